@@ -235,3 +235,71 @@ if (HDF4_ENABLE_SZIP_SUPPORT)
     message (FATAL_ERROR "SZIP support in HDF4 was requested but not found")
   endif ()
 endif ()
+
+#-----------------------------------------------------------------------------
+# Option for zstd support
+#-----------------------------------------------------------------------------
+option (HDF4_ENABLE_ZSTD_SUPPORT "Enable the zstd coder" OFF)
+if (HDF4_ENABLE_ZSTD_SUPPORT)
+  find_path (ZSTD_INCLUDE_DIR NAMES zstd.h)
+  find_library (ZSTD_LIBRARY NAMES zstd zstd_static)
+  if (ZSTD_INCLUDE_DIR AND ZSTD_LIBRARY)
+    set (H4_HAVE_ZSTD_H 1)
+    set (H4_HAVE_LIBZSTD 1)
+    set (LINK_COMP_LIBS ${LINK_COMP_LIBS} ${ZSTD_LIBRARY})
+    INCLUDE_DIRECTORIES (${ZSTD_INCLUDE_DIR})
+    set (HDF4_COMP_INCLUDE_DIRECTORIES "${HDF4_COMP_INCLUDE_DIRECTORIES};${ZSTD_INCLUDE_DIR}")
+    if (CMAKE_VERSION VERSION_GREATER_EQUAL "3.15.0")
+      message (VERBOSE "Filter ZSTD is ON")
+    endif ()
+  else ()
+    set (HDF4_ENABLE_ZSTD_SUPPORT OFF CACHE BOOL "" FORCE)
+    message (FATAL_ERROR "ZSTD support in HDF4 was requested but not found")
+  endif ()
+endif ()
+
+#-----------------------------------------------------------------------------
+# Option for LZ4 support
+#-----------------------------------------------------------------------------
+option (HDF4_ENABLE_LZ4_SUPPORT "Enable the LZ4 coder" OFF)
+if (HDF4_ENABLE_LZ4_SUPPORT)
+  find_path (LZ4_INCLUDE_DIR NAMES lz4frame.h)
+  find_library (LZ4_LIBRARY NAMES lz4 lz4_static)
+  if (LZ4_INCLUDE_DIR AND LZ4_LIBRARY)
+    set (H4_HAVE_LZ4FRAME_H 1)
+    set (H4_HAVE_LIBLZ4 1)
+    set (LINK_COMP_LIBS ${LINK_COMP_LIBS} ${LZ4_LIBRARY})
+    INCLUDE_DIRECTORIES (${LZ4_INCLUDE_DIR})
+    set (HDF4_COMP_INCLUDE_DIRECTORIES "${HDF4_COMP_INCLUDE_DIRECTORIES};${LZ4_INCLUDE_DIR}")
+    if (CMAKE_VERSION VERSION_GREATER_EQUAL "3.15.0")
+      message (VERBOSE "Filter LZ4 is ON")
+    endif ()
+  else ()
+    set (HDF4_ENABLE_LZ4_SUPPORT OFF CACHE BOOL "" FORCE)
+    message (FATAL_ERROR "LZ4 support in HDF4 was requested but not found")
+  endif ()
+endif ()
+
+#-----------------------------------------------------------------------------
+# Option for libdeflate, used next to zlib to inflate whole deflate chunks.
+# zlib-ng needs no option: built in its zlib-compatible mode, it is picked
+# up like zlib through ZLIB_INCLUDE_DIR and ZLIB_LIBRARY.
+#-----------------------------------------------------------------------------
+option (HDF4_ENABLE_LIBDEFLATE_SUPPORT "Use libdeflate to inflate whole deflate compressed chunks" OFF)
+if (HDF4_ENABLE_LIBDEFLATE_SUPPORT)
+  find_path (LIBDEFLATE_INCLUDE_DIR NAMES libdeflate.h)
+  find_library (LIBDEFLATE_LIBRARY NAMES deflate deflatestatic)
+  if (LIBDEFLATE_INCLUDE_DIR AND LIBDEFLATE_LIBRARY)
+    set (H4_HAVE_LIBDEFLATE_H 1)
+    set (H4_HAVE_LIBDEFLATE 1)
+    set (LINK_COMP_LIBS ${LINK_COMP_LIBS} ${LIBDEFLATE_LIBRARY})
+    INCLUDE_DIRECTORIES (${LIBDEFLATE_INCLUDE_DIR})
+    set (HDF4_COMP_INCLUDE_DIRECTORIES "${HDF4_COMP_INCLUDE_DIRECTORIES};${LIBDEFLATE_INCLUDE_DIR}")
+    if (CMAKE_VERSION VERSION_GREATER_EQUAL "3.15.0")
+      message (VERBOSE "libdeflate is ON")
+    endif ()
+  else ()
+    set (HDF4_ENABLE_LIBDEFLATE_SUPPORT OFF CACHE BOOL "" FORCE)
+    message (FATAL_ERROR "libdeflate support in HDF4 was requested but not found")
+  endif ()
+endif ()
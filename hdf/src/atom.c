@@ -21,17 +21,27 @@ REMARKS
 
 DESIGN
     The groups are stored in an array of pointers to store each group in an
-    element. Each "atomic group" node contains a link to a hash table to
-    manage the atoms in each group.  The allowed "atomic groups" are stored
-    in an enum (called group_t) in atom.h.
+    element.  Each "atomic group" node holds a table of slots, one atom per
+    slot: the atom carries the index of its slot, so looking an atom up is a
+    direct index into the table, and the generation of the slot, bumped each
+    time the slot is freed, so that stale atoms of a reused slot are not
+    found.  Generations start at 1 and skip 0 when they wrap, so no atom is
+    ever 0, which callers use to mean "no atom".  Freed slots are only
+    reused once enough of them are queued, so an atom does not come back
+    before about 2^19 atoms of the group have been removed.  The table is a
+    fixed directory of pages of slots that are never moved, which lets
+    lookups run without locks while other atoms are registered.  The allowed
+    "atomic groups" are stored in an enum (called group_t) in atom.h.
 
 BUGS/LIMITATIONS
     Can't iterate over the atoms in a group.
+    A group holds at most 2^18 atoms at once.
 
 LOCAL ROUTINES
-  HAIfind_atom      - Returns a pointer to an atom_info_t from a atom ID
-  HAIget_atom_node  - Gets an atom node (uses the atom free list)
-  HAIrelease_atom_node - Releases an atom node (uses the atom free list)
+  HAIfind_slot      - Returns a pointer to the slot of an atom ID
+  HAIget_slot       - Gets a free slot (reuses the oldest freed one)
+  HAIrelease_slot   - Releases a slot (puts it at the end of the free list)
+  HAIfree_pages     - Releases the slot table of a group
 EXPORTED ROUTINES
  Atom Functions:
   HAregister_atom   - Register an object in a group and get an atom for it
@@ -55,62 +65,82 @@ MODIFICATION HISTORY
 
 #include "hdf.h"
 #include "atom.h"
-
-#include <assert.h>
+#include "hlock.h"
 
 /* # of bits to use for Group ID in each atom (change if MAXGROUP>16) */
 #define GROUP_BITS 4
 #define GROUP_MASK 0x0F
 
-/* # of bits to use for the Atom index in each atom (change if MAXGROUP>16) */
-#define ATOM_BITS 28
-#define ATOM_MASK 0x0FFFFFFF
+/* # of bits to use for the slot generation in each atom */
+#define GEN_BITS 10
+#define GEN_MASK 0x3FF
 
-/* # of previous atoms cached, change inline caching macros (HAatom_object & HAIswap_cache) if this changes */
-#define ATOM_CACHE_SIZE 4
+/* # of bits to use for the slot index in each atom */
+#define SLOT_BITS 18
+#define SLOT_MASK 0x0003FFFF
 
-/* Map an atom to a Group number */
-#define ATOM_TO_GROUP(a) ((group_t)((((atom_t)(a)) >> ((sizeof(atom_t) * 8) - GROUP_BITS)) & GROUP_MASK))
+/* # of bits of the slot index that select the slot within its page */
+#define PAGE_BITS 9
+#define PAGE_SIZE (1 << PAGE_BITS)
+#define PAGE_MASK (PAGE_SIZE - 1)
+
+/* # of freed slots to queue before reusing the oldest one */
+#define MIN_FREE PAGE_SIZE
 
-/* Map an atom to a hash location (assumes s is a power of 2 and smaller than the ATOM_MASK constant) */
-#define ATOM_TO_LOC(a, s) ((atom_t)(a) & ((s)-1))
+/* # of pages in the directory of a group */
+#define NPAGES (1 << (SLOT_BITS - PAGE_BITS))
 
-/* Combine a Group number and an atom index into an atom */
-#define MAKE_ATOM(g, i)                                                                                      \
-    ((((atom_t)(g)&GROUP_MASK) << ((sizeof(atom_t) * 8) - GROUP_BITS)) | ((atom_t)(i)&ATOM_MASK))
+/* Map an atom to a Group number */
+#define ATOM_TO_GROUP(a) ((group_t)((((atom_t)(a)) >> ((sizeof(atom_t) * 8) - GROUP_BITS)) & GROUP_MASK))
 
-/* Atom information structure used */
-typedef struct atom_info_struct_tag {
-    atom_t                       id;      /* atom ID for this info */
-    void                       **obj_ptr; /* pointer associated with the atom */
-    struct atom_info_struct_tag *next;    /* link to next atom (in case of hash-clash) */
-} atom_info_t;
+/* Map an atom to the index of its slot */
+#define ATOM_TO_SLOT(a) ((uintn)(a) & SLOT_MASK)
+
+/* Combine a Group number, a slot generation and a slot index into an atom */
+#define MAKE_ATOM(g, gen, i)                                                                                 \
+    ((((atom_t)(g)&GROUP_MASK) << ((sizeof(atom_t) * 8) - GROUP_BITS)) |                                     \
+     (((atom_t)(gen)&GEN_MASK) << SLOT_BITS) | ((atom_t)(i)&SLOT_MASK))
+
+/* Slots are read without the library lock in thread-safe builds: the atom
+   ID of a slot is published after its object and read before it */
+#if defined(H4_HAVE_THREADSAFE) && defined(__GNUC__)
+#define HAI_LOAD(x)     __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define HAI_STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+#else
+#define HAI_LOAD(x)     (x)
+#define HAI_STORE(x, v) ((x) = (v))
+#endif
+
+/* Atom slot structure used */
+typedef struct atom_slot_struct_tag {
+    atom_t id;      /* atom ID held in the slot, FAIL when the slot is free */
+    void  *obj_ptr; /* pointer associated with the atom */
+    uintn  gen;     /* generation of the slot, bumped each time it is freed */
+    int32  next;    /* next free slot, -1 at the end of the free list */
+} atom_slot_t;
 
 /* Atom group structure used */
 typedef struct atom_group_struct_tag {
     uintn         count;     /* # of times this group has been initialized */
-    intn          hash_size; /* size of the hash table to store the atoms in */
     uintn         atoms;     /* current number of atoms held */
-    uintn         nextid;    /* atom ID to use for the next atom */
-    atom_info_t **atom_list; /* pointer to an array of ptrs to atoms */
+    uintn         nslots;    /* # of slots handed out so far */
+    uintn         nfree;     /* # of slots on the free list */
+    int32         free_head; /* oldest free slot, -1 if there is none */
+    int32         free_tail; /* newest free slot */
+    atom_slot_t **pages;     /* directory of NPAGES pointers to pages of slots */
 } atom_group_t;
 
 /* Array of pointers to atomic groups */
 static atom_group_t *atom_group_list[MAXGROUP] = {NULL};
 
-/* Pointer to the atom node free list */
-static atom_info_t *atom_free_list = NULL;
-
-/* Array of pointers to atomic groups */
-atom_t atom_id_cache[ATOM_CACHE_SIZE]  = {-1, -1, -1, -1};
-void  *atom_obj_cache[ATOM_CACHE_SIZE] = {NULL};
-
 /* Private function prototypes */
-static atom_info_t *HAIfind_atom(atom_t atm);
+static atom_slot_t *HAIfind_slot(atom_t atm);
+
+static atom_slot_t *HAIget_slot(atom_group_t *grp_ptr, uintn *slot);
 
-static atom_info_t *HAIget_atom_node(void);
+static void HAIrelease_slot(atom_group_t *grp_ptr, uintn slot);
 
-static void HAIrelease_atom_node(atom_info_t *atm);
+static void HAIfree_pages(atom_group_t *grp_ptr);
 
 /******************************************************************************
  NAME
@@ -119,10 +149,10 @@ static void HAIrelease_atom_node(atom_info_t *atm);
  DESCRIPTION
     Creates a global atomic group to store atoms in.  If the group has already
     been initialized, this routine just increments the count of # of
-    initializations and returns without trying to change the size of the hash
-    table.
+    initializations and returns.
 
-    NOTE: The hash size MUST be a power of 2 (checked in code)
+    NOTE: The hash size MUST be a power of 2 (checked in code).  It is only
+    checked: the slot table of the group grows as atoms are registered.
 
  RETURNS
     Returns SUCCEED if successful and FAIL otherwise
@@ -137,12 +167,10 @@ HAinit_group(group_t grp,      /* IN: Group to initialize */
     intn          ret_value = SUCCEED;
 
     HEclear();
+    HL_LOCK_LIBRARY();
     if ((grp <= BADGROUP || grp >= MAXGROUP) && hash_size > 0)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* Assertion necessary for faster pointer swapping */
-    assert(sizeof(hdf_pint_t) == sizeof(void *));
-
     /* Ensure hash_size is not zero and a power of two */
     if (hash_size == 0)
         HGOTO_ERROR(DFE_ARGS, FAIL);
@@ -159,11 +187,14 @@ HAinit_group(group_t grp,      /* IN: Group to initialize */
         grp_ptr = atom_group_list[grp];
 
     if (grp_ptr->count == 0) { /* Initialize the atom group structure */
-        grp_ptr->hash_size = hash_size;
         grp_ptr->atoms     = 0;
-        grp_ptr->nextid    = 0;
-        if ((grp_ptr->atom_list = (atom_info_t **)calloc(hash_size, sizeof(atom_info_t *))) == NULL)
+        grp_ptr->nslots    = 0;
+        grp_ptr->nfree     = 0;
+        grp_ptr->free_head = (-1);
+        grp_ptr->free_tail = (-1);
+        if ((grp_ptr->pages = (atom_slot_t **)calloc(NPAGES, sizeof(atom_slot_t *))) == NULL)
             HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        HDmem_acquire(HDF_MEM_ATOMS, NPAGES * sizeof(atom_slot_t *));
     } /* end if */
 
     /* Increment the count of the times this group has been initialized */
@@ -172,10 +203,12 @@ HAinit_group(group_t grp,      /* IN: Group to initialize */
 done:
     if (ret_value == FAIL) { /* Error condition cleanup */
         if (grp_ptr != NULL) {
-            free(grp_ptr->atom_list);
+            free(grp_ptr->pages);
             free(grp_ptr);
+            atom_group_list[grp] = NULL;
         }
     }
+    HL_UNLOCK_LIBRARY();
 
     return ret_value;
 } /* end HAinit_group() */
@@ -202,6 +235,7 @@ HAdestroy_group(group_t grp /* IN: Group to destroy */
     intn          ret_value = SUCCEED;
 
     HEclear();
+    HL_LOCK_LIBRARY();
     if (grp <= BADGROUP || grp >= MAXGROUP)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
@@ -210,19 +244,11 @@ HAdestroy_group(group_t grp /* IN: Group to destroy */
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
     /* Decrement the number of users of the atomic group */
-    if ((--(grp_ptr->count)) == 0) {
-        uintn i;
-
-        for (i = 0; i < ATOM_CACHE_SIZE; i++)
-            if (ATOM_TO_GROUP(atom_id_cache[i]) == grp) {
-                atom_id_cache[i]  = (-1);
-                atom_obj_cache[i] = NULL;
-            } /* end if */
-        free(grp_ptr->atom_list);
-        grp_ptr->atom_list = NULL;
-    } /* end if */
+    if ((--(grp_ptr->count)) == 0)
+        HAIfree_pages(grp_ptr);
 
 done:
+    HL_UNLOCK_LIBRARY();
     return ret_value;
 } /* end HAdestroy_group() */
 
@@ -234,9 +260,9 @@ done:
     Registers an object in a group and returns an atom for it.  This routine
     does _not_ check for unique-ness of the objects, if you register an object
     twice, you will get two different atoms for it.  This routine does make
-    certain that each atom in a group is unique.  Atoms are created by getting
-    a unique number for the group the atom is in and incorporating the group
-    into the atom which is returned to the user.
+    certain that each atom in a group is unique.  Atoms are created from the
+    slot the object is stored in and the generation of that slot, and
+    incorporate the group which is returned to the user.
 
  RETURNS
     Returns atom if successful and FAIL otherwise
@@ -248,12 +274,13 @@ HAregister_atom(group_t grp,   /* IN: Group to register the object in */
 )
 {
     atom_group_t *grp_ptr = NULL; /* ptr to the atomic group */
-    atom_info_t  *atm_ptr = NULL; /* ptr to the new atom */
+    atom_slot_t  *slt_ptr = NULL; /* ptr to the new atom's slot */
     atom_t        atm_id;         /* new atom ID */
-    uintn         hash_loc;       /* new item's hash table location */
+    uintn         slot;           /* new atom's slot index */
     atom_t        ret_value = SUCCEED;
 
     HEclear();
+    HL_LOCK_LIBRARY();
     if (grp <= BADGROUP || grp >= MAXGROUP)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
@@ -261,28 +288,19 @@ HAregister_atom(group_t grp,   /* IN: Group to register the object in */
     if (grp_ptr == NULL || grp_ptr->count <= 0)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
-    if ((atm_ptr = HAIget_atom_node()) == NULL)
+    if ((slt_ptr = HAIget_slot(grp_ptr, &slot)) == NULL)
         HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
-    /* Create the atom & it's ID */
-    atm_id           = MAKE_ATOM(grp, grp_ptr->nextid);
-    atm_ptr->id      = atm_id;
-    atm_ptr->obj_ptr = object;
-    atm_ptr->next    = NULL;
-
-    /* hash bucket already full, prepend to front of chain */
-    hash_loc = grp_ptr->nextid % (uintn)grp_ptr->hash_size;
-    if (grp_ptr->atom_list[hash_loc] != NULL)
-        atm_ptr->next = grp_ptr->atom_list[hash_loc];
-
-    /* Insert into the group */
-    grp_ptr->atom_list[hash_loc] = atm_ptr;
+    /* Create the atom & it's ID, the ID goes in last */
+    atm_id           = MAKE_ATOM(grp, slt_ptr->gen, slot);
+    slt_ptr->obj_ptr = object;
+    HAI_STORE(slt_ptr->id, atm_id);
     grp_ptr->atoms++;
-    grp_ptr->nextid++;
 
     ret_value = atm_id;
 
 done:
+    HL_UNLOCK_LIBRARY();
     return ret_value;
 } /* end HAregister_atom() */
 
@@ -291,7 +309,8 @@ done:
      HAatom_object - Returns to the object ptr for the atom
 
  DESCRIPTION
-    Retrieves the object ptr which is associated with the atom.
+    Retrieves the object ptr which is associated with the atom.  Takes no
+    lock and writes nothing unless the atom is not found.
 
  RETURNS
     Returns object ptr if successful and NULL otherwise
@@ -301,18 +320,20 @@ void *
 HAPatom_object(atom_t atm /* IN: Atom to retrieve object for */
 )
 {
-    atom_info_t *atm_ptr   = NULL; /* ptr to the new atom */
+    atom_slot_t *slt_ptr   = NULL; /* ptr to the atom's slot */
     void        *ret_value = NULL;
 
-    HEclear();
+    /* Direct lookup of the atom */
+    if ((slt_ptr = HAIfind_slot(atm)) != NULL) {
+        ret_value = HAI_LOAD(slt_ptr->obj_ptr);
 
-    /* General lookup of the atom */
-    if ((atm_ptr = HAIfind_atom(atm)) == NULL)
-        HGOTO_ERROR(DFE_INTERNAL, NULL);
+        /* Make sure the slot was not freed while it was read */
+        if (HAI_LOAD(slt_ptr->id) == atm)
+            HGOTO_DONE(ret_value);
+    }
 
-    /* Check if we've found the correct atom */
-    if (atm_ptr != NULL)
-        ret_value = atm_ptr->obj_ptr;
+    HEclear();
+    HGOTO_ERROR(DFE_INTERNAL, NULL);
 
 done:
     return ret_value;
@@ -360,14 +381,12 @@ HAremove_atom(atom_t atm /* IN: Atom to remove */
 )
 {
     atom_group_t *grp_ptr = NULL; /* ptr to the atomic group */
-    atom_info_t  *curr_atm,       /* ptr to the current atom */
-        *last_atm;                /* ptr to the last atom */
-    group_t grp;                  /* atom's atomic group */
-    uintn   hash_loc;             /* atom's hash table location */
-    uintn   i;                    /* local counting variable */
-    void   *ret_value = NULL;
+    atom_slot_t  *slt_ptr = NULL; /* ptr to the atom's slot */
+    group_t       grp;            /* atom's atomic group */
+    void         *ret_value = NULL;
 
     HEclear();
+    HL_LOCK_LIBRARY();
     grp = ATOM_TO_GROUP(atm);
     if (grp <= BADGROUP || grp >= MAXGROUP)
         HGOTO_ERROR(DFE_ARGS, NULL);
@@ -376,43 +395,18 @@ HAremove_atom(atom_t atm /* IN: Atom to remove */
     if (grp_ptr == NULL || grp_ptr->count <= 0)
         HGOTO_ERROR(DFE_INTERNAL, NULL);
 
-    /* Get the location in which the atom is located */
-    hash_loc = (uintn)ATOM_TO_LOC(atm, grp_ptr->hash_size);
-    curr_atm = grp_ptr->atom_list[hash_loc];
-    if (curr_atm == NULL)
-        HGOTO_ERROR(DFE_INTERNAL, NULL);
-
-    last_atm = NULL;
-    while (curr_atm != NULL) {
-        if (curr_atm->id == atm)
-            break;
-        last_atm = curr_atm;
-        curr_atm = curr_atm->next;
-    } /* end while */
-
-    if (curr_atm != NULL) {
-        if (last_atm == NULL) /* atom is the first the chain */
-            grp_ptr->atom_list[hash_loc] = curr_atm->next;
-        else
-            last_atm->next = curr_atm->next;
-        ret_value = curr_atm->obj_ptr;
-        HAIrelease_atom_node(curr_atm);
-    }    /* end if */
-    else /* couldn't find the atom in the proper place */
+    /* Get the slot in which the atom is located */
+    if ((slt_ptr = HAIfind_slot(atm)) == NULL)
         HGOTO_ERROR(DFE_INTERNAL, NULL);
 
-    /* Delete object from cache */
-    for (i = 0; i < ATOM_CACHE_SIZE; i++)
-        if (atom_id_cache[i] == atm) {
-            atom_id_cache[i]  = (-1);
-            atom_obj_cache[i] = NULL;
-            break; /* we assume there is only one instance in the cache */
-        }
+    ret_value = slt_ptr->obj_ptr;
+    HAIrelease_slot(grp_ptr, ATOM_TO_SLOT(atm));
 
     /* Decrement the number of atoms in the group */
     (grp_ptr->atoms)--;
 
 done:
+    HL_UNLOCK_LIBRARY();
     return ret_value;
 } /* end HAremove_atom() */
 
@@ -437,11 +431,12 @@ HAsearch_atom(group_t         grp,  /* IN: Group to search for the object in */
 )
 {
     atom_group_t *grp_ptr = NULL; /* ptr to the atomic group */
-    atom_info_t  *atm_ptr = NULL; /* ptr to the new atom */
-    intn          i;              /* local counting variable */
+    atom_slot_t  *slt_ptr = NULL; /* ptr to the current slot */
+    uintn         i;              /* local counting variable */
     void         *ret_value = NULL;
 
     HEclear();
+    HL_LOCK_LIBRARY();
     if (grp <= BADGROUP || grp >= MAXGROUP)
         HGOTO_ERROR(DFE_ARGS, NULL);
 
@@ -449,123 +444,190 @@ HAsearch_atom(group_t         grp,  /* IN: Group to search for the object in */
     if (grp_ptr == NULL || grp_ptr->count <= 0)
         HGOTO_ERROR(DFE_INTERNAL, NULL);
 
-    /* Start at the beginning of the array */
-    for (i = 0; i < grp_ptr->hash_size; i++) {
-        atm_ptr = grp_ptr->atom_list[i];
-        while (atm_ptr != NULL) {
-            if ((*func)(atm_ptr->obj_ptr, key))
-                HGOTO_DONE(atm_ptr->obj_ptr); /* found the item we are looking for */
-            atm_ptr = atm_ptr->next;
-        } /* end while */
-    }     /* end for */
+    /* Walk the slots in use, in slot order */
+    for (i = 0; i < grp_ptr->nslots; i++) {
+        slt_ptr = &grp_ptr->pages[i >> PAGE_BITS][i & PAGE_MASK];
+        if (slt_ptr->id != FAIL && (*func)(slt_ptr->obj_ptr, key))
+            HGOTO_DONE(slt_ptr->obj_ptr); /* found the item we are looking for */
+    }                                     /* end for */
 
 done:
+    HL_UNLOCK_LIBRARY();
     return ret_value;
 } /* end HAsearch_atom() */
 
 /******************************************************************************
  NAME
-     HAIfind_atom - Finds a atom in a group
+     HAIfind_slot - Finds the slot of an atom
 
  DESCRIPTION
-    Retrieves the atom ptr which is associated with the atom.
+    Retrieves the slot which holds the atom.  Takes no lock, pushes no error
+    and writes nothing.
 
  RETURNS
-    Returns atom ptr if successful and NULL otherwise
+    Returns slot ptr if successful and NULL otherwise
 
 *******************************************************************************/
-static atom_info_t *
-HAIfind_atom(atom_t atm /* IN: Atom to retrieve atom for */
+static atom_slot_t *
+HAIfind_slot(atom_t atm /* IN: Atom to retrieve slot for */
 )
 {
     atom_group_t *grp_ptr = NULL; /* ptr to the atomic group */
-    atom_info_t  *atm_ptr = NULL; /* ptr to the new atom */
+    atom_slot_t **pages;          /* directory of the group's pages */
+    atom_slot_t  *page;           /* page holding the slot */
     group_t       grp;            /* atom's atomic group */
-    uintn         hash_loc;       /* atom's hash table location */
-    atom_info_t  *ret_value = NULL;
+    uintn         slot;           /* atom's slot index */
 
-    HEclear();
     grp = ATOM_TO_GROUP(atm);
     if (grp <= BADGROUP || grp >= MAXGROUP)
-        HGOTO_ERROR(DFE_ARGS, NULL);
+        return NULL;
 
-    grp_ptr = atom_group_list[grp];
-    if (grp_ptr == NULL || grp_ptr->count <= 0)
-        HGOTO_ERROR(DFE_INTERNAL, NULL);
+    grp_ptr = HAI_LOAD(atom_group_list[grp]);
+    if (grp_ptr == NULL || (pages = HAI_LOAD(grp_ptr->pages)) == NULL)
+        return NULL;
 
-    /* Get the location in which the atom is located */
-    hash_loc = (uintn)ATOM_TO_LOC(atm, grp_ptr->hash_size);
-    atm_ptr  = grp_ptr->atom_list[hash_loc];
-    if (atm_ptr == NULL)
-        HGOTO_ERROR(DFE_INTERNAL, NULL);
-
-    while (atm_ptr != NULL) {
-        if (atm_ptr->id == atm)
-            break;
-        atm_ptr = atm_ptr->next;
-    } /* end while */
+    slot = ATOM_TO_SLOT(atm);
+    if ((page = HAI_LOAD(pages[slot >> PAGE_BITS])) == NULL)
+        return NULL;
 
-    if (atm_ptr) {
-        /* if found, add it to the end of the cached list */
-        atom_id_cache[ATOM_CACHE_SIZE - 1]  = atm;
-        atom_obj_cache[ATOM_CACHE_SIZE - 1] = atm_ptr->obj_ptr;
-    }
+    /* The slot must still hold this generation of the atom */
+    if (HAI_LOAD(page[slot & PAGE_MASK].id) != atm)
+        return NULL;
 
-    ret_value = atm_ptr;
-
-done:
-    return ret_value;
-} /* end HAIfind_atom() */
+    return &page[slot & PAGE_MASK];
+} /* end HAIfind_slot() */
 
 /******************************************************************************
  NAME
-     HAIget_atom_node - Gets an atom node
+     HAIget_slot - Gets a free slot of a group
 
  DESCRIPTION
-    Either gets an atom node from the free list (if there is one available)
-    or allocate a node.
+    Either reuses the slot freed the longest time ago, once MIN_FREE slots
+    are queued or no new slot is left, which keeps stale atoms from matching
+    a new one for as long as possible, or hands out a new slot, allocating
+    its page if needed.
 
  RETURNS
-    Returns atom ptr if successful and NULL otherwise
+    Returns slot ptr if successful and NULL otherwise
 
 *******************************************************************************/
-static atom_info_t *
-HAIget_atom_node(void)
+static atom_slot_t *
+HAIget_slot(atom_group_t *grp_ptr, /* IN: Group to get a slot from */
+            uintn        *slot     /* OUT: Index of the slot */
+)
 {
-    atom_info_t *ret_value = NULL;
+    atom_slot_t *page;
+    atom_slot_t *ret_value = NULL;
+    intn         i;
 
     HEclear();
-    if (atom_free_list != NULL) {
-        ret_value      = atom_free_list;
-        atom_free_list = atom_free_list->next;
+    if (grp_ptr->free_head >= 0 && (grp_ptr->nfree >= MIN_FREE || grp_ptr->nslots > SLOT_MASK)) {
+        *slot              = (uintn)grp_ptr->free_head;
+        ret_value          = &grp_ptr->pages[*slot >> PAGE_BITS][*slot & PAGE_MASK];
+        grp_ptr->free_head = ret_value->next;
+        if (grp_ptr->free_head < 0)
+            grp_ptr->free_tail = (-1);
+        grp_ptr->nfree--;
     } /* end if */
     else {
-        if ((ret_value = (atom_info_t *)malloc(sizeof(atom_info_t))) == NULL)
+        if (grp_ptr->nslots > SLOT_MASK)
             HGOTO_ERROR(DFE_NOSPACE, NULL);
+        *slot = grp_ptr->nslots;
+
+        /* Set up a new page before lookups can see it */
+        if ((page = grp_ptr->pages[*slot >> PAGE_BITS]) == NULL) {
+            if ((page = (atom_slot_t *)malloc(PAGE_SIZE * sizeof(atom_slot_t))) == NULL)
+                HGOTO_ERROR(DFE_NOSPACE, NULL);
+            for (i = 0; i < PAGE_SIZE; i++) {
+                page[i].id      = FAIL;
+                page[i].obj_ptr = NULL;
+                page[i].gen     = 1;
+                page[i].next    = (-1);
+            }
+            HAI_STORE(grp_ptr->pages[*slot >> PAGE_BITS], page);
+            HDmem_acquire(HDF_MEM_ATOMS, PAGE_SIZE * sizeof(atom_slot_t));
+        } /* end if */
+
+        ret_value = &page[*slot & PAGE_MASK];
+        grp_ptr->nslots++;
     } /* end else */
 
 done:
     return ret_value;
-} /* end HAIget_atom_node() */
+} /* end HAIget_slot() */
+
+/******************************************************************************
+ NAME
+     HAIrelease_slot - Releases a slot of a group
+
+ DESCRIPTION
+    Frees the slot, bumps its generation so the atom it held is no longer
+    found, and puts it at the end of the free list.  Generation 0 is skipped
+    so that no atom is 0.
+
+ RETURNS
+    No return value
+
+*******************************************************************************/
+static void
+HAIrelease_slot(atom_group_t *grp_ptr, /* IN: Group the slot belongs to */
+                uintn         slot     /* IN: Index of the slot */
+)
+{
+    atom_slot_t *slt_ptr = &grp_ptr->pages[slot >> PAGE_BITS][slot & PAGE_MASK];
+
+    HAI_STORE(slt_ptr->id, FAIL);
+    slt_ptr->obj_ptr = NULL;
+    slt_ptr->gen     = (slt_ptr->gen + 1) & GEN_MASK;
+    if (slt_ptr->gen == 0)
+        slt_ptr->gen = 1;
+    slt_ptr->next = (-1);
+
+    /* Append the slot to the free list */
+    if (grp_ptr->free_tail >= 0)
+        grp_ptr->pages[(uintn)grp_ptr->free_tail >> PAGE_BITS][grp_ptr->free_tail & PAGE_MASK].next =
+            (int32)slot;
+    else
+        grp_ptr->free_head = (int32)slot;
+    grp_ptr->free_tail = (int32)slot;
+    grp_ptr->nfree++;
+} /* end HAIrelease_slot() */
 
 /******************************************************************************
  NAME
-     HAIrelease_atom_node - Releases an atom node
+     HAIfree_pages - Releases the slot table of a group
 
  DESCRIPTION
-    Puts an atom node into the free list
+    Frees the pages and the directory of a group, after which none of its
+    atoms are found
 
  RETURNS
     No return value
 
 *******************************************************************************/
 static void
-HAIrelease_atom_node(atom_info_t *atm)
+HAIfree_pages(atom_group_t *grp_ptr)
 {
-    /* Insert the atom at the beginning of the free list */
-    atm->next      = atom_free_list;
-    atom_free_list = atm;
-} /* end HAIrelease_atom_node() */
+    atom_slot_t **pages = grp_ptr->pages;
+    intn          i;
+
+    if (pages == NULL)
+        return;
+
+    HAI_STORE(grp_ptr->pages, NULL);
+    for (i = 0; i < NPAGES; i++)
+        if (pages[i] != NULL) {
+            free(pages[i]);
+            HDmem_release(HDF_MEM_ATOMS, PAGE_SIZE * sizeof(atom_slot_t));
+        }
+    free(pages);
+    HDmem_release(HDF_MEM_ATOMS, NPAGES * sizeof(atom_slot_t *));
+    grp_ptr->atoms     = 0;
+    grp_ptr->nslots    = 0;
+    grp_ptr->nfree     = 0;
+    grp_ptr->free_head = (-1);
+    grp_ptr->free_tail = (-1);
+} /* end HAIfree_pages() */
 
 /*--------------------------------------------------------------------------
  NAME
@@ -587,23 +649,15 @@ HAIrelease_atom_node(atom_info_t *atm)
 intn
 HAshutdown(void)
 {
-    atom_info_t *curr;
-    intn         i;
-
-    /* Release the free-list if it exists */
-    if (atom_free_list != NULL) {
-        while (atom_free_list != NULL) {
-            curr           = atom_free_list;
-            atom_free_list = atom_free_list->next;
-            free(curr);
-        } /* end while */
-    }     /* end if */
+    intn i;
 
+    HL_LOCK_LIBRARY();
     for (i = 0; i < (intn)MAXGROUP; i++)
         if (atom_group_list[i] != NULL) {
-            free(atom_group_list[i]->atom_list);
+            HAIfree_pages(atom_group_list[i]);
             free(atom_group_list[i]);
             atom_group_list[i] = NULL;
         } /* end if */
+    HL_UNLOCK_LIBRARY();
     return SUCCEED;
 } /* end HAshutdown() */
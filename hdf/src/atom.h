@@ -26,22 +26,8 @@
 
 #include "H4api_adpt.h"
 
-/* Do swap using XOR operator. Ugly but fast... -QAK */
-#define HAIswap_cache(i, j)                                                                                  \
-    atom_id_cache[i] ^= atom_id_cache[j],                                                                    \
-        atom_obj_cache[i] = (void *)((hdf_pint_t)atom_obj_cache[j] ^ (hdf_pint_t)atom_obj_cache[i]),         \
-        atom_id_cache[j] ^= atom_id_cache[i],                                                                \
-        atom_obj_cache[j] = (void *)((hdf_pint_t)atom_obj_cache[i] ^ (hdf_pint_t)atom_obj_cache[j]),         \
-        atom_id_cache[i] ^= atom_id_cache[j],                                                                \
-        atom_obj_cache[i] = (void *)((hdf_pint_t)atom_obj_cache[i] ^ (hdf_pint_t)atom_obj_cache[j])
-
-/* Note! This is hardwired to the atom cache value being 4 */
-#define HAatom_object(atm)                                                                                   \
-    (atom_id_cache[0] == atm   ? atom_obj_cache[0]                                                           \
-     : atom_id_cache[1] == atm ? (HAIswap_cache(0, 1), atom_obj_cache[0])                                    \
-     : atom_id_cache[2] == atm ? (HAIswap_cache(1, 2), atom_obj_cache[1])                                    \
-     : atom_id_cache[3] == atm ? (HAIswap_cache(2, 3), atom_obj_cache[2])                                    \
-                               : HAPatom_object(atm))
+/* Lookups go straight to the atom's slot, there is no cache in front of them */
+#define HAatom_object(atm) HAPatom_object(atm)
 
 #include "hdf.h"
 
@@ -70,10 +56,6 @@ typedef intn (*HAsearch_func_t)(const void *obj, const void *key);
 extern "C" {
 #endif
 
-/* Global variables exposed by HAatom_object */
-HDFLIBAPI atom_t atom_id_cache[];
-HDFLIBAPI void  *atom_obj_cache[];
-
 /******************************************************************************
  NAME
      HAinit_group - Initialize an atomic group
@@ -81,9 +63,10 @@ HDFLIBAPI void  *atom_obj_cache[];
  DESCRIPTION
     Creates an atomic group to store atoms in.  If the group has already been
     initialized, this routine just increments the count of # of initializations
-    and returns without trying to change the size of the hash table.
+    and returns.
 
-    NOTE: The hash size MUST be a power of 2 (checked in code)
+    NOTE: The hash size MUST be a power of 2 (checked in code).  It is only
+    checked: the slot table of the group grows as atoms are registered.
 
  RETURNS
     Returns SUCCEED if successful and FAIL otherwise
@@ -135,7 +118,10 @@ HDFLIBAPI atom_t HAregister_atom(group_t grp,   /* IN: Group to register the obj
      HAatom_object - Returns to the object ptr for the atom
 
  DESCRIPTION
-    Retrieves the object ptr which is associated with the atom.
+    Retrieves the object ptr which is associated with the atom.  The lookup
+    takes constant time and writes nothing, so it may run concurrently with
+    other lookups and, in thread-safe builds, with the registering and
+    removing of other atoms.
 
  RETURNS
     Returns object ptr if successful and NULL otherwise
@@ -44,6 +44,11 @@ typedef uint8 bv_base;
 /* # of bits in the base type of the array used to store the bits */
 #define BV_BASE_BITS 8
 
+/* Bytes looked at together, as a machine word, when skipping over full
+ *  bytes, and the value of such a word when all of its bits are set */
+#define BV_WORD_BYTES ((int32)sizeof(size_t))
+#define BV_WORD_FULL  (~(size_t)0)
+
 /* bit-vector structure used
  *
  * All values are set to be 32-bit signed integers since that's what the
@@ -468,6 +473,16 @@ bv_find_next_zero(bv_ptr b)
     else
         i = 0;
 
+    /* skip the full bytes a word at a time, then a byte at a time */
+    while (i + BV_WORD_BYTES <= bytes_used) {
+        size_t word;
+
+        memcpy(&word, &b->buffer[i], sizeof(word));
+        if (word != BV_WORD_FULL)
+            break;
+        i += BV_WORD_BYTES;
+    }
+
     tmp_buf = &b->buffer[i];
 
     while (i < bytes_used && *tmp_buf == 255) {
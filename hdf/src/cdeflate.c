@@ -36,11 +36,49 @@
 
 /* HDF compression includes */
 #include "hcompi.h" /* Internal definitions for compression */
+#include "htpool.h" /* worker threads */
+
+#ifdef H4_HAVE_LIBDEFLATE
+#include <libdeflate.h>
+#endif /* H4_HAVE_LIBDEFLATE */
 
 /* Define the [default] size of the buffer to interact with the file */
 #define DEFLATE_BUF_SIZE     4096
 #define DEFLATE_TMP_BUF_SIZE 16384
 
+/* Version of the DFTAG_CMPSEEK element written, and the size of its header:
+   version, de-compressed length, stream length and # of seek points */
+#define DEFLATE_SEEK_VERSION  1
+#define DEFLATE_SEEK_HDR_SIZE 14
+#define DEFLATE_SEEK_PT_SIZE  8
+
+/* Writes deflated on worker threads, see HCset_deflate_threads(): the
+   size of the blocks deflated apart, the most bytes before a block used
+   as its dictionary, the blocks handed out per thread at once, and the
+   memory level of deflateInit() */
+#define DEFLATE_PAR_BLOCK      (128 * 1024)
+#define DEFLATE_PAR_DICT       32768
+#define DEFLATE_PAR_PER_THREAD 4
+#define DEFLATE_MEM_LEVEL      8
+
+/* Bytes between the seek points of the elements written, 0 for none */
+static int32 HCIdeflate_seek_interval = 0;
+
+/* Threads the large writes of the elements written are deflated on */
+static intn HCIdeflate_threads = 1;
+
+/* Block of a write deflated on a worker thread, see HCIcdeflate_encode_par() */
+typedef struct {
+    uint8       *in;       /* the block */
+    int32        in_len;   /* its length */
+    int32        dict_len; /* bytes before it to prime the dictionary with */
+    uint8       *out;      /* the block deflated */
+    int32        out_len;  /* room in 'out', then the length deflated */
+    uLong        adler;    /* Adler-32 of the block */
+    intn         level;    /* how hard to try to compress it */
+    intn         status;   /* SUCCEED once deflated */
+} deflate_block_t;
+
 /* functions to perform gzip encoding */
 funclist_t cdeflate_funcs = {HCPcdeflate_stread,
                              HCPcdeflate_stwrite,
@@ -55,6 +93,327 @@ funclist_t cdeflate_funcs = {HCPcdeflate_stread,
 /* declaration of the functions provided in this module */
 static int32 HCIcdeflate_init(compinfo_t *info);
 
+/*--------------------------------------------------------------------------
+ NAME
+    HCset_deflate_seek_interval -- Set the spacing of the seek points written
+                                   into deflate compressed elements
+
+ USAGE
+    intn HCset_deflate_seek_interval(interval)
+    int32 interval;     IN: bytes of de-compressed data between seek points,
+                            0 for none
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Deflate compressed elements written after this call are flushed fully
+    every 'interval' bytes, and the offsets of those flush points are kept
+    in a DFTAG_CMPSEEK element with the reference number of the compressed
+    element.  A seek into such an element starts inflating at the nearest
+    flush point before the offset, instead of at the beginning of the
+    data.  Each seek point costs a few bytes of compression.  The setting
+    applies to the whole library and is off by default.  Chunks are
+    always decoded whole and never hold seek points.
+--------------------------------------------------------------------------*/
+intn
+HCset_deflate_seek_interval(int32 interval)
+{
+    HEclear();
+
+    if (interval < 0)
+        HRETURN_ERROR(DFE_ARGS, FAIL);
+
+    HCIdeflate_seek_interval = interval;
+
+    return SUCCEED;
+} /* end HCset_deflate_seek_interval() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCset_deflate_threads -- Set the number of threads large writes to
+                             deflate compressed elements are deflated on
+
+ USAGE
+    intn HCset_deflate_threads(nthreads)
+    intn nthreads;      IN: number of threads, 1 for none
+
+ RETURNS
+    Returns the previous number of threads or FAIL
+
+ DESCRIPTION
+    A write that starts the deflate stream of an element written after
+    this call, and spans more than one DEFLATE_PAR_BLOCK byte block, is
+    split into such blocks, which are deflated on up to 'nthreads'
+    threads, each with the bytes before it as its dictionary.  The blocks
+    make up one deflate stream that every reader inflates as before, a
+    little larger than if it had been deflated serially.  Writes with seek
+    points, see HCset_deflate_seek_interval(), are deflated serially.
+    The setting applies to the whole library and is 1 by default.
+    Chunks are coded on the threads of their element, see HMCsetThreads().
+--------------------------------------------------------------------------*/
+intn
+HCset_deflate_threads(intn nthreads)
+{
+    intn ret_value;
+
+    HEclear();
+
+    if (nthreads < 1)
+        HRETURN_ERROR(DFE_ARGS, FAIL);
+
+    ret_value          = HCIdeflate_threads;
+    HCIdeflate_threads = MIN(nthreads, HTPOOL_MAX_THREADS);
+
+    return ret_value;
+} /* end HCset_deflate_threads() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcdeflate_add_seek -- Add a seek point to a deflate compressed element
+
+ USAGE
+    intn HCIcdeflate_add_seek(deflate_info, u_off, c_off)
+    comp_coder_deflate_info_t *deflate_info;   IN: the deflate info
+    int32 u_off;        IN: offset in the de-compressed data
+    int32 c_off;        IN: offset in the deflate stream
+
+ RETURNS
+    Returns SUCCEED or FAIL
+--------------------------------------------------------------------------*/
+static intn
+HCIcdeflate_add_seek(comp_coder_deflate_info_t *deflate_info, int32 u_off, int32 c_off)
+{
+    if (deflate_info->nseeks == deflate_info->max_seeks) {
+        intn                 max_seeks = deflate_info->max_seeks > 0 ? deflate_info->max_seeks * 2 : 64;
+        comp_deflate_seek_t *seeks;
+
+        if ((seeks = (comp_deflate_seek_t *)realloc(deflate_info->seeks,
+                                                    (size_t)max_seeks * sizeof(comp_deflate_seek_t))) == NULL)
+            HRETURN_ERROR(DFE_NOSPACE, FAIL);
+        deflate_info->seeks     = seeks;
+        deflate_info->max_seeks = max_seeks;
+    } /* end if */
+
+    deflate_info->seeks[deflate_info->nseeks].u_off = u_off;
+    deflate_info->seeks[deflate_info->nseeks].c_off = c_off;
+    deflate_info->nseeks++;
+
+    return SUCCEED;
+} /* end HCIcdeflate_add_seek() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcdeflate_write_seeks -- Store the seek points of a deflate compressed
+                               element
+
+ USAGE
+    intn HCIcdeflate_write_seeks(info)
+    compinfo_t *info;   IN: the info about the compressed element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Called once the deflate stream is finished.  Replaces the DFTAG_CMPSEEK
+    element of the compressed element with the seek points just written,
+    or removes it when there are none.
+--------------------------------------------------------------------------*/
+static intn
+HCIcdeflate_write_seeks(compinfo_t *info)
+{
+    comp_coder_deflate_info_t *deflate_info; /* ptr to deflate info */
+    uint8                     *buf = NULL;
+    uint8                     *p;
+    int32                      len;
+    intn                       i;
+    intn                       ret_value = SUCCEED;
+
+    deflate_info = &(info->cinfo.coder_info.deflate_info);
+
+    /* Seek points of an earlier write don't match the new stream */
+    if (HDcheck_tagref(deflate_info->file_id, DFTAG_CMPSEEK, info->comp_ref) == 1)
+        if (Hdeldd(deflate_info->file_id, DFTAG_CMPSEEK, info->comp_ref) == FAIL)
+            HGOTO_ERROR(DFE_CANTDELDD, FAIL);
+
+    if (deflate_info->nseeks == 0)
+        HGOTO_DONE(SUCCEED);
+
+    len = DEFLATE_SEEK_HDR_SIZE + DEFLATE_SEEK_PT_SIZE * deflate_info->nseeks;
+    if ((buf = (uint8 *)malloc((size_t)len)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    p = buf;
+    UINT16ENCODE(p, DEFLATE_SEEK_VERSION);
+    INT32ENCODE(p, deflate_info->offset);
+    INT32ENCODE(p, (int32)deflate_info->deflate_context.total_out);
+    INT32ENCODE(p, (int32)deflate_info->nseeks);
+    for (i = 0; i < deflate_info->nseeks; i++) {
+        INT32ENCODE(p, deflate_info->seeks[i].u_off);
+        INT32ENCODE(p, deflate_info->seeks[i].c_off);
+    } /* end for */
+
+    if (Hputelement(deflate_info->file_id, DFTAG_CMPSEEK, info->comp_ref, buf, len) == FAIL)
+        HGOTO_ERROR(DFE_PUTELEM, FAIL);
+
+done:
+    free(buf);
+
+    return ret_value;
+} /* end HCIcdeflate_write_seeks() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcdeflate_seek_point -- Find the seek point to start inflating from
+
+ USAGE
+    const comp_deflate_seek_t *HCIcdeflate_seek_point(info, offset)
+    compinfo_t *info;   IN: the info about the compressed element
+    int32 offset;       IN: offset in the de-compressed data to seek to
+
+ RETURNS
+    The last seek point at or before 'offset', or NULL if there is none
+
+ DESCRIPTION
+    The seek points are read in from the DFTAG_CMPSEEK element the first
+    time they are needed.  An element that is missing, unknown or doesn't
+    match the compressed element is ignored, leaving seeks to inflate the
+    stream from the beginning as before.
+--------------------------------------------------------------------------*/
+static const comp_deflate_seek_t *
+HCIcdeflate_seek_point(compinfo_t *info, int32 offset)
+{
+    comp_coder_deflate_info_t *deflate_info; /* ptr to deflate info */
+    intn                       lo, hi;
+
+    deflate_info = &(info->cinfo.coder_info.deflate_info);
+
+    if (!deflate_info->seeks_loaded) {
+        uint8 *buf = NULL;
+        uint8 *p;
+        uint16 version;
+        int32  len, elem_len, u_len, c_len, nseeks;
+        int32  u_prev = 0, c_prev = 0;
+        intn   i;
+
+        deflate_info->seeks_loaded = TRUE;
+        deflate_info->nseeks       = 0;
+
+        if (HDcheck_tagref(deflate_info->file_id, DFTAG_CMPSEEK, info->comp_ref) != 1)
+            return NULL;
+        if ((len = Hlength(deflate_info->file_id, DFTAG_CMPSEEK, info->comp_ref)) < DEFLATE_SEEK_HDR_SIZE ||
+            Hinquire(info->aid, NULL, NULL, NULL, &elem_len, NULL, NULL, NULL, NULL) == FAIL)
+            return NULL;
+        if ((buf = (uint8 *)malloc((size_t)len)) == NULL)
+            return NULL;
+        if (Hgetelement(deflate_info->file_id, DFTAG_CMPSEEK, info->comp_ref, buf) != len) {
+            free(buf);
+            return NULL;
+        } /* end if */
+
+        p = buf;
+        UINT16DECODE(p, version);
+        INT32DECODE(p, u_len);
+        INT32DECODE(p, c_len);
+        INT32DECODE(p, nseeks);
+        if (version != DEFLATE_SEEK_VERSION || u_len != info->length || c_len > elem_len || nseeks <= 0 ||
+            nseeks > (len - DEFLATE_SEEK_HDR_SIZE) / DEFLATE_SEEK_PT_SIZE) {
+            free(buf);
+            return NULL;
+        } /* end if */
+
+        for (i = 0; i < nseeks; i++) {
+            int32 u_off, c_off;
+
+            INT32DECODE(p, u_off);
+            INT32DECODE(p, c_off);
+            if (u_off <= u_prev || u_off > u_len || c_off <= c_prev || c_off > c_len ||
+                HCIcdeflate_add_seek(deflate_info, u_off, c_off) == FAIL) {
+                deflate_info->nseeks = 0;
+                break;
+            } /* end if */
+            u_prev = u_off;
+            c_prev = c_off;
+        } /* end for */
+        free(buf);
+    } /* end if */
+
+    /* binary search for the last seek point at or before the offset */
+    lo = 0;
+    hi = deflate_info->nseeks;
+    while (lo < hi) {
+        intn mid = (lo + hi) / 2;
+
+        if (deflate_info->seeks[mid].u_off <= offset)
+            lo = mid + 1;
+        else
+            hi = mid;
+    } /* end while */
+
+    return lo > 0 ? &deflate_info->seeks[lo - 1] : NULL;
+} /* end HCIcdeflate_seek_point() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPcdeflate_decode_buffer -- Inflate a whole deflate stream in memory
+
+ USAGE
+    intn HCPcdeflate_decode_buffer(src, src_len, dst, dst_len)
+    const uint8 *src;   IN: the compressed stream
+    int32 src_len;      IN: length of the compressed stream
+    uint8 *dst;         OUT: buffer for the decoded data
+    int32 dst_len;      IN: expected length of the decoded data
+
+ RETURNS
+    Returns SUCCEED if the stream inflated to exactly dst_len bytes, FAIL
+    otherwise
+
+ DESCRIPTION
+    The whole stream is inflated with a single inflate(Z_FINISH) call, or
+    by libdeflate when the library is built with it, which is faster for
+    whole buffers and falls back on zlib for anything it does not take.
+    Safe to call from worker threads: nothing is pushed on the error
+    stack.
+--------------------------------------------------------------------------*/
+intn
+HCPcdeflate_decode_buffer(const uint8 *src, int32 src_len, uint8 *dst, int32 dst_len)
+{
+    z_stream zs;
+    intn     ret_value = FAIL;
+
+#ifdef H4_HAVE_LIBDEFLATE
+    {
+        struct libdeflate_decompressor *d;
+        enum libdeflate_result          res = LIBDEFLATE_BAD_DATA;
+        size_t                          in_len, out_len;
+
+        if ((d = libdeflate_alloc_decompressor()) != NULL) {
+            /* the blocks of the element may hold bytes after the stream */
+            res = libdeflate_zlib_decompress_ex(d, src, (size_t)src_len, dst, (size_t)dst_len, &in_len,
+                                                &out_len);
+            libdeflate_free_decompressor(d);
+        }
+        if (res == LIBDEFLATE_SUCCESS && out_len == (size_t)dst_len)
+            return SUCCEED;
+    }
+#endif /* H4_HAVE_LIBDEFLATE */
+
+    memset(&zs, 0, sizeof(zs));
+    zs.next_in   = (Bytef *)src;
+    zs.avail_in  = (uInt)src_len;
+    zs.next_out  = dst;
+    zs.avail_out = (uInt)dst_len;
+    if (inflateInit(&zs) != Z_OK)
+        return FAIL;
+
+    if (inflate(&zs, Z_FINISH) == Z_STREAM_END && zs.total_out == (uLong)dst_len)
+        ret_value = SUCCEED;
+
+    inflateEnd(&zs);
+
+    return ret_value;
+} /* end HCPcdeflate_decode_buffer() */
+
 /*--------------------------------------------------------------------------
  NAME
     HCIcdeflate_init -- Initialize a gzip 'deflate' compressed data element.
@@ -137,8 +496,8 @@ HCIcdeflate_decode(compinfo_t *info, int32 length, uint8 *buf)
             int32 file_bytes;
 
             deflate_info->deflate_context.next_in = deflate_info->io_buf;
-            if ((file_bytes = Hread(info->aid, DEFLATE_BUF_SIZE, deflate_info->deflate_context.next_in)) ==
-                FAIL)
+            if ((file_bytes = Hread(info->aid, deflate_info->io_bufsize,
+                                    deflate_info->deflate_context.next_in)) == FAIL)
                 HRETURN_ERROR(DFE_READERROR, FAIL);
             deflate_info->deflate_context.avail_in = (uInt)file_bytes;
         } /* end if */
@@ -164,6 +523,156 @@ HCIcdeflate_decode(compinfo_t *info, int32 length, uint8 *buf)
     return bytes_read;
 } /* end HCIcdeflate_decode() */
 
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcdeflate_block_task -- Deflate one block of a write on a worker thread
+
+ USAGE
+    void HCIcdeflate_block_task(arg, task)
+    void *arg;          IN: the blocks of the write
+    int32 task;         IN: index of the block to deflate
+
+ DESCRIPTION
+    Task routine for htpool_run().  Deflates the block raw, with the bytes
+    before it as its dictionary, and ends it with a sync flush so that
+    the next block starts on a byte boundary.  Only touches its own block.
+--------------------------------------------------------------------------*/
+static void
+HCIcdeflate_block_task(void *arg, int32 task)
+{
+    deflate_block_t *blk = (deflate_block_t *)arg + task;
+    z_stream         zs;
+
+    blk->status = FAIL;
+    blk->adler  = adler32(adler32(0L, Z_NULL, 0), blk->in, (uInt)blk->in_len);
+
+    memset(&zs, 0, sizeof(zs));
+    if (deflateInit2(&zs, blk->level, Z_DEFLATED, -MAX_WBITS, DEFLATE_MEM_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK)
+        return;
+    if (blk->dict_len == 0 ||
+        deflateSetDictionary(&zs, blk->in - blk->dict_len, (uInt)blk->dict_len) == Z_OK) {
+        zs.next_in   = blk->in;
+        zs.avail_in  = (uInt)blk->in_len;
+        zs.next_out  = blk->out;
+        zs.avail_out = (uInt)blk->out_len;
+
+        /* the block is all out once deflate leaves room in the buffer */
+        if (deflate(&zs, Z_SYNC_FLUSH) == Z_OK && zs.avail_in == 0 && zs.avail_out > 0) {
+            blk->out_len = (int32)zs.total_out;
+            blk->status  = SUCCEED;
+        }
+    }
+    deflateEnd(&zs);
+} /* end HCIcdeflate_block_task() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcdeflate_encode_par -- Deflate a write that starts the stream on
+                              worker threads
+
+ USAGE
+    intn HCIcdeflate_encode_par(info,length,buf)
+    compinfo_t *info;   IN: the info about the compressed element
+    int32 length;       IN: number of bytes to store from the buffer
+    uint8 *buf;         IN: buffer to get the bytes from
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Writes the zlib header by hand and the DEFLATE_PAR_BLOCK byte blocks
+    of the write deflated on worker threads, see HCIcdeflate_block_task(),
+    a batch of them at a time, and combines their Adler-32s.  The
+    deflation context is then started again raw, with the end of the
+    write as its dictionary, for the rest of the stream, which
+    HCIcdeflate_term() ends with the Adler-32 of the data.
+--------------------------------------------------------------------------*/
+static intn
+HCIcdeflate_encode_par(compinfo_t *info, int32 length, uint8 *buf)
+{
+    comp_coder_deflate_info_t *deflate_info; /* ptr to deflate info */
+    deflate_block_t           *blocks = NULL;
+    uint8                      hdr[2];   /* zlib header, see RFC 1950 */
+    uint16                     zhdr;     /* the header as a number */
+    intn                       flevel;   /* compression level of the header */
+    intn                       nbatch;   /* most blocks deflated at once */
+    intn                       n;        /* blocks deflated in this batch */
+    int32                      room;     /* room for a deflated block */
+    int32                      posn;     /* offset of the next block in 'buf' */
+    int32                      dict_len; /* length of the final dictionary */
+    intn                       level;
+    intn                       i;
+    intn                       ret_value = SUCCEED;
+
+    deflate_info = &(info->cinfo.coder_info.deflate_info);
+    level        = deflate_info->deflate_level;
+
+    nbatch = deflate_info->nthreads * DEFLATE_PAR_PER_THREAD;
+    room   = (int32)compressBound((uLong)DEFLATE_PAR_BLOCK) + 16;
+    if ((blocks = (deflate_block_t *)calloc((size_t)nbatch, sizeof(deflate_block_t))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    for (i = 0; i < nbatch; i++)
+        if ((blocks[i].out = (uint8 *)malloc((size_t)room)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    /* the zlib header deflateInit() would have written */
+    flevel = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+    zhdr   = (uint16)(((Z_DEFLATED + ((MAX_WBITS - 8) << 4)) << 8) | (flevel << 6));
+    zhdr   = (uint16)(zhdr + 31 - zhdr % 31);
+    hdr[0] = (uint8)(zhdr >> 8);
+    hdr[1] = (uint8)(zhdr & 0xff);
+    if (Hwrite(info->aid, 2, hdr) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+    deflate_info->adler = adler32(0L, Z_NULL, 0);
+    for (posn = 0; posn < length;) {
+        for (n = 0; n < nbatch && posn < length; n++, posn += blocks[n - 1].in_len) {
+            blocks[n].in       = buf + posn;
+            blocks[n].in_len   = MIN(DEFLATE_PAR_BLOCK, length - posn);
+            blocks[n].dict_len = MIN(DEFLATE_PAR_DICT, posn);
+            blocks[n].out_len  = room;
+            blocks[n].level    = level;
+        } /* end for */
+
+        if (htpool_run(deflate_info->nthreads, (int32)n, HCIcdeflate_block_task, blocks) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+        for (i = 0; i < n; i++) {
+            if (blocks[i].status == FAIL)
+                HGOTO_ERROR(DFE_CENCODE, FAIL);
+            if (Hwrite(info->aid, blocks[i].out_len, blocks[i].out) == FAIL)
+                HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+            deflate_info->adler =
+                adler32_combine(deflate_info->adler, blocks[i].adler, (z_off_t)blocks[i].in_len);
+        } /* end for */
+    }     /* end for */
+
+    /* go on with the stream raw, from where the blocks left it */
+    dict_len = MIN(DEFLATE_PAR_DICT, length);
+    if (deflateEnd(&(deflate_info->deflate_context)) != Z_OK)
+        HGOTO_ERROR(DFE_CENCODE, FAIL);
+    if (deflateInit2(&(deflate_info->deflate_context), level, Z_DEFLATED, -MAX_WBITS, DEFLATE_MEM_LEVEL,
+                     Z_DEFAULT_STRATEGY) != Z_OK)
+        HGOTO_ERROR(DFE_CINIT, FAIL);
+    if (deflateSetDictionary(&(deflate_info->deflate_context), buf + length - dict_len, (uInt)dict_len) !=
+        Z_OK)
+        HGOTO_ERROR(DFE_CINIT, FAIL);
+    deflate_info->deflate_context.next_in   = NULL;
+    deflate_info->deflate_context.avail_in  = 0;
+    deflate_info->deflate_context.next_out  = deflate_info->io_buf;
+    deflate_info->deflate_context.avail_out = (uInt)deflate_info->io_bufsize;
+    deflate_info->raw_stream                = TRUE;
+    deflate_info->offset += length;
+
+done:
+    if (blocks != NULL)
+        for (i = 0; i < nbatch; i++)
+            free(blocks[i].out);
+    free(blocks);
+
+    return ret_value;
+} /* end HCIcdeflate_encode_par() */
+
 /*--------------------------------------------------------------------------
  NAME
     HCIcdeflate_encode -- Encode data from a buffer into gzip 'deflated'
@@ -190,29 +699,74 @@ static int32
 HCIcdeflate_encode(compinfo_t *info, int32 length, void *buf)
 {
     comp_coder_deflate_info_t *deflate_info; /* ptr to skipping Huffman info */
+    uint8                     *next = (uint8 *)buf;
+    int32                      left = length;
 
     deflate_info = &(info->cinfo.coder_info.deflate_info);
 
-    /* Set up the deflation buffers to point to the user's buffer to empty */
-    deflate_info->deflate_context.next_in  = buf;
-    deflate_info->deflate_context.avail_in = (uInt)length;
-    while (deflate_info->deflate_context.avail_in > 0 || deflate_info->deflate_context.avail_out == 0) {
-        /* Write more bytes from the file, if we've filled our buffer */
-        if (deflate_info->deflate_context.avail_out == 0) {
-            if (deflate_info->deflate_context.next_out != NULL) {
-                if (Hwrite(info->aid, DEFLATE_BUF_SIZE, deflate_info->io_buf) == FAIL)
-                    HRETURN_ERROR(DFE_WRITEERROR, FAIL);
+    /* a large write that starts the stream is deflated on worker threads */
+    if (deflate_info->nthreads > 1 && deflate_info->seek_interval == 0 && !deflate_info->raw_stream &&
+        deflate_info->deflate_context.total_in == 0 && length > DEFLATE_PAR_BLOCK) {
+        if (HCIcdeflate_encode_par(info, length, next) == FAIL)
+            HRETURN_ERROR(DFE_CENCODE, FAIL);
+        return length;
+    } /* end if */
+
+    /* the Adler-32 ending a raw stream */
+    if (deflate_info->raw_stream)
+        deflate_info->adler = adler32(deflate_info->adler, next, (uInt)length);
+
+    do {
+        int32 n = left; /* bytes to deflate before the next seek point */
+        int   flush;
+
+        if (deflate_info->seek_interval > 0 && n >= deflate_info->next_seek - deflate_info->offset)
+            n = deflate_info->next_seek - deflate_info->offset;
+        flush = (n > 0 && deflate_info->offset + n == deflate_info->next_seek) ? Z_FULL_FLUSH : Z_NO_FLUSH;
+
+        /* Set up the deflation buffers to point to the user's buffer to empty */
+        deflate_info->deflate_context.next_in  = next;
+        deflate_info->deflate_context.avail_in = (uInt)n;
+        while (deflate_info->deflate_context.avail_in > 0 || deflate_info->deflate_context.avail_out == 0 ||
+               flush == Z_FULL_FLUSH) {
+            int zstat;
+
+            /* Write more bytes from the file, if we've filled our buffer */
+            if (deflate_info->deflate_context.avail_out == 0) {
+                if (deflate_info->deflate_context.next_out != NULL) {
+                    if (Hwrite(info->aid, deflate_info->io_bufsize, deflate_info->io_buf) == FAIL)
+                        HRETURN_ERROR(DFE_WRITEERROR, FAIL);
+                }
+                deflate_info->deflate_context.next_out  = deflate_info->io_buf;
+                deflate_info->deflate_context.avail_out = (uInt)deflate_info->io_bufsize;
+            } /* end if */
+
+            /* break out if we've reached the end of the compressed data somehow */
+            zstat = deflate(&(deflate_info->deflate_context), flush);
+            if (zstat != Z_OK && !(zstat == Z_BUF_ERROR && flush == Z_FULL_FLUSH)) {
+                HRETURN_ERROR(DFE_CENCODE, FAIL);
             }
-            deflate_info->deflate_context.next_out  = deflate_info->io_buf;
-            deflate_info->deflate_context.avail_out = DEFLATE_BUF_SIZE;
-        } /* end if */
 
-        /* break out if we've reached the end of the compressed data somehow */
-        if (deflate(&(deflate_info->deflate_context), Z_NO_FLUSH) != Z_OK) {
-            HRETURN_ERROR(DFE_CENCODE, FAIL);
-        }
-    }                               /* end while */
-    deflate_info->offset += length; /* incr. abs. offset into the file */
+            /* the flush is done once deflate leaves room in the buffer */
+            if (flush == Z_FULL_FLUSH && deflate_info->deflate_context.avail_in == 0 &&
+                deflate_info->deflate_context.avail_out > 0)
+                break;
+        }                          /* end while */
+        deflate_info->offset += n; /* incr. abs. offset into the file */
+        next += n;
+        left -= n;
+
+        /* the stream can be inflated from here on without what came before */
+        if (flush == Z_FULL_FLUSH) {
+            if (HCIcdeflate_add_seek(deflate_info, deflate_info->offset,
+                                     (int32)deflate_info->deflate_context.total_out) == FAIL)
+                HRETURN_ERROR(DFE_NOSPACE, FAIL);
+            if (deflate_info->next_seek > INT32_MAX - deflate_info->seek_interval)
+                deflate_info->seek_interval = 0;
+            else
+                deflate_info->next_seek += deflate_info->seek_interval;
+        } /* end if */
+    } while (left > 0);
 
     return length;
 } /* end HCIcdeflate_encode() */
@@ -253,24 +807,41 @@ HCIcdeflate_term(compinfo_t *info, uint32 acc_mode)
             do {
                 /* Write more bytes from the file, if we've filled our buffer */
                 if (deflate_info->deflate_context.avail_out == 0) {
-                    if (Hwrite(info->aid, DEFLATE_BUF_SIZE, deflate_info->io_buf) == FAIL)
+                    if (Hwrite(info->aid, deflate_info->io_bufsize, deflate_info->io_buf) == FAIL)
                         HRETURN_ERROR(DFE_WRITEERROR, FAIL);
                     deflate_info->deflate_context.next_out  = deflate_info->io_buf;
-                    deflate_info->deflate_context.avail_out = DEFLATE_BUF_SIZE;
+                    deflate_info->deflate_context.avail_out = (uInt)deflate_info->io_bufsize;
                 } /* end if */
 
                 status = deflate(&(deflate_info->deflate_context), Z_FINISH);
             } while (status == Z_OK || deflate_info->deflate_context.avail_out == 0);
             if (status != Z_STREAM_END)
                 HRETURN_ERROR(DFE_CENCODE, FAIL);
-            if (deflate_info->deflate_context.avail_out < DEFLATE_BUF_SIZE)
-                if (Hwrite(info->aid, (int32)(DEFLATE_BUF_SIZE - deflate_info->deflate_context.avail_out),
+            if (deflate_info->deflate_context.avail_out < (uInt)deflate_info->io_bufsize)
+                if (Hwrite(info->aid,
+                           deflate_info->io_bufsize - (int32)deflate_info->deflate_context.avail_out,
                            deflate_info->io_buf) == FAIL)
                     HRETURN_ERROR(DFE_WRITEERROR, FAIL);
 
+            /* a raw stream ends with the Adler-32 deflate() would have written */
+            if (deflate_info->raw_stream) {
+                uint8  trailer[4];
+                uint8 *p = trailer;
+
+                UINT32ENCODE(p, (uint32)deflate_info->adler);
+                if (Hwrite(info->aid, 4, trailer) == FAIL)
+                    HRETURN_ERROR(DFE_WRITEERROR, FAIL);
+            } /* end if */
+
             /* Close down the deflation buffer */
             if (deflateEnd(&(deflate_info->deflate_context)) != Z_OK)
                 HRETURN_ERROR(DFE_CTERM, FAIL);
+
+            /* Store the seek points of the new stream */
+            if (HCIcdeflate_write_seeks(info) == FAIL)
+                HRETURN_ERROR(DFE_CTERM, FAIL);
+            deflate_info->nseeks       = 0;
+            deflate_info->seeks_loaded = FALSE;
         }      /* end if */
         else { /* finish up any inflated data */
             /* Close down the inflation buffer */
@@ -280,9 +851,10 @@ HCIcdeflate_term(compinfo_t *info, uint32 acc_mode)
     }     /* end if */
 
     /* Reset parameters */
-    deflate_info->offset   = 0; /* start at the beginning of the data */
-    deflate_info->acc_init = 0; /* second stage of initializing not performed */
-    deflate_info->acc_mode = 0; /* init access mode to illegal value */
+    deflate_info->offset     = 0;     /* start at the beginning of the data */
+    deflate_info->acc_init   = 0;     /* second stage of initializing not performed */
+    deflate_info->acc_mode   = 0;     /* init access mode to illegal value */
+    deflate_info->raw_stream = FALSE; /* the next stream gets its zlib header from deflate() */
 
     return SUCCEED;
 } /* end HCIcdeflate_term() */
@@ -336,10 +908,23 @@ HCIcdeflate_staccess(accrec_t *access_rec, int16 acc_mode)
     if (HCIcdeflate_init(info) == FAIL)
         HRETURN_ERROR(DFE_CODER, FAIL);
 
-    /* Allocate compression I/O buffer */
-    if ((deflate_info->io_buf = malloc(DEFLATE_BUF_SIZE)) == NULL)
+    /* Allocate compression I/O buffer, see HDF_CONFIG_DEFLATE_BUFSIZE */
+    if ((deflate_info->io_bufsize = HPgetconfig(HDF_CONFIG_DEFLATE_BUFSIZE)) == 0)
+        deflate_info->io_bufsize = DEFLATE_BUF_SIZE;
+    if ((deflate_info->io_buf = malloc((size_t)deflate_info->io_bufsize)) == NULL)
         HRETURN_ERROR(DFE_NOSPACE, FAIL);
 
+    /* The seek points are read in by the first seek */
+    deflate_info->file_id       = access_rec->file_id;
+    deflate_info->seek_interval = 0;
+    deflate_info->next_seek     = 0;
+    deflate_info->seeks_loaded  = FALSE;
+    deflate_info->nseeks        = 0;
+    deflate_info->max_seeks     = 0;
+    deflate_info->seeks         = NULL;
+    deflate_info->nthreads      = 1;
+    deflate_info->raw_stream    = FALSE;
+
     return SUCCEED;
 } /* end HCIcdeflate_staccess() */
 
@@ -384,6 +969,14 @@ HCIcdeflate_staccess2(accrec_t *access_rec, int16 acc_mode)
         /* force I/O with the file at first */
         deflate_info->deflate_context.next_out  = NULL;
         deflate_info->deflate_context.avail_out = 0;
+
+        /* the new stream gets its own seek points */
+        deflate_info->seek_interval = HCIdeflate_seek_interval;
+        deflate_info->next_seek     = HCIdeflate_seek_interval;
+        deflate_info->seeks_loaded  = TRUE;
+        deflate_info->nseeks        = 0;
+        deflate_info->nthreads      = HCIdeflate_threads;
+        deflate_info->raw_stream    = FALSE;
     } /* end if */
     else {
         if (inflateInit(&(deflate_info->deflate_context)) != Z_OK)
@@ -487,6 +1080,7 @@ HCPcdeflate_seek(accrec_t *access_rec, int32 offset, int origin)
 {
     compinfo_t                *info;             /* special element information */
     comp_coder_deflate_info_t *deflate_info;     /* ptr to gzip 'deflate' info */
+    const comp_deflate_seek_t *seek;             /* seek point to inflate from */
     uint8                     *tmp_buf   = NULL; /* temporary buffer */
     int32                      ret_value = SUCCEED;
 
@@ -501,7 +1095,25 @@ HCPcdeflate_seek(accrec_t *access_rec, int32 offset, int origin)
             HGOTO_ERROR(DFE_CINIT, FAIL);
     }
 
-    if (offset < deflate_info->offset) {
+    /* Start from the nearest seek point when it saves inflating data */
+    seek = deflate_info->acc_mode == DFACC_READ ? HCIcdeflate_seek_point(info, offset) : NULL;
+    if (seek != NULL && (offset < deflate_info->offset || seek->u_off > deflate_info->offset)) {
+        /* Terminate the previous method of access */
+        if (HCIcdeflate_term(info, deflate_info->acc_mode) == FAIL)
+            HGOTO_ERROR(DFE_CTERM, FAIL);
+
+        /* The data after a full flush is a raw deflate stream */
+        if (inflateInit2(&(deflate_info->deflate_context), -MAX_WBITS) != Z_OK)
+            HGOTO_ERROR(DFE_CINIT, FAIL);
+        deflate_info->acc_mode                 = DFACC_READ;
+        deflate_info->acc_init                 = DFACC_READ;
+        deflate_info->deflate_context.avail_in = 0;
+
+        if (Hseek(info->aid, seek->c_off, 0) == FAIL)
+            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+        deflate_info->offset = seek->u_off;
+    }
+    else if (offset < deflate_info->offset) {
 
         /* need to seek from the beginning */
 
@@ -727,8 +1339,9 @@ HCPcdeflate_endaccess(accrec_t *access_rec)
     if (HCIcdeflate_term(info, deflate_info->acc_mode) == FAIL)
         HRETURN_ERROR(DFE_CTERM, FAIL);
 
-    /* Get rid of the I/O buffer */
+    /* Get rid of the I/O buffer and the seek points */
     free(deflate_info->io_buf);
+    free(deflate_info->seeks);
 
     /* close the compressed data AID */
     if (Hendaccess(info->aid) == FAIL)
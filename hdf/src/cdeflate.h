@@ -27,14 +27,32 @@
 #include "zlib.h"
 #undef zintf
 
+/* A seek point of a deflate stream, see HCset_deflate_seek_interval() */
+typedef struct {
+    int32 u_off; /* offset in the de-compressed data */
+    int32 c_off; /* offset of the full flush point in the deflate stream */
+} comp_deflate_seek_t;
+
 /* gzip [en|de]coding information */
 typedef struct {
-    intn     deflate_level;   /* how hard to try to compress this data */
-    int32    offset;          /* offset in the de-compressed array */
-    intn     acc_init;        /* is access mode initialized? */
-    int16    acc_mode;        /* access mode desired */
-    void    *io_buf;          /* buffer for I/O with the file */
-    z_stream deflate_context; /* pointer to the deflation context for each byte in the element */
+    intn                 deflate_level;   /* how hard to try to compress this data */
+    int32                offset;          /* offset in the de-compressed array */
+    intn                 acc_init;        /* is access mode initialized? */
+    int16                acc_mode;        /* access mode desired */
+    void                *io_buf;          /* buffer for I/O with the file */
+    int32                io_bufsize;      /* size of 'io_buf' */
+    z_stream             deflate_context; /* pointer to the deflation context for each byte in the element */
+    int32                file_id;         /* file of the element, which holds its seek points */
+    int32                seek_interval;   /* bytes between the seek points written, 0 for none */
+    int32                next_seek;       /* offset of the next seek point written */
+    intn                 seeks_loaded;    /* are the seek points of the element read in? */
+    intn                 nseeks;          /* # of seek points */
+    intn                 max_seeks;       /* # of seek points allocated */
+    comp_deflate_seek_t *seeks;           /* the seek points, by increasing offset */
+    intn                 nthreads;        /* threads a large write is deflated on */
+    intn                 raw_stream;      /* TRUE once the zlib header was written by hand and the stream
+                                             deflated raw, to be ended by the Adler-32 of the data */
+    uLong                adler;           /* Adler-32 of the data of a raw stream */
 } comp_coder_deflate_info_t;
 
 #ifdef __cplusplus
@@ -63,6 +81,8 @@ HDFLIBAPI int32 HCPcdeflate_write(accrec_t *access_rec, int32 length, const void
 
 HDFLIBAPI intn HCPcdeflate_endaccess(accrec_t *access_rec);
 
+HDFLIBAPI intn HCPcdeflate_decode_buffer(const uint8 *src, int32 src_len, uint8 *dst, int32 dst_len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,713 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*
+   FILE
+   cjpeg.c
+   HDF JPEG encoding I/O routines for the tiles of chunked images
+
+   REMARKS
+   Each compressed element holds one JPEG image, the tile of a chunked GR
+   image, whose geometry is kept in the compression header.  A JPEG image
+   cannot be coded piecewise, so the tile is held de-compressed in memory:
+   it is decoded whole on the first read and encoded whole when the access
+   ends after a write.
+
+   DESIGN
+   Modeled on czstd.c.  The JPEG library is driven with memory source and
+   destination managers, and its errors come back through setjmp() rather
+   than exit(), so that HCPcjpeg_decode_buffer() can run on the worker
+   threads of the chunk layer.
+
+   EXPORTED ROUTINES
+   None of these routines are designed to be called by other users except
+   for the modeling layer of the compression routines.
+ */
+
+/* General HDF includes */
+#include "hdf.h"
+
+/* HDF compression includes */
+#include "hcompi.h" /* Internal definitions for compression */
+
+#include <setjmp.h>
+
+/* Hack to prevent libjpeg from re-defining `boolean` in a way that clashes
+ * with windows.h. This MUST come before including jpeglib.h.
+ */
+#ifdef H4_HAVE_WIN32_API
+#define HAVE_BOOLEAN
+#endif
+
+#include "jpeglib.h"
+#include "jerror.h"
+
+/* Smallest buffer the encoded tile is written into, it grows as needed */
+#define JPEG_MIN_BUF_SIZE 4096
+
+/* functions to perform JPEG encoding */
+funclist_t cjpeg_funcs = {HCPcjpeg_stread,
+                          HCPcjpeg_stwrite,
+                          HCPcjpeg_seek,
+                          HCPcjpeg_inquire,
+                          HCPcjpeg_read,
+                          HCPcjpeg_write,
+                          HCPcjpeg_endaccess,
+                          NULL,
+                          NULL};
+
+/* Error manager returning to the caller instead of exiting */
+typedef struct {
+    struct jpeg_error_mgr pub;  /* public fields */
+    jmp_buf               jump; /* where to go back to on an error */
+} cjpeg_error_mgr;
+
+/* Destination manager writing into a growing memory buffer */
+typedef struct {
+    struct jpeg_destination_mgr pub;  /* public fields */
+    JOCTET                     *buf;  /* start of the buffer */
+    size_t                      size; /* allocated size of the buffer */
+} cjpeg_dest_mgr;
+
+/* declaration of the functions provided in this module */
+static void    HCIcjpeg_error_exit(j_common_ptr cinfo);
+static void    HCIcjpeg_no_message(j_common_ptr cinfo);
+static void    HCIcjpeg_init_source(j_decompress_ptr cinfo);
+static boolean HCIcjpeg_fill_input(j_decompress_ptr cinfo);
+static void    HCIcjpeg_skip_input(j_decompress_ptr cinfo, long num_bytes);
+static void    HCIcjpeg_term_source(j_decompress_ptr cinfo);
+static void    HCIcjpeg_init_dest(j_compress_ptr cinfo);
+static boolean HCIcjpeg_empty_output(j_compress_ptr cinfo);
+static void    HCIcjpeg_term_dest(j_compress_ptr cinfo);
+
+/* Handlers for the JPEG library: errors jump back, messages are dropped */
+static void
+HCIcjpeg_error_exit(j_common_ptr cinfo)
+{
+    longjmp(((cjpeg_error_mgr *)cinfo->err)->jump, 1);
+}
+
+static void
+HCIcjpeg_no_message(j_common_ptr cinfo)
+{
+    (void)cinfo;
+}
+
+/* Memory source: the whole JPEG image is in the buffer from the start */
+static void
+HCIcjpeg_init_source(j_decompress_ptr cinfo)
+{
+    (void)cinfo;
+}
+
+static boolean
+HCIcjpeg_fill_input(j_decompress_ptr cinfo)
+{
+    static const JOCTET eoi[2] = {(JOCTET)0xFF, (JOCTET)JPEG_EOI};
+
+    /* the data ran out, end the image as the JPEG library does for files */
+    WARNMS(cinfo, JWRN_JPEG_EOF);
+    cinfo->src->next_input_byte = eoi;
+    cinfo->src->bytes_in_buffer = 2;
+
+    return TRUE;
+}
+
+static void
+HCIcjpeg_skip_input(j_decompress_ptr cinfo, long num_bytes)
+{
+    if (num_bytes <= 0)
+        return;
+    if ((size_t)num_bytes > cinfo->src->bytes_in_buffer)
+        (void)HCIcjpeg_fill_input(cinfo);
+    else {
+        cinfo->src->next_input_byte += num_bytes;
+        cinfo->src->bytes_in_buffer -= (size_t)num_bytes;
+    }
+}
+
+static void
+HCIcjpeg_term_source(j_decompress_ptr cinfo)
+{
+    (void)cinfo;
+}
+
+/* Memory destination: the buffer doubles whenever it fills up */
+static void
+HCIcjpeg_init_dest(j_compress_ptr cinfo)
+{
+    cjpeg_dest_mgr *dest = (cjpeg_dest_mgr *)cinfo->dest;
+
+    dest->pub.next_output_byte = dest->buf;
+    dest->pub.free_in_buffer   = dest->size;
+}
+
+static boolean
+HCIcjpeg_empty_output(j_compress_ptr cinfo)
+{
+    cjpeg_dest_mgr *dest = (cjpeg_dest_mgr *)cinfo->dest;
+    JOCTET         *buf;
+
+    if ((buf = (JOCTET *)realloc(dest->buf, dest->size * 2)) == NULL)
+        ERREXIT1(cinfo, JERR_OUT_OF_MEMORY, 0);
+    dest->pub.next_output_byte = buf + dest->size;
+    dest->pub.free_in_buffer   = dest->size;
+    dest->buf                  = buf;
+    dest->size *= 2;
+
+    return TRUE;
+}
+
+static void
+HCIcjpeg_term_dest(j_compress_ptr cinfo)
+{
+    (void)cinfo;
+}
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPcjpeg_decode_buffer -- Decode a JPEG image held in memory
+
+ USAGE
+    intn HCPcjpeg_decode_buffer(src,src_len,dst,dst_len)
+    const uint8 *src;   IN: the JPEG image
+    int32 src_len;      IN: number of bytes in the JPEG image
+    uint8 *dst;         OUT: buffer for the pixels
+    int32 dst_len;      IN: number of bytes of pixels expected
+
+ RETURNS
+    Returns SUCCEED if the image decoded to exactly 'dst_len' bytes, FAIL
+    otherwise
+
+ DESCRIPTION
+    Decodes a whole tile in one pass.  Nothing is pushed on the error
+    stack, so that the chunk layer may call this from worker threads.
+--------------------------------------------------------------------------*/
+intn
+HCPcjpeg_decode_buffer(const uint8 *src, int32 src_len, uint8 *dst, int32 dst_len)
+{
+    struct jpeg_decompress_struct cinfo;
+    cjpeg_error_mgr               jerr;
+    struct jpeg_source_mgr        source;
+    JSAMPROW *volatile            rows = NULL; /* start of each scanline in the tile */
+    size_t                        row_len;
+    JDIMENSION                    i;
+
+    if (src == NULL || src_len <= 0 || dst == NULL || dst_len <= 0)
+        return FAIL;
+
+    cinfo.err               = jpeg_std_error(&jerr.pub);
+    jerr.pub.error_exit     = HCIcjpeg_error_exit;
+    jerr.pub.output_message = HCIcjpeg_no_message;
+    if (setjmp(jerr.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        free(rows);
+        return FAIL;
+    }
+    jpeg_create_decompress(&cinfo);
+
+    source.init_source       = HCIcjpeg_init_source;
+    source.fill_input_buffer = HCIcjpeg_fill_input;
+    source.skip_input_data   = HCIcjpeg_skip_input;
+    source.resync_to_restart = jpeg_resync_to_restart;
+    source.term_source       = HCIcjpeg_term_source;
+    source.next_input_byte   = src;
+    source.bytes_in_buffer   = (size_t)src_len;
+    cinfo.src                = &source;
+
+    jpeg_read_header(&cinfo, TRUE);
+    jpeg_start_decompress(&cinfo);
+
+    /* the tile must fill the buffer exactly */
+    row_len = (size_t)cinfo.output_width * (size_t)cinfo.output_components;
+    if (row_len * cinfo.output_height != (size_t)dst_len)
+        longjmp(jerr.jump, 1);
+
+    if ((rows = (JSAMPROW *)malloc(cinfo.output_height * sizeof(JSAMPROW))) == NULL)
+        ERREXIT1(&cinfo, JERR_OUT_OF_MEMORY, 0);
+    for (i = 0; i < cinfo.output_height; i++)
+        rows[i] = dst + i * row_len;
+    while (cinfo.output_scanline < cinfo.output_height)
+        jpeg_read_scanlines(&cinfo, rows + cinfo.output_scanline, cinfo.output_height - cinfo.output_scanline);
+
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    free(rows);
+
+    return SUCCEED;
+} /* end HCPcjpeg_decode_buffer() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcjpeg_encode -- Encode the tile into a JPEG image in memory
+
+ USAGE
+    intn HCIcjpeg_encode(jpeg_info,dest)
+    comp_coder_jpeg_info_t *jpeg_info;  IN: the tile and its geometry
+    cjpeg_dest_mgr *dest;               IN/OUT: buffer for the JPEG image
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Compresses the whole tile in one pass.  On success dest->buf holds the
+    image, of dest->size minus dest->pub.free_in_buffer bytes.
+--------------------------------------------------------------------------*/
+static intn
+HCIcjpeg_encode(comp_coder_jpeg_info_t *jpeg_info, cjpeg_dest_mgr *dest)
+{
+    struct jpeg_compress_struct cinfo;
+    cjpeg_error_mgr             jerr;
+    JSAMPROW *volatile          rows = NULL; /* start of each scanline in the tile */
+    size_t                      row_len;
+    int32                       i;
+
+    cinfo.err               = jpeg_std_error(&jerr.pub);
+    jerr.pub.error_exit     = HCIcjpeg_error_exit;
+    jerr.pub.output_message = HCIcjpeg_no_message;
+    if (setjmp(jerr.jump)) {
+        jpeg_destroy_compress(&cinfo);
+        free(rows);
+        return FAIL;
+    }
+    jpeg_create_compress(&cinfo);
+
+    dest->pub.init_destination    = HCIcjpeg_init_dest;
+    dest->pub.empty_output_buffer = HCIcjpeg_empty_output;
+    dest->pub.term_destination    = HCIcjpeg_term_dest;
+    cinfo.dest                    = &dest->pub;
+
+    cinfo.image_width      = (JDIMENSION)jpeg_info->width;
+    cinfo.image_height     = (JDIMENSION)jpeg_info->height;
+    cinfo.input_components = jpeg_info->ncomps;
+    cinfo.in_color_space   = (jpeg_info->ncomps == 3) ? JCS_RGB : JCS_GRAYSCALE;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, jpeg_info->quality, jpeg_info->force_baseline);
+
+    row_len = (size_t)jpeg_info->width * (size_t)jpeg_info->ncomps;
+    if ((rows = (JSAMPROW *)malloc((size_t)jpeg_info->height * sizeof(JSAMPROW))) == NULL)
+        ERREXIT1(&cinfo, JERR_OUT_OF_MEMORY, 0);
+    for (i = 0; i < jpeg_info->height; i++)
+        rows[i] = jpeg_info->tile + (size_t)i * row_len;
+
+    jpeg_start_compress(&cinfo, TRUE);
+    while (cinfo.next_scanline < cinfo.image_height)
+        jpeg_write_scanlines(&cinfo, rows + cinfo.next_scanline, cinfo.image_height - cinfo.next_scanline);
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    free(rows);
+
+    return SUCCEED;
+} /* end HCIcjpeg_encode() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcjpeg_load -- Bring the tile into memory
+
+ USAGE
+    int32 HCIcjpeg_load(info)
+    compinfo_t *info;   IN: the info about the compressed element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Decodes the JPEG image of the element into the tile, or fills the
+    tile with zeros if nothing has been written to the element yet.  The
+    tile stays in memory until the access ends.
+--------------------------------------------------------------------------*/
+static int32
+HCIcjpeg_load(compinfo_t *info)
+{
+    comp_coder_jpeg_info_t *jpeg_info; /* ptr to JPEG info */
+    int32                   tile_len;
+    int32                   length;
+    uint8                  *raw       = NULL;
+    int32                   ret_value = SUCCEED;
+
+    jpeg_info = &(info->cinfo.coder_info.jpeg_info);
+    if (jpeg_info->tile != NULL)
+        HGOTO_DONE(SUCCEED);
+
+    tile_len = jpeg_info->width * jpeg_info->height * jpeg_info->ncomps;
+    if ((jpeg_info->tile = (uint8 *)calloc((size_t)tile_len, 1)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    if (Hinquire(info->aid, NULL, NULL, NULL, &length, NULL, NULL, NULL, NULL) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (length > 0) {
+        if ((raw = (uint8 *)malloc((size_t)length)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if (Hseek(info->aid, 0, 0) == FAIL)
+            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+        if (Hread(info->aid, length, raw) != length)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        if (HCPcjpeg_decode_buffer(raw, length, jpeg_info->tile, tile_len) == FAIL)
+            HGOTO_ERROR(DFE_CDECODE, FAIL);
+    } /* end if */
+    jpeg_info->acc_mode = DFACC_READ;
+
+done:
+    if (ret_value == FAIL) {
+        free(jpeg_info->tile);
+        jpeg_info->tile = NULL;
+    }
+    free(raw);
+
+    return ret_value;
+} /* end HCIcjpeg_load() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcjpeg_term -- Write the tile out if it was changed
+
+ USAGE
+    int32 HCIcjpeg_term(info)
+    compinfo_t *info;   IN: the info about the compressed element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Encodes a tile that was written to and writes the JPEG image over the
+    element, then releases the tile.
+--------------------------------------------------------------------------*/
+static int32
+HCIcjpeg_term(compinfo_t *info)
+{
+    comp_coder_jpeg_info_t *jpeg_info; /* ptr to JPEG info */
+    cjpeg_dest_mgr          dest;
+    int32                   length;
+    int32                   ret_value = SUCCEED;
+
+    jpeg_info = &(info->cinfo.coder_info.jpeg_info);
+    dest.buf  = NULL;
+
+    if (jpeg_info->acc_mode == DFACC_WRITE) {
+        dest.size = MAX(JPEG_MIN_BUF_SIZE, (size_t)jpeg_info->width * (size_t)jpeg_info->height *
+                                               (size_t)jpeg_info->ncomps / 4);
+        if ((dest.buf = (JOCTET *)malloc(dest.size)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if (HCIcjpeg_encode(jpeg_info, &dest) == FAIL)
+            HGOTO_ERROR(DFE_CENCODE, FAIL);
+        length = (int32)(dest.size - dest.pub.free_in_buffer);
+
+        if (Hseek(info->aid, 0, 0) == FAIL)
+            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+        if (Hwrite(info->aid, length, dest.buf) != length)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    } /* end if */
+
+done:
+    free(dest.buf);
+
+    /* Reset parameters */
+    free(jpeg_info->tile);
+    jpeg_info->tile     = NULL;
+    jpeg_info->offset   = 0; /* start at the beginning of the data */
+    jpeg_info->acc_mode = 0; /* init access mode to illegal value */
+
+    return ret_value;
+} /* end HCIcjpeg_term() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcjpeg_staccess -- Start accessing a JPEG compressed data element.
+
+ USAGE
+    int32 HCIcjpeg_staccess(access_rec, access)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int16 access;           IN: the type of access wanted
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Common code called by HCPcjpeg_stread and HCPcjpeg_stwrite
+--------------------------------------------------------------------------*/
+static int32
+HCIcjpeg_staccess(accrec_t *access_rec, int16 acc_mode)
+{
+    compinfo_t             *info;      /* special element information */
+    comp_coder_jpeg_info_t *jpeg_info; /* ptr to JPEG info */
+
+    info      = (compinfo_t *)access_rec->special_info;
+    jpeg_info = &(info->cinfo.coder_info.jpeg_info);
+
+    /* need to check for not writing, as opposed to read access */
+    /* because of the way the access works */
+    if (!(acc_mode & DFACC_WRITE)) {
+        info->aid = Hstartread(access_rec->file_id, DFTAG_COMPRESSED, info->comp_ref);
+    } /* end if */
+    else {
+        info->aid = Hstartaccess(access_rec->file_id, DFTAG_COMPRESSED, info->comp_ref,
+                                 DFACC_RDWR | DFACC_APPENDABLE);
+    } /* end else */
+    if (info->aid == FAIL)
+        HRETURN_ERROR(DFE_DENIED, FAIL);
+
+    /* Make certain we can append to the data when writing */
+    if ((acc_mode & DFACC_WRITE) && Happendable(info->aid) == FAIL)
+        HRETURN_ERROR(DFE_DENIED, FAIL);
+
+    /* the tile is brought in by the first read or write */
+    jpeg_info->offset   = 0;
+    jpeg_info->acc_mode = 0;
+    jpeg_info->tile     = NULL;
+
+    return SUCCEED;
+} /* end HCIcjpeg_staccess() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPcjpeg_stread -- start read access for compressed file
+
+ USAGE
+    int32 HCPcjpeg_stread(access_rec)
+    accrec_t *access_rec;   IN: the access record of the data element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Start read access on a compressed data element using the JPEG scheme.
+--------------------------------------------------------------------------*/
+int32
+HCPcjpeg_stread(accrec_t *access_rec)
+{
+    if (HCIcjpeg_staccess(access_rec, DFACC_READ) == FAIL)
+        HRETURN_ERROR(DFE_CINIT, FAIL);
+
+    return SUCCEED;
+} /* HCPcjpeg_stread() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPcjpeg_stwrite -- start write access for compressed file
+
+ USAGE
+    int32 HCPcjpeg_stwrite(access_rec)
+    accrec_t *access_rec;   IN: the access record of the data element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Start write access on a compressed data element using the JPEG scheme.
+--------------------------------------------------------------------------*/
+int32
+HCPcjpeg_stwrite(accrec_t *access_rec)
+{
+    if (HCIcjpeg_staccess(access_rec, DFACC_WRITE) == FAIL)
+        HRETURN_ERROR(DFE_CINIT, FAIL);
+
+    return SUCCEED;
+} /* HCPcjpeg_stwrite() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPcjpeg_seek -- Seek to offset within the data element
+
+ USAGE
+    int32 HCPcjpeg_seek(access_rec,offset,origin)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 offset;       IN: the offset in bytes from the origin specified
+    intn origin;        IN: the origin to seek from [UNUSED!]
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Seek to a position with a compressed data element.  The 'offset' is
+    an absolute offset in the tile, which is held whole in memory, so
+    seeking in either direction costs nothing.
+--------------------------------------------------------------------------*/
+int32
+HCPcjpeg_seek(accrec_t *access_rec, int32 offset, int origin)
+{
+    compinfo_t             *info;      /* special element information */
+    comp_coder_jpeg_info_t *jpeg_info; /* ptr to JPEG info */
+
+    (void)origin;
+
+    info      = (compinfo_t *)access_rec->special_info;
+    jpeg_info = &(info->cinfo.coder_info.jpeg_info);
+
+    if (offset < 0 || offset > jpeg_info->width * jpeg_info->height * jpeg_info->ncomps)
+        HRETURN_ERROR(DFE_RANGE, FAIL);
+    jpeg_info->offset = offset;
+
+    return SUCCEED;
+} /* HCPcjpeg_seek() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPcjpeg_read -- Read in a portion of data from a compressed data element.
+
+ USAGE
+    int32 HCPcjpeg_read(access_rec,length,data)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 length;           IN: the number of bytes to read
+    void * data;             OUT: the buffer to place the bytes read
+
+ RETURNS
+    Returns the number of bytes read or FAIL
+
+ DESCRIPTION
+    Read in a number of bytes from the JPEG compressed data element.
+--------------------------------------------------------------------------*/
+int32
+HCPcjpeg_read(accrec_t *access_rec, int32 length, void *data)
+{
+    compinfo_t             *info;      /* special element information */
+    comp_coder_jpeg_info_t *jpeg_info; /* ptr to JPEG info */
+    int32                   tile_len;
+
+    info      = (compinfo_t *)access_rec->special_info;
+    jpeg_info = &(info->cinfo.coder_info.jpeg_info);
+
+    if (HCIcjpeg_load(info) == FAIL)
+        HRETURN_ERROR(DFE_CDECODE, FAIL);
+
+    /* stop at the end of the tile */
+    tile_len = jpeg_info->width * jpeg_info->height * jpeg_info->ncomps;
+    if (length > tile_len - jpeg_info->offset)
+        length = tile_len - jpeg_info->offset;
+
+    memcpy(data, jpeg_info->tile + jpeg_info->offset, (size_t)length);
+    jpeg_info->offset += length;
+
+    return length;
+} /* HCPcjpeg_read() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPcjpeg_write -- Write out a portion of data from a compressed data element.
+
+ USAGE
+    int32 HCPcjpeg_write(access_rec,length,data)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 length;           IN: the number of bytes to write
+    void * data;             IN: the buffer to retrieve the bytes written
+
+ RETURNS
+    Returns the number of bytes written or FAIL
+
+ DESCRIPTION
+    Write out a number of bytes to the JPEG compressed data element.  The
+    bytes go into the tile in memory, anywhere in it; the tile is encoded
+    when the access ends.
+--------------------------------------------------------------------------*/
+int32
+HCPcjpeg_write(accrec_t *access_rec, int32 length, const void *data)
+{
+    compinfo_t             *info;      /* special element information */
+    comp_coder_jpeg_info_t *jpeg_info; /* ptr to JPEG info */
+    int32                   tile_len;
+
+    info      = (compinfo_t *)access_rec->special_info;
+    jpeg_info = &(info->cinfo.coder_info.jpeg_info);
+
+    tile_len = jpeg_info->width * jpeg_info->height * jpeg_info->ncomps;
+    if (length > tile_len - jpeg_info->offset)
+        HRETURN_ERROR(DFE_RANGE, FAIL);
+
+    /* a write of the whole tile needs nothing of the old one, otherwise
+       keep the pixels of the tile that this write does not cover */
+    if (jpeg_info->tile == NULL && length == tile_len) {
+        if ((jpeg_info->tile = (uint8 *)malloc((size_t)tile_len)) == NULL)
+            HRETURN_ERROR(DFE_NOSPACE, FAIL);
+    }
+    else if (HCIcjpeg_load(info) == FAIL)
+        HRETURN_ERROR(DFE_CDECODE, FAIL);
+
+    memcpy(jpeg_info->tile + jpeg_info->offset, data, (size_t)length);
+    jpeg_info->offset += length;
+    jpeg_info->acc_mode = DFACC_WRITE;
+
+    return length;
+} /* HCPcjpeg_write() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPcjpeg_inquire -- Inquire information about the access record and data element.
+
+ USAGE
+    int32 HCPcjpeg_inquire(access_rec,pfile_id,ptag,pref,plength,poffset,pposn,
+            paccess,pspecial)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 *pfile_id;        OUT: ptr to file id
+    uint16 *ptag;           OUT: ptr to tag of information
+    uint16 *pref;           OUT: ptr to ref of information
+    int32 *plength;         OUT: ptr to length of data element
+    int32 *poffset;         OUT: ptr to offset of data element
+    int32 *pposn;           OUT: ptr to position of access in element
+    int16 *paccess;         OUT: ptr to access mode
+    int16 *pspecial;        OUT: ptr to special code
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Inquire information about the access record and data element.
+    [Currently a NOP].
+--------------------------------------------------------------------------*/
+int32
+HCPcjpeg_inquire(accrec_t *access_rec, int32 *pfile_id, uint16 *ptag, uint16 *pref, int32 *plength,
+                 int32 *poffset, int32 *pposn, int16 *paccess, int16 *pspecial)
+{
+    (void)access_rec;
+    (void)pfile_id;
+    (void)ptag;
+    (void)pref;
+    (void)plength;
+    (void)poffset;
+    (void)pposn;
+    (void)paccess;
+    (void)pspecial;
+
+    return SUCCEED;
+} /* HCPcjpeg_inquire() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPcjpeg_endaccess -- Close the compressed data element
+
+ USAGE
+    int32 HCPcjpeg_endaccess(access_rec)
+    accrec_t *access_rec;   IN: the access record of the data element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Close the compressed data element, encoding the tile first if it was
+    written to.
+--------------------------------------------------------------------------*/
+intn
+HCPcjpeg_endaccess(accrec_t *access_rec)
+{
+    compinfo_t *info; /* special element information */
+
+    info = (compinfo_t *)access_rec->special_info;
+
+    /* flush out the tile */
+    if (HCIcjpeg_term(info) == FAIL)
+        HRETURN_ERROR(DFE_CTERM, FAIL);
+
+    /* close the compressed data AID */
+    if (Hendaccess(info->aid) == FAIL)
+        HRETURN_ERROR(DFE_CANTCLOSE, FAIL);
+
+    return SUCCEED;
+} /* HCPcjpeg_endaccess() */
@@ -0,0 +1,69 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*-----------------------------------------------------------------------------
+ * File:    cjpeg.h
+ * Purpose: Header file for JPEG encoding information of chunks.
+ * Dependencies: should only be included from hcompi.h
+ *---------------------------------------------------------------------------*/
+
+#ifndef H4_CJPEG_H
+#define H4_CJPEG_H
+
+#include "H4api_adpt.h"
+
+/* JPEG [en|de]coding information */
+typedef struct {
+    intn   quality;        /* quality factor for compression, 0 to 100 */
+    intn   force_baseline; /* limit the quantization tables to 0..255 */
+    int32  width;          /* pixels in a scanline of the tile */
+    int32  height;         /* scanlines in the tile */
+    intn   ncomps;         /* components of a pixel, 1 or 3 */
+    int32  offset;         /* offset in the de-compressed tile */
+    int16  acc_mode;       /* DFACC_WRITE once the tile has been written to */
+    uint8 *tile;           /* the whole de-compressed tile */
+} comp_coder_jpeg_info_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+HDFLIBAPI funclist_t cjpeg_funcs; /* functions to perform JPEG encoding */
+
+/*
+ ** from cjpeg.c
+ */
+
+HDFLIBAPI int32 HCPcjpeg_stread(accrec_t *rec);
+
+HDFLIBAPI int32 HCPcjpeg_stwrite(accrec_t *rec);
+
+HDFLIBAPI int32 HCPcjpeg_seek(accrec_t *access_rec, int32 offset, int origin);
+
+HDFLIBAPI int32 HCPcjpeg_inquire(accrec_t *access_rec, int32 *pfile_id, uint16 *ptag, uint16 *pref,
+                                 int32 *plength, int32 *poffset, int32 *pposn, int16 *paccess,
+                                 int16 *pspecial);
+
+HDFLIBAPI int32 HCPcjpeg_read(accrec_t *access_rec, int32 length, void *data);
+
+HDFLIBAPI int32 HCPcjpeg_write(accrec_t *access_rec, int32 length, const void *data);
+
+HDFLIBAPI intn HCPcjpeg_endaccess(accrec_t *access_rec);
+
+HDFLIBAPI intn HCPcjpeg_decode_buffer(const uint8 *src, int32 src_len, uint8 *dst, int32 dst_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H4_CJPEG_H */
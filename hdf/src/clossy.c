@@ -0,0 +1,910 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*
+   FILE
+   clossy.c
+   HDF error-bounded lossy encoding I/O routines
+
+   REMARKS
+   The lossy coder stores 32- and 64-bit floating-point data to within a
+   given error, the 'tolerance' of comp_info.lossy.  With H4_LOSSY_ABS no
+   value read back differs from the one written by more than the
+   tolerance, with H4_LOSSY_REL by more than the tolerance times the range
+   of the finite values of the element or chunk.  NaNs, infinities and
+   the values that cannot be brought within the error are stored exactly.
+
+   Each value is predicted by the one decoded before it, and the
+   difference is quantized to a multiple of twice the error bound.  The
+   quantization codes are written as variable-length integers, and they
+   are deflated together with the values stored exactly.  Smooth data
+   gives small codes that deflate well.
+
+   The element starts with a header of LOSSY_HDR_SIZE bytes: the format
+   version, the size of the values, the length of the data coded, the
+   error bound used, the length of the codes, the number of values stored
+   exactly and the length of the deflated data that follows.
+
+   DESIGN
+   Modeled on cplugin.c: the element is held de-compressed in memory, it
+   is decoded whole on the first read and encoded whole when the access
+   ends after a write.
+
+   EXPORTED ROUTINES
+   None of these routines are designed to be called by other users except
+   for the modeling layer of the compression routines and the chunk layer.
+ */
+
+/* General HDF includes */
+#include "hdf.h"
+
+/* HDF compression includes */
+#include "hcompi.h" /* Internal definitions for compression */
+
+#include <float.h>
+
+/* Version of the coded data written, and the size of its header */
+#define LOSSY_VERSION  1
+#define LOSSY_HDR_SIZE 26
+
+/* Quantization codes from this on are stored exactly instead */
+#define LOSSY_MAX_CODE 1073741824.0
+
+/* Largest number of bytes of a variable-length quantization code */
+#define LOSSY_MAX_VARINT 5
+
+/* functions to perform lossy encoding */
+funclist_t clossy_funcs = {HCPclossy_stread,
+                           HCPclossy_stwrite,
+                           HCPclossy_seek,
+                           HCPclossy_inquire,
+                           HCPclossy_read,
+                           HCPclossy_write,
+                           HCPclossy_endaccess,
+                           NULL,
+                           NULL};
+
+/* declaration of the functions provided in this module */
+static int32 HCIclossy_load(compinfo_t *info);
+static int32 HCIclossy_term(compinfo_t *info);
+static int32 HCIclossy_staccess(accrec_t *access_rec, int16 acc_mode);
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIlossy_swap -- Whether the values of an element are in the opposite
+                     byte order to the machine's
+
+ USAGE
+    intn HCIlossy_swap(nt)
+    int32 nt;           IN: the number type of the data
+--------------------------------------------------------------------------*/
+static intn
+HCIlossy_swap(int32 nt)
+{
+    intn little = (nt & DFNT_LITEND) ? TRUE : FALSE;
+
+#ifdef H4_WORDS_BIGENDIAN
+    if (nt & DFNT_NATIVE)
+        little = FALSE;
+    return little;
+#else
+    if (nt & DFNT_NATIVE)
+        little = TRUE;
+    return !little;
+#endif /* H4_WORDS_BIGENDIAN */
+} /* end HCIlossy_swap() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIlossy_copy -- Copy a value, reversing its bytes if asked
+--------------------------------------------------------------------------*/
+static void
+HCIlossy_copy(uint8 *dst, const uint8 *src, intn size, intn swap)
+{
+    intn i;
+
+    if (swap)
+        for (i = 0; i < size; i++)
+            dst[i] = src[size - 1 - i];
+    else
+        memcpy(dst, src, (size_t)size);
+} /* end HCIlossy_copy() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIlossy_get -- Get a value of the element as a float64
+--------------------------------------------------------------------------*/
+static float64
+HCIlossy_get(const uint8 *p, intn size, intn swap)
+{
+    uint8 v[8];
+
+    HCIlossy_copy(v, p, size, swap);
+    if (size == 4) {
+        float32 f;
+
+        memcpy(&f, v, sizeof(f));
+        return (float64)f;
+    }
+    else {
+        float64 d;
+
+        memcpy(&d, v, sizeof(d));
+        return d;
+    }
+} /* end HCIlossy_get() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIlossy_put -- Store a float64 as a value of the element
+--------------------------------------------------------------------------*/
+static void
+HCIlossy_put(uint8 *p, float64 d, intn size, intn swap)
+{
+    uint8 v[8];
+
+    if (size == 4) {
+        float32 f = (float32)d;
+
+        memcpy(v, &f, sizeof(f));
+    }
+    else
+        memcpy(v, &d, sizeof(d));
+    HCIlossy_copy(p, v, size, swap);
+} /* end HCIlossy_put() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIlossy_recon -- The value decoded for a quantization code
+
+ DESCRIPTION
+    The encoder checks the error of exactly the value the decoder gets, so
+    both compute it here.  The product goes through a volatile to keep the
+    compiler from fusing it with the sum on some machines only.
+--------------------------------------------------------------------------*/
+static float64
+HCIlossy_recon(float64 pred, float64 step, int32 q, intn size)
+{
+    volatile float64 r = step * (float64)q;
+
+    r = pred + r;
+    return size == 4 ? (float64)(float32)r : r;
+} /* end HCIlossy_recon() */
+
+/* Whether a value is neither a NaN nor an infinity */
+#define LOSSY_FINITE(d) ((d) >= -DBL_MAX && (d) <= DBL_MAX)
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPclossy_put_float64 -- Encode a float64 in big-endian IEEE format
+
+ DESCRIPTION
+    Used for the error bounds in the coded data and in the compression
+    header, 8 bytes at 'p'.
+--------------------------------------------------------------------------*/
+void
+HCPclossy_put_float64(uint8 *p, float64 d)
+{
+    uint8 v[8];
+
+    memcpy(v, &d, sizeof(d));
+#ifdef H4_WORDS_BIGENDIAN
+    HCIlossy_copy(p, v, 8, FALSE);
+#else
+    HCIlossy_copy(p, v, 8, TRUE);
+#endif /* H4_WORDS_BIGENDIAN */
+} /* end HCPclossy_put_float64() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPclossy_get_float64 -- Decode a float64 in big-endian IEEE format
+--------------------------------------------------------------------------*/
+float64
+HCPclossy_get_float64(const uint8 *p)
+{
+    uint8   v[8];
+    float64 d;
+
+#ifdef H4_WORDS_BIGENDIAN
+    HCIlossy_copy(v, p, 8, FALSE);
+#else
+    HCIlossy_copy(v, p, 8, TRUE);
+#endif /* H4_WORDS_BIGENDIAN */
+    memcpy(&d, v, sizeof(d));
+    return d;
+} /* end HCPclossy_get_float64() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPclossy_check_parms -- Check the parameters of the lossy coder
+
+ USAGE
+    intn HCPclossy_check_parms(c_info)
+    const comp_info *c_info;    IN: the parameters of the coder
+
+ RETURNS
+    Returns SUCCEED if the number type is a 32- or 64-bit float, the mode
+    is H4_LOSSY_ABS or H4_LOSSY_REL and the tolerance is finite and not
+    negative, FAIL otherwise.  Nothing is pushed on the error stack.
+--------------------------------------------------------------------------*/
+intn
+HCPclossy_check_parms(const comp_info *c_info)
+{
+    int32 nt = c_info->lossy.nt & ~(DFNT_NATIVE | DFNT_LITEND);
+
+    if (nt != DFNT_FLOAT32 && nt != DFNT_FLOAT64)
+        return FAIL;
+    if (c_info->lossy.mode != H4_LOSSY_ABS && c_info->lossy.mode != H4_LOSSY_REL)
+        return FAIL;
+    if (!LOSSY_FINITE(c_info->lossy.tolerance) || c_info->lossy.tolerance < 0.0)
+        return FAIL;
+
+    return SUCCEED;
+} /* end HCPclossy_check_parms() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIclossy_encode_buffer -- Encode a whole element held in memory
+
+ USAGE
+    intn HCIclossy_encode_buffer(c_info,src,src_len,pdst,pdst_len)
+    const comp_info *c_info;    IN: the parameters of the coder
+    const uint8 *src;           IN: the de-compressed element
+    int32 src_len;              IN: number of bytes in the element
+    uint8 **pdst;               OUT: the coded element, to be freed
+    int32 *pdst_len;            OUT: number of bytes of coded element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+--------------------------------------------------------------------------*/
+static intn
+HCIclossy_encode_buffer(const comp_info *c_info, const uint8 *src, int32 src_len, uint8 **pdst,
+                        int32 *pdst_len)
+{
+    intn    size = ((c_info->lossy.nt & ~(DFNT_NATIVE | DFNT_LITEND)) == DFNT_FLOAT32) ? 4 : 8;
+    intn    swap = HCIlossy_swap(c_info->lossy.nt);
+    int32   n    = src_len / size;
+    int32   tail = src_len % size;
+    uint8  *codes = NULL, *escs = NULL, *dst = NULL;
+    uint8  *cp, *ep, *p;
+    float64 eb, step, pred = 0.0;
+    uLongf  zlen;
+    int32   i, nesc = 0;
+    intn    ret_value = SUCCEED;
+
+    /* the error bound of this element */
+    eb = c_info->lossy.tolerance;
+    if (c_info->lossy.mode == H4_LOSSY_REL) {
+        float64 lo = 0.0, hi = 0.0;
+        intn    any = FALSE;
+
+        for (i = 0; i < n; i++) {
+            float64 x = HCIlossy_get(src + i * size, size, swap);
+
+            if (!LOSSY_FINITE(x))
+                continue;
+            if (!any || x < lo)
+                lo = x;
+            if (!any || x > hi)
+                hi = x;
+            any = TRUE;
+        }
+        eb = LOSSY_FINITE(hi - lo) ? eb * (hi - lo) : 0.0;
+    }
+    step = 2.0 * eb;
+    if (!LOSSY_FINITE(step))
+        eb = step = 0.0;
+
+    if ((codes = (uint8 *)malloc((size_t)n * LOSSY_MAX_VARINT + 1)) == NULL ||
+        (escs = (uint8 *)malloc((size_t)src_len + 1)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    cp = codes;
+    ep = escs;
+    for (i = 0; i < n; i++) {
+        const uint8 *v = src + i * size;
+        float64      x = HCIlossy_get(v, size, swap);
+        uint32       code = 0;
+
+        if (step > 0.0 && LOSSY_FINITE(x)) {
+            float64 qd = (x - pred) / step;
+
+            if (qd > -LOSSY_MAX_CODE && qd < LOSSY_MAX_CODE) {
+                int32   q = (int32)(qd >= 0.0 ? qd + 0.5 : qd - 0.5);
+                float64 r = HCIlossy_recon(pred, step, q, size);
+                float64 err = x > r ? x - r : r - x;
+
+                if (err <= eb) {
+                    code = ((uint32)q << 1 ^ (uint32)(q >> 31)) + 1;
+                    pred = r;
+                }
+            }
+        }
+        else if (step <= 0.0 && LOSSY_FINITE(x) && !(x < pred || x > pred))
+            code = 1;
+
+        if (code == 0) {
+            /* stored exactly, in the byte order of the element */
+            memcpy(ep, v, (size_t)size);
+            ep += size;
+            nesc++;
+            if (LOSSY_FINITE(x))
+                pred = HCIlossy_get(v, size, swap);
+        }
+
+        while (code >= 0x80) {
+            *cp++ = (uint8)(code | 0x80);
+            code >>= 7;
+        }
+        *cp++ = (uint8)code;
+    }
+
+    /* the bytes of a partial value are stored as they are */
+    memcpy(ep, src + n * size, (size_t)tail);
+    ep += tail;
+
+    /* deflate the codes followed by the values stored exactly */
+    {
+        int32  code_len  = (int32)(cp - codes);
+        int32  plain_len = code_len + (int32)(ep - escs);
+        uint8 *plain;
+
+        if ((plain = (uint8 *)malloc((size_t)plain_len + 1)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        memcpy(plain, codes, (size_t)code_len);
+        memcpy(plain + code_len, escs, (size_t)(ep - escs));
+
+        zlen = compressBound((uLong)plain_len);
+        if ((dst = (uint8 *)malloc((size_t)zlen + LOSSY_HDR_SIZE)) == NULL) {
+            free(plain);
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        }
+        if (compress2(dst + LOSSY_HDR_SIZE, &zlen, plain, (uLong)plain_len, Z_DEFAULT_COMPRESSION) != Z_OK) {
+            free(plain);
+            HGOTO_ERROR(DFE_CENCODE, FAIL);
+        }
+        free(plain);
+
+        p = dst;
+        *p++ = LOSSY_VERSION;
+        *p++ = (uint8)size;
+        INT32ENCODE(p, src_len);
+        HCPclossy_put_float64(p, eb);
+        p += 8;
+        INT32ENCODE(p, code_len);
+        INT32ENCODE(p, nesc);
+        INT32ENCODE(p, (int32)zlen);
+    }
+
+    *pdst     = dst;
+    *pdst_len = (int32)zlen + LOSSY_HDR_SIZE;
+    dst       = NULL;
+
+done:
+    free(codes);
+    free(escs);
+    free(dst);
+
+    return ret_value;
+} /* end HCIclossy_encode_buffer() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPclossy_decode_buffer -- Decode a whole element held in memory
+
+ USAGE
+    intn HCPclossy_decode_buffer(c_info,src,src_len,dst,dst_len)
+    const comp_info *c_info;    IN: the parameters of the coder
+    const uint8 *src;           IN: the compressed element
+    int32 src_len;              IN: number of bytes in the compressed element
+    uint8 *dst;                 OUT: buffer for the de-compressed element
+    int32 dst_len;              IN: number of bytes of de-compressed data
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Decodes a whole element or chunk, the bytes of 'dst' past the data
+    coded are zeroed.  Nothing is pushed on the error stack, so that the
+    chunk layer may call this from worker threads.
+--------------------------------------------------------------------------*/
+intn
+HCPclossy_decode_buffer(const comp_info *c_info, const uint8 *src, int32 src_len, uint8 *dst, int32 dst_len)
+{
+    intn         size = ((c_info->lossy.nt & ~(DFNT_NATIVE | DFNT_LITEND)) == DFNT_FLOAT32) ? 4 : 8;
+    intn         swap = HCIlossy_swap(c_info->lossy.nt);
+    const uint8 *p    = src;
+    uint8       *plain = NULL;
+    const uint8 *cp, *cend, *ep;
+    int32        len, code_len, nesc, zlen, n, tail, i;
+    float64      eb, step, pred = 0.0;
+    uLongf       plain_len;
+    intn         ret_value = FAIL;
+
+    if (src_len < LOSSY_HDR_SIZE || p[0] != LOSSY_VERSION || p[1] != size)
+        return FAIL;
+    p += 2;
+    INT32DECODE(p, len);
+    eb = HCPclossy_get_float64(p);
+    p += 8;
+    INT32DECODE(p, code_len);
+    INT32DECODE(p, nesc);
+    INT32DECODE(p, zlen);
+    n    = len / size;
+    tail = len % size;
+    if (len < 0 || len > dst_len || code_len < n || nesc < 0 || nesc > n || zlen < 0 ||
+        zlen > src_len - LOSSY_HDR_SIZE || !LOSSY_FINITE(eb) || eb < 0.0)
+        return FAIL;
+    step = 2.0 * eb;
+
+    /* inflate the codes and the values stored exactly */
+    plain_len = (uLongf)code_len + (uLongf)nesc * (uLongf)size + (uLongf)tail;
+    if ((plain = (uint8 *)malloc((size_t)plain_len + 1)) == NULL)
+        return FAIL;
+    {
+        uLongf got = plain_len;
+
+        if (uncompress(plain, &got, p, (uLong)zlen) != Z_OK || got != plain_len)
+            goto done;
+    }
+
+    cp   = plain;
+    cend = plain + code_len;
+    ep   = cend;
+    for (i = 0; i < n; i++) {
+        uint32 code  = 0;
+        intn   shift = 0;
+
+        do {
+            if (cp == cend || shift > 28)
+                goto done;
+            code |= (uint32)(*cp & 0x7f) << shift;
+            shift += 7;
+        } while (*cp++ & 0x80);
+
+        if (code == 0) {
+            float64 x;
+
+            if (ep + size > plain + plain_len - tail)
+                goto done;
+            memcpy(dst + i * size, ep, (size_t)size);
+            x = HCIlossy_get(ep, size, swap);
+            if (LOSSY_FINITE(x))
+                pred = x;
+            ep += size;
+        }
+        else {
+            uint32 z = code - 1;
+            int32  q = (int32)(z >> 1) ^ -(int32)(z & 1);
+
+            pred = HCIlossy_recon(pred, step, q, size);
+            HCIlossy_put(dst + i * size, pred, size, swap);
+        }
+    }
+    if (cp != cend)
+        goto done;
+
+    memcpy(dst + n * size, plain + plain_len - tail, (size_t)tail);
+    if (len < dst_len)
+        memset(dst + len, 0, (size_t)(dst_len - len));
+    ret_value = SUCCEED;
+
+done:
+    free(plain);
+
+    return ret_value;
+} /* end HCPclossy_decode_buffer() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIclossy_load -- Bring the element into memory
+
+ USAGE
+    int32 HCIclossy_load(info)
+    compinfo_t *info;   IN: the info about the compressed element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Reads and decodes the whole element, once.
+--------------------------------------------------------------------------*/
+static int32
+HCIclossy_load(compinfo_t *info)
+{
+    comp_coder_lossy_info_t *lossy_info; /* ptr to lossy info */
+    int32                    length;
+    uint8                   *raw       = NULL;
+    int32                    ret_value = SUCCEED;
+
+    lossy_info = &(info->cinfo.coder_info.lossy_info);
+    if (lossy_info->buf != NULL)
+        HGOTO_DONE(SUCCEED);
+
+    lossy_info->size  = info->length;
+    lossy_info->alloc = MAX(info->length, 1);
+    if ((lossy_info->buf = (uint8 *)calloc((size_t)lossy_info->alloc, 1)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    if (Hinquire(info->aid, NULL, NULL, NULL, &length, NULL, NULL, NULL, NULL) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (length > 0) {
+        if ((raw = (uint8 *)malloc((size_t)length)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if (Hseek(info->aid, 0, 0) == FAIL)
+            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+        if (Hread(info->aid, length, raw) != length)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        if (HCPclossy_decode_buffer(&lossy_info->c_info, raw, length, lossy_info->buf, lossy_info->size) ==
+            FAIL)
+            HGOTO_ERROR(DFE_CDECODE, FAIL);
+    } /* end if */
+    lossy_info->acc_mode = DFACC_READ;
+
+done:
+    if (ret_value == FAIL) {
+        free(lossy_info->buf);
+        lossy_info->buf = NULL;
+    }
+    free(raw);
+
+    return ret_value;
+} /* end HCIclossy_load() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIclossy_term -- Write the element out if it was changed
+
+ USAGE
+    int32 HCIclossy_term(info)
+    compinfo_t *info;   IN: the info about the compressed element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Encodes an element that was written to and writes it over the old one,
+    then releases the de-compressed data.
+--------------------------------------------------------------------------*/
+static int32
+HCIclossy_term(compinfo_t *info)
+{
+    comp_coder_lossy_info_t *lossy_info; /* ptr to lossy info */
+    uint8                   *coded = NULL;
+    int32                    length;
+    int32                    ret_value = SUCCEED;
+
+    lossy_info = &(info->cinfo.coder_info.lossy_info);
+
+    if (lossy_info->acc_mode == DFACC_WRITE) {
+        if (HCIclossy_encode_buffer(&lossy_info->c_info, lossy_info->buf, lossy_info->size, &coded, &length) ==
+            FAIL)
+            HGOTO_ERROR(DFE_CENCODE, FAIL);
+
+        if (Hseek(info->aid, 0, 0) == FAIL)
+            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+        if (Hwrite(info->aid, length, coded) != length)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    } /* end if */
+
+done:
+    free(coded);
+
+    /* Reset parameters */
+    free(lossy_info->buf);
+    lossy_info->buf      = NULL;
+    lossy_info->offset   = 0; /* start at the beginning of the data */
+    lossy_info->acc_mode = 0; /* init access mode to illegal value */
+
+    return ret_value;
+} /* end HCIclossy_term() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIclossy_staccess -- Start accessing a lossy compressed data element.
+
+ USAGE
+    int32 HCIclossy_staccess(access_rec, access)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int16 access;           IN: the type of access wanted
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Common code called by HCPclossy_stread and HCPclossy_stwrite
+--------------------------------------------------------------------------*/
+static int32
+HCIclossy_staccess(accrec_t *access_rec, int16 acc_mode)
+{
+    compinfo_t              *info;       /* special element information */
+    comp_coder_lossy_info_t *lossy_info; /* ptr to lossy info */
+
+    info       = (compinfo_t *)access_rec->special_info;
+    lossy_info = &(info->cinfo.coder_info.lossy_info);
+
+    /* need to check for not writing, as opposed to read access */
+    /* because of the way the access works */
+    if (!(acc_mode & DFACC_WRITE)) {
+        info->aid = Hstartread(access_rec->file_id, DFTAG_COMPRESSED, info->comp_ref);
+    } /* end if */
+    else {
+        info->aid = Hstartaccess(access_rec->file_id, DFTAG_COMPRESSED, info->comp_ref,
+                                 DFACC_RDWR | DFACC_APPENDABLE);
+    } /* end else */
+    if (info->aid == FAIL)
+        HRETURN_ERROR(DFE_DENIED, FAIL);
+
+    /* Make certain we can append to the data when writing */
+    if ((acc_mode & DFACC_WRITE) && Happendable(info->aid) == FAIL)
+        HRETURN_ERROR(DFE_DENIED, FAIL);
+
+    /* the data is brought in by the first read or write */
+    lossy_info->offset   = 0;
+    lossy_info->size     = 0;
+    lossy_info->alloc    = 0;
+    lossy_info->acc_mode = 0;
+    lossy_info->buf      = NULL;
+
+    return SUCCEED;
+} /* end HCIclossy_staccess() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPclossy_stread -- start read access for compressed file
+
+ USAGE
+    int32 HCPclossy_stread(access_rec)
+    accrec_t *access_rec;   IN: the access record of the data element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Start read access on a compressed data element using the lossy coder.
+--------------------------------------------------------------------------*/
+int32
+HCPclossy_stread(accrec_t *access_rec)
+{
+    if (HCIclossy_staccess(access_rec, DFACC_READ) == FAIL)
+        HRETURN_ERROR(DFE_CINIT, FAIL);
+
+    return SUCCEED;
+} /* HCPclossy_stread() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPclossy_stwrite -- start write access for compressed file
+
+ USAGE
+    int32 HCPclossy_stwrite(access_rec)
+    accrec_t *access_rec;   IN: the access record of the data element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Start write access on a compressed data element using the lossy coder.
+--------------------------------------------------------------------------*/
+int32
+HCPclossy_stwrite(accrec_t *access_rec)
+{
+    if (HCIclossy_staccess(access_rec, DFACC_WRITE) == FAIL)
+        HRETURN_ERROR(DFE_CINIT, FAIL);
+
+    return SUCCEED;
+} /* HCPclossy_stwrite() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPclossy_seek -- Seek to offset within the data element
+
+ USAGE
+    int32 HCPclossy_seek(access_rec,offset,origin)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 offset;       IN: the offset in bytes from the origin specified
+    intn origin;        IN: the origin to seek from [UNUSED!]
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Seek to a position with a compressed data element.  The 'offset' is
+    an absolute offset in the element, which is held whole in memory, so
+    seeking in either direction costs nothing.
+--------------------------------------------------------------------------*/
+int32
+HCPclossy_seek(accrec_t *access_rec, int32 offset, int origin)
+{
+    compinfo_t              *info;       /* special element information */
+    comp_coder_lossy_info_t *lossy_info; /* ptr to lossy info */
+
+    (void)origin;
+
+    info       = (compinfo_t *)access_rec->special_info;
+    lossy_info = &(info->cinfo.coder_info.lossy_info);
+
+    if (offset < 0)
+        HRETURN_ERROR(DFE_RANGE, FAIL);
+    lossy_info->offset = offset;
+
+    return SUCCEED;
+} /* HCPclossy_seek() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPclossy_read -- Read in a portion of data from a compressed data element.
+
+ USAGE
+    int32 HCPclossy_read(access_rec,length,data)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 length;           IN: the number of bytes to read
+    void * data;             OUT: the buffer to place the bytes read
+
+ RETURNS
+    Returns the number of bytes read or FAIL
+
+ DESCRIPTION
+    Read in a number of bytes from the lossy compressed data element.
+--------------------------------------------------------------------------*/
+int32
+HCPclossy_read(accrec_t *access_rec, int32 length, void *data)
+{
+    compinfo_t              *info;       /* special element information */
+    comp_coder_lossy_info_t *lossy_info; /* ptr to lossy info */
+
+    info       = (compinfo_t *)access_rec->special_info;
+    lossy_info = &(info->cinfo.coder_info.lossy_info);
+
+    if (HCIclossy_load(info) == FAIL)
+        HRETURN_ERROR(DFE_CDECODE, FAIL);
+
+    /* stop at the end of the element */
+    if (length > lossy_info->size - lossy_info->offset)
+        length = MAX(lossy_info->size - lossy_info->offset, 0);
+
+    memcpy(data, lossy_info->buf + lossy_info->offset, (size_t)length);
+    lossy_info->offset += length;
+
+    return length;
+} /* HCPclossy_read() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPclossy_write -- Write out a portion of data from a compressed data element.
+
+ USAGE
+    int32 HCPclossy_write(access_rec,length,data)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 length;           IN: the number of bytes to write
+    void * data;             IN: the buffer to retrieve the bytes written
+
+ RETURNS
+    Returns the number of bytes written or FAIL
+
+ DESCRIPTION
+    Write out a number of bytes to the lossy compressed data element.  The
+    bytes go into the element in memory, which grows as needed; it is
+    encoded when the access ends.
+--------------------------------------------------------------------------*/
+int32
+HCPclossy_write(accrec_t *access_rec, int32 length, const void *data)
+{
+    compinfo_t              *info;       /* special element information */
+    comp_coder_lossy_info_t *lossy_info; /* ptr to lossy info */
+    int32                    end;
+
+    info       = (compinfo_t *)access_rec->special_info;
+    lossy_info = &(info->cinfo.coder_info.lossy_info);
+
+    /* a write of the whole element needs nothing of the old one, otherwise
+       keep the bytes that this write does not cover */
+    if (lossy_info->buf != NULL || lossy_info->offset != 0 || length < info->length)
+        if (HCIclossy_load(info) == FAIL)
+            HRETURN_ERROR(DFE_CDECODE, FAIL);
+
+    end = lossy_info->offset + length;
+    if (end > lossy_info->alloc) {
+        int32  alloc = MAX(end, 2 * lossy_info->alloc);
+        uint8 *buf;
+
+        if ((buf = (uint8 *)realloc(lossy_info->buf, (size_t)alloc)) == NULL)
+            HRETURN_ERROR(DFE_NOSPACE, FAIL);
+        lossy_info->buf   = buf;
+        lossy_info->alloc = alloc;
+    }
+    if (lossy_info->offset > lossy_info->size)
+        memset(lossy_info->buf + lossy_info->size, 0, (size_t)(lossy_info->offset - lossy_info->size));
+
+    memcpy(lossy_info->buf + lossy_info->offset, data, (size_t)length);
+    lossy_info->offset = end;
+    if (end > lossy_info->size)
+        lossy_info->size = end;
+    lossy_info->acc_mode = DFACC_WRITE;
+
+    return length;
+} /* HCPclossy_write() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPclossy_inquire -- Inquire information about the access record and data element.
+
+ USAGE
+    int32 HCPclossy_inquire(access_rec,pfile_id,ptag,pref,plength,poffset,pposn,
+            paccess,pspecial)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 *pfile_id;        OUT: ptr to file id
+    uint16 *ptag;           OUT: ptr to tag of information
+    uint16 *pref;           OUT: ptr to ref of information
+    int32 *plength;         OUT: ptr to length of data element
+    int32 *poffset;         OUT: ptr to offset of data element
+    int32 *pposn;           OUT: ptr to position of access in element
+    int16 *paccess;         OUT: ptr to access mode
+    int16 *pspecial;        OUT: ptr to special code
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Inquire information about the access record and data element.
+    [Currently a NOP].
+--------------------------------------------------------------------------*/
+int32
+HCPclossy_inquire(accrec_t *access_rec, int32 *pfile_id, uint16 *ptag, uint16 *pref, int32 *plength,
+                  int32 *poffset, int32 *pposn, int16 *paccess, int16 *pspecial)
+{
+    (void)access_rec;
+    (void)pfile_id;
+    (void)ptag;
+    (void)pref;
+    (void)plength;
+    (void)poffset;
+    (void)pposn;
+    (void)paccess;
+    (void)pspecial;
+
+    return SUCCEED;
+} /* HCPclossy_inquire() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPclossy_endaccess -- Close the compressed data element
+
+ USAGE
+    int32 HCPclossy_endaccess(access_rec)
+    accrec_t *access_rec;   IN: the access record of the data element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Close the compressed data element, encoding it first if it was
+    written to.
+--------------------------------------------------------------------------*/
+intn
+HCPclossy_endaccess(accrec_t *access_rec)
+{
+    compinfo_t *info; /* special element information */
+
+    info = (compinfo_t *)access_rec->special_info;
+
+    /* flush out the element */
+    if (HCIclossy_term(info) == FAIL)
+        HRETURN_ERROR(DFE_CTERM, FAIL);
+
+    /* close the compressed data AID */
+    if (Hendaccess(info->aid) == FAIL)
+        HRETURN_ERROR(DFE_CANTCLOSE, FAIL);
+
+    return SUCCEED;
+} /* HCPclossy_endaccess() */
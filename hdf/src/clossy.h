@@ -0,0 +1,72 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*-----------------------------------------------------------------------------
+ * File:    clossy.h
+ * Purpose: Header file for error-bounded lossy encoding information.
+ * Dependencies: should only be included from hcompi.h
+ *---------------------------------------------------------------------------*/
+
+#ifndef H4_CLOSSY_H
+#define H4_CLOSSY_H
+
+#include "H4api_adpt.h"
+
+/* Error-bounded lossy [en|de]coding information */
+typedef struct {
+    comp_info c_info;   /* the parameters of the element */
+    int32     offset;   /* offset in the de-compressed data */
+    int32     size;     /* bytes of de-compressed data held */
+    int32     alloc;    /* bytes allocated for 'buf' */
+    int16     acc_mode; /* DFACC_WRITE once the data has been written to */
+    uint8    *buf;      /* the whole de-compressed element */
+} comp_coder_lossy_info_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+HDFLIBAPI funclist_t clossy_funcs; /* functions to perform lossy encoding */
+
+/*
+ ** from clossy.c
+ */
+
+HDFLIBAPI int32 HCPclossy_stread(accrec_t *rec);
+
+HDFLIBAPI int32 HCPclossy_stwrite(accrec_t *rec);
+
+HDFLIBAPI int32 HCPclossy_seek(accrec_t *access_rec, int32 offset, int origin);
+
+HDFLIBAPI int32 HCPclossy_inquire(accrec_t *access_rec, int32 *pfile_id, uint16 *ptag, uint16 *pref,
+                                  int32 *plength, int32 *poffset, int32 *pposn, int16 *paccess,
+                                  int16 *pspecial);
+
+HDFLIBAPI int32 HCPclossy_read(accrec_t *access_rec, int32 length, void *data);
+
+HDFLIBAPI int32 HCPclossy_write(accrec_t *access_rec, int32 length, const void *data);
+
+HDFLIBAPI intn HCPclossy_endaccess(accrec_t *access_rec);
+
+HDFLIBAPI void HCPclossy_put_float64(uint8 *p, float64 d);
+
+HDFLIBAPI float64 HCPclossy_get_float64(const uint8 *p);
+
+HDFLIBAPI intn HCPclossy_decode_buffer(const comp_info *c_info, const uint8 *src, int32 src_len, uint8 *dst,
+                                       int32 dst_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H4_CLOSSY_H */
@@ -0,0 +1,787 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*
+   FILE
+   clz4.c
+   HDF LZ4 encoding I/O routines
+
+   REMARKS
+   Each compressed element holds a single LZ4 frame.  The frame is written
+   and read piecewise with the LZ4 frame interface like the other coders,
+   and can also be decoded in a single call by HCPclz4_decode_frame(),
+   which the chunked elements use to page in whole chunks quickly.
+
+   DESIGN
+   Modeled on cdeflate.c: the access is set up in two stages, and a seek
+   backwards restarts decoding from the beginning of the element.
+
+   EXPORTED ROUTINES
+   None of these routines are designed to be called by other users except
+   for the modeling layer of the compression routines.
+ */
+
+/* General HDF includes */
+#include "hdf.h"
+
+/* HDF compression includes */
+#include "hcompi.h" /* Internal definitions for compression */
+
+#ifdef H4_HAVE_LIBLZ4
+
+/* Largest piece of data handed to the LZ4 encoder at once */
+#define LZ4_IN_SIZE 65536
+
+/* Define the size of the temporary buffer used when seeking */
+#define LZ4_TMP_BUF_SIZE 16384
+
+/* functions to perform LZ4 encoding */
+funclist_t clz4_funcs = {HCPclz4_stread,
+                         HCPclz4_stwrite,
+                         HCPclz4_seek,
+                         HCPclz4_inquire,
+                         HCPclz4_read,
+                         HCPclz4_write,
+                         HCPclz4_endaccess,
+                         NULL,
+                         NULL};
+
+/* declaration of the functions provided in this module */
+static int32 HCIclz4_init(compinfo_t *info);
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPclz4_prefs -- Set up the LZ4 frame preferences for an acceleration
+
+ USAGE
+    void HCPclz4_prefs(prefs, acceleration)
+    LZ4F_preferences_t *prefs;  OUT: the frame preferences
+    intn acceleration;          IN: acceleration of the encoder, 1 or more
+
+ RETURNS
+    None
+
+ DESCRIPTION
+    Acceleration 1 is the default speed of LZ4.  Each step over it trades
+    some compression for speed, through the negative compression levels
+    of the frame interface.
+--------------------------------------------------------------------------*/
+void
+HCPclz4_prefs(LZ4F_preferences_t *prefs, intn acceleration)
+{
+    memset(prefs, 0, sizeof(LZ4F_preferences_t));
+    prefs->compressionLevel = 1 - acceleration;
+} /* end HCPclz4_prefs() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPclz4_decode_frame -- Decode a whole LZ4 frame in memory
+
+ USAGE
+    intn HCPclz4_decode_frame(src, src_len, dst, dst_len)
+    const uint8 *src;   IN: the frame
+    int32 src_len;      IN: length of the frame
+    uint8 *dst;         OUT: buffer for the decoded data
+    int32 dst_len;      IN: expected length of the decoded data
+
+ RETURNS
+    Returns SUCCEED if the frame decoded to exactly dst_len bytes, FAIL
+    otherwise
+
+ DESCRIPTION
+    Safe to call from worker threads: nothing is pushed on the error
+    stack.
+--------------------------------------------------------------------------*/
+intn
+HCPclz4_decode_frame(const uint8 *src, int32 src_len, uint8 *dst, int32 dst_len)
+{
+    LZ4F_dctx              *dctx;
+    LZ4F_decompressOptions_t opts;
+    size_t                   src_pos = 0, dst_pos = 0;
+    size_t                   src_size, dst_size;
+    size_t                   hint;
+
+    if (LZ4F_isError(LZ4F_createDecompressionContext(&dctx, LZ4F_VERSION)))
+        return FAIL;
+
+    /* the whole destination is at hand, no need for LZ4 to buffer it */
+    memset(&opts, 0, sizeof(opts));
+    opts.stableDst = 1;
+
+    do {
+        src_size = (size_t)src_len - src_pos;
+        dst_size = (size_t)dst_len - dst_pos;
+        hint     = LZ4F_decompress(dctx, dst + dst_pos, &dst_size, src + src_pos, &src_size, &opts);
+        if (LZ4F_isError(hint))
+            break;
+        src_pos += src_size;
+        dst_pos += dst_size;
+    } while (hint != 0 && (src_size != 0 || dst_size != 0));
+
+    LZ4F_freeDecompressionContext(dctx);
+
+    return (hint == 0 && dst_pos == (size_t)dst_len) ? SUCCEED : FAIL;
+} /* end HCPclz4_decode_frame() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIclz4_init -- Initialize a LZ4 compressed data element.
+
+ USAGE
+    int32 HCIclz4_init(info)
+    compinfo_t *info;           IN: special element information
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Common code called by HCIclz4_staccess
+--------------------------------------------------------------------------*/
+static int32
+HCIclz4_init(compinfo_t *info)
+{
+    comp_coder_lz4_info_t *lz4_info; /* ptr to LZ4 info */
+
+    if (Hseek(info->aid, 0, 0) == FAIL) /* seek to beginning of element */
+        HRETURN_ERROR(DFE_SEEKERROR, FAIL);
+
+    lz4_info = &(info->cinfo.coder_info.lz4_info);
+
+    /* Initialize LZ4 state information */
+    lz4_info->offset      = 0; /* start at the beginning of the data */
+    lz4_info->acc_init    = 0; /* second stage of initializing not performed */
+    lz4_info->acc_mode    = 0; /* init access mode to illegal value */
+    lz4_info->io_buf      = NULL;
+    lz4_info->io_size     = 0;
+    lz4_info->lz4_context = NULL;
+
+    return SUCCEED;
+} /* end HCIclz4_init() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIclz4_decode -- Decode LZ4 compressed data into a buffer.
+
+ USAGE
+    int32 HCIclz4_decode(info,length,buf)
+    compinfo_t *info;   IN: the info about the compressed element
+    int32 length;       IN: number of bytes to read into the buffer
+    uint8 *buf;         OUT: buffer to store the bytes read
+
+ RETURNS
+    Returns # of bytes decompressed or FAIL
+
+ DESCRIPTION
+    Common code called to decode LZ4 data from the file.  Stops short of
+    'length' bytes at the end of the frame.
+--------------------------------------------------------------------------*/
+static int32
+HCIclz4_decode(compinfo_t *info, int32 length, uint8 *buf)
+{
+    comp_coder_lz4_info_t *lz4_info; /* ptr to LZ4 info */
+    size_t                 out_pos = 0;
+    size_t                 src_size, dst_size;
+    size_t                 hint;
+
+    lz4_info = &(info->cinfo.coder_info.lz4_info);
+
+    while (out_pos < (size_t)length && !lz4_info->frame_end) {
+        /* Get more bytes from the file, if we've run out */
+        if (lz4_info->io_pos == lz4_info->io_len && !lz4_info->io_eof) {
+            int32 file_bytes;
+
+            if ((file_bytes = Hread(info->aid, (int32)lz4_info->io_size, lz4_info->io_buf)) == FAIL)
+                HRETURN_ERROR(DFE_READERROR, FAIL);
+            lz4_info->io_pos = 0;
+            lz4_info->io_len = (size_t)file_bytes;
+            if (file_bytes == 0)
+                lz4_info->io_eof = TRUE;
+        } /* end if */
+
+        /* Read compressed data */
+        src_size = lz4_info->io_len - lz4_info->io_pos;
+        dst_size = (size_t)length - out_pos;
+        hint     = LZ4F_decompress((LZ4F_dctx *)lz4_info->lz4_context, buf + out_pos, &dst_size,
+                                   lz4_info->io_buf + lz4_info->io_pos, &src_size, NULL);
+        if (LZ4F_isError(hint))
+            HRETURN_ERROR(DFE_READCOMP, FAIL);
+        lz4_info->io_pos += src_size;
+        out_pos += dst_size;
+
+        /* stop at the end of the compressed data */
+        if (hint == 0)
+            lz4_info->frame_end = TRUE;
+
+        /* or if the element ended in the middle of the frame */
+        else if (lz4_info->io_eof && src_size == 0 && dst_size == 0)
+            break;
+    } /* end while */
+    lz4_info->offset += (int32)out_pos;
+
+    return (int32)out_pos;
+} /* end HCIclz4_decode() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIclz4_flush -- Write out the encoded data held in the I/O buffer
+
+ USAGE
+    int32 HCIclz4_flush(info)
+    compinfo_t *info;   IN: the info about the compressed element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+--------------------------------------------------------------------------*/
+static int32
+HCIclz4_flush(compinfo_t *info)
+{
+    comp_coder_lz4_info_t *lz4_info = &(info->cinfo.coder_info.lz4_info);
+
+    if (lz4_info->io_pos > 0) {
+        if (Hwrite(info->aid, (int32)lz4_info->io_pos, lz4_info->io_buf) == FAIL)
+            HRETURN_ERROR(DFE_WRITEERROR, FAIL);
+        lz4_info->io_pos = 0;
+    } /* end if */
+
+    return SUCCEED;
+} /* end HCIclz4_flush() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIclz4_encode -- Encode data from a buffer into LZ4 compressed data
+
+ USAGE
+    int32 HCIclz4_encode(info,length,buf)
+    compinfo_t *info;   IN: the info about the compressed element
+    int32 length;       IN: number of bytes to store from the buffer
+    uint8 *buf;         OUT: buffer to get the bytes from
+
+ RETURNS
+    Returns # of bytes encoded or FAIL
+
+ DESCRIPTION
+    Common code called to encode LZ4 data into a file.  The data is
+    handed to the encoder in pieces of at most LZ4_IN_SIZE bytes, so that
+    the I/O buffer always has room for the output of a piece.
+--------------------------------------------------------------------------*/
+static int32
+HCIclz4_encode(compinfo_t *info, int32 length, const void *buf)
+{
+    comp_coder_lz4_info_t *lz4_info; /* ptr to LZ4 info */
+    const uint8           *src = (const uint8 *)buf;
+    size_t                 in_pos;
+
+    lz4_info = &(info->cinfo.coder_info.lz4_info);
+
+    for (in_pos = 0; in_pos < (size_t)length;) {
+        size_t piece = MIN((size_t)length - in_pos, LZ4_IN_SIZE);
+        size_t n;
+
+        /* Write the buffer to the file, if the piece might not fit */
+        if (lz4_info->io_size - lz4_info->io_pos < LZ4F_compressBound(piece, NULL))
+            if (HCIclz4_flush(info) == FAIL)
+                HRETURN_ERROR(DFE_WRITEERROR, FAIL);
+
+        n = LZ4F_compressUpdate((LZ4F_cctx *)lz4_info->lz4_context, lz4_info->io_buf + lz4_info->io_pos,
+                                lz4_info->io_size - lz4_info->io_pos, src + in_pos, piece, NULL);
+        if (LZ4F_isError(n))
+            HRETURN_ERROR(DFE_CENCODE, FAIL);
+        lz4_info->io_pos += n;
+        in_pos += piece;
+    }                           /* end for */
+    lz4_info->offset += length; /* incr. abs. offset into the file */
+
+    return length;
+} /* end HCIclz4_encode() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIclz4_term -- Close down internal buffering for LZ4 encoding
+
+ USAGE
+    int32 HCIclz4_term(info,acc_mode)
+    compinfo_t *info;   IN: the info about the compressed element
+    uint32 acc_mode;    IN: the access mode the data element was opened with
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Common code called to end the LZ4 frame in the file when writing,
+    and to release the LZ4 context.
+--------------------------------------------------------------------------*/
+static int32
+HCIclz4_term(compinfo_t *info, uint32 acc_mode)
+{
+    comp_coder_lz4_info_t *lz4_info; /* ptr to LZ4 info */
+
+    lz4_info = &(info->cinfo.coder_info.lz4_info);
+
+    if (lz4_info->acc_init != 0) {
+        if (acc_mode & DFACC_WRITE) { /* flush the compressed data to the file */
+            LZ4F_cctx *cctx = (LZ4F_cctx *)lz4_info->lz4_context;
+            size_t     n;
+
+            if (lz4_info->io_size - lz4_info->io_pos < LZ4F_compressBound(0, NULL))
+                if (HCIclz4_flush(info) == FAIL)
+                    HRETURN_ERROR(DFE_WRITEERROR, FAIL);
+            n = LZ4F_compressEnd(cctx, lz4_info->io_buf + lz4_info->io_pos, lz4_info->io_size - lz4_info->io_pos,
+                                 NULL);
+            LZ4F_freeCompressionContext(cctx);
+            lz4_info->lz4_context = NULL;
+            if (LZ4F_isError(n))
+                HRETURN_ERROR(DFE_CENCODE, FAIL);
+            lz4_info->io_pos += n;
+            if (HCIclz4_flush(info) == FAIL)
+                HRETURN_ERROR(DFE_WRITEERROR, FAIL);
+        }      /* end if */
+        else { /* finish up any decompressed data */
+            LZ4F_freeDecompressionContext((LZ4F_dctx *)lz4_info->lz4_context);
+            lz4_info->lz4_context = NULL;
+        } /* end else */
+    }     /* end if */
+
+    /* Reset parameters */
+    lz4_info->offset   = 0; /* start at the beginning of the data */
+    lz4_info->acc_init = 0; /* second stage of initializing not performed */
+    lz4_info->acc_mode = 0; /* init access mode to illegal value */
+
+    return SUCCEED;
+} /* end HCIclz4_term() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIclz4_staccess -- Start accessing a LZ4 compressed data element.
+
+ USAGE
+    int32 HCIclz4_staccess(access_rec, access)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int16 access;           IN: the type of access wanted
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Common code called by HCPclz4_stread and HCPclz4_stwrite
+--------------------------------------------------------------------------*/
+static int32
+HCIclz4_staccess(accrec_t *access_rec, int16 acc_mode)
+{
+    compinfo_t            *info;     /* special element information */
+    comp_coder_lz4_info_t *lz4_info; /* ptr to LZ4 info */
+    size_t                 io_size;
+
+    info     = (compinfo_t *)access_rec->special_info;
+    lz4_info = &(info->cinfo.coder_info.lz4_info);
+
+    /* need to check for not writing, as opposed to read access */
+    /* because of the way the access works */
+    if (!(acc_mode & DFACC_WRITE)) {
+        info->aid = Hstartread(access_rec->file_id, DFTAG_COMPRESSED, info->comp_ref);
+    } /* end if */
+    else {
+        info->aid = Hstartaccess(access_rec->file_id, DFTAG_COMPRESSED, info->comp_ref,
+                                 DFACC_RDWR | DFACC_APPENDABLE);
+    } /* end else */
+    if (info->aid == FAIL)
+        HRETURN_ERROR(DFE_DENIED, FAIL);
+
+    /* Make certain we can append to the data when writing */
+    if ((acc_mode & DFACC_WRITE) && Happendable(info->aid) == FAIL)
+        HRETURN_ERROR(DFE_DENIED, FAIL);
+
+    /* initialize the common LZ4 coding info */
+    if (HCIclz4_init(info) == FAIL)
+        HRETURN_ERROR(DFE_CODER, FAIL);
+
+    /* Allocate compression I/O buffer, with room for the output of a
+       whole piece and of the frame header */
+    io_size = LZ4F_compressBound(LZ4_IN_SIZE, NULL) + LZ4F_HEADER_SIZE_MAX;
+    if ((lz4_info->io_buf = malloc(io_size)) == NULL)
+        HRETURN_ERROR(DFE_NOSPACE, FAIL);
+    lz4_info->io_size = io_size;
+
+    return SUCCEED;
+} /* end HCIclz4_staccess() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIclz4_staccess2 -- 2nd half of start accessing a LZ4 compressed
+                         data element.
+
+ USAGE
+    int32 HCIclz4_staccess2(access_rec, access)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int16 access;           IN: the type of access wanted
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Common code called by HCPclz4_seek, HCPclz4_read and HCPclz4_write
+--------------------------------------------------------------------------*/
+static int32
+HCIclz4_staccess2(accrec_t *access_rec, int16 acc_mode)
+{
+    compinfo_t            *info;     /* special element information */
+    comp_coder_lz4_info_t *lz4_info; /* ptr to LZ4 info */
+
+    info     = (compinfo_t *)access_rec->special_info;
+    lz4_info = &(info->cinfo.coder_info.lz4_info);
+
+    /* Initialize the LZ4 library */
+    if (acc_mode & DFACC_WRITE) {
+        LZ4F_cctx         *cctx;
+        LZ4F_preferences_t prefs;
+        size_t             n;
+
+        if (LZ4F_isError(LZ4F_createCompressionContext(&cctx, LZ4F_VERSION)))
+            HRETURN_ERROR(DFE_CINIT, FAIL);
+
+        /* start the frame in an empty buffer */
+        HCPclz4_prefs(&prefs, lz4_info->lz4_acceleration);
+        n = LZ4F_compressBegin(cctx, lz4_info->io_buf, lz4_info->io_size, &prefs);
+        if (LZ4F_isError(n)) {
+            LZ4F_freeCompressionContext(cctx);
+            HRETURN_ERROR(DFE_CINIT, FAIL);
+        }
+        lz4_info->io_pos      = n;
+        lz4_info->lz4_context = cctx;
+
+        /* set access mode */
+        lz4_info->acc_mode = DFACC_WRITE;
+    } /* end if */
+    else {
+        LZ4F_dctx *dctx;
+
+        if (LZ4F_isError(LZ4F_createDecompressionContext(&dctx, LZ4F_VERSION)))
+            HRETURN_ERROR(DFE_CINIT, FAIL);
+        lz4_info->lz4_context = dctx;
+
+        /* set access mode */
+        lz4_info->acc_mode = DFACC_READ;
+
+        /* force I/O with the file at first */
+        lz4_info->io_pos = lz4_info->io_len = 0;
+        lz4_info->io_eof                    = FALSE;
+        lz4_info->frame_end                 = FALSE;
+    } /* end else */
+
+    /* set flag to indicate second stage of initialization is finished */
+    lz4_info->acc_init = acc_mode;
+
+    return SUCCEED;
+} /* end HCIclz4_staccess2() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPclz4_stread -- start read access for compressed file
+
+ USAGE
+    int32 HCPclz4_stread(access_rec)
+    accrec_t *access_rec;   IN: the access record of the data element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Start read access on a compressed data element using the LZ4 scheme.
+--------------------------------------------------------------------------*/
+int32
+HCPclz4_stread(accrec_t *access_rec)
+{
+    if (HCIclz4_staccess(access_rec, DFACC_READ) == FAIL)
+        HRETURN_ERROR(DFE_CINIT, FAIL);
+
+    return SUCCEED;
+} /* HCPclz4_stread() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPclz4_stwrite -- start write access for compressed file
+
+ USAGE
+    int32 HCPclz4_stwrite(access_rec)
+    accrec_t *access_rec;   IN: the access record of the data element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Start write access on a compressed data element using the LZ4 scheme.
+--------------------------------------------------------------------------*/
+int32
+HCPclz4_stwrite(accrec_t *access_rec)
+{
+    if (HCIclz4_staccess(access_rec, DFACC_WRITE) == FAIL)
+        HRETURN_ERROR(DFE_CINIT, FAIL);
+
+    return SUCCEED;
+} /* HCPclz4_stwrite() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPclz4_seek -- Seek to offset within the data element
+
+ USAGE
+    int32 HCPclz4_seek(access_rec,offset,origin)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 offset;       IN: the offset in bytes from the origin specified
+    intn origin;        IN: the origin to seek from [UNUSED!]
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Seek to a position with a compressed data element.  The 'origin'
+    calculations have been taken care of at a higher level, it is an
+    un-used parameter.  The 'offset' is used as an absolute offset
+    because of this.
+--------------------------------------------------------------------------*/
+int32
+HCPclz4_seek(accrec_t *access_rec, int32 offset, int origin)
+{
+    compinfo_t            *info;             /* special element information */
+    comp_coder_lz4_info_t *lz4_info;         /* ptr to LZ4 info */
+    uint8                 *tmp_buf   = NULL; /* temporary buffer */
+    int32                  ret_value = SUCCEED;
+
+    (void)origin;
+
+    info     = (compinfo_t *)access_rec->special_info;
+    lz4_info = &(info->cinfo.coder_info.lz4_info);
+
+    /* Check if second stage of initialization has been performed */
+    if (lz4_info->acc_init == 0) {
+        if (HCIclz4_staccess2(access_rec, DFACC_READ) == FAIL)
+            HGOTO_ERROR(DFE_CINIT, FAIL);
+    }
+
+    if (offset < lz4_info->offset) {
+
+        /* need to seek from the beginning */
+
+        /* Terminate the previous method of access */
+        if (HCIclz4_term(info, (uint32)lz4_info->acc_mode) == FAIL)
+            HGOTO_ERROR(DFE_CTERM, FAIL);
+
+        /* Restart access */
+        if (HCIclz4_staccess2(access_rec, DFACC_READ) == FAIL)
+            HGOTO_ERROR(DFE_CINIT, FAIL);
+
+        /* Go back to the beginning of the data-stream */
+        if (Hseek(info->aid, 0, 0) == FAIL)
+            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+    }
+
+    /* Allocate a temporary buffer for decompression */
+    if ((tmp_buf = (uint8 *)malloc(sizeof(uint8) * LZ4_TMP_BUF_SIZE)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    while (lz4_info->offset + LZ4_TMP_BUF_SIZE < offset) {
+        /* grab chunks */
+        if (HCIclz4_decode(info, LZ4_TMP_BUF_SIZE, tmp_buf) == FAIL) {
+            HGOTO_ERROR(DFE_CDECODE, FAIL);
+        }
+    }
+    if (lz4_info->offset < offset) {
+        /* grab the last chunk */
+        if (HCIclz4_decode(info, offset - lz4_info->offset, tmp_buf) == FAIL) {
+            HGOTO_ERROR(DFE_CDECODE, FAIL);
+        }
+    }
+
+done:
+    free(tmp_buf);
+
+    return ret_value;
+} /* HCPclz4_seek() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPclz4_read -- Read in a portion of data from a compressed data element.
+
+ USAGE
+    int32 HCPclz4_read(access_rec,length,data)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 length;           IN: the number of bytes to read
+    void * data;             OUT: the buffer to place the bytes read
+
+ RETURNS
+    Returns the number of bytes read or FAIL
+
+ DESCRIPTION
+    Read in a number of bytes from the LZ4 compressed data element.
+--------------------------------------------------------------------------*/
+int32
+HCPclz4_read(accrec_t *access_rec, int32 length, void *data)
+{
+    compinfo_t            *info;     /* special element information */
+    comp_coder_lz4_info_t *lz4_info; /* ptr to LZ4 info */
+
+    info     = (compinfo_t *)access_rec->special_info;
+    lz4_info = &(info->cinfo.coder_info.lz4_info);
+
+    /* Check if second stage of initialization has been performed */
+    if (lz4_info->acc_init != DFACC_READ) {
+        /* Terminate the previous method of access */
+        if (HCIclz4_term(info, (uint32)lz4_info->acc_mode) == FAIL)
+            HRETURN_ERROR(DFE_CTERM, FAIL);
+
+        /* Restart access */
+        if (HCIclz4_staccess2(access_rec, DFACC_READ) == FAIL)
+            HRETURN_ERROR(DFE_CINIT, FAIL);
+
+        /* Go back to the beginning of the data-stream */
+        if (Hseek(info->aid, 0, 0) == FAIL)
+            HRETURN_ERROR(DFE_SEEKERROR, FAIL);
+    } /* end if */
+
+    if ((length = HCIclz4_decode(info, length, data)) == FAIL)
+        HRETURN_ERROR(DFE_CDECODE, FAIL);
+
+    return length;
+} /* HCPclz4_read() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPclz4_write -- Write out a portion of data from a compressed data element.
+
+ USAGE
+    int32 HCPclz4_write(access_rec,length,data)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 length;           IN: the number of bytes to write
+    void * data;             IN: the buffer to retrieve the bytes written
+
+ RETURNS
+    Returns the number of bytes written or FAIL
+
+ DESCRIPTION
+    Write out a number of bytes to the LZ4 compressed data element.
+--------------------------------------------------------------------------*/
+int32
+HCPclz4_write(accrec_t *access_rec, int32 length, const void *data)
+{
+    compinfo_t            *info;     /* special element information */
+    comp_coder_lz4_info_t *lz4_info; /* ptr to LZ4 info */
+
+    info     = (compinfo_t *)access_rec->special_info;
+    lz4_info = &(info->cinfo.coder_info.lz4_info);
+
+    /* Don't allow random write in a dataset unless: */
+    /*  1 - append onto the end */
+    /*  2 - start at the beginning and rewrite (at least) the whole dataset */
+    if ((info->length != lz4_info->offset) && (lz4_info->offset != 0 || length < info->length))
+        HRETURN_ERROR(DFE_UNSUPPORTED, FAIL);
+
+    /* Check if second stage of initialization has been performed */
+    if (lz4_info->acc_init != DFACC_WRITE) {
+        /* Terminate the previous method of access */
+        if (HCIclz4_term(info, (uint32)lz4_info->acc_init) == FAIL)
+            HRETURN_ERROR(DFE_CTERM, FAIL);
+
+        /* Go back to the beginning of the data-stream */
+        if (Hseek(info->aid, 0, 0) == FAIL)
+            HRETURN_ERROR(DFE_SEEKERROR, FAIL);
+
+        /* Restart access, which starts the frame */
+        if (HCIclz4_staccess2(access_rec, DFACC_WRITE) == FAIL)
+            HRETURN_ERROR(DFE_CINIT, FAIL);
+    } /* end if */
+
+    if ((length = HCIclz4_encode(info, length, data)) == FAIL)
+        HRETURN_ERROR(DFE_CENCODE, FAIL);
+
+    return length;
+} /* HCPclz4_write() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPclz4_inquire -- Inquire information about the access record and data element.
+
+ USAGE
+    int32 HCPclz4_inquire(access_rec,pfile_id,ptag,pref,plength,poffset,pposn,
+            paccess,pspecial)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 *pfile_id;        OUT: ptr to file id
+    uint16 *ptag;           OUT: ptr to tag of information
+    uint16 *pref;           OUT: ptr to ref of information
+    int32 *plength;         OUT: ptr to length of data element
+    int32 *poffset;         OUT: ptr to offset of data element
+    int32 *pposn;           OUT: ptr to position of access in element
+    int16 *paccess;         OUT: ptr to access mode
+    int16 *pspecial;        OUT: ptr to special code
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Inquire information about the access record and data element.
+    [Currently a NOP].
+--------------------------------------------------------------------------*/
+int32
+HCPclz4_inquire(accrec_t *access_rec, int32 *pfile_id, uint16 *ptag, uint16 *pref, int32 *plength,
+                int32 *poffset, int32 *pposn, int16 *paccess, int16 *pspecial)
+{
+    (void)access_rec;
+    (void)pfile_id;
+    (void)ptag;
+    (void)pref;
+    (void)plength;
+    (void)poffset;
+    (void)pposn;
+    (void)paccess;
+    (void)pspecial;
+
+    return SUCCEED;
+} /* HCPclz4_inquire() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPclz4_endaccess -- Close the compressed data element
+
+ USAGE
+    int32 HCPclz4_endaccess(access_rec)
+    accrec_t *access_rec;   IN: the access record of the data element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Close the compressed data element and free encoding info.
+--------------------------------------------------------------------------*/
+intn
+HCPclz4_endaccess(accrec_t *access_rec)
+{
+    compinfo_t            *info;     /* special element information */
+    comp_coder_lz4_info_t *lz4_info; /* ptr to LZ4 info */
+
+    info     = (compinfo_t *)access_rec->special_info;
+    lz4_info = &(info->cinfo.coder_info.lz4_info);
+
+    /* flush out buffer */
+    if (HCIclz4_term(info, (uint32)lz4_info->acc_mode) == FAIL)
+        HRETURN_ERROR(DFE_CTERM, FAIL);
+
+    /* Get rid of the I/O buffer */
+    free(lz4_info->io_buf);
+    lz4_info->io_buf = NULL;
+
+    /* close the compressed data AID */
+    if (Hendaccess(info->aid) == FAIL)
+        HRETURN_ERROR(DFE_CANTCLOSE, FAIL);
+
+    return SUCCEED;
+} /* HCPclz4_endaccess() */
+
+#endif /* H4_HAVE_LIBLZ4 */
@@ -0,0 +1,81 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*-----------------------------------------------------------------------------
+ * File:    clz4.h
+ * Purpose: Header file for LZ4 encoding information.
+ * Dependencies: should only be included from hcompi.h
+ *---------------------------------------------------------------------------*/
+
+#ifndef H4_CLZ4_H
+#define H4_CLZ4_H
+
+#include "H4api_adpt.h"
+
+#ifdef H4_HAVE_LIBLZ4
+/* Get the LZ4 frame header */
+#include <lz4frame.h>
+#endif
+
+/* LZ4 [en|de]coding information */
+typedef struct {
+    intn   lz4_acceleration; /* how much faster, and worse, to compress this data */
+    int32  offset;           /* offset in the de-compressed array */
+    intn   acc_init;         /* is access mode initialized? */
+    int16  acc_mode;         /* access mode desired */
+    uint8 *io_buf;           /* buffer for I/O with the file */
+    size_t io_size;          /* allocated size of io_buf */
+    size_t io_pos;           /* next byte of io_buf to decode or to fill */
+    size_t io_len;           /* number of bytes read into io_buf */
+    intn   io_eof;           /* all of the compressed data has been read */
+    intn   frame_end;        /* the end of the LZ4 frame was decoded */
+    void  *lz4_context;      /* LZ4F_cctx or LZ4F_dctx of the access */
+} comp_coder_lz4_info_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef H4_HAVE_LIBLZ4
+HDFLIBAPI funclist_t clz4_funcs; /* functions to perform LZ4 encoding */
+
+/*
+ ** from clz4.c
+ */
+
+HDFLIBAPI int32 HCPclz4_stread(accrec_t *rec);
+
+HDFLIBAPI int32 HCPclz4_stwrite(accrec_t *rec);
+
+HDFLIBAPI int32 HCPclz4_seek(accrec_t *access_rec, int32 offset, int origin);
+
+HDFLIBAPI int32 HCPclz4_inquire(accrec_t *access_rec, int32 *pfile_id, uint16 *ptag, uint16 *pref,
+                                int32 *plength, int32 *poffset, int32 *pposn, int16 *paccess,
+                                int16 *pspecial);
+
+HDFLIBAPI int32 HCPclz4_read(accrec_t *access_rec, int32 length, void *data);
+
+HDFLIBAPI int32 HCPclz4_write(accrec_t *access_rec, int32 length, const void *data);
+
+HDFLIBAPI intn HCPclz4_endaccess(accrec_t *access_rec);
+
+HDFLIBAPI void HCPclz4_prefs(LZ4F_preferences_t *prefs, intn acceleration);
+
+HDFLIBAPI intn HCPclz4_decode_frame(const uint8 *src, int32 src_len, uint8 *dst, int32 dst_len);
+#endif /* H4_HAVE_LIBLZ4 */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H4_CLZ4_H */
@@ -60,6 +60,12 @@ static const uint32 mask_arr32[33] = {/* array of values with [n] bits set */
                                       0x00FFFFFF, 0x01FFFFFF, 0x03FFFFFF,  0x07FFFFFF, 0x0FFFFFFF, 0x1FFFFFFF,
                                       0x3FFFFFFF, 0x7FFFFFFF, 0xFFFFFFFFUL};
 
+/* Largest number type coded a whole word at a time, in bytes */
+#define NBIT_WORD_SIZE 4
+
+/* Number of bit-fields moved with one Hbitreadv()/Hbitwritev() */
+#define NBIT_WORD_BATCH 256
+
 /* declaration of the functions provided in this module */
 static int32 HCIcnbit_staccess(accrec_t *access_rec, int16 acc_mode);
 
@@ -108,6 +114,7 @@ HCIcnbit_init(accrec_t *access_rec)
 
     /* Initialize N-bit state information */
     nbit_info->buf_pos = NBIT_BUF_SIZE; /* start at the beginning of the buffer */
+    nbit_info->buf_len = 0;             /* nothing expanded in the buffer yet */
     nbit_info->nt_pos  = 0;             /* start at beginning of the NT info */
     nbit_info->offset  = 0;             /* offset into the file */
     memset(nbit_info->mask_buf, (nbit_info->fill_one == TRUE ? 0xff : 0), nbit_info->nt_size);
@@ -167,6 +174,126 @@ HCIcnbit_init(accrec_t *access_rec)
     return SUCCEED;
 } /* end HCIcnbit_init() */
 
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcnbit_getword -- Get a number of NBIT_WORD_SIZE bytes or less
+
+ USAGE
+    uint32 HCIcnbit_getword(p, nt_size)
+    const uint8 *p;     IN: the number, in the big-endian order of the file
+    intn nt_size;       IN: size of the number
+
+ RETURNS
+    The number as a word
+--------------------------------------------------------------------------*/
+static uint32
+HCIcnbit_getword(const uint8 *p, intn nt_size)
+{
+    uint32 word = 0;
+    intn   i;
+
+    for (i = 0; i < nt_size; i++)
+        word = (word << 8) | p[i];
+    return word;
+} /* end HCIcnbit_getword() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcnbit_putword -- Store a number of NBIT_WORD_SIZE bytes or less
+
+ USAGE
+    void HCIcnbit_putword(p, nt_size, word)
+    uint8 *p;           OUT: the number, in the big-endian order of the file
+    intn nt_size;       IN: size of the number
+    uint32 word;        IN: the number as a word
+
+ RETURNS
+    None
+--------------------------------------------------------------------------*/
+static void
+HCIcnbit_putword(uint8 *p, intn nt_size, uint32 word)
+{
+    intn i;
+
+    for (i = nt_size - 1; i >= 0; i--, word >>= 8)
+        p[i] = (uint8)word;
+} /* end HCIcnbit_putword() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcnbit_decode_words -- Decode whole numbers of up to NBIT_WORD_SIZE bytes
+
+ USAGE
+    int32 HCIcnbit_decode_words(info,rbuf,nitems)
+    compinfo_t *info;   IN: the info about the compressed element
+    uint8 *rbuf;        OUT: buffer to expand the numbers into
+    intn nitems;        IN: number of numbers to decode
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    The bit-field of a number is contiguous in the file, so the bit-fields
+    are read NBIT_WORD_BATCH at a time with Hbitreadv() and put in place,
+    sign extension included, with word operations instead of a byte of the
+    mask at a time.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+static int32
+HCIcnbit_decode_words(compinfo_t *info, uint8 *rbuf, intn nitems)
+{
+    comp_coder_nbit_info_t *nbit_info;                   /* ptr to n-bit info */
+    uint32                  input_bits[NBIT_WORD_BATCH]; /* bits read from the file */
+    uint32                  fill;                        /* the fill bits around the bit-field */
+    uint32                  ext_mask;                    /* bits above the bit-field */
+    uint32                  value;                       /* the decoded number */
+    intn                    shift;                       /* lowest bit of the bit-field */
+    intn                    sign_bit;                    /* the sign bit from the n_bit data */
+    int32                   batch;                       /* number of bit-fields in this batch */
+    int32                   got;                         /* number of bit-fields read in full */
+    int32                   i;                           /* local counting variable */
+
+    /* get a local ptr to the nbit info for convenience */
+    nbit_info = &(info->cinfo.coder_info.nbit_info);
+
+    shift    = (nbit_info->mask_off - nbit_info->mask_len) + 1;
+    fill     = HCIcnbit_getword(nbit_info->mask_buf, nbit_info->nt_size);
+    ext_mask = ~mask_arr32[nbit_info->mask_off + 1] & mask_arr32[nbit_info->nt_size * 8];
+
+    for (; nitems > 0; nitems -= (intn)batch) {
+        batch = MIN(nitems, NBIT_WORD_BATCH);
+        if ((got = Hbitreadv(info->aid, nbit_info->mask_len, batch, input_bits)) == FAIL)
+            HRETURN_ERROR(DFE_CDECODE, FAIL);
+        if (got < batch) {
+            if (!nbit_info->sign_ext)
+                HRETURN_ERROR(DFE_CDECODE, FAIL);
+            /* past the end of the data, the short bit-field is kept and the rest are zero */
+            for (i = got + 1; i < batch; i++)
+                input_bits[i] = 0;
+        } /* end if */
+
+        for (i = 0; i < batch; i++, rbuf += nbit_info->nt_size) {
+            value = fill | (input_bits[i] << shift);
+
+            /* we only have to sign extend if the sign is not the same */
+            /* as the bit we are filling the n-bit data with */
+            if (nbit_info->sign_ext) {
+                sign_bit = (input_bits[i] >> (nbit_info->mask_len - 1)) & 1 ? 1 : 0;
+                if (sign_bit != nbit_info->fill_one)
+                    value = sign_bit ? (value | ext_mask) : (value & ~ext_mask);
+            } /* end if */
+
+            HCIcnbit_putword(rbuf, nbit_info->nt_size, value);
+        } /* end for */
+    }     /* end for */
+
+    return SUCCEED;
+} /* end HCIcnbit_decode_words() */
+
 /*--------------------------------------------------------------------------
  NAME
     HCIcnbit_decode -- Decode n-bit data into a buffer.
@@ -200,8 +327,8 @@ HCIcnbit_decode(compinfo_t *info, int32 length, uint8 *buf)
         sign_bit = 0;                    /* the sign bit from the n_bit data */
     nbit_mask_info_t *mask_info;         /* ptr to the mask info */
     intn              copy_length;       /* number of bytes to copy */
-    intn              buf_size,          /* size of the expansion buffer to use */
-        buf_items;                       /* number of items which will fit into expansion buffer */
+    int32             items_left;        /* number of items left in the element */
+    intn              buf_items;         /* number of items which will fit into expansion buffer */
     uint8 *rbuf, *rbuf2;                 /* pointer into the n-bit read buffer */
     intn   i, j;                         /* local counting variable */
 
@@ -213,67 +340,79 @@ HCIcnbit_decode(compinfo_t *info, int32 length, uint8 *buf)
     sign_byte     = nbit_info->nt_size - ((nbit_info->mask_off / 8) + 1);
     sign_mask     = mask_arr32[(nbit_info->mask_off % 8) + 1] ^ mask_arr32[nbit_info->mask_off % 8];
 
-    buf_size    = MIN(NBIT_BUF_SIZE, length);
-    buf_items   = buf_size / nbit_info->nt_size; /* compute # of items in buffer */
-    orig_length = length;                        /* save this for later */
-    while (length > 0) {                         /* decode until we have all the bytes */
-        if (nbit_info->buf_pos >= buf_size) {    /* re-fill buffer */
-            rbuf = (uint8 *)nbit_info->buffer;   /* get a ptr to the buffer */
-
-            /* get initial copy of the mask */
-            HDmemfill(rbuf, nbit_info->mask_buf, (uint32)nbit_info->nt_size, (uint32)buf_items);
-
-            for (i = 0; i < buf_items; i++) {
-                /* get a ptr to the mask info for convenience also */
-                mask_info = &(nbit_info->mask_info[0]);
-
-                if (nbit_info->sign_ext) { /* special code for expanding sign extended data */
-                    rbuf2 = rbuf;          /* set temporary pointer into buffer */
-                    for (j = 0; j < nbit_info->nt_size; j++, mask_info++, rbuf2++) {
-                        if (mask_info->length > 0) { /* check if we need to read bits */
-                            Hbitread(info->aid, mask_info->length, &input_bits);
-                            input_bits <<= (mask_info->offset - mask_info->length) + 1;
-                            *rbuf2 |= (uint8)(mask_info->mask & (uint8)input_bits);
-                            if (j == sign_byte) /* check if this is the sign byte */
-                                sign_bit = sign_mask & input_bits ? 1 : 0;
-                        } /* end if */
-                    }     /* end for */
-
-                    /* we only have to sign extend if the sign is not the same */
-                    /* as the bit we are filling the n-bit data with */
-                    if (sign_bit != nbit_info->fill_one) {
-                        rbuf2 = rbuf;        /* set temporary pointer into buffer */
-                        if (sign_bit == 1) { /* fill with ones */
-                            for (j = 0; j < sign_byte; j++, rbuf2++)
-                                *rbuf2 = 0xff;
-                            *rbuf2 |= (uint8)sign_ext_mask;
-                        }      /* end if */
-                        else { /* fill with zeroes */
-                            for (j = 0; j < sign_byte; j++, rbuf2++)
-                                *rbuf2 = 0x00;
-                            *rbuf2 &= (uint8)~sign_ext_mask;
-                        }                       /* end else */
-                    }                           /* end if */
-                    rbuf += nbit_info->nt_size; /* increment buffer ptr */
-                }                               /* end if */
-                else {                          /* no sign extension */
-                    for (j = 0; j < nbit_info->nt_size; j++, mask_info++, rbuf++) {
-                        if (mask_info->length > 0) { /* check if we need to read bits */
-                            if (Hbitread(info->aid, mask_info->length, &input_bits) != mask_info->length)
-                                HRETURN_ERROR(DFE_CDECODE, FAIL);
-                            *rbuf |=
-                                (uint8)(mask_info->mask &
-                                        (uint8)(input_bits << ((mask_info->offset - mask_info->length) + 1)));
-                        } /* end if */
-                    }     /* end for */
-                }         /* end else */
-            }             /* end for */
+    orig_length = length;                               /* save this for later */
+    while (length > 0) {                                /* decode until we have all the bytes */
+        if (nbit_info->buf_pos >= nbit_info->buf_len) { /* re-fill buffer */
+            rbuf = (uint8 *)nbit_info->buffer;          /* get a ptr to the buffer */
+
+            /* expand whole items, as many as fit and are left in the element */
+            items_left = info->length - (nbit_info->offset + (orig_length - length));
+            items_left = (items_left + nbit_info->nt_size - 1) / nbit_info->nt_size;
+            buf_items = (intn)MAX(1, MIN(NBIT_BUF_SIZE / nbit_info->nt_size, items_left));
+
+            /* small number types are expanded a whole number at a time */
+            if (nbit_info->nt_size <= NBIT_WORD_SIZE) {
+                if (HCIcnbit_decode_words(info, rbuf, buf_items) == FAIL)
+                    HRETURN_ERROR(DFE_CDECODE, FAIL);
+            } /* end if */
+            else {
+                /* get initial copy of the mask */
+                HDmemfill(rbuf, nbit_info->mask_buf, (uint32)nbit_info->nt_size, (uint32)buf_items);
+
+                for (i = 0; i < buf_items; i++) {
+                    /* get a ptr to the mask info for convenience also */
+                    mask_info = &(nbit_info->mask_info[0]);
+
+                    if (nbit_info->sign_ext) { /* special code for expanding sign extended data */
+                        rbuf2 = rbuf;          /* set temporary pointer into buffer */
+                        for (j = 0; j < nbit_info->nt_size; j++, mask_info++, rbuf2++) {
+                            if (mask_info->length > 0) { /* check if we need to read bits */
+                                Hbitread(info->aid, mask_info->length, &input_bits);
+                                input_bits <<= (mask_info->offset - mask_info->length) + 1;
+                                *rbuf2 |= (uint8)(mask_info->mask & (uint8)input_bits);
+                                if (j == sign_byte) /* check if this is the sign byte */
+                                    sign_bit = sign_mask & input_bits ? 1 : 0;
+                            } /* end if */
+                        }     /* end for */
+
+                        /* we only have to sign extend if the sign is not the same */
+                        /* as the bit we are filling the n-bit data with */
+                        if (sign_bit != nbit_info->fill_one) {
+                            rbuf2 = rbuf;        /* set temporary pointer into buffer */
+                            if (sign_bit == 1) { /* fill with ones */
+                                for (j = 0; j < sign_byte; j++, rbuf2++)
+                                    *rbuf2 = 0xff;
+                                *rbuf2 |= (uint8)sign_ext_mask;
+                            }      /* end if */
+                            else { /* fill with zeroes */
+                                for (j = 0; j < sign_byte; j++, rbuf2++)
+                                    *rbuf2 = 0x00;
+                                *rbuf2 &= (uint8)~sign_ext_mask;
+                            }                       /* end else */
+                        }                           /* end if */
+                        rbuf += nbit_info->nt_size; /* increment buffer ptr */
+                    }                               /* end if */
+                    else {                          /* no sign extension */
+                        for (j = 0; j < nbit_info->nt_size; j++, mask_info++, rbuf++) {
+                            if (mask_info->length > 0) { /* check if we need to read bits */
+                                if (Hbitread(info->aid, mask_info->length, &input_bits) != mask_info->length)
+                                    HRETURN_ERROR(DFE_CDECODE, FAIL);
+                                *rbuf |= (uint8)(mask_info->mask &
+                                                 (uint8)(input_bits
+                                                         << ((mask_info->offset - mask_info->length) + 1)));
+                            } /* end if */
+                        }     /* end for */
+                    }         /* end else */
+                }             /* end for */
+            } /* end else */
 
             nbit_info->buf_pos = 0; /* reset buffer position */
-        }                           /* end if */
+            nbit_info->buf_len = buf_items * nbit_info->nt_size;
+        } /* end if */
 
-        copy_length =
-            (intn)((length > (buf_size - nbit_info->buf_pos)) ? (buf_size - nbit_info->buf_pos) : length);
+        copy_length = (intn)((length > (nbit_info->buf_len - nbit_info->buf_pos))
+                                 ? (nbit_info->buf_len - nbit_info->buf_pos)
+                                 : length);
 
         memcpy(buf, &(nbit_info->buffer[nbit_info->buf_pos]), copy_length);
 
@@ -321,7 +460,26 @@ HCIcnbit_encode(compinfo_t *info, int32 length, const uint8 *buf)
     /* get a ptr to the mask info for convenience also */
     mask_info = &(nbit_info->mask_info[nbit_info->nt_pos]);
 
-    orig_length = length;                 /* save this for later */
+    orig_length = length; /* save this for later */
+
+    /* whole small numbers go out as a single bit-field each, a batch at a time */
+    if (nbit_info->nt_pos == 0 && nbit_info->nt_size <= NBIT_WORD_SIZE) {
+        uint32 fields[NBIT_WORD_BATCH];                                 /* bit-fields to write */
+        intn   shift = (nbit_info->mask_off - nbit_info->mask_len) + 1; /* lowest bit of the bit-field */
+        int32  batch;                                                   /* bit-fields in this batch */
+        int32  i;                                                       /* local counting variable */
+
+        while (length >= nbit_info->nt_size) {
+            batch = MIN(length / nbit_info->nt_size, NBIT_WORD_BATCH);
+            for (i = 0; i < batch; i++, buf += nbit_info->nt_size)
+                fields[i] =
+                    (HCIcnbit_getword(buf, nbit_info->nt_size) >> shift) & mask_arr32[nbit_info->mask_len];
+            if (Hbitwritev(info->aid, nbit_info->mask_len, batch, fields) == FAIL)
+                HRETURN_ERROR(DFE_CENCODE, FAIL);
+            length -= batch * nbit_info->nt_size;
+        } /* end while */
+    }     /* end if */
+
     for (; length > 0; length--, buf++) { /* encode until we store all the bytes */
         if (mask_info->length > 0) {      /* check if we need to output bits */
             output_bits =
@@ -512,6 +670,7 @@ HCPcnbit_seek(accrec_t *access_rec, int32 offset, int origin)
         HRETURN_ERROR(DFE_CSEEK, FAIL);
 
     nbit_info->buf_pos = NBIT_BUF_SIZE; /* force re-read if writing */
+    nbit_info->buf_len = 0;
     nbit_info->nt_pos  = 0;             /* start at the first byte of the mask */
     nbit_info->offset  = offset;        /* set abs. offset into the file */
 
@@ -40,6 +40,7 @@ typedef struct {
     intn  sign_ext;                             /* whether to sign extend or not */
     uint8 buffer[NBIT_BUF_SIZE];                /* buffer for expanding n-bit data in */
     intn  buf_pos;                              /* current offset in the expansion buffer */
+    intn  buf_len;                              /* number of bytes expanded in the buffer */
     intn  mask_off,                             /* offset of the bit to start masking with */
         mask_len;                               /* number of bits to mask */
     int32            offset;                    /* offset in the file in terms of bytes */
@@ -0,0 +1,794 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*
+   FILE
+   cplugin.c
+   HDF I/O routines for the coders registered by the application
+
+   REMARKS
+   A coder plugin gives the compression types from COMP_CODE_PLUGIN_MIN up
+   to the library, with callbacks that code a whole element in memory.  It
+   is registered with HCregister_coder(), or found in the shared libraries
+   of a plugin directory by HCload_coder_plugins().  The directories named
+   by the HDF4_PLUGIN_PATH environment variable are searched once, the
+   first time an element uses a type no coder is registered for.
+
+   The coders' parameters, comp_info.plugin, are kept in the compression
+   header.  Each compressed element starts with the 4-byte length of the
+   coded data that follows, so that a shorter re-write of the element is
+   not followed by the coded bytes it replaced.
+
+   DESIGN
+   Modeled on cjpeg.c: the element is held de-compressed in memory, it is
+   decoded whole on the first read and encoded whole when the access ends
+   after a write.
+
+   EXPORTED ROUTINES
+   HCregister_coder      -- register a coder plugin
+   HCunregister_coder    -- remove a coder plugin
+   HCload_coder_plugins  -- register the coders of the shared libraries in
+                            a list of directories
+   The other routines are not designed to be called by other users except
+   for the modeling layer of the compression routines and the chunk layer.
+ */
+
+/* General HDF includes */
+#include "hdf.h"
+
+/* HDF compression includes */
+#include "hcompi.h" /* Internal definitions for compression */
+
+#if defined(H4_HAVE_DLFCN_H) && !defined(H4_HAVE_WIN32_API)
+#define H4_HAVE_CODER_PLUGIN_LOADING
+#include <dirent.h>
+#include <dlfcn.h>
+#endif
+
+/* Number of coder plugins that can be registered at once */
+#define H4_MAX_CODER_PLUGINS 16
+
+/* Length of the preamble holding the length of the coded data */
+#define PLUGIN_PREAMBLE 4
+
+/* Separator of the directories of a plugin path, and suffix of the shared
+   libraries looked at */
+#define PLUGIN_PATH_SEP ':'
+#ifdef __APPLE__
+#define PLUGIN_SUFFIX ".dylib"
+#else
+#define PLUGIN_SUFFIX ".so"
+#endif
+
+/* functions to perform plugin encoding */
+funclist_t cplugin_funcs = {HCPcplugin_stread,
+                            HCPcplugin_stwrite,
+                            HCPcplugin_seek,
+                            HCPcplugin_inquire,
+                            HCPcplugin_read,
+                            HCPcplugin_write,
+                            HCPcplugin_endaccess,
+                            NULL,
+                            NULL};
+
+/* The registered coders, and whether HDF4_PLUGIN_PATH was searched */
+static hdf_coder_plugin_t HCIplugins[H4_MAX_CODER_PLUGINS];
+static intn               HCInplugins   = 0;
+static intn               HCIpath_tried = FALSE;
+
+/* declaration of the functions provided in this module */
+static const hdf_coder_plugin_t *HCIfind_coder(comp_coder_t coder_type);
+static int32                     HCIcplugin_load(compinfo_t *info);
+static int32                     HCIcplugin_term(compinfo_t *info);
+static int32                     HCIcplugin_staccess(accrec_t *access_rec, int16 acc_mode);
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIfind_coder -- Look up a registered coder plugin
+
+ USAGE
+    const hdf_coder_plugin_t *HCIfind_coder(coder_type)
+    comp_coder_t coder_type;    IN: the compression type
+
+ RETURNS
+    The coder, or NULL if none is registered for 'coder_type'
+--------------------------------------------------------------------------*/
+static const hdf_coder_plugin_t *
+HCIfind_coder(comp_coder_t coder_type)
+{
+    intn i;
+
+    for (i = 0; i < HCInplugins; i++)
+        if (HCIplugins[i].id == coder_type)
+            return &HCIplugins[i];
+    return NULL;
+} /* end HCIfind_coder() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPplugin_coder -- Get the coder plugin of a compression type
+
+ USAGE
+    const hdf_coder_plugin_t *HCPplugin_coder(coder_type)
+    comp_coder_t coder_type;    IN: the compression type
+
+ RETURNS
+    The coder, or NULL if 'coder_type' is not a plugin type or no coder is
+    registered for it
+
+ DESCRIPTION
+    The first time a plugin type has no coder, the directories named by the
+    HDF4_PLUGIN_PATH environment variable are searched for coders.  Nothing
+    is pushed on the error stack.
+--------------------------------------------------------------------------*/
+const hdf_coder_plugin_t *
+HCPplugin_coder(comp_coder_t coder_type)
+{
+    const hdf_coder_plugin_t *plugin;
+    const char               *path;
+
+    if (coder_type < COMP_CODE_PLUGIN_MIN || coder_type > COMP_CODE_PLUGIN_MAX)
+        return NULL;
+
+    if ((plugin = HCIfind_coder(coder_type)) == NULL && !HCIpath_tried) {
+        HCIpath_tried = TRUE;
+        if ((path = getenv(H4_PLUGIN_PATH_ENV)) != NULL && *path != '\0') {
+            HCload_coder_plugins(path);
+            HEclear();
+            plugin = HCIfind_coder(coder_type);
+        }
+    }
+    return plugin;
+} /* end HCPplugin_coder() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCregister_coder -- Register a coder plugin
+
+ USAGE
+    intn HCregister_coder(plugin)
+    const hdf_coder_plugin_t *plugin;   IN: the coder
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Makes the compression type 'plugin->id' usable with SDsetcompress(),
+    SDsetchunk(), GRsetcompress() and GRsetchunk(), and readable from the
+    files written with it.  The structure is copied, but the name and the
+    code it points to must stay valid until the coder is unregistered.
+    'init' is called first and the coder is not registered if it fails.
+
+    A coder is registered for all the files of the process.  Coders must be
+    registered or unregistered while no compressed element is accessed.
+--------------------------------------------------------------------------*/
+intn
+HCregister_coder(const hdf_coder_plugin_t *plugin)
+{
+    intn ret_value = SUCCEED;
+
+    HEclear();
+    if (plugin == NULL || plugin->decode == NULL || plugin->id < COMP_CODE_PLUGIN_MIN ||
+        plugin->id > COMP_CODE_PLUGIN_MAX)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (HCIfind_coder(plugin->id) != NULL)
+        HGOTO_ERROR(DFE_DUPDD, FAIL);
+    if (HCInplugins == H4_MAX_CODER_PLUGINS)
+        HGOTO_ERROR(DFE_TOOMANY, FAIL);
+
+    if (plugin->init != NULL && (*plugin->init)() == FAIL)
+        HGOTO_ERROR(DFE_CINIT, FAIL);
+    HCIplugins[HCInplugins++] = *plugin;
+
+done:
+    return ret_value;
+} /* end HCregister_coder() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCunregister_coder -- Remove a coder plugin
+
+ USAGE
+    intn HCunregister_coder(coder_type)
+    comp_coder_t coder_type;    IN: the compression type of the coder
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Calls the coder's 'term' and removes it, the elements compressed with
+    'coder_type' cannot be accessed any more.
+--------------------------------------------------------------------------*/
+intn
+HCunregister_coder(comp_coder_t coder_type)
+{
+    intn i;
+    intn ret_value = SUCCEED;
+
+    HEclear();
+    for (i = 0; i < HCInplugins; i++)
+        if (HCIplugins[i].id == coder_type)
+            break;
+    if (i == HCInplugins)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (HCIplugins[i].term != NULL)
+        (*HCIplugins[i].term)();
+    HCInplugins--;
+    for (; i < HCInplugins; i++)
+        HCIplugins[i] = HCIplugins[i + 1];
+
+done:
+    return ret_value;
+} /* end HCunregister_coder() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCload_coder_plugins -- Register the coders found in shared libraries
+
+ USAGE
+    intn HCload_coder_plugins(path)
+    const char *path;   IN: directories to search, separated by ':'
+
+ RETURNS
+    The number of coders registered, or FAIL
+
+ DESCRIPTION
+    Opens the shared libraries of the directories in 'path' and registers
+    the coder returned by the function H4PLget_coder() of each library
+    that has one.  Libraries whose coder type is already registered, or
+    that fail to register, are closed again.
+
+    Only available where dlopen() is; FAIL with DFE_UNSUPPORTED elsewhere.
+--------------------------------------------------------------------------*/
+intn
+HCload_coder_plugins(const char *path)
+{
+#ifdef H4_HAVE_CODER_PLUGIN_LOADING
+    const char *dir_start, *dir_end;
+    char       *dir  = NULL;
+    char       *file = NULL;
+    intn        ret_value = 0;
+
+    HEclear();
+    if (path == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    for (dir_start = path; *dir_start != '\0'; dir_start = (*dir_end != '\0' ? dir_end + 1 : dir_end)) {
+        DIR           *dirp;
+        struct dirent *entry;
+        size_t         dir_len;
+
+        if ((dir_end = strchr(dir_start, PLUGIN_PATH_SEP)) == NULL)
+            dir_end = dir_start + strlen(dir_start);
+        if ((dir_len = (size_t)(dir_end - dir_start)) == 0)
+            continue;
+
+        free(dir);
+        if ((dir = (char *)malloc(dir_len + 1)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        memcpy(dir, dir_start, dir_len);
+        dir[dir_len] = '\0';
+
+        if ((dirp = opendir(dir)) == NULL)
+            continue;
+        while ((entry = readdir(dirp)) != NULL) {
+            size_t                    name_len = strlen(entry->d_name);
+            void                     *handle;
+            hdf_coder_plugin_get_t    get_coder;
+            const hdf_coder_plugin_t *plugin;
+
+            if (name_len <= strlen(PLUGIN_SUFFIX) ||
+                strcmp(entry->d_name + name_len - strlen(PLUGIN_SUFFIX), PLUGIN_SUFFIX) != 0)
+                continue;
+
+            free(file);
+            if ((file = (char *)malloc(dir_len + name_len + 2)) == NULL) {
+                closedir(dirp);
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+            }
+            snprintf(file, dir_len + name_len + 2, "%s/%s", dir, entry->d_name);
+
+            if ((handle = dlopen(file, RTLD_NOW | RTLD_LOCAL)) == NULL)
+                continue;
+            *(void **)(&get_coder) = dlsym(handle, H4_PLUGIN_GET_CODER);
+            if (get_coder == NULL || (plugin = (*get_coder)()) == NULL ||
+                HCIfind_coder(plugin->id) != NULL || HCregister_coder(plugin) == FAIL) {
+                dlclose(handle);
+                continue;
+            }
+            ret_value++; /* the library stays open for the life of the process */
+        }
+        closedir(dirp);
+    }
+    HEclear();
+
+done:
+    free(dir);
+    free(file);
+
+    return ret_value;
+#else
+    (void)path;
+    HEclear();
+    HRETURN_ERROR(DFE_UNSUPPORTED, FAIL);
+#endif /* H4_HAVE_CODER_PLUGIN_LOADING */
+} /* end HCload_coder_plugins() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPcplugin_decode_buffer -- Decode a whole element held in memory
+
+ USAGE
+    intn HCPcplugin_decode_buffer(coder_type,c_info,src,src_len,dst,dst_len)
+    comp_coder_t coder_type;    IN: the compression type
+    const comp_info *c_info;    IN: the parameters of the coder
+    const uint8 *src;           IN: the compressed element
+    int32 src_len;              IN: number of bytes in the compressed element
+    uint8 *dst;                 OUT: buffer for the de-compressed element
+    int32 dst_len;              IN: number of bytes of de-compressed data
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Decodes a whole chunk with its coder, the bytes of 'dst' the coder does
+    not write are zeroed.  Nothing is pushed on the error stack, so that the
+    chunk layer may call this from worker threads.
+--------------------------------------------------------------------------*/
+intn
+HCPcplugin_decode_buffer(comp_coder_t coder_type, const comp_info *c_info, const uint8 *src, int32 src_len,
+                         uint8 *dst, int32 dst_len)
+{
+    const hdf_coder_plugin_t *plugin;
+    const uint8              *p = src;
+    uint32                    coded_len;
+    int32                     n;
+
+    if ((plugin = HCIfind_coder(coder_type)) == NULL || src_len < PLUGIN_PREAMBLE)
+        return FAIL;
+
+    UINT32DECODE(p, coded_len);
+    if (coded_len > (uint32)(src_len - PLUGIN_PREAMBLE))
+        return FAIL;
+
+    n = (*plugin->decode)(c_info, p, (int32)coded_len, dst, dst_len);
+    if (n < 0 || n > dst_len)
+        return FAIL;
+    if (n < dst_len)
+        memset(dst + n, 0, (size_t)(dst_len - n));
+
+    return SUCCEED;
+} /* end HCPcplugin_decode_buffer() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcplugin_load -- Bring the element into memory
+
+ USAGE
+    int32 HCIcplugin_load(info)
+    compinfo_t *info;   IN: the info about the compressed element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Reads and decodes the whole element, once.
+--------------------------------------------------------------------------*/
+static int32
+HCIcplugin_load(compinfo_t *info)
+{
+    comp_coder_plugin_info_t *plugin_info; /* ptr to plugin info */
+    int32                     length;
+    uint8                    *raw       = NULL;
+    int32                     ret_value = SUCCEED;
+
+    plugin_info = &(info->cinfo.coder_info.plugin_info);
+    if (plugin_info->buf != NULL)
+        HGOTO_DONE(SUCCEED);
+
+    plugin_info->size  = info->length;
+    plugin_info->alloc = MAX(info->length, 1);
+    if ((plugin_info->buf = (uint8 *)calloc((size_t)plugin_info->alloc, 1)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    if (Hinquire(info->aid, NULL, NULL, NULL, &length, NULL, NULL, NULL, NULL) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (length > 0) {
+        if ((raw = (uint8 *)malloc((size_t)length)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if (Hseek(info->aid, 0, 0) == FAIL)
+            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+        if (Hread(info->aid, length, raw) != length)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        if (HCPcplugin_decode_buffer(info->cinfo.coder_type, &plugin_info->c_info, raw, length,
+                                     plugin_info->buf, plugin_info->size) == FAIL)
+            HGOTO_ERROR(DFE_CDECODE, FAIL);
+    } /* end if */
+    plugin_info->acc_mode = DFACC_READ;
+
+done:
+    if (ret_value == FAIL) {
+        free(plugin_info->buf);
+        plugin_info->buf = NULL;
+    }
+    free(raw);
+
+    return ret_value;
+} /* end HCIcplugin_load() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcplugin_term -- Write the element out if it was changed
+
+ USAGE
+    int32 HCIcplugin_term(info)
+    compinfo_t *info;   IN: the info about the compressed element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Encodes an element that was written to and writes it over the old one,
+    then releases the de-compressed data.
+--------------------------------------------------------------------------*/
+static int32
+HCIcplugin_term(compinfo_t *info)
+{
+    comp_coder_plugin_info_t *plugin_info; /* ptr to plugin info */
+    const hdf_coder_plugin_t *plugin;
+    uint8                    *coded = NULL;
+    uint8                    *p;
+    int32                     bound;
+    int32                     length;
+    int32                     ret_value = SUCCEED;
+
+    plugin_info = &(info->cinfo.coder_info.plugin_info);
+    plugin      = plugin_info->plugin;
+
+    if (plugin_info->acc_mode == DFACC_WRITE) {
+        if (plugin->encode == NULL)
+            HGOTO_ERROR(DFE_NOENCODER, FAIL);
+        if (plugin->bound != NULL)
+            bound = (*plugin->bound)(&plugin_info->c_info, plugin_info->size);
+        else
+            bound = plugin_info->size + plugin_info->size / 8 + 64;
+        if (bound < 0)
+            HGOTO_ERROR(DFE_CENCODE, FAIL);
+
+        if ((coded = (uint8 *)malloc((size_t)bound + PLUGIN_PREAMBLE)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        length = (*plugin->encode)(&plugin_info->c_info, plugin_info->buf, plugin_info->size,
+                                   coded + PLUGIN_PREAMBLE, bound);
+        if (length < 0 || length > bound)
+            HGOTO_ERROR(DFE_CENCODE, FAIL);
+        p = coded;
+        UINT32ENCODE(p, (uint32)length);
+
+        if (Hseek(info->aid, 0, 0) == FAIL)
+            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+        if (Hwrite(info->aid, length + PLUGIN_PREAMBLE, coded) != length + PLUGIN_PREAMBLE)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    } /* end if */
+
+done:
+    free(coded);
+
+    /* Reset parameters */
+    free(plugin_info->buf);
+    plugin_info->buf      = NULL;
+    plugin_info->offset   = 0; /* start at the beginning of the data */
+    plugin_info->acc_mode = 0; /* init access mode to illegal value */
+
+    return ret_value;
+} /* end HCIcplugin_term() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcplugin_staccess -- Start accessing a plugin compressed data element.
+
+ USAGE
+    int32 HCIcplugin_staccess(access_rec, access)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int16 access;           IN: the type of access wanted
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Common code called by HCPcplugin_stread and HCPcplugin_stwrite
+--------------------------------------------------------------------------*/
+static int32
+HCIcplugin_staccess(accrec_t *access_rec, int16 acc_mode)
+{
+    compinfo_t               *info;        /* special element information */
+    comp_coder_plugin_info_t *plugin_info; /* ptr to plugin info */
+
+    info        = (compinfo_t *)access_rec->special_info;
+    plugin_info = &(info->cinfo.coder_info.plugin_info);
+
+    /* need to check for not writing, as opposed to read access */
+    /* because of the way the access works */
+    if (!(acc_mode & DFACC_WRITE)) {
+        info->aid = Hstartread(access_rec->file_id, DFTAG_COMPRESSED, info->comp_ref);
+    } /* end if */
+    else {
+        info->aid = Hstartaccess(access_rec->file_id, DFTAG_COMPRESSED, info->comp_ref,
+                                 DFACC_RDWR | DFACC_APPENDABLE);
+    } /* end else */
+    if (info->aid == FAIL)
+        HRETURN_ERROR(DFE_DENIED, FAIL);
+
+    /* Make certain we can append to the data when writing */
+    if ((acc_mode & DFACC_WRITE) && Happendable(info->aid) == FAIL)
+        HRETURN_ERROR(DFE_DENIED, FAIL);
+
+    /* the data is brought in by the first read or write */
+    plugin_info->offset   = 0;
+    plugin_info->size     = 0;
+    plugin_info->alloc    = 0;
+    plugin_info->acc_mode = 0;
+    plugin_info->buf      = NULL;
+
+    return SUCCEED;
+} /* end HCIcplugin_staccess() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPcplugin_stread -- start read access for compressed file
+
+ USAGE
+    int32 HCPcplugin_stread(access_rec)
+    accrec_t *access_rec;   IN: the access record of the data element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Start read access on a compressed data element using a coder plugin.
+--------------------------------------------------------------------------*/
+int32
+HCPcplugin_stread(accrec_t *access_rec)
+{
+    if (HCIcplugin_staccess(access_rec, DFACC_READ) == FAIL)
+        HRETURN_ERROR(DFE_CINIT, FAIL);
+
+    return SUCCEED;
+} /* HCPcplugin_stread() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPcplugin_stwrite -- start write access for compressed file
+
+ USAGE
+    int32 HCPcplugin_stwrite(access_rec)
+    accrec_t *access_rec;   IN: the access record of the data element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Start write access on a compressed data element using a coder plugin.
+--------------------------------------------------------------------------*/
+int32
+HCPcplugin_stwrite(accrec_t *access_rec)
+{
+    if (HCIcplugin_staccess(access_rec, DFACC_WRITE) == FAIL)
+        HRETURN_ERROR(DFE_CINIT, FAIL);
+
+    return SUCCEED;
+} /* HCPcplugin_stwrite() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPcplugin_seek -- Seek to offset within the data element
+
+ USAGE
+    int32 HCPcplugin_seek(access_rec,offset,origin)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 offset;       IN: the offset in bytes from the origin specified
+    intn origin;        IN: the origin to seek from [UNUSED!]
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Seek to a position with a compressed data element.  The 'offset' is
+    an absolute offset in the element, which is held whole in memory, so
+    seeking in either direction costs nothing.
+--------------------------------------------------------------------------*/
+int32
+HCPcplugin_seek(accrec_t *access_rec, int32 offset, int origin)
+{
+    compinfo_t               *info;        /* special element information */
+    comp_coder_plugin_info_t *plugin_info; /* ptr to plugin info */
+
+    (void)origin;
+
+    info        = (compinfo_t *)access_rec->special_info;
+    plugin_info = &(info->cinfo.coder_info.plugin_info);
+
+    if (offset < 0)
+        HRETURN_ERROR(DFE_RANGE, FAIL);
+    plugin_info->offset = offset;
+
+    return SUCCEED;
+} /* HCPcplugin_seek() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPcplugin_read -- Read in a portion of data from a compressed data element.
+
+ USAGE
+    int32 HCPcplugin_read(access_rec,length,data)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 length;           IN: the number of bytes to read
+    void * data;             OUT: the buffer to place the bytes read
+
+ RETURNS
+    Returns the number of bytes read or FAIL
+
+ DESCRIPTION
+    Read in a number of bytes from the plugin compressed data element.
+--------------------------------------------------------------------------*/
+int32
+HCPcplugin_read(accrec_t *access_rec, int32 length, void *data)
+{
+    compinfo_t               *info;        /* special element information */
+    comp_coder_plugin_info_t *plugin_info; /* ptr to plugin info */
+
+    info        = (compinfo_t *)access_rec->special_info;
+    plugin_info = &(info->cinfo.coder_info.plugin_info);
+
+    if (HCIcplugin_load(info) == FAIL)
+        HRETURN_ERROR(DFE_CDECODE, FAIL);
+
+    /* stop at the end of the element */
+    if (length > plugin_info->size - plugin_info->offset)
+        length = MAX(plugin_info->size - plugin_info->offset, 0);
+
+    memcpy(data, plugin_info->buf + plugin_info->offset, (size_t)length);
+    plugin_info->offset += length;
+
+    return length;
+} /* HCPcplugin_read() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPcplugin_write -- Write out a portion of data from a compressed data element.
+
+ USAGE
+    int32 HCPcplugin_write(access_rec,length,data)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 length;           IN: the number of bytes to write
+    void * data;             IN: the buffer to retrieve the bytes written
+
+ RETURNS
+    Returns the number of bytes written or FAIL
+
+ DESCRIPTION
+    Write out a number of bytes to the plugin compressed data element.  The
+    bytes go into the element in memory, which grows as needed; it is
+    encoded when the access ends.
+--------------------------------------------------------------------------*/
+int32
+HCPcplugin_write(accrec_t *access_rec, int32 length, const void *data)
+{
+    compinfo_t               *info;        /* special element information */
+    comp_coder_plugin_info_t *plugin_info; /* ptr to plugin info */
+    int32                     end;
+
+    info        = (compinfo_t *)access_rec->special_info;
+    plugin_info = &(info->cinfo.coder_info.plugin_info);
+
+    /* a write of the whole element needs nothing of the old one, otherwise
+       keep the bytes that this write does not cover */
+    if (plugin_info->buf != NULL || plugin_info->offset != 0 || length < info->length)
+        if (HCIcplugin_load(info) == FAIL)
+            HRETURN_ERROR(DFE_CDECODE, FAIL);
+
+    end = plugin_info->offset + length;
+    if (end > plugin_info->alloc) {
+        int32  alloc = MAX(end, 2 * plugin_info->alloc);
+        uint8 *buf;
+
+        if ((buf = (uint8 *)realloc(plugin_info->buf, (size_t)alloc)) == NULL)
+            HRETURN_ERROR(DFE_NOSPACE, FAIL);
+        plugin_info->buf   = buf;
+        plugin_info->alloc = alloc;
+    }
+    if (plugin_info->offset > plugin_info->size)
+        memset(plugin_info->buf + plugin_info->size, 0, (size_t)(plugin_info->offset - plugin_info->size));
+
+    memcpy(plugin_info->buf + plugin_info->offset, data, (size_t)length);
+    plugin_info->offset = end;
+    if (end > plugin_info->size)
+        plugin_info->size = end;
+    plugin_info->acc_mode = DFACC_WRITE;
+
+    return length;
+} /* HCPcplugin_write() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPcplugin_inquire -- Inquire information about the access record and data element.
+
+ USAGE
+    int32 HCPcplugin_inquire(access_rec,pfile_id,ptag,pref,plength,poffset,pposn,
+            paccess,pspecial)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 *pfile_id;        OUT: ptr to file id
+    uint16 *ptag;           OUT: ptr to tag of information
+    uint16 *pref;           OUT: ptr to ref of information
+    int32 *plength;         OUT: ptr to length of data element
+    int32 *poffset;         OUT: ptr to offset of data element
+    int32 *pposn;           OUT: ptr to position of access in element
+    int16 *paccess;         OUT: ptr to access mode
+    int16 *pspecial;        OUT: ptr to special code
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Inquire information about the access record and data element.
+    [Currently a NOP].
+--------------------------------------------------------------------------*/
+int32
+HCPcplugin_inquire(accrec_t *access_rec, int32 *pfile_id, uint16 *ptag, uint16 *pref, int32 *plength,
+                   int32 *poffset, int32 *pposn, int16 *paccess, int16 *pspecial)
+{
+    (void)access_rec;
+    (void)pfile_id;
+    (void)ptag;
+    (void)pref;
+    (void)plength;
+    (void)poffset;
+    (void)pposn;
+    (void)paccess;
+    (void)pspecial;
+
+    return SUCCEED;
+} /* HCPcplugin_inquire() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPcplugin_endaccess -- Close the compressed data element
+
+ USAGE
+    int32 HCPcplugin_endaccess(access_rec)
+    accrec_t *access_rec;   IN: the access record of the data element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Close the compressed data element, encoding it first if it was
+    written to.
+--------------------------------------------------------------------------*/
+intn
+HCPcplugin_endaccess(accrec_t *access_rec)
+{
+    compinfo_t *info; /* special element information */
+
+    info = (compinfo_t *)access_rec->special_info;
+
+    /* flush out the element */
+    if (HCIcplugin_term(info) == FAIL)
+        HRETURN_ERROR(DFE_CTERM, FAIL);
+
+    /* close the compressed data AID */
+    if (Hendaccess(info->aid) == FAIL)
+        HRETURN_ERROR(DFE_CANTCLOSE, FAIL);
+
+    return SUCCEED;
+} /* HCPcplugin_endaccess() */
@@ -0,0 +1,69 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*-----------------------------------------------------------------------------
+ * File:    cplugin.h
+ * Purpose: Header file for the coders registered with HCregister_coder().
+ * Dependencies: should only be included from hcompi.h
+ *---------------------------------------------------------------------------*/
+
+#ifndef H4_CPLUGIN_H
+#define H4_CPLUGIN_H
+
+#include "H4api_adpt.h"
+
+/* Coder plugin [en|de]coding information */
+typedef struct {
+    const hdf_coder_plugin_t *plugin;   /* the registered coder */
+    comp_info                 c_info;   /* the parameters of the element */
+    int32                     offset;   /* offset in the de-compressed data */
+    int32                     size;     /* bytes of de-compressed data held */
+    int32                     alloc;    /* bytes allocated for 'buf' */
+    int16                     acc_mode; /* DFACC_WRITE once the data has been written to */
+    uint8                    *buf;      /* the whole de-compressed element */
+} comp_coder_plugin_info_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+HDFLIBAPI funclist_t cplugin_funcs; /* functions to perform plugin encoding */
+
+/*
+ ** from cplugin.c
+ */
+
+HDFLIBAPI int32 HCPcplugin_stread(accrec_t *rec);
+
+HDFLIBAPI int32 HCPcplugin_stwrite(accrec_t *rec);
+
+HDFLIBAPI int32 HCPcplugin_seek(accrec_t *access_rec, int32 offset, int origin);
+
+HDFLIBAPI int32 HCPcplugin_inquire(accrec_t *access_rec, int32 *pfile_id, uint16 *ptag, uint16 *pref,
+                                   int32 *plength, int32 *poffset, int32 *pposn, int16 *paccess,
+                                   int16 *pspecial);
+
+HDFLIBAPI int32 HCPcplugin_read(accrec_t *access_rec, int32 length, void *data);
+
+HDFLIBAPI int32 HCPcplugin_write(accrec_t *access_rec, int32 length, const void *data);
+
+HDFLIBAPI intn HCPcplugin_endaccess(accrec_t *access_rec);
+
+HDFLIBAPI intn HCPcplugin_decode_buffer(comp_coder_t coder_type, const comp_info *c_info, const uint8 *src,
+                                        int32 src_len, uint8 *dst, int32 dst_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H4_CPLUGIN_H */
@@ -38,11 +38,23 @@
 /* HDF compression includes */
 #include "hcompi.h" /* Internal definitions for compression */
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRLE_X86
+#include <immintrin.h>
+#endif
+
 /* internal defines */
 #define TMP_BUF_SIZE 8192 /* size of throw-away buffer */
+#define OUT_BUF_SIZE 2048 /* size of the buffer the encoder collects its codes in */
 #define RUN_MASK     0x80 /* bit mask for run-length control bytes */
 #define COUNT_MASK   0x7f /* bit mask for count of run or mix */
 
+/* Codes made by HCIcrle_encode() and not written yet */
+typedef struct {
+    uint8 buf[OUT_BUF_SIZE];
+    intn  len;
+} crle_out_t;
+
 /* functions to perform run-length encoding */
 funclist_t crle_funcs = {HCPcrle_stread,
                          HCPcrle_stwrite,
@@ -59,12 +71,125 @@ static int32 HCIcrle_staccess(accrec_t *access_rec, int16 acc_mode);
 
 static int32 HCIcrle_init(accrec_t *access_rec);
 
+static int32 HCIcrle_fill(compinfo_t *info);
+
 static int32 HCIcrle_decode(compinfo_t *info, int32 length, uint8 *buf);
 
 static int32 HCIcrle_encode(compinfo_t *info, int32 length, const uint8 *buf);
 
 static int32 HCIcrle_term(compinfo_t *info);
 
+/*****************************************************************************/
+/* VECTOR RUN SCANNING                                                       */
+/*****************************************************************************/
+
+#ifdef CRLE_X86
+/* HCIcrle_runlen() 32 bytes at a time with AVX2 */
+__attribute__((target("avx2"))) static intn
+HCIcrle_runlen_avx2(const uint8 *buf, intn n, uint8 byte)
+{
+    __m256i pattern = _mm256_set1_epi8((char)byte);
+    uint32  differ;
+    intn    i;
+
+    for (i = 0; i + 32 <= n; i += 32) {
+        differ = ~(uint32)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256((const void *)(buf + i)), pattern));
+        if (differ != 0)
+            return i + __builtin_ctz(differ);
+    }
+    while (i < n && buf[i] == byte)
+        i++;
+    return i;
+}
+
+/* HCIcrle_mixlen() 32 bytes at a time with AVX2 */
+__attribute__((target("avx2"))) static intn
+HCIcrle_mixlen_avx2(const uint8 *buf, intn n)
+{
+    __m256i a, b, c;
+    uint32  triples;
+    intn    i;
+
+    for (i = 2; i + 32 <= n; i += 32) {
+        a       = _mm256_loadu_si256((const void *)(buf + i - 2));
+        b       = _mm256_loadu_si256((const void *)(buf + i - 1));
+        c       = _mm256_loadu_si256((const void *)(buf + i));
+        triples =
+            (uint32)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, b), _mm256_cmpeq_epi8(b, c)));
+        if (triples != 0)
+            return i + __builtin_ctz(triples);
+    }
+    for (; i < n; i++)
+        if (buf[i] == buf[i - 1] && buf[i] == buf[i - 2])
+            return i;
+    return n;
+}
+
+static intn HCcrle_avx2    = FALSE; /* whether the processor has AVX2 */
+static intn HCcrle_checked = FALSE; /* whether HCcrle_avx2 was set */
+
+/* Returns whether the AVX2 routines can be used */
+static intn
+HCIcrle_vector(void)
+{
+    if (!HCcrle_checked) {
+        __builtin_cpu_init();
+        HCcrle_avx2    = __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+        HCcrle_checked = TRUE;
+    }
+    return HCcrle_avx2;
+}
+#endif /* CRLE_X86 */
+
+/* Returns the number of the first 'n' bytes of 'buf' equal to 'byte' */
+static intn
+HCIcrle_runlen(const uint8 *buf, intn n, uint8 byte)
+{
+    intn i;
+
+#ifdef CRLE_X86
+    if (HCIcrle_vector())
+        return HCIcrle_runlen_avx2(buf, n, byte);
+#endif
+    for (i = 0; i < n && buf[i] == byte; i++)
+        ;
+    return i;
+}
+
+/* Returns the offset of the first of the 'n' bytes of 'buf' equal to the
+   two bytes before it, from the third one on, 'n' if there is none */
+static intn
+HCIcrle_mixlen(const uint8 *buf, intn n)
+{
+    intn i;
+
+#ifdef CRLE_X86
+    if (HCIcrle_vector())
+        return HCIcrle_mixlen_avx2(buf, n);
+#endif
+    for (i = 2; i < n; i++)
+        if (buf[i] == buf[i - 1] && buf[i] == buf[i - 2])
+            return i;
+    return n;
+}
+
+/* Adds a code and the 'len' bytes of 'data' that go with it to 'out',
+   writing what 'out' holds first when they do not fit */
+static intn
+HCIcrle_emit(compinfo_t *info, crle_out_t *out, intn code, const uint8 *data, intn len)
+{
+    if (out->len + 1 + len > OUT_BUF_SIZE) {
+        if (Hwrite(info->aid, out->len, out->buf) == FAIL)
+            return FAIL;
+        out->len = 0;
+    }
+    out->buf[out->len++] = (uint8)code;
+    memcpy(&out->buf[out->len], data, (size_t)len);
+    out->len += len;
+    return SUCCEED;
+}
+
 /*--------------------------------------------------------------------------
  NAME
     HCIcrle_init -- Initialize a RLE compressed data element.
@@ -102,10 +227,102 @@ HCIcrle_init(accrec_t *access_rec)
     rle_info->last_byte   = (uintn)RLE_NIL; /* start with no code in the last byte */
     rle_info->second_byte = (uintn)RLE_NIL; /* start with no code here too */
     rle_info->offset      = 0;              /* offset into the file */
+    rle_info->in_len      = 0;              /* nothing read ahead yet */
+    rle_info->in_pos      = 0;
 
     return SUCCEED;
 } /* end HCIcrle_init() */
 
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcrle_fill -- Read the next block of RLE compressed bytes.
+
+ USAGE
+    int32 HCIcrle_fill(info)
+    compinfo_t *info;   IN: the info about the compressed element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Reads up to RLE_IN_BUF_SIZE bytes of the compressed data into the
+    read-ahead buffer of the decoder, allocating it on first use.  It
+    fails at the end of the compressed data.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+static int32
+HCIcrle_fill(compinfo_t *info)
+{
+    comp_coder_rle_info_t *rle_info; /* ptr to RLE info */
+    int32                  n;        /* number of bytes read */
+
+    rle_info = &(info->cinfo.coder_info.rle_info);
+
+    if (rle_info->in_buf == NULL && (rle_info->in_buf = (uint8 *)malloc(RLE_IN_BUF_SIZE)) == NULL)
+        HRETURN_ERROR(DFE_NOSPACE, FAIL);
+
+    if ((n = Hread(info->aid, RLE_IN_BUF_SIZE, rle_info->in_buf)) == FAIL || n == 0)
+        HRETURN_ERROR(DFE_READERROR, FAIL);
+    rle_info->in_len = (intn)n;
+    rle_info->in_pos = 0;
+
+    return SUCCEED;
+} /* end HCIcrle_fill() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPcrle_decode_buffer -- Decode a whole RLE stream in memory
+
+ USAGE
+    intn HCPcrle_decode_buffer(src, src_len, dst, dst_len)
+    const uint8 *src;   IN: the compressed stream
+    int32 src_len;      IN: length of the compressed stream
+    uint8 *dst;         OUT: buffer for the decoded data
+    int32 dst_len;      IN: expected length of the decoded data
+
+ RETURNS
+    Returns SUCCEED if the stream decoded to at least dst_len bytes, FAIL
+    otherwise
+
+ DESCRIPTION
+    Runs are expanded with memset() and mixes copied with memcpy()
+    straight from the stream into the buffer.  Safe to call from worker
+    threads: nothing is pushed on the error stack.
+--------------------------------------------------------------------------*/
+intn
+HCPcrle_decode_buffer(const uint8 *src, int32 src_len, uint8 *dst, int32 dst_len)
+{
+    const uint8 *src_end = src + src_len; /* end of the compressed stream */
+    int32        dec_len;                 /* length of the run or mix */
+
+    while (dst_len > 0) {
+        if (src >= src_end)
+            return FAIL;
+        if (*src & RUN_MASK) { /* run byte */
+            dec_len = MIN((*src & COUNT_MASK) + RLE_MIN_RUN, dst_len);
+            if (src + 1 >= src_end)
+                return FAIL;
+            memset(dst, src[1], (size_t)dec_len);
+            src += 2;
+        }      /* end if */
+        else { /* mix byte */
+            dec_len = MIN((*src & COUNT_MASK) + RLE_MIN_MIX, dst_len);
+            if (dec_len > src_end - (src + 1))
+                return FAIL;
+            memcpy(dst, src + 1, (size_t)dec_len);
+            src += dec_len + 1;
+        } /* end else */
+        dst += dec_len;
+        dst_len -= dec_len;
+    } /* end while */
+
+    return SUCCEED;
+} /* end HCPcrle_decode_buffer() */
+
 /*--------------------------------------------------------------------------
  NAME
     HCIcrle_decode -- Decode RLE compressed data into a buffer.
@@ -120,7 +337,9 @@ HCIcrle_init(accrec_t *access_rec)
     Returns SUCCEED or FAIL
 
  DESCRIPTION
-    Common code called to decode RLE data from the file.
+    Common code called to decode RLE data from the file.  The compressed
+    bytes are read ahead RLE_IN_BUF_SIZE at a time, runs are expanded with
+    memset() and mixes copied with memcpy() straight from them.
 
  GLOBAL VARIABLES
  COMMENTS, BUGS, ASSUMPTIONS
@@ -132,7 +351,7 @@ HCIcrle_decode(compinfo_t *info, int32 length, uint8 *buf)
 {
     comp_coder_rle_info_t *rle_info;    /* ptr to RLE info */
     int32                  orig_length; /* original length to read */
-    uintn                  dec_len;     /* length to decode */
+    intn                   dec_len;     /* length to decode */
     intn                   c;           /* character to hold a byte read in */
 
     rle_info = &(info->cinfo.coder_info.rle_info);
@@ -140,37 +359,37 @@ HCIcrle_decode(compinfo_t *info, int32 length, uint8 *buf)
     orig_length = length;                      /* save this for later */
     while (length > 0) {                       /* decode until we have all the bytes we need */
         if (rle_info->rle_state == RLE_INIT) { /* need to figure out RUN or MIX state */
-            if ((c = HDgetc(info->aid)) == FAIL)
+            if (rle_info->in_pos >= rle_info->in_len && HCIcrle_fill(info) == FAIL)
                 HRETURN_ERROR(DFE_READERROR, FAIL);
+            c = rle_info->in_buf[rle_info->in_pos++];
             if (c & RUN_MASK) {                                        /* run byte */
                 rle_info->rle_state  = RLE_RUN;                        /* set to run state */
                 rle_info->buf_length = (c & COUNT_MASK) + RLE_MIN_RUN; /* run length */
-                if ((rle_info->last_byte = (uintn)HDgetc(info->aid)) == (uintn)FAIL)
+                if (rle_info->in_pos >= rle_info->in_len && HCIcrle_fill(info) == FAIL)
                     HRETURN_ERROR(DFE_READERROR, FAIL);
+                rle_info->last_byte = (uintn)rle_info->in_buf[rle_info->in_pos++];
             }                                                          /* end if */
             else {                                                     /* mix byte */
                 rle_info->rle_state  = RLE_MIX;                        /* set to mix state */
                 rle_info->buf_length = (c & COUNT_MASK) + RLE_MIN_MIX; /* mix length */
-                if (Hread(info->aid, rle_info->buf_length, rle_info->buffer) == FAIL)
-                    HRETURN_ERROR(DFE_READERROR, FAIL);
-                rle_info->buf_pos = 0;
-            } /* end else */
-        }     /* end if */
+            }                                                          /* end else */
+        }                                                              /* end if */
 
         /* RUN or MIX states */
-        if (length > rle_info->buf_length) /* still need more data */
-            dec_len = (uintn)rle_info->buf_length;
-        else /* only grab "length" bytes */
-            dec_len = (uintn)length;
+        dec_len = (intn)MIN(length, rle_info->buf_length);
 
         if (rle_info->rle_state == RLE_RUN)
-            memset(buf, rle_info->last_byte, dec_len); /* copy the run */
+            memset(buf, (int)rle_info->last_byte, (size_t)dec_len); /* copy the run */
         else {
-            memcpy(buf, &(rle_info->buffer[rle_info->buf_pos]), dec_len);
-            rle_info->buf_pos += (intn)dec_len;
+            /* copy the mix straight from the bytes read ahead */
+            if (rle_info->in_pos >= rle_info->in_len && HCIcrle_fill(info) == FAIL)
+                HRETURN_ERROR(DFE_READERROR, FAIL);
+            dec_len = MIN(dec_len, rle_info->in_len - rle_info->in_pos);
+            memcpy(buf, &(rle_info->in_buf[rle_info->in_pos]), (size_t)dec_len);
+            rle_info->in_pos += dec_len;
         } /* end else */
 
-        rle_info->buf_length -= (intn)dec_len;
+        rle_info->buf_length -= dec_len;
         if (rle_info->buf_length <= 0)      /* check for running out of bytes */
             rle_info->rle_state = RLE_INIT; /* get the next status byte */
         length -= (int32)dec_len;           /* decrement the bytes to get */
@@ -195,7 +414,11 @@ HCIcrle_decode(compinfo_t *info, int32 length, uint8 *buf)
     Returns SUCCEED or FAIL
 
  DESCRIPTION
-    Common code called to encode RLE data into a file.
+    Common code called to encode RLE data into a file.  The end of a run,
+    and the start of the next one in mixed bytes, are searched for many
+    bytes at a time, with AVX2 where the processor has it, and the codes
+    are collected to be written at once, in the same bytes as when they
+    were searched for one byte at a time.
 
  GLOBAL VARIABLES
  COMMENTS, BUGS, ASSUMPTIONS
@@ -207,10 +430,14 @@ HCIcrle_encode(compinfo_t *info, int32 length, const uint8 *buf)
 {
     comp_coder_rle_info_t *rle_info;    /* ptr to RLE info */
     int32                  orig_length; /* original length to write */
-    intn                   c;           /* character to hold a byte read in */
+    crle_out_t             out;         /* codes not written yet */
+    uint8                  run_byte;    /* byte of the run */
+    intn                   room;        /* # of bytes the run or mix can take */
+    intn                   n;           /* # of bytes the run or mix took */
 
     rle_info = &(info->cinfo.coder_info.rle_info);
 
+    out.len     = 0;
     orig_length = length; /* save this for later */
     while (length > 0) {  /* encode until we stored all the bytes */
         switch (rle_info->rle_state) {
@@ -224,64 +451,78 @@ HCIcrle_encode(compinfo_t *info, int32 length, const uint8 *buf)
                 break;
 
             case RLE_RUN:
-                /* check for end of run */
-                if ((uintn)*buf != rle_info->last_byte) {
-                    rle_info->rle_state = RLE_MIX;
-                    c                   = RUN_MASK | (rle_info->buf_length - RLE_MIN_RUN);
-                    if (HDputc((uint8)c, info->aid) == FAIL)
+                /* take all the bytes the run goes on with at once */
+                run_byte = (uint8)rle_info->last_byte;
+                room     = (intn)MIN(length, RLE_MAX_RUN - rle_info->buf_length);
+                n        = HCIcrle_runlen(buf, room, run_byte);
+                rle_info->buf_length += n;
+                buf += n;
+                length -= n;
+
+                if (rle_info->buf_length >= RLE_MAX_RUN) { /* check for too long */
+                    if (HCIcrle_emit(info, &out, RUN_MASK | (rle_info->buf_length - RLE_MIN_RUN), &run_byte,
+                                     1) == FAIL)
                         HRETURN_ERROR(DFE_WRITEERROR, FAIL);
-                    if (HDputc((uint8)rle_info->last_byte, info->aid) == FAIL)
+                    rle_info->rle_state   = RLE_INIT;
+                    rle_info->second_byte = rle_info->last_byte = (uintn)RLE_NIL;
+                }                       /* end if */
+                else if (length > 0) { /* check for end of run */
+                    if (HCIcrle_emit(info, &out, RUN_MASK | (rle_info->buf_length - RLE_MIN_RUN), &run_byte,
+                                     1) == FAIL)
                         HRETURN_ERROR(DFE_WRITEERROR, FAIL);
+                    rle_info->rle_state  = RLE_MIX;
                     rle_info->last_byte  = (uintn)(rle_info->buffer[0] = *buf);
                     rle_info->buf_length = 1;
                     rle_info->buf_pos    = 1;
-                }      /* end if */
-                else { /* run is continuing */
-                    rle_info->buf_length++;
-                    if (rle_info->buf_length >= RLE_MAX_RUN) { /* check for too long */
-                        c = RUN_MASK | (rle_info->buf_length - RLE_MIN_RUN);
-                        if (HDputc((uint8)c, info->aid) == FAIL)
-                            HRETURN_ERROR(DFE_WRITEERROR, FAIL);
-                        if (HDputc((uint8)rle_info->last_byte, info->aid) == FAIL)
-                            HRETURN_ERROR(DFE_WRITEERROR, FAIL);
-                        rle_info->rle_state   = RLE_INIT;
-                        rle_info->second_byte = rle_info->last_byte = (uintn)RLE_NIL;
-                    } /* end if */
-                }     /* end else */
-                buf++;
-                length--;
+                    buf++;
+                    length--;
+                } /* end if */
                 break;
 
             case RLE_MIX: /* mixed bunch of bytes */
-                /* check for run */
-                if ((uintn)*buf == rle_info->last_byte && (uintn)*buf == rle_info->second_byte) {
+                /* take all the bytes up to the next run at once, as many as
+                   fit in the buffer; the first two of them make a run with
+                   the bytes already in it */
+                room = (intn)MIN(length, RLE_BUF_SIZE - rle_info->buf_length);
+                if ((uintn)buf[0] == rle_info->last_byte && (uintn)buf[0] == rle_info->second_byte)
+                    n = 0;
+                else if (room > 1 && buf[1] == buf[0] && (uintn)buf[1] == rle_info->last_byte)
+                    n = 1;
+                else
+                    n = HCIcrle_mixlen(buf, room);
+
+                memcpy(&rle_info->buffer[rle_info->buf_length], buf, (size_t)n);
+                if (n > 1) {
+                    rle_info->second_byte = (uintn)buf[n - 2];
+                    rle_info->last_byte   = (uintn)buf[n - 1];
+                } /* end if */
+                else if (n == 1) {
+                    rle_info->second_byte = rle_info->last_byte;
+                    rle_info->last_byte   = (uintn)buf[0];
+                } /* end if */
+                rle_info->buf_length += n;
+                rle_info->buf_pos = rle_info->buf_length;
+                buf += n;
+                length -= n;
+
+                if (rle_info->buf_length >= RLE_BUF_SIZE) { /* check for too long */
+                    if (HCIcrle_emit(info, &out, rle_info->buf_length - RLE_MIN_MIX, rle_info->buffer,
+                                     rle_info->buf_length) == FAIL)
+                        HRETURN_ERROR(DFE_WRITEERROR, FAIL);
+                    rle_info->rle_state   = RLE_INIT;
+                    rle_info->second_byte = rle_info->last_byte = (uintn)RLE_NIL;
+                }                   /* end if */
+                else if (n < room) { /* check for run */
                     rle_info->rle_state = RLE_RUN;                  /* shift to RUN state */
                     if (rle_info->buf_length > (RLE_MIN_RUN - 1)) { /* check for mixed data to write */
-                        if (HDputc((uint8)((rle_info->buf_length - RLE_MIN_MIX) - (RLE_MIN_RUN - 1)),
-                                   info->aid) == FAIL)
-                            HRETURN_ERROR(DFE_WRITEERROR, FAIL);
-                        if (Hwrite(info->aid, (rle_info->buf_length - (RLE_MIN_RUN - 1)), rle_info->buffer) ==
-                            FAIL)
+                        if (HCIcrle_emit(info, &out, (rle_info->buf_length - RLE_MIN_MIX) - (RLE_MIN_RUN - 1),
+                                         rle_info->buffer, rle_info->buf_length - (RLE_MIN_RUN - 1)) == FAIL)
                             HRETURN_ERROR(DFE_WRITEERROR, FAIL);
                     } /* end if */
                     rle_info->buf_length = RLE_MIN_RUN;
-                }      /* end if */
-                else { /* continue MIX */
-                    rle_info->second_byte = rle_info->last_byte;
-                    rle_info->last_byte   = (uintn)(rle_info->buffer[rle_info->buf_pos] = *buf);
-                    rle_info->buf_length++;
-                    rle_info->buf_pos++;
-                    if (rle_info->buf_length >= RLE_BUF_SIZE) { /* check for too long */
-                        if (HDputc((uint8)(rle_info->buf_length - RLE_MIN_MIX), info->aid) == FAIL)
-                            HRETURN_ERROR(DFE_WRITEERROR, FAIL);
-                        if (Hwrite(info->aid, rle_info->buf_length, rle_info->buffer) == FAIL)
-                            HRETURN_ERROR(DFE_WRITEERROR, FAIL);
-                        rle_info->rle_state   = RLE_INIT;
-                        rle_info->second_byte = rle_info->last_byte = (uintn)RLE_NIL;
-                    } /* end if */
-                }     /* end else */
-                buf++;
-                length--;
+                    buf++;
+                    length--;
+                } /* end if */
                 break;
 
             default:
@@ -289,6 +530,9 @@ HCIcrle_encode(compinfo_t *info, int32 length, const uint8 *buf)
         } /* end switch */
     }     /* end while */
 
+    if (out.len > 0 && Hwrite(info->aid, out.len, out.buf) == FAIL)
+        HRETURN_ERROR(DFE_WRITEERROR, FAIL);
+
     rle_info->offset += orig_length; /* incr. abs. offset into the file */
     return SUCCEED;
 } /* end HCIcrle_encode() */
@@ -380,7 +624,8 @@ HCIcrle_staccess(accrec_t *access_rec, int16 acc_mode)
 
     if (info->aid == FAIL)
         HRETURN_ERROR(DFE_DENIED, FAIL);
-    return HCIcrle_init(access_rec); /* initialize the RLE info */
+    info->cinfo.coder_info.rle_info.in_buf = NULL; /* allocated when first decoding */
+    return HCIcrle_init(access_rec);               /* initialize the RLE info */
 } /* end HCIcrle_staccess() */
 
 /*--------------------------------------------------------------------------
@@ -574,6 +819,13 @@ HCPcrle_write(accrec_t *access_rec, int32 length, const void *data)
         (rle_info->offset != 0 && length <= (info->length - rle_info->offset)))
         HRETURN_ERROR(DFE_UNSUPPORTED, FAIL);
 
+    /* give back the bytes the decoder read ahead, so the codes go right after the last one read */
+    if (rle_info->in_pos < rle_info->in_len) {
+        if (Hseek(info->aid, -(int32)(rle_info->in_len - rle_info->in_pos), DF_CURRENT) == FAIL)
+            HRETURN_ERROR(DFE_SEEKERROR, FAIL);
+        rle_info->in_len = rle_info->in_pos = 0;
+    } /* end if */
+
     if (HCIcrle_encode(info, length, data) == FAIL)
         HRETURN_ERROR(DFE_CENCODE, FAIL);
 
@@ -659,6 +911,9 @@ HCPcrle_endaccess(accrec_t *access_rec)
         if (HCIcrle_term(info) == FAIL)
             HRETURN_ERROR(DFE_CTERM, FAIL);
 
+    free(rle_info->in_buf);
+    rle_info->in_buf = NULL;
+
     /* close the compressed data AID */
     if (Hendaccess(info->aid) == FAIL)
         HRETURN_ERROR(DFE_CANTCLOSE, FAIL);
@@ -40,6 +40,9 @@
 /* minimum length of mix */
 #define RLE_MIN_MIX 1
 
+/* size of the buffer the decoder reads the compressed bytes into */
+#define RLE_IN_BUF_SIZE 8192
+
 /*
  * Notes on RLE_MIN_RUN and RLE_MIN_MIX:
  * (excerpt from QAK's email to RA - see bug HDFFR-1261)
@@ -69,6 +72,9 @@ typedef struct {
         RLE_RUN,  /* buffer up to the current position is a run */
         RLE_MIX   /* buffer up to the current position is a mix */
     } rle_state;  /* state of the buffer storage */
+    uint8 *in_buf; /* compressed bytes read ahead by the decoder */
+    intn   in_len; /* number of bytes in 'in_buf' */
+    intn   in_pos; /* offset of the next byte to decode in 'in_buf' */
 } comp_coder_rle_info_t;
 
 #ifdef __cplusplus
@@ -97,6 +103,8 @@ HDFLIBAPI int32 HCPcrle_write(accrec_t *access_rec, int32 length, const void *da
 
 HDFLIBAPI intn HCPcrle_endaccess(accrec_t *access_rec);
 
+HDFLIBAPI intn HCPcrle_decode_buffer(const uint8 *src, int32 src_len, uint8 *dst, int32 dst_len);
+
 #ifdef __cplusplus
 }
 #endif
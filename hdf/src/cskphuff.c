@@ -44,6 +44,7 @@
 
 /* Internal Defines */
 #define TMP_BUF_SIZE 8192 /* size of throw-away buffer */
+#define READ_AHEAD   32   /* number of bits the decoder reads from the file at once */
 
 /* functions to perform skipping huffman encoding */
 funclist_t cskphuff_funcs = {HCPcskphuff_stread,
@@ -85,36 +86,30 @@ HCIcskphuff_splay(comp_coder_skphuff_info_t *skphuff_info, uint8 plain)
     uintn  a, b;     /* children of nodes to semi-rotate */
     uint8  c, d;     /* pair of nodes to semi-rotate */
     intn   skip_num; /* the tree we are splaying */
-    uintn *lleft,    /* local copy of the left pointer */
-        *lright;     /* local copy of the right pointer */
+    uintn *child[2]; /* local copies of the left & right pointers */
+    uintn  s;        /* which child of a node to exchange */
     uint8 *lup;      /* local copy of the up pointer */
 
     skip_num = skphuff_info->skip_pos; /* get the tree number to splay */
 
     /* Get the tree pointers */
-    lleft  = skphuff_info->left[skip_num];
-    lright = skphuff_info->right[skip_num];
-    lup    = skphuff_info->up[skip_num];
+    child[0] = skphuff_info->left[skip_num];
+    child[1] = skphuff_info->right[skip_num];
+    lup      = skphuff_info->up[skip_num];
 
     a = (uintn)plain + SUCCMAX; /* get the index for this source code in the up array */
     do {                        /* walk up the tree, semi-rotating pairs */
         c = lup[a];             /* find the parent of the node to semi-rotate around */
         if (c != ROOT) {        /* a pair remain above this node */
             d = lup[(int)c];    /* get the grand-parent of the node to semi-rotate around */
-            b = lleft[(int)d];
 
-            /* Exchange the children of the pair */
-            if ((uintn)c == b) {
-                b              = lright[(int)d];
-                lright[(int)d] = a;
-            } /* end if */
-            else
-                lleft[(int)d] = a;
-
-            if (a == lleft[(int)c])
-                lleft[(int)c] = b;
-            else
-                lright[(int)c] = b;
+            /* Exchange the children of the pair, the sides are looked */
+            /* up rather than branched on since they are unpredictable */
+            s                = (child[0][(int)d] == (uintn)c); /* the other child of 'd' trades with 'a' */
+            b                = child[s][(int)d];
+            child[s][(int)d] = a;
+            s                = (child[0][(int)c] != a); /* the side of 'c' which 'a' is on */
+            child[s][(int)c] = b;
 
             lup[a] = d;
             lup[b] = c;
@@ -161,8 +156,11 @@ HCIcskphuff_init(accrec_t *access_rec, uintn alloc_buf)
     skphuff_info = &(info->cinfo.coder_info.skphuff_info);
 
     /* Initialize RLE state information */
-    skphuff_info->skip_pos = 0; /* start in first byte */
-    skphuff_info->offset   = 0; /* start at the beginning of the data */
+    skphuff_info->skip_pos   = 0; /* start in first byte */
+    skphuff_info->offset     = 0; /* start at the beginning of the data */
+    skphuff_info->bit_buf    = 0; /* nothing read ahead yet */
+    skphuff_info->bit_count  = 0;
+    skphuff_info->bytes_read = 0;
 
     if (alloc_buf == TRUE) {
         /* allocate pointers to the compression buffers */
@@ -213,6 +211,10 @@ HCIcskphuff_init(accrec_t *access_rec, uintn alloc_buf)
 
  DESCRIPTION
     Common code called to decode skipping Huffman data from the file.
+    The tree changes after every code, so the bits of each code are
+    walked one at a time, but they are taken from bits read ahead
+    READ_AHEAD at a time instead of with one Hbitread() per bit.  The
+    bits left over are kept for the next call.
 
  GLOBAL VARIABLES
  COMMENTS, BUGS, ASSUMPTIONS
@@ -224,21 +226,34 @@ HCIcskphuff_decode(compinfo_t *info, int32 length, uint8 *buf)
 {
     comp_coder_skphuff_info_t *skphuff_info; /* ptr to skipping Huffman info */
     int32                      orig_length;  /* original length to read */
-    uint32                     bit;          /* bit from the file */
+    uint32                     bits;         /* bits read ahead from the file */
+    intn                       nbits;        /* number of bits left in 'bits' */
+    intn                       n;            /* number of bits read from the file */
+    uintn                     *child[2];     /* local copies of the left & right pointers */
     uintn                      a;
-    uint8                      plain; /* the source code expanded from the file */
+    uint8                      plain;        /* the source code expanded from the file */
 
     skphuff_info = &(info->cinfo.coder_info.skphuff_info);
+    bits         = skphuff_info->bit_buf;
+    nbits        = skphuff_info->bit_count;
 
     orig_length = length; /* save this for later */
     while (length > 0) {  /* decode until we have all the bytes we need */
-        a = ROOT;         /* start at the root of the tree and find the leaf we need */
+        child[0] = skphuff_info->left[skphuff_info->skip_pos];
+        child[1] = skphuff_info->right[skphuff_info->skip_pos];
+        a        = ROOT; /* start at the root of the tree and find the leaf we need */
 
         do { /* walk down once for each bit on the path */
-            if (Hbitread(info->aid, 1, &bit) == FAIL)
-                HRETURN_ERROR(DFE_CDECODE, FAIL);
-            a = ((bit == 0) ? (skphuff_info->left[skphuff_info->skip_pos][a])
-                            : (skphuff_info->right[skphuff_info->skip_pos][a]));
+            if (nbits == 0) {
+                /* the element is whole bytes, so only its last read can be short */
+                if ((n = Hbitread(info->aid, READ_AHEAD, &bits)) <= 0)
+                    HRETURN_ERROR(DFE_CDECODE, FAIL);
+                if (n < READ_AHEAD)
+                    bits >>= READ_AHEAD - n; /* a short read leaves the bits at the top */
+                skphuff_info->bytes_read += n / 8;
+                nbits = n;
+            } /* end if */
+            a = child[(bits >> --nbits) & 1][a]; /* indexed rather than branched on, the bits are random */
         } while (a <= SKPHUFF_MAX_CHAR);
 
         plain = (uint8)(a - SUCCMAX);
@@ -246,7 +261,9 @@ HCIcskphuff_decode(compinfo_t *info, int32 length, uint8 *buf)
         skphuff_info->skip_pos = (skphuff_info->skip_pos + 1) % skphuff_info->skip_size;
         *buf++                 = plain;
         length--;
-    }                                    /* end while */
+    } /* end while */
+    skphuff_info->bit_buf   = bits;
+    skphuff_info->bit_count = nbits;
     skphuff_info->offset += orig_length; /* incr. abs. offset into the file */
     return SUCCEED;
 } /* end HCIcskphuff_decode() */
@@ -603,6 +620,14 @@ HCPcskphuff_write(accrec_t *access_rec, int32 length, const void *data)
     if ((info->length != skphuff_info->offset) && (skphuff_info->offset != 0 && length <= info->length))
         HRETURN_ERROR(DFE_UNSUPPORTED, FAIL);
 
+    /* give back the bits the decoder read ahead, so the codes go right after the last one read */
+    if (skphuff_info->bit_count > 0) {
+        if (Hbitseek(info->aid, skphuff_info->bytes_read - (skphuff_info->bit_count + 7) / 8,
+                     (8 - skphuff_info->bit_count % 8) % 8) == FAIL)
+            HRETURN_ERROR(DFE_SEEKERROR, FAIL);
+        skphuff_info->bit_count = 0;
+    } /* end if */
+
     if (HCIcskphuff_encode(info, length, data) == FAIL)
         HRETURN_ERROR(DFE_CENCODE, FAIL);
 
@@ -37,9 +37,12 @@ typedef struct {
     intn    skip_size; /* number of bytes in each element */
     uintn **left,      /* define the left and right pointer arrays */
         **right;
-    uint8 **up;       /* define the up pointer array */
-    intn    skip_pos; /* current byte to read or write */
-    int32   offset;   /* offset in the de-compressed array */
+    uint8 **up;         /* define the up pointer array */
+    intn    skip_pos;   /* current byte to read or write */
+    int32   offset;     /* offset in the de-compressed array */
+    uint32  bit_buf;    /* bits read ahead from the file, in the low bits */
+    intn    bit_count;  /* number of bits in 'bit_buf' not yet decoded */
+    int32   bytes_read; /* number of bytes read into 'bit_buf' in total */
 } comp_coder_skphuff_info_t;
 
 #ifdef __cplusplus
@@ -327,6 +327,75 @@ HCIcszip_decode(compinfo_t *info, int32 length, uint8 *buf)
 
 } /* end HCIcszip_decode() */
 
+/*--------------------------------------------------------------------------
+ NAME
+    HCPcszip_decode_buffer -- Decode a whole SZIP compressed chunk in memory
+
+ USAGE
+    intn HCPcszip_decode_buffer(c_info, src, src_len, dst, dst_len)
+    const comp_info *c_info; IN: the szip parameters of the element
+    const uint8 *src;   IN: the compressed data, preamble included
+    int32 src_len;      IN: length of the compressed data
+    uint8 *dst;         OUT: buffer for the decoded data
+    int32 dst_len;      IN: expected length of the decoded data
+
+ RETURNS
+    Returns SUCCEED if the data decoded to exactly dst_len bytes, FAIL
+    otherwise
+
+ DESCRIPTION
+    Only for data written since V4.2r1, i.e. with SZ_H4_REV_2 set in the
+    options mask, whose 5 byte preamble tells whether the data was stored
+    compressed at all.  The data is decoded with a single
+    SZ_BufftoBuffDecompress() call straight into the buffer, without the
+    input and output copies of HCIcszip_decode().  Safe to call from
+    worker threads: nothing is pushed on the error stack.
+--------------------------------------------------------------------------*/
+intn
+HCPcszip_decode_buffer(const comp_info *c_info, const uint8 *src, int32 src_len, uint8 *dst, int32 dst_len)
+{
+#ifdef H4_HAVE_LIBSZ
+    const uint8 *cp;
+    int32        good_bytes;
+    size_t       size_out;
+    SZ_com_t     sz_param;
+
+    if (!(c_info->szip.options_mask & SZ_H4_REV_2) || src_len < 5)
+        return FAIL;
+
+    cp = src + 1;
+    INT32DECODE(cp, good_bytes);
+    if (good_bytes < 0 || good_bytes > src_len - 5)
+        return FAIL;
+
+    if (src[0] == 1) {
+        /* the data was not compressed -- just copy out */
+        if (good_bytes != dst_len)
+            return FAIL;
+        memcpy(dst, src + 5, (size_t)dst_len);
+        return SUCCEED;
+    }
+
+    sz_param.options_mask        = (c_info->szip.options_mask & ~SZ_H4_REV_2);
+    sz_param.bits_per_pixel      = c_info->szip.bits_per_pixel;
+    sz_param.pixels_per_block    = c_info->szip.pixels_per_block;
+    sz_param.pixels_per_scanline = c_info->szip.pixels_per_scanline;
+    size_out                     = (size_t)dst_len;
+    if (SZ_BufftoBuffDecompress(dst, &size_out, src + 5, (size_t)good_bytes, &sz_param) != SZ_OK)
+        return FAIL;
+
+    return (size_out == (size_t)dst_len) ? SUCCEED : FAIL;
+#else  /* ifdef H4_HAVE_LIBSZ */
+    (void)c_info;
+    (void)src;
+    (void)src_len;
+    (void)dst;
+    (void)dst_len;
+
+    return FAIL;
+#endif /* H4_HAVE_LIBSZ */
+} /* end HCPcszip_decode_buffer() */
+
 /*--------------------------------------------------------------------------
  NAME
     HCIcszip_encode -- Encode data from a buffer into SZIP compressed data
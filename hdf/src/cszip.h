@@ -78,6 +78,9 @@ HDFLIBAPI int32 HCPcszip_write(accrec_t *access_rec, int32 length, const void *d
 
 HDFLIBAPI intn HCPcszip_endaccess(accrec_t *access_rec);
 
+HDFLIBAPI intn HCPcszip_decode_buffer(const comp_info *c_info, const uint8 *src, int32 src_len, uint8 *dst,
+                                     int32 dst_len);
+
 /*
  * prototype in proto.h
  * HDFLIBAPI intn HCPsetup_szip_parms(comp_info *c_info, int32 nt, int32 ncomp, int32 ndims, int32 *dims,
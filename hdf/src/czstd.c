@@ -0,0 +1,695 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*
+   FILE
+   czstd.c
+   HDF zstd encoding I/O routines
+
+   REMARKS
+   Each compressed element holds a single zstd frame, written and read with
+   the streaming zstd interface, so that the element can be written and
+   read piecewise like the other coders.
+
+   DESIGN
+   Modeled on cdeflate.c: the access is set up in two stages, and a seek
+   backwards restarts decoding from the beginning of the element.
+
+   EXPORTED ROUTINES
+   None of these routines are designed to be called by other users except
+   for the modeling layer of the compression routines.
+ */
+
+/* General HDF includes */
+#include "hdf.h"
+
+/* HDF compression includes */
+#include "hcompi.h" /* Internal definitions for compression */
+
+#ifdef H4_HAVE_LIBZSTD
+
+#include <zstd.h>
+
+/* Define the size of the temporary buffer used when seeking */
+#define ZSTD_TMP_BUF_SIZE 16384
+
+/* functions to perform zstd encoding */
+funclist_t czstd_funcs = {HCPczstd_stread,
+                          HCPczstd_stwrite,
+                          HCPczstd_seek,
+                          HCPczstd_inquire,
+                          HCPczstd_read,
+                          HCPczstd_write,
+                          HCPczstd_endaccess,
+                          NULL,
+                          NULL};
+
+/* declaration of the functions provided in this module */
+static int32 HCIczstd_init(compinfo_t *info);
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIczstd_init -- Initialize a zstd compressed data element.
+
+ USAGE
+    int32 HCIczstd_init(info)
+    compinfo_t *info;           IN: special element information
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Common code called by HCIczstd_staccess
+--------------------------------------------------------------------------*/
+static int32
+HCIczstd_init(compinfo_t *info)
+{
+    comp_coder_zstd_info_t *zstd_info; /* ptr to zstd info */
+
+    if (Hseek(info->aid, 0, 0) == FAIL) /* seek to beginning of element */
+        HRETURN_ERROR(DFE_SEEKERROR, FAIL);
+
+    zstd_info = &(info->cinfo.coder_info.zstd_info);
+
+    /* Initialize zstd state information */
+    zstd_info->offset       = 0; /* start at the beginning of the data */
+    zstd_info->acc_init     = 0; /* second stage of initializing not performed */
+    zstd_info->acc_mode     = 0; /* init access mode to illegal value */
+    zstd_info->io_buf       = NULL;
+    zstd_info->io_size      = 0;
+    zstd_info->zstd_context = NULL;
+
+    return SUCCEED;
+} /* end HCIczstd_init() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIczstd_decode -- Decode zstd compressed data into a buffer.
+
+ USAGE
+    int32 HCIczstd_decode(info,length,buf)
+    compinfo_t *info;   IN: the info about the compressed element
+    int32 length;       IN: number of bytes to read into the buffer
+    uint8 *buf;         OUT: buffer to store the bytes read
+
+ RETURNS
+    Returns # of bytes decompressed or FAIL
+
+ DESCRIPTION
+    Common code called to decode zstd data from the file.  Stops short of
+    'length' bytes at the end of the frame.
+--------------------------------------------------------------------------*/
+static int32
+HCIczstd_decode(compinfo_t *info, int32 length, uint8 *buf)
+{
+    comp_coder_zstd_info_t *zstd_info; /* ptr to zstd info */
+    ZSTD_outBuffer          out;
+    ZSTD_inBuffer           in;
+    size_t                  zstat; /* decompression status */
+    int32                   bytes_read;
+
+    zstd_info = &(info->cinfo.coder_info.zstd_info);
+
+    out.dst  = buf;
+    out.size = (size_t)length;
+    out.pos  = 0;
+    while (out.pos < out.size) {
+        size_t out_pos = out.pos;
+
+        /* Get more bytes from the file, if we've run out */
+        if (zstd_info->io_pos == zstd_info->io_len && !zstd_info->io_eof) {
+            int32 file_bytes;
+
+            if ((file_bytes = Hread(info->aid, (int32)zstd_info->io_size, zstd_info->io_buf)) == FAIL)
+                HRETURN_ERROR(DFE_READERROR, FAIL);
+            zstd_info->io_pos = 0;
+            zstd_info->io_len = (size_t)file_bytes;
+            if (file_bytes == 0)
+                zstd_info->io_eof = TRUE;
+        } /* end if */
+
+        /* Read compressed data */
+        in.src  = zstd_info->io_buf;
+        in.size = zstd_info->io_len;
+        in.pos  = zstd_info->io_pos;
+        zstat   = ZSTD_decompressStream((ZSTD_DStream *)zstd_info->zstd_context, &out, &in);
+        zstd_info->io_pos = in.pos;
+        if (ZSTD_isError(zstat))
+            HRETURN_ERROR(DFE_READCOMP, FAIL);
+
+        /* break out if we've reached the end of the compressed data */
+        if (zstat == 0)
+            break;
+
+        /* or if the element ended in the middle of the frame */
+        if (zstd_info->io_eof && out.pos == out_pos)
+            break;
+    } /* end while */
+    bytes_read = (int32)out.pos;
+    zstd_info->offset += bytes_read;
+
+    return bytes_read;
+} /* end HCIczstd_decode() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIczstd_encode -- Encode data from a buffer into zstd compressed data
+
+ USAGE
+    int32 HCIczstd_encode(info,length,buf)
+    compinfo_t *info;   IN: the info about the compressed element
+    int32 length;       IN: number of bytes to store from the buffer
+    uint8 *buf;         OUT: buffer to get the bytes from
+
+ RETURNS
+    Returns # of bytes encoded or FAIL
+
+ DESCRIPTION
+    Common code called to encode zstd data into a file.
+--------------------------------------------------------------------------*/
+static int32
+HCIczstd_encode(compinfo_t *info, int32 length, const void *buf)
+{
+    comp_coder_zstd_info_t *zstd_info; /* ptr to zstd info */
+    ZSTD_outBuffer          out;
+    ZSTD_inBuffer           in;
+
+    zstd_info = &(info->cinfo.coder_info.zstd_info);
+
+    in.src  = buf;
+    in.size = (size_t)length;
+    in.pos  = 0;
+    while (in.pos < in.size) {
+        out.dst  = zstd_info->io_buf;
+        out.size = zstd_info->io_size;
+        out.pos  = zstd_info->io_pos;
+        if (ZSTD_isError(ZSTD_compressStream2((ZSTD_CStream *)zstd_info->zstd_context, &out, &in,
+                                              ZSTD_e_continue)))
+            HRETURN_ERROR(DFE_CENCODE, FAIL);
+        zstd_info->io_pos = out.pos;
+
+        /* Write the buffer to the file, if we've filled it */
+        if (zstd_info->io_pos == zstd_info->io_size) {
+            if (Hwrite(info->aid, (int32)zstd_info->io_size, zstd_info->io_buf) == FAIL)
+                HRETURN_ERROR(DFE_WRITEERROR, FAIL);
+            zstd_info->io_pos = 0;
+        } /* end if */
+    }                            /* end while */
+    zstd_info->offset += length; /* incr. abs. offset into the file */
+
+    return length;
+} /* end HCIczstd_encode() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIczstd_term -- Close down internal buffering for zstd encoding
+
+ USAGE
+    int32 HCIczstd_term(info,acc_mode)
+    compinfo_t *info;   IN: the info about the compressed element
+    uint32 acc_mode;    IN: the access mode the data element was opened with
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Common code called to end the zstd frame in the file when writing,
+    and to release the zstd stream.
+--------------------------------------------------------------------------*/
+static int32
+HCIczstd_term(compinfo_t *info, uint32 acc_mode)
+{
+    comp_coder_zstd_info_t *zstd_info; /* ptr to zstd info */
+
+    zstd_info = &(info->cinfo.coder_info.zstd_info);
+
+    if (zstd_info->acc_init != 0) {
+        if (acc_mode & DFACC_WRITE) { /* flush the compressed data to the file */
+            ZSTD_CStream  *cstream = (ZSTD_CStream *)zstd_info->zstd_context;
+            ZSTD_outBuffer out;
+            ZSTD_inBuffer  in = {NULL, 0, 0};
+            size_t         remaining;
+
+            do {
+                out.dst   = zstd_info->io_buf;
+                out.size  = zstd_info->io_size;
+                out.pos   = zstd_info->io_pos;
+                remaining = ZSTD_compressStream2(cstream, &out, &in, ZSTD_e_end);
+                if (ZSTD_isError(remaining))
+                    HRETURN_ERROR(DFE_CENCODE, FAIL);
+                zstd_info->io_pos = out.pos;
+
+                /* Write the buffer out when it is full or the frame is complete */
+                if ((zstd_info->io_pos == zstd_info->io_size || remaining == 0) && zstd_info->io_pos > 0) {
+                    if (Hwrite(info->aid, (int32)zstd_info->io_pos, zstd_info->io_buf) == FAIL)
+                        HRETURN_ERROR(DFE_WRITEERROR, FAIL);
+                    zstd_info->io_pos = 0;
+                } /* end if */
+            } while (remaining != 0);
+
+            ZSTD_freeCStream(cstream);
+        }      /* end if */
+        else { /* finish up any decompressed data */
+            ZSTD_freeDStream((ZSTD_DStream *)zstd_info->zstd_context);
+        } /* end else */
+        zstd_info->zstd_context = NULL;
+    } /* end if */
+
+    /* Reset parameters */
+    zstd_info->offset   = 0; /* start at the beginning of the data */
+    zstd_info->acc_init = 0; /* second stage of initializing not performed */
+    zstd_info->acc_mode = 0; /* init access mode to illegal value */
+
+    return SUCCEED;
+} /* end HCIczstd_term() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIczstd_staccess -- Start accessing a zstd compressed data element.
+
+ USAGE
+    int32 HCIczstd_staccess(access_rec, access)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int16 access;           IN: the type of access wanted
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Common code called by HCPczstd_stread and HCPczstd_stwrite
+--------------------------------------------------------------------------*/
+static int32
+HCIczstd_staccess(accrec_t *access_rec, int16 acc_mode)
+{
+    compinfo_t             *info;      /* special element information */
+    comp_coder_zstd_info_t *zstd_info; /* ptr to zstd info */
+    size_t                  io_size;
+
+    info      = (compinfo_t *)access_rec->special_info;
+    zstd_info = &(info->cinfo.coder_info.zstd_info);
+
+    /* need to check for not writing, as opposed to read access */
+    /* because of the way the access works */
+    if (!(acc_mode & DFACC_WRITE)) {
+        info->aid = Hstartread(access_rec->file_id, DFTAG_COMPRESSED, info->comp_ref);
+    } /* end if */
+    else {
+        info->aid = Hstartaccess(access_rec->file_id, DFTAG_COMPRESSED, info->comp_ref,
+                                 DFACC_RDWR | DFACC_APPENDABLE);
+    } /* end else */
+    if (info->aid == FAIL)
+        HRETURN_ERROR(DFE_DENIED, FAIL);
+
+    /* Make certain we can append to the data when writing */
+    if ((acc_mode & DFACC_WRITE) && Happendable(info->aid) == FAIL)
+        HRETURN_ERROR(DFE_DENIED, FAIL);
+
+    /* initialize the common zstd coding info */
+    if (HCIczstd_init(info) == FAIL)
+        HRETURN_ERROR(DFE_CODER, FAIL);
+
+    /* Allocate compression I/O buffer, of the size zstd works best with */
+    io_size = MAX(ZSTD_CStreamOutSize(), ZSTD_DStreamInSize());
+    if ((zstd_info->io_buf = malloc(io_size)) == NULL)
+        HRETURN_ERROR(DFE_NOSPACE, FAIL);
+    zstd_info->io_size = io_size;
+
+    return SUCCEED;
+} /* end HCIczstd_staccess() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIczstd_staccess2 -- 2nd half of start accessing a zstd compressed
+                          data element.
+
+ USAGE
+    int32 HCIczstd_staccess2(access_rec, access)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int16 access;           IN: the type of access wanted
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Common code called by HCPczstd_seek, HCPczstd_read and HCPczstd_write
+--------------------------------------------------------------------------*/
+static int32
+HCIczstd_staccess2(accrec_t *access_rec, int16 acc_mode)
+{
+    compinfo_t             *info;      /* special element information */
+    comp_coder_zstd_info_t *zstd_info; /* ptr to zstd info */
+
+    info      = (compinfo_t *)access_rec->special_info;
+    zstd_info = &(info->cinfo.coder_info.zstd_info);
+
+    /* Initialize the zstd library */
+    if (acc_mode & DFACC_WRITE) {
+        ZSTD_CStream *cstream;
+
+        if ((cstream = ZSTD_createCStream()) == NULL)
+            HRETURN_ERROR(DFE_CINIT, FAIL);
+        if (ZSTD_isError(ZSTD_CCtx_setParameter(cstream, ZSTD_c_compressionLevel, zstd_info->zstd_level))) {
+            ZSTD_freeCStream(cstream);
+            HRETURN_ERROR(DFE_CINIT, FAIL);
+        }
+        zstd_info->zstd_context = cstream;
+
+        /* set access mode */
+        zstd_info->acc_mode = DFACC_WRITE;
+
+        /* start with an empty buffer */
+        zstd_info->io_pos = 0;
+    } /* end if */
+    else {
+        ZSTD_DStream *dstream;
+
+        if ((dstream = ZSTD_createDStream()) == NULL)
+            HRETURN_ERROR(DFE_CINIT, FAIL);
+        zstd_info->zstd_context = dstream;
+
+        /* set access mode */
+        zstd_info->acc_mode = DFACC_READ;
+
+        /* force I/O with the file at first */
+        zstd_info->io_pos = zstd_info->io_len = 0;
+        zstd_info->io_eof                     = FALSE;
+    } /* end else */
+
+    /* set flag to indicate second stage of initialization is finished */
+    zstd_info->acc_init = acc_mode;
+
+    return SUCCEED;
+} /* end HCIczstd_staccess2() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPczstd_stread -- start read access for compressed file
+
+ USAGE
+    int32 HCPczstd_stread(access_rec)
+    accrec_t *access_rec;   IN: the access record of the data element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Start read access on a compressed data element using the zstd scheme.
+--------------------------------------------------------------------------*/
+int32
+HCPczstd_stread(accrec_t *access_rec)
+{
+    if (HCIczstd_staccess(access_rec, DFACC_READ) == FAIL)
+        HRETURN_ERROR(DFE_CINIT, FAIL);
+
+    return SUCCEED;
+} /* HCPczstd_stread() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPczstd_stwrite -- start write access for compressed file
+
+ USAGE
+    int32 HCPczstd_stwrite(access_rec)
+    accrec_t *access_rec;   IN: the access record of the data element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Start write access on a compressed data element using the zstd scheme.
+--------------------------------------------------------------------------*/
+int32
+HCPczstd_stwrite(accrec_t *access_rec)
+{
+    if (HCIczstd_staccess(access_rec, DFACC_WRITE) == FAIL)
+        HRETURN_ERROR(DFE_CINIT, FAIL);
+
+    return SUCCEED;
+} /* HCPczstd_stwrite() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPczstd_seek -- Seek to offset within the data element
+
+ USAGE
+    int32 HCPczstd_seek(access_rec,offset,origin)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 offset;       IN: the offset in bytes from the origin specified
+    intn origin;        IN: the origin to seek from [UNUSED!]
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Seek to a position with a compressed data element.  The 'origin'
+    calculations have been taken care of at a higher level, it is an
+    un-used parameter.  The 'offset' is used as an absolute offset
+    because of this.
+--------------------------------------------------------------------------*/
+int32
+HCPczstd_seek(accrec_t *access_rec, int32 offset, int origin)
+{
+    compinfo_t             *info;             /* special element information */
+    comp_coder_zstd_info_t *zstd_info;        /* ptr to zstd info */
+    uint8                  *tmp_buf   = NULL; /* temporary buffer */
+    int32                   ret_value = SUCCEED;
+
+    (void)origin;
+
+    info      = (compinfo_t *)access_rec->special_info;
+    zstd_info = &(info->cinfo.coder_info.zstd_info);
+
+    /* Check if second stage of initialization has been performed */
+    if (zstd_info->acc_init == 0) {
+        if (HCIczstd_staccess2(access_rec, DFACC_READ) == FAIL)
+            HGOTO_ERROR(DFE_CINIT, FAIL);
+    }
+
+    if (offset < zstd_info->offset) {
+
+        /* need to seek from the beginning */
+
+        /* Terminate the previous method of access */
+        if (HCIczstd_term(info, (uint32)zstd_info->acc_mode) == FAIL)
+            HGOTO_ERROR(DFE_CTERM, FAIL);
+
+        /* Restart access */
+        if (HCIczstd_staccess2(access_rec, DFACC_READ) == FAIL)
+            HGOTO_ERROR(DFE_CINIT, FAIL);
+
+        /* Go back to the beginning of the data-stream */
+        if (Hseek(info->aid, 0, 0) == FAIL)
+            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+    }
+
+    /* Allocate a temporary buffer for decompression */
+    if ((tmp_buf = (uint8 *)malloc(sizeof(uint8) * ZSTD_TMP_BUF_SIZE)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    while (zstd_info->offset + ZSTD_TMP_BUF_SIZE < offset) {
+        /* grab chunks */
+        if (HCIczstd_decode(info, ZSTD_TMP_BUF_SIZE, tmp_buf) == FAIL) {
+            HGOTO_ERROR(DFE_CDECODE, FAIL);
+        }
+    }
+    if (zstd_info->offset < offset) {
+        /* grab the last chunk */
+        if (HCIczstd_decode(info, offset - zstd_info->offset, tmp_buf) == FAIL) {
+            HGOTO_ERROR(DFE_CDECODE, FAIL);
+        }
+    }
+
+done:
+    free(tmp_buf);
+
+    return ret_value;
+} /* HCPczstd_seek() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPczstd_read -- Read in a portion of data from a compressed data element.
+
+ USAGE
+    int32 HCPczstd_read(access_rec,length,data)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 length;           IN: the number of bytes to read
+    void * data;             OUT: the buffer to place the bytes read
+
+ RETURNS
+    Returns the number of bytes read or FAIL
+
+ DESCRIPTION
+    Read in a number of bytes from the zstd compressed data element.
+--------------------------------------------------------------------------*/
+int32
+HCPczstd_read(accrec_t *access_rec, int32 length, void *data)
+{
+    compinfo_t             *info;      /* special element information */
+    comp_coder_zstd_info_t *zstd_info; /* ptr to zstd info */
+
+    info      = (compinfo_t *)access_rec->special_info;
+    zstd_info = &(info->cinfo.coder_info.zstd_info);
+
+    /* Check if second stage of initialization has been performed */
+    if (zstd_info->acc_init != DFACC_READ) {
+        /* Terminate the previous method of access */
+        if (HCIczstd_term(info, (uint32)zstd_info->acc_mode) == FAIL)
+            HRETURN_ERROR(DFE_CTERM, FAIL);
+
+        /* Restart access */
+        if (HCIczstd_staccess2(access_rec, DFACC_READ) == FAIL)
+            HRETURN_ERROR(DFE_CINIT, FAIL);
+
+        /* Go back to the beginning of the data-stream */
+        if (Hseek(info->aid, 0, 0) == FAIL)
+            HRETURN_ERROR(DFE_SEEKERROR, FAIL);
+    } /* end if */
+
+    if ((length = HCIczstd_decode(info, length, data)) == FAIL)
+        HRETURN_ERROR(DFE_CDECODE, FAIL);
+
+    return length;
+} /* HCPczstd_read() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPczstd_write -- Write out a portion of data from a compressed data element.
+
+ USAGE
+    int32 HCPczstd_write(access_rec,length,data)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 length;           IN: the number of bytes to write
+    void * data;             IN: the buffer to retrieve the bytes written
+
+ RETURNS
+    Returns the number of bytes written or FAIL
+
+ DESCRIPTION
+    Write out a number of bytes to the zstd compressed data element.
+--------------------------------------------------------------------------*/
+int32
+HCPczstd_write(accrec_t *access_rec, int32 length, const void *data)
+{
+    compinfo_t             *info;      /* special element information */
+    comp_coder_zstd_info_t *zstd_info; /* ptr to zstd info */
+
+    info      = (compinfo_t *)access_rec->special_info;
+    zstd_info = &(info->cinfo.coder_info.zstd_info);
+
+    /* Don't allow random write in a dataset unless: */
+    /*  1 - append onto the end */
+    /*  2 - start at the beginning and rewrite (at least) the whole dataset */
+    if ((info->length != zstd_info->offset) && (zstd_info->offset != 0 || length < info->length))
+        HRETURN_ERROR(DFE_UNSUPPORTED, FAIL);
+
+    /* Check if second stage of initialization has been performed */
+    if (zstd_info->acc_init != DFACC_WRITE) {
+        /* Terminate the previous method of access */
+        if (HCIczstd_term(info, (uint32)zstd_info->acc_init) == FAIL)
+            HRETURN_ERROR(DFE_CTERM, FAIL);
+
+        /* Restart access */
+        if (HCIczstd_staccess2(access_rec, DFACC_WRITE) == FAIL)
+            HRETURN_ERROR(DFE_CINIT, FAIL);
+
+        /* Go back to the beginning of the data-stream */
+        if (Hseek(info->aid, 0, 0) == FAIL)
+            HRETURN_ERROR(DFE_SEEKERROR, FAIL);
+    } /* end if */
+
+    if ((length = HCIczstd_encode(info, length, data)) == FAIL)
+        HRETURN_ERROR(DFE_CENCODE, FAIL);
+
+    return length;
+} /* HCPczstd_write() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPczstd_inquire -- Inquire information about the access record and data element.
+
+ USAGE
+    int32 HCPczstd_inquire(access_rec,pfile_id,ptag,pref,plength,poffset,pposn,
+            paccess,pspecial)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 *pfile_id;        OUT: ptr to file id
+    uint16 *ptag;           OUT: ptr to tag of information
+    uint16 *pref;           OUT: ptr to ref of information
+    int32 *plength;         OUT: ptr to length of data element
+    int32 *poffset;         OUT: ptr to offset of data element
+    int32 *pposn;           OUT: ptr to position of access in element
+    int16 *paccess;         OUT: ptr to access mode
+    int16 *pspecial;        OUT: ptr to special code
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Inquire information about the access record and data element.
+    [Currently a NOP].
+--------------------------------------------------------------------------*/
+int32
+HCPczstd_inquire(accrec_t *access_rec, int32 *pfile_id, uint16 *ptag, uint16 *pref, int32 *plength,
+                 int32 *poffset, int32 *pposn, int16 *paccess, int16 *pspecial)
+{
+    (void)access_rec;
+    (void)pfile_id;
+    (void)ptag;
+    (void)pref;
+    (void)plength;
+    (void)poffset;
+    (void)pposn;
+    (void)paccess;
+    (void)pspecial;
+
+    return SUCCEED;
+} /* HCPczstd_inquire() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPczstd_endaccess -- Close the compressed data element
+
+ USAGE
+    int32 HCPczstd_endaccess(access_rec)
+    accrec_t *access_rec;   IN: the access record of the data element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Close the compressed data element and free encoding info.
+--------------------------------------------------------------------------*/
+intn
+HCPczstd_endaccess(accrec_t *access_rec)
+{
+    compinfo_t             *info;      /* special element information */
+    comp_coder_zstd_info_t *zstd_info; /* ptr to zstd info */
+
+    info      = (compinfo_t *)access_rec->special_info;
+    zstd_info = &(info->cinfo.coder_info.zstd_info);
+
+    /* flush out buffer */
+    if (HCIczstd_term(info, (uint32)zstd_info->acc_mode) == FAIL)
+        HRETURN_ERROR(DFE_CTERM, FAIL);
+
+    /* Get rid of the I/O buffer */
+    free(zstd_info->io_buf);
+    zstd_info->io_buf = NULL;
+
+    /* close the compressed data AID */
+    if (Hendaccess(info->aid) == FAIL)
+        HRETURN_ERROR(DFE_CANTCLOSE, FAIL);
+
+    return SUCCEED;
+} /* HCPczstd_endaccess() */
+
+#endif /* H4_HAVE_LIBZSTD */
@@ -0,0 +1,71 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*-----------------------------------------------------------------------------
+ * File:    czstd.h
+ * Purpose: Header file for zstd encoding information.
+ * Dependencies: should only be included from hcompi.h
+ *---------------------------------------------------------------------------*/
+
+#ifndef H4_CZSTD_H
+#define H4_CZSTD_H
+
+#include "H4api_adpt.h"
+
+/* zstd [en|de]coding information */
+typedef struct {
+    intn   zstd_level;   /* how hard to try to compress this data */
+    int32  offset;       /* offset in the de-compressed array */
+    intn   acc_init;     /* is access mode initialized? */
+    int16  acc_mode;     /* access mode desired */
+    uint8 *io_buf;       /* buffer for I/O with the file */
+    size_t io_size;      /* allocated size of io_buf */
+    size_t io_pos;       /* next byte of io_buf to decode or to fill */
+    size_t io_len;       /* number of bytes read into io_buf */
+    intn   io_eof;       /* all of the compressed data has been read */
+    void  *zstd_context; /* ZSTD_CStream or ZSTD_DStream of the access */
+} comp_coder_zstd_info_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef H4_HAVE_LIBZSTD
+HDFLIBAPI funclist_t czstd_funcs; /* functions to perform zstd encoding */
+
+/*
+ ** from czstd.c
+ */
+
+HDFLIBAPI int32 HCPczstd_stread(accrec_t *rec);
+
+HDFLIBAPI int32 HCPczstd_stwrite(accrec_t *rec);
+
+HDFLIBAPI int32 HCPczstd_seek(accrec_t *access_rec, int32 offset, int origin);
+
+HDFLIBAPI int32 HCPczstd_inquire(accrec_t *access_rec, int32 *pfile_id, uint16 *ptag, uint16 *pref,
+                                 int32 *plength, int32 *poffset, int32 *pposn, int16 *paccess,
+                                 int16 *pspecial);
+
+HDFLIBAPI int32 HCPczstd_read(accrec_t *access_rec, int32 length, void *data);
+
+HDFLIBAPI int32 HCPczstd_write(accrec_t *access_rec, int32 length, const void *data);
+
+HDFLIBAPI intn HCPczstd_endaccess(accrec_t *access_rec);
+#endif /* H4_HAVE_LIBZSTD */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H4_CZSTD_H */
@@ -65,6 +65,7 @@
 
 #include <ctype.h>
 #include "hdf.h"
+#include "hfile.h"
 #include "hconv.h"
 
 /*
@@ -373,6 +374,27 @@ DFKislitendNT(int32 numbertype)
     return (DFNT_LITEND & numbertype) > 0 ? 1 : 0;
 }
 
+/*------------------------------------------------------------------
+ * Name:    DFKiscopyNT
+ * Purpose: Determine whether reading number type in is a plain copy
+ * Inputs:  numbertype: number type as stored in the file
+ * Returns: 1 if true, 0 if false
+ * Users:   VSreadcolumns
+ * Method:  Checks whether the DFKnumin() routine for the type is one
+ *          of the native copy routines
+ * Remarks: Sets the current number type, like DFKconvert()
+ *------------------------------------------------------------------*/
+
+int32
+DFKiscopyNT(int32 numbertype)
+{
+    if (DFKsetNT(numbertype) == FAIL)
+        return 0;
+    if (DFKnumin == DFKnb1b || DFKnumin == DFKnb2b || DFKnumin == DFKnb4b || DFKnumin == DFKnb8b)
+        return 1;
+    return 0;
+}
+
 /************************************************************
  * DFconvert()
  *
@@ -494,11 +516,13 @@ DFKconvert(void *source, void *dest, int32 ntype, int32 num_elm, int16 acc_mode,
     if (source == NULL || dest == NULL)
         return -1;
 
+    HP_TRACE(HDF_TRACE_CONVERT, FALSE, num_elm);
     DFKsetNT(ntype);
     if (acc_mode == DFACC_READ)
         ret = DFKnumin(source, dest, (uint32)num_elm, (uint32)source_stride, (uint32)dest_stride);
     else
         ret = DFKnumout(source, dest, (uint32)num_elm, (uint32)source_stride, (uint32)dest_stride);
+    HP_TRACE(HDF_TRACE_CONVERT, TRUE, num_elm);
     return ret;
 }
 
@@ -665,9 +665,9 @@ done:
  *          acc_mode : access mode
  * Returns: file ID on success, FAIL on failure with DFerror set
  * Users:   HDF systems programmers, all the RIG routines
- * Invokes: DFopen
- * Remarks: This is a hook for someday providing more efficient ways to
- *          reopen a file, to avoid re-reading all the headers
+ * Invokes: Hopen, HPkeep_open
+ * Remarks: A file opened for reading is kept open after it is closed, see
+ *          Hsetkeepopen(), so that reopening it does not read its DDs again
  *---------------------------------------------------------------------------*/
 
 int32
@@ -684,6 +684,10 @@ DFGRIopen(const char *filename, int acc_mode)
     if ((file_id = Hopen(filename, acc_mode, 0)) == FAIL)
         HGOTO_ERROR(DFE_BADOPEN, FAIL);
 
+    /* files read are kept open between calls */
+    if (acc_mode == DFACC_READ)
+        HPkeep_open(file_id);
+
     /* Check if filename buffer has been allocated */
     if (Grlastfile == NULL) {
         if ((Grlastfile = (char *)malloc(DF_MAXFNLEN + 1)) == NULL)
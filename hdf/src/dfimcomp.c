@@ -39,6 +39,7 @@
 #define EPSILON 0.5
 #define LO      1
 #define HI      0
+#define NLEVELS 32 /* levels of a color component reduced to 5 bits */
 
 struct rgb {
     uint8 c[3];
@@ -77,15 +78,12 @@ static int         nearest_color(uint8 r, uint8 g, uint8 b);
 static uint32      sqr(int16 x);
 static void        sel_palette(int blocks, int distinct, struct rgb *my_color_pt);
 static void        init(int blocks, int distinct, struct rgb *my_color_pt);
-static void        sort(int l, int r, int dim, int rank[]);
-static int         partition(int l, int r, int dim, int rank[]);
 static struct box *find_box(void);
 static void        split_box(struct box *ptr);
 static void        assign_color(void);
 static int         select_dim(struct box *ptr);
 static float       find_med(struct box *ptr, int dim);
-static void        classify(struct box *ptr, struct box *child);
-static int         next_pt(int dim, int i, int rank[], int distinct);
+static void        classify(struct box *ptr, int dim, float median, struct box *l_child, struct box *r_child);
 
 /************************************************************************/
 /*  Function: DFCIimcomp                                                */
@@ -529,9 +527,8 @@ DFCIunimcomp(int32 xdim, int32 ydim, uint8 in[], uint8 out[])
 /*  Purpose     : Quantizes colors                  */
 /*  Author  : Eng-Kiat Koh                      */
 /*  Date    : June 30th, 1988                   */
-/*  Functions   : sel_palette(), init(), sort(), partition(), find_box() */
-/*        split_box(), assign_color(), select_dim(), find_med() */
-/*                classify(), next_pt()                                 */
+/*  Functions   : sel_palette(), init(), find_box(), split_box()        */
+/*        assign_color(), select_dim(), find_med(), classify()  */
 /************************************************************************/
 
 /************************************************************************/
@@ -575,10 +572,20 @@ sel_palette(int blocks, int distinct, struct rgb *my_color_pt)
          */
 
         ptr = find_box();
+        if (ptr == NULL)
+            break;
         split_box(ptr);
     }
 
     assign_color();
+
+    /* release the boxes */
+    while (frontier != NULL) {
+        ptr      = frontier;
+        frontier = ptr->right;
+        free(ptr->pts);
+        free(ptr);
+    }
 }
 
 /************************************************************************/
@@ -654,93 +661,16 @@ init(int blocks, int distinct, struct rgb *my_color_pt)
     first->nmbr_pts      = 2 * blocks;
     first->nmbr_distinct = distinct;
 
-    dummy           = (struct box *)malloc(sizeof(struct box));
-    frontier        = dummy;
-    dummy->right    = first;
-    first->left     = dummy;
-    first->right    = NULL;
-    dummy->nmbr_pts = 0;
-
-    free(first);
-    free(dummy);
+    dummy                = (struct box *)malloc(sizeof(struct box));
+    frontier             = dummy;
+    dummy->right         = first;
+    first->left          = dummy;
+    first->right         = NULL;
+    dummy->pts           = NULL;
+    dummy->nmbr_pts      = 0;
+    dummy->nmbr_distinct = 0;
 } /* end of init */
 
-/************************************************************************/
-/*  Function    : sort                          */
-/*  Purpose : Performs quick sort on the points in a box along a    */
-/*        given dimension                   */
-/*  Parameter   :                           */
-/*    l, r   - index of leftmost and rightmost element      */
-/*    dim    - dimension along which sorting is done        */
-/*    rank   - an array which carries the index of the points to be */
-/*         sorted                       */
-/*  Returns     : none                          */
-/*  Called by   : find_med()                        */
-/*  Calls       : partition()                       */
-/************************************************************************/
-
-static void
-sort(int l, int r, int dim, int rank[])
-{
-    int i;
-
-    if (r > l) {
-        i = partition(l, r, dim, rank);
-        sort(l, i - 1, dim, rank);
-        sort(i + 1, r, dim, rank);
-    }
-}
-
-/************************************************************************
- *  Function    : partition
- *  Purpose : Partitions the list into 2 parts as in the quick sort
- *        algorithm
- *  Parameter   :
- *    l, r   - index of leftmost and rightmost element
- *    dim    - dimension along which sorting is done
- *    rank   - an array which carries the index of the points to be
- *  Returns     : index where list is partitioned
- *  Called by   : sort()
- *  Calls       : none
- ************************************************************************/
-
-static int
-partition(int l, int r, int dim, int rank[])
-{
-    int   i, j, temp;
-    uint8 v;
-
-    v = distinct_pt[rank[r]].c[dim];
-    i = l - 1;
-    j = r;
-
-    /* repeat until i and j crosses */
-    do {
-        /* repeat until an element >= v is found */
-        do
-            i++;
-        while (distinct_pt[rank[i]].c[dim] < v);
-
-        /* repeat until an element <= v is found */
-        do
-            j--;
-        while ((j > 0) && (distinct_pt[rank[j]].c[dim] > v));
-
-        /* swap pointers */
-        temp    = rank[i];
-        rank[i] = rank[j];
-        rank[j] = temp;
-    } while (i < j);
-
-    /* position partitioning element at location i */
-    temp    = rank[j];
-    rank[j] = rank[i];
-    rank[i] = rank[r];
-    rank[r] = temp;
-
-    return i;
-}
-
 /************************************************************************/
 /*  Function    : find_box                      */
 /*  Purpose : Finds the box with the largest number of color points */
@@ -812,8 +742,7 @@ split_box(struct box *ptr)
     l_child->bnd[dim][HI] = median;
     r_child->bnd[dim][LO] = median;
 
-    classify(ptr, l_child);
-    classify(ptr, r_child);
+    classify(ptr, dim, median, l_child, r_child);
 
     r_child->right     = ptr->right;
     r_child->left      = l_child;
@@ -822,6 +751,9 @@ split_box(struct box *ptr)
     (ptr->left)->right = l_child;
     if (ptr->right != NULL)
         (ptr->right)->left = r_child;
+
+    free(ptr->pts);
+    free(ptr);
 } /* end of split_box */
 
 /************************************************************************/
@@ -924,21 +856,23 @@ select_dim(struct box *ptr)
 /*  Function    : find_med                      */
 /*  Purpose : Finds the point where the box is to be split. It finds */
 /*        a point such that the 2 new boxes have about the same */
-/*        number of color points.               */
+/*        number of color points. The points are counted at */
+/*        each of the NLEVELS levels of the component, rather   */
+/*        than sorted.                      */
 /*  Parameter   :                           */
 /*    ptr    - pointer to box to be split               */
 /*    dim    - dimension to split box               */
 /*  Returns     : point where the box is to be cut          */
 /*  Called by   : split_box()                       */
-/*  Calls       : next_pt()                     */
+/*  Calls       : none                          */
 /************************************************************************/
 
 static float
 find_med(struct box *ptr, int dim)
 {
-    int     i, j, count, next, prev;
-    int    *rank;
-    float32 median;
+    int   i, v, count, first, prev, last;
+    int   level[NLEVELS];
+    float median;
 
     /* There's really no way to recover from this, given the API, but
      * at least we won't segfault...
@@ -946,114 +880,76 @@ find_med(struct box *ptr, int dim)
     if ((NULL == ptr) || (NULL == ptr->pts))
         return -9999999.99;
 
-    rank = (int *)malloc((unsigned)ptr->nmbr_distinct * sizeof(int));
+    /* count the color points at each level of the component */
+    for (v = 0; v < NLEVELS; v++)
+        level[v] = 0;
     for (i = 0; i < ptr->nmbr_distinct; i++)
-        rank[i] = ptr->pts[i];
-
-    sort(0, ptr->nmbr_distinct - 1, dim, rank);
-
-    count = 0;
-    prev = i = 0;
-    while ((i < ptr->nmbr_distinct) && (count < ptr->nmbr_pts / 2)) {
-        next = next_pt(dim, i, rank, ptr->nmbr_distinct);
-        for (j = i; j < next; j++)
-            count = count + hist[rank[j]];
-
-        prev = i;
-        i    = next;
+        level[distinct_pt[ptr->pts[i]].c[dim] & (NLEVELS - 1)] += hist[ptr->pts[i]];
+
+    /* take levels in increasing order until half the points are covered */
+    first = prev = last = -1;
+    count               = 0;
+    for (v = 0; v < NLEVELS; v++) {
+        if (level[v] == 0)
+            continue;
+        if (first == -1)
+            first = v;
+        if (count >= ptr->nmbr_pts / 2)
+            break;
+        count += level[v];
+        prev = last;
+        last = v;
     }
 
-    if (prev == 0) {
+    if (prev == -1) {
         /* the first distinct point overshot the median */
-        median = (float32)distinct_pt[rank[prev]].c[dim] + (float32)EPSILON;
+        median = (float32)first + (float32)EPSILON;
     }
     else
-        median = (float32)distinct_pt[rank[prev - 1]].c[dim] + (float32)EPSILON;
+        median = (float32)prev + (float32)EPSILON;
 
-    free(rank);
     return median;
 } /* end of find_med */
 
 /************************************************************************/
 /*  Function    : classify                      */
-/*  Purpose : Looks at the color points in the parent and selects   */
-/*        the points that belong to the child           */
+/*  Purpose : Splits the color points of the parent between the 2   */
+/*        children, on either side of the median along dim      */
 /*  Parameter   :                           */
 /*    ptr    - pointer to parent                    */
-/*    child  - pointer to child box                 */
+/*    dim    - dimension where the box is split             */
+/*    median - point where the box is cut               */
+/*    l_child, r_child - pointers to the children           */
 /*  Returns     : none                          */
 /*  Called by   : split_box()                       */
 /*  Calls       : none                          */
 /************************************************************************/
 
 static void
-classify(struct box *ptr, struct box *child)
+classify(struct box *ptr, int dim, float median, struct box *l_child, struct box *r_child)
 {
-    int  i, j;
-    int *temp;
-    int  distinct, total;
+    int i, j;
+    int l_distinct, r_distinct;
 
-    temp = (int *)malloc((unsigned)ptr->nmbr_distinct * sizeof(int));
+    l_child->pts      = (int *)malloc((unsigned)ptr->nmbr_distinct * sizeof(int));
+    r_child->pts      = (int *)malloc((unsigned)ptr->nmbr_distinct * sizeof(int));
+    l_child->nmbr_pts = 0;
+    r_child->nmbr_pts = 0;
 
-    distinct = 0;
-    total    = 0;
+    /* the children only differ from the parent along dim */
+    l_distinct = r_distinct = 0;
     for (i = 0; i < ptr->nmbr_distinct; i++) {
         j = ptr->pts[i];
-        if ((((float)distinct_pt[j].c[RED] >= child->bnd[RED][LO]) &&
-             ((float)distinct_pt[j].c[RED] <= child->bnd[RED][HI])) &&
-            (((float)distinct_pt[j].c[GREEN] >= child->bnd[GREEN][LO]) &&
-             ((float)distinct_pt[j].c[GREEN] <= child->bnd[GREEN][HI])) &&
-            (((float)distinct_pt[j].c[BLUE] >= child->bnd[BLUE][LO]) &&
-             ((float)distinct_pt[j].c[BLUE] <= child->bnd[BLUE][HI]))) {
-            /* pt is in new box */
-            temp[distinct] = j;
-            distinct++;
-            total = total + hist[j];
-        } /* end of if */
-    }     /* end of for i */
-
-    /* assign points */
-    if (distinct > 0) {
-        child->nmbr_pts      = total;
-        child->nmbr_distinct = distinct;
-        child->pts           = (int *)malloc((unsigned)distinct * sizeof(int));
-        for (i = 0; i < distinct; i++)
-            child->pts[i] = temp[i];
-    }
-    else {
-        child->nmbr_pts      = 0;
-        child->nmbr_distinct = 0;
-        child->pts           = NULL;
-    }
-
-    free(temp);
+        if ((float)distinct_pt[j].c[dim] <= median) {
+            l_child->pts[l_distinct++] = j;
+            l_child->nmbr_pts += hist[j];
+        }
+        else {
+            r_child->pts[r_distinct++] = j;
+            r_child->nmbr_pts += hist[j];
+        }
+    } /* end of for i */
 
+    l_child->nmbr_distinct = l_distinct;
+    r_child->nmbr_distinct = r_distinct;
 } /* end of classify */
-
-/************************************************************************/
-/*  Function    : next_pt                       */
-/*  Purpose : Determines the next point that has a different value  */
-/*        from the current point along  a dimension     */
-/*  Parameter   :                           */
-/*    dim    - dimension where box is to be split           */
-/*    i      - index to current point               */
-/*    rank       - sorted list of points to be searched starting from i */
-/*    distinct   - length of sorted list                                */
-/*  Returns     : index of point that has a different value     */
-/*  Called by   : find_med                      */
-/*  Calls       : none                          */
-/************************************************************************/
-
-static int
-next_pt(int dim, int i, int rank[], int distinct)
-{
-    int   j;
-    uint8 old;
-
-    old = distinct_pt[rank[i]].c[dim];
-    for (j = (i + 1); j < distinct; j++)
-        if (distinct_pt[rank[j]].c[dim] != old)
-            break;
-
-    return j;
-} /* end of next_pt */
@@ -50,7 +50,7 @@ typedef struct {
 
 typedef hdf_destination_mgr *hdf_dest_ptr;
 
-#define OUTPUT_BUF_SIZE 4096 /* size of JPEG output buffer */
+#define OUTPUT_BUF_SIZE 65536 /* size of JPEG output buffer */
 
 /* Prototypes */
 extern void    hdf_init_destination(struct jpeg_compress_struct *cinfo_ptr);
@@ -242,9 +242,10 @@ DFCIjpeg(int32 file_id, uint16 tag, uint16 ref, int32 xdim, int32 ydim, const vo
      */
     struct jpeg_compress_struct *cinfo_ptr;
     struct jpeg_error_mgr       *jerr_ptr;
-    JSAMPROW                     row_pointer[1];
+    JSAMPARRAY                   rows; /* the rows of the image */
     intn                         row_stride;
     const uint8                 *image_buffer = image;
+    int32                        i;
 
     if ((cinfo_ptr = calloc(1, sizeof(struct jpeg_compress_struct))) == NULL)
         HRETURN_ERROR(DFE_NOSPACE, FAIL);
@@ -289,11 +290,16 @@ DFCIjpeg(int32 file_id, uint16 tag, uint16 ref, int32 xdim, int32 ydim, const vo
     /* OK, get things started */
     jpeg_start_compress(cinfo_ptr, TRUE);
 
-    /* write the whole image out at once */
-    while (cinfo_ptr->next_scanline < cinfo_ptr->image_height) {
-        row_pointer[0] = (JSAMPROW)(&image_buffer[(size_t)cinfo_ptr->next_scanline * (size_t)row_stride]);
-        jpeg_write_scanlines(cinfo_ptr, row_pointer, 1);
-    } /* end while */
+    /* write the whole image out at once, handing the JPEG library all the
+       rows so it takes as many scanlines at a time as it can */
+    if ((rows = malloc(sizeof(JSAMPROW) * (size_t)ydim)) == NULL)
+        HRETURN_ERROR(DFE_NOSPACE, FAIL);
+    for (i = 0; i < ydim; i++)
+        rows[i] = (JSAMPROW)(&image_buffer[(size_t)i * (size_t)row_stride]);
+    while (cinfo_ptr->next_scanline < cinfo_ptr->image_height)
+        jpeg_write_scanlines(cinfo_ptr, rows + cinfo_ptr->next_scanline,
+                             cinfo_ptr->image_height - cinfo_ptr->next_scanline);
+    free(rows);
 
     /* Finish writing stuff out */
     jpeg_finish_compress(cinfo_ptr);
@@ -75,7 +75,7 @@ DFKnb1b(void *s, void *d, uint32 num_elm, uint32 source_stride, uint32 dest_stri
     }
 
     /* Determine if faster array processing is appropriate */
-    if ((source_stride == 0 && dest_stride == 0) || (source_stride == 1 && dest_stride == 1))
+    if ((source_stride == 0 || source_stride == 1) && (dest_stride == 0 || dest_stride == 1))
         fast_processing = 1;
 
     /* Determine if the conversion should be inplace */
@@ -124,7 +124,7 @@ DFKnb2b(void *s, void *d, uint32 num_elm, uint32 source_stride, uint32 dest_stri
     }
 
     /* Determine if faster array processing is appropriate */
-    if ((source_stride == 0 && dest_stride == 0) || (source_stride == 2 && dest_stride == 2))
+    if ((source_stride == 0 || source_stride == 2) && (dest_stride == 0 || dest_stride == 2))
         fast_processing = 1;
 
     /* Determine if the conversion should be inplace */
@@ -184,7 +184,7 @@ DFKnb4b(void *s, void *d, uint32 num_elm, uint32 source_stride, uint32 dest_stri
     }
 
     /* Determine if faster array processing is appropriate */
-    if ((source_stride == 0 && dest_stride == 0) || (source_stride == 4 && dest_stride == 4))
+    if ((source_stride == 0 || source_stride == 4) && (dest_stride == 0 || dest_stride == 4))
         fast_processing = 1;
 
     /* Determine if the conversion should be inplace */
@@ -250,7 +250,7 @@ DFKnb8b(void *s, void *d, uint32 num_elm, uint32 source_stride, uint32 dest_stri
     }
 
     /* Determine if faster array processing is appropriate */
-    if ((source_stride == 0 && dest_stride == 0) || (source_stride == 8 && dest_stride == 8))
+    if ((source_stride == 0 || source_stride == 8) && (dest_stride == 0 || dest_stride == 8))
         fast_processing = 1;
 
     /* Determine if the conversion should be inplace */
@@ -28,6 +28,13 @@
     These files used to be in dfconv.c, but it got a little too huge,
     so I broke them out into separate files. - Q
 
+    Contiguous arrays are swapped 16 or 32 bytes at a time with byte
+    shuffles where the processor has them: AVX2 or SSSE3 on x86, picked
+    by DFKswap_init() when the library starts, and NEON on ARM.  A stride
+    of the item size counts as contiguous.  The items left over go
+    through the byte loops, and strided arrays of 4 and 8 byte items
+    are swapped a word at a time.
+
  *------------------------------------------------------------------*/
 
 /*****************************************************************************/
@@ -49,6 +56,129 @@
 #include "hdf.h"
 #include "hconv.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DFKSWAP_X86
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define DFKSWAP_NEON
+#include <arm_neon.h>
+#endif
+
+/*****************************************************************************/
+/* VECTOR BYTE SWAPPING                                                      */
+/*****************************************************************************/
+
+#ifdef DFKSWAP_X86
+/* Byte shuffles reversing the 2, 4 or 8 byte items of 16 bytes */
+static const uint8 DFKswap_mask[3][16] = {{1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14},
+                                          {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12},
+                                          {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8}};
+
+/* Swaps 'nbytes' bytes, a multiple of 16, of 'size' byte items with SSSE3 */
+__attribute__((target("ssse3"))) static void
+DFKIswap_ssse3(const uint8 *source, uint8 *dest, size_t nbytes, intn size)
+{
+    __m128i mask = _mm_loadu_si128((const void *)DFKswap_mask[size / 4]);
+    size_t  off;
+
+    for (off = 0; off < nbytes; off += 16)
+        _mm_storeu_si128((void *)(dest + off),
+                         _mm_shuffle_epi8(_mm_loadu_si128((const void *)(source + off)), mask));
+}
+
+/* Swaps 'nbytes' bytes, a multiple of 16, of 'size' byte items with AVX2 */
+__attribute__((target("avx2"))) static void
+DFKIswap_avx2(const uint8 *source, uint8 *dest, size_t nbytes, intn size)
+{
+    __m256i mask = _mm256_broadcastsi128_si256(_mm_loadu_si128((const void *)DFKswap_mask[size / 4]));
+    size_t  off;
+
+    /* the shuffle works within each 16 byte lane, items never cross one */
+    for (off = 0; off + 32 <= nbytes; off += 32)
+        _mm256_storeu_si256((void *)(dest + off),
+                            _mm256_shuffle_epi8(_mm256_loadu_si256((const void *)(source + off)), mask));
+    if (off < nbytes)
+        DFKIswap_ssse3(source + off, dest + off, nbytes - off, size);
+}
+
+/* Vector routine for this processor, picked on first use */
+static void (*DFKswap_vector)(const uint8 *, uint8 *, size_t, intn) = NULL;
+
+static intn DFKswap_checked = FALSE; /* whether DFKswap_vector was picked */
+#endif /* DFKSWAP_X86 */
+
+#ifdef DFKSWAP_NEON
+/* Swaps 'nbytes' bytes, a multiple of 16, of 'size' byte items with NEON */
+static void
+DFKIswap_neon(const uint8 *source, uint8 *dest, size_t nbytes, intn size)
+{
+    size_t off;
+
+    for (off = 0; off < nbytes; off += 16) {
+        uint8x16_t v = vld1q_u8(source + off);
+
+        v = (size == 2) ? vrev16q_u8(v) : (size == 4) ? vrev32q_u8(v) : vrev64q_u8(v);
+        vst1q_u8(dest + off, v);
+    }
+}
+#endif /* DFKSWAP_NEON */
+
+/* Reverses the bytes of a 32 bit word, compilers turn this into one instruction */
+#define DFKSWAP_WORD(w) (((w) >> 24) | (((w) >> 8) & 0xff00) | (((w) << 8) & 0xff0000) | ((w) << 24))
+
+/************************************************************/
+/* DFKswap_init()                                           */
+/* -->Picks the vector byte swapping routine for this       */
+/*    processor, called once from HIstart()                 */
+/************************************************************/
+void
+DFKswap_init(void)
+{
+#if defined DFKSWAP_X86
+    if (!DFKswap_checked) {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            DFKswap_vector = DFKIswap_avx2;
+        else if (__builtin_cpu_supports("ssse3"))
+            DFKswap_vector = DFKIswap_ssse3;
+        DFKswap_checked = TRUE;
+    }
+#endif
+}
+
+/************************************************************/
+/* DFKIswap_vector()                                        */
+/* -->Byte swapping of contiguous items with vector         */
+/*    instructions, returns the number of items swapped     */
+/************************************************************/
+static uint32
+DFKIswap_vector(const uint8 *source, uint8 *dest, uint32 num_elm, intn size)
+{
+    size_t nbytes = ((size_t)num_elm * (size_t)size) & ~(size_t)15;
+
+    if (nbytes == 0)
+        return 0;
+
+    /* A vector is loaded before it is stored, so converting in place is
+       fine, but other overlapping buffers have to go item by item */
+    if (source != dest && source < dest + nbytes && dest < source + nbytes)
+        return 0;
+
+#if defined DFKSWAP_X86
+    if (!DFKswap_checked) /* converting before any file was opened */
+        DFKswap_init();
+    if (DFKswap_vector == NULL)
+        return 0;
+    (*DFKswap_vector)(source, dest, nbytes, size);
+#elif defined DFKSWAP_NEON
+    DFKIswap_neon(source, dest, nbytes, size);
+#else
+    return 0;
+#endif
+
+    return (uint32)(nbytes / (size_t)size);
+}
+
 /*****************************************************************************/
 /* NUMBER CONVERSION ROUTINES FOR BYTE SWAPPING                              */
 /*****************************************************************************/
@@ -74,8 +204,9 @@ DFKsb2b(void *s, void *d, uint32 num_elm, uint32 source_stride, uint32 dest_stri
         return FAIL;
     }
 
-    /* Determine if faster array processing is appropriate */
-    if (source_stride == 0 && dest_stride == 0)
+    /* Determine if faster array processing is appropriate, a stride */
+    /* of the item size is the same as no stride */
+    if ((source_stride == 0 || source_stride == 2) && (dest_stride == 0 || dest_stride == 2))
         fast_processing = 1;
 
     /* Determine if the conversion should be inplace */
@@ -83,6 +214,14 @@ DFKsb2b(void *s, void *d, uint32 num_elm, uint32 source_stride, uint32 dest_stri
         in_place = 1;
 
     if (fast_processing) {
+        /* Swap most of the items with vector instructions */
+        i = DFKIswap_vector(source, dest, num_elm, 2);
+        if (i == num_elm)
+            return 0;
+        num_elm -= i;
+        source += 2 * i;
+        dest += 2 * i;
+
         if (!in_place) {
             for (i = 0; i < num_elm; i++) {
                 dest[0] = source[1];
@@ -150,8 +289,9 @@ DFKsb4b(void *s, void *d, uint32 num_elm, uint32 source_stride, uint32 dest_stri
         return FAIL;
     }
 
-    /* Determine if faster array processing is appropriate */
-    if (source_stride == 0 && dest_stride == 0)
+    /* Determine if faster array processing is appropriate, a stride */
+    /* of the item size is the same as no stride */
+    if ((source_stride == 0 || source_stride == 4) && (dest_stride == 0 || dest_stride == 4))
         fast_processing = 1;
 
     /* Determine if the conversion should be inplace */
@@ -159,6 +299,14 @@ DFKsb4b(void *s, void *d, uint32 num_elm, uint32 source_stride, uint32 dest_stri
         in_place = 1;
 
     if (fast_processing) {
+        /* Swap most of the items with vector instructions */
+        i = DFKIswap_vector(source, dest, num_elm, 4);
+        if (i == num_elm)
+            return 0;
+        num_elm -= i;
+        source += 4 * i;
+        dest += 4 * i;
+
         if (!in_place) {
 #ifndef DUFF_sb4b
 #ifdef TEST1_sb4b
@@ -265,29 +413,17 @@ DFKsb4b(void *s, void *d, uint32 num_elm, uint32 source_stride, uint32 dest_stri
         }
     }
 
-    /* Generic stride processing */
-    if (!in_place)
-        for (i = 0; i < num_elm; i++) {
-            dest[0] = source[3];
-            dest[1] = source[2];
-            dest[2] = source[1];
-            dest[3] = source[0];
-            dest += dest_stride;
-            source += source_stride;
-        }
-    else
-        for (i = 0; i < num_elm; i++) {
-            buf[0]  = source[3];
-            buf[1]  = source[2];
-            buf[2]  = source[1];
-            buf[3]  = source[0];
-            dest[0] = buf[0];
-            dest[1] = buf[1];
-            dest[2] = buf[2];
-            dest[3] = buf[3];
-            dest += dest_stride;
-            source += source_stride;
-        }
+    /* Generic stride processing, a word at a time: each item is loaded */
+    /* whole before it is stored, so in place needs no special case */
+    for (i = 0; i < num_elm; i++) {
+        uint32 w;
+
+        memcpy(&w, source, 4);
+        w = DFKSWAP_WORD(w);
+        memcpy(dest, &w, 4);
+        dest += dest_stride;
+        source += source_stride;
+    }
     return 0;
 }
 
@@ -312,8 +448,9 @@ DFKsb8b(void *s, void *d, uint32 num_elm, uint32 source_stride, uint32 dest_stri
         return FAIL;
     }
 
-    /* Determine if faster array processing is appropriate */
-    if (source_stride == 0 && dest_stride == 0)
+    /* Determine if faster array processing is appropriate, a stride */
+    /* of the item size is the same as no stride */
+    if ((source_stride == 0 || source_stride == 8) && (dest_stride == 0 || dest_stride == 8))
         fast_processing = 1;
 
     /* Determine if the conversion should be inplace */
@@ -321,6 +458,14 @@ DFKsb8b(void *s, void *d, uint32 num_elm, uint32 source_stride, uint32 dest_stri
         in_place = 1;
 
     if (fast_processing) {
+        /* Swap most of the items with vector instructions */
+        i = DFKIswap_vector(source, dest, num_elm, 8);
+        if (i == num_elm)
+            return 0;
+        num_elm -= i;
+        source += 8 * i;
+        dest += 8 * i;
+
         if (!in_place) {
             for (i = 0; i < num_elm; i++) {
                 dest[0] = source[7];
@@ -361,41 +506,20 @@ DFKsb8b(void *s, void *d, uint32 num_elm, uint32 source_stride, uint32 dest_stri
         }
     }
 
-    /* Generic stride processing */
-    if (!in_place)
-        for (i = 0; i < num_elm; i++) {
-            dest[0] = source[7];
-            dest[1] = source[6];
-            dest[2] = source[5];
-            dest[3] = source[4];
-            dest[4] = source[3];
-            dest[5] = source[2];
-            dest[6] = source[1];
-            dest[7] = source[0];
-            dest += dest_stride;
-            source += source_stride;
-        }
-    else
-        for (i = 0; i < num_elm; i++) {
-            buf[0]  = source[7];
-            buf[1]  = source[6];
-            buf[2]  = source[5];
-            buf[3]  = source[4];
-            buf[4]  = source[3];
-            buf[5]  = source[2];
-            buf[6]  = source[1];
-            buf[7]  = source[0];
-            dest[0] = buf[0];
-            dest[1] = buf[1];
-            dest[2] = buf[2];
-            dest[3] = buf[3];
-            dest[4] = buf[4];
-            dest[5] = buf[5];
-            dest[6] = buf[6];
-            dest[7] = buf[7];
-            dest += dest_stride;
-            source += source_stride;
-        }
+    /* Generic stride processing, a word at a time: each item is loaded */
+    /* whole before it is stored, so in place needs no special case */
+    for (i = 0; i < num_elm; i++) {
+        uint32 lo, hi;
+
+        memcpy(&lo, source, 4);
+        memcpy(&hi, source + 4, 4);
+        hi = DFKSWAP_WORD(hi);
+        lo = DFKSWAP_WORD(lo);
+        memcpy(dest, &hi, 4);
+        memcpy(dest + 4, &lo, 4);
+        dest += dest_stride;
+        source += source_stride;
+    }
 
     return 0;
 }
@@ -1207,8 +1207,8 @@ done:
  GLOBAL VARIABLES
     Lastfile, foundRig, Refset, Newdata, Readrig, Writerig, Newpalette
  COMMENTS, BUGS, ASSUMPTIONS
-    This is a hook for someday providing more efficient ways to
-    reopen a file, to avoid re-reading all the headers.
+    A file opened for reading is kept open after it is closed, see
+    Hsetkeepopen(), so that reopening it does not read its DDs again.
  EXAMPLES
  REVISION LOG
 --------------------------------------------------------------------------*/
@@ -1236,6 +1236,10 @@ DFR8Iopen(const char *filename, intn acc_mode)
             HGOTO_ERROR(DFE_BADOPEN, FAIL);
     } /* end else */
 
+    /* files read are kept open between calls */
+    if (acc_mode == DFACC_READ)
+        HPkeep_open(file_id);
+
     /* remember filename, so reopen may be used next time if same file */
     strncpy(Lastfile, filename, DF_MAXFNLEN);
 
@@ -191,6 +191,7 @@ static intn IsCal         = 0; /* has calibration info been set?     */
 static uint16 Readref  = 0; /* ref of next SDG/NDG to be read? */
 static char  *Lastfile = NULL;
 static uint16 Lastref  = 0; /* Last ref to be read/written? */
+static uint32 Laststamp = 0; /* HPfile_stamp() of Lastfile when its nsdg table was read */
 static DFdi   lastnsdg;     /* last read nsdg in nsdg_t */
 
 /* Whether we've installed the library termination function yet for this interface */
@@ -3168,14 +3169,16 @@ done:
  *          acc_mode : access mode
  * Returns: file id on success, -1 (FAIL) on failure with error set
  * Users:   HDF systems programmers, many SD routines
- * Invokes: DFopen
- * Remarks: This is a hook for someday providing more efficient ways to
- *          reopen a file, to avoid re-reading all the headers
+ * Invokes: Hopen, HPkeep_open
+ * Remarks: A file opened for reading is kept open after it is closed, see
+ *          Hsetkeepopen(), and its nsdg table kept until the file changes,
+ *          so that reopening it reads neither its DDs nor its SDGs again
  *---------------------------------------------------------------------------*/
 int32
 DFSDIopen(const char *filename, intn acc_mode)
 {
     int32 file_id;
+    DFdi  last      = {DFTAG_NULL, 0}; /* place of the last nsdg in a table read again */
     int32 ret_value = SUCCEED;
 
     /* Perform global, one-time initialization */
@@ -3241,8 +3244,29 @@ DFSDIopen(const char *filename, intn acc_mode)
     else {
         if ((file_id = Hopen(filename, acc_mode, (int16)0)) == FAIL)
             HGOTO_ERROR(DFE_BADOPEN, FAIL);
+
+        /* read the nsdg table again if the file has changed since, keeping
+           the place of the last nsdg */
+        if (acc_mode == DFACC_READ && nsdghdr != NULL && nsdghdr->nsdg_t != NULL &&
+            HPfile_stamp(filename) != Laststamp) {
+            DFnsdgle *rear, *front;
+
+            rear = nsdghdr->nsdg_t;
+            while (rear != NULL) {
+                front = rear->next;
+                HDfreenclear(rear);
+                rear = front;
+            }
+            nsdghdr->size   = 0;
+            nsdghdr->nsdg_t = NULL;
+            last            = lastnsdg;
+        }
     }
 
+    /* files read are kept open between calls */
+    if (acc_mode == DFACC_READ)
+        HPkeep_open(file_id);
+
     /* if read, set up nsdg table */
     if (nsdghdr == NULL) {
         nsdghdr = (DFnsdg_t_hdr *)malloc((uint32)sizeof(DFnsdg_t_hdr));
@@ -3254,8 +3278,8 @@ DFSDIopen(const char *filename, intn acc_mode)
     if ((nsdghdr->nsdg_t == NULL) && (acc_mode == DFACC_READ)) {
         if (DFSDIsetnsdg_t(file_id, nsdghdr) < 0)
             HGOTO_ERROR(DFE_INTERNAL, FAIL);
-        lastnsdg.tag = DFTAG_NULL;
-        lastnsdg.ref = 0;
+        lastnsdg  = last;
+        Laststamp = HPfile_stamp(filename);
     }
 
     HIstrncpy(Lastfile, filename, DF_MAXFNLEN);
@@ -48,7 +48,8 @@ typedef struct {
     intn old_jpeg_image;  /* whether the image is an JPEG4-style HDF image */
     intn old_header_read; /* if the header has been read from the old image */
 
-    JOCTET *buffer; /* buffer for JPEG library to fill */
+    intn    whole_read; /* whether the whole image was read into the buffer */
+    JOCTET *buffer;     /* buffer for JPEG library to fill */
 } hdf_source_mgr;
 
 typedef hdf_source_mgr *hdf_src_ptr;
@@ -72,18 +73,33 @@ extern intn    jpeg_HDF_src_term(struct jpeg_decompress_struct *cinfo_ptr);
  * Returns: none.
  * Users:   JPEG library
  * Invokes: HDF low-level I/O functions
- * Remarks: Initializes the JPEG source mgr for further output.
+ * Remarks: Initializes the JPEG source mgr for further output.  A new-style
+ *          image is read in whole with one Hread, instead of feeding the
+ *          JPEG library INPUT_BUF_SIZE bytes at a time.
  *---------------------------------------------------------------------------*/
 void
 hdf_init_source(struct jpeg_decompress_struct *cinfo_ptr)
 {
-    hdf_src_ptr src = (hdf_src_ptr)cinfo_ptr->src;
-
-    if ((src->buffer = malloc(sizeof(JOCTET) * INPUT_BUF_SIZE)) == NULL)
-        ERREXIT1(cinfo_ptr, JERR_OUT_OF_MEMORY, (int)1);
+    hdf_src_ptr src    = (hdf_src_ptr)cinfo_ptr->src;
+    int32       length = 0; /* length of the compressed image */
 
     if ((src->aid = Hstartaccess(src->file_id, src->tag, src->ref, DFACC_READ)) == FAIL)
-        ERREXIT(cinfo_ptr, JERR_FILE_WRITE);
+        ERREXIT(cinfo_ptr, JERR_FILE_READ);
+
+    if (src->old_jpeg_image == FALSE &&
+        Hinquire(src->aid, NULL, NULL, NULL, &length, NULL, NULL, NULL, NULL) != FAIL && length > 0) {
+        /* the 2 extra bytes hold the EOI marker, see hdf_fill_input_buffer() */
+        if ((src->buffer = malloc(sizeof(JOCTET) * ((size_t)length + 2))) == NULL)
+            ERREXIT1(cinfo_ptr, JERR_OUT_OF_MEMORY, (int)1);
+        if (Hread(src->aid, length, src->buffer) != length)
+            ERREXIT(cinfo_ptr, JERR_FILE_READ);
+
+        src->whole_read          = TRUE;
+        src->pub.next_input_byte = src->buffer;
+        src->pub.bytes_in_buffer = (size_t)length;
+    } /* end if */
+    else if ((src->buffer = malloc(sizeof(JOCTET) * INPUT_BUF_SIZE)) == NULL)
+        ERREXIT1(cinfo_ptr, JERR_OUT_OF_MEMORY, (int)1);
 } /* end hdf_init_source() */
 
 /*-----------------------------------------------------------------------------
@@ -103,7 +119,9 @@ hdf_fill_input_buffer(struct jpeg_decompress_struct *cinfo_ptr)
     hdf_src_ptr src = (hdf_src_ptr)cinfo_ptr->src;
     int32       num_read; /* number of bytes read */
 
-    if (src->old_jpeg_image == TRUE) /* reading old-style JPEG image */
+    if (src->whole_read == TRUE) /* the whole image has been handed over */
+        src->pub.bytes_in_buffer = 0;
+    else if (src->old_jpeg_image == TRUE) /* reading old-style JPEG image */
     {
         if (src->old_header_read == TRUE) /* done with header just grab data now */
         {
@@ -259,6 +277,7 @@ jpeg_HDF_src(struct jpeg_decompress_struct *cinfo_ptr, int32 file_id, uint16 tag
     }                                          /* end if */
     else
         src->old_jpeg_image = FALSE; /* indicate an new-style image */
+    src->whole_read = FALSE;          /* set by hdf_init_source() */
 
     /* force fill_input_buffer until buffer loaded */
     src->pub.bytes_in_buffer = 0;
@@ -310,8 +329,9 @@ DFCIunjpeg(int32 file_id, uint16 tag, uint16 ref, void *image, int32 xdim, int32
      */
     struct jpeg_decompress_struct *cinfo_ptr;
     struct jpeg_error_mgr         *jerr_ptr;
-    JDIMENSION                     lines_read, lines_left;
-    JSAMPARRAY                     buffer;
+    JSAMPARRAY                     rows; /* the rows of the image */
+    size_t                         row_stride;
+    JDIMENSION                     i;
 
     if ((cinfo_ptr = calloc(1, sizeof(struct jpeg_decompress_struct))) == NULL)
         HRETURN_ERROR(DFE_NOSPACE, FAIL);
@@ -334,15 +354,17 @@ DFCIunjpeg(int32 file_id, uint16 tag, uint16 ref, void *image, int32 xdim, int32
     /* OK, get things started */
     jpeg_start_decompress(cinfo_ptr);
 
-    /* read the whole image in */
-    lines_left = (JDIMENSION)ydim;
-    while (cinfo_ptr->output_scanline < cinfo_ptr->output_height) {
-        buffer     = (JSAMPARRAY)&image;
-        lines_read = jpeg_read_scanlines(cinfo_ptr, buffer, 1);
-        lines_left -= lines_read;
-        image = (char *)image +
-                ((size_t)cinfo_ptr->output_width * (size_t)cinfo_ptr->output_components * lines_read);
-    } /* end while */
+    /* read the whole image in, decoding straight into the rows of 'image'
+       as many scanlines at a time as the JPEG library will give */
+    if ((rows = malloc(sizeof(JSAMPROW) * cinfo_ptr->output_height)) == NULL)
+        HRETURN_ERROR(DFE_NOSPACE, FAIL);
+    row_stride = (size_t)cinfo_ptr->output_width * (size_t)cinfo_ptr->output_components;
+    for (i = 0; i < cinfo_ptr->output_height; i++)
+        rows[i] = (JSAMPROW)image + (size_t)i * row_stride;
+    while (cinfo_ptr->output_scanline < cinfo_ptr->output_height)
+        jpeg_read_scanlines(cinfo_ptr, rows + cinfo_ptr->output_scanline,
+                            cinfo_ptr->output_height - cinfo_ptr->output_scanline);
+    free(rows);
 
     /* Finish reading stuff in */
     jpeg_finish_decompress(cinfo_ptr);
@@ -27,10 +27,16 @@ EXPORTED ROUTINES
    Happendable    - make a writable dataset appendable
    Hbitread       - read bits from a bitfile dataset
    Hbitwrite      - write bits to a bitfile dataset
+   Hbitwritev     - write an array of values to a bitfile dataset
+   Hbitreadv      - read an array of values from a bitfile dataset
    Hbitseek       - seek to a given bit offset in a bitfile dataset
    Hendbitaccess  - close off access to a bitfile dataset
 LOCAL ROUTINES
    HIbitflush         - flush the bits out to a writable bitfile
+   HIbitspill         - write out the full buffer of a writable bitfile
+   HIbitwrite         - write bits to a checked bitfile
+   HIbitfill          - read the next block of a bitfile into its buffer
+   HIbitread          - read bits from a checked bitfile
    HIget_bitfile_rec  - get a free bitfile record
    HIread2write       - switch from reading bits to writing them
    HIwrite2read       - switch from writing bits to reading them
@@ -61,6 +67,11 @@ static bitrec_t *HIget_bitfile_rec(void);
 
 static intn HIbitflush(bitrec_t *bitfile_rec, intn flushbit, intn writeout);
 
+static intn HIbitspill(bitrec_t *bitfile_rec);
+static intn HIbitwrite(bitrec_t *bitfile_rec, intn count, uint32 data);
+static intn HIbitfill(bitrec_t *bitfile_rec);
+static intn HIbitread(bitrec_t *bitfile_rec, intn count, uint32 *data);
+
 static intn HIwrite2read(bitrec_t *bitfile_rec);
 static intn HIread2write(bitrec_t *bitfile_rec);
 
@@ -127,10 +138,11 @@ Hstartbitread(int32 file_id, uint16 tag, uint16 ref)
 
         read_size = MIN((bitfile_rec->max_offset - bitfile_rec->byte_offset), BITBUF_SIZE);
         if ((n = Hread(bitfile_rec->acc_id, read_size, bitfile_rec->bytea)) == FAIL)
-            return FAIL;                            /* EOF? somebody pulled the rug out from under us! */
-        bitfile_rec->buf_read = (intn)n;            /* keep track of the number of bytes in buffer */
-        bitfile_rec->bytep    = bitfile_rec->bytea; /* set to the beginning of the buffer */
-    }                                               /* end if */
+            return FAIL;                                /* EOF? somebody pulled the rug out from under us! */
+        bitfile_rec->buf_read = (intn)n;                /* keep track of the number of bytes in buffer */
+        bitfile_rec->bytep    = bitfile_rec->bytea;     /* set to the beginning of the buffer */
+        bitfile_rec->bytez    = bitfile_rec->bytea + n; /* and its end to the end of the bytes read */
+    }                                                   /* end if */
     else {
         bitfile_rec->bytep    = bitfile_rec->bytez; /* set to the end of the buffer to force read */
         bitfile_rec->buf_read = 0;                  /* set the number of bytes in buffer to 0 */
@@ -288,9 +300,8 @@ Hbitappendable(int32 bitid)
 intn
 Hbitwrite(int32 bitid, intn count, uint32 data)
 {
-    static int32     last_bit_id = (-1);  /* the bit ID of the last bitfile_record accessed */
-    static bitrec_t *bitfile_rec = NULL;  /* access record */
-    intn             orig_count  = count; /* keep track of orig, number of bits to output */
+    static int32     last_bit_id = (-1); /* the bit ID of the last bitfile_record accessed */
+    static bitrec_t *bitfile_rec = NULL; /* access record */
 
     /* clear error stack and check validity of file id */
     HEclear();
@@ -312,86 +323,70 @@ Hbitwrite(int32 bitid, intn count, uint32 data)
     if (bitfile_rec->access != 'w')
         HRETURN_ERROR(DFE_BADACC, FAIL);
 
-    if (count > (intn)DATANUM)
-        count = (intn)DATANUM;
-
     /* change bitfile modes if necessary */
     if (bitfile_rec->mode == 'r')
         HIread2write(bitfile_rec);
 
-    data &= maskl[count];
-
-    /* if the new bits will not fill up a byte, then just */
-    /* merge the new bits into the current bits buffer */
-    if (count < bitfile_rec->count) {
-        bitfile_rec->bits |= (uint8)(data << (bitfile_rec->count -= count));
-        return orig_count;
-    } /* end if */
+    if (HIbitwrite(bitfile_rec, MIN(count, (intn)DATANUM), data) == FAIL)
+        return FAIL;
+    return count;
+} /* end Hbitwrite() */
 
-    /* fill up the current bits buffer and output the byte */
-    *(bitfile_rec->bytep) = (uint8)(bitfile_rec->bits | (uint8)(data >> (count -= bitfile_rec->count)));
-    bitfile_rec->byte_offset++;
-    if (++bitfile_rec->bytep == bitfile_rec->bytez) {
-        int32 write_size;
+/*--------------------------------------------------------------------------
 
-        write_size         = bitfile_rec->bytez - bitfile_rec->bytea;
-        bitfile_rec->bytep = bitfile_rec->bytea;
-        if (Hwrite(bitfile_rec->acc_id, write_size, bitfile_rec->bytea) == FAIL)
-            HRETURN_ERROR(DFE_WRITEERROR, FAIL);
-        bitfile_rec->block_offset += write_size;
+ NAME
+       Hbitwritev -- write an array of values out to a bit-element
+ USAGE
+       int32 Hbitwritev(bitid, count, nvalues, data)
+       int32 bitid;         IN: id of bit-element to write to
+       intn count;          IN: number of bits to write of each value
+       int32 nvalues;       IN: number of values to write
+       const uint32 *data;  IN: the values to output
+                            (bits to output must be in the low bits)
+ RETURNS
+       the number of values written for successful write,
+       FAIL to indicate failure
+ DESCRIPTION
+       Write the low 'count' bits of each of 'nvalues' values out to a
+       bit-element, one after the other.  The result is the same as that
+       of calling Hbitwrite() for each value, but the bit-element is only
+       looked up and checked once.
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+int32
+Hbitwritev(int32 bitid, intn count, int32 nvalues, const uint32 *data)
+{
+    bitrec_t *bitfile_rec; /* access record */
+    int32     i;
 
-        /* check if we should pre-read the next block into the buffer */
-        if (bitfile_rec->max_offset > bitfile_rec->byte_offset) {
-            int32 read_size; /* number of bytes to read into buffer */
-            int32 n;         /* number of bytes actually read */
+    /* clear error stack and check validity of file id */
+    HEclear();
 
-            read_size = MIN((bitfile_rec->max_offset - bitfile_rec->byte_offset), BITBUF_SIZE);
-            if ((n = Hread(bitfile_rec->acc_id, read_size, bitfile_rec->bytea)) == FAIL)
-                HRETURN_ERROR(DFE_READERROR, FAIL); /* EOF? somebody pulled the rug out from under us! */
-            bitfile_rec->buf_read = n;              /* keep track of the number of bytes in buffer */
-            if (Hseek(bitfile_rec->acc_id, bitfile_rec->block_offset, DF_START) == FAIL)
-                HRETURN_ERROR(DFE_SEEKERROR, FAIL);
-        } /* end if */
-    }     /* end if */
+    if (count <= 0 || nvalues < 0 || (nvalues > 0 && data == NULL))
+        HRETURN_ERROR(DFE_ARGS, FAIL);
 
-    /* output any and all remaining whole bytes */
-    while (count >= (intn)BITNUM) {
-        *(bitfile_rec->bytep) = (uint8)(data >> (count -= (intn)BITNUM));
-        bitfile_rec->byte_offset++;
-        if (++bitfile_rec->bytep == bitfile_rec->bytez) {
-            int32 write_size;
+    if ((bitfile_rec = HAatom_object(bitid)) == NULL)
+        HRETURN_ERROR(DFE_ARGS, FAIL);
 
-            write_size         = bitfile_rec->bytez - bitfile_rec->bytea;
-            bitfile_rec->bytep = bitfile_rec->bytea;
-            if (Hwrite(bitfile_rec->acc_id, write_size, bitfile_rec->bytea) == FAIL)
-                HRETURN_ERROR(DFE_WRITEERROR, FAIL);
-            bitfile_rec->block_offset += write_size;
-
-            /* check if we should pre-read the next block into the buffer */
-            if (bitfile_rec->max_offset > bitfile_rec->byte_offset) {
-                int32 read_size; /* number of bytes to read into buffer */
-                int32 n;         /* number of bytes actually read */
-
-                read_size = MIN((bitfile_rec->max_offset - bitfile_rec->byte_offset), BITBUF_SIZE);
-                if ((n = Hread(bitfile_rec->acc_id, read_size, bitfile_rec->bytea)) == FAIL)
-                    HRETURN_ERROR(DFE_READERROR, FAIL); /* EOF? somebody pulled the rug out from under us! */
-                bitfile_rec->buf_read = n;              /* keep track of the number of bytes in buffer */
-                if (Hseek(bitfile_rec->acc_id, bitfile_rec->block_offset, DF_START) == FAIL)
-                    HRETURN_ERROR(DFE_SEEKERROR, FAIL);
-            } /* end if */
-        }     /* end if */
-    }         /* end while */
+    /* Check for write access */
+    if (bitfile_rec->access != 'w')
+        HRETURN_ERROR(DFE_BADACC, FAIL);
 
-    /* put any remaining bits into the bits buffer */
-    if ((bitfile_rec->count = (intn)BITNUM - count) > 0)
-        bitfile_rec->bits = (uint8)(data << bitfile_rec->count);
+    /* change bitfile modes if necessary */
+    if (bitfile_rec->mode == 'r')
+        HIread2write(bitfile_rec);
 
-    /* Update the offset in the buffer */
-    if (bitfile_rec->byte_offset > bitfile_rec->max_offset)
-        bitfile_rec->max_offset = bitfile_rec->byte_offset;
+    if (count > (intn)DATANUM)
+        count = (intn)DATANUM;
 
-    return orig_count;
-} /* end Hbitwrite() */
+    for (i = 0; i < nvalues; i++)
+        if (HIbitwrite(bitfile_rec, count, data[i]) == FAIL)
+            return FAIL;
+    return nvalues;
+} /* end Hbitwritev() */
 
 /*--------------------------------------------------------------------------
 
@@ -421,10 +416,6 @@ Hbitread(int32 bitid, intn count, uint32 *data)
 {
     static int32     last_bit_id = (-1); /* the bit ID of the last bitfile_record accessed */
     static bitrec_t *bitfile_rec = NULL; /* access record */
-    uint32           l;
-    uint32           b = 0;      /* bits to return */
-    intn             orig_count; /* the original number of bits to read in */
-    int32            n;
 
     /* clear error stack and check validity of file id */
     HEclear();
@@ -450,72 +441,60 @@ Hbitread(int32 bitid, intn count, uint32 *data)
     if (count > (intn)DATANUM) /* truncate the count if it's too large */
         count = DATANUM;
 
-    /* if the request can be satisfied with just the */
-    /* buffered bits then do the shift and return */
-    if (count <= bitfile_rec->count) {
-        *data = (uint32)((uintn)bitfile_rec->bits >> (bitfile_rec->count -= count)) & (uint32)maskc[count];
-        return count;
-    } /* end if */
+    return HIbitread(bitfile_rec, count, data);
+} /* end Hbitread() */
 
-    /* keep track of the original number of bits to read in */
-    orig_count = count;
+/*--------------------------------------------------------------------------
 
-    /* get all the buffered bits into the correct position first */
-    if (bitfile_rec->count > 0) {
-        b = (uint32)(bitfile_rec->bits & maskc[bitfile_rec->count]);
-        b <<= (count -= bitfile_rec->count);
-    } /* end if */
+ NAME
+       Hbitreadv -- read an array of values from a bit-element
+ USAGE
+       int32 Hbitreadv(bitid, count, nvalues, data)
+       int32 bitid;         IN: id of bit-element to read from
+       intn count;          IN: number of bits to read for each value
+       int32 nvalues;       IN: number of values to read
+       uint32 *data;        OUT: the values read in
+                            (bits input will be in the low bits)
+ RETURNS
+       the number of values read in full, which is less than 'nvalues'
+       when the end of the bit-element was reached, or FAIL to indicate
+       failure
+ DESCRIPTION
+       Read 'nvalues' values of 'count' bits each from a bit-element.
+       The result is the same as that of calling Hbitread() for each
+       value, but the bit-element is only looked up and checked once.
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+int32
+Hbitreadv(int32 bitid, intn count, int32 nvalues, uint32 *data)
+{
+    bitrec_t *bitfile_rec; /* access record */
+    int32     i;
 
-    /* bring in as many whole bytes as the request allows */
-    while (count >= (intn)BITNUM) {
-        if (bitfile_rec->bytep == bitfile_rec->bytez) {
-            n = Hread(bitfile_rec->acc_id, BITBUF_SIZE, bitfile_rec->bytea);
-            if (n == FAIL) { /* EOF */
-                bitfile_rec->count =
-                    0;     /* make certain that we don't try to access the file->bits information */
-                *data = b; /* assign the bits read in */
-                return orig_count - count; /* break out now */
-            }                              /* end if */
-            bitfile_rec->block_offset +=
-                bitfile_rec->buf_read; /* keep track of the number of bytes in buffer */
-            bitfile_rec->bytez    = n + (bitfile_rec->bytep = bitfile_rec->bytea);
-            bitfile_rec->buf_read = n; /* keep track of the number of bytes in buffer */
-        }                              /* end if */
-        l = (uint32)(*bitfile_rec->bytep++);
-        b |= (uint32)(l << (count -= (intn)BITNUM));
-        bitfile_rec->byte_offset++;
-        if (bitfile_rec->byte_offset > bitfile_rec->max_offset)
-            bitfile_rec->max_offset = bitfile_rec->byte_offset;
-    } /* end while */
+    /* clear error stack and check validity of file id */
+    HEclear();
 
-    /* split any partial request with the bits buffer */
-    if (count > 0) {
-        if (bitfile_rec->bytep == bitfile_rec->bytez) {
-            n = Hread(bitfile_rec->acc_id, BITBUF_SIZE, bitfile_rec->bytea);
-            if (n == FAIL) { /* EOF */
-                bitfile_rec->count =
-                    0;     /* make certain that we don't try to access the file->bits information */
-                *data = b; /* assign the bits read in */
-                return orig_count - count; /* return now */
-            }                              /* end if */
-            bitfile_rec->block_offset +=
-                bitfile_rec->buf_read; /* keep track of the number of bytes in buffer */
-            bitfile_rec->bytez    = n + (bitfile_rec->bytep = bitfile_rec->bytea);
-            bitfile_rec->buf_read = n; /* keep track of the number of bytes in buffer */
-        }                              /* end if */
-        bitfile_rec->count = ((intn)BITNUM - count);
-        l                  = (uint32)(bitfile_rec->bits = *bitfile_rec->bytep++);
-        b |= l >> bitfile_rec->count;
-        bitfile_rec->byte_offset++;
-        if (bitfile_rec->byte_offset > bitfile_rec->max_offset)
-            bitfile_rec->max_offset = bitfile_rec->byte_offset;
-    } /* end if */
-    else
-        bitfile_rec->count = 0;
+    if (count <= 0 || nvalues < 0 || (nvalues > 0 && data == NULL))
+        HRETURN_ERROR(DFE_ARGS, FAIL);
 
-    *data = b;
-    return orig_count;
-} /* end Hbitread() */
+    if ((bitfile_rec = HAatom_object(bitid)) == NULL)
+        HRETURN_ERROR(DFE_ARGS, FAIL);
+
+    /* change bitfile modes if necessary */
+    if (bitfile_rec->mode == 'w')
+        HIwrite2read(bitfile_rec);
+
+    if (count > (intn)DATANUM) /* truncate the count if it's too large */
+        count = DATANUM;
+
+    for (i = 0; i < nvalues; i++)
+        if (HIbitread(bitfile_rec, count, &data[i]) != count)
+            break;
+    return i;
+} /* end Hbitreadv() */
 
 /*--------------------------------------------------------------------------
 
@@ -778,7 +757,9 @@ HIbitflush(bitrec_t *bitfile_rec, intn flushbit, intn writeout)
         }                                /* end else */
     }                                    /* end if */
     if (writeout == TRUE) {              /* only write data out if necessary */
-        write_size = (intn)MIN((bitfile_rec->bytez - bitfile_rec->bytea), bitfile_rec->max_offset);
+        /* only the bytes of the buffer which are in the dataset */
+        write_size = (intn)MIN((bitfile_rec->bytez - bitfile_rec->bytea),
+                               bitfile_rec->max_offset - bitfile_rec->block_offset);
         if (write_size > 0)
             if (Hwrite(bitfile_rec->acc_id, write_size, bitfile_rec->bytea) == FAIL)
                 HRETURN_ERROR(DFE_WRITEERROR, FAIL);
@@ -787,6 +768,215 @@ HIbitflush(bitrec_t *bitfile_rec, intn flushbit, intn writeout)
     return SUCCEED;
 } /* HIbitflush */
 
+/*--------------------------------------------------------------------------
+
+ NAME
+    HIbitspill -- write out the full buffer of a writable bitfile
+ USAGE
+    intn HIbitspill(bitfile_rec)
+        bitrec_t *bitfile_rec;  IN: record of bitfile element to write out
+ RETURNS
+    returns SUCCEED (0) if successful, FAIL (-1) otherwise
+ DESCRIPTION
+    Writes out the buffer once the bits written have reached its end, and
+    pre-reads the next block of the dataset into it when there is one, so
+    that bits written into the middle of the dataset merge with it.
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+static intn
+HIbitspill(bitrec_t *bitfile_rec)
+{
+    int32 write_size;
+
+    write_size         = bitfile_rec->bytez - bitfile_rec->bytea;
+    bitfile_rec->bytep = bitfile_rec->bytea;
+    if (Hwrite(bitfile_rec->acc_id, write_size, bitfile_rec->bytea) == FAIL)
+        HRETURN_ERROR(DFE_WRITEERROR, FAIL);
+    bitfile_rec->block_offset += write_size;
+
+    /* check if we should pre-read the next block into the buffer */
+    if (bitfile_rec->max_offset > bitfile_rec->byte_offset) {
+        int32 read_size; /* number of bytes to read into buffer */
+        int32 n;         /* number of bytes actually read */
+
+        read_size = MIN((bitfile_rec->max_offset - bitfile_rec->byte_offset), BITBUF_SIZE);
+        if ((n = Hread(bitfile_rec->acc_id, read_size, bitfile_rec->bytea)) == FAIL)
+            HRETURN_ERROR(DFE_READERROR, FAIL); /* EOF? somebody pulled the rug out from under us! */
+        bitfile_rec->buf_read = n;              /* keep track of the number of bytes in buffer */
+        if (Hseek(bitfile_rec->acc_id, bitfile_rec->block_offset, DF_START) == FAIL)
+            HRETURN_ERROR(DFE_SEEKERROR, FAIL);
+    } /* end if */
+
+    return SUCCEED;
+} /* HIbitspill */
+
+/*--------------------------------------------------------------------------
+
+ NAME
+    HIbitwrite -- write a number of bits out to a checked bitfile
+ USAGE
+    intn HIbitwrite(bitfile_rec, count, data)
+        bitrec_t *bitfile_rec;  IN: record of bitfile element in write mode
+        intn count;             IN: number of bits to write, up to DATANUM
+        uint32 data;            IN: actual data bits to output
+ RETURNS
+    returns SUCCEED (0) if successful, FAIL (-1) otherwise
+ DESCRIPTION
+    The work of Hbitwrite() and Hbitwritev(), once they have checked the
+    bitfile and its access.
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+static intn
+HIbitwrite(bitrec_t *bitfile_rec, intn count, uint32 data)
+{
+    data &= maskl[count];
+
+    /* if the new bits will not fill up a byte, then just */
+    /* merge the new bits into the current bits buffer */
+    if (count < bitfile_rec->count) {
+        bitfile_rec->bits |= (uint8)(data << (bitfile_rec->count -= count));
+        return SUCCEED;
+    } /* end if */
+
+    /* fill up the current bits buffer and output the byte */
+    *(bitfile_rec->bytep) = (uint8)(bitfile_rec->bits | (uint8)(data >> (count -= bitfile_rec->count)));
+    bitfile_rec->byte_offset++;
+    if (++bitfile_rec->bytep == bitfile_rec->bytez && HIbitspill(bitfile_rec) == FAIL)
+        return FAIL;
+
+    /* output any and all remaining whole bytes */
+    while (count >= (intn)BITNUM) {
+        *(bitfile_rec->bytep) = (uint8)(data >> (count -= (intn)BITNUM));
+        bitfile_rec->byte_offset++;
+        if (++bitfile_rec->bytep == bitfile_rec->bytez && HIbitspill(bitfile_rec) == FAIL)
+            return FAIL;
+    } /* end while */
+
+    /* put any remaining bits into the bits buffer */
+    if ((bitfile_rec->count = (intn)BITNUM - count) > 0)
+        bitfile_rec->bits = (uint8)(data << bitfile_rec->count);
+
+    /* Update the offset in the buffer */
+    if (bitfile_rec->byte_offset > bitfile_rec->max_offset)
+        bitfile_rec->max_offset = bitfile_rec->byte_offset;
+
+    return SUCCEED;
+} /* HIbitwrite */
+
+/*--------------------------------------------------------------------------
+
+ NAME
+    HIbitfill -- read the next block of a bitfile into its buffer
+ USAGE
+    intn HIbitfill(bitfile_rec)
+        bitrec_t *bitfile_rec;  IN: record of bitfile element to read
+ RETURNS
+    returns SUCCEED (0) if successful, FAIL (-1) at the end of the dataset
+ DESCRIPTION
+    Called by HIbitread() once the bits read have reached the end of the
+    buffer.
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+static intn
+HIbitfill(bitrec_t *bitfile_rec)
+{
+    int32 n;
+
+    if ((n = Hread(bitfile_rec->acc_id, BITBUF_SIZE, bitfile_rec->bytea)) == FAIL || n == 0) /* EOF */
+        return FAIL;
+    bitfile_rec->block_offset += bitfile_rec->buf_read; /* keep track of the number of bytes in buffer */
+    bitfile_rec->bytez    = n + (bitfile_rec->bytep = bitfile_rec->bytea);
+    bitfile_rec->buf_read = n; /* keep track of the number of bytes in buffer */
+
+    return SUCCEED;
+} /* HIbitfill */
+
+/*--------------------------------------------------------------------------
+
+ NAME
+    HIbitread -- read a number of bits from a checked bitfile
+ USAGE
+    intn HIbitread(bitfile_rec, count, data)
+        bitrec_t *bitfile_rec;  IN: record of bitfile element in read mode
+        intn count;             IN: number of bits to read, up to DATANUM
+        uint32 *data;           OUT: the bits read in
+ RETURNS
+    the number of bits read, less than 'count' at the end of the dataset
+ DESCRIPTION
+    The work of Hbitread() and Hbitreadv(), once they have checked the
+    bitfile.
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+static intn
+HIbitread(bitrec_t *bitfile_rec, intn count, uint32 *data)
+{
+    uint32 l;
+    uint32 b = 0;      /* bits to return */
+    intn   orig_count; /* the original number of bits to read in */
+
+    /* if the request can be satisfied with just the */
+    /* buffered bits then do the shift and return */
+    if (count <= bitfile_rec->count) {
+        *data = (uint32)((uintn)bitfile_rec->bits >> (bitfile_rec->count -= count)) & (uint32)maskc[count];
+        return count;
+    } /* end if */
+
+    /* keep track of the original number of bits to read in */
+    orig_count = count;
+
+    /* get all the buffered bits into the correct position first */
+    if (bitfile_rec->count > 0) {
+        b = (uint32)(bitfile_rec->bits & maskc[bitfile_rec->count]);
+        b <<= (count -= bitfile_rec->count);
+    } /* end if */
+
+    /* bring in as many whole bytes as the request allows */
+    while (count >= (intn)BITNUM) {
+        if (bitfile_rec->bytep == bitfile_rec->bytez && HIbitfill(bitfile_rec) == FAIL) {
+            bitfile_rec->count = 0; /* make certain that we don't try to access the file->bits information */
+            *data              = b; /* assign the bits read in */
+            return orig_count - count; /* break out now */
+        }                              /* end if */
+        l = (uint32)(*bitfile_rec->bytep++);
+        b |= (uint32)(l << (count -= (intn)BITNUM));
+        bitfile_rec->byte_offset++;
+        if (bitfile_rec->byte_offset > bitfile_rec->max_offset)
+            bitfile_rec->max_offset = bitfile_rec->byte_offset;
+    } /* end while */
+
+    /* split any partial request with the bits buffer */
+    if (count > 0) {
+        if (bitfile_rec->bytep == bitfile_rec->bytez && HIbitfill(bitfile_rec) == FAIL) {
+            bitfile_rec->count = 0; /* make certain that we don't try to access the file->bits information */
+            *data              = b; /* assign the bits read in */
+            return orig_count - count; /* return now */
+        }                              /* end if */
+        bitfile_rec->count = ((intn)BITNUM - count);
+        l                  = (uint32)(bitfile_rec->bits = *bitfile_rec->bytep++);
+        b |= l >> bitfile_rec->count;
+        bitfile_rec->byte_offset++;
+        if (bitfile_rec->byte_offset > bitfile_rec->max_offset)
+            bitfile_rec->max_offset = bitfile_rec->byte_offset;
+    } /* end if */
+    else
+        bitfile_rec->count = 0;
+
+    *data = b;
+    return orig_count;
+} /* HIbitread */
+
 /*--------------------------------------------------------------------------
  HIget_bitfile_rec - get a new bitfile record
 --------------------------------------------------------------------------*/
@@ -826,7 +1016,9 @@ HIread2write(bitrec_t *bitfile_rec)
 
     bitfile_rec->block_offset = (int32)LONG_MIN; /* set to bogus value */
     bitfile_rec->mode         = 'w';             /* change to write mode */
-    if (Hbitseek(bitfile_rec->bit_id, bitfile_rec->byte_offset, ((intn)BITNUM - bitfile_rec->count)) == FAIL)
+    /* a count of zero means the last byte read was used up, so start at the next one */
+    if (Hbitseek(bitfile_rec->bit_id, bitfile_rec->byte_offset,
+                 ((intn)BITNUM - bitfile_rec->count) % (intn)BITNUM) == FAIL)
         HRETURN_ERROR(DFE_INTERNAL, FAIL);
     return SUCCEED;
 } /* HIread2write */
@@ -103,6 +103,7 @@ EXPORTED ROUTINES
    HLcreate       -- create a linked block element
    HLconvert      -- convert an AID into a linked block element
    HLgetdatainfo  -- get data information of linked blocks
+   HLcompact      -- rewrite linked block elements as contiguous ones
    HDinqblockinfo -- return info about linked blocks
    HLPstread      -- open an access record for reading
    HLPstwrite     -- open an access record for writing
@@ -115,7 +116,9 @@ EXPORTED ROUTINES
 LOCAL ROUTINES
    HLIstaccess -- set up AID to access a linked block elem
    HLIgetlink  -- get link information
+   HLIlinkat   -- find a block table by its position in the chain
    HLInewlink  -- write out some data to a linked block
+   HLIcompact  -- rewrite one linked block element as a contiguous one
 */
 
 #include "hdf.h"
@@ -145,8 +148,14 @@ typedef struct linkinfo_t {
     uint16  link_ref;      /* ref of the first block table structure */
     link_t *link;          /* pointer to the first block table */
     link_t *last_link;     /* pointer to the last block table */
+    link_t **link_index;   /* the block tables in order, see HLIlinkat() */
+    int32    nindexed;     /* # of block tables in 'link_index' */
+    int32    index_size;   /* # of slots allocated in 'link_index' */
 } linkinfo_t;
 
+/* # of blocks queued for one batched read in HLPread() */
+#define HL_READ_BATCH 64
+
 /* private functions */
 static int32 HLIstaccess(accrec_t *access_rec, int16 acc_mode);
 
@@ -154,6 +163,10 @@ static link_t *HLInewlink(int32 file_id, int32 number_blocks, uint16 link_ref, u
 
 static link_t *HLIgetlink(int32 file_id, uint16 ref, int32 number_blocks);
 
+static link_t *HLIlinkat(linkinfo_t *info, int32 *nth);
+
+static intn HLIcompact(filerec_t *file_rec, int32 file_id, uint16 tag, uint16 ref);
+
 /* the accessing function table for linked blocks */
 funclist_t linked_funcs = {
     HLPstread, HLPstwrite,   HLPseek, HLPinquire, HLPread,
@@ -194,6 +207,7 @@ int32
 HLcreate(int32 file_id, uint16 tag, uint16 ref, int32 block_length, int32 number_blocks)
 {
     filerec_t  *file_rec;                  /* file record */
+    filerec_t  *locked     = NULL;         /* file record locked by this call */
     accrec_t   *access_rec = NULL;         /* access record */
     int32       dd_aid;                    /* AID for writing the special info */
     linkinfo_t *info = NULL;               /* information for the linked blocks elt */
@@ -209,6 +223,8 @@ HLcreate(int32 file_id, uint16 tag, uint16 ref, int32 block_length, int32 number
 
     /* clear error stack and validate file record id */
     HEclear();
+    locked = HL_LOCK_FID(file_id);
+
     file_rec = HAatom_object(file_id);
 
     /* check args and create special tag */
@@ -281,6 +297,9 @@ HLcreate(int32 file_id, uint16 tag, uint16 ref, int32 block_length, int32 number
     info->block_length  = block_length;
     info->number_blocks = number_blocks;
     info->link_ref      = link_ref;
+    info->link_index    = NULL;
+    info->nindexed      = 0;
+    info->index_size    = 0;
 
     /* encode special information for writing to file */
     {
@@ -336,6 +355,7 @@ done:
             HIrelease_accrec_node(access_rec);
     }
 
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* HLcreate() */
 
@@ -380,6 +400,7 @@ intn
 HLconvert(int32 aid, int32 block_length, int32 number_blocks)
 {
     filerec_t  *file_rec;                               /* file record */
+    filerec_t  *locked     = NULL;                      /* file record locked by this call */
     accrec_t   *access_rec = NULL;                      /* access record */
     linkinfo_t *info;                                   /* information for the linked blocks elt */
     uint16      link_ref;                               /* the ref of the link structure
@@ -397,6 +418,7 @@ HLconvert(int32 aid, int32 block_length, int32 number_blocks)
 
     /* clear error stack */
     HEclear();
+    locked = HL_LOCK_AID(aid);
 
     /* start checking the func. args */
     if (HAatom_group(aid) != AIDGROUP || block_length < 0 || number_blocks < 0)
@@ -475,6 +497,9 @@ HLconvert(int32 aid, int32 block_length, int32 number_blocks)
     info->block_length  = block_length;
     info->number_blocks = number_blocks;
     info->link_ref      = link_ref;
+    info->link_index    = NULL;
+    info->nindexed      = 0;
+    info->index_size    = 0;
 
     /* Get ready to fill and write the special info structure  */
 
@@ -523,9 +548,221 @@ done:
         }
     }
 
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* end HLconvert() */
 
+/* ------------------------------ HLIcompact ------------------------------ */
+/*
+NAME
+   HLIcompact -- rewrite one linked block element as a contiguous one
+USAGE
+   intn HLIcompact(file_rec, file_id, tag, ref)
+   filerec_t *file_rec;  IN: file record
+   int32  file_id;       IN: file the element is in
+   uint16 tag;           IN: tag of the element
+   uint16 ref;           IN: ref of the element
+RETURNS
+   SUCCEED / FAIL
+DESCRIPTION
+   Reads the whole element, writes it at the end of the file as plain
+   data and points the element's DD at it.  Only then are the block
+   tables and the blocks deleted, so a failure leaves the element as it
+   was.  Elements that are not linked block elements, or that are empty,
+   are left alone.
+
+---------------------------------------------------------------------------*/
+static intn
+HLIcompact(filerec_t *file_rec, int32 file_id, uint16 tag, uint16 ref)
+{
+    accrec_t   *access_rec;          /* access record of the element */
+    linkinfo_t *info;                /* information on the linked blocks */
+    link_t     *t_link;              /* current block table */
+    int32       aid     = FAIL;      /* access id of the element */
+    atom_t      ddid    = FAIL;      /* DD of the element */
+    uint8      *data    = NULL;      /* the data of the element */
+    uint16     *refs    = NULL;      /* refs of the block tables and blocks */
+    int32       nrefs   = 0;         /* # of refs in 'refs' */
+    int32       length;              /* length of the element */
+    int32       new_off;             /* offset of the contiguous data */
+    int32       i;
+    intn        ret_value = SUCCEED;
+
+    if ((aid = Hstartread(file_id, tag, ref)) == FAIL)
+        HGOTO_ERROR(DFE_CANTACCESS, FAIL);
+    if ((access_rec = HAatom_object(aid)) == NULL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (access_rec->special != SPECIAL_LINKED)
+        HGOTO_DONE(SUCCEED);
+
+    /* the element must not be in use through another access id */
+    info = (linkinfo_t *)access_rec->special_info;
+    if (info->attached > 1)
+        HGOTO_ERROR(DFE_OPENAID, FAIL);
+    if ((length = info->length) <= 0)
+        HGOTO_DONE(SUCCEED);
+
+    /* read all of the data */
+    if ((data = (uint8 *)malloc((size_t)length)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if (Hread(aid, length, data) != length)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
+
+    /* remember the block tables and the blocks to delete */
+    for (t_link = info->link; t_link != NULL; t_link = t_link->next)
+        nrefs += 1 + info->number_blocks;
+    if ((refs = (uint16 *)malloc((size_t)nrefs * sizeof(uint16))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    nrefs = 0;
+    refs[nrefs++] = info->link_ref;
+    for (t_link = info->link; t_link != NULL; t_link = t_link->next) {
+        for (i = 0; i < info->number_blocks; i++)
+            if (t_link->block_list[i].ref != 0)
+                refs[nrefs++] = t_link->block_list[i].ref;
+        if (t_link->next != NULL)
+            refs[nrefs++] = t_link->nextref;
+    }
+
+    if (Hendaccess(aid) == FAIL)
+        HGOTO_ERROR(DFE_CANTENDACCESS, FAIL);
+    aid = FAIL;
+
+    /* write the data as one piece and turn the element into a plain one */
+    if ((new_off = HPgetdiskblock(file_rec, length, TRUE)) == FAIL)
+        HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+    if (HP_write(file_rec, data, length) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    if ((ddid = HTPselect(file_rec, tag, ref)) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (HTPunspecial(ddid, new_off, length) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* the linked blocks are not used anymore */
+    for (i = 0; i < nrefs; i++)
+        if (Hdeldd(file_id, DFTAG_LINKED, refs[i]) == FAIL)
+            HGOTO_ERROR(DFE_CANTDELDD, FAIL);
+
+done:
+    if (ddid != FAIL)
+        HTPendaccess(ddid);
+    if (aid != FAIL)
+        Hendaccess(aid);
+    free(data);
+    free(refs);
+
+    return ret_value;
+} /* HLIcompact */
+
+/* ------------------------------- HLcompact ------------------------------ */
+/*
+NAME
+   HLcompact -- rewrite linked block elements as contiguous ones
+USAGE
+   intn HLcompact(file_id, tag, ref)
+   int32  file_id;       IN: file the element is in
+   uint16 tag;           IN: tag of the element, or DFTAG_WILDCARD
+   uint16 ref;           IN: ref of the element, or DFREF_WILDCARD
+RETURNS
+   SUCCEED / FAIL
+DESCRIPTION
+   Rewrites a linked block element, such as the data of an appendable
+   vdata or of a dataset with an unlimited dimension, as one contiguous
+   element with the same tag/ref, and deletes its block tables and
+   blocks.  Reads of the element then go straight through the file
+   instead of hopping from block to block.  Appending to the element
+   later turns it back into a linked block element.
+
+   With DFTAG_WILDCARD and DFREF_WILDCARD all the linked block elements
+   of the file are compacted.  Other elements are left alone.  The
+   element must not be open through another access id.
+
+   This routine is unsafe in the way Hdeldd() is.  The space of the old
+   blocks is released with HPfreediskblock(), for later writes to the
+   file while it stays open.
+
+---------------------------------------------------------------------------*/
+intn
+HLcompact(int32 file_id, uint16 tag, uint16 ref)
+{
+    filerec_t *file_rec;         /* file record */
+    filerec_t *locked = NULL;
+    uint16    *tags   = NULL;    /* tags of the special elements */
+    uint16    *refs   = NULL;    /* refs of the special elements */
+    int32      nelts  = 0;       /* # of special elements found */
+    int32      max_elts;         /* # of slots in 'tags' and 'refs' */
+    int32      i;
+    intn       ret_value = SUCCEED;
+
+    /* clear error stack and check validity of file record id */
+    HEclear();
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec) || !(file_rec->access & DFACC_WRITE))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if ((tag == DFTAG_WILDCARD) != (ref == DFREF_WILDCARD))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    locked = HL_LOCK_FILE(file_rec);
+
+    if (tag != DFTAG_WILDCARD) {
+        ret_value = HLIcompact(file_rec, file_id, tag, ref);
+        goto done;
+    }
+
+    /* list the special elements first, compacting them changes the DDs */
+    if ((max_elts = Hnumber(file_id, DFTAG_WILDCARD)) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (max_elts == 0)
+        HGOTO_DONE(SUCCEED);
+    if ((tags = (uint16 *)malloc((size_t)max_elts * sizeof(uint16))) == NULL ||
+        (refs = (uint16 *)malloc((size_t)max_elts * sizeof(uint16))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    {
+        uint16 find_tag = 0, find_ref = 0;
+        int32  find_off, find_len;
+
+        while (nelts < max_elts && Hfind(file_id, DFTAG_WILDCARD, DFREF_WILDCARD, &find_tag, &find_ref,
+                                         &find_off, &find_len, DF_FORWARD) != FAIL)
+            if (SPECIALTAG(find_tag)) {
+                tags[nelts] = BASETAG(find_tag);
+                refs[nelts] = find_ref;
+                nelts++;
+            }
+    }
+    HEclear(); /* Hfind reports the end of the DDs */
+
+    /* compact the linked block ones */
+    for (i = 0; i < nelts; i++) {
+        atom_t ddid;
+        uint8 *drec = NULL;
+        int16  special_code;
+
+        if ((ddid = HTPselect(file_rec, tags[i], refs[i])) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        if (HPread_drec(file_id, ddid, &drec) < 2) {
+            free(drec);
+            HTPendaccess(ddid);
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        }
+        {
+            uint8 *p = drec;
+
+            INT16DECODE(p, special_code);
+        }
+        free(drec);
+        if (HTPendaccess(ddid) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+        if (special_code == SPECIAL_LINKED && HLIcompact(file_rec, file_id, tags[i], refs[i]) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    }
+
+done:
+    HL_UNLOCK_FILE(locked);
+    free(tags);
+    free(refs);
+
+    return ret_value;
+} /* HLcompact */
+
 /* ---------------------------- HDinqblockinfo ---------------------------- */
 /*
 NAME
@@ -632,6 +869,7 @@ HLIstaccess(accrec_t *access_rec, int16 acc_mode)
                     free(t_link);
                 }
             }
+            free(t_info->link_index);
             free(t_info);
             access_rec->special_info = NULL;
         }
@@ -675,6 +913,9 @@ HLIstaccess(accrec_t *access_rec, int16 acc_mode)
         INT32DECODE(p, info->number_blocks);
         UINT16DECODE(p, info->link_ref);
     }
+    info->link_index = NULL;
+    info->nindexed   = 0;
+    info->index_size = 0;
 
     /* get the block length and number of blocks */
     access_rec->block_size = info->block_length;
@@ -806,7 +1047,9 @@ HLgetdatainfo(int32 file_id, uint8 *buf, /* IN: special header info */
 
         /* Get offset/length of blocks that actually point to a data elem,
            until all blocks in this table with valid ref#s are processed */
-        for (ii = 0; ii < num_blocks && link_info->block_list[ii].ref != 0; ii++) {
+        for (ii = 0; ii < num_blocks && link_info->block_list[ii].ref != 0 &&
+                     (info_count == 0 || num_data_blocks < info_count);
+             ii++) {
             int32  offset, length;
             uint16 block_ref = link_info->block_list[ii].ref; /* shortcut */
 
@@ -1010,6 +1253,63 @@ done:
     return ret_value;
 } /* HLIgetlink */
 
+/* ------------------------------ HLIlinkat ------------------------------- */
+/*
+NAME
+   HLIlinkat -- find a block table by its position in the chain
+USAGE
+   link_t * HLIlinkat(info, nth)
+   linkinfo_t *info;           IN: information on the linked block element
+   int32      *nth;            IN/OUT: position of the block table, 0 based
+RETURNS
+   A pointer to the block table or NULL.
+DESCRIPTION
+   Return the block table at position *nth of the chain.  When the chain
+   is shorter, return its last block table and set *nth to its position.
+
+   The block tables found are kept in order in info->link_index, so that
+   finding the table of a block far into a long element does not walk the
+   whole chain each time.  The index is extended from the chain when
+   needed; since new block tables are only added at the end of the chain
+   the part already indexed stays valid.
+
+---------------------------------------------------------------------------*/
+static link_t *
+HLIlinkat(linkinfo_t *info, int32 *nth)
+{
+    link_t *t_link;
+    link_t *ret_value = NULL; /* FAIL */
+
+    if (*nth < 0 || info->link == NULL)
+        HGOTO_ERROR(DFE_ARGS, NULL);
+
+    /* extend the index from the last block table in it */
+    if (*nth >= info->nindexed) {
+        t_link = (info->nindexed > 0) ? info->link_index[info->nindexed - 1]->next : info->link;
+        while (t_link != NULL && info->nindexed <= *nth) {
+            if (info->nindexed == info->index_size) {
+                int32    new_size = (info->index_size > 0) ? 2 * info->index_size : 16;
+                link_t **new_index;
+
+                new_index = (link_t **)realloc(info->link_index, (size_t)new_size * sizeof(link_t *));
+                if (new_index == NULL)
+                    HGOTO_ERROR(DFE_NOSPACE, NULL);
+                info->link_index = new_index;
+                info->index_size = new_size;
+            }
+            info->link_index[info->nindexed++] = t_link;
+            t_link                             = t_link->next;
+        }
+    }
+
+    if (*nth >= info->nindexed)
+        *nth = info->nindexed - 1;
+    ret_value = info->link_index[*nth];
+
+done:
+    return ret_value;
+} /* HLIlinkat */
+
 /* ------------------------------- HLPseek -------------------------------- */
 /*
 NAME
@@ -1068,6 +1368,10 @@ DESCRIPTION
    If length would take us off the end of the element only
    read what has been written.
 
+   The blocks are read straight from the file with HPread_batch(),
+   HL_READ_BATCH blocks at a time, so that blocks which follow each
+   other in the file are read together.
+
 --------------------------------------------------------------------------- */
 int32
 HLPread(accrec_t *access_rec, int32 length, void *datap)
@@ -1075,16 +1379,24 @@ HLPread(accrec_t *access_rec, int32 length, void *datap)
     uint8 *data = (uint8 *)datap;
     /* information record for this special data elt */
     linkinfo_t *info   = (linkinfo_t *)(access_rec->special_info);
-    link_t     *t_link = info->link; /* block table record */
+    link_t     *t_link = NULL; /* block table record */
+    filerec_t  *file_rec;      /* file record */
 
     /* relative position in linked block of data elt */
     int32 relative_posn = access_rec->posn;
 
-    int32 block_idx;      /* block table index of current block */
-    int32 current_length; /* length of current block */
-    int32 nbytes     = 0; /* # bytes read on any single Hread() */
-    int32 bytes_read = 0; /* total # bytes read for this call of HLIread */
-    int32 ret_value  = SUCCEED;
+    int32       block_idx;             /* block table index of current block */
+    int32       link_idx;              /* position of the block table in the chain */
+    int32       current_length;        /* length of current block */
+    hfile_ext_t exts[HL_READ_BATCH];   /* blocks queued for the next batched read */
+    int32       n_ext      = 0;        /* # of blocks in 'exts' */
+    int32       nbytes     = 0;        /* # bytes read on any single Hread() */
+    int32       bytes_read = 0;        /* total # bytes read for this call of HLIread */
+    int32       ret_value  = SUCCEED;
+
+    file_rec = HAatom_object(access_rec->file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
     /* validate length */
     if (length == 0)
@@ -1109,14 +1421,12 @@ HLPread(accrec_t *access_rec, int32 length, void *datap)
     }
 
     /* calculate which block to start from? */
+    link_idx = block_idx / info->number_blocks;
     {
-        int32 i;
+        int32 nth = link_idx;
 
-        for (i = 0; i < block_idx / info->number_blocks; i++) {
-            if (t_link == NULL)
-                HGOTO_ERROR(DFE_INTERNAL, FAIL);
-            t_link = t_link->next;
-        }
+        if ((t_link = HLIlinkat(info, &nth)) == NULL || nth != link_idx)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
     }
     block_idx %= info->number_blocks;
 
@@ -1129,31 +1439,63 @@ HLPread(accrec_t *access_rec, int32 length, void *datap)
         if (remaining > length)
             remaining = length;
         if (t_link->block_list[block_idx].ref != 0) {
-            int32    access_id;      /* access record id for this block */
             block_t *current_block = /* record on the current block */
                 &(t_link->block_list[block_idx]);
+            atom_t data_id;     /* DD of the block */
+            int32  data_off;    /* offset of the block in the file */
+            int32  data_len;    /* length of the block in the file */
+            intn   queued = FALSE;
+
+            /* queue the block when all of the piece wanted is in the file */
+            if ((data_id = HTPselect(file_rec, DFTAG_LINKED, current_block->ref)) != FAIL) {
+                if (HTPinquire(data_id, NULL, NULL, &data_off, &data_len) != FAIL &&
+                    data_off != INVALID_OFFSET && data_len >= relative_posn + remaining) {
+                    exts[n_ext].offset = data_off + relative_posn;
+                    exts[n_ext].length = remaining;
+                    exts[n_ext].buf    = data;
+                    n_ext++;
+                    queued = TRUE;
+                }
+                if (HTPendaccess(data_id) == FAIL)
+                    HGOTO_ERROR(DFE_INTERNAL, FAIL);
+            }
 
-            access_id = Hstartread(access_rec->file_id, DFTAG_LINKED, current_block->ref);
-            if (access_id == (int32)FAIL ||
-                (relative_posn && (int32)FAIL == Hseek(access_id, relative_posn, DF_START)) ||
-                (int32)FAIL == (nbytes = Hread(access_id, remaining, data)))
-                HGOTO_ERROR(DFE_READERROR, FAIL);
+            if (queued)
+                bytes_read += remaining;
+            else {
+                int32 access_id; /* access record id for this block */
 
-            bytes_read += nbytes;
-            Hendaccess(access_id);
+                access_id = Hstartread(access_rec->file_id, DFTAG_LINKED, current_block->ref);
+                if (access_id == (int32)FAIL ||
+                    (relative_posn && (int32)FAIL == Hseek(access_id, relative_posn, DF_START)) ||
+                    (int32)FAIL == (nbytes = Hread(access_id, remaining, data)))
+                    HGOTO_ERROR(DFE_READERROR, FAIL);
+
+                bytes_read += nbytes;
+                Hendaccess(access_id);
+            }
         }
         else { /*if block is missing, fill this part of buffer with zero's */
             memset(data, 0, (size_t)remaining);
-            bytes_read += nbytes;
+            bytes_read += remaining;
         }
 
         /* move variables for the next block */
         data += remaining;
         length -= remaining;
+
+        /* read the queued blocks when the queue is full or at the end */
+        if (n_ext == HL_READ_BATCH || (length == 0 && n_ext > 0)) {
+            if (HPread_batch(file_rec, n_ext, exts) == FAIL)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+            n_ext = 0;
+        }
+
         if (length > 0 && ++block_idx >= info->number_blocks) {
+            int32 nth = ++link_idx;
+
             block_idx = 0;
-            t_link    = t_link->next;
-            if (t_link == NULL)
+            if ((t_link = HLIlinkat(info, &nth)) == NULL || nth != link_idx)
                 HGOTO_ERROR(DFE_INTERNAL, FAIL);
         }
         relative_posn  = 0;
@@ -1233,8 +1575,22 @@ HLPwrite(accrec_t *access_rec, int32 length, const void *datap)
         /* follow the links of block tables and create missing
            block tables along the way */
         int32 num_links; /* number of links to follow */
+        int32 nth;       /* position of the furthest link already there */
+        int32 prev_nth;  /* position of the link before it */
+
+        /* jump to the furthest existing link on the way */
+        num_links = block_idx / info->number_blocks;
+        if (num_links > 0) {
+            nth = num_links;
+            if ((t_link = HLIlinkat(info, &nth)) == NULL)
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+            prev_nth = nth - 1;
+            if (nth > 0 && (prev_link = HLIlinkat(info, &prev_nth)) == NULL)
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+            num_links -= nth;
+        }
 
-        for (num_links = block_idx / info->number_blocks; num_links > 0; num_links--) {
+        for (; num_links > 0; num_links--) {
             if (!t_link->next) { /* create missing link (block table) */
                 t_link->nextref = Htagnewref(access_rec->file_id, DFTAG_LINKED);
                 t_link->next    = HLInewlink(access_rec->file_id, info->number_blocks, t_link->nextref, 0);
@@ -1634,6 +1990,7 @@ HLPcloseAID(accrec_t *access_rec)
             free(t_link);
         }
 
+        free(info->link_index);
         free(info);
         access_rec->special_info = NULL;
     }
@@ -18,6 +18,12 @@
    elements are held in memory while they are being accessed and are only
    written back to the file if they are modified.
 
+   A file can also buffer its small elements on its own, see HBsetpolicy():
+   a plain element opened for reading often enough is read once and its
+   bytes kept with the file record, until the element changes or the file
+   is released.  The access records opened on it later stay plain ones,
+   which Hread() serves from these bytes through HBPread().
+
    File Organization
   ******************
     These special elements are invoked at run-time only, information about
@@ -26,12 +32,16 @@
     the library, these routines aren't called.
 
  LOCAL ROUTINES
+   HBIcompare       -- compare the tag/refs of two counted elements
+   HBIrelease       -- detach from the special information of an element
 
  EXPORTED BUT LIBRARY PRIVATE ROUTINES
    HBPcloseAID      -- close file but keep AID active
    HBPendacess      -- close file, free AID
+   HBPforget        -- drop the bytes buffered by a file for an element
    HBPinfo          -- return info about an buffered element
    HBPinquire       -- retrieve information about an buffered element
+   HBPpromote       -- buffer an element a file reads repeatedly
    HBPread          -- read some data out of an buffered element
    HBPreset         -- replace the current buffered info with new info (NOP)
    HBPseek          -- set the seek position
@@ -42,6 +52,7 @@
 
 EXPORTED ROUTINES
    HBconvert        -- start buffering an AID
+   HBsetpolicy      -- buffer the small elements a file reads repeatedly
 
 ------------------------------------------------------------------------- */
 
@@ -59,8 +70,23 @@ typedef struct {
     uint8    *buf;            /* pointer to the buffered data */
     int32     buf_aid;        /* AID for buffered access record (below) */
     accrec_t *buf_access_rec; /* "Real" access record for buffered data */
+    intn      shared;         /* held by the file for plain AIDs, see
+                                 HBPpromote(), without buf_aid */
 } bufinfo_t;
 
+/* hbelem_t -- an element counted for buffering, see HBsetpolicy() */
+typedef struct {
+    uint32     key;  /* tag and ref of the element */
+    intn       uses; /* # of times it was opened for reading */
+    bufinfo_t *info; /* its bytes once buffered, NULL before */
+} hbelem_t;
+
+#define HB_KEY(t, r) (((uint32)(t) << 16) | (uint32)(r))
+
+static intn HBIcompare(void *k1, void *k2, intn cmparg);
+
+static int32 HBIrelease(bufinfo_t *info);
+
 /* forward declaration of the functions provided in this module */
 
 /* buf_funcs -- table of the accessing functions of the buffered
@@ -139,6 +165,7 @@ HBconvert(int32 aid)
     info->attached = 1;
     info->modified = 0;        /* Data starts out not modified */
     info->length   = data_len; /* initial buffer size */
+    info->shared   = FALSE;
 
     /* Get space for buffer */
     if (data_len > 0) {
@@ -500,12 +527,35 @@ DESCRIPTION
 int32
 HBPcloseAID(accrec_t *access_rec)
 {
-    bufinfo_t *info = /* special information record */
-        (bufinfo_t *)access_rec->special_info;
     int32 ret_value = SUCCEED;
 
     /* detach the special information record.
        If no more references to that, free the record */
+    if ((ret_value = HBIrelease((bufinfo_t *)access_rec->special_info)) != FAIL)
+        access_rec->special_info = NULL;
+
+    return ret_value;
+} /* HBPcloseAID */
+
+/* ------------------------------ HBIrelease ------------------------------ */
+/*
+NAME
+   HBIrelease -- detach from the special information of an element
+USAGE
+   int32 HBIrelease(info)
+       bufinfo_t * info;           IN:  special information to detach from
+RETURNS
+   SUCCEED / FAIL
+DESCRIPTION
+   Drop one reference to the special information of a buffered element.
+   The last one flushes the buffered data (if modified), closes the
+   dependent access record and frees the information.
+
+---------------------------------------------------------------------------*/
+static int32
+HBIrelease(bufinfo_t *info)
+{
+    int32 ret_value = SUCCEED;
 
     if (--(info->attached) == 0) {
         /* Flush the data if it's been modified */
@@ -518,15 +568,15 @@ HBPcloseAID(accrec_t *access_rec)
         free(info->buf);
 
         /* Close the dependent access record */
-        Hendaccess(info->buf_aid);
+        if (!info->shared)
+            Hendaccess(info->buf_aid);
 
         free(info);
-        access_rec->special_info = NULL;
     }
 
 done:
     return ret_value;
-} /* HBPcloseAID */
+} /* HBIrelease */
 
 /* ------------------------------- HBPinfo -------------------------------- */
 /*
@@ -562,3 +612,214 @@ HBPinfo(accrec_t *access_rec, sp_info_block_t *info_block)
 done:
     return ret_value;
 } /* HBPinfo */
+
+/*------------------------------------------------------------------------
+NAME
+   HBsetpolicy -- buffer the small elements a file reads repeatedly
+USAGE
+   intn HBsetpolicy(file_id, max_len, min_uses)
+       int32  file_id;      IN: id of the file
+       int32  max_len;      IN: length up to which elements are buffered, 0 for none
+       intn   min_uses;     IN: # of read accesses from which they are
+RETURNS
+   SUCCEED/FAIL
+DESCRIPTION
+   Buffers the plain elements of the file at most max_len bytes long
+   without HBconvert() being called: from the min_uses'th time such an
+   element is opened for reading, e.g. with Hstartread(), it is read
+   once and every access record opened for reading on it afterwards
+   reads from memory.  Dimension scales, attributes, chunk tables and
+   the other small vdatas looked up again and again are then read from
+   the file once.  The bytes are kept until the element is written,
+   moved or deleted, or the file is released, which with HPkeep_open()
+   can be after several opens.  An access record opened before the
+   element is written keeps reading what it read from the buffer.
+   A max_len of 0 turns the buffering off and frees what was held.
+
+FORTRAN
+   None
+
+--------------------------------------------------------------------------*/
+intn
+HBsetpolicy(int32 file_id, int32 max_len, intn min_uses)
+{
+    filerec_t *file_rec; /* file record */
+    filerec_t *locked    = NULL;
+    intn       ret_value = SUCCEED;
+
+    HEclear();
+
+    if (max_len < 0 || min_uses < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* check validity of file record */
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    locked = HL_LOCK_FILE(file_rec);
+
+    if (max_len == 0)
+        HBPforget(file_rec, DFTAG_WILDCARD, DFREF_WILDCARD);
+    file_rec->hb_max_len  = max_len;
+    file_rec->hb_min_uses = MAX(min_uses, 1);
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* HBsetpolicy */
+
+/* ------------------------------ HBIcompare ------------------------------ */
+/*
+NAME
+   HBIcompare -- compare the tag/refs of two counted elements
+USAGE
+   intn HBIcompare(k1, k2, cmparg)
+       void * k1, * k2;            IN: keys of the hbelem_t's to compare
+       intn   cmparg;              IN: unused
+RETURNS
+   <0, 0 or >0 as k1 is before, the same as or after k2
+DESCRIPTION
+   Orders the tree of the elements counted by HBPpromote().
+
+---------------------------------------------------------------------------*/
+static intn
+HBIcompare(void *k1, void *k2, intn cmparg)
+{
+    uint32 key1 = *(uint32 *)k1;
+    uint32 key2 = *(uint32 *)k2;
+
+    (void)cmparg;
+
+    return (key1 < key2) ? -1 : (key1 > key2);
+} /* HBIcompare */
+
+/* ------------------------------ HBPpromote ------------------------------ */
+/*
+NAME
+   HBPpromote -- buffer an element a file reads repeatedly
+USAGE
+   intn HBPpromote(file_rec, access_rec, tag, ref, offset, length)
+       filerec_t * file_rec;       IN: file of the element
+       accrec_t *  access_rec;     IN: access record just opened for reading
+       uint16      tag, ref;       IN: the plain element it is on
+       int32       offset, length; IN: where its data is in the file
+RETURNS
+   SUCCEED / FAIL
+DESCRIPTION
+   Called by Hstartaccess() for the plain elements opened for reading
+   that are short enough for the policy of the file, see HBsetpolicy().
+   Counts the access and, from the one the policy asks for, attaches the
+   bytes the file holds for the element, read here the first time, to
+   the access record as its special information.  The access record
+   stays a plain one for the callers looking at it, while Hread() reads
+   from these bytes and Hendaccess() detaches it with HBPcloseAID().
+   It is left alone on failure.
+
+---------------------------------------------------------------------------*/
+intn
+HBPpromote(filerec_t *file_rec, accrec_t *access_rec, uint16 tag, uint16 ref, int32 offset, int32 length)
+{
+    TBBT_NODE *node;             /* node of the element in the tree */
+    hbelem_t  *elem      = NULL; /* the element counted */
+    bufinfo_t *info      = NULL; /* information for the buffered element */
+    uint32     key       = HB_KEY(tag, ref);
+    intn       ret_value = SUCCEED;
+
+    if (file_rec->hb_elems == NULL &&
+        (file_rec->hb_elems = tbbtdmake(HBIcompare, (intn)sizeof(uint32), 0)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    if ((node = tbbtdfind(file_rec->hb_elems, &key, NULL)) != NULL)
+        elem = (hbelem_t *)node->data;
+    else {
+        if ((elem = (hbelem_t *)calloc(1, sizeof(hbelem_t))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        elem->key = key;
+        if (tbbtdins(file_rec->hb_elems, elem, &elem->key) == NULL) {
+            free(elem);
+            HGOTO_ERROR(DFE_TBBTINS, FAIL);
+        } /* end if */
+    }     /* end else */
+
+    /* read the element the first time it is used often enough */
+    if (elem->info == NULL) {
+        if (++elem->uses < file_rec->hb_min_uses)
+            HGOTO_DONE(SUCCEED);
+
+        if ((info = (bufinfo_t *)malloc(sizeof(bufinfo_t))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if ((info->buf = (uint8 *)malloc((size_t)length)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if (HPread_at(file_rec, offset, info->buf, length) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+
+        info->attached       = 1; /* the file's reference */
+        info->modified       = 0;
+        info->length         = length;
+        info->buf_aid        = FAIL;
+        info->buf_access_rec = NULL;
+        info->shared         = TRUE;
+        elem->info           = info;
+        info                 = NULL;
+    } /* end if */
+
+    /* Share the bytes with the access record */
+    elem->info->attached++;
+    access_rec->special_info = (void *)elem->info;
+
+done:
+    if (ret_value == FAIL) { /* Error condition cleanup */
+        if (info != NULL) {
+            free(info->buf);
+            free(info);
+        } /* end if */
+    }     /* end if */
+
+    return ret_value;
+} /* HBPpromote */
+
+/* ------------------------------ HBPforget ------------------------------- */
+/*
+NAME
+   HBPforget -- drop the bytes buffered by a file for an element
+USAGE
+   void HBPforget(file_rec, tag, ref)
+       filerec_t * file_rec;       IN: file of the element
+       uint16      tag, ref;       IN: the element, DFTAG_WILDCARD for all
+RETURNS
+   None
+DESCRIPTION
+   Called when an element is about to change, so that the next access
+   record opened on it reads it again; those still open keep the bytes
+   they were reading.  With DFTAG_WILDCARD, everything counted for the
+   file is freed, as when it is released.
+
+---------------------------------------------------------------------------*/
+void
+HBPforget(filerec_t *file_rec, uint16 tag, uint16 ref)
+{
+    TBBT_NODE *node; /* node of the element in the tree */
+    hbelem_t  *elem; /* the element counted */
+    uint32     key = HB_KEY(tag, ref);
+
+    if (file_rec->hb_elems == NULL)
+        return;
+
+    if (tag == DFTAG_WILDCARD) {
+        while ((node = tbbtfirst((TBBT_NODE *)*(file_rec->hb_elems))) != NULL) {
+            elem = (hbelem_t *)tbbtrem((TBBT_NODE **)file_rec->hb_elems, node, NULL);
+            if (elem->info != NULL)
+                HBIrelease(elem->info);
+            free(elem);
+        } /* end while */
+        tbbtdfree(file_rec->hb_elems, NULL, NULL);
+        file_rec->hb_elems = NULL;
+    } /* end if */
+    else if ((node = tbbtdfind(file_rec->hb_elems, &key, NULL)) != NULL) {
+        elem = (hbelem_t *)node->data;
+        if (elem->info != NULL) {
+            HBIrelease(elem->info);
+            elem->info = NULL;
+        } /* end if */
+    }     /* end if */
+} /* HBPforget */
@@ -198,7 +198,22 @@ EXPORTED ROUTINES
    HMCcreate       -- create a chunked element
    HMCwriteChunk   -- write out the specified chunk to a chunked element
    HMCreadChunk    -- read the specified chunk from a chunked element
+   HMCwriteChunkRaw -- write the stored data of a chunk to a chunked element
+   HMCreadChunkRaw -- read the stored data of a chunk from a chunked element
+   HMCreadSlab     -- read a hyperslab of a chunked element
    HMCsetMaxcache  -- maximum number of chunks to cache
+   HMCsetThreads   -- number of threads used to code compressed chunks
+   HMCgetCacheStats -- hit, miss and eviction counts of the chunk cache
+   HMCsetReadahead -- turn readahead of sequential reads on or off
+   HMCsetSparse    -- leave chunks of only fill values unwritten
+   HMCsetDedup     -- share the data of chunks identical to one written before
+   HMCsetRawLimit  -- store chunks that do not compress well as they are
+   HMCsetCoderPolicy -- choose the coder of each new chunk by a trial
+   HMCsetCacheBudget -- byte budget of the shared chunk cache pool
+   HMCsetDiskCache -- keep the compressed chunks of remote files on local disk
+   HMCsetStats     -- keep statistics of the chunks written
+   HMCgetChunkStats -- get the statistics of a chunk
+   HMCqueryChunks  -- find the chunks that may hold values in a range
    HMCPcloseAID    -- close file but keep AID active (For Hnextread())
 
    Library Private
@@ -227,6 +242,7 @@ LOCAL ROUTINES
    ------------------------
    create_dim_recs           -- create the appropriate arrays in memory
    update_chunk_indices_seek -- translate seek pos to chunk and pos in chunk
+   advance_chunk_indices_seek -- move chunk and pos in chunk past a run
    compute_chunk_to_seek     -- translate chunk coordinates to seek position
    update_chunk_indices      -- not used
    compute_array_to_chunk    -- not used
@@ -241,6 +257,27 @@ LOCAL ROUTINES
    Common Routine
    -------------
    HMCIstaccess -- set up AID to access a chunked element
+   HMCIpredecode -- decode compressed chunks of a read on worker threads
+   HMCIreadahead -- bring the chunks of the next read into the chunk cache
+   HMCIwrite_chunk -- write out a single chunk to the file
+   HMCIqueue_pending -- add a new compressed chunk to the write-behind queue
+   HMCIflush_pending -- encode the write-behind queue on worker threads and write it
+   HMCIunwritten -- tell whether a chunk has never been written
+   HMCIall_fill -- tell whether a chunk holds only fill values
+   HMCIdedup_chunk -- share the data of a chunk identical to one written before
+   HMCIstored_plain -- tell whether a chunk of a compressed element is stored as it is
+   HMCIencode_chunk -- compress a chunk in memory, unless it does not pay
+   HMCIpick_coder -- choose the coder of a new chunk by a trial on a sample
+   HMCIread_stored -- read the data of a chunk as stored in the file
+   HMCIchunk_stats -- compute the statistics of a chunk
+   HMCIload_stats -- read in the statistics of the chunks
+   HMCIflush_stats -- write out the statistics of the chunks
+   HMCIcrc32c -- CRC-32C of a buffer
+   HMCIchunk_sums -- set the checksums of a chunk being written
+   HMCIload_sums -- read in the checksums of the chunks
+   HMCIfill_stored -- set the checksums of the stored data of the chunks
+   HMCIflush_sums -- write out the checksums of the chunks
+   HMCIdisk_get, HMCIdisk_put, HMCIdisk_trim -- manage the local chunk cache
 
    AUTHOR
    -------
@@ -261,6 +298,25 @@ LOCAL ROUTINES
 #include "tbbt.h"   /* TBBT stuff */
 #include "mcache.h" /* caching routines */
 #include "hcomp.h"  /* For Compression */
+#include "hcompi.h" /* For the zlib and LZ4 interfaces used on worker threads */
+#include "htpool.h" /* worker threads */
+
+/* CRC-32C instructions for the checksums of the chunks, see HMCIcrc32c() */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HMC_CRC32C_X86
+#include <immintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#define HMC_CRC32C_ARM
+#include <arm_acle.h>
+#include <stdint.h>
+#endif
+
+/* The local chunk cache lists its directory, see HMCsetDiskCache() */
+#ifndef H4_HAVE_WIN32_API
+#define HMC_DISK_CACHE
+#include <dirent.h>
+#include <utime.h>
+#endif /* H4_HAVE_WIN32_API */
 
 /* Define class, class version and name(partial) for chunk table i.e. Vdata */
 #define _HDF_CHK_TBL_NAME "_HDF_CHK_TBL_" /* 13 bytes */
@@ -271,9 +327,65 @@ LOCAL ROUTINES
 #define _HDF_CHK_FIELD_3     "chk_ref"                /* 7 bytes */
 #define _HDF_CHK_FIELD_NAMES "origin,chk_tag,chk_ref" /* 22 bytes */
 
+/* Define name(partial), field names and number type attribute of the
+   statistics of the chunks i.e. Vdata, see HMCsetStats() */
+#define _HDF_CHK_STATS_NAME   "_HDF_CHK_STATS_" /* 15 bytes */
+#define _HDF_CHK_STATS_FIELDS "min,max,count"
+#define _HDF_CHK_STATS_NT     "number_type"
+
+/* Size of a record of the statistics Vdata */
+#define _HDF_CHK_STATS_REC (2 * sizeof(float64) + sizeof(int32))
+
+/* Number of values converted at once by HMCIchunk_stats() */
+#define _HDF_CHK_STATS_BATCH 512
+
+/* Define name(partial) and field names of the checksums of the chunks
+   i.e. Vdata, see HMCsetChecksums() */
+#define _HDF_CHK_SUMS_NAME   "_HDF_CHK_SUMS_" /* 14 bytes */
+#define _HDF_CHK_SUMS_FIELDS "raw,stored,known"
+
+/* Size of a record of the checksums Vdata */
+#define _HDF_CHK_SUMS_REC (2 * sizeof(uint32) + sizeof(int32))
+
 /* Define version number for chunked header format */
 #define _HDF_CHK_HDR_VER 0 /* zero version for format header */
 
+/* Number of chunks decoded ahead per decoding thread, see HMCIpredecode() */
+#define _HDF_CHK_PREDECODE_PER_THREAD 2
+
+/* Least number of chunks handed to a decode provider at once, see
+   HCset_decode_provider() */
+#define _HDF_CHK_PROVIDER_BATCH 16
+
+/* Number of chunks queued for write-behind per encoding thread,
+   see HMCIqueue_pending() */
+#define _HDF_CHK_PENDING_PER_THREAD 4
+
+/* Number of bytes of a chunk compressed first, to find out whether
+   compressing the rest pays, see HMCIencode_chunk() */
+#define _HDF_CHK_RAW_SAMPLE 4096
+
+/* Most coders tried on a sample of a new chunk, see HMCIpick_coder() */
+#define _HDF_CHK_MAX_CANDIDATES 3
+
+/* Number of chunk table records read at once by HMCIstaccess() */
+#define _HDF_CHK_INDEX_BATCH 4096
+
+/* Number of new chunk table records written at once, see HMCIflush_table() */
+#define _HDF_CHK_TABLE_BATCH 4096
+
+/* Number of chunk records in a page of 'chk_pages', and the most pages
+   i.e. the chunk numbers past which the records are kept in the TBBT */
+#define _HDF_CHK_PAGE_RECS 512
+#define _HDF_CHK_MAX_PAGES 65536
+
+/* Files of the local chunk cache: their suffix and header, i.e. the magic
+   number, the length of the chunk and the length of the name of the file
+   it came from, followed by that name and the chunk */
+#define _HDF_CHK_DISK_SUFFIX ".h4chk"
+#define _HDF_CHK_DISK_MAGIC  "H4CK"
+#define _HDF_CHK_DISK_HDR    10
+
 /* Structure for each Data array dimension */
 typedef struct dim_rec_struct {
     /* fields stored in chunked header */
@@ -293,17 +405,92 @@ typedef struct dim_rec_struct {
     int32 num_chunks;        /* i.e. "dim_length / chunk_length" */
 } DIM_REC, *DIM_REC_PTR;
 
-/* Structure for each Chunk */
+/* Structure for each Chunk, the origin of the chunk is computed from its
+   number when its record is added to the chunk table */
 typedef struct chunk_rec_struct {
     int32 chunk_number; /* chunk number from coordinates i.e. origin */
-    int32 chk_vnum;     /* chunk vdata record number i.e. position in table*/
 
     /* chunk record fields stored in Vdata Table */
-    int32 *origin;  /* origin -> position of chunk */
-    uint16 chk_tag; /* DFTAG_CHUNK or another Chunked element? */
+    uint16 chk_tag; /* DFTAG_CHUNK or another Chunked element?
+                       0 for an unused entry of a page of records */
     uint16 chk_ref; /* reference number of this chunk */
 } CHUNK_REC, *CHUNK_REC_PTR;
 
+/* Chunk table record as read in by HMCIstaccess(), kept sorted by chunk
+   number; a CHUNK_REC is only made for it when the chunk is accessed,
+   see HMCIfind_chunk() */
+typedef struct chunk_index_t {
+    int32  chunk_number; /* chunk number from coordinates i.e. origin */
+    int32  chk_vnum;     /* chunk vdata record number i.e. position in table*/
+    uint16 chk_tag;      /* DFTAG_CHUNK or another Chunked element? */
+    uint16 chk_ref;      /* reference number of this chunk */
+} chunk_index_t;
+
+/* Coder a new chunk is compressed with in memory, see HMCsetCoderPolicy() */
+typedef struct chunk_coder_t {
+    comp_coder_t coder; /* COMP_CODE_DEFLATE or COMP_CODE_LZ4 */
+    comp_info    cinfo; /* its level or acceleration */
+} chunk_coder_t;
+
+/* Chunk held in memory while it is decoded ahead of a read by
+   HMCIpredecode() or waits in the write-behind queue for HMCIflush_pending() */
+typedef struct chunk_coded_t {
+    int32         chunk_num; /* chunk number */
+    uint8        *raw;       /* compressed chunk as stored in the file */
+    int32         raw_len;   /* length of 'raw' */
+    uint8        *data;      /* decoded chunk */
+    int32         data_len;  /* length of 'data' i.e. chunk_size * nt_size */
+    intn          status;    /* SUCCEED once the chunk was decoded/encoded */
+    intn          plain;     /* TRUE when it is to be stored as it is, see HMCsetRawLimit() */
+    chunk_coder_t coder;     /* coder it was compressed with, see HMCsetCoderPolicy() */
+    int32         disk_off;  /* offset of its first block, to keep it in the local
+                                chunk cache once read, -1 if not */
+} chunk_coded_t;
+
+/* File of the local chunk cache, see HMCIdisk_trim() */
+typedef struct chunk_disk_t {
+    time_t mtime;  /* last use of the chunk */
+    int32  kbytes; /* size of the file, in KB rounded up */
+    char  *name;   /* path of the file */
+} chunk_disk_t;
+
+/* Statistics of the values of a chunk, the fill value and NaNs left out */
+typedef struct chunk_stats_t {
+    float64 min;   /* least value */
+    float64 max;   /* greatest value */
+    int32   count; /* number of values, 0 for a chunk of only fill values,
+                      -1 when not known */
+} chunk_stats_t;
+
+/* CRC-32C checksums of a chunk */
+typedef struct chunk_sums_t {
+    uint32 raw;    /* of its data decoded */
+    uint32 stored; /* of its data as stored in the file */
+    int32  known;  /* HDF_CHKSUM_RAW and HDF_CHKSUM_STORED or'ed for those known */
+} chunk_sums_t;
+
+/* Chunk written since the element was opened, see HMCIdedup_chunk() */
+typedef struct chunk_hash_t {
+    uint32 crc;       /* CRC-32 of its data */
+    int32  len;       /* length of its data */
+    int32  chunk_num; /* chunk number, -1 for an empty slot */
+    intn   stored;    /* TRUE if the CRC is of the data as stored in the file,
+                         FALSE if of the decoded data */
+} chunk_hash_t;
+
+/* Written chunk with the file offset of its data, sorted by HMCIsort_chunks() */
+typedef struct chunk_place_t {
+    int32 offset;    /* offset of the first block of the chunk's data */
+    int32 chunk_num; /* chunk number */
+} chunk_place_t;
+
+/* Written chunks listed by HMCIplace_chunk() for HMCnextChunk() */
+typedef struct chunk_places_t {
+    int32          file_id; /* file the chunks are in */
+    int32          nplaces; /* number of entries in 'places' */
+    chunk_place_t *places;  /* the chunks listed */
+} chunk_places_t;
+
 /* information on this special chunk data elt */
 typedef struct chunkinfo_t {
     intn  attached; /* how many access records refer to this elt */
@@ -339,10 +526,79 @@ typedef struct chunkinfo_t {
                                      to the other chunks */
     int32     *seek_pos_chunk;    /* position within the current chunk */
     int32     *seek_user_indices; /* user position within the element  */
-    TBBT_TREE *chk_tree;          /* TBBT tree of all accessed table entries
-                                     i.e. CHUNK_REC's read/written/modified */
-    MCACHE *chk_cache;            /* chunk cache */
-    int32   num_recs;             /* number of Table(Vdata) records */
+    CHUNK_REC    **chk_pages;     /* CHUNK_REC's read/written/modified, by
+                                     chunk number, see HMCInew_chunk() */
+    int32          npages;        /* number of entries in 'chk_pages' */
+    int32          nused_pages;   /* pages of 'chk_pages' allocated */
+    int32          npaged;        /* records held in those pages */
+    TBBT_TREE     *chk_tree;      /* TBBT tree of the other CHUNK_REC's, of
+                                     chunk numbers past the pages or of
+                                     sparse chunks */
+    chunk_index_t *chk_index;     /* table entries in the file, by chunk number */
+    int32          nindex;        /* number of entries in 'chk_index' */
+    MCACHE        *chk_cache;     /* chunk cache */
+    int32          num_recs;      /* number of Table(Vdata) records */
+    uint8         *tbl_recs;      /* new table records not written yet */
+    int32          ntbl_recs;     /* number of records in 'tbl_recs' */
+    int32          tbl_recs_max;  /* records 'tbl_recs' has room for */
+    int32         *order;         /* written chunks in storage order, see HMCnextChunk() */
+    int32          norder;        /* number of entries in 'order' */
+
+    /* For decoding/encoding compressed chunks on worker threads */
+    intn           nthreads;    /* number of coding threads, 1 = serial */
+    chunk_coded_t *predecoded;  /* chunks decoded ahead of the current read */
+    int32          npredecoded; /* number of entries in 'predecoded' */
+    chunk_coded_t *pending;     /* written chunks waiting to be encoded */
+    int32          npending;    /* number of entries in 'pending' */
+
+    /* For readahead of sequential reads, see HMCIreadahead() */
+    intn  readahead; /* TRUE when readahead is on */
+    int32 ra_posn;   /* element position of the last read, -1 if none */
+    int32 ra_length; /* length of the last read */
+    int32 ra_stride; /* distance between the last two reads */
+    int32 ra_streak; /* # of reads in a row at that same distance */
+
+    intn sparse;       /* TRUE to leave new chunks of only fill values unwritten */
+    intn raw_limit;    /* percent of its size a new chunk must compress to, or
+                          it is stored as it is; 0 for none, see HMCsetRawLimit() */
+    intn coder_policy; /* percent a faster coder may trail the best one by on
+                          a new chunk; -1 for none, see HMCsetCoderPolicy() */
+
+    /* Sharing of the data of identical chunks, see HMCsetDedup() */
+    intn          dedup;     /* TRUE to look for new chunks written before */
+    chunk_hash_t *dd_slots;  /* chunks written, open-addressed by CRC */
+    int32         dd_nslots; /* number of entries in 'dd_slots', a power of 2 */
+    int32         dd_nused;  /* entries of 'dd_slots' in use */
+
+    /* Statistics of the chunks written, see HMCsetStats() */
+    int32          stats_nt;     /* number type of the values, 0 if none are kept */
+    intn           stats_looked; /* TRUE once the file was searched for them */
+    intn           stats_dirty;  /* TRUE when 'stats' changed since read in */
+    uint16         stats_ref;    /* ref of their Vdata, 0 if not written yet */
+    chunk_stats_t *stats;        /* statistics by chunk number */
+    int32          nstats;       /* number of entries in 'stats' */
+    int32          stats_max;    /* entries 'stats' has room for */
+
+    /* Checksums of the chunks written, see HMCsetChecksums() */
+    intn          sums_on;     /* TRUE when checksums are kept */
+    intn          sums_looked; /* TRUE once the file was searched for them */
+    intn          sums_dirty;  /* TRUE when 'sums' changed since read in */
+    uint16        sums_ref;    /* ref of their Vdata, 0 if not written yet */
+    chunk_sums_t *sums;        /* checksums by chunk number */
+    int32         nsums;       /* number of entries in 'sums' */
+    int32         sums_max;    /* entries 'sums' has room for */
+
+    /* Total compressed length of the chunks in the file, see
+       HMCgetChunkSizes(); -1 until computed and after every write */
+    int32 comp_bytes;
+
+    /* Buffers HMCIread_coded_chunk() reuses from chunk to chunk */
+    uint8       *rd_raw;      /* compressed chunk as stored in the file */
+    int32        rd_raw_size; /* allocated length of 'rd_raw' */
+    int32       *rd_offsets;  /* file offsets of the chunk's blocks */
+    int32       *rd_lengths;  /* lengths of the chunk's blocks */
+    hfile_ext_t *rd_exts;     /* extents to read */
+    intn         rd_nblocks;  /* allocated entries of the three above */
 } chunkinfo_t;
 
 /* private functions */
@@ -375,6 +631,22 @@ static int32 HMCPchunkwrite(void       *cookie,    /* IN: access record to mess
                             int32       chunk_num, /* IN: chunk number */
                             const void *datap /* IN: buffer for data */);
 
+static intn HMCIflush_pending(accrec_t *access_rec /* IN: access record of the element */);
+static intn HMCIflush_table(chunkinfo_t *info /* IN: chunked element info */);
+static intn HMCIunwritten(chunkinfo_t *info,     /* IN: chunked element information record */
+                          int32        chunk_num /* IN: chunk to look for */);
+static intn HMCIall_fill(const chunkinfo_t *info, /* IN: chunked element information record */
+                         const void        *datap /* IN: chunk data */);
+static int32 HMCIread_stored(accrec_t  *access_rec, /* IN: access record of the element */
+                             CHUNK_REC *chk_rec,    /* IN: chunk record */
+                             void      *datap,      /* OUT: buffer for the stored data */
+                             int32      buflen /* IN: size of 'datap' */);
+static intn HMCIdedup_chunk(accrec_t   *access_rec, /* IN: access record of the element */
+                            CHUNK_REC  *chk_rec,    /* IN/OUT: record of the new chunk */
+                            const void *datap,      /* IN: data of the new chunk */
+                            int32       len,        /* IN: length of the data */
+                            intn        stored /* IN: TRUE if the data is as stored */);
+
 static int32 HMCPwrite(accrec_t   *access_rec, /* IN: access record to mess with */
                        int32       length,     /* IN: number of bytes to write */
                        const void *data /* IN: buffer for data */);
@@ -394,6 +666,13 @@ static int32 HMCPinquire(accrec_t *access_rec, /* IN:  access record to return i
                          int16    *paccess,    /* OUT: access mode; */
                          int16    *pspecial /* OUT: special code; */);
 
+/* The directory of the local chunk cache, NULL when there is none, the KB
+   it may hold and the KB it holds, -1 until counted, see HMCsetDiskCache();
+   protected by the library lock */
+static char *disk_dir  = NULL;
+static int32 disk_max  = 0;
+static int32 disk_used = -1;
+
 /* the accessing special function table for chunks */
 funclist_t chunked_funcs = {
     HMCPstread, HMCPstwrite,   HMCPseek, HMCPinquire, HMCPread,
@@ -503,6 +782,41 @@ update_chunk_indices_seek(int32    sloc,    /* IN: physical Seek loc in element
     }
 } /* update_chunk_indices_seek()*/
 
+/* -------------------------------------------------------------------------
+NAME
+    advance_chunk_indices_seek -- move chunk and pos in chunk past a run
+DESCRIPTION
+    Same as update_chunk_indices_seek() for the seek location 'sloc'
+    that ends a run of 'nbytes' bytes along the last dimension, taken
+    from the chunk and position in chunk of its start.  A run that stays
+    in the row of its chunk, or ends with it, only moves the indices of
+    the last dimension; any other run is translated from 'sloc'.
+RETURNS
+    Nothing
+---------------------------------------------------------------------------*/
+static void
+advance_chunk_indices_seek(int32    sloc,    /* IN: physical Seek loc in element after the run */
+                           int32    nbytes,  /* IN: bytes in the run */
+                           int32    ndims,   /* IN: number of dimensions of elem */
+                           int32    nt_size, /* IN: number type size */
+                           int32   *sbi,     /* IN/OUT: seek chunk indices array */
+                           int32   *spb,     /* IN/OUT: seek pos w/ chunk array */
+                           DIM_REC *ddims /* IN: dim record ptrs */)
+{
+    DIM_REC *ddim = &ddims[ndims - 1]; /* the dimension of the run */
+    int32    n    = nbytes / nt_size;   /* values in the run */
+    int32    pos  = sbi[ndims - 1] * ddim->chunk_length + spb[ndims - 1] + n;
+
+    if (pos < ddim->dim_length && spb[ndims - 1] + n < ddim->chunk_length)
+        spb[ndims - 1] += n;
+    else if (pos < ddim->dim_length && spb[ndims - 1] + n == ddim->chunk_length) {
+        sbi[ndims - 1]++;
+        spb[ndims - 1] = 0;
+    }
+    else
+        update_chunk_indices_seek(sloc, ndims, nt_size, sbi, spb, ddims);
+} /* advance_chunk_indices_seek()*/
+
 /* -------------------------------------------------------------------------
 NAME
     compute_chunk_to_array -- translate chunk arrays to user array
@@ -775,16 +1089,332 @@ AUTHOR
 static void
 chkdestroynode(void *n /* IN: chunk record */)
 {
-    CHUNK_REC *t = (CHUNK_REC *)n;
+    /* free chunk record structure */
+    free(n);
+} /* chkdestroynode */
+
+/* ----------------------------- HMCIlookup_chunk -----------------------------
+NAME
+   HMCIlookup_chunk -- find the record of a chunk in memory
+
+DESCRIPTION
+   Looks up the record of a chunk in the pages of chunk records, then
+   in the TBBT.  The chunk index is not searched, see HMCIfind_chunk().
+
+RETURNS
+   The chunk record, NULL if there is none
+--------------------------------------------------------------------------- */
+static CHUNK_REC *
+HMCIlookup_chunk(chunkinfo_t *info,     /* IN: chunked element information record */
+                 int32        chunk_num /* IN: chunk number */)
+{
+    int32      page  = chunk_num / _HDF_CHK_PAGE_RECS;
+    TBBT_NODE *entry = NULL; /* chunk node from TBBT */
 
-    if (t != NULL) {
-        /* free origin first */
-        free(t->origin);
+    if (page < info->npages && info->chk_pages[page] != NULL) {
+        CHUNK_REC *chk_rec = &info->chk_pages[page][chunk_num % _HDF_CHK_PAGE_RECS];
 
-        /* free chunk record structure */
-        free(t);
+        if (chk_rec->chk_tag != 0)
+            return chk_rec;
     }
-} /* chkdestroynode */
+
+    if ((entry = tbbtdfind(info->chk_tree, &chunk_num, NULL)) != NULL)
+        return (CHUNK_REC *)entry->data;
+
+    return NULL;
+} /* HMCIlookup_chunk() */
+
+/* ------------------------------ HMCInew_chunk ------------------------------
+NAME
+   HMCInew_chunk -- make the record of a chunk that has none
+
+DESCRIPTION
+   Makes the record of a chunk that is not in memory yet, marked as not
+   written.  The records are kept in pages of _HDF_CHK_PAGE_RECS records
+   indexed by chunk number, allocated as they are needed, so that a
+   chunk costs no allocation of its own.  A chunk goes to the TBBT
+   instead when its number is past _HDF_CHK_MAX_PAGES pages or its page
+   is not allocated and the pages allocated are mostly empty, i.e. the
+   chunks accessed are sparse.
+
+   The pages never move, a record stays where it is until the element
+   is closed, see HMCIfree_chunks().
+
+RETURNS
+   The chunk record or NULL on error
+--------------------------------------------------------------------------- */
+static CHUNK_REC *
+HMCInew_chunk(chunkinfo_t *info,     /* IN: chunked element information record */
+              int32        chunk_num /* IN: chunk number */)
+{
+    int32      page      = chunk_num / _HDF_CHK_PAGE_RECS;
+    CHUNK_REC *chkptr    = NULL; /* Chunk record to inserted in TBBT  */
+    int32     *chk_key   = NULL; /* Chunk record key for insertion in TBBT */
+    CHUNK_REC *ret_value = NULL;
+
+    /* grow the list of pages up to the page of the chunk */
+    if (page >= info->npages && page < _HDF_CHK_MAX_PAGES) {
+        int32       npages = MAX(page + 1, MIN(2 * info->npages, _HDF_CHK_MAX_PAGES));
+        CHUNK_REC **pages;
+
+        if ((pages = (CHUNK_REC **)realloc(info->chk_pages, (size_t)npages * sizeof(CHUNK_REC *))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, NULL);
+        memset(pages + info->npages, 0, (size_t)(npages - info->npages) * sizeof(CHUNK_REC *));
+        info->chk_pages = pages;
+        info->npages    = npages;
+    }
+
+    /* allocate the page of the chunk, unless the chunks are sparse */
+    if (page < info->npages && info->chk_pages[page] == NULL &&
+        (info->nused_pages < 16 || info->npaged >= info->nused_pages * (_HDF_CHK_PAGE_RECS / 16))) {
+        if ((info->chk_pages[page] = (CHUNK_REC *)calloc(_HDF_CHK_PAGE_RECS, sizeof(CHUNK_REC))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, NULL);
+        info->nused_pages++;
+    }
+
+    if (page < info->npages && info->chk_pages[page] != NULL) {
+        chkptr = &info->chk_pages[page][chunk_num % _HDF_CHK_PAGE_RECS];
+        info->npaged++;
+    }
+    else {
+        /* Allocate space for a chunk record */
+        if ((chkptr = (CHUNK_REC *)malloc(sizeof(CHUNK_REC))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, NULL);
+
+        /* allocate space for key */
+        if ((chk_key = (int32 *)malloc(sizeof(int32))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, NULL);
+        *chk_key = chunk_num;
+
+        /* add to TBBT tree based on chunk number as the key */
+        tbbtdins(info->chk_tree, chkptr, chk_key);
+    }
+
+    /* Initialize chunk record */
+    chkptr->chunk_number = chunk_num;
+    chkptr->chk_tag      = DFTAG_NULL;
+    chkptr->chk_ref      = 0;
+
+    ret_value = chkptr;
+
+done:
+    if (ret_value == NULL) { /* Error condition cleanup */
+        if (chk_key == NULL)
+            free(chkptr);
+    }
+
+    return ret_value;
+} /* HMCInew_chunk() */
+
+/* ----------------------------- HMCIfree_chunks -----------------------------
+NAME
+   HMCIfree_chunks -- free the chunk records of an element
+
+DESCRIPTION
+   Frees the pages of chunk records and the TBBT.
+
+RETURNS
+   Nothing
+--------------------------------------------------------------------------- */
+static void
+HMCIfree_chunks(chunkinfo_t *info /* IN: chunked element information record */)
+{
+    int32 i;
+
+    for (i = 0; i < info->npages; i++)
+        free(info->chk_pages[i]);
+    free(info->chk_pages);
+    info->chk_pages   = NULL;
+    info->npages      = 0;
+    info->nused_pages = 0;
+    info->npaged      = 0;
+
+    if (info->chk_tree != NULL)
+        tbbtdfree(info->chk_tree, chkdestroynode, chkfreekey);
+    info->chk_tree = NULL;
+} /* HMCIfree_chunks() */
+
+/* ---------------------------- HMCIindexcompare ----------------------------
+NAME
+   HMCIindexcompare -- orders chunk index entries by chunk number, then by
+                       position in the chunk table
+--------------------------------------------------------------------------- */
+static int
+HMCIindexcompare(const void *p1, const void *p2)
+{
+    const chunk_index_t *e1 = (const chunk_index_t *)p1;
+    const chunk_index_t *e2 = (const chunk_index_t *)p2;
+
+    if (e1->chunk_number != e2->chunk_number)
+        return (e1->chunk_number > e2->chunk_number) ? 1 : -1;
+    return (e1->chk_vnum > e2->chk_vnum) - (e1->chk_vnum < e2->chk_vnum);
+} /* HMCIindexcompare() */
+
+/* ----------------------------- HMCIread_index -----------------------------
+NAME
+   HMCIread_index -- read the chunk table into the chunk index
+
+DESCRIPTION
+   Reads the 'num_recs' records of the chunk table attached as 'info->aid'
+   in batches into 'info->chk_index', which has room for them, numbering
+   them in table order and sorting them by chunk number.
+
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+static intn
+HMCIread_index(chunkinfo_t *info, int32 num_recs, int32 vdata_size)
+{
+    uint8 *v_data = NULL; /* Vdata records */
+    int32 *origin = NULL; /* origin of a chunk */
+    int32  nrecs;         /* number of Vdata records read at once */
+    intn   sorted;        /* whether the records are in chunk order */
+    int32  i, j;
+    intn   k;
+    intn   ret_value = SUCCEED;
+
+    /* Allocate space for a batch of Vdata records */
+    nrecs = MIN(num_recs, _HDF_CHK_INDEX_BATCH);
+    if ((v_data = malloc((size_t)nrecs * (size_t)vdata_size)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if ((origin = (int32 *)malloc((size_t)info->ndims * sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    /* Read the records in batches into the chunk index; the chunk
+       records for the TBBT are only made for the chunks accessed,
+       see HMCIfind_chunk().
+       Note that chunk tag DTAG_CHUNK is not verified here.
+       It is checked in HMCPchunkread() before the chunk is read. */
+    sorted = TRUE;
+    for (j = 0; j < num_recs; j += nrecs) {
+        uint8 *pntr  = NULL;
+        int32  nread = MIN(nrecs, num_recs - j);
+
+        /* read a batch of records */
+        if (VSread(info->aid, v_data, nread, FULL_INTERLACE) != nread)
+            HGOTO_ERROR(DFE_VSREAD, FAIL);
+
+        pntr = v_data; /* set pointer to vdata record */
+        for (i = 0; i < nread; i++) {
+            chunk_index_t *idx = &info->chk_index[j + i];
+
+            /* Copy origin first */
+            for (k = 0; k < info->ndims; k++) {
+                memcpy(&origin[k], pntr, sizeof(int32));
+                pntr += sizeof(int32);
+            }
+
+            /* Copy tag next.
+               Note: Verification of tag as DTAG_CHUNK is done in
+               HMCPchunkread() before the chunk object is read.
+               In the future the tag/ref pair could point to
+               another chunk table...etc.
+               */
+            memcpy(&idx->chk_tag, pntr, sizeof(uint16));
+            pntr += sizeof(uint16);
+
+            /* Copy ref last */
+            memcpy(&idx->chk_ref, pntr, sizeof(uint16));
+            pntr += sizeof(uint16);
+
+            /* now compute chunk number from origin */
+            calculate_chunk_num(&idx->chunk_number, info->ndims, origin, info->ddims);
+
+            /* set chunk number to record number */
+            idx->chk_vnum = j + i;
+
+            if (j + i > 0 && idx->chunk_number < idx[-1].chunk_number)
+                sorted = FALSE;
+        }
+    }
+
+    /* chunks are usually written in order, so this is rarely needed */
+    if (!sorted)
+        qsort(info->chk_index, (size_t)num_recs, sizeof(chunk_index_t), HMCIindexcompare);
+
+done:
+    free(v_data);
+    free(origin);
+
+    return ret_value;
+} /* HMCIread_index() */
+
+/* ----------------------------- HMCIfind_chunk -----------------------------
+NAME
+   HMCIfind_chunk -- find the record of a chunk
+
+DESCRIPTION
+   Looks up the record of a chunk in memory, then in the chunk index
+   read in by HMCIstaccess().  A chunk found in the index is given a
+   CHUNK_REC, see HMCInew_chunk(), so that only the chunks actually
+   accessed get one.  '*chk_rec' is set to NULL if the chunk was never written.
+
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+static intn
+HMCIfind_chunk(chunkinfo_t *info,      /* IN: chunked element information record */
+               int32        chunk_num, /* IN: chunk number */
+               CHUNK_REC  **chk_rec /* OUT: chunk record, NULL if none */)
+{
+    CHUNK_REC *chkptr    = NULL; /* Chunk record made for the chunk */
+    int32      lo, hi, mid;      /* binary search bounds */
+    intn       ret_value = SUCCEED;
+
+    if ((*chk_rec = HMCIlookup_chunk(info, chunk_num)) != NULL)
+        HGOTO_DONE(SUCCEED);
+
+    /* first entry of the index with this chunk number, if any */
+    lo = 0;
+    hi = info->nindex;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (info->chk_index[mid].chunk_number < chunk_num)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == info->nindex || info->chk_index[lo].chunk_number != chunk_num)
+        HGOTO_DONE(SUCCEED); /* never written */
+
+    if ((chkptr = HMCInew_chunk(info, chunk_num)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    chkptr->chk_tag = info->chk_index[lo].chk_tag;
+    chkptr->chk_ref = info->chk_index[lo].chk_ref;
+
+    *chk_rec = chkptr;
+
+done:
+    return ret_value;
+} /* HMCIfind_chunk() */
+
+/* ----------------------------- HMCIcache_size -----------------------------
+NAME
+   HMCIcache_size -- number of chunks the cache of an element starts with
+
+DESCRIPTION
+   The cache holds the chunks along the last dimension, i.e. a row of
+   chunks, unless HDF_CONFIG_CHUNK_CACHE_BYTES is set, see Hsetconfig(),
+   in which case it holds as many chunks as fit in those bytes, at least
+   one.
+
+RETURNS
+   The number of chunks
+--------------------------------------------------------------------------- */
+static int32
+HMCIcache_size(const chunkinfo_t *info /* IN: chunked element information record */)
+{
+    int32 nbytes = HPgetconfig(HDF_CONFIG_CHUNK_CACHE_BYTES);
+    int32 nchunks;
+    intn  i;
+
+    if (nbytes > 0)
+        return MAX(1, nbytes / (info->chunk_size * info->nt_size));
+
+    for (nchunks = 1, i = 1; i < info->ndims; i++)
+        nchunks *= info->ddims[i].num_chunks;
+    return nchunks;
+} /* HMCIcache_size() */
 
 /* ----------------------------- HMCIstaccess ------------------------------
 NAME
@@ -804,7 +1434,7 @@ DESCRIPTION
    the cache are dealt with by their number i.e. translation of
    'origin' of chunk to a unique number. The default maximum number
    of chunks is the cache is set the number of chunks along the
-   last dimension.
+   last dimension, see HMCIcache_size().
 
    NOTE: The cache itself could be used to cache any object into a number
    of fixed size chunks so long as the read/write(page-in/page-out) routines know
@@ -834,9 +1464,7 @@ HMCIstaccess(accrec_t *access_rec, /* IN: access record to fill in */
     int32      interlace;         /* type of interlace */
     int32      vdata_size;        /* size of Vdata */
     int32      num_recs;          /* number of Vdatas */
-    uint8     *v_data  = NULL;    /* Vdata record */
-    CHUNK_REC *chkptr  = NULL;    /* Chunk record */
-    int32     *chk_key = NULL;    /* chunk key */
+    intn       status;            /* result of reading the chunk table */
     int32      npages  = 1;       /* number of chunks */
     int32      chunks_needed;     /* default chunk cache size  */
     int32      access_aid = FAIL; /* access id */
@@ -844,7 +1472,7 @@ HMCIstaccess(accrec_t *access_rec, /* IN: access record to fill in */
     char       name[VSNAMELENMAX + 1];   /* Vdata name */
     char class[VSNAMELENMAX + 1];        /* Vdata class */
     char v_class[VSNAMELENMAX + 1] = ""; /* Vdata class for comparison */
-    intn i, j, k;                        /* loop indices */
+    intn j;                              /* loop index */
 
     /* Check args */
     if (access_rec == NULL)
@@ -879,13 +1507,17 @@ HMCIstaccess(accrec_t *access_rec, /* IN: access record to fill in */
             /* close/free chunk cache */
             mcache_close(tmpinfo->chk_cache);
 
+            /* write out the new chunk table records */
+            HMCIflush_table(tmpinfo);
+
             /* Use Vxxx interface to free Vdata info */
             VSdetach(tmpinfo->aid);
 
-            /* free chunk tree */
-            tbbtdfree(tmpinfo->chk_tree, chkdestroynode, chkfreekey);
+            /* free chunk records */
+            HMCIfree_chunks(tmpinfo);
 
             /* free up stuff in special info */
+            free(tmpinfo->chk_index);
             free(tmpinfo->ddims);
             free(tmpinfo->seek_chunk_indices);
             free(tmpinfo->seek_pos_chunk);
@@ -896,6 +1528,9 @@ HMCIstaccess(accrec_t *access_rec, /* IN: access record to fill in */
             free(tmpinfo->comp_sp_tag_header);
             free(tmpinfo->cinfo);
             free(tmpinfo->minfo);
+            free(tmpinfo->tbl_recs);
+            free(tmpinfo->order);
+            free(tmpinfo->stats);
 
             /* free info struct last */
             free(tmpinfo);
@@ -929,7 +1564,13 @@ HMCIstaccess(accrec_t *access_rec, /* IN: access record to fill in */
         info->seek_pos_chunk       = NULL;
         info->seek_user_indices    = NULL;
         info->ddims                = NULL;
+        info->chk_pages            = NULL;
+        info->npages               = 0;
+        info->nused_pages          = 0;
+        info->npaged               = 0;
         info->chk_tree             = NULL;
+        info->chk_index            = NULL;
+        info->nindex               = 0;
         info->chk_cache            = NULL;
         info->fill_val             = NULL;
         info->minfo                = NULL;
@@ -937,6 +1578,49 @@ HMCIstaccess(accrec_t *access_rec, /* IN: access record to fill in */
         info->comp_sp_tag_header   = NULL;
         info->comp_sp_tag_head_len = 0;
         info->num_recs             = 0; /* zero records to start with */
+        info->tbl_recs             = NULL;
+        info->ntbl_recs            = 0;
+        info->tbl_recs_max         = 0;
+        info->order                = NULL;
+        info->norder               = 0;
+        info->nthreads             = 1; /* decode chunks serially */
+        info->predecoded           = NULL;
+        info->npredecoded          = 0;
+        info->pending              = NULL;
+        info->npending             = 0;
+        info->readahead            = FALSE;
+        info->ra_posn              = -1;
+        info->ra_length            = 0;
+        info->ra_stride            = 0;
+        info->ra_streak            = 0;
+        info->sparse               = FALSE;
+        info->raw_limit            = 0;
+        info->coder_policy         = -1;
+        info->dedup                = FALSE;
+        info->dd_slots             = NULL;
+        info->dd_nslots            = 0;
+        info->dd_nused             = 0;
+        info->stats_nt             = 0;
+        info->stats_looked         = FALSE;
+        info->stats_dirty          = FALSE;
+        info->stats_ref            = 0;
+        info->stats                = NULL;
+        info->nstats               = 0;
+        info->stats_max            = 0;
+        info->sums_on              = FALSE;
+        info->sums_looked          = FALSE;
+        info->sums_dirty           = FALSE;
+        info->sums_ref             = 0;
+        info->sums                 = NULL;
+        info->nsums                = 0;
+        info->sums_max             = 0;
+        info->comp_bytes           = -1;
+        info->rd_raw               = NULL;
+        info->rd_raw_size          = 0;
+        info->rd_offsets           = NULL;
+        info->rd_lengths           = NULL;
+        info->rd_exts              = NULL;
+        info->rd_nblocks           = 0;
 
         /* read the special info structure from the file */
         if ((dd_aid = Hstartaccess(access_rec->file_id, data_tag, data_ref, DFACC_READ)) == FAIL)
@@ -1132,80 +1816,31 @@ HMCIstaccess(accrec_t *access_rec, /* IN: access record to fill in */
             if (VSsetfields(info->aid, _HDF_CHK_FIELD_NAMES) == FAIL)
                 HGOTO_ERROR(DFE_BADFIELDS, FAIL);
 
-            /* Allocate space for a single Vdata record */
-            if ((v_data = malloc((size_t)vdata_size)) == NULL)
+            /* Allocate space for the chunk index */
+            if ((info->chk_index = (chunk_index_t *)malloc((size_t)num_recs * sizeof(chunk_index_t))) ==
+                NULL)
                 HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
-            /* for each record read it in and put into TBBT tree
-               NOTE: Should change this to a single VSread() but then
-               would have to store all the v_data rec's somewhere
-               before inserting them into the TBBT tree...
-               ....for someone to do later if performance of VSread() is bad.
-               Technically a B+-Tree should have been used instead or
-               better yet the Vdata implementation should be re-written to use one.
-               Note that chunk tag DTAG_CHUNK is not verified here.
-               It is checked in HMCPchunkread() before the chunk is read. */
-            for (j = 0; j < num_recs; j++) {
-                uint8 *pntr = NULL;
-
-                /* read single record */
-                if (VSread(info->aid, v_data, 1, FULL_INTERLACE) == FAIL)
-                    HGOTO_ERROR(DFE_VSREAD, FAIL);
-
-                pntr = v_data; /* set pointer to vdata record */
-
-                /* Allocate space for a chunk record */
-                if ((chkptr = (CHUNK_REC *)malloc(sizeof(CHUNK_REC))) == NULL)
-                    HGOTO_ERROR(DFE_NOSPACE, FAIL);
-
-                /* Allocate space for a origin in chunk record */
-                if ((chkptr->origin = (int32 *)malloc((size_t)info->ndims * sizeof(int32))) == NULL)
-                    HGOTO_ERROR(DFE_NOSPACE, FAIL);
-
-                /* allocate space for key */
-                if ((chk_key = (int32 *)malloc(sizeof(int32))) == NULL)
-                    HGOTO_ERROR(DFE_NOSPACE, FAIL);
-
-                /* Copy origin first */
-                for (k = 0; k < info->ndims; k++) {
-                    memcpy(&chkptr->origin[k], pntr, sizeof(int32));
-                    pntr += sizeof(int32);
-                }
-
-                /* Copy tag next.
-                   Note: Verification of tag as DTAG_CHUNK is done in
-                   HMCPchunkread() before the chunk object is read.
-                   In the future the tag/ref pair could point to
-                   another chunk table...etc.
-                   */
-                memcpy(&chkptr->chk_tag, pntr, sizeof(uint16));
-                pntr += sizeof(uint16);
-
-                /* Copy ref last */
-                memcpy(&chkptr->chk_ref, pntr, sizeof(uint16));
-
-                /* now compute chunk number from origin */
-                calculate_chunk_num(chk_key, info->ndims, chkptr->origin, info->ddims);
-
-                chkptr->chunk_number = *chk_key;
-
-                /* set chunk number to record number */
-                chkptr->chk_vnum = info->num_recs++;
-
-                /* add to TBBT tree based on chunk number as the key */
-                tbbtdins(info->chk_tree, chkptr, chk_key);
-            } /* end for num_recs */
+            /* Opened by the "mpio" driver, the file is read by a group of
+               processes: the first one alone reads the chunk table, and
+               the index is broadcast to the others */
+            status = SUCCEED;
+            if (HPmpio_rank(file_rec) == 0)
+                status = HMCIread_index(info, num_recs, vdata_size);
+            if (HPmpio_share(file_rec, status, info->chk_index,
+                             (int32)((size_t)num_recs * sizeof(chunk_index_t))) == FAIL)
+                HGOTO_ERROR(DFE_VSREAD, FAIL);
+            info->num_recs = num_recs;
+            info->nindex   = num_recs;
         }     /* end if num_recs */
 
         /* set return value */
         access_aid = HAregister_atom(AIDGROUP, access_rec);
 
         /* create chunk cache with 'maxcache' set to the number of chunks
-           along the last dimension i.e subscript changes the fastest*/
-        chunks_needed = 1;
-        for (i = 1; i < info->ndims; i++) {
-            chunks_needed *= info->ddims[i].num_chunks;
-        }
+           along the last dimension i.e subscript changes the fastest,
+           or as many as HDF_CONFIG_CHUNK_CACHE_BYTES holds */
+        chunks_needed = HMCIcache_size(info);
         if ((info->chk_cache = mcache_open(&access_rec->file_id,               /* cache key */
                                            access_aid,                         /* object id */
                                            (info->chunk_size * info->nt_size), /* chunk size */
@@ -1250,11 +1885,11 @@ done:
             if (info->aid != FAIL)
                 VSdetach(info->aid);
 
-            /* free chunk tree */
-            if (info->chk_tree != NULL)
-                tbbtdfree(info->chk_tree, chkdestroynode, chkfreekey);
+            /* free chunk records */
+            HMCIfree_chunks(info);
 
             /* free up stuff in special info */
+            free(info->chk_index);
             free(info->ddims);
             free(info->seek_chunk_indices);
             free(info->seek_pos_chunk);
@@ -1263,6 +1898,14 @@ done:
             free(info->comp_sp_tag_header);
             free(info->cinfo);
             free(info->minfo);
+            free(info->rd_raw);
+            free(info->rd_offsets);
+            free(info->rd_lengths);
+            free(info->rd_exts);
+            free(info->tbl_recs);
+            free(info->order);
+            free(info->stats);
+            free(info->dd_slots);
 
             free(info);
 
@@ -1276,8 +1919,6 @@ done:
     if (c_sp_header != NULL)
         free(c_sp_header);
 #endif
-    /* free allocated space for vdata record */
-    free(v_data);
 
     return ret_value;
 } /* HMCIstaccess */
@@ -1310,7 +1951,7 @@ DESCRIPTION
    the cache are dealt with by their number i.e. translation of
    'origin' of chunk to a unique number. The default maximum number
    of chunks is the cache is set the number of chunks along the
-   last dimension.
+   last dimension, see HMCIcache_size().
 
    NOTE: The cache itself could be used to cache any object into a number
    of fixed size chunks so long as the read/write(page-in/page-out) routines know
@@ -1333,6 +1974,7 @@ HMCcreate(int32 file_id,       /* IN: file to put chunked element in */
                                   can be an array? but we only handle 1 level */ )
 {
     filerec_t   *file_rec    = NULL;      /* file record */
+    filerec_t   *locked      = NULL;      /* file record locked by this call */
     accrec_t    *access_rec  = NULL;      /* access record */
     int32        dd_aid      = FAIL;      /* AID for writing the special info */
     chunkinfo_t *info        = NULL;      /* information for the chunked elt */
@@ -1360,6 +2002,7 @@ HMCcreate(int32 file_id,       /* IN: file to put chunked element in */
     /* validate args */
     if (BADFREC(file_rec) || chk_array == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
+    locked = HL_LOCK_FILE(file_rec);
 
     /* check file access for write */
     if (!(file_rec->access & DFACC_WRITE))
@@ -1416,9 +2059,58 @@ HMCcreate(int32 file_id,       /* IN: file to put chunked element in */
     info->seek_pos_chunk       = NULL;
     info->seek_user_indices    = NULL;
     info->ddims                = NULL;
+    info->chk_pages            = NULL;
+    info->npages               = 0;
+    info->nused_pages          = 0;
+    info->npaged               = 0;
     info->chk_tree             = NULL;
+    info->chk_index            = NULL;
+    info->nindex               = 0;
     info->chk_cache            = NULL;
     info->num_recs             = 0;            /* zero Vdata records to start */
+    info->tbl_recs             = NULL;
+    info->ntbl_recs            = 0;
+    info->tbl_recs_max         = 0;
+    info->order                = NULL;
+    info->norder               = 0;
+    info->nthreads             = 1;            /* decode chunks serially */
+    info->predecoded           = NULL;
+    info->npredecoded          = 0;
+    info->pending              = NULL;
+    info->npending             = 0;
+    info->readahead            = FALSE;
+    info->ra_posn              = -1;
+    info->ra_length            = 0;
+    info->ra_stride            = 0;
+    info->ra_streak            = 0;
+    info->sparse               = FALSE;
+    info->raw_limit            = 0;
+    info->coder_policy         = -1;
+    info->dedup                = FALSE;
+    info->dd_slots             = NULL;
+    info->dd_nslots            = 0;
+    info->dd_nused             = 0;
+    info->stats_nt             = 0;
+    info->stats_looked         = TRUE; /* new element, none in the file */
+    info->stats_dirty          = FALSE;
+    info->stats_ref            = 0;
+    info->stats                = NULL;
+    info->nstats               = 0;
+    info->stats_max            = 0;
+    info->sums_on              = FALSE;
+    info->sums_looked          = TRUE; /* new element, none in the file */
+    info->sums_dirty           = FALSE;
+    info->sums_ref             = 0;
+    info->sums                 = NULL;
+    info->nsums                = 0;
+    info->sums_max             = 0;
+    info->comp_bytes           = -1;
+    info->rd_raw               = NULL;
+    info->rd_raw_size          = 0;
+    info->rd_offsets           = NULL;
+    info->rd_lengths           = NULL;
+    info->rd_exts              = NULL;
+    info->rd_nblocks           = 0;
     info->fill_val_len         = fill_val_len; /* length of fill value */
     /* allocate space for fill value */
     if ((info->fill_val = malloc((uint32)fill_val_len)) == NULL)
@@ -1703,11 +2395,8 @@ HMCcreate(int32 file_id,       /* IN: file to put chunked element in */
     /* register this valid access record for the chunked element */
     access_aid = HAregister_atom(AIDGROUP, access_rec);
 
-    chunks_needed = 1;
-    for (i = 1; i < info->ndims; i++) {
-        chunks_needed *= info->ddims[i].num_chunks;
-    }
     /* create chunk cache */
+    chunks_needed = HMCIcache_size(info);
     if ((info->chk_cache = mcache_open(&access_rec->file_id,               /* cache key */
                                        access_aid,                         /* object id */
                                        (info->chunk_size * info->nt_size), /* chunk size */
@@ -1742,9 +2431,8 @@ done:
             if (info->aid != FAIL)
                 VSdetach(info->aid); /* detach from chunk table */
 
-            /* free chunk tree */
-            if (info->chk_tree != NULL)
-                tbbtdfree(info->chk_tree, chkdestroynode, chkfreekey);
+            /* free chunk records */
+            HMCIfree_chunks(info);
 
             /* free up stuff in special info */
             free(info->ddims);
@@ -1754,6 +2442,14 @@ done:
             free(info->comp_sp_tag_header);
             free(info->cinfo);
             free(info->minfo);
+            free(info->rd_raw);
+            free(info->rd_offsets);
+            free(info->rd_lengths);
+            free(info->rd_exts);
+            free(info->tbl_recs);
+            free(info->order);
+            free(info->stats);
+            free(info->dd_slots);
 
             free(info); /* free special info last */
 
@@ -1768,6 +2464,7 @@ done:
     /* free special element header */
     free(c_sp_header);
 
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* HMCcreate() */
 
@@ -1816,6 +2513,39 @@ done:
     return ret_value;
 } /* HMCgetcompress() */
 
+/*--------------------------------------------------------------------------
+NAME
+     HMCgetcompmodel - get the modeling type of a chunked element
+
+DESCRIPTION
+     Returns the modeling type the chunks of a compressed chunked element
+     were written with, COMP_MODEL_STDIO if the element is not compressed.
+     This routine is used by HCPgetcompmodel for the chunked element part.
+
+RETURNS
+     Returns SUCCEED/FAIL
+-------------------------------------------------------------------------- */
+intn
+HMCgetcompmodel(accrec_t     *access_rec, /* IN: access record */
+                comp_model_t *model_type /* OUT: modeling type */)
+{
+    chunkinfo_t *info      = NULL; /* chunked element information record */
+    intn         ret_value = SUCCEED;
+
+    /* Get the special info from the given record */
+    info = (chunkinfo_t *)access_rec->special_info;
+    if (info == NULL)
+        HGOTO_ERROR(DFE_COMPINFO, FAIL);
+
+    if (info->flag == SPECIAL_COMP)
+        *model_type = info->model_type;
+    else
+        *model_type = COMP_MODEL_STDIO;
+
+done:
+    return ret_value;
+} /* HMCgetcompmodel() */
+
 /*--------------------------------------------------------------------------
 NAME
      HMCgetcomptype - get compression information for chunked element
@@ -1970,7 +2700,6 @@ HMCgetdatainfo(int32 file_id, uint16 tag, uint16 ref, int32 *chk_coord, /* IN: c
     intn         count   = 0; /* number of blocks */
     int32        chk_num = 0;
     CHUNK_REC   *chk_rec = NULL; /* chunk record */
-    TBBT_NODE   *entry   = NULL; /* chunk node from TBBT */
     accrec_t    *access_rec;
     filerec_t   *file_rec;
     int32        new_aid   = FAIL;
@@ -2008,9 +2737,10 @@ HMCgetdatainfo(int32 file_id, uint16 tag, uint16 ref, int32 *chk_coord, /* IN: c
     /* Calculate chunk number from origin */
     calculate_chunk_num(&chk_num, chkinfo->ndims, chk_coord, chkinfo->ddims);
 
-    /* Find chunk record in TBBT */
-    if ((entry = (tbbtdfind(chkinfo->chk_tree, &chk_num, NULL))) ==
-        NULL) { /* chunk had not been written, no chunk record */
+    /* Find chunk record */
+    if (HMCIfind_chunk(chkinfo, chk_num, &chk_rec) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (chk_rec == NULL) { /* chunk had not been written, no chunk record */
         if (offsetarray != NULL && lengtharray != NULL) {
             offsetarray[0] = 0;
             lengtharray[0] = 0;
@@ -2018,9 +2748,6 @@ HMCgetdatainfo(int32 file_id, uint16 tag, uint16 ref, int32 *chk_coord, /* IN: c
         count = 0;
     }
     else { /* chunk record exists */
-        /* Get chunk record from node */
-        chk_rec = (CHUNK_REC *)entry->data;
-
         /* Check to see if it has been written to */
         if (chk_rec->chk_tag != DFTAG_NULL &&
             BASETAG(chk_rec->chk_tag) == DFTAG_CHUNK) { /* valid chunk in file */
@@ -2143,6 +2870,77 @@ done:
     return ret_value;
 } /* HMCgetdatainfo */
 
+/* ------------------------------ HMCIcomp_length -----------------------------
+NAME
+   HMCIcomp_length -- length of a compressed chunk as stored in the file
+
+DESCRIPTION
+   Reads the compression special info header the chunk's tag/ref points
+   to, only as far as the ref# of the compressed data, and returns the
+   length of that data.  The chunk is not decoded and no coder is set up.
+   A chunk stored as it is, see HMCsetRawLimit(), is its own length.
+
+RETURNS
+   The length of the compressed data of the chunk, FAIL on error
+--------------------------------------------------------------------------- */
+static int32
+HMCIcomp_length(int32  file_id, /* IN: file the chunk is in */
+                uint16 chk_tag, /* IN: tag of the chunk */
+                uint16 chk_ref /* IN: ref of the chunk */)
+{
+    uint8  chk_spbuf[10]; /* 10 bytes for special tag, version,
+                             uncomp len, comp ref# */
+    uint8 *p;
+    uint16 sp_tag;
+    uint16 comp_ref = 0;
+    int32  chk_aid  = FAIL;
+    atom_t ddid;    /* DD of the chunk */
+    intn   special; /* whether the DD is special */
+    int32  len;
+    int32  ret_value = SUCCEED;
+
+    /* a chunk stored as it is, see HMCsetRawLimit() */
+    if ((ddid = HTPselect(HAatom_object(file_id), chk_tag, chk_ref)) == FAIL)
+        HGOTO_ERROR(DFE_NOMATCH, FAIL);
+    special = HTPis_special(ddid);
+    if (HTPendaccess(ddid) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (!special)
+        HGOTO_DONE(Hlength(file_id, chk_tag, chk_ref));
+
+    /* Prepare to read the info which the tag/ref points to */
+    if ((chk_aid = Hstartaccess(file_id, MKSPECIALTAG(chk_tag), chk_ref, DFACC_READ)) == FAIL)
+        HGOTO_ERROR(DFE_BADAID, FAIL);
+
+    /* Read 10 bytes: special tag (2), comp. version (2),
+       uncomp length (4), and comp. ref# (2) */
+    if (Hread(chk_aid, 10, chk_spbuf) == FAIL)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
+
+    /* Decode and check the special tag to be sure */
+    p = chk_spbuf;
+    UINT16DECODE(p, sp_tag); /* 2 bytes */
+    if (sp_tag != SPECIAL_COMP)
+        HGOTO_ERROR(DFE_COMPINFO, FAIL);
+
+    /* Skip compression version (2 bytes) and uncompressed data length
+       (4 bytes), then get ref # of compressed data (2 bytes) */
+    p = p + 2 + 4;
+    UINT16DECODE(p, comp_ref);
+
+    /* Get length of compressed data */
+    if ((len = Hlength(file_id, DFTAG_COMPRESSED, comp_ref)) == FAIL)
+        HGOTO_ERROR(DFE_BADLEN, FAIL);
+
+    ret_value = len;
+
+done:
+    if (chk_aid != FAIL && Hendaccess(chk_aid) == FAIL)
+        ret_value = FAIL;
+
+    return ret_value;
+} /* HMCIcomp_length() */
+
 /*--------------------------------------------------------------------------
 NAME
      HMCgetdatasize - get data sizes of the chunked element
@@ -2155,8 +2953,9 @@ DESCRIPTION
      - decode the chunking info special header to get the chunk table info
      - get access to the chunk table via Vdata interface
      - get the size of the chunk table to determine if the data has been written
-     - if the element is also compressed, read each vdata record to obtain the
-        tag/ref pair of the compression special header and read the header
+     - if the element is also compressed, read the vdata records, in batches,
+        to obtain the tag/ref pair of the compression special header of each
+        chunk and read the header, see HMCIcomp_length
      - decode the compression special header to get the compressed data ref# and
         retrieve the compressed data length via Hlength
      - if uncompressed size is requested by the caller, calculate the actual
@@ -2176,22 +2975,19 @@ HMCgetdatasize(int32 file_id, uint8 *p, /* IN: access id of header info */
                int32 *comp_size,        /* OUT: size of compressed data */
                int32 *orig_size)        /* OUT: size of uncompression type */
 {
-    uint16       comp_ref = 0;                   /* ref# of compressed data */
     char         vsname[VSNAMELENMAX + 1];       /* Vdata name */
     char         v_class[VSNAMELENMAX + 1] = ""; /* Vdata class for comparison */
     char         vsclass[VSNAMELENMAX + 1];      /* Vdata class */
     int32        vdata_size;                     /* size of Vdata */
     chunkinfo_t *chkinfo   = NULL;               /* chunked element information */
-    uint8       *v_data    = NULL;               /* Vdata record */
+    uint8       *v_data    = NULL;               /* batch of Vdata records */
     int32        num_recs  = 0,                  /* number of records in chunk table */
         chk_data_size      = 0,                  /* non-compressed data size */
         chk_comp_data_size = 0,                  /* compressed data size */
         chktab_id          = -1,                 /* chunk table (vdata) id */
-        chk_aid            = -1,                 /* a single chunk aid */
+        nrecs              = 0,                  /* records read at once */
         len                = 0;                  /* length of a compressed chunk */
-    uint8 chk_spbuf[10];                         /* 10 bytes for special tag, version,
-                                                    uncomp len, comp ref# */
-    int  j, k;
+    int  i, j, k;
     intn ret_value = SUCCEED;
 
     /* Skip 4byte header len */
@@ -2259,8 +3055,6 @@ HMCgetdatasize(int32 file_id, uint8 *p, /* IN: access id of header info */
                    special info header of each chunk and get the compressed
                    data size */
                 case SPECIAL_COMP: {
-                    uint16 sp_tag;
-
                     /* Get class of Vdata */
                     if ((VSgetclass(chktab_id, vsclass)) == FAIL)
                         HGOTO_ERROR(DFE_INTERNAL, FAIL);
@@ -2275,73 +3069,42 @@ HMCgetdatasize(int32 file_id, uint8 *p, /* IN: access id of header info */
                     if (VSsetfields(chktab_id, _HDF_CHK_FIELD_NAMES) == FAIL)
                         HGOTO_ERROR(DFE_BADFIELDS, FAIL);
 
-                    /* Allocate space for a single Vdata record */
-                    if ((v_data = malloc((size_t)vdata_size)) == NULL)
+                    /* Allocate space for a batch of Vdata records */
+                    nrecs = MIN(num_recs, _HDF_CHK_INDEX_BATCH);
+                    if ((v_data = malloc((size_t)nrecs * (size_t)vdata_size)) == NULL)
                         HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
-                    /* Read in the tag/ref of each chunk then get the
-                        compression info header the tag/ref points to and
-                        decode the compressed data size */
-                    for (j = 0; j < num_recs; j++) {
-                        uint8 *pntr = NULL;      /* temp pointer to vdata record */
-                        uint16 chk_tag, chk_ref; /* each chunk's tag/ref */
+                    /* Read in the tag/ref of each chunk, a batch of records
+                        at a time, then get the compressed data size from the
+                        compression info header the tag/ref points to */
+                    for (j = 0; j < num_recs; j += nrecs) {
+                        uint8 *pntr  = NULL; /* temp pointer to vdata record */
+                        int32  nread = MIN(nrecs, num_recs - j);
 
-                        /* Read single record */
-                        if (VSread(chktab_id, v_data, 1, FULL_INTERLACE) == FAIL)
+                        if (VSread(chktab_id, v_data, nread, FULL_INTERLACE) != nread)
                             HGOTO_ERROR(DFE_VSREAD, FAIL);
 
                         pntr = v_data; /* set pointer to vdata record */
+                        for (i = 0; i < nread; i++) {
+                            uint16 chk_tag, chk_ref; /* each chunk's tag/ref */
 
-                        /* Skip origin first */
-                        for (k = 0; k < chkinfo->ndims; k++) {
-                            pntr += sizeof(int32);
-                        }
-
-                        /* Get the chunk's tag and ref */
-                        memcpy(&chk_tag, pntr, sizeof(uint16));
-                        pntr += sizeof(uint16);
-                        memcpy(&chk_ref, pntr, sizeof(uint16));
-
-                        /* Prepare to read the info which the tag/ref points to */
-                        chk_aid = Hstartaccess(file_id, MKSPECIALTAG(chk_tag), chk_ref, DFACC_READ);
-                        if (chk_aid == FAIL)
-                            HGOTO_ERROR(DFE_BADAID, FAIL);
-
-                        /* Read 10 bytes: special tag (2), comp. version (2),
-                           uncomp length (4), and comp. ref# (2) */
-                        if (Hread(chk_aid, 10, chk_spbuf) == FAIL)
-                            HGOTO_ERROR(DFE_READERROR, FAIL);
-
-                        /* Decode and check the special tag to be sure */
-                        p = chk_spbuf;
-                        UINT16DECODE(p, sp_tag); /* 2 bytes */
-                        if (sp_tag == SPECIAL_COMP) {
-                            /* Skip compression version (2 bytes) and
-                                uncompressed data length (4 bytes) */
-                            p = p + 2 + 4;
-
-                            /* Get ref # of compressed data (2 bytes) */
-                            UINT16DECODE(p, comp_ref);
+                            /* Skip origin first */
+                            for (k = 0; k < chkinfo->ndims; k++) {
+                                pntr += sizeof(int32);
+                            }
 
-                            /* Get length of compressed data.  Note that this
-                                length is specified as compressed chunk size
-                                times nt_size. */
-                            if ((len = Hlength(file_id, DFTAG_COMPRESSED, comp_ref)) == FAIL)
-                                HGOTO_ERROR(DFE_BADLEN, FAIL);
+                            /* Get the chunk's tag and ref */
+                            memcpy(&chk_tag, pntr, sizeof(uint16));
+                            pntr += sizeof(uint16);
+                            memcpy(&chk_ref, pntr, sizeof(uint16));
+                            pntr += sizeof(uint16);
 
                             /* Accumulate compressed size of all chunks. */
+                            if ((len = HMCIcomp_length(file_id, chk_tag, chk_ref)) == FAIL)
+                                HGOTO_ERROR(DFE_COMPINFO, FAIL);
                             chk_comp_data_size = chk_comp_data_size + len;
                         }
-
-                        /* sp_tag is not SPECIAL_COMP, while 'chkinfo->flag'
-                           above is SPECIAL_COMP, something must be wrong */
-                        else
-                            HGOTO_ERROR(DFE_COMPINFO, FAIL);
-
-                        /* End access to special info of an individual chunk */
-                        if (Hendaccess(chk_aid) == FAIL)
-                            HGOTO_ERROR(DFE_CANTENDACCESS, FAIL);
-                    } /* for each record */
+                    } /* for each batch of records */
                     break;
                 }
                 default:
@@ -2397,6 +3160,13 @@ DESCRIPTION
      Use flags argument of 'HMC_PAGEALL' if the whole object is to be cached
      in memory otherwise pass in zero.
 
+     One of HDF_CACHE_LRU (the default), HDF_CACHE_CLOCK or HDF_CACHE_2Q
+     can be or'ed into 'flags' to select the replacement policy of the
+     cache, see mcache_set_policy().  With HDF_CACHE_SHARED the cache
+     joins the shared pool with 'maxcache' as its weight, see
+     mcache_set_pool(), otherwise it leaves the pool.  The policy and
+     the pool membership are set on every call.
+
 RETURNS
      Returns number of 'maxcache' if successful and FAIL otherwise
 
@@ -2415,22 +3185,43 @@ HMCsetMaxcache(int32 access_id, /* IN: access aid to mess with */
 {
     accrec_t    *access_rec = NULL; /* access record */
     chunkinfo_t *info       = NULL; /* chunked element information record */
+    intn         policy;            /* cache replacement policy */
+    filerec_t   *locked     = NULL;
     int32        ret_value  = SUCCEED;
 
-    (void)flags;
+    locked = HL_LOCK_AID(access_id);
 
     /* Check args */
     access_rec = HAatom_object(access_id);
     if (access_rec == NULL || maxcache < 1)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
+    switch (flags & HDF_CACHE_POLICY) {
+        case HDF_CACHE_LRU:
+            policy = MCACHE_LRU;
+            break;
+        case HDF_CACHE_CLOCK:
+            policy = MCACHE_CLOCK;
+            break;
+        case HDF_CACHE_2Q:
+            policy = MCACHE_2Q;
+            break;
+        default:
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
     /* since this routine can be called by the user,
        need to check if this access id is special CHUNKED */
     if (access_rec->special == SPECIAL_CHUNKED) {
         info = (chunkinfo_t *)(access_rec->special_info);
 
-        if (info != NULL)
+        if (info != NULL) {
             ret_value = mcache_set_maxcache(info->chk_cache, maxcache);
+            if (mcache_set_policy(info->chk_cache, policy) == FAIL)
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+            if (mcache_set_pool(info->chk_cache, (flags & HDF_CACHE_SHARED) ? ret_value : 0) == FAIL)
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        }
         else
             ret_value = FAIL;
     }
@@ -2438,447 +3229,4776 @@ HMCsetMaxcache(int32 access_id, /* IN: access aid to mess with */
         ret_value = FAIL;
 
 done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* HMCsetMaxcache() */
 
-/* ------------------------------ HMCPstread -------------------------------
+/* ------------------------------- HMCsetThreads ----------------------------
 NAME
-   HMCPstread -- open an access record of chunked element for reading
+     HMCsetThreads - number of threads used to code chunks
 
 DESCRIPTION
-   Calls to HMCIstaccess to fill in the access rec for
-   reading
+     Set the number of threads used to decode and encode the compressed
+     chunks of this element.
+
+     With 'nthreads' greater than 1, a read that has to bring several
+     deflate or LZ4 compressed chunks into the chunk cache first reads
+     their compressed data from the file, then decodes it on up to 'nthreads'
+     threads and only then hands the decoded chunks to the cache.
+
+     Likewise, new deflate or LZ4 compressed chunks leaving the chunk cache
+     are queued instead of being written right away.  The queue is encoded
+     on up to 'nthreads' threads and written out whenever it fills up,
+     when the number of threads is changed again and at the latest when
+     the element is closed, so write errors for these chunks are reported
+     by Hendaccess().  Chunks that already exist in the file are
+     rewritten serially.
+
+     A value of 1 restores the default, serial behavior.  Chunks using
+     other compression methods are always coded serially, as are all
+     chunks when the library was built without thread support.
 
 RETURNS
-   The AID of the access record on success FAIL on error.
-AUTHOR
-   -GeorgeV - 9/3/96
----------------------------------------------------------------------------*/
-static int32
-HMCPstread(accrec_t *access_rec /* IN: access record to fill in */)
+     Returns the previous number of threads if successful and FAIL otherwise
+
+-------------------------------------------------------------------------- */
+intn
+HMCsetThreads(int32 access_id, /* IN: access aid to mess with */
+              intn  nthreads /* IN: number of coding threads */)
 {
-    int32 ret_value;
+    accrec_t    *access_rec = NULL; /* access record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    filerec_t   *locked     = NULL;
+    intn         ret_value  = SUCCEED;
 
-    ret_value = HMCIstaccess(access_rec, DFACC_READ);
+    locked = HL_LOCK_AID(access_id);
 
-    return ret_value;
-} /* HMCPstread */
-
-/* ------------------------------ HMCPstwrite ------------------------------
-NAME
-   HMCPstwrite -- open an access record of a chunked element for writing
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL || nthreads < 1)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
 
-DESCRIPTION
-   Calls to HMCIstaccess to fill in the access rec for
-   writing
+    /* since this routine can be called by the user,
+       need to check if this access id is special CHUNKED */
+    if (access_rec->special == SPECIAL_CHUNKED) {
+        info = (chunkinfo_t *)(access_rec->special_info);
 
-RETURNS
-   The AID of the access record on success FAIL on error.
-AUTHOR
-   -GeorgeV - 9/3/96
----------------------------------------------------------------------------*/
-static int32
-HMCPstwrite(accrec_t *access_rec /* IN: access record to fill in */)
-{
-    int32 ret_value;
+        if (info != NULL) {
+            /* the write-behind queue is sized for the old number */
+            if (HMCIflush_pending(access_rec) == FAIL)
+                HGOTO_ERROR(DFE_WRITEERROR, FAIL);
 
-    ret_value = HMCIstaccess(access_rec, DFACC_WRITE);
+            ret_value      = info->nthreads;
+            info->nthreads = (nthreads > HTPOOL_MAX_THREADS) ? HTPOOL_MAX_THREADS : nthreads;
+        }
+        else
+            ret_value = FAIL;
+    }
+    else /* not special */
+        ret_value = FAIL;
 
+done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
-} /* HMCPstwrite */
+} /* HMCsetThreads() */
 
-/* ------------------------------- HMCPseek --------------------------------
+/* ------------------------------ HMCgetCacheStats ---------------------------
 NAME
-   HMCPseek -- set the seek posn in the chunked element
+     HMCgetCacheStats - hit, miss and eviction counts of the chunk cache
 
 DESCRIPTION
-   Set the seek posn in the given chunked element
+     Returns the number of chunk lookups that were satisfied from the
+     chunk cache of this element, the number that had to read the chunk
+     from the file (or create it), and the number of chunks evicted from
+     the cache to make room for others, since the element was opened.
 
 RETURNS
-   SUCCEED / FAIL
-AUTHOR
-   -GeorgeV - 9/3/96
----------------------------------------------------------------------------*/
-static int32
-HMCPseek(accrec_t *access_rec, /* IN: access record to mess with */
-         int32     offset,     /* IN: seek offset */
-         int       origin /* IN: where we should calc the offset from */)
+     Returns SUCCEED if successful and FAIL otherwise
+
+-------------------------------------------------------------------------- */
+intn
+HMCgetCacheStats(int32              access_id, /* IN: access aid to mess with */
+                 hdf_cache_stats_t *stats /* OUT: hit, miss and eviction counts */)
 {
-    chunkinfo_t *info      = NULL; /* information for the chunked elt */
-    int32        ret_value = SUCCEED;
+    accrec_t    *access_rec = NULL; /* access record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    intn         ret_value  = SUCCEED;
 
     /* Check args */
+    access_rec = HAatom_object(access_id);
     if (access_rec == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* validate access record */
-    if (access_rec->special != SPECIAL_CHUNKED)
-        HGOTO_ERROR(DFE_INTERNAL, FAIL);
-
-    /* get special info */
-    info = (chunkinfo_t *)(access_rec->special_info);
-
-    /* adjust the offset according to origin and validate */
-    /* there is no upper bound to posn */
-    if (origin == DF_CURRENT)
-        offset += access_rec->posn;
-    if (origin == DF_END)
-        offset += (info->length * info->nt_size); /* adjust by number type size */
-    if (offset < 0)
-        HGOTO_ERROR(DFE_RANGE, FAIL);
-
-    /* Seek to given location(bytes) for reading/writing */
-    /* i.e calculate chunk indices given seek location
-       this will update the proper arrays in the special info struct */
-    update_chunk_indices_seek(offset, info->ndims, info->nt_size, info->seek_chunk_indices,
-                              info->seek_pos_chunk, info->ddims);
+    /* since this routine can be called by the user,
+       need to check if this access id is special CHUNKED */
+    if (access_rec->special == SPECIAL_CHUNKED) {
+        info = (chunkinfo_t *)(access_rec->special_info);
 
-    /* set position in access record */
-    access_rec->posn = offset;
+        if (info != NULL)
+            ret_value = mcache_get_stats(info->chk_cache, stats);
+        else
+            ret_value = FAIL;
+    }
+    else /* not special */
+        ret_value = FAIL;
 
 done:
     return ret_value;
-} /* HMCPseek */
+} /* HMCgetCacheStats() */
 
-/* ------------------------------- HMCPchunkread --------------------------------
+/* ------------------------------- HMCsetReadahead --------------------------
 NAME
-   HMCPchunkread - read a chunk
+     HMCsetReadahead - turn readahead of sequential reads on or off
 
 DESCRIPTION
-   Read in a whole chunk from a chunked element given the chunk number.
-
-   This is used as the 'page-in-chunk' routine for the cache.
-   Only the cache should call this routine.
+     With readahead on, the element watches where its reads start.  Once
+     three reads of the same length in a row were each the same distance
+     past the one before, as when a dataset is read slab by slab along its
+     slowest dimension, every further read of the pattern brings the
+     chunks the next read of the pattern will need into the chunk cache
+     before it returns.  Chunks decoded on several threads (see
+     HMCsetThreads()) are read and decoded ahead together with the chunks
+     of the current read.
+
+     Nothing is read ahead when the next read would need more chunks than
+     the chunk cache holds.  Chunks read ahead count as cache misses in
+     HMCgetCacheStats(), and the reads that find them as hits.
 
 RETURNS
-   The number of bytes read or FAIL on error
-AUTHOR
-   -GeorgeV - 9/3/96
---------------------------------------------------------------------------- */
-static int32
-HMCPchunkread(void *cookie,    /* IN: access record to mess with */
-              int32 chunk_num, /* IN: chunk to read */
-              void *datap /* OUT: buffer for data */)
+     Returns the previous setting (TRUE or FALSE) if successful and FAIL
+     otherwise
+
+-------------------------------------------------------------------------- */
+intn
+HMCsetReadahead(int32 access_id, /* IN: access aid to mess with */
+                intn  readahead /* IN: TRUE to turn readahead on */)
 {
-    accrec_t    *access_rec = (accrec_t *)cookie; /* access record */
-    chunkinfo_t *info       = NULL;               /* information record for this special data elt */
-    CHUNK_REC   *chk_rec    = NULL;               /* chunk record */
-    TBBT_NODE   *entry      = NULL;               /* chunk node from TBBT */
-    uint8       *bptr       = NULL;               /* pointer to data buffer */
-    int32        chk_id     = FAIL;               /* chunk id */
-    int32        bytes_read = 0;                  /* total # bytes read for this call of HMCIread */
-    int32        read_len   = 0;                  /* length of bytes to read */
-    int32        nitems     = 1;                  /* used in HDmemfill(), */
-    int32        ret_value  = SUCCEED;
+    accrec_t    *access_rec = NULL; /* access record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    filerec_t   *locked     = NULL;
+    intn         ret_value  = SUCCEED;
+
+    locked = HL_LOCK_AID(access_id);
 
     /* Check args */
+    access_rec = HAatom_object(access_id);
     if (access_rec == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* set inputs */
-    bptr       = (uint8 *)datap;
-    info       = (chunkinfo_t *)(access_rec->special_info);
-    bytes_read = 0;
-    read_len   = (info->chunk_size * info->nt_size);
-
-    /* find chunk record in TBBT */
-    if ((entry = (tbbtdfind(info->chk_tree, &chunk_num, NULL))) == NULL) { /* does not exist */
-        /* calculate number of fill value items to fill buffer with */
-        nitems = (info->chunk_size * info->nt_size) / info->fill_val_len;
+    /* since this routine can be called by the user,
+       need to check if this access id is special CHUNKED */
+    if (access_rec->special == SPECIAL_CHUNKED) {
+        info = (chunkinfo_t *)(access_rec->special_info);
 
-        /* copy fill values into buffer and return */
-        if (HDmemfill(datap, info->fill_val, (uint32)info->fill_val_len, (uint32)nitems) == NULL)
-            HE_REPORT_GOTO("HDmemfill failed to fill read chunk", FAIL);
+        if (info != NULL) {
+            ret_value       = info->readahead;
+            info->readahead = (readahead != FALSE) ? TRUE : FALSE;
+            info->ra_posn   = -1; /* start looking for a pattern again */
+            info->ra_streak = 0;
+        }
+        else
+            ret_value = FAIL;
     }
-    else /* exists in TBBT */
-    {
-        /* get chunk record from node */
-        chk_rec = (CHUNK_REC *)entry->data;
+    else /* not special */
+        ret_value = FAIL;
 
-        /* check to see if has been written to */
-        if (chk_rec->chk_tag != DFTAG_NULL &&
-            BASETAG(chk_rec->chk_tag) == DFTAG_CHUNK) { /* valid chunk in file */
-            /* Start read on chunk */
-            if ((chk_id = Hstartread(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref)) == FAIL) {
-                Hendaccess(chk_id);
-                HE_REPORT_GOTO("Hstartread failed to read chunk", FAIL);
-            }
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* HMCsetReadahead() */
 
-            /* read data from chunk */
-            if (Hread(chk_id, read_len, bptr) == FAIL)
-                HGOTO_ERROR(DFE_READERROR, FAIL);
+/* -------------------------------- HMCsetSparse -----------------------------
+NAME
+     HMCsetSparse - leave chunks of only fill values unwritten
 
-            bytes_read = read_len;
+DESCRIPTION
+     With sparse writes on, a chunk that holds nothing but the fill value
+     of the element when it leaves the chunk cache is not written to the
+     file, and gets no chunk table record, provided it was never written
+     before.  It reads back as fill values like any chunk never written.
+     A chunk already in the file is always written, as the chunk table
+     cannot drop records.
 
-            /* end access to chunk */
-            if (Hendaccess(chk_id) == FAIL)
-                HE_REPORT_GOTO("Hendaccess failed to end access to chunk", FAIL);
-        }
-        else if (chk_rec->chk_tag ==
-                 DFTAG_NULL) { /* chunk has not been written, so return fill value buffer */
-            /* calculate number of fill value items to fill buffer with */
-            nitems = (info->chunk_size * info->nt_size) / info->fill_val_len;
+     Chunks that were never written are read as fill values straight into
+     the caller's buffer, without going through the chunk cache, whether
+     sparse writes are on or not.
 
-            /* copy fill values into buffer and return */
-            if (HDmemfill(datap, info->fill_val, (uint32)info->fill_val_len, (uint32)nitems) == NULL)
-                HE_REPORT_GOTO("HDmemfill failed to fill read chunk", FAIL);
-        }
-        else /* not a valid chunk ref for now */
-        {
-            /* For now DFTAG_CHUNK is the only allowed value.
-               In the future this could be another Chunk table. */
-            HE_REPORT_GOTO("Not a valid Chunk object, wrong tag for chunk", FAIL);
-        }
+RETURNS
+     Returns the previous setting (TRUE or FALSE) if successful and FAIL
+     otherwise
 
-    } /* end else exists in TBBT tree */
+-------------------------------------------------------------------------- */
+intn
+HMCsetSparse(int32 access_id, /* IN: access aid to mess with */
+             intn  sparse /* IN: TRUE to leave chunks of fill values unwritten */)
+{
+    accrec_t    *access_rec = NULL; /* access record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    filerec_t   *locked     = NULL;
+    intn         ret_value  = SUCCEED;
 
-    ret_value = bytes_read; /* number of bytes read */
+    locked = HL_LOCK_AID(access_id);
 
-done:
-    if (ret_value == FAIL) { /* Error condition cleanup */
-        if (chk_id != FAIL)
-            Hendaccess(chk_id);
-    } /* end if */
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* since this routine can be called by the user,
+       need to check if this access id is special CHUNKED */
+    if (access_rec->special == SPECIAL_CHUNKED) {
+        info = (chunkinfo_t *)(access_rec->special_info);
+
+        if (info != NULL) {
+            ret_value    = info->sparse;
+            info->sparse = (sparse != FALSE) ? TRUE : FALSE;
+        }
+        else
+            ret_value = FAIL;
+    }
+    else /* not special */
+        ret_value = FAIL;
 
+done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
-} /* HMCPchunkread() */
+} /* HMCsetSparse() */
 
-/* ------------------------------- HMCreadChunk ---------------------------
+/* -------------------------------- HMCsetDedup ------------------------------
 NAME
-   HMCreadChunk -- read a whole chunk
+     HMCsetDedup - share the data of chunks identical to one written before
 
 DESCRIPTION
-   Read a whole chunk from a chunked element.
+     With deduplication on, a chunk that was never written and is the
+     same, byte for byte, as a chunk of the element written since the
+     element was opened gets a DD pointing at the data of that chunk,
+     see Hdupdd(), instead of being encoded and written again.  Chunks
+     are matched on a CRC-32 of their data and then compared with what
+     the file holds.  Those written with HMCwriteChunkRaw() are matched on
+     their data as stored, the others on their decoded data.
 
-   This can be used by users to read whole chunks from the file
-   based on chunk origin for now i.e position of chunk in overall
-.  chunk array.
+     A chunk sharing its data is given data of its own when it is written
+     again, so that the other chunks keep theirs.
 
 RETURNS
-   The number of bytes read or FAIL on error
-AUTHOR
-   -GeorgeV - 9/3/96
----------------------------------------------------------------------------*/
-int32
-HMCreadChunk(int32  access_id, /* IN: access aid to mess with */
-             int32 *origin,    /* IN: origin of chunk to read */
-             void  *datap /* IN: buffer for data */)
+     Returns the previous setting (TRUE or FALSE) if successful and FAIL
+     otherwise
+
+-------------------------------------------------------------------------- */
+intn
+HMCsetDedup(int32 access_id, /* IN: access aid to mess with */
+            intn  dedup /* IN: TRUE to share the data of identical chunks */)
 {
     accrec_t    *access_rec = NULL; /* access record */
-    filerec_t   *file_rec   = NULL; /* file record */
     chunkinfo_t *info       = NULL; /* chunked element information record */
-    uint8       *bptr       = NULL; /* data buffer pointer */
-    void        *chk_data   = NULL; /* chunk data */
-    uint8       *chk_dptr   = NULL; /* chunk data pointer */
-    int32        relative_posn;     /* relative position in chunked element */
-    int32        bytes_read = 0;    /* total #bytes read  */
-    int32        read_len   = 0;    /* bytes to read next */
-    int32        chunk_num  = -1;   /* chunk number */
-    int32        ret_value  = SUCCEED;
-    intn         i;
+    filerec_t   *locked     = NULL;
+    intn         ret_value  = SUCCEED;
+
+    locked = HL_LOCK_AID(access_id);
 
     /* Check args */
     access_rec = HAatom_object(access_id);
     if (access_rec == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    if (origin == NULL || datap == NULL)
-        HGOTO_ERROR(DFE_ARGS, FAIL);
-
-    /* validate file records */
-    file_rec = HAatom_object(access_rec->file_id);
-    if (BADFREC(file_rec))
-        HGOTO_ERROR(DFE_INTERNAL, FAIL);
-
-    /* can read from this file? */
-    if (!(file_rec->access & DFACC_READ))
-        HGOTO_ERROR(DFE_DENIED, FAIL);
-
     /* since this routine can be called by the user,
        need to check if this access id is special CHUNKED */
     if (access_rec->special == SPECIAL_CHUNKED) {
-        /* Set inputs */
-        info          = (chunkinfo_t *)(access_rec->special_info);
-        relative_posn = access_rec->posn;
-        read_len      = (info->chunk_size * info->nt_size);
-        bytes_read    = 0;
-        bptr          = datap;
+        info = (chunkinfo_t *)(access_rec->special_info);
 
-        /* copy origin over to seek chunk indices
-           and set position within chunk to beginning of that chunk */
-        for (i = 0; i < info->ndims; i++) {
-            info->seek_chunk_indices[i] = origin[i];
-            info->seek_pos_chunk[i]     = 0;
+        if (info != NULL) {
+            ret_value   = info->dedup;
+            info->dedup = (dedup != FALSE) ? TRUE : FALSE;
         }
+        else
+            ret_value = FAIL;
+    }
+    else /* not special */
+        ret_value = FAIL;
 
-        /* calculate chunk number from origin */
-        calculate_chunk_num(&chunk_num, info->ndims, origin, info->ddims);
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* HMCsetDedup() */
+
+/* ------------------------------- HMCsetRawLimit -----------------------------
+NAME
+     HMCsetRawLimit - store chunks that do not compress well as they are
+
+DESCRIPTION
+     With a limit set, a new chunk of a deflate or LZ4 compressed element
+     is compressed in memory first, and is stored as it is, without the
+     compression, unless it compresses to at most 'percent' percent of
+     its size.  Such a chunk is an element of its own that is not special,
+     which every reader reads without decoding it.  The first
+     _HDF_CHK_RAW_SAMPLE bytes of a larger chunk are compressed first,
+     and the rest is not when they do not compress to the limit.
+
+     A 'percent' of 0 turns the limit off, which is the default.  Chunks
+     already in the file are written back the way they are stored.
+
+RETURNS
+     Returns the previous limit if successful and FAIL otherwise
+
+-------------------------------------------------------------------------- */
+intn
+HMCsetRawLimit(int32 access_id, /* IN: access aid to mess with */
+               intn  percent /* IN: limit of the compressed size, 0 for none */)
+{
+    accrec_t    *access_rec = NULL; /* access record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    filerec_t   *locked     = NULL;
+    intn         ret_value  = SUCCEED;
+
+    locked = HL_LOCK_AID(access_id);
+
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL || percent < 0 || percent > 100)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* since this routine can be called by the user,
+       need to check if this access id is special CHUNKED */
+    if (access_rec->special == SPECIAL_CHUNKED) {
+        info = (chunkinfo_t *)(access_rec->special_info);
+
+        if (info != NULL) {
+            ret_value       = info->raw_limit;
+            info->raw_limit = percent;
+        }
+        else
+            ret_value = FAIL;
+    }
+    else /* not special */
+        ret_value = FAIL;
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* HMCsetRawLimit() */
+
+/* ----------------------------- HMCsetCoderPolicy ----------------------------
+NAME
+     HMCsetCoderPolicy - choose the coder of each new chunk by a trial
+
+DESCRIPTION
+     With a policy set, the first _HDF_CHK_RAW_SAMPLE bytes of a new chunk
+     of a deflate or LZ4 compressed element are compressed with each of
+     the coders LZ4 (when the library has it), deflate at level 1 and
+     deflate at the level of the element, or 6 for an LZ4 element.  The
+     chunk is compressed with the fastest of them whose sample is at most
+     'percent' percent larger than the smallest one.  The coder and its
+     parameters are kept in the compression header of the chunk, which
+     is how every reader decodes it.
+
+     A negative 'percent' turns the policy off, which is the default, and
+     new chunks are compressed with the coder of the element.  A 'percent'
+     of 0 picks the coder that compresses the sample best.
+
+RETURNS
+     Returns SUCCEED if successful and FAIL otherwise
+
+-------------------------------------------------------------------------- */
+intn
+HMCsetCoderPolicy(int32 access_id, /* IN: access aid to mess with */
+                  intn  percent /* IN: size a faster coder may trail by, negative for none */)
+{
+    accrec_t    *access_rec = NULL; /* access record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    filerec_t   *locked     = NULL;
+    intn         ret_value  = SUCCEED;
+
+    locked = HL_LOCK_AID(access_id);
+
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* since this routine can be called by the user,
+       need to check if this access id is special CHUNKED */
+    if (access_rec->special == SPECIAL_CHUNKED) {
+        info = (chunkinfo_t *)(access_rec->special_info);
+
+        if (info != NULL)
+            info->coder_policy = percent < 0 ? -1 : percent;
+        else
+            ret_value = FAIL;
+    }
+    else /* not special */
+        ret_value = FAIL;
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* HMCsetCoderPolicy() */
+
+/* ------------------------------ HMCIwalk_written ----------------------------
+NAME
+   HMCIwalk_written -- visit every chunk of the element that was written
+
+DESCRIPTION
+   Calls 'func', if not NULL, with the chunk number and tag/ref of each
+   chunk that has a chunk table record, taken from the chunk records
+   accessed since the element was opened and, for the others, from the
+   chunk index read in by HMCIstaccess().  Neither is decoded nor read.
+
+RETURNS
+   The number of chunks visited, FAIL if 'func' failed
+--------------------------------------------------------------------------- */
+static int32
+HMCIwalk_written(chunkinfo_t *info, /* IN: chunked element information record */
+                 intn (*func)(chunkinfo_t *info, int32 chunk_num, uint16 chk_tag, uint16 chk_ref,
+                              void *arg), /* IN: called for each chunk */
+                 void *arg /* IN: passed on to 'func' */)
+{
+    TBBT_NODE *node;      /* chunk record in the TBBT */
+    int32      count = 0; /* chunks visited */
+    int32      i, j;
+
+    /* chunks accessed since the element was opened, these records are
+       newer than the index entries of the same chunks */
+    for (i = 0; i < info->npages; i++) {
+        if (info->chk_pages[i] == NULL)
+            continue;
+        for (j = 0; j < _HDF_CHK_PAGE_RECS; j++) {
+            CHUNK_REC *chk_rec = &info->chk_pages[i][j];
+
+            if (chk_rec->chk_tag == 0 || chk_rec->chk_tag == DFTAG_NULL)
+                continue;
+            if (func != NULL &&
+                func(info, chk_rec->chunk_number, chk_rec->chk_tag, chk_rec->chk_ref, arg) == FAIL)
+                return FAIL;
+            count++;
+        }
+    }
+    for (node = tbbtfirst((TBBT_NODE *)*info->chk_tree); node != NULL; node = tbbtnext(node)) {
+        CHUNK_REC *chk_rec = (CHUNK_REC *)node->data;
+
+        if (chk_rec->chk_tag == DFTAG_NULL)
+            continue;
+        if (func != NULL && func(info, chk_rec->chunk_number, chk_rec->chk_tag, chk_rec->chk_ref, arg) == FAIL)
+            return FAIL;
+        count++;
+    }
+
+    /* then the other chunks in the file; like HMCIfind_chunk() only the
+       first entry of a chunk number counts */
+    for (i = 0; i < info->nindex; i++) {
+        chunk_index_t *idx = &info->chk_index[i];
+
+        if (idx->chk_tag == DFTAG_NULL || (i > 0 && idx[-1].chunk_number == idx->chunk_number) ||
+            HMCIlookup_chunk(info, idx->chunk_number) != NULL)
+            continue;
+        if (func != NULL && func(info, idx->chunk_number, idx->chk_tag, idx->chk_ref, arg) == FAIL)
+            return FAIL;
+        count++;
+    }
+
+    return count;
+} /* HMCIwalk_written() */
+
+/* Sets the bit of a written chunk in the map of HMCgetChunkMap() */
+static intn
+HMCImap_chunk(chunkinfo_t *info, int32 chunk_num, uint16 chk_tag, uint16 chk_ref, void *arg)
+{
+    uint8 *map = (uint8 *)arg;
+
+    (void)info;
+    (void)chk_tag;
+    (void)chk_ref;
+
+    map[chunk_num / 8] |= (uint8)(1 << (chunk_num % 8));
+    return SUCCEED;
+} /* HMCImap_chunk() */
+
+/* Adds the compressed length of a written chunk to info->comp_bytes */
+static intn
+HMCIsum_chunk(chunkinfo_t *info, int32 chunk_num, uint16 chk_tag, uint16 chk_ref, void *arg)
+{
+    int32 file_id = *(int32 *)arg;
+    int32 len;
+
+    (void)chunk_num;
+
+    if ((len = HMCIcomp_length(file_id, chk_tag, chk_ref)) == FAIL)
+        return FAIL;
+    info->comp_bytes += len;
+    return SUCCEED;
+} /* HMCIsum_chunk() */
+
+/* ------------------------------- HMCIsync_chunks -----------------------------
+NAME
+   HMCIsync_chunks -- get the element to the state of the chunk table
+
+DESCRIPTION
+   Writes out the chunks held in the chunk cache or the write-behind
+   queue, if the file is open for writing, so that the chunk table
+   records of the element are up to date.
+
+RETURNS
+   The chunked element information record, NULL on error
+--------------------------------------------------------------------------- */
+static chunkinfo_t *
+HMCIsync_chunks(accrec_t *access_rec /* IN: access record of the element */)
+{
+    filerec_t   *file_rec = NULL; /* file record */
+    chunkinfo_t *info     = NULL; /* chunked element information record */
+
+    /* validate file records */
+    file_rec = HAatom_object(access_rec->file_id);
+    if (BADFREC(file_rec))
+        return NULL;
+
+    if (access_rec->special != SPECIAL_CHUNKED || access_rec->special_info == NULL)
+        return NULL;
+    info = (chunkinfo_t *)(access_rec->special_info);
+
+    if (file_rec->access & DFACC_WRITE) {
+        if (mcache_sync(info->chk_cache) == RET_ERROR)
+            return NULL;
+        if (HMCIflush_pending(access_rec) == FAIL)
+            return NULL;
+    }
+
+    return info;
+} /* HMCIsync_chunks() */
+
+/* ------------------------------- HMCgetChunkMap ------------------------------
+NAME
+     HMCgetChunkMap - get the map of the chunks written
+
+DESCRIPTION
+     Fills in 'map', if not NULL, with one bit per chunk of the element,
+     set for each chunk that was written to the file.  The bit of chunk
+     number n, counting the chunks in the same order as the data, with
+     the last dimension changing fastest, is bit (n % 8) of map[n / 8].
+     'map' must have room for (nchunks + 7) / 8 bytes.  The number of
+     chunks of the element is returned in 'nchunks' if it is not NULL.
+
+     The map is made from the chunk table read in when the element was
+     opened, with the chunks written since, so no chunk is read.  Chunks
+     that are cached or waiting to be written are flushed to the file
+     first.  Chunks that were never written read as fill values.
+
+RETURNS
+     The number of chunks written if successful and FAIL otherwise
+--------------------------------------------------------------------------- */
+int32
+HMCgetChunkMap(int32  access_id, /* IN: access aid to mess with */
+               uint8 *map,       /* OUT: one bit per chunk, set if written */
+               int32 *nchunks /* OUT: number of chunks of the element */)
+{
+    accrec_t    *access_rec = NULL; /* access record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    int32        total      = 1;    /* number of chunks of the element */
+    int32        i;
+    filerec_t   *locked    = NULL;
+    int32        ret_value = SUCCEED;
+
+    locked = HL_LOCK_AID(access_id);
+
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* since this routine can be called by the user,
+       need to check if this access id is special CHUNKED */
+    if ((info = HMCIsync_chunks(access_rec)) == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    for (i = 0; i < info->ndims; i++)
+        total *= info->ddims[i].num_chunks;
+    if (nchunks != NULL)
+        *nchunks = total;
+
+    if (map != NULL)
+        memset(map, 0, (size_t)(total + 7) / 8);
+    ret_value = HMCIwalk_written(info, map != NULL ? HMCImap_chunk : NULL, map);
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* HMCgetChunkMap() */
+
+/* ------------------------------ HMCIstats_entry ------------------------------
+NAME
+   HMCIstats_entry -- get the statistics entry of a chunk
+
+DESCRIPTION
+   Returns the entry of 'info->stats' for the chunk, growing the table
+   with entries of statistics not known as needed.
+
+RETURNS
+   The entry or NULL if out of memory
+--------------------------------------------------------------------------- */
+static chunk_stats_t *
+HMCIstats_entry(chunkinfo_t *info, /* IN: chunked element information record */
+                int32        chunk_num /* IN: chunk number */)
+{
+    if (chunk_num >= info->stats_max) {
+        int32          new_max = MAX(chunk_num + 1, 2 * info->stats_max);
+        chunk_stats_t *new_stats;
+        int32          i;
+
+        if ((new_stats = realloc(info->stats, (size_t)new_max * sizeof(chunk_stats_t))) == NULL)
+            return NULL;
+        for (i = info->stats_max; i < new_max; i++) {
+            new_stats[i].min   = 0.0;
+            new_stats[i].max   = 0.0;
+            new_stats[i].count = -1;
+        }
+        info->stats     = new_stats;
+        info->stats_max = new_max;
+    }
+    if (chunk_num >= info->nstats)
+        info->nstats = chunk_num + 1;
+
+    return &info->stats[chunk_num];
+} /* HMCIstats_entry() */
+
+/* Returns the native value at 'p' of number type 'nt' as a float64 */
+static float64
+HMCIstats_value(int32 nt, const uint8 *p)
+{
+    switch (nt & DFNT_MASK) {
+        case DFNT_CHAR8:
+        case DFNT_UCHAR8:
+        case DFNT_UINT8:
+            return (float64)(*p);
+        case DFNT_INT8:
+            return (float64)(*(const int8 *)p);
+        case DFNT_INT16: {
+            int16 v;
+            memcpy(&v, p, sizeof(v));
+            return (float64)v;
+        }
+        case DFNT_UINT16: {
+            uint16 v;
+            memcpy(&v, p, sizeof(v));
+            return (float64)v;
+        }
+        case DFNT_INT32: {
+            int32 v;
+            memcpy(&v, p, sizeof(v));
+            return (float64)v;
+        }
+        case DFNT_UINT32: {
+            uint32 v;
+            memcpy(&v, p, sizeof(v));
+            return (float64)v;
+        }
+        case DFNT_FLOAT32: {
+            float32 v;
+            memcpy(&v, p, sizeof(v));
+            return (float64)v;
+        }
+        default: {
+            float64 v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+    }
+} /* HMCIstats_value() */
+
+/* ------------------------------ HMCIchunk_stats ------------------------------
+NAME
+   HMCIchunk_stats -- compute the statistics of a chunk
+
+DESCRIPTION
+   Sets the least and greatest value and the number of values of a
+   chunk, in the file number type, that are neither the fill value nor
+   NaN.  The values are converted to the native type a batch at a time.
+
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+static intn
+HMCIchunk_stats(chunkinfo_t *info,      /* IN: chunked element information record */
+                int32        chunk_num, /* IN: chunk number */
+                const void  *datap /* IN: chunk data */)
+{
+    const uint8   *p         = (const uint8 *)datap;
+    uint8          values[_HDF_CHK_STATS_BATCH * sizeof(float64)]; /* values converted */
+    int32          nat_size  = DFKNTsize(info->stats_nt | DFNT_NATIVE);
+    int32          left      = info->chunk_size;
+    intn           skip_fill = (info->fill_val_len == info->nt_size);
+    chunk_stats_t *st;
+    float64        v;
+    int32          n, i;
+
+    if ((st = HMCIstats_entry(info, chunk_num)) == NULL)
+        return FAIL;
+    info->stats_dirty = TRUE;
+    st->min           = 0.0;
+    st->max           = 0.0;
+    st->count         = 0;
+
+    if (HMCIall_fill(info, datap))
+        return SUCCEED;
+
+    for (; left > 0; left -= n, p += n * info->nt_size) {
+        n = MIN(left, _HDF_CHK_STATS_BATCH);
+        if (DFKconvert((void *)p, values, info->stats_nt, n, DFACC_READ, 0, 0) == FAIL)
+            return FAIL;
+        for (i = 0; i < n; i++) {
+            if (skip_fill && memcmp(p + i * info->nt_size, info->fill_val, (size_t)info->nt_size) == 0)
+                continue;
+            v = HMCIstats_value(info->stats_nt, values + i * nat_size);
+            if (v != v) /* NaN */
+                continue;
+            if (st->count == 0 || v < st->min)
+                st->min = v;
+            if (st->count == 0 || v > st->max)
+                st->max = v;
+            st->count++;
+        }
+    }
+
+    return SUCCEED;
+} /* HMCIchunk_stats() */
+
+/* ------------------------------ HMCIload_stats -------------------------------
+NAME
+   HMCIload_stats -- read in the statistics of the chunks
+
+DESCRIPTION
+   Looks for the Vdata of the statistics of the chunks of the element,
+   named after the chunk table, and reads it into 'info->stats'.  It
+   holds a record per chunk number up to the last chunk with statistics,
+   and the number type of the values in an attribute.  Without such a
+   Vdata no statistics are kept.
+
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+static intn
+HMCIload_stats(accrec_t *access_rec /* IN: access record of the element */)
+{
+    chunkinfo_t   *info = (chunkinfo_t *)(access_rec->special_info);
+    char           name[VSNAMELENMAX + 1]; /* Vdata name */
+    int32          vs   = FAIL;            /* Vdata of the statistics */
+    int32          ref;                    /* its ref */
+    int32          nrecs;                  /* its number of records */
+    int32          nt   = 0;               /* number type of the values */
+    int32          idx;
+    uint8         *recs = NULL, *p;
+    chunk_stats_t *st;
+    int32          i;
+    intn           ret_value = SUCCEED;
+
+    info->stats_looked = TRUE;
+
+    sprintf(name, "%s%d_%d", _HDF_CHK_STATS_NAME, info->chktbl_tag, info->chktbl_ref);
+    if ((ref = VSfind(access_rec->file_id, name)) == 0)
+        HGOTO_DONE(SUCCEED);
+
+    if ((vs = VSattach(access_rec->file_id, ref, "r")) == FAIL)
+        HGOTO_ERROR(DFE_CANTATTACH, FAIL);
+    if ((idx = VSfindattr(vs, _HDF_VDATA, _HDF_CHK_STATS_NT)) == FAIL ||
+        VSgetattr(vs, _HDF_VDATA, idx, &nt) == FAIL)
+        HGOTO_ERROR(DFE_CANTGETATTR, FAIL);
+    if ((nrecs = VSelts(vs)) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    if (nrecs > 0) {
+        if (VSsetfields(vs, _HDF_CHK_STATS_FIELDS) == FAIL)
+            HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+        if ((recs = (uint8 *)malloc((size_t)nrecs * _HDF_CHK_STATS_REC)) == NULL ||
+            HMCIstats_entry(info, nrecs - 1) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if (VSread(vs, recs, nrecs, FULL_INTERLACE) != nrecs)
+            HGOTO_ERROR(DFE_VSREAD, FAIL);
+
+        for (i = 0, p = recs, st = info->stats; i < nrecs; i++, st++) {
+            memcpy(&st->min, p, sizeof(float64));
+            p += sizeof(float64);
+            memcpy(&st->max, p, sizeof(float64));
+            p += sizeof(float64);
+            memcpy(&st->count, p, sizeof(int32));
+            p += sizeof(int32);
+        }
+    }
+
+    info->stats_ref = (uint16)ref;
+    info->stats_nt  = nt;
+
+done:
+    if (vs != FAIL)
+        VSdetach(vs);
+    free(recs);
+    return ret_value;
+} /* HMCIload_stats() */
+
+/* ------------------------------ HMCIflush_stats ------------------------------
+NAME
+   HMCIflush_stats -- write out the statistics of the chunks
+
+DESCRIPTION
+   Writes 'info->stats' over the records of the Vdata of the statistics
+   of the chunks, creating the Vdata the first time, see
+   HMCIload_stats().
+
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+static intn
+HMCIflush_stats(accrec_t *access_rec /* IN: access record of the element */)
+{
+    chunkinfo_t   *info = (chunkinfo_t *)(access_rec->special_info);
+    char           name[VSNAMELENMAX + 1]; /* Vdata name */
+    int32          vs   = FAIL;            /* Vdata of the statistics */
+    uint8         *recs = NULL, *p;
+    chunk_stats_t *st;
+    int32          i;
+    intn           ret_value = SUCCEED;
+
+    if (info->stats_nt == 0 || !info->stats_dirty)
+        HGOTO_DONE(SUCCEED);
+
+    if (info->stats_ref == 0) {
+        if ((vs = VSattach(access_rec->file_id, -1, "w")) == FAIL)
+            HGOTO_ERROR(DFE_CANTATTACH, FAIL);
+        if (VSfdefine(vs, "min", DFNT_FLOAT64, 1) == FAIL || VSfdefine(vs, "max", DFNT_FLOAT64, 1) == FAIL ||
+            VSfdefine(vs, "count", DFNT_INT32, 1) == FAIL)
+            HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+        sprintf(name, "%s%d_%d", _HDF_CHK_STATS_NAME, info->chktbl_tag, info->chktbl_ref);
+        if (VSsetname(vs, name) == FAIL || VSsetclass(vs, _HDF_CHK_STATS_CLASS) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        if (VSsetattr(vs, _HDF_VDATA, _HDF_CHK_STATS_NT, DFNT_INT32, 1, &info->stats_nt) == FAIL)
+            HGOTO_ERROR(DFE_CANTSETATTR, FAIL);
+        info->stats_ref = (uint16)VSQueryref(vs);
+    }
+    else {
+        if ((vs = VSattach(access_rec->file_id, (int32)info->stats_ref, "w")) == FAIL)
+            HGOTO_ERROR(DFE_CANTATTACH, FAIL);
+        if (VSelts(vs) > 0 && VSseek(vs, 0) == FAIL)
+            HGOTO_ERROR(DFE_BADSEEK, FAIL);
+    }
+    if (VSsetfields(vs, _HDF_CHK_STATS_FIELDS) == FAIL)
+        HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+
+    if (info->nstats > 0) {
+        if ((recs = (uint8 *)malloc((size_t)info->nstats * _HDF_CHK_STATS_REC)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        for (i = 0, p = recs, st = info->stats; i < info->nstats; i++, st++) {
+            memcpy(p, &st->min, sizeof(float64));
+            p += sizeof(float64);
+            memcpy(p, &st->max, sizeof(float64));
+            p += sizeof(float64);
+            memcpy(p, &st->count, sizeof(int32));
+            p += sizeof(int32);
+        }
+        if (VSwrite(vs, recs, info->nstats, FULL_INTERLACE) != info->nstats)
+            HGOTO_ERROR(DFE_VSWRITE, FAIL);
+    }
+    info->stats_dirty = FALSE;
+
+done:
+    if (vs != FAIL && VSdetach(vs) == FAIL)
+        ret_value = FAIL;
+    free(recs);
+    return ret_value;
+} /* HMCIflush_stats() */
+
+/* -------------------------------- HMCsetStats -------------------------------
+NAME
+     HMCsetStats - keep statistics of the chunks of an element
+
+DESCRIPTION
+     From now on, each chunk written to the element gets its statistics:
+     the least and greatest of its values and their number, the fill
+     value and NaNs left out, for values of number type 'nt', the number
+     type of the element in the file.  They are stored with the chunk
+     table, in a Vdata of their own written when the element is closed,
+     and kept up to date from then on whenever the element is written.
+     HMCqueryChunks() then finds the chunks that may hold values in a
+     range without reading any.
+
+     The chunks written before the statistics were turned on have no
+     statistics, nor do chunks written with HMCwriteChunkRaw() to a
+     compressed element; these are taken as holding values of any range.
+     Calling it again with the same number type does nothing.
+
+RETURNS
+     Returns SUCCEED if successful and FAIL otherwise
+-------------------------------------------------------------------------- */
+intn
+HMCsetStats(int32 access_id, /* IN: access aid to mess with */
+            int32 nt /* IN: number type of the values in the file */)
+{
+    accrec_t    *access_rec = NULL; /* access record */
+    filerec_t   *file_rec   = NULL; /* file record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    filerec_t   *locked     = NULL;
+    intn         ret_value  = SUCCEED;
+
+    locked = HL_LOCK_AID(access_id);
+
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL || access_rec->special != SPECIAL_CHUNKED ||
+        (info = (chunkinfo_t *)(access_rec->special_info)) == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    file_rec = HAatom_object(access_rec->file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (!(file_rec->access & DFACC_WRITE))
+        HGOTO_ERROR(DFE_DENIED, FAIL);
+
+    /* only the number types converted by HMCIstats_value() */
+    switch (nt & DFNT_MASK) {
+        case DFNT_CHAR8:
+        case DFNT_UCHAR8:
+        case DFNT_INT8:
+        case DFNT_UINT8:
+        case DFNT_INT16:
+        case DFNT_UINT16:
+        case DFNT_INT32:
+        case DFNT_UINT32:
+        case DFNT_FLOAT32:
+        case DFNT_FLOAT64:
+            break;
+        default:
+            HGOTO_ERROR(DFE_BADNUMTYPE, FAIL);
+    }
+    if (DFKNTsize(nt) != info->nt_size)
+        HGOTO_ERROR(DFE_BADNUMTYPE, FAIL);
+
+    if (!info->stats_looked && HMCIload_stats(access_rec) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (info->stats_nt != 0) {
+        if (info->stats_nt != nt)
+            HGOTO_ERROR(DFE_BADNUMTYPE, FAIL);
+        HGOTO_DONE(SUCCEED);
+    }
+
+    info->stats_nt    = nt;
+    info->stats_dirty = TRUE;
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* HMCsetStats() */
+
+/* ------------------------------ HMCgetChunkStats -----------------------------
+NAME
+     HMCgetChunkStats - get the statistics of a chunk
+
+DESCRIPTION
+     Returns the least and greatest value of the chunk at 'origin' in
+     'min' and 'max' and their number in 'count', see HMCsetStats().
+     'count' is 0 for a chunk of only fill values, including a chunk
+     never written, and -1 when the statistics of the chunk are not
+     known, in which case 'min' and 'max' are not set.  Chunks that are
+     cached or waiting to be written are flushed to the file first.
+
+RETURNS
+     Returns SUCCEED if successful and FAIL otherwise, also when the
+     element keeps no statistics
+-------------------------------------------------------------------------- */
+intn
+HMCgetChunkStats(int32    access_id, /* IN: access aid to mess with */
+                 int32   *origin,    /* IN: origin of the chunk */
+                 float64 *min,       /* OUT: least value */
+                 float64 *max,       /* OUT: greatest value */
+                 int32   *count /* OUT: number of values, -1 if not known */)
+{
+    accrec_t    *access_rec = NULL; /* access record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    int32        chunk_num  = -1;   /* chunk number */
+    int32        i;
+    filerec_t   *locked    = NULL;
+    intn         ret_value = SUCCEED;
+
+    locked = HL_LOCK_AID(access_id);
+
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL || origin == NULL || min == NULL || max == NULL || count == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if ((info = HMCIsync_chunks(access_rec)) == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (!info->stats_looked && HMCIload_stats(access_rec) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (info->stats_nt == 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    for (i = 0; i < info->ndims; i++)
+        if (origin[i] < 0 || origin[i] >= info->ddims[i].num_chunks)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+    calculate_chunk_num(&chunk_num, info->ndims, origin, info->ddims);
+
+    if (chunk_num < info->nstats && info->stats[chunk_num].count >= 0) {
+        *min   = info->stats[chunk_num].min;
+        *max   = info->stats[chunk_num].max;
+        *count = info->stats[chunk_num].count;
+    }
+    else
+        *count = HMCIunwritten(info, chunk_num) ? 0 : -1;
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* HMCgetChunkStats() */
+
+/* ------------------------------- HMCqueryChunks ------------------------------
+NAME
+     HMCqueryChunks - find the chunks that may hold values in a range
+
+DESCRIPTION
+     Finds the chunks written whose values, other than the fill value,
+     may lie between 'lo' and 'hi' included, i.e. those whose statistics
+     range meets [lo, hi] and those whose statistics are not known, see
+     HMCsetStats().  The origins of the first 'maxchunks' of them, in
+     chunk number order, are returned in 'origins', 'ndims' values each.
+     No chunk is read: only the statistics and the chunk table kept in
+     memory are looked at, after the chunks that are cached or waiting
+     to be written were flushed to the file.
+
+RETURNS
+     The number of chunks found, which can be more than 'maxchunks', if
+     successful and FAIL otherwise, also when the element keeps no
+     statistics
+-------------------------------------------------------------------------- */
+int32
+HMCqueryChunks(int32   access_id, /* IN: access aid to mess with */
+               float64 lo,        /* IN: least value looked for */
+               float64 hi,        /* IN: greatest value looked for */
+               int32   maxchunks, /* IN: number of origins 'origins' has room for */
+               int32  *origins /* OUT: origins of the chunks found */)
+{
+    accrec_t    *access_rec = NULL; /* access record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    uint8       *map        = NULL; /* one bit per chunk, set if written */
+    int32        total      = 1;    /* number of chunks of the element */
+    int32        nfound     = 0;    /* chunks found */
+    int32        num, n, i;
+    filerec_t   *locked    = NULL;
+    int32        ret_value = SUCCEED;
+
+    locked = HL_LOCK_AID(access_id);
+
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL || maxchunks < 0 || (maxchunks > 0 && origins == NULL))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if ((info = HMCIsync_chunks(access_rec)) == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (!info->stats_looked && HMCIload_stats(access_rec) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (info->stats_nt == 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* the chunks never written hold only fill values */
+    for (i = 0; i < info->ndims; i++)
+        total *= info->ddims[i].num_chunks;
+    if ((map = (uint8 *)calloc((size_t)(total + 7) / 8, 1)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if (HMCIwalk_written(info, HMCImap_chunk, map) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    for (num = 0; num < total; num++) {
+        if (!(map[num / 8] & (1 << (num % 8))))
+            continue;
+        if (num < info->nstats && info->stats[num].count >= 0 &&
+            (info->stats[num].count == 0 || info->stats[num].max < lo || info->stats[num].min > hi))
+            continue;
+
+        /* the origin of the chunk, i.e. the reverse of calculate_chunk_num() */
+        if (nfound < maxchunks) {
+            int32 *origin = origins + (size_t)nfound * (size_t)info->ndims;
+
+            n = num;
+            for (i = info->ndims - 1; i > 0; i--) {
+                origin[i] = n % info->ddims[i].num_chunks;
+                n /= info->ddims[i].num_chunks;
+            }
+            origin[0] = n;
+        }
+        nfound++;
+    }
+
+    ret_value = nfound;
+
+done:
+    free(map);
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* HMCqueryChunks() */
+
+/* ---------------------------- HMCIcrc32c_table ----------------------------
+   CRC-32C (Castagnoli) of each byte value, reflected polynomial 0x82f63b78,
+   for the processors without CRC-32C instructions
+--------------------------------------------------------------------------- */
+static const uint32 HMCIcrc32c_table[256] = {
+    0x00000000, 0xf26b8303, 0xe13b70f7, 0x1350f3f4, 0xc79a971f, 0x35f1141c,
+    0x26a1e7e8, 0xd4ca64eb, 0x8ad958cf, 0x78b2dbcc, 0x6be22838, 0x9989ab3b,
+    0x4d43cfd0, 0xbf284cd3, 0xac78bf27, 0x5e133c24, 0x105ec76f, 0xe235446c,
+    0xf165b798, 0x030e349b, 0xd7c45070, 0x25afd373, 0x36ff2087, 0xc494a384,
+    0x9a879fa0, 0x68ec1ca3, 0x7bbcef57, 0x89d76c54, 0x5d1d08bf, 0xaf768bbc,
+    0xbc267848, 0x4e4dfb4b, 0x20bd8ede, 0xd2d60ddd, 0xc186fe29, 0x33ed7d2a,
+    0xe72719c1, 0x154c9ac2, 0x061c6936, 0xf477ea35, 0xaa64d611, 0x580f5512,
+    0x4b5fa6e6, 0xb93425e5, 0x6dfe410e, 0x9f95c20d, 0x8cc531f9, 0x7eaeb2fa,
+    0x30e349b1, 0xc288cab2, 0xd1d83946, 0x23b3ba45, 0xf779deae, 0x05125dad,
+    0x1642ae59, 0xe4292d5a, 0xba3a117e, 0x4851927d, 0x5b016189, 0xa96ae28a,
+    0x7da08661, 0x8fcb0562, 0x9c9bf696, 0x6ef07595, 0x417b1dbc, 0xb3109ebf,
+    0xa0406d4b, 0x522bee48, 0x86e18aa3, 0x748a09a0, 0x67dafa54, 0x95b17957,
+    0xcba24573, 0x39c9c670, 0x2a993584, 0xd8f2b687, 0x0c38d26c, 0xfe53516f,
+    0xed03a29b, 0x1f682198, 0x5125dad3, 0xa34e59d0, 0xb01eaa24, 0x42752927,
+    0x96bf4dcc, 0x64d4cecf, 0x77843d3b, 0x85efbe38, 0xdbfc821c, 0x2997011f,
+    0x3ac7f2eb, 0xc8ac71e8, 0x1c661503, 0xee0d9600, 0xfd5d65f4, 0x0f36e6f7,
+    0x61c69362, 0x93ad1061, 0x80fde395, 0x72966096, 0xa65c047d, 0x5437877e,
+    0x4767748a, 0xb50cf789, 0xeb1fcbad, 0x197448ae, 0x0a24bb5a, 0xf84f3859,
+    0x2c855cb2, 0xdeeedfb1, 0xcdbe2c45, 0x3fd5af46, 0x7198540d, 0x83f3d70e,
+    0x90a324fa, 0x62c8a7f9, 0xb602c312, 0x44694011, 0x5739b3e5, 0xa55230e6,
+    0xfb410cc2, 0x092a8fc1, 0x1a7a7c35, 0xe811ff36, 0x3cdb9bdd, 0xceb018de,
+    0xdde0eb2a, 0x2f8b6829, 0x82f63b78, 0x709db87b, 0x63cd4b8f, 0x91a6c88c,
+    0x456cac67, 0xb7072f64, 0xa457dc90, 0x563c5f93, 0x082f63b7, 0xfa44e0b4,
+    0xe9141340, 0x1b7f9043, 0xcfb5f4a8, 0x3dde77ab, 0x2e8e845f, 0xdce5075c,
+    0x92a8fc17, 0x60c37f14, 0x73938ce0, 0x81f80fe3, 0x55326b08, 0xa759e80b,
+    0xb4091bff, 0x466298fc, 0x1871a4d8, 0xea1a27db, 0xf94ad42f, 0x0b21572c,
+    0xdfeb33c7, 0x2d80b0c4, 0x3ed04330, 0xccbbc033, 0xa24bb5a6, 0x502036a5,
+    0x4370c551, 0xb11b4652, 0x65d122b9, 0x97baa1ba, 0x84ea524e, 0x7681d14d,
+    0x2892ed69, 0xdaf96e6a, 0xc9a99d9e, 0x3bc21e9d, 0xef087a76, 0x1d63f975,
+    0x0e330a81, 0xfc588982, 0xb21572c9, 0x407ef1ca, 0x532e023e, 0xa145813d,
+    0x758fe5d6, 0x87e466d5, 0x94b49521, 0x66df1622, 0x38cc2a06, 0xcaa7a905,
+    0xd9f75af1, 0x2b9cd9f2, 0xff56bd19, 0x0d3d3e1a, 0x1e6dcdee, 0xec064eed,
+    0xc38d26c4, 0x31e6a5c7, 0x22b65633, 0xd0ddd530, 0x0417b1db, 0xf67c32d8,
+    0xe52cc12c, 0x1747422f, 0x49547e0b, 0xbb3ffd08, 0xa86f0efc, 0x5a048dff,
+    0x8ecee914, 0x7ca56a17, 0x6ff599e3, 0x9d9e1ae0, 0xd3d3e1ab, 0x21b862a8,
+    0x32e8915c, 0xc083125f, 0x144976b4, 0xe622f5b7, 0xf5720643, 0x07198540,
+    0x590ab964, 0xab613a67, 0xb831c993, 0x4a5a4a90, 0x9e902e7b, 0x6cfbad78,
+    0x7fab5e8c, 0x8dc0dd8f, 0xe330a81a, 0x115b2b19, 0x020bd8ed, 0xf0605bee,
+    0x24aa3f05, 0xd6c1bc06, 0xc5914ff2, 0x37faccf1, 0x69e9f0d5, 0x9b8273d6,
+    0x88d28022, 0x7ab90321, 0xae7367ca, 0x5c18e4c9, 0x4f48173d, 0xbd23943e,
+    0xf36e6f75, 0x0105ec76, 0x12551f82, 0xe03e9c81, 0x34f4f86a, 0xc69f7b69,
+    0xd5cf889d, 0x27a40b9e, 0x79b737ba, 0x8bdcb4b9, 0x988c474d, 0x6ae7c44e,
+    0xbe2da0a5, 0x4c4623a6, 0x5f16d052, 0xad7d5351
+};
+
+#ifdef HMC_CRC32C_X86
+/* Updates 'crc' with 'len' bytes at 'p' with the SSE4.2 CRC-32C instructions */
+__attribute__((target("sse4.2"))) static uint32
+HMCIcrc32c_sse42(uint32 crc, const uint8 *p, size_t len)
+{
+#ifdef __x86_64__
+    unsigned long long w;
+
+    for (; len >= 8; len -= 8, p += 8) {
+        memcpy(&w, p, sizeof(w));
+        crc = (uint32)_mm_crc32_u64(crc, w);
+    }
+#endif
+    for (; len > 0; len--, p++)
+        crc = _mm_crc32_u8(crc, *p);
+    return crc;
+}
+
+static intn HMCcrc32c_sse42   = FALSE; /* whether the processor has SSE4.2 */
+static intn HMCcrc32c_checked = FALSE; /* whether HMCcrc32c_sse42 was set */
+#endif /* HMC_CRC32C_X86 */
+
+/* -------------------------------- HMCIcrc32c --------------------------------
+NAME
+   HMCIcrc32c -- CRC-32C of a buffer
+
+DESCRIPTION
+   Computes the CRC-32C (Castagnoli) of 'len' bytes, as iSCSI and ext4
+   do, with the CRC-32C instructions of SSE4.2 when the processor has
+   them, of ARMv8 when the library is built for them, and a table lookup
+   a byte at a time otherwise.  Safe to call from worker threads.
+
+RETURNS
+   The CRC-32C
+--------------------------------------------------------------------------- */
+static uint32
+HMCIcrc32c(const void *buf, /* IN: bytes to checksum */
+           int32       len /* IN: number of bytes */)
+{
+    const uint8 *p   = (const uint8 *)buf;
+    size_t       n   = (size_t)len;
+    uint32       crc = 0xffffffff;
+
+#if defined HMC_CRC32C_X86
+    if (!HMCcrc32c_checked) {
+        __builtin_cpu_init();
+        HMCcrc32c_sse42   = __builtin_cpu_supports("sse4.2") ? TRUE : FALSE;
+        HMCcrc32c_checked = TRUE;
+    }
+    if (HMCcrc32c_sse42)
+        return ~HMCIcrc32c_sse42(crc, p, n);
+#elif defined HMC_CRC32C_ARM
+    for (; n >= 8; n -= 8, p += 8) {
+        uint64_t w;
+
+        memcpy(&w, p, sizeof(w));
+        crc = __crc32cd(crc, w);
+    }
+    for (; n > 0; n--, p++)
+        crc = __crc32cb(crc, *p);
+    return ~crc;
+#endif
+    for (; n > 0; n--, p++)
+        crc = HMCIcrc32c_table[(crc ^ *p) & 0xff] ^ (crc >> 8);
+    return ~crc;
+} /* HMCIcrc32c() */
+
+/* ------------------------------- HMCIsums_entry ------------------------------
+NAME
+   HMCIsums_entry -- get the checksums entry of a chunk
+
+DESCRIPTION
+   Returns the entry of 'info->sums' for the chunk, growing the table
+   with entries of no checksums known as needed.
+
+RETURNS
+   The entry or NULL if out of memory
+--------------------------------------------------------------------------- */
+static chunk_sums_t *
+HMCIsums_entry(chunkinfo_t *info, /* IN: chunked element information record */
+               int32        chunk_num /* IN: chunk number */)
+{
+    if (chunk_num >= info->sums_max) {
+        int32         new_max = MAX(chunk_num + 1, 2 * info->sums_max);
+        chunk_sums_t *new_sums;
+
+        if ((new_sums = realloc(info->sums, (size_t)new_max * sizeof(chunk_sums_t))) == NULL)
+            return NULL;
+        memset(new_sums + info->sums_max, 0, (size_t)(new_max - info->sums_max) * sizeof(chunk_sums_t));
+        info->sums     = new_sums;
+        info->sums_max = new_max;
+    }
+    if (chunk_num >= info->nsums)
+        info->nsums = chunk_num + 1;
+
+    return &info->sums[chunk_num];
+} /* HMCIsums_entry() */
+
+/* ------------------------------ HMCIchunk_sums -------------------------------
+NAME
+   HMCIchunk_sums -- set the checksums of a chunk being written
+
+DESCRIPTION
+   Sets the CRC-32C of the 'len' bytes at 'datap', the chunk decoded if
+   'stored' is FALSE and as stored in the file otherwise.  When the
+   decoded chunk changes the one of the stored data is no longer known;
+   it is set by the caller when it has it in memory, by
+   HMCIfill_stored() from the file otherwise.  For an element that is
+   not compressed both are the same.
+
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+static intn
+HMCIchunk_sums(chunkinfo_t *info,      /* IN: chunked element information record */
+               int32        chunk_num, /* IN: chunk number */
+               const void  *datap,     /* IN: data of the chunk */
+               int32        len,       /* IN: length of the data */
+               intn         stored /* IN: TRUE if the data is as stored */)
+{
+    chunk_sums_t *cs;
+
+    if ((cs = HMCIsums_entry(info, chunk_num)) == NULL)
+        return FAIL;
+    info->sums_dirty = TRUE;
+
+    if (stored) {
+        cs->stored = HMCIcrc32c(datap, len);
+        cs->known |= HDF_CHKSUM_STORED;
+    }
+    else {
+        cs->raw   = HMCIcrc32c(datap, len);
+        cs->known = HDF_CHKSUM_RAW;
+        if ((info->flag & 0xff) != SPECIAL_COMP) {
+            cs->stored = cs->raw;
+            cs->known |= HDF_CHKSUM_STORED;
+        }
+    }
+
+    return SUCCEED;
+} /* HMCIchunk_sums() */
+
+/* ------------------------------ HMCIload_sums -------------------------------
+NAME
+   HMCIload_sums -- read in the checksums of the chunks
+
+DESCRIPTION
+   Looks for the Vdata of the checksums of the chunks of the element,
+   named after the chunk table, and reads it into 'info->sums'.  It
+   holds a record per chunk number up to the last chunk with checksums.
+   Without such a Vdata no checksums are kept.
+
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+static intn
+HMCIload_sums(accrec_t *access_rec /* IN: access record of the element */)
+{
+    chunkinfo_t  *info = (chunkinfo_t *)(access_rec->special_info);
+    char          name[VSNAMELENMAX + 1]; /* Vdata name */
+    int32         vs   = FAIL;            /* Vdata of the checksums */
+    int32         ref;                    /* its ref */
+    int32         nrecs;                  /* its number of records */
+    uint8        *recs = NULL, *p;
+    chunk_sums_t *cs;
+    int32         i;
+    intn          ret_value = SUCCEED;
+
+    info->sums_looked = TRUE;
+
+    sprintf(name, "%s%d_%d", _HDF_CHK_SUMS_NAME, info->chktbl_tag, info->chktbl_ref);
+    if ((ref = VSfind(access_rec->file_id, name)) == 0)
+        HGOTO_DONE(SUCCEED);
+
+    if ((vs = VSattach(access_rec->file_id, ref, "r")) == FAIL)
+        HGOTO_ERROR(DFE_CANTATTACH, FAIL);
+    if ((nrecs = VSelts(vs)) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    if (nrecs > 0) {
+        if (VSsetfields(vs, _HDF_CHK_SUMS_FIELDS) == FAIL)
+            HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+        if ((recs = (uint8 *)malloc((size_t)nrecs * _HDF_CHK_SUMS_REC)) == NULL ||
+            HMCIsums_entry(info, nrecs - 1) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if (VSread(vs, recs, nrecs, FULL_INTERLACE) != nrecs)
+            HGOTO_ERROR(DFE_VSREAD, FAIL);
+
+        for (i = 0, p = recs, cs = info->sums; i < nrecs; i++, cs++) {
+            memcpy(&cs->raw, p, sizeof(uint32));
+            p += sizeof(uint32);
+            memcpy(&cs->stored, p, sizeof(uint32));
+            p += sizeof(uint32);
+            memcpy(&cs->known, p, sizeof(int32));
+            p += sizeof(int32);
+        }
+    }
+
+    info->sums_ref = (uint16)ref;
+    info->sums_on  = TRUE;
+
+done:
+    if (vs != FAIL)
+        VSdetach(vs);
+    free(recs);
+    return ret_value;
+} /* HMCIload_sums() */
+
+/* ----------------------------- HMCIfill_stored ------------------------------
+NAME
+   HMCIfill_stored -- set the checksums of the stored data of the chunks
+
+DESCRIPTION
+   Reads back from the file the stored data of the chunks written whose
+   checksum of the decoded data is known but not the one of the stored
+   data, see HMCIchunk_sums(), i.e. chunks compressed as they were
+   written and chunks sharing the data of others.  They are read as
+   stored, nothing is decoded.
+
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+static intn
+HMCIfill_stored(accrec_t *access_rec /* IN: access record of the element */)
+{
+    chunkinfo_t  *info    = (chunkinfo_t *)(access_rec->special_info);
+    CHUNK_REC    *chk_rec = NULL; /* chunk record */
+    uint8        *buf     = NULL; /* stored data of a chunk */
+    int32         buf_len = 0;    /* allocated length of 'buf' */
+    int32         len;            /* length of the stored data */
+    chunk_sums_t *cs;
+    int32         num;
+    intn          ret_value = SUCCEED;
+
+    for (num = 0, cs = info->sums; num < info->nsums; num++, cs++) {
+        if (cs->known != HDF_CHKSUM_RAW)
+            continue;
+        if (HMCIfind_chunk(info, num, &chk_rec) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        if (chk_rec == NULL || chk_rec->chk_tag == DFTAG_NULL)
+            continue; /* left unwritten, see HMCsetSparse() */
+
+        if ((len = HMCIread_stored(access_rec, chk_rec, NULL, 0)) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        if (len > buf_len) {
+            free(buf);
+            if ((buf = (uint8 *)malloc((size_t)len)) == NULL)
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+            buf_len = len;
+        }
+        if (HMCIread_stored(access_rec, chk_rec, buf, buf_len) != len)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        if (HMCIchunk_sums(info, num, buf, len, TRUE) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    }
+
+done:
+    free(buf);
+    return ret_value;
+} /* HMCIfill_stored() */
+
+/* ------------------------------ HMCIflush_sums -------------------------------
+NAME
+   HMCIflush_sums -- write out the checksums of the chunks
+
+DESCRIPTION
+   Writes 'info->sums' over the records of the Vdata of the checksums
+   of the chunks, creating the Vdata the first time, see
+   HMCIload_sums().  The checksums of the stored data not known yet are
+   set first, see HMCIfill_stored().
+
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+static intn
+HMCIflush_sums(accrec_t *access_rec /* IN: access record of the element */)
+{
+    chunkinfo_t  *info = (chunkinfo_t *)(access_rec->special_info);
+    char          name[VSNAMELENMAX + 1]; /* Vdata name */
+    int32         vs   = FAIL;            /* Vdata of the checksums */
+    uint8        *recs = NULL, *p;
+    chunk_sums_t *cs;
+    int32         i;
+    intn          ret_value = SUCCEED;
+
+    if (!info->sums_on || !info->sums_dirty)
+        HGOTO_DONE(SUCCEED);
+    if (HMCIfill_stored(access_rec) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    if (info->sums_ref == 0) {
+        if ((vs = VSattach(access_rec->file_id, -1, "w")) == FAIL)
+            HGOTO_ERROR(DFE_CANTATTACH, FAIL);
+        if (VSfdefine(vs, "raw", DFNT_UINT32, 1) == FAIL || VSfdefine(vs, "stored", DFNT_UINT32, 1) == FAIL ||
+            VSfdefine(vs, "known", DFNT_INT32, 1) == FAIL)
+            HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+        sprintf(name, "%s%d_%d", _HDF_CHK_SUMS_NAME, info->chktbl_tag, info->chktbl_ref);
+        if (VSsetname(vs, name) == FAIL || VSsetclass(vs, _HDF_CHK_SUMS_CLASS) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        info->sums_ref = (uint16)VSQueryref(vs);
+    }
+    else {
+        if ((vs = VSattach(access_rec->file_id, (int32)info->sums_ref, "w")) == FAIL)
+            HGOTO_ERROR(DFE_CANTATTACH, FAIL);
+        if (VSelts(vs) > 0 && VSseek(vs, 0) == FAIL)
+            HGOTO_ERROR(DFE_BADSEEK, FAIL);
+    }
+    if (VSsetfields(vs, _HDF_CHK_SUMS_FIELDS) == FAIL)
+        HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+
+    if (info->nsums > 0) {
+        if ((recs = (uint8 *)malloc((size_t)info->nsums * _HDF_CHK_SUMS_REC)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        for (i = 0, p = recs, cs = info->sums; i < info->nsums; i++, cs++) {
+            memcpy(p, &cs->raw, sizeof(uint32));
+            p += sizeof(uint32);
+            memcpy(p, &cs->stored, sizeof(uint32));
+            p += sizeof(uint32);
+            memcpy(p, &cs->known, sizeof(int32));
+            p += sizeof(int32);
+        }
+        if (VSwrite(vs, recs, info->nsums, FULL_INTERLACE) != info->nsums)
+            HGOTO_ERROR(DFE_VSWRITE, FAIL);
+    }
+    info->sums_dirty = FALSE;
+
+done:
+    if (vs != FAIL && VSdetach(vs) == FAIL)
+        ret_value = FAIL;
+    free(recs);
+    return ret_value;
+} /* HMCIflush_sums() */
+
+/* ------------------------------ HMCsetChecksums ------------------------------
+NAME
+     HMCsetChecksums - keep checksums of the chunks of an element
+
+DESCRIPTION
+     From now on, each chunk written to the element gets two CRC-32C
+     checksums: of its data decoded and of its data as stored in the
+     file, i.e. compressed if the element is.  They are stored with the
+     chunk table, in a Vdata of their own written when the element is
+     closed, and kept up to date from then on whenever the element is
+     written.  HMCgetChunkChecksum() returns them, so that chunks can be
+     verified or compared, even across files, without decoding them.
+
+     The checksum of the decoded data is computed as a chunk leaves the
+     chunk cache; the one of the stored data as the chunk is compressed
+     in memory, or else by reading the chunk back as stored when the
+     element is closed.  Chunks written before the checksums were
+     turned on have none, and chunks written with HMCwriteChunkRaw() to
+     a compressed element only the one of the stored data.  Calling it
+     again does nothing.
+
+RETURNS
+     Returns SUCCEED if successful and FAIL otherwise
+-------------------------------------------------------------------------- */
+intn
+HMCsetChecksums(int32 access_id /* IN: access aid to mess with */)
+{
+    accrec_t    *access_rec = NULL; /* access record */
+    filerec_t   *file_rec   = NULL; /* file record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    filerec_t   *locked     = NULL;
+    intn         ret_value  = SUCCEED;
+
+    locked = HL_LOCK_AID(access_id);
+
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL || access_rec->special != SPECIAL_CHUNKED ||
+        (info = (chunkinfo_t *)(access_rec->special_info)) == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    file_rec = HAatom_object(access_rec->file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (!(file_rec->access & DFACC_WRITE))
+        HGOTO_ERROR(DFE_DENIED, FAIL);
+
+    if (!info->sums_looked && HMCIload_sums(access_rec) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (info->sums_on)
+        HGOTO_DONE(SUCCEED);
+
+    info->sums_on    = TRUE;
+    info->sums_dirty = TRUE;
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* HMCsetChecksums() */
+
+/* ---------------------------- HMCgetChunkChecksum ----------------------------
+NAME
+     HMCgetChunkChecksum - get the checksums of a chunk
+
+DESCRIPTION
+     Returns the CRC-32C of the data of the chunk at 'origin' decoded in
+     'raw_crc' and as stored in the file in 'stored_crc', see
+     HMCsetChecksums().  Only those known are set: the value returned
+     tells which.  Chunks that are cached or waiting to be written are
+     flushed to the file first.
+
+RETURNS
+     Returns HDF_CHKSUM_RAW, HDF_CHKSUM_STORED or both or'ed for the
+     checksums known, 0 for none, e.g. for a chunk never written, if
+     successful and FAIL otherwise, also when the element keeps no
+     checksums
+-------------------------------------------------------------------------- */
+intn
+HMCgetChunkChecksum(int32   access_id,  /* IN: access aid to mess with */
+                    int32  *origin,     /* IN: origin of the chunk */
+                    uint32 *raw_crc,    /* OUT: CRC-32C of the decoded data */
+                    uint32 *stored_crc /* OUT: CRC-32C of the data as stored */)
+{
+    accrec_t     *access_rec = NULL; /* access record */
+    chunkinfo_t  *info       = NULL; /* chunked element information record */
+    chunk_sums_t *cs         = NULL; /* checksums of the chunk */
+    int32         chunk_num  = -1;   /* chunk number */
+    int32         i;
+    filerec_t    *locked    = NULL;
+    intn          ret_value = 0;
+
+    locked = HL_LOCK_AID(access_id);
+
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL || origin == NULL || raw_crc == NULL || stored_crc == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if ((info = HMCIsync_chunks(access_rec)) == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (!info->sums_looked && HMCIload_sums(access_rec) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (!info->sums_on)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    for (i = 0; i < info->ndims; i++)
+        if (origin[i] < 0 || origin[i] >= info->ddims[i].num_chunks)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+    calculate_chunk_num(&chunk_num, info->ndims, origin, info->ddims);
+    if (chunk_num >= info->nsums)
+        HGOTO_DONE(0);
+
+    cs = &info->sums[chunk_num];
+    if (cs->known == HDF_CHKSUM_RAW && HMCIfill_stored(access_rec) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (cs->known & HDF_CHKSUM_RAW)
+        *raw_crc = cs->raw;
+    if (cs->known & HDF_CHKSUM_STORED)
+        *stored_crc = cs->stored;
+    ret_value = (intn)cs->known;
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* HMCgetChunkChecksum() */
+
+/* Adds a written chunk and the offset of its data to the list of HMCnextChunk() */
+static intn
+HMCIplace_chunk(chunkinfo_t *info, int32 chunk_num, uint16 chk_tag, uint16 chk_ref, void *arg)
+{
+    chunk_places_t *list   = (chunk_places_t *)arg;
+    int32           offset = 0;
+    int32           length;
+
+    (void)info;
+
+    /* the chunk's data, which may be compressed or in linked blocks,
+       starts with its first block */
+    if (HDgetdatainfo(list->file_id, chk_tag, chk_ref, NULL, 0, 1, &offset, &length) == FAIL)
+        return FAIL;
+
+    list->places[list->nplaces].offset    = offset;
+    list->places[list->nplaces].chunk_num = chunk_num;
+    list->nplaces++;
+    return SUCCEED;
+} /* HMCIplace_chunk() */
+
+/* qsort() comparison of written chunks by the offset of their data */
+static int
+HMCIsort_chunks(const void *p1, const void *p2)
+{
+    const chunk_place_t *e1 = (const chunk_place_t *)p1;
+    const chunk_place_t *e2 = (const chunk_place_t *)p2;
+
+    if (e1->offset != e2->offset)
+        return (e1->offset > e2->offset) ? 1 : -1;
+    return (e1->chunk_num > e2->chunk_num) - (e1->chunk_num < e2->chunk_num);
+} /* HMCIsort_chunks() */
+
+/* -------------------------------- HMCnextChunk -------------------------------
+NAME
+     HMCnextChunk - get the next written chunk in storage order
+
+DESCRIPTION
+     Visits the chunks of the element that were written, in the order
+     their data is stored in the file, so that reading them one after
+     the other with HMCgetChunkPtr() or HMCreadChunk() moves forward in
+     the file.  '*cursor' is set to 0 to start, which also takes the
+     chunks written until then; each call returns the origin of the next
+     chunk in 'origin' and advances '*cursor'.  Chunks that are cached or
+     waiting to be written are flushed to the file first.
+
+RETURNS
+     1 if a chunk was returned, 0 when all chunks were visited and FAIL
+     on error
+--------------------------------------------------------------------------- */
+intn
+HMCnextChunk(int32  access_id, /* IN: access aid to mess with */
+             int32 *cursor,    /* IN/OUT: position of the visit, 0 to start */
+             int32 *origin /* OUT: origin of the next chunk */)
+{
+    accrec_t      *access_rec = NULL; /* access record */
+    chunkinfo_t   *info       = NULL; /* chunked element information record */
+    chunk_places_t list;              /* written chunks and their offsets */
+    int32          nwritten;          /* number of chunks written */
+    int32          num;               /* chunk number */
+    int32          i;
+    filerec_t     *locked    = NULL;
+    intn           ret_value = SUCCEED;
+
+    list.places = NULL;
+
+    locked = HL_LOCK_AID(access_id);
+
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL || cursor == NULL || origin == NULL || *cursor < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if ((info = HMCIsync_chunks(access_rec)) == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* (re)start: list the written chunks by the offset of their data */
+    if (*cursor == 0) {
+        free(info->order);
+        info->order  = NULL;
+        info->norder = 0;
+
+        if ((nwritten = HMCIwalk_written(info, NULL, NULL)) > 0) {
+            list.file_id = access_rec->file_id;
+            list.nplaces = 0;
+            if ((list.places = (chunk_place_t *)malloc((size_t)nwritten * sizeof(chunk_place_t))) == NULL)
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+            if ((info->order = (int32 *)malloc((size_t)nwritten * sizeof(int32))) == NULL)
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+            if (HMCIwalk_written(info, HMCIplace_chunk, &list) == FAIL)
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+            qsort(list.places, (size_t)nwritten, sizeof(chunk_place_t), HMCIsort_chunks);
+
+            for (i = 0; i < nwritten; i++)
+                info->order[i] = list.places[i].chunk_num;
+            info->norder = nwritten;
+        }
+    }
+
+    if (*cursor >= info->norder)
+        HGOTO_DONE(0);
+
+    /* the origin of the chunk, i.e. the reverse of calculate_chunk_num() */
+    num = info->order[(*cursor)++];
+    for (i = info->ndims - 1; i > 0; i--) {
+        origin[i] = num % info->ddims[i].num_chunks;
+        num /= info->ddims[i].num_chunks;
+    }
+    origin[0] = num;
+    ret_value = 1;
+
+done:
+    if (ret_value == FAIL && info != NULL) {
+        free(info->order);
+        info->order  = NULL;
+        info->norder = 0;
+    }
+    free(list.places);
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* HMCnextChunk() */
+
+/* ------------------------------ HMCgetChunkSizes -----------------------------
+NAME
+     HMCgetChunkSizes - get data sizes of an open chunked element
+
+DESCRIPTION
+     Does what HMCgetdatasize() does for an element that is open, from
+     the chunk table kept in memory.  The uncompressed size takes the
+     number of chunk table records only.  The compressed size is summed
+     once over the compression headers of the chunks and kept until the
+     next chunk is written, so that it takes no I/O to get again.
+     Either of 'comp_size' and 'orig_size' can be NULL.
+
+RETURNS
+     Returns SUCCEED/FAIL
+--------------------------------------------------------------------------- */
+intn
+HMCgetChunkSizes(int32  access_id, /* IN: access aid to mess with */
+                 int32 *comp_size, /* OUT: size of compressed data */
+                 int32 *orig_size /* OUT: size of non-compressed data */)
+{
+    accrec_t    *access_rec = NULL; /* access record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    int32        data_size;         /* total size of the chunks written */
+    filerec_t   *locked    = NULL;
+    intn         ret_value = SUCCEED;
+
+    locked = HL_LOCK_AID(access_id);
+
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if ((info = HMCIsync_chunks(access_rec)) == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    data_size = info->chunk_size * info->nt_size * info->num_recs;
+    if (orig_size != NULL)
+        *orig_size = data_size;
+
+    if (comp_size != NULL) {
+        if ((info->flag & 0xff) != SPECIAL_COMP)
+            *comp_size = data_size;
+        else {
+            if (info->comp_bytes < 0) {
+                info->comp_bytes = 0;
+                if (HMCIwalk_written(info, HMCIsum_chunk, &access_rec->file_id) == FAIL) {
+                    info->comp_bytes = -1;
+                    HGOTO_ERROR(DFE_COMPINFO, FAIL);
+                }
+            }
+            *comp_size = info->comp_bytes;
+        }
+    }
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* HMCgetChunkSizes() */
+
+/* ------------------------------ HMCsetCacheBudget --------------------------
+NAME
+     HMCsetCacheBudget - byte budget of the shared chunk cache pool
+
+DESCRIPTION
+     Sets the number of bytes that the chunk caches which joined the
+     shared pool, by passing HDF_CACHE_SHARED to HMCsetMaxcache(), may
+     hold together, across all open elements and files.  The default is
+     64 MB.  A lower budget is reached as the caches bring in new chunks.
+
+RETURNS
+     Returns the previous budget if successful and FAIL otherwise
+
+-------------------------------------------------------------------------- */
+int32
+HMCsetCacheBudget(int32 nbytes /* IN: bytes shared by the pooled caches */)
+{
+    int32 ret_value = SUCCEED;
+
+    if (nbytes < 1)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    ret_value = mcache_set_pool_budget(nbytes);
+
+done:
+    return ret_value;
+} /* HMCsetCacheBudget() */
+
+#ifdef HMC_DISK_CACHE
+/* ------------------------------- HMCIdisk_name ------------------------------
+NAME
+   HMCIdisk_name -- name of a chunk in the local chunk cache
+
+DESCRIPTION
+   Names the file of the local chunk cache holding the compressed chunk
+   stored from 'offset' in a file, 'raw_len' bytes long.  The file is
+   identified by a hash of its name and length, and the chunk by its offset
+   and length, so a chunk written again elsewhere, or a file replaced by
+   one of another length, is not mistaken for the one kept.  Only the chunks
+   of files opened read-only through a driver other than "core" and
+   "memory" are kept.
+
+RETURNS
+   The name, to be freed by the caller, or NULL when the chunk is not kept
+--------------------------------------------------------------------------- */
+static char *
+HMCIdisk_name(filerec_t *file_rec, /* IN: file record */
+              int32      offset,   /* IN: file offset of the chunk's first block */
+              int32      raw_len /* IN: length of the compressed chunk */)
+{
+    char       *dir = NULL; /* copy of the directory */
+    const char *p;
+    uint32      id;   /* hash of the name and length of the file */
+    int32       size; /* length of the file */
+    size_t      len;
+    char       *ret_value = NULL;
+
+    if (file_rec->access != DFACC_READ || file_rec->drv == NULL || file_rec->drv == &HP_driver_core ||
+        file_rec->drv == &HP_driver_memory)
+        return NULL;
+
+    HL_LOCK_LIBRARY();
+    if (disk_dir != NULL)
+        dir = strdup(disk_dir);
+    HL_UNLOCK_LIBRARY();
+    if (dir == NULL || (size = HPfile_size(file_rec)) == FAIL)
+        HGOTO_DONE(NULL);
+
+    for (id = (uint32)size, p = file_rec->path; *p != '\0'; p++)
+        id = id * 1000003U ^ (uint32)(uint8)*p;
+
+    len = strlen(dir) + 3 * 8 + strlen(_HDF_CHK_DISK_SUFFIX) + 2;
+    if ((ret_value = (char *)malloc(len)) != NULL)
+        snprintf(ret_value, len, "%s/%08lx%08lx%08lx%s", dir, (unsigned long)id, (unsigned long)offset,
+                 (unsigned long)raw_len, _HDF_CHK_DISK_SUFFIX);
+
+done:
+    free(dir);
+    return ret_value;
+} /* HMCIdisk_name() */
+
+/* ------------------------------- HMCIdisk_get -------------------------------
+NAME
+   HMCIdisk_get -- read a compressed chunk from the local chunk cache
+
+DESCRIPTION
+   Reads the compressed chunk stored from 'offset' in the file from the
+   local chunk cache, if it is there, and marks it as just used.  Nothing
+   is pushed on the error stack, the caller reads the chunk from the file
+   when this fails.
+
+RETURNS
+   SUCCEED if the chunk was read, FAIL otherwise
+--------------------------------------------------------------------------- */
+static intn
+HMCIdisk_get(filerec_t *file_rec, /* IN: file record */
+             int32      offset,   /* IN: file offset of the chunk's first block */
+             uint8     *raw,      /* OUT: the compressed chunk */
+             int32      raw_len /* IN: length of the compressed chunk */)
+{
+    char  *name = NULL;            /* file holding the chunk */
+    char  *path = NULL;            /* name of the file it came from */
+    FILE  *fp   = NULL;            /* the file holding the chunk */
+    uint8  hdr[_HDF_CHK_DISK_HDR]; /* its header */
+    uint8 *p;                      /* pointer into the header */
+    uint32 len;                    /* length of the chunk held */
+    uint16 path_len;               /* length of the name held */
+    intn   ret_value = FAIL;
+
+    if ((name = HMCIdisk_name(file_rec, offset, raw_len)) == NULL)
+        HGOTO_DONE(FAIL);
+    if ((fp = fopen(name, "rb")) == NULL)
+        HGOTO_DONE(FAIL);
+
+    if (fread(hdr, 1, _HDF_CHK_DISK_HDR, fp) != _HDF_CHK_DISK_HDR ||
+        memcmp(hdr, _HDF_CHK_DISK_MAGIC, 4) != 0)
+        HGOTO_DONE(FAIL);
+    p = hdr + 4;
+    UINT32DECODE(p, len);
+    UINT16DECODE(p, path_len);
+    if (len != (uint32)raw_len || path_len != strlen(file_rec->path))
+        HGOTO_DONE(FAIL);
+
+    /* another file whose name and length hash the same? */
+    if ((path = (char *)malloc((size_t)path_len + 1)) == NULL ||
+        fread(path, 1, (size_t)path_len, fp) != (size_t)path_len ||
+        memcmp(path, file_rec->path, (size_t)path_len) != 0)
+        HGOTO_DONE(FAIL);
+    if (fread(raw, 1, (size_t)raw_len, fp) != (size_t)raw_len)
+        HGOTO_DONE(FAIL);
+
+    utime(name, NULL); /* its modification time orders the evictions */
+    ret_value = SUCCEED;
+
+done:
+    if (fp != NULL)
+        fclose(fp);
+    free(path);
+    free(name);
+    return ret_value;
+} /* HMCIdisk_get() */
+
+/* ----------------------------- HMCIdisk_compare -----------------------------
+NAME
+   HMCIdisk_compare -- compare two files of the local chunk cache
+
+DESCRIPTION
+   Orders the files of the local chunk cache by their last use, for
+   qsort().
+
+RETURNS
+   <0, 0 or >0 as the first file was used before, at the same time or
+   after the second one
+--------------------------------------------------------------------------- */
+static int
+HMCIdisk_compare(const void *p1, const void *p2)
+{
+    const chunk_disk_t *d1 = (const chunk_disk_t *)p1;
+    const chunk_disk_t *d2 = (const chunk_disk_t *)p2;
+
+    return (d1->mtime > d2->mtime) - (d1->mtime < d2->mtime);
+} /* HMCIdisk_compare() */
+
+/* ------------------------------- HMCIdisk_trim ------------------------------
+NAME
+   HMCIdisk_trim -- evict the least recently used chunks of the local cache
+
+DESCRIPTION
+   Counts the files of the local chunk cache and removes the least recently
+   used ones, by modification time, until the others take no more than
+   'target' KB.  The directory may be shared with other processes, whose
+   chunks are counted and evicted alike.
+
+RETURNS
+   None
+--------------------------------------------------------------------------- */
+static void
+HMCIdisk_trim(int32 target /* IN: KB the cache is to hold at most */)
+{
+    char          *dir   = NULL; /* copy of the directory */
+    chunk_disk_t  *files = NULL; /* the files of the cache */
+    chunk_disk_t  *p;            /* grown array */
+    int32          nfiles = 0;   /* number of entries in 'files' */
+    int32          max    = 0;   /* entries 'files' has room for */
+    int32          total  = 0;   /* KB the files take */
+    DIR           *dirp;
+    struct dirent *entry;
+    struct stat    sbuf;
+    size_t         name_len, len;
+    int32          i;
+
+    HL_LOCK_LIBRARY();
+    if (disk_dir != NULL)
+        dir = strdup(disk_dir);
+    HL_UNLOCK_LIBRARY();
+    if (dir == NULL || (dirp = opendir(dir)) == NULL) {
+        free(dir);
+        return;
+    }
+
+    while ((entry = readdir(dirp)) != NULL) {
+        name_len = strlen(entry->d_name);
+        if (name_len <= strlen(_HDF_CHK_DISK_SUFFIX) ||
+            strcmp(entry->d_name + name_len - strlen(_HDF_CHK_DISK_SUFFIX), _HDF_CHK_DISK_SUFFIX) != 0)
+            continue;
+
+        if (nfiles == max) {
+            max = MAX(2 * max, 64);
+            if ((p = (chunk_disk_t *)realloc(files, (size_t)max * sizeof(chunk_disk_t))) == NULL)
+                break;
+            files = p;
+        }
+        len = strlen(dir) + name_len + 2;
+        if ((files[nfiles].name = (char *)malloc(len)) == NULL)
+            break;
+        snprintf(files[nfiles].name, len, "%s/%s", dir, entry->d_name);
+        if (stat(files[nfiles].name, &sbuf) != 0) {
+            free(files[nfiles].name);
+            continue;
+        }
+        files[nfiles].mtime  = sbuf.st_mtime;
+        files[nfiles].kbytes = (int32)((sbuf.st_size + 1023) / 1024);
+        total += files[nfiles].kbytes;
+        nfiles++;
+    }
+    closedir(dirp);
+
+    if (total > target) {
+        qsort(files, (size_t)nfiles, sizeof(chunk_disk_t), HMCIdisk_compare);
+        for (i = 0; i < nfiles && total > target; i++)
+            if (remove(files[i].name) == 0)
+                total -= files[i].kbytes;
+    }
+
+    HL_LOCK_LIBRARY();
+    disk_used = total;
+    HL_UNLOCK_LIBRARY();
+
+    for (i = 0; i < nfiles; i++)
+        free(files[i].name);
+    free(files);
+    free(dir);
+} /* HMCIdisk_trim() */
+
+/* ------------------------------- HMCIdisk_put -------------------------------
+NAME
+   HMCIdisk_put -- keep a compressed chunk in the local chunk cache
+
+DESCRIPTION
+   Writes a compressed chunk just read from the file into the local chunk
+   cache, under a temporary name which is then renamed, so other processes
+   sharing the directory never read a partial chunk.  When the cache grows
+   past its size, the least recently used chunks are evicted down to 7/8 of
+   it.  Nothing is pushed on the error stack, a chunk not kept is read from
+   the file again.
+
+RETURNS
+   None
+--------------------------------------------------------------------------- */
+static void
+HMCIdisk_put(filerec_t   *file_rec, /* IN: file record */
+             int32        offset,   /* IN: file offset of the chunk's first block */
+             const uint8 *raw,      /* IN: the compressed chunk */
+             int32        raw_len /* IN: length of the compressed chunk */)
+{
+    char  *name = NULL;            /* file holding the chunk */
+    char  *tmp  = NULL;            /* its temporary name */
+    FILE  *fp   = NULL;            /* the file holding the chunk */
+    uint8  hdr[_HDF_CHK_DISK_HDR]; /* its header */
+    uint8 *p;                      /* pointer into the header */
+    size_t path_len = strlen(file_rec->path);
+    size_t len;
+    intn   written;
+    intn   trim;
+    int32  target = 0;
+
+    if (path_len > 65535 || (name = HMCIdisk_name(file_rec, offset, raw_len)) == NULL)
+        return;
+    len = strlen(name) + 22;
+    if ((tmp = (char *)malloc(len)) == NULL) {
+        free(name);
+        return;
+    }
+    snprintf(tmp, len, "%s.%ld", name, (long)getpid());
+
+    memcpy(hdr, _HDF_CHK_DISK_MAGIC, 4);
+    p = hdr + 4;
+    UINT32ENCODE(p, raw_len);
+    UINT16ENCODE(p, path_len);
+    if ((fp = fopen(tmp, "wb")) != NULL) {
+        written = fwrite(hdr, 1, _HDF_CHK_DISK_HDR, fp) == _HDF_CHK_DISK_HDR &&
+                  fwrite(file_rec->path, 1, path_len, fp) == path_len &&
+                  fwrite(raw, 1, (size_t)raw_len, fp) == (size_t)raw_len;
+        if (fclose(fp) != 0 || !written || rename(tmp, name) != 0)
+            remove(tmp);
+        else {
+            HL_LOCK_LIBRARY();
+            if (disk_used >= 0)
+                disk_used += (int32)((_HDF_CHK_DISK_HDR + path_len + (size_t)raw_len + 1023) / 1024);
+            trim   = disk_dir != NULL && (disk_used < 0 || disk_used > disk_max);
+            target = disk_max - disk_max / 8;
+            HL_UNLOCK_LIBRARY();
+            if (trim)
+                HMCIdisk_trim(target);
+        }
+    }
+
+    free(tmp);
+    free(name);
+} /* HMCIdisk_put() */
+#else
+#define HMCIdisk_get(file_rec, offset, raw, raw_len) FAIL
+#define HMCIdisk_put(file_rec, offset, raw, raw_len) ((void)0)
+#endif /* HMC_DISK_CACHE */
+
+/* ------------------------------ HMCsetDiskCache ----------------------------
+NAME
+     HMCsetDiskCache - keep the compressed chunks of remote files on local disk
+
+DESCRIPTION
+     Sets the directory of the local chunk cache, a second level below the
+     chunk caches of the elements.  The compressed chunks read from files
+     opened read-only through a driver other than "core" and "memory", such
+     as "http", are written to it as they are, and read from it instead of
+     the file by the next reads of these chunks, in this process or another
+     one, until evicted.  The cache holds at most 'max_kbytes' KB: when it
+     grows past it, the least recently used chunks are evicted.  Setting the
+     directory evicts at once down to the new size, emptying the cache for
+     a size of 0.  Only the chunks decoded whole in memory, those of the
+     deflate, LZ4, RLE, JPEG, SZIP and lossy coders and of the coder
+     plugins, are kept.  A NULL directory turns the cache off.
+
+RETURNS
+     SUCCEED if successful and FAIL otherwise; FAIL on Windows, where the
+     local chunk cache is not supported
+
+-------------------------------------------------------------------------- */
+intn
+HMCsetDiskCache(const char *dir, /* IN: directory of the cache, NULL for none */
+                int32 max_kbytes /* IN: KB the cache may hold */)
+{
+#ifdef HMC_DISK_CACHE
+    char *new_dir   = NULL;
+    intn  ret_value = SUCCEED;
+
+    if ((dir != NULL && *dir == '\0') || max_kbytes < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (dir != NULL && (new_dir = strdup(dir)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    HL_LOCK_LIBRARY();
+    free(disk_dir);
+    disk_dir  = new_dir;
+    disk_max  = max_kbytes;
+    disk_used = -1;
+    HL_UNLOCK_LIBRARY();
+
+    if (new_dir != NULL)
+        HMCIdisk_trim(max_kbytes);
+
+done:
+    return ret_value;
+#else
+    (void)dir;
+    (void)max_kbytes;
+    HRETURN_ERROR(DFE_UNSUPPORTED, FAIL);
+#endif /* HMC_DISK_CACHE */
+} /* HMCsetDiskCache() */
+
+/* ------------------------------ HMCPstread -------------------------------
+NAME
+   HMCPstread -- open an access record of chunked element for reading
+
+DESCRIPTION
+   Calls to HMCIstaccess to fill in the access rec for
+   reading
+
+RETURNS
+   The AID of the access record on success FAIL on error.
+AUTHOR
+   -GeorgeV - 9/3/96
+---------------------------------------------------------------------------*/
+static int32
+HMCPstread(accrec_t *access_rec /* IN: access record to fill in */)
+{
+    int32 ret_value;
+
+    ret_value = HMCIstaccess(access_rec, DFACC_READ);
+
+    return ret_value;
+} /* HMCPstread */
+
+/* ------------------------------ HMCPstwrite ------------------------------
+NAME
+   HMCPstwrite -- open an access record of a chunked element for writing
+
+DESCRIPTION
+   Calls to HMCIstaccess to fill in the access rec for
+   writing
+
+RETURNS
+   The AID of the access record on success FAIL on error.
+AUTHOR
+   -GeorgeV - 9/3/96
+---------------------------------------------------------------------------*/
+static int32
+HMCPstwrite(accrec_t *access_rec /* IN: access record to fill in */)
+{
+    int32 ret_value;
+
+    ret_value = HMCIstaccess(access_rec, DFACC_WRITE);
+
+    return ret_value;
+} /* HMCPstwrite */
+
+/* ------------------------------- HMCPseek --------------------------------
+NAME
+   HMCPseek -- set the seek posn in the chunked element
+
+DESCRIPTION
+   Set the seek posn in the given chunked element
+
+RETURNS
+   SUCCEED / FAIL
+AUTHOR
+   -GeorgeV - 9/3/96
+---------------------------------------------------------------------------*/
+static int32
+HMCPseek(accrec_t *access_rec, /* IN: access record to mess with */
+         int32     offset,     /* IN: seek offset */
+         int       origin /* IN: where we should calc the offset from */)
+{
+    chunkinfo_t *info      = NULL; /* information for the chunked elt */
+    int32        ret_value = SUCCEED;
+
+    /* Check args */
+    if (access_rec == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* validate access record */
+    if (access_rec->special != SPECIAL_CHUNKED)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* get special info */
+    info = (chunkinfo_t *)(access_rec->special_info);
+
+    /* adjust the offset according to origin and validate */
+    /* there is no upper bound to posn */
+    if (origin == DF_CURRENT)
+        offset += access_rec->posn;
+    if (origin == DF_END)
+        offset += (info->length * info->nt_size); /* adjust by number type size */
+    if (offset < 0)
+        HGOTO_ERROR(DFE_RANGE, FAIL);
+
+    /* Seek to given location(bytes) for reading/writing */
+    /* i.e calculate chunk indices given seek location
+       this will update the proper arrays in the special info struct */
+    update_chunk_indices_seek(offset, info->ndims, info->nt_size, info->seek_chunk_indices,
+                              info->seek_pos_chunk, info->ddims);
+
+    /* set position in access record */
+    access_rec->posn = offset;
+
+done:
+    return ret_value;
+} /* HMCPseek */
+
+/* --------------------------- HMCIfree_predecoded ---------------------------
+NAME
+   HMCIfree_predecoded -- release the chunks decoded by HMCIpredecode
+
+DESCRIPTION
+   Frees the chunks decoded ahead of a read.  Chunks that were paged into
+   the chunk cache are unaffected.
+
+RETURNS
+   Nothing
+--------------------------------------------------------------------------- */
+static void
+HMCIfree_predecoded(chunkinfo_t *info /* IN: chunked element information record */)
+{
+    int32 i;
+
+    if (info->predecoded != NULL) {
+        for (i = 0; i < info->npredecoded; i++) {
+            free(info->predecoded[i].raw);
+            HDlarge_free(info->predecoded[i].data, (size_t)info->predecoded[i].data_len);
+        }
+        free(info->predecoded);
+    }
+    info->predecoded  = NULL;
+    info->npredecoded = 0;
+} /* HMCIfree_predecoded() */
+
+/* --------------------------- HMCIfind_predecoded ---------------------------
+NAME
+   HMCIfind_predecoded -- look up a chunk decoded by HMCIpredecode
+
+RETURNS
+   The predecode record of the chunk or NULL if it has none
+--------------------------------------------------------------------------- */
+static chunk_coded_t *
+HMCIfind_predecoded(chunkinfo_t *info,     /* IN: chunked element information record */
+                    int32        chunk_num /* IN: chunk to look for */)
+{
+    int32 i;
+
+    for (i = 0; i < info->npredecoded; i++)
+        if (info->predecoded[i].chunk_num == chunk_num)
+            return &info->predecoded[i];
+
+    return NULL;
+} /* HMCIfind_predecoded() */
+
+/* ---------------------------- HMCIfind_pending -----------------------------
+NAME
+   HMCIfind_pending -- look up a chunk in the write-behind queue
+
+RETURNS
+   The queue entry of the chunk or NULL if it is not queued
+--------------------------------------------------------------------------- */
+static chunk_coded_t *
+HMCIfind_pending(chunkinfo_t *info,     /* IN: chunked element information record */
+                 int32        chunk_num /* IN: chunk to look for */)
+{
+    int32 i;
+
+    for (i = 0; i < info->npending; i++)
+        if (info->pending[i].chunk_num == chunk_num)
+            return &info->pending[i];
+
+    return NULL;
+} /* HMCIfind_pending() */
+
+/* ----------------------------- HMCIdirect_chunk -----------------------------
+NAME
+   HMCIdirect_chunk -- tell whether a read or write can take a whole
+                       chunk at once
+
+DESCRIPTION
+   The position is at the start of a chunk, the read or write has 'len'
+   bytes more, at least the whole chunk, and the chunk is laid out in
+   the element as it is in itself: its length is 1 along the dimensions
+   before some dimension and the whole dimension length along the ones
+   after it, and it is not cut short by the end of that dimension.  Such
+   a chunk can be read straight into the caller's buffer, or overwritten
+   without reading it in first.
+
+RETURNS
+   TRUE if the whole chunk is in the next 'len' bytes
+--------------------------------------------------------------------------- */
+static intn
+HMCIdirect_chunk(const chunkinfo_t *info, /* IN: chunked element information record */
+                 int32              len /* IN: bytes left to read or write */)
+{
+    int32 d, k;
+
+    if (len < info->chunk_size * info->nt_size)
+        return FALSE;
+    for (k = 0; k < info->ndims; k++)
+        if (info->seek_pos_chunk[k] != 0)
+            return FALSE;
+
+    for (d = 0; d < info->ndims - 1 && info->ddims[d].chunk_length == 1; d++)
+        ;
+    for (k = d + 1; k < info->ndims; k++)
+        if (info->ddims[k].chunk_length != info->ddims[k].dim_length)
+            return FALSE;
+
+    /* the last chunk along that dimension may be cut short by its end */
+    if (info->seek_chunk_indices[d] == info->ddims[d].num_chunks - 1 &&
+        info->ddims[d].last_chunk_length != info->ddims[d].chunk_length)
+        return FALSE;
+
+    return TRUE;
+} /* HMCIdirect_chunk() */
+
+/* ------------------------------ HMCIunwritten ------------------------------
+NAME
+   HMCIunwritten -- tell whether a chunk has never been written
+
+DESCRIPTION
+   A chunk that is neither in the chunk cache, nor in the write-behind
+   queue, nor in the file reads as fill values only.  Nothing is pushed
+   on the error stack; a chunk that cannot be looked up is reported as
+   written, for the generic path to fail on.
+
+RETURNS
+   TRUE if the chunk reads as fill values, FALSE otherwise
+--------------------------------------------------------------------------- */
+static intn
+HMCIunwritten(chunkinfo_t *info,     /* IN: chunked element information record */
+              int32        chunk_num /* IN: chunk to look for */)
+{
+    CHUNK_REC *chk_rec = NULL; /* chunk record */
+
+    if (mcache_is_cached(info->chk_cache, chunk_num + 1) || HMCIfind_pending(info, chunk_num) != NULL)
+        return FALSE;
+    if (HMCIfind_chunk(info, chunk_num, &chk_rec) == FAIL)
+        return FALSE;
+
+    return (chk_rec == NULL || chk_rec->chk_tag == DFTAG_NULL) ? TRUE : FALSE;
+} /* HMCIunwritten() */
+
+/* ------------------------------- HMCIall_fill -------------------------------
+NAME
+   HMCIall_fill -- tell whether a chunk holds only fill values
+
+DESCRIPTION
+   The chunk is all fill when its first value is the fill value and
+   every byte equals the one a fill value further on, which a single
+   memcmp() of the chunk against itself checks.
+
+RETURNS
+   TRUE if the chunk holds only fill values, FALSE otherwise
+--------------------------------------------------------------------------- */
+static intn
+HMCIall_fill(const chunkinfo_t *info, /* IN: chunked element information record */
+             const void        *datap /* IN: chunk data */)
+{
+    const uint8 *p   = (const uint8 *)datap;
+    int32        len = info->chunk_size * info->nt_size;
+
+    if (info->fill_val_len <= 0 || len % info->fill_val_len != 0)
+        return FALSE;
+
+    return (memcmp(p, info->fill_val, (size_t)info->fill_val_len) == 0 &&
+            memcmp(p, p + info->fill_val_len, (size_t)(len - info->fill_val_len)) == 0)
+               ? TRUE
+               : FALSE;
+} /* HMCIall_fill() */
+
+/* ---------------------------- HMCIstored_plain ----------------------------
+NAME
+   HMCIstored_plain -- tell whether a chunk of a compressed element is
+                       stored as it is
+
+DESCRIPTION
+   A chunk of a compressed element that did not compress well enough,
+   see HMCsetRawLimit(), is stored as an element that is not special.
+   Nothing is pushed on the error stack.
+
+RETURNS
+   TRUE if the chunk is stored as it is, FALSE otherwise or if it cannot
+   be looked up
+--------------------------------------------------------------------------- */
+static intn
+HMCIstored_plain(const chunkinfo_t *info,    /* IN: chunked element information record */
+                 int32              file_id, /* IN: file the chunk is in */
+                 uint16             chk_tag, /* IN: tag of the chunk */
+                 uint16             chk_ref /* IN: ref of the chunk */)
+{
+    filerec_t *file_rec; /* file record */
+    atom_t     ddid;     /* DD of the chunk */
+    intn       special;  /* whether the DD is special */
+
+    if ((info->flag & 0xff) != SPECIAL_COMP)
+        return FALSE;
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec) || (ddid = HTPselect(file_rec, chk_tag, chk_ref)) == FAIL)
+        return FALSE;
+    special = HTPis_special(ddid);
+    HTPendaccess(ddid);
+
+    return special == FALSE ? TRUE : FALSE;
+} /* HMCIstored_plain() */
+
+/* ---------------------------- HMCIdecode_buffer ----------------------------
+NAME
+   HMCIdecode_buffer -- decode a whole compressed chunk held in memory
+
+DESCRIPTION
+   Decodes the compressed data of a deflate, LZ4, RLE, JPEG, SZIP or lossy
+   compressed chunk with a single call of the coder.  Safe to call from worker threads: nothing
+   is pushed on the error stack.
+
+RETURNS
+   SUCCEED if the chunk decoded to exactly 'data_len' bytes, FAIL otherwise
+--------------------------------------------------------------------------- */
+static intn
+HMCIdecode_buffer(const chunkinfo_t *info,    /* IN: chunked element information record */
+                  const uint8       *raw,     /* IN: compressed chunk */
+                  int32              raw_len, /* IN: length of the compressed chunk */
+                  uint8             *data,    /* OUT: buffer for the chunk */
+                  int32              data_len /* IN: length of the decoded chunk */)
+{
+    /* a chunk of a deflate or LZ4 element may have been compressed with
+       the other of the two, see HMCsetCoderPolicy(); an LZ4 frame starts
+       with its magic number, which no zlib stream does */
+    if (info->comp_type == COMP_CODE_DEFLATE || info->comp_type == COMP_CODE_LZ4) {
+#ifdef H4_HAVE_LIBLZ4
+        if (raw_len >= 4 && raw[0] == 0x04 && raw[1] == 0x22 && raw[2] == 0x4D && raw[3] == 0x18)
+            return HCPclz4_decode_frame(raw, raw_len, data, data_len);
+#endif /* H4_HAVE_LIBLZ4 */
+        return HCPcdeflate_decode_buffer(raw, raw_len, data, data_len);
+    }
+    if (info->comp_type == COMP_CODE_RLE)
+        return HCPcrle_decode_buffer(raw, raw_len, data, data_len);
+    if (info->comp_type == COMP_CODE_JPEG)
+        return HCPcjpeg_decode_buffer(raw, raw_len, data, data_len);
+    if (info->comp_type == COMP_CODE_LOSSY)
+        return HCPclossy_decode_buffer(info->cinfo, raw, raw_len, data, data_len);
+#ifdef H4_HAVE_LIBSZ
+    if (info->comp_type == COMP_CODE_SZIP)
+        return HCPcszip_decode_buffer(info->cinfo, raw, raw_len, data, data_len);
+#endif /* H4_HAVE_LIBSZ */
+    if (info->comp_type >= COMP_CODE_PLUGIN_MIN)
+        return HCPcplugin_decode_buffer(info->comp_type, info->cinfo, raw, raw_len, data, data_len);
+    return FAIL;
+} /* HMCIdecode_buffer() */
+
+/* ----------------------------- HMCIwhole_coder -----------------------------
+NAME
+   HMCIwhole_coder -- can the chunks be coded whole in memory?
+
+DESCRIPTION
+   Whole chunks are decoded in memory for the deflate, LZ4, RLE, JPEG, SZIP
+   and lossy coders and the registered coder plugins only, and not for chunks
+   with shuffled bytes.  SZIP chunks
+   written before V4.2r1 lack the preamble HCPcszip_decode_buffer() needs,
+   as do chunks of an element created during this access, whose options
+   mask does not carry SZ_H4_REV_2 until it is read back from the file.
+
+RETURNS
+   TRUE if HMCIdecode_buffer() decodes the chunks of the element, FALSE
+   otherwise
+--------------------------------------------------------------------------- */
+static intn
+HMCIwhole_coder(const chunkinfo_t *info /* IN: chunked element information record */)
+{
+    if ((info->flag & 0xff) != SPECIAL_COMP || info->model_type != COMP_MODEL_STDIO)
+        return FALSE;
+#ifdef H4_HAVE_LIBLZ4
+    if (info->comp_type == COMP_CODE_LZ4)
+        return TRUE;
+#endif /* H4_HAVE_LIBLZ4 */
+#ifdef H4_HAVE_LIBSZ
+    if (info->comp_type == COMP_CODE_SZIP)
+        return (info->cinfo->szip.options_mask & SZ_H4_REV_2) ? TRUE : FALSE;
+#endif /* H4_HAVE_LIBSZ */
+    if (info->comp_type >= COMP_CODE_PLUGIN_MIN)
+        return HCPplugin_coder(info->comp_type) != NULL;
+    return info->comp_type == COMP_CODE_DEFLATE || info->comp_type == COMP_CODE_RLE ||
+           info->comp_type == COMP_CODE_JPEG || info->comp_type == COMP_CODE_LOSSY;
+} /* HMCIwhole_coder() */
+
+/* -------------------------- HMCIthreaded_decoder --------------------------
+NAME
+   HMCIthreaded_decoder -- can the chunks be decoded on worker threads?
+
+DESCRIPTION
+   The worker threads decode whole chunks in memory, see HMCIwhole_coder().
+   Chunks of JPEG images are the costliest to decode, and the tiles a read
+   touches are decoded side by side.
+
+RETURNS
+   TRUE if HMCIpredecode() handles the chunks of the element, FALSE
+   otherwise
+--------------------------------------------------------------------------- */
+static intn
+HMCIthreaded_decoder(const chunkinfo_t *info /* IN: chunked element information record */)
+{
+    /* RLE chunks decode about as fast as they are read */
+    return info->nthreads > 1 && HMCIwhole_coder(info) && info->comp_type != COMP_CODE_RLE;
+} /* HMCIthreaded_decoder() */
+
+/* --------------------------- HMCIthreaded_coder ---------------------------
+NAME
+   HMCIthreaded_coder -- can the chunks be coded on worker threads?
+
+DESCRIPTION
+   The worker threads encode whole chunks in memory with the deflate and
+   LZ4 coders, see HMCIencode_task().
+
+RETURNS
+   TRUE if the write-behind queue handles the chunks of the element, FALSE
+   otherwise
+--------------------------------------------------------------------------- */
+static intn
+HMCIthreaded_coder(const chunkinfo_t *info /* IN: chunked element information record */)
+{
+    /* RLE, JPEG and SZIP chunks are only decoded whole */
+    return HMCIthreaded_decoder(info) &&
+           (info->comp_type == COMP_CODE_DEFLATE || info->comp_type == COMP_CODE_LZ4);
+} /* HMCIthreaded_coder() */
+
+/* --------------------------- HMCIbatch_decoder ----------------------------
+NAME
+   HMCIbatch_decoder -- are the chunks of a read decoded together?
+
+DESCRIPTION
+   The chunks of a read are decoded together by HMCIpredecode() when they
+   are decoded on worker threads, see HMCIthreaded_decoder(), or by a
+   decode provider set with HCset_decode_provider() for their coder.
+
+RETURNS
+   TRUE if HMCIpredecode() handles the chunks of the element, FALSE
+   otherwise
+--------------------------------------------------------------------------- */
+static intn
+HMCIbatch_decoder(const chunkinfo_t *info /* IN: chunked element information record */)
+{
+    void *user_data;
+
+    if ((info->flag & 0xff) == SPECIAL_COMP && info->model_type == COMP_MODEL_STDIO &&
+        HCPget_decode_provider(info->comp_type, &user_data) != NULL)
+        return TRUE;
+    return HMCIthreaded_decoder(info);
+} /* HMCIbatch_decoder() */
+
+/* ----------------------------- HMCIdecode_task -----------------------------
+NAME
+   HMCIdecode_task -- decode one chunk read in by HMCIpredecode
+
+DESCRIPTION
+   Task routine for htpool_run().  It runs on a worker thread and
+   therefore only touches its own predecode record; failures are
+   reported through the record's status and not through the error stack.
+
+RETURNS
+   Nothing
+--------------------------------------------------------------------------- */
+static void
+HMCIdecode_task(void *arg, /* IN: chunked element information record */
+                int32 task /* IN: index of the record to decode */)
+{
+    chunkinfo_t   *info = (chunkinfo_t *)arg;
+    chunk_coded_t *pd   = &info->predecoded[task];
+
+    if (pd->status == SUCCEED) /* done by the decode provider */
+        return;
+    if (pd->raw == NULL || pd->data == NULL)
+        return;
+
+    pd->status = HMCIdecode_buffer(info, pd->raw, pd->raw_len, pd->data, pd->data_len);
+} /* HMCIdecode_task() */
+
+/* ------------------------------ HMCIpredecode ------------------------------
+NAME
+   HMCIpredecode -- decode the compressed chunks of a read ahead of time
+
+DESCRIPTION
+   Walks the next 'length' bytes of the element from position 'posn',
+   the same way HMCPread() does, and collects the distinct chunks which
+   are not in the chunk cache, up to _HDF_CHK_PREDECODE_PER_THREAD chunks
+   per decoding thread.  When 'chunks' is not NULL, they are taken from
+   the 'nchunks' chunk numbers it lists instead, in that order, see
+   HMCreadSlab().  The compressed data of these chunks is read
+   from the file on the calling thread, in a single HPread_batch() call,
+   and then decoded on the worker threads.  HMCPchunkread() copies a
+   chunk decoded here into the cache instead of reading and decoding it
+   again.
+
+   With a decode provider set for the coder of the element, at least
+   _HDF_CHK_PROVIDER_BATCH chunks are collected and handed to it first;
+   the worker threads, if any, decode those it left.
+
+   Any chunk that cannot be handled here (not written, or failing to
+   decode) is left to the serial path of HMCPchunkread(),
+   which reports errors as usual.  Chunks previously decoded are freed.
+
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+static intn
+HMCIpredecode(accrec_t    *access_rec, /* IN: access record of the element */
+              int32        posn,       /* IN: element position of the read */
+              int32        length,     /* IN: number of bytes left to read */
+              const int32 *chunks,     /* IN: chunks to decode instead, or NULL */
+              int32        nchunks /* IN: number of entries in 'chunks' */)
+{
+    chunkinfo_t        *info          = NULL; /* chunked element information record */
+    filerec_t          *file_rec      = NULL; /* file record */
+    chunk_coded_t      *pd            = NULL; /* predecode record */
+    CHUNK_REC          *chk_rec       = NULL; /* chunk record */
+    int32              *chunk_indices = NULL; /* chunk indices of the walk */
+    int32              *pos_chunk     = NULL; /* position in chunk of the walk */
+    int32              *offsets       = NULL; /* file offsets of a chunk's blocks */
+    int32              *lengths       = NULL; /* lengths of a chunk's blocks */
+    hfile_ext_t        *exts          = NULL; /* extents to read for all the chunks */
+    int32               n_ext         = 0;    /* number of extents in 'exts' */
+    int32               max_ext       = 0;    /* number of extents 'exts' has room for */
+    hdf_decode_func_t   provider      = NULL; /* decode provider of the coder */
+    void               *user_data     = NULL; /* its data */
+    const uint8       **raws          = NULL; /* chunks handed to the provider */
+    int32              *raw_lens      = NULL; /* their lengths */
+    uint8             **datas         = NULL; /* buffers for the decoded chunks */
+    intn               *statuses      = NULL; /* which ones the provider decoded */
+    int32               nprovided     = 0;    /* number of chunks handed to it */
+    int32               maxchunks;            /* number of chunks to decode ahead */
+    int32               bytes_walked  = 0;    /* bytes of the read walked so far */
+    int32               chunk_size    = 0;    /* contiguous bytes in the current chunk */
+    int32               chunk_num     = 0;    /* current chunk number */
+    int32               last_num      = -1;   /* last chunk number seen on the walk */
+    int32               raw_len;              /* total length of a chunk's blocks */
+    intn                nblocks;              /* number of blocks of a chunk */
+    intn                b;
+    int32               i;
+    intn                ret_value = SUCCEED;
+
+    /* set inputs */
+    info = (chunkinfo_t *)(access_rec->special_info);
+    HMCIfree_predecoded(info);
+
+    file_rec = HAatom_object(access_rec->file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    maxchunks = (int32)info->nthreads * _HDF_CHK_PREDECODE_PER_THREAD;
+    if ((info->flag & 0xff) == SPECIAL_COMP && info->model_type == COMP_MODEL_STDIO &&
+        (provider = HCPget_decode_provider(info->comp_type, &user_data)) != NULL)
+        maxchunks = MAX(maxchunks, _HDF_CHK_PROVIDER_BATCH);
+    if ((info->predecoded = (chunk_coded_t *)calloc((size_t)maxchunks, sizeof(chunk_coded_t))) ==
+        NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if ((chunk_indices = (int32 *)malloc((size_t)info->ndims * sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if ((pos_chunk = (int32 *)malloc((size_t)info->ndims * sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    /* the chunks listed that will have to be paged in */
+    for (i = 0; chunks != NULL && i < nchunks && info->npredecoded < maxchunks; i++)
+        if (!mcache_is_cached(info->chk_cache, chunks[i] + 1) &&
+            HMCIfind_predecoded(info, chunks[i]) == NULL && HMCIfind_pending(info, chunks[i]) == NULL) {
+            info->predecoded[info->npredecoded].chunk_num = chunks[i];
+            info->predecoded[info->npredecoded].status    = FAIL;
+            info->npredecoded++;
+        }
+
+    /* otherwise walk the rest of the read collecting the chunks that will
+       have to be paged in, without touching the seek arrays of the element */
+    update_chunk_indices_seek(posn, info->ndims, info->nt_size, chunk_indices, pos_chunk, info->ddims);
+    while (chunks == NULL && bytes_walked < length) {
+        calculate_chunk_num(&chunk_num, info->ndims, chunk_indices, info->ddims);
+        calculate_chunk_for_chunk(&chunk_size, info->ndims, info->nt_size, length, bytes_walked,
+                                  chunk_indices, pos_chunk, info->ddims);
+
+        if (chunk_num != last_num && !mcache_is_cached(info->chk_cache, chunk_num + 1) &&
+            HMCIfind_predecoded(info, chunk_num) == NULL && HMCIfind_pending(info, chunk_num) == NULL) {
+            if (info->npredecoded == maxchunks)
+                break;
+            info->predecoded[info->npredecoded].chunk_num = chunk_num;
+            info->predecoded[info->npredecoded].status    = FAIL;
+            info->npredecoded++;
+        }
+        last_num = chunk_num;
+
+        bytes_walked += chunk_size;
+        posn += chunk_size;
+        update_chunk_indices_seek(posn, info->ndims, info->nt_size, chunk_indices, pos_chunk, info->ddims);
+    } /* end while "bytes_walked" */
+
+    /* read the compressed data of the chunks that were written */
+    for (i = 0; i < info->npredecoded; i++) {
+        pd = &info->predecoded[i];
+
+        if (HMCIfind_chunk(info, pd->chunk_num, &chk_rec) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        if (chk_rec == NULL)
+            continue; /* chunk not written, it will be filled */
+        if (chk_rec->chk_tag == DFTAG_NULL || BASETAG(chk_rec->chk_tag) != DFTAG_CHUNK)
+            continue;
+        if (HMCIstored_plain(info, access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref))
+            continue; /* chunk stored as it is, it will be read */
+
+        nblocks = HDgetdatainfo(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref, NULL, 0, 0, NULL,
+                                NULL);
+        if (nblocks <= 0)
+            continue;
+
+        if ((offsets = (int32 *)malloc((size_t)nblocks * sizeof(int32))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if ((lengths = (int32 *)malloc((size_t)nblocks * sizeof(int32))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if (HDgetdatainfo(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref, NULL, 0, (uintn)nblocks,
+                          offsets, lengths) != nblocks)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+        for (raw_len = 0, b = 0; b < nblocks; b++)
+            raw_len += lengths[b];
+
+        pd->raw_len  = raw_len;
+        pd->data_len = info->chunk_size * info->nt_size;
+        if ((pd->raw = (uint8 *)malloc((size_t)raw_len)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if ((pd->data = (uint8 *)HDlarge_alloc((size_t)pd->data_len)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+        /* a chunk kept on local disk is not read from the file */
+        pd->disk_off = offsets[0];
+        if (HMCIdisk_get(file_rec, offsets[0], pd->raw, raw_len) == SUCCEED) {
+            pd->disk_off = -1;
+            nblocks      = 0;
+        }
+
+        /* queue the blocks for the read of all the chunks */
+        if (n_ext + nblocks > max_ext) {
+            hfile_ext_t *new_exts;
+
+            max_ext = MAX(2 * max_ext, n_ext + nblocks);
+            if ((new_exts = (hfile_ext_t *)realloc(exts, (size_t)max_ext * sizeof(hfile_ext_t))) == NULL)
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+            exts = new_exts;
+        }
+        for (raw_len = 0, b = 0; b < nblocks; b++) {
+            exts[n_ext].offset = offsets[b];
+            exts[n_ext].length = lengths[b];
+            exts[n_ext].buf    = pd->raw + raw_len;
+            n_ext++;
+            raw_len += lengths[b];
+        }
+
+        free(offsets);
+        free(lengths);
+        offsets = NULL;
+        lengths = NULL;
+    } /* end for "npredecoded" */
+
+    /* read the compressed data of all the chunks in one batch */
+    if (HPread_batch(file_rec, n_ext, exts) == FAIL)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
+    for (i = 0; i < info->npredecoded; i++) {
+        pd = &info->predecoded[i];
+        if (pd->raw != NULL && pd->disk_off >= 0)
+            HMCIdisk_put(file_rec, pd->disk_off, pd->raw, pd->raw_len);
+    }
+
+    HP_TRACE(HDF_TRACE_DECODE, FALSE, info->npredecoded * info->chunk_size * info->nt_size);
+
+    /* hand the chunks read to the decode provider */
+    if (provider != NULL) {
+        if ((raws = (const uint8 **)malloc((size_t)info->npredecoded * sizeof(uint8 *))) == NULL ||
+            (raw_lens = (int32 *)malloc((size_t)info->npredecoded * sizeof(int32))) == NULL ||
+            (datas = (uint8 **)malloc((size_t)info->npredecoded * sizeof(uint8 *))) == NULL ||
+            (statuses = (intn *)malloc((size_t)info->npredecoded * sizeof(intn))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        for (i = 0; i < info->npredecoded; i++) {
+            pd = &info->predecoded[i];
+            if (pd->raw == NULL || pd->data == NULL)
+                continue;
+            raws[nprovided]     = pd->raw;
+            raw_lens[nprovided] = pd->raw_len;
+            datas[nprovided]    = pd->data;
+            statuses[nprovided] = FAIL;
+            nprovided++;
+        }
+        if (nprovided > 0 && (*provider)(info->comp_type, info->cinfo, nprovided, raws, raw_lens, datas,
+                                         info->chunk_size * info->nt_size, statuses, user_data) == SUCCEED)
+            for (nprovided = 0, i = 0; i < info->npredecoded; i++) {
+                pd = &info->predecoded[i];
+                if (pd->raw != NULL && pd->data != NULL)
+                    pd->status = statuses[nprovided++];
+            }
+    }
+
+    /* decode the chunks left on the worker threads */
+    if (HMCIthreaded_decoder(info))
+        ret_value = htpool_run(info->nthreads, info->npredecoded, HMCIdecode_task, info);
+    HP_TRACE(HDF_TRACE_DECODE, TRUE, info->npredecoded * info->chunk_size * info->nt_size);
+    if (ret_value == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* keep only what was decoded */
+    for (i = 0; i < info->npredecoded; i++) {
+        pd = &info->predecoded[i];
+        free(pd->raw);
+        pd->raw = NULL;
+        if (pd->status != SUCCEED) {
+            HDlarge_free(pd->data, (size_t)pd->data_len);
+            pd->data = NULL;
+        }
+        else if ((uintn)info->comp_type < H4_STATS_NCODERS)
+            file_rec->stats.bytes_decoded[info->comp_type] += (uint32)pd->data_len;
+    }
+
+done:
+    if (ret_value == FAIL) { /* Error condition cleanup */
+        HMCIfree_predecoded(info);
+    }
+    free(chunk_indices);
+    free(pos_chunk);
+    free(offsets);
+    free(lengths);
+    free(exts);
+    free(raws);
+    free(raw_lens);
+    free(datas);
+    free(statuses);
+
+    return ret_value;
+} /* HMCIpredecode() */
+
+/* ------------------------------ HMCIreadahead ------------------------------
+NAME
+   HMCIreadahead -- bring the chunks of the next read into the chunk cache
+
+DESCRIPTION
+   Walks 'length' bytes of the element from position 'posn', where the
+   next read of a sequential pattern is expected, and pages the chunks
+   it needs that are not cached yet into the chunk cache.  Nothing is
+   done when the walk covers more chunks than the cache holds, as the
+   chunks read ahead would then evict each other.  With several coding
+   threads the compressed chunks are decoded ahead by HMCIpredecode().
+
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+static intn
+HMCIreadahead(accrec_t *access_rec, /* IN: access record of the element */
+              int32     posn,       /* IN: element position of the next read */
+              int32     length /* IN: length of the next read */)
+{
+    chunkinfo_t *info          = NULL; /* chunked element information record */
+    int32       *chunk_indices = NULL; /* chunk indices of the walk */
+    int32       *pos_chunk     = NULL; /* position in chunk of the walk */
+    int32       *chunks        = NULL; /* distinct chunks of the walk */
+    int32        nchunks       = 0;    /* number of entries in 'chunks' */
+    int32        nmissing      = 0;    /* number of those not cached */
+    int32        maxcache;             /* number of chunks the cache holds */
+    int32        walk_posn    = posn;  /* element position of the walk */
+    int32        bytes_walked = 0;     /* bytes of the read walked so far */
+    int32        chunk_size   = 0;     /* contiguous bytes in the current chunk */
+    int32        chunk_num    = 0;     /* current chunk number */
+    void        *chk_data     = NULL;  /* chunk data */
+    int32        i;
+    intn         ret_value = SUCCEED;
+
+    /* set inputs */
+    info = (chunkinfo_t *)(access_rec->special_info);
+    if ((maxcache = mcache_get_maxcache(info->chk_cache)) <= 0)
+        HGOTO_DONE(SUCCEED);
+
+    if ((chunks = (int32 *)malloc((size_t)maxcache * sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if ((chunk_indices = (int32 *)malloc((size_t)info->ndims * sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if ((pos_chunk = (int32 *)malloc((size_t)info->ndims * sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    /* collect the distinct chunks of the next read, without touching the
+       seek arrays of the element */
+    update_chunk_indices_seek(walk_posn, info->ndims, info->nt_size, chunk_indices, pos_chunk, info->ddims);
+    while (bytes_walked < length) {
+        calculate_chunk_num(&chunk_num, info->ndims, chunk_indices, info->ddims);
+        calculate_chunk_for_chunk(&chunk_size, info->ndims, info->nt_size, length, bytes_walked,
+                                  chunk_indices, pos_chunk, info->ddims);
+
+        for (i = nchunks - 1; i >= 0 && chunks[i] != chunk_num; i--)
+            ;
+        if (i < 0) {
+            if (nchunks == maxcache)
+                HGOTO_DONE(SUCCEED); /* the cache is too small */
+            chunks[nchunks++] = chunk_num;
+            if (!mcache_is_cached(info->chk_cache, chunk_num + 1) && !HMCIunwritten(info, chunk_num))
+                nmissing++;
+        }
+
+        bytes_walked += chunk_size;
+        walk_posn += chunk_size;
+        update_chunk_indices_seek(walk_posn, info->ndims, info->nt_size, chunk_indices, pos_chunk, info->ddims);
+    } /* end while "bytes_walked" */
+    if (nmissing == 0)
+        HGOTO_DONE(SUCCEED);
+
+    /* decode the compressed chunks together */
+    if (HMCIbatch_decoder(info))
+        if (HMCIpredecode(access_rec, posn, length, NULL, 0) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+
+    /* page the missing chunks in, in the order the read will want them;
+       the read fills in chunks that were never written itself */
+    for (i = 0; i < nchunks; i++) {
+        if (mcache_is_cached(info->chk_cache, chunks[i] + 1) || HMCIunwritten(info, chunks[i]))
+            continue;
+        if ((chk_data = mcache_get(info->chk_cache, chunks[i] + 1, 0)) == NULL)
+            HE_REPORT_GOTO("failed to find chunk record", FAIL);
+        if (mcache_put(info->chk_cache, chk_data, 0) == FAIL)
+            HE_REPORT_GOTO("failed to put chunk back in cache", FAIL);
+    }
+
+done:
+    HMCIfree_predecoded(info);
+    free(chunks);
+    free(chunk_indices);
+    free(pos_chunk);
+
+    return ret_value;
+} /* HMCIreadahead() */
+
+/* qsort() comparison of chunk numbers */
+static int
+HMCInumcompare(const void *p1, const void *p2)
+{
+    int32 n1 = *(const int32 *)p1;
+    int32 n2 = *(const int32 *)p2;
+
+    return (n1 > n2) - (n1 < n2);
+} /* HMCInumcompare() */
+
+/* ------------------------------- HMCPprefetch -------------------------------
+NAME
+   HMCPprefetch -- announce the reads of the chunks under runs of bytes
+
+DESCRIPTION
+   Walks the 'nruns' runs of bytes of the element given by 'offsets' and
+   'lengths', and tells the system with HPwillneed() that the file blocks
+   of each chunk they touch will be read soon.  Chunks that are cached,
+   waiting to be written or were never written are left out.  Nothing
+   is read into the chunk cache or decoded, see Hprefetch().
+
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+intn
+HMCPprefetch(accrec_t    *access_rec, /* IN: access record of the element */
+             int32        nruns,      /* IN: number of runs of bytes */
+             const int32 *offsets,    /* IN: offset in the element of each run */
+             const int32 *lengths /* IN: number of bytes of each run */)
+{
+    chunkinfo_t *info          = NULL; /* chunked element information record */
+    filerec_t   *file_rec      = NULL; /* file record */
+    CHUNK_REC   *chk_rec       = NULL; /* chunk record */
+    int32       *chunk_indices = NULL; /* chunk indices of the walk */
+    int32       *pos_chunk     = NULL; /* position in chunk of the walk */
+    int32       *chunks        = NULL; /* chunks touched by the runs */
+    int32        nchunks       = 0;    /* number of entries in 'chunks' */
+    int32        max_chunks    = 0;    /* entries 'chunks' has room for */
+    int32       *blk_offsets   = NULL; /* file offset of each block of a chunk */
+    int32       *blk_lengths   = NULL; /* length of each block of a chunk */
+    intn         nblocks;              /* number of blocks of a chunk */
+    int32        walk_posn;            /* element position of the walk */
+    int32        bytes_walked;         /* bytes of the run walked so far */
+    int32        chunk_size = 0;       /* contiguous bytes in the current chunk */
+    int32        chunk_num  = 0;       /* current chunk number */
+    int32        r, i;
+    intn         b;
+    intn         ret_value = SUCCEED;
+
+    file_rec = HAatom_object(access_rec->file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    info = (chunkinfo_t *)(access_rec->special_info);
+
+    if ((chunk_indices = (int32 *)malloc((size_t)info->ndims * sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if ((pos_chunk = (int32 *)malloc((size_t)info->ndims * sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    /* collect the chunks of the runs, without touching the seek arrays of
+       the element */
+    for (r = 0; r < nruns; r++) {
+        if (offsets[r] < 0 || lengths[r] < 0)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+
+        walk_posn    = offsets[r];
+        bytes_walked = 0;
+        update_chunk_indices_seek(walk_posn, info->ndims, info->nt_size, chunk_indices, pos_chunk, info->ddims);
+        while (bytes_walked < lengths[r]) {
+            calculate_chunk_num(&chunk_num, info->ndims, chunk_indices, info->ddims);
+            calculate_chunk_for_chunk(&chunk_size, info->ndims, info->nt_size, lengths[r], bytes_walked,
+                                      chunk_indices, pos_chunk, info->ddims);
+
+            if (nchunks == 0 || chunks[nchunks - 1] != chunk_num) {
+                if (nchunks == max_chunks) {
+                    int32  new_max = (max_chunks == 0) ? 64 : 2 * max_chunks;
+                    int32 *new_chunks;
+
+                    if ((new_chunks = (int32 *)realloc(chunks, (size_t)new_max * sizeof(int32))) == NULL)
+                        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+                    chunks     = new_chunks;
+                    max_chunks = new_max;
+                }
+                chunks[nchunks++] = chunk_num;
+            }
+
+            bytes_walked += chunk_size;
+            walk_posn += chunk_size;
+            update_chunk_indices_seek(walk_posn, info->ndims, info->nt_size, chunk_indices, pos_chunk,
+                                      info->ddims);
+        } /* end while "bytes_walked" */
+    }     /* end for "r" */
+    if (nchunks == 0)
+        HGOTO_DONE(SUCCEED);
+
+    /* each chunk once, in the order of the chunk numbers */
+    qsort(chunks, (size_t)nchunks, sizeof(int32), HMCInumcompare);
+    for (i = 0; i < nchunks; i++) {
+        if (i > 0 && chunks[i] == chunks[i - 1])
+            continue;
+        if (mcache_is_cached(info->chk_cache, chunks[i] + 1) || HMCIfind_pending(info, chunks[i]) != NULL)
+            continue;
+        if (HMCIfind_chunk(info, chunks[i], &chk_rec) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        if (chk_rec == NULL || chk_rec->chk_tag == DFTAG_NULL)
+            continue;
+
+        if ((nblocks = HDgetdatainfo(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref, NULL, 0, 0, NULL,
+                                     NULL)) <= 0)
+            continue;
+        if ((blk_offsets = (int32 *)malloc((size_t)nblocks * sizeof(int32))) == NULL ||
+            (blk_lengths = (int32 *)malloc((size_t)nblocks * sizeof(int32))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if (HDgetdatainfo(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref, NULL, 0, (uintn)nblocks,
+                          blk_offsets, blk_lengths) == nblocks)
+            for (b = 0; b < nblocks; b++)
+                HPwillneed(file_rec, blk_offsets[b], blk_lengths[b]);
+        free(blk_offsets);
+        free(blk_lengths);
+        blk_offsets = blk_lengths = NULL;
+    }
+
+done:
+    free(blk_offsets);
+    free(blk_lengths);
+    free(chunks);
+    free(chunk_indices);
+    free(pos_chunk);
+
+    return ret_value;
+} /* HMCPprefetch() */
+
+/* --------------------------- HMCIread_coded_chunk ---------------------------
+NAME
+   HMCIread_coded_chunk -- read and decode a compressed chunk at once
+
+DESCRIPTION
+   Reads the compressed data of a chunk with a single HPread_batch() call
+   and decodes it straight into the buffer with HMCIdecode_buffer(),
+   instead of going through the compression layer piece by piece.  The
+   block lists and the buffer for the compressed data are kept in the
+   element's information record and only grown, so a dataset of many
+   small chunks does not allocate them again for every chunk.  Nothing is
+   pushed on the error stack, the caller falls back to the generic path
+   when this fails.
+
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+static intn
+HMCIread_coded_chunk(accrec_t  *access_rec, /* IN: access record of the element */
+                     CHUNK_REC *chk_rec,    /* IN: chunk record */
+                     uint8     *datap,      /* OUT: buffer for the chunk */
+                     int32      data_len /* IN: length of the decoded chunk */)
+{
+    chunkinfo_t *info;            /* chunked element information record */
+    filerec_t   *file_rec = NULL; /* file record */
+    void        *p;               /* grown buffer */
+    int32        raw_len;         /* total length of the chunk's blocks */
+    intn         nblocks;         /* number of blocks of the chunk */
+    intn         b;
+    intn         ret_value = SUCCEED;
+
+    file_rec = HAatom_object(access_rec->file_id);
+    if (BADFREC(file_rec))
+        HGOTO_DONE(FAIL);
+    info = (chunkinfo_t *)access_rec->special_info;
+
+    /* a chunk stored as it is needs no decoding */
+    if (HMCIstored_plain(info, access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref))
+        HGOTO_DONE(FAIL);
+
+    nblocks =
+        HDgetdatainfo(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref, NULL, 0, 0, NULL, NULL);
+    if (nblocks <= 0)
+        HGOTO_DONE(FAIL);
+
+    if (nblocks > info->rd_nblocks) {
+        if ((p = realloc(info->rd_offsets, (size_t)nblocks * sizeof(int32))) == NULL)
+            HGOTO_DONE(FAIL);
+        info->rd_offsets = (int32 *)p;
+        if ((p = realloc(info->rd_lengths, (size_t)nblocks * sizeof(int32))) == NULL)
+            HGOTO_DONE(FAIL);
+        info->rd_lengths = (int32 *)p;
+        if ((p = realloc(info->rd_exts, (size_t)nblocks * sizeof(hfile_ext_t))) == NULL)
+            HGOTO_DONE(FAIL);
+        info->rd_exts    = (hfile_ext_t *)p;
+        info->rd_nblocks = nblocks;
+    }
+    if (HDgetdatainfo(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref, NULL, 0, (uintn)nblocks,
+                      info->rd_offsets, info->rd_lengths) != nblocks)
+        HGOTO_DONE(FAIL);
+
+    for (raw_len = 0, b = 0; b < nblocks; b++)
+        raw_len += info->rd_lengths[b];
+    if (raw_len > info->rd_raw_size) {
+        if ((p = realloc(info->rd_raw, (size_t)raw_len)) == NULL)
+            HGOTO_DONE(FAIL);
+        info->rd_raw      = (uint8 *)p;
+        info->rd_raw_size = raw_len;
+    }
+    for (raw_len = 0, b = 0; b < nblocks; b++) {
+        info->rd_exts[b].offset = info->rd_offsets[b];
+        info->rd_exts[b].length = info->rd_lengths[b];
+        info->rd_exts[b].buf    = info->rd_raw + raw_len;
+        raw_len += info->rd_lengths[b];
+    }
+
+    /* the chunks of remote files may be kept on local disk */
+    if (HMCIdisk_get(file_rec, info->rd_offsets[0], info->rd_raw, raw_len) == FAIL) {
+        if (HPread_batch(file_rec, nblocks, info->rd_exts) == FAIL)
+            HGOTO_DONE(FAIL);
+        HMCIdisk_put(file_rec, info->rd_offsets[0], info->rd_raw, raw_len);
+    }
+
+    HP_TRACE(HDF_TRACE_DECODE, FALSE, data_len);
+    ret_value = HMCIdecode_buffer(info, info->rd_raw, raw_len, datap, data_len);
+    HP_TRACE(HDF_TRACE_DECODE, TRUE, data_len);
+    if (ret_value == SUCCEED && (uintn)info->comp_type < H4_STATS_NCODERS)
+        file_rec->stats.bytes_decoded[info->comp_type] += (uint32)data_len;
+
+done:
+    return ret_value;
+} /* HMCIread_coded_chunk() */
+
+/* ------------------------------- HMCPchunkread --------------------------------
+NAME
+   HMCPchunkread - read a chunk
+
+DESCRIPTION
+   Read in a whole chunk from a chunked element given the chunk number.
+
+   This is used as the 'page-in-chunk' routine for the cache.
+   Only the cache should call this routine.
+
+RETURNS
+   The number of bytes read or FAIL on error
+AUTHOR
+   -GeorgeV - 9/3/96
+--------------------------------------------------------------------------- */
+static int32
+HMCPchunkread(void *cookie,    /* IN: access record to mess with */
+              int32 chunk_num, /* IN: chunk to read */
+              void *datap /* OUT: buffer for data */)
+{
+    accrec_t      *access_rec = (accrec_t *)cookie; /* access record */
+    chunkinfo_t   *info       = NULL;               /* information record for this special data elt */
+    CHUNK_REC     *chk_rec    = NULL;               /* chunk record */
+    chunk_coded_t *pd         = NULL;               /* chunk decoded by HMCIpredecode() */
+    uint8         *bptr       = NULL;               /* pointer to data buffer */
+    int32          chk_id     = FAIL;               /* chunk id */
+    int32          bytes_read = 0;                  /* total # bytes read for this call of HMCIread */
+    int32          read_len   = 0;                  /* length of bytes to read */
+    int32          nitems     = 1;                  /* used in HDmemfill(), */
+    int32          ret_value  = SUCCEED;
+
+    /* Check args */
+    if (access_rec == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* set inputs */
+    bptr       = (uint8 *)datap;
+    info       = (chunkinfo_t *)(access_rec->special_info);
+    bytes_read = 0;
+    read_len   = (info->chunk_size * info->nt_size);
+    HP_TRACE(HDF_TRACE_CHUNK, FALSE, read_len);
+
+    /* chunk still waiting in the write-behind queue or already decoded
+       ahead of this read? */
+    if ((pd = HMCIfind_pending(info, chunk_num)) != NULL ||
+        ((pd = HMCIfind_predecoded(info, chunk_num)) != NULL && pd->status == SUCCEED)) {
+        memcpy(bptr, pd->data, read_len);
+        HGOTO_DONE(read_len);
+    }
+
+    /* find chunk record */
+    if (HMCIfind_chunk(info, chunk_num, &chk_rec) == FAIL)
+        HE_REPORT_GOTO("failed to find chunk record", FAIL);
+    if (chk_rec == NULL) { /* does not exist */
+        /* calculate number of fill value items to fill buffer with */
+        nitems = (info->chunk_size * info->nt_size) / info->fill_val_len;
+
+        /* copy fill values into buffer and return */
+        if (HDmemfill(datap, info->fill_val, (uint32)info->fill_val_len, (uint32)nitems) == NULL)
+            HE_REPORT_GOTO("HDmemfill failed to fill read chunk", FAIL);
+    }
+    else /* exists */
+    {
+        /* check to see if has been written to */
+        if (chk_rec->chk_tag != DFTAG_NULL &&
+            BASETAG(chk_rec->chk_tag) == DFTAG_CHUNK) { /* valid chunk in file */
+            /* deflate and LZ4 chunks are decoded in one go, unless their
+               bytes are shuffled */
+            if (HMCIwhole_coder(info) && HMCIread_coded_chunk(access_rec, chk_rec, bptr, read_len) == SUCCEED)
+                HGOTO_DONE(read_len);
+
+            /* Start read on chunk */
+            if ((chk_id = Hstartread(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref)) == FAIL) {
+                Hendaccess(chk_id);
+                HE_REPORT_GOTO("Hstartread failed to read chunk", FAIL);
+            }
+
+            /* read data from chunk */
+            if (Hread(chk_id, read_len, bptr) == FAIL)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+
+            bytes_read = read_len;
+
+            /* end access to chunk */
+            if (Hendaccess(chk_id) == FAIL)
+                HE_REPORT_GOTO("Hendaccess failed to end access to chunk", FAIL);
+        }
+        else if (chk_rec->chk_tag ==
+                 DFTAG_NULL) { /* chunk has not been written, so return fill value buffer */
+            /* calculate number of fill value items to fill buffer with */
+            nitems = (info->chunk_size * info->nt_size) / info->fill_val_len;
+
+            /* copy fill values into buffer and return */
+            if (HDmemfill(datap, info->fill_val, (uint32)info->fill_val_len, (uint32)nitems) == NULL)
+                HE_REPORT_GOTO("HDmemfill failed to fill read chunk", FAIL);
+        }
+        else /* not a valid chunk ref for now */
+        {
+            /* For now DFTAG_CHUNK is the only allowed value.
+               In the future this could be another Chunk table. */
+            HE_REPORT_GOTO("Not a valid Chunk object, wrong tag for chunk", FAIL);
+        }
+
+    } /* end else exists in TBBT tree */
+
+    ret_value = bytes_read; /* number of bytes read */
+
+done:
+    if (ret_value == FAIL) { /* Error condition cleanup */
+        if (chk_id != FAIL)
+            Hendaccess(chk_id);
+    } /* end if */
+    if (access_rec != NULL)
+        HP_TRACE(HDF_TRACE_CHUNK, TRUE, read_len);
+
+    return ret_value;
+} /* HMCPchunkread() */
+
+/* ------------------------------- HMCreadChunk ---------------------------
+NAME
+   HMCreadChunk -- read a whole chunk
+
+DESCRIPTION
+   Read a whole chunk from a chunked element.
+
+   This can be used by users to read whole chunks from the file
+   based on chunk origin for now i.e position of chunk in overall
+.  chunk array.
+
+RETURNS
+   The number of bytes read or FAIL on error
+AUTHOR
+   -GeorgeV - 9/3/96
+---------------------------------------------------------------------------*/
+int32
+HMCreadChunk(int32  access_id, /* IN: access aid to mess with */
+             int32 *origin,    /* IN: origin of chunk to read */
+             void  *datap /* IN: buffer for data */)
+{
+    accrec_t    *access_rec = NULL; /* access record */
+    filerec_t   *file_rec   = NULL; /* file record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    uint8       *bptr       = NULL; /* data buffer pointer */
+    void        *chk_data   = NULL; /* chunk data */
+    uint8       *chk_dptr   = NULL; /* chunk data pointer */
+    int32        relative_posn;     /* relative position in chunked element */
+    int32        bytes_read = 0;    /* total #bytes read  */
+    int32        read_len   = 0;    /* bytes to read next */
+    int32        chunk_num  = -1;   /* chunk number */
+    filerec_t   *locked     = NULL;
+    int32        ret_value  = SUCCEED;
+    intn         i;
+
+    locked = HL_LOCK_AID(access_id);
+
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (origin == NULL || datap == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* validate file records */
+    file_rec = HAatom_object(access_rec->file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* can read from this file? */
+    if (!(file_rec->access & DFACC_READ))
+        HGOTO_ERROR(DFE_DENIED, FAIL);
+
+    /* since this routine can be called by the user,
+       need to check if this access id is special CHUNKED */
+    if (access_rec->special == SPECIAL_CHUNKED) {
+        /* Set inputs */
+        info          = (chunkinfo_t *)(access_rec->special_info);
+        relative_posn = access_rec->posn;
+        read_len      = (info->chunk_size * info->nt_size);
+        bytes_read    = 0;
+        bptr          = datap;
+
+        /* copy origin over to seek chunk indices
+           and set position within chunk to beginning of that chunk */
+        for (i = 0; i < info->ndims; i++) {
+            info->seek_chunk_indices[i] = origin[i];
+            info->seek_pos_chunk[i]     = 0;
+        }
+
+        /* calculate chunk number from origin */
+        calculate_chunk_num(&chunk_num, info->ndims, origin, info->ddims);
+
+        /* currently get chunk data from cache based on chunk number
+           Note the cache deals with objects starting from 1 not 0 */
+        if ((chk_data = mcache_get(info->chk_cache, /* cache handle */
+                                   chunk_num + 1,   /* chunk number */
+                                   0 /* flag: unused */)) == NULL)
+            HE_REPORT_GOTO("failed to find chunk record", FAIL);
+
+        chk_dptr = chk_data; /* set chunk data ptr */
+
+        /* copy data from chunk to users buffer */
+        memcpy(bptr, chk_dptr, read_len);
+
+        /* put chunk back to cache and mark it as *not* DIRTY */
+        if (mcache_put(info->chk_cache, /* cache handle */
+                       chk_data,        /* whole data chunk */
+                       0 /* flag: 0->not DIRTY */) == FAIL)
+            HE_REPORT_GOTO("failed to put chunk back in cache", FAIL);
+
+        /* adjust number of bytes already read */
+        bytes_read = read_len;
+
+        /*update chunk seek indices after reading chunk */
+        update_seek_pos_chunk(bytes_read, info->ndims, info->nt_size, info->seek_pos_chunk, info->ddims);
+
+        /* compute user array for chunk arrays */
+        compute_chunk_to_array(info->seek_chunk_indices, info->seek_pos_chunk, info->seek_user_indices,
+                               info->ndims, info->ddims);
+
+        /* calculate new read seek position in element from user array */
+        compute_array_to_seek(&relative_posn, info->seek_user_indices, info->nt_size, info->ndims,
+                              info->ddims);
+
+        /* update access record with bytes read */
+        access_rec->posn = relative_posn;
+
+        ret_value = bytes_read;
+    }
+    else /* not special chunked element */
+        ret_value = FAIL;
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* HMCreadChunk() */
+
+/* ------------------------------- HMCgetChunkPtr ---------------------------
+NAME
+   HMCgetChunkPtr -- get a pointer to a whole chunk in the chunk cache
+
+DESCRIPTION
+   Reads the chunk at 'origin' into the chunk cache, if it is not cached
+   yet, and returns a pointer to it in '*datap' instead of copying it
+   like HMCreadChunk() does.  The page is pinned in the cache: it is
+   neither evicted nor reused until it is given back with
+   HMCreleaseChunk(), so several chunks can be held at once, at the
+   cost of the cache growing past its size.  The data must not be
+   written to; writes to the element through any access id show in it.
+   The position of the element is left as it is.
+
+RETURNS
+   The number of bytes of the chunk or FAIL on error
+---------------------------------------------------------------------------*/
+int32
+HMCgetChunkPtr(int32        access_id, /* IN: access aid to mess with */
+               int32       *origin,    /* IN: origin of chunk to get */
+               const void **datap /* OUT: the chunk in the cache */)
+{
+    accrec_t    *access_rec = NULL; /* access record */
+    filerec_t   *file_rec   = NULL; /* file record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    void        *chk_data   = NULL; /* chunk data */
+    int32        chunk_num  = -1;   /* chunk number */
+    filerec_t   *locked     = NULL;
+    int32        ret_value  = SUCCEED;
+    intn         i;
+
+    locked = HL_LOCK_AID(access_id);
+
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL || origin == NULL || datap == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* validate file records */
+    file_rec = HAatom_object(access_rec->file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* can read from this file? */
+    if (!(file_rec->access & DFACC_READ))
+        HGOTO_ERROR(DFE_DENIED, FAIL);
+
+    if (access_rec->special != SPECIAL_CHUNKED)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    info = (chunkinfo_t *)(access_rec->special_info);
+
+    for (i = 0; i < info->ndims; i++)
+        if (origin[i] < 0 || origin[i] >= info->ddims[i].num_chunks)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get the chunk from the cache and keep it pinned
+       Note the cache deals with objects starting from 1 not 0 */
+    calculate_chunk_num(&chunk_num, info->ndims, origin, info->ddims);
+    if ((chk_data = mcache_get(info->chk_cache, chunk_num + 1, 0)) == NULL)
+        HE_REPORT_GOTO("failed to find chunk record", FAIL);
+
+    *datap    = chk_data;
+    ret_value = info->chunk_size * info->nt_size;
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* HMCgetChunkPtr() */
+
+/* ------------------------------- HMCreleaseChunk --------------------------
+NAME
+   HMCreleaseChunk -- give back a chunk gotten with HMCgetChunkPtr()
+
+DESCRIPTION
+   Unpins the chunk 'datap' returned by HMCgetChunkPtr() for the same
+   element, after which the pointer must not be used anymore.  Each
+   HMCgetChunkPtr() must be matched by one HMCreleaseChunk() before the
+   last access id of the element is ended.
+
+RETURNS
+   SUCCEED/FAIL
+---------------------------------------------------------------------------*/
+intn
+HMCreleaseChunk(int32       access_id, /* IN: access aid to mess with */
+                const void *datap /* IN: the chunk in the cache */)
+{
+    accrec_t    *access_rec = NULL; /* access record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    filerec_t   *locked     = NULL;
+    intn         ret_value  = SUCCEED;
+
+    locked = HL_LOCK_AID(access_id);
+
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL || datap == NULL || access_rec->special != SPECIAL_CHUNKED)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    info = (chunkinfo_t *)(access_rec->special_info);
+
+    /* put chunk back to cache and mark it as *not* DIRTY */
+    if (mcache_put(info->chk_cache, (void *)datap, 0) == FAIL)
+        HE_REPORT_GOTO("failed to put chunk back in cache", FAIL);
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* HMCreleaseChunk() */
+
+/* ------------------------------ HMCIslab_part ------------------------------
+NAME
+   HMCIslab_part -- find the indices of a hyperslab in a chunk
+
+DESCRIPTION
+   Of the 'edges' indices start, start + stride, ... of a hyperslab along
+   a dimension, finds those in the chunk of index 'chunk' along that
+   dimension, which must not come before 'start'.  The first of them is
+   the 'first'-th index of the slab.
+
+RETURNS
+   The number of indices of the slab in the chunk, 0 if none
+--------------------------------------------------------------------------- */
+static int32
+HMCIslab_part(const DIM_REC *ddim,   /* IN: dimension record */
+              int32          chunk,  /* IN: chunk index along the dimension */
+              int32          start,  /* IN: first index of the slab */
+              int32          stride, /* IN: distance between indices of the slab */
+              int32          edges,  /* IN: number of indices of the slab */
+              int32         *first /* OUT: first index of the slab in the chunk */)
+{
+    int32 lo = chunk * ddim->chunk_length;  /* first index of the chunk */
+    int32 hi = lo + ddim->chunk_length - 1; /* last index of the chunk */
+    int32 last;                             /* last index of the slab in the chunk */
+
+    *first = (lo <= start) ? 0 : (lo - start + stride - 1) / stride;
+    last   = MIN(edges - 1, (hi - start) / stride);
+
+    return (*first <= last) ? last - *first + 1 : 0;
+} /* HMCIslab_part() */
+
+/* ------------------------------- HMCIcopy_row ------------------------------
+NAME
+   HMCIcopy_row -- copy 'n' values 'step' bytes apart to consecutive values
+
+DESCRIPTION
+   The row copies of HMCIcopy_block(), all with this signature.  A copy
+   is generated by HMCI_COPY_ROW() for each of the common sizes of number
+   types, in which the copy of a value is a move of a constant size, and
+   HMCIcopy_run() copies values next to each other with one memcpy().
+   HMCIrow_copier() picks one once for a whole hyperslab.
+
+RETURNS
+   Nothing
+--------------------------------------------------------------------------- */
+typedef void (*hmc_copy_row_t)(const uint8 *src, uint8 *dst, int32 n, int32 step, int32 nt_size);
+
+#define HMCI_COPY_ROW(size)                                                                              \
+    static void HMCIcopy_row##size(const uint8 *src, uint8 *dst, int32 n, int32 step, int32 nt_size)      \
+    {                                                                                                    \
+        int32 i;                                                                                         \
+                                                                                                         \
+        (void)nt_size;                                                                                   \
+        for (i = 0; i < n; i++, src += step, dst += size)                                                \
+            memcpy(dst, src, size);                                                                      \
+    }
+
+HMCI_COPY_ROW(1)
+HMCI_COPY_ROW(2)
+HMCI_COPY_ROW(4)
+HMCI_COPY_ROW(8)
+
+/* values of any other size */
+static void
+HMCIcopy_row(const uint8 *src,  /* IN: first value to copy */
+             uint8       *dst,  /* OUT: where to copy it */
+             int32        n,    /* IN: number of values */
+             int32        step, /* IN: bytes between the values in 'src' */
+             int32        nt_size /* IN: size of a value */)
+{
+    int32 i;
+
+    for (i = 0; i < n; i++, src += step, dst += nt_size)
+        memcpy(dst, src, (size_t)nt_size);
+} /* HMCIcopy_row() */
+
+/* values next to each other */
+static void
+HMCIcopy_run(const uint8 *src,  /* IN: first value to copy */
+             uint8       *dst,  /* OUT: where to copy it */
+             int32        n,    /* IN: number of values */
+             int32        step, /* IN: bytes between the values in 'src' */
+             int32        nt_size /* IN: size of a value */)
+{
+    (void)step;
+    memcpy(dst, src, (size_t)(n * nt_size));
+} /* HMCIcopy_run() */
+
+/* the row copy for values 'step' bytes apart */
+static hmc_copy_row_t
+HMCIrow_copier(int32 step, /* IN: bytes between the values to copy */
+               int32 nt_size /* IN: size of a value */)
+{
+    if (step == nt_size)
+        return HMCIcopy_run;
+    switch (nt_size) {
+        case 1:
+            return HMCIcopy_row1;
+        case 2:
+            return HMCIcopy_row2;
+        case 4:
+            return HMCIcopy_row4;
+        case 8:
+            return HMCIcopy_row8;
+        default:
+            return HMCIcopy_row;
+    }
+} /* HMCIrow_copier() */
+
+/* ------------------------------ HMCIcopy_block -----------------------------
+NAME
+   HMCIcopy_block -- copy the part of a hyperslab in a chunk
+
+DESCRIPTION
+   Copies the 'count[0]' x ... x 'count[ndims - 1]' values of a chunk
+   that are in a hyperslab to their places in the buffer of the slab,
+   one row at a time with 'copy_row'.  Along dimension k, the values are
+   'src_step[k]' bytes apart in the chunk and 'dst_step[k]' bytes apart
+   in the buffer.  Ranks 1 to 4 have loops of their own, higher ranks go
+   through the rows of the part with 'idx', an array of 'ndims' indices.
+
+RETURNS
+   Nothing
+--------------------------------------------------------------------------- */
+static void
+HMCIcopy_block(int32          ndims,    /* IN: number of dimensions */
+               hmc_copy_row_t copy_row, /* IN: copy of a row, see HMCIrow_copier() */
+               int32          nt_size,  /* IN: size of a value */
+               const int32   *count,    /* IN: number of values along each dimension */
+               const int32   *src_step, /* IN: bytes between values in the chunk */
+               const int32   *dst_step, /* IN: bytes between values in the buffer */
+               const uint8   *src,      /* IN: first value of the part in the chunk */
+               uint8         *dst,      /* OUT: its place in the buffer */
+               int32         *idx /* IN: scratch array of 'ndims' indices */)
+{
+    int32 last = ndims - 1; /* the dimension of the rows */
+    int32 soff, doff;       /* offsets of a row in the chunk and in the buffer */
+    int32 i, j, k;
+
+    switch (ndims) {
+        case 1:
+            (*copy_row)(src, dst, count[0], src_step[0], nt_size);
+            break;
+        case 2:
+            for (i = 0; i < count[0]; i++)
+                (*copy_row)(src + i * src_step[0], dst + i * dst_step[0], count[1], src_step[1], nt_size);
+            break;
+        case 3:
+            for (i = 0; i < count[0]; i++)
+                for (j = 0; j < count[1]; j++)
+                    (*copy_row)(src + i * src_step[0] + j * src_step[1],
+                                dst + i * dst_step[0] + j * dst_step[1], count[2], src_step[2], nt_size);
+            break;
+        case 4:
+            for (i = 0; i < count[0]; i++)
+                for (j = 0; j < count[1]; j++)
+                    for (k = 0; k < count[2]; k++)
+                        (*copy_row)(src + i * src_step[0] + j * src_step[1] + k * src_step[2],
+                                    dst + i * dst_step[0] + j * dst_step[1] + k * dst_step[2], count[3],
+                                    src_step[3], nt_size);
+            break;
+        default:
+            for (k = 0; k < last; k++)
+                idx[k] = 0;
+            do {
+                for (soff = 0, doff = 0, k = 0; k < last; k++) {
+                    soff += idx[k] * src_step[k];
+                    doff += idx[k] * dst_step[k];
+                }
+                (*copy_row)(src + soff, dst + doff, count[last], src_step[last], nt_size);
+
+                /* next row */
+                for (k = last - 1; k >= 0; k--) {
+                    if (++idx[k] < count[k])
+                        break;
+                    idx[k] = 0;
+                }
+            } while (k >= 0);
+            break;
+    }
+} /* HMCIcopy_block() */
+
+/* ------------------------------- HMCreadSlab --------------------------------
+NAME
+   HMCreadSlab -- read a hyperslab of a chunked element
+
+DESCRIPTION
+   Reads the values of indices start[k] + i * stride[k], 0 <= i < edges[k],
+   along each dimension k of the element into 'datap', laid out as an
+   array of dimensions 'edges', in the number format of the element.
+   A NULL 'stride' reads every value.
+
+   Instead of walking the slab one contiguous run of the element at a
+   time as reads through Hread() do, the chunks that hold values of the
+   slab are gone through once, in the order of their numbers, and the
+   part of the slab in each is copied straight from the chunk cache into
+   the buffer.  Chunks the stride skips over are not read at all, and
+   chunks never written are copied from the fill value.  Compressed
+   chunks are decoded together, as HMCPread() does.  The position of the
+   element is left as it is.
+
+RETURNS
+   The number of bytes read or FAIL on error
+---------------------------------------------------------------------------*/
+int32
+HMCreadSlab(int32        access_id, /* IN: access aid to mess with */
+            const int32 *start,     /* IN: first index of the slab along each dimension */
+            const int32 *stride,    /* IN: distance between indices, NULL for 1 */
+            const int32 *edges,     /* IN: number of indices along each dimension */
+            void        *datap /* OUT: buffer for the slab */)
+{
+    accrec_t      *access_rec = NULL; /* access record */
+    filerec_t     *file_rec   = NULL; /* file record */
+    chunkinfo_t   *info       = NULL; /* chunked element information record */
+    int32         *dims       = NULL; /* the arrays by dimension below */
+    int32         *cfirst, *clast;    /* chunk indices of the first and last chunk of the slab */
+    int32         *corigin;           /* chunk indices of the current chunk */
+    int32         *count;             /* number of values of the slab in the current chunk */
+    int32         *src_step;          /* bytes between values of the slab in a chunk */
+    int32         *dst_step;          /* bytes between values of the slab in 'datap' */
+    int32         *idx;               /* scratch indices for HMCIcopy_block() */
+    hmc_copy_row_t copy_row;          /* copy of a row of the slab */
+    int32         *chunks     = NULL; /* chunks holding values of the slab */
+    int32          nchunks    = 0;    /* number of entries in 'chunks' */
+    uint8         *fill_chunk = NULL; /* a chunk of fill values */
+    void          *chk_data   = NULL; /* chunk data */
+    int32          soff;              /* offset of the first value of the slab in the current chunk */
+    uint8         *dst;               /* its place in 'datap' */
+    int32          ndims, nt_size, chunk_bytes;
+    int32          chunk_num, first, st, num, maxchunks;
+    int32          cstep, ustep;
+    intn           predecode;
+    intn           k;
+    int32          i;
+    filerec_t     *locked    = NULL;
+    int32          ret_value = SUCCEED;
+
+    locked = HL_LOCK_AID(access_id);
+
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL || start == NULL || edges == NULL || datap == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* validate file records */
+    file_rec = HAatom_object(access_rec->file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* can read from this file? */
+    if (!(file_rec->access & DFACC_READ))
+        HGOTO_ERROR(DFE_DENIED, FAIL);
+
+    if (access_rec->special != SPECIAL_CHUNKED)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    info        = (chunkinfo_t *)(access_rec->special_info);
+    ndims       = info->ndims;
+    nt_size     = info->nt_size;
+    chunk_bytes = info->chunk_size * nt_size;
+
+    if ((dims = (int32 *)malloc((size_t)(7 * ndims) * sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    cfirst   = dims;
+    clast    = dims + ndims;
+    corigin  = dims + 2 * ndims;
+    count    = dims + 3 * ndims;
+    src_step = dims + 4 * ndims;
+    dst_step = dims + 5 * ndims;
+    idx      = dims + 6 * ndims;
+
+    /* the slab must be in the element; find the chunks it spans */
+    maxchunks = 1;
+    cstep     = nt_size;
+    ustep     = nt_size;
+    for (k = (intn)ndims - 1; k >= 0; k--) {
+        st = (stride != NULL) ? stride[k] : 1;
+        if (start[k] < 0 || edges[k] < 1 || st < 1 || start[k] >= info->ddims[k].dim_length ||
+            edges[k] - 1 > (info->ddims[k].dim_length - 1 - start[k]) / st)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+
+        cfirst[k]   = start[k] / info->ddims[k].chunk_length;
+        clast[k]    = (start[k] + (edges[k] - 1) * st) / info->ddims[k].chunk_length;
+        src_step[k] = st * cstep;
+        dst_step[k] = ustep;
+        cstep *= info->ddims[k].chunk_length;
+        if (ustep > INT32_MAX / edges[k])
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+        ustep *= edges[k];
+        maxchunks *= clast[k] - cfirst[k] + 1;
+    }
+
+    /* list the chunks holding values of the slab, in the order of their
+       numbers; a stride longer than the chunks skips some of them */
+    if ((chunks = (int32 *)malloc((size_t)maxchunks * sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    for (k = 0; k < (intn)ndims; k++)
+        corigin[k] = cfirst[k];
+    do {
+        for (k = 0; k < (intn)ndims; k++)
+            if (HMCIslab_part(&info->ddims[k], corigin[k], start[k], (stride != NULL) ? stride[k] : 1,
+                              edges[k], &first) == 0)
+                break;
+        if (k == (intn)ndims) {
+            calculate_chunk_num(&chunk_num, ndims, corigin, info->ddims);
+            chunks[nchunks++] = chunk_num;
+        }
+
+        /* next chunk */
+        for (k = (intn)ndims - 1; k >= 0; k--) {
+            if (++corigin[k] <= clast[k])
+                break;
+            corigin[k] = cfirst[k];
+        }
+    } while (k >= 0);
+
+    /* decode compressed chunks together? */
+    predecode = HMCIbatch_decoder(info);
+
+    /* the rows of the slab are alike in every chunk */
+    copy_row = HMCIrow_copier(src_step[ndims - 1], nt_size);
+
+    for (i = 0; i < nchunks; i++) {
+        /* chunk indices of the chunk, and the part of the slab in it */
+        for (num = chunks[i], k = (intn)ndims - 1; k >= 0; k--) {
+            corigin[k] = num % info->ddims[k].num_chunks;
+            num /= info->ddims[k].num_chunks;
+        }
+        soff = 0;
+        dst  = datap;
+        for (k = 0; k < (intn)ndims; k++) {
+            st       = (stride != NULL) ? stride[k] : 1;
+            count[k] = HMCIslab_part(&info->ddims[k], corigin[k], start[k], st, edges[k], &first);
+            soff += (start[k] + first * st - corigin[k] * info->ddims[k].chunk_length) * (src_step[k] / st);
+            dst += first * dst_step[k];
+        }
+
+        if (info->fill_val_len > 0 && chunk_bytes % info->fill_val_len == 0 &&
+            HMCIunwritten(info, chunks[i])) {
+            /* a chunk never written is only fill values */
+            if (fill_chunk == NULL) {
+                if ((fill_chunk = (uint8 *)malloc((size_t)chunk_bytes)) == NULL)
+                    HGOTO_ERROR(DFE_NOSPACE, FAIL);
+                if (HDmemfill(fill_chunk, info->fill_val, (uint32)info->fill_val_len,
+                              (uint32)(chunk_bytes / info->fill_val_len)) == NULL)
+                    HE_REPORT_GOTO("HDmemfill failed to fill chunk", FAIL);
+            }
+            HMCIcopy_block(ndims, copy_row, nt_size, count, src_step, dst_step, fill_chunk + soff, dst, idx);
+            continue;
+        }
+
+        /* decode this and the next chunks of the slab together, unless this
+           chunk is already at hand */
+        if (predecode && !mcache_is_cached(info->chk_cache, chunks[i] + 1) &&
+            HMCIfind_predecoded(info, chunks[i]) == NULL)
+            if (HMCIpredecode(access_rec, 0, 0, chunks + i, nchunks - i) == FAIL)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+
+        /* Note the cache deals with objects starting from 1 not 0 */
+        if ((chk_data = mcache_get(info->chk_cache, chunks[i] + 1, 0)) == NULL)
+            HE_REPORT_GOTO("failed to find chunk record", FAIL);
+
+        HMCIcopy_block(ndims, copy_row, nt_size, count, src_step, dst_step, (uint8 *)chk_data + soff, dst,
+                       idx);
+
+        /* put chunk back to cache and mark it as *not* DIRTY */
+        if (mcache_put(info->chk_cache, chk_data, 0) == FAIL)
+            HE_REPORT_GOTO("failed to put chunk back in cache", FAIL);
+    }
+
+    ret_value = ustep;
+
+done:
+    /* chunks decoded ahead are only kept for the duration of the read */
+    if (info != NULL)
+        HMCIfree_predecoded(info);
+    free(dims);
+    free(chunks);
+    free(fill_chunk);
+
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* HMCreadSlab() */
+
+/* ------------------------------- HMCPread --------------------------------
+NAME
+   HMCPread - read data from a chunked element
+
+DESCRIPTION
+   Read in some data from a chunked element.
+
+   Data is obtained from the cache which takes care of reading
+   in the proper chunks to satisfy the request.  When the request covers
+   more chunks than the cache holds, the whole chunks that are not cached
+   and are laid out in the element as they are in themselves are read
+   straight into the buffer instead, see HMCIdirect_chunk().
+
+RETURNS
+   The number of bytes read or FAIL on error
+AUTHOR
+   -GeorgeV - 9/3/96
+--------------------------------------------------------------------------- */
+static int32
+HMCPread(accrec_t *access_rec, /* IN: access record to mess with */
+         int32     length,     /* IN: number of bytes to read */
+         void     *datap /* OUT: buffer for data */)
+{
+    chunkinfo_t *info          = NULL; /* information record for this special data elt */
+    int32        relative_posn = 0;    /* relative position in chunk of data elt */
+    int32        bytes_read    = 0;    /* total # bytes read for this call of HMCIread */
+    uint8       *bptr          = NULL; /* data buffer pointer */
+    int32        read_len      = 0;    /* amount of data to copy */
+    int32        read_seek     = 0;    /* next read seek position */
+    int32        chunk_size    = 0;    /* size of data to read from chunk */
+    int32        chunk_num     = 0;    /* next chunk number */
+    void        *chk_data      = NULL; /* chunk data */
+    uint8       *chk_dptr      = NULL; /* pointer to chunk data */
+    intn         predecode     = FALSE; /* decode chunks together? */
+    intn         fill          = FALSE; /* chunk never written, read as fill? */
+    intn         direct        = FALSE; /* read whole chunks around the cache? */
+    int32        stride        = 0;     /* distance from the last read */
+    int32        ret_value     = SUCCEED;
+
+    /* Check args */
+    if (access_rec == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* set inputs */
+    info          = (chunkinfo_t *)(access_rec->special_info);
+    relative_posn = access_rec->posn; /* current seek position in element */
+
+    /* validate length and set proper length */
+    if (length == 0)
+        length = (info->length * info->nt_size) - access_rec->posn;
+    else if (length < 0)
+        HGOTO_ERROR(DFE_RANGE, FAIL);
+
+    if (access_rec->posn + length > (info->length * info->nt_size))
+        length = (info->length * info->nt_size) - access_rec->posn;
+
+    /* does this read continue a pattern of equally spaced reads? */
+    if (info->readahead) {
+        stride = access_rec->posn - info->ra_posn;
+        if (info->ra_posn >= 0 && stride > 0 && stride == info->ra_stride && length == info->ra_length)
+            info->ra_streak++;
+        else
+            info->ra_streak = 0;
+        info->ra_posn   = access_rec->posn;
+        info->ra_length = length;
+        info->ra_stride = stride;
+    }
+
+    /* should chunk indices be updated with relative_posn?
+       or did last operation update it already */
+    update_chunk_indices_seek(access_rec->posn, info->ndims, info->nt_size, info->seek_chunk_indices,
+                              info->seek_pos_chunk, info->ddims);
+
+    /* decode compressed chunks together? */
+    predecode = HMCIbatch_decoder(info);
+
+    /* more chunks read than the cache holds? */
+    direct = length / (info->chunk_size * info->nt_size) > mcache_get_maxcache(info->chk_cache);
+
+    /* enter translating length to proper filling of buffer from chunks */
+    bptr       = datap;
+    bytes_read = 0;
+    read_len   = length;
+    while (bytes_read < read_len) {
+        /* calculate chunk to retrieve on this pass */
+        calculate_chunk_num(&chunk_num, info->ndims, info->seek_chunk_indices, info->ddims);
+
+        /* calculate contiguous chunk size that we can read from this chunk
+           during this pass */
+        calculate_chunk_for_chunk(&chunk_size, info->ndims, info->nt_size, read_len, bytes_read,
+                                  info->seek_chunk_indices, info->seek_pos_chunk, info->ddims);
+
+        /* calculate position in chunk */
+        calculate_seek_in_chunk(&read_seek, info->ndims, info->nt_size, info->seek_pos_chunk, info->ddims);
+
+        /* a chunk that was never written is only fill values; those go
+           straight into the user's buffer, without paging the chunk in */
+        fill = info->fill_val_len > 0 && read_seek % info->fill_val_len == 0 &&
+               chunk_size % info->fill_val_len == 0 && HMCIunwritten(info, chunk_num);
+
+        /* decode this and the next chunks of the read together, unless this
+           chunk is already at hand */
+        if (predecode && !fill && !mcache_is_cached(info->chk_cache, chunk_num + 1) &&
+            HMCIfind_predecoded(info, chunk_num) == NULL)
+            if (HMCIpredecode(access_rec, relative_posn, read_len - bytes_read, NULL, 0) == FAIL)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+
+        if (fill) {
+            if (HDmemfill(bptr, info->fill_val, (uint32)info->fill_val_len,
+                          (uint32)(chunk_size / info->fill_val_len)) == NULL)
+                HE_REPORT_GOTO("HDmemfill failed to fill read chunk", FAIL);
+        }
+        else if (direct && !mcache_is_cached(info->chk_cache, chunk_num + 1) &&
+                 HMCIdirect_chunk(info, read_len - bytes_read)) {
+            /* a whole chunk not in the cache is decoded straight into the
+               user's buffer, without going through a cache page that the
+               rest of this read would evict anyway */
+            chunk_size = info->chunk_size * info->nt_size;
+            if (HMCPchunkread(access_rec, chunk_num, bptr) == FAIL)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+        }
+        else {
+            /* would be nice to get Chunk record from TBBT based on chunk number
+               and then get chunk data base on chunk vdata number but
+               currently the chunk calculations return chunk
+               numbers and not Vdata record numbers.
+               This would reduce some overhead in the number of chunks
+               dealt with in the cache */
+
+            /* currently get chunk data from cache based on chunk number
+               Note the cache deals with objects starting from 1 not 0 */
+            if ((chk_data = mcache_get(info->chk_cache, /* cache handle */
+                                       chunk_num + 1,   /* chunk number */
+                                       0 /* flag: unused */)) == NULL)
+                HE_REPORT_GOTO("failed to find chunk record", FAIL);
+
+            chk_dptr = chk_data; /* set chunk data ptr */
+
+            chk_dptr += read_seek; /* move to correct position in chunk */
+
+            /* copy data from chunk to users buffer */
+            memcpy(bptr, chk_dptr, chunk_size);
+
+            /* put chunk back to cache */
+            if (mcache_put(info->chk_cache, /* cache handle */
+                           chk_data,        /* whole data chunk */
+                           0 /* flag: 0->not DIRTY */) == FAIL)
+                HE_REPORT_GOTO("failed to put chunk back in cache", FAIL);
+        }
+
+        /* increment buffer pointer */
+        bptr += chunk_size;
+
+        /* adjust number of bytes already read */
+        bytes_read += chunk_size;
+
+        /* update relative position i.e. user element seek position
+           with chunk size written */
+        relative_posn += chunk_size;
+
+        /* i.e calculate chunk indices given seek location
+           this will update the proper arrays in the special info struct */
+        advance_chunk_indices_seek(relative_posn, chunk_size, info->ndims, info->nt_size,
+                                   info->seek_chunk_indices, info->seek_pos_chunk, info->ddims);
+    } /* end while "bytes_read" */
+
+    /* update access record position with bytes read */
+    access_rec->posn += bytes_read;
+
+    /* bring in the chunks of the next read of the pattern; readahead is
+       only a hint, the read that needs a chunk which could not be brought
+       in reads it again and reports the error */
+    if (info->readahead && info->ra_streak > 0 && info->ra_posn + stride < info->length * info->nt_size)
+        if (HMCIreadahead(access_rec, info->ra_posn + stride,
+                          MIN(length, info->length * info->nt_size - (info->ra_posn + stride))) == FAIL)
+            HEclear();
+
+    ret_value = bytes_read;
+
+done:
+    /* chunks decoded ahead are only kept for the duration of the read */
+    if (info != NULL)
+        HMCIfree_predecoded(info);
+
+    return ret_value;
+} /* HMCPread  */
+
+/* ----------------------------- HMCIflush_table -----------------------------
+NAME
+   HMCIflush_table -- write out the new chunk table records
+
+DESCRIPTION
+   Appends the records HMCIadd_chunk_record() kept in 'info->tbl_recs'
+   to the chunk table i.e. the Vdata with a single VSwrite().
+
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+static intn
+HMCIflush_table(chunkinfo_t *info /* IN: chunked element info */)
+{
+    intn ret_value = SUCCEED;
+
+    if (info->ntbl_recs > 0) {
+        if (VSwrite(info->aid, info->tbl_recs, info->ntbl_recs, FULL_INTERLACE) != info->ntbl_recs)
+            ret_value = FAIL;
+        info->ntbl_recs = 0;
+    }
+
+    return ret_value;
+} /* HMCIflush_table() */
+
+/* --------------------------- HMCIadd_chunk_record ---------------------------
+NAME
+   HMCIadd_chunk_record -- add a chunk to the chunk table
+
+DESCRIPTION
+   Gives a chunk that was not written yet its chunk tag/ref and
+   appends its record to the chunk table i.e. the Vdata.  The records
+   are kept in memory and written _HDF_CHK_TABLE_BATCH at a time, the
+   rest when the element is closed, see HMCIflush_table().
+
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+static intn
+HMCIadd_chunk_record(accrec_t  *access_rec, /* IN: access record of the element */
+                     CHUNK_REC *chk_rec /* IN/OUT: chunk record */)
+{
+    chunkinfo_t *info      = (chunkinfo_t *)(access_rec->special_info); /* chunked element info */
+    size_t       rec_size  = ((size_t)info->ndims * sizeof(int32)) + (2 * sizeof(uint16));
+    uint8       *pntr      = NULL;
+    int32        num       = chk_rec->chunk_number;
+    int32        origin;
+    intn         ret_value = SUCCEED;
+    intn         k; /* loop index */
+
+    /* Make room for one more Chunk record, doubling the buffer up to
+       a batch of records */
+    if (info->ntbl_recs == info->tbl_recs_max) {
+        int32  new_max = (info->tbl_recs_max == 0) ? 16 : MIN(2 * info->tbl_recs_max, _HDF_CHK_TABLE_BATCH);
+        uint8 *new_recs;
+
+        if ((new_recs = realloc(info->tbl_recs, (size_t)new_max * rec_size)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        info->tbl_recs     = new_recs;
+        info->tbl_recs_max = new_max;
+    }
+
+    /* Initialize chunk record */
+    chk_rec->chk_tag = DFTAG_CHUNK;
+    chk_rec->chk_ref = Htagnewref(access_rec->file_id, DFTAG_CHUNK);
+
+    if (chk_rec->chk_ref == 0) {
+        /* out of ref numbers -- extremely fatal  */
+        HGOTO_ERROR(DFE_NOREF, FAIL);
+    }
+    /* Copy origin first to vdata record, from the chunk number i.e. the
+       reverse of calculate_chunk_num() */
+    pntr = info->tbl_recs + (size_t)info->ntbl_recs * rec_size;
+    for (k = info->ndims - 1; k > 0; k--) {
+        origin = num % info->ddims[k].num_chunks;
+        num /= info->ddims[k].num_chunks;
+        memcpy(pntr + (size_t)k * sizeof(int32), &origin, sizeof(int32));
+    }
+    memcpy(pntr, &num, sizeof(int32));
+    pntr += (size_t)info->ndims * sizeof(int32);
+
+    /* Copy tag next */
+    memcpy(pntr, &chk_rec->chk_tag, sizeof(uint16));
+    pntr += sizeof(uint16);
+
+    /* Copy ref last */
+    memcpy(pntr, &chk_rec->chk_ref, sizeof(uint16));
+    info->ntbl_recs++;
+
+    /* Add a full batch to Vdata i.e. chunk table */
+    if (info->ntbl_recs == _HDF_CHK_TABLE_BATCH && HMCIflush_table(info) == FAIL)
+        HGOTO_ERROR(DFE_VSWRITE, FAIL);
+
+done:
+    return ret_value;
+} /* HMCIadd_chunk_record() */
+
+/* ----------------------------- HMCImemory_coder -----------------------------
+NAME
+   HMCImemory_coder -- are new chunks compressed in memory first?
+
+DESCRIPTION
+   With a limit set by HMCsetRawLimit(), new deflate and LZ4 chunks are
+   compressed in memory, to be stored as they are when that does not pay.
+   With a policy set by HMCsetCoderPolicy() they are compressed in memory
+   with the coder a trial picks for each of them.
+
+RETURNS
+   TRUE if HMCIencode_chunk() handles the new chunks of the element, FALSE
+   otherwise
+--------------------------------------------------------------------------- */
+static intn
+HMCImemory_coder(const chunkinfo_t *info /* IN: chunked element information record */)
+{
+    if ((info->raw_limit == 0 && info->coder_policy < 0) || (info->flag & 0xff) != SPECIAL_COMP ||
+        info->model_type != COMP_MODEL_STDIO)
+        return FALSE;
+#ifdef H4_HAVE_LIBLZ4
+    if (info->comp_type == COMP_CODE_LZ4)
+        return TRUE;
+#endif /* H4_HAVE_LIBLZ4 */
+    return info->comp_type == COMP_CODE_DEFLATE;
+} /* HMCImemory_coder() */
+
+/* ----------------------------- HMCIencode_bound -----------------------------
+NAME
+   HMCIencode_bound -- room needed to compress a chunk in memory
+
+RETURNS
+   The largest length 'data_len' bytes compress to with the deflate or
+   LZ4 coder of the element, or with either of them when the coder is
+   picked by HMCIpick_coder()
+--------------------------------------------------------------------------- */
+static int32
+HMCIencode_bound(const chunkinfo_t *info, /* IN: chunked element information record */
+                 int32              data_len /* IN: length of the chunk */)
+{
+    int32 bound = (int32)compressBound((uLong)data_len);
+
+#ifdef H4_HAVE_LIBLZ4
+    if (info->comp_type == COMP_CODE_LZ4 || info->coder_policy >= 0) {
+        LZ4F_preferences_t prefs;
+
+        HCPclz4_prefs(&prefs, info->comp_type == COMP_CODE_LZ4 ? info->cinfo->lz4.acceleration : 1);
+        bound = MAX(bound, (int32)LZ4F_compressFrameBound((size_t)data_len, &prefs));
+    }
+#else
+    (void)info;
+#endif /* H4_HAVE_LIBLZ4 */
+    return bound;
+} /* HMCIencode_bound() */
+
+/* ------------------------------ HMCIcompress ------------------------------
+NAME
+   HMCIcompress -- compress a buffer with the deflate or LZ4 coder
+
+DESCRIPTION
+   Compresses 'data_len' bytes into 'raw', which has room for '*raw_len'
+   bytes, and sets '*raw_len' to the compressed length.  Safe to call
+   from worker threads: nothing is pushed on the error stack.
+
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+static intn
+HMCIcompress(const chunk_coder_t *coder,    /* IN: coder and its parameters */
+             const uint8         *data,     /* IN: bytes to compress */
+             int32                data_len, /* IN: number of bytes */
+             uint8               *raw,      /* OUT: compressed bytes */
+             int32               *raw_len /* IN/OUT: room in 'raw', then compressed length */)
+{
+    uLongf comp_len;
+
+#ifdef H4_HAVE_LIBLZ4
+    if (coder->coder == COMP_CODE_LZ4) {
+        LZ4F_preferences_t prefs;
+        size_t             n;
+
+        HCPclz4_prefs(&prefs, coder->cinfo.lz4.acceleration);
+        n = LZ4F_compressFrame(raw, (size_t)*raw_len, data, (size_t)data_len, &prefs);
+        if (LZ4F_isError(n))
+            return FAIL;
+        *raw_len = (int32)n;
+        return SUCCEED;
+    }
+#endif /* H4_HAVE_LIBLZ4 */
+
+    comp_len = (uLongf)*raw_len;
+    if (compress2(raw, &comp_len, data, (uLong)data_len, coder->cinfo.deflate.level) != Z_OK)
+        return FAIL;
+    *raw_len = (int32)comp_len;
+    return SUCCEED;
+} /* HMCIcompress() */
+
+/* ------------------------------ HMCIpick_coder ------------------------------
+NAME
+   HMCIpick_coder -- choose the coder of a new chunk by a trial on a sample
+
+DESCRIPTION
+   Compresses 'sample_len' bytes with each candidate coder, from the
+   fastest to the slowest: LZ4 when the library has it, deflate at
+   level 1 and deflate at the level of the element, or 6 for an LZ4
+   element.  Picks the first one whose sample is at most
+   'info->coder_policy' percent larger than the smallest one.  'raw' has
+   room for 'raw_room' bytes.  Safe to call from worker threads.
+
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+static intn
+HMCIpick_coder(const chunkinfo_t *info,       /* IN: chunked element information record */
+               const uint8       *data,       /* IN: chunk to compress */
+               int32              sample_len, /* IN: number of bytes tried */
+               uint8             *raw,        /* OUT: scratch for the compressed sample */
+               int32              raw_room,   /* IN: room in 'raw' */
+               chunk_coder_t     *coder,      /* OUT: the coder picked */
+               int32             *coded_len /* OUT: length of the sample compressed with it */)
+{
+    chunk_coder_t cands[_HDF_CHK_MAX_CANDIDATES]; /* coders tried, fastest first */
+    int32         lens[_HDF_CHK_MAX_CANDIDATES];  /* lengths of the sample with each */
+    int32         best = -1;                      /* smallest of 'lens' */
+    intn          level;                          /* deflate level of the slowest candidate */
+    intn          ncands = 0;
+    intn          c;
+
+    memset(cands, 0, sizeof(cands));
+#ifdef H4_HAVE_LIBLZ4
+    cands[ncands].coder = COMP_CODE_LZ4;
+    cands[ncands++].cinfo.lz4.acceleration =
+        info->comp_type == COMP_CODE_LZ4 ? info->cinfo->lz4.acceleration : 1;
+#endif /* H4_HAVE_LIBLZ4 */
+    cands[ncands].coder                 = COMP_CODE_DEFLATE;
+    cands[ncands++].cinfo.deflate.level = 1;
+    level = info->comp_type == COMP_CODE_DEFLATE ? info->cinfo->deflate.level : 6;
+    if (level > 1) {
+        cands[ncands].coder                 = COMP_CODE_DEFLATE;
+        cands[ncands++].cinfo.deflate.level = level;
+    }
+
+    for (c = 0; c < ncands; c++) {
+        lens[c] = raw_room;
+        if (HMCIcompress(&cands[c], data, sample_len, raw, &lens[c]) == FAIL)
+            return FAIL;
+        if (best < 0 || lens[c] < best)
+            best = lens[c];
+    }
+
+    /* the fastest one close enough to the best, which is one of them */
+    for (c = 0; (float64)lens[c] * 100 > (float64)best * (100 + info->coder_policy); c++)
+        ;
+    *coder     = cands[c];
+    *coded_len = lens[c];
+    return SUCCEED;
+} /* HMCIpick_coder() */
+
+/* ----------------------------- HMCIencode_chunk -----------------------------
+NAME
+   HMCIencode_chunk -- compress a chunk in memory, unless it does not pay
+
+DESCRIPTION
+   Compresses a chunk into 'raw', which has room for HMCIencode_bound()
+   bytes, as given in '*raw_len', with the coder of the element or the
+   one HMCIpick_coder() picks under a policy set by HMCsetCoderPolicy().
+   With a limit set by HMCsetRawLimit(), '*plain' is set when the chunk
+   does not compress to the limit, and is then to be stored as it is.
+   The first _HDF_CHK_RAW_SAMPLE bytes of a larger chunk are compressed
+   first; the rest is not compressed when those do not compress to the
+   limit.  Safe to call from worker threads.
+
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+static intn
+HMCIencode_chunk(const chunkinfo_t *info,     /* IN: chunked element information record */
+                 const uint8       *data,     /* IN: chunk to compress */
+                 int32              data_len, /* IN: length of the chunk */
+                 uint8             *raw,      /* OUT: compressed chunk */
+                 int32             *raw_len,  /* IN/OUT: room in 'raw', then compressed length */
+                 chunk_coder_t     *coder,    /* OUT: coder the chunk was compressed with */
+                 intn              *plain /* OUT: TRUE to store the chunk as it is */)
+{
+    int32 sample_len = MIN(data_len, _HDF_CHK_RAW_SAMPLE); /* bytes compressed first */
+    int32 len        = -1; /* compressed length of the sample, -1 until compressed */
+
+    *plain = FALSE;
+    memset(coder, 0, sizeof(chunk_coder_t));
+    coder->coder = info->comp_type;
+    coder->cinfo = *info->cinfo;
+    if (info->coder_policy >= 0 &&
+        HMCIpick_coder(info, data, sample_len, raw, *raw_len, coder, &len) == FAIL)
+        return FAIL;
+
+    if (info->raw_limit > 0 && data_len > 2 * _HDF_CHK_RAW_SAMPLE) {
+        if (len < 0) {
+            len = *raw_len;
+            if (HMCIcompress(coder, data, sample_len, raw, &len) == FAIL)
+                return FAIL;
+        }
+        if ((float64)len * 100 > (float64)info->raw_limit * sample_len) {
+            *plain = TRUE;
+            return SUCCEED;
+        }
+    }
+
+    if (HMCIcompress(coder, data, data_len, raw, raw_len) == FAIL)
+        return FAIL;
+    if (info->raw_limit > 0 && (float64)*raw_len * 100 > (float64)info->raw_limit * data_len)
+        *plain = TRUE;
+    return SUCCEED;
+} /* HMCIencode_chunk() */
+
+/* ------------------------------ HMCIwrite_coded ------------------------------
+NAME
+   HMCIwrite_coded -- write out a chunk compressed in memory
+
+DESCRIPTION
+   Writes a new chunk, compressed by HMCIencode_chunk(), with the record
+   added to the chunk table for it.  Its compression header records the
+   coder it was compressed with.  A chunk to be stored as it is gets an
+   element that is not special.
+
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+static intn
+HMCIwrite_coded(accrec_t            *access_rec, /* IN: access record of the element */
+                CHUNK_REC           *chk_rec,    /* IN: chunk record */
+                const uint8         *data,       /* IN: the chunk */
+                int32                data_len,   /* IN: length of the chunk */
+                const chunk_coder_t *coder,      /* IN: coder 'raw' was compressed with */
+                const uint8         *raw,        /* IN: the chunk compressed */
+                int32                raw_len,    /* IN: length of 'raw' */
+                intn                 plain /* IN: TRUE to store the chunk as it is */)
+{
+    chunkinfo_t *info      = (chunkinfo_t *)(access_rec->special_info);
+    comp_info    cinfo     = coder->cinfo; /* parameters of the coder */
+    int32        chk_id    = FAIL;         /* chunk access id */
+    intn         ret_value = SUCCEED;
+
+    /* the checksum of the stored data while it is in memory */
+    if (info->sums_on && HMCIchunk_sums(info, chk_rec->chunk_number, plain ? data : raw,
+                                        plain ? data_len : raw_len, TRUE) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    if (!plain) {
+        if (HCPwrite_compressed(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref, info->model_type,
+                                info->minfo, coder->coder, &cinfo, data_len, raw, raw_len) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        HGOTO_DONE(SUCCEED);
+    }
 
-        /* currently get chunk data from cache based on chunk number
-           Note the cache deals with objects starting from 1 not 0 */
-        if ((chk_data = mcache_get(info->chk_cache, /* cache handle */
-                                   chunk_num + 1,   /* chunk number */
-                                   0 /* flag: unused */)) == NULL)
-            HE_REPORT_GOTO("failed to find chunk record", FAIL);
+    if ((chk_id = Hstartwrite(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref, data_len)) == FAIL)
+        HE_REPORT_GOTO("Hstartwrite failed to write chunk", FAIL);
+    if (Hwrite(chk_id, data_len, data) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
 
-        chk_dptr = chk_data; /* set chunk data ptr */
+done:
+    if (chk_id != FAIL && Hendaccess(chk_id) == FAIL)
+        ret_value = FAIL;
 
-        /* copy data from chunk to users buffer */
-        memcpy(bptr, chk_dptr, read_len);
+    return ret_value;
+} /* HMCIwrite_coded() */
 
-        /* put chunk back to cache and mark it as *not* DIRTY */
-        if (mcache_put(info->chk_cache, /* cache handle */
-                       chk_data,        /* whole data chunk */
-                       0 /* flag: 0->not DIRTY */) == FAIL)
-            HE_REPORT_GOTO("failed to put chunk back in cache", FAIL);
+/* ------------------------------ HMCIwrite_chunk ------------------------------
+NAME
+   HMCIwrite_chunk -- write out chunk data
 
-        /* adjust number of bytes already read */
-        bytes_read = read_len;
+DESCRIPTION
+   Write a whole chunk to the file, creating the chunk (compressed if
+   the element is) and its chunk table record if it was not written
+   before.  With a limit set by HMCsetRawLimit() or a policy set by
+   HMCsetCoderPolicy(), a new chunk is compressed in memory first, see
+   HMCIencode_chunk().
 
-        /*update chunk seek indices after reading chunk */
-        update_seek_pos_chunk(bytes_read, info->ndims, info->nt_size, info->seek_pos_chunk, info->ddims);
+RETURNS
+   The number of bytes written or FAIL on error
+--------------------------------------------------------------------------- */
+static int32
+HMCIwrite_chunk(accrec_t   *access_rec, /* IN: access record of the element */
+                CHUNK_REC  *chk_rec,    /* IN: chunk record */
+                const void *datap /* IN: buffer for data */)
+{
+    chunkinfo_t  *info          = NULL;  /* chunked element information record */
+    filerec_t    *file_rec      = NULL;  /* file record */
+    atom_t        ddid;                  /* DD of the chunk */
+    intn          shared;                /* whether the chunk shares its data */
+    intn          create        = FALSE; /* whether the chunk is written anew */
+    int32         chk_id        = FAIL;  /* chunkd access id */
+    int32         bytes_written = 0;     /* total #bytes written by HMCIwrite */
+    int32         write_len     = 0;     /* nbytes to write next */
+    uint8        *raw           = NULL;  /* the chunk compressed in memory */
+    int32         raw_len;               /* length of 'raw' */
+    intn          plain;                 /* TRUE to store the chunk as it is */
+    chunk_coder_t coder;                 /* coder 'raw' was compressed with */
+    int32         ret_value     = SUCCEED;
 
-        /* compute user array for chunk arrays */
-        compute_chunk_to_array(info->seek_chunk_indices, info->seek_pos_chunk, info->seek_user_indices,
-                               info->ndims, info->ddims);
+    /* Set inputs */
+    info      = (chunkinfo_t *)(access_rec->special_info);
+    write_len = (info->chunk_size * info->nt_size);
 
-        /* calculate new read seek position in element from user array */
-        compute_array_to_seek(&relative_posn, info->seek_user_indices, info->nt_size, info->ndims,
-                              info->ddims);
+    /* Check to see if already created in chunk table */
+    if (chk_rec->chk_tag == DFTAG_NULL) { /* does not exists in Vdata table and in file but does in TBBT */
+        if (HMCIadd_chunk_record(access_rec, chk_rec) == FAIL)
+            HGOTO_ERROR(DFE_VSWRITE, FAIL);
+        create = TRUE;
+    }
+    else { /* data shared with another chunk, see HMCsetDedup(), is not written over */
+        file_rec = HAatom_object(access_rec->file_id);
+        if ((ddid = HTPselect(file_rec, chk_rec->chk_tag, chk_rec->chk_ref)) == FAIL)
+            HGOTO_ERROR(DFE_NOMATCH, FAIL);
+        shared = HTPshares_data(ddid);
+        if (HTPendaccess(ddid) == FAIL || shared == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        if (shared) {
+            if (Hdeldd(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref) == FAIL)
+                HGOTO_ERROR(DFE_CANTDELDD, FAIL);
+            create = TRUE;
+        }
+    }
 
-        /* update access record with bytes read */
-        access_rec->posn = relative_posn;
+    /* a new chunk is compressed in memory first when it may be stored as
+       it is or its coder is picked by a trial, see HMCsetRawLimit() and
+       HMCsetCoderPolicy() */
+    if (create && HMCImemory_coder(info)) {
+        raw_len = HMCIencode_bound(info, write_len);
+        if ((raw = (uint8 *)malloc((size_t)raw_len)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if (HMCIencode_chunk(info, datap, write_len, raw, &raw_len, &coder, &plain) == SUCCEED) {
+            if (HMCIwrite_coded(access_rec, chk_rec, datap, write_len, &coder, raw, raw_len, plain) == FAIL)
+                HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+            HGOTO_DONE(write_len);
+        }
+    }
 
-        ret_value = bytes_read;
+    if (create) {
+        /* Create compressed chunk if set
+           else start write access on element */
+        switch (info->flag & 0xff) /* only using 8bits for now */
+        {
+            case SPECIAL_COMP: /* Create compressed chunk */
+                if ((chk_id = HCcreate(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref,
+                                       info->model_type, info->minfo, info->comp_type, info->cinfo)) == FAIL)
+                    HE_REPORT_GOTO("HCcreate failed to read chunk", FAIL);
+                break;
+            default:
+                /* Start write on chunk */
+                if ((chk_id = Hstartwrite(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref,
+                                          write_len)) == FAIL)
+                    HE_REPORT_GOTO("Hstartwrite failed to read chunk", FAIL);
+                break;
+        }
+    }      /* not already in file */
+    else { /* Already in file so start access */
+        /* Start write on chunk */
+        if ((chk_id = Hstartwrite(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref, write_len)) ==
+            FAIL)
+            HE_REPORT_GOTO("Hstartwrite failed to read chunk", FAIL);
     }
-    else /* not special chunked element */
-        ret_value = FAIL;
+
+    /* write data to chunk */
+    if (Hwrite(chk_id, write_len, datap) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+    bytes_written = write_len;
+
+    /* end access to chunk */
+    if (Hendaccess(chk_id) == FAIL)
+        HE_REPORT_GOTO("Hendaccess failed to end access to chunk", FAIL);
+
+    ret_value = bytes_written;
 
 done:
+    if (ret_value == FAIL) { /* Error condition cleanup */
+        if (chk_id != FAIL)
+            Hendaccess(chk_id);
+    }
+    free(raw);
+
     return ret_value;
-} /* HMCreadChunk() */
+} /* HMCIwrite_chunk() */
 
-/* ------------------------------- HMCPread --------------------------------
+/* ------------------------------ HMCIencode_task ------------------------------
 NAME
-   HMCPread - read data from a chunked element
+   HMCIencode_task -- compress one chunk of the write-behind queue
 
 DESCRIPTION
-   Read in some data from a chunked element.
-
-   Data is obtained from the cache which takes care of reading
-   in the proper chunks to satisfy the request.
+   Task routine for htpool_run().  Like HMCIdecode_task() it runs on a
+   worker thread and only touches its own queue entry.
 
 RETURNS
-   The number of bytes read or FAIL on error
-AUTHOR
-   -GeorgeV - 9/3/96
+   Nothing
 --------------------------------------------------------------------------- */
-static int32
-HMCPread(accrec_t *access_rec, /* IN: access record to mess with */
-         int32     length,     /* IN: number of bytes to read */
-         void     *datap /* OUT: buffer for data */)
+static void
+HMCIencode_task(void *arg, /* IN: chunked element information record */
+                int32 task /* IN: index of the queue entry to encode */)
 {
-    chunkinfo_t *info          = NULL; /* information record for this special data elt */
-    int32        relative_posn = 0;    /* relative position in chunk of data elt */
-    int32        bytes_read    = 0;    /* total # bytes read for this call of HMCIread */
-    uint8       *bptr          = NULL; /* data buffer pointer */
-    int32        read_len      = 0;    /* amount of data to copy */
-    int32        read_seek     = 0;    /* next read seek position */
-    int32        chunk_size    = 0;    /* size of data to read from chunk */
-    int32        chunk_num     = 0;    /* next chunk number */
-    void        *chk_data      = NULL; /* chunk data */
-    uint8       *chk_dptr      = NULL; /* pointer to chunk data */
-    int32        ret_value     = SUCCEED;
+    chunkinfo_t   *info = (chunkinfo_t *)arg;
+    chunk_coded_t *pd   = &info->pending[task];
 
-    /* Check args */
-    if (access_rec == NULL)
-        HGOTO_ERROR(DFE_ARGS, FAIL);
+    pd->status = FAIL;
+    if (pd->raw == NULL)
+        return;
 
-    /* set inputs */
-    info          = (chunkinfo_t *)(access_rec->special_info);
-    relative_posn = access_rec->posn; /* current seek position in element */
+    pd->status =
+        HMCIencode_chunk(info, pd->data, pd->data_len, pd->raw, &pd->raw_len, &pd->coder, &pd->plain);
+} /* HMCIencode_task() */
 
-    /* validate length and set proper length */
-    if (length == 0)
-        length = (info->length * info->nt_size) - access_rec->posn;
-    else if (length < 0)
-        HGOTO_ERROR(DFE_RANGE, FAIL);
+/* ---------------------------- HMCIpendcompare ----------------------------
+NAME
+   HMCIpendcompare -- orders write-behind queue entries by chunk number
+--------------------------------------------------------------------------- */
+static int
+HMCIpendcompare(const void *p1, const void *p2)
+{
+    int32 n1 = ((const chunk_coded_t *)p1)->chunk_num;
+    int32 n2 = ((const chunk_coded_t *)p2)->chunk_num;
 
-    if (access_rec->posn + length > (info->length * info->nt_size))
-        length = (info->length * info->nt_size) - access_rec->posn;
+    return (n1 > n2) - (n1 < n2);
+} /* HMCIpendcompare() */
 
-    /* should chunk indices be updated with relative_posn?
-       or did last operation update it already */
-    update_chunk_indices_seek(access_rec->posn, info->ndims, info->nt_size, info->seek_chunk_indices,
-                              info->seek_pos_chunk, info->ddims);
+/* ----------------------------- HMCIflush_pending -----------------------------
+NAME
+   HMCIflush_pending -- write out the write-behind queue
 
-    /* enter translating length to proper filling of buffer from chunks */
-    bptr       = datap;
-    bytes_read = 0;
-    read_len   = length;
-    while (bytes_read < read_len) {
-        /* calculate chunk to retrieve on this pass */
-        calculate_chunk_num(&chunk_num, info->ndims, info->seek_chunk_indices, info->ddims);
+DESCRIPTION
+   Compresses the queued chunks on the worker threads, see
+   HMCIencode_chunk(), and then writes them out on the calling thread in
+   chunk number order.  As chunk refs are handed out in increasing order
+   the chunks end up in the file in tag/ref order.  A chunk that failed
+   to compress is written through the serial path of HMCIwrite_chunk().
 
-        /* calculate contiguous chunk size that we can read from this chunk
-           during this pass */
-        calculate_chunk_for_chunk(&chunk_size, info->ndims, info->nt_size, read_len, bytes_read,
-                                  info->seek_chunk_indices, info->seek_pos_chunk, info->ddims);
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+static intn
+HMCIflush_pending(accrec_t *access_rec /* IN: access record of the element */)
+{
+    chunkinfo_t   *info    = NULL; /* chunked element information record */
+    chunk_coded_t *pd      = NULL; /* queue entry */
+    CHUNK_REC     *chk_rec = NULL; /* chunk record */
+    int32          i;
+    intn           ret_value = SUCCEED;
 
-        /* would be nice to get Chunk record from TBBT based on chunk number
-           and then get chunk data base on chunk vdata number but
-           currently the chunk calculations return chunk
-           numbers and not Vdata record numbers.
-           This would reduce some overhead in the number of chunks
-           dealt with in the cache */
+    info = (chunkinfo_t *)(access_rec->special_info);
+    if (info->npending == 0)
+        HGOTO_DONE(SUCCEED);
+    info->comp_bytes = -1; /* see HMCgetChunkSizes() */
+
+    /* room for the compressed chunks */
+    for (i = 0; i < info->npending; i++) {
+        pd          = &info->pending[i];
+        pd->raw_len = HMCIencode_bound(info, pd->data_len);
+        if ((pd->raw = (uint8 *)malloc((size_t)pd->raw_len)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    }
 
-        /* currently get chunk data from cache based on chunk number
-           Note the cache deals with objects starting from 1 not 0 */
-        if ((chk_data = mcache_get(info->chk_cache, /* cache handle */
-                                   chunk_num + 1,   /* chunk number */
-                                   0 /* flag: unused */)) == NULL)
+    /* compress them on the worker threads */
+    if (htpool_run(info->nthreads, info->npending, HMCIencode_task, info) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* and write them out in order */
+    qsort(info->pending, (size_t)info->npending, sizeof(chunk_coded_t), HMCIpendcompare);
+    for (i = 0; i < info->npending; i++) {
+        pd = &info->pending[i];
+
+        if (HMCIfind_chunk(info, pd->chunk_num, &chk_rec) == FAIL || chk_rec == NULL)
             HE_REPORT_GOTO("failed to find chunk record", FAIL);
 
-        chk_dptr = chk_data; /* set chunk data ptr */
+        if (pd->status == SUCCEED) {
+            if (HMCIadd_chunk_record(access_rec, chk_rec) == FAIL)
+                HGOTO_ERROR(DFE_VSWRITE, FAIL);
+            if (HMCIwrite_coded(access_rec, chk_rec, pd->data, pd->data_len, &pd->coder, pd->raw,
+                                pd->raw_len, pd->plain) == FAIL)
+                HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        }
+        else if (HMCIwrite_chunk(access_rec, chk_rec, pd->data) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    }
 
-        /* calculate position in chunk */
-        calculate_seek_in_chunk(&read_seek, info->ndims, info->nt_size, info->seek_pos_chunk, info->ddims);
+done:
+    /* the queue is emptied even on failure, as the cache already
+       considers these chunks written */
+    if (info != NULL) {
+        for (i = 0; i < info->npending; i++) {
+            free(info->pending[i].raw);
+            free(info->pending[i].data);
+        }
+        free(info->pending);
+        info->pending  = NULL;
+        info->npending = 0;
+    }
 
-        chk_dptr += read_seek; /* move to correct position in chunk */
+    return ret_value;
+} /* HMCIflush_pending() */
 
-        /* copy data from chunk to users buffer */
-        memcpy(bptr, chk_dptr, chunk_size);
+/* ----------------------------- HMCIqueue_pending -----------------------------
+NAME
+   HMCIqueue_pending -- add a chunk to the write-behind queue
 
-        /* put chunk back to cache */
-        if (mcache_put(info->chk_cache, /* cache handle */
-                       chk_data,        /* whole data chunk */
-                       0 /* flag: 0->not DIRTY */) == FAIL)
-            HE_REPORT_GOTO("failed to put chunk back in cache", FAIL);
+DESCRIPTION
+   Keeps a copy of a chunk that was never written, to be compressed and
+   written with other chunks by HMCIflush_pending().  The queue holds up
+   to _HDF_CHK_PENDING_PER_THREAD chunks per encoding thread and is
+   flushed when full.
 
-        /* increment buffer pointer */
-        bptr += chunk_size;
+RETURNS
+   SUCCEED / FAIL
+--------------------------------------------------------------------------- */
+static intn
+HMCIqueue_pending(accrec_t   *access_rec, /* IN: access record of the element */
+                  int32       chunk_num,  /* IN: chunk number */
+                  const void *datap /* IN: chunk data */)
+{
+    chunkinfo_t   *info = NULL; /* chunked element information record */
+    chunk_coded_t *pd   = NULL; /* queue entry */
+    int32          maxpending;  /* capacity of the queue */
+    intn           ret_value = SUCCEED;
 
-        /* adjust number of bytes already read */
-        bytes_read += chunk_size;
+    info       = (chunkinfo_t *)(access_rec->special_info);
+    maxpending = (int32)info->nthreads * _HDF_CHK_PENDING_PER_THREAD;
 
-        /* update relative position i.e. user element seek position
-           with chunk size written */
-        relative_posn += chunk_size;
+    if (info->npending == maxpending)
+        if (HMCIflush_pending(access_rec) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
 
-        /* i.e calculate chunk indices given seek location
-           this will update the proper arrays in the special info struct */
-        update_chunk_indices_seek(relative_posn, info->ndims, info->nt_size, info->seek_chunk_indices,
-                                  info->seek_pos_chunk, info->ddims);
-    } /* end while "bytes_read" */
+    if (info->pending == NULL)
+        if ((info->pending = (chunk_coded_t *)calloc((size_t)maxpending, sizeof(chunk_coded_t))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
-    /* update access record position with bytes read */
-    access_rec->posn += bytes_read;
+    pd = &info->pending[info->npending];
 
-    ret_value = bytes_read;
+    pd->chunk_num = chunk_num;
+    pd->data_len  = info->chunk_size * info->nt_size;
+    pd->raw       = NULL;
+    pd->raw_len   = 0;
+    pd->status    = FAIL;
+    pd->plain     = FALSE;
+    if ((pd->data = (uint8 *)malloc((size_t)pd->data_len)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    memcpy(pd->data, datap, pd->data_len);
+
+    info->npending++;
 
 done:
     return ret_value;
-} /* HMCPread  */
+} /* HMCIqueue_pending() */
 
 /* ------------------------------- HMCPchunkwrite -------------------------------
 NAME
@@ -2890,6 +8010,15 @@ DESCRIPTION
    This is used as the 'page-out-chunk' routine for the cache.
    Only the cache should call this routine.
 
+   When the element is deflate or LZ4 compressed and more than one coding
+   thread was set with HMCsetThreads(), chunks that were never written
+   go to the write-behind queue instead; see HMCIqueue_pending().
+
+   With HMCsetSparse() on, a chunk that was never written and holds only
+   fill values is not written at all: it reads as fill values as it is.
+   With HMCsetDedup() on, one that is the same as a chunk written before
+   shares its data; see HMCIdedup_chunk().
+
 RETURNS
    The number of bytes written or FAIL on error
 AUTHOR
@@ -2900,120 +8029,107 @@ HMCPchunkwrite(void       *cookie,    /* IN: access record to mess with */
                int32       chunk_num, /* IN: chunk number */
                const void *datap /* IN: buffer for data */)
 {
-    accrec_t    *access_rec    = (accrec_t *)cookie; /* access record */
-    chunkinfo_t *info          = NULL;               /* chunked element information record */
-    CHUNK_REC   *chk_rec       = NULL;               /* current chunk */
-    TBBT_NODE   *entry         = NULL;               /* node off of  chunk tree */
-    uint8       *v_data        = NULL;               /* chunk table record i.e Vdata record */
-    CHUNK_REC   *chkptr        = NULL;               /* Chunk record to inserted in TBBT  */
-    const void  *bptr          = NULL;               /* data buffer pointer */
-    int32        chk_id        = FAIL;               /* chunkd access id */
-    int32        bytes_written = 0;                  /* total #bytes written by HMCIwrite */
-    int32        write_len     = 0;                  /* nbytes to write next */
-    int32        ret_value     = SUCCEED;
-    intn         k; /* loop index */
+    accrec_t      *access_rec = (accrec_t *)cookie; /* access record */
+    chunkinfo_t   *info       = NULL;               /* chunked element information record */
+    CHUNK_REC     *chk_rec    = NULL;               /* current chunk */
+    chunk_coded_t *pd         = NULL;               /* write-behind queue entry */
+    int32          write_len  = 0;                  /* nbytes to write next */
+    intn           shared;                          /* shares the data of another chunk */
+    int32          ret_value  = SUCCEED;
 
     /* Check args */
     if (access_rec == NULL)
-        HGOTO_ERROR(DFE_ARGS, FAIL);
-
-    /* Set inputs */
-    info          = (chunkinfo_t *)(access_rec->special_info);
-    write_len     = (info->chunk_size * info->nt_size);
-    bytes_written = 0;
-    bptr          = datap;
-
-    /* find chunk record in TBBT */
-    if ((entry = (tbbtdfind(info->chk_tree, &chunk_num, NULL))) == NULL)
-        HE_REPORT_GOTO("failed to find chunk record", FAIL);
-
-    chk_rec = (CHUNK_REC *)entry->data; /* get file entry from node */
-
-    /* Check to see if already created in chunk table */
-    if (chk_rec->chk_tag == DFTAG_NULL) { /* does not exists in Vdata table and in file but does in TBBT */
-        uint8 *pntr = NULL;
-
-        chkptr = chk_rec;
-        /* so create a new Vdata record */
-        /* Allocate space for a single Chunk record in Vdata */
-        if (v_data == NULL) {
-            if ((v_data = malloc(((size_t)info->ndims * sizeof(int32)) + (2 * sizeof(uint16)))) == NULL)
-                HGOTO_ERROR(DFE_NOSPACE, FAIL);
-        }
-
-        /* Initialize chunk record */
-        chkptr->chk_tag = DFTAG_CHUNK;
-        chkptr->chk_ref = Htagnewref(access_rec->file_id, DFTAG_CHUNK);
-
-        if (chkptr->chk_ref == 0) {
-            /* out of ref numbers -- extremely fatal  */
-            HGOTO_ERROR(DFE_NOREF, FAIL);
-        }
-        /* Copy origin first to vdata record*/
-        pntr = v_data;
-        for (k = 0; k < info->ndims; k++) {
-            memcpy(pntr, &chkptr->origin[k], sizeof(int32));
-            pntr += sizeof(int32);
-        }
-
-        /* Copy tag next */
-        memcpy(pntr, &chkptr->chk_tag, sizeof(uint16));
-        pntr += sizeof(uint16);
-
-        /* Copy ref last */
-        memcpy(pntr, &chkptr->chk_ref, sizeof(uint16));
-
-        /* Add to Vdata i.e. chunk table */
-        if (VSwrite(info->aid, v_data, 1, FULL_INTERLACE) == FAIL)
-            HGOTO_ERROR(DFE_VSWRITE, FAIL);
-
-        /* Create compressed chunk if set
-           else start write access on element */
-        switch (info->flag & 0xff) /* only using 8bits for now */
-        {
-            case SPECIAL_COMP: /* Create compressed chunk */
-                if ((chk_id = HCcreate(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref,
-                                       info->model_type, info->minfo, info->comp_type, info->cinfo)) == FAIL)
-                    HE_REPORT_GOTO("HCcreate failed to read chunk", FAIL);
-                break;
-            default:
-                /* Start write on chunk */
-                if ((chk_id = Hstartwrite(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref,
-                                          write_len)) == FAIL)
-                    HE_REPORT_GOTO("Hstartwrite failed to read chunk", FAIL);
-                break;
-        }
-    }      /* not already in Vdata table */
-    else { /* Already in table so start access */
-        /* Start write on chunk */
-        if ((chk_id = Hstartwrite(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref, write_len)) ==
-            FAIL)
-            HE_REPORT_GOTO("Hstartwrite failed to read chunk", FAIL);
-    }
+        HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* write data to chunk */
-    if (Hwrite(chk_id, write_len, bptr) == FAIL)
-        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    /* Set inputs */
+    info      = (chunkinfo_t *)(access_rec->special_info);
+    write_len = (info->chunk_size * info->nt_size);
 
-    bytes_written = write_len;
+    info->comp_bytes = -1; /* see HMCgetChunkSizes() */
 
-    /* end access to chunk */
-    if (Hendaccess(chk_id) == FAIL)
-        HE_REPORT_GOTO("Hendaccess failed to end access to chunk", FAIL);
+    /* find chunk record */
+    if (HMCIfind_chunk(info, chunk_num, &chk_rec) == FAIL || chk_rec == NULL)
+        HE_REPORT_GOTO("failed to find chunk record", FAIL);
 
-    ret_value = bytes_written;
+    /* statistics of the chunk, see HMCsetStats() */
+    if (!info->stats_looked && HMCIload_stats(access_rec) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (info->stats_nt != 0 && HMCIchunk_stats(info, chunk_num, datap) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
-done:
-    if (ret_value == FAIL) { /* Error condition cleanup */
-        if (chk_id != FAIL)
-            Hendaccess(chk_id);
+    /* and its checksums, see HMCsetChecksums() */
+    if (!info->sums_looked && HMCIload_sums(access_rec) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (info->sums_on && HMCIchunk_sums(info, chunk_num, datap, write_len, FALSE) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* chunk already waiting to be written? */
+    if ((pd = HMCIfind_pending(info, chunk_num)) != NULL) {
+        memcpy(pd->data, datap, write_len);
+        HGOTO_DONE(write_len);
     }
 
-    free(v_data);
+    /* new chunk of nothing but fill values? */
+    if (info->sparse && chk_rec->chk_tag == DFTAG_NULL && HMCIall_fill(info, datap))
+        HGOTO_DONE(write_len);
+
+    /* new chunk the same as one written before? */
+    if (info->dedup && chk_rec->chk_tag == DFTAG_NULL) {
+        if ((shared = HMCIdedup_chunk(access_rec, chk_rec, datap, write_len, FALSE)) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        if (shared)
+            HGOTO_DONE(write_len);
+    }
+
+    /* new compressed chunk with write-behind on? */
+    if (chk_rec->chk_tag == DFTAG_NULL && HMCIthreaded_coder(info)) {
+        if (HMCIqueue_pending(access_rec, chunk_num, datap) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        HGOTO_DONE(write_len);
+    }
 
+    ret_value = HMCIwrite_chunk(access_rec, chk_rec, datap);
+
+done:
     return ret_value;
 } /* HMCPchunkwrite() */
 
+/* --------------------------- HMCIget_chunk_record ---------------------------
+NAME
+   HMCIget_chunk_record -- find or create the record of a chunk
+
+DESCRIPTION
+   Looks up the record of a chunk and, if the chunk is not known yet,
+   makes a record for it that marks it as not written.
+
+RETURNS
+   The chunk record or NULL on error
+--------------------------------------------------------------------------- */
+static CHUNK_REC *
+HMCIget_chunk_record(chunkinfo_t *info, /* IN: chunked element information record */
+                     int32        chunk_num /* IN: chunk number */)
+{
+    CHUNK_REC *chkptr    = NULL; /* Chunk record of the chunk */
+    CHUNK_REC *ret_value = NULL;
+
+    if (HMCIfind_chunk(info, chunk_num, &chkptr) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, NULL);
+    if (chkptr != NULL)
+        HGOTO_DONE(chkptr);
+
+    /* not known so create a new chunk record */
+    if ((chkptr = HMCInew_chunk(info, chunk_num)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, NULL);
+
+    /* count it as the next Vdata record */
+    info->num_recs++;
+
+    ret_value = chkptr;
+
+done:
+    return ret_value;
+} /* HMCIget_chunk_record() */
+
 /* ------------------------------- HMCwriteChunk ---------------------------
 NAME
    HMCwriteChunk -- write out a whole chunk
@@ -3038,8 +8154,6 @@ HMCwriteChunk(int32       access_id, /* IN: access aid to mess with */
     accrec_t    *access_rec = NULL;  /* access record */
     filerec_t   *file_rec   = NULL;  /* file record */
     chunkinfo_t *info       = NULL;  /* chunked element information record */
-    CHUNK_REC   *chkptr     = NULL;  /* Chunk record to inserted in TBBT  */
-    int32       *chk_key    = NULL;  /* Chunk record key for insertion in TBBT */
     const void  *bptr       = NULL;  /* data buffer pointer */
     void        *chk_data   = NULL;  /* chunk data */
     uint8       *chk_dptr   = NULL;  /* chunk data pointer */
@@ -3047,10 +8161,12 @@ HMCwriteChunk(int32       access_id, /* IN: access aid to mess with */
     int32        bytes_written = 0;  /* total #bytes written by HMCIwrite */
     int32        write_len     = 0;  /* bytes to write next */
     int32        chunk_num     = -1; /* chunk number */
+    filerec_t   *locked        = NULL;
     int32        ret_value     = SUCCEED;
-    intn         k; /* loop index */
     intn         i;
 
+    locked = HL_LOCK_AID(access_id);
+
     /* Check args */
     access_rec = HAatom_object(access_id);
     if (access_rec == NULL)
@@ -3088,44 +8204,10 @@ HMCwriteChunk(int32       access_id, /* IN: access aid to mess with */
         /* calculate chunk number from origin */
         calculate_chunk_num(&chunk_num, info->ndims, origin, info->ddims);
 
-        /* find chunk record in TBBT */
-        if (tbbtdfind(info->chk_tree, &chunk_num, NULL) == NULL) { /* not in tree */
-
-            /* so create a new chunk record */
-            /* Allocate space for a chunk record */
-            if ((chkptr = (CHUNK_REC *)malloc(sizeof(CHUNK_REC))) == NULL)
-                HGOTO_ERROR(DFE_NOSPACE, FAIL);
-
-            /* Allocate space for a origin in chunk record */
-            if ((chkptr->origin = (int32 *)malloc((size_t)info->ndims * sizeof(int32))) == NULL)
-                HGOTO_ERROR(DFE_NOSPACE, FAIL);
-
-            /* allocate space for key */
-            if ((chk_key = (int32 *)malloc(sizeof(int32))) == NULL)
-                HGOTO_ERROR(DFE_NOSPACE, FAIL);
-
-            /* Initialize chunk record */
-            chkptr->chk_tag = DFTAG_NULL;
-            chkptr->chk_ref = 0;
-
-            /* Initialize chunk origins */
-            for (k = 0; k < info->ndims; k++) {
-                chkptr->origin[k] = origin[k];
-            }
-
-            /* set chunk record number to next Vdata record number */
-            chkptr->chk_vnum = info->num_recs++;
-
-            /* set key to chunk number */
-            chkptr->chunk_number = *chk_key = chunk_num;
-
-            /* add to TBBT tree based on chunk number as the key */
-            tbbtdins(info->chk_tree, chkptr, chk_key);
+        /* find chunk record, create it if not there */
+        if (HMCIget_chunk_record(info, chunk_num) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
-            /* re-initialize ptrs to allow for error-failure check */
-            chkptr  = NULL;
-            chk_key = NULL;
-        }
         /* would be nice to get Chunk record from TBBT based on chunk number
            and then get chunk data base on chunk vdata number but
            currently the chunk calculations return chunk
@@ -3134,10 +8216,11 @@ HMCwriteChunk(int32       access_id, /* IN: access aid to mess with */
            dealt with in the cache */
 
         /* get chunk data from cache based on chunk number
-           chunks in the cache start from 1 not 0 */
+           chunks in the cache start from 1 not 0; the chunk is
+           overwritten whole so it is not read in */
         if ((chk_data = mcache_get(info->chk_cache, /* cache handle */
                                    chunk_num + 1,   /* chunk number */
-                                   0 /* flag: unused */)) == NULL)
+                                   MCACHE_NOREAD /* flag: no read */)) == NULL)
             HE_REPORT_GOTO("failed to find chunk record", FAIL);
 
         chk_dptr = chk_data; /* set chunk data ptr */
@@ -3172,17 +8255,416 @@ HMCwriteChunk(int32       access_id, /* IN: access aid to mess with */
         ret_value = FAIL;
 
 done:
-    if (ret_value == FAIL) { /* Error condition cleanup */
-        /* check chunk ptrs */
-        if (chkptr != NULL) {
-            free(chkptr->origin);
-            free(chkptr);
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* HMCwriteChunk */
+
+/* ------------------------------ HMCIread_stored ------------------------------
+NAME
+   HMCIread_stored -- read the data of a chunk as stored in the file
+
+DESCRIPTION
+   Copies the data of a written chunk as it is stored in the file, i.e.
+   still compressed if the element is, into 'datap', which holds 'buflen'
+   bytes.  With 'datap' NULL only the length of the data is found.
+
+RETURNS
+   The number of bytes of stored data or FAIL on error
+--------------------------------------------------------------------------- */
+static int32
+HMCIread_stored(accrec_t  *access_rec, /* IN: access record of the element */
+                CHUNK_REC *chk_rec,    /* IN: chunk record */
+                void      *datap,      /* OUT: buffer for the stored data */
+                int32      buflen /* IN: size of 'datap' */)
+{
+    filerec_t *file_rec = NULL; /* file record */
+    int32     *offsets  = NULL; /* offsets of the data blocks */
+    int32     *lengths  = NULL; /* lengths of the data blocks */
+    intn       nblocks;         /* number of data blocks */
+    intn       b;               /* loop index */
+    int32      raw_len   = 0;   /* bytes of stored data */
+    int32      ret_value = SUCCEED;
+
+    file_rec = HAatom_object(access_rec->file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* locate the stored data */
+    if ((nblocks = HDgetdatainfo(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref, NULL, 0, 0, NULL,
+                                 NULL)) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (nblocks == 0)
+        HGOTO_DONE(0);
+
+    if ((offsets = (int32 *)malloc((size_t)nblocks * sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if ((lengths = (int32 *)malloc((size_t)nblocks * sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if (HDgetdatainfo(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref, NULL, 0, (uintn)nblocks,
+                      offsets, lengths) != nblocks)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    for (b = 0; b < nblocks; b++)
+        raw_len += lengths[b];
+
+    if (datap == NULL)
+        HGOTO_DONE(raw_len);
+    if (buflen < raw_len)
+        HGOTO_ERROR(DFE_NOTENOUGH, FAIL);
+
+    /* and copy it */
+    for (raw_len = 0, b = 0; b < nblocks; b++) {
+        if (HPread_at(file_rec, offsets[b], (uint8 *)datap + raw_len, lengths[b]) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        raw_len += lengths[b];
+    }
+
+    ret_value = raw_len;
+
+done:
+    free(offsets);
+    free(lengths);
+
+    return ret_value;
+} /* HMCIread_stored() */
+
+/* ------------------------------ HMCIdedup_chunk ------------------------------
+NAME
+   HMCIdedup_chunk -- share the data of a chunk identical to one written before
+
+DESCRIPTION
+   Looks for a chunk of the element written since it was opened whose
+   data is the same as the 'len' bytes at 'datap', the data of the new
+   chunk as stored in the file if 'stored' is TRUE and decoded otherwise.
+   Chunks with the same CRC-32 are read back from the file and compared
+   byte for byte.  If one is found, the new chunk gets a chunk table
+   record and a DD pointing at its data, see Hdupdd().  If not, the new
+   chunk is remembered for the chunks written after it, which it must
+   then be written before.
+
+RETURNS
+   TRUE if the new chunk now shares the data of another one, FALSE if it
+   is to be written, FAIL on error
+--------------------------------------------------------------------------- */
+static intn
+HMCIdedup_chunk(accrec_t   *access_rec, /* IN: access record of the element */
+                CHUNK_REC  *chk_rec,    /* IN/OUT: record of the new chunk */
+                const void *datap,      /* IN: data of the new chunk */
+                int32       len,        /* IN: length of the data */
+                intn        stored /* IN: TRUE if the data is as stored */)
+{
+    chunkinfo_t  *info     = (chunkinfo_t *)(access_rec->special_info); /* chunked element info */
+    filerec_t    *file_rec = NULL;                                      /* file record */
+    chunk_hash_t *slot     = NULL;                                      /* entry of the table */
+    chunk_hash_t *old      = NULL;                                      /* table before it grew */
+    CHUNK_REC    *other    = NULL;                                      /* chunk written before */
+    uint8        *buf      = NULL;                                      /* its data read back */
+    atom_t        ddid     = FAIL;                                      /* its DD */
+    uint16        dd_tag;                                               /* tag of its DD */
+    int32         aid;                                                  /* access to it */
+    int32         nread;                                                /* bytes of it read back */
+    uint32        crc;                                                  /* CRC of the new chunk */
+    int32         nold, mask, h, i;
+    intn          ret_value = FALSE;
+
+    crc = (uint32)crc32(0L, (const Bytef *)datap, (uInt)len);
+
+    /* keep the table at most half full, so that probing ends quickly */
+    if (2 * (info->dd_nused + 1) > info->dd_nslots) {
+        old  = info->dd_slots;
+        nold = info->dd_nslots;
+        if ((slot = (chunk_hash_t *)malloc((size_t)(nold == 0 ? 64 : 2 * nold) * sizeof(chunk_hash_t))) ==
+            NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        info->dd_slots  = slot;
+        info->dd_nslots = (nold == 0) ? 64 : 2 * nold;
+        mask            = info->dd_nslots - 1;
+        for (h = 0; h < info->dd_nslots; h++)
+            info->dd_slots[h].chunk_num = -1;
+        for (i = 0; i < nold; i++)
+            if (old[i].chunk_num != -1) {
+                h = (int32)(old[i].crc & (uint32)mask);
+                while (info->dd_slots[h].chunk_num != -1)
+                    h = (h + 1) & mask;
+                info->dd_slots[h] = old[i];
+            }
+        free(old);
+    }
+
+    mask = info->dd_nslots - 1;
+    for (h = (int32)(crc & (uint32)mask); info->dd_slots[h].chunk_num != -1; h = (h + 1) & mask) {
+        slot = &info->dd_slots[h];
+        if (slot->crc != crc || slot->len != len || slot->stored != stored)
+            continue;
+
+        /* the chunk may still wait in the write-behind queue */
+        if (HMCIfind_pending(info, slot->chunk_num) != NULL && HMCIflush_pending(access_rec) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        if (HMCIfind_chunk(info, slot->chunk_num, &other) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        if (other == NULL || other->chk_tag == DFTAG_NULL)
+            continue;
+
+        /* what the file holds for it, which may have changed since */
+        if (buf == NULL && (buf = (uint8 *)malloc((size_t)len)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if (stored) {
+            if (HMCIread_stored(access_rec, other, NULL, 0) != len)
+                continue;
+            nread = HMCIread_stored(access_rec, other, buf, len);
         }
-        free(chk_key);
+        else {
+            if ((aid = Hstartread(access_rec->file_id, other->chk_tag, other->chk_ref)) == FAIL)
+                HGOTO_ERROR(DFE_CANTACCESS, FAIL);
+            nread = Hread(aid, len, buf);
+            Hendaccess(aid);
+        }
+        if (nread == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        if (nread != len || memcmp(buf, datap, (size_t)len) != 0)
+            continue;
+
+        /* the same: point a DD of the new chunk at the data, with the tag
+           of the DD, special if the chunk is compressed */
+        file_rec = HAatom_object(access_rec->file_id);
+        if ((ddid = HTPselect(file_rec, other->chk_tag, other->chk_ref)) == FAIL)
+            HGOTO_ERROR(DFE_NOMATCH, FAIL);
+        if (HTPinquire(ddid, &dd_tag, NULL, NULL, NULL) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        if (HTPendaccess(ddid) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        ddid = FAIL;
+
+        if (HMCIadd_chunk_record(access_rec, chk_rec) == FAIL)
+            HGOTO_ERROR(DFE_VSWRITE, FAIL);
+        if (Hdupdd(access_rec->file_id, dd_tag, chk_rec->chk_ref, dd_tag, other->chk_ref) == FAIL)
+            HGOTO_ERROR(DFE_DUPDD, FAIL);
+        HGOTO_DONE(TRUE);
     }
 
+    /* none, remember this one */
+    slot            = &info->dd_slots[h];
+    slot->crc       = crc;
+    slot->len       = len;
+    slot->chunk_num = chk_rec->chunk_number;
+    slot->stored    = stored;
+    info->dd_nused++;
+
+done:
+    if (ddid != FAIL)
+        HTPendaccess(ddid);
+    free(buf);
     return ret_value;
-} /* HMCwriteChunk */
+} /* HMCIdedup_chunk() */
+
+/* ----------------------------- HMCreadChunkRaw -----------------------------
+NAME
+   HMCreadChunkRaw -- read the stored data of a whole chunk
+
+DESCRIPTION
+   Copies the data of the chunk at 'origin' as it is stored in the file,
+   i.e. still compressed if the element is, into 'datap' without
+   decoding it and without going through the chunk cache.  Chunks that
+   are cached or waiting to be written are flushed to the file first.
+
+   With 'datap' NULL only the number of bytes the chunk takes would be
+   returned.  The data can be written to another chunked element with
+   the same chunk lengths, number type and compression using
+   HMCwriteChunkRaw().
+
+RETURNS
+   The number of bytes of stored data, 0 if the chunk was never
+   written, or FAIL on error
+--------------------------------------------------------------------------- */
+int32
+HMCreadChunkRaw(int32  access_id, /* IN: access aid to mess with */
+                int32 *origin,    /* IN: origin of chunk to read */
+                void  *datap,     /* OUT: buffer for the stored data */
+                int32  buflen /* IN: size of 'datap' */)
+{
+    accrec_t    *access_rec = NULL; /* access record */
+    filerec_t   *file_rec   = NULL; /* file record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    CHUNK_REC   *chk_rec    = NULL; /* chunk record */
+    comp_coder_t comp_type;         /* coder the chunk was stored with */
+    int32        chunk_num = -1;    /* chunk number */
+    filerec_t   *locked    = NULL;
+    int32        ret_value = SUCCEED;
+
+    locked = HL_LOCK_AID(access_id);
+
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (origin == NULL || buflen < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* validate file records */
+    file_rec = HAatom_object(access_rec->file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* can read from this file? */
+    if (!(file_rec->access & DFACC_READ))
+        HGOTO_ERROR(DFE_DENIED, FAIL);
+
+    /* since this routine can be called by the user,
+       need to check if this access id is special CHUNKED */
+    if (access_rec->special != SPECIAL_CHUNKED)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    info = (chunkinfo_t *)(access_rec->special_info);
+
+    /* make sure the file holds the latest data of the chunk */
+    if (file_rec->access & DFACC_WRITE) {
+        if (mcache_sync(info->chk_cache) == RET_ERROR)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        if (HMCIflush_pending(access_rec) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    }
+
+    /* calculate chunk number from origin */
+    calculate_chunk_num(&chunk_num, info->ndims, origin, info->ddims);
+
+    /* chunk not written yet? */
+    if (HMCIfind_chunk(info, chunk_num, &chk_rec) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (chk_rec == NULL || chk_rec->chk_tag == DFTAG_NULL)
+        HGOTO_DONE(0);
+
+    /* a chunk coded otherwise than the element could not be written
+       back by HMCwriteChunkRaw() */
+    if ((info->flag & 0xff) == SPECIAL_COMP) {
+        if (HCPgetcomptype(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref, &comp_type) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        if (comp_type != info->comp_type)
+            HGOTO_ERROR(DFE_BADCODER, FAIL);
+    }
+
+    ret_value = HMCIread_stored(access_rec, chk_rec, datap, buflen);
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* HMCreadChunkRaw() */
+
+/* ----------------------------- HMCwriteChunkRaw ----------------------------
+NAME
+   HMCwriteChunkRaw -- write the stored data of a whole chunk
+
+DESCRIPTION
+   Writes data read by HMCreadChunkRaw() from an element with the same
+   chunk lengths, number type and compression as the chunk at 'origin',
+   without encoding it again.  The chunk must not have been written
+   before.  Unlike HMCwriteChunk() the position of the access record is
+   not changed.
+
+RETURNS
+   The number of bytes written or FAIL on error
+--------------------------------------------------------------------------- */
+int32
+HMCwriteChunkRaw(int32       access_id, /* IN: access aid to mess with */
+                 int32      *origin,    /* IN: origin of chunk to write */
+                 const void *datap,     /* IN: stored data of the chunk */
+                 int32       length /* IN: number of bytes of stored data */)
+{
+    accrec_t    *access_rec = NULL; /* access record */
+    filerec_t   *file_rec   = NULL; /* file record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    CHUNK_REC   *chk_rec    = NULL; /* chunk record */
+    int32        chunk_num  = -1;   /* chunk number */
+    intn         shared;            /* shares the data of another chunk */
+    filerec_t   *locked     = NULL;
+    int32        ret_value  = SUCCEED;
+
+    locked = HL_LOCK_AID(access_id);
+
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (origin == NULL || datap == NULL || length <= 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* validate file records */
+    file_rec = HAatom_object(access_rec->file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* can write in this file? */
+    if (!(file_rec->access & DFACC_WRITE))
+        HGOTO_ERROR(DFE_DENIED, FAIL);
+
+    /* since this routine can be called by the user,
+       need to check if this access id is special CHUNKED */
+    if (access_rec->special != SPECIAL_CHUNKED)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    info             = (chunkinfo_t *)(access_rec->special_info);
+    info->comp_bytes = -1; /* see HMCgetChunkSizes() */
+
+    /* the stored data of an uncompressed chunk is the chunk itself */
+    if ((info->flag & 0xff) != SPECIAL_COMP) {
+        if (length != info->chunk_size * info->nt_size)
+            HGOTO_ERROR(DFE_BADLEN, FAIL);
+        HGOTO_DONE(HMCwriteChunk(access_id, origin, datap));
+    }
+
+    /* calculate chunk number from origin */
+    calculate_chunk_num(&chunk_num, info->ndims, origin, info->ddims);
+
+    /* find chunk record, create it if not there */
+    if ((chk_rec = HMCIget_chunk_record(info, chunk_num)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    /* the chunk must not exist elsewhere than in its record */
+    if (chk_rec->chk_tag != DFTAG_NULL || mcache_is_cached(info->chk_cache, chunk_num + 1) ||
+        HMCIfind_pending(info, chunk_num) != NULL)
+        HE_REPORT_GOTO("chunk was already written", FAIL);
+
+    /* the statistics of the chunk are not known without decoding it */
+    if (!info->stats_looked && HMCIload_stats(access_rec) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (info->stats_nt != 0 && chunk_num < info->nstats && info->stats[chunk_num].count != -1) {
+        info->stats[chunk_num].count = -1;
+        info->stats_dirty            = TRUE;
+    }
+
+    /* nor the checksum of the decoded data */
+    if (!info->sums_looked && HMCIload_sums(access_rec) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (info->sums_on) {
+        if (HMCIsums_entry(info, chunk_num) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        info->sums[chunk_num].known = 0;
+        if (HMCIchunk_sums(info, chunk_num, datap, length, TRUE) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    }
+
+    /* the same as a chunk written before? */
+    if (info->dedup) {
+        if ((shared = HMCIdedup_chunk(access_rec, chk_rec, datap, length, TRUE)) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        if (shared)
+            HGOTO_DONE(length);
+    }
+
+    if (HMCIadd_chunk_record(access_rec, chk_rec) == FAIL)
+        HGOTO_ERROR(DFE_VSWRITE, FAIL);
+    if (HCPwrite_compressed(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref, info->model_type,
+                            info->minfo, info->comp_type, info->cinfo, info->chunk_size * info->nt_size,
+                            datap, length) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+    ret_value = length;
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* HMCwriteChunkRaw() */
 
 /* ------------------------------- HMCPwrite -------------------------------
 NAME
@@ -3208,8 +8690,6 @@ HMCPwrite(accrec_t   *access_rec, /* IN: access record to mess with */
 {
     filerec_t   *file_rec = NULL;   /* file record */
     chunkinfo_t *info     = NULL;   /* chunked element information record */
-    CHUNK_REC   *chkptr   = NULL;   /* Chunk record to inserted in TBBT  */
-    int32       *chk_key  = NULL;   /* Chunk record key for insertion in TBBT */
     const uint8 *bptr     = NULL;   /* data buffer pointer */
     void        *chk_data = NULL;   /* chunk data */
     uint8       *chk_dptr = NULL;   /* chunk data pointer */
@@ -3218,9 +8698,9 @@ HMCPwrite(accrec_t   *access_rec, /* IN: access record to mess with */
     int32        write_len     = 0; /* next write size */
     int32        write_seek    = 0; /* next write seek */
     int32        chunk_size    = 0; /* chunk size */
-    int32        chunk_num     = 0; /* chunk number */
+    int32        chunk_num     = 0;     /* chunk number */
+    intn         whole         = FALSE; /* chunk overwritten whole? */
     int32        ret_value     = SUCCEED;
-    intn         k; /* loop index */
 
     /* Check args */
     if (access_rec == NULL)
@@ -3254,43 +8734,15 @@ HMCPwrite(accrec_t   *access_rec, /* IN: access record to mess with */
         calculate_chunk_for_chunk(&chunk_size, info->ndims, info->nt_size, write_len, bytes_written,
                                   info->seek_chunk_indices, info->seek_pos_chunk, info->ddims);
 
-        /* find chunk record in TBBT */
-        if (tbbtdfind(info->chk_tree, &chunk_num, NULL) == NULL) { /* not in tree */
-
-            /* so create a new chunk record */
-            /* Allocate space for a chunk record */
-            if ((chkptr = (CHUNK_REC *)malloc(sizeof(CHUNK_REC))) == NULL)
-                HGOTO_ERROR(DFE_NOSPACE, FAIL);
-
-            /* Allocate space for a origin in chunk record */
-            if ((chkptr->origin = (int32 *)malloc((size_t)info->ndims * sizeof(int32))) == NULL)
-                HGOTO_ERROR(DFE_NOSPACE, FAIL);
-
-            /* allocate space for key */
-            if ((chk_key = (int32 *)malloc(sizeof(int32))) == NULL)
-                HGOTO_ERROR(DFE_NOSPACE, FAIL);
-
-            /* Initialize chunk record */
-            chkptr->chk_tag = DFTAG_NULL;
-            chkptr->chk_ref = 0;
-
-            /* Initialize chunk origins */
-            for (k = 0; k < info->ndims; k++)
-                chkptr->origin[k] = info->seek_chunk_indices[k];
-
-            /* set chunk record number to next Vdata record number */
-            chkptr->chk_vnum = info->num_recs++;
-
-            /* set key to chunk number */
-            chkptr->chunk_number = *chk_key = chunk_num;
+        /* or a whole chunk, overwritten without reading it in first */
+        whole = HMCIdirect_chunk(info, write_len - bytes_written);
+        if (whole)
+            chunk_size = info->chunk_size * info->nt_size;
 
-            /* add to TBBT tree based on chunk number as the key */
-            tbbtdins(info->chk_tree, chkptr, chk_key);
+        /* find chunk record, create it if not written yet */
+        if (HMCIget_chunk_record(info, chunk_num) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
-            /* re-initialize ptrs to allow for error-failure check */
-            chkptr  = NULL;
-            chk_key = NULL;
-        }
         /* would be nice to get Chunk record from TBBT based on chunk number
            and then get chunk data base on chunk vdata number but
            currently the chunk calculations return chunk
@@ -3300,9 +8752,9 @@ HMCPwrite(accrec_t   *access_rec, /* IN: access record to mess with */
 
         /* get chunk data from cache based on chunk number
            chunks in the cache start from 1 not 0 */
-        if ((chk_data = mcache_get(info->chk_cache, /* cache handle */
-                                   chunk_num + 1,   /* chunk number */
-                                   0 /* flag: unused */)) == NULL)
+        if ((chk_data = mcache_get(info->chk_cache,          /* cache handle */
+                                   chunk_num + 1,            /* chunk number */
+                                   whole ? MCACHE_NOREAD : 0 /* flag: no read */)) == NULL)
             HE_REPORT_GOTO("failed to find chunk record", FAIL);
 
         chk_dptr = chk_data; /* set chunk data ptr */
@@ -3333,8 +8785,8 @@ HMCPwrite(accrec_t   *access_rec, /* IN: access record to mess with */
 
         /* i.e calculate chunk indices given seek location
            this will update the proper arrays in the special info struct */
-        update_chunk_indices_seek(relative_posn, info->ndims, info->nt_size, info->seek_chunk_indices,
-                                  info->seek_pos_chunk, info->ddims);
+        advance_chunk_indices_seek(relative_posn, chunk_size, info->ndims, info->nt_size,
+                                   info->seek_chunk_indices, info->seek_pos_chunk, info->ddims);
     } /* end while "bytes_written" */
 
     /* update access record with bytes written */
@@ -3343,15 +8795,6 @@ HMCPwrite(accrec_t   *access_rec, /* IN: access record to mess with */
     ret_value = bytes_written;
 
 done:
-    if (ret_value == FAIL) { /* Error condition cleanup */
-        /* check chunk ptrs */
-        if (chkptr != NULL) {
-            free(chkptr->origin);
-            free(chkptr);
-        }
-        free(chk_key);
-    }
-
     return ret_value;
 } /* HMCPwrite */
 
@@ -3395,6 +8838,12 @@ HMCPcloseAID(accrec_t *access_rec /* IN:  access record of file to close */)
         if (info->chk_cache != NULL) {
             /* Sync chunk cache */
             mcache_sync(info->chk_cache);
+
+            /* write out the chunks queued for write-behind */
+            if (HMCIflush_pending(access_rec) == FAIL) {
+                HERROR(DFE_WRITEERROR);
+                ret_value = FAIL;
+            }
 #ifdef STATISTICS
             /* cache statistics if 'mcache.c' complied with -DSTATISTICS */
             mcache_stat(info->chk_cache);
@@ -3406,6 +8855,20 @@ HMCPcloseAID(accrec_t *access_rec /* IN:  access record of file to close */)
         /* clean up chunk table lists and info record here */
         /* Use Vxxx interface to end access to Vdata info */
         if (info->aid != FAIL) {
+            /* write out the new chunk table records */
+            if (HMCIflush_table(info) == FAIL) {
+                HERROR(DFE_VSWRITE);
+                ret_value = FAIL;
+            }
+            /* and the statistics and checksums of the chunks */
+            if (HMCIflush_stats(access_rec) == FAIL) {
+                HERROR(DFE_VSWRITE);
+                ret_value = FAIL;
+            }
+            if (HMCIflush_sums(access_rec) == FAIL) {
+                HERROR(DFE_VSWRITE);
+                ret_value = FAIL;
+            }
             if (VSdetach(info->aid) == FAIL)
                 HGOTO_ERROR(DFE_CANTENDACCESS, FAIL);
         }
@@ -3415,10 +8878,11 @@ HMCPcloseAID(accrec_t *access_rec /* IN:  access record of file to close */)
         if (Vend(access_rec->file_id) == FAIL)
             HGOTO_ERROR(DFE_CANTFLUSH, FAIL);
 
-        /* clean up chunk tree */
-        tbbtdfree(info->chk_tree, chkdestroynode, chkfreekey);
+        /* clean up chunk records */
+        HMCIfree_chunks(info);
 
         /* free up stuff in special info */
+        free(info->chk_index);
         free(info->ddims);
         free(info->seek_chunk_indices);
         free(info->seek_pos_chunk);
@@ -3427,6 +8891,16 @@ HMCPcloseAID(accrec_t *access_rec /* IN:  access record of file to close */)
         free(info->comp_sp_tag_header);
         free(info->cinfo);
         free(info->minfo);
+        free(info->rd_raw);
+        free(info->rd_offsets);
+        free(info->rd_lengths);
+        free(info->rd_exts);
+        free(info->tbl_recs);
+        free(info->order);
+        free(info->stats);
+        free(info->sums);
+        free(info->dd_slots);
+        HMCIfree_predecoded(info);
 
         free(info);
         access_rec->special_info = NULL;
@@ -82,6 +82,9 @@ HDFLIBAPI intn HMCgetcompress(accrec_t     *access_rec, /* IN: access record */
 HDFLIBAPI intn HMCgetcomptype(int32         access_id, /* IN: access record */
                               comp_coder_t *comp_type /* OUT: compression type */);
 
+HDFLIBAPI intn HMCgetcompmodel(accrec_t     *access_rec, /* IN: access record */
+                               comp_model_t *model_type /* OUT: modeling type */);
+
 HDFLIBAPI intn HMCgetdatainfo(int32  file_id, /* IN: file in which element is located */
                               uint16 data_tag, uint16 data_ref,
                               int32 *chk_coord,    /* IN: chunk coord array or NULL for non-chunk SDS */
@@ -99,6 +102,62 @@ HDFLIBAPI int32 HMCsetMaxcache(int32 access_id, /* IN: access aid to mess with *
                                int32 maxcache,  /* IN: max number of pages to cache */
                                int32 flags /* IN: flags = 0, HMC_PAGEALL */);
 
+HDFLIBAPI intn HMCsetThreads(int32 access_id, /* IN: access aid to mess with */
+                             intn  nthreads /* IN: number of decoding threads */);
+
+HDFLIBAPI intn HMCgetCacheStats(int32              access_id, /* IN: access aid to mess with */
+                                hdf_cache_stats_t *stats /* OUT: hit, miss and eviction counts */);
+
+HDFLIBAPI intn HMCsetReadahead(int32 access_id, /* IN: access aid to mess with */
+                               intn  readahead /* IN: TRUE to turn readahead on */);
+
+HDFLIBAPI intn HMCsetSparse(int32 access_id, /* IN: access aid to mess with */
+                            intn  sparse /* IN: TRUE to leave chunks of fill values unwritten */);
+
+HDFLIBAPI intn HMCsetDedup(int32 access_id, /* IN: access aid to mess with */
+                           intn  dedup /* IN: TRUE to share the data of identical chunks */);
+
+HDFLIBAPI intn HMCsetRawLimit(int32 access_id, /* IN: access aid to mess with */
+                              intn  percent /* IN: limit of the compressed size, 0 for none */);
+
+HDFLIBAPI intn HMCsetCoderPolicy(int32 access_id, /* IN: access aid to mess with */
+                                 intn  percent /* IN: size a faster coder may trail by, negative for none */);
+
+HDFLIBAPI int32 HMCgetChunkMap(int32  access_id, /* IN: access aid to mess with */
+                               uint8 *map,       /* OUT: one bit per chunk, set if written */
+                               int32 *nchunks /* OUT: number of chunks of the element */);
+
+HDFLIBAPI intn HMCsetStats(int32 access_id, /* IN: access aid to mess with */
+                           int32 nt /* IN: number type of the values in the file */);
+
+HDFLIBAPI intn HMCgetChunkStats(int32    access_id, /* IN: access aid to mess with */
+                                int32   *origin,    /* IN: origin of the chunk */
+                                float64 *min,       /* OUT: least value */
+                                float64 *max,       /* OUT: greatest value */
+                                int32   *count /* OUT: number of values, -1 if not known */);
+
+HDFLIBAPI int32 HMCqueryChunks(int32   access_id, /* IN: access aid to mess with */
+                               float64 lo,        /* IN: least value looked for */
+                               float64 hi,        /* IN: greatest value looked for */
+                               int32   maxchunks, /* IN: number of origins 'origins' has room for */
+                               int32  *origins /* OUT: origins of the chunks found */);
+
+HDFLIBAPI intn HMCsetChecksums(int32 access_id /* IN: access aid to mess with */);
+
+HDFLIBAPI intn HMCgetChunkChecksum(int32   access_id,  /* IN: access aid to mess with */
+                                   int32  *origin,     /* IN: origin of the chunk */
+                                   uint32 *raw_crc,    /* OUT: CRC-32C of the decoded data */
+                                   uint32 *stored_crc /* OUT: CRC-32C of the data as stored */);
+
+HDFLIBAPI intn HMCgetChunkSizes(int32  access_id, /* IN: access aid to mess with */
+                                int32 *comp_size, /* OUT: size of compressed data */
+                                int32 *orig_size /* OUT: size of non-compressed data */);
+
+HDFLIBAPI int32 HMCsetCacheBudget(int32 nbytes /* IN: bytes shared by the pooled caches */);
+
+HDFLIBAPI intn HMCsetDiskCache(const char *dir, /* IN: directory of the cache, NULL for none */
+                               int32 max_kbytes /* IN: KB the cache may hold */);
+
 HDFLIBAPI int32 HMCwriteChunk(int32       access_id, /* IN: access aid to mess with */
                               int32      *origin,    /* IN: origin of chunk to write */
                               const void *datap /* IN: buffer for data */);
@@ -107,8 +166,41 @@ HDFLIBAPI int32 HMCreadChunk(int32  access_id, /* IN: access aid to mess with */
                              int32 *origin,    /* IN: origin of chunk to read */
                              void  *datap /* IN: buffer for data */);
 
+HDFLIBAPI int32 HMCgetChunkPtr(int32        access_id, /* IN: access aid to mess with */
+                               int32       *origin,    /* IN: origin of chunk to get */
+                               const void **datap /* OUT: the chunk in the cache */);
+
+HDFLIBAPI intn HMCreleaseChunk(int32       access_id, /* IN: access aid to mess with */
+                               const void *datap /* IN: the chunk in the cache */);
+
+HDFLIBAPI int32 HMCreadSlab(int32        access_id, /* IN: access aid to mess with */
+                            const int32 *start,     /* IN: first index of the slab along each dimension */
+                            const int32 *stride,    /* IN: distance between indices, NULL for 1 */
+                            const int32 *edges,     /* IN: number of indices along each dimension */
+                            void        *datap /* OUT: buffer for the slab */);
+
+HDFLIBAPI intn HMCnextChunk(int32  access_id, /* IN: access aid to mess with */
+                            int32 *cursor,    /* IN/OUT: position of the visit, 0 to start */
+                            int32 *origin /* OUT: origin of the next chunk */);
+
+HDFLIBAPI int32 HMCwriteChunkRaw(int32       access_id, /* IN: access aid to mess with */
+                                 int32      *origin,    /* IN: origin of chunk to write */
+                                 const void *datap,     /* IN: stored data of the chunk */
+                                 int32       length /* IN: number of bytes of stored data */);
+
+HDFLIBAPI int32 HMCreadChunkRaw(int32  access_id, /* IN: access aid to mess with */
+                                int32 *origin,    /* IN: origin of chunk to read */
+                                void  *datap,     /* OUT: buffer for the stored data */
+                                int32  buflen /* IN: size of 'datap' */);
+
 HDFLIBAPI int32 HMCPcloseAID(accrec_t *access_rec /* IN:  access record of file to close */);
 
+HDFLIBAPI intn HMCPprefetch /* has to be here because used in hfile.c */
+    (accrec_t    *access_rec, /* IN: access record of the element */
+     int32        nruns,      /* IN: number of runs of bytes */
+     const int32 *offsets,    /* IN: offset in the element of each run */
+     const int32 *lengths /* IN: number of bytes of each run */);
+
 HDFLIBAPI int32 HMCPgetnumrecs /* has to be here because used in hfile.c */
     (accrec_t *access_rec,     /* IN:  access record to return info about */
      int32    *num_recs /* OUT: length of the chunked elt */);
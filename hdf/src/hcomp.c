@@ -60,6 +60,8 @@ BUGS/LIMITATIONS
 
 EXPORTED ROUTINES
    HCcreate - create or modify an existing data element to be compressed
+   HCPwrite_compressed - write data compressed elsewhere as a new compressed element
+   HCset_decode_provider - decode the chunks of a compression type elsewhere
 LOCAL ROUTINES
 
 AUTHOR
@@ -102,6 +104,12 @@ uint16 compress_map[COMP_MAX_COMP + 1] = {
     DFTAG_IMC    /* COMP_IMCOMP -> DFTAG_IMC (for IMCOMP compression) */
 };
 
+/* Decode providers set with HCset_decode_provider(), by compression type */
+static struct {
+    hdf_decode_func_t func;      /* decodes batches of chunks, NULL if none */
+    void             *user_data; /* passed to 'func' */
+} HCIdecode_provider[H4_STATS_NCODERS];
+
 /* declaration of the functions provided in this module */
 static int32 HCIstaccess(accrec_t *access_rec, int16 acc_mode);
 
@@ -245,8 +253,86 @@ HCIinit_coder(int16 acc_mode, comp_coder_info_t *cinfo, comp_coder_t coder_type,
             cinfo->coder_info.szip_info.szip_dirty          = SZIP_CLEAN;
             break;
 
-        default:
+        case COMP_CODE_ZSTD: /* zstd encoding, only when the library is present */
+#ifdef H4_HAVE_LIBZSTD
+            if (c_info->zstd.level < H4_ZSTD_MIN_LEVEL || c_info->zstd.level > H4_ZSTD_MAX_LEVEL)
+                HRETURN_ERROR(DFE_BADCODER, FAIL);
+
+            /* set the coding type and the zstd func. ptrs */
+            cinfo->coder_type  = COMP_CODE_ZSTD;
+            cinfo->coder_funcs = czstd_funcs;
+
+            /* copy encoding info */
+            if (acc_mode & DFACC_WRITE)
+                cinfo->coder_info.zstd_info.zstd_level = c_info->zstd.level;
+            break;
+#else
             HRETURN_ERROR(DFE_BADCODER, FAIL);
+#endif /* H4_HAVE_LIBZSTD */
+
+        case COMP_CODE_LZ4: /* LZ4 encoding, only when the library is present */
+#ifdef H4_HAVE_LIBLZ4
+            if (c_info->lz4.acceleration < H4_LZ4_MIN_ACCELERATION ||
+                c_info->lz4.acceleration > H4_LZ4_MAX_ACCELERATION)
+                HRETURN_ERROR(DFE_BADCODER, FAIL);
+
+            /* set the coding type and the LZ4 func. ptrs */
+            cinfo->coder_type  = COMP_CODE_LZ4;
+            cinfo->coder_funcs = clz4_funcs;
+
+            /* copy encoding info */
+            if (acc_mode & DFACC_WRITE)
+                cinfo->coder_info.lz4_info.lz4_acceleration = c_info->lz4.acceleration;
+            break;
+#else
+            HRETURN_ERROR(DFE_BADCODER, FAIL);
+#endif /* H4_HAVE_LIBLZ4 */
+
+        case COMP_CODE_LOSSY: /* error-bounded lossy encoding of floats */
+            if (HCPclossy_check_parms(c_info) == FAIL)
+                HRETURN_ERROR(DFE_BADCODER, FAIL);
+
+            /* set the coding type and the lossy func. ptrs */
+            cinfo->coder_type  = COMP_CODE_LOSSY;
+            cinfo->coder_funcs = clossy_funcs;
+
+            /* copy encoding info, the number type is needed for reading too */
+            cinfo->coder_info.lossy_info.c_info = *c_info;
+            break;
+
+        case COMP_CODE_JPEG: /* JPEG encoding, for the chunks of GR images only */
+            if (c_info->jpeg.width < 1 || c_info->jpeg.height < 1 ||
+                (c_info->jpeg.ncomps != 1 && c_info->jpeg.ncomps != 3))
+                HRETURN_ERROR(DFE_BADCODER, FAIL);
+
+            /* set the coding type and the JPEG func. ptrs */
+            cinfo->coder_type  = COMP_CODE_JPEG;
+            cinfo->coder_funcs = cjpeg_funcs;
+
+            /* copy encoding info, the shape of the tile is needed for reading too */
+            cinfo->coder_info.jpeg_info.quality        = c_info->jpeg.quality;
+            cinfo->coder_info.jpeg_info.force_baseline = c_info->jpeg.force_baseline;
+            cinfo->coder_info.jpeg_info.width          = c_info->jpeg.width;
+            cinfo->coder_info.jpeg_info.height         = c_info->jpeg.height;
+            cinfo->coder_info.jpeg_info.ncomps         = c_info->jpeg.ncomps;
+            break;
+
+        default: /* a coder registered with HCregister_coder() */
+        {
+            const hdf_coder_plugin_t *plugin = HCPplugin_coder(coder_type);
+
+            if (plugin == NULL || c_info->plugin.cd_nelmts < 0 ||
+                c_info->plugin.cd_nelmts > H4_PLUGIN_MAX_CD_VALUES)
+                HRETURN_ERROR(DFE_BADCODER, FAIL);
+
+            /* set the coding type and the plugin func. ptrs */
+            cinfo->coder_type  = coder_type;
+            cinfo->coder_funcs = cplugin_funcs;
+
+            /* copy encoding info, the coder's callbacks get its parameters */
+            cinfo->coder_info.plugin_info.plugin = plugin;
+            cinfo->coder_info.plugin_info.c_info = *c_info;
+        } break;
     } /* end switch */
     return SUCCEED;
 } /* end HCIinit_coder() */
@@ -275,7 +361,6 @@ static int32
 HCIinit_model(int16 acc_mode, comp_model_info_t *minfo, comp_model_t model_type, model_info *m_info)
 {
     (void)acc_mode;
-    (void)m_info;
 
     switch (model_type) {                          /* determine the type of modeling */
         case COMP_MODEL_STDIO:                     /* standard C stdio modeling */
@@ -283,6 +368,22 @@ HCIinit_model(int16 acc_mode, comp_model_info_t *minfo, comp_model_t model_type,
             minfo->model_funcs = mstdio_funcs;     /* set the stdio func. ptrs */
             break;
 
+        case COMP_MODEL_SHUFFLE: /* bytes shuffled by significance */
+            if (m_info->shuffle.elem_size < 1 || m_info->shuffle.elem_size > SHUFFLE_BLOCK_SIZE)
+                HRETURN_ERROR(DFE_BADMODEL, FAIL);
+
+            /* set the model type and the shuffle func. ptrs */
+            minfo->model_type  = COMP_MODEL_SHUFFLE;
+            minfo->model_funcs = mshuffle_funcs;
+
+            /* copy modeling info, the buffers are allocated by the access */
+            minfo->model_info.shuffle_info.elem_size = m_info->shuffle.elem_size;
+            minfo->model_info.shuffle_info.block_size =
+                (SHUFFLE_BLOCK_SIZE / m_info->shuffle.elem_size) * m_info->shuffle.elem_size;
+            minfo->model_info.shuffle_info.buf = NULL;
+            minfo->model_info.shuffle_info.tmp = NULL;
+            break;
+
         default:
             HRETURN_ERROR(DFE_BADMODEL, FAIL);
     } /* end switch */
@@ -326,6 +427,10 @@ HCPquery_encode_header(comp_model_t model_type, model_info *m_info, comp_coder_t
 
     /* add any additional information needed for modeling type */
     switch (model_type) {
+        case COMP_MODEL_SHUFFLE: /* Shuffling stores the element size */
+            model_len += 2;
+            break;
+
         default: /* no additional information needed */
             break;
     } /* end switch */
@@ -344,15 +449,37 @@ HCPquery_encode_header(comp_model_t model_type, model_info *m_info, comp_coder_t
             coder_len += 2;
             break;
 
+        case COMP_CODE_ZSTD: /* zstd coding stores the compression level */
+            coder_len += 2;
+            break;
+
+        case COMP_CODE_LZ4: /* LZ4 coding stores the acceleration */
+            coder_len += 2;
+            break;
+
         case COMP_CODE_SZIP: /* Szip coding stores various szip parameters */
             coder_len += 14;
             break;
 
+        case COMP_CODE_JPEG: /* JPEG coding stores the quality and the tile shape */
+            coder_len += 14;
+            break;
+
+        case COMP_CODE_LOSSY: /* Lossy coding stores the mode, number type and tolerance */
+            coder_len += 14;
+            break;
+
         case COMP_CODE_IMCOMP: /* IMCOMP is no longer supported, can only be inquired */
             HRETURN_ERROR(DFE_BADCODER, FAIL);
             break;
 
         default: /* no additional information needed */
+                 /* except for a coder plugin, which stores its parameters */
+            if (coder_type >= COMP_CODE_PLUGIN_MIN) {
+                if (c_info->plugin.cd_nelmts < 0 || c_info->plugin.cd_nelmts > H4_PLUGIN_MAX_CD_VALUES)
+                    HRETURN_ERROR(DFE_BADCODER, FAIL);
+                coder_len += 2 + 4 * c_info->plugin.cd_nelmts;
+            }
             break;
     } /* end switch */
 
@@ -399,6 +526,12 @@ HCPencode_header(uint8 *p, comp_model_t model_type, model_info *m_info, comp_cod
 
     /* add any additional information needed for modeling type */
     switch (model_type) {
+        case COMP_MODEL_SHUFFLE: /* Shuffling needs the element size */
+            if (m_info->shuffle.elem_size < 1 || m_info->shuffle.elem_size > SHUFFLE_BLOCK_SIZE)
+                HRETURN_ERROR(DFE_BADMODEL, FAIL);
+            UINT16ENCODE(p, (uint16)m_info->shuffle.elem_size);
+            break;
+
         default: /* no additional information needed */
             break;
     } /* end switch */
@@ -439,6 +572,23 @@ HCPencode_header(uint8 *p, comp_model_t model_type, model_info *m_info, comp_cod
             UINT16ENCODE(p, (uint16)c_info->deflate.level);
             break;
 
+        case COMP_CODE_ZSTD: /* zstd coding stores the compression level */
+            if (c_info->zstd.level < H4_ZSTD_MIN_LEVEL || c_info->zstd.level > H4_ZSTD_MAX_LEVEL)
+                HRETURN_ERROR(DFE_BADCODER, FAIL);
+
+            /* specify compression level */
+            UINT16ENCODE(p, (uint16)c_info->zstd.level);
+            break;
+
+        case COMP_CODE_LZ4: /* LZ4 coding stores the acceleration */
+            if (c_info->lz4.acceleration < H4_LZ4_MIN_ACCELERATION ||
+                c_info->lz4.acceleration > H4_LZ4_MAX_ACCELERATION)
+                HRETURN_ERROR(DFE_BADCODER, FAIL);
+
+            /* specify acceleration */
+            UINT16ENCODE(p, (uint16)c_info->lz4.acceleration);
+            break;
+
         case COMP_CODE_SZIP: /* Szip coding stores various szip parameters */
             UINT32ENCODE(p, (uint32)c_info->szip.pixels);
             UINT32ENCODE(p, (uint32)c_info->szip.pixels_per_scanline);
@@ -447,11 +597,43 @@ HCPencode_header(uint8 *p, comp_model_t model_type, model_info *m_info, comp_cod
             *p++ = (uint8)c_info->szip.pixels_per_block;
             break;
 
+        case COMP_CODE_JPEG: /* JPEG coding stores the quality and the tile shape */
+            if (c_info->jpeg.quality < 0 || c_info->jpeg.quality > 100 || c_info->jpeg.width < 1 ||
+                c_info->jpeg.height < 1 || (c_info->jpeg.ncomps != 1 && c_info->jpeg.ncomps != 3))
+                HRETURN_ERROR(DFE_BADCODER, FAIL);
+
+            UINT16ENCODE(p, (uint16)c_info->jpeg.quality);
+            UINT16ENCODE(p, (uint16)c_info->jpeg.force_baseline);
+            UINT32ENCODE(p, (uint32)c_info->jpeg.width);
+            UINT32ENCODE(p, (uint32)c_info->jpeg.height);
+            UINT16ENCODE(p, (uint16)c_info->jpeg.ncomps);
+            break;
+
+        case COMP_CODE_LOSSY: /* Lossy coding stores the mode, number type and tolerance */
+            if (HCPclossy_check_parms(c_info) == FAIL)
+                HRETURN_ERROR(DFE_BADCODER, FAIL);
+
+            UINT16ENCODE(p, (uint16)c_info->lossy.mode);
+            INT32ENCODE(p, c_info->lossy.nt);
+            HCPclossy_put_float64(p, c_info->lossy.tolerance);
+            p += 8;
+            break;
+
         case COMP_CODE_IMCOMP: /* IMCOMP is no longer supported, can only be inquired */
             HRETURN_ERROR(DFE_BADCODER, FAIL);
             break;
 
         default: /* no additional information needed */
+                 /* except for a coder plugin, which stores its parameters */
+            if (coder_type >= COMP_CODE_PLUGIN_MIN) {
+                intn i;
+
+                if (c_info->plugin.cd_nelmts < 0 || c_info->plugin.cd_nelmts > H4_PLUGIN_MAX_CD_VALUES)
+                    HRETURN_ERROR(DFE_BADCODER, FAIL);
+                UINT16ENCODE(p, (uint16)c_info->plugin.cd_nelmts);
+                for (i = 0; i < c_info->plugin.cd_nelmts; i++)
+                    UINT32ENCODE(p, c_info->plugin.cd_values[i]);
+            }
             break;
     } /* end switch */
 
@@ -499,6 +681,14 @@ HCPdecode_header(uint8 *p, comp_model_t *model_type, model_info *m_info, comp_co
 
     /* read any additional information needed for modeling type */
     switch (*model_type) {
+        case COMP_MODEL_SHUFFLE: /* Obtain the element size for shuffling */
+        {
+            uint16 e_size; /* temp. var for element size */
+
+            UINT16DECODE(p, e_size);
+            m_info->shuffle.elem_size = (intn)e_size;
+        } break;
+
         default: /* no additional information needed */
             break;
     } /* end switch */
@@ -551,6 +741,24 @@ HCPdecode_header(uint8 *p, comp_model_t *model_type, model_info *m_info, comp_co
         } /* end case */
         break;
 
+        case COMP_CODE_ZSTD: /* Obtains compression level for zstd coding */
+        {
+            uint16 level; /* compression level */
+
+            UINT16DECODE(p, level);
+            c_info->zstd.level = (intn)level;
+        } /* end case */
+        break;
+
+        case COMP_CODE_LZ4: /* Obtains acceleration for LZ4 coding */
+        {
+            uint16 acceleration; /* acceleration of the encoder */
+
+            UINT16DECODE(p, acceleration);
+            c_info->lz4.acceleration = (intn)acceleration;
+        } /* end case */
+        break;
+
         case COMP_CODE_SZIP: /* Obtains szip parameters for Szip coding */
         {
             UINT32DECODE(p, c_info->szip.pixels);
@@ -560,8 +768,48 @@ HCPdecode_header(uint8 *p, comp_model_t *model_type, model_info *m_info, comp_co
             c_info->szip.pixels_per_block = *p++;
         } break;
 
+        case COMP_CODE_JPEG: /* Obtains the quality and the tile shape for JPEG coding */
+        {
+            uint16 quality, force_baseline, ncomps;
+            uint32 width, height;
+
+            UINT16DECODE(p, quality);
+            UINT16DECODE(p, force_baseline);
+            UINT32DECODE(p, width);
+            UINT32DECODE(p, height);
+            UINT16DECODE(p, ncomps);
+            c_info->jpeg.quality        = (intn)quality;
+            c_info->jpeg.force_baseline = (intn)force_baseline;
+            c_info->jpeg.width          = (int32)width;
+            c_info->jpeg.height         = (int32)height;
+            c_info->jpeg.ncomps         = (intn)ncomps;
+        } break;
+
+        case COMP_CODE_LOSSY: /* Obtains the mode, number type and tolerance for lossy coding */
+        {
+            uint16 mode;
+
+            UINT16DECODE(p, mode);
+            INT32DECODE(p, c_info->lossy.nt);
+            c_info->lossy.mode      = (intn)mode;
+            c_info->lossy.tolerance = HCPclossy_get_float64(p);
+            p += 8;
+        } break;
+
         default: /* no additional information needed */
-                 /* this includes RLE, JPEG, and IMCOMP */
+                 /* this includes RLE and IMCOMP */
+                 /* a coder plugin has its parameters */
+            if (*coder_type >= COMP_CODE_PLUGIN_MIN) {
+                uint16 nelmts; /* number of parameters */
+                intn   i;
+
+                UINT16DECODE(p, nelmts);
+                if (nelmts > H4_PLUGIN_MAX_CD_VALUES)
+                    HGOTO_ERROR(DFE_BADCODER, FAIL);
+                c_info->plugin.cd_nelmts = (int32)nelmts;
+                for (i = 0; i < (intn)nelmts; i++)
+                    UINT32DECODE(p, c_info->plugin.cd_values[i]);
+            }
             break;
     } /* end switch */
 
@@ -700,6 +948,7 @@ HCcreate(int32 file_id, uint16 tag, uint16 ref, comp_model_t model_type, model_i
          comp_coder_t coder_type, comp_info *c_info)
 {
     filerec_t  *file_rec;          /* file record */
+    filerec_t  *locked     = NULL; /* file record locked by this call */
     accrec_t   *access_rec = NULL; /* access element record */
     compinfo_t *info       = NULL; /* special element information */
     atom_t      data_id    = FAIL; /* dd ID of existing regular element */
@@ -721,6 +970,7 @@ HCcreate(int32 file_id, uint16 tag, uint16 ref, comp_model_t model_type, model_i
     /* get a slot in the access records table */
     if (NULL == (access_rec = HIget_access_rec()))
         HRETURN_ERROR(DFE_TOOMANY, FAIL);
+    locked = HL_LOCK_FILE(file_rec);
 
     /* search for identical dd */
     if ((data_id = HTPselect(file_rec, tag, ref)) != FAIL) {
@@ -758,6 +1008,8 @@ HCcreate(int32 file_id, uint16 tag, uint16 ref, comp_model_t model_type, model_i
 
     /* set up compressed special info structure */
     info->attached = 1;
+    info->hdr      = NULL;
+    info->hdr_len  = 0;
     info->comp_ref = Htagnewref(file_id, DFTAG_COMPRESSED); /* get the new reference # */
     if (HCIinit_model(DFACC_RDWR, &(info->minfo), model_type, m_info) == FAIL)
         HGOTO_ERROR(DFE_MINIT, FAIL);
@@ -778,6 +1030,21 @@ HCcreate(int32 file_id, uint16 tag, uint16 ref, comp_model_t model_type, model_i
     access_rec->appendable   = FALSE; /* start data as non-appendable */
     file_rec->attach++;
 
+    /* The header of an element of a file created for streaming, see
+       Hsetstreaming(), is written out with the data that follows it and
+       cannot be updated where it is: it is kept, and written again at the
+       end of the file by HCPcloseAID() */
+    if (file_rec->stream != NULL) {
+        int32 hdr_off; /* offset of the header */
+
+        if (HTPinquire(access_rec->ddid, NULL, NULL, &hdr_off, &info->hdr_len) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        if ((info->hdr = (uint8 *)malloc((size_t)info->hdr_len)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if (HPread_at(file_rec, hdr_off, info->hdr, info->hdr_len) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+    } /* end if */
+
     /* propagate the initialization down to the modeling layer */
     if ((*(info->minfo.model_funcs.stwrite))(access_rec) == FAIL)
         HGOTO_ERROR(DFE_MODEL, FAIL);
@@ -799,12 +1066,15 @@ done:
     if (ret_value == FAIL) { /* Error condition cleanup */
         if (access_rec != NULL)
             HIrelease_accrec_node(access_rec);
+        if (info != NULL)
+            free(info->hdr);
         free(info);
 
         access_rec->special_info = NULL;
     }
     free(buf);
 
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* end HCcreate() */
 
@@ -1014,6 +1284,70 @@ done:
     return ret_value;
 } /* HCPgetcompinfo */
 
+/*--------------------------------------------------------------------------
+ NAME
+    HCPgetcompmodel -- Retrieves the modeling type of an element
+ USAGE
+    intn HCPgetcompmodel(file_id, data_tag, data_ref, model_type)
+    int32 file_id;              IN: file id
+    uint16 data_tag;            IN: tag of the element
+    uint16 data_ref;            IN: ref of element
+    comp_model_t* model_type;   OUT: the type of modeling
+ RETURNS
+    SUCCEED/FAIL
+ DESCRIPTION
+    This routine retrieves the modeling type of the element, e.g. whether
+    its bytes were shuffled before they were compressed.  Elements that
+    are not compressed use COMP_MODEL_STDIO.  The routine is used by
+    SDgetshuffle at this time.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+intn
+HCPgetcompmodel(int32 file_id, uint16 data_tag, uint16 data_ref,
+                comp_model_t *model_type) /* OUT: modeling type */
+{
+    int32     aid        = FAIL;
+    accrec_t *access_rec = NULL; /* access element record */
+    intn      ret_value  = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* check the output argument */
+    if (model_type == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* start read access on the access record of the data element */
+    if ((aid = Hstartread(file_id, data_tag, data_ref)) == FAIL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if ((access_rec = HAatom_object(aid)) == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* the header of a compressed element was read by the access */
+    if (access_rec->special == SPECIAL_COMP)
+        *model_type = ((compinfo_t *)access_rec->special_info)->minfo.model_type;
+    else if (access_rec->special == SPECIAL_CHUNKED) {
+        if (HMCgetcompmodel(access_rec, model_type) == FAIL)
+            HGOTO_ERROR(DFE_COMPINFO, FAIL);
+    }
+    else
+        *model_type = COMP_MODEL_STDIO;
+
+done:
+    /* end access to the aid if it's been accessed */
+    if (aid != FAIL)
+        if (Hendaccess(aid) == FAIL) {
+            HERROR(DFE_CANTENDACCESS);
+            ret_value = FAIL;
+        }
+
+    return ret_value;
+} /* HCPgetcompmodel */
+
 /*--------------------------------------------------------------------------
  NAME
     HCIstaccess -- Start accessing a compressed data element.
@@ -1059,6 +1393,8 @@ HCIstaccess(accrec_t *access_rec, int16 acc_mode)
     if (HCIread_header(access_rec, info, &c_info, &m_info) == FAIL)
         HGOTO_ERROR(DFE_COMPINFO, FAIL);
     info->attached = 1;
+    info->hdr      = NULL;
+    info->hdr_len  = 0;
     if (HCIinit_model(acc_mode, &(info->minfo), info->minfo.model_type, &m_info) == FAIL)
         HRETURN_ERROR(DFE_MINIT, FAIL);
     if (HCIinit_coder(acc_mode, &(info->cinfo), info->cinfo.coder_type, &c_info) == FAIL)
@@ -1206,7 +1542,8 @@ done:
 int32
 HCPread(accrec_t *access_rec, int32 length, void *data)
 {
-    compinfo_t *info; /* information on the special element */
+    compinfo_t *info;     /* information on the special element */
+    filerec_t  *file_rec; /* file record */
     int32       ret_value;
 
     /* validate length */
@@ -1221,9 +1558,17 @@ HCPread(accrec_t *access_rec, int32 length, void *data)
     else if (length < 0 || access_rec->posn + length > info->length)
         HGOTO_ERROR(DFE_RANGE, FAIL);
 
-    if ((*(info->minfo.model_funcs.read))(access_rec, length, data) == FAIL)
+    HP_TRACE(HDF_TRACE_DECODE, FALSE, length);
+    ret_value = (*(info->minfo.model_funcs.read))(access_rec, length, data);
+    HP_TRACE(HDF_TRACE_DECODE, TRUE, length);
+    if (ret_value == FAIL)
         HGOTO_ERROR(DFE_MODEL, FAIL);
 
+    /* count the decoded bytes in the statistics of the file */
+    file_rec = HAatom_object(access_rec->file_id);
+    if (!BADFREC(file_rec) && (uintn)info->cinfo.coder_type < H4_STATS_NCODERS)
+        file_rec->stats.bytes_decoded[info->cinfo.coder_type] += (uint32)length;
+
     /* adjust access position */
     access_rec->posn += length;
 
@@ -1283,12 +1628,16 @@ HCPwrite(accrec_t *access_rec, int32 length, const void *data)
         info->length = access_rec->posn;
 
         INT32ENCODE(p, info->length);
-        if (HPseek(file_rec, data_off + 4) == FAIL)
-            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
-        /* re-write un-comp. len */
-        if (HP_write(file_rec, local_ptbuf, 4) == FAIL)
-            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
-    } /* end if */
+        if (info->hdr != NULL) /* the header kept, see HCcreate() */
+            memcpy(info->hdr + 4, local_ptbuf, 4);
+        else {
+            if (HPseek(file_rec, data_off + 4) == FAIL)
+                HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+            /* re-write un-comp. len */
+            if (HP_write(file_rec, local_ptbuf, 4) == FAIL)
+                HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        } /* end else */
+    }     /* end if */
 
     ret_value = length; /* return length of bytes written */
 
@@ -1439,6 +1788,20 @@ HCPcloseAID(accrec_t *access_rec)
     /* BMR - reset special_info to NULL after memory is freed; problem shown
        by the failure when running hdp list with a large file on PC - 12/6/98 */
     if (--(info->attached) == 0) {
+        /* the header kept in a file created for streaming goes to the end
+           of the file, its old place is left unused */
+        if (info->hdr != NULL) {
+            filerec_t *file_rec = HAatom_object(access_rec->file_id);
+            int32      hdr_off;
+
+            if ((hdr_off = HPgetdiskblock(file_rec, info->hdr_len, TRUE)) == FAIL ||
+                HP_write(file_rec, info->hdr, info->hdr_len) == FAIL ||
+                HTPupdate(access_rec->ddid, hdr_off, info->hdr_len) == FAIL)
+                ret = FAIL;
+            free(info->hdr);
+            if (ret == FAIL)
+                HERROR(DFE_WRITEERROR);
+        } /* end if */
         free(info);
         access_rec->special_info = NULL;
     }
@@ -1500,8 +1863,10 @@ RETURNS
 DESCRIPTION
    Return information about the given compression method.
 
-   Currently, reports if encoding and/or decoding are available. SZIP
-   is the only method that varies in the current versions.
+   Currently, reports if encoding and/or decoding are available. SZIP,
+   ZSTD and LZ4 are the only built-in methods that vary in the current
+   versions; the types from COMP_CODE_PLUGIN_MIN are available once a
+   coder is registered for them with HCregister_coder().
 
 
 ---------------------------------------------------------------------------*/
@@ -1534,6 +1899,9 @@ HCget_config_info(comp_coder_t coder_type, /* IN: compression type */
         case COMP_CODE_DEFLATE: /* gzip 'deflate' encoding, maybe optional */
             *compression_config_info = COMP_DECODER_ENABLED | COMP_ENCODER_ENABLED;
             break;
+        case COMP_CODE_LOSSY: /* error-bounded lossy encoding, built on zlib */
+            *compression_config_info = COMP_DECODER_ENABLED | COMP_ENCODER_ENABLED;
+            break;
 
         case COMP_CODE_SZIP:
 #ifdef H4_HAVE_LIBSZ
@@ -1547,13 +1915,97 @@ HCget_config_info(comp_coder_t coder_type, /* IN: compression type */
             *compression_config_info = 0;
 #endif /* H4_HAVE_LIBSZ */
             break;
-        default:
+
+        case COMP_CODE_ZSTD: /* zstd encoding, optional */
+#ifdef H4_HAVE_LIBZSTD
+            *compression_config_info = COMP_DECODER_ENABLED | COMP_ENCODER_ENABLED;
+#else
             *compression_config_info = 0;
-            HRETURN_ERROR(DFE_BADCODER, FAIL);
+#endif /* H4_HAVE_LIBZSTD */
+            break;
+
+        case COMP_CODE_LZ4: /* LZ4 encoding, optional */
+#ifdef H4_HAVE_LIBLZ4
+            *compression_config_info = COMP_DECODER_ENABLED | COMP_ENCODER_ENABLED;
+#else
+            *compression_config_info = 0;
+#endif /* H4_HAVE_LIBLZ4 */
+            break;
+        default: /* a coder registered with HCregister_coder() */
+        {
+            const hdf_coder_plugin_t *plugin = HCPplugin_coder(coder_type);
+
+            *compression_config_info = 0;
+            if (plugin == NULL)
+                HRETURN_ERROR(DFE_BADCODER, FAIL);
+            *compression_config_info = COMP_DECODER_ENABLED;
+            if (plugin->encode != NULL)
+                *compression_config_info |= COMP_ENCODER_ENABLED;
+        } break;
     }
     return SUCCEED;
 }
 
+/*--------------------------------------------------------------------------
+ NAME
+    HCset_decode_provider -- decode the chunks of a compression type elsewhere
+ USAGE
+    intn HCset_decode_provider(coder_type, func, user_data)
+    comp_coder_t coder_type;  IN: the compression type handled by 'func'
+    hdf_decode_func_t func;   IN: the decode provider, NULL to remove it
+    void *user_data;          IN: passed to 'func'
+ RETURNS
+    SUCCEED/FAIL
+ DESCRIPTION
+    Registers a decode provider, e.g. a GPU decompressor, for the chunked
+    SDSs and GRs compressed with 'coder_type'.  A read hands the compressed
+    chunks it has to bring into the chunk cache to 'func' in batches, as
+    they are stored in the file, instead of decoding them on the calling
+    thread or on the threads set with SDsetchunkthreads().  Chunks of
+    shuffled bytes are always decoded by the library.
+
+    The provider is used by all the files of the process.  It must be set
+    or removed while no chunked element is being read, and may be called
+    for several elements at once in a thread-safe build.
+
+--------------------------------------------------------------------------*/
+intn
+HCset_decode_provider(comp_coder_t coder_type, hdf_decode_func_t func, void *user_data)
+{
+    intn ret_value = SUCCEED;
+
+    HEclear();
+    if (coder_type <= COMP_CODE_NONE || coder_type >= H4_STATS_NCODERS)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    HCIdecode_provider[coder_type].user_data = (func != NULL ? user_data : NULL);
+    HCIdecode_provider[coder_type].func      = func;
+
+done:
+    return ret_value;
+} /* HCset_decode_provider */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPget_decode_provider -- the decode provider of a compression type
+ USAGE
+    hdf_decode_func_t HCPget_decode_provider(coder_type, user_data)
+    comp_coder_t coder_type;  IN: the compression type
+    void **user_data;         OUT: the data to pass to the provider
+ RETURNS
+    The provider set with HCset_decode_provider(), NULL if none
+--------------------------------------------------------------------------*/
+hdf_decode_func_t
+HCPget_decode_provider(comp_coder_t coder_type, void **user_data)
+{
+    if (coder_type <= COMP_CODE_NONE || coder_type >= H4_STATS_NCODERS ||
+        HCIdecode_provider[coder_type].func == NULL)
+        return NULL;
+
+    *user_data = HCIdecode_provider[coder_type].user_data;
+    return HCIdecode_provider[coder_type].func;
+} /* HCPget_decode_provider */
+
 /*--------------------------------------------------------------------------
  NAME
     HCPgetcomptype -- Retrieves compression type of an element
@@ -1807,3 +2259,66 @@ done:
 
     return ret_value;
 } /* HCPgetdatasize */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPwrite_compressed -- Write an already compressed data element
+ USAGE
+    intn HCPwrite_compressed(file_id, tag, ref, model_type, m_info, coder_type,
+                             c_info, length, comp_data, comp_len)
+        int32 file_id;           IN: file id
+        uint16 tag, ref;         IN: tag/ref of the new compressed element
+        comp_model_t model_type; IN: the type of modeling used
+        model_info *m_info;      IN: Information needed for the modeling type chosen
+        comp_coder_t coder_type; IN: the type of encoding used
+        comp_info *c_info;       IN: Information needed for the encoding type chosen
+        int32 length;            IN: length of the uncompressed data
+        const void *comp_data;   IN: the compressed data
+        int32 comp_len;          IN: length of the compressed data
+ RETURNS
+    SUCCEED/FAIL
+ DESCRIPTION
+    Creates a new compressed element from data that was encoded outside
+    of the compression layer, e.g. by the chunking layer on its worker
+    threads.  The result is the same as writing the uncompressed data
+    through HCcreate()/Hwrite(), provided 'comp_data' is exactly what the
+    coder 'coder_type' would have produced.  The element must not exist.
+
+--------------------------------------------------------------------------*/
+intn
+HCPwrite_compressed(int32 file_id, uint16 tag, uint16 ref, comp_model_t model_type, model_info *m_info,
+                    comp_coder_t coder_type, comp_info *c_info, int32 length, const void *comp_data,
+                    int32 comp_len)
+{
+    filerec_t *file_rec;    /* file record */
+    compinfo_t info;        /* special element information */
+    uint16     special_tag; /* special version of tag */
+    intn       ret_value = SUCCEED;
+
+    /* clear error stack and validate args */
+    HEclear();
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec) || SPECIALTAG(tag) || (special_tag = MKSPECIALTAG(tag)) == DFTAG_NULL ||
+        comp_data == NULL || length < 0 || comp_len < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* check for access permission */
+    if (!(file_rec->access & DFACC_WRITE))
+        HGOTO_ERROR(DFE_DENIED, FAIL);
+
+    /* only the parts of the special info that go into the header */
+    info.length           = length;
+    info.minfo.model_type = model_type;
+    info.cinfo.coder_type = coder_type;
+    if ((info.comp_ref = Htagnewref(file_id, DFTAG_COMPRESSED)) == 0)
+        HGOTO_ERROR(DFE_NOREF, FAIL);
+
+    /* write the compressed data, then the header pointing to it */
+    if (Hputelement(file_id, DFTAG_COMPRESSED, info.comp_ref, (const uint8 *)comp_data, comp_len) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    if (HCIwrite_header(file_id, &info, special_tag, ref, c_info, m_info) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+done:
+    return ret_value;
+} /* HCPwrite_compressed */
@@ -26,7 +26,8 @@
 
 /* For determining which type of modeling is being done */
 typedef enum {
-    COMP_MODEL_STDIO = 0 /* for Standard C I/O model */
+    COMP_MODEL_STDIO   = 0, /* for Standard C I/O model */
+    COMP_MODEL_SHUFFLE = 1  /* for the bytes of the elements shuffled before coding */
 } comp_model_t;
 
 /* For determining which type of encoding is being done */
@@ -39,11 +40,21 @@ typedef enum {
     COMP_CODE_SZIP,       /* for szip encoding */
     COMP_CODE_INVALID,    /* invalid last code, for range checking */
     COMP_CODE_JPEG,       /* _Ugly_ hack to allow JPEG images to be created with GRsetcompress */
-    COMP_CODE_IMCOMP = 12 /* another _Ugly_ hack to allow IMCOMP images to
+    COMP_CODE_IMCOMP = 12, /* another _Ugly_ hack to allow IMCOMP images to
                    be inquired, 12 to be the same as COMP_IMCOMP writing
                    will not be allowed, however.  -BMR, Jul 2012 */
+    COMP_CODE_ZSTD = 13,   /* for zstd encoding, past the JPEG and IMCOMP hacks
+                   so that no existing code changes value */
+    COMP_CODE_LZ4 = 14,    /* for LZ4 encoding, fast rather than small */
+    COMP_CODE_LOSSY = 15   /* for error-bounded lossy encoding of floating-point data */
+                           /* a new code must stay below H4_STATS_NCODERS in hdf.h */
 } comp_coder_t;
 
+/* Range of the compression types left to the coders registered with
+   HCregister_coder(), the type is stored in 16 bits */
+#define COMP_CODE_PLUGIN_MIN 256
+#define COMP_CODE_PLUGIN_MAX 65535
+
 /* Compression types available */
 #define COMP_NONE   0
 #define COMP_JPEG   2
@@ -54,12 +65,30 @@ typedef enum {
 #define COMP_DECODER_ENABLED 1
 #define COMP_ENCODER_ENABLED 2
 
+/* Range of the zstd compression levels accepted */
+#define H4_ZSTD_MIN_LEVEL 1
+#define H4_ZSTD_MAX_LEVEL 22
+
+/* Range of the LZ4 accelerations accepted, stored in 16 bits */
+#define H4_LZ4_MIN_ACCELERATION 1
+#define H4_LZ4_MAX_ACCELERATION 65535
+
+/* How comp_info.lossy.tolerance bounds the error of the lossy coder */
+#define H4_LOSSY_ABS 0 /* the error of each value */
+#define H4_LOSSY_REL 1 /* the error relative to the range of the values coded together */
+
+/* Number of parameters a coder plugin can keep in the compression header */
+#define H4_PLUGIN_MAX_CD_VALUES 4
+
 typedef union tag_model_info { /* Union to contain modeling information */
     struct {
         int32  nt;   /* number type */
         intn   ndim; /* number of dimensions */
         int32 *dims; /* array of dimensions */
     } dim;
+    struct {
+        intn elem_size; /* number of bytes in one element */
+    } shuffle;
 } model_info;
 
 typedef union tag_comp_info { /* Union to contain compression information */
@@ -72,6 +101,10 @@ typedef union tag_comp_info { /* Union to contain compression information */
         /* 0..255 for JPEG baseline compatibility */
         /* This is only an issue for quality */
         /* settings below 24 */
+        /* Shape of the chunks of a JPEG chunked image, set by GRsetchunk */
+        int32 width;  /* pixels in a scanline of a chunk */
+        int32 height; /* scanlines in a chunk */
+        intn  ncomps; /* components of a pixel, 1 or 3 */
     } jpeg;
     struct { /* struct to contain information about how to compress */
         /* or decompress a N-bit encoded dataset */
@@ -89,6 +122,14 @@ typedef union tag_comp_info { /* Union to contain compression information */
         /* or decompress a gzip encoded dataset */
         intn level; /* how hard to work when compressing the data */
     } deflate;
+    struct { /* struct to contain info about how to compress */
+        /* or decompress a zstd encoded dataset */
+        intn level; /* how hard to work when compressing the data, 1 to 22 */
+    } zstd;
+    struct { /* struct to contain info about how to compress */
+        /* or decompress a LZ4 encoded dataset */
+        intn acceleration; /* how much speed to trade for size, 1 is the default */
+    } lz4;
     struct {
         int32 options_mask;        /* IN */
         int32 pixels_per_block;    /* IN */
@@ -96,9 +137,56 @@ typedef union tag_comp_info { /* Union to contain compression information */
         int32 bits_per_pixel;      /* OUT: size of NT */
         int32 pixels;              /* OUT: size of dataset or chunk */
     } szip;                        /* for szip encoding */
+    struct { /* struct to contain info about how to compress */
+        /* or decompress error-bounded lossy coded floating-point data */
+        int32   nt;        /* number type of the data, set by SDsetcompress() and SDsetchunk() */
+        intn    mode;      /* H4_LOSSY_ABS or H4_LOSSY_REL */
+        float64 tolerance; /* largest error allowed */
+    } lossy;
+    struct { /* struct to contain the parameters of a coder registered */
+        /* with HCregister_coder(), kept in the compression header */
+        int32  cd_nelmts;                          /* number of values used */
+        uint32 cd_values[H4_PLUGIN_MAX_CD_VALUES]; /* the coder's own parameters */
+    } plugin;
 
 } comp_info;
 
+/* Decode provider, see HCset_decode_provider(): decodes the 'n' chunks
+   'raw[i]', 'raw_len[i]' bytes each and stored as SDreadchunkraw() returns
+   them, into the 'data_len' byte buffers 'data[i]', setting 'status[i]' to
+   SUCCEED for each chunk it decoded.  The library decodes the chunks left
+   at FAIL itself.  Returns SUCCEED, or FAIL to have all of them decoded by
+   the library. */
+typedef intn (*hdf_decode_func_t)(comp_coder_t coder_type, const comp_info *c_info, int32 n,
+                                  const uint8 *const *raw, const int32 *raw_len, uint8 *const *data,
+                                  int32 data_len, intn *status, void *user_data);
+
+/* Coder plugin, see HCregister_coder(): codes whole elements, a chunk or
+   the data of an SDS or GR.  'encode' codes the 'src_len' bytes of 'src'
+   into the buffer 'dst' of 'dst_len' bytes, as many as 'bound' returned,
+   or src_len + src_len/8 + 64 if 'bound' is NULL.  'decode' does the
+   reverse.  Both return the number of bytes written to 'dst', or FAIL.
+   'decode' may be called from the worker threads set with
+   SDsetchunkthreads() and must be thread-safe.  'encode' is NULL for a
+   coder that can only read. */
+typedef struct {
+    comp_coder_t id;   /* COMP_CODE_PLUGIN_MIN to COMP_CODE_PLUGIN_MAX */
+    const char  *name; /* name of the coder */
+    intn (*init)(void); /* called when registered, NULL if not needed */
+    void (*term)(void); /* called when unregistered, NULL if not needed */
+    int32 (*bound)(const comp_info *c_info, int32 src_len);
+    int32 (*encode)(const comp_info *c_info, const uint8 *src, int32 src_len, uint8 *dst, int32 dst_len);
+    int32 (*decode)(const comp_info *c_info, const uint8 *src, int32 src_len, uint8 *dst, int32 dst_len);
+} hdf_coder_plugin_t;
+
+/* Function a shared library loaded by HCload_coder_plugins() exports under
+   the name H4_PLUGIN_GET_CODER, returning the coder to register */
+typedef const hdf_coder_plugin_t *(*hdf_coder_plugin_get_t)(void);
+#define H4_PLUGIN_GET_CODER "H4PLget_coder"
+
+/* Environment variable with the directories searched for coder plugins */
+#define H4_PLUGIN_PATH_ENV "HDF4_PLUGIN_PATH"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -31,12 +31,14 @@
 /* structure for storing modeling information */
 /* only allow modeling and master compression routines access */
 
-#include "mstdio.h" /* stdio modeling header */
+#include "mstdio.h"   /* stdio modeling header */
+#include "mshuffle.h" /* shuffle modeling header */
 
 typedef struct comp_model_info_tag {
-    comp_model_t model_type;                /* model this stream is using */
-    union {                                 /* union of all the different types of model information */
-        comp_model_stdio_info_t stdio_info; /* stdio model info */
+    comp_model_t model_type;                    /* model this stream is using */
+    union {                                     /* union of all the different types of model information */
+        comp_model_stdio_info_t   stdio_info;   /* stdio model info */
+        comp_model_shuffle_info_t shuffle_info; /* shuffle model info */
     } model_info;
     funclist_t model_funcs; /* functions to perform modeling */
 } comp_model_info_t;
@@ -52,6 +54,11 @@ typedef struct comp_model_info_tag {
 #include "cskphuff.h" /* Skipping huffman encoding header */
 #include "cdeflate.h" /* gzip 'deflate' encoding header */
 #include "cszip.h"    /* szip encoding header */
+#include "czstd.h"    /* zstd encoding header */
+#include "clz4.h"     /* LZ4 encoding header */
+#include "cjpeg.h"    /* JPEG encoding header, for chunks */
+#include "clossy.h"   /* error-bounded lossy encoding header */
+#include "cplugin.h"  /* registered coder plugins header */
 
 typedef struct comp_coder_info_tag {
     comp_coder_t coder_type;                    /* coding scheme this stream is using */
@@ -62,6 +69,11 @@ typedef struct comp_coder_info_tag {
         comp_coder_skphuff_info_t skphuff_info; /* Skipping huffman coding info */
         comp_coder_deflate_info_t deflate_info; /* gzip 'deflate' coding info */
         comp_coder_szip_info_t    szip_info;    /* szip coding info */
+        comp_coder_zstd_info_t    zstd_info;    /* zstd coding info */
+        comp_coder_lz4_info_t     lz4_info;     /* LZ4 coding info */
+        comp_coder_jpeg_info_t    jpeg_info;    /* JPEG coding info */
+        comp_coder_lossy_info_t   lossy_info;   /* error-bounded lossy coding info */
+        comp_coder_plugin_info_t  plugin_info;  /* coder plugin info */
 
     } coder_info;
     funclist_t coder_funcs; /* functions to perform encoding */
@@ -93,6 +105,9 @@ typedef struct compinfo_tag {
     comp_coder_info_t  cinfo;    /* coding information */
     intn               caching;  /* whether caching is turned on */
     comp_state_cache_t sinfo;    /* state information for caching */
+    uint8             *hdr;      /* the header, in a file created for streaming,
+                                    written again when the element is closed */
+    int32              hdr_len;  /* # of bytes of 'hdr' */
 } compinfo_t;
 
 #endif /* H4_HCOMPI_H */
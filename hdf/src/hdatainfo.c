@@ -510,6 +510,10 @@ Vgetattdatainfo(int32 vgid, intn attrindex, int32 *offset, int32 *length)
         /* Bad attr list */
         HGOTO_ERROR(DFE_BADATTR, FAIL);
 
+    /* Attributes in the compact store share the store's vdata */
+    if (vg_alist == vg->alist && vg_alist[adjusted_index].atag == VG_ATTR_STORE_TAG)
+        HGOTO_DONE(VIattr_store_datainfo(vg, adjusted_index, offset, length));
+
     /* Get vdata holding the attribute */
     if (FAIL == (attr_vsid = VSattach(vg->f, (int32)vg_alist[adjusted_index].aref, "r")))
         HGOTO_ERROR(DFE_CANTATTACH, FAIL);
@@ -716,7 +720,9 @@ GRgetattdatainfo(int32 id, int32 attrindex, int32 *offset, int32 *length)
         if (NULL == (ri_ptr = (ri_info_t *)HAatom_object(id)))
             HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
 
-        /* Check index against image's attribute count */
+        /* Check index against image's attribute count, reading them in first */
+        if (GRIget_lattrs(ri_ptr) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
         if (attrindex >= ri_ptr->lattr_count)
             HGOTO_ERROR(DFE_ARGS, FAIL);
         search_tree = ri_ptr->lattree;
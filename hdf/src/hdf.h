@@ -58,6 +58,13 @@ typedef enum {
 /* The magic cookie for Hcache to cache all files */
 #define CACHE_ALL_FILES (-2)
 
+/* How a file is going to be read, told to the system, see Hsetaccesspattern() */
+#define HDF_ACCESS_NORMAL     0x00 /* no particular order */
+#define HDF_ACCESS_SEQUENTIAL 0x01 /* from start to end: read ahead more */
+#define HDF_ACCESS_RANDOM     0x02 /* in no order: do not read ahead */
+#define HDF_ACCESS_WILLNEED   0x04 /* soon: start reading the whole file in */
+#define HDF_ACCESS_DONTNEED   0x08 /* once: drop the pages from the page cache once read */
+
 /* File access modes */
 /* 001--007 for different serial modes */
 /* 011--017 for different parallel modes */
@@ -124,6 +131,182 @@ typedef int32 HFILEID;
 
 typedef intn (*hdf_termfunc_t)(void); /* termination function typedef */
 
+/* One request of a batched element read, see Hreadv() */
+typedef struct hdf_readv_t {
+    uint16 tag;    /* IN: tag of the element to read */
+    uint16 ref;    /* IN: ref of the element to read */
+    int32  offset; /* IN: offset in the element to start reading at */
+    int32  length; /* IN: # of bytes to read, 0 for the rest of the element */
+    void  *buf;    /* IN: buffer to read the data into */
+    int32  nread;  /* OUT: # of bytes read */
+} hdf_readv_t;
+
+/* Allocation routines for the library's metadata, see Hset_allocator() */
+typedef struct hdf_allocator_t {
+    void *(*alloc)(size_t size, void *ctx); /* allocates like malloc() */
+    void (*free)(void *ptr, void *ctx);     /* frees like free() */
+    void *ctx;                              /* passed to both */
+} hdf_allocator_t;
+
+/* What the large buffers of the library are made of, see Hsethugepages() */
+#define HDF_HUGEPAGES_NONE        0x00 /* memory from malloc() */
+#define HDF_HUGEPAGES_TRANSPARENT 0x01 /* transparent huge pages, asked for with madvise() */
+#define HDF_HUGEPAGES_EXPLICIT    0x02 /* reserved huge pages, else transparent ones */
+#define HDF_HUGEPAGES_LOCAL       0x10 /* on the NUMA node of the thread that first writes them */
+
+/* Kinds of memory the library holds, see Hget_memory_usage() */
+typedef enum {
+    HDF_MEM_CHUNK_CACHE = 0, /* pages of the chunk caches */
+    HDF_MEM_SCRATCH,         /* conversion and I/O buffers kept between calls */
+    HDF_MEM_TBBT,            /* nodes of the tag/ref, vgroup and vdata trees */
+    HDF_MEM_FREE_LISTS,      /* released access records and nodes kept for reuse */
+    HDF_MEM_ATOMS,           /* slot tables of the atom groups */
+    HDF_MEM_VHEADERS,        /* per-file arenas of the vgroup and vdata headers */
+    HDF_MEM_NC,              /* parsed netCDF metadata of the open SD files */
+    HDF_MEM_NCATEGORIES
+} hdf_mem_category_t;
+
+/* Bytes the library holds, by kind of memory, see Hget_memory_usage() */
+typedef struct hdf_memory_report_t {
+    size_t current[HDF_MEM_NCATEGORIES]; /* # of bytes held now */
+    size_t peak[HDF_MEM_NCATEGORIES];    /* most bytes held at once */
+} hdf_memory_report_t;
+
+/* An attribute returned by the *readallattrs() routines; name and values
+   point into the caller's arena */
+typedef struct hdf_attr_t {
+    char *name;   /* null-terminated name of the attribute */
+    int32 ntype;  /* number type of the values */
+    int32 count;  /* # of values */
+    void *values; /* values, in memory format */
+} hdf_attr_t;
+
+/* A vgroup of the hierarchy returned by Vgettree(); the arrays and strings
+   point into the tree's allocation */
+typedef struct hdf_vgnode_t {
+    uint16  ref;       /* ref of the vgroup */
+    char   *name;      /* null-terminated name, "" if none */
+    char   *vclass;    /* null-terminated class name, "" if none */
+    int32   nentries;  /* # of tag/ref entries */
+    uint16 *tags;      /* tag of each entry */
+    uint16 *refs;      /* ref of each entry */
+    int32   nchildren; /* # of entries that are vgroups of the file */
+    int32  *children;  /* node index of each of those vgroups */
+    int32   nparents;  /* # of entries of vgroups that are this one */
+} hdf_vgnode_t;
+
+/* The vgroup hierarchy of a file, see Vgettree() */
+typedef struct hdf_vgtree_t {
+    int32         nnodes; /* # of vgroups */
+    hdf_vgnode_t *nodes;  /* the vgroups, in the order of their elements in the file */
+} hdf_vgtree_t;
+
+/* Comparisons of a condition of VSquery(); VS_QUERY_SORTED may be or'ed
+   into one to tell that its field never decreases from record to record */
+#define VS_QUERY_LT     1
+#define VS_QUERY_LE     2
+#define VS_QUERY_EQ     3
+#define VS_QUERY_NE     4
+#define VS_QUERY_GE     5
+#define VS_QUERY_GT     6
+#define VS_QUERY_SORTED 0x100
+
+/* A condition on a field of the records of a vdata, see VSquery() */
+typedef struct hdf_vscond_t {
+    const char *field; /* name of a field of order 1 and numeric type */
+    intn        op;    /* one of the VS_QUERY_* comparisons */
+    float64     value; /* value the field is compared to */
+} hdf_vscond_t;
+
+/* What Hprobe() finds out about a file */
+typedef struct hdf_probe_t {
+    int32  magic;   /* first 4 bytes of the file, decoded big-endian */
+    intn   hdf;     /* TRUE if they are the HDF magic number */
+    intn   dds_ok;  /* TRUE if the first DD block was checked and is sane */
+    int32  ndds;    /* # of DDs in the first DD block, if checked */
+    uint32 majorv;  /* version of the library that wrote the file, */
+    uint32 minorv;  /* from the version tag, if in the first DD block */
+    uint32 release; /* and checked; 0 otherwise */
+} hdf_probe_t;
+
+/* # of entries of hdf_stats_t.bytes_decoded, one more than the largest comp_coder_t */
+#define H4_STATS_NCODERS 16
+
+/* I/O statistics of an open file, see Hgetstats() */
+typedef struct hdf_stats_t {
+    uint32 bytes_read;                      /* # of bytes read from the file */
+    uint32 bytes_written;                   /* # of bytes written to the file */
+    uint32 nreads;                          /* # of read system calls */
+    uint32 nwrites;                         /* # of write system calls */
+    uint32 nseeks;                          /* # of seeks actually made */
+    uint32 nlookups;                        /* # of DD lookups by tag and ref */
+    uint32 nopens;                          /* # of reopens of its parked descriptor */
+    uint32 bytes_decoded[H4_STATS_NCODERS]; /* # of bytes decoded, indexed by comp_coder_t */
+} hdf_stats_t;
+
+/* Statistics of the chunk cache of a chunked element, see SDgetchunkcachestats() */
+typedef struct hdf_cache_stats_t {
+    int32 hits;      /* # of chunk lookups that found the chunk cached */
+    int32 misses;    /* # of chunk lookups that had to read the chunk in */
+    int32 evictions; /* # of chunks evicted to make room for others */
+} hdf_cache_stats_t;
+
+/* Phases of the library reported to the tracing callback, see Hset_trace_callback() */
+typedef enum {
+    HDF_TRACE_OPEN = 0,   /* Hopen() of a file */
+    HDF_TRACE_DD_LOAD,    /* reading the DD list of a file being opened */
+    HDF_TRACE_DD_FLUSH,   /* writing the changed DD blocks of a file */
+    HDF_TRACE_READ,       /* reading bytes from a file */
+    HDF_TRACE_WRITE,      /* writing bytes to a file */
+    HDF_TRACE_CHUNK,      /* bringing a chunk of a chunked element into its cache */
+    HDF_TRACE_DECODE,     /* decoding compressed data */
+    HDF_TRACE_CONVERT,    /* converting numbers to or from their file representation */
+    HDF_TRACE_META_READ,  /* reading the SD metadata of a file being opened */
+    HDF_TRACE_META_FLUSH, /* writing the changed SD metadata of a file */
+    HDF_TRACE_NOPS        /* # of phases, for range checking */
+} hdf_trace_op_t;
+
+/* Tracing callback: called with 'end' FALSE when a phase begins and TRUE when
+   it ends, 'count' being the # of bytes or elements the phase works on */
+typedef void (*hdf_trace_func_t)(hdf_trace_op_t op, intn end, int32 count, void *user_data);
+
+/* Settings of the library, see Hsetconfig(): each one starts from the
+   environment variable named after it, e.g. HDF4_CHUNK_CACHE_BYTES, read
+   when the library starts, and 0 stands for the built-in default */
+typedef enum {
+    HDF_CONFIG_CHUNK_CACHE_BYTES, /* bytes of the cache of a chunked element opened next,
+                                     0 for a row of chunks */
+    HDF_CONFIG_IO_BUFSIZE,        /* buffer of the netCDF files opened next, 0 for 1 MB,
+                                     see SDsetxdrbuffersize() */
+    HDF_CONFIG_DEFLATE_BUFSIZE,   /* file I/O buffer of a deflate element opened next, 0 for 4 KB */
+    HDF_CONFIG_MAX_FILES,         /* SD files open before their table grows, 0 for MAX_FILE */
+    HDF_CONFIG_TASK_THREADS,      /* most threads of any parallel work, 0 for no limit,
+                                     see Hsettaskthreads() */
+    HDF_CONFIG_NSETTINGS          /* # of settings, for range checking */
+} hdf_config_t;
+
+/* Task executor, see Hsettaskexecutor(): calls 'task' once for every task
+   index in [0, ntasks), with 'arg', on up to 'nthreads' threads, and returns
+   SUCCEED once all the calls have returned, or FAIL */
+typedef intn (*hdf_executor_func_t)(void *user_data, int32 ntasks, intn nthreads,
+                                    void (*task)(void *arg, int32 i), void *arg);
+
+/* A file driver, see Hsetdriver(): the operations through which the library
+   reaches the files opened with it.  'open' opens the file named 'path' with
+   the access mode of Hopen(), creating it for DFACC_CREATE, and returns the
+   handle passed to the other operations, or NULL.  The other operations
+   return SUCCEED or FAIL, 'size' the length of the file or FAIL.  'write' is
+   NULL for a read-only driver and 'flush' for one with nothing to flush. */
+typedef struct hdf_driver_t {
+    const char *name; /* name the driver is selected by */
+    void *(*open)(const char *path, intn acc_mode);
+    intn (*read)(void *handle, int32 offset, void *buf, int32 bytes);
+    intn (*write)(void *handle, int32 offset, const void *buf, int32 bytes);
+    int32 (*size)(void *handle);
+    intn (*flush)(void *handle);
+    intn (*close)(void *handle);
+} hdf_driver_t;
+
 /* .................................................................. */
 
 /* Publicly accessible functions declarations.  This includes all the
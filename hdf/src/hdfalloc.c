@@ -12,13 +12,51 @@
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 #include "hdf.h"
+#include "tbbt.h"
+#include "hlock.h"
+
+/* Large buffers can be mapped, with huge pages where the system has them,
+   see Hsethugepages() */
+#if defined(H4_HAVE_MMAP) && defined(H4_HAVE_SYS_MMAN_H)
+#include <sys/mman.h>
+#if defined(MAP_ANONYMOUS) || defined(MAP_ANON)
+#define HDLARGE_MAP_SUPPORTED
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+#endif
+
+/* ...and bound to the NUMA node of the thread using them, on Linux */
+#if defined(HDLARGE_MAP_SUPPORTED) && defined(__linux__)
+#include <sys/syscall.h>
+#if defined(SYS_mbind)
+#define HDLARGE_MBIND_SUPPORTED
+#define HDMPOL_LOCAL 4 /* MPOL_LOCAL of <linux/mempolicy.h> */
+#endif
+#endif
 
 /*
 LOCAL ROUTINES
-  None
+  HDlarge_map  -- map a large buffer
 EXPORTED ROUTINES
   HDmemfill    -- copy a chunk of memory repetitively into another chunk
   HIstrncpy    -- string copy with termination
+  HDarena_attr -- place an attribute's name and values in a caller's arena
+  Hset_allocator -- set the allocator of the library's metadata
+  HDmeta_alloc   -- allocate a block of metadata
+  HDmeta_free    -- free a block of metadata
+  HDmarena_alloc -- allocate from a metadata arena
+  HDmarena_free  -- free a metadata arena
+  HDmem_acquire  -- account for memory the library took
+  HDmem_release  -- account for memory the library gave back
+  HDscratch_resize -- replace a scratch buffer kept between calls
+  Hsethugepages  -- set what the large buffers are made of
+  HDlarge_alloc  -- allocate a buffer that may be large
+  HDlarge_free   -- free a buffer from HDlarge_alloc
+  HPregister_mem_funcs -- register the memory routines of an interface
+  Hget_memory_usage    -- get the memory held by the library
+  Htrim_memory         -- free the memory the library keeps for reuse
   strdup     -- in-library replacement for non-ANSI strdup()
 */
 
@@ -46,7 +84,8 @@ EXPORTED ROUTINES
  GLOBAL VARIABLES
  COMMENTS, BUGS, ASSUMPTIONS
     The src and dest pointers are assumed to point to valid portions of
-    memory.
+    memory.  'src' can be the start of 'dest' itself, to repeat the
+    first item already in place over the rest of the buffer.
  EXAMPLES
  REVISION LOG
 --------------------------------------------------------------------------*/
@@ -60,7 +99,8 @@ HDmemfill(void *dest, const void *src, uint32 item_size, uint32 num_items)
 
     /* minimal error check for 0 sized array or item size */
     if (num_items > 0 && item_size > 0) {
-        memcpy(dest, src, item_size); /* copy first item */
+        if (dest != src)
+            memcpy(dest, src, item_size); /* copy first item */
 
         copy_size  = item_size;
         copy_items = 1;
@@ -118,3 +158,632 @@ HIstrncpy(char *dest, const char *source, intn len)
     *dest = '\0'; /* Force the last byte be '\0'   */
     return destp;
 } /* end HIstrncpy() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HDarena_attr -- place an attribute's name and values in a caller's arena
+ USAGE
+    intn HDarena_attr(attr,arena,arena_size,used,name,ntype,count,val_size)
+        hdf_attr_t *attr;       OUT: attribute entry to fill in
+        void *arena;            IN: caller's arena, may be NULL
+        int32 arena_size;       IN: size of the arena in bytes
+        int32 *used;            IN/OUT: # of bytes of the arena used so far
+        const char *name;       IN: name of the attribute
+        int32 ntype;            IN: number type of the attribute
+        int32 count;            IN: # of values of the attribute
+        int32 val_size;         IN: size of the values in memory, in bytes
+ RETURNS
+    TRUE if the attribute was placed in the arena, FALSE if it did not fit.
+ DESCRIPTION
+    Common code for the *readallattrs() routines.  Reserves room for the
+    values, aligned to 8 bytes, followed by the null-terminated name at
+    offset *used of the arena and advances *used past them whether they
+    fit or not, so that *used ends up as the size of arena needed for all
+    the attributes.  If they fit, the name is copied and attr->values
+    points at the room left for the caller to fill in; otherwise
+    attr->name and attr->values are set to NULL.
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+intn
+HDarena_attr(hdf_attr_t *attr, void *arena, int32 arena_size, int32 *used, const char *name, int32 ntype,
+             int32 count, int32 val_size)
+{
+    int32 start;    /* offset of the values in the arena */
+    int32 name_len; /* length of the name, with its terminator */
+
+    start    = (*used + 7) & ~7;
+    name_len = (int32)strlen(name) + 1;
+    *used    = start + val_size + name_len;
+
+    attr->ntype = ntype;
+    attr->count = count;
+    if (arena == NULL || *used > arena_size) {
+        attr->name   = NULL;
+        attr->values = NULL;
+        return FALSE;
+    } /* end if */
+
+    attr->values = (uint8 *)arena + start;
+    attr->name   = (char *)attr->values + val_size;
+    memcpy(attr->name, name, (size_t)name_len);
+    return TRUE;
+} /* end HDarena_attr() */
+
+/* Header of a block of metadata, the routine and context to free it with */
+typedef union HDmeta_hdr_t {
+    struct {
+        void (*free)(void *ptr, void *ctx);
+        void *ctx;
+    } a;
+    double align; /* keeps what follows aligned */
+} HDmeta_hdr_t;
+
+/* A block of a metadata arena, the room to allocate from follows it */
+typedef struct HDmarena_block_t {
+    struct HDmarena_block_t *next; /* block allocated before this one */
+    size_t                   size; /* # of bytes of room in the block */
+    size_t                   used; /* # of bytes of room allocated */
+    double                   align;
+} HDmarena_block_t;
+
+/* Size of the first block of an arena and largest size of the next ones */
+#define HDMARENA_MIN 4096
+#define HDMARENA_MAX 65536
+
+static void *
+HDmeta_malloc(size_t size, void *ctx)
+{
+    (void)ctx;
+    return malloc(size);
+}
+
+static void
+HDmeta_mfree(void *ptr, void *ctx)
+{
+    (void)ctx;
+    free(ptr);
+}
+
+/* The allocator of the metadata blocks */
+static hdf_allocator_t HDmeta_allocator = {HDmeta_malloc, HDmeta_mfree, NULL};
+
+/*--------------------------------------------------------------------------
+ NAME
+    Hset_allocator -- set the allocator of the library's metadata
+ USAGE
+    intn Hset_allocator(allocator)
+        const hdf_allocator_t *allocator;   IN: allocation routines, NULL for
+                                            malloc() and free()
+ RETURNS
+    SUCCEED/FAIL
+ DESCRIPTION
+    Makes the library allocate the blocks its metadata lives in with
+    allocator->alloc and free them with allocator->free, passing
+    allocator->ctx to both, e.g. to account for the memory of the
+    library.  These blocks are the per-file arenas of the vgroup and
+    vdata headers and the slabs of the nodes of the tag/ref, vgroup and
+    vdata trees, see HDmeta_alloc().
+
+    Blocks are freed by the allocator that allocated them, so the
+    allocator can be changed at any time, but not while another thread
+    is in the library.  Other memory is allocated with malloc().
+--------------------------------------------------------------------------*/
+intn
+Hset_allocator(const hdf_allocator_t *allocator)
+{
+    intn ret_value = SUCCEED;
+
+    HEclear();
+    if (allocator == NULL) {
+        HDmeta_allocator.alloc = HDmeta_malloc;
+        HDmeta_allocator.free  = HDmeta_mfree;
+        HDmeta_allocator.ctx   = NULL;
+    }
+    else {
+        if (allocator->alloc == NULL || allocator->free == NULL)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+        HDmeta_allocator = *allocator;
+    }
+
+done:
+    return ret_value;
+} /* end Hset_allocator() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HDmeta_alloc -- allocate a block of metadata
+ USAGE
+    void *HDmeta_alloc(size)
+        size_t size;            IN: # of bytes to allocate
+ RETURNS
+    The block, NULL if it could not be allocated.
+ DESCRIPTION
+    Allocates a block with the allocator set by Hset_allocator(), to be
+    freed with HDmeta_free().
+--------------------------------------------------------------------------*/
+void *
+HDmeta_alloc(size_t size)
+{
+    HDmeta_hdr_t *hdr;
+
+    if ((hdr = HDmeta_allocator.alloc(sizeof(HDmeta_hdr_t) + size, HDmeta_allocator.ctx)) == NULL)
+        return NULL;
+    hdr->a.free = HDmeta_allocator.free;
+    hdr->a.ctx  = HDmeta_allocator.ctx;
+    return hdr + 1;
+} /* end HDmeta_alloc() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HDmeta_free -- free a block of metadata
+ USAGE
+    void HDmeta_free(ptr)
+        void *ptr;              IN: block from HDmeta_alloc(), may be NULL
+ DESCRIPTION
+    Frees a block with the allocator that allocated it.
+--------------------------------------------------------------------------*/
+void
+HDmeta_free(void *ptr)
+{
+    HDmeta_hdr_t *hdr;
+
+    if (ptr != NULL) {
+        hdr = (HDmeta_hdr_t *)ptr - 1;
+        hdr->a.free(hdr, hdr->a.ctx);
+    }
+} /* end HDmeta_free() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HDmarena_alloc -- allocate from a metadata arena
+ USAGE
+    void *HDmarena_alloc(arena, size)
+        void **arena;           IN/OUT: the arena, NULL when empty
+        size_t size;            IN: # of bytes to allocate
+ RETURNS
+    The memory, zeroed and aligned to 8 bytes, NULL if it could not be
+    allocated.
+ DESCRIPTION
+    Allocates from the last block of the arena, or from a new block of
+    metadata when it is full, each new block twice as large as the one
+    before up to HDMARENA_MAX bytes.  Memory of an arena is not freed by
+    itself: HDmarena_free() frees all of it at once, for the metadata
+    that lives as long as a file.
+--------------------------------------------------------------------------*/
+void *
+HDmarena_alloc(void **arena, size_t size)
+{
+    HDmarena_block_t *blk = (HDmarena_block_t *)*arena;
+    size_t            bsize;
+    void             *ret_value;
+
+    size = (size + 7) & ~(size_t)7;
+    if (blk == NULL || blk->size - blk->used < size) {
+        bsize = (blk == NULL) ? HDMARENA_MIN : MIN(2 * blk->size, HDMARENA_MAX);
+        if (bsize < size)
+            bsize = size;
+        if ((blk = (HDmarena_block_t *)HDmeta_alloc(sizeof(HDmarena_block_t) + bsize)) == NULL)
+            return NULL;
+        blk->next = (HDmarena_block_t *)*arena;
+        blk->size = bsize;
+        blk->used = 0;
+        *arena    = blk;
+        HDmem_acquire(HDF_MEM_VHEADERS, sizeof(HDmarena_block_t) + bsize);
+    }
+
+    ret_value = (uint8 *)(blk + 1) + blk->used;
+    blk->used += size;
+    memset(ret_value, 0, size);
+    return ret_value;
+} /* end HDmarena_alloc() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HDmarena_free -- free a metadata arena
+ USAGE
+    void HDmarena_free(arena)
+        void **arena;           IN/OUT: the arena, set to NULL
+ DESCRIPTION
+    Frees all the memory allocated from the arena, one block at a time.
+--------------------------------------------------------------------------*/
+void
+HDmarena_free(void **arena)
+{
+    HDmarena_block_t *blk;
+
+    while ((blk = (HDmarena_block_t *)*arena) != NULL) {
+        *arena = blk->next;
+        HDmem_release(HDF_MEM_VHEADERS, sizeof(HDmarena_block_t) + blk->size);
+        HDmeta_free(blk);
+    }
+} /* end HDmarena_free() */
+
+/* Bytes held by the library and most bytes held at once, by category */
+static size_t HDmem_current[HDF_MEM_NCATEGORIES];
+static size_t HDmem_peak[HDF_MEM_NCATEGORIES];
+
+/* Routines of the upper layers, see HPregister_mem_funcs() */
+#define HDMEM_MAX_TRIM 8
+static size_t (*HDmem_usage[HDF_MEM_NCATEGORIES])(void);
+static intn (*HDmem_trim[HDMEM_MAX_TRIM])(void);
+
+/*--------------------------------------------------------------------------
+ NAME
+    HDmem_acquire -- account for memory the library took
+ USAGE
+    void HDmem_acquire(category, size)
+        hdf_mem_category_t category;    IN: kind of memory
+        size_t size;                    IN: # of bytes taken
+ DESCRIPTION
+    Adds 'size' bytes to the memory held in 'category', as reported by
+    Hget_memory_usage().  Each call is matched by HDmem_release() with the
+    same size when the memory is given back.
+--------------------------------------------------------------------------*/
+void
+HDmem_acquire(hdf_mem_category_t category, size_t size)
+{
+    HL_LOCK_LIBRARY();
+    HDmem_current[category] += size;
+    if (HDmem_current[category] > HDmem_peak[category])
+        HDmem_peak[category] = HDmem_current[category];
+    HL_UNLOCK_LIBRARY();
+} /* end HDmem_acquire() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HDmem_release -- account for memory the library gave back
+ USAGE
+    void HDmem_release(category, size)
+        hdf_mem_category_t category;    IN: kind of memory
+        size_t size;                    IN: # of bytes given back
+--------------------------------------------------------------------------*/
+void
+HDmem_release(hdf_mem_category_t category, size_t size)
+{
+    HL_LOCK_LIBRARY();
+    HDmem_current[category] -= MIN(size, HDmem_current[category]);
+    HL_UNLOCK_LIBRARY();
+} /* end HDmem_release() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HDscratch_resize -- replace a scratch buffer kept between calls
+ USAGE
+    intn HDscratch_resize(buf, bufsize, size)
+        uint8 **buf;            IN/OUT: the buffer, NULL if none
+        uint32 *bufsize;        IN/OUT: # of bytes of the buffer
+        size_t size;            IN: # of bytes of the new buffer, 0 to only
+                                free the old one
+ RETURNS
+    SUCCEED/FAIL
+ DESCRIPTION
+    Frees the buffer and allocates one of 'size' bytes instead, without
+    keeping its contents, counting them as HDF_MEM_SCRATCH memory.  The
+    buffer is left NULL and empty if it cannot be allocated.  It comes
+    from HDlarge_alloc(), so a large one may be made of huge pages.
+--------------------------------------------------------------------------*/
+intn
+HDscratch_resize(uint8 **buf, uint32 *bufsize, size_t size)
+{
+    intn ret_value = SUCCEED;
+
+    if (*buf != NULL) {
+        HDlarge_free(*buf, *bufsize);
+        HDmem_release(HDF_MEM_SCRATCH, *bufsize);
+    }
+    *buf     = NULL;
+    *bufsize = 0;
+
+    if (size > 0) {
+        if ((*buf = (uint8 *)HDlarge_alloc(size)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        *bufsize = (uint32)size;
+        HDmem_acquire(HDF_MEM_SCRATCH, size);
+    }
+
+done:
+    return ret_value;
+} /* end HDscratch_resize() */
+
+/* Large buffers, see HDlarge_alloc(): the mapped ones are aligned to a huge
+   page, the others come from malloc() and are moved off that alignment, so
+   that HDlarge_free() can tell them apart */
+#define HDLARGE_PAGE    2097152 /* bytes of a huge page */
+#define HDLARGE_PAD     32      /* bytes before a large buffer from malloc() */
+#define HDLARGE_LEN(sz) (((sz) + HDLARGE_PAGE - 1) / HDLARGE_PAGE * HDLARGE_PAGE)
+
+#if defined(HDLARGE_MAP_SUPPORTED) && defined(MAP_HUGETLB)
+#ifdef MAP_HUGE_SHIFT
+#define HDLARGE_HUGETLB (MAP_HUGETLB | (21 << MAP_HUGE_SHIFT)) /* pages of 2 MB */
+#else
+#define HDLARGE_HUGETLB MAP_HUGETLB
+#endif
+#endif
+
+/* What the large buffers are made of, see Hsethugepages() */
+static intn HDlarge_mode = HDF_HUGEPAGES_NONE;
+
+/*--------------------------------------------------------------------------
+ NAME
+    Hsethugepages -- set what the large buffers are made of
+ USAGE
+    intn Hsethugepages(mode)
+        intn mode;              IN: HDF_HUGEPAGES_* flags
+ RETURNS
+    SUCCEED/FAIL
+ DESCRIPTION
+    Makes the library back its buffers of 2 MB and more with huge pages:
+    the pages of the chunk caches, the scratch buffers of the vdata and
+    SD interfaces, and the chunks decoded on the worker threads.  With
+    HDF_HUGEPAGES_TRANSPARENT they are mapped and aligned to a huge page,
+    and the system is asked to back them with transparent huge pages.
+    HDF_HUGEPAGES_EXPLICIT takes them from the huge pages reserved by the
+    administrator, e.g. in /proc/sys/vm/nr_hugepages, and falls back to
+    transparent ones when there are none left.  Either cuts the TLB
+    misses of the scans of large chunks.
+
+    HDF_HUGEPAGES_LOCAL, alone or with one of them, binds the buffers to
+    the NUMA node of the thread that first writes them, whatever the
+    memory policy of the process: a chunk decoded on a worker thread to
+    the node of that worker, and a page of a chunk cache to the node of
+    the thread that reads it in.
+
+    HDF_HUGEPAGES_NONE, the default, takes all buffers from malloc().
+    Buffers are freed the way they were allocated, so the mode can be
+    changed at any time, but not while another thread is in the library.
+    It fails with DFE_UNSUPPORTED where buffers cannot be mapped; where
+    they can, the system may still not give huge pages, which does not
+    make anything fail.
+--------------------------------------------------------------------------*/
+intn
+Hsethugepages(intn mode)
+{
+    intn ret_value = SUCCEED;
+
+    HEclear();
+    if ((mode & ~(HDF_HUGEPAGES_TRANSPARENT | HDF_HUGEPAGES_EXPLICIT | HDF_HUGEPAGES_LOCAL)) != 0 ||
+        ((mode & HDF_HUGEPAGES_TRANSPARENT) && (mode & HDF_HUGEPAGES_EXPLICIT)))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+#ifndef HDLARGE_MAP_SUPPORTED
+    if (mode != HDF_HUGEPAGES_NONE)
+        HGOTO_ERROR(DFE_UNSUPPORTED, FAIL);
+#endif
+
+    HDlarge_mode = mode;
+
+done:
+    return ret_value;
+} /* end Hsethugepages() */
+
+#ifdef HDLARGE_MAP_SUPPORTED
+/*--------------------------------------------------------------------------
+ NAME
+    HDlarge_map -- map a large buffer
+ USAGE
+    void *HDlarge_map(len)
+        size_t len;             IN: # of bytes, a multiple of HDLARGE_PAGE
+ RETURNS
+    The buffer, aligned to HDLARGE_PAGE, NULL if it could not be mapped.
+ DESCRIPTION
+    Maps the buffer as HDlarge_mode says.  Its pages are not touched, so
+    each one is placed when it is first written.
+--------------------------------------------------------------------------*/
+static void *
+HDlarge_map(size_t len)
+{
+    void  *addr = MAP_FAILED;
+    uint8 *base;
+    size_t head;
+
+#ifdef HDLARGE_HUGETLB
+    if (HDlarge_mode & HDF_HUGEPAGES_EXPLICIT)
+        addr = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | HDLARGE_HUGETLB, -1, 0);
+#endif
+    if (addr == MAP_FAILED) {
+        /* map a huge page more and keep the part aligned to one */
+        base = (uint8 *)mmap(NULL, len + HDLARGE_PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                             -1, 0);
+        if ((void *)base == MAP_FAILED)
+            return NULL;
+        head = (HDLARGE_PAGE - (size_t)((uintptr_t)base % HDLARGE_PAGE)) % HDLARGE_PAGE;
+        if (head > 0)
+            (void)munmap(base, head);
+        (void)munmap(base + head + len, HDLARGE_PAGE - head);
+        addr = base + head;
+#if defined(H4_HAVE_MADVISE) && defined(MADV_HUGEPAGE)
+        if (HDlarge_mode & (HDF_HUGEPAGES_TRANSPARENT | HDF_HUGEPAGES_EXPLICIT))
+            (void)madvise(addr, len, MADV_HUGEPAGE);
+#endif
+    }
+
+#ifdef HDLARGE_MBIND_SUPPORTED
+    if (HDlarge_mode & HDF_HUGEPAGES_LOCAL)
+        (void)syscall(SYS_mbind, addr, len, HDMPOL_LOCAL, NULL, 0UL, 0U);
+#endif
+
+    return addr;
+} /* end HDlarge_map() */
+#endif /* HDLARGE_MAP_SUPPORTED */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HDlarge_alloc -- allocate a buffer that may be large
+ USAGE
+    void *HDlarge_alloc(size)
+        size_t size;            IN: # of bytes to allocate
+ RETURNS
+    The buffer, aligned like one from malloc(), NULL if it could not be
+    allocated.
+ DESCRIPTION
+    Allocates a buffer to be freed with HDlarge_free() given the same
+    size.  Buffers of HDLARGE_PAGE bytes and more are mapped when
+    Hsethugepages() asked for it, the others come from malloc().
+--------------------------------------------------------------------------*/
+void *
+HDlarge_alloc(size_t size)
+{
+    uint8 *ptr;
+    uintn  pad;
+
+    if (size < HDLARGE_PAGE)
+        return malloc(size);
+
+#ifdef HDLARGE_MAP_SUPPORTED
+    if (HDlarge_mode != HDF_HUGEPAGES_NONE && (ptr = (uint8 *)HDlarge_map(HDLARGE_LEN(size))) != NULL)
+        return ptr;
+#endif
+
+    /* never aligned to a huge page */
+    if ((ptr = (uint8 *)malloc(size + HDLARGE_PAD)) == NULL)
+        return NULL;
+    pad = ((uintptr_t)(ptr + HDLARGE_PAD / 2) % HDLARGE_PAGE == 0) ? HDLARGE_PAD : HDLARGE_PAD / 2;
+    ptr += pad;
+    ptr[-1] = (uint8)pad;
+    return ptr;
+} /* end HDlarge_alloc() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HDlarge_free -- free a buffer from HDlarge_alloc
+ USAGE
+    void HDlarge_free(ptr, size)
+        void *ptr;              IN: buffer from HDlarge_alloc(), may be NULL
+        size_t size;            IN: # of bytes it was allocated with
+--------------------------------------------------------------------------*/
+void
+HDlarge_free(void *ptr, size_t size)
+{
+    if (ptr == NULL)
+        return;
+
+    if (size < HDLARGE_PAGE)
+        free(ptr);
+#ifdef HDLARGE_MAP_SUPPORTED
+    else if ((uintptr_t)ptr % HDLARGE_PAGE == 0)
+        (void)munmap(ptr, HDLARGE_LEN(size));
+#endif
+    else
+        free((uint8 *)ptr - ((uint8 *)ptr)[-1]);
+} /* end HDlarge_free() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HPregister_mem_funcs -- register the memory routines of an interface
+ USAGE
+    intn HPregister_mem_funcs(category, usage, trim)
+        hdf_mem_category_t category;    IN: kind of memory 'usage' counts
+        size_t (*usage)(void);          IN: counts the bytes held, or NULL
+        intn (*trim)(void);             IN: frees what can be freed, or NULL
+ RETURNS
+    SUCCEED/FAIL
+ DESCRIPTION
+    For the interfaces built on top of this library, like the SD one:
+    'usage' replaces the count of HDmem_acquire() for 'category' with the
+    bytes it finds by walking the memory itself, and 'trim' is called by
+    Htrim_memory().  Registering a routine twice has no effect.
+--------------------------------------------------------------------------*/
+intn
+HPregister_mem_funcs(hdf_mem_category_t category, size_t (*usage)(void), intn (*trim)(void))
+{
+    intn i;
+    intn ret_value = SUCCEED;
+
+    HEclear();
+    if (category < HDF_MEM_CHUNK_CACHE || category >= HDF_MEM_NCATEGORIES)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (usage != NULL)
+        HDmem_usage[category] = usage;
+    if (trim != NULL) {
+        for (i = 0; i < HDMEM_MAX_TRIM && HDmem_trim[i] != NULL && HDmem_trim[i] != trim; i++)
+            ;
+        if (i == HDMEM_MAX_TRIM)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        HDmem_trim[i] = trim;
+    }
+
+done:
+    return ret_value;
+} /* end HPregister_mem_funcs() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    Hget_memory_usage -- get the memory held by the library
+ USAGE
+    intn Hget_memory_usage(report)
+        hdf_memory_report_t *report;    OUT: bytes held, by category
+ RETURNS
+    SUCCEED/FAIL
+ DESCRIPTION
+    Reports the bytes the library holds now and the most it held at
+    once, in each category of hdf_mem_category_t.  The parsed netCDF
+    metadata are counted by walking the open SD files, so their peak is
+    the largest count reported so far.  Only the memory the library keeps
+    between calls is counted, not the application's buffers nor what a
+    call allocates and frees before it returns.
+--------------------------------------------------------------------------*/
+intn
+Hget_memory_usage(hdf_memory_report_t *report)
+{
+    intn i;
+    intn ret_value = SUCCEED;
+
+    HEclear();
+    if (report == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    for (i = 0; i < HDF_MEM_NCATEGORIES; i++)
+        if (HDmem_usage[i] != NULL) {
+            HL_LOCK_LIBRARY();
+            HDmem_current[i] = (*HDmem_usage[i])();
+            if (HDmem_current[i] > HDmem_peak[i])
+                HDmem_peak[i] = HDmem_current[i];
+            HL_UNLOCK_LIBRARY();
+        }
+
+    HL_LOCK_LIBRARY();
+    memcpy(report->current, HDmem_current, sizeof(HDmem_current));
+    memcpy(report->peak, HDmem_peak, sizeof(HDmem_peak));
+    HL_UNLOCK_LIBRARY();
+
+done:
+    return ret_value;
+} /* end Hget_memory_usage() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    Htrim_memory -- free the memory the library keeps for reuse
+ USAGE
+    intn Htrim_memory()
+ RETURNS
+    SUCCEED/FAIL
+ DESCRIPTION
+    Frees the free lists of access records and of tree, vgroup and vdata
+    nodes, the scratch buffers of the V and SD interfaces (those of the
+    calling thread for SD), and closes the files kept open after Hclose()
+    for a quick reopen.  All of them are allocated again as needed.
+
+    The chunk caches are not trimmed, their pages belong to open
+    elements: bound them with HMCsetCacheBudget() instead.  Must not be
+    called while another thread is in the library.
+--------------------------------------------------------------------------*/
+intn
+Htrim_memory(void)
+{
+    intn i;
+    intn ret_value = SUCCEED;
+
+    HEclear();
+    if (VSPshutdown() == FAIL || VPtrim() == FAIL || Hshutdown() == FAIL || tbbt_shutdown() == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    for (i = 0; i < HDMEM_MAX_TRIM && HDmem_trim[i] != NULL; i++)
+        if ((*HDmem_trim[i])() == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+done:
+    return ret_value;
+} /* end Htrim_memory() */
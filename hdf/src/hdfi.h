@@ -109,6 +109,11 @@
 #include <process.h>
 #endif
 
+/* MPI, for the "mpio" file driver, see Hsetmpio() */
+#ifdef H4_HAVE_PARALLEL
+#include <mpi.h>
+#endif
+
 /*-------------------------------------------------------------------------
  * Pre-C99 platform-independent type scheme
  *
@@ -24,6 +24,8 @@ EXPORTED ROUTINES
   HEreport -- give a more detailed error description
   HEprint  -- print values from the error stack
   HEvalue  -- return a error off of the error stack
+  HEset_mode -- choose between the full error stack and the last error code
+  HEget_mode -- return the error mode of the calling thread
  */
 
 #include "hdf.h"
@@ -33,9 +35,6 @@ EXPORTED ROUTINES
  */
 #include <stdarg.h>
 
-/* always points to the next available slot; the last error record is in slot (top-1) */
-static int32 error_top = 0;
-
 /* We use a stack to hold the errors plus we keep track of the function,
    file and line where the error occurs. */
 
@@ -237,9 +236,41 @@ static const struct error_messages_t error_messages[] = {
 
 };
 
+#ifdef H4_HAVE_THREADSAFE
+#include <pthread.h>
+
+/* Each thread has an error stack of its own */
+typedef struct error_state_t {
+    int32          top;   /* next available slot of the stack */
+    error_t       *stack; /* the stack, allocated by HEpush */
+    intn           mode;  /* HE_MODE_FULL or HE_MODE_CODE */
+    hdf_err_code_t last;  /* the last error pushed, in HE_MODE_CODE */
+} error_state_t;
+
+static pthread_once_t error_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t  error_key;
+
+static error_state_t *HEIget_state(void);
+
+/* the error_top and error_stack of the calling thread */
+#define error_top   (HEIget_state()->top)
+#define error_stack (HEIget_state()->stack)
+#define error_mode  (HEIget_state()->mode)
+#define error_last  (HEIget_state()->last)
+#else
+/* always points to the next available slot; the last error record is in slot (top-1) */
+static int32 error_top = 0;
+
 /* pointer to the structure to hold error messages */
 static error_t *error_stack = NULL;
 
+/* HE_MODE_FULL or HE_MODE_CODE */
+static intn error_mode = HE_DEFAULT_MODE;
+
+/* the last error pushed, in HE_MODE_CODE */
+static hdf_err_code_t error_last = DFE_NONE;
+#endif /* H4_HAVE_THREADSAFE */
+
 #ifndef DEFAULT_MESG
 #define DEFAULT_MESG "Unknown error"
 #endif
@@ -247,6 +278,52 @@ static error_t *error_stack = NULL;
 /* size of error message table */
 #define ERRMESG_SZ (sizeof(error_messages) / sizeof(error_messages[0]))
 
+#ifdef H4_HAVE_THREADSAFE
+/* Frees the error stack of a thread when the thread exits */
+static void
+HEIfree_state(void *arg)
+{
+    error_state_t *state = (error_state_t *)arg;
+    int32          i;
+
+    if (state->stack != NULL)
+        for (i = 0; i < ERR_STACK_SZ; i++)
+            free(state->stack[i].desc);
+    free(state->stack);
+    free(state);
+} /* HEIfree_state */
+
+/* Creates the key of the per-thread error stacks, called once */
+static void
+HEIcreate_key(void)
+{
+    if (pthread_key_create(&error_key, HEIfree_state) != 0) {
+        puts("HEpush cannot create the error stack key.  Unable to continue!!");
+        exit(8);
+    }
+} /* HEIcreate_key */
+
+/* Returns the error state of the calling thread */
+static error_state_t *
+HEIget_state(void)
+{
+    error_state_t *state;
+
+    pthread_once(&error_key_once, HEIcreate_key);
+    if ((state = (error_state_t *)pthread_getspecific(error_key)) == NULL) {
+        state = (error_state_t *)calloc(1, sizeof(error_state_t));
+        if (state == NULL || pthread_setspecific(error_key, state) != 0) {
+            puts("HEpush cannot allocate space.  Unable to continue!!");
+            exit(8);
+        }
+        state->mode = HE_DEFAULT_MODE;
+        state->last = DFE_NONE;
+    }
+
+    return state;
+} /* HEIget_state */
+#endif /* H4_HAVE_THREADSAFE */
+
 /*------------------------------------------------------------------------
 NAME
    HEstring -- return error description
@@ -291,6 +368,11 @@ DESCRIPTION
 void
 HEclear(void)
 {
+    if (error_mode == HE_MODE_CODE) {
+        error_last = DFE_NONE;
+        goto done;
+    }
+
     if (!error_top)
         goto done;
 
@@ -322,7 +404,9 @@ DESCRIPTION
    (function_name and file_name) referred are in some
    semi-permanent storage, so it just saves the pointer
    to the strings.  blank out the description field so
-   that a description is reported  only if REreport is called
+   that a description is reported  only if REreport is called.
+   In HE_MODE_CODE only the error code is kept, replacing the one
+   pushed before it.
 
 ---------------------------------------------------------------------------*/
 void
@@ -330,6 +414,11 @@ HEpush(hdf_err_code_t error_code, const char *function_name, const char *file_na
 {
     intn i;
 
+    if (error_mode == HE_MODE_CODE) {
+        error_last = error_code;
+        return;
+    }
+
     /* if the stack is not allocated, then do it */
     if (!error_stack) {
         error_stack = (error_t *)malloc((uint32)sizeof(error_t) * ERR_STACK_SZ);
@@ -366,7 +455,7 @@ RETURNS
 DESCRIPTION
    Using printf and the variable number of args facility allow the
    library to specify a more detailed description of a given
-   error condition
+   error condition.  Descriptions are dropped in HE_MODE_CODE.
 
 ---------------------------------------------------------------------------*/
 void
@@ -375,6 +464,9 @@ HEreport(const char *format, ...)
     va_list arg_ptr;
     char   *tmp;
 
+    if (error_mode == HE_MODE_CODE)
+        return;
+
     va_start(arg_ptr, format);
 
     if ((error_top < ERR_STACK_SZ + 1) && (error_top > 0)) {
@@ -406,12 +498,19 @@ RETURNS
 DESCRIPTION
    Print part of the error stack to a given file.  If level == 0
    the entire stack is printed.  If an extra description has been
-   added (via HEreport) it is printed too.
+   added (via HEreport) it is printed too.  In HE_MODE_CODE only the
+   last error code is printed.
 
 ---------------------------------------------------------------------------*/
 void
 HEprint(FILE *stream, int32 print_levels)
 {
+    if (error_mode == HE_MODE_CODE) {
+        if (error_last != DFE_NONE)
+            fprintf(stream, "HDF error: (%d) <%s>\n", error_last, HEstring(error_last));
+        return;
+    }
+
     if (print_levels == 0 || print_levels > error_top) /* print all errors */
         print_levels = error_top;
 
@@ -437,7 +536,8 @@ HEprint(FILE *stream, int32 print_levels)
    RETURNS
    Error code or DFE_NONE if no error
    DESCRIPTION
-   Return the error code of a single error out of the error stack
+   Return the error code of a single error out of the error stack.
+   In HE_MODE_CODE only level 1, the last error, is kept.
 
    --------------------------------------------------------------------------- */
 int16
@@ -445,7 +545,9 @@ HEvalue(int32 level)
 {
     int16 ret_value = DFE_NONE;
 
-    if (level > 0 && level <= error_top)
+    if (error_mode == HE_MODE_CODE)
+        ret_value = (int16)(level == 1 ? error_last : DFE_NONE);
+    else if (level > 0 && level <= error_top)
         ret_value = (int16)error_stack[error_top - level].error_code;
     else
         ret_value = DFE_NONE;
@@ -453,6 +555,56 @@ HEvalue(int32 level)
     return ret_value;
 } /* HEvalue */
 
+/*--------------------------------------------------------------------------
+ NAME
+    HEset_mode -- choose between the full error stack and the last error code
+ USAGE
+    intn HEset_mode(mode)
+    intn mode;          IN: HE_MODE_FULL or HE_MODE_CODE
+ RETURNS
+    SUCCEED/FAIL
+ DESCRIPTION
+    In HE_MODE_FULL, the default, each error is pushed onto the error
+    stack with the function, file and line it was detected in, and
+    descriptions given to HEreport are kept.  In HE_MODE_CODE only the
+    code of the last error is kept and nothing is copied or allocated,
+    which takes the error handling off the cost of the library calls of
+    programs making many small reads.  HEvalue(1) and HEprint still give
+    the last error.
+
+    The mode is that of the calling thread in the thread-safe library,
+    where each thread has errors of its own, and of the program otherwise.
+    Building with HE_DEFAULT_MODE defined to HE_MODE_CODE changes the
+    default.  The errors reported so far are cleared.
+--------------------------------------------------------------------------*/
+intn
+HEset_mode(intn mode)
+{
+    if (mode != HE_MODE_FULL && mode != HE_MODE_CODE) {
+        HERROR(DFE_ARGS);
+        return FAIL;
+    }
+
+    HEclear();
+    error_mode = mode;
+
+    return SUCCEED;
+} /* HEset_mode */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HEget_mode -- return the error mode of the calling thread
+ USAGE
+    intn HEget_mode()
+ RETURNS
+    HE_MODE_FULL or HE_MODE_CODE, see HEset_mode
+--------------------------------------------------------------------------*/
+intn
+HEget_mode(void)
+{
+    return error_mode;
+} /* HEget_mode */
+
 /*--------------------------------------------------------------------------
  NAME
     HEshutdown
@@ -478,5 +630,6 @@ HEshutdown(void)
         error_stack = NULL;
         error_top   = 0;
     }
+    error_last = DFE_NONE;
     return SUCCEED;
 } /* end HEshutdown() */
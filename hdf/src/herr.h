@@ -19,6 +19,10 @@
 #ifndef H4_HERR_H
 #define H4_HERR_H
 
+/* Error modes, see HEset_mode */
+#define HE_MODE_FULL 0 /* keep a stack of errors, with where they happened */
+#define HE_MODE_CODE 1 /* keep the code of the last error only */
+
 /* HERROR macro, used to facilitate error reporting */
 #define HERROR(e) HEpush(e, __func__, __FILE__, __LINE__)
 
@@ -53,6 +53,14 @@
  LOCAL ROUTINES
    HXIstaccess      -- set up AID to access an ext elem
    HXIbuildfilename -- Build the Filename for the External Element
+   HXIopen_file     -- get an external file from the cache, opening it if needed
+   HXIrelease_file  -- give back an external file to the cache
+   HXIread_file     -- read from an external file
+   HXIwrite_file    -- write to an external file
+   HXIprune_files   -- close the unused external files beyond the limit
+   HXIfind_file     -- look up an external file in the cache
+   HXIdrop_file     -- drop an external file from the cache
+   HXIreopen_file   -- make an external file writable
 
  EXPORTED BUT LIBRARY PRIVATE ROUTINES
    HXPcloseAID      -- close file but keep AID active
@@ -71,6 +79,7 @@ EXPORTED ROUTINES
    HXcreate         -- create an external element
    HXsetcreatedir   -- set the directory variable for creating external file
    HXsetdir         -- set the directory variable for locating external file
+   HXsetfilecache   -- set the # of unused external files kept open
 
 ------------------------------------------------------------------------- */
 
@@ -99,6 +108,33 @@ static char *HDFEXTCREATEDIR = NULL;
 static char *extdir          = NULL;
 static char *HDFEXTDIR       = NULL;
 static intn  extdir_changed  = FALSE;
+static uint32 extdir_gen     = 0; /* bumped whenever extdir changes */
+
+/* extfile_t -- an external file kept open, shared by all the external
+   elements in that file, see HXIopen_file() */
+
+typedef struct extfile_t {
+    char             *name;     /* name the file was last found by, NULL if
+                                   only ever created */
+    uint32            name_gen; /* extdir_gen when it was looked up */
+    char             *path;     /* path the file was opened at */
+    hdf_file_t        file;     /* external file descriptor */
+    intn              writable; /* opened for writing? */
+    intn              nusers;   /* # of external elements using it */
+    intn              gone;     /* its path now leads elsewhere, see HXIfind_file */
+    struct extfile_t *prev;     /* previous file, more recently used */
+    struct extfile_t *next;     /* next file, less recently used */
+} extfile_t;
+
+/* # of unused external files kept open by default, see HXsetfilecache() */
+#define EXT_CACHE_FILES 16
+
+/* The external files open, most recently used first, the # of those that
+   are unused and the # of those kept open.  All protected by the library
+   lock, which is also held during I/O on the files, as they are shared */
+static extfile_t *extfiles      = NULL;
+static intn       extfile_nidle = 0;
+static intn       extfile_max   = EXT_CACHE_FILES;
 
 /* extinfo_t -- external elt information structure */
 
@@ -109,7 +145,7 @@ typedef struct {
     int32      length;           /* length of this element */
     int32      length_file_name; /* length of the external file name */
     int32      para_extfile_id;  /* parallel ID of the external file */
-    hdf_file_t file_external;    /* external file descriptor */
+    extfile_t *file_external;    /* external file, from the cache */
     char      *extern_file_name; /* name of the external file */
     intn       file_open;        /* has the file been opened yet ? */
 } extinfo_t;
@@ -117,6 +153,14 @@ typedef struct {
 /* forward declaration of the functions provided in this module */
 static int32 HXIstaccess(accrec_t *access_rec, int16 access);
 static char *HXIbuildfilename(const char *ext_fname, const intn acc_mode);
+static extfile_t *HXIopen_file(const char *ext_fname, intn lookup, intn acc_mode);
+static void       HXIrelease_file(extfile_t *ext_file);
+static hdf_err_code_t HXIread_file(extfile_t *ext_file, int32 offset, void *buf, int32 length);
+static hdf_err_code_t HXIwrite_file(extfile_t *ext_file, int32 offset, const void *buf, int32 length);
+static void       HXIprune_files(void);
+static extfile_t *HXIfind_file(const char *key, intn by_name);
+static void       HXIdrop_file(extfile_t *ext_file);
+static intn       HXIreopen_file(extfile_t *ext_file);
 
 /* ext_funcs -- table of the accessing functions of the external
    data element function modules.  The position of each function in
@@ -178,20 +222,23 @@ int32
 HXcreate(int32 file_id, uint16 tag, uint16 ref, const char *extern_file_name, int32 offset, int32 start_len)
 {
     filerec_t *file_rec;                       /* file record */
+    filerec_t *locked     = NULL;              /* file record locked by this call */
     accrec_t  *access_rec = NULL;              /* access element record */
     int32      dd_aid;                         /* AID for writing the special info */
-    hdf_file_t file_external;                  /* external file descriptor */
-    extinfo_t *info    = NULL;                 /* special element information */
+    extfile_t *file_external = NULL;           /* external file */
+    extinfo_t *info          = NULL;           /* special element information */
     atom_t     data_id = FAIL;                 /* dd ID of existing regular element */
     int32      data_len;                       /* length of the data we are checking */
     uint16     special_tag;                    /* special version of tag */
     uint8      local_ptbuf[20 + MAX_PATH_LEN]; /* temp working buffer */
-    char      *fname     = NULL;               /* filename built from external filename */
     void      *buf       = NULL;               /* temporary buffer */
+    hdf_err_code_t err;                        /* error of the external file I/O */
     int32      ret_value = SUCCEED;
 
     /* clear error stack and validate args */
     HEclear();
+    locked = HL_LOCK_FID(file_id);
+
     file_rec = HAatom_object(file_id);
     if (BADFREC(file_rec) || !extern_file_name || (offset < 0) || SPECIALTAG(tag) ||
         (special_tag = MKSPECIALTAG(tag)) == DFTAG_NULL)
@@ -251,19 +298,9 @@ HXcreate(int32 file_id, uint16 tag, uint16 ref, const char *extern_file_name, in
         }
     } /* end if */
 
-    /* build the customized external file name. */
-    if (!(fname = HXIbuildfilename(extern_file_name, DFACC_CREATE)))
+    /* Open the external file with write access, creating it if needed */
+    if ((file_external = HXIopen_file(extern_file_name, DFACC_CREATE, DFACC_CREATE)) == NULL)
         HGOTO_ERROR(DFE_BADOPEN, FAIL);
-
-    /* Try to open the external file with write access first, if that fails,
-       create it */
-    file_external = (hdf_file_t)HI_OPEN(fname, DFACC_WRITE);
-    if (OPENERR(file_external)) {
-        file_external = (hdf_file_t)HI_CREATE(fname);
-        if (OPENERR(file_external))
-            HGOTO_ERROR(DFE_BADOPEN, FAIL);
-    }
-    free(fname);
     extdir_changed = FALSE; /* set to TRUE when HXsetdir is called */
 
     /* Get a bare access record and special info structure */
@@ -286,10 +323,8 @@ HXcreate(int32 file_id, uint16 tag, uint16 ref, const char *extern_file_name, in
             HGOTO_ERROR(DFE_NOSPACE, FAIL);
         if (Hgetelement(file_id, tag, ref, buf) == FAIL)
             HGOTO_ERROR(DFE_READERROR, FAIL);
-        if (HI_SEEK(file_external, offset) == FAIL)
-            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
-        if (HI_WRITE(file_external, buf, (int)data_len) == FAIL)
-            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        if ((err = HXIwrite_file(file_external, offset, buf, data_len)) != DFE_NONE)
+            HGOTO_ERROR(err, FAIL);
         info->length = data_len;
     }
     else
@@ -354,13 +389,15 @@ done:
 
             access_rec->special_info = NULL;
         }
-        free(fname);
+        if (file_external != NULL)
+            HXIrelease_file(file_external);
         if (data_id != FAIL)
             HTPendaccess(data_id);
     }
 
     free(buf);
 
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* HXcreate */
 
@@ -379,9 +416,8 @@ DESCRIPTION
 intn
 HXPsetaccesstype(accrec_t *access_rec)
 {
-    hdf_file_t file_external; /* external file descriptor */
+    extfile_t *file_external; /* external file */
     extinfo_t *info;          /* special element information */
-    char      *fname     = NULL;
     intn       ret_value = SUCCEED;
 
     /* clear error stack and validate args */
@@ -394,21 +430,15 @@ HXPsetaccesstype(accrec_t *access_rec)
     if ((info = (extinfo_t *)access_rec->special_info) == NULL)
         HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
-    /* build the customized external file name. */
-    if ((fname = HXIbuildfilename(info->extern_file_name, DFACC_OLD)) == NULL)
-        HGOTO_ERROR(DFE_BADOPEN, FAIL);
-
     /* Open the external file for the correct access type */
     switch (access_rec->access_type) {
         case DFACC_SERIAL:
-            file_external = (hdf_file_t)HI_OPEN(fname, DFACC_WRITE);
-            if (OPENERR(file_external)) {
-                file_external = (hdf_file_t)HI_CREATE(fname);
-                if (OPENERR(file_external))
-                    HGOTO_ERROR(DFE_BADOPEN, FAIL);
-            }
-            free(fname);
+            if ((file_external = HXIopen_file(info->extern_file_name, DFACC_OLD, DFACC_CREATE)) == NULL)
+                HGOTO_ERROR(DFE_BADOPEN, FAIL);
+            if (info->file_open)
+                HXIrelease_file(info->file_external);
             info->file_external = file_external;
+            info->file_open     = TRUE;
             extdir_changed      = FALSE; /* set to TRUE when HXsetdir is called again */
             break;
 
@@ -417,10 +447,6 @@ HXPsetaccesstype(accrec_t *access_rec)
     }
 
 done:
-    if (ret_value == FAIL) { /* Error condition cleanup */
-        free(fname);
-    }
-
     return ret_value;
 }
 
@@ -627,7 +653,8 @@ HXPread(accrec_t *access_rec, int32 length, void *data)
 {
     extinfo_t *info = /* information on the special element */
         (extinfo_t *)access_rec->special_info;
-    int32 ret_value = SUCCEED;
+    hdf_err_code_t err; /* error of the external file I/O */
+    int32          ret_value = SUCCEED;
 
     /* validate length */
     if (length < 0)
@@ -640,23 +667,16 @@ HXPread(accrec_t *access_rec, int32 length, void *data)
         HGOTO_ERROR(DFE_RANGE, FAIL);
 
     /* if the file is open but external directory is changed (by HXsetdir),
-       then close the file first before making the new file path */
+       then give it back first before looking up the new file path */
     if (!info->file_open || (info->file_open && extdir_changed)) {
-        char *fname;
-
-        /* if the file is open, close it first */
+        /* if the file is open, give it back first */
         if (info->file_open) {
-            HI_CLOSE(info->file_external);
+            HXIrelease_file(info->file_external);
             info->file_open = FALSE;
         }
 
-        /* build the customized external file name. */
-        if ((fname = HXIbuildfilename(info->extern_file_name, DFACC_OLD)) == NULL)
-            HGOTO_ERROR(DFE_BADOPEN, FAIL);
-
-        info->file_external = (hdf_file_t)HI_OPEN(fname, access_rec->access);
-        free(fname);
-        if (OPENERR(info->file_external)) {
+        info->file_external = HXIopen_file(info->extern_file_name, DFACC_OLD, (intn)access_rec->access);
+        if (info->file_external == NULL) {
             HERROR(DFE_BADOPEN);
             HEreport("Could not find external file %s\n", info->extern_file_name);
             HGOTO_DONE(FAIL);
@@ -666,12 +686,9 @@ HXPread(accrec_t *access_rec, int32 length, void *data)
     }
 
     /* read it in from the file */
-    {
-        if (HI_SEEK(info->file_external, access_rec->posn + info->extern_offset) == FAIL)
-            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
-        if (HI_READ(info->file_external, data, length) == FAIL)
-            HGOTO_ERROR(DFE_READERROR, FAIL);
-    }
+    if ((err = HXIread_file(info->file_external, access_rec->posn + info->extern_offset, data, length)) !=
+        DFE_NONE)
+        HGOTO_ERROR(err, FAIL);
 
     /* adjust access position */
     access_rec->posn += length;
@@ -706,9 +723,10 @@ HXPwrite(accrec_t *access_rec, int32 length, const void *data)
     uint8      local_ptbuf[4]; /* temp buffer */
     extinfo_t *info =          /* information on the special element */
         (extinfo_t *)(access_rec->special_info);
-    uint8     *p = local_ptbuf; /* temp buffer ptr */
-    filerec_t *file_rec;        /* file record */
-    int32      ret_value = SUCCEED;
+    uint8         *p = local_ptbuf; /* temp buffer ptr */
+    filerec_t     *file_rec;        /* file record */
+    hdf_err_code_t err;             /* error of the external file I/O */
+    int32          ret_value = SUCCEED;
 
     /* convert file id to file record */
     file_rec = HAatom_object(access_rec->file_id);
@@ -718,23 +736,16 @@ HXPwrite(accrec_t *access_rec, int32 length, const void *data)
         HGOTO_ERROR(DFE_RANGE, FAIL);
 
     /* if the file is open but external directory is changed (by HXsetdir),
-       then close the file first before making the new file path */
+       then give it back first before looking up the new file path */
     if (!info->file_open || (info->file_open && extdir_changed)) {
-        char *fname;
-
-        /* if the file is open, close it first */
+        /* if the file is open, give it back first */
         if (info->file_open) {
-            HI_CLOSE(info->file_external);
+            HXIrelease_file(info->file_external);
             info->file_open = FALSE;
         }
 
-        /* build the customized external file name. */
-        if ((fname = HXIbuildfilename(info->extern_file_name, DFACC_OLD)) == NULL)
-            HGOTO_ERROR(DFE_BADOPEN, FAIL);
-
-        info->file_external = (hdf_file_t)HI_OPEN(fname, access_rec->access);
-        free(fname);
-        if (OPENERR(info->file_external)) {
+        info->file_external = HXIopen_file(info->extern_file_name, DFACC_OLD, (intn)access_rec->access);
+        if (info->file_external == NULL) {
             HERROR(DFE_BADOPEN);
             HEreport("Could not find external file %s\n", info->extern_file_name);
             HGOTO_DONE(FAIL);
@@ -743,26 +754,11 @@ HXPwrite(accrec_t *access_rec, int32 length, const void *data)
         extdir_changed  = FALSE; /* set to TRUE when HXsetdir is called again */
     }
 
-    /* write the data onto file */
-    {
-        if (HI_SEEK(info->file_external, access_rec->posn + info->extern_offset) == FAIL)
-            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
-        if (HI_WRITE(info->file_external, data, length) == FAIL) {
-            /* this external file might not be opened with write permission,
-               reopen the file and try again */
-            hdf_file_t f = (hdf_file_t)HI_OPEN(info->extern_file_name, DFACC_WRITE);
-
-            if (OPENERR(f) || HI_SEEK(f, access_rec->posn + info->extern_offset) == FAIL ||
-                HI_WRITE(f, data, length) == FAIL) {
-                HI_CLOSE(f);
-                HGOTO_ERROR(DFE_DENIED, FAIL);
-            }
-            HI_CLOSE(info->file_external);
-
-            /* if okay, substitute the file descriptor */
-            info->file_external = f;
-        }
-    }
+    /* write the data onto file; the external file might have been opened
+       without write permission, in which case it is reopened with it */
+    if ((err = HXIwrite_file(info->file_external, access_rec->posn + info->extern_offset, data, length)) !=
+        DFE_NONE)
+        HGOTO_ERROR(err, FAIL);
 
     /* update access record, and information about special elelemt */
     access_rec->posn += length;
@@ -926,7 +922,7 @@ HXPcloseAID(accrec_t *access_rec)
 
     if (--(info->attached) == 0) {
         if (info->file_open)
-            HI_CLOSE(info->file_external);
+            HXIrelease_file(info->file_external);
         free(info->extern_file_name);
         free(info);
         access_rec->special_info = NULL;
@@ -1018,7 +1014,12 @@ HXPreset(accrec_t *access_rec, sp_info_block_t *info_block)
     if (BADFREC(file_rec))
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
-    /* update our internal pointers */
+    /* update our internal pointers; the file of the new name is opened
+       when next needed */
+    if (info->file_open) {
+        HXIrelease_file(info->file_external);
+        info->file_open = FALSE;
+    }
     info->extern_offset = info_block->offset;
     free(info->extern_file_name);
     info->extern_file_name = (char *)strdup(info_block->path);
@@ -1134,6 +1135,7 @@ HXsetdir(const char *newdir)
             free(extdir);
             extdir         = NULL;
             extdir_changed = TRUE;
+            extdir_gen++;
         }
     }
     else {
@@ -1147,11 +1149,13 @@ HXsetdir(const char *newdir)
                 free(extdir);
                 extdir         = pt;
                 extdir_changed = TRUE;
+                extdir_gen++;
             }
         }
         else {
             extdir         = pt;
             extdir_changed = TRUE;
+            extdir_gen++;
         }
     }
 
@@ -1159,6 +1163,38 @@ done:
     return ret_value;
 } /* HXsetdir */
 
+/*------------------------------------------------------------------------
+NAME
+   HXsetfilecache -- set the # of unused external files kept open
+USAGE
+   intn HXsetfilecache(nfiles)
+   intn nfiles		IN: # of files, 0 to close them once unused
+RETURNS
+   SUCCEED if no error, else FAIL
+DESCRIPTION
+   External files are kept open while their elements are accessed, and
+   shared by all the elements in them.  Once no element uses a file, it
+   stays open for the next access, up to nfiles such files, after which
+   the least recently used ones are closed.  The default is 16.
+
+--------------------------------------------------------------------------*/
+intn
+HXsetfilecache(intn nfiles)
+{
+    intn ret_value = SUCCEED;
+
+    if (nfiles < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    HL_LOCK_LIBRARY();
+    extfile_max = nfiles;
+    HXIprune_files();
+    HL_UNLOCK_LIBRARY();
+
+done:
+    return ret_value;
+} /* HXsetfilecache */
+
 /* ------------------------------- HXIbuildfilename ------------------------------- */
 /*
 NAME
@@ -1352,6 +1388,340 @@ done:
     return ret_value;
 } /* HXIbuildfilename */
 
+/* ------------------------------- HXIopen_file ------------------------------- */
+/*
+NAME
+   HXIopen_file -- get an external file from the cache, opening it if needed
+USAGE
+   extfile_t *HXIopen_file(ext_fname, lookup, acc_mode)
+   const char *ext_fname;    IN: name of the external file
+   intn        lookup;       IN: DFACC_OLD or DFACC_CREATE, see HXIbuildfilename
+   intn        acc_mode;     IN: DFACC_READ, DFACC_WRITE, or DFACC_CREATE to
+                                 open for writing, creating the file if needed
+RETURNS
+   The external file, NULL on error
+DESCRIPTION
+   The external files are kept open in a cache, shared by all the external
+   elements in them, so that reading many elements of one external file
+   does not open the file and search the external directories each time.
+   A file is looked up by the name it was last found by in the external
+   directories, as long as they have not changed, else by the path the name
+   leads to, and is checked to be still there.  A file opened read-only is
+   reopened for writing in place when write access is asked for.  The file must be given back with
+   HXIrelease_file().
+
+---------------------------------------------------------------------------*/
+static extfile_t *
+HXIopen_file(const char *ext_fname, intn lookup, intn acc_mode)
+{
+    extfile_t *ext_file  = NULL;
+    char      *fname     = NULL;
+    intn       write     = (acc_mode & (DFACC_WRITE | DFACC_CREATE)) != 0;
+    extfile_t *ret_value = NULL;
+
+    HL_LOCK_LIBRARY();
+
+    /* look the name up first, saving the search of the directories */
+    if (lookup == DFACC_OLD)
+        ext_file = HXIfind_file(ext_fname, TRUE);
+
+    if (lookup != DFACC_OLD || ext_file == NULL) {
+        char *name = NULL;
+
+        if ((fname = HXIbuildfilename(ext_fname, lookup)) == NULL)
+            HGOTO_ERROR(DFE_BADOPEN, NULL);
+        if (lookup == DFACC_OLD && (name = strdup(ext_fname)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, NULL);
+
+        if ((ext_file = HXIfind_file(fname, FALSE)) == NULL) {
+            hdf_file_t f;
+
+            f = (hdf_file_t)HI_OPEN(fname, write ? DFACC_WRITE : DFACC_READ);
+            if (OPENERR(f) && acc_mode == DFACC_CREATE)
+                f = (hdf_file_t)HI_CREATE(fname);
+            if (OPENERR(f)) {
+                free(name);
+                HGOTO_ERROR(DFE_BADOPEN, NULL);
+            }
+            if ((ext_file = (extfile_t *)calloc(1, sizeof(extfile_t))) == NULL) {
+                HI_CLOSE(f);
+                free(name);
+                HGOTO_ERROR(DFE_NOSPACE, NULL);
+            }
+            ext_file->path     = fname;
+            ext_file->file     = f;
+            ext_file->writable = write;
+            fname              = NULL;
+
+            /* the file is added unused, at the front of the list */
+            if ((ext_file->next = extfiles) != NULL)
+                extfiles->prev = ext_file;
+            extfiles = ext_file;
+            extfile_nidle++;
+        }
+        if (name != NULL) {
+            free(ext_file->name);
+            ext_file->name     = name;
+            ext_file->name_gen = extdir_gen;
+        }
+    }
+
+    if (write && HXIreopen_file(ext_file) == FAIL)
+        HGOTO_ERROR(DFE_DENIED, NULL);
+
+    /* move the file to the front of the list */
+    if (ext_file != extfiles) {
+        ext_file->prev->next = ext_file->next;
+        if (ext_file->next != NULL)
+            ext_file->next->prev = ext_file->prev;
+        ext_file->prev = NULL;
+        ext_file->next = extfiles;
+        extfiles->prev = ext_file;
+        extfiles       = ext_file;
+    }
+    if (ext_file->nusers++ == 0)
+        extfile_nidle--;
+    ret_value = ext_file;
+
+done:
+    free(fname);
+    HL_UNLOCK_LIBRARY();
+    return ret_value;
+} /* HXIopen_file */
+
+/* ------------------------------ HXIrelease_file ------------------------------ */
+/*
+NAME
+   HXIrelease_file -- give back an external file to the cache
+USAGE
+   void HXIrelease_file(ext_file)
+   extfile_t *ext_file;      IN: external file from HXIopen_file()
+DESCRIPTION
+   A file no longer used by any external element is flushed, and kept
+   open unless there are more such files than HXsetfilecache() allows.
+
+---------------------------------------------------------------------------*/
+static void
+HXIrelease_file(extfile_t *ext_file)
+{
+    HL_LOCK_LIBRARY();
+    if (--ext_file->nusers == 0) {
+        if (ext_file->writable)
+            HI_FLUSH(ext_file->file);
+        extfile_nidle++;
+        if (ext_file->gone)
+            HXIdrop_file(ext_file);
+        HXIprune_files();
+    }
+    HL_UNLOCK_LIBRARY();
+} /* HXIrelease_file */
+
+/* ------------------------------ HXIprune_files ------------------------------- */
+/*
+NAME
+   HXIprune_files -- close the unused external files beyond the limit
+USAGE
+   void HXIprune_files()
+DESCRIPTION
+   Closes the least recently used of the unused external files until no
+   more than extfile_max are left.  Called with the library lock held.
+
+---------------------------------------------------------------------------*/
+static void
+HXIprune_files(void)
+{
+    extfile_t *ext_file, *prev;
+
+    for (ext_file = extfiles; ext_file != NULL && ext_file->next != NULL; ext_file = ext_file->next)
+        ;
+    for (; ext_file != NULL && extfile_nidle > extfile_max; ext_file = prev) {
+        prev = ext_file->prev;
+        if (ext_file->nusers == 0)
+            HXIdrop_file(ext_file);
+    }
+} /* HXIprune_files */
+
+/* ------------------------------- HXIfind_file -------------------------------- */
+/*
+NAME
+   HXIfind_file -- look up an external file in the cache
+USAGE
+   extfile_t *HXIfind_file(key, by_name)
+   const char *key;          IN: name or path of the file
+   intn        by_name;      IN: TRUE to look up the name the file was found by
+RETURNS
+   The external file, NULL if it is not in the cache
+DESCRIPTION
+   A file whose path no longer leads to it, because it was removed or
+   replaced, is dropped from the cache.  Called with the library lock held.
+
+---------------------------------------------------------------------------*/
+static extfile_t *
+HXIfind_file(const char *key, intn by_name)
+{
+    extfile_t  *ext_file;
+    struct stat path_stat;
+
+    for (ext_file = extfiles; ext_file != NULL; ext_file = ext_file->next) {
+        if (ext_file->gone)
+            continue;
+        if (by_name ? (ext_file->name != NULL && ext_file->name_gen == extdir_gen &&
+                       strcmp(ext_file->name, key) == 0)
+                    : strcmp(ext_file->path, key) == 0)
+            break;
+    }
+    if (ext_file == NULL)
+        return NULL;
+
+    if (stat(ext_file->path, &path_stat) == 0) {
+#ifdef H4_HAVE_WIN32_API
+        /* open files cannot be removed */
+        return ext_file;
+#else
+        struct stat file_stat;
+
+        if (fstat(HI_FILENO(ext_file->file), &file_stat) == 0 && file_stat.st_dev == path_stat.st_dev &&
+            file_stat.st_ino == path_stat.st_ino)
+            return ext_file;
+#endif
+    }
+    HXIdrop_file(ext_file);
+    return NULL;
+} /* HXIfind_file */
+
+/* ------------------------------- HXIdrop_file -------------------------------- */
+/*
+NAME
+   HXIdrop_file -- drop an external file from the cache
+USAGE
+   void HXIdrop_file(ext_file)
+   extfile_t *ext_file;      IN: external file to drop
+DESCRIPTION
+   Closes the file if it is unused, else only marks it as gone, so that it
+   is no longer looked up, and leaves it to be closed once unused.  Called
+   with the library lock held.
+
+---------------------------------------------------------------------------*/
+static void
+HXIdrop_file(extfile_t *ext_file)
+{
+    if (ext_file->nusers > 0) {
+        ext_file->gone = TRUE;
+        return;
+    }
+
+    if (ext_file->prev != NULL)
+        ext_file->prev->next = ext_file->next;
+    else
+        extfiles = ext_file->next;
+    if (ext_file->next != NULL)
+        ext_file->next->prev = ext_file->prev;
+    HI_CLOSE(ext_file->file);
+    free(ext_file->name);
+    free(ext_file->path);
+    free(ext_file);
+    extfile_nidle--;
+} /* HXIdrop_file */
+
+/* ------------------------------ HXIreopen_file ------------------------------- */
+/*
+NAME
+   HXIreopen_file -- make an external file writable
+USAGE
+   intn HXIreopen_file(ext_file)
+   extfile_t *ext_file;      IN: external file
+RETURNS
+   SUCCEED if the file is open for writing, else FAIL
+DESCRIPTION
+   A file opened read-only is reopened for writing in place, for all the
+   elements sharing it.  A file that is gone cannot be reopened.  Called
+   with the library lock held.
+
+---------------------------------------------------------------------------*/
+static intn
+HXIreopen_file(extfile_t *ext_file)
+{
+    hdf_file_t f;
+
+    if (ext_file->writable)
+        return SUCCEED;
+    if (ext_file->gone)
+        return FAIL;
+
+    f = (hdf_file_t)HI_OPEN(ext_file->path, DFACC_WRITE);
+    if (OPENERR(f))
+        return FAIL;
+    HI_CLOSE(ext_file->file);
+    ext_file->file     = f;
+    ext_file->writable = TRUE;
+    return SUCCEED;
+} /* HXIreopen_file */
+
+/* ------------------------------- HXIread_file -------------------------------- */
+/*
+NAME
+   HXIread_file -- read from an external file
+USAGE
+   hdf_err_code_t HXIread_file(ext_file, offset, buf, length)
+   extfile_t *ext_file;      IN: external file from HXIopen_file()
+   int32      offset;        IN: offset in the file to read from
+   void      *buf;           OUT: buffer to read into
+   int32      length;        IN: # of bytes to read
+RETURNS
+   DFE_NONE on success, the error otherwise
+DESCRIPTION
+   The seek and the read are done under the library lock, as the file
+   descriptor may be shared with elements of other HDF files.
+
+---------------------------------------------------------------------------*/
+static hdf_err_code_t
+HXIread_file(extfile_t *ext_file, int32 offset, void *buf, int32 length)
+{
+    hdf_err_code_t ret_value = DFE_NONE;
+
+    HL_LOCK_LIBRARY();
+    if (HI_SEEK(ext_file->file, offset) == FAIL)
+        ret_value = DFE_SEEKERROR;
+    else if (HI_READ(ext_file->file, buf, length) == FAIL)
+        ret_value = DFE_READERROR;
+    HL_UNLOCK_LIBRARY();
+
+    return ret_value;
+} /* HXIread_file */
+
+/* ------------------------------- HXIwrite_file ------------------------------- */
+/*
+NAME
+   HXIwrite_file -- write to an external file
+USAGE
+   hdf_err_code_t HXIwrite_file(ext_file, offset, buf, length)
+   extfile_t  *ext_file;     IN: external file from HXIopen_file()
+   int32       offset;       IN: offset in the file to write at
+   const void *buf;          IN: data to write
+   int32       length;       IN: # of bytes to write
+RETURNS
+   DFE_NONE on success, the error otherwise
+DESCRIPTION
+   A file opened read-only is first reopened for writing, for all the
+   elements sharing it.
+
+---------------------------------------------------------------------------*/
+static hdf_err_code_t
+HXIwrite_file(extfile_t *ext_file, int32 offset, const void *buf, int32 length)
+{
+    hdf_err_code_t ret_value = DFE_NONE;
+
+    HL_LOCK_LIBRARY();
+    if (HXIreopen_file(ext_file) == FAIL)
+        ret_value = DFE_DENIED;
+    else if (HI_SEEK(ext_file->file, offset) == FAIL)
+        ret_value = DFE_SEEKERROR;
+    else if (HI_WRITE(ext_file->file, buf, length) == FAIL)
+        ret_value = DFE_WRITEERROR;
+    HL_UNLOCK_LIBRARY();
+    return ret_value;
+} /* HXIwrite_file */
+
 /*------------------------------------------------------------------------
 NAME
    HXPshutdown -- free any memory buffers we've allocated
@@ -1375,5 +1745,12 @@ HXPshutdown(void)
     HDFEXTCREATEDIR = NULL;
     HDFEXTDIR       = NULL;
 
+    /* close all the external files kept open */
+    HL_LOCK_LIBRARY();
+    extfile_max = 0;
+    HXIprune_files();
+    extfile_max = EXT_CACHE_FILES;
+    HL_UNLOCK_LIBRARY();
+
     return SUCCEED;
 } /* end HXPshutdown() */
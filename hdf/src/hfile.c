@@ -57,21 +57,49 @@
    HDputc      -- write a byte to data element
    Hendaccess  -- to dispose of an access element
    Hgetelement -- read in a data element
+   Hreadv      -- read parts of several data elements
    Hputelement -- writes a data element
    Hlength     -- returns length of a data element
    Hoffset     -- get offset of data element in the file
    Hishdf      -- tells if a file is an HDF file
+   Hprobe      -- find out the format of a file without opening it
    Htrunc      -- truncate a dataset to a length
    Hsync       -- sync file with memory
    Hcache      -- set low-level caching for a file
+   Hmmap       -- set memory-mapped reads for a read-only file
+   Hsetaccesspattern -- tell the system how a file is going to be read
+   Hsetdriver  -- set the driver of the files opened next
+   Hregisterdriver -- add a file driver
+   Hsetstreaming -- write the files created next strictly in order
+   Hsetmaxdescriptors -- set the # of descriptors kept by the open files
+   Hsetkeepopen -- set the # of closed files kept open
+   Hwriteindex -- write the sidecar index of a file
+   Hreadindex  -- set reads from the sidecar index of a read-only file
+   Hsetindexcache -- set where sidecar indexes are kept and write missing ones
+   Hsetcompact -- set compaction of linked block elements on close
+   Hsetcompactdd -- set compaction of the DD list on close
+   Hsetalignment -- set the alignment of the data elements of a file
+   Hreservespace -- reserve space for the small elements of a file
    HDvalidfid  -- check if a file ID is valid
    HDerr       --  Closes a file and return FAIL.
    Hsetacceesstype -- set the I/O access type (serial, parallel, ...)
                        of a data element
+   Hsetsievebuf    -- set the size of the sieve buffer of a data element
    Hgetlibversion  -- return version info on current HDF library
    Hgetfileversion -- return version info on HDF file
+   Hgetstats       -- return the I/O statistics of an HDF file
+   Hset_trace_callback -- set the callback the library reports its phases to
+   Hsetconfig      -- change a setting of the library
+   Hgetconfig      -- get a setting of the library
    HPgetdiskblock  -- Get the offset of a free block in the file.
    HPfreediskblock -- Release a block in a file to be reused.
+   HPread_at       -- read from a file at an offset, leaving its position
+   HPread_batch    -- read several extents of a file at once
+   HPfile_size     -- get the length of a file
+   HPkeep_open     -- keep a file open after its last close
+   HPfile_stamp    -- identify the contents of a file on disk
+   HPgetconfig     -- get a setting of the library, for its own use
+   HPprefetch_files -- read ahead the metadata of files about to be opened
    HDread_drec -- reads a description record
    HDcheck_empty   -- determines if an element has been written with data
    HDget_special_info -- get information about a special element
@@ -99,15 +127,41 @@
 
    LOCAL ROUTINES
    HIextend_file   -- extend file to current length
+   HIgetendblock   -- get a block at the end of the file
+   HIrelocate      -- move a growing element of an aligned file
+   HIfree_compare_off, HIfree_compare_size -- compare unused extents
+   HIfree_find, HIfree_insert, HIfree_remove  -- manage unused extents
    HIget_function_table -- create special function table
    HIgetspinfo          -- return special info
    HIunlock             -- unlock a previously locked file record
    HIget_filerec_node   -- locate a filerec for a new file
+   HIkept_add, HIkept_trim, HIkept_take, HIkept_close -- keep closed files open
    HIrelease_filerec_node -- release a filerec
    HIvalid_magic        -- verify the magic number in a file
+   HIdrv_valid_magic    -- verify the magic number in a file opened by a driver
+   HIprobe_read         -- read bytes of a file probed by Hprobe()
+   HIfind_driver        -- look a file driver up by name
+   HIpath_driver        -- get the driver a file is to be opened with
+   HIfile_open, HIfile_close -- open or close the file of a filerec
+   HIfile_use           -- make sure a file holds its descriptor
+   HIfd_add, HIfd_remove -- add or remove a file from the descriptor list
+   HIfd_park            -- close the descriptor of the least recently used file
+   HIfd_pin, HIfd_unpin -- keep a descriptor from being parked during a read
+   HIwbuf_write, HIwbuf_flush -- write out the write-combining buffer of a file
+   HIstream_open, HIstream_close -- start or finish writing a file in order
+   HIstream_write, HIstream_read -- write or read a file written in order
+   HIstream_emit        -- write out bytes of a file written in order
+   HIseek               -- move the position of a file
+   HIindex_path         -- get the name of the sidecar index of a file
+   HIopen_index, HIclose_index -- load or drop the sidecar index of a file
+   HIwrite_index        -- write the sidecar index of a file
+   HIread_index         -- read from the sidecar index of a file
    HIget_access_rec     -- allocate a new access record
    HIupdate_version     -- determine whether new version tag should be written
    HIread_version       -- reads a version tag from a file
+   HIprefetch_elem      -- tell whether an element is read when a file is opened
+   HIprefetch_compare   -- order extents by offset
+   HIprefetch_task      -- read ahead the metadata of one file
    + */
 
 #include <string.h>
@@ -117,10 +171,107 @@
 #include <errno.h>
 #include "glist.h" /* for double-linked lists, stacks and queues */
 
+#include <sys/stat.h>
+
+#ifdef HI_MMAP_SUPPORTED
+#include <sys/mman.h>
+#endif
+
+#ifdef HI_PREADV_SUPPORTED
+#include <sys/uio.h>
+#endif
+
+#ifdef HI_FADVISE_SUPPORTED
+#include <fcntl.h>
+#endif
+
+/* Whether a character separates the directories of a path, and the id of
+   the process, see HIindex_path() and HIwrite_index() */
+#ifdef H4_HAVE_WIN32_API
+#define HI_IS_SEP(c) ((c) == '/' || (c) == '\\')
+#define HI_GETPID()  _getpid()
+#else
+#define HI_IS_SEP(c) ((c) == '/')
+#define HI_GETPID()  getpid()
+#endif
+
 /*--------------------- Locally defined Globals -----------------------------*/
 
-/* The default state of the file DD caching */
-static intn default_cache = TRUE;
+/* The default state of the file DD caching, and the default size of the
+   buffer combining small writes, see Hcache() */
+static intn  default_cache     = TRUE;
+static int32 default_wbuf_size = HWBUF_DEFAULT_SIZE;
+
+/* Whether the write-combining buffer of a file holds bytes of an extent */
+#define HI_WBUF_OVERLAPS(f, o, n)                                                                            \
+    ((f)->wbuf_len > 0 && (o) < (f)->wbuf_off + (f)->wbuf_len && (f)->wbuf_off < (o) + (n))
+
+/* The default state of memory-mapping for files opened read-only */
+static intn default_mmap = FALSE;
+
+/* The access pattern of the files opened next, and all its flags, see
+   Hsetaccesspattern() */
+static intn default_pattern = HDF_ACCESS_NORMAL;
+#define HI_ACCESS_ALL (HDF_ACCESS_SEQUENTIAL | HDF_ACCESS_RANDOM | HDF_ACCESS_WILLNEED | HDF_ACCESS_DONTNEED)
+
+/* The default state of reads from the sidecar index for files opened read-only */
+static intn default_index = FALSE;
+
+/* The directory the sidecar indexes are kept in, NULL for next to their
+   files, and whether files opened read-only without a valid index get one,
+   see Hsetindexcache() */
+static char *index_dir   = NULL;
+static intn  index_write = FALSE;
+
+/* The driver of the files opened next, NULL for the built-in one, and
+   whether the built-in one maps the files opened read-only, see Hsetdriver() */
+static const hdf_driver_t *default_driver     = NULL;
+static intn                default_driver_map = FALSE;
+
+/* The # of bytes the files created next keep before writing them out in
+   order, 0 for writing them as usual, see Hsetstreaming() */
+static int32 default_stream = 0;
+
+/* The drivers that can be selected by name, see Hregisterdriver() */
+static const hdf_driver_t *drivers[HDRV_MAX_DRIVERS] = {
+    &HP_driver_core,
+    &HP_driver_memory,
+#ifdef H4_HAVE_LIBCURL
+    &HP_driver_http,
+#endif /* H4_HAVE_LIBCURL */
+#ifdef H4_HAVE_PARALLEL
+    &HP_driver_mpio,
+#endif /* H4_HAVE_PARALLEL */
+#ifdef HI_DIRECT_SUPPORTED
+    &HP_driver_direct,
+#endif /* HI_DIRECT_SUPPORTED */
+};
+
+/* The files of the built-in file access holding a descriptor, most
+   recently used first, their number and the most kept open, see
+   Hsetmaxdescriptors(); protected by the library lock */
+static filerec_t *fd_first = NULL;
+static filerec_t *fd_last  = NULL;
+static intn       fd_count = 0;
+static intn       fd_max   = MAX_OPEN_DESCRIPTORS;
+
+/* The read-only files kept open after their last close, most recently
+   closed first, their number and the most kept, see Hsetkeepopen();
+   protected by the files lock */
+static filerec_t *kept_first = NULL;
+static intn       kept_count = 0;
+static intn       kept_max   = KEEP_OPEN_FILES;
+
+/* The tracing callback and its user data, see Hset_trace_callback() */
+hdf_trace_func_t HPtrace_func = NULL;
+void            *HPtrace_data = NULL;
+
+/* The settings of the library, see Hsetconfig(), and the environment
+   variables they are read from when it starts */
+static int32             config_values[HDF_CONFIG_NSETTINGS] = {0};
+static const char *const config_env[HDF_CONFIG_NSETTINGS]    = {
+    "HDF4_CHUNK_CACHE_BYTES", "HDF4_IO_BUFSIZE", "HDF4_DEFLATE_BUFSIZE", "HDF4_MAX_FILES",
+    "HDF4_TASK_THREADS"};
 
 /* Whether we've installed the library termination function yet for this interface */
 static intn          library_terminate = FALSE;
@@ -158,6 +309,9 @@ extern funclist_t comp_funcs;
    For definition of the chunked data element, see hchunk.c. */
 #include "hchunks.h"
 
+/* The shared worker threads, see HPprefetch_files() */
+#include "htpool.h"
+
 /* Functions for accessing buffered data elements.
    For definition of the buffered data element, see hbuffer.c. */
 extern funclist_t buf_funcs;
@@ -184,22 +338,120 @@ functab_t functab[] = {
  */
 static intn HIunlock(filerec_t *file_rec);
 
-static filerec_t *HIget_filerec_node(const char *path);
+static filerec_t *HIget_filerec_node(const char *path, intn acc_mode);
+
+static intn HIkept_add(filerec_t *file_rec);
+
+static void HIkept_trim(void);
+
+static filerec_t *HIkept_take(const char *path, intn acc_mode);
+
+static void HIkept_close(filerec_t *file_rec);
 
 static intn HIrelease_filerec_node(filerec_t *file_rec);
 
 static intn HIvalid_magic(hdf_file_t file);
 
+static intn HIdrv_valid_magic(const hdf_driver_t *drv, void *handle);
+
+static intn HIprobe_read(const hdf_driver_t *drv, void *handle, hdf_file_t file, int32 offset, void *buf,
+                         int32 bytes);
+
+static const hdf_driver_t *HIfind_driver(const char *name);
+
+static const hdf_driver_t *HIpath_driver(const char *path);
+
+static intn HIfile_open(filerec_t *file_rec, const hdf_driver_t *drv, intn acc_mode);
+
+static intn HIfile_close(filerec_t *file_rec);
+
+static intn HIfile_use(filerec_t *file_rec);
+
+static void HIfd_add(filerec_t *file_rec);
+
+static void HIfd_remove(filerec_t *file_rec);
+
+static intn HIfd_park(filerec_t *keep);
+
+#if defined(H4_HAVE_THREADSAFE) && defined(HI_PREADV_SUPPORTED)
+static intn HIfd_pin(filerec_t *file_rec, int *fd);
+
+static void HIfd_unpin(filerec_t *file_rec);
+#endif /* H4_HAVE_THREADSAFE && HI_PREADV_SUPPORTED */
+
+static intn HIwbuf_write(filerec_t *file_rec);
+
+static intn HIwbuf_flush(filerec_t *file_rec);
+
+static intn HIstream_open(filerec_t *file_rec, int16 ndds, int32 window);
+
+static intn HIstream_close(filerec_t *file_rec);
+
+static intn HIstream_emit(filerec_t *file_rec, int32 offset, const void *buf, int32 bytes);
+
+static intn HIstream_write(filerec_t *file_rec, int32 offset, const uint8 *buf, int32 bytes);
+
+static intn HIstream_read(filerec_t *file_rec, int32 offset, uint8 *buf, int32 bytes);
+
+static intn HIseek(filerec_t *file_rec, int32 offset);
+
+static intn HIopen_map(filerec_t *file_rec);
+
+static intn HIclose_map(filerec_t *file_rec);
+
+static void HIadvise(filerec_t *file_rec, intn old_pattern, intn willneed);
+
+static void HIdrop_behind(filerec_t *file_rec, int32 offset, int32 bytes);
+
+static void HIdrop_flush(filerec_t *file_rec);
+
+static char *HIindex_path(const char *path);
+
+static intn HIopen_index(filerec_t *file_rec);
+
+static intn HIwrite_index(filerec_t *file_rec, int32 max_len);
+
+static void HIclose_index(filerec_t *file_rec);
+
+static intn HIread_index(filerec_t *file_rec, int32 offset, void *buf, int32 bytes);
+
+static int HIreadv_compare(const void *a, const void *b);
+
+#ifdef HI_PREADV_SUPPORTED
+static intn HIpreadv(int fd, struct iovec *iov, int niov, off_t offset);
+#endif /* HI_PREADV_SUPPORTED */
+
+static int32 HIreadv_special(int32 file_id, hdf_readv_t *req);
+
 static intn HIextend_file(filerec_t *file_rec);
 
+static int32 HIgetendblock(filerec_t *file_rec, int32 block_size, intn aligned, intn moveto);
+
+static intn HIrelocate(filerec_t *file_rec, accrec_t *access_rec, int32 data_off, int32 data_len,
+                       int32 new_len);
+
+static intn HIfree_compare_off(void *k1, void *k2, intn cmparg);
+
+static intn HIfree_compare_size(void *k1, void *k2, intn cmparg);
+
+static TBBT_NODE *HIfree_find(TBBT_TREE *tree, void *key, intn by_size, intn above);
+
+static intn HIfree_insert(filerec_t *file_rec, hfile_free_t *ext);
+
+static void HIfree_remove(filerec_t *file_rec, hfile_free_t *ext);
+
 static funclist_t *HIget_function_table(accrec_t *access_rec);
 
+static intn HIreposition(accrec_t *access_rec, filerec_t *file_rec, atom_t ddid);
+
 static intn HIupdate_version(int32);
 
 static intn HIread_version(int32);
 
 static intn HIcheckfileversion(int32 file_id);
 
+static void HIread_config(void);
+
 static intn HIsync(filerec_t *file_rec);
 
 static intn HIstart(void);
@@ -213,7 +465,9 @@ USAGE
    int access;             IN: DFACC_READ, DFACC_WRITE, DFACC_CREATE
                                 or any bitwise-or of the above.
    int16 ndds;             IN: Number of dds in a block if this
-                                file needs to be created.
+                                file needs to be created, or in the
+                                blocks added to a file opened for
+                                writing; 0 for the default.
 RETURNS
    On success returns file id, on failure returns -1.
 DESCRIPTION
@@ -228,6 +482,11 @@ DESCRIPTION
    implied even if it is not set.  DFACC_CREATE implies
    DFACC_WRITE.
 
+   Files that are to get many elements read faster when their DDs are
+   in a few large blocks: ndds sets the size of the first DD block of a
+   new file, which the blocks added later take, and the size of the
+   blocks added to an existing file.
+
    If the file is already opened and access is DFACC_CREATE:
    error DFE_ALROPEN.
    If the file is already opened, the requested access contains
@@ -246,12 +505,15 @@ int32
 Hopen(const char *path, intn acc_mode, int16 ndds)
 {
     filerec_t *file_rec  = NULL; /* File record */
+    filerec_t *locked    = NULL; /* File record locked by this call */
     int        vtag      = 0;    /* write version tag? */
     int32      fid       = FAIL; /* File ID */
     int32      ret_value = SUCCEED;
 
     /* Clear errors and check args and all the boring stuff. */
     HEclear();
+    HP_TRACE(HDF_TRACE_OPEN, FALSE, 0);
+    HL_LOCK_FILES();
     if (!path || ((acc_mode & DFACC_ALL) != acc_mode))
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
@@ -262,8 +524,9 @@ Hopen(const char *path, intn acc_mode, int16 ndds)
 
     /* Get a space to put the file information.
      * HIget_filerec_node() also copies path into the record. */
-    if ((file_rec = HIget_filerec_node(path)) == NULL)
+    if ((file_rec = HIget_filerec_node(path, acc_mode)) == NULL)
         HGOTO_ERROR(DFE_TOOMANY, FAIL); /* The slots are full. */
+    locked = HL_LOCK_FILE(file_rec);
 
     if (file_rec->refcount) { /* File is already opened, check that permission is okay. */
         /* If this request is to create a new file and file is still
@@ -276,23 +539,29 @@ Hopen(const char *path, intn acc_mode, int16 ndds)
                provide for write, then try to reopen file for writing.
                This cannot be done on OS (such as the SXOS) where only one
                open is allowed per file at any time. */
-            hdf_file_t f;
+            filerec_t old_rec; /* the handles of the file opened read-only */
 
             /* Sync. the file before throwing away the old file handle */
             if (HIsync(file_rec) == FAIL)
                 HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
-            f = (hdf_file_t)HI_OPEN(file_rec->path, acc_mode);
-            if (OPENERR(f))
+            /* Writable files are never mapped nor read from an index */
+            if (HIclose_map(file_rec) == FAIL)
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+            HIclose_index(file_rec);
+
+            /* Open the file again with the same driver, then close the
+               old handle. */
+            memset(&old_rec, 0, sizeof(old_rec));
+            old_rec.file       = file_rec->file;
+            old_rec.drv        = file_rec->drv;
+            old_rec.drv_handle = file_rec->drv_handle;
+            old_rec.parked     = file_rec->parked;
+            HIfd_remove(file_rec);
+            if (HIfile_open(file_rec, file_rec->drv, acc_mode) == FAIL)
                 HGOTO_ERROR(DFE_DENIED, FAIL);
-
-            /* Replace file_rec->file with new file pointer and
-               close old one. */
-            if (HI_CLOSE(file_rec->file) == FAIL) {
-                HI_CLOSE(f);
+            if (HIfile_close(&old_rec) == FAIL)
                 HGOTO_ERROR(DFE_CANTCLOSE, FAIL);
-            }
-            file_rec->file      = f;
             file_rec->f_cur_off = 0;
             file_rec->last_op   = H4_OP_UNKNOWN;
         }
@@ -300,14 +569,37 @@ Hopen(const char *path, intn acc_mode, int16 ndds)
         /* There is now one more open to this file. */
         file_rec->refcount++;
     }
+    else if (file_rec->kept) {
+        /* The file was kept open since its last close, see HPkeep_open():
+           its DD list is still loaded and up to date. */
+        file_rec->kept     = FALSE;
+        file_rec->keep     = FALSE;
+        file_rec->refcount = 1;
+        if (file_rec->pattern != default_pattern) {
+            intn old_pattern = file_rec->pattern;
+
+            file_rec->pattern = default_pattern;
+            HIadvise(file_rec, old_pattern, TRUE);
+        } /* end if */
+    }
     else {
         /* Flag to see if file is new and needs to be set up. */
         intn new_file = FALSE;
 
+        /* Flag to see if the file needs a sidecar index written */
+        intn need_index = FALSE;
+
+        /* The driver to open the file with */
+        const hdf_driver_t *drv = HIpath_driver(file_rec->path);
+
+        /* The file is read the way the files opened next are, as it is
+           opened: even its DD list is read with the pattern */
+        file_rec->pattern  = default_pattern;
+        file_rec->drop_len = 0;
+
         /* Open the file, fill in the blanks and all the good stuff. */
         if (acc_mode != DFACC_CREATE) { /* try to open existing file */
-            file_rec->file = (hdf_file_t)HI_OPEN(file_rec->path, acc_mode);
-            if (OPENERR(file_rec->file)) {
+            if (HIfile_open(file_rec, drv, acc_mode) == FAIL) {
                 if (acc_mode & DFACC_WRITE) {
                     /* Seems like the file is not there, try to create it. */
                     new_file = TRUE;
@@ -319,19 +611,39 @@ Hopen(const char *path, intn acc_mode, int16 ndds)
                 /* Open existing file successfully. */
                 file_rec->access = acc_mode | DFACC_READ;
 
-                /* Check to see if file is a HDF file. */
-                if (!HIvalid_magic(file_rec->file)) {
-                    HI_CLOSE(file_rec->file);
+                /* Load the sidecar index of read-only files, if requested;
+                   it is not an error not to find a valid one */
+                if (default_index && acc_mode == DFACC_READ && HIopen_index(file_rec) == FAIL)
+                    need_index = index_write;
+
+                /* Check to see if file is a HDF file; an index is only
+                   loaded when it holds the magic number. */
+                if (file_rec->idx == NULL && !(drv != NULL ? HIdrv_valid_magic(drv, file_rec->drv_handle)
+                                                           : HIvalid_magic(file_rec->file))) {
+                    HIfile_close(file_rec);
                     HGOTO_ERROR(DFE_NOTDFFILE, FAIL);
                 }
 
                 file_rec->f_cur_off = 0;
                 file_rec->last_op   = H4_OP_UNKNOWN;
+
+                /* Map read-only files, if requested; failure is not fatal,
+                   the file is simply read through the file handle */
+                if ((default_mmap || default_driver_map) && acc_mode == DFACC_READ)
+                    HIopen_map(file_rec);
+
                 /* Read in all the relevant data descriptor records. */
                 if (HTPstart(file_rec) == FAIL) {
-                    HI_CLOSE(file_rec->file);
+                    HIclose_map(file_rec);
+                    HIclose_index(file_rec);
+                    HIfile_close(file_rec);
                     HGOTO_ERROR(DFE_BADOPEN, FAIL);
                 }
+
+                /* Write the missing index for the processes opening the
+                   file next, see Hsetindexcache(); failing to is not fatal */
+                if (need_index && HIwrite_index(file_rec, HIDX_DEF_MAX_LEN) == SUCCEED)
+                    HIopen_index(file_rec);
             }
         }
         /* do *not* use else here */
@@ -339,8 +651,7 @@ Hopen(const char *path, intn acc_mode, int16 ndds)
                                                     /* make user we get a version tag */
             vtag = 1;
 
-            file_rec->file = (hdf_file_t)HI_CREATE(file_rec->path);
-            if (OPENERR(file_rec->file)) {
+            if (HIfile_open(file_rec, drv, DFACC_CREATE) == FAIL) {
                 /* check if the failure was due to "too many open files" */
                 if (errno == EMFILE) {
                     HGOTO_ERROR(DFE_TOOMANY, FAIL);
@@ -352,12 +663,19 @@ Hopen(const char *path, intn acc_mode, int16 ndds)
             file_rec->f_cur_off = 0;
             file_rec->last_op   = H4_OP_UNKNOWN;
 
+            /* a file created for streaming is written out in order from
+               now on, its head last */
+            if (default_stream > 0 && HIstream_open(file_rec, ndds, default_stream) == FAIL) {
+                HIfile_close(file_rec);
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+            }
+
             /* set up the newly created (and empty) file with
                the magic cookie and initial data descriptor records */
             if (HP_write(file_rec, HDFMAGIC, MAGICLEN) == FAIL)
                 HGOTO_ERROR(DFE_WRITEERROR, FAIL);
 
-            if (HI_FLUSH(file_rec->file) == FAIL) /* flush the cookie */
+            if (HP_flush(file_rec) == FAIL) /* flush the cookie */
                 HGOTO_ERROR(DFE_WRITEERROR, FAIL);
 
             if (HTPinit(file_rec, ndds) == FAIL)
@@ -370,9 +688,22 @@ Hopen(const char *path, intn acc_mode, int16 ndds)
         file_rec->attach   = 0;
 
         /* currently, default is caching OFF */
-        file_rec->cache = default_cache;
-        file_rec->dirty = 0; /* mark all dirty flags off to start */
-    }                        /* end else */
+        file_rec->cache           = default_cache;
+        file_rec->wbuf_size       = default_wbuf_size;
+        file_rec->compact         = FALSE;
+        file_rec->compact_dd      = FALSE;
+        file_rec->align_threshold = 0;
+        file_rec->alignment       = 0;
+        file_rec->dirty           = 0; /* mark all dirty flags off to start */
+
+        /* the DD blocks of a streamed file are written when it is closed */
+        if (file_rec->stream != NULL)
+            file_rec->cache = TRUE;
+    } /* end else */
+
+    /* The DD blocks added to an existing file take the size asked for */
+    if (ndds > 0 && acc_mode != DFACC_CREATE && (file_rec->access & DFACC_WRITE))
+        file_rec->new_ndds = MAX(ndds, MIN_NDDS);
 
     file_rec->version_set = FALSE;
 
@@ -396,9 +727,15 @@ done:
             HAremove_atom(fid);
 
         /* Chuck the file record we've built */
-        if (file_rec != NULL && file_rec->refcount == 0)
+        if (file_rec != NULL && file_rec->refcount == 0) {
+            HL_UNLOCK_FILE(locked);
+            locked = NULL;
             HIrelease_filerec_node(file_rec);
+        }
     }
+    HL_UNLOCK_FILE(locked);
+    HL_UNLOCK_FILES();
+    HP_TRACE(HDF_TRACE_OPEN, TRUE, 0);
 
     return ret_value;
 } /* Hopen */
@@ -421,20 +758,31 @@ intn
 Hclose(int32 file_id)
 {
     filerec_t *file_rec; /* file record pointer */
+    filerec_t *locked    = NULL;
     intn       ret_value = SUCCEED;
 
     /* Clear errors and check args and all the boring stuff. */
     HEclear();
+    HL_LOCK_FILES();
 
     /* convert file id to file rec and check for validity */
     file_rec = HAatom_object(file_id);
     if (BADFREC(file_rec))
         HGOTO_ERROR(DFE_ARGS, FAIL);
+    locked = HL_LOCK_FILE(file_rec);
 
     /* version tags */
     if ((file_rec->refcount > 0) && (file_rec->version.modified == 1))
         HIupdate_version(file_id);
 
+    /* compact the linked block elements, then the DD list, before the last
+       close; what cannot be compacted is left as it is and does not stop
+       the close */
+    if (file_rec->refcount == 1 && file_rec->attach == 0 && file_rec->compact)
+        HLcompact(file_id, DFTAG_WILDCARD, DFREF_WILDCARD);
+    if (file_rec->refcount == 1 && file_rec->attach == 0 && file_rec->compact_dd)
+        Hcompactdd(file_id);
+
     /* decrease the reference count */
     if (--file_rec->refcount == 0) {
         /* if file reference count is zero but there are still attached
@@ -445,25 +793,36 @@ Hclose(int32 file_id)
             HGOTO_ERROR(DFE_OPENAID, FAIL);
         } /* end if */
 
-        /* before closing file, check whether to flush file info */
-        if (HIsync(file_rec) == FAIL)
-            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        /* a file marked by HPkeep_open() stays open, to be reopened
+           without reading its DD list again */
+        if (!HIkept_add(file_rec)) {
+            /* before closing file, check whether to flush file info; a
+               streamed file is written out to its end, then its head */
+            if ((file_rec->stream != NULL ? HIstream_close(file_rec) : HIsync(file_rec)) == FAIL)
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
-        /* otherwise, nothing should still be using this file, close it */
-        /* ignore any close error */
-        HI_CLOSE(file_rec->file);
+            /* otherwise, nothing should still be using this file, close it */
+            /* ignore any close error */
+            HIclose_map(file_rec);
+            HIclose_index(file_rec);
+            HIfile_close(file_rec);
 
-        if (HTPend(file_rec) == FAIL)
-            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+            if (HTPend(file_rec) == FAIL)
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
-        if (HIrelease_filerec_node(file_rec))
-            HGOTO_ERROR(DFE_INTERNAL, FAIL);
-    } /* end if */
+            HL_UNLOCK_FILE(locked);
+            locked = NULL;
+            if (HIrelease_filerec_node(file_rec))
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        } /* end if */
+    }     /* end if */
 
     if (HAremove_atom(file_id) == NULL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
 done:
+    HL_UNLOCK_FILE(locked);
+    HL_UNLOCK_FILES();
     return ret_value;
 } /* Hclose */
 
@@ -531,11 +890,14 @@ intn
 Hinquire(int32 access_id, int32 *pfile_id, uint16 *ptag, uint16 *pref, int32 *plength, int32 *poffset,
          int32 *pposn, int16 *paccess, int16 *pspecial)
 {
-    accrec_t *access_rec; /* access record */
-    intn      ret_value = SUCCEED;
+    accrec_t  *access_rec; /* access record */
+    filerec_t *locked    = NULL;
+    intn       ret_value = SUCCEED;
 
     /* clear error stack and check validity of access id */
     HEclear();
+    locked = HL_LOCK_AID(access_id);
+
     access_rec = HAatom_object(access_id);
     if (access_rec == (accrec_t *)NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
@@ -559,6 +921,7 @@ Hinquire(int32 access_id, int32 *pfile_id, uint16 *ptag, uint16 *pref, int32 *pl
         *pspecial = 0;
 
 done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* end Hinquire */
 
@@ -666,10 +1029,14 @@ Hnextread(int32 access_id, uint16 tag, uint16 ref, intn origin)
     accrec_t  *access_rec;               /* access record */
     uint16     new_tag = 0, new_ref = 0; /* new tag & ref to access */
     int32      new_off, new_len;         /* offset & length of new tag & ref */
+    atom_t     new_ddid;                 /* DD id of the new tag & ref */
+    filerec_t *locked    = NULL;
     intn       ret_value = SUCCEED;
 
     /* clear error stack and check validity of the access id */
     HEclear();
+    locked = HL_LOCK_AID(access_id);
+
     access_rec = HAatom_object(access_id);
     if (access_rec == (accrec_t *)NULL || !(access_rec->access & DFACC_READ) ||
         (origin != DF_START && origin != DF_CURRENT)) /* DF_END is NOT supported yet !!!! */
@@ -679,6 +1046,103 @@ Hnextread(int32 access_id, uint16 tag, uint16 ref, intn origin)
     if (BADFREC(file_rec))
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
+    if (origin == DF_START) { /* set up variables to start searching from beginning of file */
+        new_tag = 0;
+        new_ref = 0;
+    }
+    else { /* origin == CURRENT */
+           /* set up variables to start searching from the current position */
+        /* Get the old tag & ref */
+        if (HTPinquire(access_rec->ddid, &new_tag, &new_ref, NULL, NULL) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    }
+
+    /* go look for the dd */
+    if (Hfind(access_rec->file_id, tag, ref, &new_tag, &new_ref, &new_off, &new_len, DF_FORWARD) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* found, so update the access record */
+    if ((new_ddid = HTPselect(file_rec, new_tag, new_ref)) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    ret_value = HIreposition(access_rec, file_rec, new_ddid);
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* end Hnextread() */
+
+/*--------------------------------------------------------------------------
+NAME
+   Hrestartread -- position a read access elt on another tag/ref
+USAGE
+   intn Hrestartread(access_id, tag, ref)
+   int32 access_id;         IN: id of a READ access elt
+   uint16 tag;              IN: the tag to access
+   uint16 ref;              IN: the ref to access
+RETURNS
+   returns SUCCEED (0) if successful and FAIL (-1) otherwise
+DESCRIPTION
+   Moves a read access elt to the start of the data element tag/ref, as if
+   it was ended and Hstartread was called on tag/ref, but keeps the access
+   id and its record.  No wildcards apply and the DD list is not searched,
+   which makes this the cheapest way to read many elements one after the
+   other.  If tag/ref does not exist, the access elt is not modified.
+
+--------------------------------------------------------------------------*/
+intn
+Hrestartread(int32 access_id, uint16 tag, uint16 ref)
+{
+    filerec_t *file_rec;   /* file record */
+    accrec_t  *access_rec; /* access record */
+    atom_t     new_ddid;   /* DD id of the new tag & ref */
+    filerec_t *locked    = NULL;
+    intn       ret_value = SUCCEED;
+
+    /* clear error stack and check validity of the access id */
+    HEclear();
+    locked = HL_LOCK_AID(access_id);
+
+    access_rec = HAatom_object(access_id);
+    if (access_rec == (accrec_t *)NULL || !(access_rec->access & DFACC_READ))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    file_rec = HAatom_object(access_rec->file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    if ((new_ddid = HTPselect(file_rec, BASETAG(tag), ref)) == FAIL)
+        HGOTO_ERROR(DFE_NOMATCH, FAIL);
+    ret_value = HIreposition(access_rec, file_rec, new_ddid);
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* end Hrestartread() */
+
+/*--------------------------------------------------------------------------
+NAME
+   HIreposition -- move a read access elt to another DD
+USAGE
+   intn HIreposition(access_rec, file_rec, ddid)
+   accrec_t *access_rec;    IN: access record to move
+   filerec_t *file_rec;     IN: file record of the access record
+   atom_t ddid;             IN: DD id of the element to move to
+RETURNS
+   returns SUCCEED (0) if successful and FAIL (-1) otherwise
+DESCRIPTION
+   Closes the special element the access record was on, if any, lets go
+   of its DD id and sets the record up to read the element of ddid from
+   its start, which the record takes ownership of.  Used by Hnextread
+   and Hrestartread.
+
+--------------------------------------------------------------------------*/
+static intn
+HIreposition(accrec_t *access_rec, filerec_t *file_rec, atom_t ddid)
+{
+    uint16 new_tag, new_ref; /* tag & ref of the new element */
+    int32  new_off, new_len; /* offset & length of the new element */
+    intn   ret_value = SUCCEED;
+
     /*
      * if access record used to point to an external element we
      * need to close the file before moving on
@@ -714,30 +1178,22 @@ Hnextread(int32 access_id, uint16 tag, uint16 ref, intn origin)
                 break;
         } /* end switch */
     }
-
-    if (origin == DF_START) { /* set up variables to start searching from beginning of file */
-        new_tag = 0;
-        new_ref = 0;
-    }
-    else { /* origin == CURRENT */
-           /* set up variables to start searching from the current position */
-        /* Get the old tag & ref */
-        if (HTPinquire(access_rec->ddid, &new_tag, &new_ref, NULL, NULL) == FAIL)
-            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    else if (access_rec->special_info != NULL) { /* bytes buffered by the file */
+        if (HBPcloseAID(access_rec) == FAIL)
+            HGOTO_ERROR(DFE_CANTCLOSE, FAIL);
     }
-
-    /* go look for the dd */
-    if (Hfind(access_rec->file_id, tag, ref, &new_tag, &new_ref, &new_off, &new_len, DF_FORWARD) == FAIL)
-        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    access_rec->special_info = NULL;
 
     /* Let go of the previous DD id */
     if (HTPendaccess(access_rec->ddid) == FAIL)
         HGOTO_ERROR(DFE_CANTFLUSH, FAIL);
 
-    /* found, so update the access record */
-    if ((access_rec->ddid = HTPselect(file_rec, new_tag, new_ref)) == FAIL)
-        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    /* update the access record */
+    access_rec->ddid       = ddid;
     access_rec->appendable = FALSE; /* start data as non-appendable */
+    access_rec->sieve_len  = 0;     /* the sieve buffer held the previous element */
+    if (HTPinquire(ddid, &new_tag, &new_ref, &new_off, &new_len) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
     if (new_len == INVALID_OFFSET && new_off == INVALID_LENGTH)
         access_rec->new_elem = TRUE;
     else
@@ -765,9 +1221,19 @@ Hnextread(int32 access_id, uint16 tag, uint16 ref, intn origin)
     access_rec->special = 0;
     access_rec->posn    = 0;
 
+    /* small elements read repeatedly come from memory, see HBsetpolicy() */
+    if (file_rec->hb_max_len > 0 && !(access_rec->access & DFACC_WRITE) && !access_rec->new_elem &&
+        !SPECIALTAG(new_tag) && new_len > 0 && new_len <= file_rec->hb_max_len)
+        HBPpromote(file_rec, access_rec, new_tag, new_ref, new_off, new_len);
+
 done:
+    if (ret_value == FAIL) { /* Error condition cleanup */
+        if (access_rec->ddid != ddid)
+            HTPendaccess(ddid);
+    }
+
     return ret_value;
-} /* end Hnextread() */
+} /* end HIreposition() */
 
 /*--------------------------------------------------------------------------
 NAME
@@ -841,6 +1307,7 @@ Hstartaccess(int32 file_id, uint16 tag, uint16 ref, uint32 flags)
     accrec_t  *access_rec = NULL;        /* access record */
     uint16     new_tag = 0, new_ref = 0; /* new tag & ref to access */
     int32      new_off, new_len;         /* offset & length of new tag & ref */
+    filerec_t *locked    = NULL;
     int32      ret_value = SUCCEED;
 
     /* clear error stack and check validity of file id */
@@ -849,6 +1316,7 @@ Hstartaccess(int32 file_id, uint16 tag, uint16 ref, uint32 flags)
     file_rec = HAatom_object(file_id);
     if (BADFREC(file_rec))
         HGOTO_ERROR(DFE_ARGS, FAIL);
+    locked = HL_LOCK_FILE(file_rec);
 
     /* If writing, can we write to this file? */
     if ((flags & DFACC_WRITE) && !(file_rec->access & DFACC_WRITE))
@@ -939,6 +1407,12 @@ Hstartaccess(int32 file_id, uint16 tag, uint16 ref, uint32 flags)
                                      this elt is new */
     file_rec->attach++;           /* increment number of elts attached to file */
 
+    /* small elements read repeatedly come from memory, see HBsetpolicy();
+       the access stays a plain one if the element cannot be buffered */
+    if (file_rec->hb_max_len > 0 && !(flags & DFACC_WRITE) && !ddnew && !SPECIALTAG(new_tag) &&
+        new_len > 0 && new_len <= file_rec->hb_max_len)
+        HBPpromote(file_rec, access_rec, new_tag, new_ref, new_off, new_len);
+
     /* check current maximum ref for file and update if necessary */
     if (new_ref > file_rec->maxref)
         file_rec->maxref = new_ref;
@@ -957,6 +1431,7 @@ done:
             HIrelease_accrec_node(access_rec);
     }
 
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* end Hstartaccess */
 
@@ -981,10 +1456,12 @@ Hsetlength(int32 aid, int32 length)
     accrec_t  *access_rec; /* access record */
     filerec_t *file_rec;   /* file record */
     int32      offset;     /* offset of this data element in file */
+    filerec_t *locked    = NULL;
     intn       ret_value = SUCCEED;
 
     /* clear error stack and check validity of file id */
     HEclear();
+    locked = HL_LOCK_AID(aid);
 
     if ((access_rec = HAatom_object(aid)) == NULL) /* get the access_rec pointer */
         HGOTO_ERROR(DFE_ARGS, FAIL);
@@ -997,8 +1474,14 @@ Hsetlength(int32 aid, int32 length)
     if (BADFREC(file_rec))
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* place the data element at the end of the file and record its offset */
-    if ((offset = HPgetdiskblock(file_rec, length, FALSE)) == FAIL)
+    /* place the data element in unused space or at the end of the file and
+       record its offset; an element that may grow in place must be last,
+       unless the file is aligned: it is then moved when it grows */
+    if (access_rec->appendable && file_rec->alignment == 0)
+        offset = HIgetendblock(file_rec, length, FALSE, FALSE);
+    else
+        offset = HPgetdiskblock(file_rec, length, FALSE);
+    if (offset == FAIL)
         HGOTO_ERROR(DFE_SEEKERROR, FAIL);
 
     /* fill in dd record updating the offset and length of the element */
@@ -1009,6 +1492,7 @@ Hsetlength(int32 aid, int32 length)
     access_rec->new_elem = FALSE;
 
 done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* end Hsetlength */
 
@@ -1122,10 +1606,12 @@ Hseek(int32 access_id, int32 offset, intn origin)
     filerec_t *file_rec;            /* file record */
     int32      data_len;            /* length of the data we are checking */
     int32      data_off;            /* offset of the data we are checking */
+    filerec_t *locked    = NULL;
     intn       ret_value = SUCCEED;
 
     /* clear error stack and check validity of this access id */
     HEclear();
+    locked = HL_LOCK_AID(access_id);
 
     access_rec = HAatom_object(access_id);
     if (access_rec == (accrec_t *)NULL || (origin != DF_START && origin != DF_CURRENT && origin != DF_END))
@@ -1184,6 +1670,7 @@ Hseek(int32 access_id, int32 offset, intn origin)
     access_rec->posn = offset;
 
 done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* Hseek() */
 
@@ -1245,10 +1732,13 @@ Hread(int32 access_id, int32 length, void *data)
     accrec_t  *access_rec; /* access record */
     int32      data_len;   /* length of the data we are checking */
     int32      data_off;   /* offset of the data we are checking */
+    filerec_t *locked    = NULL;
     int32      ret_value = SUCCEED;
 
     /* clear error stack and check validity of access id */
     HEclear();
+    locked = HL_LOCK_AID(access_id);
+
     access_rec = HAatom_object(access_id);
     if (access_rec == (accrec_t *)NULL || data == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
@@ -1276,18 +1766,70 @@ Hread(int32 access_id, int32 length, void *data)
     if (HTPinquire(access_rec->ddid, NULL, NULL, &data_off, &data_len) == FAIL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
-    /* seek to position to start reading and read in data */
-    if (HPseek(file_rec, access_rec->posn + data_off) == FAIL)
-        HGOTO_ERROR(DFE_SEEKERROR, FAIL);
-
     /* length == 0 means to read to end of element, */
     /* if read length exceeds length of elt, read till end of elt */
     if (length == 0 || length + access_rec->posn > data_len)
         length = data_len - access_rec->posn;
 
-    /* read in data */
-    if (HP_read(file_rec, data, length) == FAIL)
-        HGOTO_ERROR(DFE_READERROR, FAIL);
+    /* the bytes buffered by the file for the element, see HBsetpolicy() */
+    if (access_rec->special_info != NULL) {
+        ret_value = HBPread(access_rec, length, data);
+        goto done;
+    } /* end if */
+
+    /* read small pieces through the sieve buffer, if there is one */
+    if (length > 0 && length < access_rec->sieve_size) {
+        if (access_rec->posn < access_rec->sieve_posn ||
+            access_rec->posn + length > access_rec->sieve_posn + access_rec->sieve_len) {
+            /* fill the buffer with the bytes from the current position on */
+            access_rec->sieve_posn = access_rec->posn;
+            access_rec->sieve_len  = MIN(access_rec->sieve_size, data_len - access_rec->posn);
+            if (HPread_at(file_rec, access_rec->posn + data_off, access_rec->sieve_buf,
+                          access_rec->sieve_len) == FAIL) {
+                access_rec->sieve_len = 0;
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+            }
+        }
+        memcpy(data, (uint8 *)access_rec->sieve_buf + (access_rec->posn - access_rec->sieve_posn),
+               (size_t)length);
+    }
+    else {
+#if defined(H4_HAVE_THREADSAFE) && defined(HI_PREADV_SUPPORTED)
+        int fd;
+
+        /* read without the lock of the file, so that other threads can use
+           the file meanwhile: the element is only read from and the
+           descriptor stays put, while the access record is moved first;
+           files dropping what they read keep track of it under the lock */
+        if (length > 0 && !(file_rec->pattern & HDF_ACCESS_DONTNEED) && HIfd_pin(file_rec, &fd) == SUCCEED) {
+            struct iovec iov;
+            int32        posn = access_rec->posn;
+            intn         status;
+
+            access_rec->posn += length;
+            file_rec->stats.nreads++;
+            file_rec->stats.bytes_read += (uint32)length;
+            HL_UNLOCK_FILE(locked);
+            locked = NULL;
+
+            iov.iov_base = data;
+            iov.iov_len  = (size_t)length;
+            HP_TRACE(HDF_TRACE_READ, FALSE, length);
+            status = HIpreadv(fd, &iov, 1, (off_t)(posn + data_off));
+            HP_TRACE(HDF_TRACE_READ, TRUE, length);
+            HIfd_unpin(file_rec);
+            if (status == FAIL) {
+                locked = HL_LOCK_AID(access_id);
+                if ((access_rec = HAatom_object(access_id)) != NULL)
+                    access_rec->posn = posn;
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+            } /* end if */
+            HGOTO_DONE(length);
+        } /* end if */
+#endif /* H4_HAVE_THREADSAFE && HI_PREADV_SUPPORTED */
+        if (HPread_at(file_rec, access_rec->posn + data_off, data, length) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+    }
 
     /* move the position of the access record */
     access_rec->posn += length;
@@ -1295,6 +1837,7 @@ Hread(int32 access_id, int32 length, void *data)
     ret_value = length;
 
 done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* Hread */
 
@@ -1315,23 +1858,33 @@ DESCRIPTION
    of the user to insure that no two access elements are writing to the
    same data element.  It is possible to interlace writes to more than
    one data elements in the same file though.
-   Calling with length == 0 is an error.
+   Calling with length == 0 is an error, as is a write that would take the
+   element past MAX_FILE_OFFSET.
 
 --------------------------------------------------------------------------*/
 int32
 Hwrite(int32 access_id, int32 length, const void *data)
 {
-    filerec_t *file_rec;   /* file record */
-    accrec_t  *access_rec; /* access record */
-    int32      data_len;   /* length of the data we are checking */
-    int32      data_off;   /* offset of the data we are checking */
+    filerec_t *file_rec;           /* file record */
+    accrec_t  *access_rec;         /* access record */
+    uint16     data_tag, data_ref; /* tag/ref of the data we are checking */
+    int32      data_len;           /* length of the data we are checking */
+    int32      data_off;           /* offset of the data we are checking */
+    filerec_t *locked    = NULL;
     int32      ret_value = SUCCEED;
 
     /* clear error stack and check validity of access id */
     HEclear();
+    locked = HL_LOCK_AID(access_id);
+
     access_rec = HAatom_object(access_id);
     if (access_rec == (accrec_t *)NULL || !(access_rec->access & DFACC_WRITE) || data == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (length > MAX_FILE_OFFSET - access_rec->posn)
+        HGOTO_ERROR(DFE_BADLEN, FAIL);
+
+    /* the sieve buffer may hold the bytes being overwritten */
+    access_rec->sieve_len = 0;
 
     /* if special elt, call special write function */
     if (access_rec->special) {
@@ -1347,15 +1900,19 @@ Hwrite(int32 access_id, int32 length, const void *data)
     /* check for a "new" element and make it appendable if so.
        Does this mean every element is by default appendable? */
     if (access_rec->new_elem == TRUE) {
-        Hsetlength(access_id, length); /* make the initial chunk of data */
         access_rec->appendable = TRUE; /* make it appendable */
-    }                                  /* end if */
+        if (Hsetlength(access_id, length) == FAIL) /* make the initial chunk of data */
+            HGOTO_ERROR(DFE_BADLEN, FAIL);
+    } /* end if */
 
     /* get the offset and length of the element. This should have
        been set by Hstartwrite(). */
-    if (HTPinquire(access_rec->ddid, NULL, NULL, &data_off, &data_len) == FAIL)
+    if (HTPinquire(access_rec->ddid, &data_tag, &data_ref, &data_off, &data_len) == FAIL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
+    /* the bytes buffered for the element are about to change */
+    HBPforget(file_rec, data_tag, data_ref);
+
     /* check validity of length and write data.
      NOTE: it is an error to attempt write past the end of the elt */
     if (length <= 0 || (!access_rec->appendable && length + access_rec->posn > data_len))
@@ -1365,26 +1922,42 @@ Hwrite(int32 access_id, int32 length, const void *data)
        data element length */
     if (access_rec->appendable && length + access_rec->posn > data_len) { /* yes */
 
-        /* is data element at end of file?
-           hmm. not sure about this condition. */
-        if (data_len + data_off != file_rec->f_end_off) { /* nope, not at end of file. Try to promote to
-                                                         linked-block element. */
-            if (HLconvert(access_id, access_rec->block_size, access_rec->num_blocks) == FAIL) {
-                access_rec->appendable = FALSE;
-                HGOTO_ERROR(DFE_BADSEEK, FAIL);
-            } /* end if */
-              /* successfully converted the element into a linked block */
-              /* now loop back and actually write the data out */
-            if ((ret_value = Hwrite(access_id, length, data)) == FAIL)
+        /* in an aligned file, an element shorter than the threshold is moved
+           when it was empty, reaches the threshold or is not at the end */
+        if (file_rec->alignment > 0 && data_len < file_rec->align_threshold &&
+            (data_len == 0 || access_rec->posn + length >= file_rec->align_threshold ||
+             data_len + data_off != file_rec->f_end_off)) {
+            if (HIrelocate(file_rec, access_rec, data_off, data_len, access_rec->posn + length) == FAIL)
                 HGOTO_ERROR(DFE_WRITEERROR, FAIL);
-            goto done; /* we're finished, wrap things up */
-        }              /* end if */
-
-        /* Update the DD with the new length. Note argument of '-2' for
-           the offset parameter means not to change the offset in the DD. */
-        if (HTPupdate(access_rec->ddid, -2, access_rec->posn + length) == FAIL)
-            HGOTO_ERROR(DFE_INTERNAL, FAIL);
-    } /* end if */
+            if (HTPinquire(access_rec->ddid, NULL, NULL, &data_off, &data_len) == FAIL)
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        } /* end if */
+        else {
+            /* is data element at end of file?
+               hmm. not sure about this condition. */
+            if (data_len + data_off != file_rec->f_end_off) { /* nope, not at end of file. Try to promote to
+                                                             linked-block element. */
+                if (HLconvert(access_id, access_rec->block_size, access_rec->num_blocks) == FAIL) {
+                    access_rec->appendable = FALSE;
+                    HGOTO_ERROR(DFE_BADSEEK, FAIL);
+                } /* end if */
+                  /* successfully converted the element into a linked block */
+                  /* now loop back and actually write the data out */
+                if ((ret_value = Hwrite(access_id, length, data)) == FAIL)
+                    HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+                goto done; /* we're finished, wrap things up */
+            }              /* end if */
+
+            /* the file cannot grow past MAX_FILE_OFFSET either */
+            if (access_rec->posn + length > MAX_FILE_OFFSET - data_off)
+                HGOTO_ERROR(DFE_BADLEN, FAIL);
+
+            /* Update the DD with the new length. Note argument of '-2' for
+               the offset parameter means not to change the offset in the DD. */
+            if (HTPupdate(access_rec->ddid, -2, access_rec->posn + length) == FAIL)
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        } /* end else */
+    }     /* end if */
 
     /* seek and write data */
     if (HPseek(file_rec, access_rec->posn + data_off) == FAIL)
@@ -1403,6 +1976,7 @@ Hwrite(int32 access_id, int32 length, const void *data)
     ret_value = length;
 
 done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* end Hwrite */
 
@@ -1488,10 +2062,13 @@ Hendaccess(int32 access_id)
 {
     filerec_t *file_rec;          /* file record */
     accrec_t  *access_rec = NULL; /* access record */
+    filerec_t *locked     = NULL;
     intn       ret_value  = SUCCEED;
 
     /* clear error stack and check validity of access id */
     HEclear();
+    locked = HL_LOCK_AID(access_id);
+
     if ((access_rec = HAremove_atom(access_id)) == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
@@ -1506,6 +2083,10 @@ Hendaccess(int32 access_id)
     if (BADFREC(file_rec))
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
+    /* let go of the bytes buffered by the file, see HBsetpolicy() */
+    if (access_rec->special_info != NULL && HBPcloseAID(access_rec) == FAIL)
+        HGOTO_ERROR(DFE_CANTCLOSE, FAIL);
+
     /* update file and access records */
     if (HTPendaccess(access_rec->ddid) == FAIL)
         HGOTO_ERROR(DFE_CANTFLUSH, FAIL);
@@ -1514,6 +2095,7 @@ Hendaccess(int32 access_id)
     HIrelease_accrec_node(access_rec);
 
 done:
+    HL_UNLOCK_FILE(locked);
     if (ret_value == FAIL) { /* Error condition cleanup */
         if (access_rec != NULL)
             HIrelease_accrec_node(access_rec);
@@ -1574,49 +2156,178 @@ done:
 
 /*--------------------------------------------------------------------------
 NAME
-   Hputelement -- writes a data element
+   Hreadv -- read parts of several data elements
 USAGE
-   int Hputelement(fileid, tag, ref, data, length)
+   int32 Hreadv(fileid, nreqs, reqs)
    int32 fileid;             IN: id of file
-   int16 tag;                IN: tag of data element to put
-   int16 ref;                IN: ref of data element to put
-   char *data;               IN: pointer to buffer
-   int32 length;             IN: length of data
+   int32 nreqs;              IN: number of requests
+   hdf_readv_t *reqs;        IN/OUT: the requests
 RETURNS
-   returns length of bytes written if successful and FAIL (-1)
+   returns the total number of bytes read if successful and FAIL (-1)
    otherwise
 DESCRIPTION
-   Writes a data element or replaces an existing data element
-   in an HDF file.  Uses Hwrite and its associated routines.
-
+   Reads bytes [offset, offset + length) of the element tag/ref of each
+   request into its buffer and sets its nread to the number of bytes
+   read; a length of 0 reads the rest of the element.  Reads are clipped
+   at the end of the element, as Hread does.
+
+   The elements are located in the DD list up front, without setting up
+   access records.  The extents of plain elements are then read in one
+   batch with HPread_batch().  Special elements (linked blocks,
+   compressed, external, ...) are read through their access functions.
+
+   All the elements are located before any data is read: if one of them
+   does not exist, nothing is read.
 --------------------------------------------------------------------------*/
 int32
-Hputelement(int32 file_id, uint16 tag, uint16 ref, const uint8 *data, int32 length)
+Hreadv(int32 file_id, int32 nreqs, hdf_readv_t *reqs)
 {
-    int32 access_id = FAIL; /* access record id */
-    int32 ret_value = SUCCEED;
-
-    /* clear error stack */
+    filerec_t   *file_rec;         /* file record */
+    hfile_ext_t *exts      = NULL; /* extents of the plain elements */
+    int32        n_ext     = 0;    /* # of extents */
+    int32       *special   = NULL; /* requests for special elements */
+    int32        n_special = 0;    /* # of special element requests */
+    atom_t       ddid      = FAIL; /* DD id of the current element */
+    int32        total     = 0;    /* # of bytes read */
+    int32        i;                /* loop index */
+    filerec_t   *locked    = NULL;
+    int32        ret_value = SUCCEED;
+
+    /* clear error stack and check validity of args */
     HEclear();
 
-    /* get access record, write out data and dispose of access record */
-    if ((access_id = Hstartwrite(file_id, (uint16)tag, (uint16)ref, length)) == FAIL)
-        HGOTO_ERROR(DFE_NOMATCH, FAIL);
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec) || nreqs < 0 || (nreqs > 0 && reqs == NULL))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    locked = HL_LOCK_FILE(file_rec);
+    if (nreqs == 0)
+        HGOTO_DONE(0);
 
-    if ((ret_value = Hwrite(access_id, length, data)) == FAIL)
-        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    if ((exts = (hfile_ext_t *)malloc((size_t)nreqs * sizeof(hfile_ext_t))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if ((special = (int32 *)malloc((size_t)nreqs * sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
-    if (Hendaccess(access_id) == FAIL)
-        HGOTO_ERROR(DFE_CANTENDACCESS, FAIL);
+    /* Locate the data of each request */
+    for (i = 0; i < nreqs; i++) {
+        hdf_readv_t *req = &reqs[i];
+        int32        data_off, data_len; /* offset & length of the element */
+        int32        nbytes;             /* # of bytes to read */
 
-done:
-    if (ret_value == FAIL) { /* Error condition cleanup */
-        if (access_id != FAIL)
-            Hendaccess(access_id);
-    }
+        req->nread = 0;
+        if (req->buf == NULL || req->offset < 0 || req->length < 0)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    return ret_value;
-} /* end Hputelement() */
+        if ((ddid = HTPselect(file_rec, req->tag, req->ref)) == FAIL)
+            HGOTO_ERROR(DFE_NOMATCH, FAIL);
+
+        /* let the special element functions deal with special elements */
+        if (!SPECIALTAG(req->tag) && HTPis_special(ddid) == TRUE) {
+            special[n_special++] = i;
+        }
+        else {
+            if (HTPinquire(ddid, NULL, NULL, &data_off, &data_len) == FAIL)
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+            /* an element written without its length being set is empty */
+            if (data_off == INVALID_OFFSET && data_len == INVALID_LENGTH)
+                data_len = 0;
+            if (req->offset > data_len)
+                HGOTO_ERROR(DFE_BADSEEK, FAIL);
+
+            nbytes = data_len - req->offset;
+            if (req->length > 0 && req->length < nbytes)
+                nbytes = req->length;
+            if (nbytes > 0) {
+                exts[n_ext].offset = data_off + req->offset;
+                exts[n_ext].length = nbytes;
+                exts[n_ext].buf    = (uint8 *)req->buf;
+                n_ext++;
+                req->nread = nbytes;
+                total += nbytes;
+            } /* end if */
+        }     /* end else */
+
+        if (HTPendaccess(ddid) == FAIL)
+            HGOTO_ERROR(DFE_CANTENDACCESS, FAIL);
+        ddid = FAIL;
+    } /* end for */
+
+    /* Read the plain elements */
+    if (HPread_batch(file_rec, n_ext, exts) == FAIL)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
+
+    /* Read the special elements */
+    for (i = 0; i < n_special; i++) {
+        int32 nbytes;
+
+        if ((nbytes = HIreadv_special(file_id, &reqs[special[i]])) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        total += nbytes;
+    } /* end for */
+
+    ret_value = total;
+
+done:
+    if (ret_value == FAIL) { /* Error condition cleanup */
+        if (ddid != FAIL)
+            HTPendaccess(ddid);
+        if (exts != NULL)
+            for (i = 0; i < nreqs; i++)
+                reqs[i].nread = 0;
+    }
+    free(exts);
+    free(special);
+
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* Hreadv() */
+
+/*--------------------------------------------------------------------------
+NAME
+   Hputelement -- writes a data element
+USAGE
+   int Hputelement(fileid, tag, ref, data, length)
+   int32 fileid;             IN: id of file
+   int16 tag;                IN: tag of data element to put
+   int16 ref;                IN: ref of data element to put
+   char *data;               IN: pointer to buffer
+   int32 length;             IN: length of data
+RETURNS
+   returns length of bytes written if successful and FAIL (-1)
+   otherwise
+DESCRIPTION
+   Writes a data element or replaces an existing data element
+   in an HDF file.  Uses Hwrite and its associated routines.
+
+--------------------------------------------------------------------------*/
+int32
+Hputelement(int32 file_id, uint16 tag, uint16 ref, const uint8 *data, int32 length)
+{
+    int32 access_id = FAIL; /* access record id */
+    int32 ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* get access record, write out data and dispose of access record */
+    if ((access_id = Hstartwrite(file_id, (uint16)tag, (uint16)ref, length)) == FAIL)
+        HGOTO_ERROR(DFE_NOMATCH, FAIL);
+
+    if ((ret_value = Hwrite(access_id, length, data)) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+    if (Hendaccess(access_id) == FAIL)
+        HGOTO_ERROR(DFE_CANTENDACCESS, FAIL);
+
+done:
+    if (ret_value == FAIL) { /* Error condition cleanup */
+        if (access_id != FAIL)
+            Hendaccess(access_id);
+    }
+
+    return ret_value;
+} /* end Hputelement() */
 
 /*--------------------------------------------------------------------------
 NAME
@@ -1726,33 +2437,168 @@ DESCRIPTION
    This user level routine can be used to determine if a file
    with a given name is an HDF file.  Note, just because a file
    is not an HDF file does not imply that all HDF library
-   functions can not work on it.
+   functions can not work on it.  Only the magic number of the file
+   is read, see Hprobe().
 
 --------------------------------------------------------------------------*/
 intn
 Hishdf(const char *filename)
 {
-    intn       ret;
-    hdf_file_t fp;
-    intn       ret_value = TRUE;
+    hdf_probe_t probe;
 
-    /* Search for a matching slot in the already open files. */
-    if (HAsearch_atom(FIDGROUP, HPcompare_filerec_path, filename) != NULL)
-        HGOTO_DONE(TRUE);
+    if (Hprobe(filename, FALSE, &probe) == FAIL)
+        return FALSE;
+    return probe.hdf;
+} /* Hishdf */
 
-    fp = (hdf_file_t)HI_OPEN(filename, DFACC_READ);
-    if (OPENERR(fp)) {
-        ret_value = FALSE;
+/*--------------------------------------------------------------------------
+NAME
+   Hprobe -- find out the format of a file without opening it
+USAGE
+   intn Hprobe(path, check_dds, probe)
+   const char *path;             IN: name of file
+   intn check_dds;               IN: whether to check the first DD block
+   hdf_probe_t *probe;           OUT: what is found out about the file
+RETURNS
+   returns SUCCEED (0) if the file could be read, FAIL (-1) otherwise
+DESCRIPTION
+   Reads the first 4 bytes of a file, which are returned in probe->magic
+   for the caller to tell the HDF, netCDF and CDF formats apart, and sets
+   probe->hdf to whether the file has the HDF magic number.  Nothing is
+   allocated, and no file record is made, which makes this cheap enough to
+   classify any number of files.
+   If check_dds is TRUE and the file is an HDF file, its first DD block is
+   also read: probe->dds_ok is set to whether the block and the extents of
+   its DDs fit in the file, probe->ndds to its number of DDs, and the
+   version of the library that wrote the file is read when the block holds
+   the version tag.  The version is 0.0.0 otherwise.  A file open in the
+   library is reported from its file record.
+   Files are read through the driver they would be opened with, see
+   Hsetdriver().
+
+--------------------------------------------------------------------------*/
+intn
+Hprobe(const char *filename, intn check_dds, hdf_probe_t *probe)
+{
+    filerec_t          *file_rec;
+    const hdf_driver_t *drv;
+    void               *handle = NULL;
+    hdf_file_t          fp;
+    intn                fp_open = FALSE;
+    uint8               buf[NDDS_SZ + OFFSET_SZ];
+    uint8              *p;
+    int32               size;
+    intn                ret_value = SUCCEED;
+
+    HEclear();
+    if (filename == NULL || probe == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    memset(probe, 0, sizeof(hdf_probe_t));
+
+    /* A file open in the library is reported as it is known there */
+    HL_LOCK_FILES();
+    if ((file_rec = HAsearch_atom(FIDGROUP, HPcompare_filerec_path, filename)) != NULL) {
+        memcpy(buf, HDFMAGIC, MAGICLEN);
+        p = buf;
+        INT32DECODE(p, probe->magic);
+        probe->hdf     = TRUE;
+        probe->dds_ok  = TRUE;
+        probe->ndds    = file_rec->ddhead != NULL ? file_rec->ddhead->ndds : 0;
+        probe->majorv  = file_rec->version.majorv;
+        probe->minorv  = file_rec->version.minorv;
+        probe->release = file_rec->version.release;
+    } /* end if */
+    HL_UNLOCK_FILES();
+    if (file_rec != NULL)
+        HGOTO_DONE(SUCCEED);
+
+    /* Look through the driver the file would be opened with */
+    if ((drv = HIpath_driver(filename)) != NULL) {
+        if ((handle = (*drv->open)(filename, DFACC_READ)) == NULL)
+            HGOTO_ERROR(DFE_BADOPEN, FAIL);
     }
     else {
-        ret = HIvalid_magic(fp);
-        HI_CLOSE(fp);
-        ret_value = (int)ret;
-    }
+        fp = (hdf_file_t)HI_OPEN(filename, DFACC_READ);
+        if (OPENERR(fp))
+            HGOTO_ERROR(DFE_BADOPEN, FAIL);
+        fp_open = TRUE;
+    } /* end else */
+
+    if (HIprobe_read(drv, handle, fp, 0, buf, MAGICLEN) == FAIL)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
+    p = buf;
+    INT32DECODE(p, probe->magic);
+    probe->hdf = NSTREQ((char *)buf, HDFMAGIC, MAGICLEN);
+    if (!probe->hdf || !check_dds)
+        HGOTO_DONE(SUCCEED);
+
+    /* The first DD block follows the magic number */
+    if (drv != NULL)
+        size = (*drv->size)(handle);
+    else if (HI_SEEKEND(fp) == FAIL || (size = (int32)HI_TELL(fp)) < 0)
+        size = FAIL;
+    if (size == FAIL)
+        HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+    if (size >= MAGICLEN + NDDS_SZ + OFFSET_SZ) {
+        int16  ndds;
+        int32  next;
+        uint8 *dds;
+        intn   i;
+
+        if (HIprobe_read(drv, handle, fp, MAGICLEN, buf, NDDS_SZ + OFFSET_SZ) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        p = buf;
+        INT16DECODE(p, ndds);
+        INT32DECODE(p, next);
+        if (ndds <= 0 || (int32)ndds * DD_SZ > size - (MAGICLEN + NDDS_SZ + OFFSET_SZ) ||
+            (next != 0 && (next < MAGICLEN || next > size - (NDDS_SZ + OFFSET_SZ))))
+            HGOTO_DONE(SUCCEED);
+
+        if ((dds = malloc((size_t)ndds * DD_SZ)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if (HIprobe_read(drv, handle, fp, MAGICLEN + NDDS_SZ + OFFSET_SZ, dds, (int32)ndds * DD_SZ) == FAIL) {
+            free(dds);
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        } /* end if */
+        probe->ndds   = ndds;
+        probe->dds_ok = TRUE;
+        for (i = 0, p = dds; i < ndds; i++) {
+            uint16 tag, ref;
+            int32  offset, length;
+
+            UINT16DECODE(p, tag);
+            UINT16DECODE(p, ref);
+            INT32DECODE(p, offset);
+            INT32DECODE(p, length);
+            if (tag == DFTAG_NULL || (offset == INVALID_OFFSET && length == INVALID_LENGTH))
+                continue;
+            if (offset < 0 || length < 0 || offset > size - length) {
+                probe->dds_ok = FALSE;
+                break;
+            } /* end if */
+            if (tag == DFTAG_VERSION && length >= 3 * 4) {
+                uint8  vbuf[3 * 4];
+                uint8 *v = vbuf;
+
+                if (HIprobe_read(drv, handle, fp, offset, vbuf, 3 * 4) == FAIL) {
+                    free(dds);
+                    HGOTO_ERROR(DFE_READERROR, FAIL);
+                } /* end if */
+                UINT32DECODE(v, probe->majorv);
+                UINT32DECODE(v, probe->minorv);
+                UINT32DECODE(v, probe->release);
+            } /* end if */
+        }     /* end for */
+        free(dds);
+    } /* end if */
 
 done:
+    if (handle != NULL)
+        (*drv->close)(handle);
+    if (fp_open)
+        HI_CLOSE(fp);
     return ret_value;
-} /* Hishdf */
+} /* Hprobe */
 
 /*--------------------------------------------------------------------------
 NAME
@@ -1771,17 +2617,23 @@ DESCRIPTION
 int32
 Htrunc(int32 aid, int32 trunc_len)
 {
-    accrec_t *access_rec; /* access record */
-    int32     data_len;   /* length of the data we are checking */
-    int32     data_off;   /* offset of the data we are checking */
-    int32     ret_value = SUCCEED;
+    accrec_t  *access_rec; /* access record */
+    int32      data_len;   /* length of the data we are checking */
+    int32      data_off;   /* offset of the data we are checking */
+    filerec_t *locked    = NULL;
+    int32      ret_value = SUCCEED;
 
     /* clear error stack and check validity of access id */
     HEclear();
+    locked = HL_LOCK_AID(aid);
+
     access_rec = HAatom_object(aid);
     if (access_rec == (accrec_t *)NULL || !(access_rec->access & DFACC_WRITE))
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
+    /* the sieve buffer may hold bytes past the new end */
+    access_rec->sieve_len = 0;
+
         /* Dunno about truncating special elements... -QAK */
 #ifdef DONT_KNOW
     /* if special elt, call special function */
@@ -1810,6 +2662,7 @@ Htrunc(int32 aid, int32 trunc_len)
         HGOTO_ERROR(DFE_BADLEN, FAIL);
 
 done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* end Htrunc() */
 
@@ -1831,6 +2684,11 @@ HIsync(filerec_t *file_rec)
 {
     intn ret_value = SUCCEED;
 
+    /* a streamed file is only written out when it is closed, since what
+       was written out cannot be written again */
+    if (file_rec->stream != NULL)
+        HGOTO_DONE(SUCCEED);
+
     /* check whether to flush the file info */
     if (file_rec->cache && file_rec->dirty) {
         /* flush DD blocks if necessary */
@@ -1845,6 +2703,10 @@ HIsync(filerec_t *file_rec)
         file_rec->dirty = 0; /* file doesn't need to be flushed now */
     }                        /* end if */
 
+    /* write out the small writes combined so far */
+    if (HIwbuf_flush(file_rec) == FAIL)
+        HGOTO_ERROR(DFE_CANTFLUSH, FAIL);
+
 done:
     return ret_value;
 } /* HIsync */
@@ -1858,10 +2720,9 @@ USAGE
 RETURNS
    returns SUCCEED (0) if successful, FAIL (-1) otherwise
 DESCRIPTION
-   Currently, the on-disk and in-memory representations are always
-   the same.  Thus there is no real use for Hsync().  In the future,
-   things may be buffered before being written out at which time
-   Hsync() will be useful to sync up the on-disk representation.
+   Writes out the cached DD blocks and the small writes combined in
+   memory, see Hcache(), so that the file on disk is up to date.  Files
+   created for streaming, see Hsetstreaming(), are left as they are.
 NOTE
    First tests of caching DD's until close.
 
@@ -1870,18 +2731,21 @@ intn
 Hsync(int32 file_id)
 {
     filerec_t *file_rec; /* file record */
+    filerec_t *locked    = NULL;
     intn       ret_value = SUCCEED;
 
     /* check validity of file record and get dd ptr */
     file_rec = HAatom_object(file_id);
     if (BADFREC(file_rec))
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    locked = HL_LOCK_FILE(file_rec);
 
     /* check whether to flush the file info */
     if (HIsync(file_rec) == FAIL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
 done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* Hsync */
 
@@ -1898,869 +2762,3667 @@ DESCRIPTION
    Set/reset the caching in an HDF file.
    If file_id is set to CACHE_ALL_FILES, then the value of cache_on is
    used to modify the default caching state.
+
+   Caching keeps the DD blocks in memory until the file is synced or
+   closed, and combines the small writes to adjacent offsets in a buffer
+   of the file, written out when full, when a read needs bytes it holds,
+   and by Hsync() and Hclose().  A cache_on larger than 1 gives the size
+   of that buffer in bytes; TRUE gives it HWBUF_DEFAULT_SIZE bytes.
+   Writes at least as long as the buffer go straight to the file.  With
+   cache_on FALSE everything is written out and writes are no longer
+   combined.  Files opened through a driver write straight through it.
+   Files created for streaming, see Hsetstreaming(), keep their DD
+   blocks cached.
 --------------------------------------------------------------------------*/
 intn
 Hcache(int32 file_id, intn cache_on)
 {
-    filerec_t *file_rec; /* file record */
+    filerec_t *file_rec;  /* file record */
+    int32      wbuf_size; /* size of the write-combining buffer */
+    filerec_t *locked    = NULL;
     intn       ret_value = SUCCEED;
 
+    if (cache_on > 1)
+        wbuf_size = (int32)cache_on;
+    else
+        wbuf_size = (cache_on != 0 ? HWBUF_DEFAULT_SIZE : 0);
+
     if (file_id == CACHE_ALL_FILES) /* check whether to modify the default cache */
     {                               /* set the default caching for all further files Hopen'ed */
-        default_cache = (cache_on != 0 ? TRUE : FALSE);
+        default_cache     = (cache_on != 0 ? TRUE : FALSE);
+        default_wbuf_size = wbuf_size;
     } /* end if */
     else {
         /* check validity of file record and get dd ptr */
         file_rec = HAatom_object(file_id);
         if (BADFREC(file_rec))
             HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        locked = HL_LOCK_FILE(file_rec);
 
         /* check whether to flush the file info */
         if (cache_on == FALSE && file_rec->cache) {
             if (HIsync(file_rec) == FAIL)
                 HGOTO_ERROR(DFE_INTERNAL, FAIL);
         } /* end if */
-        file_rec->cache = (cache_on != 0 ? TRUE : FALSE);
+        file_rec->cache = (cache_on != 0 || file_rec->stream != NULL ? TRUE : FALSE);
+
+        /* a buffer of another size is allocated by the next write */
+        if (wbuf_size != file_rec->wbuf_size) {
+            if (HIwbuf_flush(file_rec) == FAIL)
+                HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+            free(file_rec->wbuf);
+            file_rec->wbuf      = NULL;
+            file_rec->wbuf_size = wbuf_size;
+        } /* end if */
     } /* end else */
 
 done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* Hcache */
 
 /*--------------------------------------------------------------------------
 NAME
-   HDvalidfid -- check if a file ID is valid
+   Hmmap -- set memory-mapped reads for a read-only file
 USAGE
-   int HDvalidfid(file_id)
-   int32 file_id;            IN: id of file
+   intn Hmmap(file_id,mmap_on)
+           int32 file_id;            IN: id of file
+           intn mmap_on;             IN: whether to map the file or not
 RETURNS
-   returns TRUE if valid ID else FALSE
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
 DESCRIPTION
-   Determine whether a given int32 is a valid HDF file ID or not
-
+   Set/reset memory-mapping of an HDF file opened read-only.  While a file
+   is mapped, all reads from it are copied out of the mapping instead of
+   going through the file handle.
+   If file_id is set to CACHE_ALL_FILES, then the value of mmap_on is
+   used to modify the default state for all further files Hopen'ed with
+   DFACC_READ.  The default is not to map files.
+   Mapping a file opened for writing fails.  On platforms without mmap()
+   this routine has no effect, as does a mapping that cannot be set up.
+COMMENTS, BUGS, ASSUMPTIONS
+   A mapped file must not be truncated by another process while it is
+   open: accessing a page past the new end of the file raises SIGBUS.
 --------------------------------------------------------------------------*/
 intn
-HDvalidfid(int32 file_id)
+Hmmap(int32 file_id, intn mmap_on)
 {
-    filerec_t *file_rec;
-    intn       ret_value = TRUE;
+    filerec_t *file_rec; /* file record */
+    filerec_t *locked    = NULL;
+    intn       ret_value = SUCCEED;
 
-    /* convert file id to file rec and check for validity */
-    file_rec = HAatom_object(file_id);
-    if (BADFREC(file_rec))
-        ret_value = FALSE;
+    HEclear();
+
+    if (file_id == CACHE_ALL_FILES) /* check whether to modify the default */
+    {                               /* set the default mapping for all further files Hopen'ed */
+        default_mmap = (mmap_on != 0 ? TRUE : FALSE);
+    } /* end if */
+    else {
+        /* check validity of file record */
+        file_rec = HAatom_object(file_id);
+        if (BADFREC(file_rec))
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+        locked = HL_LOCK_FILE(file_rec);
+
+        if (mmap_on) {
+            if (file_rec->access & DFACC_WRITE)
+                HGOTO_ERROR(DFE_DENIED, FAIL);
+            if (file_rec->map == NULL)
+                HIopen_map(file_rec);
+        } /* end if */
+        else if (HIclose_map(file_rec) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    } /* end else */
 
+done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
-} /* HDvalidfid */
+} /* Hmmap */
 
 /*--------------------------------------------------------------------------
-HDerr --  Closes a file and return FAIL.
-           Replacement for DFIerr in HDF3.1 and before
+NAME
+   Hsetaccesspattern -- tell the system how a file is going to be read
+USAGE
+   intn Hsetaccesspattern(file_id,pattern)
+           int32 file_id;            IN: id of file
+           intn pattern;             IN: HDF_ACCESS_* flags
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
+DESCRIPTION
+   Passes on to the system how the file is going to be read, through
+   posix_fadvise() on its descriptor and madvise() on its mapping, see
+   Hmmap().  HDF_ACCESS_SEQUENTIAL is for reading the file from start to
+   end, as hrepack does, and HDF_ACCESS_RANDOM for reading pieces of it in
+   no order, as a tile server does; at most one of them is given.
+   HDF_ACCESS_WILLNEED starts reading the whole file into the page cache
+   at once.  With HDF_ACCESS_DONTNEED, the bytes read one after the other
+   are dropped from the page cache once HDROP_BEHIND_LEN of them are read,
+   and when the reads jump elsewhere, so that scanning a large file does
+   not push everything else out of the page cache; what is read again
+   then comes from the disk again.  HDF_ACCESS_NORMAL undoes all of them.
+   If file_id is set to CACHE_ALL_FILES, then pattern becomes the access
+   pattern of all further files Hopen'ed, which is applied as they are
+   opened.  The default is HDF_ACCESS_NORMAL.
+   These are hints: they do not change what is read, and where the
+   system does not take them, or for files opened through a driver, they
+   have no effect.
 --------------------------------------------------------------------------*/
-int
-HDerr(int32 file_id)
+intn
+Hsetaccesspattern(int32 file_id, intn pattern)
 {
-    Hclose(file_id);
-    return FAIL;
-}
+    filerec_t *file_rec; /* file record */
+    filerec_t *locked    = NULL;
+    intn       old_pattern;
+    intn       ret_value = SUCCEED;
+
+    HEclear();
+
+    if ((pattern & ~HI_ACCESS_ALL) != 0 ||
+        ((pattern & HDF_ACCESS_SEQUENTIAL) && (pattern & HDF_ACCESS_RANDOM)))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (file_id == CACHE_ALL_FILES) /* set the pattern of all further files Hopen'ed */
+        default_pattern = pattern;
+    else {
+        /* check validity of file record */
+        file_rec = HAatom_object(file_id);
+        if (BADFREC(file_rec))
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+        locked = HL_LOCK_FILE(file_rec);
+
+        old_pattern       = file_rec->pattern;
+        file_rec->pattern = pattern;
+        if (!(pattern & HDF_ACCESS_DONTNEED))
+            file_rec->drop_len = 0;
+        HIadvise(file_rec, old_pattern, TRUE);
+    } /* end else */
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* Hsetaccesspattern */
 
 /*--------------------------------------------------------------------------
 NAME
-   Hsetacceesstype -- set the I/O access type (serial, parallel, ...)
-                                          of a data element
+   Hsetdriver -- set the driver of the files opened next
 USAGE
-   intn Hsetacceesstype(access_id, accesstype)
-   int32 access_id;        IN: id of access element
-   uintn accesstype;       IN: I/O access type
+   intn Hsetdriver(name)
+           const char *name;         IN: name of the driver, NULL for "posix"
 RETURNS
-   returns FAIL (-1) if fail, SUCCEED (0) otherwise.
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
 DESCRIPTION
-   Set the type of I/O for accessing the data element to
-   accesstype.
-
+   Selects the driver through which the files opened next, by Hopen() or
+   SDstart(), are read and written.  The drivers are:
+       "posix" -- the built-in file access, the default
+       "mmap"  -- the built-in file access, mapping the files opened
+                  read-only, as Hmmap(CACHE_ALL_FILES, TRUE) does
+       "core"  -- the whole file is read into memory when it is opened and
+                  written back when it is flushed or closed
+       "memory" -- files held in memory, never written to disk; files
+                  created get an image of their own, see Hsetimage()
+       "http"  -- read-only HTTP(S) range requests, with a block cache;
+                  only in libraries built with libcurl
+       "mpio"  -- read-only MPI-IO, the file being opened by a group of
+                  processes together, see Hsetmpio(); only in libraries
+                  built with MPI
+       "direct" -- reads and writes of 64 KB or more bypass the page
+                  cache, through aligned buffers, the smaller ones going
+                  through it; only where the system has O_DIRECT or
+                  F_NOCACHE
+   along with those added by Hregisterdriver().  Files named by an
+   "http://", "https://" or "s3://" URL are always opened with the "http"
+   driver, and files with an image, see Hsetimage(), with the "memory"
+   driver.  A file keeps the driver it was first opened with until it is
+   closed.
 --------------------------------------------------------------------------*/
 intn
-Hsetaccesstype(int32 access_id, uintn accesstype)
+Hsetdriver(const char *name)
 {
-    accrec_t *access_rec; /* access record */
-    intn      ret_value = SUCCEED;
+    const hdf_driver_t *drv       = NULL;
+    intn                map       = FALSE;
+    intn                ret_value = SUCCEED;
 
-    /* clear error stack and check validity of this access id */
     HEclear();
+    HL_LOCK_FILES();
 
-    access_rec = HAatom_object(access_id);
-    if (access_rec == (accrec_t *)NULL)
-        HGOTO_ERROR(DFE_ARGS, FAIL);
-    if (accesstype != DFACC_DEFAULT && accesstype != DFACC_SERIAL && accesstype != DFACC_PARALLEL)
+    if (name == NULL || strcmp(name, "posix") == 0)
+        drv = NULL;
+    else if (strcmp(name, "mmap") == 0)
+        map = TRUE;
+    else if ((drv = HIfind_driver(name)) == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    if (accesstype == access_rec->access_type)
-        goto done;
-
-    /* kludge mode on */
-    if (accesstype != DFACC_PARALLEL) /* go to PARALLEL only */
-    {
-        ret_value = FAIL;
-        goto done;
-    }
-    /* if special elt, call special function */
-    if (access_rec->special)
-        ret_value = HXPsetaccesstype(access_rec);
+    default_driver     = drv;
+    default_driver_map = map;
 
 done:
+    HL_UNLOCK_FILES();
     return ret_value;
-} /* Hsetacceesstype() */
+} /* Hsetdriver */
 
 /*--------------------------------------------------------------------------
- NAME
-    HDdont_atexit
- PURPOSE
-    Indicates to the library that an 'atexit()' routine is _not_ to be installed
- USAGE
-    intn HDdont_atexit(void)
- RETURNS
-    Returns SUCCEED/FAIL
- DESCRIPTION
-        This routine indicates to the library that an 'atexit()' cleanip routine
-    should not be installed.  The major (only?) purpose for this is in
-    situations where the library is dynamically linked into an application and
-    is un-linked from the application before 'exit()' gets called.  In those
-    situations, a routine installed with 'atexit()' would jump to a routine
-    which was no longer in memory, causing errors.
-        In order to be effective, this routine _must_ be called before any other
-    HDF function calls, and must be called each time the library is loaded/
-    linked into the application. (the first time and after it's been un-loaded)
- GLOBAL VARIABLES
- COMMENTS, BUGS, ASSUMPTIONS
-    If this routine is used, certain memory buffers will not be de-allocated,
-    although in theory a user could call HPend on their own...
- EXAMPLES
- REVISION LOG
+NAME
+   Hregisterdriver -- add a file driver
+USAGE
+   intn Hregisterdriver(driver)
+           const hdf_driver_t *driver; IN: the driver
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
+DESCRIPTION
+   Makes the driver available to Hsetdriver() under its name, replacing a
+   driver of the same name.  The "posix" and "mmap" drivers cannot be
+   replaced.  The driver is not copied and must stay valid until the
+   library terminates.  Every operation but 'write' and 'flush' is
+   required.
 --------------------------------------------------------------------------*/
 intn
-HDdont_atexit(void)
+Hregisterdriver(const hdf_driver_t *driver)
 {
+    intn i;
     intn ret_value = SUCCEED;
 
-    if (install_atexit == TRUE)
-        install_atexit = FALSE;
+    HEclear();
+    HL_LOCK_FILES();
 
-    return ret_value;
-} /* end HDdont_atexit() */
+    if (driver == NULL || driver->name == NULL || driver->open == NULL || driver->read == NULL ||
+        driver->size == NULL || driver->close == NULL || strcmp(driver->name, "posix") == 0 ||
+        strcmp(driver->name, "mmap") == 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
 
-/*==========================================================================
+    for (i = 0; i < HDRV_MAX_DRIVERS; i++)
+        if (drivers[i] == NULL || strcmp(drivers[i]->name, driver->name) == 0)
+            break;
+    if (i == HDRV_MAX_DRIVERS)
+        HGOTO_ERROR(DFE_TOOMANY, FAIL);
 
-Internal Routines
+    if (drivers[i] != NULL && default_driver == drivers[i])
+        default_driver = driver;
+    drivers[i] = driver;
 
-==========================================================================*/
+done:
+    HL_UNLOCK_FILES();
+    return ret_value;
+} /* Hregisterdriver */
 
 /*--------------------------------------------------------------------------
- NAME
-    HIstart
- PURPOSE
-    Global and H-level initialization routine
- USAGE
-    intn HIstart()
- RETURNS
-    Returns SUCCEED/FAIL
- DESCRIPTION
-    Register the global shut-down routine (HPend) for call with atexit
- GLOBAL VARIABLES
- COMMENTS, BUGS, ASSUMPTIONS
- EXAMPLES
- REVISION LOG
+NAME
+   Hsetstreaming -- write the files created next strictly in order
+USAGE
+   intn Hsetstreaming(window)
+           int32 window;             IN: # of bytes kept before being written
+                                         out, 0 to write files as usual
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
+DESCRIPTION
+   The files created next, by Hopen() or SDstart(), are written out in
+   order of their offsets, each byte once, so that they can be sent to
+   an output that cannot seek back, such as a multipart upload to an
+   object store through a driver, see Hregisterdriver().  The last
+   'window' bytes written are kept in memory, where they may still
+   change; writing or reading the bytes written out before them fails.
+   The DD blocks after the first are placed at the end of the file when
+   it is closed, after the data and the metadata written by SDend(), the
+   first DD block pointing to them.
+
+   The head of the file, its magic number and first DD block, is only
+   known then: it is written last, at offset 0, with one write.  The
+   output must take that write after the others, as a multipart upload
+   does with its first part; a pipe cannot.  Elements are to be written
+   whole, one after the other: an element that grows once the window
+   has moved past it, such as a linked block element, fails, and so do
+   the compactions on close, see Hsetcompact().  The setting does not
+   apply to the files opened that exist.
 --------------------------------------------------------------------------*/
-static intn
-HIstart(void)
+intn
+Hsetstreaming(int32 window)
 {
     intn ret_value = SUCCEED;
 
-    /* Don't call this routine again... */
-    library_terminate = TRUE;
+    HEclear();
+    HL_LOCK_FILES();
 
-    /* Install atexit() library cleanup routine
-     *
-     * In the past, this had problems with Solaris + gcc
-     *
-     * XXX: Check to see if this is true with modern Solaris
-     */
-#if !(defined(__sun) && defined(__GNUC__))
-    if (install_atexit == TRUE)
-        if (atexit(&HPend) != 0)
-            HGOTO_ERROR(DFE_CANTINIT, FAIL);
-#endif
+    if (window < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    default_stream = window;
 
-    /* Create the file ID and access ID groups */
-    if (HAinit_group(FIDGROUP, 64) == FAIL)
-        HGOTO_ERROR(DFE_INTERNAL, FAIL);
-    if (HAinit_group(AIDGROUP, 256) == FAIL)
-        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+done:
+    HL_UNLOCK_FILES();
+    return ret_value;
+} /* Hsetstreaming */
 
-    if (cleanup_list == NULL) {
-        /* allocate list to hold terminateion fcns */
-        if ((cleanup_list = malloc(sizeof(Generic_list))) == NULL)
-            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+/*--------------------------------------------------------------------------
+NAME
+   Hsetmaxdescriptors -- set the # of descriptors kept by the open files
+USAGE
+   intn Hsetmaxdescriptors(max_fds)
+           intn max_fds;             IN: # of descriptors, 0 for no limit
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
+DESCRIPTION
+   Any number of files can be kept open with the built-in file access:
+   only the most recently used max_fds of them hold a file descriptor.
+   The least recently used ones are flushed and their descriptors closed,
+   to be reopened by path when they are next read or written.  The
+   default is MAX_OPEN_DESCRIPTORS (512).  Whatever the limit, the
+   descriptors of other files are also given back when the system runs
+   out of them.  Files opened through a driver hold no descriptor.
+--------------------------------------------------------------------------*/
+intn
+Hsetmaxdescriptors(intn max_fds)
+{
+    intn ret_value = SUCCEED;
 
-        /* initialize list */
-        if (HDGLinitialize_list(cleanup_list) == FAIL)
-            HGOTO_ERROR(DFE_INTERNAL, FAIL);
-    }
+    HEclear();
+    if (max_fds < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    HL_LOCK_LIBRARY();
+    fd_max = max_fds;
+    while (fd_max > 0 && fd_count > fd_max && HIfd_park(NULL))
+        ;
+    HL_UNLOCK_LIBRARY();
 
 done:
     return ret_value;
-} /* end HIstart() */
+} /* Hsetmaxdescriptors */
 
 /*--------------------------------------------------------------------------
- NAME
-    HPregister_term_func
- PURPOSE
-    Registers a termination function in the list of routines to call during
-    atexit() termination.
- USAGE
-    intn HPregister_term_func(term_func)
-        intn (*term_func)();           IN: function to call during axexit()
- RETURNS
-    Returns SUCCEED/FAIL
- DESCRIPTION
-    Adds routines to the linked-list of routines to call when terminating the
-    library.
- GLOBAL VARIABLES
- COMMENTS, BUGS, ASSUMPTIONS
-    Should only ever be called by the "atexit" function, or real power-users.
- EXAMPLES
- REVISION LOG
+NAME
+   Hsetkeepopen -- set the # of closed files kept open
+USAGE
+   intn Hsetkeepopen(nfiles)
+           intn nfiles;              IN: # of files, 0 to keep none
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
+DESCRIPTION
+   The single-file interfaces (DFSD, DFR8, DF24, DFGR) open and close
+   their file on every call.  The files they read are kept open, with
+   their DD list loaded, after their last close, so that a loop over the
+   datasets or slices of a file does not read the file's DD list on
+   every call.  A file kept open is opened again from disk when it has
+   changed since, and closed when opened for writing.  Up to nfiles files
+   are kept open, KEEP_OPEN_FILES (4) by default, the file closed the
+   longest ago being closed for good when over the limit.
+   Hsetkeepopen(0) closes them all, which is needed before replacing or
+   removing them on systems that cannot remove open files.
 --------------------------------------------------------------------------*/
 intn
-HPregister_term_func(hdf_termfunc_t term_func)
+Hsetkeepopen(intn nfiles)
 {
     intn ret_value = SUCCEED;
-    if (library_terminate == FALSE)
-        if (HIstart() == FAIL)
-            HGOTO_ERROR(DFE_CANTINIT, FAIL);
 
-    if (HDGLadd_to_list(*cleanup_list, (void *)term_func) == FAIL)
-        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    HEclear();
+    if (nfiles < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    HL_LOCK_FILES();
+    kept_max = nfiles;
+    HIkept_trim();
+    HL_UNLOCK_FILES();
 
 done:
     return ret_value;
-} /* end HPregister_term_func() */
+} /* Hsetkeepopen */
 
 /*--------------------------------------------------------------------------
- NAME
-    HPend
- PURPOSE
-    Terminate various static buffers and shutdown the library.
- USAGE
-    intn HPend()
- RETURNS
-    Returns SUCCEED/FAIL
- DESCRIPTION
-    Walk through the shutdown routines for the various interfaces and
-    terminate them all.
- GLOBAL VARIABLES
- COMMENTS, BUGS, ASSUMPTIONS
-    Should only ever be called by the "atexit" function, or real power-users.
- EXAMPLES
- REVISION LOG
+NAME
+   Hwriteindex -- write the sidecar index of a file
+USAGE
+   intn Hwriteindex(file_id, max_len)
+           int32 file_id;            IN: id of file
+           int32 max_len;            IN: length of the longest element to index,
+                                         0 for HIDX_DEF_MAX_LEN
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
+DESCRIPTION
+   Writes the sidecar index of the file, under the name of the file
+   followed by HIDX_SUFFIX.  The index holds the offset, length and
+   contents of the magic number, of the DD blocks and of every element of
+   at most max_len bytes: the vgroups, vdata headers and records,
+   attributes, special element headers and chunk tables, along with any
+   small data elements.  Files opened read-only with Hreadindex() on read
+   all of these from the index, in one read, and only the larger data
+   elements from the file.
+   The index describes the file as it is when it is written, and must be
+   written again whenever the file changes.  An index whose file has
+   changed length is ignored.  Indexes go to the directory set with
+   Hsetindexcache(), if any.
+COMMENTS, BUGS, ASSUMPTIONS
+   The index starts with HIDX_MAGIC and three 32-bit integers: the version
+   HIDX_VERSION, the length of the file and the # of extents.  The offset
+   and length of each extent follow as 32-bit integers, by offset, then
+   the contents of the extents.  All integers are big-endian.
 --------------------------------------------------------------------------*/
-void
-HPend(void)
+intn
+Hwriteindex(int32 file_id, int32 max_len)
 {
-    hdf_termfunc_t term_func; /* pointer to a termination routine for an interface */
+    filerec_t *file_rec; /* file record */
+    filerec_t *locked    = NULL;
+    intn       ret_value = SUCCEED;
 
-    /* Shutdown the file ID atom group */
-    HAdestroy_group(FIDGROUP);
+    HEclear();
 
-    /* Shutdown the access ID atom group */
-    HAdestroy_group(AIDGROUP);
+    if (max_len < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (max_len == 0)
+        max_len = HIDX_DEF_MAX_LEN;
 
-    if ((term_func = (hdf_termfunc_t)HDGLfirst_in_list(*cleanup_list)) != NULL) {
-        do {
-            (*term_func)();
-        } while ((term_func = (hdf_termfunc_t)HDGLnext_in_list(*cleanup_list)) != NULL);
-    } /* end if */
+    /* check validity of file record */
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    locked = HL_LOCK_FILE(file_rec);
 
-    /* can't issue errors if you're free'ing the error stack. */
-    HDGLdestroy_list(cleanup_list); /* clear the list of interface cleanup routines */
-    /* free allocated list struct */
-    free(cleanup_list);
-    /* re-initialize */
-    cleanup_list = NULL;
+    /* The index is taken from the file, so put the DD list there first */
+    if ((file_rec->access & DFACC_WRITE) && HIsync(file_rec) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (HIwrite_index(file_rec, max_len) == FAIL)
+        HGOTO_DONE(FAIL);
 
-    HPbitshutdown();
-    HXPshutdown();
-    Hshutdown();
-    HEshutdown();
-    HAshutdown();
-    tbbt_shutdown();
-} /* end HPend() */
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* Hwriteindex */
 
 /*--------------------------------------------------------------------------
 NAME
-   HIextend_file -- extend file to current length
+   Hreadindex -- set reads from the sidecar index of a read-only file
 USAGE
-   int HIextend_file(file_rec)
-           filerec_t  * file_rec        IN: pointer to file structure to extend
+   intn Hreadindex(file_id,index_on)
+           int32 file_id;            IN: id of file
+           intn index_on;            IN: whether to read from the index or not
 RETURNS
-   SUCCEED / FAIL
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
 DESCRIPTION
-   The routine extends an HDF file to be the length on the f_end_off
-   member of the file_rec.  This is mainly written as a function so that
-   the functionality is localized.
+   Set/reset reads from the sidecar index, see Hwriteindex(), of an HDF
+   file opened read-only.  The index is loaded in one read, and what it
+   holds is copied out of memory instead of being read from the file.
+   If file_id is set to CACHE_ALL_FILES, then the value of index_on is
+   used to modify the default state for all further files Hopen'ed with
+   DFACC_READ; the DD list and the metadata are then read from the index
+   when the file is opened.  A file without a valid index is read as
+   usual.  The default is not to read from indexes.
+   With a file id the index is loaded for the reads to come; this fails
+   if the file is open for writing or has no valid index.
 --------------------------------------------------------------------------*/
-static intn
-HIextend_file(filerec_t *file_rec)
+intn
+Hreadindex(int32 file_id, intn index_on)
 {
-    uint8 temp      = 0;
-    intn  ret_value = SUCCEED;
+    filerec_t *file_rec; /* file record */
+    filerec_t *locked    = NULL;
+    intn       ret_value = SUCCEED;
 
-    if (HPseek(file_rec, file_rec->f_end_off) == FAIL)
-        HGOTO_ERROR(DFE_SEEKERROR, FAIL);
-    if (HP_write(file_rec, &temp, 1) == FAIL)
-        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    HEclear();
+
+    if (file_id == CACHE_ALL_FILES) /* check whether to modify the default */
+    {                               /* set the default for all further files Hopen'ed */
+        default_index = (index_on != 0 ? TRUE : FALSE);
+    } /* end if */
+    else {
+        /* check validity of file record */
+        file_rec = HAatom_object(file_id);
+        if (BADFREC(file_rec))
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+        locked = HL_LOCK_FILE(file_rec);
+
+        if (index_on) {
+            if (file_rec->access & DFACC_WRITE)
+                HGOTO_ERROR(DFE_DENIED, FAIL);
+            if (file_rec->idx == NULL && HIopen_index(file_rec) == FAIL)
+                HGOTO_ERROR(DFE_BADOPEN, FAIL);
+        } /* end if */
+        else
+            HIclose_index(file_rec);
+    } /* end else */
 
 done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
-} /* HIextend_file */
+} /* Hreadindex */
 
 /*--------------------------------------------------------------------------
 NAME
-   HIget_function_table -- create special function table
+   Hsetindexcache -- set where sidecar indexes are kept and write missing ones
 USAGE
-   int HIget_func_table(access_rec)
-   accrec_t * access_rec;     IN: access record we are working on
+   intn Hsetindexcache(dir, write_missing)
+           const char *dir;          IN: directory of the indexes, NULL for
+                                         next to their files
+           intn write_missing;       IN: whether to write missing indexes
 RETURNS
-   NULL no matter what (seems odd....)
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
 DESCRIPTION
-   Set up the table of special functions for a given special element
-
+   Lets the processes of a node that read the same files share their
+   metadata.  With a directory, the sidecar indexes, see Hwriteindex(),
+   are written to and read from it instead of next to their files, e.g.
+   a node-local memory file system when the files are on a read-only
+   archive.  An index there is named after the base name of its file and
+   the stamp of the file's modification time, length, serial number and
+   device, so that a file replaced or changed gets a new one.
+   With write_missing TRUE, a file opened read-only while reads from
+   indexes are on by default, see Hreadindex(CACHE_ALL_FILES, TRUE), and
+   without a valid index gets one written when it is opened; the other
+   processes opening it then read its DD list, vgroups, vdata headers,
+   attributes and chunk tables from the index instead of from the file.
+   Indexes are written under a temporary name and renamed, and are mapped
+   read-only where mmap() is available, so that all the processes reading
+   a file share one copy of its index.
+   The setting applies to the files opened afterwards.
 --------------------------------------------------------------------------*/
-static funclist_t *
-HIget_function_table(accrec_t *access_rec)
+intn
+Hsetindexcache(const char *dir, intn write_missing)
 {
-    filerec_t  *file_rec; /* file record */
-    int16       spec_code;
-    uint8       lbuf[4];          /* temporary buffer */
-    uint8      *p;                /* tmp buf ptr */
-    int32       data_off;         /* offset of the data we are checking */
-    int         i;                /* loop index */
-    funclist_t *ret_value = NULL; /* FAIL */
-
-    /* read in the special code in the special elt */
-    file_rec = HAatom_object(access_rec->file_id);
+    char *new_dir   = NULL;
+    intn  ret_value = SUCCEED;
 
-    /* get the offset and length of the dataset */
-    if (HTPinquire(access_rec->ddid, NULL, NULL, &data_off, NULL) == FAIL)
-        HGOTO_ERROR(DFE_INTERNAL, NULL);
+    HEclear();
 
-    if (HPseek(file_rec, data_off) == FAIL)
-        HGOTO_ERROR(DFE_SEEKERROR, NULL);
-    if (HP_read(file_rec, lbuf, (int)2) == FAIL)
-        HGOTO_ERROR(DFE_READERROR, NULL);
+    if (dir != NULL && *dir == '\0')
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (dir != NULL && (new_dir = strdup(dir)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
-    /* using special code, look up function table in associative table */
-    p = &lbuf[0];
-    INT16DECODE(p, spec_code);
-    access_rec->special = (intn)spec_code;
-    for (i = 0; functab[i].key != 0; i++) {
-        if (access_rec->special == functab[i].key) {
-            ret_value = functab[i].tab;
-            break; /* break out of loop */
-        }
-    }
+    HL_LOCK_FILES();
+    free(index_dir);
+    index_dir   = new_dir;
+    index_write = (write_missing != 0 ? TRUE : FALSE);
+    HL_UNLOCK_FILES();
 
 done:
     return ret_value;
-} /* HIget_function_table */
+} /* Hsetindexcache */
 
 /*--------------------------------------------------------------------------
 NAME
-   HIgetspinfo -- return special info
+   Hsetcompact -- set compaction of linked block elements on close
 USAGE
-   int HIgetspinfo(access_rec, tag, ref)
-   accrec_t * access_rec;     IN: access record we are working on
-   int16      tag;            IN: tag to look for
-   int16      ref;            IN: ref to look for
+   intn Hsetcompact(file_id,compact_on)
+           int32 file_id;            IN: id of file
+           intn compact_on;          IN: whether to compact on close or not
 RETURNS
-   special_info field or NULL if not found
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
 DESCRIPTION
-   given the tag and ref of a given element return the special
-   info field of the access element.
-
-   Basically, this function checks if any other AIDs in the file
-   have read in the special information for this object.  If so,
-   this special information will be reused.  Otherwise, the
-   special element handling code needs to read in the information
-   from disk
-GLOBALS
-   Reads from the global access_records
-
+   When set, the last Hclose() of the file rewrites every linked block
+   element of the file as one contiguous element with HLcompact(), so
+   that data appended in many small pieces can be read back
+   sequentially.  The file must be open for writing.
 --------------------------------------------------------------------------*/
-void *
-HIgetspinfo(accrec_t *access_rec)
+intn
+Hsetcompact(int32 file_id, intn compact_on)
 {
-    void *ret_value = NULL; /* FAIL */
+    filerec_t *file_rec; /* file record */
+    filerec_t *locked    = NULL;
+    intn       ret_value = SUCCEED;
 
-    if ((ret_value = HAsearch_atom(AIDGROUP, HPcompare_accrec_tagref, access_rec)) != NULL)
-        HGOTO_DONE(((accrec_t *)ret_value)->special_info);
+    HEclear();
+
+    /* check validity of file record */
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    locked = HL_LOCK_FILE(file_rec);
+
+    if (compact_on && !(file_rec->access & DFACC_WRITE))
+        HGOTO_ERROR(DFE_BADACC, FAIL);
+
+    file_rec->compact = (compact_on != 0 ? TRUE : FALSE);
 
 done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
-} /* HIgetspinfo */
+} /* Hsetcompact */
 
 /*--------------------------------------------------------------------------
-HIunlock -- unlock a previously locked file record
---------------------------------------------------------------------------*/
-static int
-HIunlock(filerec_t *file_rec)
+NAME
+   Hsetcompactdd -- set compaction of the DD list on close
+USAGE
+   intn Hsetcompactdd(file_id,compact_on)
+           int32 file_id;            IN: id of file
+           intn compact_on;          IN: whether to compact on close or not
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
+DESCRIPTION
+   When set, the last Hclose() of the file rewrites the DD list with
+   Hcompactdd(), after the linked block elements are compacted if
+   Hsetcompact() is set, so that the empty DDs left by the elements
+   deleted are not read at each open.  The file must be open for writing.
+--------------------------------------------------------------------------*/
+intn
+Hsetcompactdd(int32 file_id, intn compact_on)
 {
-    /* unlock the file record */
-    file_rec->attach--;
+    filerec_t *file_rec; /* file record */
+    filerec_t *locked    = NULL;
+    intn       ret_value = SUCCEED;
 
-    return SUCCEED;
+    HEclear();
+
+    /* check validity of file record */
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    locked = HL_LOCK_FILE(file_rec);
+
+    if (compact_on && !(file_rec->access & DFACC_WRITE))
+        HGOTO_ERROR(DFE_BADACC, FAIL);
+
+    file_rec->compact_dd = (compact_on != 0 ? TRUE : FALSE);
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* Hsetcompactdd */
+
+/*--------------------------------------------------------------------------
+NAME
+   Hsetalignment -- set the alignment of the data elements of a file
+USAGE
+   intn Hsetalignment(file_id, threshold, alignment)
+           int32 file_id;            IN: id of file
+           int32 threshold;          IN: length from which elements are aligned
+           int32 alignment;          IN: alignment in bytes, 0 or 1 for none
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
+DESCRIPTION
+   Elements written from now on that are at least threshold bytes long
+   start at an offset that is a multiple of alignment, so that each can
+   be read with one aligned request; an element that grows, like
+   compressed data, is moved to an aligned block when it reaches the
+   threshold.  The space skipped before an aligned element is left
+   unused.  Smaller elements still go to unused space of the file, see
+   Hreservespace(), and are moved rather than converted to linked blocks
+   when they grow.  The setting lasts until the file is closed.
+--------------------------------------------------------------------------*/
+intn
+Hsetalignment(int32 file_id, int32 threshold, int32 alignment)
+{
+    filerec_t *file_rec; /* file record */
+    filerec_t *locked    = NULL;
+    intn       ret_value = SUCCEED;
+
+    HEclear();
+
+    if (threshold < 0 || alignment < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* check validity of file record */
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    locked = HL_LOCK_FILE(file_rec);
+
+    if (alignment > 1 && !(file_rec->access & DFACC_WRITE))
+        HGOTO_ERROR(DFE_BADACC, FAIL);
+
+    file_rec->align_threshold = threshold;
+    file_rec->alignment       = (alignment > 1 ? alignment : 0);
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* Hsetalignment */
+
+/*--------------------------------------------------------------------------
+NAME
+   Hreservespace -- reserve space for the small elements of a file
+USAGE
+   intn Hreservespace(file_id, size)
+           int32 file_id;            IN: id of file
+           int32 size;               IN: number of bytes to reserve
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
+DESCRIPTION
+   Appends size bytes to the file as unused space, which HPgetdiskblock()
+   hands out to the elements written later that are not aligned, see
+   Hsetalignment().  With an alignment set, the space is made longer to
+   end where the next aligned element would start.  Called on a new file,
+   this keeps the DD blocks, vgroups, attributes and other small elements
+   together at the front.  What is not used by the time the file is
+   closed is left empty, or left out when no element follows it.
+--------------------------------------------------------------------------*/
+intn
+Hreservespace(int32 file_id, int32 size)
+{
+    filerec_t *file_rec; /* file record */
+#ifndef DISKBLOCK_DEBUG
+    hfile_free_t *ext;
+#endif /* DISKBLOCK_DEBUG */
+    filerec_t *locked    = NULL;
+    intn       ret_value = SUCCEED;
+
+    HEclear();
+
+    if (size <= 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* check validity of file record */
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    locked = HL_LOCK_FILE(file_rec);
+
+    if (!(file_rec->access & DFACC_WRITE))
+        HGOTO_ERROR(DFE_BADACC, FAIL);
+
+#ifndef DISKBLOCK_DEBUG
+    if (file_rec->alignment > 0 && size <= MAX_FILE_OFFSET - file_rec->f_end_off - file_rec->alignment &&
+        (file_rec->f_end_off + size) % file_rec->alignment != 0)
+        size += file_rec->alignment - (file_rec->f_end_off + size) % file_rec->alignment;
+    if (size > MAX_FILE_OFFSET - file_rec->f_end_off)
+        HGOTO_ERROR(DFE_BADLEN, FAIL);
+
+    /* record the space as an unused extent, HPfreediskblock() would move
+       the end of the file back instead */
+    if ((ext = (hfile_free_t *)malloc(sizeof(hfile_free_t))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    ext->offset = file_rec->f_end_off;
+    ext->length = size;
+    if (HIfree_insert(file_rec, ext) == FAIL) {
+        free(ext);
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    } /* end if */
+
+    /* the file itself only grows once the space is written or passed, see
+       HIgetendblock() */
+    file_rec->f_end_off += size;
+#endif /* DISKBLOCK_DEBUG */
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* Hreservespace */
+
+/*--------------------------------------------------------------------------
+NAME
+   HDvalidfid -- check if a file ID is valid
+USAGE
+   int HDvalidfid(file_id)
+   int32 file_id;            IN: id of file
+RETURNS
+   returns TRUE if valid ID else FALSE
+DESCRIPTION
+   Determine whether a given int32 is a valid HDF file ID or not
+
+--------------------------------------------------------------------------*/
+intn
+HDvalidfid(int32 file_id)
+{
+    filerec_t *file_rec;
+    intn       ret_value = TRUE;
+
+    /* convert file id to file rec and check for validity */
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec))
+        ret_value = FALSE;
+
+    return ret_value;
+} /* HDvalidfid */
+
+/*--------------------------------------------------------------------------
+HDerr --  Closes a file and return FAIL.
+           Replacement for DFIerr in HDF3.1 and before
+--------------------------------------------------------------------------*/
+int
+HDerr(int32 file_id)
+{
+    Hclose(file_id);
+    return FAIL;
 }
 
-/* ------------------------- SPECIAL TAG ROUTINES ------------------------- */
-/*
-   The HDF tag space is divided as follows based on the 2 highest bits:
-   00: Library reserved ordinary tags
-   01: Library reserved special tags
-   10, 11: User tags.
+/*--------------------------------------------------------------------------
+NAME
+   Hsetacceesstype -- set the I/O access type (serial, parallel, ...)
+                                          of a data element
+USAGE
+   intn Hsetacceesstype(access_id, accesstype)
+   int32 access_id;        IN: id of access element
+   uintn accesstype;       IN: I/O access type
+RETURNS
+   returns FAIL (-1) if fail, SUCCEED (0) otherwise.
+DESCRIPTION
+   Set the type of I/O for accessing the data element to
+   accesstype.
 
-   It is relatively cheap to operate with special tags within the library
-   reserved tags range.  For users to specify special tags and their
-   corresponding ordinary tag, the pair has to be added to the
-   special_table.
+--------------------------------------------------------------------------*/
+intn
+Hsetaccesstype(int32 access_id, uintn accesstype)
+{
+    accrec_t *access_rec; /* access record */
+    intn      ret_value = SUCCEED;
 
-   The special_table contains pairs of each tag and its corresponding
-   special tag.  The same table is also used to determine if a tag is
-   special.  Add to this table any additional tag/special_tag pairs
-   that might be necessary.
+    /* clear error stack and check validity of this access id */
+    HEclear();
 
- */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == (accrec_t *)NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (accesstype != DFACC_DEFAULT && accesstype != DFACC_SERIAL && accesstype != DFACC_PARALLEL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
 
-/*
-   The functionality of these routines is covered by the SPECIALTAG,
-   MKSPECIALTAG and BASETAG macros
- */
+    if (accesstype == access_rec->access_type)
+        goto done;
 
-#ifdef SPECIAL_TABLE
+    /* kludge mode on */
+    if (accesstype != DFACC_PARALLEL) /* go to PARALLEL only */
+    {
+        ret_value = FAIL;
+        goto done;
+    }
+    /* if special elt, call special function */
+    if (access_rec->special)
+        ret_value = HXPsetaccesstype(access_rec);
 
-typedef struct special_table_t {
-    uint16 tag;
-    uint16 special_tag;
-} special_table_t;
+done:
+    return ret_value;
+} /* Hsetacceesstype() */
 
-static special_table_t special_table[] = {
-    {0x8010, 0x4000 | 0x8010}, /* dummy */
-};
+/*--------------------------------------------------------------------------
+NAME
+   Hsetsievebuf -- set the size of the sieve buffer of a data element
+USAGE
+   intn Hsetsievebuf(access_id, size)
+   int32 access_id;        IN: id of access element
+   int32 size;             IN: size of the sieve buffer in bytes, 0 for none
+RETURNS
+   returns FAIL (-1) if fail, SUCCEED (0) otherwise.
+DESCRIPTION
+   With a sieve buffer, an Hread() of fewer than 'size' bytes of a plain
+   data element (not a special element) that is not within the bytes
+   last read into the buffer reads 'size' bytes, or up to the end of the
+   element, into the buffer and copies the data from there.  Reads of
+   nearby data are then served from memory.  Special elements are left
+   alone.  Hwrite() and Htrunc() on
+   the access element empty the buffer; writes through other access
+   elements to the same data element are not seen, so the buffer should
+   only be used when the data is not changed meanwhile.
 
-#define SP_TAB_SZ (sizeof(special_table) / sizeof(special_table[0]))
+--------------------------------------------------------------------------*/
+intn
+Hsetsievebuf(int32 access_id, int32 size)
+{
+    accrec_t  *access_rec; /* access record */
+    void      *buf       = NULL;
+    filerec_t *locked    = NULL;
+    intn       ret_value = SUCCEED;
+
+    /* clear error stack and check validity of this access id */
+    HEclear();
+    locked = HL_LOCK_AID(access_id);
+
+    access_rec = HAatom_object(access_id);
+    if (access_rec == (accrec_t *)NULL || size < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* special elements do their own I/O */
+    if (access_rec->special)
+        HGOTO_DONE(SUCCEED);
+
+    if (size > 0 && (buf = malloc((size_t)size)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    free(access_rec->sieve_buf);
+    access_rec->sieve_buf  = buf;
+    access_rec->sieve_size = size;
+    access_rec->sieve_posn = 0;
+    access_rec->sieve_len  = 0;
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* Hsetsievebuf() */
 
 /*--------------------------------------------------------------------------
+NAME
+   Hprefetch -- announce reads of parts of a data element
+USAGE
+   intn Hprefetch(access_id, nruns, offsets, lengths)
+   int32 access_id;        IN: id of access element
+   int32 nruns;            IN: number of runs of bytes
+   const int32 *offsets;   IN: offset in the element of each run
+   const int32 *lengths;   IN: number of bytes of each run
+RETURNS
+   returns FAIL (-1) if fail, SUCCEED (0) otherwise.
+DESCRIPTION
+   Tells the system, with HPwillneed(), that the file blocks holding the
+   'nruns' runs of bytes of the element will be read soon, so that they
+   are read from disk in the background and a later Hread() of them
+   finds them in memory.  Nothing is read or decoded here.  The chunks
+   of a chunked element that the runs touch are announced whole, unless
+   they are cached or were never written; all the blocks of a compressed
+   element are announced, its bytes being decoded from the start.
+   Elements in external files are left alone.
+
 --------------------------------------------------------------------------*/
-uint16
-HDmake_special_tag(uint16 tag)
+intn
+Hprefetch(int32 access_id, int32 nruns, const int32 *offsets, const int32 *lengths)
 {
-    int    i;
-    uint16 ret_value = DFTAG_NULL; /* FAIL */
+    accrec_t  *access_rec;             /* access record */
+    filerec_t *file_rec;               /* file record */
+    uint16     tag, ref;               /* the element */
+    int32     *blk_offsets = NULL;     /* file offset of each block */
+    int32     *blk_lengths = NULL;     /* length of each block */
+    intn       nblocks;                /* number of blocks of the element */
+    int32      blk_start;              /* element offset of the current block */
+    int32      lo, hi;                 /* part of the run in the current block */
+    int32      r;
+    intn       b;
+    filerec_t *locked    = NULL;
+    intn       ret_value = SUCCEED;
+
+    /* clear error stack and check validity of this access id */
+    HEclear();
+    locked = HL_LOCK_AID(access_id);
+
+    access_rec = HAatom_object(access_id);
+    if (access_rec == (accrec_t *)NULL || nruns < 0 || (nruns > 0 && (offsets == NULL || lengths == NULL)))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    file_rec = HAatom_object(access_rec->file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    if (access_rec->special == SPECIAL_CHUNKED) {
+        ret_value = HMCPprefetch(access_rec, nruns, offsets, lengths);
+        HGOTO_DONE(ret_value);
+    }
+    if (access_rec->special != 0 && access_rec->special != SPECIAL_LINKED &&
+        access_rec->special != SPECIAL_COMP)
+        HGOTO_DONE(SUCCEED);
+
+    if (HTPinquire(access_rec->ddid, &tag, &ref, NULL, NULL) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if ((nblocks = HDgetdatainfo(access_rec->file_id, tag, ref, NULL, 0, 0, NULL, NULL)) <= 0)
+        HGOTO_DONE(nblocks == FAIL ? FAIL : SUCCEED);
+    if ((blk_offsets = (int32 *)malloc((size_t)nblocks * sizeof(int32))) == NULL ||
+        (blk_lengths = (int32 *)malloc((size_t)nblocks * sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if (HDgetdatainfo(access_rec->file_id, tag, ref, NULL, 0, (uintn)nblocks, blk_offsets, blk_lengths) !=
+        nblocks)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    if (access_rec->special == SPECIAL_COMP) {
+        for (b = 0; b < nblocks; b++)
+            HPwillneed(file_rec, blk_offsets[b], blk_lengths[b]);
+        HGOTO_DONE(SUCCEED);
+    }
+
+    /* the part of each run in each block */
+    for (r = 0; r < nruns; r++)
+        for (b = 0, blk_start = 0; b < nblocks && blk_start < offsets[r] + lengths[r];
+             blk_start += blk_lengths[b++]) {
+            lo = MAX(offsets[r], blk_start);
+            hi = MIN(offsets[r] + lengths[r], blk_start + blk_lengths[b]);
+            if (lo < hi)
+                HPwillneed(file_rec, blk_offsets[b] + (lo - blk_start), hi - lo);
+        }
+
+done:
+    free(blk_offsets);
+    free(blk_lengths);
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* Hprefetch() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HDdont_atexit
+ PURPOSE
+    Indicates to the library that an 'atexit()' routine is _not_ to be installed
+ USAGE
+    intn HDdont_atexit(void)
+ RETURNS
+    Returns SUCCEED/FAIL
+ DESCRIPTION
+        This routine indicates to the library that an 'atexit()' cleanip routine
+    should not be installed.  The major (only?) purpose for this is in
+    situations where the library is dynamically linked into an application and
+    is un-linked from the application before 'exit()' gets called.  In those
+    situations, a routine installed with 'atexit()' would jump to a routine
+    which was no longer in memory, causing errors.
+        In order to be effective, this routine _must_ be called before any other
+    HDF function calls, and must be called each time the library is loaded/
+    linked into the application. (the first time and after it's been un-loaded)
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+    If this routine is used, certain memory buffers will not be de-allocated,
+    although in theory a user could call HPend on their own...
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+intn
+HDdont_atexit(void)
+{
+    intn ret_value = SUCCEED;
+
+    if (install_atexit == TRUE)
+        install_atexit = FALSE;
+
+    return ret_value;
+} /* end HDdont_atexit() */
+
+/*==========================================================================
+
+Internal Routines
+
+==========================================================================*/
+
+/*--------------------------------------------------------------------------
+ NAME
+    HIstart
+ PURPOSE
+    Global and H-level initialization routine
+ USAGE
+    intn HIstart()
+ RETURNS
+    Returns SUCCEED/FAIL
+ DESCRIPTION
+    Register the global shut-down routine (HPend) for call with atexit
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+static intn
+HIstart(void)
+{
+    intn ret_value = SUCCEED;
+
+    /* Don't call this routine again... */
+    HL_LOCK_LIBRARY();
+    if (library_terminate == TRUE)
+        HGOTO_DONE(SUCCEED); /* another thread got here first */
+    library_terminate = TRUE;
+
+    /* Install atexit() library cleanup routine
+     *
+     * In the past, this had problems with Solaris + gcc
+     *
+     * XXX: Check to see if this is true with modern Solaris
+     */
+#if !(defined(__sun) && defined(__GNUC__))
+    if (install_atexit == TRUE)
+        if (atexit(&HPend) != 0)
+            HGOTO_ERROR(DFE_CANTINIT, FAIL);
+#endif
+
+    /* Create the file ID and access ID groups */
+    if (HAinit_group(FIDGROUP, 64) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (HAinit_group(AIDGROUP, 256) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    if (cleanup_list == NULL) {
+        /* allocate list to hold terminateion fcns */
+        if ((cleanup_list = malloc(sizeof(Generic_list))) == NULL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+        /* initialize list */
+        if (HDGLinitialize_list(cleanup_list) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    }
+
+    /* Pick the number conversion routines for this processor */
+    DFKswap_init();
+
+    /* Read the settings given in the environment */
+    HIread_config();
+
+done:
+    HL_UNLOCK_LIBRARY();
+    return ret_value;
+} /* end HIstart() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HPregister_term_func
+ PURPOSE
+    Registers a termination function in the list of routines to call during
+    atexit() termination.
+ USAGE
+    intn HPregister_term_func(term_func)
+        intn (*term_func)();           IN: function to call during axexit()
+ RETURNS
+    Returns SUCCEED/FAIL
+ DESCRIPTION
+    Adds routines to the linked-list of routines to call when terminating the
+    library.
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+    Should only ever be called by the "atexit" function, or real power-users.
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+intn
+HPregister_term_func(hdf_termfunc_t term_func)
+{
+    intn ret_value = SUCCEED;
+
+    HL_LOCK_LIBRARY();
+    if (library_terminate == FALSE)
+        if (HIstart() == FAIL)
+            HGOTO_ERROR(DFE_CANTINIT, FAIL);
+
+    if (HDGLadd_to_list(*cleanup_list, (void *)term_func) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+done:
+    HL_UNLOCK_LIBRARY();
+    return ret_value;
+} /* end HPregister_term_func() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HPend
+ PURPOSE
+    Terminate various static buffers and shutdown the library.
+ USAGE
+    intn HPend()
+ RETURNS
+    Returns SUCCEED/FAIL
+ DESCRIPTION
+    Walk through the shutdown routines for the various interfaces and
+    terminate them all.
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+    Should only ever be called by the "atexit" function, or real power-users.
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+void
+HPend(void)
+{
+    hdf_termfunc_t term_func; /* pointer to a termination routine for an interface */
+
+    /* Shutdown the file ID atom group */
+    HAdestroy_group(FIDGROUP);
+
+    /* Shutdown the access ID atom group */
+    HAdestroy_group(AIDGROUP);
+
+    if ((term_func = (hdf_termfunc_t)HDGLfirst_in_list(*cleanup_list)) != NULL) {
+        do {
+            (*term_func)();
+        } while ((term_func = (hdf_termfunc_t)HDGLnext_in_list(*cleanup_list)) != NULL);
+    } /* end if */
+
+    /* can't issue errors if you're free'ing the error stack. */
+    HDGLdestroy_list(cleanup_list); /* clear the list of interface cleanup routines */
+    /* free allocated list struct */
+    free(cleanup_list);
+    /* re-initialize */
+    cleanup_list = NULL;
+
+    HPbitshutdown();
+    HXPshutdown();
+    Hshutdown();
+    HEshutdown();
+    HAshutdown();
+    tbbt_shutdown();
+} /* end HPend() */
+
+/*--------------------------------------------------------------------------
+NAME
+   HIextend_file -- extend file to current length
+USAGE
+   int HIextend_file(file_rec)
+           filerec_t  * file_rec        IN: pointer to file structure to extend
+RETURNS
+   SUCCEED / FAIL
+DESCRIPTION
+   The routine extends an HDF file to be the length on the f_end_off
+   member of the file_rec.  This is mainly written as a function so that
+   the functionality is localized.  Unused space at the end of the file,
+   see Hreservespace(), is not written.
+--------------------------------------------------------------------------*/
+static intn
+HIextend_file(filerec_t *file_rec)
+{
+#ifndef DISKBLOCK_DEBUG
+    TBBT_NODE    *node;
+    hfile_free_t *ext;
+#endif /* DISKBLOCK_DEBUG */
+    int32 end_off   = file_rec->f_end_off;
+    uint8 temp      = 0;
+    intn  ret_value = SUCCEED;
+
+#ifndef DISKBLOCK_DEBUG
+    if (file_rec->free_by_off != NULL &&
+        (node = tbbtlast((TBBT_NODE *)*(file_rec->free_by_off))) != NULL) {
+        ext = (hfile_free_t *)node->data;
+        if (ext->offset + ext->length == end_off)
+            end_off = ext->offset;
+    } /* end if */
+#endif /* DISKBLOCK_DEBUG */
+
+    if (HPseek(file_rec, end_off) == FAIL)
+        HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+    if (HP_write(file_rec, &temp, 1) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+done:
+    return ret_value;
+} /* HIextend_file */
+
+/*--------------------------------------------------------------------------
+NAME
+   HIget_function_table -- create special function table
+USAGE
+   int HIget_func_table(access_rec)
+   accrec_t * access_rec;     IN: access record we are working on
+RETURNS
+   NULL no matter what (seems odd....)
+DESCRIPTION
+   Set up the table of special functions for a given special element
+
+--------------------------------------------------------------------------*/
+static funclist_t *
+HIget_function_table(accrec_t *access_rec)
+{
+    int16       spec_code;
+    int         i;                /* loop index */
+    funclist_t *ret_value = NULL; /* FAIL */
+
+    /* get the special code in the special elt, read once per DD */
+    if (HTPspecial_code(access_rec->ddid, &spec_code) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, NULL);
+
+    /* using special code, look up function table in associative table */
+    access_rec->special = (intn)spec_code;
+    for (i = 0; functab[i].key != 0; i++) {
+        if (access_rec->special == functab[i].key) {
+            ret_value = functab[i].tab;
+            break; /* break out of loop */
+        }
+    }
+
+done:
+    return ret_value;
+} /* HIget_function_table */
+
+/*--------------------------------------------------------------------------
+NAME
+   HIgetspinfo -- return special info
+USAGE
+   int HIgetspinfo(access_rec, tag, ref)
+   accrec_t * access_rec;     IN: access record we are working on
+   int16      tag;            IN: tag to look for
+   int16      ref;            IN: ref to look for
+RETURNS
+   special_info field or NULL if not found
+DESCRIPTION
+   given the tag and ref of a given element return the special
+   info field of the access element.
+
+   Basically, this function checks if any other AIDs in the file
+   have read in the special information for this object.  If so,
+   this special information will be reused.  Otherwise, the
+   special element handling code needs to read in the information
+   from disk
+GLOBALS
+   Reads from the global access_records
+
+--------------------------------------------------------------------------*/
+void *
+HIgetspinfo(accrec_t *access_rec)
+{
+    void *ret_value = NULL; /* FAIL */
+
+    if ((ret_value = HAsearch_atom(AIDGROUP, HPcompare_accrec_tagref, access_rec)) != NULL)
+        HGOTO_DONE(((accrec_t *)ret_value)->special_info);
+
+done:
+    return ret_value;
+} /* HIgetspinfo */
+
+/*--------------------------------------------------------------------------
+HIunlock -- unlock a previously locked file record
+--------------------------------------------------------------------------*/
+static int
+HIunlock(filerec_t *file_rec)
+{
+    /* unlock the file record */
+    file_rec->attach--;
+
+    return SUCCEED;
+}
+
+/* ------------------------- SPECIAL TAG ROUTINES ------------------------- */
+/*
+   The HDF tag space is divided as follows based on the 2 highest bits:
+   00: Library reserved ordinary tags
+   01: Library reserved special tags
+   10, 11: User tags.
+
+   It is relatively cheap to operate with special tags within the library
+   reserved tags range.  For users to specify special tags and their
+   corresponding ordinary tag, the pair has to be added to the
+   special_table.
+
+   The special_table contains pairs of each tag and its corresponding
+   special tag.  The same table is also used to determine if a tag is
+   special.  Add to this table any additional tag/special_tag pairs
+   that might be necessary.
+
+ */
+
+/*
+   The functionality of these routines is covered by the SPECIALTAG,
+   MKSPECIALTAG and BASETAG macros
+ */
+
+#ifdef SPECIAL_TABLE
+
+typedef struct special_table_t {
+    uint16 tag;
+    uint16 special_tag;
+} special_table_t;
+
+static special_table_t special_table[] = {
+    {0x8010, 0x4000 | 0x8010}, /* dummy */
+};
+
+#define SP_TAB_SZ (sizeof(special_table) / sizeof(special_table[0]))
+
+/*--------------------------------------------------------------------------
+--------------------------------------------------------------------------*/
+uint16
+HDmake_special_tag(uint16 tag)
+{
+    int    i;
+    uint16 ret_value = DFTAG_NULL; /* FAIL */
+
+    if (~tag & 0x8000) {
+        ret_value = ((uint16)(tag | 0x4000));
+        goto done;
+    }
+
+    for (i = 0; i < SP_TAB_SZ; i++)
+        if (special_table[i].tag == tag) {
+            ret_value = (uint16)special_table[i].special_tag;
+            break;
+        }
+
+done:
+    return ret_value;
+}
+
+/*--------------------------------------------------------------------------
+--------------------------------------------------------------------------*/
+intn
+HDis_special_tag(uint16 tag)
+{
+    int  i;
+    intn ret_value = FALSE; /* FAIL */
+
+    if (~tag & 0x8000) {
+        ret_value = (tag & 0x4000) ? TRUE : FALSE;
+        goto done;
+    }
+
+    for (i = 0; i < SP_TAB_SZ; i++)
+        if (special_table[i].special_tag == tag) {
+            ret_value = TRUE;
+            break;
+        }
+
+done:
+    return ret_value;
+}
+
+/*--------------------------------------------------------------------------
+--------------------------------------------------------------------------*/
+uint16
+HDbase_tag(uint16 tag)
+{
+    int    i;
+    uint16 ret_value = tag;
+
+    if (~tag & 0x8000) {
+        ret_value = ((uint16)(tag & ~0x4000));
+        goto done;
+    }
+
+    for (i = 0; i < SP_TAB_SZ; i++)
+        if (special_table[i].special_tag == tag) {
+            ret_value = special_table[i].special_tag;
+            break;
+        }
+done:
+    return ret_value;
+}
+
+#endif /* SPECIAL_TABLE */
+
+/*--------------------------------------------------------------------------
+ NAME
+    Hgetlibversion -- return version info for current HDF library
+ USAGE
+    intn Hgetlibversion(majorv, minorv, release, string)
+    uint32 *majorv;     OUT: majorv version number
+    uint32 *minorv;     OUT: minorv version number
+    uint32 *release;    OUT: release number
+    char   string[];    OUT: informational text string (80 chars)
+ RETURNS
+    returns SUCCEED (0).
+ DESCRIPTION
+    Copies values from #defines in hfile.h to provided buffers. This
+        information is statistically compiled into the HDF library, so
+        it is not necessary to have any files open to get this information.
+
+--------------------------------------------------------------------------*/
+intn
+Hgetlibversion(uint32 *majorv, uint32 *minorv, uint32 *releasev, char *string)
+{
+    HEclear();
+
+    *majorv   = LIBVER_MAJOR;
+    *minorv   = LIBVER_MINOR;
+    *releasev = LIBVER_RELEASE;
+    HIstrncpy(string, LIBVER_STRING, LIBVSTR_LEN + 1);
+
+    return SUCCEED;
+} /* HDgetlibversion */
+
+/*--------------------------------------------------------------------------
+ NAME
+    Hgetfileversion -- return version info for HDF file
+ USAGE
+    intn Hgetfileversion(file_id, majorv, minorv, release, string)
+    int32 file_id;      IN: handle of file
+    uint32 *majorv;     OUT: majorv version number
+    uint32 *minorv;     OUT: minorv version number
+    uint32 *release;    OUT: release number
+    char *string;       OUT: informational text string (80 chars)
+ RETURNS
+    returns SUCCEED (0) if successful and FAIL (-1) if failed.
+ DESCRIPTION
+    Copies values from file_records[] structure for a given file to
+        provided buffers.
+ GLOBAL VARIABLES
+    Reads file_records[]
+
+--------------------------------------------------------------------------*/
+intn
+Hgetfileversion(int32 file_id, uint32 *majorv, uint32 *minorv, uint32 *release, char *string)
+{
+    filerec_t *file_rec;
+    intn       ret_value = SUCCEED;
+
+    HEclear();
+
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (majorv != NULL)
+        *majorv = file_rec->version.majorv;
+    if (minorv != NULL)
+        *minorv = file_rec->version.minorv;
+    if (release != NULL)
+        *release = file_rec->version.release;
+    if (string != NULL)
+        HIstrncpy(string, file_rec->version.string, LIBVSTR_LEN + 1);
+
+done:
+    return ret_value;
+} /* Hgetfileversion */
+
+/*--------------------------------------------------------------------------
+ NAME
+    Hgetstats -- return the I/O statistics of an HDF file
+ USAGE
+    intn Hgetstats(file_id, stats)
+    int32 file_id;          IN: handle of file
+    hdf_stats_t *stats;     OUT: the statistics of the file
+ RETURNS
+    returns SUCCEED (0) if successful and FAIL (-1) if failed.
+ DESCRIPTION
+    Copies the counters kept for the file since it was first opened: the
+    bytes read and written, the read, write and seek calls made to the
+    system, the DD lookups by tag and ref, and the bytes decoded by each
+    compression coder.  Reads of a mapped file count as bytes read but
+    not as read calls, and seeks that the file position made unnecessary
+    are not counted.  The counters wrap around at 2^32.
+
+    Every ID of the file shares the counters, which are kept whether
+    they are queried or not; the chunk cache of a chunked element has
+    its own counters, see HMCgetCacheStats().
+ GLOBAL VARIABLES
+    Reads file_records[]
+
+--------------------------------------------------------------------------*/
+intn
+Hgetstats(int32 file_id, hdf_stats_t *stats)
+{
+    filerec_t *file_rec;
+    filerec_t *locked    = NULL;
+    intn       ret_value = SUCCEED;
+
+    HEclear();
+
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec) || stats == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    locked = HL_LOCK_FILE(file_rec);
+
+    *stats = file_rec->stats;
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* Hgetstats */
+
+/*--------------------------------------------------------------------------
+ NAME
+    Hset_trace_callback -- set the callback the library reports its phases to
+ USAGE
+    intn Hset_trace_callback(func, user_data)
+    hdf_trace_func_t func;  IN: the callback, NULL to turn tracing off
+    void *user_data;        IN: pointer passed to every call of the callback
+ RETURNS
+    returns SUCCEED (0) if successful and FAIL (-1) if failed.
+ DESCRIPTION
+    From now on 'func' is called when one of the main phases of the
+    library begins and when it ends: opening a file, loading and flushing
+    its DD list, reading and writing bytes, bringing a chunk into the
+    chunk cache, decoding compressed data, converting numbers and reading
+    and flushing the SD metadata, see hdf_trace_op_t.  Phases nest, a
+    chunk being read and decoded while it is brought into the cache, and
+    the end of a phase is reported even when it fails.
+
+    The callback runs on the thread doing the work, possibly with a file
+    locked, so it must be quick and must not call the library; it is
+    meant to time the phases, e.g. to export them as spans.  Without a
+    callback, each phase costs a single test.  The callback is shared by
+    the whole process and should be set while no other thread uses the
+    library.
+ GLOBAL VARIABLES
+    Sets HPtrace_func and HPtrace_data
+
+--------------------------------------------------------------------------*/
+intn
+Hset_trace_callback(hdf_trace_func_t func, void *user_data)
+{
+    HPtrace_data = (func != NULL ? user_data : NULL);
+    HPtrace_func = func;
+
+    return SUCCEED;
+} /* Hset_trace_callback */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HIread_config -- read the settings of the library from the environment
+ USAGE
+    void HIread_config()
+ RETURNS
+    none
+ DESCRIPTION
+    Sets each setting whose environment variable holds a count that is
+    not negative, optionally followed by K, M or G for that many KB, MB
+    or GB.  Other values are ignored, leaving the setting as it was.
+
+--------------------------------------------------------------------------*/
+static void
+HIread_config(void)
+{
+    const char *value;
+    char       *end;
+    long long   n;
+    intn        i;
+
+    for (i = 0; i < HDF_CONFIG_NSETTINGS; i++) {
+        if ((value = getenv(config_env[i])) == NULL || *value == '\0')
+            continue;
+        n = strtoll(value, &end, 10);
+        switch (*end) {
+            case 'g':
+            case 'G':
+                n *= 1024;
+                /* FALLTHROUGH */
+            case 'm':
+            case 'M':
+                n *= 1024;
+                /* FALLTHROUGH */
+            case 'k':
+            case 'K':
+                n *= 1024;
+                end++;
+                break;
+            default:
+                break;
+        }
+        if (end != value && *end == '\0' && n >= 0 && n <= INT32_MAX)
+            config_values[i] = (int32)n;
+    }
+} /* HIread_config */
+
+/*--------------------------------------------------------------------------
+ NAME
+    Hsetconfig -- change a setting of the library
+ USAGE
+    int32 Hsetconfig(setting, value)
+    hdf_config_t setting;   IN: the setting
+    int32 value;            IN: its new value, 0 for the built-in default
+ RETURNS
+    Returns the previous value if successful and FAIL otherwise
+ DESCRIPTION
+    Sizes the buffers and caches made from now on and bounds the work of
+    the library, see hdf_config_t.  When the library starts, each setting
+    is read from the environment variable named after it, such as
+    HDF4_CHUNK_CACHE_BYTES for HDF_CONFIG_CHUNK_CACHE_BYTES, so that a
+    deployment can be tuned without rebuilding; the calls made by the
+    application take precedence.  Settings apply to the whole process.
+
+--------------------------------------------------------------------------*/
+int32
+Hsetconfig(hdf_config_t setting, int32 value)
+{
+    int32 ret_value = SUCCEED;
+
+    HEclear();
+
+    if ((intn)setting < 0 || setting >= HDF_CONFIG_NSETTINGS || value < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* the environment is read first, the call then overrides it */
+    if (library_terminate == FALSE)
+        if (HIstart() == FAIL)
+            HGOTO_ERROR(DFE_CANTINIT, FAIL);
+
+    ret_value              = config_values[setting];
+    config_values[setting] = value;
+
+done:
+    return ret_value;
+} /* Hsetconfig */
+
+/*--------------------------------------------------------------------------
+ NAME
+    Hgetconfig -- get a setting of the library
+ USAGE
+    int32 Hgetconfig(setting)
+    hdf_config_t setting;   IN: the setting
+ RETURNS
+    Returns the value of the setting, 0 for the built-in default, if
+    successful and FAIL otherwise
+ DESCRIPTION
+    See Hsetconfig().
+
+--------------------------------------------------------------------------*/
+int32
+Hgetconfig(hdf_config_t setting)
+{
+    int32 ret_value = SUCCEED;
+
+    HEclear();
+
+    if ((intn)setting < 0 || setting >= HDF_CONFIG_NSETTINGS)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    ret_value = HPgetconfig(setting);
+
+done:
+    return ret_value;
+} /* Hgetconfig */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HPgetconfig -- get a setting of the library, for its own use
+ USAGE
+    int32 HPgetconfig(setting)
+    hdf_config_t setting;   IN: the setting, which must be valid
+ RETURNS
+    Returns the value of the setting, 0 for the built-in default
+ DESCRIPTION
+    Starts the library first if needed, so that the environment is read.
+
+--------------------------------------------------------------------------*/
+int32
+HPgetconfig(hdf_config_t setting)
+{
+    if (library_terminate == FALSE)
+        HIstart();
+
+    return config_values[setting];
+} /* HPgetconfig */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HIcheckfileversion -- check version info for HDF file
+ USAGE
+    intn Hgetfileversion(file_id)
+    int32 file_id;      IN: handle of file
+ RETURNS
+    returns SUCCEED (0) if successful and FAIL (-1) if failed.
+ DESCRIPTION
+    Checks that the file's version is current and update it if it isn't.
+
+--------------------------------------------------------------------------*/
+static intn
+HIcheckfileversion(int32 file_id)
+{
+    filerec_t *file_rec;
+    uint32     lmajorv, lminorv, lrelease;
+    uint32     fmajorv, fminorv, frelease;
+    char       string[LIBVSTR_LEN + 1]; /* len 80+1  */
+    intn       newver    = 0;
+    intn       ret_value = SUCCEED;
+
+    HEclear();
+
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get file version and set newver condition */
+    if (Hgetfileversion(file_id, &fmajorv, &fminorv, &frelease, string) != SUCCEED) {
+        newver = 1;
+        HEclear();
+    } /* end if */
+
+    /* get library version */
+    Hgetlibversion(&lmajorv, &lminorv, &lrelease, string);
+
+    /* check whether we need to update the file version tag */
+    if (lmajorv > fmajorv || (lmajorv == fmajorv && lminorv > fminorv) ||
+        (lmajorv == fmajorv && lminorv == fminorv && lrelease > frelease))
+        newver = 1;
+    if (newver == 1) {
+        file_rec->version.majorv  = lmajorv;
+        file_rec->version.minorv  = lminorv;
+        file_rec->version.release = lrelease;
+        HIstrncpy(file_rec->version.string, string, LIBVSTR_LEN + 1);
+        file_rec->version.modified = 1;
+    } /* end if */
+
+    file_rec->version_set = TRUE;
+
+done:
+    return ret_value;
+} /* HIcheckfileversion */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIget_filerec_node -- find a filerec for a FILE
+ USAGE
+       filerec_t *HIget_filerec_node(path, acc_mode)
+       char * path;             IN: name of file
+       intn acc_mode;           IN: access the file is opened with
+ RETURNS
+       a file record or else NULL
+ DESCRIPTION
+       Search the file record array for a matching record, then the files
+       kept open after their last close, or allocate an empty slot.
+       The file is considered the same if the path matches exactly.  This
+       routine is unable to detect aliases, or how to compare relative and
+       absolute paths.
+
+--------------------------------------------------------------------------*/
+static filerec_t *
+HIget_filerec_node(const char *path, intn acc_mode)
+{
+    filerec_t *ret_value = NULL;
+
+    if ((ret_value = HAsearch_atom(FIDGROUP, HPcompare_filerec_path, path)) == NULL &&
+        (ret_value = HIkept_take(path, acc_mode)) == NULL) {
+        if ((ret_value = (filerec_t *)calloc(1, sizeof(filerec_t))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, NULL);
+
+        if ((ret_value->path = (char *)strdup(path)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, NULL);
+
+        if (HL_INIT(&ret_value->lock) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, NULL);
+
+        /* Initialize annotation stuff */
+        ret_value->an_tree[AN_DATA_LABEL] = NULL;
+        ret_value->an_tree[AN_DATA_DESC]  = NULL;
+        ret_value->an_tree[AN_FILE_LABEL] = NULL;
+        ret_value->an_tree[AN_FILE_DESC]  = NULL;
+        ret_value->an_num[AN_DATA_LABEL]  = -1;
+        ret_value->an_num[AN_DATA_DESC]   = -1;
+        ret_value->an_num[AN_FILE_LABEL]  = -1;
+        ret_value->an_num[AN_FILE_DESC]   = -1;
+    } /* end if */
+
+done:
+    return ret_value;
+} /* HIget_filerec_node */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIrelease_filerec_node -- release/recycle a filerec
+ USAGE
+       intn HIrelease_filerec_node(file_rec)
+       filerec_t *file_rec;         IN: File record to release
+ RETURNS
+       SUCCEED/FAIL
+ DESCRIPTION
+        Release a file record back to the system
+
+--------------------------------------------------------------------------*/
+static intn
+HIrelease_filerec_node(filerec_t *file_rec)
+{
+    /* Close file if it's opened */
+    HIclose_map(file_rec);
+    HIclose_index(file_rec);
+    HIfile_close(file_rec);
+
+    /* Free all the components of the file record */
+    HBPforget(file_rec, DFTAG_WILDCARD, DFREF_WILDCARD);
+    if (file_rec->free_by_off != NULL) {
+        tbbtdfree(file_rec->free_by_size, NULL, NULL);
+        tbbtdfree(file_rec->free_by_off, free, NULL);
+    }
+    HL_DESTROY(&file_rec->lock);
+    free(file_rec->wbuf);
+    if (file_rec->stream != NULL) {
+        free(file_rec->stream->head);
+        free(file_rec->stream->buf);
+        free(file_rec->stream);
+    } /* end if */
+    free(file_rec->path);
+    free(file_rec);
+
+    return SUCCEED;
+} /* HIrelease_filerec_node */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIkept_add -- keep a file open after its last close
+ USAGE
+       intn HIkept_add(file_rec)
+       filerec_t *file_rec;         IN: File record of the file closed
+ RETURNS
+       TRUE if the file is kept open, FALSE if it is to be closed.
+ DESCRIPTION
+       Files marked by HPkeep_open(), opened read-only with the built-in
+       file access, are kept open with their DD list when last closed, up
+       to the limit set by Hsetkeepopen().
+
+--------------------------------------------------------------------------*/
+static intn
+HIkept_add(filerec_t *file_rec)
+{
+    if (!file_rec->keep || kept_max == 0 || file_rec->access != DFACC_READ || file_rec->drv != NULL)
+        return FALSE;
+
+    file_rec->kept      = TRUE;
+    file_rec->kept_next = kept_first;
+    kept_first          = file_rec;
+    kept_count++;
+    HIkept_trim();
+
+    return TRUE;
+} /* HIkept_add */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIkept_trim -- close the files kept open over the limit
+ USAGE
+       void HIkept_trim()
+ RETURNS
+       none
+ DESCRIPTION
+       The files closed the longest ago are closed for good while more
+       files are kept open than set by Hsetkeepopen().
+
+--------------------------------------------------------------------------*/
+static void
+HIkept_trim(void)
+{
+    filerec_t *prev, *last;
+
+    while (kept_count > kept_max) {
+        for (prev = NULL, last = kept_first; last->kept_next != NULL; last = last->kept_next)
+            prev = last;
+        if (prev == NULL)
+            kept_first = NULL;
+        else
+            prev->kept_next = NULL;
+        kept_count--;
+        HIkept_close(last);
+    } /* end while */
+} /* HIkept_trim */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIkept_take -- take a file kept open to open it again
+ USAGE
+       filerec_t *HIkept_take(path, acc_mode)
+       const char * path;           IN: name of file
+       intn acc_mode;               IN: access the file is opened with
+ RETURNS
+       the record of the file, kept open, or NULL
+ DESCRIPTION
+       A file kept open since its last close is taken out of the files kept
+       open.  It is returned to be used as it is if opened read-only again
+       and unchanged on disk, per HPfile_stamp(); it is closed otherwise.
+
+--------------------------------------------------------------------------*/
+static filerec_t *
+HIkept_take(const char *path, intn acc_mode)
+{
+    filerec_t *file_rec, *prev;
+    uint32     stamp;
+
+    for (prev = NULL, file_rec = kept_first; file_rec != NULL; file_rec = file_rec->kept_next) {
+        if (strcmp(file_rec->path, path) == 0)
+            break;
+        prev = file_rec;
+    } /* end for */
+    if (file_rec == NULL)
+        return NULL;
+
+    if (prev == NULL)
+        kept_first = file_rec->kept_next;
+    else
+        prev->kept_next = file_rec->kept_next;
+    file_rec->kept_next = NULL;
+    kept_count--;
+
+    stamp = HPfile_stamp(path);
+    if (acc_mode == DFACC_READ && stamp != 0 && stamp == file_rec->stamp)
+        return file_rec;
+
+    HIkept_close(file_rec);
+    return NULL;
+} /* HIkept_take */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIkept_close -- close a file kept open
+ USAGE
+       void HIkept_close(file_rec)
+       filerec_t *file_rec;         IN: File record of the file
+ RETURNS
+       none
+ DESCRIPTION
+       Closes a file taken out of the files kept open and releases its
+       record.
+
+--------------------------------------------------------------------------*/
+static void
+HIkept_close(filerec_t *file_rec)
+{
+    file_rec->kept = FALSE;
+    HTPend(file_rec);
+    HIrelease_filerec_node(file_rec);
+} /* HIkept_close */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HPkeep_open -- keep a file open after its last close
+ USAGE
+       intn HPkeep_open(file_id)
+       int32 file_id;               IN: id of the file
+ RETURNS
+       SUCCEED/FAIL
+ DESCRIPTION
+       Used by the single-file interfaces, which open and close their file
+       on every call: a file opened read-only, with the built-in file
+       access, stays open with its DD list loaded after its last close, so
+       that opening it again reads nothing, see Hsetkeepopen().  It is
+       opened again from disk if it has changed since, per HPfile_stamp().
+
+--------------------------------------------------------------------------*/
+intn
+HPkeep_open(int32 file_id)
+{
+    filerec_t *file_rec;
+    intn       ret_value = SUCCEED;
+
+    HL_LOCK_FILES();
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (!file_rec->keep) {
+        file_rec->keep  = TRUE;
+        file_rec->stamp = HPfile_stamp(file_rec->path);
+    } /* end if */
+
+done:
+    HL_UNLOCK_FILES();
+    return ret_value;
+} /* HPkeep_open */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HPfile_stamp -- identify the contents of a file on disk
+ USAGE
+       uint32 HPfile_stamp(path)
+       const char * path;           IN: name of file
+ RETURNS
+       the stamp of the file, 0 if it does not exist
+ DESCRIPTION
+       Hashes the modification time, length, file serial number and device
+       of a file, which change whenever the file is written or replaced.  Two
+       different stamps of a file mean it has changed in between; a file
+       written twice in the same second without changing length goes
+       unnoticed.
+
+--------------------------------------------------------------------------*/
+uint32
+HPfile_stamp(const char *path)
+{
+    struct stat sbuf;
+    uint32      stamp;
+
+    if (stat(path, &sbuf) != 0)
+        return 0;
+
+    stamp = (uint32)sbuf.st_mtime;
+    stamp = stamp * 1000003U ^ (uint32)sbuf.st_size;
+    stamp = stamp * 1000003U ^ (uint32)sbuf.st_ino;
+    stamp = stamp * 1000003U ^ (uint32)sbuf.st_dev;
+    return stamp != 0 ? stamp : 1;
+} /* HPfile_stamp */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HPisfile_in_use -- check if a FILE is currently in use
+ USAGE
+       intn HPisfile_in_use(path)
+       const char * path;             IN: name of file
+ RETURNS
+       TRUE if the file is in use or FALSE, otherwise.
+ DESCRIPTION
+        Get its record if the file is opened, then check its
+        reference count to decide whether the file is currently in use.
+
+--------------------------------------------------------------------------*/
+intn
+HPisfile_in_use(const char *path)
+{
+    filerec_t *file_rec  = NULL;
+    intn       ret_value = FALSE;
+
+    /* Search for the record of a file named "path". */
+    file_rec = (filerec_t *)HAsearch_atom(FIDGROUP, HPcompare_filerec_path, path);
+
+    /* If the file is not found, it can't be in use, return FALSE */
+    if (file_rec == NULL)
+        ret_value = FALSE;
+    else if (file_rec->refcount) /* file is in use if ref count is not 0 */
+        ret_value = TRUE;
+
+    return ret_value;
+} /* HPisfile_in_use */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HPcompare_filerec_path -- compare filerec objects for the atom API
+ USAGE
+       intn HPcompare_filerec_path(obj, key)
+       const void * obj;             IN: pointer to the file record
+       const void * key;             IN: pointer to the name of file
+ RETURNS
+       TRUE if the key matches the obj, FALSE otherwise
+ DESCRIPTION
+       Look inside the file record for the atom API and compare the the
+       paths.
+--------------------------------------------------------------------------*/
+intn
+HPcompare_filerec_path(const void *obj, const void *key)
+{
+    const filerec_t *frec      = obj;
+    const char      *fname     = key;
+    intn             ret_value = FALSE; /* set default as FALSE */
+
+    /* check args */
+    if (frec != NULL && fname != NULL) {
+        /* check bad file record */
+        if (BADFREC(frec))
+            ret_value = FALSE;
+        else {
+            if (!strcmp(frec->path, fname))
+                ret_value = TRUE;
+            else
+                ret_value = FALSE;
+        }
+    }
+
+    return ret_value;
+} /* HPcompare_filerec_path */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HPcompare_accrec_tagref -- compare accrec objects for the atom API
+ USAGE
+       intn HPcompare_accrec_tagref(obj, key)
+       const void * rec1;            IN: pointer to the access record #1
+       const void * rec2;            IN: pointer to the access record #2
+ RETURNS
+       TRUE if tag/ref of rec1 matches the tag/ref of rec2, FALSE otherwise
+ DESCRIPTION
+       Look inside the access record for the atom API and compare the the
+       paths.
+--------------------------------------------------------------------------*/
+intn
+HPcompare_accrec_tagref(const void *rec1, const void *rec2)
+{
+    uint16 tag1, ref1;        /* tag/ref of access record #1 */
+    uint16 tag2, ref2;        /* tag/ref of access record #2 */
+    intn   ret_value = FALSE; /* FAIL */
+
+    if (rec1 != rec2) {
+        if (HTPinquire(((const accrec_t *)rec1)->ddid, &tag1, &ref1, NULL, NULL) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FALSE);
+
+        if (HTPinquire(((const accrec_t *)rec2)->ddid, &tag2, &ref2, NULL, NULL) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FALSE);
+
+        if (((const accrec_t *)rec1)->file_id == ((const accrec_t *)rec2)->file_id && tag1 == tag2 &&
+            ref1 == ref2)
+            HGOTO_DONE(TRUE);
+    } /* end if */
+
+done:
+    return ret_value;
+} /* HPcompare_accrec_tagref */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIvalid_magic -- verify the magic number in a file
+ USAGE
+       int32 HIvalid_magic(path)
+       hdf_file_t file;             IN: FILE pointer
+ RETURNS
+       TRUE if valid magic number else FALSE
+ DESCRIPTION
+       Given an open file pointer, see if the first four bytes of the
+       file are the HDF "magic number" HDFMAGIC
+
+--------------------------------------------------------------------------*/
+static intn
+HIvalid_magic(hdf_file_t file)
+{
+    char b[MAGICLEN];       /* Temporary buffer */
+    intn ret_value = FALSE; /* FAIL */
+
+    /* Seek to beginning of the file. */
+    if (HI_SEEK(file, 0) == FAIL)
+        HGOTO_ERROR(DFE_SEEKERROR, FALSE);
+
+    /* Read in magic cookie and compare. */
+    if (HI_READ(file, b, MAGICLEN) == FAIL)
+        HGOTO_ERROR(DFE_READERROR, FALSE);
+
+    if (NSTREQ(b, HDFMAGIC, MAGICLEN))
+        ret_value = TRUE;
+
+done:
+    return ret_value;
+}
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIprobe_read -- read bytes of a file probed by Hprobe()
+ USAGE
+       intn HIprobe_read(drv, handle, file, offset, buf, bytes)
+       const hdf_driver_t *drv;     IN: driver of the file, or NULL
+       void *handle;                IN: handle of the file for the driver
+       hdf_file_t file;             IN: the file, when opened without a driver
+       int32 offset;                IN: offset to read at
+       void *buf;                   OUT: buffer of 'bytes' bytes
+       int32 bytes;                 IN: # of bytes to read
+ RETURNS
+       SUCCEED/FAIL
+ DESCRIPTION
+       Reads bytes of a file opened without a file record, through its
+       driver or with the built-in file access.
+
+--------------------------------------------------------------------------*/
+static intn
+HIprobe_read(const hdf_driver_t *drv, void *handle, hdf_file_t file, int32 offset, void *buf, int32 bytes)
+{
+    if (drv != NULL)
+        return (*drv->read)(handle, offset, buf, bytes);
+    if (HI_SEEK(file, offset) == FAIL || HI_READ(file, buf, bytes) == FAIL)
+        return FAIL;
+    return SUCCEED;
+} /* HIprobe_read */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIdrv_valid_magic -- verify the magic number in a file opened by a driver
+ USAGE
+       intn HIdrv_valid_magic(drv, handle)
+       const hdf_driver_t *drv;     IN: driver of the file
+       void *handle;                IN: handle of the file for the driver
+ RETURNS
+       TRUE if valid magic number else FALSE
+ DESCRIPTION
+       As HIvalid_magic(), for a file opened through a driver.
+
+--------------------------------------------------------------------------*/
+static intn
+HIdrv_valid_magic(const hdf_driver_t *drv, void *handle)
+{
+    char b[MAGICLEN];       /* Temporary buffer */
+    intn ret_value = FALSE; /* FAIL */
+
+    if ((*drv->read)(handle, 0, b, MAGICLEN) == FAIL)
+        HGOTO_ERROR(DFE_READERROR, FALSE);
+
+    if (NSTREQ(b, HDFMAGIC, MAGICLEN))
+        ret_value = TRUE;
+
+done:
+    return ret_value;
+} /* HIdrv_valid_magic */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIfind_driver -- look a file driver up by name
+ USAGE
+       const hdf_driver_t *HIfind_driver(name)
+       const char *name;            IN: name of the driver
+ RETURNS
+       The driver, or NULL when there is none of that name
+ DESCRIPTION
+       Searches the drivers that are built in or were registered with
+       Hregisterdriver().  The caller holds the files lock, if any.
+
+--------------------------------------------------------------------------*/
+static const hdf_driver_t *
+HIfind_driver(const char *name)
+{
+    const hdf_driver_t *ret_value = NULL;
+    intn                i;
+
+    for (i = 0; i < HDRV_MAX_DRIVERS && drivers[i] != NULL; i++)
+        if (strcmp(drivers[i]->name, name) == 0) {
+            ret_value = drivers[i];
+            break;
+        } /* end if */
+
+    return ret_value;
+} /* HIfind_driver */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIpath_driver -- get the driver a file is to be opened with
+ USAGE
+       const hdf_driver_t *HIpath_driver(path)
+       const char *path;            IN: name of the file
+ RETURNS
+       The driver, NULL for the built-in file access
+ DESCRIPTION
+       URLs go to the "http" driver, names of file images to the "memory"
+       driver, other names to the driver set by Hsetdriver().  Without an "http" driver, URLs are handed to the
+       built-in file access, which fails to open them.
+
+--------------------------------------------------------------------------*/
+static const hdf_driver_t *
+HIpath_driver(const char *path)
+{
+    if (strncmp(path, "http://", 7) == 0 || strncmp(path, "https://", 8) == 0 ||
+        strncmp(path, "s3://", 5) == 0)
+        return HIfind_driver("http");
+    if (HPis_image(path))
+        return &HP_driver_memory;
+
+    return default_driver;
+} /* HIpath_driver */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIfile_open -- open the file of a filerec
+ USAGE
+       intn HIfile_open(file_rec, drv, acc_mode)
+       filerec_t *file_rec;         IN: File record of the file
+       const hdf_driver_t *drv;     IN: driver to open it with, NULL for the
+                                        built-in file access
+       intn acc_mode;               IN: access mode, DFACC_CREATE to create it
+ RETURNS
+       SUCCEED/FAIL
+ DESCRIPTION
+       Opens the file named by the record and stores its handle and driver
+       there.  On failure the record is left as it was and errno tells
+       why, for the built-in file access.
+
+--------------------------------------------------------------------------*/
+static intn
+HIfile_open(filerec_t *file_rec, const hdf_driver_t *drv, intn acc_mode)
+{
+    intn ret_value = SUCCEED;
+
+    if (drv != NULL) {
+        void *handle = (*drv->open)(file_rec->path, acc_mode);
+
+        if (handle == NULL)
+            HGOTO_DONE(FAIL);
+        file_rec->drv_handle = handle;
+    } /* end if */
+    else {
+        hdf_file_t f;
+
+        /* when out of descriptors, give back those of the other files */
+        do {
+            if (acc_mode == DFACC_CREATE)
+                f = (hdf_file_t)HI_CREATE(file_rec->path);
+            else
+                f = (hdf_file_t)HI_OPEN(file_rec->path, acc_mode);
+        } while (OPENERR(f) && (errno == EMFILE || errno == ENFILE) && HIfd_park(file_rec));
+        if (OPENERR(f))
+            HGOTO_DONE(FAIL);
+        file_rec->file   = f;
+        file_rec->parked = FALSE;
+        HIfd_add(file_rec);
+    } /* end else */
+    file_rec->drv = drv;
+    HIadvise(file_rec, HDF_ACCESS_NORMAL, TRUE);
+
+done:
+    return ret_value;
+} /* HIfile_open */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIfile_close -- close the file of a filerec
+ USAGE
+       intn HIfile_close(file_rec)
+       filerec_t *file_rec;         IN: File record of the file
+ RETURNS
+       SUCCEED/FAIL
+ DESCRIPTION
+       Closes the file through its driver, if it is open, after writing
+       out its write-combining buffer.  A file whose descriptor was parked
+       has nothing left to close.
+
+--------------------------------------------------------------------------*/
+static intn
+HIfile_close(filerec_t *file_rec)
+{
+    intn ret_value = SUCCEED;
+
+    if (file_rec->drv != NULL) {
+        if (file_rec->drv_handle != NULL)
+            ret_value = (*file_rec->drv->close)(file_rec->drv_handle);
+        file_rec->drv_handle = NULL;
+    } /* end if */
+    else {
+        if (HIwbuf_flush(file_rec) == FAIL)
+            ret_value = FAIL;
+        HIdrop_flush(file_rec);
+        HIfd_remove(file_rec);
+        if (file_rec->parked)
+            file_rec->parked = FALSE;
+        else if (file_rec->file != NULL && HI_CLOSE(file_rec->file) == FAIL)
+            ret_value = FAIL;
+    } /* end else */
+
+    return ret_value;
+} /* HIfile_close */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIfile_use -- make sure a file holds its descriptor
+ USAGE
+       intn HIfile_use(file_rec)
+       filerec_t *file_rec;         IN: File record of the file
+ RETURNS
+       SUCCEED/FAIL
+ DESCRIPTION
+       Files opened with the built-in file access are kept open without
+       limit, but only the most recently used of them hold a descriptor,
+       see Hsetmaxdescriptors().  This is called before each use of the
+       descriptor of a file: a parked file is reopened by its path, with
+       the access it was opened with, and the file becomes the most
+       recently used one.  The next access to a reopened file seeks again.
+
+--------------------------------------------------------------------------*/
+static intn
+HIfile_use(filerec_t *file_rec)
+{
+    intn ret_value = SUCCEED;
+
+    if (file_rec->drv != NULL)
+        return SUCCEED;
+
+    HL_LOCK_LIBRARY();
+    if (file_rec->parked) {
+        intn       acc_mode = (file_rec->access & DFACC_WRITE) ? DFACC_WRITE : DFACC_READ;
+        hdf_file_t f;
+
+        do
+            f = (hdf_file_t)HI_OPEN(file_rec->path, acc_mode);
+        while (OPENERR(f) && (errno == EMFILE || errno == ENFILE) && HIfd_park(file_rec));
+        if (OPENERR(f))
+            HGOTO_ERROR(DFE_BADOPEN, FAIL);
+        file_rec->file      = f;
+        file_rec->parked    = FALSE;
+        file_rec->last_op   = H4_OP_UNKNOWN;
+        file_rec->stats.nopens++;
+        HIfd_add(file_rec);
+        HIadvise(file_rec, HDF_ACCESS_NORMAL, FALSE);
+    } /* end if */
+    else if (file_rec->fd_listed && fd_first != file_rec) {
+        HIfd_remove(file_rec);
+        HIfd_add(file_rec);
+    } /* end if */
+
+done:
+    HL_UNLOCK_LIBRARY();
+    return ret_value;
+} /* HIfile_use */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIfd_add -- add a file to the descriptor list
+ USAGE
+       void HIfd_add(file_rec)
+       filerec_t *file_rec;         IN: File record of a file holding a descriptor
+ DESCRIPTION
+       Makes the file the most recently used one, then parks the least
+       recently used ones beyond the limit.
+
+--------------------------------------------------------------------------*/
+static void
+HIfd_add(filerec_t *file_rec)
+{
+    HL_LOCK_LIBRARY();
+    file_rec->fd_prev = NULL;
+    file_rec->fd_next = fd_first;
+    if (fd_first != NULL)
+        fd_first->fd_prev = file_rec;
+    else
+        fd_last = file_rec;
+    fd_first            = file_rec;
+    file_rec->fd_listed = TRUE;
+    fd_count++;
+
+    while (fd_max > 0 && fd_count > fd_max && HIfd_park(file_rec))
+        ;
+    HL_UNLOCK_LIBRARY();
+} /* HIfd_add */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIfd_remove -- remove a file from the descriptor list
+ USAGE
+       void HIfd_remove(file_rec)
+       filerec_t *file_rec;         IN: File record of the file
+ DESCRIPTION
+       Does nothing for a file that is not in the list.
+
+--------------------------------------------------------------------------*/
+static void
+HIfd_remove(filerec_t *file_rec)
+{
+    HL_LOCK_LIBRARY();
+    if (file_rec->fd_listed) {
+        if (file_rec->fd_prev != NULL)
+            file_rec->fd_prev->fd_next = file_rec->fd_next;
+        else
+            fd_first = file_rec->fd_next;
+        if (file_rec->fd_next != NULL)
+            file_rec->fd_next->fd_prev = file_rec->fd_prev;
+        else
+            fd_last = file_rec->fd_prev;
+        file_rec->fd_prev   = NULL;
+        file_rec->fd_next   = NULL;
+        file_rec->fd_listed = FALSE;
+        fd_count--;
+    } /* end if */
+    HL_UNLOCK_LIBRARY();
+} /* HIfd_remove */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIfd_park -- close the descriptor of the least recently used file
+ USAGE
+       intn HIfd_park(keep)
+       filerec_t *keep;             IN: File record never to park
+ RETURNS
+       TRUE if a descriptor was closed, FALSE if none could be
+ DESCRIPTION
+       The file is flushed, its write-combining buffer first, and its
+       descriptor closed; the file stays open and is reopened by
+       HIfile_use().  Files in use by another thread, files being read
+       outside their lock (see HIfd_pin()), and files that cannot be
+       flushed, are skipped.  The lock of a file is only
+       tried, never waited for, so this is safe whatever the locks held.
+
+--------------------------------------------------------------------------*/
+static intn
+HIfd_park(filerec_t *keep)
+{
+    filerec_t *file_rec;
+    intn       ret_value = FALSE;
+
+    HL_LOCK_LIBRARY();
+    for (file_rec = fd_last; file_rec != NULL; file_rec = file_rec->fd_prev) {
+        if (file_rec == keep || file_rec->fd_pins > 0 || !HL_TRYLOCK_FILE(file_rec))
+            continue;
+        HIdrop_flush(file_rec);
+        if ((file_rec->wbuf_len == 0 || HIwbuf_write(file_rec) == SUCCEED) &&
+            HI_FLUSH(file_rec->file) == SUCCEED && HI_CLOSE(file_rec->file) == SUCCEED) {
+            HIfd_remove(file_rec);
+            file_rec->parked  = TRUE;
+            file_rec->last_op = H4_OP_UNKNOWN;
+            ret_value         = TRUE;
+        } /* end if */
+        HL_UNLOCK_FILE(file_rec);
+        if (ret_value)
+            break;
+    } /* end for */
+    HL_UNLOCK_LIBRARY();
+
+    return ret_value;
+} /* HIfd_park */
+
+#if defined(H4_HAVE_THREADSAFE) && defined(HI_PREADV_SUPPORTED)
+/*--------------------------------------------------------------------------
+ NAME
+       HIfd_pin -- keep a descriptor from being parked during a read
+ USAGE
+       intn HIfd_pin(file_rec, fd)
+       filerec_t *file_rec;         IN: File record of the file
+       int *fd;                     OUT: its descriptor
+ RETURNS
+       SUCCEED/FAIL
+ DESCRIPTION
+       Makes sure the file holds its descriptor and keeps HIfd_park() off
+       it until HIfd_unpin(), so that the descriptor can be read from at
+       an offset once the lock of the file is released.  Only the built-in
+       file access of read-only files, neither mapped nor indexed, reads
+       outside the lock: nothing else then changes the file.
+
+--------------------------------------------------------------------------*/
+static intn
+HIfd_pin(filerec_t *file_rec, int *fd)
+{
+    intn ret_value = SUCCEED;
+
+    if (file_rec->drv != NULL || file_rec->map != NULL || file_rec->idx != NULL ||
+        (file_rec->access & DFACC_WRITE))
+        return FAIL;
+
+    HL_LOCK_LIBRARY();
+    if ((ret_value = HIfile_use(file_rec)) == SUCCEED) {
+        file_rec->fd_pins++;
+        *fd = HI_FILENO(file_rec->file);
+    } /* end if */
+    HL_UNLOCK_LIBRARY();
+
+    return ret_value;
+} /* HIfd_pin */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIfd_unpin -- let a pinned descriptor be parked again
+ USAGE
+       void HIfd_unpin(file_rec)
+       filerec_t *file_rec;         IN: File record of the file
+ DESCRIPTION
+       Undoes one HIfd_pin().
+
+--------------------------------------------------------------------------*/
+static void
+HIfd_unpin(filerec_t *file_rec)
+{
+    HL_LOCK_LIBRARY();
+    file_rec->fd_pins--;
+    HL_UNLOCK_LIBRARY();
+} /* HIfd_unpin */
+#endif /* H4_HAVE_THREADSAFE && HI_PREADV_SUPPORTED */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIwbuf_write -- write out the write-combining buffer of a file
+ USAGE
+       intn HIwbuf_write(file_rec)
+       filerec_t *file_rec;         IN: File record of a file holding a descriptor
+ RETURNS
+       SUCCEED/FAIL
+ DESCRIPTION
+       Writes the buffered bytes where they belong with one write, and
+       flushes the file so that positional reads see them.  The buffer is
+       emptied even on failure.  The next access to the file seeks again.
+
+--------------------------------------------------------------------------*/
+static intn
+HIwbuf_write(filerec_t *file_rec)
+{
+    intn ret_value = SUCCEED;
+
+    HP_TRACE(HDF_TRACE_WRITE, FALSE, file_rec->wbuf_len);
+    file_rec->stats.nseeks++;
+    file_rec->stats.nwrites++;
+    if (HI_SEEK(file_rec->file, file_rec->wbuf_off) == FAIL ||
+        HI_WRITE(file_rec->file, file_rec->wbuf, file_rec->wbuf_len) == FAIL ||
+        HI_FLUSH(file_rec->file) == FAIL)
+        ret_value = FAIL;
+    HP_TRACE(HDF_TRACE_WRITE, TRUE, file_rec->wbuf_len);
+    file_rec->wbuf_len = 0;
+    file_rec->last_op  = H4_OP_UNKNOWN;
+
+    return ret_value;
+} /* HIwbuf_write */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIwbuf_flush -- write out the write-combining buffer of a file
+ USAGE
+       intn HIwbuf_flush(file_rec)
+       filerec_t *file_rec;         IN: File record of the file
+ RETURNS
+       SUCCEED/FAIL
+ DESCRIPTION
+       As HIwbuf_write(), for any file; does nothing when the buffer is
+       empty.
+
+--------------------------------------------------------------------------*/
+static intn
+HIwbuf_flush(filerec_t *file_rec)
+{
+    intn ret_value = SUCCEED;
+
+    if (file_rec->wbuf_len == 0)
+        return SUCCEED;
+
+    if (HIfile_use(file_rec) == FAIL || HIwbuf_write(file_rec) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+done:
+    return ret_value;
+} /* HIwbuf_flush */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIstream_open -- start writing a file created for streaming
+ USAGE
+       intn HIstream_open(file_rec, ndds, window)
+       filerec_t *file_rec;         IN: File record of the file created
+       int16 ndds;                  IN: # of DDs of the first DD block, as
+                                        given to Hopen()
+       int32 window;                IN: # of bytes kept before being written
+ RETURNS
+       SUCCEED/FAIL
+ DESCRIPTION
+       Called before anything is written to the file, see Hsetstreaming().
+       The head of the file, its magic number and the first DD block that
+       HTPinit() makes, is kept until the file is closed; the bytes after
+       it are kept in a buffer of twice the window, and written out half a
+       buffer at a time.
+
+--------------------------------------------------------------------------*/
+static intn
+HIstream_open(filerec_t *file_rec, int16 ndds, int32 window)
+{
+    hfile_stream_t *s;
+    intn            ret_value = SUCCEED;
+
+    if (window > MAX_FILE_OFFSET / 2)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* sized as HTPinit() does */
+    if (ndds <= 0)
+        ndds = DEF_NDDS;
+    else if (ndds < MIN_NDDS)
+        ndds = MIN_NDDS;
+
+    if ((s = (hfile_stream_t *)calloc(1, sizeof(hfile_stream_t))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    s->head_len = MAGICLEN + NDDS_SZ + OFFSET_SZ + (ndds * DD_SZ);
+    s->size     = 2 * window;
+    s->off      = s->head_len;
+    s->len      = 0;
+    if ((s->head = (uint8 *)calloc(1, (size_t)s->head_len)) == NULL ||
+        (s->buf = (uint8 *)malloc((size_t)s->size)) == NULL) {
+        free(s->head);
+        free(s);
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    } /* end if */
+    file_rec->stream = s;
+
+done:
+    return ret_value;
+} /* HIstream_open */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIstream_close -- finish writing a file created for streaming
+ USAGE
+       intn HIstream_close(file_rec)
+       filerec_t *file_rec;         IN: File record of the file
+ RETURNS
+       SUCCEED/FAIL
+ DESCRIPTION
+       Writes the DD blocks, those after the first at the end of the file,
+       writes out what the buffer holds, then the head of the file at
+       offset 0.  The file is no longer streamed afterwards, even on
+       failure.
+
+--------------------------------------------------------------------------*/
+static intn
+HIstream_close(filerec_t *file_rec)
+{
+    hfile_stream_t *s         = file_rec->stream;
+    intn            ret_value = SUCCEED;
+
+    if (HTPsync(file_rec) == FAIL)
+        HGOTO_ERROR(DFE_CANTFLUSH, FAIL);
+    if ((file_rec->dirty & FILE_END_DIRTY) && HIextend_file(file_rec) == FAIL)
+        HGOTO_ERROR(DFE_CANTFLUSH, FAIL);
+    file_rec->dirty = 0;
+
+    if (HIstream_emit(file_rec, s->off, s->buf, s->len) == FAIL ||
+        HIstream_emit(file_rec, 0, s->head, s->head_len) == FAIL || HP_flush(file_rec) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+done:
+    free(s->head);
+    free(s->buf);
+    free(s);
+    file_rec->stream = NULL;
+
+    return ret_value;
+} /* HIstream_close */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIstream_emit -- write out bytes of a file created for streaming
+ USAGE
+       intn HIstream_emit(file_rec, offset, buf, bytes)
+       filerec_t *file_rec;         IN: File record of the file
+       int32 offset;                IN: where the bytes go in the file
+       const void *buf;             IN: the bytes
+       int32 bytes;                 IN: # of bytes
+ RETURNS
+       SUCCEED/FAIL
+ DESCRIPTION
+       Writes the bytes through the driver of the file, or the built-in
+       file access.  Every call but the last one, for the head of the
+       file, writes right after the one before.
+
+--------------------------------------------------------------------------*/
+static intn
+HIstream_emit(filerec_t *file_rec, int32 offset, const void *buf, int32 bytes)
+{
+    intn ret_value = SUCCEED;
+
+    if (bytes == 0)
+        return SUCCEED;
+
+    file_rec->stats.nwrites++;
+    if (file_rec->drv != NULL) {
+        if (file_rec->drv->write == NULL ||
+            (*file_rec->drv->write)(file_rec->drv_handle, offset, buf, bytes) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    } /* end if */
+    else {
+        file_rec->stats.nseeks++;
+        if (HIfile_use(file_rec) == FAIL || HI_SEEK(file_rec->file, offset) == FAIL ||
+            HI_WRITE(file_rec->file, buf, bytes) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    } /* end else */
+
+done:
+    return ret_value;
+} /* HIstream_emit */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIstream_write -- write to a file created for streaming
+ USAGE
+       intn HIstream_write(file_rec, offset, buf, bytes)
+       filerec_t *file_rec;         IN: File record of the file
+       int32 offset;                IN: where the bytes go in the file
+       const uint8 *buf;            IN: the bytes
+       int32 bytes;                 IN: # of bytes
+ RETURNS
+       SUCCEED/FAIL
+ DESCRIPTION
+       Copies the bytes into the head or the buffer of the file.  When the
+       buffer has no room left, its start is written out, down to half the
+       buffer at least; the bytes that still do not fit, the space skipped
+       before the write then the start of the write, are written out
+       straight, the space as zeros.  Bytes written out already cannot be
+       written again.
+
+--------------------------------------------------------------------------*/
+static intn
+HIstream_write(filerec_t *file_rec, int32 offset, const uint8 *buf, int32 bytes)
+{
+    hfile_stream_t *s = file_rec->stream;
+    int32           need; /* # of bytes to write out to make room */
+    int32           n;
+    intn            ret_value = SUCCEED;
+
+    if (offset < 0 || bytes < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (offset < s->head_len) {
+        n = MIN(bytes, s->head_len - offset);
+        memcpy(s->head + offset, buf, (size_t)n);
+        offset += n;
+        buf += n;
+        bytes -= n;
+    } /* end if */
+    if (bytes == 0)
+        HGOTO_DONE(SUCCEED);
+    if (offset < s->off)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+    if ((need = offset + bytes - s->off - s->size) > 0) {
+        n = MIN(s->len, MAX(need, s->len - s->size / 2));
+        if (HIstream_emit(file_rec, s->off, s->buf, n) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        memmove(s->buf, s->buf + n, (size_t)(s->len - n));
+        s->off += n;
+        s->len -= n;
+        need -= n;
+
+        /* the buffer is empty if there is still no room */
+        while (need > 0 && s->off < offset) {
+            n = MIN(MIN(need, offset - s->off), s->size);
+            memset(s->buf, 0, (size_t)n);
+            if (HIstream_emit(file_rec, s->off, s->buf, n) == FAIL)
+                HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+            s->off += n;
+            need -= n;
+        } /* end while */
+        if (need > 0) {
+            if (HIstream_emit(file_rec, offset, buf, need) == FAIL)
+                HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+            offset += need;
+            buf += need;
+            bytes -= need;
+            s->off = offset;
+        } /* end if */
+    }     /* end if */
+
+    if (offset > s->off + s->len)
+        memset(s->buf + s->len, 0, (size_t)(offset - s->off - s->len));
+    memcpy(s->buf + (offset - s->off), buf, (size_t)bytes);
+    s->len = MAX(s->len, offset + bytes - s->off);
+
+done:
+    return ret_value;
+} /* HIstream_write */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIstream_read -- read from a file created for streaming
+ USAGE
+       intn HIstream_read(file_rec, offset, buf, bytes)
+       filerec_t *file_rec;         IN: File record of the file
+       int32 offset;                IN: where to read in the file
+       uint8 *buf;                  OUT: the bytes read
+       int32 bytes;                 IN: # of bytes
+ RETURNS
+       SUCCEED/FAIL
+ DESCRIPTION
+       Copies the bytes out of the head or the buffer of the file; bytes
+       not written yet read as zeros.  Bytes written out already cannot
+       be read.
+
+--------------------------------------------------------------------------*/
+static intn
+HIstream_read(filerec_t *file_rec, int32 offset, uint8 *buf, int32 bytes)
+{
+    hfile_stream_t *s = file_rec->stream;
+    int32           n;
+    intn            ret_value = SUCCEED;
+
+    if (offset < 0 || bytes < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    if (~tag & 0x8000) {
-        ret_value = ((uint16)(tag | 0x4000));
-        goto done;
-    }
+    if (offset < s->head_len) {
+        n = MIN(bytes, s->head_len - offset);
+        memcpy(buf, s->head + offset, (size_t)n);
+        offset += n;
+        buf += n;
+        bytes -= n;
+    } /* end if */
+    if (bytes == 0)
+        HGOTO_DONE(SUCCEED);
+    if (offset < s->off)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
 
-    for (i = 0; i < SP_TAB_SZ; i++)
-        if (special_table[i].tag == tag) {
-            ret_value = (uint16)special_table[i].special_tag;
-            break;
-        }
+    n = MIN(bytes, MAX(s->off + s->len - offset, 0));
+    memcpy(buf, s->buf + (offset - s->off), (size_t)n);
+    memset(buf + n, 0, (size_t)(bytes - n));
 
 done:
     return ret_value;
-}
+} /* HIstream_read */
 
 /*--------------------------------------------------------------------------
+ NAME
+       HIreadv_compare -- compare two extents of a batched read
+ USAGE
+       int HIreadv_compare(a, b)
+       const void *a, *b;           IN: the extents to compare
+ RETURNS
+       <0, 0 or >0, as for qsort()
+ DESCRIPTION
+       Orders extents by file offset, then by length.
+
 --------------------------------------------------------------------------*/
-intn
-HDis_special_tag(uint16 tag)
+static int
+HIreadv_compare(const void *a, const void *b)
 {
-    int  i;
-    intn ret_value = FALSE; /* FAIL */
-
-    if (~tag & 0x8000) {
-        ret_value = (tag & 0x4000) ? TRUE : FALSE;
-        goto done;
-    }
-
-    for (i = 0; i < SP_TAB_SZ; i++)
-        if (special_table[i].special_tag == tag) {
-            ret_value = TRUE;
-            break;
-        }
+    const hfile_ext_t *ea = (const hfile_ext_t *)a;
+    const hfile_ext_t *eb = (const hfile_ext_t *)b;
 
-done:
-    return ret_value;
-}
+    if (ea->offset != eb->offset)
+        return (ea->offset < eb->offset) ? -1 : 1;
+    return (ea->length < eb->length) ? -1 : (ea->length > eb->length);
+} /* HIreadv_compare */
 
+#ifdef HI_PREADV_SUPPORTED
 /*--------------------------------------------------------------------------
+ NAME
+       HIpreadv -- read into several buffers at a file offset
+ USAGE
+       intn HIpreadv(fd, iov, niov, offset)
+       int fd;                      IN: file descriptor
+       struct iovec *iov;           IN: the buffers, modified
+       int niov;                    IN: # of buffers
+       off_t offset;                IN: file offset to read from
+ RETURNS
+       SUCCEED if all the buffers were filled, FAIL otherwise
+ DESCRIPTION
+       Calls preadv() until all the buffers are filled, so that short
+       reads and interrupted calls are retried.  Reaching the end of the
+       file first is an error.  The file position is left alone.
+
 --------------------------------------------------------------------------*/
-uint16
-HDbase_tag(uint16 tag)
+static intn
+HIpreadv(int fd, struct iovec *iov, int niov, off_t offset)
 {
-    int    i;
-    uint16 ret_value = tag;
+    ssize_t nread;
 
-    if (~tag & 0x8000) {
-        ret_value = ((uint16)(tag & ~0x4000));
-        goto done;
-    }
+    while (niov > 0) {
+        if ((nread = preadv(fd, iov, niov, offset)) < 0) {
+            if (errno == EINTR)
+                continue;
+            return FAIL;
+        }
+        if (nread == 0)
+            return FAIL;
+        offset += nread;
 
-    for (i = 0; i < SP_TAB_SZ; i++)
-        if (special_table[i].special_tag == tag) {
-            ret_value = special_table[i].special_tag;
-            break;
+        /* skip the buffers filled, then move into the one partly filled */
+        while (niov > 0 && (size_t)nread >= iov->iov_len) {
+            nread -= (ssize_t)iov->iov_len;
+            iov++;
+            niov--;
         }
-done:
-    return ret_value;
-}
+        if (niov > 0) {
+            iov->iov_base = (char *)iov->iov_base + nread;
+            iov->iov_len -= (size_t)nread;
+        }
+    } /* end while */
 
-#endif /* SPECIAL_TABLE */
+    return SUCCEED;
+} /* HIpreadv */
+#endif /* HI_PREADV_SUPPORTED */
 
 /*--------------------------------------------------------------------------
  NAME
-    Hgetlibversion -- return version info for current HDF library
+       HIreadv_special -- read one Hreadv() request of a special element
  USAGE
-    intn Hgetlibversion(majorv, minorv, release, string)
-    uint32 *majorv;     OUT: majorv version number
-    uint32 *minorv;     OUT: minorv version number
-    uint32 *release;    OUT: release number
-    char   string[];    OUT: informational text string (80 chars)
+       int32 HIreadv_special(file_id, req)
+       int32 file_id;               IN: id of file
+       hdf_readv_t *req;            IN/OUT: the request
  RETURNS
-    returns SUCCEED (0).
+       # of bytes read or FAIL
  DESCRIPTION
-    Copies values from #defines in hfile.h to provided buffers. This
-        information is statistically compiled into the HDF library, so
-        it is not necessary to have any files open to get this information.
+       Reads the request through an access record, so that the special
+       element functions take care of the element's layout.
 
 --------------------------------------------------------------------------*/
-intn
-Hgetlibversion(uint32 *majorv, uint32 *minorv, uint32 *releasev, char *string)
+static int32
+HIreadv_special(int32 file_id, hdf_readv_t *req)
 {
-    HEclear();
+    int32 access_id = FAIL; /* access record id */
+    int32 ret_value = SUCCEED;
 
-    *majorv   = LIBVER_MAJOR;
-    *minorv   = LIBVER_MINOR;
-    *releasev = LIBVER_RELEASE;
-    HIstrncpy(string, LIBVER_STRING, LIBVSTR_LEN + 1);
+    if ((access_id = Hstartread(file_id, req->tag, req->ref)) == FAIL)
+        HGOTO_ERROR(DFE_NOMATCH, FAIL);
 
-    return SUCCEED;
-} /* HDgetlibversion */
+    if (req->offset > 0 && Hseek(access_id, req->offset, DF_START) == FAIL)
+        HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+
+    if ((req->nread = Hread(access_id, req->length, req->buf)) == FAIL)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
+
+    ret_value = req->nread;
+
+done:
+    if (access_id != FAIL)
+        if (Hendaccess(access_id) == FAIL)
+            ret_value = FAIL;
+
+    return ret_value;
+} /* HIreadv_special */
 
 /*--------------------------------------------------------------------------
  NAME
-    Hgetfileversion -- return version info for HDF file
+       HIopen_map -- memory-map a file opened read-only
  USAGE
-    intn Hgetfileversion(file_id, majorv, minorv, release, string)
-    int32 file_id;      IN: handle of file
-    uint32 *majorv;     OUT: majorv version number
-    uint32 *minorv;     OUT: minorv version number
-    uint32 *release;    OUT: release number
-    char *string;       OUT: informational text string (80 chars)
+       intn HIopen_map(file_rec)
+       filerec_t *file_rec;         IN: File record of the file to map
  RETURNS
-    returns SUCCEED (0) if successful and FAIL (-1) if failed.
+       SUCCEED/FAIL
  DESCRIPTION
-    Copies values from file_records[] structure for a given file to
-        provided buffers.
- GLOBAL VARIABLES
-    Reads file_records[]
+       Maps the whole file read-only, so that HP_read() can copy data out
+       of the mapping.  Empty files, files too large for an int32 offset
+       and files opened through a driver are not mapped.  On failure the file is left unmapped and is read
+       through its file handle as usual.
 
 --------------------------------------------------------------------------*/
-intn
-Hgetfileversion(int32 file_id, uint32 *majorv, uint32 *minorv, uint32 *release, char *string)
+static intn
+HIopen_map(filerec_t *file_rec)
 {
-    filerec_t *file_rec;
-    intn       ret_value = SUCCEED;
+    intn ret_value = FAIL;
 
-    HEclear();
+#ifdef HI_MMAP_SUPPORTED
+    struct stat sbuf;
+    void       *map;
+    int         fd;
 
-    file_rec = HAatom_object(file_id);
-    if (BADFREC(file_rec))
-        HGOTO_ERROR(DFE_ARGS, FAIL);
+    /* Only files opened with the built-in file access have a descriptor */
+    if (file_rec->drv != NULL)
+        HGOTO_DONE(FAIL);
 
-    if (majorv != NULL)
-        *majorv = file_rec->version.majorv;
-    if (minorv != NULL)
-        *minorv = file_rec->version.minorv;
-    if (release != NULL)
-        *release = file_rec->version.release;
-    if (string != NULL)
-        HIstrncpy(string, file_rec->version.string, LIBVSTR_LEN + 1);
+    if (HIfile_use(file_rec) == FAIL)
+        HGOTO_DONE(FAIL);
+    fd = HI_FILENO(file_rec->file);
+    if (fstat(fd, &sbuf) != 0 || sbuf.st_size <= 0 || sbuf.st_size > (off_t)INT32_MAX)
+        HGOTO_DONE(FAIL);
+
+    map = mmap(NULL, (size_t)sbuf.st_size, PROT_READ, MAP_PRIVATE, fd, (off_t)0);
+    if (map == MAP_FAILED)
+        HGOTO_DONE(FAIL);
+
+    file_rec->map     = (uint8 *)map;
+    file_rec->map_len = (int32)sbuf.st_size;
+    ret_value         = SUCCEED;
+    HIadvise(file_rec, HDF_ACCESS_NORMAL, FALSE);
 
 done:
+#else
+    (void)file_rec;
+#endif /* HI_MMAP_SUPPORTED */
     return ret_value;
-} /* Hgetfileversion */
+} /* HIopen_map */
 
 /*--------------------------------------------------------------------------
  NAME
-    HIcheckfileversion -- check version info for HDF file
+       HIclose_map -- remove the memory-mapping of a file
  USAGE
-    intn Hgetfileversion(file_id)
-    int32 file_id;      IN: handle of file
+       intn HIclose_map(file_rec)
+       filerec_t *file_rec;         IN: File record of the mapped file
  RETURNS
-    returns SUCCEED (0) if successful and FAIL (-1) if failed.
+       SUCCEED/FAIL
  DESCRIPTION
-    Checks that the file's version is current and update it if it isn't.
+       Unmaps the file, if it is mapped.  The next access to the file goes
+       through the file handle, with a fresh seek to the current offset.
 
 --------------------------------------------------------------------------*/
 static intn
-HIcheckfileversion(int32 file_id)
+HIclose_map(filerec_t *file_rec)
 {
-    filerec_t *file_rec;
-    uint32     lmajorv, lminorv, lrelease;
-    uint32     fmajorv, fminorv, frelease;
-    char       string[LIBVSTR_LEN + 1]; /* len 80+1  */
-    intn       newver    = 0;
-    intn       ret_value = SUCCEED;
+    intn ret_value = SUCCEED;
 
-    HEclear();
+#ifdef HI_MMAP_SUPPORTED
+    if (file_rec->map != NULL) {
+        HIdrop_flush(file_rec);
+        if (munmap((void *)file_rec->map, (size_t)file_rec->map_len) != 0)
+            ret_value = FAIL;
+        file_rec->map     = NULL;
+        file_rec->map_len = 0;
+        file_rec->last_op = H4_OP_UNKNOWN;
+    } /* end if */
+#else
+    (void)file_rec;
+#endif /* HI_MMAP_SUPPORTED */
 
-    file_rec = HAatom_object(file_id);
-    if (BADFREC(file_rec))
-        HGOTO_ERROR(DFE_ARGS, FAIL);
+    return ret_value;
+} /* HIclose_map */
 
-    /* get file version and set newver condition */
-    if (Hgetfileversion(file_id, &fmajorv, &fminorv, &frelease, string) != SUCCEED) {
-        newver = 1;
-        HEclear();
+/*--------------------------------------------------------------------------
+ NAME
+       HIadvise -- give the access pattern of a file to the system
+ USAGE
+       void HIadvise(file_rec, old_pattern, willneed)
+       filerec_t *file_rec;         IN: File record of the file
+       intn old_pattern;            IN: pattern the system was given before
+       intn willneed;               IN: whether to read the file in, if asked
+ DESCRIPTION
+       Gives the order the file is read in, see Hsetaccesspattern(), to
+       its descriptor and its mapping, unless it is that of old_pattern,
+       which is HDF_ACCESS_NORMAL for a descriptor or mapping just made.
+       With willneed, a file read with HDF_ACCESS_WILLNEED starts being
+       read in.  Files opened through a driver and parked files are left
+       alone, as is everything where the system has no such calls.
+
+--------------------------------------------------------------------------*/
+static void
+HIadvise(filerec_t *file_rec, intn old_pattern, intn willneed)
+{
+    intn order  = file_rec->pattern & (HDF_ACCESS_SEQUENTIAL | HDF_ACCESS_RANDOM);
+    intn reread = willneed && (file_rec->pattern & HDF_ACCESS_WILLNEED);
+
+    if (order == (old_pattern & (HDF_ACCESS_SEQUENTIAL | HDF_ACCESS_RANDOM)) && !reread)
+        return;
+
+#ifdef HI_FADVISE_SUPPORTED
+    if (file_rec->drv == NULL && !file_rec->parked) {
+        int fd = HI_FILENO(file_rec->file);
+
+        (void)posix_fadvise(fd, (off_t)0, (off_t)0,
+                            order == HDF_ACCESS_SEQUENTIAL ? POSIX_FADV_SEQUENTIAL
+                            : order == HDF_ACCESS_RANDOM   ? POSIX_FADV_RANDOM
+                                                           : POSIX_FADV_NORMAL);
+        if (reread)
+            (void)posix_fadvise(fd, (off_t)0, (off_t)0, POSIX_FADV_WILLNEED);
+    } /* end if */
+#endif /* HI_FADVISE_SUPPORTED */
+
+#ifdef HI_MADVISE_SUPPORTED
+    if (file_rec->map != NULL) {
+        (void)madvise((void *)file_rec->map, (size_t)file_rec->map_len,
+                      order == HDF_ACCESS_SEQUENTIAL ? MADV_SEQUENTIAL
+                      : order == HDF_ACCESS_RANDOM   ? MADV_RANDOM
+                                                     : MADV_NORMAL);
+        if (reread)
+            (void)madvise((void *)file_rec->map, (size_t)file_rec->map_len, MADV_WILLNEED);
     } /* end if */
+#endif /* HI_MADVISE_SUPPORTED */
+} /* HIadvise */
 
-    /* get library version */
-    Hgetlibversion(&lmajorv, &lminorv, &lrelease, string);
+/*--------------------------------------------------------------------------
+ NAME
+       HIdrop_behind -- note bytes read from a file dropping what it reads
+ USAGE
+       void HIdrop_behind(file_rec, offset, bytes)
+       filerec_t *file_rec;         IN: File record of the file
+       int32 offset;                IN: file offset of the bytes read
+       int32 bytes;                 IN: # of bytes read
+ DESCRIPTION
+       Called after each read from the descriptor or the mapping of a
+       file.  For a file read with HDF_ACCESS_DONTNEED, reads following
+       each other add up to an extent, which is dropped from the page
+       cache once HDROP_BEHIND_LEN long, or when a read does not follow it,
+       so that a scan makes one call per HDROP_BEHIND_LEN bytes.
 
-    /* check whether we need to update the file version tag */
-    if (lmajorv > fmajorv || (lmajorv == fmajorv && lminorv > fminorv) ||
-        (lmajorv == fmajorv && lminorv == fminorv && lrelease > frelease))
-        newver = 1;
-    if (newver == 1) {
-        file_rec->version.majorv  = lmajorv;
-        file_rec->version.minorv  = lminorv;
-        file_rec->version.release = lrelease;
-        HIstrncpy(file_rec->version.string, string, LIBVSTR_LEN + 1);
-        file_rec->version.modified = 1;
-    } /* end if */
+--------------------------------------------------------------------------*/
+static void
+HIdrop_behind(filerec_t *file_rec, int32 offset, int32 bytes)
+{
+    if (!(file_rec->pattern & HDF_ACCESS_DONTNEED) || bytes <= 0)
+        return;
 
-    file_rec->version_set = TRUE;
+    if (file_rec->drop_len > 0 && offset == file_rec->drop_off + file_rec->drop_len)
+        file_rec->drop_len += bytes;
+    else {
+        HIdrop_flush(file_rec);
+        file_rec->drop_off = offset;
+        file_rec->drop_len = bytes;
+    } /* end else */
 
-done:
-    return ret_value;
-} /* HIcheckfileversion */
+    if (file_rec->drop_len >= HDROP_BEHIND_LEN)
+        HIdrop_flush(file_rec);
+} /* HIdrop_behind */
 
 /*--------------------------------------------------------------------------
  NAME
-       HIget_filerec_node -- find a filerec for a FILE
+       HIdrop_flush -- drop the pages read from a file from the page cache
  USAGE
-       filerec_t *HIget_filerec_node(path)
-       char * path;             IN: name of file
- RETURNS
-       a file record or else NULL
+       void HIdrop_flush(file_rec)
+       filerec_t *file_rec;         IN: File record of the file
  DESCRIPTION
-       Search the file record array for a matching record, or allocate an
-       empty slot.
-       The file is considered the same if the path matches exactly.  This
-       routine is unable to detect aliases, or how to compare relative and
-       absolute paths.
+       Drops the extent noted by HIdrop_behind(), if any, from the mapping
+       of the file, then from the page cache.  Only the pages the extent
+       covers whole go; the system may keep those still used elsewhere.
 
 --------------------------------------------------------------------------*/
-static filerec_t *
-HIget_filerec_node(const char *path)
+static void
+HIdrop_flush(filerec_t *file_rec)
 {
-    filerec_t *ret_value = NULL;
+    int32 offset = file_rec->drop_off;
+    int32 length = file_rec->drop_len;
 
-    if ((ret_value = HAsearch_atom(FIDGROUP, HPcompare_filerec_path, path)) == NULL) {
-        if ((ret_value = (filerec_t *)calloc(1, sizeof(filerec_t))) == NULL)
-            HGOTO_ERROR(DFE_NOSPACE, NULL);
+    file_rec->drop_len = 0;
+    if (length <= 0 || file_rec->drv != NULL)
+        return;
 
-        if ((ret_value->path = (char *)strdup(path)) == NULL)
-            HGOTO_ERROR(DFE_NOSPACE, NULL);
+#ifdef HI_MADVISE_SUPPORTED
+    if (file_rec->map != NULL) {
+        off_t page  = (off_t)sysconf(_SC_PAGESIZE);
+        off_t start = page > 0 ? ((off_t)offset + page - 1) / page * page : 0;
+        off_t end   = page > 0 ? MIN((off_t)offset + length, (off_t)file_rec->map_len) / page * page : 0;
 
-        /* Initialize annotation stuff */
-        ret_value->an_tree[AN_DATA_LABEL] = NULL;
-        ret_value->an_tree[AN_DATA_DESC]  = NULL;
-        ret_value->an_tree[AN_FILE_LABEL] = NULL;
-        ret_value->an_tree[AN_FILE_DESC]  = NULL;
-        ret_value->an_num[AN_DATA_LABEL]  = -1;
-        ret_value->an_num[AN_DATA_DESC]   = -1;
-        ret_value->an_num[AN_FILE_LABEL]  = -1;
-        ret_value->an_num[AN_FILE_DESC]   = -1;
+        if (end > start)
+            (void)madvise((void *)(file_rec->map + start), (size_t)(end - start), MADV_DONTNEED);
     } /* end if */
+#endif /* HI_MADVISE_SUPPORTED */
+
+#ifdef HI_FADVISE_SUPPORTED
+    if (!file_rec->parked)
+        (void)posix_fadvise(HI_FILENO(file_rec->file), (off_t)offset, (off_t)length, POSIX_FADV_DONTNEED);
+#else
+    (void)offset;
+#endif /* HI_FADVISE_SUPPORTED */
+} /* HIdrop_flush */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HPfile_size -- get the length of a file
+ USAGE
+       int32 HPfile_size(file_rec)
+       filerec_t *file_rec;         IN: File record of the file
+ RETURNS
+       The length of the file, or FAIL
+ DESCRIPTION
+       Gets the length of the file from its handle or its driver, which
+       may differ from the end of its last element.  Files too large for an int32 offset
+       fail.  The next access to the file seeks again.
+
+--------------------------------------------------------------------------*/
+int32
+HPfile_size(filerec_t *file_rec)
+{
+    long  size;              /* length of the file */
+    int32 ret_value = FAIL;
+
+    if (file_rec->drv != NULL)
+        HGOTO_DONE((*file_rec->drv->size)(file_rec->drv_handle));
+
+    if (HIwbuf_flush(file_rec) == FAIL || HIfile_use(file_rec) == FAIL || HI_SEEKEND(file_rec->file) == FAIL)
+        HGOTO_DONE(FAIL);
+    size              = (long)HI_TELL(file_rec->file);
+    file_rec->last_op = H4_OP_UNKNOWN;
+    if (size < 0 || size > (long)INT32_MAX)
+        HGOTO_DONE(FAIL);
+    ret_value = (int32)size;
 
 done:
     return ret_value;
-} /* HIget_filerec_node */
+} /* HPfile_size */
 
 /*--------------------------------------------------------------------------
  NAME
-       HIrelease_filerec_node -- release/recycle a filerec
+       HIindex_path -- get the name of the sidecar index of a file
  USAGE
-       intn HIrelease_filerec_node(file_rec)
-       filerec_t *file_rec;         IN: File record to release
+       char *HIindex_path(path)
+       const char *path;            IN: Name of the file
  RETURNS
-       SUCCEED/FAIL
+       The name of the index, to be freed by the caller, or NULL
  DESCRIPTION
-        Release a file record back to the system
+       The index of a file is named after it, followed by HIDX_SUFFIX.  In
+       the directory set with Hsetindexcache(), it is named after the base
+       name of the file and its HPfile_stamp(); NULL is returned for a
+       file that cannot be stamped.
 
 --------------------------------------------------------------------------*/
-static intn
-HIrelease_filerec_node(filerec_t *file_rec)
+static char *
+HIindex_path(const char *path)
 {
-    /* Close file if it's opened */
-    if (file_rec->file != NULL)
-        HI_CLOSE(file_rec->file);
+    const char *base = path; /* base name of the file */
+    const char *p;
+    uint32      stamp;
+    size_t      len;
+    char       *ret_value;
+
+    if (index_dir == NULL) {
+        if ((ret_value = (char *)malloc(strlen(path) + strlen(HIDX_SUFFIX) + 1)) != NULL) {
+            strcpy(ret_value, path);
+            strcat(ret_value, HIDX_SUFFIX);
+        } /* end if */
+        return ret_value;
+    } /* end if */
 
-    /* Free all the components of the file record */
-    free(file_rec->path);
-    free(file_rec);
+    if ((stamp = HPfile_stamp(path)) == 0)
+        return NULL;
+    for (p = path; *p != '\0'; p++)
+        if (HI_IS_SEP(*p))
+            base = p + 1;
 
-    return SUCCEED;
-} /* HIrelease_filerec_node */
+    /* directory, separator, base name, '.', 8 hex digits, suffix and '\0' */
+    len = strlen(index_dir) + strlen(base) + strlen(HIDX_SUFFIX) + 11;
+    if ((ret_value = (char *)malloc(len)) != NULL)
+        snprintf(ret_value, len, "%s/%s.%08lx%s", index_dir, base, (unsigned long)stamp, HIDX_SUFFIX);
+
+    return ret_value;
+} /* HIindex_path */
 
 /*--------------------------------------------------------------------------
  NAME
-       HPisfile_in_use -- check if a FILE is currently in use
+       HIopen_index -- load the sidecar index of a file opened read-only
  USAGE
-       intn HPisfile_in_use(path)
-       const char * path;             IN: name of file
+       intn HIopen_index(file_rec)
+       filerec_t *file_rec;         IN: File record of the file
  RETURNS
-       TRUE if the file is in use or FALSE, otherwise.
+       SUCCEED/FAIL
  DESCRIPTION
-        Get its record if the file is opened, then check its
-        reference count to decide whether the file is currently in use.
+       Reads the whole index of the file, see Hwriteindex(), with one read
+       and decodes its extents, so that HP_read() can copy what they hold
+       out of memory.  The index of a file opened with the built-in file
+       access is mapped instead where possible, shared with the other
+       processes mapping it.  An index that is missing, damaged, of another
+       version or written for a file of another length fails, as does one
+       without the magic number of the file; the file is then read as
+       usual.
 
 --------------------------------------------------------------------------*/
-intn
-HPisfile_in_use(const char *path)
+static intn
+HIopen_index(filerec_t *file_rec)
 {
-    filerec_t *file_rec  = NULL;
-    intn       ret_value = FALSE;
+    char        *idx_path = NULL; /* name of the index */
+    hdf_file_t   f;               /* the index file */
+    uint8       *buf  = NULL;     /* contents of the index */
+    hfile_ext_t *exts = NULL;     /* its extents */
+    uint8       *p;               /* position in the header */
+    long         size;            /* length of the index */
+    int32        file_len;        /* length of the file */
+    int32        version;         /* version of the index */
+    int32        idx_file_len;    /* length of the file the index was written for */
+    int32        n_ext;           /* # of extents */
+    int32        data_off;        /* offset of the contents of an extent */
+    int32        map_len = 0;     /* length of the mapping of the index, if mapped */
+    int32        i;               /* loop index */
+    intn         ret_value = SUCCEED;
+
+    if ((file_len = HPfile_size(file_rec)) == FAIL)
+        HGOTO_DONE(FAIL);
+    if ((idx_path = HIindex_path(file_rec->path)) == NULL)
+        HGOTO_DONE(FAIL);
+
+    /* Read the whole index in, through the driver of the file, so that
+       the index of a remote file takes a single request */
+    if (file_rec->drv != NULL) {
+        const hdf_driver_t *drv    = file_rec->drv;
+        void               *handle = (*drv->open)(idx_path, DFACC_READ);
+
+        if (handle == NULL)
+            HGOTO_DONE(FAIL);
+        if ((size = (long)(*drv->size)(handle)) < HIDX_HDR_SZ || (buf = (uint8 *)malloc((size_t)size)) == NULL ||
+            (*drv->read)(handle, 0, buf, (int32)size) == FAIL) {
+            (*drv->close)(handle);
+            HGOTO_DONE(FAIL);
+        } /* end if */
+        (*drv->close)(handle);
+    } /* end if */
+    else {
+        f = (hdf_file_t)HI_OPEN(idx_path, DFACC_READ);
+        if (OPENERR(f))
+            HGOTO_DONE(FAIL);
+        if (HI_SEEKEND(f) == FAIL || (size = (long)HI_TELL(f)) < HIDX_HDR_SZ || size > (long)INT32_MAX) {
+            HI_CLOSE(f);
+            HGOTO_DONE(FAIL);
+        } /* end if */
+#ifdef HI_MMAP_SUPPORTED
+        {
+            void *map = mmap(NULL, (size_t)size, PROT_READ, MAP_SHARED, HI_FILENO(f), (off_t)0);
 
-    /* Search for the record of a file named "path". */
-    file_rec = (filerec_t *)HAsearch_atom(FIDGROUP, HPcompare_filerec_path, path);
+            if (map != MAP_FAILED) {
+                buf     = (uint8 *)map;
+                map_len = (int32)size;
+            } /* end if */
+        }
+#endif /* HI_MMAP_SUPPORTED */
+        if (buf == NULL && (HI_SEEK(f, 0) == FAIL || (buf = (uint8 *)malloc((size_t)size)) == NULL ||
+                            HI_READ(f, buf, (int32)size) == FAIL)) {
+            HI_CLOSE(f);
+            HGOTO_DONE(FAIL);
+        } /* end if */
+        HI_CLOSE(f);
+    } /* end else */
 
-    /* If the file is not found, it can't be in use, return FALSE */
-    if (file_rec == NULL)
-        ret_value = FALSE;
-    else if (file_rec->refcount) /* file is in use if ref count is not 0 */
-        ret_value = TRUE;
+    /* Check the header */
+    p = buf + 4;
+    INT32DECODE(p, version);
+    INT32DECODE(p, idx_file_len);
+    INT32DECODE(p, n_ext);
+    if (memcmp(buf, HIDX_MAGIC, 4) != 0 || version != HIDX_VERSION || idx_file_len != file_len ||
+        n_ext < 1 || n_ext > ((int32)size - HIDX_HDR_SZ) / HIDX_EXT_SZ)
+        HGOTO_DONE(FAIL);
+
+    /* Decode the extents, which must be in order, inside the file and
+       account for the rest of the index */
+    if ((exts = (hfile_ext_t *)malloc((size_t)n_ext * sizeof(hfile_ext_t))) == NULL)
+        HGOTO_DONE(FAIL);
+    data_off = HIDX_HDR_SZ + n_ext * HIDX_EXT_SZ;
+    for (i = 0; i < n_ext; i++) {
+        INT32DECODE(p, exts[i].offset);
+        INT32DECODE(p, exts[i].length);
+        if (exts[i].length <= 0 || exts[i].offset < (i == 0 ? 0 : exts[i - 1].offset + exts[i - 1].length) ||
+            exts[i].length > file_len - exts[i].offset || exts[i].length > (int32)size - data_off)
+            HGOTO_DONE(FAIL);
+        exts[i].buf = buf + data_off;
+        data_off += exts[i].length;
+    } /* end for */
+    if (data_off != (int32)size || exts[0].offset != 0 || exts[0].length < MAGICLEN ||
+        memcmp(exts[0].buf, HDFMAGIC, MAGICLEN) != 0)
+        HGOTO_DONE(FAIL);
+
+    file_rec->idx     = exts;
+    file_rec->idx_n   = n_ext;
+    file_rec->idx_buf = buf;
+    file_rec->idx_map = map_len;
+    exts              = NULL;
+    buf               = NULL;
 
+done:
+    free(idx_path);
+    free(exts);
+#ifdef HI_MMAP_SUPPORTED
+    if (map_len > 0 && buf != NULL) {
+        munmap((void *)buf, (size_t)map_len);
+        buf = NULL;
+    } /* end if */
+#endif /* HI_MMAP_SUPPORTED */
+    free(buf);
     return ret_value;
-} /* HPisfile_in_use */
+} /* HIopen_index */
 
 /*--------------------------------------------------------------------------
  NAME
-       HPcompare_filerec_path -- compare filerec objects for the atom API
+       HIclose_index -- drop the sidecar index of a file
  USAGE
-       intn HPcompare_filerec_path(obj, key)
-       const void * obj;             IN: pointer to the file record
-       const void * key;             IN: pointer to the name of file
+       void HIclose_index(file_rec)
+       filerec_t *file_rec;         IN: File record of the file
  RETURNS
-       TRUE if the key matches the obj, FALSE otherwise
+       none
  DESCRIPTION
-       Look inside the file record for the atom API and compare the the
-       paths.
+       Frees the index of the file, if it has one.  All reads then go to
+       the file.
+
 --------------------------------------------------------------------------*/
-intn
-HPcompare_filerec_path(const void *obj, const void *key)
+static void
+HIclose_index(filerec_t *file_rec)
 {
-    const filerec_t *frec      = obj;
-    const char      *fname     = key;
-    intn             ret_value = FALSE; /* set default as FALSE */
-
-    /* check args */
-    if (frec != NULL && fname != NULL) {
-        /* check bad file record */
-        if (BADFREC(frec))
-            ret_value = FALSE;
-        else {
-            if (!strcmp(frec->path, fname))
-                ret_value = TRUE;
-            else
-                ret_value = FALSE;
-        }
-    }
-
-    return ret_value;
-} /* HPcompare_filerec_path */
+    free(file_rec->idx);
+#ifdef HI_MMAP_SUPPORTED
+    if (file_rec->idx_map > 0)
+        munmap((void *)file_rec->idx_buf, (size_t)file_rec->idx_map);
+    else
+#endif /* HI_MMAP_SUPPORTED */
+        free(file_rec->idx_buf);
+    file_rec->idx     = NULL;
+    file_rec->idx_n   = 0;
+    file_rec->idx_buf = NULL;
+    file_rec->idx_map = 0;
+} /* HIclose_index */
 
 /*--------------------------------------------------------------------------
  NAME
-       HPcompare_accrec_tagref -- compare accrec objects for the atom API
+       HIwrite_index -- write the sidecar index of a file
  USAGE
-       intn HPcompare_accrec_tagref(obj, key)
-       const void * rec1;            IN: pointer to the access record #1
-       const void * rec2;            IN: pointer to the access record #2
+       intn HIwrite_index(file_rec, max_len)
+       filerec_t *file_rec;         IN: File record of the file
+       int32 max_len;               IN: length of the longest element to index
  RETURNS
-       TRUE if tag/ref of rec1 matches the tag/ref of rec2, FALSE otherwise
+       SUCCEED/FAIL
  DESCRIPTION
-       Look inside the access record for the atom API and compare the the
-       paths.
+       Writes the index of the file as it is on disk, see Hwriteindex(),
+       where HIindex_path() names it.
+
 --------------------------------------------------------------------------*/
-intn
-HPcompare_accrec_tagref(const void *rec1, const void *rec2)
+static intn
+HIwrite_index(filerec_t *file_rec, int32 max_len)
 {
-    uint16 tag1, ref1;        /* tag/ref of access record #1 */
-    uint16 tag2, ref2;        /* tag/ref of access record #2 */
-    intn   ret_value = FALSE; /* FAIL */
+    ddblock_t   *block;            /* DD block being indexed */
+    hfile_ext_t *exts     = NULL;  /* extents of the index */
+    uint8       *buf      = NULL;  /* the index */
+    uint8       *p;                /* position in the index */
+    char        *idx_path = NULL;  /* name of the index */
+    char        *tmp_path = NULL;  /* name it is written under first */
+    size_t       tmp_len;          /* room in tmp_path */
+    hdf_file_t   f;                /* the index file */
+    int32        file_len;         /* length of the file */
+    int32        max_ext  = 1;     /* room in exts */
+    int32        n_ext    = 0;     /* # of extents */
+    int32        idx_len  = 0;     /* length of the index */
+    int32        i, j;             /* loop indices */
+    intn         ret_value = SUCCEED;
+
+    if ((file_len = HPfile_size(file_rec)) == FAIL)
+        HGOTO_ERROR(DFE_SEEKERROR, FAIL);
 
-    if (rec1 != rec2) {
-        if (HTPinquire(((const accrec_t *)rec1)->ddid, &tag1, &ref1, NULL, NULL) == FAIL)
-            HGOTO_ERROR(DFE_INTERNAL, FALSE);
+    /* Collect the magic number, the DD blocks and the small elements */
+    for (block = file_rec->ddhead; block != NULL; block = block->next)
+        max_ext += 1 + block->ndds;
+    if ((exts = (hfile_ext_t *)malloc((size_t)max_ext * sizeof(hfile_ext_t))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
-        if (HTPinquire(((const accrec_t *)rec2)->ddid, &tag2, &ref2, NULL, NULL) == FAIL)
-            HGOTO_ERROR(DFE_INTERNAL, FALSE);
+    exts[n_ext].offset   = 0;
+    exts[n_ext++].length = MAGICLEN;
+    for (block = file_rec->ddhead; block != NULL; block = block->next) {
+        exts[n_ext].offset   = block->myoffset;
+        exts[n_ext++].length = NDDS_SZ + OFFSET_SZ + block->ndds * DD_SZ;
+        for (i = 0; i < block->ndds; i++) {
+            dd_t *dd = &block->ddlist[i];
+
+            if (dd->tag == DFTAG_NULL || dd->offset == INVALID_OFFSET || dd->offset < MAGICLEN ||
+                dd->length <= 0 || dd->length > max_len || dd->length > file_len - dd->offset)
+                continue;
+            exts[n_ext].offset   = dd->offset;
+            exts[n_ext++].length = dd->length;
+        } /* end for */
+    }     /* end for */
+
+    /* Merge the extents that overlap or touch */
+    qsort(exts, (size_t)n_ext, sizeof(hfile_ext_t), HIreadv_compare);
+    for (i = 0, j = 1; j < n_ext; j++) {
+        if (exts[j].offset <= exts[i].offset + exts[i].length) {
+            if (exts[j].offset + exts[j].length > exts[i].offset + exts[i].length)
+                exts[i].length = exts[j].offset + exts[j].length - exts[i].offset;
+        } /* end if */
+        else
+            exts[++i] = exts[j];
+    } /* end for */
+    n_ext = i + 1;
+
+    /* The extents do not overlap, so their contents add up to at most the
+       length of the file */
+    idx_len = HIDX_HDR_SZ + n_ext * HIDX_EXT_SZ;
+    for (i = 0; i < n_ext; i++) {
+        if (exts[i].length > INT32_MAX - idx_len)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        idx_len += exts[i].length;
+    } /* end for */
+    if ((buf = (uint8 *)malloc((size_t)idx_len)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
-        if (((const accrec_t *)rec1)->file_id == ((const accrec_t *)rec2)->file_id && tag1 == tag2 &&
-            ref1 == ref2)
-            HGOTO_DONE(TRUE);
+    /* Encode the header and the extents, and read their contents in */
+    p = buf;
+    memcpy(p, HIDX_MAGIC, 4);
+    p += 4;
+    INT32ENCODE(p, HIDX_VERSION);
+    INT32ENCODE(p, file_len);
+    INT32ENCODE(p, n_ext);
+    for (i = 0; i < n_ext; i++) {
+        INT32ENCODE(p, exts[i].offset);
+        INT32ENCODE(p, exts[i].length);
+    } /* end for */
+    for (i = 0; i < n_ext; i++) {
+        exts[i].buf = p;
+        p += exts[i].length;
+    } /* end for */
+    if (HPread_batch(file_rec, n_ext, exts) == FAIL)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
+
+    /* Write the index next to the file or in the directory of indexes,
+       under a name of its own first, then replace the old index at once:
+       other processes may have it mapped, see HIopen_index() */
+    if ((idx_path = HIindex_path(file_rec->path)) == NULL)
+        HGOTO_ERROR(DFE_BADNAME, FAIL);
+    tmp_len = strlen(idx_path) + 16;
+    if ((tmp_path = (char *)malloc(tmp_len)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    snprintf(tmp_path, tmp_len, "%s.%ld", idx_path, (long)HI_GETPID());
+    f = (hdf_file_t)HI_CREATE(tmp_path);
+    if (OPENERR(f))
+        HGOTO_ERROR(DFE_BADOPEN, FAIL);
+    if (HI_WRITE(f, buf, idx_len) == FAIL) {
+        HI_CLOSE(f);
+        remove(tmp_path);
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    } /* end if */
+    if (HI_CLOSE(f) == FAIL) {
+        remove(tmp_path);
+        HGOTO_ERROR(DFE_CANTCLOSE, FAIL);
+    } /* end if */
+    if (rename(tmp_path, idx_path) != 0 && (remove(idx_path) != 0 || rename(tmp_path, idx_path) != 0)) {
+        remove(tmp_path);
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
     } /* end if */
 
 done:
+    free(tmp_path);
+    free(idx_path);
+    free(buf);
+    free(exts);
     return ret_value;
-} /* HPcompare_accrec_tagref */
+} /* HIwrite_index */
 
 /*--------------------------------------------------------------------------
  NAME
-       HIvalid_magic -- verify the magic number in a file
+       HIread_index -- read from the sidecar index of a file
  USAGE
-       int32 HIvalid_magic(path)
-       hdf_file_t file;             IN: FILE pointer
+       intn HIread_index(file_rec, offset, buf, bytes)
+       filerec_t *file_rec;         IN: File record of the file
+       int32 offset;                IN: offset of the bytes in the file
+       void *buf;                   OUT: where the data goes
+       int32 bytes;                 IN: # of bytes to read
  RETURNS
-       TRUE if valid magic number else FALSE
+       SUCCEED when the index holds the bytes, FAIL otherwise
  DESCRIPTION
-       Given an open file pointer, see if the first four bytes of the
-       file are the HDF "magic number" HDFMAGIC
+       Looks the offset up in the extents of the index of the file and
+       copies the bytes out when a single extent holds them all.  The
+       file position is left alone.
 
 --------------------------------------------------------------------------*/
 static intn
-HIvalid_magic(hdf_file_t file)
+HIread_index(filerec_t *file_rec, int32 offset, void *buf, int32 bytes)
 {
-    char b[MAGICLEN];       /* Temporary buffer */
-    intn ret_value = FALSE; /* FAIL */
-
-    /* Seek to beginning of the file. */
-    if (HI_SEEK(file, 0) == FAIL)
-        HGOTO_ERROR(DFE_SEEKERROR, FALSE);
-
-    /* Read in magic cookie and compare. */
-    if (HI_READ(file, b, MAGICLEN) == FAIL)
-        HGOTO_ERROR(DFE_READERROR, FALSE);
-
-    if (NSTREQ(b, HDFMAGIC, MAGICLEN))
-        ret_value = TRUE;
-
-done:
-    return ret_value;
-}
+    hfile_ext_t *ext; /* extent holding the offset */
+    int32        lo = 0;
+    int32        hi = file_rec->idx_n - 1;
+
+    /* Find the last extent starting at or before the offset */
+    while (lo < hi) {
+        int32 mid = (lo + hi + 1) / 2;
+
+        if (file_rec->idx[mid].offset <= offset)
+            lo = mid;
+        else
+            hi = mid - 1;
+    } /* end while */
+    ext = &file_rec->idx[lo];
+
+    if (bytes < 0 || offset < ext->offset || bytes > ext->length - (offset - ext->offset))
+        return FAIL;
+    memcpy(buf, ext->buf + (offset - ext->offset), (size_t)bytes);
+    return SUCCEED;
+} /* HIread_index */
 
 /*--------------------------------------------------------------------------
  NAME
@@ -2781,14 +6443,17 @@ HIget_access_rec(void)
     HEclear();
 
     /* Grab from free list if possible */
+    HL_LOCK_LIBRARY();
     if (accrec_free_list != NULL) {
         ret_value        = accrec_free_list;
         accrec_free_list = accrec_free_list->next;
+        HDmem_release(HDF_MEM_FREE_LISTS, sizeof(accrec_t));
     } /* end if */
-    else {
+    HL_UNLOCK_LIBRARY();
+    if (ret_value == NULL) {
         if ((ret_value = (accrec_t *)malloc(sizeof(accrec_t))) == NULL)
             HGOTO_ERROR(DFE_NOSPACE, NULL);
-    } /* end else */
+    } /* end if */
 
     /* Initialize to zeros */
     memset(ret_value, 0, sizeof(accrec_t));
@@ -2811,9 +6476,16 @@ done:
 void
 HIrelease_accrec_node(accrec_t *acc)
 {
+    /* Drop the sieve buffer, see Hsetsievebuf() */
+    free(acc->sieve_buf);
+    acc->sieve_buf = NULL;
+
     /* Insert the atom at the beginning of the free list */
+    HL_LOCK_LIBRARY();
     acc->next        = accrec_free_list;
     accrec_free_list = acc;
+    HDmem_acquire(HDF_MEM_FREE_LISTS, sizeof(accrec_t));
+    HL_UNLOCK_LIBRARY();
 } /* end HIrelease_accrec_node() */
 
 /*--------------------------------------------------------------------------
@@ -2927,6 +6599,138 @@ done:
     return ret_value;
 } /* HIread_version */
 
+/*-----------------------------------------------------------------------
+NAME
+   HIfree_compare_off --- Compare two unused extents by offset
+USAGE
+   intn HIfree_compare_off(k1, k2, cmparg)
+   void *k1, *k2;           IN: ptrs to the extents
+   intn cmparg;             IN: unused
+RETURNS
+   <0, 0, >0 as k1 starts before, at or after k2.
+-------------------------------------------------------------------------*/
+static intn
+HIfree_compare_off(void *k1, void *k2, intn cmparg)
+{
+    int32 off1 = ((hfile_free_t *)k1)->offset;
+    int32 off2 = ((hfile_free_t *)k2)->offset;
+
+    (void)cmparg;
+
+    return (off1 < off2) ? -1 : (off1 > off2) ? 1 : 0;
+} /* HIfree_compare_off() */
+
+/*-----------------------------------------------------------------------
+NAME
+   HIfree_compare_size --- Compare two unused extents by length
+USAGE
+   intn HIfree_compare_size(k1, k2, cmparg)
+   void *k1, *k2;           IN: ptrs to the extents
+   intn cmparg;             IN: unused
+RETURNS
+   <0, 0, >0 as k1 is shorter, the same or longer than k2.  Extents of
+   the same length are ordered by offset.
+-------------------------------------------------------------------------*/
+static intn
+HIfree_compare_size(void *k1, void *k2, intn cmparg)
+{
+    hfile_free_t *e1 = (hfile_free_t *)k1;
+    hfile_free_t *e2 = (hfile_free_t *)k2;
+
+    (void)cmparg;
+
+    if (e1->length != e2->length)
+        return (e1->length < e2->length) ? -1 : 1;
+    if (e1->offset != e2->offset)
+        return (e1->offset < e2->offset) ? -1 : 1;
+    return 0;
+} /* HIfree_compare_size() */
+
+/*-----------------------------------------------------------------------
+NAME
+   HIfree_find --- Find the neighbour of a key in a tree of extents
+USAGE
+   TBBT_NODE *HIfree_find(tree, key, by_size, above)
+   TBBT_TREE *tree;         IN: free_by_off or free_by_size tree
+   void *key;               IN: key to look for
+   intn by_size;            IN: TRUE for the free_by_size tree
+   intn above;              IN: TRUE for the first node at or above
+                                the key, FALSE for the last node at
+                                or below it
+RETURNS
+   The node found or NULL.
+-------------------------------------------------------------------------*/
+static TBBT_NODE *
+HIfree_find(TBBT_TREE *tree, void *key, intn by_size, intn above)
+{
+    TBBT_NODE *node;
+    TBBT_NODE *parent = NULL;
+    intn       cmp;
+
+    if ((node = tbbtdfind(tree, key, &parent)) != NULL || parent == NULL)
+        return node;
+
+    /* the key would go next to 'parent', on the side the key compares */
+    if (by_size)
+        cmp = HIfree_compare_size(key, parent->key, 0);
+    else
+        cmp = HIfree_compare_off(key, parent->key, 0);
+    if (above)
+        return (cmp < 0) ? parent : tbbtnext(parent);
+    return (cmp > 0) ? parent : tbbtprev(parent);
+} /* HIfree_find() */
+
+/*-----------------------------------------------------------------------
+NAME
+   HIfree_insert --- Add an unused extent to the trees of a file
+USAGE
+   intn HIfree_insert(file_rec, ext)
+   filerec_t *file_rec;     IN: ptr to the file record
+   hfile_free_t *ext;       IN: the extent, owned by the trees after
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) if failed.
+-------------------------------------------------------------------------*/
+static intn
+HIfree_insert(filerec_t *file_rec, hfile_free_t *ext)
+{
+    intn ret_value = SUCCEED;
+
+    if (file_rec->free_by_off == NULL) {
+        if ((file_rec->free_by_off = tbbtdmake(HIfree_compare_off, 0, 0)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if ((file_rec->free_by_size = tbbtdmake(HIfree_compare_size, 0, 0)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    } /* end if */
+
+    if (tbbtdins(file_rec->free_by_off, ext, ext) == NULL)
+        HGOTO_ERROR(DFE_TBBTINS, FAIL);
+    if (tbbtdins(file_rec->free_by_size, ext, ext) == NULL) {
+        tbbtrem((TBBT_NODE **)file_rec->free_by_off, tbbtdfind(file_rec->free_by_off, ext, NULL),
+                NULL);
+        HGOTO_ERROR(DFE_TBBTINS, FAIL);
+    } /* end if */
+
+done:
+    return ret_value;
+} /* HIfree_insert() */
+
+/*-----------------------------------------------------------------------
+NAME
+   HIfree_remove --- Take an unused extent out of the trees of a file
+USAGE
+   void HIfree_remove(file_rec, ext)
+   filerec_t *file_rec;     IN: ptr to the file record
+   hfile_free_t *ext;       IN: the extent, owned by the caller after
+RETURNS
+   Nothing
+-------------------------------------------------------------------------*/
+static void
+HIfree_remove(filerec_t *file_rec, hfile_free_t *ext)
+{
+    tbbtrem((TBBT_NODE **)file_rec->free_by_off, tbbtdfind(file_rec->free_by_off, ext, NULL), NULL);
+    tbbtrem((TBBT_NODE **)file_rec->free_by_size, tbbtdfind(file_rec->free_by_size, ext, NULL), NULL);
+} /* HIfree_remove() */
+
 /*-----------------------------------------------------------------------
 NAME
    HPgetdiskblock --- Get the offset of a free block in the file.
@@ -2940,24 +6744,120 @@ USAGE
 RETURNS
    returns offset of block in the file if successful, FAIL (-1) if failed.
 DESCRIPTION
-   Used to "allocate" space in the file.  Currently, it just appends
-   blocks to the end of the file willy-nilly.  At some point in the
-   future, this could be changed to use a "real" free-list of empty
-   blocks in the file and dole those out.
+   Used to "allocate" space in the file.  The smallest extent released
+   with HPfreediskblock() or reserved with Hreservespace() since the file
+   was opened that is big enough is used, from its start; without one
+   the block is appended to the end of the file.  In a file with an
+   alignment, see Hsetalignment(), the first extent big enough is used
+   instead, and blocks that are to be aligned are always appended.
 
 -------------------------------------------------------------------------*/
 int32
 HPgetdiskblock(filerec_t *file_rec, int32 block_size, intn moveto)
+{
+#ifndef DISKBLOCK_DEBUG
+    TBBT_NODE    *node;
+    hfile_free_t *ext;
+    hfile_free_t  key;
+#endif /* DISKBLOCK_DEBUG */
+    intn  aligned;
+    int32 ret_value = SUCCEED;
+
+    /* check for valid arguments */
+    if (file_rec == NULL || block_size < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    aligned = (file_rec->alignment > 0 && block_size > 0 && block_size >= file_rec->align_threshold);
+
+#ifndef DISKBLOCK_DEBUG
+    /* best fit among the unused extents of the file, or the first fit in an
+       aligned file to keep its small elements together at the front */
+    if (!aligned && block_size > 0 && file_rec->free_by_size != NULL && file_rec->stream == NULL) {
+        if (file_rec->alignment > 0) {
+            for (node = tbbtfirst((TBBT_NODE *)*(file_rec->free_by_off)); node != NULL; node = tbbtnext(node))
+                if (((hfile_free_t *)node->data)->length >= block_size)
+                    break;
+        } /* end if */
+        else {
+            key.length = block_size;
+            key.offset = 0;
+            node       = HIfree_find(file_rec->free_by_size, &key, TRUE, TRUE);
+        } /* end else */
+        if (node != NULL) {
+            ext       = (hfile_free_t *)node->data;
+            ret_value = ext->offset;
+
+            /* keep what is left of the extent */
+            HIfree_remove(file_rec, ext);
+            if (ext->length > block_size) {
+                ext->offset += block_size;
+                ext->length -= block_size;
+                if (HIfree_insert(file_rec, ext) == FAIL)
+                    free(ext); /* the rest is just not reused */
+            }                  /* end if */
+            else
+                free(ext);
+
+            if (moveto == TRUE && HPseek(file_rec, ret_value) == FAIL)
+                HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+            HGOTO_DONE(ret_value);
+        } /* end if */
+    }     /* end if */
+#endif    /* DISKBLOCK_DEBUG */
+
+    if ((ret_value = HIgetendblock(file_rec, block_size, aligned, moveto)) == FAIL)
+        HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+
+done:
+    return ret_value;
+} /* HPgetdiskblock() */
+
+/*-----------------------------------------------------------------------
+NAME
+   HIgetendblock --- Get a block at the end of the file.
+USAGE
+   int32 HIgetendblock(file_rec, block_size, aligned, moveto)
+   filerec_t *file_rec;     IN: ptr to the file record
+   int32 block_size;        IN: size of the block needed
+   intn aligned;            IN: whether the block starts at a multiple
+                                of the alignment of the file
+   intn moveto;             IN: whether to move the file position
+                                to the allocated position or leave
+                                it undefined.
+RETURNS
+   returns offset of block in the file if successful, FAIL (-1) if failed.
+DESCRIPTION
+   Appends a block to the end of the file.  Used by HPgetdiskblock() and
+   for elements that may grow in place, which must be at the end.  The
+   space skipped to align the block is left unused.  The file cannot
+   grow past MAX_FILE_OFFSET.
+
+-------------------------------------------------------------------------*/
+static int32
+HIgetendblock(filerec_t *file_rec, int32 block_size, intn aligned, intn moveto)
 {
     uint8 temp;
+    int32 pad       = 0; /* bytes skipped to align the block */
     int32 ret_value = SUCCEED;
 
     /* check for valid arguments */
     if (file_rec == NULL || block_size < 0)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
+    if (aligned && file_rec->alignment > 0 && file_rec->f_end_off % file_rec->alignment != 0)
+        pad = file_rec->alignment - file_rec->f_end_off % file_rec->alignment;
+
 #ifdef DISKBLOCK_DEBUG
     block_size += (DISKBLOCK_HSIZE + DISKBLOCK_TSIZE);
+#endif /* DISKBLOCK_DEBUG */
+
+    /* the DDs could not record space past MAX_FILE_OFFSET */
+    if (pad > MAX_FILE_OFFSET - file_rec->f_end_off ||
+        block_size > MAX_FILE_OFFSET - file_rec->f_end_off - pad)
+        HGOTO_ERROR(DFE_BADLEN, FAIL);
+    file_rec->f_end_off += pad;
+
+#ifdef DISKBLOCK_DEBUG
     /* get the offset of the allocated block */
     ret_value = file_rec->f_end_off + DISKBLOCK_HSIZE;
 #else  /* DISKBLOCK_DEBUG */
@@ -3003,7 +6903,66 @@ HPgetdiskblock(filerec_t *file_rec, int32 block_size, intn moveto)
 
 done:
     return ret_value;
-} /* HPgetdiskblock() */
+} /* HIgetendblock() */
+
+/*-----------------------------------------------------------------------
+NAME
+   HIrelocate --- Move a growing element of an aligned file
+USAGE
+   intn HIrelocate(file_rec, access_rec, data_off, data_len, new_len)
+   filerec_t *file_rec;     IN: ptr to the file record
+   accrec_t *access_rec;    IN: access record of the element
+   int32 data_off;          IN: current offset of the element
+   int32 data_len;          IN: current length of the element
+   int32 new_len;           IN: length the element grows to
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) if failed.
+DESCRIPTION
+   Used by Hwrite() in files with an alignment, see Hsetalignment(), for
+   an element shorter than the threshold that grows.  An empty element
+   is placed like a new one of new_len bytes, any other gets a block at
+   the end of the file, aligned once new_len reaches the threshold, and
+   its data is copied there.  The old space is released.  Only elements
+   shorter than the threshold are moved, so the copy is short.
+
+-------------------------------------------------------------------------*/
+static intn
+HIrelocate(filerec_t *file_rec, accrec_t *access_rec, int32 data_off, int32 data_len, int32 new_len)
+{
+    uint8 *buf = NULL; /* the data being moved */
+    int32  new_off;    /* offset of the new block */
+    intn   ret_value = SUCCEED;
+
+    if (data_len > 0) {
+        if ((buf = (uint8 *)malloc((size_t)data_len)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if (HPseek(file_rec, data_off) == FAIL)
+            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+        if (HP_read(file_rec, buf, data_len) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        new_off = HIgetendblock(file_rec, new_len, new_len >= file_rec->align_threshold, FALSE);
+    } /* end if */
+    else
+        new_off = HPgetdiskblock(file_rec, new_len, FALSE);
+    if (new_off == FAIL)
+        HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+
+    if (data_len > 0) {
+        if (HPseek(file_rec, new_off) == FAIL)
+            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+        if (HP_write(file_rec, buf, data_len) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    } /* end if */
+
+    if (HTPupdate(access_rec->ddid, new_off, new_len) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (HPfreediskblock(file_rec, data_off, data_len) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+done:
+    free(buf);
+    return ret_value;
+} /* HIrelocate() */
 
 /*-----------------------------------------------------------------------
 NAME
@@ -3016,19 +6975,80 @@ USAGE
 RETURNS
    returns SUCCEED (0) if successful, FAIL (-1) if failed.
 DESCRIPTION
-   Used to "release" space in the file.  Currently, it does nothing.
-   At some point in the future, this could be changed to add the block
-   to a "real" free-list of empty blocks in the file and manage those.
+   Used to "release" space in the file, which must not be used by any
+   element anymore.  The space is merged with the unused extents next to
+   it and handed out again by HPgetdiskblock(); space at the end of the
+   file moves the end back instead.  The unused extents are only known
+   while the file is open, they are not recorded in the file.
 
 -------------------------------------------------------------------------*/
 intn
 HPfreediskblock(filerec_t *file_rec, int32 block_off, int32 block_size)
 {
+#ifndef DISKBLOCK_DEBUG
+    TBBT_NODE    *node;
+    hfile_free_t *ext = NULL;
+    hfile_free_t *nbr;
+#endif /* DISKBLOCK_DEBUG */
     intn ret_value = SUCCEED;
 
-    (void)file_rec;
+    if (file_rec == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+#ifndef DISKBLOCK_DEBUG
+    /* nothing to release, or not space the library handed out */
+    if (block_off == INVALID_OFFSET || block_size <= 0 || block_off < MAGICLEN ||
+        block_size > file_rec->f_end_off - block_off)
+        HGOTO_DONE(SUCCEED);
+
+    if ((ext = (hfile_free_t *)malloc(sizeof(hfile_free_t))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    ext->offset = block_off;
+    ext->length = block_size;
+
+    /* merge with the extent before, then the one after */
+    if (file_rec->free_by_off != NULL) {
+        if ((node = HIfree_find(file_rec->free_by_off, ext, FALSE, FALSE)) != NULL) {
+            nbr = (hfile_free_t *)node->data;
+            if (nbr->offset + nbr->length > ext->offset) /* released twice */
+                HGOTO_DONE(SUCCEED);
+            if (nbr->offset + nbr->length == ext->offset) {
+                HIfree_remove(file_rec, nbr);
+                ext->offset = nbr->offset;
+                ext->length += nbr->length;
+                free(nbr);
+            } /* end if */
+        }     /* end if */
+        if ((node = HIfree_find(file_rec->free_by_off, ext, FALSE, TRUE)) != NULL) {
+            nbr = (hfile_free_t *)node->data;
+            if (ext->offset + ext->length > nbr->offset) /* released twice */
+                HGOTO_DONE(SUCCEED);
+            if (ext->offset + ext->length == nbr->offset) {
+                HIfree_remove(file_rec, nbr);
+                ext->length += nbr->length;
+                free(nbr);
+            } /* end if */
+        }     /* end if */
+    }         /* end if */
+
+    /* space at the end of the file just makes the file end earlier */
+    if (ext->offset + ext->length == file_rec->f_end_off) {
+        file_rec->f_end_off = ext->offset;
+        HGOTO_DONE(SUCCEED);
+    } /* end if */
+
+    if (HIfree_insert(file_rec, ext) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    ext = NULL;
+#else  /* DISKBLOCK_DEBUG */
     (void)block_off;
     (void)block_size;
+#endif /* DISKBLOCK_DEBUG */
+
+done:
+#ifndef DISKBLOCK_DEBUG
+    free(ext);
+#endif /* DISKBLOCK_DEBUG */
 
     return ret_value;
 } /* HPfreediskblock() */
@@ -3052,11 +7072,14 @@ HPfreediskblock(filerec_t *file_rec, int32 block_off, int32 block_size)
 int32
 HDget_special_info(int32 access_id, sp_info_block_t *info_block)
 {
-    accrec_t *access_rec; /* access record */
-    int32     ret_value = FAIL;
+    accrec_t  *access_rec; /* access record */
+    filerec_t *locked    = NULL;
+    int32      ret_value = FAIL;
 
     /* clear error stack and check validity of access id */
     HEclear();
+    locked = HL_LOCK_AID(access_id);
+
     access_rec = HAatom_object(access_id);
     if (access_rec == (accrec_t *)NULL || info_block == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
@@ -3068,6 +7091,7 @@ HDget_special_info(int32 access_id, sp_info_block_t *info_block)
         info_block->key = FAIL;
 
 done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* HDget_special_info */
 
@@ -3092,11 +7116,14 @@ done:
 int32
 HDset_special_info(int32 access_id, sp_info_block_t *info_block)
 {
-    accrec_t *access_rec; /* access record */
-    int32     ret_value = FAIL;
+    accrec_t  *access_rec; /* access record */
+    filerec_t *locked    = NULL;
+    int32      ret_value = FAIL;
 
     /* clear error stack and check validity of access id */
     HEclear();
+    locked = HL_LOCK_AID(access_id);
+
     access_rec = HAatom_object(access_id);
     if (access_rec == (accrec_t *)NULL || info_block == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
@@ -3107,6 +7134,7 @@ HDset_special_info(int32 access_id, sp_info_block_t *info_block)
 
     /* else is not special so fail */
 done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* HDset_special_info */
 
@@ -3132,15 +7160,25 @@ Hshutdown(void)
 {
     accrec_t *curr;
 
+    /* Close the files kept open */
+    HL_LOCK_FILES();
+    kept_max = 0;
+    HIkept_trim();
+    kept_max = KEEP_OPEN_FILES;
+    HL_UNLOCK_FILES();
+
     /* Release the free-list if it exists */
+    HL_LOCK_LIBRARY();
     if (accrec_free_list != NULL) {
         while (accrec_free_list != NULL && accrec_free_list != accrec_free_list->next) {
             curr             = accrec_free_list;
             accrec_free_list = accrec_free_list->next;
             curr->next       = NULL;
             free(curr);
+            HDmem_release(HDF_MEM_FREE_LISTS, sizeof(accrec_t));
         }
     }
+    HL_UNLOCK_LIBRARY();
 
     return SUCCEED;
 } /* end Hshutdown() */
@@ -3187,24 +7225,172 @@ HP_read(filerec_t *file_rec, void *buf, int32 bytes)
 {
     intn ret_value = SUCCEED;
 
+    HP_TRACE(HDF_TRACE_READ, FALSE, bytes);
+
+    /* A file created for streaming reads what it still holds */
+    if (file_rec->stream != NULL) {
+        if (HIstream_read(file_rec, file_rec->f_cur_off, (uint8 *)buf, bytes) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        file_rec->f_cur_off += bytes;
+        file_rec->last_op = H4_OP_READ;
+        file_rec->stats.bytes_read += (uint32)bytes;
+        HGOTO_DONE(SUCCEED);
+    } /* end if */
+
+    /* Copy straight out of the mapping of a mapped file */
+    if (file_rec->map != NULL) {
+        if (bytes < 0 || file_rec->f_cur_off < 0 || bytes > file_rec->map_len - file_rec->f_cur_off)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        memcpy(buf, file_rec->map + file_rec->f_cur_off, (size_t)bytes);
+        HIdrop_behind(file_rec, file_rec->f_cur_off, bytes);
+        file_rec->f_cur_off += bytes;
+        file_rec->last_op = H4_OP_READ;
+        file_rec->stats.bytes_read += (uint32)bytes;
+        HGOTO_DONE(SUCCEED);
+    } /* end if */
+
+    /* Copy out of the sidecar index what it holds; the file position
+       is not moved, so the next read from the file seeks again */
+    if (file_rec->idx != NULL && HIread_index(file_rec, file_rec->f_cur_off, buf, bytes) == SUCCEED) {
+        file_rec->f_cur_off += bytes;
+        file_rec->last_op = H4_OP_UNKNOWN;
+        HGOTO_DONE(SUCCEED);
+    } /* end if */
+
+    /* A driver reads at an offset: there is no file position to move */
+    if (file_rec->drv != NULL) {
+        file_rec->stats.nreads++;
+        if ((*file_rec->drv->read)(file_rec->drv_handle, file_rec->f_cur_off, buf, bytes) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        file_rec->f_cur_off += bytes;
+        file_rec->last_op = H4_OP_READ;
+        file_rec->stats.bytes_read += (uint32)bytes;
+        HGOTO_DONE(SUCCEED);
+    } /* end if */
+
+    /* Write out the buffered writes the read would see */
+    if (HI_WBUF_OVERLAPS(file_rec, file_rec->f_cur_off, bytes) && HIwbuf_flush(file_rec) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
     /* Check for switching file access operations */
     if (file_rec->last_op == H4_OP_WRITE || file_rec->last_op == H4_OP_UNKNOWN) {
 #ifdef HFILE_SEEKINFO
         read_force_seek++;
 #endif /* HFILE_SEEKINFO */
         file_rec->last_op = H4_OP_UNKNOWN;
-        if (HPseek(file_rec, file_rec->f_cur_off) == FAIL)
+        if (HIseek(file_rec, file_rec->f_cur_off) == FAIL)
             HGOTO_ERROR(DFE_INTERNAL, FAIL);
     } /* end if */
 
-    if (HI_READ(file_rec->file, buf, bytes) == FAIL)
+    file_rec->stats.nreads++;
+    if (HIfile_use(file_rec) == FAIL || HI_READ(file_rec->file, buf, bytes) == FAIL)
         HGOTO_ERROR(DFE_READERROR, FAIL);
+    HIdrop_behind(file_rec, file_rec->f_cur_off, bytes);
     file_rec->f_cur_off += bytes;
     file_rec->last_op = H4_OP_READ;
+    file_rec->stats.bytes_read += (uint32)bytes;
 done:
+    HP_TRACE(HDF_TRACE_READ, TRUE, bytes);
     return ret_value;
 } /* end HP_read() */
 
+/*--------------------------------------------------------------------------
+ NAME
+    HPread_at
+ PURPOSE
+    Read from an HDF file at an offset.
+ USAGE
+    intn HPread_at(file_rec,offset,buf,bytes)
+        filerec_t * file_rec;   IN: Pointer to the HDF file record
+        int32 offset;           IN: file offset to read from
+        void * buf;             IN: Pointer to the buffer to read data into
+        int32 bytes;            IN: # of bytes to read
+ RETURNS
+    Returns SUCCEED/FAIL
+ DESCRIPTION
+    Reads as HPseek() followed by HP_read() would, but without using or
+    moving the file position kept in the file record, so that the access
+    records of a file do not seek each other around.  Mapped files, the
+    sidecar index and drivers read at an offset anyway; the built-in file
+    access does so with preadv() where available, and falls back to
+    HPseek() and HP_read() elsewhere.  Files created for streaming read
+    what they still hold in memory.
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+    Should only be called by HDF low-level routines
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+intn
+HPread_at(filerec_t *file_rec, int32 offset, void *buf, int32 bytes)
+{
+#ifdef HI_PREADV_SUPPORTED
+    struct iovec iov;
+#endif /* HI_PREADV_SUPPORTED */
+    intn ret_value = SUCCEED;
+
+    if (offset < 0 || bytes < 0)
+        HRETURN_ERROR(DFE_READERROR, FAIL);
+    if (bytes == 0)
+        return SUCCEED;
+
+#ifndef HI_PREADV_SUPPORTED
+    if (file_rec->map == NULL && file_rec->idx == NULL && file_rec->drv == NULL && file_rec->stream == NULL) {
+        if (HPseek(file_rec, offset) == FAIL)
+            HRETURN_ERROR(DFE_SEEKERROR, FAIL);
+        return HP_read(file_rec, buf, bytes);
+    } /* end if */
+#endif /* HI_PREADV_SUPPORTED */
+
+    HP_TRACE(HDF_TRACE_READ, FALSE, bytes);
+
+    if (file_rec->stream != NULL) {
+        if (HIstream_read(file_rec, offset, (uint8 *)buf, bytes) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        file_rec->stats.bytes_read += (uint32)bytes;
+        HGOTO_DONE(SUCCEED);
+    } /* end if */
+
+    if (file_rec->map != NULL) {
+        if (bytes > file_rec->map_len - offset)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        memcpy(buf, file_rec->map + offset, (size_t)bytes);
+        HIdrop_behind(file_rec, offset, bytes);
+        file_rec->stats.bytes_read += (uint32)bytes;
+        HGOTO_DONE(SUCCEED);
+    } /* end if */
+
+    if (file_rec->idx != NULL && HIread_index(file_rec, offset, buf, bytes) == SUCCEED)
+        HGOTO_DONE(SUCCEED);
+
+    file_rec->stats.nreads++;
+    if (file_rec->drv != NULL) {
+        if ((*file_rec->drv->read)(file_rec->drv_handle, offset, buf, bytes) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+    } /* end if */
+#ifdef HI_PREADV_SUPPORTED
+    else {
+        /* positional reads see the file, not the buffers: write out the
+           buffered writes the read would see, and the stdio buffer */
+        if (HI_WBUF_OVERLAPS(file_rec, offset, bytes) && HIwbuf_flush(file_rec) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        if (file_rec->last_op == H4_OP_WRITE && HP_flush(file_rec) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        iov.iov_base = buf;
+        iov.iov_len  = (size_t)bytes;
+        if (HIfile_use(file_rec) == FAIL ||
+            HIpreadv(HI_FILENO(file_rec->file), &iov, 1, (off_t)offset) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        HIdrop_behind(file_rec, offset, bytes);
+    } /* end else */
+#endif /* HI_PREADV_SUPPORTED */
+    file_rec->stats.bytes_read += (uint32)bytes;
+
+done:
+    HP_TRACE(HDF_TRACE_READ, TRUE, bytes);
+    return ret_value;
+} /* end HPread_at() */
+
 /*--------------------------------------------------------------------------
  NAME
     HPseek
@@ -3226,6 +7412,43 @@ done:
 --------------------------------------------------------------------------*/
 intn
 HPseek(filerec_t *file_rec, int32 offset)
+{
+    /* A mapped file, one opened through a driver or one created for
+       streaming has no file position to move */
+    if (file_rec->map != NULL || file_rec->drv != NULL || file_rec->stream != NULL) {
+        file_rec->f_cur_off = offset;
+        file_rec->last_op   = H4_OP_SEEK;
+    } /* end if */
+    /* With writes combined, the seek is left to the read or write that
+       needs it, and is not made for writes that end up in the buffer */
+    else if (file_rec->wbuf_size > 0) {
+        if (file_rec->f_cur_off != offset) {
+            file_rec->f_cur_off = offset;
+            file_rec->last_op   = H4_OP_UNKNOWN;
+        } /* end if */
+    } /* end if */
+    else
+        return HIseek(file_rec, offset);
+
+    return SUCCEED;
+} /* end HPseek() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HIseek
+ PURPOSE
+    Move the position of a file opened with the built-in file access.
+ USAGE
+    intn HIseek(file_rec,offset)
+        filerec_t * file_rec;   IN: Pointer to the HDF file record
+        int32 offset;           IN: offset in the file to go to
+ RETURNS
+    Returns SUCCEED/FAIL
+ DESCRIPTION
+    Seeks, unless the file is known to be at the offset already.
+--------------------------------------------------------------------------*/
+static intn
+HIseek(filerec_t *file_rec, int32 offset)
 {
     intn ret_value = SUCCEED;
 
@@ -3238,7 +7461,8 @@ HPseek(filerec_t *file_rec, int32 offset)
         seek_taken++;
         printf(" taken: %d\n", (int)seek_taken);
 #endif /* HFILE_SEEKINFO */
-        if (HI_SEEK(file_rec->file, offset) == FAIL)
+        file_rec->stats.nseeks++;
+        if (HIfile_use(file_rec) == FAIL || HI_SEEK(file_rec->file, offset) == FAIL)
             HGOTO_ERROR(DFE_SEEKERROR, FAIL);
         file_rec->f_cur_off = offset;
         file_rec->last_op   = H4_OP_SEEK;
@@ -3252,7 +7476,7 @@ HPseek(filerec_t *file_rec, int32 offset)
 
 done:
     return ret_value;
-} /* end HPseek() */
+} /* end HIseek() */
 
 /*--------------------------------------------------------------------------
  NAME
@@ -3279,25 +7503,616 @@ HP_write(filerec_t *file_rec, const void *buf, int32 bytes)
 {
     intn ret_value = SUCCEED;
 
+    HP_TRACE(HDF_TRACE_WRITE, FALSE, bytes);
+
+    /* A file created for streaming keeps the bytes that may still change,
+       and writes out the others in order */
+    if (file_rec->stream != NULL) {
+        if (HIstream_write(file_rec, file_rec->f_cur_off, (const uint8 *)buf, bytes) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        file_rec->f_cur_off += bytes;
+        file_rec->last_op = H4_OP_WRITE;
+        file_rec->stats.bytes_written += (uint32)bytes;
+        HGOTO_DONE(SUCCEED);
+    } /* end if */
+
+    /* A driver writes at an offset: there is no file position to move */
+    if (file_rec->drv != NULL) {
+        file_rec->stats.nwrites++;
+        if (file_rec->drv->write == NULL ||
+            (*file_rec->drv->write)(file_rec->drv_handle, file_rec->f_cur_off, buf, bytes) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        file_rec->f_cur_off += bytes;
+        file_rec->last_op = H4_OP_WRITE;
+        file_rec->stats.bytes_written += (uint32)bytes;
+        HGOTO_DONE(SUCCEED);
+    } /* end if */
+
+    /* Combine small writes: one merged with or next to what the buffer
+       holds is copied there, others write the buffer out first */
+    if (bytes < file_rec->wbuf_size) {
+        int32 off = file_rec->f_cur_off;
+
+        if (file_rec->wbuf_len > 0 &&
+            (off < file_rec->wbuf_off || off > file_rec->wbuf_off + file_rec->wbuf_len ||
+             off + bytes - file_rec->wbuf_off > file_rec->wbuf_size) &&
+            HIwbuf_flush(file_rec) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        if (file_rec->wbuf == NULL &&
+            (file_rec->wbuf = (uint8 *)malloc((size_t)file_rec->wbuf_size)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        /* the stdio buffer goes first, as the file position moves on */
+        if (file_rec->last_op == H4_OP_WRITE && HI_FLUSH(file_rec->file) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+        if (file_rec->wbuf_len == 0)
+            file_rec->wbuf_off = off;
+        memcpy(file_rec->wbuf + (off - file_rec->wbuf_off), buf, (size_t)bytes);
+        file_rec->wbuf_len  = MAX(file_rec->wbuf_len, off + bytes - file_rec->wbuf_off);
+        file_rec->f_cur_off = off + bytes;
+        file_rec->last_op   = H4_OP_UNKNOWN;
+        file_rec->stats.bytes_written += (uint32)bytes;
+        HGOTO_DONE(SUCCEED);
+    } /* end if */
+    if (file_rec->wbuf_len > 0 && HIwbuf_flush(file_rec) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
     /* Check for switching file access operations */
     if (file_rec->last_op == H4_OP_READ || file_rec->last_op == H4_OP_UNKNOWN) {
 #ifdef HFILE_SEEKINFO
         write_force_seek++;
 #endif /* HFILE_SEEKINFO */
         file_rec->last_op = H4_OP_UNKNOWN;
-        if (HPseek(file_rec, file_rec->f_cur_off) == FAIL)
+        if (HIseek(file_rec, file_rec->f_cur_off) == FAIL)
             HGOTO_ERROR(DFE_INTERNAL, FAIL);
     } /* end if */
 
-    if (HI_WRITE(file_rec->file, buf, bytes) == FAIL)
+    file_rec->stats.nwrites++;
+    if (HIfile_use(file_rec) == FAIL || HI_WRITE(file_rec->file, buf, bytes) == FAIL)
         HGOTO_ERROR(DFE_WRITEERROR, FAIL);
     file_rec->f_cur_off += bytes;
     file_rec->last_op = H4_OP_WRITE;
+    file_rec->stats.bytes_written += (uint32)bytes;
 
 done:
+    HP_TRACE(HDF_TRACE_WRITE, TRUE, bytes);
     return ret_value;
 } /* end HP_write() */
 
+/*--------------------------------------------------------------------------
+ NAME
+    HP_flush
+ PURPOSE
+    Alias for HI_FLUSH on HDF files.
+ USAGE
+    intn HP_flush(file_rec)
+        filerec_t * file_rec;   IN: Pointer to the HDF file record
+ RETURNS
+    Returns SUCCEED/FAIL
+ DESCRIPTION
+    Function to wrap around HI_FLUSH, or the flush of the driver of the
+    file
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+    Should only be called by HDF low-level routines
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+intn
+HP_flush(filerec_t *file_rec)
+{
+    intn ret_value = SUCCEED;
+
+    if (file_rec->drv != NULL) {
+        if (file_rec->drv->flush != NULL && (*file_rec->drv->flush)(file_rec->drv_handle) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    } /* end if */
+    else if (file_rec->wbuf_len > 0) { /* writing the buffer out flushes the file */
+        if (HIwbuf_flush(file_rec) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    } /* end if */
+    else if (!file_rec->parked && HI_FLUSH(file_rec->file) == FAIL) /* parked files were flushed */
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+done:
+    return ret_value;
+} /* end HP_flush() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HPread_batch
+ PURPOSE
+    Read several extents of an HDF file at once.
+ USAGE
+    intn HPread_batch(file_rec,n_ext,exts)
+        filerec_t * file_rec;   IN: Pointer to the HDF file record
+        int32 n_ext;            IN: # of extents
+        hfile_ext_t * exts;     IN: the extents, sorted on return
+ RETURNS
+    Returns SUCCEED/FAIL
+ DESCRIPTION
+    Reads each extent into its buffer.  The extents are sorted by file
+    offset, and extents that are adjacent or close together are read by
+    a single call, up to HREADV_MAX_REGION bytes and HREADV_MAX_IOV
+    extents at a time.
+
+    Where preadv() is available the extents of such a call are scattered
+    straight into their buffers, the gaps between them going to a scratch
+    buffer, without any seek and without moving the file position.
+    Elsewhere a merged region is read with HPseek() and HP_read() into a
+    temporary buffer and copied out.  Extents held by the sidecar index
+    of the file are copied out of it.  The extents of a file opened
+    through a driver are handed to it one at a time.  Extents with a length of 0 or less
+    are skipped; reading past the end of the file is an error.
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+    Should only be called by HDF low-level routines
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+intn
+HPread_batch(filerec_t *file_rec, int32 n_ext, hfile_ext_t *exts)
+{
+#ifdef HI_PREADV_SUPPORTED
+    struct iovec iov[HREADV_MAX_IOV]; /* buffers of one read */
+    uint8       *gap_buf = NULL;      /* where the gaps go */
+    int          niov;                /* # of buffers of one read */
+#else
+    uint8 *region      = NULL; /* buffer for merged extents */
+    int32  region_size = 0;    /* size of the region buffer */
+    int32  i;                  /* loop index */
+#endif /* HI_PREADV_SUPPORTED */
+    int32 *idx_len = NULL;     /* lengths of the extents copied from the index */
+    int32  j, k;               /* extents of one read */
+    intn   ret_value = SUCCEED;
+
+    if (n_ext <= 0)
+        HGOTO_DONE(SUCCEED);
+
+    /* Copy straight out of the mapping of a mapped file */
+    if (file_rec->map != NULL) {
+        for (j = 0; j < n_ext; j++) {
+            if (exts[j].length <= 0)
+                continue;
+            if (exts[j].offset < 0 || exts[j].length > file_rec->map_len - exts[j].offset)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+            HP_TRACE(HDF_TRACE_READ, FALSE, exts[j].length);
+            memcpy(exts[j].buf, file_rec->map + exts[j].offset, (size_t)exts[j].length);
+            HIdrop_behind(file_rec, exts[j].offset, exts[j].length);
+            file_rec->stats.bytes_read += (uint32)exts[j].length;
+            HP_TRACE(HDF_TRACE_READ, TRUE, exts[j].length);
+        } /* end for */
+        HGOTO_DONE(SUCCEED);
+    } /* end if */
+
+    /* A file created for streaming reads what it still holds */
+    if (file_rec->stream != NULL) {
+        for (j = 0; j < n_ext; j++) {
+            if (exts[j].length <= 0)
+                continue;
+            if (HIstream_read(file_rec, exts[j].offset, exts[j].buf, exts[j].length) == FAIL)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+            file_rec->stats.bytes_read += (uint32)exts[j].length;
+        } /* end for */
+        HGOTO_DONE(SUCCEED);
+    } /* end if */
+
+    qsort(exts, (size_t)n_ext, sizeof(hfile_ext_t), HIreadv_compare);
+
+    /* Copy out of the sidecar index the extents it holds; they are left
+       out of the reads below until their lengths are put back */
+    if (file_rec->idx != NULL) {
+        intn left = FALSE; /* whether any extent is still to be read */
+
+        if ((idx_len = (int32 *)calloc((size_t)n_ext, sizeof(int32))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        for (j = 0; j < n_ext; j++) {
+            if (exts[j].length <= 0)
+                continue;
+            if (HIread_index(file_rec, exts[j].offset, exts[j].buf, exts[j].length) == SUCCEED) {
+                idx_len[j]     = exts[j].length;
+                exts[j].length = 0;
+            } /* end if */
+            else
+                left = TRUE;
+        } /* end for */
+        if (!left)
+            HGOTO_DONE(SUCCEED);
+    } /* end if */
+
+    /* A driver reads each extent at its offset, merging or caching them
+       as it sees fit */
+    if (file_rec->drv != NULL) {
+        for (j = 0; j < n_ext; j++) {
+            if (exts[j].length <= 0)
+                continue;
+            if (exts[j].offset < 0)
+                HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+            file_rec->stats.nreads++;
+            HP_TRACE(HDF_TRACE_READ, FALSE, exts[j].length);
+            ret_value = (*file_rec->drv->read)(file_rec->drv_handle, exts[j].offset, exts[j].buf,
+                                               exts[j].length);
+            HP_TRACE(HDF_TRACE_READ, TRUE, exts[j].length);
+            if (ret_value == FAIL)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+            file_rec->stats.bytes_read += (uint32)exts[j].length;
+        } /* end for */
+        HGOTO_DONE(SUCCEED);
+    } /* end if */
+
+    /* write out the buffered writes the reads would see */
+    for (j = 0; j < n_ext && file_rec->wbuf_len > 0; j++)
+        if (exts[j].length > 0 && HI_WBUF_OVERLAPS(file_rec, exts[j].offset, exts[j].length) &&
+            HIwbuf_flush(file_rec) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+#ifdef HI_PREADV_SUPPORTED
+    /* positional reads see the file, not the stdio buffer: flush it */
+    if (file_rec->last_op == H4_OP_WRITE)
+        if (HP_flush(file_rec) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+#endif /* HI_PREADV_SUPPORTED */
+
+    for (j = 0; j < n_ext; j = k) {
+        int32 start = exts[j].offset;
+        int32 end   = start;
+
+        if (exts[j].length <= 0) {
+            k = j + 1;
+            continue;
+        } /* end if */
+        if (start < 0)
+            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+
+#ifdef HI_PREADV_SUPPORTED
+        for (niov = 0, k = j; k < n_ext && niov < HREADV_MAX_IOV - 1; k++) {
+            int32 gap = exts[k].offset - end;
+
+            if (exts[k].length <= 0)
+                continue;
+            /* overlapping extents cannot share a read */
+            if (k > j && (gap < 0 || gap > HREADV_MAX_GAP ||
+                          exts[k].offset + exts[k].length - start > HREADV_MAX_REGION))
+                break;
+            if (gap > 0) {
+                if (gap_buf == NULL && (gap_buf = (uint8 *)malloc(HREADV_MAX_GAP)) == NULL)
+                    HGOTO_ERROR(DFE_NOSPACE, FAIL);
+                iov[niov].iov_base = gap_buf;
+                iov[niov].iov_len  = (size_t)gap;
+                niov++;
+            } /* end if */
+            iov[niov].iov_base = exts[k].buf;
+            iov[niov].iov_len  = (size_t)exts[k].length;
+            niov++;
+            end = exts[k].offset + exts[k].length;
+        } /* end for */
+
+        file_rec->stats.nreads++;
+        HP_TRACE(HDF_TRACE_READ, FALSE, end - start);
+        if ((ret_value = HIfile_use(file_rec)) == SUCCEED)
+            ret_value = HIpreadv(HI_FILENO(file_rec->file), iov, niov, (off_t)start);
+        HP_TRACE(HDF_TRACE_READ, TRUE, end - start);
+        if (ret_value == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        HIdrop_behind(file_rec, start, end - start);
+        file_rec->stats.bytes_read += (uint32)(end - start);
+#else
+        end = start + exts[j].length;
+        for (k = j + 1; k < n_ext; k++) {
+            int32 ext_end = exts[k].offset + exts[k].length;
+
+            if (exts[k].offset - end > HREADV_MAX_GAP || MAX(end, ext_end) - start > HREADV_MAX_REGION)
+                break;
+            end = MAX(end, ext_end);
+        } /* end for */
+
+        if (HPseek(file_rec, start) == FAIL)
+            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+
+        if (k == j + 1) { /* a single extent goes straight to its buffer */
+            if (HP_read(file_rec, exts[j].buf, exts[j].length) == FAIL)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+        }
+        else {
+            if (end - start > region_size) {
+                free(region);
+                region_size = end - start;
+                if ((region = (uint8 *)malloc((size_t)region_size)) == NULL)
+                    HGOTO_ERROR(DFE_NOSPACE, FAIL);
+            } /* end if */
+
+            if (HP_read(file_rec, region, end - start) == FAIL)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+            for (i = j; i < k; i++)
+                if (exts[i].length > 0)
+                    memcpy(exts[i].buf, region + (exts[i].offset - start), (size_t)exts[i].length);
+        } /* end else */
+#endif /* HI_PREADV_SUPPORTED */
+    }     /* end for */
+
+done:
+    if (idx_len != NULL) {
+        for (j = 0; j < n_ext; j++)
+            if (idx_len[j] > 0)
+                exts[j].length = idx_len[j];
+        free(idx_len);
+    } /* end if */
+#ifdef HI_PREADV_SUPPORTED
+    free(gap_buf);
+#else
+    free(region);
+#endif /* HI_PREADV_SUPPORTED */
+
+    return ret_value;
+} /* end HPread_batch() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HPwillneed
+ PURPOSE
+    Tell the system that an extent of an HDF file will be read soon.
+ USAGE
+    void HPwillneed(file_rec,offset,length)
+        filerec_t * file_rec;   IN: Pointer to the HDF file record
+        int32 offset;           IN: file offset of the extent
+        int32 length;           IN: # of bytes of the extent
+ RETURNS
+    Nothing
+ DESCRIPTION
+    Asks the system with posix_fadvise() to start reading the extent in
+    the background, so that a later read of it does not wait for the
+    disk.  This is only a hint: it does nothing for mapped files, files
+    opened through a driver, where it is not available, or when the
+    system ignores it.
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+    Should only be called by HDF low-level routines
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+void
+HPwillneed(filerec_t *file_rec, int32 offset, int32 length)
+{
+#ifdef HI_FADVISE_SUPPORTED
+    if (file_rec->map == NULL && file_rec->drv == NULL && !file_rec->parked && offset >= 0 && length > 0)
+        (void)posix_fadvise(HI_FILENO(file_rec->file), (off_t)offset, (off_t)length, POSIX_FADV_WILLNEED);
+#else
+    (void)file_rec;
+    (void)offset;
+    (void)length;
+#endif /* HI_FADVISE_SUPPORTED */
+} /* end HPwillneed() */
+
+/* Reading ahead the metadata of files about to be opened, see
+   HPprefetch_files() */
+#define HP_PREFETCH_MAX_VS (64 * 1024) /* largest vdata read ahead, e.g. an attribute */
+#define HP_PREFETCH_GAP    4096        /* largest gap read through between elements */
+#define HP_PREFETCH_BUF    (64 * 1024) /* bytes read at a time */
+
+/* An extent of a file read ahead */
+typedef struct {
+    int32 offset;
+    int32 length;
+} hp_prefetch_ext_t;
+
+/*--------------------------------------------------------------------------
+ NAME
+    HIprefetch_elem -- tell whether an element is read when a file is opened
+ DESCRIPTION
+    The elements SDstart() and Vstart() read to set up a file: the
+    vgroups, the vdata headers, the small vdatas holding the attributes
+    and dimension values, the SD tags other than the data and the
+    description records of the special elements.
+
+--------------------------------------------------------------------------*/
+static intn
+HIprefetch_elem(uint16 tag, int32 length)
+{
+    if (SPECIALTAG(tag))
+        return TRUE;
+
+    switch (tag) {
+        case DFTAG_VERSION:
+        case DFTAG_VG:
+        case DFTAG_VH:
+        case DFTAG_NDG:
+        case DFTAG_SDG:
+        case DFTAG_SDD:
+        case DFTAG_SDS:
+        case DFTAG_SDL:
+        case DFTAG_SDU:
+        case DFTAG_SDF:
+        case DFTAG_SDM:
+        case DFTAG_SDC:
+        case DFTAG_SDT:
+        case DFTAG_SDLNK:
+        case DFTAG_CAL:
+        case DFTAG_FV:
+            return TRUE;
+        case DFTAG_VS:
+            return length <= HP_PREFETCH_MAX_VS;
+        default:
+            return FALSE;
+    } /* end switch */
+} /* HIprefetch_elem */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HIprefetch_compare -- order extents by offset, for qsort()
+--------------------------------------------------------------------------*/
+static int
+HIprefetch_compare(const void *e1, const void *e2)
+{
+    int32 o1 = ((const hp_prefetch_ext_t *)e1)->offset;
+    int32 o2 = ((const hp_prefetch_ext_t *)e2)->offset;
+
+    return (o1 > o2) - (o1 < o2);
+} /* HIprefetch_compare */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HIprefetch_task -- read ahead the metadata of one file
+ DESCRIPTION
+    Task routine for htpool_run(), run on a worker thread: it uses no
+    library state but the name of the index directory and reports no
+    error, the file being opened for real afterwards.  Reads the whole
+    sidecar index of the file when indexes are used and the file has one,
+    see Hsetindex(); otherwise walks the DD blocks of the file and reads
+    the elements HIprefetch_elem() selects, in order of offset, through
+    the small gaps between them.  What is read is dropped: it is left in
+    the page cache for the file to be opened from.
+
+--------------------------------------------------------------------------*/
+static void
+HIprefetch_task(void *arg, int32 i)
+{
+    const char *const *paths = (const char *const *)arg;
+    hp_prefetch_ext_t *exts  = NULL; /* the elements to read */
+    int32              nexts = 0, max_exts = 0;
+    uint8             *buf   = NULL; /* DD blocks, then the elements */
+    char              *idx_path;
+    int32              buf_size;
+    hdf_file_t         fp;
+    uint8              head[NDDS_SZ + OFFSET_SZ];
+    uint8             *p;
+    int32              size, next, nblocks, start, end, n;
+    int16              ndds;
+    intn               d;
+
+    if (default_index && (idx_path = HIindex_path(paths[i])) != NULL) {
+        fp = (hdf_file_t)HI_OPEN(idx_path, DFACC_READ);
+        free(idx_path);
+        if (!OPENERR(fp)) {
+            if ((buf = (uint8 *)malloc(HP_PREFETCH_BUF)) != NULL)
+                while (HI_READ(fp, buf, HP_PREFETCH_BUF) == SUCCEED)
+                    ;
+            free(buf);
+            HI_CLOSE(fp);
+            return;
+        } /* end if */
+    }     /* end if */
+
+    fp = (hdf_file_t)HI_OPEN(paths[i], DFACC_READ);
+    if (OPENERR(fp))
+        return;
+    if ((buf = (uint8 *)malloc(HP_PREFETCH_BUF)) == NULL)
+        goto done;
+    buf_size = HP_PREFETCH_BUF;
+    if (HI_SEEKEND(fp) == FAIL || (size = (int32)HI_TELL(fp)) < MAGICLEN + NDDS_SZ + OFFSET_SZ)
+        goto done;
+    if (HI_SEEK(fp, 0) == FAIL || HI_READ(fp, buf, MAGICLEN) == FAIL ||
+        !NSTREQ((char *)buf, HDFMAGIC, MAGICLEN))
+        goto done;
+
+    /* the DD blocks, the number of blocks bounded against a loop */
+    for (next = MAGICLEN, nblocks = 0; next != 0 && nblocks < size / (NDDS_SZ + OFFSET_SZ); nblocks++) {
+        if (next < MAGICLEN || next > size - (NDDS_SZ + OFFSET_SZ) || HI_SEEK(fp, next) == FAIL ||
+            HI_READ(fp, head, NDDS_SZ + OFFSET_SZ) == FAIL)
+            break;
+        p = head;
+        INT16DECODE(p, ndds);
+        INT32DECODE(p, next);
+        if (ndds <= 0 || (int32)ndds * DD_SZ > buf_size || HI_READ(fp, buf, (int32)ndds * DD_SZ) == FAIL)
+            break;
+
+        for (d = 0, p = buf; d < ndds; d++) {
+            uint16 tag;
+            int32  offset, length;
+
+            UINT16DECODE(p, tag);
+            p += 2; /* the ref */
+            INT32DECODE(p, offset);
+            INT32DECODE(p, length);
+            if (tag == DFTAG_NULL || offset < 0 || length <= 0 || offset > size - length ||
+                !HIprefetch_elem(tag, length))
+                continue;
+            if (nexts == max_exts) {
+                hp_prefetch_ext_t *new_exts;
+
+                max_exts = MAX(2 * max_exts, 64);
+                if ((new_exts = (hp_prefetch_ext_t *)realloc(exts, (size_t)max_exts * sizeof(*exts))) == NULL)
+                    goto done;
+                exts = new_exts;
+            } /* end if */
+            exts[nexts].offset = offset;
+            exts[nexts].length = length;
+            nexts++;
+        } /* end for */
+    }     /* end for */
+
+    /* the elements in order, through the small gaps */
+    if (nexts > 1)
+        qsort(exts, (size_t)nexts, sizeof(hp_prefetch_ext_t), HIprefetch_compare);
+    for (d = 0; d < nexts;) {
+        start = exts[d].offset;
+        end   = exts[d].offset + exts[d].length;
+        for (d++; d < nexts && exts[d].offset - end <= HP_PREFETCH_GAP; d++)
+            end = MAX(end, exts[d].offset + exts[d].length);
+        if (HI_SEEK(fp, start) == FAIL)
+            break;
+        for (; start < end; start += n) {
+            n = MIN(end - start, buf_size);
+            if (HI_READ(fp, buf, n) == FAIL)
+                goto done;
+        }
+    } /* end for */
+
+done:
+    free(exts);
+    free(buf);
+    HI_CLOSE(fp);
+} /* HIprefetch_task */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HPprefetch_files
+ PURPOSE
+    Read ahead the metadata of files about to be opened, several at once.
+ USAGE
+    intn HPprefetch_files(nfiles, paths)
+        intn nfiles;                IN: number of files
+        const char *const paths[];  IN: names of the files
+ RETURNS
+    SUCCEED/FAIL
+ DESCRIPTION
+    Reads the metadata of the files that SDstart() and Vstart() read to
+    set them up, see HIprefetch_task(), on up to HTPOOL_MAX_THREADS
+    threads of the pool, so that the latencies of the reads overlap
+    instead of adding up, and the files then opened one after the other
+    find their metadata in the page cache.  The parsing stays serial:
+    only plain reads run on the threads.  Files opened through a driver,
+    see Hsetdriver(), are left alone, the driver keeping its own data.
+    The files need not be HDF files; those that are not, or cannot be
+    read, are skipped.
+
+--------------------------------------------------------------------------*/
+intn
+HPprefetch_files(intn nfiles, const char *const paths[])
+{
+    const char **local = NULL; /* the files read with the built-in file access */
+    int32        nlocal = 0;
+    intn         i;
+    intn         ret_value = SUCCEED;
+
+    if (nfiles < 0 || (nfiles > 0 && paths == NULL))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (nfiles == 0)
+        HGOTO_DONE(SUCCEED);
+
+    if ((local = (const char **)malloc((size_t)nfiles * sizeof(const char *))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    for (i = 0; i < nfiles; i++)
+        if (paths[i] != NULL && HIpath_driver(paths[i]) == NULL)
+            local[nlocal++] = paths[i];
+
+    if (htpool_run(HTPOOL_MAX_THREADS, nlocal, HIprefetch_task, (void *)local) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+done:
+    free(local);
+    return ret_value;
+} /* HPprefetch_files */
+
 /*--------------------------------------------------------------------------
  NAME
     HDread_drec -- reads a description record
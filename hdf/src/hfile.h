@@ -25,11 +25,20 @@
 #include "atom.h"
 #include "linklist.h"
 #include "dynarray.h"
+#include "hlock.h"
 
 /* Magic cookie for HDF data files */
 #define MAGICLEN 4                  /* length */
 #define HDFMAGIC "\016\003\023\001" /* ^N^C^S^A */
 
+/* Sidecar index of a file, see Hwriteindex() */
+#define HIDX_SUFFIX      ".h4idx"    /* appended to the name of the file */
+#define HIDX_MAGIC       "H4IX"      /* magic cookie of the index */
+#define HIDX_VERSION     1           /* version of the index format */
+#define HIDX_HDR_SZ      16          /* magic, version, file length, # of extents */
+#define HIDX_EXT_SZ      8           /* offset and length of an extent */
+#define HIDX_DEF_MAX_LEN (64 * 1024) /* elements up to this long are indexed */
+
 /* sizes of elements in a file.  This is necessary because
    the size of variables need not be the same as in the file
    (cannot use sizeof) */
@@ -43,6 +52,23 @@
 #define INVALID_OFFSET -1
 #define INVALID_LENGTH -1
 
+/* The DDs record offsets and lengths in 32 signed bits, so no element
+ * may end past this offset in the file.  There is no file variant with
+ * 64-bit DDs nor int64 entry points: writes past it fail instead */
+#define MAX_FILE_OFFSET ((int32)0x7fffffff)
+
+/* Limits on merging the extents of a batched read into one read */
+#define HREADV_MAX_GAP    4096    /* largest gap between extents read over */
+#define HREADV_MAX_REGION 1048576 /* largest merged region */
+#define HREADV_MAX_IOV    64      /* largest number of buffers of one read */
+
+/* Default size of the buffer combining the small writes to a file, see Hcache() */
+#define HWBUF_DEFAULT_SIZE 65536
+
+/* Bytes read one after the other before they are dropped from the page
+   cache, for the files read with HDF_ACCESS_DONTNEED, see Hsetaccesspattern() */
+#define HDROP_BEHIND_LEN 1048576
+
 /* #define DISKBLOCK_DEBUG */
 #ifdef DISKBLOCK_DEBUG
 
@@ -86,6 +112,7 @@ typedef FILE *hdf_file_t;
 #define HI_SEEK_CUR(f, o) (fseek((f), (long)(o), SEEK_CUR) == 0 ? SUCCEED : FAIL)
 #define HI_SEEKEND(f)     (fseek((f), (long)0, SEEK_END) == 0 ? SUCCEED : FAIL)
 #define HI_TELL(f)        (ftell(f))
+#define HI_FILENO(f)      (fileno(f))
 #define OPENERR(f)        ((f) == (FILE *)NULL)
 #endif /* FILELIB == UNIXBUFIO */
 
@@ -101,9 +128,48 @@ typedef int hdf_file_t;
 #define HI_SEEK(f, o)     (lseek((f), (off_t)(o), SEEK_SET) != (-1) ? SUCCEED : FAIL)
 #define HI_SEEKEND(f)     (lseek((f), (off_t)0, SEEK_END) != (-1) ? SUCCEED : FAIL)
 #define HI_TELL(f)        (lseek((f), (off_t)0, SEEK_CUR))
+#define HI_FILENO(f)      (f)
 #define OPENERR(f)        (f < 0)
 #endif /* FILELIB == UNIXUNBUFIO */
 
+/* Files opened read-only can be memory-mapped, see Hmmap() */
+#if defined(H4_HAVE_MMAP) && defined(H4_HAVE_SYS_MMAN_H)
+#define HI_MMAP_SUPPORTED
+#endif
+
+/* Batched reads use positional reads where available, see HPread_batch() */
+#if defined(H4_HAVE_PREADV) && defined(H4_HAVE_SYS_UIO_H) && defined(HI_FILENO)
+#define HI_PREADV_SUPPORTED
+#endif
+
+/* File drivers, see Hsetdriver() */
+#define HDRV_MAX_DRIVERS 16 /* # of drivers that can be registered */
+
+/* Reads and writes bypassing the page cache, see the "direct" driver in
+   hfiledrv.c, on the systems with O_DIRECT or F_NOCACHE */
+#if !defined(H4_HAVE_WIN32_API) && defined(H4_HAVE_UNISTD_H) && defined(H4_HAVE_FCNTL_H) &&                 \
+    (defined(__linux__) || defined(__FreeBSD__) || defined(__APPLE__))
+#define HI_DIRECT_SUPPORTED
+#endif
+
+/* Reads coming up can be announced to the system, see HPwillneed() */
+#if defined(H4_HAVE_POSIX_FADVISE) && defined(HI_FILENO)
+#define HI_FADVISE_SUPPORTED
+#endif
+
+/* So can the way a mapped file is read, see Hsetaccesspattern() */
+#if defined(HI_MMAP_SUPPORTED) && defined(H4_HAVE_MADVISE)
+#define HI_MADVISE_SUPPORTED
+#endif
+
+/* Reports the beginning or the end of a phase to the tracing callback,
+   see Hset_trace_callback(); with no callback this is a single test */
+#define HP_TRACE(op, end, count)                                                                             \
+    do {                                                                                                     \
+        if (HPtrace_func != NULL)                                                                            \
+            (*HPtrace_func)((op), (end), (int32)(count), HPtrace_data);                                      \
+    } while (0)
+
 /* ----------------------- Internal Data Structures ----------------------- */
 /* The internal structure used to keep track of the files opened: an
    array of filerec_t structures, each has a linked list of ddblock_t.
@@ -191,11 +257,12 @@ typedef int hdf_file_t;
 
 /* record of each data descriptor */
 typedef struct dd_t {
-    uint16            tag;    /* Tag number of element i.e. type of data */
-    uint16            ref;    /* Reference number of element */
-    int32             length; /* length of data element */
-    int32             offset; /* byte offset of data element from */
-    struct ddblock_t *blk;    /* Pointer to the block this dd is in */
+    uint16            tag;       /* Tag number of element i.e. type of data */
+    uint16            ref;       /* Reference number of element */
+    int32             length;    /* length of data element */
+    int32             offset;    /* byte offset of data element from */
+    int16             spec_code; /* special code of a special element, 0 until read */
+    struct ddblock_t *blk;       /* Pointer to the block this dd is in */
 } /* beginning of file */
 dd_t;
 
@@ -214,6 +281,7 @@ typedef struct ddblock_t {
     int32             myoffset;   /* offset of this DD block in the file */
     int16             ndds;       /* number of dd's in this block */
     int32             nextoffset; /* offset to the next ddblock in the file */
+    int32             firstdd;    /* position of this block's first dd in the DD list */
     struct filerec_t *frec;       /* Pointer to the filerec this block is in */
     struct ddblock_t *next;       /* pointer to the next ddblock in memory */
     struct ddblock_t *prev;       /* Pointer to previous ddblock. */
@@ -224,8 +292,11 @@ typedef struct ddblock_t {
 typedef struct tag_info_str {
     uint16 tag; /* tag value for this node */
     /* Needs to be first in this structure */
-    bv_ptr   b; /* bit-vector to keep track of which refs are used */
-    dynarr_p d; /* dynarray of the refs for this tag */
+    bv_ptr        b;      /* bit-vector to keep track of which refs are used */
+    dynarr_p      d;      /* dynarray of the refs for this tag */
+    struct dd_t **dds;    /* DDs of this tag and its special tag, in DD list order */
+    intn          ndds;   /* number of DDs in 'dds' */
+    intn          maxdds; /* number of DDs 'dds' has room for */
 } tag_info;
 
 /* For determining what the last file operation was */
@@ -236,6 +307,31 @@ typedef enum {
     H4_OP_READ         /* Last operation was a read */
 } fileop_t;
 
+/* One extent of a batched read, see HPread_batch() */
+typedef struct hfile_ext_t {
+    int32  offset; /* offset of the data in the file */
+    int32  length; /* # of bytes to read */
+    uint8 *buf;    /* where the data goes */
+} hfile_ext_t;
+
+/* An unused extent of a file, see HPfreediskblock() */
+typedef struct hfile_free_t {
+    int32 offset; /* offset of the unused space in the file */
+    int32 length; /* # of bytes unused */
+} hfile_free_t;
+
+/* The bytes of a file created for streaming not written out yet, see
+   Hsetstreaming() */
+typedef struct hfile_stream_t {
+    uint8 *head;     /* the magic number and the first DD block, written last */
+    int32  head_len; /* # of bytes of the head */
+    uint8 *buf;      /* the last bytes written, which may still change */
+    int32  size;     /* size of the buffer */
+    int32  off;      /* file offset of the bytes in the buffer, those before are written out */
+    int32  len;      /* # of bytes in the buffer */
+    int32  pos;      /* position of the file (built-in file access), -1 when not known */
+} hfile_stream_t;
+
 /* File record structure */
 typedef struct filerec_t {
     char      *path;        /* name of file */
@@ -246,16 +342,83 @@ typedef struct filerec_t {
     intn       attach;      /* number of access elts attached */
     intn       version_set; /* version tag stuff */
     version_t  version;     /* file version info */
+    int16      new_ndds;    /* # of DDs of the DD blocks added, 0 for that of the first */
+
+    /* File driver info, see Hsetdriver() */
+    const hdf_driver_t *drv;        /* driver of the file, NULL for the built-in one */
+    void               *drv_handle; /* handle of the file for the driver */
+
+    /* Descriptor info (built-in file access only), see HIfile_use() */
+    intn              parked;    /* descriptor closed, reopened when next used */
+    intn              fd_listed; /* in the list of files holding a descriptor */
+    struct filerec_t *fd_prev;   /* file used more recently */
+    struct filerec_t *fd_next;   /* file used less recently */
+    intn              fd_pins;   /* reads in progress outside the file lock, see HIfd_pin() */
+
+    /* Write-combining info (built-in file access only), see Hcache() */
+    uint8 *wbuf;      /* bytes written but not yet in the file, NULL until the first write */
+    int32  wbuf_size; /* size of the buffer, 0 for writing straight to the file */
+    int32  wbuf_off;  /* file offset of the bytes in the buffer */
+    int32  wbuf_len;  /* # of bytes in the buffer */
+
+    /* Streaming info (files created only), see Hsetstreaming() */
+    hfile_stream_t *stream; /* NULL unless the file is written out sequentially */
+
+    /* Keep-open info (read-only files), see HPkeep_open() */
+    intn              keep;      /* kept open after its last close */
+    intn              kept;      /* closed, but kept open */
+    uint32            stamp;     /* HPfile_stamp() of the file when marked */
+    struct filerec_t *kept_next; /* file closed before, if kept open */
 
     /* Seek caching info */
     int32    f_cur_off; /* Current location in the file */
     fileop_t last_op;   /* the last file operation performed */
 
+    /* Memory-mapping info (read-only files only) */
+    uint8 *map;     /* mapping of the whole file, NULL when not mapped */
+    int32  map_len; /* length of the mapping */
+
+    /* Access pattern info, see Hsetaccesspattern() */
+    intn  pattern;  /* HDF_ACCESS_* flags the file is read with */
+    int32 drop_off; /* offset of the bytes read but not yet dropped, with HDF_ACCESS_DONTNEED */
+    int32 drop_len; /* # of those bytes, read one after the other */
+
+    /* Sidecar index info (read-only files only), see Hreadindex() */
+    hfile_ext_t *idx;     /* extents held by the index, by offset, NULL when none */
+    int32        idx_n;   /* # of extents */
+    uint8       *idx_buf; /* contents of the index */
+    int32        idx_map; /* length of the mapping of the index, 0 when idx_buf was read in */
+
+    /* I/O statistics, see Hgetstats() */
+    hdf_stats_t stats; /* counters since the file was opened */
+
+    /* Compaction of linked block elements and of the DD list on close,
+       see Hsetcompact() and Hsetcompactdd() */
+    intn compact;    /* boolean: whether to compact linked blocks on close */
+    intn compact_dd; /* boolean: whether to compact the DD list on close */
+
+    /* Alignment of the data elements, see Hsetalignment() */
+    int32 align_threshold; /* elements at least this long are aligned */
+    int32 alignment;       /* their offsets are multiples of this, 0 for none */
+
+    /* Buffering of the small elements read repeatedly, see HBsetpolicy() */
+    int32      hb_max_len;  /* elements at most this long are buffered, 0 for none */
+    intn       hb_min_uses; /* once opened for reading this many times */
+    TBBT_TREE *hb_elems;    /* the elements counted, by tag/ref, NULL until the first */
+
     /* DD block caching info */
     intn  cache;     /* boolean: whether caching is on */
     intn  dirty;     /* boolean: if dd list needs to be flushed */
     int32 f_end_off; /* offset of the end of the file */
 
+    /* Space released in the file while it is open, see HPfreediskblock() */
+    TBBT_TREE *free_by_off;  /* unused extents by offset */
+    TBBT_TREE *free_by_size; /* the same extents by length, then offset */
+
+    /* Data shared by several DDs, see Hdupdd() and HTPshares_data() */
+    intn dd_shared_known; /* boolean: whether 'dd_shared' was worked out */
+    intn dd_shared;       /* boolean: whether the data of any two DDs overlap */
+
     /* DD list pointers */
     struct ddblock_t *ddhead; /* head of ddblock list */
     struct ddblock_t *ddlast; /* end of ddblock list */
@@ -273,6 +436,15 @@ typedef struct filerec_t {
                             * i.e. file/data labels and descriptions.
                             * This is done for faster searching of annotations
                             * of a particular type. */
+
+    /* annotations by the item they annotate, see ANIobjindex() in mfan.c */
+    struct ANentry **an_obj[4];     /* entries of each tree by tag/ref of the item,
+                                     * NULL until the item's annotations are looked up */
+    intn             an_obj_max[4]; /* room in an_obj[] */
+
+#ifdef H4_HAVE_THREADSAFE
+    hlock_t lock; /* serializes the DD, access and chunk operations */
+#endif
 } filerec_t;
 
 /* bits for filerec_t 'dirty' flag */
@@ -297,6 +469,10 @@ typedef struct accrec_t {
     int32              posn;         /* seek position with respect to start of element */
     void              *special_info; /* special element info? */
     struct funclist_t *special_func; /* ptr to special function? */
+    void              *sieve_buf;    /* sieve buffer of a plain element, see Hsetsievebuf() */
+    int32              sieve_size;   /* size of the sieve buffer */
+    int32              sieve_posn;   /* position in the element of the bytes in the buffer */
+    int32              sieve_len;    /* # of bytes in the buffer, 0 if empty */
     struct accrec_t   *next;         /* for free-list linking */
 } accrec_t;
 
@@ -444,14 +620,50 @@ HDFLIBAPI int32 HDget_special_info(int32 access_id, sp_info_block_t *info_block)
 
 HDFLIBAPI int32 HDset_special_info(int32 access_id, sp_info_block_t *info_block);
 
+HDFLIBAPI hdf_trace_func_t HPtrace_func; /* tracing callback, NULL when tracing is off */
+HDFLIBAPI void            *HPtrace_data; /* user data passed to the tracing callback */
+
 HDFLIBAPI intn HP_read(filerec_t *file_rec, void *buf, int32 bytes);
 
 HDFLIBAPI intn HPseek(filerec_t *file_rec, int32 offset);
 
+HDFLIBAPI intn HPread_at(filerec_t *file_rec, int32 offset, void *buf, int32 bytes);
+
 HDFLIBAPI intn HP_write(filerec_t *file_rec, const void *buf, int32 bytes);
 
+HDFLIBAPI intn HP_flush(filerec_t *file_rec);
+
+HDFLIBAPI intn HPread_batch(filerec_t *file_rec, int32 n_ext, hfile_ext_t *exts);
+
+HDFLIBAPI int32 HPfile_size(filerec_t *file_rec);
+
+HDFLIBAPI void HPwillneed(filerec_t *file_rec, int32 offset, int32 length);
+
+HDFLIBAPI intn HPprefetch_files(intn nfiles, const char *const paths[]);
+
 HDFLIBAPI int32 HPread_drec(int32 file_id, atom_t data_id, uint8 **drec_buf);
 
+/*
+ ** from hfiledrv.c
+ */
+HDFLIBAPI const hdf_driver_t HP_driver_core;   /* whole file in memory */
+HDFLIBAPI const hdf_driver_t HP_driver_memory; /* file images, see Hsetimage() */
+#ifdef H4_HAVE_LIBCURL
+HDFLIBAPI const hdf_driver_t HP_driver_http; /* HTTP(S) and S3 range reads */
+#endif /* H4_HAVE_LIBCURL */
+#ifdef H4_HAVE_PARALLEL
+HDFLIBAPI const hdf_driver_t HP_driver_mpio; /* MPI-IO reads by a group of processes */
+#endif /* H4_HAVE_PARALLEL */
+#ifdef HI_DIRECT_SUPPORTED
+HDFLIBAPI const hdf_driver_t HP_driver_direct; /* direct I/O, bypassing the page cache */
+#endif /* HI_DIRECT_SUPPORTED */
+
+HDFLIBAPI intn HPis_image(const char *name);
+
+HDFLIBAPI intn HPmpio_rank(filerec_t *file_rec);
+
+HDFLIBAPI intn HPmpio_share(filerec_t *file_rec, intn status, void *buf, int32 bytes);
+
 HDFLIBAPI intn tagcompare(void *k1, void *k2, intn cmparg);
 
 HDFLIBAPI void tagdestroynode(void *n);
@@ -559,6 +771,11 @@ HDFLIBAPI int32 HBPcloseAID(accrec_t *access_rec);
 
 HDFLIBAPI int32 HBPinfo(accrec_t *access_rec, sp_info_block_t *info_block);
 
+HDFLIBAPI intn HBPpromote(filerec_t *file_rec, accrec_t *access_rec, uint16 tag, uint16 ref, int32 offset,
+                          int32 length);
+
+HDFLIBAPI void HBPforget(filerec_t *file_rec, uint16 tag, uint16 ref);
+
 /*
  ** from hcompri.c
  */
@@ -651,6 +868,22 @@ intn HTPsync(filerec_t *file_rec /* IN:  File record to store info in */
 intn HTPend(filerec_t *file_rec /* IN:  File record to store info in */
 );
 
+/******************************************************************************
+ NAME
+     HTPcompact - Rewrite the DD list in as few DD blocks as possible
+
+ DESCRIPTION
+    Moves the DDs in use to the front of the DD list, keeping their order,
+    and drops the DD blocks this empties.  Nothing may be attached to the
+    file.
+
+ RETURNS
+    Returns SUCCEED if successful and FAIL otherwise
+
+*******************************************************************************/
+intn HTPcompact(filerec_t *file_rec /* IN:  File record to store info in */
+);
+
 /******************************************************************************
  NAME
      HTPcreate - Create (and attach to) a tag/ref pair
@@ -736,6 +969,24 @@ intn HTPupdate(atom_t ddid,    /* IN: DD id to update */
                int32  new_len  /* IN: new length for DD */
 );
 
+/******************************************************************************
+ NAME
+     HTPunspecial - Turn the DD of a special element into a plain one
+
+ DESCRIPTION
+    Changes the tag of a DD from the special tag to its base tag and points
+    it at new data, so that the element keeps its tag/ref but is stored as
+    a plain element.
+
+ RETURNS
+    Returns SUCCEED if successful and FAIL otherwise
+
+*******************************************************************************/
+intn HTPunspecial(atom_t ddid,    /* IN: DD id to update */
+                  int32  new_off, /* IN: offset of the plain data */
+                  int32  new_len  /* IN: length of the plain data */
+);
+
 /******************************************************************************
  NAME
      HTPinquire - Get the DD information for a DD (i.e. tag/ref/offset/length)
@@ -769,6 +1020,41 @@ intn HTPinquire(atom_t  ddid, /* IN: DD id to inquire about */
 intn HTPis_special(atom_t ddid /* IN: DD id to inquire about */
 );
 
+/******************************************************************************
+ NAME
+     HTPshares_data - Check whether the data of a DD is shared
+
+ DESCRIPTION
+    Checks whether the data of the DD overlaps the data of another DD of
+    the file, as after Hdupdd().  Whether any DDs of the file share data
+    is worked out once, so that in files where none do the check costs
+    nothing.
+
+ RETURNS
+    Returns TRUE(1)/FALSE(0) if successful and FAIL otherwise
+
+*******************************************************************************/
+intn HTPshares_data(atom_t ddid /* IN: DD id to inquire about */
+);
+
+/******************************************************************************
+ NAME
+     HTPspecial_code - Get the special code of the element of a special DD
+
+ DESCRIPTION
+    Reads the special code at the start of the data of a special element the
+    first time it is asked for and keeps it with the DD, so that the special
+    elements opened again are not read for it.  The code kept is dropped
+    whenever the DD is pointed at other data.
+
+ RETURNS
+    Returns SUCCEED if successful and FAIL otherwise
+
+*******************************************************************************/
+intn HTPspecial_code(atom_t ddid,    /* IN: DD id of the special element */
+                     int16 *spec_code /* OUT: special code of the element */
+);
+
 /******************************************************************************
  NAME
     HTPdump_dds -- Dump out the dd information for a file
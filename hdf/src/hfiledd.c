@@ -30,7 +30,9 @@ DESIGN
     The tag_tree is a tbbt of the tags contained within the file.  Each
     node of the tag_tree has a link to a bit-vector for keeping track of the
     refs used for that tag and a link to a dynamic array pointers into the
-    DD list for each ref # used.
+    DD list for each ref # used.  Each node also keeps an array of the tag's
+    DDs sorted by their position in the DD list, so searches for the next
+    or previous DD of a tag do not have to walk the whole DD list.
 
 BUGS/LIMITATIONS
 
@@ -42,6 +44,7 @@ EXPORTED ROUTINES
     Htagnewref  - Returns a ref that is unique in the file for a given tag
     Hfind       - Locate the next object of a search in an HDF file
     Hdeldd      - Delete a data descriptor
+    Hcompactdd  - Drop the empty DDs of the DD list
 
   Developer-level routines
     HDcheck_tagref - Checks to see if tag/ref is in DD list i.e. created already
@@ -56,11 +59,14 @@ EXPORTED ROUTINES
     HTPupdate   - Change the offset and/or length of a data object
     HTPinquire  - Get the DD information for a DD (i.e. tag/ref/offset/length)
     HTPis_special- Check if a DD id is associated with a special tag
+    HTPshares_data- Check whether the data of a DD is shared with another DD
+    HTPspecial_code- Get the special code of the element of a special DD
   DD list functions:
     HTPstart    - Initialize the DD list from disk (creates the DD list in memory)
     HTPinit     - Create a new DD list (creates the DD list in memory)
     HTPsync     - Flush the DD list to disk (synchronizes with disk)
     HTPend      - Close the DD list to disk (synchronizes with disk too)
+    HTPcompact  - Rewrite the DD list in as few DD blocks as possible
 LOCAL ROUTINES
     HTIfind_dd      - find a specific DD in the file
     HTInew_dd_block - create a new (empty) DD block
@@ -68,6 +74,10 @@ LOCAL ROUTINES
     HTIcount_dd     - counts the dd's of a certain type in file
     HTIregister_tag_ref     - insert a ref into the tag tree for a file
     HTIunregister_tag_ref   - remove a ref from the tag tree for a file
+    HTIfind_tag_pos         - find a position in the DD list of a tag
+    HTIfind_ref_dd          - find the nearest DD with a given ref
+    HTIread_window          - read the DD blocks through a read-ahead window
+    HTIshares_data          - check whether another DD uses some of a DD's data
 
 OLD ROUTINES
     HIlookup_dd             - find the dd record for an element
@@ -106,11 +116,36 @@ static intn HTIregister_tag_ref(filerec_t *file_rec, dd_t *dd);
 
 static intn HTIunregister_tag_ref(filerec_t *file_rec, dd_t *dd_ptr);
 
+static intn HTIfind_tag_pos(tag_info *tinfo_ptr, int32 pos);
+
+static dd_t *HTIfind_ref_dd(filerec_t *file_rec, uint16 look_ref, int32 pos, intn direction);
+
+static intn HTIfree_space(filerec_t *file_rec, dd_t *dd_ptr);
+
+static intn HTIshares_data(filerec_t *file_rec, dd_t *dd_ptr);
+
+/* Window of a file the DD blocks are read through at open, see HTIread_window() */
+typedef struct ddwindow_t {
+    uint8 *buf;      /* the bytes read */
+    uintn  buf_size; /* size of buf */
+    int32  off;      /* offset of the bytes read in the file */
+    int32  len;      /* # of bytes read */
+    int32  file_len; /* length of the file, FAIL to read no more than needed */
+} ddwindow_t;
+
+static uint8 *HTIread_window(filerec_t *file_rec, ddwindow_t *win, int32 offset, int32 bytes);
+
 /* Local definitions */
 /* The initial size of a ref dynarray */
 #define REF_DYNARRAY_START 64
 /* The increment of a ref dynarray */
 #define REF_DYNARRAY_INCR 256
+/* The largest # of DDs of a block, which is stored in 16 bits */
+#define MAX_NDDS 32767
+/* The initial size of the DD array of a tag */
+#define TAG_DDS_START 64
+/* position of a DD in the DD list */
+#define DDPOS(dd) ((dd)->blk->firstdd + (int32)((dd) - (dd)->blk->ddlist))
 /* macros to encode and decode a DD */
 #define DDENCODE(p, tag, ref, offset, length)                                                                \
     {                                                                                                        \
@@ -145,12 +180,23 @@ intn
 HTPstart(filerec_t *file_rec /* IN:  File record to store info in */
 )
 {
-    uint8 *tbuf      = NULL; /* temporary buffer */
-    uintn  tbuf_size = 0;    /* temporary buffer size */
-    int32  end_off   = 0;    /* offset of the end of the file */
-    intn   ret_value = SUCCEED;
+    ddwindow_t win;           /* window the DD blocks are read through */
+    int32      end_off   = 0; /* offset of the end of the file */
+    intn       ret_value = SUCCEED;
 
     HEclear();
+    HP_TRACE(HDF_TRACE_DD_LOAD, FALSE, 0);
+
+    /* DD blocks are read DD_READ_AHEAD bytes at a time, so that the blocks
+       following one another, and the DDs following their header, take one
+       read; blocks read from a sidecar index are read as they are */
+    memset(&win, 0, sizeof(win));
+    win.file_len = file_rec->idx == NULL ? HPfile_size(file_rec) : FAIL;
+
+    /* Whether DDs share data is only worked out when needed */
+    file_rec->dd_shared_known = FALSE;
+    file_rec->dd_shared       = FALSE;
+
     /* Alloc start of linked list of ddblocks. */
     file_rec->ddhead = (ddblock_t *)malloc(sizeof(ddblock_t));
     if (file_rec->ddhead == (ddblock_t *)NULL)
@@ -168,6 +214,7 @@ HTPstart(filerec_t *file_rec /* IN:  File record to store info in */
     Set it up so that we start reading from there. */
     file_rec->ddlast->myoffset = MAGICLEN; /* set offset of block in file */
     file_rec->ddlast->dirty    = 0;        /* block does not need to be flushed */
+    file_rec->ddlast->firstdd  = 0;        /* first block of the DD list */
 
     /* Initialize the tag tree */
     file_rec->tag_tree = tbbtdmake(tagcompare, sizeof(uint16), TBBT_FAST_UINT16_COMPARE);
@@ -180,28 +227,22 @@ HTPstart(filerec_t *file_rec /* IN:  File record to store info in */
              at the same time. */
     file_rec->maxref = 0;
     for (;;) {
-        ddblock_t *ddcurr;                      /* ptr to the current DD block */
-        dd_t      *curr_dd_ptr;                 /* pointer to the current DD being read in */
-        uint8      ddhead[NDDS_SZ + OFFSET_SZ]; /* storage for the DD header */
-        uint8     *p;                           /* Temporary buffer pointer. */
-        intn       ndds;                        /* number of DDs in a block */
-        intn       i;                           /* Temporary integer */
+        ddblock_t *ddcurr;      /* ptr to the current DD block */
+        dd_t      *curr_dd_ptr; /* pointer to the current DD being read in */
+        uint8     *p;           /* Temporary buffer pointer. */
+        intn       ndds;        /* number of DDs in a block */
+        intn       i;           /* Temporary integer */
 
         /* Get a short-cut for the current DD block being read-in */
         ddcurr = file_rec->ddlast;
 
-        /* Go to the beginning of the DD block */
-        if (HPseek(file_rec, ddcurr->myoffset) == FAIL)
-            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
-
         /* Read in the start of this dd block.
            Read data consists of ndds (number of dd's in this block) and
            offset (offset to the next ddblock). */
-        if (HP_read(file_rec, ddhead, NDDS_SZ + OFFSET_SZ) == FAIL)
+        if ((p = HTIread_window(file_rec, &win, ddcurr->myoffset, NDDS_SZ + OFFSET_SZ)) == NULL)
             HGOTO_ERROR(DFE_READERROR, FAIL);
 
         /* Decode the numbers. */
-        p = &ddhead[0];
         INT16DECODE(p, ddcurr->ndds);
         ndds = (intn)ddcurr->ndds;
         if (ndds <= 0) /* validity check */
@@ -219,27 +260,19 @@ HTPstart(filerec_t *file_rec /* IN:  File record to store info in */
         if (ddcurr->ddlist == (dd_t *)NULL)
             HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
-        /* Allocate memory for the temporary buffer also */
-        if (tbuf == NULL || ((uintn)ndds * DD_SZ) > tbuf_size) {
-            free(tbuf);
-            tbuf_size = (uintn)ndds * DD_SZ;
-            tbuf      = (uint8 *)malloc(tbuf_size);
-            if (tbuf == (uint8 *)NULL)
-                HGOTO_ERROR(DFE_NOSPACE, FAIL);
-        } /* end if */
-
         /* Index of current dd in ddlist of this ddblock is 0. */
         curr_dd_ptr = ddcurr->ddlist;
 
         /* Read in a chunk of dd's from the file. */
-        if (HP_read(file_rec, tbuf, ndds * DD_SZ) == FAIL)
+        if ((p = HTIread_window(file_rec, &win, ddcurr->myoffset + NDDS_SZ + OFFSET_SZ, ndds * DD_SZ)) ==
+            NULL)
             HGOTO_ERROR(DFE_READERROR, FAIL);
 
         /* decode the dd's */
-        p = tbuf;
         for (i = 0; i < ndds; i++, curr_dd_ptr++) {
             DDDECODE(p, curr_dd_ptr->tag, curr_dd_ptr->ref, curr_dd_ptr->offset, curr_dd_ptr->length);
-            curr_dd_ptr->blk = ddcurr;
+            curr_dd_ptr->spec_code = 0;
+            curr_dd_ptr->blk       = ddcurr;
 
             /* check if maximum ref # exceeded */
             if (file_rec->maxref < curr_dd_ptr->ref)
@@ -268,6 +301,7 @@ HTPstart(filerec_t *file_rec /* IN:  File record to store info in */
             ddnew->ddlist    = (dd_t *)NULL;
             ddnew->myoffset  = ddcurr->nextoffset;
             ddnew->dirty     = FALSE;
+            ddnew->firstdd   = ddcurr->firstdd + ddcurr->ndds;
             file_rec->ddlast = ddnew;
 
             /* Keep the filerec_t pointer around for each ddblock */
@@ -285,7 +319,8 @@ HTPstart(filerec_t *file_rec /* IN:  File record to store info in */
     file_rec->f_end_off = end_off;
 
 done:
-    free(tbuf);
+    free(win.buf);
+    HP_TRACE(HDF_TRACE_DD_LOAD, TRUE, 0);
 
     return ret_value;
 } /* end HTPstart() */
@@ -325,6 +360,10 @@ HTPinit(filerec_t *file_rec, /* IN: File record to store info in */
     else if (ndds < MIN_NDDS)
         ndds = MIN_NDDS;
 
+    /* A new file has no data shared */
+    file_rec->dd_shared_known = TRUE;
+    file_rec->dd_shared       = FALSE;
+
     /* allocate the dd block in memory and initialize it */
     file_rec->ddhead = (ddblock_t *)malloc(sizeof(ddblock_t));
     if (file_rec->ddhead == (ddblock_t *)NULL)
@@ -336,6 +375,7 @@ HTPinit(filerec_t *file_rec, /* IN: File record to store info in */
     block->nextoffset        = 0;
     block->myoffset          = MAGICLEN;
     block->dirty             = FALSE;
+    block->firstdd           = 0;
 
     /* Keep the filerec_t pointer around for each ddblock */
     block->frec = file_rec;
@@ -356,8 +396,9 @@ HTPinit(filerec_t *file_rec, /* IN: File record to store info in */
     list[0].tag    = DFTAG_NULL;
     list[0].ref    = DFREF_NONE;
     list[0].length = INVALID_LENGTH;
-    list[0].offset = INVALID_OFFSET;
-    list[0].blk    = block;
+    list[0].offset    = INVALID_OFFSET;
+    list[0].spec_code = 0;
+    list[0].blk       = block;
     HDmemfill(&list[1], &list[0], sizeof(dd_t), (uint32)(ndds - 1));
 
     tbuf = (uint8 *)malloc(ndds * DD_SZ);
@@ -402,7 +443,9 @@ done:
 
  DESCRIPTION
     Synchronizes the in-memory copy of the DD list with the copy on disk by
-    writing out the DD blocks which have changed to disk.
+    writing out the DD blocks which have changed to disk.  The blocks of a
+    file created for streaming that have no place in the file yet, see
+    Hsetstreaming(), get one at its end first.
 
  RETURNS
     Returns SUCCEED if successful and FAIL otherwise
@@ -423,10 +466,23 @@ HTPsync(filerec_t *file_rec /* IN:  File record to store info in */
     intn       ret_value = SUCCEED;
 
     HEclear();
+    HP_TRACE(HDF_TRACE_DD_FLUSH, FALSE, 0);
+
     block = file_rec->ddhead;
     if (block == NULL) /* check for DD list */
         HGOTO_ERROR(DFE_BADDDLIST, FAIL);
 
+    for (block = block->next; block != NULL; block = block->next)
+        if (block->myoffset == 0) {
+            if ((block->myoffset = HPgetdiskblock(file_rec, NDDS_SZ + OFFSET_SZ + (block->ndds * DD_SZ),
+                                                  FALSE)) == FAIL)
+                HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+            block->prev->nextoffset = block->myoffset;
+            block->prev->dirty      = TRUE;
+            block->dirty            = TRUE;
+        } /* end if */
+
+    block = file_rec->ddhead;
     while (block != NULL) {         /* check all the blocks for flushing */
         if (block->dirty == TRUE) { /* flush this block? */
             if (HPseek(file_rec, block->myoffset) == FAIL)
@@ -466,6 +522,7 @@ HTPsync(filerec_t *file_rec /* IN:  File record to store info in */
 
 done:
     free(tbuf);
+    HP_TRACE(HDF_TRACE_DD_FLUSH, TRUE, 0);
 
     return ret_value;
 } /* end HTPsync() */
@@ -515,6 +572,169 @@ done:
     return ret_value;
 } /* end HTPend() */
 
+/******************************************************************************
+ NAME
+     HTPcompact - Rewrite the DD list in as few DD blocks as possible
+
+ DESCRIPTION
+    Moves the DDs in use to the front of the DD list, keeping their order,
+    so that they fill the first DD block and as few blocks after it as
+    they need; the empty DDs left by deleted elements are dropped.  The
+    blocks after the first are written to new space before the first one
+    is changed to point to them, and the space of the old blocks is then
+    released with HPfreediskblock().  The DD list is left as it is when
+    it would not take fewer blocks.  Nothing may be attached to the file,
+    since access records hold DDs of the DD list.
+
+ RETURNS
+    Returns SUCCEED if successful and FAIL otherwise
+
+*******************************************************************************/
+intn
+HTPcompact(filerec_t *file_rec /* IN:  File record to store info in */
+)
+{
+    ddblock_t *old_head;        /* DD list being replaced */
+    ddblock_t *new_head = NULL; /* DD list replacing it */
+    ddblock_t *new_last = NULL; /* last block of the new DD list */
+    ddblock_t *block, *next;    /* DD blocks walked */
+    dd_t      *dst;             /* next DD of the new DD list */
+    int32      nlive   = 0;     /* # of DDs in use */
+    int32      left;            /* # of DDs still to place */
+    intn       nblocks = 0;     /* # of blocks of the DD list */
+    intn       nnew;            /* # of blocks of the new DD list */
+    intn       pad;             /* # of DDs of the blocks added to the file */
+    intn       i;               /* temp ints */
+    intn       ret_value = SUCCEED;
+
+    HEclear();
+    if ((old_head = file_rec->ddhead) == NULL)
+        HGOTO_ERROR(DFE_BADDDLIST, FAIL);
+    if (!(file_rec->access & DFACC_WRITE))
+        HGOTO_ERROR(DFE_BADACC, FAIL);
+    if (file_rec->attach > 0)
+        HGOTO_ERROR(DFE_OPENAID, FAIL);
+
+    for (block = old_head; block != NULL; block = block->next, nblocks++)
+        for (i = 0; i < block->ndds; i++)
+            if (block->ddlist[i].tag != DFTAG_NULL)
+                nlive++;
+
+    /* The first block stays where it is, with the size it has; the DDs
+       that do not fit in it go to blocks of at most MAX_NDDS DDs */
+    left = nlive - old_head->ndds;
+    nnew = 1 + (left > 0 ? (intn)((left + MAX_NDDS - 1) / MAX_NDDS) : 0);
+    if (nnew >= nblocks)
+        HGOTO_DONE(SUCCEED);
+    pad = file_rec->new_ndds > 0 ? (intn)file_rec->new_ndds : (intn)old_head->ndds;
+
+    /* Make the blocks of the new DD list, empty */
+    left = nlive;
+    for (i = 0; i < nnew; i++) {
+        intn ndds; /* # of DDs of this block */
+
+        if (i == 0)
+            ndds = (intn)old_head->ndds;
+        else if (left > MAX_NDDS)
+            ndds = MAX_NDDS;
+        else /* the last block keeps room for a block of DDs to come */
+            ndds = (intn)MIN(left + pad, MAX_NDDS);
+        left -= MIN(left, ndds);
+
+        if ((block = (ddblock_t *)calloc(1, sizeof(ddblock_t))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if (new_head == NULL)
+            new_head = block;
+        else {
+            new_last->next = block;
+            block->prev    = new_last;
+        } /* end else */
+        new_last        = block;
+        block->frec     = file_rec;
+        block->ndds     = (int16)ndds;
+        block->myoffset = MAGICLEN;
+        block->firstdd  = block->prev == NULL ? 0 : block->prev->firstdd + block->prev->ndds;
+        if ((block->ddlist = (dd_t *)malloc((uint32)ndds * sizeof(dd_t))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        block->ddlist[0].tag       = DFTAG_NULL;
+        block->ddlist[0].ref       = DFREF_NONE;
+        block->ddlist[0].length    = INVALID_LENGTH;
+        block->ddlist[0].offset    = INVALID_OFFSET;
+        block->ddlist[0].spec_code = 0;
+        block->ddlist[0].blk       = block;
+        HDmemfill(&block->ddlist[1], &block->ddlist[0], sizeof(dd_t), (uint32)(ndds - 1));
+
+        /* the old blocks are still in use, so the new ones get other space */
+        if (block->prev != NULL) {
+            if ((block->myoffset = HPgetdiskblock(file_rec, NDDS_SZ + OFFSET_SZ + (ndds * DD_SZ), FALSE)) ==
+                FAIL)
+                HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+            block->prev->nextoffset = block->myoffset;
+        } /* end if */
+    }     /* end for */
+
+    /* Copy the DDs in use, in order */
+    block = new_head;
+    dst   = block->ddlist;
+    for (next = old_head; next != NULL; next = next->next)
+        for (i = 0; i < next->ndds; i++) {
+            if (next->ddlist[i].tag == DFTAG_NULL)
+                continue;
+            if (dst == block->ddlist + block->ndds) {
+                block = block->next;
+                dst   = block->ddlist;
+            } /* end if */
+            *dst     = next->ddlist[i];
+            dst->blk = block;
+            dst++;
+        } /* end for */
+
+    /* Switch to the new DD list, and build the tag tree, which points
+       into the DD list, again */
+    file_rec->ddhead     = new_head;
+    file_rec->ddlast     = new_last;
+    new_head             = NULL;
+    file_rec->ddnull     = NULL;
+    file_rec->ddnull_idx = (-1);
+    tbbtdfree(file_rec->tag_tree, tagdestroynode, NULL);
+    file_rec->tag_tree = tbbtdmake(tagcompare, sizeof(uint16), TBBT_FAST_UINT16_COMPARE);
+    for (block = file_rec->ddhead; block != NULL; block = block->next)
+        for (i = 0; i < block->ndds; i++)
+            if (block->ddlist[i].tag != DFTAG_NULL)
+                if (HTIregister_tag_ref(file_rec, &block->ddlist[i]) == FAIL)
+                    HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* Write the blocks after the first, then the first, which makes the
+       new DD list the one of the file */
+    for (block = file_rec->ddhead->next; block != NULL; block = block->next)
+        block->dirty = TRUE;
+    if (HTPsync(file_rec) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    file_rec->ddhead->dirty = TRUE;
+    if (HTPsync(file_rec) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* The space of the old blocks after the first can be used again */
+    for (block = old_head->next; block != NULL; block = block->next)
+        if (HPfreediskblock(file_rec, block->myoffset, NDDS_SZ + OFFSET_SZ + (block->ndds * DD_SZ)) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+done:
+    if (old_head != NULL && old_head != file_rec->ddhead)
+        for (block = old_head; block != NULL; block = next) {
+            next = block->next;
+            free(block->ddlist);
+            free(block);
+        } /* end for */
+    for (block = new_head; block != NULL; block = next) {
+        next = block->next;
+        free(block->ddlist);
+        free(block);
+    } /* end for */
+
+    return ret_value;
+} /* end HTPcompact() */
+
 /******************************************************************************
  NAME
      HTPcreate - Create (and attach to) a tag/ref pair
@@ -554,8 +774,9 @@ HTPcreate(filerec_t *file_rec, /* IN: File record to store info in */
     dd_ptr->ref = ref;
     /* the following assures object definition in DD list
        without data written for object. */
-    dd_ptr->offset = INVALID_OFFSET;
-    dd_ptr->length = INVALID_LENGTH;
+    dd_ptr->offset    = INVALID_OFFSET;
+    dd_ptr->length    = INVALID_LENGTH;
+    dd_ptr->spec_code = 0;
 
     /* dd_ptr->blk should already be correctly set */
 
@@ -602,6 +823,7 @@ HTPselect(filerec_t *file_rec, /* IN: File record to store info in */
     HEclear();
     if (file_rec == NULL || (tag == DFTAG_NULL || tag == DFTAG_WILDCARD) || ref == DFREF_WILDCARD)
         HGOTO_ERROR(DFE_ARGS, FAIL);
+    file_rec->stats.nlookups++;
 
     /* Try to find the regular tag in the tag info tree */
     if ((tip_ptr = (tag_info **)tbbtdfind(file_rec->tag_tree, (void *)&base_tag, NULL)) == NULL)
@@ -679,7 +901,7 @@ HTPdelete(atom_t ddid /* IN: DD id to delete */
     file_rec->ddnull     = NULL;
     file_rec->ddnull_idx = (-1);
 
-    if (HPfreediskblock(file_rec, dd_ptr->offset, dd_ptr->length) == FAIL)
+    if (HTIfree_space(file_rec, dd_ptr) == FAIL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
     /* Update the disk, etc. */
@@ -734,6 +956,7 @@ HTPupdate(atom_t ddid,    /* IN: DD id to update */
         dd_ptr->length = new_len;
     if (new_off != dont_change)
         dd_ptr->offset = new_off;
+    dd_ptr->spec_code = 0; /* read it again, see HTPspecial_code() */
 
     /* Update the disk, etc. */
     if (HTIupdate_dd(dd_ptr->blk->frec, dd_ptr) == FAIL)
@@ -743,6 +966,53 @@ done:
     return ret_value;
 } /* HTPupdate() */
 
+/******************************************************************************
+ NAME
+     HTPunspecial - Turn the DD of a special element into a plain one
+
+ DESCRIPTION
+    Changes the tag of a DD from the special tag to its base tag and points
+    it at new data, so that the element keeps its tag/ref but is stored as
+    a plain element.  The description record the DD pointed to is released.
+    The caller is responsible for the storage the special element used.
+
+ RETURNS
+    Returns SUCCEED if successful and FAIL otherwise
+
+*******************************************************************************/
+intn
+HTPunspecial(atom_t ddid,    /* IN: DD id to update */
+             int32  new_off, /* IN: offset of the plain data */
+             int32  new_len  /* IN: length of the plain data */
+)
+{
+    dd_t *dd_ptr    = NULL; /* ptr to the DD info for the tag/ref */
+    intn  ret_value = SUCCEED;
+
+    HEclear();
+    /* Retrieve the atom's object, so we can update the DD */
+    if ((dd_ptr = HAatom_object(ddid)) == NULL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (!SPECIALTAG(dd_ptr->tag))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (HTIfree_space(dd_ptr->blk->frec, dd_ptr) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* Update the tag/ref in memory */
+    dd_ptr->tag       = BASETAG(dd_ptr->tag);
+    dd_ptr->offset    = new_off;
+    dd_ptr->length    = new_len;
+    dd_ptr->spec_code = 0;
+
+    /* Update the disk, etc. */
+    if (HTIupdate_dd(dd_ptr->blk->frec, dd_ptr) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+done:
+    return ret_value;
+} /* HTPunspecial() */
+
 /******************************************************************************
  NAME
      HTPinquire - Get the DD information for a DD (i.e. tag/ref/offset/length)
@@ -818,6 +1088,131 @@ done:
     return ret_value;
 } /* HTPis_special() */
 
+/* Orders data extents, pairs of offset and length, by offset */
+static int
+HTIextent_compare(const void *p1, const void *p2)
+{
+    int32 o1 = ((const int32 *)p1)[0];
+    int32 o2 = ((const int32 *)p2)[0];
+
+    return (o1 > o2) - (o1 < o2);
+} /* HTIextent_compare() */
+
+/******************************************************************************
+ NAME
+     HTPshares_data - Check whether the data of a DD is shared
+
+ DESCRIPTION
+    Checks whether the data of the DD overlaps the data of another DD of
+    the file, as after Hdupdd().  The first call sorts the data of all the
+    DDs by offset to find out whether any of them overlap; until Hdupdd()
+    is called, a file where none do is not searched again.
+
+ RETURNS
+    Returns TRUE(1)/FALSE(0) if successful and FAIL otherwise
+
+*******************************************************************************/
+intn
+HTPshares_data(atom_t ddid /* IN: DD id to inquire about */
+)
+{
+    dd_t      *dd_ptr; /* ptr to the DD info for the tag/ref */
+    filerec_t *file_rec;
+    ddblock_t *block;
+    dd_t      *list;
+    int32     *exts = NULL; /* offset and length of the data of each DD */
+    int32      n    = 0;    /* number of extents */
+    int32      end;         /* end of the extents sorted so far */
+    int32      k;
+    intn       i;
+    intn       ret_value = FALSE;
+
+    HEclear();
+    /* Retrieve the atom's object, so we can look at its data */
+    if ((dd_ptr = HAatom_object(ddid)) == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    file_rec = dd_ptr->blk->frec;
+
+    if (!file_rec->dd_shared_known) {
+        for (block = file_rec->ddhead; block != NULL; block = block->next)
+            n += block->ndds;
+        if (n > 0 && (exts = (int32 *)malloc((size_t)n * 2 * sizeof(int32))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+        for (n = 0, block = file_rec->ddhead; block != NULL; block = block->next) {
+            list = block->ddlist;
+            for (i = 0; i < block->ndds; i++)
+                if (list[i].tag != DFTAG_NULL && list[i].offset != INVALID_OFFSET &&
+                    list[i].length != INVALID_LENGTH && list[i].length > 0) {
+                    exts[2 * n]     = list[i].offset;
+                    exts[2 * n + 1] = list[i].length;
+                    n++;
+                }
+        } /* end for */
+        if (n > 1)
+            qsort(exts, (size_t)n, 2 * sizeof(int32), HTIextent_compare);
+
+        file_rec->dd_shared = FALSE;
+        for (end = 0, k = 0; k < n; k++) {
+            if (k > 0 && exts[2 * k] < end) {
+                file_rec->dd_shared = TRUE;
+                break;
+            }
+            end = MAX(end, exts[2 * k] + exts[2 * k + 1]);
+        }
+        file_rec->dd_shared_known = TRUE;
+    }
+
+    ret_value = HTIshares_data(file_rec, dd_ptr);
+
+done:
+    free(exts);
+    return ret_value;
+} /* HTPshares_data() */
+
+/******************************************************************************
+ NAME
+     HTPspecial_code - Get the special code of the element of a special DD
+
+ DESCRIPTION
+    Reads the special code at the start of the data of a special element the
+    first time it is asked for and keeps it with the DD, so that the special
+    elements opened again are not read for it.  The code kept is dropped
+    whenever the DD is pointed at other data.
+
+ RETURNS
+    Returns SUCCEED if successful and FAIL otherwise
+
+*******************************************************************************/
+intn
+HTPspecial_code(atom_t ddid,    /* IN: DD id of the special element */
+                int16 *spec_code /* OUT: special code of the element */
+)
+{
+    dd_t      *dd_ptr; /* ptr to the DD info for the tag/ref */
+    filerec_t *file_rec;
+    uint8      lbuf[2]; /* temporary buffer */
+    uint8     *p;       /* tmp buf ptr */
+    intn       ret_value = SUCCEED;
+
+    HEclear();
+    /* Retrieve the atom's object, so we can read its data */
+    if ((dd_ptr = HAatom_object(ddid)) == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (dd_ptr->spec_code == 0) {
+        file_rec = dd_ptr->blk->frec;
+        if (HPread_at(file_rec, dd_ptr->offset, lbuf, 2) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        p = &lbuf[0];
+        INT16DECODE(p, dd_ptr->spec_code);
+    } /* end if */
+    *spec_code = dd_ptr->spec_code;
+
+done:
+    return ret_value;
+} /* HTPspecial_code() */
+
 /******************************************************************************
  NAME
      Hdupdd - Duplicate a data descriptor
@@ -844,6 +1239,7 @@ Hdupdd(int32  file_id, /* IN: File ID the tag/refs are in */
     atom_t     new_dd;   /* The DD id for the new DD */
     int32      old_len;  /* The length of the old DD */
     int32      old_off;  /* The offset of the old DD */
+    filerec_t *locked    = NULL;
     intn       ret_value = SUCCEED;
 
     /* clear error stack and check validity of file id */
@@ -851,6 +1247,7 @@ Hdupdd(int32  file_id, /* IN: File ID the tag/refs are in */
     file_rec = HAatom_object(file_id);
     if (BADFREC(file_rec))
         HGOTO_ERROR(DFE_ARGS, FAIL);
+    locked = HL_LOCK_FILE(file_rec);
 
     /* Attach to the old DD in the file */
     if ((old_dd = HTPselect(file_rec, old_tag, old_ref)) == FAIL)
@@ -867,6 +1264,8 @@ Hdupdd(int32  file_id, /* IN: File ID the tag/refs are in */
     /* Set the new DD's offset & length to the same as the old DD */
     if (HTPupdate(new_dd, old_off, old_len) == FAIL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (old_off != INVALID_OFFSET && old_len != INVALID_LENGTH && old_len > 0)
+        file_rec->dd_shared = file_rec->dd_shared_known = TRUE;
 
     /* End access to the old & new DDs */
     if (HTPendaccess(old_dd) == FAIL)
@@ -875,6 +1274,7 @@ Hdupdd(int32  file_id, /* IN: File ID the tag/refs are in */
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
 done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* Hdupdd() */
 
@@ -901,6 +1301,7 @@ Hnumber(int32  file_id, /* IN: File ID the tag/refs are in */
     uintn      all_cnt;
     uintn      real_cnt;
     filerec_t *file_rec; /* file record */
+    filerec_t *locked    = NULL;
     int32      ret_value = SUCCEED;
 
     /* convert file id to file record */
@@ -909,6 +1310,7 @@ Hnumber(int32  file_id, /* IN: File ID the tag/refs are in */
     HEclear();
     if (BADFREC(file_rec))
         HGOTO_ERROR(DFE_ARGS, FAIL);
+    locked = HL_LOCK_FILE(file_rec);
 
     /* Go count the items with that tag */
     if (HTIcount_dd(file_rec, tag, DFREF_WILDCARD, &all_cnt, &real_cnt) == FAIL)
@@ -917,6 +1319,7 @@ Hnumber(int32  file_id, /* IN: File ID the tag/refs are in */
     ret_value = (int32)real_cnt;
 
 done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* Hnumber() */
 
@@ -939,6 +1342,7 @@ Hnewref(int32 file_id /* IN: File ID the tag/refs are in */)
 {
     filerec_t *file_rec; /* file record */
     uint16     ref;      /* the new ref */
+    filerec_t *locked    = NULL;
     uint16     ret_value = DFREF_NONE;
     uint32     i_ref; /* index for FOR loop */
 
@@ -947,6 +1351,7 @@ Hnewref(int32 file_id /* IN: File ID the tag/refs are in */)
     file_rec = HAatom_object(file_id);
     if (BADFREC(file_rec))
         HGOTO_ERROR(DFE_ARGS, 0);
+    locked = HL_LOCK_FILE(file_rec);
 
     /* if maxref of this file is still below the maximum,
      just return next number */
@@ -966,6 +1371,7 @@ Hnewref(int32 file_id /* IN: File ID the tag/refs are in */)
     }                            /* end else */
 
 done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* Hnewref() */
 
@@ -991,6 +1397,7 @@ Htagnewref(int32  file_id, /* IN: File ID the tag/refs are in */
     tag_info  *tinfo_ptr;                /* pointer to the info for a tag */
     tag_info **tip_ptr;                  /* ptr to the ptr to the info for a tag */
     uint16     base_tag  = BASETAG(tag); /* corresponding base tag (if the tag is special) */
+    filerec_t *locked    = NULL;
     uint16     ret_value = DFREF_NONE;
 
     /* clear error stack and check validity of file record id */
@@ -998,6 +1405,7 @@ Htagnewref(int32  file_id, /* IN: File ID the tag/refs are in */
     file_rec = HAatom_object(file_id);
     if (BADFREC(file_rec))
         HGOTO_ERROR(DFE_ARGS, 0);
+    locked = HL_LOCK_FILE(file_rec);
 
     if ((tip_ptr = (tag_info **)tbbtdfind(file_rec->tag_tree, (void *)&base_tag, NULL)) == NULL)
         ret_value = 1;        /* The first available ref */
@@ -1008,6 +1416,7 @@ Htagnewref(int32  file_id, /* IN: File ID the tag/refs are in */
     }
 
 done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* Htagnewref() */
 
@@ -1045,6 +1454,7 @@ Hfind(int32   file_id,    /* IN: file ID to search in */
 {
     filerec_t *file_rec; /* file record */
     dd_t      *dd_ptr;   /* ptr to current ddlist searched */
+    filerec_t *locked    = NULL;
     intn       ret_value = SUCCEED;
 
     /* clear error stack and check validity of the access id */
@@ -1056,6 +1466,7 @@ Hfind(int32   file_id,    /* IN: file ID to search in */
     file_rec = HAatom_object(file_id);
     if (BADFREC(file_rec))
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    locked = HL_LOCK_FILE(file_rec);
 
     dd_ptr = NULL;
     if (*find_ref != 0 || *find_tag != 0) { /* continue a search */
@@ -1074,6 +1485,7 @@ Hfind(int32   file_id,    /* IN: file ID to search in */
     *find_length = dd_ptr->length;
 
 done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* end Hfind() */
 
@@ -1170,10 +1582,9 @@ HDreuse_tagref(int32  file_id, /* IN: id of file */
     if ((ddid = HTPselect(file_rec, tag, ref)) == FAIL)
         HGOTO_ERROR(DFE_NOMATCH, FAIL);
 
-    /* could reuse space in file by calling HPfreediskblock() routine
-       but it does nothing for now. For later. */
-    /* if (HPfreediskblock(file_rec,dd_ptr->offset,dd_ptr->length) == FAIL)
-        HGOTO_ERROR(DFE_INTERNAL, FAIL); */
+    /* the data is rewritten elsewhere, let its space be reused */
+    if (HTIfree_space(file_rec, HAatom_object(ddid)) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
     /* reuse the dd by setting the offset and length to
        INVALID_OFFSET and INVALID_LENGTH*/
@@ -1217,6 +1628,7 @@ Hdeldd(int32 file_id, uint16 tag, uint16 ref)
 {
     filerec_t *file_rec; /* file record */
     atom_t     ddid;     /* ID for the DD */
+    filerec_t *locked    = NULL;
     intn       ret_value = SUCCEED;
 
     /* clear error stack and check validity of file record id */
@@ -1224,6 +1636,7 @@ Hdeldd(int32 file_id, uint16 tag, uint16 ref)
     file_rec = HAatom_object(file_id);
     if (BADFREC(file_rec) || tag == DFTAG_WILDCARD || ref == DFREF_WILDCARD)
         HGOTO_ERROR(DFE_ARGS, FAIL);
+    locked = HL_LOCK_FILE(file_rec);
 
     /* look for the dd to delete */
     if ((ddid = HTPselect(file_rec, tag, ref)) == FAIL)
@@ -1234,9 +1647,50 @@ Hdeldd(int32 file_id, uint16 tag, uint16 ref)
         HGOTO_ERROR(DFE_CANTDELDD, FAIL);
 
 done:
+    HL_UNLOCK_FILE(locked);
     return ret_value;
 } /* end Hdeldd */
 
+/*--------------------------------------------------------------------------
+NAME
+   Hcompactdd -- drop the empty DDs of the DD list
+USAGE
+   intn Hcompactdd(file_id)
+   int32 file_id;            IN: id of file
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
+DESCRIPTION
+   Rewrites the DD list of a file opened for writing in as few DD blocks
+   as the DDs in use take, leaving out the empty DDs of the elements
+   deleted.  Files whose elements are deleted and written again over a
+   long time end up with long chains of mostly empty DD blocks, all of
+   which are read each time the file is opened.  No element of the file
+   may be accessed while this is done.  Hsetcompactdd() has this done
+   by the last Hclose() of the file.
+
+--------------------------------------------------------------------------*/
+intn
+Hcompactdd(int32 file_id)
+{
+    filerec_t *file_rec; /* file record */
+    filerec_t *locked    = NULL;
+    intn       ret_value = SUCCEED;
+
+    /* clear error stack and check validity of file record id */
+    HEclear();
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    locked = HL_LOCK_FILE(file_rec);
+
+    if (HTPcompact(file_rec) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+done:
+    HL_UNLOCK_FILE(locked);
+    return ret_value;
+} /* end Hcompactdd */
+
 #ifdef DD_DEBUG
 /*--------------------------------------------------------------------------
  NAME
@@ -1341,6 +1795,59 @@ done:
 
 /* Private, static, internal routines.  Do not call from outside this module */
 
+/*--------------------------------------------------------------------------
+ NAME
+    HTIread_window -- read the DD blocks through a read-ahead window
+ USAGE
+    uint8 *HTIread_window(file_rec, win, offset, bytes)
+        filerec_t  * file_rec;        IN: file record
+        ddwindow_t * win;             IN/OUT: window of the file last read
+        int32        offset;          IN: offset of the bytes in the file
+        int32        bytes;           IN: # of bytes needed
+ RETURNS
+    returns a pointer to the bytes, good until the next call, or NULL
+ DESCRIPTION
+    Returns the bytes out of the window last read if they are in it.
+    Otherwise the window is read again from 'offset': DD_READ_AHEAD bytes,
+    or the bytes needed if more, but not past the end of the file.  Only
+    the bytes needed are read when the length of the file is unknown.
+
+--------------------------------------------------------------------------*/
+static uint8 *
+HTIread_window(filerec_t *file_rec, ddwindow_t *win, int32 offset, int32 bytes)
+{
+    int32  len;
+    uint8 *ret_value = NULL;
+
+    if (win->buf != NULL && offset >= win->off && bytes <= win->len - (offset - win->off))
+        HGOTO_DONE(win->buf + (offset - win->off));
+
+    len = bytes;
+    if (win->file_len != FAIL && bytes < DD_READ_AHEAD && offset < win->file_len)
+        len = MAX(bytes, MIN(DD_READ_AHEAD, win->file_len - offset));
+
+    if ((uintn)len > win->buf_size) {
+        free(win->buf);
+        win->len = 0;
+        if ((win->buf = (uint8 *)malloc((size_t)len)) == NULL) {
+            win->buf_size = 0;
+            HGOTO_ERROR(DFE_NOSPACE, NULL);
+        } /* end if */
+        win->buf_size = (uintn)len;
+    } /* end if */
+
+    if (HPread_at(file_rec, offset, win->buf, len) == FAIL) {
+        win->len = 0;
+        HGOTO_ERROR(DFE_READERROR, NULL);
+    } /* end if */
+    win->off  = offset;
+    win->len  = len;
+    ret_value = win->buf;
+
+done:
+    return ret_value;
+} /* HTIread_window */
+
 /*--------------------------------------------------------------------------
  NAME
     HTInew_dd_block -- create a new (empty) DD block
@@ -1353,6 +1860,8 @@ done:
  DESCRIPTION
     Create a new DDblock in the file.  Update the previously last DDblock so
     that its offset points to the newly created one.
+    The new block has twice the DDs of the previously last one, but no more
+    than GROW_MAX_NDDS unless the file asks for more.
 
 --------------------------------------------------------------------------*/
 static intn
@@ -1375,15 +1884,24 @@ HTInew_dd_block(filerec_t *file_rec)
     /* allocate new dd block record and fill in data */
     if ((block = (ddblock_t *)malloc(sizeof(ddblock_t))) == NULL)
         HGOTO_ERROR(DFE_NOSPACE, FAIL);
-    block->ndds       = (int16)(ndds = (intn)file_rec->ddhead->ndds); /* snarf from first block */
+    /* snarf from first block, unless asked otherwise in Hopen(); a block
+       has twice the DDs of the last one, up to GROW_MAX_NDDS, so that the
+       chain of blocks of a file with many objects stays short */
+    ndds              = file_rec->new_ndds > 0 ? (intn)file_rec->new_ndds : (intn)file_rec->ddhead->ndds;
+    ndds              = MAX(ndds, MIN(2 * (intn)file_rec->ddlast->ndds, GROW_MAX_NDDS));
+    block->ndds       = (int16)ndds;
     block->next       = (ddblock_t *)NULL;
     block->nextoffset = 0;
+    block->firstdd    = file_rec->ddlast->firstdd + file_rec->ddlast->ndds;
 
     /* Keep the filerec_t pointer around for each ddblock */
     block->frec = file_rec;
 
-    /* get room for the new DD block in the file */
-    if ((nextoffset = HPgetdiskblock(file_rec, NDDS_SZ + OFFSET_SZ + (ndds * DD_SZ), TRUE)) == FAIL)
+    /* get room for the new DD block in the file; the blocks of a file created
+       for streaming get theirs at its end when it is closed, see HTPsync() */
+    if (file_rec->stream != NULL)
+        nextoffset = 0;
+    else if ((nextoffset = HPgetdiskblock(file_rec, NDDS_SZ + OFFSET_SZ + (ndds * DD_SZ), TRUE)) == FAIL)
         HGOTO_ERROR(DFE_SEEKERROR, FAIL);
     block->myoffset = nextoffset;             /* set offset of new block */
     block->dirty    = (uintn)file_rec->cache; /* if we're caching, wait to write DD block */
@@ -1408,12 +1926,15 @@ HTInew_dd_block(filerec_t *file_rec)
     list[0].tag    = DFTAG_NULL;
     list[0].ref    = DFREF_NONE;
     list[0].length = INVALID_LENGTH;
-    list[0].offset = INVALID_OFFSET;
-    list[0].blk    = block;
+    list[0].offset    = INVALID_OFFSET;
+    list[0].spec_code = 0;
+    list[0].blk       = block;
     HDmemfill(&list[1], &list[0], sizeof(dd_t), (uint32)ndds - 1);
 
-    if (file_rec->cache != 0) { /* if we are caching, wait to update previous DD block */
-        uint8 *tbuf;            /* temporary buffer */
+    /* if we are caching, wait to update previous DD block; a streamed file
+       writes the block once it has its place */
+    if (file_rec->cache != 0 && file_rec->stream == NULL) {
+        uint8 *tbuf; /* temporary buffer */
 
         tbuf = (uint8 *)malloc(ndds * DD_SZ);
         if (tbuf == (uint8 *)NULL)
@@ -1454,7 +1975,8 @@ HTInew_dd_block(filerec_t *file_rec)
     file_rec->ddlast = block;
 
     /* set the end of the file to the end of the current DD block */
-    file_rec->f_end_off = block->myoffset + (NDDS_SZ + OFFSET_SZ) + (block->ndds * DD_SZ);
+    if (file_rec->stream == NULL)
+        file_rec->f_end_off = block->myoffset + (NDDS_SZ + OFFSET_SZ) + (block->ndds * DD_SZ);
 
 done:
     return ret_value;
@@ -1488,6 +2010,8 @@ HTIfind_dd(filerec_t *file_rec, uint16 look_tag, uint16 look_ref, dd_t **pdd, in
     intn       ret_value = SUCCEED;
 
     HEclear();
+    file_rec->stats.nlookups++;
+
     /* Create the special version of the tag to search for also */
     special_tag = MKSPECIALTAG(look_tag);
 
@@ -1568,65 +2092,30 @@ HTIfind_dd(filerec_t *file_rec, uint16 look_tag, uint16 look_ref, dd_t **pdd, in
                 }                                  /* end for */
             }                                      /* end if */
             else if (look_tag == DFTAG_WILDCARD) { /* tag is wildcard */
-                for (; block; block = block->next) {
-                    list = &block->ddlist[idx];
-                    for (; idx < block->ndds; idx++, list++) {
-                        /* skip the empty dd's */
-                        if (list->tag == DFTAG_NULL)
-                            continue;
-
-                        if (list->ref == look_ref) {
+                /* look up the ref in the dynarray of each tag */
+                if ((*pdd = HTIfind_ref_dd(file_rec, look_ref, DDPOS(block->ddlist) + idx, DF_FORWARD)) !=
+                    NULL)
+                    HGOTO_DONE(SUCCEED);
+            }                                      /* end if */
+            else if (look_ref == DFREF_WILDCARD) { /* ref is wildcard */
+                tag_info **tip_ptr;                      /* ptr to the ptr to the info for a tag */
+                tag_info  *tinfo_ptr;                    /* pointer to the info for a tag */
+                uint16     base_tag = BASETAG(look_tag); /* corresponding base tag */
+
+                /* walk the DDs of the tag from the current position on */
+                if ((tip_ptr = (tag_info **)tbbtdfind(file_rec->tag_tree, (void *)&base_tag, NULL)) != NULL) {
+                    tinfo_ptr = *tip_ptr;
+                    for (idx = HTIfind_tag_pos(tinfo_ptr, DDPOS(block->ddlist) + idx); idx < tinfo_ptr->ndds;
+                         idx++) {
+                        list = tinfo_ptr->dds[idx];
+                        if (list->tag == look_tag || (special_tag != DFTAG_NULL && list->tag == special_tag)) {
                             /* we have a match !! */
                             *pdd = list;
                             HGOTO_DONE(SUCCEED);
                         } /* end if */
                     }     /* end for */
-
-                    /* start from beginning of the next dd list */
-                    idx = 0;
-                }                                  /* end for */
-            }                                      /* end if */
-            else if (look_ref == DFREF_WILDCARD) { /* ref is wildcard */
-                if (special_tag == DFTAG_NULL) {
-                    /* Change this to lookup the next used ref # in the bitvector or dynarray -QAK */
-                    for (; block; block = block->next) {
-                        list = &block->ddlist[idx];
-                        for (; idx < block->ndds; idx++, list++) {
-                            /* skip the empty dd's */
-                            if (list->tag == DFTAG_NULL && look_tag != DFTAG_NULL)
-                                continue;
-
-                            if (list->tag == look_tag) {
-                                /* we have a match !! */
-                                *pdd = list;
-                                HGOTO_DONE(SUCCEED);
-                            } /* end if */
-                        }     /* end for */
-
-                        /* start from beginning of the next dd list */
-                        idx = 0;
-                    } /* end for */
-                }     /* end if */
-                else {
-                    for (; block; block = block->next) {
-                        list = &block->ddlist[idx];
-                        for (; idx < block->ndds; idx++, list++) {
-                            /* skip the empty dd's */
-                            if (list->tag == DFTAG_NULL && look_tag != DFTAG_NULL)
-                                continue;
-
-                            if (list->tag == look_tag || list->tag == special_tag) {
-                                /* we have a match !! */
-                                *pdd = list;
-                                HGOTO_DONE(SUCCEED);
-                            } /* end if */
-                        }     /* end for */
-
-                        /* start from beginning of the next dd list */
-                        idx = 0;
-                    } /* end for */
-                }     /* end else */
-            }         /* end if */
+                }         /* end if */
+            }             /* end if */
             else {    /* Both tag & ref are not wildcards */
                 for (; block; block = block->next) {
                     list = &block->ddlist[idx];
@@ -1658,6 +2147,35 @@ HTIfind_dd(filerec_t *file_rec, uint16 look_tag, uint16 look_ref, dd_t **pdd, in
                 block = (*pdd)->blk;
                 idx   = ((*pdd) - &block->ddlist[0]) - 1;
             } /* end else */
+
+            if (look_tag == DFTAG_WILDCARD && look_ref != DFREF_WILDCARD) { /* tag is wildcard */
+                /* look up the ref in the dynarray of each tag */
+                if ((*pdd = HTIfind_ref_dd(file_rec, look_ref, DDPOS(block->ddlist) + idx, DF_BACKWARD)) !=
+                    NULL)
+                    HGOTO_DONE(SUCCEED);
+                HGOTO_DONE(FAIL);
+            } /* end if */
+            else if (look_tag != DFTAG_WILDCARD && look_tag != DFTAG_NULL) { /* tag is not wildcard */
+                tag_info **tip_ptr;                      /* ptr to the ptr to the info for a tag */
+                tag_info  *tinfo_ptr;                    /* pointer to the info for a tag */
+                uint16     base_tag = BASETAG(look_tag); /* corresponding base tag */
+
+                /* walk the DDs of the tag back from the current position */
+                if ((tip_ptr = (tag_info **)tbbtdfind(file_rec->tag_tree, (void *)&base_tag, NULL)) == NULL)
+                    HGOTO_DONE(FAIL);
+                tinfo_ptr = *tip_ptr;
+                for (idx = HTIfind_tag_pos(tinfo_ptr, DDPOS(block->ddlist) + idx + 1) - 1; idx >= 0; idx--) {
+                    list = tinfo_ptr->dds[idx];
+                    if ((list->tag == look_tag || (special_tag != DFTAG_NULL && list->tag == special_tag)) &&
+                        (look_ref == DFREF_WILDCARD || list->ref == look_ref)) {
+                        /* we have a match !! */
+                        *pdd = list;
+                        HGOTO_DONE(SUCCEED);
+                    } /* end if */
+                }     /* end for */
+                HGOTO_DONE(FAIL);
+            } /* end if */
+
             for (; block;) {
                 list = block->ddlist;
                 for (; idx >= 0; idx--) {
@@ -1690,6 +2208,81 @@ done:
     return ret_value;
 } /* HTIfind_dd */
 
+/*--------------------------------------------------------------------------
+ NAME
+    HTIfree_space -- release the data space of a DD
+ USAGE
+    int HTIfree_space(file_rec, dd_ptr)
+        filerec_t *file_rec;    IN: id of file
+        dd_t      *dd_ptr;      IN: pointer to dd that stops using its data
+ RETURNS
+    returns SUCCEED (0) if successful and FAIL (-1) if failed.
+ DESCRIPTION
+   Hands the space of the DD's data to HPfreediskblock(), unless another
+   DD still uses some of it.
+
+--------------------------------------------------------------------------*/
+static intn
+HTIfree_space(filerec_t *file_rec, dd_t *dd_ptr)
+{
+    intn ret_value = SUCCEED;
+
+    if (dd_ptr == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (dd_ptr->offset == INVALID_OFFSET || dd_ptr->length == INVALID_LENGTH || dd_ptr->length <= 0)
+        HGOTO_DONE(SUCCEED);
+
+    /* Hdupdd() lets several DDs share data, keep it while any other uses it */
+    if (HTIshares_data(file_rec, dd_ptr))
+        HGOTO_DONE(SUCCEED);
+
+    if (HPfreediskblock(file_rec, dd_ptr->offset, dd_ptr->length) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+done:
+    return ret_value;
+} /* HTIfree_space */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HTIshares_data -- check whether another DD uses some of a DD's data
+ USAGE
+    int HTIshares_data(file_rec, dd_ptr)
+        filerec_t *file_rec;    IN: id of file
+        dd_t      *dd_ptr;      IN: pointer to dd to check
+ RETURNS
+    returns TRUE if another DD's data overlaps the DD's data, FALSE if not
+ DESCRIPTION
+   Goes through the whole DD list, unless the file is known not to have
+   any data shared, see HTPshares_data().
+
+--------------------------------------------------------------------------*/
+static intn
+HTIshares_data(filerec_t *file_rec, dd_t *dd_ptr)
+{
+    ddblock_t *block;
+    dd_t      *list;
+    int32      end;
+    intn       i;
+
+    if (dd_ptr->offset == INVALID_OFFSET || dd_ptr->length == INVALID_LENGTH || dd_ptr->length <= 0)
+        return FALSE;
+    if (file_rec->dd_shared_known && !file_rec->dd_shared)
+        return FALSE;
+
+    end = dd_ptr->offset + dd_ptr->length;
+    for (block = file_rec->ddhead; block != NULL; block = block->next) {
+        list = block->ddlist;
+        for (i = 0; i < block->ndds; i++)
+            if (&list[i] != dd_ptr && list[i].tag != DFTAG_NULL && list[i].offset != INVALID_OFFSET &&
+                list[i].length != INVALID_LENGTH && list[i].offset < end &&
+                dd_ptr->offset < list[i].offset + list[i].length)
+                return TRUE;
+    } /* end for */
+
+    return FALSE;
+} /* HTIshares_data */
+
 /*--------------------------------------------------------------------------
  NAME
     HTIupdate_dd -- update a DD on disk
@@ -1713,6 +2306,10 @@ HTIupdate_dd(filerec_t *file_rec, dd_t *dd_ptr)
     HEclear();
     block = dd_ptr->blk;
     idx   = dd_ptr - &block->ddlist[0];
+
+    /* the element may not hold what the file buffered for it anymore */
+    HBPforget(file_rec, BASETAG(dd_ptr->tag), dd_ptr->ref);
+
     if (file_rec->cache) { /* if caching is on, postpone update until later */
         file_rec->dirty |= DDLIST_DIRTY;
         block->dirty = TRUE;
@@ -1790,7 +2387,6 @@ HTIcount_dd(filerec_t *file_rec, uint16 cnt_tag, uint16 cnt_ref, uintn *all_cnt,
     /* search for special version also */
     special_tag = MKSPECIALTAG(cnt_tag);
 
-    /* Change these algorithms to take advantage of the dynamic arrays for tags -QAK */
     switch (cnt_tag) {
         case DFTAG_WILDCARD:
             for (block = file_rec->ddhead; block != NULL; block = block->next) {
@@ -1822,53 +2418,22 @@ HTIcount_dd(filerec_t *file_rec, uint16 cnt_tag, uint16 cnt_ref, uintn *all_cnt,
             } /* end for */
             break;
 
-        default:
-            if (special_tag == DFTAG_NULL) {
-                for (block = file_rec->ddhead; block != NULL; block = block->next) {
-                    t_all_cnt += (uintn)block->ndds;
+        default: {
+            tag_info **tip_ptr;                     /* ptr to the ptr to the info for a tag */
+            uint16     base_tag = BASETAG(cnt_tag); /* corresponding base tag */
 
-                    dd_ptr = block->ddlist;
-                    for (idx = 0; idx < block->ndds; idx++, dd_ptr++)
-                        if (dd_ptr->tag == cnt_tag && (dd_ptr->ref == cnt_ref || cnt_ref == DFREF_WILDCARD))
-                            t_real_cnt++;
+            for (block = file_rec->ddhead; block != NULL; block = block->next)
+                t_all_cnt += (uintn)block->ndds;
+
+            /* only look at the DDs of the tag */
+            if ((tip_ptr = (tag_info **)tbbtdfind(file_rec->tag_tree, (void *)&base_tag, NULL)) != NULL)
+                for (idx = 0; idx < (*tip_ptr)->ndds; idx++) {
+                    dd_ptr = (*tip_ptr)->dds[idx];
+                    if ((dd_ptr->tag == cnt_tag || (special_tag != DFTAG_NULL && dd_ptr->tag == special_tag)) &&
+                        (cnt_ref == DFREF_WILDCARD || dd_ptr->ref == cnt_ref))
+                        t_real_cnt++;
                 } /* end for */
-            }     /* end if */
-            else {
-                if (cnt_ref == DFREF_WILDCARD) {
-                    for (block = file_rec->ddhead; block != NULL; block = block->next) {
-                        t_all_cnt += (uintn)block->ndds;
-
-                        idx    = 0;
-                        dd_ptr = block->ddlist;
-                        if (block->ndds % 2 == 1)
-                            if (dd_ptr->tag == cnt_tag || dd_ptr->tag == special_tag) {
-                                t_real_cnt++;
-                                idx++;
-                                dd_ptr++;
-                            } /* end if */
-                        for (; idx < block->ndds; idx++, dd_ptr++) {
-                            if (dd_ptr->tag == cnt_tag || dd_ptr->tag == special_tag)
-                                t_real_cnt++;
-                            idx++;
-                            dd_ptr++;
-                            if (dd_ptr->tag == cnt_tag || dd_ptr->tag == special_tag)
-                                t_real_cnt++;
-                        } /* end for */
-                    }     /* end for */
-                }         /* end if */
-                else {
-                    for (block = file_rec->ddhead; block != NULL; block = block->next) {
-                        t_all_cnt += (uintn)block->ndds;
-
-                        dd_ptr = block->ddlist;
-                        for (idx = 0; idx < block->ndds; idx++, dd_ptr++)
-                            if ((dd_ptr->tag == cnt_tag || dd_ptr->tag == special_tag) &&
-                                dd_ptr->ref == cnt_ref)
-                                t_real_cnt++;
-                    } /* end for */
-                }     /* end else */
-            }         /* end else */
-            break;
+        } break;
     } /* end switch */
 
     *all_cnt  = t_all_cnt;
@@ -1895,6 +2460,7 @@ HTIregister_tag_ref(filerec_t *file_rec, dd_t *dd_ptr)
     tag_info  *tinfo_ptr;                        /* pointer to the info for a tag */
     tag_info **tip_ptr;                          /* ptr to the ptr to the info for a tag */
     uint16     base_tag  = BASETAG(dd_ptr->tag); /* the base tag for the tag tree */
+    intn       pos;                              /* position of the DD in the tag's DD array */
     int        ret_value = SUCCEED;
 
     HEclear();
@@ -1938,6 +2504,28 @@ HTIregister_tag_ref(filerec_t *file_rec, dd_t *dd_ptr)
     if (DAset_elem(tinfo_ptr->d, (intn)dd_ptr->ref, (void *)dd_ptr) == FAIL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
+    /* Insert the DD into the tag's DD array, keeping it in DD list order.
+       DDs are mostly added at the end of the DD list, so this is usually
+       an append. */
+    if (tinfo_ptr->ndds == tinfo_ptr->maxdds) {
+        intn   new_max = (tinfo_ptr->maxdds == 0) ? TAG_DDS_START : 2 * tinfo_ptr->maxdds;
+        dd_t **new_dds;
+
+        if ((new_dds = (dd_t **)realloc(tinfo_ptr->dds, (size_t)new_max * sizeof(dd_t *))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        tinfo_ptr->dds    = new_dds;
+        tinfo_ptr->maxdds = new_max;
+    } /* end if */
+    if (tinfo_ptr->ndds == 0 || DDPOS(tinfo_ptr->dds[tinfo_ptr->ndds - 1]) < DDPOS(dd_ptr))
+        pos = tinfo_ptr->ndds;
+    else {
+        pos = HTIfind_tag_pos(tinfo_ptr, DDPOS(dd_ptr));
+        memmove(&tinfo_ptr->dds[pos + 1], &tinfo_ptr->dds[pos],
+                (size_t)(tinfo_ptr->ndds - pos) * sizeof(dd_t *));
+    } /* end else */
+    tinfo_ptr->dds[pos] = dd_ptr;
+    tinfo_ptr->ndds++;
+
 done:
     if (ret_value == FAIL) { /* Error condition cleanup */
 
@@ -1976,6 +2564,7 @@ HTIunregister_tag_ref(filerec_t *file_rec, dd_t *dd_ptr)
     }                 /* end if */
     else {            /* found an existing tag */
         intn ref_bit; /* bit of the ref # in the tag info */
+        intn pos;     /* position of the DD in the tag's DD array */
 
         tinfo_ptr = *tip_ptr; /* get the pointer to the tag info */
         if ((ref_bit = bv_get(tinfo_ptr->b, (intn)dd_ptr->ref)) == FAIL)
@@ -1989,6 +2578,14 @@ HTIunregister_tag_ref(filerec_t *file_rec, dd_t *dd_ptr)
         if (DAdel_elem(tinfo_ptr->d, (intn)dd_ptr->ref) == NULL)
             HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
+        /* and from the tag's DD array */
+        pos = HTIfind_tag_pos(tinfo_ptr, DDPOS(dd_ptr));
+        if (pos == tinfo_ptr->ndds || tinfo_ptr->dds[pos] != dd_ptr)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        memmove(&tinfo_ptr->dds[pos], &tinfo_ptr->dds[pos + 1],
+                (size_t)(tinfo_ptr->ndds - pos - 1) * sizeof(dd_t *));
+        tinfo_ptr->ndds--;
+
         /* Delete the tag/ref from the file */
         dd_ptr->tag = DFTAG_NULL;
     } /* end else */
@@ -1997,6 +2594,81 @@ done:
     return ret_value;
 } /* HTIunregister_tag_ref */
 
+/*--------------------------------------------------------------------------
+ NAME
+    HTIfind_tag_pos -- find a position in the DD list of a tag
+ USAGE
+    intn HTIfind_tag_pos(tinfo_ptr, pos)
+        tag_info  * tinfo_ptr;        IN: info for the tag
+        int32       pos;              IN: position in the DD list
+ RETURNS
+    The index of the first DD of the tag's DD array at or after position
+    'pos' of the DD list, or the number of DDs in the array if there is none.
+ DESCRIPTION
+    Binary search of the tag's DD array, which is kept in DD list order.
+
+--------------------------------------------------------------------------*/
+static intn
+HTIfind_tag_pos(tag_info *tinfo_ptr, int32 pos)
+{
+    intn lo = 0;               /* first index that may be the answer */
+    intn hi = tinfo_ptr->ndds; /* last index that may be the answer */
+
+    while (lo < hi) {
+        intn mid = lo + (hi - lo) / 2;
+
+        if (DDPOS(tinfo_ptr->dds[mid]) < pos)
+            lo = mid + 1;
+        else
+            hi = mid;
+    } /* end while */
+
+    return lo;
+} /* HTIfind_tag_pos */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HTIfind_ref_dd -- find the nearest DD with a given ref
+ USAGE
+    dd_t *HTIfind_ref_dd(file_rec, look_ref, pos, direction)
+        filerec_t  * file_rec;        IN: file record
+        uint16       look_ref;        IN: ref to look for
+        int32        pos;             IN: position in the DD list to start at
+        intn         direction;       IN: direction to search
+                                        (DF_FORWARD / DF_BACKWARD)
+ RETURNS
+    The first DD with ref 'look_ref' at or after (DF_FORWARD) or at or
+    before (DF_BACKWARD) position 'pos' of the DD list, NULL if none.
+ DESCRIPTION
+    Any tag has at most one DD with a given ref, so this only has to look
+    up the ref in the dynarray of each tag of the file.
+
+--------------------------------------------------------------------------*/
+static dd_t *
+HTIfind_ref_dd(filerec_t *file_rec, uint16 look_ref, int32 pos, intn direction)
+{
+    void **t;              /* node of the tag tree */
+    dd_t  *dd_ptr;         /* DD of the current tag with that ref */
+    dd_t  *best_dd = NULL; /* nearest DD found so far */
+
+    for (t = (void **)tbbtfirst((TBBT_NODE *)*(file_rec->tag_tree)); t != NULL;
+         t = (void **)tbbtnext((TBBT_NODE *)t)) {
+        if ((dd_ptr = DAget_elem(((tag_info *)*t)->d, (intn)look_ref)) == NULL)
+            continue;
+
+        if (direction == DF_FORWARD) {
+            if (DDPOS(dd_ptr) >= pos && (best_dd == NULL || DDPOS(dd_ptr) < DDPOS(best_dd)))
+                best_dd = dd_ptr;
+        } /* end if */
+        else {
+            if (DDPOS(dd_ptr) <= pos && (best_dd == NULL || DDPOS(dd_ptr) > DDPOS(best_dd)))
+                best_dd = dd_ptr;
+        } /* end else */
+    }     /* end for */
+
+    return best_dd;
+} /* HTIfind_ref_dd */
+
 /* ---------------------------- tagcompare ------------------------- */
 /*
    Compares two tag B-tree keys for equality.  Similar to memcmp.
@@ -2030,5 +2702,6 @@ tagdestroynode(void *n)
         bv_delete(t->b);
     if (t->d != NULL)
         DAdestroy_array(t->d, 0);
+    free(t->dds);
     free(n);
 } /* tagdestroynode */
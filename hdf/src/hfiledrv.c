@@ -0,0 +1,1379 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*-----------------------------------------------------------------------------
+ * File:    hfiledrv.c
+ * Purpose: file drivers built into the library
+ *
+ * See Hsetdriver() in hfile.c for how a driver is selected.  The "posix"
+ * and "mmap" drivers are the built-in file access of hfile.c; this file
+ * holds the others:
+ *
+ *   "core"   -- keeps the whole file in memory.  It is read in when the
+ *               file is opened and written back, if it was changed, when
+ *               the file is flushed or closed.
+ *   "memory" -- opens file images held in memory, see Hsetimage(), which
+ *               are never written to disk.
+ *   "http"   -- reads a file served over HTTP(S), or a public S3 object,
+ *               with range requests.  What is read is kept in a cache of
+ *               fixed-size blocks; the blocks missing from a read are
+ *               fetched by parallel requests, and so are the parts of a
+ *               read too long for the cache.  Read-only; only built with
+ *               libcurl.
+ *   "mpio"   -- reads a file opened by a group of MPI processes together,
+ *               see Hsetmpio(), each process reading independently with
+ *               MPI-IO.  Read-only; only built with MPI.
+ *   "direct" -- reads and writes a file with direct I/O, bypassing the
+ *               page cache, so that streaming through large files leaves
+ *               the data cached for other programs alone.  Direct I/O
+ *               needs aligned offsets, lengths and buffers: large reads
+ *               and writes go through an aligned buffer of the file, or
+ *               straight to the caller's buffer when aligned, while small
+ *               ones, such as those of the metadata, and the unaligned
+ *               ends of large writes go through the page cache.  Only
+ *               where the system has O_DIRECT or F_NOCACHE.
+ *---------------------------------------------------------------------------*/
+
+/* O_DIRECT is only declared with _GNU_SOURCE on Linux */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "hdf.h"
+#include "hfile.h"
+
+#ifdef H4_HAVE_LIBCURL
+#include <curl/curl.h>
+#endif /* H4_HAVE_LIBCURL */
+
+/* ========================== memory buffers ========================== */
+
+#define MEM_MIN_ALLOC (64 * 1024) /* smallest buffer of a file */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIbuf_write -- write to a file held in a growable buffer
+ DESCRIPTION
+       Grows the buffer by doubling it as needed; writing past the end of
+       the file fills the gap with zeros.  Used by the core and memory
+       drivers.
+
+--------------------------------------------------------------------------*/
+static intn
+HIbuf_write(uint8 **data, int32 *length, int32 *alloc, int32 offset, const void *buf, int32 bytes)
+{
+    if (offset < 0 || bytes < 0 || bytes > INT32_MAX - offset)
+        return FAIL;
+
+    if (offset + bytes > *alloc) {
+        int32  new_alloc = MAX(*alloc, MEM_MIN_ALLOC);
+        uint8 *new_data;
+
+        while (new_alloc < offset + bytes)
+            new_alloc = (new_alloc > INT32_MAX / 2 ? INT32_MAX : new_alloc * 2);
+        if ((new_data = (uint8 *)realloc(*data, (size_t)new_alloc)) == NULL)
+            return FAIL;
+        *data  = new_data;
+        *alloc = new_alloc;
+    } /* end if */
+    if (offset > *length)
+        memset(*data + *length, 0, (size_t)(offset - *length));
+
+    if (bytes > 0)
+        memcpy(*data + offset, buf, (size_t)bytes);
+    *length = MAX(*length, offset + bytes);
+    return SUCCEED;
+} /* HIbuf_write */
+
+/* ============================== core driver ============================== */
+
+/* A file of the core driver */
+typedef struct {
+    char  *path;     /* name of the file */
+    uint8 *data;     /* contents of the file */
+    int32  length;   /* length of the file */
+    int32  alloc;    /* size of data */
+    intn   writable; /* whether the file is written back */
+    intn   dirty;    /* whether the contents changed since they were written */
+} core_file_t;
+
+static void *HIcore_open(const char *path, intn acc_mode);
+static intn  HIcore_read(void *handle, int32 offset, void *buf, int32 bytes);
+static intn  HIcore_write(void *handle, int32 offset, const void *buf, int32 bytes);
+static int32 HIcore_size(void *handle);
+static intn  HIcore_flush(void *handle);
+static intn  HIcore_close(void *handle);
+
+const hdf_driver_t HP_driver_core = {"core",       HIcore_open,  HIcore_read, HIcore_write,
+                                     HIcore_size, HIcore_flush, HIcore_close};
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIcore_open -- open a file of the core driver
+ DESCRIPTION
+       Reads the whole file in, or starts an empty one for DFACC_CREATE.
+       Files too large for an int32 offset cannot be opened.
+
+--------------------------------------------------------------------------*/
+static void *
+HIcore_open(const char *path, intn acc_mode)
+{
+    core_file_t *cf = NULL;
+    hdf_file_t   f;
+    long         size;
+
+    if ((cf = (core_file_t *)calloc(1, sizeof(core_file_t))) == NULL || (cf->path = strdup(path)) == NULL)
+        goto error;
+    cf->writable = (acc_mode & (DFACC_WRITE | DFACC_CREATE)) ? TRUE : FALSE;
+
+    if (acc_mode == DFACC_CREATE) {
+        cf->dirty = TRUE; /* the file is created even if nothing is written */
+        return cf;
+    } /* end if */
+
+    f = (hdf_file_t)HI_OPEN(path, acc_mode);
+    if (OPENERR(f))
+        goto error;
+    if (HI_SEEKEND(f) == FAIL || (size = (long)HI_TELL(f)) < 0 || size > (long)INT32_MAX ||
+        HI_SEEK(f, 0) == FAIL) {
+        HI_CLOSE(f);
+        goto error;
+    } /* end if */
+    cf->length = cf->alloc = (int32)size;
+    if (size > 0 &&
+        ((cf->data = (uint8 *)malloc((size_t)size)) == NULL || HI_READ(f, cf->data, (int32)size) == FAIL)) {
+        HI_CLOSE(f);
+        goto error;
+    } /* end if */
+    HI_CLOSE(f);
+    return cf;
+
+error:
+    if (cf != NULL) {
+        free(cf->data);
+        free(cf->path);
+        free(cf);
+    } /* end if */
+    return NULL;
+} /* HIcore_open */
+
+static intn
+HIcore_read(void *handle, int32 offset, void *buf, int32 bytes)
+{
+    core_file_t *cf = (core_file_t *)handle;
+
+    if (offset < 0 || bytes < 0 || bytes > cf->length - offset)
+        return FAIL;
+    if (bytes > 0)
+        memcpy(buf, cf->data + offset, (size_t)bytes);
+    return SUCCEED;
+} /* HIcore_read */
+
+static intn
+HIcore_write(void *handle, int32 offset, const void *buf, int32 bytes)
+{
+    core_file_t *cf = (core_file_t *)handle;
+
+    if (!cf->writable || HIbuf_write(&cf->data, &cf->length, &cf->alloc, offset, buf, bytes) == FAIL)
+        return FAIL;
+    cf->dirty = TRUE;
+    return SUCCEED;
+} /* HIcore_write */
+
+static int32
+HIcore_size(void *handle)
+{
+    return ((core_file_t *)handle)->length;
+} /* HIcore_size */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIcore_flush -- write a file of the core driver back
+ DESCRIPTION
+       Rewrites the whole file if its contents changed.
+
+--------------------------------------------------------------------------*/
+static intn
+HIcore_flush(void *handle)
+{
+    core_file_t *cf = (core_file_t *)handle;
+    hdf_file_t   f;
+    intn         ret_value = SUCCEED;
+
+    if (!cf->writable || !cf->dirty)
+        return SUCCEED;
+
+    f = (hdf_file_t)HI_CREATE(cf->path);
+    if (OPENERR(f))
+        return FAIL;
+    if (cf->length > 0 && HI_WRITE(f, cf->data, cf->length) == FAIL)
+        ret_value = FAIL;
+    if (HI_CLOSE(f) == FAIL)
+        ret_value = FAIL;
+    if (ret_value == SUCCEED)
+        cf->dirty = FALSE;
+    return ret_value;
+} /* HIcore_flush */
+
+static intn
+HIcore_close(void *handle)
+{
+    core_file_t *cf        = (core_file_t *)handle;
+    intn         ret_value = HIcore_flush(handle);
+
+    free(cf->data);
+    free(cf->path);
+    free(cf);
+    return ret_value;
+} /* HIcore_close */
+
+/* ============================= memory driver ============================= */
+
+/* A file image, see Hsetimage() */
+typedef struct mem_image_t {
+    char               *name;   /* name the image is opened by */
+    uint8              *data;   /* contents of the file */
+    int32               length; /* length of the file */
+    int32               alloc;  /* size of data when owned, 0 otherwise */
+    intn                owned;  /* whether data belongs to the library */
+    intn                nopen;  /* # of opens of the image */
+    struct mem_image_t *next;   /* next image */
+} mem_image_t;
+
+/* A file of the memory driver */
+typedef struct {
+    mem_image_t *image;    /* the image opened */
+    intn         writable; /* whether it was opened for writing */
+} mem_file_t;
+
+/* The file images, protected by the files lock */
+static mem_image_t *mem_images = NULL;
+
+static void *HImem_open(const char *path, intn acc_mode);
+static intn  HImem_read(void *handle, int32 offset, void *buf, int32 bytes);
+static intn  HImem_write(void *handle, int32 offset, const void *buf, int32 bytes);
+static int32 HImem_size(void *handle);
+static intn  HImem_close(void *handle);
+
+const hdf_driver_t HP_driver_memory = {"memory",   HImem_open, HImem_read, HImem_write,
+                                       HImem_size, NULL,       HImem_close};
+
+/* Finds the image of a name, NULL when there is none */
+static mem_image_t *
+HImem_find(const char *name)
+{
+    mem_image_t *image;
+
+    for (image = mem_images; image != NULL; image = image->next)
+        if (strcmp(image->name, name) == 0)
+            break;
+    return image;
+} /* HImem_find */
+
+/* Adds an empty image of a name, NULL on failure */
+static mem_image_t *
+HImem_add(const char *name)
+{
+    mem_image_t *image;
+
+    if ((image = (mem_image_t *)calloc(1, sizeof(mem_image_t))) == NULL)
+        return NULL;
+    if ((image->name = strdup(name)) == NULL) {
+        free(image);
+        return NULL;
+    } /* end if */
+    image->next = mem_images;
+    mem_images  = image;
+    return image;
+} /* HImem_add */
+
+/* Empties an image, freeing its contents if they belong to the library */
+static void
+HImem_clear(mem_image_t *image)
+{
+    if (image->owned)
+        free(image->data);
+    image->data   = NULL;
+    image->length = 0;
+    image->alloc  = 0;
+    image->owned  = FALSE;
+} /* HImem_clear */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HPis_image -- tell whether a name is that of a file image
+ USAGE
+       intn HPis_image(name)
+       const char *name;            IN: name of the file
+ RETURNS
+       TRUE if an image of that name exists, FALSE otherwise
+ DESCRIPTION
+       Such names are opened with the memory driver, see HIpath_driver().
+
+--------------------------------------------------------------------------*/
+intn
+HPis_image(const char *name)
+{
+    intn ret_value;
+
+    HL_LOCK_FILES();
+    ret_value = (HImem_find(name) != NULL);
+    HL_UNLOCK_FILES();
+    return ret_value;
+} /* HPis_image */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HImem_open -- open a file of the memory driver
+ DESCRIPTION
+       Opens the image of the name, which must exist unless the file is
+       created.  Creating a file empties its image, or adds one.
+
+--------------------------------------------------------------------------*/
+static void *
+HImem_open(const char *path, intn acc_mode)
+{
+    mem_file_t  *mf;
+    mem_image_t *image;
+
+    if ((mf = (mem_file_t *)malloc(sizeof(mem_file_t))) == NULL)
+        return NULL;
+
+    HL_LOCK_FILES();
+    image = HImem_find(path);
+    if (acc_mode == DFACC_CREATE) {
+        if (image == NULL)
+            image = HImem_add(path);
+        else if (image->nopen == 0)
+            HImem_clear(image);
+        else
+            image = NULL;
+    } /* end if */
+    if (image != NULL)
+        image->nopen++;
+    HL_UNLOCK_FILES();
+
+    if (image == NULL) {
+        free(mf);
+        return NULL;
+    } /* end if */
+    mf->image    = image;
+    mf->writable = (acc_mode & (DFACC_WRITE | DFACC_CREATE)) ? TRUE : FALSE;
+    return mf;
+} /* HImem_open */
+
+static intn
+HImem_read(void *handle, int32 offset, void *buf, int32 bytes)
+{
+    mem_image_t *image = ((mem_file_t *)handle)->image;
+
+    if (offset < 0 || bytes < 0 || bytes > image->length - offset)
+        return FAIL;
+    if (bytes > 0)
+        memcpy(buf, image->data + offset, (size_t)bytes);
+    return SUCCEED;
+} /* HImem_read */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HImem_write -- write to a file of the memory driver
+ DESCRIPTION
+       The buffer of an image set by Hsetimage() is never written to: it is
+       copied into a buffer of the library on the first write.
+
+--------------------------------------------------------------------------*/
+static intn
+HImem_write(void *handle, int32 offset, const void *buf, int32 bytes)
+{
+    mem_file_t  *mf    = (mem_file_t *)handle;
+    mem_image_t *image = mf->image;
+
+    if (!mf->writable)
+        return FAIL;
+
+    if (!image->owned && image->length > 0) {
+        uint8 *data;
+
+        if ((data = (uint8 *)malloc((size_t)image->length)) == NULL)
+            return FAIL;
+        memcpy(data, image->data, (size_t)image->length);
+        image->data  = data;
+        image->alloc = image->length;
+    } /* end if */
+    image->owned = TRUE;
+
+    return HIbuf_write(&image->data, &image->length, &image->alloc, offset, buf, bytes);
+} /* HImem_write */
+
+static int32
+HImem_size(void *handle)
+{
+    return ((mem_file_t *)handle)->image->length;
+} /* HImem_size */
+
+static intn
+HImem_close(void *handle)
+{
+    mem_file_t *mf = (mem_file_t *)handle;
+
+    HL_LOCK_FILES();
+    mf->image->nopen--;
+    HL_UNLOCK_FILES();
+    free(mf);
+    return SUCCEED;
+} /* HImem_close */
+
+/*--------------------------------------------------------------------------
+NAME
+   Hsetimage -- make a buffer the image of a file
+USAGE
+   intn Hsetimage(name, buf, size)
+           const char *name;         IN: name to open the file by
+           const void *buf;          IN: the contents of the file
+           int32 size;               IN: # of bytes of buf
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
+DESCRIPTION
+   Hopen() and SDstart() then open the file of that name from the buffer,
+   instead of from the disk, through the "memory" driver.  The buffer is
+   not copied, and must stay valid and unchanged until the image is
+   deleted with Hdeleteimage().  It is not written to either: a file
+   opened for writing copies it on its first write.
+   Files created with the "memory" driver selected, see Hsetdriver(), get
+   an image of their own, which grows as they are written.  Hgetimage()
+   returns the image of a file.
+   The image of a file that is open cannot be replaced.
+--------------------------------------------------------------------------*/
+intn
+Hsetimage(const char *name, const void *buf, int32 size)
+{
+    mem_image_t *image;
+    intn         ret_value = SUCCEED;
+
+    HEclear();
+    HL_LOCK_FILES();
+
+    if (name == NULL || size < 0 || (buf == NULL && size > 0))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if ((image = HImem_find(name)) == NULL) {
+        if ((image = HImem_add(name)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    } /* end if */
+    else if (image->nopen > 0)
+        HGOTO_ERROR(DFE_ALROPEN, FAIL);
+    else
+        HImem_clear(image);
+
+    image->data   = (uint8 *)buf;
+    image->length = size;
+
+done:
+    HL_UNLOCK_FILES();
+    return ret_value;
+} /* Hsetimage */
+
+/*--------------------------------------------------------------------------
+NAME
+   Hgetimage -- get the image of a file
+USAGE
+   intn Hgetimage(name, buf, size)
+           const char *name;         IN: name of the file
+           const void **buf;         OUT: the contents of the file
+           int32 *size;              OUT: # of bytes of the contents
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
+DESCRIPTION
+   Returns the image of a file held in memory, see Hsetimage().  The file
+   should be closed first, so that all of it is in the image.  The
+   contents stay valid until the image is deleted or the file is written
+   to again.
+--------------------------------------------------------------------------*/
+intn
+Hgetimage(const char *name, const void **buf, int32 *size)
+{
+    mem_image_t *image;
+    intn         ret_value = SUCCEED;
+
+    HEclear();
+    HL_LOCK_FILES();
+
+    if (name == NULL || buf == NULL || size == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if ((image = HImem_find(name)) == NULL)
+        HGOTO_ERROR(DFE_BADNAME, FAIL);
+
+    *buf  = image->data;
+    *size = image->length;
+
+done:
+    HL_UNLOCK_FILES();
+    return ret_value;
+} /* Hgetimage */
+
+/*--------------------------------------------------------------------------
+NAME
+   Hdeleteimage -- delete the image of a file
+USAGE
+   intn Hdeleteimage(name)
+           const char *name;         IN: name of the file
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
+DESCRIPTION
+   Forgets the image of a file held in memory, freeing its contents if
+   they belong to the library.  A buffer given to Hsetimage() can be
+   reused once its image is deleted.  The image of a file that is open
+   cannot be deleted.
+--------------------------------------------------------------------------*/
+intn
+Hdeleteimage(const char *name)
+{
+    mem_image_t **pimage;
+    mem_image_t  *image;
+    intn          ret_value = SUCCEED;
+
+    HEclear();
+    HL_LOCK_FILES();
+
+    if (name == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    for (pimage = &mem_images; *pimage != NULL; pimage = &(*pimage)->next)
+        if (strcmp((*pimage)->name, name) == 0)
+            break;
+    if ((image = *pimage) == NULL)
+        HGOTO_ERROR(DFE_BADNAME, FAIL);
+    if (image->nopen > 0)
+        HGOTO_ERROR(DFE_ALROPEN, FAIL);
+
+    *pimage = image->next;
+    HImem_clear(image);
+    free(image->name);
+    free(image);
+
+done:
+    HL_UNLOCK_FILES();
+    return ret_value;
+} /* Hdeleteimage */
+
+#ifdef H4_HAVE_LIBCURL
+
+/* ============================== http driver ============================== */
+
+#define HTTP_BLOCK_SIZE   (256 * 1024) /* bytes fetched by one request of a cached read */
+#define HTTP_CACHE_BLOCKS 64           /* blocks kept in the cache of a file */
+#define HTTP_MAX_PARALLEL 8            /* requests in flight at once */
+
+/* A block of the cache of a file */
+typedef struct {
+    int32  blkno;  /* # of the block in the file, -1 for an empty slot */
+    int32  length; /* # of bytes held; the last block of a file is short */
+    uint32 used;   /* clock of the file at the last use of the block */
+    uint8 *data;   /* the bytes, HTTP_BLOCK_SIZE of room */
+} http_block_t;
+
+/* A file of the http driver */
+typedef struct {
+    char        *url;                       /* URL of the file */
+    CURL        *curl[HTTP_MAX_PARALLEL];   /* handles of the requests, kept for their connections */
+    CURLM       *multi;                     /* runs the requests in parallel */
+    int32        size;                      /* length of the file */
+    uint32       clock;                     /* incremented at each use of a block */
+    http_block_t cache[HTTP_CACHE_BLOCKS];  /* the cache */
+} http_file_t;
+
+/* A range request */
+typedef struct {
+    int32  offset;   /* offset of the range in the file */
+    int32  length;   /* # of bytes of the range */
+    uint8 *dest;     /* where they go */
+    int32  received; /* # of bytes received so far */
+} http_range_t;
+
+static void *HIhttp_open(const char *path, intn acc_mode);
+static intn  HIhttp_read(void *handle, int32 offset, void *buf, int32 bytes);
+static int32 HIhttp_size(void *handle);
+static intn  HIhttp_close(void *handle);
+
+const hdf_driver_t HP_driver_http = {"http", HIhttp_open, HIhttp_read, NULL, HIhttp_size, NULL, HIhttp_close};
+
+/* Whether libcurl has been initialized */
+static intn http_initialized = FALSE;
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIhttp_url -- get the URL of a file of the http driver
+ DESCRIPTION
+       "s3://bucket/key" names the public object at
+       "https://bucket.s3.amazonaws.com/key"; other names are URLs already.
+       The URL is to be freed by the caller.
+
+--------------------------------------------------------------------------*/
+static char *
+HIhttp_url(const char *path)
+{
+    char       *url;
+    const char *key;
+
+    if (strncmp(path, "s3://", 5) != 0)
+        return strdup(path);
+
+    path += 5;
+    if ((key = strchr(path, '/')) == NULL)
+        return NULL;
+    if ((url = (char *)malloc(strlen(path) + sizeof("https://.s3.amazonaws.com"))) == NULL)
+        return NULL;
+    snprintf(url, strlen(path) + sizeof("https://.s3.amazonaws.com"), "https://%.*s.s3.amazonaws.com%s",
+             (int)(key - path), path, key);
+    return url;
+} /* HIhttp_url */
+
+/* Stores the bytes received for a range, failing the request on overflow,
+   which is what a server that ignores the range sends */
+static size_t
+HIhttp_write_cb(char *data, size_t size, size_t nmemb, void *user)
+{
+    http_range_t *range = (http_range_t *)user;
+    size_t        n     = size * nmemb;
+
+    if (n > (size_t)(range->length - range->received))
+        return 0;
+    memcpy(range->dest + range->received, data, n);
+    range->received += (int32)n;
+    return n;
+} /* HIhttp_write_cb */
+
+/* Discards the body of a response */
+static size_t
+HIhttp_discard_cb(char *data, size_t size, size_t nmemb, void *user)
+{
+    (void)data;
+    (void)user;
+    return size * nmemb;
+} /* HIhttp_discard_cb */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIhttp_handle -- get the handle of a request of a file
+ DESCRIPTION
+       Creates the handle on first use.  The handles of a file keep their
+       connections open from one request to the next.
+
+--------------------------------------------------------------------------*/
+static CURL *
+HIhttp_handle(http_file_t *hf, intn i)
+{
+    CURL *curl = hf->curl[i];
+
+    if (curl == NULL) {
+        if ((curl = curl_easy_init()) == NULL)
+            return NULL;
+        curl_easy_setopt(curl, CURLOPT_URL, hf->url);
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(curl, CURLOPT_USERAGENT, "HDF4");
+        hf->curl[i] = curl;
+    } /* end if */
+    return curl;
+} /* HIhttp_handle */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIhttp_fetch -- fetch ranges of a file of the http driver
+ DESCRIPTION
+       Issues a range request for each range, HTTP_MAX_PARALLEL at a time,
+       and waits for all of them.  Fails unless each range is received in
+       full.
+
+--------------------------------------------------------------------------*/
+static intn
+HIhttp_fetch(http_file_t *hf, intn n, http_range_t *ranges)
+{
+    intn i, j, k;
+    intn ret_value = SUCCEED;
+
+    for (i = 0; i < n && ret_value == SUCCEED; i = k) {
+        int      running;
+        CURLMsg *msg;
+        int      left;
+
+        /* Start the requests of this round */
+        for (j = 0, k = i; k < n && j < HTTP_MAX_PARALLEL; j++, k++) {
+            CURL *curl = HIhttp_handle(hf, j);
+            char  range[32];
+
+            if (curl == NULL) {
+                ret_value = FAIL;
+                break;
+            } /* end if */
+            snprintf(range, sizeof(range), "%ld-%ld", (long)ranges[k].offset,
+                     (long)ranges[k].offset + (long)ranges[k].length - 1);
+            ranges[k].received = 0;
+            curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+            curl_easy_setopt(curl, CURLOPT_RANGE, range);
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, HIhttp_write_cb);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &ranges[k]);
+            curl_easy_setopt(curl, CURLOPT_PRIVATE, &ranges[k]);
+            if (curl_multi_add_handle(hf->multi, curl) != CURLM_OK) {
+                ret_value = FAIL;
+                break;
+            } /* end if */
+        }     /* end for */
+
+        /* Run them to completion */
+        do {
+            if (curl_multi_perform(hf->multi, &running) != CURLM_OK) {
+                ret_value = FAIL;
+                break;
+            } /* end if */
+            if (running > 0 && curl_multi_wait(hf->multi, NULL, 0, 1000, NULL) != CURLM_OK) {
+                ret_value = FAIL;
+                break;
+            } /* end if */
+        } while (running > 0);
+
+        while ((msg = curl_multi_info_read(hf->multi, &left)) != NULL) {
+            http_range_t *range = NULL;
+
+            if (msg->msg != CURLMSG_DONE)
+                continue;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&range);
+            if (msg->data.result != CURLE_OK || range == NULL || range->received != range->length)
+                ret_value = FAIL;
+        } /* end while */
+
+        for (j = 0; j < HTTP_MAX_PARALLEL; j++)
+            if (hf->curl[j] != NULL)
+                curl_multi_remove_handle(hf->multi, hf->curl[j]);
+    } /* end for */
+
+    return ret_value;
+} /* HIhttp_fetch */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIhttp_open -- open a file of the http driver
+ DESCRIPTION
+       Gets the length of the file with a HEAD request.  Files cannot be
+       opened for writing, nor can files too large for an int32 offset.
+
+--------------------------------------------------------------------------*/
+static void *
+HIhttp_open(const char *path, intn acc_mode)
+{
+    http_file_t *hf = NULL;
+    CURL        *curl;
+    curl_off_t   length;
+    intn         i;
+
+    if (acc_mode & (DFACC_WRITE | DFACC_CREATE))
+        return NULL;
+
+    if (!http_initialized) {
+        if (curl_global_init(CURL_GLOBAL_DEFAULT) != CURLE_OK)
+            return NULL;
+        http_initialized = TRUE;
+    } /* end if */
+
+    if ((hf = (http_file_t *)calloc(1, sizeof(http_file_t))) == NULL)
+        return NULL;
+    for (i = 0; i < HTTP_CACHE_BLOCKS; i++)
+        hf->cache[i].blkno = -1;
+    if ((hf->url = HIhttp_url(path)) == NULL || (hf->multi = curl_multi_init()) == NULL ||
+        (curl = HIhttp_handle(hf, 0)) == NULL)
+        goto error;
+
+    curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, HIhttp_discard_cb);
+    if (curl_easy_perform(curl) != CURLE_OK ||
+        curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length) != CURLE_OK || length < 0 ||
+        length > (curl_off_t)INT32_MAX)
+        goto error;
+    hf->size = (int32)length;
+    return hf;
+
+error:
+    HIhttp_close(hf);
+    return NULL;
+} /* HIhttp_open */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIhttp_read -- read from a file of the http driver
+ DESCRIPTION
+       A read spanning more than half the cache is split into up to
+       HTTP_MAX_PARALLEL ranges fetched in parallel straight into the
+       buffer.  Other reads are copied out of the cache, the missing blocks
+       being fetched in parallel into the least recently used slots.
+
+--------------------------------------------------------------------------*/
+static intn
+HIhttp_read(void *handle, int32 offset, void *buf, int32 bytes)
+{
+    http_file_t  *hf = (http_file_t *)handle;
+    http_range_t  ranges[HTTP_CACHE_BLOCKS];
+    http_block_t *blocks[HTTP_CACHE_BLOCKS]; /* blocks of the read, in order */
+    int32         first, last;               /* first and last block of the read */
+    int32         b, pos;
+    intn          i, n = 0;
+
+    if (offset < 0 || bytes < 0 || bytes > hf->size - offset)
+        return FAIL;
+    if (bytes == 0)
+        return SUCCEED;
+
+    first = offset / HTTP_BLOCK_SIZE;
+    last  = (offset + bytes - 1) / HTTP_BLOCK_SIZE;
+
+    /* Long reads bypass the cache */
+    if (last - first + 1 > HTTP_CACHE_BLOCKS / 2) {
+        int32 part = (bytes + HTTP_MAX_PARALLEL - 1) / HTTP_MAX_PARALLEL;
+
+        for (pos = 0; pos < bytes; pos += part, n++) {
+            ranges[n].offset = offset + pos;
+            ranges[n].length = MIN(part, bytes - pos);
+            ranges[n].dest   = (uint8 *)buf + pos;
+        } /* end for */
+        return HIhttp_fetch(hf, n, ranges);
+    } /* end if */
+
+    /* Find the blocks of the read that are cached */
+    for (b = first; b <= last; b++) {
+        blocks[b - first] = NULL;
+        for (i = 0; i < HTTP_CACHE_BLOCKS; i++)
+            if (hf->cache[i].blkno == b) {
+                blocks[b - first]  = &hf->cache[i];
+                hf->cache[i].used = ++hf->clock;
+                break;
+            } /* end if */
+    }         /* end for */
+
+    /* Give each missing block the least recently used slot; the blocks of
+       this read are the most recently used, so none of them is evicted */
+    for (b = first; b <= last; b++) {
+        http_block_t *slot = NULL;
+
+        if (blocks[b - first] != NULL)
+            continue;
+        for (i = 0; i < HTTP_CACHE_BLOCKS; i++)
+            if (slot == NULL || hf->cache[i].used < slot->used)
+                slot = &hf->cache[i];
+        if (slot->data == NULL && (slot->data = (uint8 *)malloc(HTTP_BLOCK_SIZE)) == NULL)
+            return FAIL;
+        slot->blkno       = b;
+        slot->length      = MIN(HTTP_BLOCK_SIZE, hf->size - b * HTTP_BLOCK_SIZE);
+        slot->used        = ++hf->clock;
+        blocks[b - first] = slot;
+
+        ranges[n].offset = b * HTTP_BLOCK_SIZE;
+        ranges[n].length = slot->length;
+        ranges[n].dest   = slot->data;
+        n++;
+    } /* end for */
+
+    if (n > 0 && HIhttp_fetch(hf, n, ranges) == FAIL) {
+        /* the blocks just assigned may hold anything */
+        for (b = first; b <= last; b++)
+            for (i = 0; i < n; i++)
+                if (blocks[b - first]->data == ranges[i].dest)
+                    blocks[b - first]->blkno = -1;
+        return FAIL;
+    } /* end if */
+
+    /* Copy the read out of the blocks */
+    for (b = first, pos = 0; b <= last; b++) {
+        int32 start = (b == first ? offset - b * HTTP_BLOCK_SIZE : 0);
+        int32 len   = MIN(blocks[b - first]->length - start, bytes - pos);
+
+        memcpy((uint8 *)buf + pos, blocks[b - first]->data + start, (size_t)len);
+        pos += len;
+    } /* end for */
+
+    return SUCCEED;
+} /* HIhttp_read */
+
+static int32
+HIhttp_size(void *handle)
+{
+    return ((http_file_t *)handle)->size;
+} /* HIhttp_size */
+
+static intn
+HIhttp_close(void *handle)
+{
+    http_file_t *hf = (http_file_t *)handle;
+    intn         i;
+
+    if (hf == NULL)
+        return SUCCEED;
+    for (i = 0; i < HTTP_MAX_PARALLEL; i++)
+        if (hf->curl[i] != NULL)
+            curl_easy_cleanup(hf->curl[i]);
+    if (hf->multi != NULL)
+        curl_multi_cleanup(hf->multi);
+    for (i = 0; i < HTTP_CACHE_BLOCKS; i++)
+        free(hf->cache[i].data);
+    free(hf->url);
+    free(hf);
+    return SUCCEED;
+} /* HIhttp_close */
+
+#endif /* H4_HAVE_LIBCURL */
+
+/* ============================== mpio driver ============================== */
+
+#ifdef H4_HAVE_PARALLEL
+
+/* A file of the mpio driver */
+typedef struct {
+    MPI_File fh;   /* the file */
+    MPI_Comm comm; /* the processes that opened the file */
+    int      rank; /* rank of this process in 'comm' */
+    int32    size; /* length of the file */
+} mpio_file_t;
+
+static void *HImpio_open(const char *path, intn acc_mode);
+static intn  HImpio_read(void *handle, int32 offset, void *buf, int32 bytes);
+static int32 HImpio_size(void *handle);
+static intn  HImpio_close(void *handle);
+
+const hdf_driver_t HP_driver_mpio = {"mpio", HImpio_open, HImpio_read, NULL, HImpio_size, NULL, HImpio_close};
+
+/* The communicator and hints of the files opened next, see Hsetmpio() */
+static MPI_Comm mpio_comm = MPI_COMM_NULL;
+static MPI_Info mpio_info = MPI_INFO_NULL;
+
+/*--------------------------------------------------------------------------
+ NAME
+       HImpio_open -- open a file of the mpio driver
+ DESCRIPTION
+       Collective over the communicator given to Hsetmpio(), or
+       MPI_COMM_WORLD if none was.  Files cannot be opened for writing,
+       nor can files too large for an int32 offset.
+
+--------------------------------------------------------------------------*/
+static void *
+HImpio_open(const char *path, intn acc_mode)
+{
+    mpio_file_t *mf = NULL;
+    MPI_Offset   length;
+    int          initialized = 0;
+
+    if (acc_mode & (DFACC_WRITE | DFACC_CREATE))
+        return NULL;
+    if (MPI_Initialized(&initialized) != MPI_SUCCESS || !initialized)
+        return NULL;
+
+    if ((mf = (mpio_file_t *)calloc(1, sizeof(mpio_file_t))) == NULL)
+        return NULL;
+    mf->fh = MPI_FILE_NULL;
+    if (MPI_Comm_dup(mpio_comm != MPI_COMM_NULL ? mpio_comm : MPI_COMM_WORLD, &mf->comm) != MPI_SUCCESS) {
+        free(mf);
+        return NULL;
+    } /* end if */
+    MPI_Comm_rank(mf->comm, &mf->rank);
+
+    if (MPI_File_open(mf->comm, path, MPI_MODE_RDONLY, mpio_info, &mf->fh) != MPI_SUCCESS ||
+        MPI_File_get_size(mf->fh, &length) != MPI_SUCCESS || length > (MPI_Offset)INT32_MAX)
+        goto error;
+    mf->size = (int32)length;
+    return mf;
+
+error:
+    HImpio_close(mf);
+    return NULL;
+} /* HImpio_open */
+
+static intn
+HImpio_read(void *handle, int32 offset, void *buf, int32 bytes)
+{
+    mpio_file_t *mf = (mpio_file_t *)handle;
+    MPI_Status   status;
+    int          count;
+
+    if (offset < 0 || bytes < 0 || bytes > mf->size - offset)
+        return FAIL;
+    if (bytes == 0)
+        return SUCCEED;
+
+    if (MPI_File_read_at(mf->fh, (MPI_Offset)offset, buf, (int)bytes, MPI_BYTE, &status) != MPI_SUCCESS ||
+        MPI_Get_count(&status, MPI_BYTE, &count) != MPI_SUCCESS || count != (int)bytes)
+        return FAIL;
+    return SUCCEED;
+} /* HImpio_read */
+
+static int32
+HImpio_size(void *handle)
+{
+    return ((mpio_file_t *)handle)->size;
+} /* HImpio_size */
+
+/* Collective, as is the opening of the file */
+static intn
+HImpio_close(void *handle)
+{
+    mpio_file_t *mf        = (mpio_file_t *)handle;
+    intn         ret_value = SUCCEED;
+
+    if (mf == NULL)
+        return SUCCEED;
+    if (mf->fh != MPI_FILE_NULL && MPI_File_close(&mf->fh) != MPI_SUCCESS)
+        ret_value = FAIL;
+    MPI_Comm_free(&mf->comm);
+    free(mf);
+    return ret_value;
+} /* HImpio_close */
+
+/*--------------------------------------------------------------------------
+NAME
+   Hsetmpio -- read the files opened next with MPI-IO
+USAGE
+   intn Hsetmpio(comm, info)
+           MPI_Comm comm;            IN: the processes opening the files
+           MPI_Info info;            IN: MPI-IO hints, or MPI_INFO_NULL
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
+DESCRIPTION
+   Selects the "mpio" driver, see Hsetdriver(), for the files opened
+   next, which are then opened read-only by all the processes of 'comm'
+   together.  The communicator and the hints are copied.  Passing
+   MPI_COMM_NULL selects the "posix" driver again.
+   Opening and closing such a file, by Hopen()/Hclose() or
+   SDstart()/SDend(), is collective over 'comm', and so is the first
+   access to each chunked element: one process reads the chunk table and
+   broadcasts it, instead of every process reading it.  The processes are
+   to make the same calls on the file up to the reads of the data, which
+   are independent; each process can read the chunks of its own part of a
+   data set, see SDgetchunkslab().
+--------------------------------------------------------------------------*/
+intn
+Hsetmpio(MPI_Comm comm, MPI_Info info)
+{
+    MPI_Comm new_comm  = MPI_COMM_NULL;
+    MPI_Info new_info  = MPI_INFO_NULL;
+    intn     ret_value = SUCCEED;
+
+    HEclear();
+
+    if (comm != MPI_COMM_NULL) {
+        if (MPI_Comm_dup(comm, &new_comm) != MPI_SUCCESS)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+        if (info != MPI_INFO_NULL && MPI_Info_dup(info, &new_info) != MPI_SUCCESS) {
+            MPI_Comm_free(&new_comm);
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+        } /* end if */
+    }     /* end if */
+
+    HL_LOCK_FILES();
+    if (mpio_comm != MPI_COMM_NULL)
+        MPI_Comm_free(&mpio_comm);
+    if (mpio_info != MPI_INFO_NULL)
+        MPI_Info_free(&mpio_info);
+    mpio_comm = new_comm;
+    mpio_info = new_info;
+    HL_UNLOCK_FILES();
+
+    ret_value = Hsetdriver(comm != MPI_COMM_NULL ? "mpio" : NULL);
+
+done:
+    return ret_value;
+} /* Hsetmpio */
+
+#endif /* H4_HAVE_PARALLEL */
+
+/* ============================= direct driver ============================= */
+
+#ifdef HI_DIRECT_SUPPORTED
+
+#define DIRECT_ALIGN    4096          /* alignment of offsets, lengths and buffers of direct I/O */
+#define DIRECT_MIN      (64 * 1024)   /* shortest read or write done with direct I/O */
+#define DIRECT_BUF_SIZE (1024 * 1024) /* size of the aligned buffer of a file */
+
+/* Rounds an offset down or up to the alignment of direct I/O */
+#define DIRECT_FLOOR(o) ((o) & ~(int32)(DIRECT_ALIGN - 1))
+#define DIRECT_CEIL(o)  DIRECT_FLOOR((o) + (DIRECT_ALIGN - 1))
+
+/* A file of the direct driver */
+typedef struct {
+    int    fd;  /* descriptor for the accesses through the page cache */
+    int    dfd; /* descriptor for direct I/O, -1 if the file system has none */
+    uint8 *buf; /* aligned buffer of DIRECT_BUF_SIZE bytes, NULL until needed */
+} direct_file_t;
+
+static void *HIdirect_open(const char *path, intn acc_mode);
+static intn  HIdirect_read(void *handle, int32 offset, void *buf, int32 bytes);
+static intn  HIdirect_write(void *handle, int32 offset, const void *buf, int32 bytes);
+static int32 HIdirect_size(void *handle);
+static intn  HIdirect_close(void *handle);
+
+const hdf_driver_t HP_driver_direct = {"direct",      HIdirect_open, HIdirect_read, HIdirect_write,
+                                       HIdirect_size, NULL,          HIdirect_close};
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIdirect_open -- open a file of the direct driver
+ DESCRIPTION
+       Opens the file twice, for the accesses through the page cache and
+       for direct I/O.  A file system refusing direct I/O, such as tmpfs,
+       leaves only the first descriptor, through which everything then
+       goes.
+
+--------------------------------------------------------------------------*/
+static void *
+HIdirect_open(const char *path, intn acc_mode)
+{
+    direct_file_t *df = NULL;
+    int            flags;
+
+    if ((df = (direct_file_t *)calloc(1, sizeof(direct_file_t))) == NULL)
+        return NULL;
+    df->dfd = -1;
+
+    if (acc_mode & DFACC_CREATE)
+        flags = O_RDWR | O_CREAT | O_TRUNC;
+    else
+        flags = (acc_mode & DFACC_WRITE) ? O_RDWR : O_RDONLY;
+    if ((df->fd = open(path, flags, 0666)) < 0) {
+        free(df);
+        return NULL;
+    } /* end if */
+
+    flags &= ~(O_CREAT | O_TRUNC);
+#ifdef O_DIRECT
+    df->dfd = open(path, flags | O_DIRECT);
+#else
+    if ((df->dfd = open(path, flags)) >= 0 && fcntl(df->dfd, F_NOCACHE, 1) == -1) {
+        close(df->dfd);
+        df->dfd = -1;
+    } /* end if */
+#endif /* O_DIRECT */
+    return df;
+} /* HIdirect_open */
+
+/* Reads 'bytes' bytes at 'offset' or up to the end of the file, returning
+   the # of bytes read or -1 */
+static ssize_t
+HIdirect_pread(int fd, void *buf, size_t bytes, off_t offset)
+{
+    size_t  done = 0;
+    ssize_t n;
+
+    while (done < bytes) {
+        if ((n = pread(fd, (uint8 *)buf + done, bytes - done, offset + (off_t)done)) < 0)
+            return -1;
+        if (n == 0)
+            break;
+        done += (size_t)n;
+    } /* end while */
+    return (ssize_t)done;
+} /* HIdirect_pread */
+
+/* Writes 'bytes' bytes at 'offset' */
+static intn
+HIdirect_pwrite(int fd, const void *buf, size_t bytes, off_t offset)
+{
+    size_t  done = 0;
+    ssize_t n;
+
+    while (done < bytes) {
+        if ((n = pwrite(fd, (const uint8 *)buf + done, bytes - done, offset + (off_t)done)) <= 0)
+            return FAIL;
+        done += (size_t)n;
+    } /* end while */
+    return SUCCEED;
+} /* HIdirect_pwrite */
+
+/* Whether an access of 'bytes' bytes is done with direct I/O, allocating
+   the aligned buffer of the file the first time */
+static intn
+HIdirect_use(direct_file_t *df, int32 bytes)
+{
+    void *p;
+
+    if (bytes < DIRECT_MIN || df->dfd < 0)
+        return FALSE;
+    if (df->buf == NULL) {
+        if (posix_memalign(&p, DIRECT_ALIGN, DIRECT_BUF_SIZE) != 0)
+            return FALSE;
+        df->buf = (uint8 *)p;
+    } /* end if */
+    return TRUE;
+} /* HIdirect_use */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIdirect_read -- read from a file of the direct driver
+ DESCRIPTION
+       Reads the aligned blocks holding the bytes asked for into the
+       aligned buffer of the file, a buffer full at a time, and copies the
+       bytes out; the aligned part of a read into an aligned buffer is
+       read straight into it.  Short reads go through the page cache.
+
+--------------------------------------------------------------------------*/
+static intn
+HIdirect_read(void *handle, int32 offset, void *buf, int32 bytes)
+{
+    direct_file_t *df = (direct_file_t *)handle;
+    uint8         *p  = (uint8 *)buf;
+    int32          start; /* aligned offset of the blocks read */
+    int32          skip;  /* bytes of the blocks before 'offset' */
+    int32          n;     /* bytes of the blocks copied to 'buf' */
+
+    if (offset < 0 || bytes < 0)
+        return FAIL;
+    if (!HIdirect_use(df, bytes))
+        return HIdirect_pread(df->fd, buf, (size_t)bytes, (off_t)offset) == (ssize_t)bytes ? SUCCEED : FAIL;
+
+    while (bytes > 0) {
+        start = DIRECT_FLOOR(offset);
+        skip  = offset - start;
+        if (skip == 0 && ((size_t)p & (DIRECT_ALIGN - 1)) == 0 && bytes >= DIRECT_ALIGN) {
+            n = DIRECT_FLOOR(bytes);
+            if (HIdirect_pread(df->dfd, p, (size_t)n, (off_t)offset) != (ssize_t)n)
+                return FAIL;
+        }
+        else {
+            n = MIN(bytes, DIRECT_BUF_SIZE - skip);
+            if (HIdirect_pread(df->dfd, df->buf, (size_t)DIRECT_CEIL(skip + n), (off_t)start) < skip + n)
+                return FAIL;
+            memcpy(p, df->buf + skip, (size_t)n);
+        } /* end else */
+        p += n;
+        offset += n;
+        bytes -= n;
+    } /* end while */
+    return SUCCEED;
+} /* HIdirect_read */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HIdirect_write -- write to a file of the direct driver
+ DESCRIPTION
+       Writes the aligned blocks covered by the bytes with direct I/O,
+       straight from the caller's buffer if aligned and through the
+       aligned buffer of the file otherwise, and the bytes before and
+       after them through the page cache, as short writes are.
+
+--------------------------------------------------------------------------*/
+static intn
+HIdirect_write(void *handle, int32 offset, const void *buf, int32 bytes)
+{
+    direct_file_t *df = (direct_file_t *)handle;
+    const uint8   *p  = (const uint8 *)buf;
+    int32          lo, hi; /* aligned range written with direct I/O */
+    int32          n;
+
+    if (offset < 0 || bytes < 0 || bytes > INT32_MAX - offset)
+        return FAIL;
+    lo = DIRECT_CEIL(offset);
+    hi = DIRECT_FLOOR(offset + bytes);
+    if (hi <= lo || !HIdirect_use(df, hi - lo))
+        return HIdirect_pwrite(df->fd, buf, (size_t)bytes, (off_t)offset);
+
+    if (lo > offset && HIdirect_pwrite(df->fd, p, (size_t)(lo - offset), (off_t)offset) == FAIL)
+        return FAIL;
+    if (offset + bytes > hi && HIdirect_pwrite(df->fd, p + (hi - offset), (size_t)(offset + bytes - hi),
+                                               (off_t)hi) == FAIL)
+        return FAIL;
+
+    p += lo - offset;
+    if (((size_t)p & (DIRECT_ALIGN - 1)) == 0)
+        return HIdirect_pwrite(df->dfd, p, (size_t)(hi - lo), (off_t)lo);
+    for (; lo < hi; lo += n, p += n) {
+        n = MIN(hi - lo, DIRECT_BUF_SIZE);
+        memcpy(df->buf, p, (size_t)n);
+        if (HIdirect_pwrite(df->dfd, df->buf, (size_t)n, (off_t)lo) == FAIL)
+            return FAIL;
+    } /* end for */
+    return SUCCEED;
+} /* HIdirect_write */
+
+static int32
+HIdirect_size(void *handle)
+{
+    struct stat sbuf;
+
+    if (fstat(((direct_file_t *)handle)->fd, &sbuf) != 0 || sbuf.st_size > (off_t)INT32_MAX)
+        return FAIL;
+    return (int32)sbuf.st_size;
+} /* HIdirect_size */
+
+static intn
+HIdirect_close(void *handle)
+{
+    direct_file_t *df        = (direct_file_t *)handle;
+    intn           ret_value = SUCCEED;
+
+    if (df->dfd >= 0 && close(df->dfd) != 0)
+        ret_value = FAIL;
+    if (close(df->fd) != 0)
+        ret_value = FAIL;
+    free(df->buf);
+    free(df);
+    return ret_value;
+} /* HIdirect_close */
+
+#endif /* HI_DIRECT_SUPPORTED */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HPmpio_rank -- get the rank of this process for a file
+ DESCRIPTION
+       The rank in the processes that opened a file of the mpio driver
+       together; 0 for other files.
+
+--------------------------------------------------------------------------*/
+intn
+HPmpio_rank(filerec_t *file_rec)
+{
+#ifdef H4_HAVE_PARALLEL
+    if (file_rec->drv == &HP_driver_mpio)
+        return ((mpio_file_t *)file_rec->drv_handle)->rank;
+#else
+    (void)file_rec;
+#endif /* H4_HAVE_PARALLEL */
+    return 0;
+} /* HPmpio_rank */
+
+/*--------------------------------------------------------------------------
+ NAME
+       HPmpio_share -- send what rank 0 read of a file to the other ranks
+ DESCRIPTION
+       For a file of the mpio driver, broadcasts 'status' from rank 0 and,
+       if it is SUCCEED, the 'bytes' bytes of 'buf', and returns the status
+       of rank 0.  Collective; every rank must call it with the same
+       'bytes'.  Other files are read by one process, and 'status' is
+       returned.
+
+--------------------------------------------------------------------------*/
+intn
+HPmpio_share(filerec_t *file_rec, intn status, void *buf, int32 bytes)
+{
+#ifdef H4_HAVE_PARALLEL
+    if (file_rec->drv == &HP_driver_mpio) {
+        mpio_file_t *mf         = (mpio_file_t *)file_rec->drv_handle;
+        int          root_state = (int)status;
+
+        if (MPI_Bcast(&root_state, 1, MPI_INT, 0, mf->comm) != MPI_SUCCESS)
+            return FAIL;
+        if (root_state == SUCCEED && bytes > 0 &&
+            MPI_Bcast(buf, (int)bytes, MPI_BYTE, 0, mf->comm) != MPI_SUCCESS)
+            return FAIL;
+        return (intn)root_state;
+    } /* end if */
+#else
+    (void)file_rec;
+    (void)buf;
+    (void)bytes;
+#endif /* H4_HAVE_PARALLEL */
+    return status;
+} /* HPmpio_share */
@@ -20,6 +20,7 @@ LOCAL ROUTINES
 EXPORTED ROUTINES
   HDc2fstr      -- convert a C string into a Fortran string IN PLACE
   HDf2cstring   -- convert a Fortran string to a C string
+  HDf2cstring_buf -- convert a Fortran string to a C string, in a buffer if it fits
   HDpackFstring -- convert a C string into a Fortran string
   HDflush       -- flush the HDF file
   HDgettagdesc  -- return a text description of a tag
@@ -89,6 +90,45 @@ HDf2cstring(_fcd fdesc, intn len)
     memcpy(cstr, str, i + 1);
     return cstr;
 } /* HDf2cstring */
+
+/* --------------------------- HDf2cstring_buf ---------------------------- */
+/*
+NAME
+   HDf2cstring_buf -- convert a Fortran string to a C string, in a buffer
+                      if it fits
+USAGE
+   char * HDf2cstring_buf(fdesc, len, buf, buflen)
+   _fcd  fdesc;     IN: Fortran string descriptor
+   intn  len;       IN: length of Fortran string
+   char *buf;       IN: caller's buffer, usually on the stack
+   intn  buflen;    IN: size of buf
+RETURNS
+   Pointer to the C string if success, else NULL
+DESCRIPTION
+   Same as HDf2cstring, but the C string goes into 'buf' when it fits
+   there, which it does for all names of the usual length, and is only
+   allocated otherwise.  The caller frees the result only when it is not
+   'buf'.  Fortran stubs that are called once per value use this to stay
+   off the heap.
+
+---------------------------------------------------------------------------*/
+char *
+HDf2cstring_buf(_fcd fdesc, intn len, char *buf, intn buflen)
+{
+    char *cstr, *str;
+    int   i;
+
+    str = _fcdtocp(fdesc);
+    for (i = len - 1; i >= 0 && !isgraph((int)str[i]); i--)
+        /*EMPTY*/;
+    if (i + 2 <= buflen)
+        cstr = buf;
+    else if ((cstr = (char *)malloc((uint32)(i + 2))) == NULL)
+        HRETURN_ERROR(DFE_NOSPACE, NULL);
+    cstr[i + 1] = '\0';
+    memcpy(cstr, str, i + 1);
+    return cstr;
+} /* HDf2cstring_buf */
 /* ---------------------------- HDpackFstring ----------------------------- */
 /*
 NAME
@@ -151,7 +191,7 @@ HDflush(int32 file_id)
     if (BADFREC(file_rec))
         HRETURN_ERROR(DFE_ARGS, FAIL);
 
-    HI_FLUSH(file_rec->file);
+    HP_flush(file_rec);
 
     return SUCCEED;
 } /* HDflush */
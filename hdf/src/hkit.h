@@ -43,6 +43,7 @@ static const tag_descript_t tag_descriptions[] = {
     {DFTAG_LINKED, string(DFTAG_LINKED), "Linked Blocks Indicator"},
     {DFTAG_VERSION, string(DFTAG_VERSION), "Version Descriptor"},
     {DFTAG_COMPRESSED, string(DFTAG_COMPRESSED), "Compressed Data Indicator"},
+    {DFTAG_CMPSEEK, string(DFTAG_CMPSEEK), "Compressed Data Seek Points"},
     {DFTAG_CHUNK, string(DFTAG_CHUNK), "Data Chunk"},
 
     /* utility set */
@@ -91,11 +91,29 @@
 #define MAX_FILE 32
 #endif /* MAX_FILE */
 
+/* Maximum number of file descriptors kept open by the files opened with the
+   built-in file access, see Hsetmaxdescriptors() */
+#ifndef MAX_OPEN_DESCRIPTORS
+#define MAX_OPEN_DESCRIPTORS 512
+#endif /* MAX_OPEN_DESCRIPTORS */
+
+/* Number of read-only files of the single-file interfaces kept open
+   after their last close, see Hsetkeepopen() */
+#ifndef KEEP_OPEN_FILES
+#define KEEP_OPEN_FILES 4
+#endif /* KEEP_OPEN_FILES */
+
 /* Maximum length of external filename(s) (used in hextelt.c) */
 #ifndef MAX_PATH_LEN
 #define MAX_PATH_LEN 1024
 #endif /* MAX_PATH_LEN */
 
+/* # of bytes read at a time when the DD blocks of a file are read at
+   open, so that DD blocks following one another take one read */
+#ifndef DD_READ_AHEAD
+#define DD_READ_AHEAD 65536
+#endif /* DD_READ_AHEAD */
+
 /* ndds (number of dd's in a block) default,
    so user need not specify */
 #ifndef DEF_NDDS
@@ -107,6 +125,12 @@
 #define MIN_NDDS 4
 #endif /* MIN_NDDS */
 
+/* ndds maximum of the DD blocks added to a file, each of which has twice
+   the DDs of the one before, so that the chain of blocks stays short */
+#ifndef GROW_MAX_NDDS
+#define GROW_MAX_NDDS 4096
+#endif /* GROW_MAX_NDDS */
+
 /* largest number that will fit into 16-bit word ref variable */
 #define MAX_REF ((uint16)65535)
 
@@ -156,6 +180,11 @@
 #define ERR_STACK_SZ 10
 #endif
 
+/* error mode of the library at start, see HEset_mode */
+#ifndef HE_DEFAULT_MODE
+#define HE_DEFAULT_MODE HE_MODE_FULL
+#endif
+
 /* max size of a stored error description */
 #ifndef ERR_STRING_SIZE
 #define ERR_STRING_SIZE 512
@@ -225,6 +254,8 @@ changing the class name variable declaration much easier - BMR 4/1/02*/
    from local_nc.h  */
 #define _HDF_ATTRIBUTE "Attr0.0"
 /* class of a Vdata containing SD interface attribute */
+#define _HDF_ATTR_STORE "AttrStore0.0"
+/* class of a Vdata packing the small attributes of a Vgroup */
 #define _HDF_VARIABLE "Var0.0"
 /* class of a Vgroup representing an SD NDG */
 #define _HDF_SDSVAR "SDSVar"
@@ -256,6 +287,18 @@ changing the class name variable declaration much easier - BMR 4/1/02*/
 #define _HDF_CHK_TBL_CLASS     "_HDF_CHK_TBL_" /* 13 bytes */
 #define _HDF_CHK_TBL_CLASS_VER 0               /* zero version number for class */
 
+/* The vdata class name of the statistics of the chunks of a chunked
+   element, stored with its chunk table, see HMCsetStats() */
+#define _HDF_CHK_STATS_CLASS "_HDF_CHK_STATS"
+
+/* The vdata class name of the checksums of the chunks of a chunked
+   element, stored with its chunk table, see HMCsetChecksums() */
+#define _HDF_CHK_SUMS_CLASS "_HDF_CHK_SUMS"
+
+/* The vdata class name of the index of a field of a vdata, see
+   VScreateindex() */
+#define _HDF_VS_INDEX_CLASS "_HDF_VS_INDEX"
+
 /*
 #define NUM_INTERNAL_VGS    6
 char *INTERNAL_HDF_VGS[] = {_HDF_VARIABLE, _HDF_DIMENSION, _HDF_UDIMENSION,
@@ -270,6 +313,8 @@ char *INTERNAL_HDF_VDS[] = {DIM_VALS, DIM_VALS01, _HDF_ATTRIBUTE, _HDF_SDSVAR,
 /* For MFGR interface */
 #define FILL_ATTR "FillValue"
 /* name of an attribute containing the fill value */
+#define OVERVIEW_ATTR "Overviews"
+/* name of an attribute listing the refs of an image's overviews */
 
 /* For SD interface  */
 #define _FillValue "_FillValue"
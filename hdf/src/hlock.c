@@ -0,0 +1,227 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*-----------------------------------------------------------------------------
+ * File:    hlock.c
+ * Purpose: locks of the thread-safe library
+ *
+ * See hlock.h for the locks and the order they are taken in.  Nothing in
+ * this file is compiled unless the library is built thread-safe.
+ *---------------------------------------------------------------------------*/
+
+#include "hdf.h"
+#include "hfile.h"
+#include "hlock.h"
+
+#ifdef H4_HAVE_THREADSAFE
+
+static pthread_once_t HLonce = PTHREAD_ONCE_INIT;
+static hlock_t        HLlibrary_lock; /* atom groups and free lists */
+static hlock_t        HLfiles_lock;   /* opening and closing of files */
+
+/* Set up the global locks, called once */
+static void
+HLIinit_globals(void)
+{
+    if (HLinit(&HLlibrary_lock) == FAIL || HLinit(&HLfiles_lock) == FAIL) {
+        puts("HLinit cannot initialize the library locks.  Unable to continue!!");
+        exit(8);
+    }
+} /* HLIinit_globals */
+
+/******************************************************************************
+ NAME
+     HLinit - Initialize a recursive lock
+
+ RETURNS
+    Returns SUCCEED if successful and FAIL otherwise
+
+*******************************************************************************/
+intn
+HLinit(hlock_t *lock)
+{
+    pthread_mutexattr_t attr;
+    intn                ret_value = SUCCEED;
+
+    if (pthread_mutexattr_init(&attr) != 0)
+        return FAIL;
+    if (pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE) != 0 || pthread_mutex_init(lock, &attr) != 0)
+        ret_value = FAIL;
+    pthread_mutexattr_destroy(&attr);
+
+    return ret_value;
+} /* HLinit */
+
+/******************************************************************************
+ NAME
+     HLdestroy - Destroy a lock initialized with HLinit()
+
+ RETURNS
+    No return value
+
+*******************************************************************************/
+void
+HLdestroy(hlock_t *lock)
+{
+    pthread_mutex_destroy(lock);
+} /* HLdestroy */
+
+/******************************************************************************
+ NAME
+     HLlock/HLunlock - Take and release a lock
+
+ RETURNS
+    No return value
+
+*******************************************************************************/
+void
+HLlock(hlock_t *lock)
+{
+    pthread_mutex_lock(lock);
+} /* HLlock */
+
+void
+HLunlock(hlock_t *lock)
+{
+    pthread_mutex_unlock(lock);
+} /* HLunlock */
+
+/******************************************************************************
+ NAME
+     HLlock_library/HLunlock_library - Take and release the library lock
+
+ RETURNS
+    No return value
+
+*******************************************************************************/
+void
+HLlock_library(void)
+{
+    pthread_once(&HLonce, HLIinit_globals);
+    pthread_mutex_lock(&HLlibrary_lock);
+} /* HLlock_library */
+
+void
+HLunlock_library(void)
+{
+    pthread_mutex_unlock(&HLlibrary_lock);
+} /* HLunlock_library */
+
+/******************************************************************************
+ NAME
+     HLlock_files/HLunlock_files - Take and release the files lock
+
+ RETURNS
+    No return value
+
+*******************************************************************************/
+void
+HLlock_files(void)
+{
+    pthread_once(&HLonce, HLIinit_globals);
+    pthread_mutex_lock(&HLfiles_lock);
+} /* HLlock_files */
+
+void
+HLunlock_files(void)
+{
+    pthread_mutex_unlock(&HLfiles_lock);
+} /* HLunlock_files */
+
+/******************************************************************************
+ NAME
+     HLlock_file - Take the lock of a file record
+
+ RETURNS
+    Returns the file record
+
+*******************************************************************************/
+filerec_t *
+HLlock_file(filerec_t *file_rec)
+{
+    pthread_mutex_lock(&file_rec->lock);
+    return file_rec;
+} /* HLlock_file */
+
+/******************************************************************************
+ NAME
+     HLtrylock_file - Take the lock of a file record if it is free
+
+ RETURNS
+    Returns TRUE if the lock was taken, FALSE otherwise
+
+*******************************************************************************/
+intn
+HLtrylock_file(filerec_t *file_rec)
+{
+    return pthread_mutex_trylock(&file_rec->lock) == 0 ? TRUE : FALSE;
+} /* HLtrylock_file */
+
+/******************************************************************************
+ NAME
+     HLlock_fid - Take the lock of the file record of a file id
+
+ RETURNS
+    Returns the locked file record, or NULL if nothing was locked
+
+*******************************************************************************/
+filerec_t *
+HLlock_fid(int32 file_id)
+{
+    filerec_t *file_rec;
+
+    if (HAatom_group(file_id) != FIDGROUP)
+        return NULL;
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec))
+        return NULL;
+
+    return HLlock_file(file_rec);
+} /* HLlock_fid */
+
+/******************************************************************************
+ NAME
+     HLlock_aid - Take the lock of the file record of an access id
+
+ RETURNS
+    Returns the locked file record, or NULL if nothing was locked
+
+*******************************************************************************/
+filerec_t *
+HLlock_aid(int32 access_id)
+{
+    accrec_t *access_rec;
+
+    if (HAatom_group(access_id) != AIDGROUP)
+        return NULL;
+    if ((access_rec = HAatom_object(access_id)) == NULL)
+        return NULL;
+
+    return HLlock_fid(access_rec->file_id);
+} /* HLlock_aid */
+
+/******************************************************************************
+ NAME
+     HLunlock_file - Release the lock of a file record
+
+ RETURNS
+    No return value
+
+*******************************************************************************/
+void
+HLunlock_file(filerec_t *file_rec)
+{
+    if (file_rec != NULL)
+        pthread_mutex_unlock(&file_rec->lock);
+} /* HLunlock_file */
+
+#endif /* H4_HAVE_THREADSAFE */
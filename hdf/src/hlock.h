@@ -0,0 +1,201 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*-----------------------------------------------------------------------------
+ * File:    hlock.h
+ * Purpose: header file for the locks of the thread-safe library
+ *
+ * In a thread-safe build (H4_HAVE_THREADSAFE) the library uses three kinds
+ * of recursive locks, always taken in this order:
+ *
+ *  - the files lock, held by Hopen() and Hclose() while they look up, set
+ *    up or tear down a file record;
+ *  - one lock per file record, held by the H-level routines that work on
+ *    the DD list, the access records or the chunks of that file;
+ *  - the library lock, held briefly around the atom groups, the node
+ *    free lists and the I/O on the shared external files.  No other lock
+ *    is ever taken while holding it.
+ *
+ * In other builds the macros below do nothing.
+ *---------------------------------------------------------------------------*/
+
+#ifndef H4_HLOCK_H
+#define H4_HLOCK_H
+
+#include "hdf.h"
+
+#ifdef H4_HAVE_THREADSAFE
+#include <pthread.h>
+
+/* A recursive mutex */
+typedef pthread_mutex_t hlock_t;
+
+#define HL_INIT(l)          HLinit(l)
+#define HL_DESTROY(l)       HLdestroy(l)
+#define HL_LOCK(l)          HLlock(l)
+#define HL_UNLOCK(l)        HLunlock(l)
+#define HL_LOCK_LIBRARY()   HLlock_library()
+#define HL_UNLOCK_LIBRARY() HLunlock_library()
+#define HL_LOCK_FILES()     HLlock_files()
+#define HL_UNLOCK_FILES()   HLunlock_files()
+#define HL_LOCK_FILE(f)     HLlock_file(f)
+#define HL_TRYLOCK_FILE(f)  HLtrylock_file(f)
+#define HL_LOCK_FID(fid)    HLlock_fid(fid)
+#define HL_LOCK_AID(aid)    HLlock_aid(aid)
+#define HL_UNLOCK_FILE(f)   HLunlock_file(f)
+#else
+#define HL_INIT(l)          SUCCEED
+#define HL_DESTROY(l)       ((void)0)
+#define HL_LOCK(l)          ((void)0)
+#define HL_UNLOCK(l)        ((void)0)
+#define HL_LOCK_LIBRARY()   ((void)0)
+#define HL_UNLOCK_LIBRARY() ((void)0)
+#define HL_LOCK_FILES()     ((void)0)
+#define HL_UNLOCK_FILES()   ((void)0)
+#define HL_LOCK_FILE(f)     (f)
+#define HL_TRYLOCK_FILE(f)  TRUE
+#define HL_LOCK_FID(fid)    NULL
+#define HL_LOCK_AID(aid)    NULL
+#define HL_UNLOCK_FILE(f)   ((void)(f))
+#endif /* H4_HAVE_THREADSAFE */
+
+#ifdef H4_HAVE_THREADSAFE
+
+struct filerec_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ NAME
+     HLinit - Initialize a recursive lock
+
+ RETURNS
+    Returns SUCCEED if successful and FAIL otherwise
+
+*******************************************************************************/
+intn HLinit(hlock_t *lock /* IN: lock to initialize */);
+
+/******************************************************************************
+ NAME
+     HLdestroy - Destroy a lock initialized with HLinit()
+
+ RETURNS
+    No return value
+
+*******************************************************************************/
+void HLdestroy(hlock_t *lock /* IN: lock to destroy */);
+
+/******************************************************************************
+ NAME
+     HLlock/HLunlock - Take and release a lock
+
+ RETURNS
+    No return value
+
+*******************************************************************************/
+void HLlock(hlock_t *lock /* IN: lock to take */);
+void HLunlock(hlock_t *lock /* IN: lock to release */);
+
+/******************************************************************************
+ NAME
+     HLlock_library/HLunlock_library - Take and release the library lock
+
+ RETURNS
+    No return value
+
+*******************************************************************************/
+void HLlock_library(void);
+void HLunlock_library(void);
+
+/******************************************************************************
+ NAME
+     HLlock_files/HLunlock_files - Take and release the files lock
+
+ RETURNS
+    No return value
+
+*******************************************************************************/
+void HLlock_files(void);
+void HLunlock_files(void);
+
+/******************************************************************************
+ NAME
+     HLlock_file - Take the lock of a file record
+
+ RETURNS
+    Returns the file record
+
+*******************************************************************************/
+struct filerec_t *HLlock_file(struct filerec_t *file_rec /* IN: file record to lock */);
+
+/******************************************************************************
+ NAME
+     HLtrylock_file - Take the lock of a file record if it is free
+
+ DESCRIPTION
+    Never waits, so it may be called whatever the locks held.
+
+ RETURNS
+    Returns TRUE if the lock was taken, FALSE otherwise
+
+*******************************************************************************/
+intn HLtrylock_file(struct filerec_t *file_rec /* IN: file record to lock */);
+
+/******************************************************************************
+ NAME
+     HLlock_fid - Take the lock of the file record of a file id
+
+ DESCRIPTION
+    Nothing is locked when 'file_id' is not the id of an open file.
+
+ RETURNS
+    Returns the locked file record, or NULL if nothing was locked
+
+*******************************************************************************/
+struct filerec_t *HLlock_fid(int32 file_id /* IN: file id */);
+
+/******************************************************************************
+ NAME
+     HLlock_aid - Take the lock of the file record of an access id
+
+ DESCRIPTION
+    Nothing is locked when 'access_id' is not a valid access id.
+
+ RETURNS
+    Returns the locked file record, or NULL if nothing was locked
+
+*******************************************************************************/
+struct filerec_t *HLlock_aid(int32 access_id /* IN: access id */);
+
+/******************************************************************************
+ NAME
+     HLunlock_file - Release the lock of a file record
+
+ DESCRIPTION
+    Releases a lock taken with HLlock_file(), HLlock_fid() or HLlock_aid();
+    a NULL file record is ignored.
+
+ RETURNS
+    No return value
+
+*******************************************************************************/
+void HLunlock_file(struct filerec_t *file_rec /* IN: file record to unlock */);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H4_HAVE_THREADSAFE */
+
+#endif /* H4_HLOCK_H */
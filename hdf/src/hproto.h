@@ -61,6 +61,8 @@ HDFLIBAPI int32 Hstartread(int32 file_id, uint16 tag, uint16 ref);
 
 HDFLIBAPI intn Hnextread(int32 access_id, uint16 tag, uint16 ref, intn origin);
 
+HDFLIBAPI intn Hrestartread(int32 access_id, uint16 tag, uint16 ref);
+
 HDFLIBAPI intn Hexist(int32 file_id, uint16 search_tag, uint16 search_ref);
 
 HDFLIBAPI intn Hinquire(int32 access_id, int32 *pfile_id, uint16 *ptag, uint16 *pref, int32 *plength,
@@ -78,6 +80,12 @@ HDFLIBAPI intn HPisappendable(int32 aid);
 
 HDFLIBAPI intn HPregister_term_func(hdf_termfunc_t term_func);
 
+HDFLIBAPI int32 HPgetconfig(hdf_config_t setting);
+
+HDFLIBAPI intn HPkeep_open(int32 file_id);
+
+HDFLIBAPI uint32 HPfile_stamp(const char *path);
+
 HDFLIBAPI intn Hseek(int32 access_id, int32 offset, intn origin);
 
 HDFLIBAPI int32 Htell(int32 access_id);
@@ -96,6 +104,8 @@ HDFLIBAPI intn HDputc(uint8 c, int32 access_id);
 
 HDFLIBAPI int32 Hgetelement(int32 file_id, uint16 tag, uint16 ref, uint8 *data);
 
+HDFLIBAPI int32 Hreadv(int32 file_id, int32 nreqs, hdf_readv_t *reqs);
+
 HDFLIBAPI int32 Hputelement(int32 file_id, uint16 tag, uint16 ref, const uint8 *data, int32 length);
 
 HDFLIBAPI int32 Hlength(int32 file_id, uint16 tag, uint16 ref);
@@ -106,12 +116,68 @@ HDFLIBAPI intn Hsync(int32 file_id);
 
 HDFLIBAPI intn Hcache(int32 file_id, intn cache_on);
 
+HDFLIBAPI intn Hmmap(int32 file_id, intn mmap_on);
+
+HDFLIBAPI intn Hsetaccesspattern(int32 file_id, intn pattern);
+
+HDFLIBAPI intn Hsetdriver(const char *name);
+
+HDFLIBAPI intn Hregisterdriver(const hdf_driver_t *driver);
+
+HDFLIBAPI intn Hsetstreaming(int32 window);
+
+HDFLIBAPI intn Hsetmaxdescriptors(intn max_fds);
+
+HDFLIBAPI intn Hsetkeepopen(intn nfiles);
+
+HDFLIBAPI intn Hsetimage(const char *name, const void *buf, int32 size);
+
+HDFLIBAPI intn Hgetimage(const char *name, const void **buf, int32 *size);
+
+HDFLIBAPI intn Hdeleteimage(const char *name);
+
+#ifdef H4_HAVE_PARALLEL
+HDFLIBAPI intn Hsetmpio(MPI_Comm comm, MPI_Info info);
+#endif /* H4_HAVE_PARALLEL */
+
+HDFLIBAPI intn Hwriteindex(int32 file_id, int32 max_len);
+
+HDFLIBAPI intn Hreadindex(int32 file_id, intn index_on);
+
+HDFLIBAPI intn Hsetindexcache(const char *dir, intn write_missing);
+
+HDFLIBAPI intn Hsetcompact(int32 file_id, intn compact_on);
+
+HDFLIBAPI intn Hsetcompactdd(int32 file_id, intn compact_on);
+
+HDFLIBAPI intn Hsetalignment(int32 file_id, int32 threshold, int32 alignment);
+
+HDFLIBAPI intn Hreservespace(int32 file_id, int32 size);
+
 HDFLIBAPI intn Hgetlibversion(uint32 *majorv, uint32 *minorv, uint32 *releasev, char *string);
 
 HDFLIBAPI intn Hgetfileversion(int32 file_id, uint32 *majorv, uint32 *minorv, uint32 *release, char *string);
 
+HDFLIBAPI intn Hgetstats(int32 file_id, hdf_stats_t *stats);
+
+HDFLIBAPI intn Hset_trace_callback(hdf_trace_func_t func, void *user_data);
+
+HDFLIBAPI int32 Hsetconfig(hdf_config_t setting, int32 value);
+
+HDFLIBAPI int32 Hgetconfig(hdf_config_t setting);
+
+HDFLIBAPI intn Hsettaskthreads(intn nthreads);
+
+HDFLIBAPI intn Hsettaskaffinity(const intn *cpus, intn ncpus);
+
+HDFLIBAPI intn Hsettaskexecutor(hdf_executor_func_t func, void *user_data);
+
 HDFLIBAPI intn Hsetaccesstype(int32 access_id, uintn accesstype);
 
+HDFLIBAPI intn Hsetsievebuf(int32 access_id, int32 size);
+
+HDFLIBAPI intn Hprefetch(int32 access_id, int32 nruns, const int32 *offsets, const int32 *lengths);
+
 HDFLIBAPI uint16 HDmake_special_tag(uint16 tag);
 
 HDFLIBAPI intn HDis_special_tag(uint16 tag);
@@ -136,6 +202,8 @@ HDFLIBAPI intn Hgetntinfo(int32 numbertype, hdf_ntinfo_t *nt_info);
 
 HDFLIBAPI intn Hishdf(const char *filename);
 
+HDFLIBAPI intn Hprobe(const char *filename, intn check_dds, hdf_probe_t *probe);
+
 HDFLIBAPI intn Hfidinquire(int32 file_id, char **fname, intn *acc_mode, intn *attach);
 
 HDFLIBAPI intn Hshutdown(void);
@@ -314,6 +382,21 @@ HDFLIBAPI intn Hdeldd(int32  file_id, /* IN: File ID the tag/refs are in */
                       uint16 ref      /* IN: Ref of tag/ref to delete */
 );
 
+/******************************************************************************
+ NAME
+     Hcompactdd - Drop the empty DDs of the DD list
+
+ DESCRIPTION
+    Rewrites the DD list of a file opened for writing in as few DD blocks
+    as the DDs in use take.  No element of the file may be accessed.
+
+ RETURNS
+    returns SUCCEED (0) if successful, FAIL (-1) otherwise
+
+*******************************************************************************/
+HDFLIBAPI intn Hcompactdd(int32 file_id /* IN: File ID to compact the DD list of */
+);
+
 /*
  ** from hdfalloc.c
  */
@@ -322,12 +405,45 @@ HDFLIBAPI void *HDmemfill(void *dest, const void *src, uint32 item_size, uint32
 
 HDFLIBAPI char *HIstrncpy(char *dest, const char *source, intn len);
 
+HDFLIBAPI intn HDarena_attr(hdf_attr_t *attr, void *arena, int32 arena_size, int32 *used, const char *name,
+                            int32 ntype, int32 count, int32 val_size);
+
+HDFLIBAPI intn Hset_allocator(const hdf_allocator_t *allocator);
+
+HDFLIBAPI void *HDmeta_alloc(size_t size);
+
+HDFLIBAPI void HDmeta_free(void *ptr);
+
+HDFLIBAPI void *HDmarena_alloc(void **arena, size_t size);
+
+HDFLIBAPI void HDmarena_free(void **arena);
+
+HDFLIBAPI void HDmem_acquire(hdf_mem_category_t category, size_t size);
+
+HDFLIBAPI void HDmem_release(hdf_mem_category_t category, size_t size);
+
+HDFLIBAPI intn HDscratch_resize(uint8 **buf, uint32 *bufsize, size_t size);
+
+HDFLIBAPI intn Hsethugepages(intn mode);
+
+HDFLIBAPI void *HDlarge_alloc(size_t size);
+
+HDFLIBAPI void HDlarge_free(void *ptr, size_t size);
+
+HDFLIBAPI intn HPregister_mem_funcs(hdf_mem_category_t category, size_t (*usage)(void), intn (*trim)(void));
+
+HDFLIBAPI intn Hget_memory_usage(hdf_memory_report_t *report);
+
+HDFLIBAPI intn Htrim_memory(void);
+
 HDFLIBAPI int32 HDspaceleft(void);
 
 HDFLIBAPI intn HDc2fstr(char *str, intn len);
 
 HDFLIBAPI char *HDf2cstring(_fcd fdesc, intn len);
 
+HDFLIBAPI char *HDf2cstring_buf(_fcd fdesc, intn len, char *buf, intn buflen);
+
 HDFLIBAPI intn HDflush(int32 file_id);
 
 HDFLIBAPI intn HDpackFstring(char *src, char *dest, intn len);
@@ -349,6 +465,8 @@ HDFLIBAPI intn HLgetblockinfo(int32 aid, int32 *block_size, int32 *num_blocks);
 HDFLIBAPI intn HLgetdatainfo(int32 file_id, uint8 *buf, uintn start_block, uintn info_count,
                              int32 *offsetarray, int32 *lengtharray);
 
+HDFLIBAPI intn HLcompact(int32 file_id, uint16 tag, uint16 ref);
+
 /*
  ** from hextelt.c
  */
@@ -359,6 +477,8 @@ HDFLIBAPI intn HXsetcreatedir(const char *dir);
 
 HDFLIBAPI intn HXsetdir(const char *dir);
 
+HDFLIBAPI intn HXsetfilecache(intn nfiles);
+
 /*
  ** from hcomp.c
  */
@@ -373,11 +493,21 @@ HDFLIBAPI intn HCPgetcompinfo(int32 file_id, uint16 data_tag, uint16 data_ref, c
 
 HDFLIBAPI intn HCPgetcomptype(int32 file_id, uint16 data_tag, uint16 data_ref, comp_coder_t *coder_type);
 
+HDFLIBAPI intn HCPgetcompmodel(int32 file_id, uint16 data_tag, uint16 data_ref, comp_model_t *model_type);
+
 HDFLIBAPI intn HCPgetdatasize(int32 file_id, uint16 data_tag, uint16 data_ref, int32 *comp_size,
                               int32 *orig_size);
 
+HDFLIBAPI intn HCPwrite_compressed(int32 file_id, uint16 tag, uint16 ref, comp_model_t model_type,
+                                   model_info *m_info, comp_coder_t coder_type, comp_info *c_info,
+                                   int32 length, const void *comp_data, int32 comp_len);
+
 HDFPUBLIC intn HCget_config_info(comp_coder_t coder_type, uint32 *compression_config_info);
 
+HDFLIBAPI intn HCset_decode_provider(comp_coder_t coder_type, hdf_decode_func_t func, void *user_data);
+
+HDFLIBAPI hdf_decode_func_t HCPget_decode_provider(comp_coder_t coder_type, void **user_data);
+
 HDFLIBAPI int32 HCPquery_encode_header(comp_model_t model_type, model_info *m_info, comp_coder_t coder_type,
                                        comp_info *c_info);
 
@@ -387,6 +517,29 @@ HDFLIBAPI intn HCPencode_header(uint8 *p, comp_model_t model_type, model_info *m
 HDFLIBAPI intn HCPdecode_header(uint8 *p, comp_model_t *model_type, model_info *m_info,
                                 comp_coder_t *coder_type, comp_info *c_info);
 
+/*
+ ** from cdeflate.c
+ */
+HDFLIBAPI intn HCset_deflate_seek_interval(int32 interval);
+
+HDFLIBAPI intn HCset_deflate_threads(intn nthreads);
+
+/*
+ ** from clossy.c
+ */
+HDFLIBAPI intn HCPclossy_check_parms(const comp_info *c_info);
+
+/*
+ ** from cplugin.c
+ */
+HDFLIBAPI intn HCregister_coder(const hdf_coder_plugin_t *plugin);
+
+HDFLIBAPI intn HCunregister_coder(comp_coder_t coder_type);
+
+HDFLIBAPI intn HCload_coder_plugins(const char *path);
+
+HDFLIBAPI const hdf_coder_plugin_t *HCPplugin_coder(comp_coder_t coder_type);
+
 /*
  ** from cszip.c
  */
@@ -398,6 +551,8 @@ HDFLIBAPI intn HCPsetup_szip_parms(comp_info *c_info, int32 nt, int32 ncomp, int
  */
 HDFLIBAPI intn HBconvert(int32 aid);
 
+HDFLIBAPI intn HBsetpolicy(int32 file_id, int32 max_len, intn min_uses);
+
 /*
  ** from hcompri.c
  */
@@ -419,6 +574,10 @@ HDFLIBAPI int16 HEvalue(int32 level);
 
 HDFLIBAPI void HEclear(void);
 
+HDFLIBAPI intn HEset_mode(intn mode);
+
+HDFLIBAPI intn HEget_mode(void);
+
 HDFLIBAPI intn HEshutdown(void);
 
 /*
@@ -432,8 +591,12 @@ HDFLIBAPI intn Hbitappendable(int32 bitid);
 
 HDFLIBAPI intn Hbitwrite(int32 bitid, intn count, uint32 data);
 
+HDFLIBAPI int32 Hbitwritev(int32 bitid, intn count, int32 nvalues, const uint32 *data);
+
 HDFLIBAPI intn Hbitread(int32 bitid, intn count, uint32 *data);
 
+HDFLIBAPI int32 Hbitreadv(int32 bitid, intn count, int32 nvalues, uint32 *data);
+
 HDFLIBAPI intn Hbitseek(int32 bitid, int32 byte_offset, intn bit_offset);
 
 HDFLIBAPI intn Hgetbit(int32 bitid);
@@ -781,6 +944,8 @@ HDFLIBAPI int32 DFKisnativeNT(int32 numbertype);
 
 HDFLIBAPI int32 DFKislitendNT(int32 numbertype);
 
+HDFLIBAPI int32 DFKiscopyNT(int32 numbertype);
+
 HDFLIBAPI int8 DFKgetPNSC(int32 numbertype, int32 machinetype);
 
 HDFLIBAPI intn DFKsetNT(int32 ntype);
@@ -810,6 +975,8 @@ HDFLIBAPI intn DFKsb4b(void *s, void *d, uint32 num_elm, uint32 source_stride, u
 
 HDFLIBAPI intn DFKsb8b(void *s, void *d, uint32 num_elm, uint32 source_stride, uint32 dest_stride);
 
+HDFLIBAPI void DFKswap_init(void);
+
 /* Multi-file Annotation C-routines found in mfan.c */
 HDFLIBAPI int32 ANstart(int32 file_id);
 
@@ -873,6 +1040,8 @@ HDFLIBAPI intn GRwriteimage(int32 riid, int32 start[2], int32 stride[2], int32 c
 
 HDFLIBAPI intn GRreadimage(int32 riid, int32 start[2], int32 stride[2], int32 count[2], void *data);
 
+HDFLIBAPI intn GRprefetch(int32 riid, int32 start[2], int32 count[2]);
+
 HDFLIBAPI intn GRendaccess(int32 riid);
 
 HDFLIBAPI uint16 GRidtoref(int32 riid);
@@ -909,6 +1078,8 @@ HDFLIBAPI intn GRattrinfo(int32 id, int32 idx, char *name, int32 *attr_nt, int32
 
 HDFLIBAPI intn GRgetattr(int32 id, int32 idx, void *data);
 
+HDFLIBAPI int32 GRreadallattrs(int32 id, hdf_attr_t attrs[], int32 max_attrs, void *arena, int32 *arena_size);
+
 HDFLIBAPI int32 GRfindattr(int32 id, const char *name);
 
 HDFLIBAPI intn GRgetcomptype(int32 riid, comp_coder_t *comp_type);
@@ -930,6 +1101,24 @@ HDFLIBAPI intn GR2bmapped(int32 riid, intn *tobe_mapped, intn *created_byGR);
 /* Cache flags */
 #define HDF_CACHEALL 0x1
 
+/* Chunk cache replacement policies, or'ed into the cache flags */
+#define HDF_CACHE_LRU    0x00 /* evict the least recently used chunk */
+#define HDF_CACHE_CLOCK  0x10 /* evict with the CLOCK (second chance) algorithm */
+#define HDF_CACHE_2Q     0x20 /* scan resistant: evict chunks used only once first */
+#define HDF_CACHE_POLICY 0x30 /* mask of the replacement policy bits */
+
+/* The chunk cache shares the process-wide byte budget, see SDsetchunkcachebudget() */
+#define HDF_CACHE_SHARED 0x40
+
+/* Checksums of a chunk known, returned by SDgetchunkchecksum() */
+#define HDF_CHKSUM_RAW    0x1 /* of the data decoded */
+#define HDF_CHKSUM_STORED 0x2 /* of the data as stored in the file */
+
+/* Whether 'flags' are valid chunk cache flags */
+#define HDF_CACHE_FLAGS_OK(flags)                                                                            \
+    (((flags) & ~(HDF_CACHEALL | HDF_CACHE_POLICY | HDF_CACHE_SHARED)) == 0 &&                              \
+     ((flags)&HDF_CACHE_POLICY) != HDF_CACHE_POLICY)
+
 /* Chunk Definition, Note that GRs need only 2 dimensions for the chunk_lengths */
 typedef union hdf_chunk_def_u {
     /* Chunk Lengths only */
@@ -1141,6 +1330,46 @@ HDFLIBAPI intn GRreadchunk(int32  riid,   /* IN: raster access id */
                            int32 *origin, /* IN: origin of chunk to read */
                            void  *datap /* IN/OUT: buffer for data */);
 
+/******************************************************************************
+ NAME
+     GRreadchunkraw -- read the stored data of a chunk of the GR
+
+ DESCRIPTION
+     This routine copies the chunk of the chunked GR specified by chunk
+     'origin' as it is stored in the file, i.e. still compressed if the
+     GR is, into 'datap' without decoding, converting or reinterlacing it.
+     With 'datap' NULL only the size of the stored chunk is returned.
+
+     See GRwritechunkraw() to copy the chunk to another GR.
+
+ RETURNS
+        The number of bytes of the stored chunk, 0 if the chunk was never
+        written and FAIL on error
+******************************************************************************/
+HDFLIBAPI int32 GRreadchunkraw(int32  riid,   /* IN: raster access id */
+                               int32 *origin, /* IN: origin of chunk to read */
+                               void  *datap,  /* OUT: buffer for the stored chunk */
+                               int32  buflen /* IN: size of 'datap' */);
+
+/******************************************************************************
+ NAME
+     GRwritechunkraw -- write the stored data of a chunk of the GR
+
+ DESCRIPTION
+     This routine writes 'length' bytes read by GRreadchunkraw() as the
+     chunk of the chunked GR specified by chunk 'origin', without
+     encoding or converting them.  The GR must have the same number type,
+     number of components, chunk lengths and compression as the one the
+     data was read from, and the chunk must not have been written yet.
+
+ RETURNS
+        SUCCEED/FAIL
+******************************************************************************/
+HDFLIBAPI intn GRwritechunkraw(int32       riid,   /* IN: raster access id */
+                               int32      *origin, /* IN: origin of chunk to write */
+                               const void *datap,  /* IN: stored chunk */
+                               int32       length /* IN: number of bytes in 'datap' */);
+
 /******************************************************************************
 NAME
      GRsetchunkcache -- maximum number of chunks to cache
@@ -1179,6 +1408,21 @@ DESCRIPTION
      in memory, otherwise pass in zero(0). Currently you can only
      pass in zero.
 
+     The policy used to pick the chunk to evict from a full cache can be
+     or'ed into 'flags': HDF_CACHE_LRU (the default, least recently used),
+     HDF_CACHE_CLOCK or HDF_CACHE_2Q.  HDF_CACHE_2Q is scan resistant:
+     chunks that were only read once, as in a pass across the data, are
+     evicted before chunks that were read again.
+
+     With HDF_CACHE_SHARED also or'ed into 'flags', the cache joins the
+     cache pool shared by all the datasets of the process, whose byte
+     budget is set with SDsetchunkcachebudget().  'maxcache' still bounds
+     the number of chunks cached and is the dataset's weight in the pool:
+     when the pool is full, chunks are evicted from the dataset holding
+     the most bytes relative to its weight.  Calling again without
+     HDF_CACHE_SHARED takes the cache out of the pool.  Thread-safe
+     builds have no pool and refuse HDF_CACHE_SHARED.
+
     See GRsetchunk() for a description of the organization of chunks in an GR.
 
 RETURNS
@@ -1189,6 +1433,62 @@ HDFLIBAPI intn GRsetchunkcache(int32 riid,     /* IN: raster access id */
                                int32 maxcache, /* IN: max number of chunks to cache */
                                int32 flags /* IN: flags = 0, HDF_CACHEALL */);
 
+/******************************************************************************
+NAME
+     GRsetchunkthreads -- number of threads used to code chunks
+
+DESCRIPTION
+     Set the number of threads used to decode and encode the deflate or LZ4
+     compressed chunks of a chunked GR, as SDsetchunkthreads() does for an
+     SDS.  JPEG, SZIP and coder plugin compressed chunks are decoded on the
+     threads too.
+     Chunks written may only reach the file when the GR is closed with
+     GRendaccess().  Passing 1 restores the default, serial coding.
+
+RETURNS
+     Returns the previous number of threads if successful and FAIL otherwise
+******************************************************************************/
+HDFLIBAPI intn GRsetchunkthreads(int32 riid, /* IN: raster access id */
+                                 intn  nthreads /* IN: number of coding threads */);
+
+/*=== GR Overview Routines  ====*/
+
+/******************************************************************************
+NAME
+     GRbuildoverviews -- build reduced resolution copies of a GR
+
+DESCRIPTION
+     Build 'nlevels' overview levels of a GR, each one the previous level
+     with every other pixel of every other line kept.  The levels are stored
+     as GRs named "<name>.overviewN", chunked and compressed like the GR,
+     and are listed in its OVERVIEW_ATTR attribute.  Call it again after
+     the GR data has changed.
+
+RETURNS
+     Returns SUCCEED if successful and FAIL otherwise
+******************************************************************************/
+HDFLIBAPI intn GRbuildoverviews(int32 riid, /* IN: raster access id */
+                                intn  nlevels /* IN: number of levels to build */);
+
+/******************************************************************************
+NAME
+     GRreadimage_level -- read data from an overview level of a GR
+
+DESCRIPTION
+     Read data from level 'level' of the overviews built by
+     GRbuildoverviews(), as GRreadimage() reads the GR itself, which is
+     level 0.  'start', 'stride' and 'count' are in pixels of the level.
+
+RETURNS
+     Returns SUCCEED if successful and FAIL otherwise
+******************************************************************************/
+HDFLIBAPI intn GRreadimage_level(int32 riid,      /* IN: raster access id */
+                                 intn  level,     /* IN: overview level, 0 for the GR */
+                                 int32 start[2],  /* IN: start of the data read */
+                                 int32 stride[2], /* IN: stride along each edge */
+                                 int32 count[2],  /* IN: count along each edge */
+                                 void *data /* OUT: buffer to read into */);
+
 /* Vset interface functions (used to be in vproto.h) */
 
 /* Useful macros, which someday might become actual functions */
@@ -1215,6 +1515,8 @@ HDFLIBAPI intn GRsetchunkcache(int32 riid,     /* IN: raster access id */
  ** from vattr.c
  */
 HDFLIBAPI intn Vsetattr(int32 vgid, const char *attrname, int32 datatype, int32 count, const void *values);
+
+HDFLIBAPI intn Vsetcompactattr(HFILEID f, intn compact_on);
 HDFLIBAPI intn Vnattrs(int32 vgid);
 HDFLIBAPI intn Vnattrs2(int32 vgid);
 HDFLIBAPI intn Vnoldattrs(int32 vgid);
@@ -1236,6 +1538,9 @@ HDFLIBAPI intn  VSfindattr(int32 vsid, int32 findex, const char *attrname);
 HDFLIBAPI intn VSattrinfo(int32 vsid, int32 findex, intn attrindex, char *name, int32 *datatype, int32 *count,
                           int32 *size);
 HDFLIBAPI intn VSgetattr(int32 vsid, int32 findex, intn attrindex, void *values);
+
+HDFLIBAPI int32 VSreadallattrs(int32 vsid, int32 findex, hdf_attr_t attrs[], int32 max_attrs, void *arena,
+                               int32 *arena_size);
 HDFLIBAPI intn VSisattr(int32 vsid);
 /*
  ** from vconv.c
@@ -1383,6 +1688,10 @@ HDFLIBAPI intn Visinternal /* this function is replaced by Vgisinternal */
 
 HDFLIBAPI intn Vgetvgroups(int32 id, uintn start_vg, uintn n_vgs, uint16 *refarray);
 
+HDFLIBAPI intn Vgettree(HFILEID f, hdf_vgtree_t **tree);
+
+HDFLIBAPI intn Vfreetree(hdf_vgtree_t *tree);
+
 /*******************************************************************************
 NAME
    Vdeletetagref - delete tag/ref pair in Vgroup
@@ -1403,6 +1712,8 @@ HDFLIBAPI intn Vdeletetagref(int32 vkey, /* IN: vgroup key */
 
 HDFLIBAPI intn VPshutdown(void);
 
+HDFLIBAPI intn VPtrim(void);
+
 /*
  ** from vparse.c
  */
@@ -1486,8 +1797,29 @@ HDFLIBAPI int32 VSseek(int32 vkey, int32 eltpos);
 
 HDFLIBAPI int32 VSread(int32 vkey, uint8 buf[], int32 nelt, int32 interlace);
 
+HDFLIBAPI int32 VSreadcolumns(int32 vkey, uint8 *bufs[], int32 nelt);
+
+HDFLIBAPI int32 VSreadfield(int32 vkey, const char *fieldname, uint8 buf[], int32 nelt);
+
+HDFLIBAPI intn VSiter_begin(int32 vkey, int32 batch, int32 interlace);
+
+HDFLIBAPI int32 VSiter_next(int32 vkey, uint8 buf[]);
+
+HDFLIBAPI intn VSiter_end(int32 vkey);
+
+HDFLIBAPI int32 VSquery(int32 vkey, intn nconds, const hdf_vscond_t conds[], int32 maxrecs, int32 indices[]);
+
+HDFLIBAPI intn VScreateindex(int32 vkey, const char *field);
+
+HDFLIBAPI int32 VSlookup(int32 vkey, const char *field, float64 value, int32 maxrecs, int32 indices[]);
+
+HDFLIBAPI int32 VSrange(int32 vkey, const char *field, float64 lo, float64 hi, int32 maxrecs,
+                        int32 indices[]);
+
 HDFLIBAPI int32 VSwrite(int32 vkey, const uint8 buf[], int32 nelt, int32 interlace);
 
+HDFLIBAPI int32 VSwritecolumns(int32 vkey, const uint8 *bufs[], int32 nelt);
+
 #ifdef __cplusplus
 }
 #endif
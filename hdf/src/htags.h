@@ -29,6 +29,7 @@
 #define DFTAG_LINKED       20 /* linked-block special element */
 #define DFTAG_VERSION      30
 #define DFTAG_COMPRESSED   40 /* compressed special element */
+#define DFTAG_CMPSEEK      41 /* seek points of a deflate compressed element */
 #define DFTAG_VLINKED      50 /* variable-len linked-block header */
 #define DFTAG_VLINKED_DATA 51 /* variable-len linked-block data */
 #define DFTAG_CHUNKED                                                                                        \
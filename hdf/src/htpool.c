@@ -0,0 +1,433 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*-----------------------------------------------------------------------------
+ * File:    htpool.c
+ * Purpose: run independent tasks on the library's shared worker threads
+ *
+ * All the parallel work of the library runs on one pool of worker threads,
+ * started as the jobs need them and kept until the library shuts down.  A
+ * job splits its task indices into one range for each thread that may work
+ * on it, the calling thread included.  Each thread runs the tasks of its own
+ * range in order, and once it is empty steals the upper half of the largest
+ * range left, so the threads keep to neighbouring tasks while the load
+ * evens out.  Several jobs may run at once, e.g. from the thread of the
+ * asynchronous SD calls; idle workers help the oldest job with room for
+ * them, and every caller works on its own job, which thus never waits for
+ * a busy pool.
+ *
+ * Hsettaskthreads() caps the threads of every job, Hsettaskaffinity() pins
+ * the workers to CPUs and Hsettaskexecutor() hands the jobs to an executor
+ * of the application instead, e.g. one running on TBB or OpenMP.
+ *---------------------------------------------------------------------------*/
+
+/* pthread_setaffinity_np() is only declared with _GNU_SOURCE */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "hdf.h"
+#include "htpool.h"
+
+#ifdef H4_HAVE_THREADS
+#include <pthread.h>
+#ifdef H4_HAVE_PTHREAD_SETAFFINITY_NP
+#include <sched.h>
+#endif /* H4_HAVE_PTHREAD_SETAFFINITY_NP */
+#endif /* H4_HAVE_THREADS */
+
+/* Task indices left to a thread working on a job: [lo, hi) */
+typedef struct htpool_range_t {
+    int32 lo; /* next task to run */
+    int32 hi; /* end of the range */
+} htpool_range_t;
+
+/* State shared by all the threads working on one job */
+typedef struct htpool_job_t {
+    htpool_task_t task;   /* task routine */
+    void         *arg;    /* argument for the task routine */
+    int32         ntasks; /* number of tasks in the job */
+    intn          nslots; /* threads that may work on it, the caller's slot 0 */
+#ifdef H4_HAVE_THREADS
+    intn                 nhelpers; /* workers that joined it, protected by the pool lock */
+    intn                 nbusy;    /* workers still on it, protected by the pool lock */
+    struct htpool_job_t *next;     /* next job with room for workers */
+    pthread_mutex_t      lock;     /* protects 'ranges' */
+    htpool_range_t       ranges[HTPOOL_MAX_THREADS];
+#endif /* H4_HAVE_THREADS */
+} htpool_job_t;
+
+/* Executor of the application, see Hsettaskexecutor() */
+static hdf_executor_func_t htpool_executor      = NULL;
+static void               *htpool_executor_data = NULL;
+
+#ifdef H4_HAVE_THREADS
+/* The shared pool: its workers, the jobs with room for them, and the CPUs
+   the workers are pinned to, see Hsettaskaffinity() */
+static pthread_mutex_t htpool_lock     = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  htpool_work     = PTHREAD_COND_INITIALIZER; /* a job was queued */
+static pthread_cond_t  htpool_done     = PTHREAD_COND_INITIALIZER; /* a worker left a job */
+static pthread_t       htpool_threads[HTPOOL_MAX_THREADS];
+static intn            htpool_nthreads = 0;     /* workers started */
+static intn            htpool_stop     = FALSE; /* TRUE while the workers are shut down */
+static intn            htpool_term     = FALSE; /* is htpool_shutdown() registered? */
+static htpool_job_t   *htpool_jobs     = NULL;  /* jobs with room for workers, oldest first */
+static intn            htpool_cpus[HTPOOL_MAX_THREADS];
+static intn            htpool_ncpus    = 0;
+
+/* Pin worker 'w' to its CPU, if any are set */
+static void
+htpool_pin(intn w)
+{
+#ifdef H4_HAVE_PTHREAD_SETAFFINITY_NP
+    cpu_set_t set;
+
+    if (htpool_ncpus == 0)
+        return;
+    CPU_ZERO(&set);
+    CPU_SET((size_t)htpool_cpus[w % htpool_ncpus], &set);
+    pthread_setaffinity_np(htpool_threads[w], sizeof(set), &set);
+#else
+    (void)w;
+#endif /* H4_HAVE_PTHREAD_SETAFFINITY_NP */
+} /* htpool_pin */
+
+/* Hand out the next task index of a slot, stealing the upper half of the
+   largest range left once the slot's own is empty; -1 when none are left */
+static int32
+htpool_claim(htpool_job_t *job, intn slot)
+{
+    htpool_range_t *own = &job->ranges[slot];
+    htpool_range_t *victim;
+    int32           take;
+    int32           task = -1;
+    intn            s;
+
+    pthread_mutex_lock(&job->lock);
+    if (own->lo >= own->hi) {
+        for (victim = NULL, s = 0; s < job->nslots; s++)
+            if (victim == NULL || job->ranges[s].hi - job->ranges[s].lo > victim->hi - victim->lo)
+                victim = &job->ranges[s];
+        if (victim != NULL && victim->lo < victim->hi) {
+            take       = (victim->hi - victim->lo + 1) / 2;
+            own->hi    = victim->hi;
+            own->lo    = victim->hi - take;
+            victim->hi = own->lo;
+        }
+    }
+    if (own->lo < own->hi)
+        task = own->lo++;
+    pthread_mutex_unlock(&job->lock);
+
+    return task;
+} /* htpool_claim */
+
+/* Run tasks of a job from a slot until there are none left */
+static void
+htpool_work_on(htpool_job_t *job, intn slot)
+{
+    int32 task;
+
+    while ((task = htpool_claim(job, slot)) >= 0)
+        (*job->task)(job->arg, task);
+} /* htpool_work_on */
+
+/* Take a job off the list of jobs with room for workers, if it is there;
+   called with the pool lock held */
+static void
+htpool_unqueue(htpool_job_t *job)
+{
+    htpool_job_t **p;
+
+    for (p = &htpool_jobs; *p != NULL; p = &(*p)->next)
+        if (*p == job) {
+            *p = job->next;
+            break;
+        }
+} /* htpool_unqueue */
+
+/* Worker thread: help the oldest job with room until the pool shuts down */
+static void *
+htpool_worker(void *arg)
+{
+    htpool_job_t *job;
+    intn          slot;
+
+    (void)arg;
+    pthread_mutex_lock(&htpool_lock);
+    while (!htpool_stop) {
+        if ((job = htpool_jobs) == NULL) {
+            pthread_cond_wait(&htpool_work, &htpool_lock);
+            continue;
+        }
+
+        /* take the next slot, the job is full once all are taken */
+        slot = ++job->nhelpers;
+        job->nbusy++;
+        if (job->nhelpers == job->nslots - 1)
+            htpool_unqueue(job);
+        pthread_mutex_unlock(&htpool_lock);
+
+        htpool_work_on(job, slot);
+
+        /* nothing left to steal: no other worker need join it */
+        pthread_mutex_lock(&htpool_lock);
+        htpool_unqueue(job);
+        if (--job->nbusy == 0)
+            pthread_cond_broadcast(&htpool_done);
+    }
+    pthread_mutex_unlock(&htpool_lock);
+
+    return NULL;
+} /* htpool_worker */
+
+/* Stop and join the workers, at the shut down of the library */
+static intn
+htpool_shutdown(void)
+{
+    intn i;
+
+    pthread_mutex_lock(&htpool_lock);
+    htpool_stop = TRUE;
+    pthread_cond_broadcast(&htpool_work);
+    pthread_mutex_unlock(&htpool_lock);
+
+    for (i = 0; i < htpool_nthreads; i++)
+        pthread_join(htpool_threads[i], NULL);
+
+    pthread_mutex_lock(&htpool_lock);
+    htpool_nthreads = 0;
+    htpool_stop     = FALSE;
+    htpool_term     = FALSE;
+    pthread_mutex_unlock(&htpool_lock);
+
+    return SUCCEED;
+} /* htpool_shutdown */
+
+/* Start workers until there are 'n'; called with the pool lock held */
+static void
+htpool_grow(intn n)
+{
+    if (!htpool_term && n > htpool_nthreads) {
+        if (HPregister_term_func(&htpool_shutdown) != 0)
+            return;
+        htpool_term = TRUE;
+    }
+    while (htpool_nthreads < n) {
+        if (pthread_create(&htpool_threads[htpool_nthreads], NULL, htpool_worker, NULL) != 0)
+            break; /* carry on with the workers we have */
+        htpool_pin(htpool_nthreads++);
+    }
+} /* htpool_grow */
+#endif /* H4_HAVE_THREADS */
+
+/******************************************************************************
+ NAME
+     htpool_run - Run a set of independent tasks on worker threads
+
+ DESCRIPTION
+    Calls 'task' once for every task index in [0, ntasks), spreading the
+    calls over up to 'nthreads' threads (the calling thread included), as
+    capped by Hsettaskthreads(), or hands them to the executor set by
+    Hsettaskexecutor().
+
+ RETURNS
+    Returns SUCCEED if successful and FAIL otherwise
+
+*******************************************************************************/
+intn
+htpool_run(intn nthreads, int32 ntasks, htpool_task_t task, void *arg)
+{
+#ifdef H4_HAVE_THREADS
+    htpool_job_t job;
+    int32        per;
+#endif
+    int32 s;
+    int32 max_threads;
+    intn  ret_value = SUCCEED;
+
+    /* Check args */
+    if (task == NULL || ntasks < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if ((max_threads = HPgetconfig(HDF_CONFIG_TASK_THREADS)) > 0 && nthreads > max_threads)
+        nthreads = (intn)max_threads;
+    if (nthreads > HTPOOL_MAX_THREADS)
+        nthreads = HTPOOL_MAX_THREADS;
+    if (nthreads > ntasks)
+        nthreads = (intn)ntasks;
+
+    if (nthreads > 1 && htpool_executor != NULL) {
+        if ((*htpool_executor)(htpool_executor_data, ntasks, nthreads, task, arg) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        HGOTO_DONE(SUCCEED);
+    }
+
+#ifdef H4_HAVE_THREADS
+    if (nthreads > 1) {
+        job.task   = task;
+        job.arg    = arg;
+        job.ntasks = ntasks;
+        job.nslots = nthreads;
+        if (pthread_mutex_init(&job.lock, NULL) != 0)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+        /* one range of neighbouring tasks for each slot */
+        for (s = 0, per = ntasks / nthreads; s < nthreads; s++) {
+            job.ranges[s].lo = s * per + MIN(s, ntasks % nthreads);
+            job.ranges[s].hi = job.ranges[s].lo + per + (s < ntasks % nthreads ? 1 : 0);
+        }
+        job.nhelpers = 0;
+        job.nbusy    = 0;
+        job.next     = NULL;
+
+        /* queue it for the workers; the calling thread takes slot 0 */
+        pthread_mutex_lock(&htpool_lock);
+        htpool_grow(nthreads - 1);
+        if (htpool_nthreads > 0) {
+            htpool_job_t **p;
+
+            for (p = &htpool_jobs; *p != NULL; p = &(*p)->next)
+                ;
+            *p = &job;
+            pthread_cond_broadcast(&htpool_work);
+        }
+        pthread_mutex_unlock(&htpool_lock);
+
+        htpool_work_on(&job, 0);
+
+        /* wait for the workers that joined it to leave */
+        pthread_mutex_lock(&htpool_lock);
+        htpool_unqueue(&job);
+        while (job.nbusy > 0)
+            pthread_cond_wait(&htpool_done, &htpool_lock);
+        pthread_mutex_unlock(&htpool_lock);
+
+        pthread_mutex_destroy(&job.lock);
+        HGOTO_DONE(SUCCEED);
+    }
+#endif
+
+    /* Serial fallback */
+    for (s = 0; s < ntasks; s++)
+        (*task)(arg, s);
+
+done:
+    return ret_value;
+} /* htpool_run */
+
+/*--------------------------------------------------------------------------
+ NAME
+    Hsettaskthreads -- set the most threads any parallel work of the library uses
+ USAGE
+    intn Hsettaskthreads(nthreads)
+    intn nthreads;      IN: most threads of a job, the calling thread
+                            included, 0 for no limit
+ RETURNS
+    Returns the previous limit if successful and FAIL otherwise
+ DESCRIPTION
+    Chunks decoded and encoded on the threads of their element, see
+    SDsetchunkthreads(), and deflate streams written on several threads,
+    see HCset_deflate_threads(), all run on the one pool of worker threads
+    of the library, which is started as needed.  The number of threads
+    each of them asks for is capped by 'nthreads', which thus bounds the
+    pool and the CPUs the library keeps busy.  The limit is 0 by default,
+    or as given by HDF4_TASK_THREADS, see HDF_CONFIG_TASK_THREADS.
+--------------------------------------------------------------------------*/
+intn
+Hsettaskthreads(intn nthreads)
+{
+    HEclear();
+
+    if (nthreads < 0)
+        HRETURN_ERROR(DFE_ARGS, FAIL);
+
+    return (intn)Hsetconfig(HDF_CONFIG_TASK_THREADS, MIN(nthreads, HTPOOL_MAX_THREADS));
+} /* Hsettaskthreads */
+
+/*--------------------------------------------------------------------------
+ NAME
+    Hsettaskaffinity -- pin the worker threads of the library to CPUs
+ USAGE
+    intn Hsettaskaffinity(cpus, ncpus)
+    const intn *cpus;   IN: CPU numbers
+    intn ncpus;         IN: # of entries of 'cpus', 0 to unpin
+ RETURNS
+    Returns SUCCEED if successful and FAIL otherwise, or where the system
+    cannot pin threads
+ DESCRIPTION
+    The workers of the pool, see Hsettaskthreads(), running and to come,
+    are pinned to the CPUs in turn.  Giving the CPUs of one NUMA node
+    keeps the work of the library, and the buffers its workers first
+    touch, on that node.  The threads calling the library are left alone.
+    Workers already pinned stay so after an unpinning call.
+--------------------------------------------------------------------------*/
+intn
+Hsettaskaffinity(const intn *cpus, intn ncpus)
+{
+#ifdef H4_HAVE_PTHREAD_SETAFFINITY_NP
+    intn i;
+#endif
+    intn ret_value = SUCCEED;
+
+    HEclear();
+
+    if (ncpus < 0 || ncpus > HTPOOL_MAX_THREADS || (ncpus > 0 && cpus == NULL))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+#ifdef H4_HAVE_PTHREAD_SETAFFINITY_NP
+    for (i = 0; i < ncpus; i++)
+        if (cpus[i] < 0 || cpus[i] >= CPU_SETSIZE)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    pthread_mutex_lock(&htpool_lock);
+    for (i = 0; i < ncpus; i++)
+        htpool_cpus[i] = cpus[i];
+    htpool_ncpus = ncpus;
+    for (i = 0; i < htpool_nthreads; i++)
+        htpool_pin(i);
+    pthread_mutex_unlock(&htpool_lock);
+#else
+    if (ncpus > 0)
+        HGOTO_ERROR(DFE_UNSUPPORTED, FAIL);
+#endif /* H4_HAVE_PTHREAD_SETAFFINITY_NP */
+
+done:
+    return ret_value;
+} /* Hsettaskaffinity */
+
+/*--------------------------------------------------------------------------
+ NAME
+    Hsettaskexecutor -- run the parallel work of the library on an executor
+ USAGE
+    intn Hsettaskexecutor(func, user_data)
+    hdf_executor_func_t func;   IN: the executor, NULL for the library's pool
+    void *user_data;            IN: pointer passed to every call of 'func'
+ RETURNS
+    Returns SUCCEED (0) if successful and FAIL (-1) if failed.
+ DESCRIPTION
+    From now on every job of more than one thread, capped as by
+    Hsettaskthreads(), is handed to 'func', e.g. to run its tasks in a
+    TBB parallel_for or an OpenMP loop, instead of the library's own
+    workers.  The tasks do not call the library and may run on any thread
+    in any order; 'func' returns once they all have.
+--------------------------------------------------------------------------*/
+intn
+Hsettaskexecutor(hdf_executor_func_t func, void *user_data)
+{
+    HEclear();
+
+    htpool_executor      = func;
+    htpool_executor_data = user_data;
+
+    return SUCCEED;
+} /* Hsettaskexecutor */
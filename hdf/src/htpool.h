@@ -0,0 +1,69 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*-----------------------------------------------------------------------------
+ * File:    htpool.h
+ * Purpose: header file for the library's shared worker-thread pool
+ *
+ * Tasks handed to htpool_run() must not call into the HDF library: the
+ * library's global state (atoms, error stack, file records) is not
+ * protected against concurrent access.  Task routines only work on memory
+ * handed to them by the caller and report problems through that memory.
+ *---------------------------------------------------------------------------*/
+
+#ifndef H4_HTPOOL_H
+#define H4_HTPOOL_H
+
+#include "hdf.h"
+
+/* Upper bound on the number of worker threads used for a single job */
+#define HTPOOL_MAX_THREADS 64
+
+/* Task routine, called once for each task index in [0, ntasks) */
+typedef void (*htpool_task_t)(void *arg, /* IN: job argument given to htpool_run() */
+                              int32 task /* IN: index of the task to run */);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ NAME
+     htpool_run - Run a set of independent tasks on worker threads
+
+ DESCRIPTION
+    Calls 'task' once for every task index in [0, ntasks), spreading the
+    calls over up to 'nthreads' threads (the calling thread included) and
+    returns once all of them have completed.  The threads come from the
+    library's shared pool, or the executor of Hsettaskexecutor(), and
+    'nthreads' is capped by Hsettaskthreads().  Each thread runs a range of
+    neighbouring tasks in increasing order, then steals from the others, so
+    tasks do not start in any overall order.
+
+    When the library was built without thread support or when 'nthreads' is
+    1 or less, the tasks are simply run on the calling thread, in order.
+
+ RETURNS
+    Returns SUCCEED if successful and FAIL otherwise
+
+*******************************************************************************/
+intn htpool_run(intn          nthreads, /* IN: maximum number of threads to use */
+                int32         ntasks,   /* IN: number of tasks to run */
+                htpool_task_t task,     /* IN: task routine */
+                void         *arg       /* IN: argument passed to each task */
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H4_HTPOOL_H */
@@ -51,14 +51,40 @@
 #define STATISTICS
 */
 
-#include "hdf.h"    /* number types ..etc */
-#include "hqueue.h" /* Circular queue functions(Macros) */
+#include "hdf.h" /* number types ..etc */
 #include "mcache.h"
 
 /* Private routines */
-static BKT *mcache_bkt(MCACHE *mp);
-static BKT *mcache_look(MCACHE *mp, int32 pgno);
-static intn mcache_write(MCACHE *mp, BKT *bkt);
+static BKT    *mcache_bkt(MCACHE *mp);
+static BKT    *mcache_look(MCACHE *mp, int32 pgno);
+static intn    mcache_write(MCACHE *mp, BKT *bkt);
+static int32   mcache_hashsize(int32 nentries);
+static void    mcache_hash_insert(MCACHE *mp, BKT *bp);
+static void    mcache_hash_remove(BKT *bp);
+static void    mcache_lru_append(MCACHE *mp, BKT *bp);
+static void    mcache_lru_remove(MCACHE *mp, BKT *bp);
+static L_ELEM *mcache_elem_look(MCACHE *mp, int32 pgno);
+static BKT    *mcache_victim(MCACHE *mp);
+static void    mcache_ghost_push(MCACHE *mp, L_ELEM *lp);
+static intn    mcache_ghost_reset(MCACHE *mp, int32 nghosts);
+static intn    mcache_evict(MCACHE *mp, BKT *bp);
+static MCACHE *mcache_pool_owner(void);
+static void    mcache_pool_leave(MCACHE *mp);
+
+/* Size of the 2Q probation queue and of its ghost ring for 'maxcache' pages */
+#define MCACHE_A1_SIZE(maxcache)    MAX(1, (maxcache) / 4)
+#define MCACHE_GHOST_SIZE(maxcache) MAX(1, (maxcache) / 2)
+
+/* Bytes of memory of a page of 'mp', see HDF_MEM_CHUNK_CACHE */
+#define MCACHE_PAGE_BYTES(mp) (sizeof(BKT) + (size_t)(mp)->pagesize)
+
+/* Ghost stamps are restarted before they can overflow */
+#define MCACHE_MAX_GHOST_SEQ 0x7fff0000
+
+/* The pool shared by the caches that joined it with mcache_set_pool() */
+static MCACHE *mcache_pool        = NULL;            /* caches in the pool */
+static int32   mcache_pool_bytes  = 0;               /* bytes of the pages they cache */
+static int32   mcache_pool_budget = DEF_POOL_BUDGET; /* bytes they may cache */
 
 /******************************************************************************
 NAME
@@ -79,6 +105,189 @@ mcache_get_npages(MCACHE *mp /* IN: MCACHE cookie */)
         return 0;
 } /* mcache_get_npages */
 
+/******************************************************************************
+NAME
+    mcache_is_cached - checks whether a page is currently in the cache
+
+DESCRIPTION
+    Looks up the given page in the cache without bringing it in and without
+    counting the lookup as a cache hit or miss.
+
+RETURNS
+    Returns TRUE if the page is in the cache and FALSE otherwise.
+******************************************************************************/
+intn
+mcache_is_cached(MCACHE *mp, /* IN: MCACHE cookie */
+                 int32   pgno /* IN: page number */)
+{
+    BKT *bp = NULL; /* bucket element */
+
+    if (mp == NULL || pgno < 1 || pgno > mp->npages)
+        return FALSE;
+
+    for (bp = mp->hqh[HASHKEY(pgno, mp->hashsize)]; bp != NULL; bp = bp->hnext)
+        if (bp->pgno == pgno)
+            return TRUE;
+
+    return FALSE;
+} /* mcache_is_cached */
+
+/******************************************************************************
+NAME
+    mcache_set_policy - sets the page replacement policy
+
+DESCRIPTION
+    Selects how the page to evict is picked once the cache is full:
+    MCACHE_LRU (the default), MCACHE_CLOCK or MCACHE_2Q.  See
+    mcache_victim() for a description of the policies.  The pages that
+    are cached stay cached.
+
+RETURNS
+    Returns the previous policy if successful and RET_ERROR otherwise.
+******************************************************************************/
+intn
+mcache_set_policy(MCACHE *mp, /* IN: MCACHE cookie */
+                  intn    policy /* IN: page replacement policy */)
+{
+    BKT *bp        = NULL; /* bucket element */
+    intn ret_value = RET_SUCCESS;
+
+    if (mp == NULL || (policy != MCACHE_LRU && policy != MCACHE_CLOCK && policy != MCACHE_2Q))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    ret_value = mp->policy;
+    if (policy == mp->policy)
+        goto done;
+
+    if (mcache_ghost_reset(mp, policy == MCACHE_2Q ? MCACHE_GHOST_SIZE(mp->maxcache) : 0) == RET_ERROR)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    /* Move the pages on probation to the lru list and clear the marks
+       of the old policy */
+    while ((bp = mp->a1_head) != NULL) {
+        mcache_lru_remove(mp, bp);
+        bp->flags &= ~MCACHE_PROBATION;
+        mcache_lru_append(mp, bp);
+    }
+    for (bp = mp->lru_head; bp != NULL; bp = bp->lnext)
+        bp->flags &= ~MCACHE_REFERENCED;
+    mp->hand = NULL;
+
+    mp->policy = policy;
+
+done:
+    return ret_value;
+} /* mcache_set_policy */
+
+/******************************************************************************
+NAME
+    mcache_get_stats - returns the hit, miss and eviction counts of the cache
+
+DESCRIPTION
+    Returns the number of mcache_get() calls that found their page in the
+    cache, the number that had to bring the page in, and the number of
+    pages evicted to make room for others, since the cache was opened.
+
+RETURNS
+    RET_SUCCESS if successful and RET_ERROR otherwise
+******************************************************************************/
+intn
+mcache_get_stats(MCACHE            *mp,   /* IN: MCACHE cookie */
+                 hdf_cache_stats_t *stats /* OUT: hit, miss and eviction counts */)
+{
+    intn ret_value = RET_SUCCESS;
+
+    if (mp == NULL || stats == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    stats->hits      = mp->nhits;
+    stats->misses    = mp->nmisses;
+    stats->evictions = mp->nevictions;
+
+done:
+    return ret_value;
+} /* mcache_get_stats */
+
+/******************************************************************************
+NAME
+    mcache_set_pool - adds a cache to or removes it from the shared pool
+
+DESCRIPTION
+    Caches in the shared pool share a single byte budget, set with
+    mcache_set_pool_budget(), on top of their own max # of pages.  When
+    a cache in the pool needs a new page and the pool is full, a page is
+    evicted from the cache in the pool that holds the most bytes relative
+    to its 'weight', which may be the cache itself.  A page evicted from
+    another cache is written out with that cache's filter if it is dirty.
+
+    A 'weight' of 0 takes the cache out of the pool, its pages stay
+    cached.  Caches leave the pool when they are closed.
+
+    Thread-safe builds do not have the pool, caches cannot join it.
+
+RETURNS
+    RET_SUCCESS if successful and RET_ERROR otherwise
+******************************************************************************/
+intn
+mcache_set_pool(MCACHE *mp, /* IN: MCACHE cookie */
+                int32   weight /* IN: share of the pool, 0 to leave it */)
+{
+    intn ret_value = RET_SUCCESS;
+
+    if (mp == NULL || weight < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+#ifdef H4_HAVE_THREADSAFE
+    /* A cache in the pool gives up pages for caches of other files, which
+       may be in use by other threads under their own file lock */
+    if (weight > 0)
+        HGOTO_ERROR(DFE_UNSUPPORTED, FAIL);
+#endif
+
+    if (weight > 0 && mp->weight == 0) { /* join the pool */
+        mp->pprev = NULL;
+        mp->pnext = mcache_pool;
+        if (mcache_pool != NULL)
+            mcache_pool->pprev = mp;
+        mcache_pool = mp;
+        mcache_pool_bytes += mp->curcache * mp->pagesize;
+    }
+    else if (weight == 0)
+        mcache_pool_leave(mp);
+
+    mp->weight = weight;
+
+done:
+    return ret_value;
+} /* mcache_set_pool */
+
+/******************************************************************************
+NAME
+    mcache_set_pool_budget - sets the byte budget of the shared pool
+
+DESCRIPTION
+    Sets the number of bytes of pages that the caches in the shared pool
+    may hold together.  Lowering the budget does not evict pages right
+    away, the pool shrinks as the caches in it bring in new pages.
+
+RETURNS
+    Returns the previous budget if successful and RET_ERROR otherwise.
+******************************************************************************/
+int32
+mcache_set_pool_budget(int32 nbytes /* IN: bytes shared by the pooled caches */)
+{
+    int32 ret_value = RET_SUCCESS;
+
+    if (nbytes < 1)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    ret_value          = mcache_pool_budget;
+    mcache_pool_budget = nbytes;
+
+done:
+    return ret_value;
+} /* mcache_set_pool_budget */
+
 /******************************************************************************
 NAME
     mcache_get_maxcache - returns current number of pages cached.
@@ -104,6 +313,8 @@ NAME
 
 DESCRIPTION
     Sets current number of pages to cached for object to 'maxcache'.
+    The page hash table is grown to match, so that lookups stay short
+    however many pages are cached.
 
 RETURNS
     Returns current number of pages cached.
@@ -112,6 +323,10 @@ int32
 mcache_set_maxcache(MCACHE *mp, /* IN: MCACHE cookie */
                     int32   maxcache /* IN: max pages to cache */)
 {
+    BKT  **newhqh = NULL; /* new page hash table */
+    BKT   *bp     = NULL; /* bucket element */
+    int32  newsize;       /* size of the new page hash table */
+
     if (mp != NULL) { /* currently allow the current cache to grow up */
         if (mp->maxcache < maxcache)
             mp->maxcache = maxcache;
@@ -123,6 +338,26 @@ mcache_set_maxcache(MCACHE *mp, /* IN: MCACHE cookie */
             if (maxcache > mp->curcache)
                 mp->maxcache = maxcache;
         }
+
+        /* Rehash the cached pages into a larger table if the cache outgrew
+           the current one; if the table can't be allocated, keep using
+           the old one */
+        newsize = mcache_hashsize(mp->maxcache);
+        if (newsize > mp->hashsize && (newhqh = (BKT **)calloc((size_t)newsize, sizeof(BKT *))) != NULL) {
+            free(mp->hqh);
+            mp->hqh      = newhqh;
+            mp->hashsize = newsize;
+            for (bp = mp->lru_head; bp != NULL; bp = bp->lnext)
+                mcache_hash_insert(mp, bp);
+            for (bp = mp->a1_head; bp != NULL; bp = bp->lnext)
+                mcache_hash_insert(mp, bp);
+        }
+
+        /* The 2Q ghost ring follows the size of the cache; failing to
+           resize it only makes the policy forget evicted pages */
+        if (mp->policy == MCACHE_2Q && mp->nghosts != MCACHE_GHOST_SIZE(mp->maxcache))
+            mcache_ghost_reset(mp, MCACHE_GHOST_SIZE(mp->maxcache));
+
         return mp->maxcache;
     }
     else
@@ -172,12 +407,12 @@ mcache_open(void *key,       /* IN: byte string used as handle to share buffers
             int32 npages,    /* IN: number of chunks currently in object */
             int32 flags /* IN: 0= object exists, 1= does not exist  */)
 {
-    struct _lhqh *lhead     = NULL; /* head of an entry in list hash chain */
-    MCACHE       *mp        = NULL; /* MCACHE cookie */
-    L_ELEM       *lp        = NULL;
-    intn          ret_value = RET_SUCCESS;
-    intn          entry; /* index into hash table */
-    int32         pageno;
+    L_ELEM **lhead     = NULL; /* head of an entry in list hash chain */
+    MCACHE  *mp        = NULL; /* MCACHE cookie */
+    L_ELEM  *lp        = NULL;
+    intn     ret_value = RET_SUCCESS;
+    intn     entry; /* index into hash table */
+    int32    pageno;
 
     (void)key;
 
@@ -191,11 +426,13 @@ mcache_open(void *key,       /* IN: byte string used as handle to share buffers
     if ((mp = (MCACHE *)calloc(1, sizeof(MCACHE))) == NULL)
         HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
-    H4_CIRCLEQ_INIT(&mp->lqh);
-    for (entry = 0; entry < HASHSIZE; ++entry) {
-        H4_CIRCLEQ_INIT(&mp->hqh[entry]);
-        H4_CIRCLEQ_INIT(&mp->lhqh[entry]);
-    }
+    /* Allocate the hash tables, sized for the cache and the object */
+    mp->hashsize  = mcache_hashsize(maxcache);
+    mp->lhashsize = mcache_hashsize(npages);
+    if ((mp->hqh = (BKT **)calloc((size_t)mp->hashsize, sizeof(BKT *))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if ((mp->lhqh = (L_ELEM **)calloc((size_t)mp->lhashsize, sizeof(L_ELEM *))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
     /* Initialize max # of pages to cache and number of pages in object */
     mp->maxcache = (int32)maxcache;
@@ -208,7 +445,7 @@ mcache_open(void *key,       /* IN: byte string used as handle to share buffers
 
     /* Initialize list hash chain */
     for (pageno = 1; pageno <= mp->npages; ++pageno) {
-        lhead = &mp->lhqh[HASHKEY(pageno)];
+        lhead = &mp->lhqh[HASHKEY(pageno, mp->lhashsize)];
         if ((lp = (L_ELEM *)malloc(sizeof(L_ELEM))) == NULL)
             HGOTO_ERROR(DFE_NOSPACE, FAIL);
         lp->pgno = (int32)pageno; /* set page number */
@@ -224,8 +461,9 @@ mcache_open(void *key,       /* IN: byte string used as handle to share buffers
         lp->elemhit = 0;
         ++(mp->listalloc);
 #endif
-        H4_CIRCLEQ_INSERT_HEAD(lhead, lp, hl); /* add to list */
-    }                                          /* end for pageno */
+        lp->hnext = *lhead; /* add to list */
+        *lhead    = lp;
+    } /* end for pageno */
 
     /* initialize input/output filters and cookie to NULL */
     mp->pgin     = NULL;
@@ -246,14 +484,19 @@ mcache_open(void *key,       /* IN: byte string used as handle to share buffers
 
 done:
     if (ret_value == RET_ERROR) { /* error cleanup */
-        free(mp);
-        /* free up list elements */
-        for (entry = 0; entry < HASHSIZE; ++entry) {
-            while ((lp = mp->lhqh[entry].cqh_first) != (void *)&mp->lhqh[entry]) {
-                H4_CIRCLEQ_REMOVE(&mp->lhqh[entry], mp->lhqh[entry].cqh_first, hl);
-                free(lp);
-            }
-        } /* end for entry */
+        if (mp != NULL) {
+            /* free up list elements */
+            if (mp->lhqh != NULL)
+                for (entry = 0; entry < mp->lhashsize; ++entry) {
+                    while ((lp = mp->lhqh[entry]) != NULL) {
+                        mp->lhqh[entry] = lp->hnext;
+                        free(lp);
+                    }
+                } /* end for entry */
+            free(mp->lhqh);
+            free(mp->hqh);
+            free(mp);
+        }
 
         mp = NULL; /* return value */
     }
@@ -295,7 +538,11 @@ NAME
 
 DESCRIPTION
     Get a page specified by 'pgno'. If the page is not cached then
-    we need to create a new page. All returned pages are pinned.
+    we need to create a new page. All returned pages are pinned, a page
+    gotten more than once stays pinned until it is put back as often.
+    With MCACHE_NOREAD the caller is about to overwrite the whole page,
+    so a page that is not cached is not read in and its contents are
+    undefined.
 
 RETURNS
    The specified page if successful and NULL otherwise
@@ -303,16 +550,12 @@ RETURNS
 void *
 mcache_get(MCACHE *mp,   /* IN: MCACHE cookie */
            int32   pgno, /* IN: page number */
-           int32   flags /* IN: XXX not used? */)
+           int32   flags /* IN: 0 or MCACHE_NOREAD */)
 {
-    struct _hqh  *head      = NULL; /* head of lru queue */
-    struct _lhqh *lhead     = NULL; /* head of an entry in list hash chain */
-    BKT          *bp        = NULL; /* bucket element */
-    L_ELEM       *lp        = NULL;
-    intn          ret_value = RET_SUCCESS;
-    intn          list_hit; /* hit flag */
-
-    (void)flags;
+    L_ELEM **lhead     = NULL; /* head of an entry in list hash chain */
+    BKT     *bp        = NULL; /* bucket element */
+    L_ELEM  *lp        = NULL;
+    intn     ret_value = RET_SUCCESS;
 
     /* check inputs */
     if (mp == NULL)
@@ -329,56 +572,49 @@ mcache_get(MCACHE *mp,   /* IN: MCACHE cookie */
 
     /* Check for a page that is cached. */
     if ((bp = mcache_look(mp, pgno)) != NULL) {
+        ++mp->nhits;
+
         /*
-         * Move the page to the head of the hash chain and the tail
-         * of the lru chain.
+         * Record the use of the page: CLOCK only marks it, LRU and 2Q move
+         * it to the tail of the lru list.  Under 2Q, pages on probation
+         * stay where they are until they are evicted.
          */
-        head = &mp->hqh[HASHKEY(bp->pgno)];
-        H4_CIRCLEQ_REMOVE(head, bp, hq);
-        H4_CIRCLEQ_INSERT_HEAD(head, bp, hq);
-        H4_CIRCLEQ_REMOVE(&mp->lqh, bp, q);
-        H4_CIRCLEQ_INSERT_TAIL(&mp->lqh, bp, q);
-        /* Return a pinned page. */
+        if (mp->policy == MCACHE_CLOCK)
+            bp->flags |= MCACHE_REFERENCED;
+        else if (!(bp->flags & MCACHE_PROBATION)) {
+            mcache_lru_remove(mp, bp);
+            mcache_lru_append(mp, bp);
+        }
+        /* Return a pinned page, the page stays pinned until every
+           mcache_get() of it is matched by a mcache_put() */
         bp->flags |= MCACHE_PINNED;
+        ++bp->pins;
 
-        /* update this page reference */
-        lhead = &mp->lhqh[HASHKEY(bp->pgno)];
-        for (lp = lhead->cqh_first; lp != (void *)lhead; lp = lp->hl.cqe_next)
-            if (lp->pgno == bp->pgno) { /* hit */
 #ifdef STATISTICS
-                ++mp->listhit;
-                ++lp->elemhit;
+        /* update this page reference */
+        ++mp->listhit;
+        ++bp->elem->elemhit;
 #endif
-                break;
-            } /* end if lp->pgno */
 
         /* we are done */
         ret_value = RET_SUCCESS;
         goto done;
     } /* end if bp */
 
+    ++mp->nmisses;
+
     /* Page not cached so
      * Get a page from the cache to use or create one. */
     if ((bp = mcache_bkt(mp)) == NULL)
         HE_REPORT_GOTO("unable to get a new page from bucket", FAIL);
 
     /* Check to see if this page has ever been referenced */
-    list_hit = 0;
-    lhead    = &mp->lhqh[HASHKEY(pgno)];
-    for (lp = lhead->cqh_first; lp != (void *)lhead; lp = lp->hl.cqe_next)
-        if (lp->pgno == pgno && lp->eflags != 0) { /* hit */
-#ifdef STATISTICS
-            ++mp->listhit;
-            ++lp->elemhit;
-#endif
-            list_hit = 1;
-            break;
-        } /* end if lp->pgno */
+    lp = mcache_elem_look(mp, pgno);
 
     /* If there is no hit then we allocate a new element
      *  and insert into hash table */
-    if (!list_hit) { /* NO hit, new list element
-                      * no need to read this page from disk */
+    if (lp == NULL) { /* NO hit, new list element
+                       * no need to read this page from disk */
         if ((lp = (L_ELEM *)malloc(sizeof(L_ELEM))) == NULL)
             HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
@@ -388,10 +624,23 @@ mcache_get(MCACHE *mp,   /* IN: MCACHE cookie */
         ++mp->listalloc;
         lp->elemhit = 1;
 #endif
-        H4_CIRCLEQ_INSERT_HEAD(lhead, lp, hl); /* add to list */
-    }                                          /*end if !list_hit */
-    else {                                     /* list hit, need to read page */
-        lp->eflags = ELEM_READ;                /* Indicate we are reading this page */
+        lhead     = &mp->lhqh[HASHKEY(pgno, mp->lhashsize)];
+        lp->hnext = *lhead; /* add to list */
+        *lhead    = lp;
+    }
+    else if (lp->eflags != 0 && (flags & MCACHE_NOREAD)) { /* list hit, page overwritten whole */
+#ifdef STATISTICS
+        ++mp->listhit;
+        ++lp->elemhit;
+#endif
+        lp->eflags = ELEM_READ;
+    }
+    else if (lp->eflags != 0) { /* list hit, need to read page */
+#ifdef STATISTICS
+        ++mp->listhit;
+        ++lp->elemhit;
+#endif
+        lp->eflags = ELEM_READ; /* Indicate we are reading this page */
 
 #ifdef STATISTICS
         ++mp->pageread;
@@ -403,14 +652,12 @@ mcache_get(MCACHE *mp,   /* IN: MCACHE cookie */
         if (mp->pgin != NULL) { /* Note page numbers in HMCPxxx are 0 based not 1 based */
             if (((mp->pgin)(mp->pgcookie, pgno - 1, bp->page)) == FAIL) {
                 HEreport("mcache_get: error reading chunk=%d\n", (intn)pgno - 1);
-                lp        = NULL; /* don't clobber the cache! */
                 ret_value = RET_ERROR;
                 goto done;
             }
         }
         else {
             HEreport("mcache_get: reading fcn not set,chunk=%d\n", (intn)pgno - 1);
-            lp        = NULL;
             ret_value = RET_ERROR;
             goto done;
         }
@@ -418,19 +665,35 @@ mcache_get(MCACHE *mp,   /* IN: MCACHE cookie */
 
     /* Set the page number, pin the page. */
     bp->pgno  = pgno;
+    bp->elem  = lp;
     bp->flags = MCACHE_PINNED;
+    bp->pins  = 1;
+
+    /* Under 2Q, a page starts on probation unless it was evicted from
+       probation recently, i.e. this is its second use in a short time */
+    if (mp->policy == MCACHE_2Q) {
+        if (lp->ghost != 0)
+            lp->ghost = 0;
+        else
+            bp->flags |= MCACHE_PROBATION;
+    }
 
     /*
      * Add the page to the head of the hash chain and the tail
-     * of the lru chain.
+     * of the lru list.
      */
-    head = &mp->hqh[HASHKEY(bp->pgno)];
-    H4_CIRCLEQ_INSERT_HEAD(head, bp, hq);
-    H4_CIRCLEQ_INSERT_TAIL(&mp->lqh, bp, q);
+    mcache_hash_insert(mp, bp);
+    mcache_lru_append(mp, bp);
 
 done:
     if (ret_value == RET_ERROR) { /* error cleanup */
-        free(lp);
+        if (bp != NULL) {         /* the page isn't on any list, give it back */
+            HDlarge_free(bp, MCACHE_PAGE_BYTES(mp));
+            HDmem_release(HDF_MEM_CHUNK_CACHE, MCACHE_PAGE_BYTES(mp));
+            --mp->curcache;
+            if (mp->weight > 0)
+                mcache_pool_bytes -= mp->pagesize;
+        }
         return NULL;
     }
     return bp->page;
@@ -452,10 +715,8 @@ mcache_put(MCACHE *mp,   /* IN: MCACHE cookie */
            void   *page, /* IN: page to put */
            int32   flags /* IN: flags = 0, MCACHE_DIRTY */)
 {
-    struct _lhqh *lhead     = NULL; /* head of an entry in list hash chain */
-    L_ELEM       *lp        = NULL;
-    BKT          *bp        = NULL; /* bucket element ptr */
-    intn          ret_value = RET_SUCCESS;
+    BKT *bp        = NULL; /* bucket element ptr */
+    intn ret_value = RET_SUCCESS;
 
     /* check inputs */
     if (mp == NULL || page == NULL)
@@ -467,21 +728,18 @@ mcache_put(MCACHE *mp,   /* IN: MCACHE cookie */
     /* get pointer to bucket element */
     bp = (BKT *)((char *)page - sizeof(BKT));
 
-    /* Unpin the page and mark it appropriately */
-    bp->flags &= ~MCACHE_PINNED;
+    /* Unpin the page once it is put back as often as it was gotten, and
+       mark it appropriately */
+    if (bp->pins > 0 && --bp->pins == 0)
+        bp->flags &= ~MCACHE_PINNED;
     bp->flags |= flags & MCACHE_DIRTY;
 
     if (bp->flags & MCACHE_DIRTY) { /* update this page reference */
-        lhead = &mp->lhqh[HASHKEY(bp->pgno)];
-        for (lp = lhead->cqh_first; lp != (void *)lhead; lp = lp->hl.cqe_next)
-            if (lp->pgno == bp->pgno) { /* hit */
 #ifdef STATISTICS
-                ++mp->listhit;
-                ++lp->elemhit;
+        ++mp->listhit;
+        ++bp->elem->elemhit;
 #endif
-                lp->eflags = ELEM_WRITTEN;
-                break;
-            } /* end if lp->pgno */
+        bp->elem->eflags = ELEM_WRITTEN;
     }
 
 done:
@@ -512,16 +770,24 @@ mcache_close(MCACHE *mp /* IN: MCACHE cookie */)
     if (mp == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
+    mcache_pool_leave(mp);
+
     /* Free up any space allocated to the lru pages. */
-    while ((bp = mp->lqh.cqh_first) != (void *)&mp->lqh) {
-        H4_CIRCLEQ_REMOVE(&mp->lqh, mp->lqh.cqh_first, q);
-        free(bp);
+    while ((bp = mp->lru_head) != NULL) {
+        mcache_lru_remove(mp, bp);
+        HDlarge_free(bp, MCACHE_PAGE_BYTES(mp));
+        HDmem_release(HDF_MEM_CHUNK_CACHE, MCACHE_PAGE_BYTES(mp));
+    }
+    while ((bp = mp->a1_head) != NULL) {
+        mcache_lru_remove(mp, bp);
+        HDlarge_free(bp, MCACHE_PAGE_BYTES(mp));
+        HDmem_release(HDF_MEM_CHUNK_CACHE, MCACHE_PAGE_BYTES(mp));
     }
 
     /* free up list elements */
-    for (entry = 0; entry < HASHSIZE; ++entry) {
-        while ((lp = mp->lhqh[entry].cqh_first) != (void *)&mp->lhqh[entry]) {
-            H4_CIRCLEQ_REMOVE(&mp->lhqh[entry], mp->lhqh[entry].cqh_first, hl);
+    for (entry = 0; entry < mp->lhashsize; ++entry) {
+        while ((lp = mp->lhqh[entry]) != NULL) {
+            mp->lhqh[entry] = lp->hnext;
             free(lp);
             nelem++;
         }
@@ -533,6 +799,9 @@ done:
     }
 
     /* Free the MCACHE cookie. */
+    free(mp->ghosts);
+    free(mp->lhqh);
+    free(mp->hqh);
     free(mp);
 
     return ret_value;
@@ -558,8 +827,12 @@ mcache_sync(MCACHE *mp /* IN: MCACHE cookie */)
     if (mp == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* Walk the lru chain, flushing any dirty pages to disk. */
-    for (bp = mp->lqh.cqh_first; bp != (void *)&mp->lqh; bp = bp->q.cqe_next) {
+    /* Walk the lru lists, flushing any dirty pages to disk. */
+    for (bp = mp->lru_head; bp != NULL; bp = bp->lnext) {
+        if (bp->flags & MCACHE_DIRTY && mcache_write(mp, bp) == RET_ERROR)
+            HE_REPORT_GOTO("unable to flush a dirty page", FAIL);
+    } /* end for bp */
+    for (bp = mp->a1_head; bp != NULL; bp = bp->lnext) {
         if (bp->flags & MCACHE_DIRTY && mcache_write(mp, bp) == RET_ERROR)
             HE_REPORT_GOTO("unable to flush a dirty page", FAIL);
     } /* end for bp */
@@ -587,47 +860,59 @@ NOTE: Note that the size of the page allocated is equal to
       pagesize fragment to the user. The only caveat here is
       that a user could inadvertently clobber the bucket element
       information by writing out of the page size bounds.
+      Large pages come from HDlarge_alloc(), and may be made of
+      huge pages, see Hsethugepages().
 ******************************************************************************/
 static BKT *
 mcache_bkt(MCACHE *mp /* IN: MCACHE cookie */)
 {
-    struct _hqh *head      = NULL; /* head of hash chain */
-    BKT         *bp        = NULL; /* bucket element */
-    intn         ret_value = RET_SUCCESS;
+    MCACHE *owner     = NULL; /* cache to take a page from */
+    BKT    *bp        = NULL; /* bucket element */
+    intn    ret_value = RET_SUCCESS;
 
     /* check inputs */
     if (mp == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
+    /* A cache in the shared pool first makes room for the page in the
+       pool.  If all pages of the chosen cache are pinned the pool grows. */
+    if (mp->weight > 0)
+        while (mcache_pool_bytes + mp->pagesize > mcache_pool_budget) {
+            if ((owner = mcache_pool_owner()) == NULL || (bp = mcache_victim(owner)) == NULL)
+                break;
+            if (mcache_evict(owner, bp) == RET_ERROR)
+                HE_REPORT_GOTO("unable to flush a dirty page", FAIL);
+
+            if (owner == mp) /* reuse our own page */
+                goto done;
+
+            HDlarge_free(bp, MCACHE_PAGE_BYTES(owner));
+            HDmem_release(HDF_MEM_CHUNK_CACHE, MCACHE_PAGE_BYTES(owner));
+            --owner->curcache;
+            mcache_pool_bytes -= owner->pagesize;
+        } /* end while */
+
     /* If under the max cached, always create a new page. */
     if ((int32)mp->curcache < (int32)mp->maxcache)
         goto new;
 
     /*
-     * If the cache is max'd out, walk the lru list for a buffer we
-     * can flush.  If we find one, write it (if necessary) and take it
+     * If the cache is max'd out, ask the replacement policy for a buffer
+     * we can flush.  If we get one, write it (if necessary) and take it
      * off any lists.  If we don't find anything we grow the cache anyway.
      * The cache never shrinks.
      */
-    for (bp = mp->lqh.cqh_first; bp != (void *)&mp->lqh; bp = bp->q.cqe_next)
-        if (!(bp->flags & MCACHE_PINNED)) { /* Flush if dirty. */
-            if (bp->flags & MCACHE_DIRTY && mcache_write(mp, bp) == RET_ERROR)
-                HE_REPORT_GOTO("unable to flush a dirty page", FAIL);
-#ifdef STATISTICS
-            ++mp->pageflush;
-#endif
-            /* Remove from the hash and lru queues. */
-            head = &mp->hqh[HASHKEY(bp->pgno)];
-            H4_CIRCLEQ_REMOVE(head, bp, hq);
-            H4_CIRCLEQ_REMOVE(&mp->lqh, bp, q);
+    if ((bp = mcache_victim(mp)) != NULL) {
+        if (mcache_evict(mp, bp) == RET_ERROR)
+            HE_REPORT_GOTO("unable to flush a dirty page", FAIL);
 
-            /* done */
-            ret_value = RET_SUCCESS;
-            goto done;
-        } /* end if bp->flags */
+        /* done */
+        ret_value = RET_SUCCESS;
+        goto done;
+    } /* end if bp */
 
     /* create a new page */
-    new : if ((bp = (BKT *)malloc(sizeof(BKT) + (uintn)mp->pagesize)) == NULL) HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    new : if ((bp = (BKT *)HDlarge_alloc(MCACHE_PAGE_BYTES(mp))) == NULL) HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
 #ifdef STATISTICS
     ++mp->pagealloc;
@@ -636,16 +921,107 @@ mcache_bkt(MCACHE *mp /* IN: MCACHE cookie */)
     /* set page ptr past bucket element section */
     bp->page = (char *)bp + sizeof(BKT);
     ++mp->curcache; /* increase number of cached pages */
+    HDmem_acquire(HDF_MEM_CHUNK_CACHE, MCACHE_PAGE_BYTES(mp));
+    if (mp->weight > 0)
+        mcache_pool_bytes += mp->pagesize;
 
 done:
     if (ret_value == RET_ERROR) { /* error cleanup */
-        free(bp);
         return NULL;
     }
 
     return bp; /* return only the pagesize fragment */
 } /* mcache_bkt() */
 
+/******************************************************************************
+NAME
+   mcache_evict - take a page out of the cache.
+
+DESCRIPTION
+   Private routine. Writes the page out if it is dirty and takes it off
+   the hash chain and lru list, the bucket can then be reused or freed.
+
+RETURNS
+   RET_SUCCESS if successful and RET_ERROR otherwise
+******************************************************************************/
+static intn
+mcache_evict(MCACHE *mp, /* IN: MCACHE cookie */
+             BKT    *bp /* IN: bucket element */)
+{
+    intn ret_value = RET_SUCCESS;
+
+    /* Flush if dirty. */
+    if (bp->flags & MCACHE_DIRTY && mcache_write(mp, bp) == RET_ERROR)
+        HE_REPORT_GOTO("unable to flush a dirty page", FAIL);
+#ifdef STATISTICS
+    ++mp->pageflush;
+#endif
+    /* 2Q remembers pages evicted from probation for a while */
+    if (bp->flags & MCACHE_PROBATION)
+        mcache_ghost_push(mp, bp->elem);
+
+    /* Remove from the hash chain and lru list. */
+    mcache_hash_remove(bp);
+    mcache_lru_remove(mp, bp);
+    ++mp->nevictions;
+
+done:
+    return ret_value;
+} /* mcache_evict() */
+
+/******************************************************************************
+NAME
+   mcache_pool_owner - pick the cache of the shared pool to take a page from.
+
+DESCRIPTION
+   Private routine. Returns the cache in the pool holding the most bytes
+   relative to its weight.
+
+RETURNS
+   A cache with pages, or NULL if the caches in the pool hold no pages.
+******************************************************************************/
+static MCACHE *
+mcache_pool_owner(void)
+{
+    MCACHE *owner = NULL; /* cache most over its share */
+    MCACHE *mp    = NULL;
+
+    for (mp = mcache_pool; mp != NULL; mp = mp->pnext)
+        if (mp->curcache > 0 &&
+            (owner == NULL || (float64)mp->curcache * (float64)mp->pagesize * (float64)owner->weight >
+                                  (float64)owner->curcache * (float64)owner->pagesize * (float64)mp->weight))
+            owner = mp;
+
+    return owner;
+} /* mcache_pool_owner() */
+
+/******************************************************************************
+NAME
+   mcache_pool_leave - take a cache out of the shared pool.
+
+DESCRIPTION
+   Private routine. Does nothing if the cache is not in the pool.
+
+RETURNS
+   Nothing
+******************************************************************************/
+static void
+mcache_pool_leave(MCACHE *mp /* IN: MCACHE cookie */)
+{
+    if (mp->weight == 0)
+        return;
+
+    if (mp->pprev != NULL)
+        mp->pprev->pnext = mp->pnext;
+    else
+        mcache_pool = mp->pnext;
+    if (mp->pnext != NULL)
+        mp->pnext->pprev = mp->pprev;
+
+    mcache_pool_bytes -= mp->curcache * mp->pagesize;
+    mp->weight = 0;
+} /* mcache_pool_leave() */
+
 /******************************************************************************
 NAME
    mcache_write - write a page to disk given it's bucket handle.
@@ -660,9 +1036,7 @@ static int
 mcache_write(MCACHE *mp, /* IN: MCACHE cookie */
              BKT    *bp /* IN: bucket element */)
 {
-    struct _lhqh *lhead     = NULL; /* head of an entry in list hash chain */
-    L_ELEM       *lp        = NULL;
-    intn          ret_value = RET_SUCCESS;
+    intn ret_value = RET_SUCCESS;
 
     /* check inputs */
     if (mp == NULL || bp == NULL)
@@ -673,16 +1047,11 @@ mcache_write(MCACHE *mp, /* IN: MCACHE cookie */
 #endif
 
     /* update this page reference */
-    lhead = &mp->lhqh[HASHKEY(bp->pgno)];
-    for (lp = lhead->cqh_first; lp != (void *)lhead; lp = lp->hl.cqe_next)
-        if (lp->pgno == bp->pgno) { /* hit */
 #ifdef STATISTICS
-            ++mp->listhit;
-            ++lp->elemhit;
+    ++mp->listhit;
+    ++bp->elem->elemhit;
 #endif
-            lp->eflags = ELEM_SYNC;
-            break;
-        }
+    bp->elem->eflags = ELEM_SYNC;
 
     /* Run page through the user's filter.
        we use this to write the data chunk/page out.
@@ -725,8 +1094,7 @@ static BKT *
 mcache_look(MCACHE *mp, /* IN: MCACHE cookie */
             int32   pgno /* IN: page to look up in cache */)
 {
-    struct _hqh *head = NULL; /* head of hash chain */
-    BKT         *bp   = NULL; /* bucket element */
+    BKT *bp = NULL; /* bucket element */
 
     /* check inputs */
     if (mp == NULL) {
@@ -741,8 +1109,7 @@ mcache_look(MCACHE *mp, /* IN: MCACHE cookie */
     }
 
     /* search through hash chain */
-    head = &mp->hqh[HASHKEY(pgno)];
-    for (bp = head->cqh_first; bp != (void *)head; bp = bp->hq.cqe_next)
+    for (bp = mp->hqh[HASHKEY(pgno, mp->hashsize)]; bp != NULL; bp = bp->hnext)
         if (bp->pgno == pgno) { /* hit....found page in cache */
 #ifdef STATISTICS
             ++mp->cachehit;
@@ -762,6 +1129,301 @@ done:
     return bp;
 } /* mcache_look() */
 
+/******************************************************************************
+NAME
+   mcache_elem_look - lookup the element record of a page.
+
+DESCRIPTION
+   Private routine. Lookup the record of a page that has been referenced
+   before.
+
+RETURNS
+   Element record if found and NULL otherwise.
+******************************************************************************/
+static L_ELEM *
+mcache_elem_look(MCACHE *mp, /* IN: MCACHE cookie */
+                 int32   pgno /* IN: page to look up */)
+{
+    L_ELEM *lp = NULL;
+
+    for (lp = mp->lhqh[HASHKEY(pgno, mp->lhashsize)]; lp != NULL; lp = lp->hnext)
+        if (lp->pgno == pgno)
+            break;
+
+    return lp;
+} /* mcache_elem_look() */
+
+/******************************************************************************
+NAME
+   mcache_hashsize - size of a hash table for a number of entries.
+
+DESCRIPTION
+   Private routine. Returns the smallest power of two that is at least
+   'nentries', clamped to [MIN_HASHSIZE, MAX_HASHSIZE].
+
+RETURNS
+   Number of hash chains to use.
+******************************************************************************/
+static int32
+mcache_hashsize(int32 nentries /* IN: expected number of entries */)
+{
+    int32 size = MIN_HASHSIZE;
+
+    while (size < nentries && size < MAX_HASHSIZE)
+        size <<= 1;
+
+    return size;
+} /* mcache_hashsize() */
+
+/******************************************************************************
+NAME
+   mcache_hash_insert - add a page to the head of its hash chain.
+
+DESCRIPTION
+   Private routine.
+
+RETURNS
+   Nothing
+******************************************************************************/
+static void
+mcache_hash_insert(MCACHE *mp, /* IN: MCACHE cookie */
+                   BKT    *bp /* IN: bucket element */)
+{
+    BKT **head = &mp->hqh[HASHKEY(bp->pgno, mp->hashsize)]; /* head of hash chain */
+
+    bp->hnext = *head;
+    if (bp->hnext != NULL)
+        bp->hnext->hprev = &bp->hnext;
+    bp->hprev = head;
+    *head     = bp;
+} /* mcache_hash_insert() */
+
+/******************************************************************************
+NAME
+   mcache_hash_remove - take a page off its hash chain.
+
+DESCRIPTION
+   Private routine.
+
+RETURNS
+   Nothing
+******************************************************************************/
+static void
+mcache_hash_remove(BKT *bp /* IN: bucket element */)
+{
+    *bp->hprev = bp->hnext;
+    if (bp->hnext != NULL)
+        bp->hnext->hprev = bp->hprev;
+} /* mcache_hash_remove() */
+
+/******************************************************************************
+NAME
+   mcache_lru_append - add a page to the (most recently used) tail of the
+                       lru list.
+
+DESCRIPTION
+   Private routine.
+
+RETURNS
+   Nothing
+******************************************************************************/
+static void
+mcache_lru_append(MCACHE *mp, /* IN: MCACHE cookie */
+                  BKT    *bp /* IN: bucket element */)
+{
+    BKT **head = &mp->lru_head; /* head of the page's list */
+    BKT **tail = &mp->lru_tail; /* tail of the page's list */
+
+    if (bp->flags & MCACHE_PROBATION) {
+        head = &mp->a1_head;
+        tail = &mp->a1_tail;
+        ++mp->na1;
+    }
+
+    bp->lnext = NULL;
+    bp->lprev = *tail;
+    if (*tail != NULL)
+        (*tail)->lnext = bp;
+    else
+        *head = bp;
+    *tail = bp;
+} /* mcache_lru_append() */
+
+/******************************************************************************
+NAME
+   mcache_lru_remove - take a page off the lru list.
+
+DESCRIPTION
+   Private routine.
+
+RETURNS
+   Nothing
+******************************************************************************/
+static void
+mcache_lru_remove(MCACHE *mp, /* IN: MCACHE cookie */
+                  BKT    *bp /* IN: bucket element */)
+{
+    BKT **head = &mp->lru_head; /* head of the page's list */
+    BKT **tail = &mp->lru_tail; /* tail of the page's list */
+
+    if (bp->flags & MCACHE_PROBATION) {
+        head = &mp->a1_head;
+        tail = &mp->a1_tail;
+        --mp->na1;
+    }
+
+    if (mp->hand == bp)
+        mp->hand = bp->lnext;
+
+    if (bp->lprev != NULL)
+        bp->lprev->lnext = bp->lnext;
+    else
+        *head = bp->lnext;
+    if (bp->lnext != NULL)
+        bp->lnext->lprev = bp->lprev;
+    else
+        *tail = bp->lprev;
+} /* mcache_lru_remove() */
+
+/******************************************************************************
+NAME
+   mcache_victim - pick the page to evict.
+
+DESCRIPTION
+   Private routine. Picks an unpinned page to evict according to the
+   cache's replacement policy:
+
+   MCACHE_LRU   - the least recently used page.
+   MCACHE_CLOCK - the lru list is kept in load order and swept by a clock
+                  hand; a page used since the hand last passed it gets a
+                  second chance.
+   MCACHE_2Q    - the oldest page on probation, as long as more than a
+                  quarter of the cache is on probation, else the least
+                  recently used of the pages used more than once.
+
+RETURNS
+   Page to evict, or NULL if all pages are pinned.
+******************************************************************************/
+static BKT *
+mcache_victim(MCACHE *mp /* IN: MCACHE cookie */)
+{
+    BKT  *bp = NULL; /* bucket element */
+    int32 n;
+
+    if (mp->policy == MCACHE_CLOCK) {
+        /* two sweeps at most: the first may only clear reference marks */
+        for (n = 2 * mp->curcache; n > 0; n--) {
+            if ((bp = mp->hand) == NULL)
+                bp = mp->lru_head;
+            if (bp == NULL)
+                break;
+            mp->hand = bp->lnext;
+
+            if (bp->flags & MCACHE_PINNED)
+                continue;
+            if (bp->flags & MCACHE_REFERENCED) {
+                bp->flags &= ~MCACHE_REFERENCED;
+                continue;
+            }
+            return bp;
+        } /* end for n */
+        return NULL;
+    }
+
+    if (mp->policy == MCACHE_2Q && mp->na1 > MCACHE_A1_SIZE(mp->maxcache))
+        for (bp = mp->a1_head; bp != NULL; bp = bp->lnext)
+            if (!(bp->flags & MCACHE_PINNED))
+                return bp;
+
+    /* Pages are only pinned between mcache_get() and mcache_put(), or
+       while held by HMCgetChunkPtr(), so this normally stops at the head
+       of the list. */
+    for (bp = mp->lru_head; bp != NULL; bp = bp->lnext)
+        if (!(bp->flags & MCACHE_PINNED))
+            return bp;
+    for (bp = mp->a1_head; bp != NULL; bp = bp->lnext)
+        if (!(bp->flags & MCACHE_PINNED))
+            return bp;
+
+    return NULL;
+} /* mcache_victim() */
+
+/******************************************************************************
+NAME
+   mcache_ghost_push - remember a page evicted from 2Q probation.
+
+DESCRIPTION
+   Private routine. Stamps the element record of the page and adds it to
+   the ghost ring, forgetting the page that falls out of the ring.  A page
+   that is brought back while it is remembered skips probation.
+
+RETURNS
+   Nothing
+******************************************************************************/
+static void
+mcache_ghost_push(MCACHE *mp, /* IN: MCACHE cookie */
+                  L_ELEM *lp /* IN: element record of the evicted page */)
+{
+    L_ELEM **slot = NULL; /* ring slot for the page */
+
+    if (mp->nghosts == 0)
+        return;
+    if (mp->ghost_seq >= MCACHE_MAX_GHOST_SEQ)
+        mcache_ghost_reset(mp, mp->nghosts);
+
+    slot = &mp->ghosts[mp->ghost_seq % mp->nghosts];
+    ++mp->ghost_seq;
+
+    /* the page pushed out of the ring is forgotten, unless it has been
+       evicted again since it was added */
+    if (*slot != NULL && (*slot)->ghost == mp->ghost_seq - mp->nghosts)
+        (*slot)->ghost = 0;
+
+    lp->ghost = mp->ghost_seq;
+    *slot     = lp;
+} /* mcache_ghost_push() */
+
+/******************************************************************************
+NAME
+   mcache_ghost_reset - empty the 2Q ghost ring.
+
+DESCRIPTION
+   Private routine. Forgets all remembered pages and resizes the ghost
+   ring to 'nghosts' entries; 0 frees it.
+
+RETURNS
+   RET_SUCCESS if successful and RET_ERROR otherwise, in which case the
+   cache is left without a ghost ring.
+******************************************************************************/
+static intn
+mcache_ghost_reset(MCACHE *mp, /* IN: MCACHE cookie */
+                   int32   nghosts /* IN: new size of the ghost ring */)
+{
+    int32 i;
+    intn  ret_value = RET_SUCCESS;
+
+    for (i = 0; i < mp->nghosts; i++)
+        if (mp->ghosts[i] != NULL) {
+            mp->ghosts[i]->ghost = 0;
+            mp->ghosts[i]        = NULL;
+        }
+    mp->ghost_seq = 0;
+
+    if (nghosts != mp->nghosts) {
+        free(mp->ghosts);
+        mp->ghosts  = NULL;
+        mp->nghosts = 0;
+        if (nghosts > 0) {
+            if ((mp->ghosts = (L_ELEM **)calloc((size_t)nghosts, sizeof(L_ELEM *))) == NULL)
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+            mp->nghosts = nghosts;
+        }
+    }
+
+done:
+    return ret_value;
+} /* mcache_ghost_reset() */
+
 #ifdef STATISTICS
 #ifdef H4_HAVE_GETRUSAGE
 
@@ -806,13 +1468,12 @@ RETURNS
 void
 mcache_stat(MCACHE *mp /* IN: MCACHE cookie */)
 {
-    struct _lhqh *lhead = NULL; /* head of an entry in list hash chain */
-    BKT          *bp    = NULL; /* bucket element */
-    L_ELEM       *lp    = NULL;
-    char         *sep   = NULL;
-    intn          entry; /* index into hash table */
-    intn          cnt;
-    intn          hitcnt;
+    BKT    *bp  = NULL; /* bucket element */
+    L_ELEM *lp  = NULL;
+    char   *sep = NULL;
+    intn    entry; /* index into hash table */
+    intn    cnt;
+    intn    hitcnt;
 
 #ifdef H4_HAVE_GETRUSAGE
     myrusage();
@@ -839,12 +1500,16 @@ mcache_stat(MCACHE *mp /* IN: MCACHE cookie */)
                               (sizeof(L_ELEM) * mp->npages)));
         sep = "";
         cnt = 0;
-        for (bp = mp->lqh.cqh_first; bp != (void *)&mp->lqh; bp = bp->q.cqe_next) {
+        /* pages on probation first, then the lru list */
+        for (bp = (mp->a1_head != NULL ? mp->a1_head : mp->lru_head); bp != NULL;
+             bp = ((bp->flags & MCACHE_PROBATION) && bp->lnext == NULL ? mp->lru_head : bp->lnext)) {
             (void)fprintf(stderr, "%s%u", sep, bp->pgno);
             if (bp->flags & MCACHE_DIRTY)
                 (void)fprintf(stderr, "d");
             if (bp->flags & MCACHE_PINNED)
                 (void)fprintf(stderr, "P");
+            if (bp->flags & MCACHE_PROBATION)
+                (void)fprintf(stderr, "p");
             if (++cnt == 10) {
                 sep = "\n";
                 cnt = 0;
@@ -857,9 +1522,8 @@ mcache_stat(MCACHE *mp /* IN: MCACHE cookie */)
         sep    = "";
         cnt    = 0;
         hitcnt = 0;
-        for (entry = 0; entry < HASHSIZE; ++entry) {
-            lhead = &mp->lhqh[entry];
-            for (lp = lhead->cqh_first; lp != (void *)lhead; lp = lp->hl.cqe_next) {
+        for (entry = 0; entry < mp->lhashsize; ++entry) {
+            for (lp = mp->lhqh[entry]; lp != NULL; lp = lp->hnext) {
                 cnt++;
                 (void)fprintf(stderr, "%s%u(%u)", sep, lp->pgno, lp->elemhit);
                 hitcnt += lp->elemhit;
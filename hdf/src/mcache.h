@@ -51,9 +51,6 @@
 #ifndef H4_MCACHE_H
 #define H4_MCACHE_H
 
-/* Required include */
-#include "hqueue.h" /* Circular queue functions(Macros) */
-
 #include "H4api_adpt.h"
 
 /* Set return/succeed values */
@@ -67,16 +64,20 @@
 
 /*
  * The memory pool scheme is a simple one.  Each in-memory page is referenced
- * by a bucket which is threaded in up to two (three?) ways.  All active pages
- * are threaded on a hash chain (hashed by page number) and an lru chain.
- * (Inactive pages are threaded on a free chain?).  Each reference to a memory
- * pool is handed an opaque MPOOL cookie which stores all of this information.
+ * by a bucket which is threaded in two ways.  All active pages are threaded
+ * on a hash chain (hashed by page number) and an lru list.  Every page
+ * ever referenced also has an element record, threaded on a second hash
+ * table.  Each reference to a memory pool is handed an opaque MPOOL cookie
+ * which stores all of this information.
  */
 
-/* Current Hash table size. Page numbers start with 1
+/* Hash table sizes are powers of two between these bounds: the page hash
+ * grows with the max # of pages to cache, the element hash is sized from
+ * the # of pages in the object.  Page numbers start with 1
  * (i.e 0 will denote invalid page number) */
-#define HASHSIZE      128
-#define HASHKEY(pgno) ((pgno - 1) % HASHSIZE)
+#define MIN_HASHSIZE        128
+#define MAX_HASHSIZE        65536
+#define HASHKEY(pgno, size) ((uint32)((pgno)-1) & (uint32)((size)-1))
 
 /* Default pagesize and max # of pages to cache */
 #define DEF_PAGESIZE 8192
@@ -84,21 +85,18 @@
 
 #define MAX_PAGE_NUMBER 0xffffffff /* >= # of pages in a object */
 
-/* The BKT structures are the elements of the queues. */
-typedef struct _bkt {
-    H4_CIRCLEQ_ENTRY(_bkt) hq; /* hash queue */
-    H4_CIRCLEQ_ENTRY(_bkt) q;  /* lru queue */
-    void *page;                /* page */
-    int32 pgno;                /* page number */
-#define MCACHE_DIRTY  0x01     /* page needs to be written */
-#define MCACHE_PINNED 0x02     /* page is pinned into memory */
-    uint8 flags;               /* flags */
-} BKT;
+/* Page replacement policies, see mcache_set_policy() */
+#define MCACHE_LRU   0 /* evict the least recently used page */
+#define MCACHE_CLOCK 1 /* evict the first page not used since the clock hand last passed it */
+#define MCACHE_2Q    2 /* scan resistant: pages used once are evicted before pages used again */
+
+/* Default byte budget of the pool shared by caches, see mcache_set_pool() */
+#define DEF_POOL_BUDGET (64 * 1024 * 1024)
 
 /* The element structure for every page referenced(read/written) in object */
 typedef struct _lelem {
-    H4_CIRCLEQ_ENTRY(_lelem) hl; /* hash list */
-    int32 pgno;                  /* page number */
+    struct _lelem *hnext; /* next element on the hash chain */
+    int32          pgno;  /* page number */
 #ifdef STATISTICS
     int32 elemhit; /* # of hits on page */
 #endif
@@ -106,23 +104,62 @@ typedef struct _lelem {
 #define ELEM_WRITTEN 0x02
 #define ELEM_SYNC    0x03
     uint8 eflags; /* 1= read, 2=written, 3=synced */
+    int32 ghost;  /* 2Q: stamp of the page's eviction from the probation
+                     queue while it is remembered, 0 otherwise */
 } L_ELEM;
 
+/* The BKT structures are the elements of the hash chains and lru list. */
+typedef struct _bkt {
+    struct _bkt  *hnext;   /* next bucket on the hash chain */
+    struct _bkt **hprev;   /* link pointing to this bucket on the hash chain */
+    struct _bkt  *lnext;   /* next (more recently used) bucket on the lru list */
+    struct _bkt  *lprev;   /* previous (less recently used) bucket on the lru list */
+    L_ELEM       *elem;    /* element record of the page */
+    void         *page;    /* page */
+    int32         pgno;    /* page number */
+    uint16        pins;    /* mcache_get() calls not matched by mcache_put() yet */
+#define MCACHE_DIRTY      0x01 /* page needs to be written */
+#define MCACHE_PINNED     0x02 /* page is pinned into memory */
+#define MCACHE_REFERENCED 0x04 /* CLOCK: page was used since the hand passed it */
+#define MCACHE_PROBATION  0x08 /* 2Q: page is on the probation queue */
+    uint8 flags;               /* flags */
+} BKT;
+
 #define MCACHE_EXTEND                                                                                        \
     0x10 /* increase number of pages                                                                         \
         i.e extend object */
+#define MCACHE_NOREAD 0x20 /* mcache_get(): the page is overwritten whole, do not read it in */
 
 /* Memory pool cache */
 typedef struct MCACHE {
-    H4_CIRCLEQ_HEAD(_lqh, _bkt) lqh;                            /* lru queue head */
-    H4_CIRCLEQ_HEAD(_hqh, _bkt) hqh[HASHSIZE];                  /* hash queue array */
-    H4_CIRCLEQ_HEAD(_lhqh, _lelem) lhqh[HASHSIZE];              /* hash of all elements */
-    int32 curcache;                                             /* current num of cached pages */
-    int32 maxcache;                                             /* max number of cached pages */
-    int32 npages;                                               /* number of pages in the object */
-    int32 pagesize;                                             /* cache page size */
-    int32 object_id;                                            /* access ID of object this cache is for */
-    int32 object_size;                                          /* size of object to cache
+    BKT           *lru_head;                                    /* least recently used page */
+    BKT           *lru_tail;                                    /* most recently used page */
+    BKT           *a1_head;                                     /* 2Q: oldest page on probation */
+    BKT           *a1_tail;                                     /* 2Q: newest page on probation */
+    int32          na1;                                         /* 2Q: # of pages on probation */
+    L_ELEM       **ghosts;                                      /* 2Q: ring of pages recently evicted
+                                                                   from probation */
+    int32          nghosts;                                     /* 2Q: size of the ghost ring */
+    int32          ghost_seq;                                   /* 2Q: # of evictions from probation */
+    BKT           *hand;                                        /* CLOCK: next page to consider */
+    intn           policy;                                      /* page replacement policy */
+    int32          nhits;                                       /* # of mcache_get() hits */
+    int32          nmisses;                                     /* # of mcache_get() misses */
+    int32          nevictions;                                  /* # of pages evicted */
+    int32          weight;                                      /* share of the shared pool, 0 if
+                                                                   the cache is not in the pool */
+    struct MCACHE *pnext;                                       /* next cache in the shared pool */
+    struct MCACHE *pprev;                                       /* previous cache in the shared pool */
+    BKT          **hqh;                                         /* hash table of cached pages */
+    int32          hashsize;                                    /* # of chains in hqh */
+    L_ELEM       **lhqh;                                        /* hash table of all elements */
+    int32          lhashsize;                                   /* # of chains in lhqh */
+    int32          curcache;                                    /* current num of cached pages */
+    int32          maxcache;                                    /* max number of cached pages */
+    int32          npages;                                      /* number of pages in the object */
+    int32          pagesize;                                    /* cache page size */
+    int32          object_id;                                   /* access ID of object this cache is for */
+    int32          object_size;                                 /* size of object to cache
                                                                    must be multiple of pagesize for now */
     int32 (*pgin)(void *cookie, int32 pgno, void *page);        /* page in conversion routine */
     int32 (*pgout)(void *cookie, int32 pgno, const void *page); /* page out conversion routine*/
@@ -165,7 +202,7 @@ HDFLIBAPI void *mcache_new(MCACHE *mp,       /* IN: MCACHE cookie */
 
 HDFLIBAPI void *mcache_get(MCACHE *mp,   /* IN: MCACHE cookie */
                            int32   pgno, /* IN: page number */
-                           int32   flags /* IN: XXX not used? */);
+                           int32   flags /* IN: 0 or MCACHE_NOREAD */);
 
 HDFLIBAPI intn mcache_put(MCACHE *mp,   /* IN: MCACHE cookie */
                           void   *page, /* IN: page to put */
@@ -184,6 +221,20 @@ HDFLIBAPI int32 mcache_set_maxcache(MCACHE *mp, /* IN: MCACHE cookie */
 
 HDFLIBAPI int32 mcache_get_npages(MCACHE *mp /* IN: MCACHE cookie */);
 
+HDFLIBAPI intn mcache_is_cached(MCACHE *mp, /* IN: MCACHE cookie */
+                                int32   pgno /* IN: page number */);
+
+HDFLIBAPI intn mcache_set_policy(MCACHE *mp, /* IN: MCACHE cookie */
+                                 intn    policy /* IN: page replacement policy */);
+
+HDFLIBAPI intn mcache_get_stats(MCACHE            *mp,   /* IN: MCACHE cookie */
+                                hdf_cache_stats_t *stats /* OUT: hit, miss and eviction counts */);
+
+HDFLIBAPI intn mcache_set_pool(MCACHE *mp, /* IN: MCACHE cookie */
+                               int32   weight /* IN: share of the pool, 0 to leave it */);
+
+HDFLIBAPI int32 mcache_set_pool_budget(int32 nbytes /* IN: bytes shared by the pooled caches */);
+
 #ifdef STATISTICS
 HDFLIBAPI void mcache_stat(MCACHE *mp /* IN: MCACHE cookie */);
 #endif /* STATISTICS */
@@ -44,6 +44,9 @@
  *                  (used in annotation TBBTtree)
  *  ANIaddentry:  - add entry to corresponding annotation TBBTtree
  *  ANIcreate_ann_tree - create annotation TBBTtree
+ *  ANIobjindex  - make the index of the annotations of TYPE by tag/ref
+ *  ANIobjinsert - add an annotation to the index by tag/ref
+ *  ANIobjfind   - find the first annotation of a tag/ref in that index
  *  ANIfind:      - return annotation handle(ann_id) if found of given TYPE/ref
  *  ANInumann:    - return number of annotations that match TYPE/tag/ref
  *  ANIannlist:   - return list of handles(ann_id's) that match TYPE/tag/ref
@@ -101,6 +104,13 @@ static intn ANIstart(void);
 /* private destroy routine */
 static intn ANIdestroy(void);
 
+/* The initial size of the index of the annotations by tag/ref */
+#define AN_OBJ_START 64
+
+/* private routines of the index of the annotations by tag/ref */
+static void ANIobjinsert(filerec_t *file_rec, ann_type type, ANentry *ann_entry);
+static intn ANIobjfind(filerec_t *file_rec, ann_type type, uint16 elem_tag, uint16 elem_ref);
+
 /*-----------------------------------------------------------------------------
  *                          Internal Routines
  *---------------------------------------------------------------------------*/
@@ -373,9 +383,10 @@ ANIaddentry(int32    an_id, /* IN: annotation interface id */
         ann_entry->elmref = ann_ref;
     }
 
-    /* Add annotation entry to 'type' tree */
+    /* Add annotation entry to 'type' tree, and to its index by tag/ref */
     if (tbbtdins(file_rec->an_tree[type], ann_entry, ann_key) == NULL)
         HE_REPORT_GOTO("failed to insert annotation into 'type' tree", FAIL);
+    ANIobjinsert(file_rec, type, ann_entry);
 
     /* increment number of annotatiosn of 'type' */
     file_rec->an_num[type] += 1;
@@ -398,7 +409,9 @@ done:
    ANIcreate_ann_tree --  create an annotation tree of 'type' for given file
 
  DESCRIPTION
-   Creates either a label or description annotation TBBT tree.
+   Creates either a label or description annotation TBBT tree.  The
+   tag/refs of the items data annotations annotate are read in one batch
+   with Hreadv(); the text of the annotations is only read by ANreadann().
 
  RETURNS
    Number of annotations of 'type' in file if successful and
@@ -415,19 +428,21 @@ ANIcreate_ann_tree(int32    an_id,/* IN: annotation interface id */
                                          AN_FILE_LABEL for file labels,
                                          AN_FILE_DESC for file descriptions.*/)
 {
-    filerec_t *file_rec = NULL; /* file record pointer */
-    uint8      datadi[4];
-    int32      more_anns;
-    int32      aid = FAIL;
-    int32      nanns;
-    int32      i;
-    int32     *ann_key = NULL;
-    uint16     ann_tag;
-    uint16     ann_ref;
-    uint8     *dptr      = NULL;
-    ANentry   *ann_entry = NULL;
-    ANnode    *ann_node  = NULL;
-    intn       ret_value = SUCCEED;
+    filerec_t   *file_rec = NULL; /* file record pointer */
+    uint16      *refs     = NULL; /* refs of the annotations */
+    hdf_readv_t *reqs     = NULL; /* reads of their data tag/refs */
+    uint8       *datadi   = NULL; /* their data tag/refs */
+    int32        more_anns;
+    int32        aid = FAIL;
+    int32        nanns;
+    int32        i;
+    int32       *ann_key = NULL;
+    uint16       ann_tag;
+    uint16       ann_ref;
+    uint8       *dptr      = NULL;
+    ANentry     *ann_entry = NULL;
+    ANnode      *ann_node  = NULL;
+    intn         ret_value = SUCCEED;
 
     /* Clear error stack */
     HEclear();
@@ -468,38 +483,60 @@ ANIcreate_ann_tree(int32    an_id,/* IN: annotation interface id */
     }
 
     /* Get number of annotations of 'type' in file */
-    if ((nanns = Hnumber(an_id, ann_tag)) == 0) { /* ZERO annotations of 'type' in file */
+    if ((nanns = Hnumber(an_id, ann_tag)) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (nanns == 0) { /* ZERO annotations of 'type' in file */
         file_rec->an_num[type] = 0;
         ret_value              = file_rec->an_num[type];
         goto done; /* we are done */
     }
 
-    /* start read on 'type' annotations  in file
+    /* Collect the refs of the annotations of 'type' in the file
      * note that so far an_id == file_id */
+    if ((refs = (uint16 *)malloc((size_t)nanns * sizeof(uint16))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
     if ((aid = Hstartread(an_id, ann_tag, DFREF_WILDCARD)) == FAIL) {
         HE_REPORT_GOTO("Hstartread failed to read annotation", FAIL);
     }
     else
         more_anns = SUCCEED;
-
-    /* Process annotations of 'type' in file */
     for (i = 0; (i < nanns) && (more_anns != FAIL); i++) { /* see if annotation is there */
-        if (FAIL == Hinquire(aid, (int32 *)NULL, (uint16 *)NULL, &ann_ref, (int32 *)NULL, (int32 *)NULL,
-                             (int32 *)NULL, (int16 *)NULL,
-                             (int16 *)NULL)) { /* record what we found so far and return */
-            file_rec->an_num[type] = nanns;
-            ret_value              = FAIL;
-            goto done; /* we are done */
-        }
+        if (FAIL == Hinquire(aid, (int32 *)NULL, (uint16 *)NULL, &refs[i], (int32 *)NULL, (int32 *)NULL,
+                             (int32 *)NULL, (int16 *)NULL, (int16 *)NULL))
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
-        /* if data annotation, read data annotation tag/ref */
-        if (type != AN_FILE_LABEL && type != AN_FILE_DESC) {
-            if ((int32)FAIL == Hread(aid, (int32)4, datadi)) { /* record what we found so far and return */
-                file_rec->an_num[type] = nanns;
-                ret_value              = FAIL;
-                goto done; /* we are done */
-            }
+        /* set read on next annotation */
+        more_anns = Hnextread(aid, ann_tag, DFREF_WILDCARD, DF_CURRENT);
+    } /* end for "more_anns" */
+    nanns = i;
+
+    /* Finish access*/
+    if (FAIL == Hendaccess(aid))
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    aid = FAIL;
+
+    /* if data annotations, read the tag/ref of the data they annotate,
+       in one batch; their text is only read by ANreadann() */
+    if (type != AN_FILE_LABEL && type != AN_FILE_DESC) {
+        if ((reqs = (hdf_readv_t *)calloc((size_t)nanns, sizeof(hdf_readv_t))) == NULL ||
+            (datadi = (uint8 *)malloc((size_t)nanns * 4)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        for (i = 0; i < nanns; i++) {
+            reqs[i].tag    = ann_tag;
+            reqs[i].ref    = refs[i];
+            reqs[i].length = 4;
+            reqs[i].buf    = &datadi[4 * i];
         }
+        if (Hreadv(an_id, nanns, reqs) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        for (i = 0; i < nanns; i++)
+            if (reqs[i].nread != 4)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+    }
+
+    /* Process annotations of 'type' in file */
+    for (i = 0; i < nanns; i++) {
+        ann_ref = refs[i];
 
         /* allocate space for key */
         if ((ann_key = (int32 *)malloc(sizeof(int32))) == NULL)
@@ -529,10 +566,11 @@ ANIcreate_ann_tree(int32    an_id,/* IN: annotation interface id */
         ann_entry->ann_id = HAregister_atom(ANIDGROUP, ann_node);
         if (FAIL == ann_entry->ann_id)
             HE_REPORT_GOTO("failed to insert annotation into ann_id Group", FAIL);
+        ann_node = NULL;
 
         /* Check if data annotation to decode data tag/ref */
         if (type != AN_FILE_LABEL && type != AN_FILE_DESC) {
-            dptr = (uint8 *)&(datadi[0]);
+            dptr = &datadi[4 * i];
             UINT16DECODE(dptr, ann_entry->elmtag);
             UINT16DECODE(dptr, ann_entry->elmref);
         }
@@ -544,16 +582,14 @@ ANIcreate_ann_tree(int32    an_id,/* IN: annotation interface id */
         /* Add annotation entry to 'type' tree */
         if (tbbtdins(file_rec->an_tree[type], ann_entry, ann_key) == NULL)
             HE_REPORT_GOTO("failed to insert annotation into 'type' tree", FAIL);
+        file_rec->an_num[type]++;
+    } /* end for */
 
-        /* set read on next annotation */
-        more_anns = Hnextread(aid, ann_tag, DFREF_WILDCARD, DF_CURRENT);
-    } /* end for "more_anns" */
-
-    /* Finish access*/
-    if (FAIL != aid) {
-        if (FAIL == Hendaccess(aid))
-            HGOTO_ERROR(DFE_INTERNAL, FAIL);
-    }
+    /* the entries belong to the tree, which is mostly searched from now on */
+    ann_key   = NULL;
+    ann_entry = NULL;
+    if (tbbtdindex(file_rec->an_tree[type]) == FAIL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
     /* set return value */
     ret_value = file_rec->an_num[type] = nanns;
@@ -566,10 +602,161 @@ done:
         if (FAIL != aid)
             Hendaccess(aid);
     }
+    free(refs);
+    free(reqs);
+    free(datadi);
 
     return ret_value;
 } /* ANIcreate_ann_tree */
 
+/* ------------------------------- ANIobjcmp --------------------------------
+ NAME
+        ANIobjcmp -- compare two annotation entries by tag/ref
+
+ DESCRIPTION
+    Orders annotation entries by the tag/ref of the item they annotate.
+    The annotations of one item keep the order of the annotation tree,
+    i.e. by decreasing annotation ref, see ANIanncmp().  Used by qsort()
+    to sort the index of the annotations by tag/ref.
+
+ RETURNS
+    Returns <0 if i comes before j, 0 if i=j and >0 otherwise
+
+--------------------------------------------------------------------------- */
+static int
+ANIobjcmp(const void *i, /* IN: pointer to an annotation entry */
+          const void *j /* IN: pointer to an annotation entry */)
+{
+    const ANentry *ei = *(ANentry *const *)i;
+    const ANentry *ej = *(ANentry *const *)j;
+
+    if (ei->elmtag != ej->elmtag)
+        return ei->elmtag < ej->elmtag ? -1 : 1;
+    if (ei->elmref != ej->elmref)
+        return ei->elmref < ej->elmref ? -1 : 1;
+    if (ei->annref != ej->annref)
+        return ei->annref > ej->annref ? -1 : 1;
+    return 0;
+} /* ANIobjcmp */
+
+/*--------------------------------------------------------------------------
+ NAME
+   ANIobjindex -- make the index of the annotations of 'type' by tag/ref
+
+ DESCRIPTION
+   Sorts the entries of the annotation tree of 'type' by the tag/ref of
+   the item they annotate, so that the annotations of an item are found
+   with a binary search instead of a walk of the whole tree.  The index
+   is made the first time it is needed and kept up to date by
+   ANIaddentry() until ANend().
+
+ RETURNS
+   SUCCEED if successful and FAIL (-1) otherwise
+
+ -------------------------------------------------------------------------*/
+static intn
+ANIobjindex(filerec_t *file_rec, /* IN: file record */
+            ann_type   type /* IN: annotation type */)
+{
+    TBBT_NODE *entry = NULL;
+    ANentry  **list  = NULL;
+    intn       max;
+    intn       n         = 0;
+    intn       ret_value = SUCCEED;
+
+    if (file_rec->an_obj[type] != NULL)
+        HGOTO_DONE(SUCCEED);
+
+    max = MAX(file_rec->an_num[type], AN_OBJ_START);
+    if ((list = (ANentry **)malloc((size_t)max * sizeof(ANentry *))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    for (entry = tbbtfirst((TBBT_NODE *)*(file_rec->an_tree[type])); entry != NULL && n < max;
+         entry = tbbtnext(entry))
+        list[n++] = (ANentry *)entry->data;
+    qsort(list, (size_t)n, sizeof(ANentry *), ANIobjcmp);
+
+    file_rec->an_obj[type]     = list;
+    file_rec->an_obj_max[type] = max;
+
+done:
+    return ret_value;
+} /* ANIobjindex */
+
+/*--------------------------------------------------------------------------
+ NAME
+   ANIobjinsert -- add an annotation to the index by tag/ref
+
+ DESCRIPTION
+   Inserts a new entry of the annotation tree of 'type' in its index by
+   tag/ref, which holds the an_num[type] entries before it.  An index
+   that cannot grow is dropped, to be made again when next needed.
+
+ RETURNS
+   None
+
+ -------------------------------------------------------------------------*/
+static void
+ANIobjinsert(filerec_t *file_rec,  /* IN: file record */
+             ann_type   type,      /* IN: annotation type */
+             ANentry   *ann_entry /* IN: entry added to the annotation tree */)
+{
+    ANentry **list = file_rec->an_obj[type];
+    intn      n    = file_rec->an_num[type];
+    intn      pos;
+
+    if (list == NULL)
+        return;
+    if (n == file_rec->an_obj_max[type]) {
+        if ((list = (ANentry **)realloc(list, 2 * (size_t)n * sizeof(ANentry *))) == NULL) {
+            free(file_rec->an_obj[type]);
+            file_rec->an_obj[type] = NULL;
+            return;
+        }
+        file_rec->an_obj[type]     = list;
+        file_rec->an_obj_max[type] = 2 * n;
+    }
+
+    /* new annotations mostly have the largest ref, and come first */
+    pos = ANIobjfind(file_rec, type, ann_entry->elmtag, ann_entry->elmref);
+    memmove(&list[pos + 1], &list[pos], (size_t)(n - pos) * sizeof(ANentry *));
+    list[pos] = ann_entry;
+} /* ANIobjinsert */
+
+/*--------------------------------------------------------------------------
+ NAME
+   ANIobjfind -- find the first annotation of a tag/ref in the index
+
+ DESCRIPTION
+   Binary search of the index by tag/ref of the annotations of 'type',
+   which must have been made with ANIobjindex().
+
+ RETURNS
+   The position of the first entry of the index for the item elem_tag/
+   elem_ref or after it, an_num[type] if there is none.
+
+ -------------------------------------------------------------------------*/
+static intn
+ANIobjfind(filerec_t *file_rec, /* IN: file record */
+           ann_type   type,     /* IN: annotation type */
+           uint16     elem_tag, /* IN: tag of item of which this is annotation */
+           uint16     elem_ref /* IN: ref of item of which this is annotation */)
+{
+    ANentry **list = file_rec->an_obj[type];
+    intn      lo   = 0;
+    intn      hi   = file_rec->an_num[type];
+
+    while (lo < hi) {
+        intn mid = lo + (hi - lo) / 2;
+
+        if (list[mid]->elmtag < elem_tag || (list[mid]->elmtag == elem_tag && list[mid]->elmref < elem_ref))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+} /* ANIobjfind */
+
 #if NOT_USED_YET
 /*--------------------------------------------------------------------------
  NAME
@@ -664,9 +851,9 @@ ANInumann(int32    an_id,  /* IN: annotation interface id */
           uint16 elem_ref /* IN: ref of item of which this is annotation */)
 {
     filerec_t *file_rec  = NULL; /* file record pointer */
-    TBBT_NODE *entry     = NULL;
-    ANentry   *ann_entry = NULL;
+    ANentry  **list      = NULL;
     intn       nanns     = 0;
+    intn       i;
     intn       ret_value = SUCCEED;
 
     /* Clear error stack */
@@ -683,13 +870,13 @@ ANInumann(int32    an_id,  /* IN: annotation interface id */
             HGOTO_ERROR(DFE_BADCALL, FAIL);
     }
 
-    /* Traverse the list looking for a match */
-    for (entry = tbbtfirst((TBBT_NODE *)*(file_rec->an_tree[type])); entry != NULL; entry = tbbtnext(entry)) {
-        ann_entry = (ANentry *)entry->data; /* get annotation entry from node */
-        if ((ann_entry->elmref == elem_ref) && (ann_entry->elmtag == elem_tag)) {
-            nanns++; /* increment ref counter if match */
-        }
-    }
+    /* Look the tag/ref up in the index of the tree */
+    if (ANIobjindex(file_rec, type) == FAIL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    list = file_rec->an_obj[type];
+    for (i = ANIobjfind(file_rec, type, elem_tag, elem_ref);
+         i < file_rec->an_num[type] && list[i]->elmtag == elem_tag && list[i]->elmref == elem_ref; i++)
+        nanns++; /* increment ref counter if match */
 
     /* return number of annotation references found for tag/ref */
     ret_value = nanns;
@@ -725,9 +912,9 @@ ANIannlist(int32    an_id,  /* IN: annotation interface id */
            int32  ann_list[] /* OUT: array of ann_id's that match criteria. */)
 {
     filerec_t *file_rec  = NULL; /* file record pointer */
-    TBBT_NODE *entry     = NULL;
-    ANentry   *ann_entry = NULL;
+    ANentry  **list      = NULL;
     intn       nanns     = 0;
+    intn       i;
     intn       ret_value = SUCCEED;
 
     /* Clear error stack */
@@ -744,14 +931,13 @@ ANIannlist(int32    an_id,  /* IN: annotation interface id */
             HGOTO_ERROR(DFE_BADCALL, FAIL);
     }
 
-    /* Traverse the list looking for a match */
-    for (entry = tbbtfirst((TBBT_NODE *)*(file_rec->an_tree[type])); entry != NULL; entry = tbbtnext(entry)) {
-        ann_entry = (ANentry *)entry->data; /* get annotation entry from node */
-        if ((ann_entry->elmref == elem_ref) &&
-            (ann_entry->elmtag == elem_tag)) { /* save ref of ann match in list */
-            ann_list[nanns++] = ann_entry->ann_id;
-        }
-    }
+    /* Look the tag/ref up in the index of the tree */
+    if (ANIobjindex(file_rec, type) == FAIL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    list = file_rec->an_obj[type];
+    for (i = ANIobjfind(file_rec, type, elem_tag, elem_ref);
+         i < file_rec->an_num[type] && list[i]->elmtag == elem_tag && list[i]->elmref == elem_ref; i++)
+        ann_list[nanns++] = list[i]->ann_id; /* save ref of ann match in list */
 
     /* return number of annotation id's found for tag/ref */
     ret_value = nanns;
@@ -1313,6 +1499,7 @@ ANend(int32 an_id /* IN: Annotation ID of file to close */)
     TBBT_NODE *aentry    = NULL;
     ANentry   *ann_entry = NULL;
     ANnode    *ann_node  = NULL;
+    intn       i;
     int32      ret_value = SUCCEED;
 
     /* Clear error stack */
@@ -1397,6 +1584,13 @@ ANend(int32 an_id /* IN: Annotation ID of file to close */)
         tbbtdfree(file_rec->an_tree[AN_DATA_DESC], ANfreedata, ANfreekey);
     }
 
+    /* free the indices by tag/ref of the trees */
+    for (i = 0; i < 4; i++) {
+        free(file_rec->an_obj[i]);
+        file_rec->an_obj[i]     = NULL;
+        file_rec->an_obj_max[i] = 0;
+    }
+
     /* re-initialize everything in file record for annotations so
        the a ANstart() works. */
     file_rec->an_tree[AN_DATA_LABEL] = NULL;
@@ -82,6 +82,8 @@ intn GRwriteimage(int32 riid,int32 start[2],int32 stride[2],int32 count[2],void
         dimension support)
 intn GRreadimage(int32 riid,int32 start[2],int32 stride[2],int32 count[2],void * data)
     - Read image data from an RI.  Partial reads and subsampling are allowed.
+intn GRprefetch(int32 riid,int32 start[2],int32 count[2])
+    - Announce a read of part of an RI, so its data is read from disk ahead.
 intn GRendaccess(int32 riid)
     - End access to an RI.
 
@@ -138,6 +140,8 @@ int32 GRattrinfo(int32 dimid|riid|grid,int32 index,char *name,int32 *attr_nt,int
     - Get attribute information for an object.
 intn GRgetattr(int32 dimid|riid|grid,int32 index,void * data)
     - Read an attribute for an object.
+int32 GRreadallattrs(int32 riid|grid,hdf_attr_t attrs[],int32 max_attrs,void *arena,int32 *arena_size)
+    - Read all the attributes of an object at once.
 int32 GRfindattr(int32 dimid|riid|grid,char *name)
     - Get the index of an attribute with a given name for an object.
 
@@ -147,6 +151,13 @@ Chunking Functions:
      GRwritechunk   -- write the specified chunk to the GR
      GRreadchunk    -- read the specified chunk to the GR
      GRsetchunkcache -- maximum number of chunks to cache
+     GRsetchunkthreads -- number of threads used to code chunks
+
+Overview Functions:
+intn GRbuildoverviews(int32 riid,intn nlevels)
+    - Builds reduced resolution copies of an RI.
+intn GRreadimage_level(int32 riid,intn level,int32 start[2],int32 stride[2],int32 count[2],void * data)
+    - Reads image data from a level of an RI's overviews.
 
 LOCAL ROUTINES
 intn GRIil_convert(const void * inbuf,gr_interlace_t inil,void * outbuf,
@@ -204,6 +215,12 @@ static intn GRIgetaid(ri_info_t *img_ptr, intn acc_perm);
 
 static intn GRIisspecial_type(int32 file_id, uint16 tag, uint16 ref);
 
+static void GRIil_split_line(const uint8 *pixels, uint8 *planes, const size_t *lines, int32 n, int32 ncomp,
+                             uintn comp_size);
+
+static void GRIil_join_line(const uint8 *planes, const size_t *lines, uint8 *pixels, int32 n, int32 ncomp,
+                            uintn comp_size);
+
 #ifdef H4_HAVE_LIBSZ /* we have the library */
 static intn GRsetup_szip_parms(ri_info_t *ri_ptr, comp_info *c_info, int32 *cdims);
 #endif
@@ -532,6 +549,129 @@ Decode_diminfo(uint8 *p, dim_info_t *dim_info)
     UINT16DECODE(p, dim_info->comp_ref);
 } /* Decode_diminfo */
 
+/* -------------------------- GRIimgcmp ------------------------ */
+/*
+   Orders image_info_structs by the ref of the image, and those of the same
+   ref by their place in the list, i.e. in the order they were found.  Used
+   by qsort() to sort the list of pointers to them in GRIget_image_list().
+ */
+static int
+GRIimgcmp(const void *i, const void *j)
+{
+    const imginfo_t *ii = *(imginfo_t *const *)i;
+    const imginfo_t *ij = *(imginfo_t *const *)j;
+
+    if (ii->img_ref != ij->img_ref)
+        return ii->img_ref < ij->img_ref ? -1 : 1;
+    if (ii != ij)
+        return ii < ij ? -1 : 1;
+    return 0;
+} /* end GRIimgcmp() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    GRIget_lattrs
+ PURPOSE
+    Read in the local attributes of an image the first time they are needed
+ USAGE
+    intn GRIget_lattrs(ri_ptr)
+        ri_info_t *ri_ptr;          IN: image to read the attributes of
+ RETURNS
+    Return SUCCEED/FAIL
+ DESCRIPTION
+    GRstart() only notes that an image of the file has local attributes,
+    see GRIget_image_list().  The first routine looking at the local
+    attribute tree or count of the image calls this to attach the vdatas of
+    the attributes and put their information into the tree, so that opening
+    a file with many images does not read the attributes of all of them.
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+intn
+GRIget_lattrs(ri_info_t *ri_ptr)
+{
+    int32 file_id;                   /* file the image is in */
+    int32 img_key = FAIL;            /* Vgroup key of the image */
+    int32 img_tag, img_ref;          /* tag/ref in the Vgroup */
+    int32 nobjs;                     /* number of tag/refs in the Vgroup */
+    char  textbuf[VGNAMELENMAX + 1]; /* buffer to store a generated name in */
+    intn  j;                         /* local counting variable */
+    intn  ret_value = SUCCEED;
+
+    if (!ri_ptr->lattr_pending)
+        HGOTO_DONE(SUCCEED);
+    ri_ptr->lattr_pending = FALSE;
+
+    file_id = ri_ptr->gr_ptr->hdf_file_id;
+    if ((img_key = Vattach(file_id, (int32)ri_ptr->ri_ref, "r")) == FAIL)
+        HGOTO_ERROR(DFE_CANTATTACH, FAIL);
+    if ((nobjs = Vntagrefs(img_key)) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    for (j = 0; j < nobjs; j++) {
+        at_info_t *new_attr; /* attr to add to the local attr set */
+        int32      at_key;   /* VData key for the attribute */
+
+        if (Vgettagref(img_key, j, &img_tag, &img_ref) == FAIL || img_tag != DFTAG_VH)
+            continue;
+
+        if ((new_attr = (at_info_t *)malloc(sizeof(at_info_t))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        new_attr->ref           = (uint16)img_ref;
+        new_attr->index         = ri_ptr->lattr_count;
+        new_attr->data_modified = FALSE;
+        new_attr->new_at        = FALSE;
+        new_attr->data          = NULL;
+        if ((at_key = VSattach(file_id, (int32)img_ref, "r")) != FAIL) {
+            char *fname;
+
+            /* Make certain the attribute only has one field */
+            if (VFnfields(at_key) != 1) {
+                VSdetach(at_key);
+                free(new_attr);
+                continue;
+            }
+            new_attr->nt  = VFfieldtype(at_key, 0);
+            new_attr->len = VFfieldorder(at_key, 0);
+            if (new_attr->len == 1)
+                new_attr->len = VSelts(at_key);
+
+            /* Get the name of the attribute */
+            if ((fname = VFfieldname(at_key, 0)) == NULL) {
+                sprintf(textbuf, "Attribute #%d", (int)new_attr->index);
+                if ((new_attr->name = (char *)malloc(strlen(textbuf) + 1)) == NULL) {
+                    VSdetach(at_key);
+                    free(new_attr);
+                    HGOTO_ERROR(DFE_NOSPACE, FAIL);
+                }
+                strcpy(new_attr->name, textbuf);
+            }
+            else {
+                if ((new_attr->name = (char *)malloc(strlen(fname) + 1)) == NULL) {
+                    VSdetach(at_key);
+                    free(new_attr);
+                    HGOTO_ERROR(DFE_NOSPACE, FAIL);
+                }
+                strcpy(new_attr->name, fname);
+            }
+
+            tbbtdins(ri_ptr->lattree, new_attr, NULL); /* insert the attr instance in B-tree */
+
+            VSdetach(at_key);
+        } /* end if */
+
+        ri_ptr->lattr_count++;
+    } /* end for */
+
+done:
+    if (img_key != FAIL)
+        Vdetach(img_key);
+
+    return ret_value;
+} /* end GRIget_lattrs() */
+
 /*--------------------------------------------------------------------------
  NAME
     GRIget_image_list
@@ -562,16 +702,17 @@ Decode_diminfo(uint8 *p, dim_info_t *dim_info)
 static intn
 GRIget_image_list(int32 file_id, gr_info_t *gr_ptr)
 {
-    uint16     gr_ref;                          /* ref # of the Vgroup containing new-style RIs */
-    intn       curr_image;                      /* current image gathering information about */
-    intn       nimages;                         /* total number of potential images */
-    intn       noldimages;                      /* count of old imgs returned by Get_oldimgs */
-    int32      nri, nci, nri8, nci8, nii8, nvg; /* number of RIs, CIs, RI8s, CI8s & II8s & Vgroups */
-    uint16     find_tag, find_ref;              /* storage for tag/ref pairs found */
-    int32      find_off, find_len;              /* storage for offset/lengths of tag/refs found */
-    imginfo_t *img_info;                        /* image info list */
-    intn       i, j;                            /* local counting variable */
-    intn       ret_value = SUCCEED;
+    uint16      gr_ref;                          /* ref # of the Vgroup containing new-style RIs */
+    intn        curr_image;                      /* current image gathering information about */
+    intn        nimages;                         /* total number of potential images */
+    intn        noldimages;                      /* count of old imgs returned by Get_oldimgs */
+    int32       nri, nci, nri8, nci8, nii8, nvg; /* number of RIs, CIs, RI8s, CI8s & II8s & Vgroups */
+    uint16      find_tag, find_ref;              /* storage for tag/ref pairs found */
+    int32       find_off, find_len;              /* storage for offset/lengths of tag/refs found */
+    imginfo_t  *img_info;                        /* image info list */
+    imginfo_t **img_list = NULL;                 /* image info list sorted by ref */
+    intn        i, j;                            /* local counting variable */
+    intn        ret_value = SUCCEED;
 
     HEclear();
 
@@ -771,61 +912,76 @@ GRIget_image_list(int32 file_id, gr_info_t *gr_ptr)
                                +-----------------+-----------------+--------+
     */
 
+    /* Only images with the same ref can be duplicates, so sort the list by
+       ref and compare each image with those of its run of equal refs, in
+       the order of the list as before */
+    if (curr_image > 0 &&
+        (img_list = (imginfo_t **)malloc((size_t)curr_image * sizeof(imginfo_t *))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    for (i = 0; i < curr_image; i++)
+        img_list[i] = &img_info[i];
+    qsort(img_list, (size_t)curr_image, sizeof(imginfo_t *), GRIimgcmp);
+
     for (i = 0; i < curr_image; i++) { /* go through the images looking for duplicates */
-        if (img_info[i].img_tag != DFTAG_NULL)
-            for (j = i + 1; j < curr_image; j++) {
-                /* if their refs are different, they're not duplicate, skip */
-                if (img_info[i].img_ref == img_info[j].img_ref)
-                    if (img_info[j].img_tag != DFTAG_NULL) {
-                        /* If the element is special, get its type, to allow
-                           linked block or chunked images to go into the if
-                           statement below in order for the duplicate image be
-                           eliminated - bug #814, BMR Feb, 2005 */
-                        intn special_type =
-                            GRIisspecial_type(file_id, img_info[i].img_tag, img_info[i].img_ref);
-
-                        if (((img_info[i].offset != INVALID_OFFSET && img_info[i].offset != 0) &&
-                             img_info[i].offset == img_info[j].offset) ||
-                            (img_info[i].offset == 0 &&
-                             (special_type == SPECIAL_LINKED || special_type == SPECIAL_CHUNKED))) {
-                            /* eliminate the oldest tag from the match */
-                            switch (img_info[i].img_tag) {
-                                case DFTAG_RI:
-                                case DFTAG_CI: /* Newer style raster image, found in RIG & Vgroup */
-                                    if (img_info[j].grp_tag == DFTAG_RIG) {
-                                        img_info[j].img_tag = DFTAG_NULL;
-                                        if (img_info[i].grp_tag == DFTAG_VG)
-                                            img_info[i].aux_ref = img_info[j].grp_ref;
-                                    } /* end if */
-                                    else {
-                                        if (img_info[i].grp_tag == DFTAG_VG)
-                                            img_info[j].img_tag = DFTAG_NULL;
-                                        else {
-                                            img_info[j].img_tag = DFTAG_NULL;
-                                            if (img_info[i].grp_tag == DFTAG_RIG)
-                                                img_info[j].aux_ref = img_info[i].grp_ref;
-                                        } /* end else */
-                                    }     /* end else */
-                                    break;
+        imginfo_t *imgi         = img_list[i];
+        intn       special_type = -1; /* not looked up yet */
 
-                                case DFTAG_RI8:
-                                case DFTAG_CI8:
-                                case DFTAG_II8: /* Eldest style raster image, no grouping */
-                                    if (img_info[j].img_tag != DFTAG_RI8 &&
-                                        img_info[j].img_tag != DFTAG_CI8 && img_info[j].img_tag != DFTAG_II8)
-                                        img_info[i].img_tag = DFTAG_NULL;
-                                    else
-                                        img_info[j].img_tag = DFTAG_NULL;
-                                    break;
+        if (imgi->img_tag != DFTAG_NULL)
+            for (j = i + 1; j < curr_image && img_list[j]->img_ref == imgi->img_ref; j++) {
+                imginfo_t *imgj = img_list[j];
 
-                                default:
-                                    /* an image which was eliminated from the list of images */
-                                    break;
-                            } /* end switch */
-                        }     /* end if */
-                    }         /* end if */
-            }                 /* end for */
-    }                         /* end for go through the images looking for duplicates */
+                if (imgj->img_tag == DFTAG_NULL)
+                    continue;
+
+                /* If the element is special, get its type, to allow
+                   linked block or chunked images to go into the if
+                   statement below in order for the duplicate image be
+                   eliminated - bug #814, BMR Feb, 2005 */
+                if (imgi->offset == 0 && special_type == -1)
+                    special_type = GRIisspecial_type(file_id, imgi->img_tag, imgi->img_ref);
+
+                if (((imgi->offset != INVALID_OFFSET && imgi->offset != 0) && imgi->offset == imgj->offset) ||
+                    (imgi->offset == 0 &&
+                     (special_type == SPECIAL_LINKED || special_type == SPECIAL_CHUNKED))) {
+                    /* eliminate the oldest tag from the match */
+                    switch (imgi->img_tag) {
+                        case DFTAG_RI:
+                        case DFTAG_CI: /* Newer style raster image, found in RIG & Vgroup */
+                            if (imgj->grp_tag == DFTAG_RIG) {
+                                imgj->img_tag = DFTAG_NULL;
+                                if (imgi->grp_tag == DFTAG_VG)
+                                    imgi->aux_ref = imgj->grp_ref;
+                            } /* end if */
+                            else {
+                                if (imgi->grp_tag == DFTAG_VG)
+                                    imgj->img_tag = DFTAG_NULL;
+                                else {
+                                    imgj->img_tag = DFTAG_NULL;
+                                    if (imgi->grp_tag == DFTAG_RIG)
+                                        imgj->aux_ref = imgi->grp_ref;
+                                } /* end else */
+                            }     /* end else */
+                            break;
+
+                        case DFTAG_RI8:
+                        case DFTAG_CI8:
+                        case DFTAG_II8: /* Eldest style raster image, no grouping */
+                            if (imgj->img_tag != DFTAG_RI8 && imgj->img_tag != DFTAG_CI8 &&
+                                imgj->img_tag != DFTAG_II8)
+                                imgi->img_tag = DFTAG_NULL;
+                            else
+                                imgj->img_tag = DFTAG_NULL;
+                            break;
+
+                        default:
+                            /* an image which was eliminated from the list of images */
+                            break;
+                    } /* end switch */
+                }     /* end if */
+            }         /* end for */
+    }                 /* end for go through the images looking for duplicates */
+    free(img_list);
+    img_list = NULL;
 
     /* Ok, now sort through the file for information about each image found */
     for (i = 0; i < curr_image; i++) {
@@ -836,7 +992,6 @@ GRIget_image_list(int32 file_id, gr_info_t *gr_ptr)
                     ri_info_t *new_image;                 /* ptr to the image to read in */
                     int32      img_key;                   /* Vgroup key of an image */
                     int32      img_tag, img_ref;          /* image tag/ref in the Vgroup */
-                    char       textbuf[VGNAMELENMAX + 1]; /* buffer to store the name in */
                     uint8      ntstring[4];               /* buffer to store NT info */
                     uint8      GRtbuf[64];                /* local buffer for reading RIG info */
 
@@ -974,63 +1129,9 @@ GRIget_image_list(int32 file_id, gr_info_t *gr_ptr)
                                     break;
                                 } /* end case DFTAG_ID */
 
-                                case DFTAG_VH: /* Attribute information */
-                                {
-                                    at_info_t *new_attr; /* attr to add to the local attr set */
-                                    int32      at_key;   /* VData key for the attribute */
-
-                                    if ((new_attr = (at_info_t *)malloc(sizeof(at_info_t))) == NULL)
-                                        HGOTO_ERROR(DFE_NOSPACE, FAIL);
-                                    new_attr->ref           = (uint16)img_ref;
-                                    new_attr->index         = new_image->lattr_count;
-                                    new_attr->data_modified = FALSE;
-                                    new_attr->new_at        = FALSE;
-                                    new_attr->data          = NULL;
-                                    if ((at_key = VSattach(file_id, (int32)img_ref, "r")) != FAIL) {
-                                        char *fname;
-
-                                        /* Make certain the attribute only has one field */
-                                        if (VFnfields(at_key) != 1) {
-                                            VSdetach(at_key);
-                                            free(new_attr);
-                                            break;
-                                        }
-                                        new_attr->nt  = VFfieldtype(at_key, 0);
-                                        new_attr->len = VFfieldorder(at_key, 0);
-                                        if (new_attr->len == 1)
-                                            new_attr->len = VSelts(at_key);
-
-                                        /* Get the name of the attribute */
-                                        if ((fname = VFfieldname(at_key, 0)) == NULL) {
-                                            sprintf(textbuf, "Attribute #%d", (int)new_attr->index);
-                                            if ((new_attr->name = (char *)malloc(strlen(textbuf) + 1)) ==
-                                                NULL) {
-                                                VSdetach(at_key);
-                                                free(new_attr);
-                                                HGOTO_ERROR(DFE_NOSPACE, FAIL);
-                                            }
-                                            strcpy(new_attr->name, textbuf);
-                                        }
-                                        else {
-                                            if ((new_attr->name = (char *)malloc(strlen(fname) + 1)) ==
-                                                NULL) {
-                                                VSdetach(at_key);
-                                                free(new_attr);
-                                                HGOTO_ERROR(DFE_NOSPACE, FAIL);
-                                            }
-                                            strcpy(new_attr->name, fname);
-                                        }
-
-                                        tbbtdins(new_image->lattree, new_attr,
-                                                 NULL); /* insert the attr instance in B-tree */
-
-                                        VSdetach(at_key);
-                                    } /* end if */
-
-                                    new_image->lattr_count++;
-
+                                case DFTAG_VH: /* Attribute information, read when first needed */
+                                    new_image->lattr_pending = TRUE;
                                     break;
-                                } /* end case DFTAG_VH */
 
                                 default: /* Unknown tag */
                                     break;
@@ -1279,9 +1380,97 @@ GRIget_image_list(int32 file_id, gr_info_t *gr_ptr)
     free(img_info); /* free image info structures */
 
 done:
+    free(img_list);
+
     return ret_value;
 } /* end GRIget_image_list() */
 
+/* Copy loops for one line of pixels, instantiated with constant numbers and
+   sizes of components so that compilers can unroll and vectorize them */
+#define GRI_SPLIT(nc, size)                                                                                  \
+    for (j = 0; j < n; j++)                                                                                  \
+        for (k = 0; k < (nc); k++, pixels += (size))                                                         \
+            memcpy(planes + lines[k] + (size_t)j * (size), pixels, (size));
+#define GRI_JOIN(nc, size)                                                                                   \
+    for (j = 0; j < n; j++)                                                                                  \
+        for (k = 0; k < (nc); k++, pixels += (size))                                                         \
+            memcpy(pixels, planes + lines[k] + (size_t)j * (size), (size));
+
+/*--------------------------------------------------------------------------
+ NAME
+    GRIil_split_line
+ PURPOSE
+    Split a line of pixel interlaced data into one line per component.
+ USAGE
+    void GRIil_split_line(pixels,planes,lines,n,ncomp,comp_size)
+        const uint8 *pixels;        IN: the pixel interlaced line
+        uint8 *planes;              IN: buffer of the component lines
+        const size_t *lines;        IN: offset of each component's line in planes
+        int32 n;                    IN: number of pixels in the line
+        int32 ncomp;                IN: number of components per pixel
+        uintn comp_size;            IN: size of a component in bytes
+ RETURNS
+    none
+ DESCRIPTION
+    3 and 4 component images of 8 and 16-bit components have their own
+    loops, other images are copied a component at a time.
+--------------------------------------------------------------------------*/
+static void
+GRIil_split_line(const uint8 *pixels, uint8 *planes, const size_t *lines, int32 n, int32 ncomp,
+                 uintn comp_size)
+{
+    int32 j;
+    intn  k;
+
+    if (ncomp == 3 && comp_size == 1)
+        GRI_SPLIT(3, 1)
+    else if (ncomp == 3 && comp_size == 2)
+        GRI_SPLIT(3, 2)
+    else if (ncomp == 4 && comp_size == 1)
+        GRI_SPLIT(4, 1)
+    else if (ncomp == 4 && comp_size == 2)
+        GRI_SPLIT(4, 2)
+    else
+        GRI_SPLIT(ncomp, comp_size)
+} /* end GRIil_split_line() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    GRIil_join_line
+ PURPOSE
+    Join one line per component into a line of pixel interlaced data.
+ USAGE
+    void GRIil_join_line(planes,lines,pixels,n,ncomp,comp_size)
+        const uint8 *planes;        IN: buffer of the component lines
+        const size_t *lines;        IN: offset of each component's line in planes
+        uint8 *pixels;              IN: where the pixel interlaced line goes
+        int32 n;                    IN: number of pixels in the line
+        int32 ncomp;                IN: number of components per pixel
+        uintn comp_size;            IN: size of a component in bytes
+ RETURNS
+    none
+ DESCRIPTION
+    The reverse of GRIil_split_line().
+--------------------------------------------------------------------------*/
+static void
+GRIil_join_line(const uint8 *planes, const size_t *lines, uint8 *pixels, int32 n, int32 ncomp,
+                uintn comp_size)
+{
+    int32 j;
+    intn  k;
+
+    if (ncomp == 3 && comp_size == 1)
+        GRI_JOIN(3, 1)
+    else if (ncomp == 3 && comp_size == 2)
+        GRI_JOIN(3, 2)
+    else if (ncomp == 4 && comp_size == 1)
+        GRI_JOIN(4, 1)
+    else if (ncomp == 4 && comp_size == 2)
+        GRI_JOIN(4, 2)
+    else
+        GRI_JOIN(ncomp, comp_size)
+} /* end GRIil_join_line() */
+
 /*--------------------------------------------------------------------------
  NAME
     GRIil_convert
@@ -1301,7 +1490,8 @@ done:
  DESCRIPTION
     This routine converts between PIXEL, LINE & COMPONENT interlacing schemes.
     All data written to the disk is written in PIXEL interlacing and converted
-    to/from the user's buffers.
+    to/from the user's buffers.  Conversions to and from PIXEL interlace go a
+    line at a time through GRIil_split_line() and GRIil_join_line().
  GLOBAL VARIABLES
  COMMENTS, BUGS, ASSUMPTIONS
     This routine does no parameter checking, it's assumed to be done at a
@@ -1330,6 +1520,32 @@ GRIil_convert(const void *inbuf, gr_interlace_t inil, void *outbuf, gr_interlace
 
     if (inil == outil) /* check for trivial input=output 'conversion' */
         memcpy(outbuf, inbuf, (size_t)dims[XDIM] * (size_t)dims[YDIM] * (size_t)pixel_size);
+    else if (inil == MFGR_INTERLACE_PIXEL || outil == MFGR_INTERLACE_PIXEL) {
+        gr_interlace_t planes_il = (inil == MFGR_INTERLACE_PIXEL) ? outil : inil;
+        size_t        *lines; /* offset of each component of the current line */
+        size_t         line_size  = (size_t)dims[XDIM] * comp_size;
+        size_t         pixel_line = (size_t)dims[XDIM] * pixel_size;
+
+        if (planes_il != MFGR_INTERLACE_LINE && planes_il != MFGR_INTERLACE_COMPONENT)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+        if ((lines = malloc(sizeof(size_t) * (size_t)ncomp)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+        for (i = 0; i < dims[YDIM]; i++) {
+            for (k = 0; k < ncomp; k++)
+                if (planes_il == MFGR_INTERLACE_LINE)
+                    lines[k] = ((size_t)i * (size_t)ncomp + (size_t)k) * line_size;
+                else
+                    lines[k] = ((size_t)k * (size_t)dims[YDIM] + (size_t)i) * line_size;
+            if (inil == MFGR_INTERLACE_PIXEL)
+                GRIil_split_line((const uint8 *)inbuf + (size_t)i * pixel_line, (uint8 *)outbuf, lines,
+                                 dims[XDIM], ncomp, comp_size);
+            else
+                GRIil_join_line((const uint8 *)inbuf, lines, (uint8 *)outbuf + (size_t)i * pixel_line,
+                                dims[XDIM], ncomp, comp_size);
+        } /* end for */
+        free(lines);
+    } /* end if */
     else {
         /* allocate pixel pointer arrays */
         if ((in_comp_ptr = malloc(sizeof(void *) * (size_t)ncomp)) == NULL)
@@ -1521,6 +1737,10 @@ GRstart(int32 hdf_file_id)
         /* Go get all the images and attributes in the file */
         if (GRIget_image_list(hdf_file_id, gr_ptr) == FAIL)
             HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+        /* the trees are mostly searched from now on */
+        if (tbbtdindex(gr_ptr->grtree) == FAIL || tbbtdindex(gr_ptr->gattree) == FAIL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
     } /* end else */
     gr_ptr->access++;
 
@@ -2299,6 +2519,7 @@ GRcreate(int32 grid, const char *name, int32 ncomp, int32 nt, int32 il, int32 di
     ri_ptr->meta_modified             = TRUE;
     ri_ptr->attr_modified             = FALSE;
     ri_ptr->lattr_count               = 0;
+    ri_ptr->lattr_pending             = FALSE;
     ri_ptr->lattree                   = tbbtdmake(rigcompare, sizeof(int32), TBBT_FAST_INT32_COMPARE);
     if (ri_ptr->lattree == NULL)
         HGOTO_ERROR(DFE_NOSPACE, FAIL);
@@ -2443,8 +2664,11 @@ GRgetiminfo(int32 riid, char *name, int32 *ncomp, int32 *nt, int32 *il, int32 di
         dimsizes[1] = ri_ptr->img_dim.ydim;
     } /* end if */
 
-    if (n_attr != NULL)
+    if (n_attr != NULL) {
+        if (GRIget_lattrs(ri_ptr) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
         *n_attr = ri_ptr->lattr_count;
+    } /* end if */
 
 done:
     return ret_value;
@@ -2965,7 +3189,8 @@ GRreadimage(int32 riid, int32 start[2], int32 in_stride[2], int32 count[2], void
     intn         solid_block = FALSE; /* whether the image data is a solid block of data */
     intn         whole_image = FALSE; /* whether we are reading in the whole image */
     intn         image_data  = FALSE; /* whether there is actual image data or not */
-    void       **img_data;            /* pointer to the converted image data to write */
+    void        *img_data    = NULL;  /* buffer the image data is read into */
+    void        *pixel_data  = NULL;  /* buffer for the pixel interlaced data in memory */
     uintn        pixel_disk_size;     /* size of a pixel on disk */
     uintn        pixel_mem_size;      /* size of a pixel in memory */
     intn         convert;             /* true if machine NT != NT to be written */
@@ -3067,6 +3292,14 @@ GRreadimage(int32 riid, int32 start[2], int32 in_stride[2], int32 count[2], void
             image_data = FALSE;
     } /* end else */
 
+    /* The data goes straight into the user's buffer when it wants pixel
+       interlace, or else through one buffer that GRIil_convert() copies
+       into the user's buffer */
+    if (ri_ptr->im_il == MFGR_INTERLACE_PIXEL)
+        pixel_data = data;
+    else if ((pixel_data = malloc(pixel_mem_size * (size_t)count[XDIM] * (size_t)count[YDIM])) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
     if (image_data == FALSE) { /* Fake an image for the user by using the pixel fill value */
         void *fill_pixel;      /* converted value for the filled pixel */
         int32 at_index;
@@ -3083,17 +3316,17 @@ GRreadimage(int32 riid, int32 start[2], int32 in_stride[2], int32 count[2], void
             memset(fill_pixel, 0, pixel_mem_size);
 
         /* Fill the user's buffer with the fill value */
-        HDmemfill(data, fill_pixel, pixel_mem_size, (uint32)(count[XDIM] * count[YDIM]));
+        HDmemfill(pixel_data, fill_pixel, pixel_mem_size, (uint32)(count[XDIM] * count[YDIM]));
         free(fill_pixel);
-    }                  /* end if */
-    else {             /* an image exists in the file */
-        if (convert) { /* convert image data to HDF disk format */
-            /* Allocate space for the conversion buffer */
+    }    /* end if */
+    else { /* an image exists in the file */
+        /* the number types convert in place when they are the same size */
+        if (pixel_disk_size != pixel_mem_size) {
             if ((img_data = malloc(pixel_disk_size * (size_t)count[XDIM] * (size_t)count[YDIM])) == NULL)
                 HGOTO_ERROR(DFE_NOSPACE, FAIL);
         }    /* end if */
-        else /* no conversion necessary, just use the user's buffer */
-            img_data = data;
+        else
+            img_data = pixel_data;
 
         if (GRIgetaid(ri_ptr, DFACC_READ) == FAIL)
             HGOTO_ERROR(DFE_INTERNAL, FAIL);
@@ -3158,53 +3391,50 @@ GRreadimage(int32 riid, int32 start[2], int32 in_stride[2], int32 count[2], void
             }     /* end else */
         }         /* end else */
 
-        if (convert) { /* convert the pixel data into the HDF disk format */
-            DFKconvert(img_data, data, ri_ptr->img_dim.nt, ri_ptr->img_dim.ncomps * count[XDIM] * count[YDIM],
-                       DFACC_READ, 0, 0);
-            free(img_data);
-        } /* end if */
-    }     /* end else */
-
-    /* Check whether we need to convert the buffer to the user's */
-    /*    requested interlace scheme. */
-    /* Note: This is implemented in a horribly ugly & slow manner, but I'm */
-    /*        in a bit of a hurry right now - QAK */
-    if (ri_ptr->im_il != MFGR_INTERLACE_PIXEL) {
-        void *pixel_buf; /* buffer for the pixel interlaced data */
-
-        /* Allocate space for the conversion buffer */
-        if ((pixel_buf = malloc(pixel_mem_size * (size_t)count[XDIM] * (size_t)count[YDIM])) == NULL)
-            HGOTO_ERROR(DFE_NOSPACE, FAIL);
-
-        GRIil_convert(data, MFGR_INTERLACE_PIXEL, pixel_buf, ri_ptr->im_il, count, ri_ptr->img_dim.ncomps,
-                      ri_ptr->img_dim.nt);
-
-        memcpy(data, pixel_buf, pixel_mem_size * (size_t)count[XDIM] * (size_t)count[YDIM]);
+        if (convert) /* convert the pixel data from the HDF disk format */
+            DFKconvert(img_data, pixel_data, ri_ptr->img_dim.nt,
+                       ri_ptr->img_dim.ncomps * count[XDIM] * count[YDIM], DFACC_READ, 0, 0);
+    } /* end else */
 
-        free(pixel_buf);
-    } /* end if */
+    /* Convert the buffer to the user's requested interlace scheme */
+    if (pixel_data != data)
+        if (GRIil_convert(pixel_data, MFGR_INTERLACE_PIXEL, data, ri_ptr->im_il, count, ri_ptr->img_dim.ncomps,
+                          ri_ptr->img_dim.nt) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
 done:
+    if (img_data != pixel_data)
+        free(img_data);
+    if (pixel_data != data)
+        free(pixel_data);
+
     return ret_value;
 } /* end GRreadimage() */
 
 /*--------------------------------------------------------------------------
  NAME
-    GRendaccess
+    GRprefetch
 
  PURPOSE
-    End access to an RI.
+    Announce a read of part of an RI.
 
  USAGE
-    intn GRendaccess(riid)
-        int32 riid;         IN: RI ID from GRselect/GRcreate
+    intn GRprefetch(riid,start,count)
+        int32 riid;         IN: access ID of the RI
+        int32 start[2];     IN: array containing the offset in the image of the
+                                image data to read in
+        int32 count[2];     IN: array containing the number of pixels to
+                                read in each dimension
 
  RETURNS
     SUCCEED/FAIL
 
  DESCRIPTION
-    End access to an RI.  Further attempts to access the RI ID will result in
-    an error.
+    Tells the system that the file blocks holding the pixels of the part
+    of the image will be read soon, so that they are read from disk in
+    the background and the GRreadimage() of them later finds them in
+    memory, see Hprefetch().  Nothing is read or decoded here, and an
+    image with no data written is left alone.
 
  GLOBAL VARIABLES
  COMMENTS, BUGS, ASSUMPTIONS
@@ -3212,180 +3442,599 @@ done:
  REVISION LOG
 --------------------------------------------------------------------------*/
 intn
-GRendaccess(int32 riid)
+GRprefetch(int32 riid, int32 start[2], int32 count[2])
 {
-    ri_info_t *ri_ptr; /* ptr to the image to work with */
+    ri_info_t *ri_ptr;            /* ptr to the image to work with */
+    int32     *offsets = NULL;    /* element offset of each row of pixels */
+    int32     *lengths = NULL;    /* bytes of each row of pixels */
+    int32      pixel_disk_size;   /* size of a pixel on disk */
+    int32      i;
     intn       ret_value = SUCCEED;
 
     /* clear error stack and check validity of args */
     HEclear();
 
-    /* check the validity of the RI ID */
-    if (HAatom_group(riid) != RIIDGROUP)
+    if (HAatom_group(riid) != RIIDGROUP || start == NULL || count == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
     /* locate RI's object in hash table */
     if (NULL == (ri_ptr = (ri_info_t *)HAatom_object(riid)))
         HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
 
-    if (!(ri_ptr->access > 0))
-        HGOTO_ERROR(DFE_CANTENDACCESS, FAIL);
-
-    /* Check for writing a fill value attribute out */
-    if (ri_ptr->store_fill == TRUE) { /* store the fill value attribute before letting go of the image */
-        if (GRsetattr(riid, FILL_ATTR, ri_ptr->img_dim.nt, ri_ptr->img_dim.ncomps, ri_ptr->fill_value) ==
-            FAIL)
-            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
-        ri_ptr->store_fill = FALSE;
-    } /* end if */
+    if (start[XDIM] < 0 || start[YDIM] < 0 || count[XDIM] < 1 || count[YDIM] < 1 ||
+        start[XDIM] + count[XDIM] > ri_ptr->img_dim.xdim || start[YDIM] + count[YDIM] > ri_ptr->img_dim.ydim)
+        HGOTO_ERROR(DFE_BADDIM, FAIL);
 
-    /* Reduce the number of accesses to the RI */
-    ri_ptr->access--;
+    /* Check if the image data is in the file */
+    if (ri_ptr->img_tag == DFTAG_NULL || ri_ptr->img_ref == DFREF_WILDCARD ||
+        Hlength(ri_ptr->gr_ptr->hdf_file_id, ri_ptr->img_tag, ri_ptr->img_ref) <= 0)
+        HGOTO_DONE(SUCCEED);
 
-    /* Check if we should shut down the AID we've been holding open */
-    if (!(ri_ptr->access > 0) && ri_ptr->img_aid != 0) {
-        Hendaccess(ri_ptr->img_aid);
-        ri_ptr->img_aid = 0;
-    } /* end if */
+    if (GRIgetaid(ri_ptr, DFACC_READ) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
-    /* Double check on setting the GR modified flag */
-    /* Maybe this should be flagged as as error? -QAK */
-    if (ri_ptr->meta_modified == TRUE && ri_ptr->gr_ptr->gr_modified == FALSE)
-        ri_ptr->gr_ptr->gr_modified = TRUE;
+    /* one run of bytes per row of pixels, as GRreadimage() reads them */
+    if ((offsets = (int32 *)malloc((size_t)count[YDIM] * sizeof(int32))) == NULL ||
+        (lengths = (int32 *)malloc((size_t)count[YDIM] * sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    pixel_disk_size = ri_ptr->img_dim.ncomps * DFKNTsize(ri_ptr->img_dim.nt);
+    for (i = 0; i < count[YDIM]; i++) {
+        offsets[i] = ((ri_ptr->img_dim.xdim * (start[YDIM] + i)) + start[XDIM]) * pixel_disk_size;
+        lengths[i] = count[XDIM] * pixel_disk_size;
+    }
 
-    /* Delete the atom for the RI ID */
-    if (NULL == HAremove_atom(riid))
-        HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
+    if (Hprefetch(ri_ptr->img_aid, count[YDIM], offsets, lengths) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
 done:
+    free(offsets);
+    free(lengths);
     return ret_value;
-} /* end GRendaccess() */
+} /* end GRprefetch() */
 
 /*--------------------------------------------------------------------------
  NAME
-    GRidtoref
+    GRIgetoverviews
 
  PURPOSE
-    Maps an RI ID to a reference # for annotating or including in a Vgroup.
+    Read the list of overview images of an RI.
 
  USAGE
-    uint16 GRidtoref(riid)
+    intn GRIgetoverviews(riid,refs)
         int32 riid;         IN: RI ID from GRselect/GRcreate
+        uint16 **refs;      OUT: the RI reference numbers of the overviews,
+                                level 1 first, to be freed by the caller
 
  RETURNS
-    A valid reference # on success or 0
+    The number of overview levels (0 when the RI has none, in which case
+    *refs is NULL) or FAIL
 
  DESCRIPTION
-    Maps an riid to a reference # for annotating or including in a Vgroup.
+    Reads the OVERVIEW_ATTR attribute that GRbuildoverviews() stores with
+    the RI.
 
  GLOBAL VARIABLES
  COMMENTS, BUGS, ASSUMPTIONS
  EXAMPLES
  REVISION LOG
 --------------------------------------------------------------------------*/
-uint16
-GRidtoref(int32 riid)
+static intn
+GRIgetoverviews(int32 riid, uint16 **refs)
 {
-    ri_info_t *ri_ptr;        /* ptr to the image to work with */
-    uint16     ret_value = 0; /* FAIL? */
-
-    /* clear error stack and check validity of args */
-    HEclear();
+    int32 attr_index; /* index of the overview attribute */
+    int32 attr_nt;    /* number type of the overview attribute */
+    int32 nrefs;      /* number of overview levels */
+    intn  ret_value = 0;
+
+    *refs = NULL;
+    if ((attr_index = GRfindattr(riid, OVERVIEW_ATTR)) == FAIL) {
+        /* no overviews built yet, that's not an error */
+        HEclear();
+        HGOTO_DONE(0);
+    } /* end if */
 
-    /* check the validity of the RI ID */
-    if (HAatom_group(riid) != RIIDGROUP)
-        HGOTO_ERROR(DFE_ARGS, 0);
+    if (GRattrinfo(riid, attr_index, NULL, &attr_nt, &nrefs) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (attr_nt != DFNT_UINT16 || nrefs < 1)
+        HGOTO_ERROR(DFE_BADATTR, FAIL);
 
-    /* locate RI's object in hash table */
-    if (NULL == (ri_ptr = (ri_info_t *)HAatom_object(riid)))
-        HGOTO_ERROR(DFE_RINOTFOUND, 0);
+    if ((*refs = (uint16 *)malloc((size_t)nrefs * sizeof(uint16))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if (GRgetattr(riid, attr_index, *refs) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
-    /* Changed to handle case when ri_ptr->rig_ref is DFREF_WILDCARD */
-    if (ri_ptr->ri_ref != DFREF_WILDCARD)
-        ret_value = ri_ptr->ri_ref;
-    else {
-        if (ri_ptr->rig_ref == DFREF_WILDCARD) {
-            if (ri_ptr->img_ref == DFREF_WILDCARD)
-                HGOTO_ERROR(DFE_INTERNAL, 0);
-            ret_value = ri_ptr->img_ref;
-        }
-        else
-            ret_value = ri_ptr->rig_ref;
-    } /* end else */
+    ret_value = (intn)nrefs;
 
 done:
+    if (ret_value == FAIL) {
+        free(*refs);
+        *refs = NULL;
+    } /* end if */
+
     return ret_value;
-} /* end GRidtoref() */
+} /* end GRIgetoverviews() */
 
 /*--------------------------------------------------------------------------
  NAME
-    GRreftoindex
+    GRbuildoverviews
 
  PURPOSE
-    Maps the reference # of an RI into an index which can be used with GRselect.
+    Build reduced resolution copies of an image
 
  USAGE
-    int32 GRreftoindex(grid,ref)
-        int32 grid;         IN: GR ID from GRstart
-        uint16 ref;         IN: reference number of raster image to map to index
+    intn GRbuildoverviews(riid,nlevels)
+        int32 riid;         IN: RI ID from GRselect/GRcreate
+        intn nlevels;       IN: number of overview levels to build
 
  RETURNS
-    A valid index # on success or FAIL
+    SUCCEED/FAIL
 
  DESCRIPTION
-    Maps the reference # of an RI into an index which can be used with GRselect.
+    Builds an overview pyramid for an RI: level 1 is the image with every
+    other pixel of every other line kept, so each dimension is halved
+    (rounding up), level 2 is decimated the same way from level 1, and so
+    on, down to 'nlevels'.  Once a dimension has shrunk to a single pixel
+    it stays at one pixel.
+
+    Each level is stored as an ordinary RI in the same file, named
+    "<image name>.overview<level>", with the number type and number of
+    components of the image.  It is chunked, with the image's chunk lengths
+    clamped to its dimensions, and compressed like the image, so that
+    GRreadimage_level() can read a window of a level without touching the
+    rest.  JPEG and IMCOMP compressed images get uncompressed overviews.
+    The reference numbers of the levels are recorded in the OVERVIEW_ATTR
+    attribute of the image.
 
  GLOBAL VARIABLES
  COMMENTS, BUGS, ASSUMPTIONS
+    Calling GRbuildoverviews() again rewrites the existing levels in place
+    and adds any missing ones, so it must be called again after the image
+    data has changed.  Levels above 'nlevels' left over from an earlier
+    call are no longer listed but stay in the file.  The overview images are
+    counted by GRfileinfo() and returned by GRselect() like any other RI.
+
  EXAMPLES
  REVISION LOG
 --------------------------------------------------------------------------*/
-int32
-GRreftoindex(int32 grid, uint16 ref)
+intn
+GRbuildoverviews(int32 riid, intn nlevels)
 {
-    gr_info_t *gr_ptr; /* ptr to the GR information for this grid */
-    ri_info_t *ri_ptr; /* ptr to the image to work with */
-    void     **t;      /* temp. ptr to the image found */
-    int32      ret_value = SUCCEED;
+    ri_info_t     *ri_ptr;             /* ptr to the image to work with */
+    int32          grid      = FAIL;   /* temporary GR ID of the image's file */
+    int32          ovrid     = FAIL;   /* RI ID of the overview being written */
+    uint16        *old_refs  = NULL;   /* overviews from an earlier call */
+    intn           nold      = 0;      /* number of overviews from an earlier call */
+    uint16        *refs      = NULL;   /* reference numbers of the overviews */
+    uint8         *img_data  = NULL;   /* pixel interlaced image, decimated in place */
+    char          *ovr_name  = NULL;   /* name of the overview being built */
+    int32          dims[2];            /* dimensions of the current level */
+    int32          ovr_dims[2];        /* dimensions of an existing overview */
+    int32          start[2]  = {0, 0}; /* start of the whole image */
+    int32          ncomp, nt;          /* number of components, number type */
+    size_t         pixel_size;         /* size of a pixel in memory */
+    HDF_CHUNK_DEF  chunk_def;          /* chunking of the image */
+    int32          chunk_flags;        /* HDF_NONE, HDF_CHUNK or HDF_CHUNK|HDF_COMP */
+    comp_coder_t   comp_type = COMP_CODE_NONE;
+    comp_info      cinfo;
+    gr_interlace_t save_il;            /* interlace requested by the user */
+    intn           level;
+    intn           ret_value = SUCCEED;
 
     /* clear error stack and check validity of args */
     HEclear();
 
-    /* check the validity of the RI ID */
-    if (HAatom_group(grid) != GRIDGROUP)
+    if (HAatom_group(riid) != RIIDGROUP || nlevels < 1 || nlevels > MAX_ORDER)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* locate GR's object in hash table */
-    if (NULL == (gr_ptr = (gr_info_t *)HAatom_object(grid)))
-        HGOTO_ERROR(DFE_GRNOTFOUND, FAIL);
-
-    if ((t = (void **)tbbtfirst((TBBT_NODE *)*(gr_ptr->grtree))) == NULL)
+    /* locate RI's object in hash table */
+    if (NULL == (ri_ptr = (ri_info_t *)HAatom_object(riid)))
         HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
-    do {
-        ri_ptr = (ri_info_t *)*t;
-        if (ri_ptr != NULL && ((ri_ptr->ri_ref == ref) || (ri_ptr->ri_ref == DFREF_WILDCARD &&
-                                                           ri_ptr->rig_ref == ref))) /* the ref matches */
-            HGOTO_DONE(ri_ptr->index);
-    } while ((t = (void **)tbbtnext((TBBT_NODE *)t)) != NULL);
 
-    ret_value = (FAIL);
+    /* the GR calls below need an ID for the file the image is in */
+    if ((grid = HAregister_atom(GRIDGROUP, ri_ptr->gr_ptr)) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
-done:
-    return ret_value;
-} /* end GRreftoindex() */
+    if ((nold = GRIgetoverviews(riid, &old_refs)) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if ((refs = (uint16 *)malloc((size_t)nlevels * sizeof(uint16))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if ((ovr_name = (char *)malloc(strlen(ri_ptr->name) + 32)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
-/*--------------------------------------------------------------------------
- NAME
-    GRreqlutil
+    /* read the whole image in pixel interlace */
+    ncomp      = ri_ptr->img_dim.ncomps;
+    nt         = ri_ptr->img_dim.nt;
+    dims[XDIM] = ri_ptr->img_dim.xdim;
+    dims[YDIM] = ri_ptr->img_dim.ydim;
+    pixel_size = (size_t)ncomp * (size_t)DFKNTsize((nt | DFNT_NATIVE) & (~DFNT_LITEND));
+    if ((img_data = (uint8 *)malloc((size_t)dims[XDIM] * (size_t)dims[YDIM] * pixel_size)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
- PURPOSE
-    Request that the next LUT read from an RI have a particular interlace.
+    save_il       = ri_ptr->im_il;
+    ri_ptr->im_il = MFGR_INTERLACE_PIXEL;
+    ret_value     = GRreadimage(riid, start, NULL, dims, img_data);
+    ri_ptr->im_il = save_il;
+    if (ret_value == FAIL)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
 
- USAGE
-    intn GRreqlutil(riid,il)
-        int32 riid;         IN: RI ID from GRselect/GRcreate
-        intn il;            IN: interlace for next LUT.  From the following
-                                values (found in mfgr.h):
+    /* find out how the overviews should be stored */
+    if (GRgetchunkinfo(riid, &chunk_def, &chunk_flags) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (GRgetcompinfo(riid, &comp_type, &cinfo) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (comp_type == COMP_CODE_JPEG || comp_type == COMP_CODE_IMCOMP)
+        comp_type = COMP_CODE_NONE;
+    if (chunk_flags & HDF_CHUNK) {
+        if (comp_type != COMP_CODE_NONE) {
+            chunk_flags              = HDF_CHUNK | HDF_COMP;
+            chunk_def.comp.comp_type = (int32)comp_type;
+            chunk_def.comp.cinfo     = cinfo;
+        } /* end if */
+        else
+            chunk_flags = HDF_CHUNK;
+    } /* end if */
+
+    for (level = 1; level <= nlevels; level++) {
+        int32 xsrc = dims[XDIM];
+        int32 i, j;
+
+        /* keep every other pixel of every other line */
+        dims[XDIM] = (dims[XDIM] + 1) / 2;
+        dims[YDIM] = (dims[YDIM] + 1) / 2;
+        for (j = 0; j < dims[YDIM]; j++)
+            for (i = 0; i < dims[XDIM]; i++)
+                memmove(img_data + ((size_t)j * (size_t)dims[XDIM] + (size_t)i) * pixel_size,
+                        img_data + ((size_t)(2 * j) * (size_t)xsrc + (size_t)(2 * i)) * pixel_size,
+                        pixel_size);
+
+        /* reuse the image of this level if an earlier call built it */
+        ovrid = FAIL;
+        if (level <= nold) {
+            int32 ovr_index = GRreftoindex(grid, old_refs[level - 1]);
+
+            if (ovr_index != FAIL && (ovrid = GRselect(grid, ovr_index)) != FAIL) {
+                int32 ovr_ncomp, ovr_nt;
+
+                if (GRgetiminfo(ovrid, NULL, &ovr_ncomp, &ovr_nt, NULL, ovr_dims, NULL) == FAIL ||
+                    ovr_ncomp != ncomp || ovr_nt != nt || ovr_dims[XDIM] != dims[XDIM] ||
+                    ovr_dims[YDIM] != dims[YDIM]) {
+                    GRendaccess(ovrid);
+                    ovrid = FAIL;
+                } /* end if */
+            }   /* end if */
+            HEclear();
+        } /* end if */
+
+        if (ovrid == FAIL) {
+            sprintf(ovr_name, "%s.overview%d", ri_ptr->name, level);
+            if ((ovrid = GRcreate(grid, ovr_name, ncomp, nt, MFGR_INTERLACE_PIXEL, dims)) == FAIL)
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+            if (chunk_flags & HDF_CHUNK) {
+                HDF_CHUNK_DEF ovr_chunk = chunk_def;
+
+                if (ovr_chunk.chunk_lengths[0] > dims[XDIM])
+                    ovr_chunk.chunk_lengths[0] = dims[XDIM];
+                if (ovr_chunk.chunk_lengths[1] > dims[YDIM])
+                    ovr_chunk.chunk_lengths[1] = dims[YDIM];
+                if (GRsetchunk(ovrid, ovr_chunk, chunk_flags) == FAIL)
+                    HGOTO_ERROR(DFE_INTERNAL, FAIL);
+            } /* end if */
+            else if (comp_type != COMP_CODE_NONE) {
+                if (GRsetcompress(ovrid, comp_type, &cinfo) == FAIL)
+                    HGOTO_ERROR(DFE_INTERNAL, FAIL);
+            } /* end if */
+        }     /* end if */
+
+        if (GRwriteimage(ovrid, start, NULL, dims, img_data) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        refs[level - 1] = GRidtoref(ovrid);
+        if (GRendaccess(ovrid) == FAIL) {
+            ovrid = FAIL;
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        } /* end if */
+        ovrid = FAIL;
+    } /* end for */
+
+    if (GRsetattr(riid, OVERVIEW_ATTR, DFNT_UINT16, (int32)nlevels, refs) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+done:
+    if (ovrid != FAIL)
+        GRendaccess(ovrid);
+    if (grid != FAIL)
+        HAremove_atom(grid);
+    free(img_data);
+    free(ovr_name);
+    free(refs);
+    free(old_refs);
+
+    return ret_value;
+} /* end GRbuildoverviews() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    GRreadimage_level
+
+ PURPOSE
+    Read raster data from a level of an image's overview pyramid
+
+ USAGE
+    intn GRreadimage_level(riid,level,start,stride,edge,data)
+        int32 riid;         IN: RI ID from GRselect/GRcreate
+        intn level;         IN: level to read, 0 for the image itself
+        int32 start[2];     IN: offset in the level of the data to read
+        int32 stride[2];    IN: interval of the data read along each edge
+        int32 count[2];     IN: number of elements to read along each edge
+        void * data;        IN: pointer to the buffer to read into
+
+ RETURNS
+    SUCCEED/FAIL
+
+ DESCRIPTION
+    Reads image data from level 'level' of the overviews built by
+    GRbuildoverviews(), as GRreadimage() does for the image.  'start',
+    'stride' and 'count' are in the pixels of the level, whose dimensions
+    are the image dimensions halved (rounding up) 'level' times.  The data
+    is returned in the interlace requested with GRreqimageil() for 'riid'.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+    Fails with DFE_ARGS when 'level' is beyond the levels that were built;
+    the number of levels is the count of the OVERVIEW_ATTR attribute.
+
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+intn
+GRreadimage_level(int32 riid, intn level, int32 start[2], int32 stride[2], int32 count[2], void *data)
+{
+    ri_info_t *ri_ptr;           /* ptr to the image to work with */
+    int32      grid      = FAIL; /* temporary GR ID of the image's file */
+    int32      ovrid     = FAIL; /* RI ID of the overview read */
+    int32      ovr_index;        /* index of the overview in the file */
+    uint16    *refs      = NULL; /* reference numbers of the overviews */
+    intn       nlevels;          /* number of overview levels */
+    intn       ret_value = SUCCEED;
+
+    /* clear error stack and check validity of args */
+    HEclear();
+
+    if (level == 0)
+        HGOTO_DONE(GRreadimage(riid, start, stride, count, data));
+
+    if (HAatom_group(riid) != RIIDGROUP || level < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* locate RI's object in hash table */
+    if (NULL == (ri_ptr = (ri_info_t *)HAatom_object(riid)))
+        HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
+
+    if ((nlevels = GRIgetoverviews(riid, &refs)) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (level > nlevels)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if ((grid = HAregister_atom(GRIDGROUP, ri_ptr->gr_ptr)) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if ((ovr_index = GRreftoindex(grid, refs[level - 1])) == FAIL)
+        HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
+    if ((ovrid = GRselect(grid, ovr_index)) == FAIL)
+        HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
+
+    if (GRreqimageil(ovrid, (intn)ri_ptr->im_il) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (GRreadimage(ovrid, start, stride, count, data) == FAIL)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
+
+done:
+    if (ovrid != FAIL && GRendaccess(ovrid) == FAIL)
+        ret_value = FAIL;
+    if (grid != FAIL)
+        HAremove_atom(grid);
+    free(refs);
+
+    return ret_value;
+} /* end GRreadimage_level() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    GRendaccess
+
+ PURPOSE
+    End access to an RI.
+
+ USAGE
+    intn GRendaccess(riid)
+        int32 riid;         IN: RI ID from GRselect/GRcreate
+
+ RETURNS
+    SUCCEED/FAIL
+
+ DESCRIPTION
+    End access to an RI.  Further attempts to access the RI ID will result in
+    an error.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+intn
+GRendaccess(int32 riid)
+{
+    ri_info_t *ri_ptr; /* ptr to the image to work with */
+    intn       ret_value = SUCCEED;
+
+    /* clear error stack and check validity of args */
+    HEclear();
+
+    /* check the validity of the RI ID */
+    if (HAatom_group(riid) != RIIDGROUP)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* locate RI's object in hash table */
+    if (NULL == (ri_ptr = (ri_info_t *)HAatom_object(riid)))
+        HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
+
+    if (!(ri_ptr->access > 0))
+        HGOTO_ERROR(DFE_CANTENDACCESS, FAIL);
+
+    /* Check for writing a fill value attribute out */
+    if (ri_ptr->store_fill == TRUE) { /* store the fill value attribute before letting go of the image */
+        if (GRsetattr(riid, FILL_ATTR, ri_ptr->img_dim.nt, ri_ptr->img_dim.ncomps, ri_ptr->fill_value) ==
+            FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        ri_ptr->store_fill = FALSE;
+    } /* end if */
+
+    /* Reduce the number of accesses to the RI */
+    ri_ptr->access--;
+
+    /* Check if we should shut down the AID we've been holding open */
+    if (!(ri_ptr->access > 0) && ri_ptr->img_aid != 0) {
+        Hendaccess(ri_ptr->img_aid);
+        ri_ptr->img_aid = 0;
+    } /* end if */
+
+    /* Double check on setting the GR modified flag */
+    /* Maybe this should be flagged as as error? -QAK */
+    if (ri_ptr->meta_modified == TRUE && ri_ptr->gr_ptr->gr_modified == FALSE)
+        ri_ptr->gr_ptr->gr_modified = TRUE;
+
+    /* Delete the atom for the RI ID */
+    if (NULL == HAremove_atom(riid))
+        HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
+
+done:
+    return ret_value;
+} /* end GRendaccess() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    GRidtoref
+
+ PURPOSE
+    Maps an RI ID to a reference # for annotating or including in a Vgroup.
+
+ USAGE
+    uint16 GRidtoref(riid)
+        int32 riid;         IN: RI ID from GRselect/GRcreate
+
+ RETURNS
+    A valid reference # on success or 0
+
+ DESCRIPTION
+    Maps an riid to a reference # for annotating or including in a Vgroup.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+uint16
+GRidtoref(int32 riid)
+{
+    ri_info_t *ri_ptr;        /* ptr to the image to work with */
+    uint16     ret_value = 0; /* FAIL? */
+
+    /* clear error stack and check validity of args */
+    HEclear();
+
+    /* check the validity of the RI ID */
+    if (HAatom_group(riid) != RIIDGROUP)
+        HGOTO_ERROR(DFE_ARGS, 0);
+
+    /* locate RI's object in hash table */
+    if (NULL == (ri_ptr = (ri_info_t *)HAatom_object(riid)))
+        HGOTO_ERROR(DFE_RINOTFOUND, 0);
+
+    /* Changed to handle case when ri_ptr->rig_ref is DFREF_WILDCARD */
+    if (ri_ptr->ri_ref != DFREF_WILDCARD)
+        ret_value = ri_ptr->ri_ref;
+    else {
+        if (ri_ptr->rig_ref == DFREF_WILDCARD) {
+            if (ri_ptr->img_ref == DFREF_WILDCARD)
+                HGOTO_ERROR(DFE_INTERNAL, 0);
+            ret_value = ri_ptr->img_ref;
+        }
+        else
+            ret_value = ri_ptr->rig_ref;
+    } /* end else */
+
+done:
+    return ret_value;
+} /* end GRidtoref() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    GRreftoindex
+
+ PURPOSE
+    Maps the reference # of an RI into an index which can be used with GRselect.
+
+ USAGE
+    int32 GRreftoindex(grid,ref)
+        int32 grid;         IN: GR ID from GRstart
+        uint16 ref;         IN: reference number of raster image to map to index
+
+ RETURNS
+    A valid index # on success or FAIL
+
+ DESCRIPTION
+    Maps the reference # of an RI into an index which can be used with GRselect.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+int32
+GRreftoindex(int32 grid, uint16 ref)
+{
+    gr_info_t *gr_ptr; /* ptr to the GR information for this grid */
+    ri_info_t *ri_ptr; /* ptr to the image to work with */
+    void     **t;      /* temp. ptr to the image found */
+    int32      ret_value = SUCCEED;
+
+    /* clear error stack and check validity of args */
+    HEclear();
+
+    /* check the validity of the RI ID */
+    if (HAatom_group(grid) != GRIDGROUP)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* locate GR's object in hash table */
+    if (NULL == (gr_ptr = (gr_info_t *)HAatom_object(grid)))
+        HGOTO_ERROR(DFE_GRNOTFOUND, FAIL);
+
+    if ((t = (void **)tbbtfirst((TBBT_NODE *)*(gr_ptr->grtree))) == NULL)
+        HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
+    do {
+        ri_ptr = (ri_info_t *)*t;
+        if (ri_ptr != NULL && ((ri_ptr->ri_ref == ref) || (ri_ptr->ri_ref == DFREF_WILDCARD &&
+                                                           ri_ptr->rig_ref == ref))) /* the ref matches */
+            HGOTO_DONE(ri_ptr->index);
+    } while ((t = (void **)tbbtnext((TBBT_NODE *)t)) != NULL);
+
+    ret_value = (FAIL);
+
+done:
+    return ret_value;
+} /* end GRreftoindex() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    GRreqlutil
+
+ PURPOSE
+    Request that the next LUT read from an RI have a particular interlace.
+
+ USAGE
+    intn GRreqlutil(riid,il)
+        int32 riid;         IN: RI ID from GRselect/GRcreate
+        intn il;            IN: interlace for next LUT.  From the following
+                                values (found in mfgr.h):
                       MFGR_INTERLACE_PIXEL      - pixel interlacing
                       MFGR_INTERLACE_LINE       - line interlacing
                       MFGR_INTERLACE_COMPONENT  - component/plane interlacing
@@ -4014,7 +4663,8 @@ GRsetcompress(int32 riid, comp_coder_t comp_type, comp_info *cinfo)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
     /* Check the validity of the compression type */
-    if ((comp_type < COMP_CODE_NONE || comp_type >= COMP_CODE_INVALID) && comp_type != COMP_CODE_JPEG)
+    if ((comp_type < COMP_CODE_NONE || comp_type >= COMP_CODE_INVALID) && comp_type != COMP_CODE_JPEG &&
+        comp_type != COMP_CODE_ZSTD && comp_type != COMP_CODE_LZ4 && comp_type < COMP_CODE_PLUGIN_MIN)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
     /* locate RI's object in hash table */
@@ -4429,6 +5079,8 @@ GRsetattr(int32 id, const char *name, int32 attr_nt, int32 count, const void *da
         if (NULL == (ri_ptr = (ri_info_t *)HAatom_object(id)))
             HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
         gr_ptr = ri_ptr->gr_ptr;
+        if (GRIget_lattrs(ri_ptr) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
         hdf_file_id  = gr_ptr->hdf_file_id;
         search_tree  = ri_ptr->lattree;
@@ -4614,6 +5266,8 @@ GRattrinfo(int32 id, int32 index, char *name, int32 *attr_nt, int32 *count)
         /* locate RI's object in hash table */
         if (NULL == (ri_ptr = (ri_info_t *)HAatom_object(id)))
             HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
+        if (GRIget_lattrs(ri_ptr) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
         if (index < 0 || index >= ri_ptr->lattr_count)
             HGOTO_ERROR(DFE_ARGS, FAIL);
@@ -4695,6 +5349,8 @@ GRgetattr(int32 id, int32 index, void *data)
         if (NULL == (ri_ptr = (ri_info_t *)HAatom_object(id)))
             HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
         gr_ptr = ri_ptr->gr_ptr;
+        if (GRIget_lattrs(ri_ptr) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
         if (index < 0 || index >= ri_ptr->lattr_count)
             HGOTO_ERROR(DFE_ARGS, FAIL);
@@ -4745,6 +5401,168 @@ done:
     return ret_value;
 } /* end GRgetattr() */
 
+/*--------------------------------------------------------------------------
+ NAME
+    GRreadallattrs
+
+ PURPOSE
+    Read all the attributes of an object at once.
+
+ USAGE
+    int32 GRreadallattrs(riid|grid,attrs,max_attrs,arena,arena_size)
+        int32 riid|grid;        IN: RI|GR ID
+        hdf_attr_t attrs[];     OUT: attribute entries
+        int32 max_attrs;        IN: # of entries of attrs
+        void *arena;            OUT: arena for the names and values
+        int32 *arena_size;      IN: size of the arena
+                                OUT: size of arena needed for all the attributes
+
+ RETURNS
+    The number of attributes of the object, or FAIL.
+
+ DESCRIPTION
+    Read the name, number type, count and values of every attribute of
+    the object into attrs[], with the names and values packed into the
+    caller's arena as HDarena_attr() lays them out.  Attributes are
+    placed in index order until one does not fit; the name and values of
+    the entries that did not fit are set to NULL.  Calling with a NULL
+    arena returns the number of attributes and the arena size needed.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+    The values not already cached are read in a single Hreadv() of their
+    attribute vdatas instead of attaching each vdata in turn; if that
+    fails, they are read one at a time with GRgetattr().
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+int32
+GRreadallattrs(int32 id, hdf_attr_t attrs[], int32 max_attrs, void *arena, int32 *arena_size)
+{
+    gr_info_t   *gr_ptr;           /* ptr to the GR information for this grid */
+    ri_info_t   *ri_ptr;           /* ptr to the image to work with */
+    void       **t;                /* temp. ptr to the attribute found */
+    TBBT_TREE   *search_tree;      /* attribute tree to search through */
+    at_info_t   *at_ptr;           /* ptr to the attribute to work with */
+    int32        nattrs;           /* # of attributes of the object */
+    hdf_attr_t   extra;            /* entry for the attributes past max_attrs */
+    hdf_attr_t  *attr;             /* entry of the attribute to work with */
+    hdf_readv_t *reqs     = NULL;  /* reads of the values not cached */
+    at_info_t  **req_attr = NULL;  /* attribute of each read */
+    int32       *req_idx  = NULL;  /* index of each read's entry */
+    uint8       *raw      = NULL;  /* file-format values of the reads */
+    int32        raw_size = 0;     /* size of the raw buffer */
+    int32        nreqs    = 0;     /* # of reads */
+    int32        used     = 0;     /* # of bytes of the arena used */
+    int32        ii;
+    int32        ret_value = FAIL;
+
+    /* clear error stack and check validity of args */
+    HEclear();
+
+    if (arena_size == NULL || max_attrs < 0 || (attrs == NULL && max_attrs > 0))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (HAatom_group(id) == GRIDGROUP) {
+        /* locate GR's object in hash table */
+        if (NULL == (gr_ptr = (gr_info_t *)HAatom_object(id)))
+            HGOTO_ERROR(DFE_GRNOTFOUND, FAIL);
+        nattrs      = gr_ptr->gattr_count;
+        search_tree = gr_ptr->gattree;
+    } /* end if */
+    else if (HAatom_group(id) == RIIDGROUP) {
+        /* locate RI's object in hash table */
+        if (NULL == (ri_ptr = (ri_info_t *)HAatom_object(id)))
+            HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
+        if (GRIget_lattrs(ri_ptr) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        gr_ptr      = ri_ptr->gr_ptr;
+        nattrs      = ri_ptr->lattr_count;
+        search_tree = ri_ptr->lattree;
+    }    /* end if */
+    else
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (nattrs > 0) {
+        if ((reqs = malloc((size_t)nattrs * sizeof(hdf_readv_t))) == NULL ||
+            (req_attr = malloc((size_t)nattrs * sizeof(at_info_t *))) == NULL ||
+            (req_idx = malloc((size_t)nattrs * sizeof(int32))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    } /* end if */
+
+    /* Place each attribute in the arena, copying the cached values and
+       queueing reads for the others */
+    for (ii = 0; ii < nattrs; ii++) {
+        int32 at_size; /* size in bytes of the attribute data */
+
+        if ((t = (void **)tbbtdfind(search_tree, &ii, NULL)) == NULL)
+            HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
+        at_ptr  = (at_info_t *)*t;
+        at_size = at_ptr->len * DFKNTsize((at_ptr->nt | DFNT_NATIVE) & (~DFNT_LITEND));
+
+        /* the ones past max_attrs are only counted in the arena size */
+        attr = (ii < max_attrs) ? &attrs[ii] : &extra;
+        if (!HDarena_attr(attr, (attr == &extra) ? NULL : arena, *arena_size, &used, at_ptr->name, at_ptr->nt,
+                          at_ptr->len, at_size))
+            continue;
+
+        if (at_ptr->data != NULL)
+            memcpy(attr->values, at_ptr->data, (size_t)at_size);
+        else if (at_size > 0) {
+            reqs[nreqs].tag    = DFTAG_VS;
+            reqs[nreqs].ref    = at_ptr->ref;
+            reqs[nreqs].offset = 0;
+            reqs[nreqs].length = at_ptr->len * DFKNTsize(at_ptr->nt);
+            reqs[nreqs].buf    = NULL;
+            req_attr[nreqs]    = at_ptr;
+            req_idx[nreqs]     = ii;
+            raw_size += reqs[nreqs].length;
+            nreqs++;
+        } /* end if */
+    }     /* end for */
+
+    if (nreqs > 0) {
+        intn batch_ok = FALSE; /* TRUE if the batch read got everything */
+
+        if ((raw = malloc((size_t)raw_size)) != NULL) {
+            uint8 *p = raw;
+
+            for (ii = 0; ii < nreqs; ii++) {
+                reqs[ii].buf = p;
+                p += reqs[ii].length;
+            } /* end for */
+            if (Hreadv(gr_ptr->hdf_file_id, nreqs, reqs) != FAIL) {
+                batch_ok = TRUE;
+                for (ii = 0; ii < nreqs; ii++)
+                    if (reqs[ii].nread != reqs[ii].length)
+                        batch_ok = FALSE;
+            } /* end if */
+        }     /* end if */
+
+        for (ii = 0; ii < nreqs; ii++) {
+            void *dest = attrs[req_idx[ii]].values;
+
+            if (batch_ok) {
+                if (DFKconvert(reqs[ii].buf, dest, req_attr[ii]->nt, req_attr[ii]->len, DFACC_READ, 0, 0) ==
+                    FAIL)
+                    HGOTO_ERROR(DFE_BADCONV, FAIL);
+            } /* end if */
+            else if (GRgetattr(id, req_idx[ii], dest) == FAIL)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+        } /* end for */
+    }     /* end if */
+
+    *arena_size = used;
+    ret_value   = nattrs;
+
+done:
+    free(reqs);
+    free(req_attr);
+    free(req_idx);
+    free(raw);
+    return ret_value;
+} /* end GRreadallattrs() */
+
 /*--------------------------------------------------------------------------
  NAME
     GRfindattr
@@ -4796,6 +5614,8 @@ GRfindattr(int32 id, const char *name)
         /* locate RI's object in hash table */
         if (NULL == (ri_ptr = (ri_info_t *)HAatom_object(id)))
             HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
+        if (GRIget_lattrs(ri_ptr) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
         search_tree = ri_ptr->lattree;
     }    /* end if */
@@ -4905,7 +5725,8 @@ GRIgetaid(ri_info_t *ri_ptr, intn acc_perm)
     if (ri_ptr->comp_img ||
         (ri_ptr->img_aid != 0 && (acc_perm & DFACC_WRITE) != 0 && (ri_ptr->acc_perm & DFACC_WRITE) == 0)) {
         /* Close the old AID (which only had read permission) */
-        Hendaccess(ri_ptr->img_aid);
+        if (ri_ptr->img_aid != 0)
+            Hendaccess(ri_ptr->img_aid);
         ri_ptr->img_aid = 0;
     } /* end if */
 
@@ -5028,6 +5849,13 @@ GRPshutdown(void)
       that set in 'GRsetcompress()'. The bit-or'd 'flags' argument' is set to
       'HDF_CHUNK | HDF_COMP'.
 
+      With COMP_CODE_JPEG each chunk is stored as a JPEG image of its own,
+      of chunk_lengths[0] scanlines of chunk_lengths[1] pixels, with the
+      quality and force_baseline given in 'cinfo.jpeg'; the image must have
+      8-bit pixels of 1 or 3 components.  A read then decodes only
+      the chunks it touches, on several threads when GRsetchunkthreads()
+      allows it.
+
       See the example in pseudo-C below for further usage.
 
       The maximum number of Chunks in an HDF file is 65,535.
@@ -5182,7 +6010,18 @@ GRsetchunk(int32         riid,      /* IN: raster access id */
             chunk[0].model_type = COMP_MODEL_STDIO; /* Default */
             chunk[0].minfo      = &minfo;           /* dummy */
 
-            if ((comp_coder_t)cdef->comp.comp_type != COMP_CODE_SZIP) {
+            if ((comp_coder_t)cdef->comp.comp_type == COMP_CODE_JPEG) {
+                /* each chunk is coded as a JPEG image of 8-bit pixels */
+                if (DFKNTsize(ri_ptr->img_dim.nt) != 1 ||
+                    (ri_ptr->img_dim.ncomps != 1 && ri_ptr->img_dim.ncomps != 3))
+                    HGOTO_ERROR(DFE_CANTMOD, FAIL);
+                memcpy(&cinfo, &(cdef->comp.cinfo), sizeof(comp_info));
+                cinfo.jpeg.height = cdims[0];
+                cinfo.jpeg.width  = cdims[1];
+                cinfo.jpeg.ncomps = ri_ptr->img_dim.ncomps;
+                chunk[0].cinfo    = &cinfo;
+            }
+            else if ((comp_coder_t)cdef->comp.comp_type != COMP_CODE_SZIP) {
                 chunk[0].cinfo = &cdef->comp.cinfo;
             }
             else
@@ -5811,6 +6650,148 @@ done:
     return ret_value;
 } /* GRreadchunk() */
 
+/******************************************************************************
+ NAME
+     GRreadchunkraw -- read the stored data of a chunk of the GR
+
+ DESCRIPTION
+     This routine copies the chunk of the chunked GR specified by chunk
+     'origin' as it is stored in the file, i.e. still compressed if the
+     image is, into 'datap' without decoding, converting or reinterlacing
+     it.  With 'datap' NULL only the size of the stored chunk is returned
+     so that a buffer can be allocated.  The coder and its parameters are
+     returned by GRgetcompinfo().
+
+     The data can be written with GRwritechunkraw() to a new chunked GR
+     with the same number type, number of components, chunk lengths and
+     compression, which copies the chunk without decompressing and
+     compressing it again.
+
+     See GRsetchunk() for a description of the organization of chunks in an GR.
+
+     NOTE:
+         This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+ RETURNS
+        The number of bytes of the stored chunk, 0 if the chunk was never
+        written and FAIL on error
+******************************************************************************/
+int32
+GRreadchunkraw(int32  riid,   /* IN: access aid to GR */
+               int32 *origin, /* IN: origin of chunk to read */
+               void  *datap,  /* OUT: buffer for the stored chunk */
+               int32  buflen /* IN: size of 'datap' */)
+{
+    ri_info_t *ri_ptr = NULL; /* ptr to the image to work with */
+    int16      special;       /* Special code */
+    int32      ret_value = SUCCEED;
+
+    /* clear error stack and check validity of args */
+    HEclear();
+
+    /* Check args */
+    if (origin == NULL || buflen < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* check the validity of the RI ID */
+    if (HAatom_group(riid) != RIIDGROUP)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* locate RI's object in hash table */
+    if (NULL == (ri_ptr = (ri_info_t *)HAatom_object(riid)))
+        HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
+
+    /* check if access id exists already */
+    if (ri_ptr->img_aid == 0) {
+        if (GRIgetaid(ri_ptr, DFACC_READ) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    }
+    else if (ri_ptr->img_aid == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* inquire about element */
+    ret_value = Hinquire(ri_ptr->img_aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
+    if (ret_value != FAIL) {
+        if (special == SPECIAL_CHUNKED)
+            ret_value = HMCreadChunkRaw(ri_ptr->img_aid, origin, datap, buflen);
+        else
+            ret_value = FAIL;
+    }
+
+done:
+    return ret_value;
+} /* GRreadchunkraw() */
+
+/******************************************************************************
+ NAME
+     GRwritechunkraw -- write the stored data of a chunk of the GR
+
+ DESCRIPTION
+     This routine writes 'length' bytes read by GRreadchunkraw() as the
+     chunk of the chunked GR specified by chunk 'origin', without
+     encoding, converting or reinterlacing them.  The GR must have the same
+     number type, number of components, chunk lengths and compression as
+     the one the data was read from, and the chunk must not have been
+     written yet.  The chunk table is updated as by GRwritechunk().
+
+     See GRsetchunk() for a description of the organization of chunks in an GR.
+
+     NOTE:
+         This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+ RETURNS
+        SUCCEED/FAIL
+******************************************************************************/
+intn
+GRwritechunkraw(int32       riid,   /* IN: access aid to GR */
+                int32      *origin, /* IN: origin of chunk to write */
+                const void *datap,  /* IN: stored chunk */
+                int32       length /* IN: number of bytes in 'datap' */)
+{
+    ri_info_t *ri_ptr = NULL; /* ptr to the image to work with */
+    int16      special;       /* Special code */
+    intn       ret_value = SUCCEED;
+
+    /* clear error stack and check validity of args */
+    HEclear();
+
+    /* Check args */
+    if (origin == NULL || datap == NULL || length <= 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* check the validity of the RI ID */
+    if (HAatom_group(riid) != RIIDGROUP)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* locate RI's object in hash table */
+    if (NULL == (ri_ptr = (ri_info_t *)HAatom_object(riid)))
+        HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
+
+    /* check if access id exists already */
+    if (ri_ptr->img_aid == 0) {
+        /* now get access id, use write access */
+        if (GRIgetaid(ri_ptr, DFACC_WRITE) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    }
+    else if (ri_ptr->img_aid == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* inquire about element */
+    ret_value = Hinquire(ri_ptr->img_aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
+    if (ret_value != FAIL) {
+        if (special == SPECIAL_CHUNKED) {
+            if (HMCwriteChunkRaw(ri_ptr->img_aid, origin, datap, length) == FAIL)
+                HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+            ret_value = SUCCEED;
+        }
+        else
+            ret_value = FAIL;
+    }
+
+done:
+    return ret_value;
+} /* GRwritechunkraw() */
+
 /******************************************************************************
 NAME
      GRsetchunkcache - maximum number of chunks to cache
@@ -5849,6 +6830,21 @@ DESCRIPTION
      in memory, otherwise pass in zero(0). Currently you can only
      pass in zero.
 
+     The policy used to pick the chunk to evict from a full cache can be
+     or'ed into 'flags': HDF_CACHE_LRU (the default, least recently used),
+     HDF_CACHE_CLOCK or HDF_CACHE_2Q.  HDF_CACHE_2Q is scan resistant:
+     chunks that were only read once, as in a pass across the data, are
+     evicted before chunks that were read again.
+
+     With HDF_CACHE_SHARED also or'ed into 'flags', the cache joins the
+     cache pool shared by all the datasets of the process, whose byte
+     budget is set with SDsetchunkcachebudget().  'maxcache' still bounds
+     the number of chunks cached and is the dataset's weight in the pool:
+     when the pool is full, chunks are evicted from the dataset holding
+     the most bytes relative to its weight.  Calling again without
+     HDF_CACHE_SHARED takes the cache out of the pool.  Thread-safe
+     builds have no pool and refuse HDF_CACHE_SHARED.
+
      See GRsetchunk() for a description of the organization of chunks in an GR.
 
      NOTE:
@@ -5879,7 +6875,7 @@ GRsetchunkcache(int32 riid,     /* IN: access aid to mess with */
         goto done;
     }
 
-    if (flags != 0 && flags != HDF_CACHEALL) {
+    if (!HDF_CACHE_FLAGS_OK(flags)) {
         ret_value = FAIL;
         goto done;
     }
@@ -5914,6 +6910,75 @@ done:
     return ret_value;
 } /* GRsetchunkcache() */
 
+/******************************************************************************
+NAME
+     GRsetchunkthreads - number of threads used to code chunks
+
+DESCRIPTION
+     Set the number of threads used to decode and encode the compressed
+     chunks of a chunked GR.
+
+     With 'nthreads' greater than 1, the deflate or LZ4 compressed chunks
+     that GRreadimage() has to bring into the chunk cache are decoded in
+     parallel on up to 'nthreads' threads, and new compressed chunks
+     written by GRwriteimage() or GRwritechunk() are held back and
+     compressed in parallel before they are written.  The remaining ones are
+     written when the GR is closed, so GRendaccess() reports any failure
+     to write them.  Passing 1 restores the serial behaviour.
+
+     See SDsetchunkthreads() for more details.
+
+     NOTE:
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+RETURNS
+     Returns the previous number of threads if successful and FAIL otherwise
+******************************************************************************/
+intn
+GRsetchunkthreads(int32 riid, /* IN: access aid to mess with */
+                  intn  nthreads /* IN: number of coding threads */)
+{
+    ri_info_t *ri_ptr = NULL; /* ptr to the image to work with */
+    int16      special;       /* Special code */
+    intn       ret_value = SUCCEED;
+
+    /* clear error stack and check validity of args */
+    HEclear();
+
+    /* Check args */
+    if (nthreads < 1)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* check the validity of the RI ID */
+    if (HAatom_group(riid) != RIIDGROUP)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* locate RI's object in hash table */
+    if (NULL == (ri_ptr = (ri_info_t *)HAatom_object(riid)))
+        HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
+
+    /* check if access id exists already */
+    if (ri_ptr->img_aid == 0) {
+        /* now get access id, use write access */
+        if (GRIgetaid(ri_ptr, DFACC_WRITE) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    }
+    else if (ri_ptr->img_aid == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* inquire about element */
+    ret_value = Hinquire(ri_ptr->img_aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
+    if (ret_value != FAIL) {
+        if (special == SPECIAL_CHUNKED) /* set threads */
+            ret_value = HMCsetThreads(ri_ptr->img_aid, nthreads);
+        else
+            ret_value = FAIL;
+    }
+
+done:
+    return ret_value;
+} /* GRsetchunkthreads() */
+
 /*---------------------------------------------------------------
 NAME
    GRmapped - Checks whether an RI is to be mapped (hmap project)
@@ -624,15 +624,17 @@ FRETVAL(intf)
 nmgisattr(intf *riid, _fcd name, intf *nt, intf *count, void *data, intf *nlen)
 {
     char *fn;
+    char  namebuf[H4_MAX_NC_NAME];
     intf  ret;
 
     /* Convert the FORTRAN string into a C string */
-    fn = HDf2cstring(name, (intn)*nlen);
+    fn = HDf2cstring_buf(name, (intn)*nlen, namebuf, (intn)sizeof(namebuf));
     if (fn == NULL)
         return FAIL;
 
     ret = (intf)GRsetattr((int32)*riid, fn, (int32)*nt, (int32)*count, data);
-    free(fn);
+    if (fn != namebuf)
+        free(fn);
 
     return ret;
 } /* end mgisattr() */
@@ -735,15 +737,17 @@ FRETVAL(intf)
 nmgifndat(intf *riid, _fcd name, intf *nlen)
 {
     char *fn;
+    char  namebuf[H4_MAX_NC_NAME];
     intf  ret;
 
     /* Convert the FORTRAN string into a C string */
-    fn = HDf2cstring(name, (intn)*nlen);
+    fn = HDf2cstring_buf(name, (intn)*nlen, namebuf, (intn)sizeof(namebuf));
     if (fn == NULL)
         return FAIL;
 
     ret = (intf)GRfindattr((int32)*riid, fn);
-    free(fn);
+    if (fn != namebuf)
+        free(fn);
 
     return ret;
 } /* end mgifndat() */
@@ -98,6 +98,7 @@ typedef struct ri_info {
     char          *name;             /* name of the image */
     int32          lattr_count;      /* # of local attr entries in ri_info so far */
     TBBT_TREE     *lattree;          /* Root of the local attribute B-Tree */
+    uintn          lattr_pending;    /* whether the local attributes are still to be read */
     intn           access;           /* the number of times this image has been selected */
     uintn          use_buf_drvr; /* access to image needs to be through the buffered special element driver */
     uintn use_cr_drvr; /* access to image needs to be through the compressed raster special element driver */
@@ -129,6 +130,8 @@ HDFLIBAPI void GRIgrdestroynode(void *n);
 
 HDFLIBAPI void GRIattrdestroynode(void *n);
 
+HDFLIBAPI intn GRIget_lattrs(ri_info_t *ri_ptr);
+
 HDFLIBAPI void GRIridestroynode(void *n);
 
 #ifdef __cplusplus
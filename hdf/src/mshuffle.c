@@ -0,0 +1,662 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*
+FILE
+   mshuffle.c
+   HDF byte shuffling modeling I/O routines
+
+REMARKS
+   The bytes of the elements are regrouped by significance before they
+   reach the encoding layer: all the first bytes of the elements, then all
+   the second bytes, and so on.  The high bytes of floating-point and wide
+   integer data change slowly from one element to the next, so the coders
+   find much longer matches in the shuffled data.
+
+DESIGN
+   The data is shuffled in blocks of SHUFFLE_BLOCK_SIZE bytes, rounded down
+   to whole elements, so a block can be decoded without the rest of the
+   element.  The bytes after the last whole element of the last block are
+   not shuffled.  The shuffled data has the length of the data, so the
+   positions in both are the same.
+
+   A block is handed to the coder once it is complete, or when the access
+   moves elsewhere.  The element must therefore be written sequentially,
+   from its beginning or from the end of the last complete block written
+   through the same access.
+
+EXPORTED ROUTINES
+   None of these routines are designed to be called by other users except
+   for the top layer of the compression routines.
+
+    HCPmshuffle_stread    -- start read access for compressed file
+    HCPmshuffle_stwrite   -- start write access for compressed file
+    HCPmshuffle_seek      -- Seek to offset within the data element
+    HCPmshuffle_read      -- Read in a portion of data from a compressed
+                              data element.
+    HCPmshuffle_write     -- Write out a portion of data from a compressed
+                              data element.
+    HCPmshuffle_inquire   -- Inquire information about the access record
+                              and data element.
+    HCPmshuffle_endaccess -- Close the compressed data element
+ */
+
+/* General HDF includes */
+#include "hdf.h"
+#include "hfile.h"
+
+/* HDF compression includes */
+#include "hcompi.h" /* Internal definitions for compression */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MSHUFFLE_X86
+#include <immintrin.h>
+#endif
+
+funclist_t mshuffle_funcs = {HCPmshuffle_stread,
+                             HCPmshuffle_stwrite,
+                             HCPmshuffle_seek,
+                             HCPmshuffle_inquire,
+                             HCPmshuffle_read,
+                             HCPmshuffle_write,
+                             HCPmshuffle_endaccess,
+                             NULL,
+                             NULL};
+
+/*****************************************************************************/
+/* VECTOR BYTE SHUFFLING                                                     */
+/*****************************************************************************/
+
+#ifdef MSHUFFLE_X86
+/* Byte shuffle grouping the bytes of four 4 byte elements by significance,
+   which is its own inverse */
+static const uint8 HCshuffle4_mask[16] = {0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15};
+
+/* Shuffles 'nelem' 4 byte elements, a multiple of 32, with AVX2; the
+   planes of bytes of the same significance are 'stride' bytes apart */
+__attribute__((target("avx2"))) static void
+HCIshuffle4_avx2(uint8 *dst, const uint8 *src, int32 nelem, int32 stride)
+{
+    __m256i mask = _mm256_broadcastsi128_si256(_mm_loadu_si128((const void *)HCshuffle4_mask));
+    __m256i perm = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    int32   i;
+
+    for (i = 0; i < nelem; i += 32) {
+        const uint8 *s = src + 4 * i;
+        __m256i      a, b, c, d, ab_lo, ab_hi, cd_lo, cd_hi;
+
+        /* each vector of 8 elements becomes four 8 byte planes */
+        a = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256((const void *)s), mask), perm);
+        b = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256((const void *)(s + 32)), mask),
+                                        perm);
+        c = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256((const void *)(s + 64)), mask),
+                                        perm);
+        d = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256((const void *)(s + 96)), mask),
+                                        perm);
+
+        /* then the planes of the four vectors are put together */
+        ab_lo = _mm256_unpacklo_epi64(a, b);
+        ab_hi = _mm256_unpackhi_epi64(a, b);
+        cd_lo = _mm256_unpacklo_epi64(c, d);
+        cd_hi = _mm256_unpackhi_epi64(c, d);
+        _mm256_storeu_si256((void *)(dst + i), _mm256_permute2x128_si256(ab_lo, cd_lo, 0x20));
+        _mm256_storeu_si256((void *)(dst + stride + i), _mm256_permute2x128_si256(ab_hi, cd_hi, 0x20));
+        _mm256_storeu_si256((void *)(dst + 2 * stride + i), _mm256_permute2x128_si256(ab_lo, cd_lo, 0x31));
+        _mm256_storeu_si256((void *)(dst + 3 * stride + i), _mm256_permute2x128_si256(ab_hi, cd_hi, 0x31));
+    }
+}
+
+/* Undoes HCIshuffle4_avx2() */
+__attribute__((target("avx2"))) static void
+HCIunshuffle4_avx2(uint8 *dst, const uint8 *src, int32 nelem, int32 stride)
+{
+    __m256i mask = _mm256_broadcastsi128_si256(_mm_loadu_si128((const void *)HCshuffle4_mask));
+    __m256i perm = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    int32   i;
+
+    for (i = 0; i < nelem; i += 32) {
+        uint8  *d = dst + 4 * i;
+        __m256i p0, p1, p2, p3, ab_lo, ab_hi, cd_lo, cd_hi, a, b, c, e;
+
+        p0    = _mm256_loadu_si256((const void *)(src + i));
+        p1    = _mm256_loadu_si256((const void *)(src + stride + i));
+        p2    = _mm256_loadu_si256((const void *)(src + 2 * stride + i));
+        p3    = _mm256_loadu_si256((const void *)(src + 3 * stride + i));
+        ab_lo = _mm256_permute2x128_si256(p0, p2, 0x20);
+        cd_lo = _mm256_permute2x128_si256(p0, p2, 0x31);
+        ab_hi = _mm256_permute2x128_si256(p1, p3, 0x20);
+        cd_hi = _mm256_permute2x128_si256(p1, p3, 0x31);
+        a     = _mm256_unpacklo_epi64(ab_lo, ab_hi);
+        b     = _mm256_unpackhi_epi64(ab_lo, ab_hi);
+        c     = _mm256_unpacklo_epi64(cd_lo, cd_hi);
+        e     = _mm256_unpackhi_epi64(cd_lo, cd_hi);
+        _mm256_storeu_si256((void *)d, _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(a, perm), mask));
+        _mm256_storeu_si256((void *)(d + 32), _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(b, perm), mask));
+        _mm256_storeu_si256((void *)(d + 64), _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(c, perm), mask));
+        _mm256_storeu_si256((void *)(d + 96), _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(e, perm), mask));
+    }
+}
+
+static intn HCshuffle_avx2    = FALSE; /* whether the processor has AVX2 */
+static intn HCshuffle_checked = FALSE; /* whether HCshuffle_avx2 was set */
+
+/* Returns the number of 4 byte elements of 'nelem' the AVX2 routines take */
+static int32
+HCIshuffle4_vector(int32 nelem)
+{
+    if (!HCshuffle_checked) {
+        __builtin_cpu_init();
+        HCshuffle_avx2    = __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+        HCshuffle_checked = TRUE;
+    }
+    return HCshuffle_avx2 ? (nelem & ~31) : 0;
+}
+#endif /* MSHUFFLE_X86 */
+
+/* Shuffles the 'len' bytes of 'src' into 'dst', by planes of 'nelem' bytes
+   of the same significance; the bytes after the last element are copied */
+static void
+HCIshuffle(uint8 *dst, const uint8 *src, int32 len, intn size)
+{
+    int32 nelem = len / size;
+    int32 done  = 0; /* elements done with vector instructions */
+    int32 i;
+    intn  b;
+
+#ifdef MSHUFFLE_X86
+    if (size == 4 && (done = HCIshuffle4_vector(nelem)) > 0)
+        HCIshuffle4_avx2(dst, src, done, nelem);
+#endif
+    for (b = 0; b < size; b++)
+        for (i = done; i < nelem; i++)
+            dst[b * nelem + i] = src[i * size + b];
+    memcpy(dst + nelem * size, src + nelem * size, (size_t)(len - nelem * size));
+}
+
+/* Undoes HCIshuffle() */
+static void
+HCIunshuffle(uint8 *dst, const uint8 *src, int32 len, intn size)
+{
+    int32 nelem = len / size;
+    int32 done  = 0; /* elements done with vector instructions */
+    int32 i;
+    intn  b;
+
+#ifdef MSHUFFLE_X86
+    if (size == 4 && (done = HCIshuffle4_vector(nelem)) > 0)
+        HCIunshuffle4_avx2(dst, src, done, nelem);
+#endif
+    for (i = done; i < nelem; i++)
+        for (b = 0; b < size; b++)
+            dst[i * size + b] = src[b * nelem + i];
+    memcpy(dst + nelem * size, src + nelem * size, (size_t)(len - nelem * size));
+}
+
+/*****************************************************************************/
+/* MODEL ROUTINES                                                            */
+/*****************************************************************************/
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIshuffle_staccess -- Set up the shuffle model for an access
+
+ USAGE
+    intn HCIshuffle_staccess(access_rec)
+    accrec_t *access_rec;   IN: the access record of the data element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Resets the positions and allocates the block buffers.
+--------------------------------------------------------------------------*/
+static intn
+HCIshuffle_staccess(accrec_t *access_rec)
+{
+    compinfo_t                *info;         /* information on the special element */
+    comp_model_shuffle_info_t *shuffle_info; /* ptr to shuffle info */
+
+    info         = (compinfo_t *)access_rec->special_info;
+    shuffle_info = &(info->minfo.model_info.shuffle_info);
+
+    shuffle_info->pos     = 0;
+    shuffle_info->block   = -1;
+    shuffle_info->buf_len = 0;
+    shuffle_info->dirty   = FALSE;
+    shuffle_info->writing = FALSE;
+    shuffle_info->coded   = 0;
+
+    if (shuffle_info->buf == NULL) {
+        if ((shuffle_info->buf = (uint8 *)malloc(2 * (size_t)shuffle_info->block_size)) == NULL)
+            HRETURN_ERROR(DFE_NOSPACE, FAIL);
+        shuffle_info->tmp = shuffle_info->buf + shuffle_info->block_size;
+    }
+    return SUCCEED;
+} /* HCIshuffle_staccess() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIshuffle_flush -- Hand the block being written to the coder
+
+ USAGE
+    intn HCIshuffle_flush(access_rec)
+    accrec_t *access_rec;   IN: the access record of the data element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Shuffles the bytes written to the current block and writes them out
+    through the coder.  The block stays in 'buf' for reading.
+--------------------------------------------------------------------------*/
+static intn
+HCIshuffle_flush(accrec_t *access_rec)
+{
+    compinfo_t                *info;         /* information on the special element */
+    comp_model_shuffle_info_t *shuffle_info; /* ptr to shuffle info */
+    int32                      length;       /* length of the element */
+    int32                      ret;
+
+    info         = (compinfo_t *)access_rec->special_info;
+    shuffle_info = &(info->minfo.model_info.shuffle_info);
+
+    if (!shuffle_info->dirty)
+        return SUCCEED;
+
+    HCIshuffle(shuffle_info->tmp, shuffle_info->buf, shuffle_info->buf_len, shuffle_info->elem_size);
+
+    /* The coders only take a write at the end of the element, and the
+       length of the element already counts the bytes held back here */
+    length       = info->length;
+    info->length = shuffle_info->coded;
+    ret          = (*(info->cinfo.coder_funcs.write))(access_rec, shuffle_info->buf_len, shuffle_info->tmp);
+    info->length = length;
+    if (ret == FAIL)
+        HRETURN_ERROR(DFE_CODER, FAIL);
+
+    shuffle_info->coded += shuffle_info->buf_len;
+    shuffle_info->dirty   = FALSE;
+    shuffle_info->writing = TRUE;
+    return SUCCEED;
+} /* HCIshuffle_flush() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIshuffle_load -- Read a block in through the coder
+
+ USAGE
+    intn HCIshuffle_load(access_rec, block)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 block;            IN: the offset of the block
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Decodes the block starting at 'block' and unshuffles it into 'buf'.
+--------------------------------------------------------------------------*/
+static intn
+HCIshuffle_load(accrec_t *access_rec, int32 block)
+{
+    compinfo_t                *info;         /* information on the special element */
+    comp_model_shuffle_info_t *shuffle_info; /* ptr to shuffle info */
+    int32                      len;          /* length of the block */
+
+    info         = (compinfo_t *)access_rec->special_info;
+    shuffle_info = &(info->minfo.model_info.shuffle_info);
+
+    len = MIN(shuffle_info->block_size, info->length - block);
+    if (len <= 0)
+        HRETURN_ERROR(DFE_RANGE, FAIL);
+
+    shuffle_info->block   = -1;
+    shuffle_info->writing = FALSE;
+    if (shuffle_info->coded != block) {
+        if ((*(info->cinfo.coder_funcs.seek))(access_rec, block, DF_START) == FAIL)
+            HRETURN_ERROR(DFE_CODER, FAIL);
+        shuffle_info->coded = block;
+    }
+    if ((*(info->cinfo.coder_funcs.read))(access_rec, len, shuffle_info->tmp) == FAIL)
+        HRETURN_ERROR(DFE_CODER, FAIL);
+    shuffle_info->coded += len;
+
+    HCIunshuffle(shuffle_info->buf, shuffle_info->tmp, len, shuffle_info->elem_size);
+    shuffle_info->block   = block;
+    shuffle_info->buf_len = len;
+    return SUCCEED;
+} /* HCIshuffle_load() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPmshuffle_stread -- start read access for compressed file
+
+ USAGE
+    int32 HCPmshuffle_stread(access_rec)
+    accrec_t *access_rec;   IN: the access record of the data element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Start read access on a compressed data element using the shuffle
+    modeling scheme.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+int32
+HCPmshuffle_stread(accrec_t *access_rec)
+{
+    compinfo_t *info; /* information on the special element */
+
+    info = (compinfo_t *)access_rec->special_info;
+
+    if (HCIshuffle_staccess(access_rec) == FAIL)
+        HRETURN_ERROR(DFE_MINIT, FAIL);
+    if ((*(info->cinfo.coder_funcs.stread))(access_rec) == FAIL)
+        HRETURN_ERROR(DFE_CODER, FAIL);
+    return SUCCEED;
+} /* HCPmshuffle_stread() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPmshuffle_stwrite -- start write access for compressed file
+
+ USAGE
+    int32 HCPmshuffle_stwrite(access_rec)
+    accrec_t *access_rec;   IN: the access record of the data element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Start write access on a compressed data element using the shuffle
+    modeling scheme.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+int32
+HCPmshuffle_stwrite(accrec_t *access_rec)
+{
+    compinfo_t *info; /* information on the special element */
+
+    info = (compinfo_t *)access_rec->special_info;
+
+    if (HCIshuffle_staccess(access_rec) == FAIL)
+        HRETURN_ERROR(DFE_MINIT, FAIL);
+    if ((*(info->cinfo.coder_funcs.stwrite))(access_rec) == FAIL)
+        HRETURN_ERROR(DFE_CODER, FAIL);
+    return SUCCEED;
+} /* HCPmshuffle_stwrite() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPmshuffle_seek -- Seek to offset within the data element
+
+ USAGE
+    int32 HCPmshuffle_seek(access_rec,offset,origin)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 offset;       IN: the offset in bytes from the origin specified
+    intn origin;        IN: the origin to seek from [UNUSED!]
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Seek to a position with a compressed data element.  The 'origin'
+    calculations have been taken care of at a higher level, it is an
+    un-used parameter.  The 'offset' is used as an absolute offset
+    because of this.  The coder is only moved when a block is read.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+int32
+HCPmshuffle_seek(accrec_t *access_rec, int32 offset, int origin)
+{
+    compinfo_t *info; /* information on the special element */
+
+    (void)origin;
+
+    info = (compinfo_t *)access_rec->special_info;
+
+    /* a seek to where the writes left off keeps the block being written */
+    if (offset == info->minfo.model_info.shuffle_info.pos)
+        return SUCCEED;
+    if (HCIshuffle_flush(access_rec) == FAIL)
+        HRETURN_ERROR(DFE_MODEL, FAIL);
+
+    /* set the offset */
+    info->minfo.model_info.shuffle_info.pos = offset;
+    return SUCCEED;
+} /* HCPmshuffle_seek() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPmshuffle_read -- Read in a portion of data from a compressed data element.
+
+ USAGE
+    int32 HCPmshuffle_read(access_rec,length,data)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 length;           IN: the number of bytes to read
+    void * data;             OUT: the buffer to place the bytes read
+
+ RETURNS
+    Returns the number of bytes read or FAIL
+
+ DESCRIPTION
+    Read in a number of bytes from a compressed data element, unshuffling
+    the blocks they are in.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+int32
+HCPmshuffle_read(accrec_t *access_rec, int32 length, void *data)
+{
+    compinfo_t                *info;         /* information on the special element */
+    comp_model_shuffle_info_t *shuffle_info; /* ptr to shuffle info */
+    uint8                     *p = (uint8 *)data;
+    int32                      left; /* bytes still to read */
+    int32                      block;
+    int32                      n;
+
+    info         = (compinfo_t *)access_rec->special_info;
+    shuffle_info = &(info->minfo.model_info.shuffle_info);
+
+    if (HCIshuffle_flush(access_rec) == FAIL)
+        HRETURN_ERROR(DFE_MODEL, FAIL);
+
+    for (left = length; left > 0; left -= n) {
+        block = shuffle_info->pos - shuffle_info->pos % shuffle_info->block_size;
+        if (block != shuffle_info->block ||
+            shuffle_info->buf_len != MIN(shuffle_info->block_size, info->length - block))
+            if (HCIshuffle_load(access_rec, block) == FAIL)
+                HRETURN_ERROR(DFE_MODEL, FAIL);
+
+        n = MIN(left, shuffle_info->buf_len - (shuffle_info->pos - block));
+        memcpy(p, shuffle_info->buf + (shuffle_info->pos - block), (size_t)n);
+        p += n;
+        shuffle_info->pos += n;
+    }
+    return length;
+} /* HCPmshuffle_read() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPmshuffle_write -- Write out a portion of data from a compressed data element.
+
+ USAGE
+    int32 HCPmshuffle_write(access_rec,length,data)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 length;           IN: the number of bytes to write
+    void * data;             IN: the buffer to retrieve the bytes written
+
+ RETURNS
+    Returns the number of bytes written or FAIL
+
+ DESCRIPTION
+    Write out a number of bytes to a compressed data element.  The bytes
+    are collected into blocks, which are shuffled and passed to the coder
+    once they are complete.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+    Only sequential writes are supported, see the DESIGN notes above.
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+int32
+HCPmshuffle_write(accrec_t *access_rec, int32 length, const void *data)
+{
+    compinfo_t                *info;         /* information on the special element */
+    comp_model_shuffle_info_t *shuffle_info; /* ptr to shuffle info */
+    const uint8               *p = (const uint8 *)data;
+    int32                      left; /* bytes still to write */
+    int32                      n;
+
+    info         = (compinfo_t *)access_rec->special_info;
+    shuffle_info = &(info->minfo.model_info.shuffle_info);
+
+    /* Continue the block being written, or start a new one */
+    if (shuffle_info->dirty) {
+        if (shuffle_info->pos != shuffle_info->block + shuffle_info->buf_len)
+            HRETURN_ERROR(DFE_UNSUPPORTED, FAIL);
+    }
+    else {
+        if (shuffle_info->pos == 0 && shuffle_info->coded != 0) {
+            /* rewrite the element from its beginning */
+            if ((*(info->cinfo.coder_funcs.seek))(access_rec, 0, DF_START) == FAIL)
+                HRETURN_ERROR(DFE_CODER, FAIL);
+            shuffle_info->coded = 0;
+        }
+        else if (shuffle_info->pos != 0 && (!shuffle_info->writing || shuffle_info->pos != shuffle_info->coded ||
+                                            shuffle_info->pos % shuffle_info->block_size != 0))
+            HRETURN_ERROR(DFE_UNSUPPORTED, FAIL);
+        shuffle_info->block   = shuffle_info->pos;
+        shuffle_info->buf_len = 0;
+    }
+
+    for (left = length; left > 0; left -= n) {
+        if (shuffle_info->buf_len == shuffle_info->block_size) {
+            shuffle_info->block += shuffle_info->block_size;
+            shuffle_info->buf_len = 0;
+        }
+        n = MIN(left, shuffle_info->block_size - shuffle_info->buf_len);
+        memcpy(shuffle_info->buf + shuffle_info->buf_len, p, (size_t)n);
+        p += n;
+        shuffle_info->buf_len += n;
+        shuffle_info->dirty = TRUE;
+
+        if (shuffle_info->buf_len == shuffle_info->block_size && HCIshuffle_flush(access_rec) == FAIL)
+            HRETURN_ERROR(DFE_MODEL, FAIL);
+    }
+
+    /* adjust model position */
+    shuffle_info->pos += length;
+    return length;
+} /* HCPmshuffle_write() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPmshuffle_inquire -- Inquire information about the access record and data element.
+
+ USAGE
+    int32 HCPmshuffle_inquire(access_rec,pfile_id,ptag,pref,plength,poffset,pposn,
+            paccess,pspecial)
+    accrec_t *access_rec;   IN: the access record of the data element
+    int32 *pfile_id;        OUT: ptr to file id
+    uint16 *ptag;           OUT: ptr to tag of information
+    uint16 *pref;           OUT: ptr to ref of information
+    int32 *plength;         OUT: ptr to length of data element
+    int32 *poffset;         OUT: ptr to offset of data element
+    int32 *pposn;           OUT: ptr to position of access in element
+    int16 *paccess;         OUT: ptr to access mode
+    int16 *pspecial;        OUT: ptr to special code
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Inquire information about the access record and data element.
+    [Currently a NOP].
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+int32
+HCPmshuffle_inquire(accrec_t *access_rec, int32 *pfile_id, uint16 *ptag, uint16 *pref, int32 *plength,
+                    int32 *poffset, int32 *pposn, int16 *paccess, int16 *pspecial)
+{
+    compinfo_t *info; /* information on the special element */
+    int32       ret;
+
+    info = (compinfo_t *)access_rec->special_info;
+    if ((ret = (*(info->cinfo.coder_funcs.inquire))(access_rec, pfile_id, ptag, pref, plength, poffset, pposn,
+                                                    paccess, pspecial)) == FAIL)
+        HRETURN_ERROR(DFE_CODER, FAIL);
+    return ret;
+} /* HCPmshuffle_inquire() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPmshuffle_endaccess -- Close the compressed data element
+
+ USAGE
+    intn HCPmshuffle_endaccess(access_rec)
+    accrec_t *access_rec;   IN: the access record of the data element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Write out the last block, close the compressed data element and free
+    modelling info.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+intn
+HCPmshuffle_endaccess(accrec_t *access_rec)
+{
+    compinfo_t                *info;         /* information on the special element */
+    comp_model_shuffle_info_t *shuffle_info; /* ptr to shuffle info */
+    intn                       flushed;
+    intn                       ret;
+
+    info         = (compinfo_t *)access_rec->special_info;
+    shuffle_info = &(info->minfo.model_info.shuffle_info);
+
+    flushed = HCIshuffle_flush(access_rec);
+    free(shuffle_info->buf);
+    shuffle_info->buf = shuffle_info->tmp = NULL;
+
+    if ((ret = (*(info->cinfo.coder_funcs.endaccess))(access_rec)) == FAIL)
+        HRETURN_ERROR(DFE_CODER, FAIL);
+    if (flushed == FAIL)
+        HRETURN_ERROR(DFE_MODEL, FAIL);
+    return ret;
+} /* HCPmshuffle_endaccess() */
@@ -0,0 +1,75 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*-----------------------------------------------------------------------------
+ * File:    mshuffle.h
+ * Purpose: Header file for byte shuffling modeling information.
+ * Dependencies: should be included after hdf.h
+ * Invokes:
+ * Contents: Structures & definitions for shuffle modeling.  This header
+ *              should only be included in hcomp.c and mshuffle.c.
+ * Structure definitions:
+ * Constant definitions: SHUFFLE_BLOCK_SIZE
+ *---------------------------------------------------------------------------*/
+
+#ifndef H4_MSHUFFLE_H
+#define H4_MSHUFFLE_H
+
+/* Bytes of data shuffled together, rounded down to whole elements */
+#define SHUFFLE_BLOCK_SIZE 65536
+
+/* model information about shuffle model */
+typedef struct {
+    intn   elem_size;  /* bytes in one element, the stride of the shuffle */
+    int32  block_size; /* bytes shuffled together, a multiple of elem_size */
+    int32  pos;        /* position of the model in the unshuffled data */
+    int32  block;      /* offset of the block held in 'buf', -1 if none */
+    int32  buf_len;    /* number of bytes of the block held in 'buf' */
+    intn   dirty;      /* TRUE if 'buf' was written but not handed to the coder */
+    intn   writing;    /* TRUE if the coder was last used for writing */
+    int32  coded;      /* position of the coder in the shuffled data */
+    uint8 *buf;        /* the block as the user sees it */
+    uint8 *tmp;        /* the block as the coder sees it */
+} comp_model_shuffle_info_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+HDFLIBAPI funclist_t mshuffle_funcs;
+
+/*
+ ** from mshuffle.c
+ */
+
+HDFLIBAPI int32 HCPmshuffle_stread(accrec_t *rec);
+
+HDFLIBAPI int32 HCPmshuffle_stwrite(accrec_t *rec);
+
+HDFLIBAPI int32 HCPmshuffle_seek(accrec_t *access_rec, int32 offset, int origin);
+
+HDFLIBAPI int32 HCPmshuffle_inquire(accrec_t *access_rec, int32 *pfile_id, uint16 *ptag, uint16 *pref,
+                                    int32 *plength, int32 *poffset, int32 *pposn, int16 *paccess,
+                                    int16 *pspecial);
+
+HDFLIBAPI int32 HCPmshuffle_read(accrec_t *access_rec, int32 length, void *data);
+
+HDFLIBAPI int32 HCPmshuffle_write(accrec_t *access_rec, int32 length, const void *data);
+
+HDFLIBAPI intn HCPmshuffle_endaccess(accrec_t *access_rec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H4_MSHUFFLE_H */
@@ -21,10 +21,22 @@
 
 #define TBBT_INTERNALS
 #include "tbbt.h"
+#include "hlock.h"
 
 #define KEYcmp(k1, k2, a)                                                                                    \
     ((NULL != compar) ? (*compar)(k1, k2, a) : memcmp(k1, k2, 0 < (a) ? (a) : (intn)strlen(k1)))
 
+/* Number of nodes in the first and largest blocks of the nodes of a tree */
+#define TBBT_SLAB_MIN 8
+#define TBBT_SLAB_MAX 512
+
+/* Block of nodes of a tree, from which tbbtdins() allocates the nodes */
+struct tbbt_slab {
+    struct tbbt_slab *next;     /* Previous block allocated for the tree */
+    size_t            size;     /* # of bytes of the block */
+    TBBT_NODE         nodes[1]; /* First of the nodes of the block */
+};
+
 void tbbt1dump(TBBT_NODE *node, intn method);
 
 /* Function Prototypes */
@@ -34,6 +46,13 @@ extern void tbbt_dump(TBBT_TREE *ptree, void (*key_dump)(void *, void *), intn m
 
 static TBBT_NODE *tbbt_get_node(void);
 static void       tbbt_release_node(TBBT_NODE *nod);
+static TBBT_NODE *tbbt_get_tree_node(TBBT_TREE *tree);
+static void       tbbt_release_tree_node(TBBT_TREE *tree, TBBT_NODE *nod);
+static TBBT_NODE *tbbt_insert(TBBT_NODE **root, TBBT_TREE *tree, void *item, void *key,
+                              intn (*compar)(void *, void *, intn), intn arg);
+static void       tbbt_drop_index(TBBT_TREE *tree);
+static TBBT_NODE *tbbt_index_fill(TBBT_TREE *tree, unsigned long i, TBBT_NODE *node);
+static TBBT_NODE *tbbt_index_find(TBBT_TREE *tree, void *key);
 
 /* Returns pointer to end-most (to LEFT or RIGHT) node of tree: */
 static TBBT_NODE *
@@ -184,6 +203,8 @@ tbbtdfind(TBBT_TREE *tree, void *key, TBBT_NODE **pp)
 {
     if (tree == NULL)
         return NULL;
+    if (tree->index_nodes != NULL && NULL == pp)
+        return tbbt_index_find(tree, key);
     if (tree->fast_compare != 0)
         return tbbtffind(tree->root, key, tree->fast_compare, pp);
     else
@@ -476,11 +497,21 @@ balance(TBBT_NODE **root, TBBT_NODE *ptr, intn side, intn added)
 TBBT_NODE *
 tbbtins(TBBT_NODE **root, void *item, void *key,
         intn (*compar)(void * /* k1 */, void * /* k2 */, intn /* arg */), intn arg)
+{
+    return tbbt_insert(root, NULL, item, key, compar, arg);
+}
+
+/* tbbt_insert -- Insert a node into a tree, taking the node from the blocks
+ * of `tree' if it is not NULL or from the free list otherwise */
+static TBBT_NODE *
+tbbt_insert(TBBT_NODE **root, TBBT_TREE *tree, void *item, void *key,
+            intn (*compar)(void * /* k1 */, void * /* k2 */, intn /* arg */), intn arg)
 {
     intn       cmp;
     TBBT_NODE *ptr, *parent;
 
-    if (NULL != tbbtfind(*root, (key ? key : item), compar, arg, &parent) || NULL == (ptr = tbbt_get_node()))
+    if (NULL != tbbtfind(*root, (key ? key : item), compar, arg, &parent) ||
+        NULL == (ptr = (tree != NULL ? tbbt_get_tree_node(tree) : tbbt_get_node())))
         return NULL;
     ptr->data   = item;
     ptr->key    = key ? key : item;
@@ -517,9 +548,11 @@ tbbtdins(TBBT_TREE *tree, void *item, void *key)
 
     if (tree == NULL)
         return NULL;
-    ret_node = tbbtins(&(tree->root), item, key, tree->compar, tree->cmparg);
-    if (ret_node != NULL)
+    ret_node = tbbt_insert(&(tree->root), tree, item, key, tree->compar, tree->cmparg);
+    if (ret_node != NULL) {
         tree->count++;
+        tbbt_drop_index(tree);
+    }
     return ret_node;
 }
 
@@ -544,7 +577,8 @@ tbbtrem(TBBT_NODE **root, TBBT_NODE *node, void **kp)
     void      *data; /* Saved pointer to data item of deleted node */
 
     if (NULL == root || NULL == node)
-        return NULL;   /* Argument couldn't find node to delete */
+        return NULL; /* Argument couldn't find node to delete */
+    tbbt_drop_index((TBBT_TREE *)root);
     data = node->data; /* Save pointer to data item to be returned at end */
     if (NULL != kp)
         *kp = node->key;
@@ -585,7 +619,7 @@ tbbtrem(TBBT_NODE **root, TBBT_NODE *node, void **kp)
             else { /* Case 3b: Remove last node of tree: */
                 *root = NULL;
             } /* end else */
-            tbbt_release_node(node);
+            tbbt_release_tree_node((TBBT_TREE *)root, node);
             return data;
         }
         side = (par->Rchild == leaf) ? RIGHT : LEFT;
@@ -638,7 +672,7 @@ tbbtrem(TBBT_NODE **root, TBBT_NODE *node, void **kp)
             n->link[side] = next;
         } /* end else */
     }
-    tbbt_release_node(leaf);
+    tbbt_release_tree_node((TBBT_TREE *)root, leaf);
     balance(root, par, side, -1);
     ((TBBT_TREE *)root)->count--;
     return data;
@@ -658,6 +692,12 @@ tbbtdmake(intn (*cmp)(void * /* k1 */, void * /* k2 */, intn /* arg */), intn ar
     tree->fast_compare = fast_compare;
     tree->compar       = cmp;
     tree->cmparg       = arg;
+    tree->free_nodes   = NULL;
+    tree->slabs        = NULL;
+    tree->slab_nodes   = TBBT_SLAB_MIN;
+    tree->index_nodes  = NULL;
+    tree->index_keys   = NULL;
+    tree->index_len    = 0;
 
     return tree;
 }
@@ -827,14 +867,123 @@ tbbt_dump(TBBT_TREE *ptree, void (*key_dump)(void *, void *), intn method)
 TBBT_TREE *
 tbbtdfree(TBBT_TREE *tree, void (*fd)(void * /* item */), void (*fk)(void * /* key */))
 {
+    TBBT_NODE        *node;
+    struct tbbt_slab *slab;
+
     if (tree == NULL)
         return NULL;
 
-    tbbtfree(&tree->root, fd, fk);
+    /* The nodes are released with their blocks, so only visit them when
+       there are items or keys to free */
+    if (NULL != fd || NULL != fk)
+        for (node = tbbtfirst(tree->root); NULL != node; node = tbbtnext(node)) {
+            if (NULL != fd)
+                (*fd)(node->data);
+            if (NULL != fk)
+                (*fk)(node->key);
+        }
+    tbbt_drop_index(tree);
+    while (NULL != (slab = tree->slabs)) {
+        tree->slabs = slab->next;
+        HDmem_release(HDF_MEM_TBBT, slab->size);
+        HDmeta_free(slab);
+    }
     free(tree);
     return NULL;
 }
 
+/* tbbtdindex -- Build the search index of a "described" tree */
+/* Returns SUCCEED, or FAIL if the index could not be allocated */
+intn
+tbbtdindex(TBBT_TREE *tree)
+{
+    TBBT_NODE    *node;
+    unsigned long n = 0;
+
+    if (tree == NULL)
+        return FAIL;
+
+    tbbt_drop_index(tree);
+    for (node = tbbtfirst(tree->root); NULL != node; node = tbbtnext(node))
+        n++;
+    if (n == 0)
+        return SUCCEED;
+
+    /* both arrays are indexed from 1, so the children of i are 2i and 2i+1 */
+    if (NULL == (tree->index_nodes = malloc((n + 1) * sizeof(TBBT_NODE *))))
+        return FAIL;
+    if (tree->fast_compare != 0 && NULL == (tree->index_keys = malloc((n + 1) * sizeof(int32)))) {
+        tbbt_drop_index(tree);
+        return FAIL;
+    }
+    tree->index_len = n;
+    tbbt_index_fill(tree, 1, tbbtfirst(tree->root));
+
+    return SUCCEED;
+}
+
+/* tbbt_drop_index -- Free the search index of a tree, if it has one */
+static void
+tbbt_drop_index(TBBT_TREE *tree)
+{
+    if (tree->index_nodes == NULL)
+        return;
+    free(tree->index_nodes);
+    free(tree->index_keys);
+    tree->index_nodes = NULL;
+    tree->index_keys  = NULL;
+    tree->index_len   = 0;
+}
+
+/* tbbt_index_fill -- Put the nodes from `node' on, in order, in the sub-tree
+ * of the index rooted at `i' */
+/* Returns the node following the last one put in the index */
+static TBBT_NODE *
+tbbt_index_fill(TBBT_TREE *tree, unsigned long i, TBBT_NODE *node)
+{
+    if (i > tree->index_len)
+        return node;
+
+    node                 = tbbt_index_fill(tree, 2 * i, node);
+    tree->index_nodes[i] = node;
+    if (tree->index_keys != NULL)
+        tree->index_keys[i] = (tree->fast_compare == TBBT_FAST_UINT16_COMPARE) ? (int32)(*(uint16 *)node->key)
+                                                                               : *(int32 *)node->key;
+    return tbbt_index_fill(tree, 2 * i + 1, tbbtnext(node));
+}
+
+/* tbbt_index_find -- Look up a node in the search index of a tree */
+/* Returns a pointer to the found node (or NULL) */
+static TBBT_NODE *
+tbbt_index_find(TBBT_TREE *tree, void *key)
+{
+    intn (*compar)(void *, void *, intn) = tree->compar;
+    unsigned long i                        = 1;
+    int32         k                        = 0;
+
+    /* descend to the right of every node lower than `key', so that the last
+       node descended to the left of is the first one not lower than it */
+    if (tree->index_keys != NULL) {
+        k = (tree->fast_compare == TBBT_FAST_UINT16_COMPARE) ? (int32)(*(uint16 *)key) : *(int32 *)key;
+        while (i <= tree->index_len)
+            i = 2 * i + (tree->index_keys[i] < k);
+    }
+    else
+        while (i <= tree->index_len)
+            i = 2 * i + (KEYcmp(tree->index_nodes[i]->key, key, tree->cmparg) < 0);
+
+    /* undo the descents to the right that followed it, then the one left */
+    while (i & 1)
+        i >>= 1;
+    i >>= 1;
+    if (i == 0)
+        return NULL;
+
+    if (tree->index_keys != NULL)
+        return (tree->index_keys[i] == k) ? tree->index_nodes[i] : NULL;
+    return (0 == KEYcmp(key, tree->index_nodes[i]->key, tree->cmparg)) ? tree->index_nodes[i] : NULL;
+}
+
 /* returns the number of nodes in the tree */
 long
 tbbtcount(TBBT_TREE *tree)
@@ -862,12 +1011,17 @@ tbbt_get_node(void)
 {
     TBBT_NODE *ret_value = NULL;
 
+    HL_LOCK_LIBRARY();
     if (tbbt_free_list != NULL) {
         ret_value      = tbbt_free_list;
         tbbt_free_list = tbbt_free_list->Lchild;
     }
-    else
-        ret_value = malloc(sizeof(TBBT_NODE));
+    HL_UNLOCK_LIBRARY();
+    if (ret_value != NULL)
+        HDmem_release(HDF_MEM_FREE_LISTS, sizeof(TBBT_NODE));
+    else if ((ret_value = malloc(sizeof(TBBT_NODE))) == NULL)
+        return NULL;
+    HDmem_acquire(HDF_MEM_TBBT, sizeof(TBBT_NODE));
 
     return ret_value;
 } /* end tbbt_get_node() */
@@ -887,10 +1041,79 @@ static void
 tbbt_release_node(TBBT_NODE *nod)
 {
     /* Insert the atom at the beginning of the free list */
+    HL_LOCK_LIBRARY();
     nod->Lchild    = tbbt_free_list;
     tbbt_free_list = nod;
+    HL_UNLOCK_LIBRARY();
+    HDmem_release(HDF_MEM_TBBT, sizeof(TBBT_NODE));
+    HDmem_acquire(HDF_MEM_FREE_LISTS, sizeof(TBBT_NODE));
 } /* end tbbt_release_node() */
 
+/******************************************************************************
+ NAME
+     tbbt_get_tree_node - Gets a node for a tree made with tbbtdmake()
+
+ DESCRIPTION
+    Takes a node from the nodes removed from the tree if there is one, or
+    else from the last block of nodes allocated for the tree.  A new block
+    is allocated when the last one is used up, each one twice as large as
+    the one before up to TBBT_SLAB_MAX nodes, so that the nodes of a tree
+    lie close together and tbbtdfree() can release them all at once.
+
+ RETURNS
+    Returns tbbt ptr if successful and NULL otherwise
+
+*******************************************************************************/
+static TBBT_NODE *
+tbbt_get_tree_node(TBBT_TREE *tree)
+{
+    struct tbbt_slab *slab;
+    TBBT_NODE        *ret_value;
+    size_t            size;
+    uintn             u;
+
+    if (tree->free_nodes == NULL) {
+        size = sizeof(struct tbbt_slab) + (tree->slab_nodes - 1) * sizeof(TBBT_NODE);
+        if ((slab = HDmeta_alloc(size)) == NULL)
+            return NULL;
+        slab->next  = tree->slabs;
+        slab->size  = size;
+        tree->slabs = slab;
+        HDmem_acquire(HDF_MEM_TBBT, size);
+
+        /* thread the new nodes on the free list, first node at the head */
+        for (u = tree->slab_nodes; u > 0; u--) {
+            slab->nodes[u - 1].Lchild = tree->free_nodes;
+            tree->free_nodes          = &slab->nodes[u - 1];
+        }
+        if (tree->slab_nodes < TBBT_SLAB_MAX)
+            tree->slab_nodes *= 2;
+    }
+    ret_value        = tree->free_nodes;
+    tree->free_nodes = ret_value->Lchild;
+
+    return ret_value;
+} /* end tbbt_get_tree_node() */
+
+/******************************************************************************
+ NAME
+     tbbt_release_tree_node - Releases a node of a tree made with tbbtdmake()
+
+ DESCRIPTION
+    Puts a node into the list of nodes removed from the tree, for the next
+    insertion into the same tree
+
+ RETURNS
+    No return value
+
+*******************************************************************************/
+static void
+tbbt_release_tree_node(TBBT_TREE *tree, TBBT_NODE *nod)
+{
+    nod->Lchild      = tree->free_nodes;
+    tree->free_nodes = nod;
+} /* end tbbt_release_tree_node() */
+
 /*--------------------------------------------------------------------------
  NAME
     tbbt_shutdown
@@ -914,12 +1137,15 @@ tbbt_shutdown(void)
     TBBT_NODE *curr;
 
     /* Release the free-list if it exists */
+    HL_LOCK_LIBRARY();
     if (tbbt_free_list != NULL) {
         while (tbbt_free_list != NULL) {
             curr           = tbbt_free_list;
             tbbt_free_list = tbbt_free_list->Lchild;
             free(curr);
+            HDmem_release(HDF_MEM_FREE_LISTS, sizeof(TBBT_NODE));
         }
     }
+    HL_UNLOCK_LIBRARY();
     return SUCCEED;
 } /* end tbbt_shutdown() */
@@ -73,7 +73,13 @@ struct tbbt_tree {
     unsigned long count;        /* The number of nodes in the tree currently */
     uintn         fast_compare; /* use a faster in-line compare (with casts) instead of function call */
     intn (*compar)(void *k1, void *k2, intn cmparg);
-    intn cmparg;
+    intn              cmparg;
+    TBBT_NODE        *free_nodes;  /* Removed nodes, reused before the slabs grow */
+    struct tbbt_slab *slabs;       /* Blocks of nodes the tree allocates its nodes from */
+    uintn             slab_nodes;  /* Number of nodes in the next block allocated */
+    TBBT_NODE       **index_nodes; /* Nodes in Eytzinger order for tbbtdfind(), or NULL */
+    int32            *index_keys;  /* Keys of index_nodes, for a "fast compare" tree */
+    unsigned long     index_len;   /* Number of nodes in index_nodes */
 #endif /* TBBT_INTERNALS */
 };
 
@@ -185,7 +191,6 @@ HDFLIBAPI TBBT_TREE *tbbtdmake(intn (*compar)(void *, void *, intn), intn arg, u
  *     node= tbbtdless( tree1, key, NULL );
  *     node= tbbtless( *tree1, key, compar, arg, NULL );
  *     node= tbbtdins( tree1, item, key );
- *     node= tbbtins( tree1, item, key, compar, arg );
  *     item= tbbtrem( tree1, tbbtdfind(tree1,key,NULL), NULL );
  *     item= tbbtrem( tree1, tbbtfind(*tree1,key,compar,arg,NULL), NULL );
  *     tree1= tbbtdfree( tree1, free, NULL );       (* or whatever *)
@@ -197,7 +202,22 @@ HDFLIBAPI TBBT_TREE *tbbtdmake(intn (*compar)(void *, void *, intn), intn arg, u
  *     node= tbbtrem( &root, tbbtfind(root,key), NULL );
  *     tbbtfree( &root, free, NULL );               (* or whatever *)
  * Never use tbbtfree() on a tree allocated with tbbtdmake() or on a sub-tree
- * of ANY tree.  Never use tbbtdfree() except on a tbbtdmake()d tree.
+ * of ANY tree.  Never use tbbtdfree() except on a tbbtdmake()d tree.  The
+ * nodes of a tbbtdmake()d tree are allocated in blocks that belong to the
+ * tree, so only ever add nodes to it with tbbtdins().
+ */
+
+HDFLIBAPI intn tbbtdindex(TBBT_TREE *tree);
+/* Builds a search index for a tree made with tbbtdmake() that is done being
+ * loaded and is searched much more often than it is changed.  tbbtdfind()
+ * then looks keys up by a binary search of an array of the nodes laid out in
+ * Eytzinger (breadth-first) order, keeping the keys of a "fast compare" tree
+ * in an array of their own, instead of following the links of the tree from
+ * node to node.  The nodes found are the nodes of the tree, so tbbtnext() and
+ * the other routines work on them as before.  Inserting or removing a node
+ * drops the index; call tbbtdindex() again to rebuild it.  Returns SUCCEED,
+ * or FAIL if the index could not be allocated, in which case the tree is
+ * searched as before.
  */
 
 HDFLIBAPI TBBT_NODE *tbbtdfind(TBBT_TREE *tree, void *key, TBBT_NODE **pp);
@@ -274,7 +294,9 @@ HDFLIBAPI void       tbbtfree(TBBT_NODE **root, void (*fd)(void *), void (*fk)(v
  * is NULL, no action is done for the key values (they were allocated on the
  * stack, as a part of each data item, or together with one malloc() call, for
  * example) and likewise for `fd'.  tbbtdfree() always returns NULL and
- * tbbtfree() always sets `root' to be NULL.
+ * tbbtfree() always sets `root' to be NULL.  tbbtdfree() releases the blocks
+ * the nodes of the tree were allocated from at once and only visits the nodes
+ * when `fd' or `fk' is not NULL.
  */
 
 HDFLIBAPI void tbbtprint(TBBT_NODE *node);
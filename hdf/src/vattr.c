@@ -135,6 +135,9 @@
 *   intn VSgetattr(int32 vsid, int32 findex, intn attrindex,
 *                  void * values)
 *        get values of an attribute
+*   int32 VSreadallattrs(int32 vsid, int32 findex, hdf_attr_t attrs[],
+*                  int32 max_attrs, void *arena, int32 *arena_size)
+*        get names, info and values of all the attrs of a field/vdata
 *   intn VSisattr(int32 vsid)
 *        test if a vdata is an attribute of other object
 *   < int32 VSgetversion(int32 vsid) already defined in vio.c >
@@ -163,15 +166,22 @@
 *	 that are counted by Vnattrs2.
 *   int32 Vgetversion(int32 vgid)
 *        get vset version of a vgroup
+*   intn Vsetcompactattr(HFILEID f, intn compact_on)
+*        keep small vgroup attrs in a compact attribute store
 * Private routines:
+*   VIattr_store_load -- read the compact attribute store of a vgroup
+*   VIattr_store_find -- get the compact attr of an attribute index
+*   VIattr_store_flush -- write the compact attribute store out
+*   VIattr_store_datainfo -- get the offset/length of a compact attr
+*   VIattr_store_free -- free the compact attribute store
 *
 * Affected existing functions:
 *    vgp.c:vunpackvg--VPgetinfo
-*    vgp.c:VPgetinfo--Load_vfile--vinitialize
+*    vgp.c:VPgetinfo--vginst
 *    vgp.c:vpackvg--Vdetach
 *    vgp.c:Vattach
 *    vgp.c:Vdestroynode--Remove_file--Vfinish
-*    vio.c:VSPgetinfo--Load_vfile--vinitialize
+*    vio.c:VSPgetinfo--vsinst
 *    vio.c:vpackvs
 *    vio.c:vunpackvs
 *    vio.c:VSdetach
@@ -204,12 +214,10 @@ DESCRIPTION
 intn
 VSfindex(int32 vsid, const char *fieldname, int32 *findex)
 {
-    vsinstance_t   *vs_inst;
-    VDATA          *vs;
-    DYN_VWRITELIST *w;
-    int32           nflds;
-    int32           ret_value = SUCCEED;
-    intn            i, found = 0;
+    vsinstance_t *vs_inst;
+    VDATA        *vs;
+    intn          i;
+    int32         ret_value = SUCCEED;
 
     HEclear();
     if (HAatom_group(vsid) != VSIDGROUP)
@@ -218,26 +226,12 @@ VSfindex(int32 vsid, const char *fieldname, int32 *findex)
     /* locate vs' index in vstab */
     if (NULL == (vs_inst = (vsinstance_t *)HAatom_object(vsid)))
         HGOTO_ERROR(DFE_NOVS, FAIL);
-    vs    = vs_inst->vs;
-    w     = &vs->wlist;
-    nflds = w->n;
-    for (i = 0; i < nflds; i++) {
-#ifdef VDATA_FIELDS_ALL_UPPER
-        if (matchnocase(fieldname, w->name[i])) {
-            found   = 1;
-            *findex = i;
-            break;
-        }
-#else
-        if (strcmp(fieldname, w->name[i]) == 0) {
-            found   = 1;
-            *findex = i;
-            break;
-        }
-#endif /* VDATA_FIELDS_ALL_UPPER */
-    }
-    if (!found)
+    vs = vs_inst->vs;
+
+    /* look the name up in the hash table of the field names */
+    if ((i = VSIfield_index(vs, fieldname)) == FAIL)
         HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+    *findex = i;
 done:
     return ret_value;
 } /* VSfindex */
@@ -708,6 +702,149 @@ done:
     return ret_value;
 } /* VSgetattr */
 
+/* ----------------------  VSreadallattrs --------------------
+NAME
+   VSreadallattrs -- get all the attributes of a vdata/field at once
+USAGE
+   int32 VSreadallattrs(int32 vsid, int32 findex, hdf_attr_t attrs[],
+                        int32 max_attrs, void *arena, int32 *arena_size)
+   int32 vsid;        IN: vdata access id
+   int32 findex;      IN: field index; _HDF_VDATA (-1) for vdata
+   hdf_attr_t attrs[];OUT: attribute entries
+   int32 max_attrs;   IN: # of entries of attrs
+   void *arena;       OUT: arena for the names and values
+   int32 *arena_size; IN: size of the arena
+                      OUT: size of arena needed for all the attributes
+RETURNS
+   Returns the number of attributes of the field/vdata, FAIL otherwise
+DESCRIPTION
+   Fills in attrs[] with the name, datatype, count and values of each
+   attribute of the field/vdata, as VSattrinfo and VSgetattr would, with
+   the names and values packed into the caller's arena as HDarena_attr
+   lays them out.  Attributes are placed in index order until one does
+   not fit; the name and values of the entries that did not fit are set
+   to NULL.  Calling with a NULL arena returns the number of attributes
+   and the arena size needed.
+
+   The attribute vdatas are not attached: their headers come from the
+   vdata instances and their values are read in a single Hreadv.  If
+   that fails, the values are read one at a time with VSgetattr.
+--------------------------------------------------------- */
+int32
+VSreadallattrs(int32 vsid, int32 findex, hdf_attr_t attrs[], int32 max_attrs, void *arena, int32 *arena_size)
+{
+    VDATA        *vs, *attr_vs;
+    vs_attr_t    *vs_alist;
+    vsinstance_t *vs_inst, *attr_inst;
+    hdf_attr_t    extra; /* entry for the attrs past max_attrs */
+    hdf_attr_t   *attr;
+    hdf_readv_t  *reqs     = NULL; /* reads of the attr values */
+    int32        *req_idx  = NULL; /* attr index of each read */
+    int16        *req_type = NULL; /* datatype of each read */
+    uint8        *raw      = NULL; /* file-format values of the reads */
+    int32         raw_size = 0;
+    int32         nreqs    = 0;
+    int32         used     = 0;
+    int32         a_index, count, size;
+    intn          i, nattrs, batch_ok;
+    int32         ret_value = FAIL;
+
+    HEclear();
+    if (HAatom_group(vsid) != VSIDGROUP)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (arena_size == NULL || max_attrs < 0 || (attrs == NULL && max_attrs > 0))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    /* locate vs' index in vstab */
+    if (NULL == (vs_inst = (vsinstance_t *)HAatom_object(vsid)))
+        HGOTO_ERROR(DFE_NOVS, FAIL);
+    if (NULL == (vs = vs_inst->vs))
+        HGOTO_ERROR(DFE_NOVS, FAIL);
+    if ((findex >= vs->wlist.n || findex < 0) && (findex != _HDF_VDATA))
+        HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+    nattrs = vs->nattrs;
+    if (nattrs > 0) {
+        if ((reqs = malloc((size_t)nattrs * sizeof(hdf_readv_t))) == NULL ||
+            (req_idx = malloc((size_t)nattrs * sizeof(int32))) == NULL ||
+            (req_type = malloc((size_t)nattrs * sizeof(int16))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    }
+
+    /* place each attr of the field/vdata, queueing a read of its values */
+    a_index  = 0;
+    vs_alist = vs->alist;
+    for (i = 0; i < nattrs; i++, vs_alist++) {
+        if (vs_alist->findex != findex)
+            continue;
+        if (NULL == (attr_inst = vsinst(vs->f, vs_alist->aref)))
+            HGOTO_ERROR(DFE_NOVS, FAIL);
+        attr_vs = attr_inst->vs;
+        if (strcmp(attr_vs->vsclass, _HDF_ATTRIBUTE) != 0)
+            HGOTO_ERROR(DFE_BADATTR, FAIL);
+        /* this vdata has 1 field */
+        if (attr_vs->wlist.n != 1 || strcmp(attr_vs->wlist.name[0], ATTR_FIELD_NAME))
+            HGOTO_ERROR(DFE_BADATTR, FAIL);
+        count = (int32)attr_vs->wlist.order[0];
+        size  = count * DFKNTsize(attr_vs->wlist.type[0] | DFNT_NATIVE);
+
+        /* the ones past max_attrs are only counted in the arena size */
+        attr = (a_index < max_attrs) ? &attrs[a_index] : &extra;
+        if (HDarena_attr(attr, (attr == &extra) ? NULL : arena, *arena_size, &used, attr_vs->vsname,
+                         (int32)attr_vs->wlist.type[0], count, size)) {
+            if (attr_vs->nvertices > 0 && size > 0) {
+                reqs[nreqs].tag    = DFTAG_VS;
+                reqs[nreqs].ref    = vs_alist->aref;
+                reqs[nreqs].offset = 0;
+                reqs[nreqs].length = (int32)attr_vs->wlist.isize[0];
+                req_idx[nreqs]     = a_index;
+                req_type[nreqs]    = attr_vs->wlist.type[0];
+                raw_size += reqs[nreqs].length;
+                nreqs++;
+            }
+            else /* no values written yet */
+                memset(attr->values, 0, (size_t)size);
+        }
+        a_index++;
+    }
+
+    if (nreqs > 0) {
+        batch_ok = FALSE;
+        if ((raw = malloc((size_t)raw_size)) != NULL) {
+            uint8 *p = raw;
+
+            for (i = 0; i < nreqs; i++) {
+                reqs[i].buf = p;
+                p += reqs[i].length;
+            }
+            if (Hreadv(vs->f, nreqs, reqs) != FAIL) {
+                batch_ok = TRUE;
+                for (i = 0; i < nreqs; i++)
+                    if (reqs[i].nread != reqs[i].length)
+                        batch_ok = FALSE;
+            }
+        }
+        for (i = 0; i < nreqs; i++) {
+            attr = &attrs[req_idx[i]];
+            if (batch_ok) {
+                if (FAIL == DFKconvert(reqs[i].buf, attr->values, (int32)req_type[i], attr->count, DFACC_READ,
+                                       0, 0))
+                    HGOTO_ERROR(DFE_BADCONV, FAIL);
+            }
+            else if (FAIL == VSgetattr(vsid, findex, (intn)req_idx[i], attr->values))
+                HGOTO_ERROR(DFE_VSREAD, FAIL);
+        }
+    }
+
+    *arena_size = used;
+    ret_value   = a_index;
+
+done:
+    free(reqs);
+    free(req_idx);
+    free(req_type);
+    free(raw);
+    return ret_value;
+} /* VSreadallattrs */
+
 /* -------------------- VSisattr ----------------------
 NAME
    VSisattr -- test if a vdata is an attribute of
@@ -742,6 +879,304 @@ done:
     return ret_value;
 } /* VSisattr */
 
+/* -----------------  Vsetcompactattr  -------------------
+NAME
+   Vsetcompactattr -- keep small vgroup attrs in a compact store
+USAGE
+   intn Vsetcompactattr(HFILEID f, intn compact_on)
+   HFILEID f;        IN: file id, after Vstart
+   intn compact_on;  IN: TRUE to turn the compact store on
+RETURNS
+   Returns SUCCEED when successful, FAIL otherwise.
+DESCRIPTION
+   By default every vgroup attribute is stored in a vdata of its own.
+   With the compact store on, Vsetattr packs the new attributes of
+   up to VATTR_COMPACT_MAX bytes of values into a single vdata of
+   class _HDF_ATTR_STORE per vgroup, written when the vgroup is
+   detached, so that reading the attributes of the vgroup takes one
+   element read instead of one vdata attach per attribute.
+   Attributes already in the file keep their storage.
+   Files with compact stores are read through the same Vnattrs,
+   Vattrinfo, Vgetattr, ... calls; libraries older than the store
+   cannot read the attributes in it.
+------------------------------------------------------------  */
+intn
+Vsetcompactattr(HFILEID f, intn compact_on)
+{
+    vfile_t *vf;
+    intn     ret_value = SUCCEED;
+
+    HEclear();
+    if (NULL == (vf = Get_vfile(f)))
+        HGOTO_ERROR(DFE_FNF, FAIL);
+    vf->compact_attrs = compact_on ? TRUE : FALSE;
+
+done:
+    return ret_value;
+} /* Vsetcompactattr */
+
+/* -----------------  VIattr_store_load  -----------------
+NAME
+   VIattr_store_load -- read the compact attribute store of a vgroup
+USAGE
+   vattr_store_t *VIattr_store_load(VGROUP *vg)
+   VGROUP *vg;       IN: the vgroup
+RETURNS
+   Returns the store, NULL on failure.
+DESCRIPTION
+   The store is read the first time it is needed, in a single
+   Hgetelement of the data of its vdata (uint8 records, so the file
+   and memory formats are the same), and kept with the vgroup.  A
+   vgroup without one gets an empty store.
+   The store data is, for each attribute: the length of the name
+   (uint16), the name, the number type and the count (int32), then
+   the values in file format; all preceded by the # of attributes
+   (int32).
+------------------------------------------------------------  */
+static vattr_store_t *
+VIattr_store_load(VGROUP *vg)
+{
+    vattr_store_t   *st  = NULL;
+    vattr_compact_t *a;
+    uint8           *buf = NULL;
+    const uint8     *p, *end;
+    int32            len, n, vsize;
+    uint16           name_len;
+    intn             i;
+    vattr_store_t   *ret_value = NULL;
+
+    if (vg->astore != NULL)
+        HGOTO_DONE(vg->astore);
+
+    if (NULL == (st = calloc(1, sizeof(vattr_store_t))))
+        HGOTO_ERROR(DFE_NOSPACE, NULL);
+    for (i = 0; i < vg->nattrs; i++)
+        if (vg->alist[i].atag == VG_ATTR_STORE_TAG) {
+            st->ref = vg->alist[i].aref;
+            break;
+        }
+
+    if (st->ref != 0) {
+        if ((len = Hlength(vg->f, DFTAG_VS, st->ref)) == FAIL || len < 4)
+            HGOTO_ERROR(DFE_BADATTR, NULL);
+        if (NULL == (buf = malloc((size_t)len)))
+            HGOTO_ERROR(DFE_NOSPACE, NULL);
+        if (Hgetelement(vg->f, DFTAG_VS, st->ref, buf) != len)
+            HGOTO_ERROR(DFE_READERROR, NULL);
+
+        p   = buf;
+        end = buf + len;
+        INT32DECODE(p, n);
+        if (n < 0 || NULL == (st->attrs = calloc((size_t)(n > 0 ? n : 1), sizeof(vattr_compact_t))))
+            HGOTO_ERROR(DFE_BADATTR, NULL);
+        st->max = n > 0 ? n : 1;
+        for (i = 0; i < n; i++) {
+            a = &st->attrs[i];
+            if (end - p < 2)
+                HGOTO_ERROR(DFE_BADATTR, NULL);
+            UINT16DECODE(p, name_len);
+            if (end - p < (ptrdiff_t)name_len + 8)
+                HGOTO_ERROR(DFE_BADATTR, NULL);
+            if (NULL == (a->name = malloc((size_t)name_len + 1)))
+                HGOTO_ERROR(DFE_NOSPACE, NULL);
+            memcpy(a->name, p, name_len);
+            a->name[name_len] = '\0';
+            p += name_len;
+            INT32DECODE(p, a->type);
+            INT32DECODE(p, a->count);
+            st->n++;
+            vsize = a->count * DFKNTsize(a->type);
+            if (vsize <= 0 || end - p < vsize)
+                HGOTO_ERROR(DFE_BADATTR, NULL);
+            if (NULL == (a->values = malloc((size_t)vsize)))
+                HGOTO_ERROR(DFE_NOSPACE, NULL);
+            memcpy(a->values, p, (size_t)vsize);
+            p += vsize;
+        }
+    }
+    vg->astore = st;
+    ret_value  = st;
+
+done:
+    if (ret_value == NULL && st != NULL) {
+        vg->astore = st;
+        VIattr_store_free(vg);
+    }
+    free(buf);
+    return ret_value;
+} /* VIattr_store_load */
+
+/* -----------------  VIattr_store_find  -----------------
+NAME
+   VIattr_store_find -- get the compact attr of an attribute index
+USAGE
+   vattr_compact_t *VIattr_store_find(VGROUP *vg, intn attrindex)
+   VGROUP *vg;       IN: the vgroup
+   intn attrindex;   IN: index of an attribute in vg->alist that
+                         is in the compact store
+RETURNS
+   Returns the attribute, NULL on failure.
+------------------------------------------------------------  */
+static vattr_compact_t *
+VIattr_store_find(VGROUP *vg, intn attrindex)
+{
+    vattr_store_t   *st;
+    intn             i, slot;
+    vattr_compact_t *ret_value = NULL;
+
+    if (NULL == (st = VIattr_store_load(vg)))
+        HGOTO_ERROR(DFE_BADATTR, NULL);
+
+    /* the store holds the compact attrs in attribute list order */
+    slot = 0;
+    for (i = 0; i < attrindex; i++)
+        if (vg->alist[i].atag == VG_ATTR_STORE_TAG)
+            slot++;
+    if (slot >= st->n)
+        HGOTO_ERROR(DFE_BADATTR, NULL);
+    ret_value = &st->attrs[slot];
+
+done:
+    return ret_value;
+} /* VIattr_store_find */
+
+/* -----------------  VIattr_store_flush  ----------------
+NAME
+   VIattr_store_flush -- write the compact attribute store out
+USAGE
+   intn VIattr_store_flush(VGROUP *vg)
+   VGROUP *vg;       IN: the vgroup, about to be written out
+RETURNS
+   Returns SUCCEED when successful, FAIL otherwise.
+DESCRIPTION
+   Called by Vdetach before the vgroup is packed.  A store that
+   changed is written into a new vdata, the entries of the compact
+   attrs in the attribute list are pointed to it and the vdata of
+   the previous version of the store is deleted.
+------------------------------------------------------------  */
+intn
+VIattr_store_flush(VGROUP *vg)
+{
+    vattr_store_t   *st = vg->astore;
+    vattr_compact_t *a;
+    uint8           *buf = NULL, *p;
+    int32            len, new_ref;
+    intn             i;
+    intn             ret_value = SUCCEED;
+
+    if (st == NULL || !st->dirty)
+        HGOTO_DONE(SUCCEED);
+
+    len = 4;
+    for (i = 0; i < st->n; i++)
+        len += 2 + (int32)strlen(st->attrs[i].name) + 8 + st->attrs[i].count * DFKNTsize(st->attrs[i].type);
+    if (NULL == (buf = malloc((size_t)len)))
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    p = buf;
+    INT32ENCODE(p, st->n);
+    for (i = 0; i < st->n; i++) {
+        a = &st->attrs[i];
+        UINT16ENCODE(p, strlen(a->name));
+        memcpy(p, a->name, strlen(a->name));
+        p += strlen(a->name);
+        INT32ENCODE(p, a->type);
+        INT32ENCODE(p, a->count);
+        memcpy(p, a->values, (size_t)(a->count * DFKNTsize(a->type)));
+        p += a->count * DFKNTsize(a->type);
+    }
+
+    if ((new_ref = VHstoredatam(vg->f, ATTR_FIELD_NAME, buf, len, DFNT_UINT8, "attribute store",
+                                _HDF_ATTR_STORE, 1)) == FAIL)
+        HGOTO_ERROR(DFE_VSCANTCREATE, FAIL);
+    if (st->ref != 0 && VSdelete(vg->f, (int32)st->ref) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    st->ref = (uint16)new_ref;
+    for (i = 0; i < vg->nattrs; i++)
+        if (vg->alist[i].atag == VG_ATTR_STORE_TAG)
+            vg->alist[i].aref = st->ref;
+    st->dirty = FALSE;
+
+done:
+    free(buf);
+    return ret_value;
+} /* VIattr_store_flush */
+
+/* -----------------  VIattr_store_datainfo  -------------
+NAME
+   VIattr_store_datainfo -- get the offset/length of a compact attr
+USAGE
+   intn VIattr_store_datainfo(VGROUP *vg, intn attrindex,
+                              int32 *offset, int32 *length)
+   VGROUP *vg;       IN: the vgroup
+   intn attrindex;   IN: index of an attribute in vg->alist that
+                         is in the compact store
+   int32 *offset;    OUT: offset of the attr's values in the file
+   int32 *length;    OUT: length of the attr's values
+RETURNS
+   Returns the number of data blocks, 1, or FAIL, as
+   Vgetattdatainfo does.  A store not written out yet has no
+   data in the file and fails.
+------------------------------------------------------------  */
+intn
+VIattr_store_datainfo(VGROUP *vg, intn attrindex, int32 *offset, int32 *length)
+{
+    vattr_store_t   *st;
+    vattr_compact_t *a;
+    int32            pos, vsid = FAIL;
+    int32            st_offset, st_length;
+    intn             i;
+    intn             ret_value = FAIL;
+
+    if (NULL == (a = VIattr_store_find(vg, attrindex)))
+        HGOTO_ERROR(DFE_BADATTR, FAIL);
+    st = vg->astore;
+    if (st->ref == 0 || st->dirty)
+        HGOTO_ERROR(DFE_BADATTR, FAIL);
+
+    /* position of the values in the store data */
+    pos = 4;
+    for (i = 0; &st->attrs[i] != a; i++)
+        pos += 2 + (int32)strlen(st->attrs[i].name) + 8 + st->attrs[i].count * DFKNTsize(st->attrs[i].type);
+    pos += 2 + (int32)strlen(a->name) + 8;
+
+    if (FAIL == (vsid = VSattach(vg->f, (int32)st->ref, "r")))
+        HGOTO_ERROR(DFE_CANTATTACH, FAIL);
+    if (VSgetdatainfo(vsid, 0, 1, &st_offset, &st_length) != 1)
+        HGOTO_ERROR(DFE_GENAPP, FAIL);
+    *offset   = st_offset + pos;
+    *length   = a->count * DFKNTsize(a->type);
+    ret_value = 1;
+
+done:
+    if (vsid != FAIL && FAIL == VSdetach(vsid))
+        ret_value = FAIL;
+    return ret_value;
+} /* VIattr_store_datainfo */
+
+/* -----------------  VIattr_store_free  -----------------
+NAME
+   VIattr_store_free -- free the compact attribute store
+USAGE
+   void VIattr_store_free(VGROUP *vg)
+   VGROUP *vg;       IN: the vgroup
+------------------------------------------------------------  */
+void
+VIattr_store_free(VGROUP *vg)
+{
+    vattr_store_t *st = vg->astore;
+    intn           i;
+
+    if (st == NULL)
+        return;
+    for (i = 0; i < st->n; i++) {
+        free(st->attrs[i].name);
+        free(st->attrs[i].values);
+    }
+    free(st->attrs);
+    free(st);
+    vg->astore = NULL;
+} /* VIattr_store_free */
+
 /* -----------------  Vsetattr  -------------------------
 NAME
    Vsetattr -- set an attribute for a vgroup
@@ -763,18 +1198,25 @@ DESCRIPTION
       datatype or order will be considered as an error.
    No limit on max number of attributes. (int32 is the final
       limit.
+   With Vsetcompactattr on, a new attribute of up to
+      VATTR_COMPACT_MAX bytes goes in the vgroup's compact
+      attribute store instead of a vdata of its own.
 ------------------------------------------------------------  */
 intn
 Vsetattr(int32 vgid, const char *attrname, int32 datatype, int32 count, const void *values)
 {
-    VGROUP         *vg;
-    VDATA          *vs;
-    vginstance_t   *v;
-    vsinstance_t   *vs_inst;
-    DYN_VWRITELIST *w;
-    int32           ret_value = SUCCEED;
-    int32           attr_vs_ref, fid, vsid;
-    intn            i;
+    VGROUP          *vg;
+    VDATA           *vs;
+    vginstance_t    *v;
+    vsinstance_t    *vs_inst;
+    vfile_t         *vf;
+    DYN_VWRITELIST  *w;
+    vattr_store_t   *st;
+    vattr_compact_t *a;
+    int32            ret_value = SUCCEED;
+    int32            attr_vs_ref, fid, vsid, vsize;
+    uint16           atag;
+    intn             i;
 
     HEclear();
 
@@ -808,6 +1250,20 @@ Vsetattr(int32 vgid, const char *attrname, int32 datatype, int32 count, const vo
     /* if the attr already exist, check data type and order. */
     if (vg->alist != NULL) {
         for (i = 0; i < vg->nattrs; i++) {
+            if (vg->alist[i].atag == VG_ATTR_STORE_TAG) {
+                if (NULL == (a = VIattr_store_find(vg, i)))
+                    HGOTO_ERROR(DFE_BADATTR, FAIL);
+                if (strcmp(a->name, attrname) != 0)
+                    continue;
+                if (a->type != datatype || a->count != count)
+                    HGOTO_ERROR(DFE_BADATTR, FAIL);
+                /* replace the values */
+                if (FAIL == DFKconvert((void *)values, a->values, datatype, count, DFACC_WRITE, 0, 0))
+                    HGOTO_ERROR(DFE_BADCONV, FAIL);
+                vg->astore->dirty = TRUE;
+                vg->marked        = 1;
+                HGOTO_DONE(SUCCEED);
+            } /* attr in the compact store */
             if ((vsid = VSattach(fid, (int32)vg->alist[i].aref, "w")) == FAIL)
                 HGOTO_ERROR(DFE_CANTATTACH, FAIL);
             if (NULL == (vs_inst = (vsinstance_t *)HAatom_object(vsid)))
@@ -833,10 +1289,48 @@ Vsetattr(int32 vgid, const char *attrname, int32 datatype, int32 count, const vo
                 HGOTO_ERROR(DFE_CANTDETACH, FAIL);
         } /* for loop, not exists */
     }
-    /* create the attr_vdata and insert it into vg->alist */
-    if ((attr_vs_ref = VHstoredatam(fid, ATTR_FIELD_NAME, values, 1, datatype, attrname, _HDF_ATTRIBUTE,
-                                    count)) == FAIL)
-        HGOTO_ERROR(DFE_VSCANTCREATE, FAIL);
+    if (NULL == (vf = Get_vfile(fid)))
+        HGOTO_ERROR(DFE_FNF, FAIL);
+    vsize = count * DFKNTsize(datatype);
+    if (vf->compact_attrs && vsize > 0 && vsize <= VATTR_COMPACT_MAX) {
+        /* append the attr to the compact store, written out by Vdetach */
+        if (NULL == (st = VIattr_store_load(vg)))
+            HGOTO_ERROR(DFE_BADATTR, FAIL);
+        if (st->n == st->max) {
+            intn             new_max = st->max > 0 ? 2 * st->max : 8;
+            vattr_compact_t *new_attrs;
+
+            if (NULL == (new_attrs = realloc(st->attrs, (size_t)new_max * sizeof(vattr_compact_t))))
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+            st->attrs = new_attrs;
+            st->max   = new_max;
+        }
+        a = &st->attrs[st->n];
+        if (NULL == (a->name = strdup(attrname)))
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if (NULL == (a->values = malloc((size_t)vsize))) {
+            free(a->name);
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        }
+        if (FAIL == DFKconvert((void *)values, a->values, datatype, count, DFACC_WRITE, 0, 0)) {
+            free(a->name);
+            free(a->values);
+            HGOTO_ERROR(DFE_BADCONV, FAIL);
+        }
+        a->type     = datatype;
+        a->count    = count;
+        st->n++;
+        st->dirty   = TRUE;
+        atag        = VG_ATTR_STORE_TAG;
+        attr_vs_ref = st->ref;
+    }
+    else {
+        /* create the attr_vdata and insert it into vg->alist */
+        if ((attr_vs_ref = VHstoredatam(fid, ATTR_FIELD_NAME, values, 1, datatype, attrname,
+                                        _HDF_ATTRIBUTE, count)) == FAIL)
+            HGOTO_ERROR(DFE_VSCANTCREATE, FAIL);
+        atag = DFTAG_VH;
+    }
     /* add the attr to attr list */
     if (vg->alist == NULL)
         vg->alist = (vg_attr_t *)malloc(sizeof(vg_attr_t));
@@ -848,7 +1342,7 @@ Vsetattr(int32 vgid, const char *attrname, int32 datatype, int32 count, const vo
     vg->nattrs++;
     vg->flags                      = vg->flags | VG_ATTR_SET;
     vg->version                    = VSET_NEW_VERSION;
-    vg->alist[vg->nattrs - 1].atag = DFTAG_VH;
+    vg->alist[vg->nattrs - 1].atag = atag;
     vg->alist[vg->nattrs - 1].aref = (uint16)attr_vs_ref;
     vg->marked                     = 1;
     /* list of refs of all attributes, it is only used when Vattrinfo2 is
@@ -1120,13 +1614,14 @@ done:
 intn
 Vfindattr(int32 vgid, const char *attrname)
 {
-    VGROUP       *vg;
-    VDATA        *vs;
-    vginstance_t *v;
-    vsinstance_t *vs_inst;
-    int32         fid, vsid;
-    int32         ret_value = FAIL;
-    intn          i, found;
+    VGROUP          *vg;
+    VDATA           *vs;
+    vginstance_t    *v;
+    vsinstance_t    *vs_inst;
+    vattr_compact_t *a;
+    int32            fid, vsid;
+    int32            ret_value = FAIL;
+    intn             i, found;
 
     HEclear();
 
@@ -1152,6 +1647,15 @@ Vfindattr(int32 vgid, const char *attrname)
         HGOTO_ERROR(DFE_ARGS, FAIL);
     found = 0;
     for (i = 0; found == 0 && i < vg->nattrs; i++) {
+        if (vg->alist[i].atag == VG_ATTR_STORE_TAG) {
+            if (NULL == (a = VIattr_store_find(vg, i)))
+                HGOTO_ERROR(DFE_BADATTR, FAIL);
+            if (0 == strcmp(a->name, attrname)) {
+                ret_value = i;
+                found     = 1;
+            }
+            continue;
+        }
         if ((vsid = VSattach(fid, (int32)vg->alist[i].aref, "r")) == FAIL)
             HGOTO_ERROR(DFE_CANTATTACH, FAIL);
         if (HAatom_group(vsid) != VSIDGROUP)
@@ -1199,11 +1703,12 @@ Vattrinfo(int32 vgid, intn attrindex, char *name, int32 *datatype, int32 *count,
     VDATA          *vs;
     DYN_VWRITELIST *w;
     /*    char fldname[FIELDNAMELENMAX + 1]; */
-    char         *fldname;
-    vginstance_t *v;
-    vsinstance_t *vs_inst;
-    int32         fid, vsid;
-    int32         ret_value = SUCCEED;
+    char            *fldname;
+    vginstance_t    *v;
+    vsinstance_t    *vs_inst;
+    vattr_compact_t *a;
+    int32            fid, vsid;
+    int32            ret_value = SUCCEED;
 
     HEclear();
     if (HAatom_group(vgid) != VGIDGROUP)
@@ -1221,6 +1726,21 @@ Vattrinfo(int32 vgid, intn attrindex, char *name, int32 *datatype, int32 *count,
         /* not that many attrs or bad attr list */
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
+    if (vg->alist[attrindex].atag == VG_ATTR_STORE_TAG) {
+        /* in the compact store, no vdata to attach */
+        if (NULL == (a = VIattr_store_find(vg, attrindex)))
+            HGOTO_ERROR(DFE_BADATTR, FAIL);
+        if (name)
+            strcpy(name, a->name);
+        if (datatype)
+            *datatype = a->type;
+        if (count)
+            *count = a->count;
+        if (size)
+            *size = a->count * DFKNTsize(a->type | DFNT_NATIVE);
+        HGOTO_DONE(SUCCEED);
+    }
+
     if ((vsid = VSattach(fid, (int32)vg->alist[attrindex].aref, "r")) == FAIL)
         HGOTO_ERROR(DFE_CANTATTACH, FAIL);
     if (HAatom_group(vsid) != VSIDGROUP)
@@ -1294,15 +1814,16 @@ intn
 Vattrinfo2(int32 vgid, intn attrindex, char *name, int32 *datatype, int32 *count, int32 *size, int32 *nfields,
            uint16 *refnum)
 {
-    VGROUP         *vg;
-    VDATA          *vs;
-    DYN_VWRITELIST *w;
-    vginstance_t   *vg_inst;
-    vsinstance_t   *vs_inst;
-    vg_attr_t      *vg_alist = NULL;
-    int32           vsid;
-    intn            adjusted_index;
-    int32           ret_value = SUCCEED;
+    VGROUP          *vg;
+    VDATA           *vs;
+    DYN_VWRITELIST  *w;
+    vginstance_t    *vg_inst;
+    vsinstance_t    *vs_inst;
+    vg_attr_t       *vg_alist = NULL;
+    vattr_compact_t *a;
+    int32            vsid;
+    intn             adjusted_index;
+    int32            ret_value = SUCCEED;
 
     /* Clear error stack */
     HEclear();
@@ -1343,6 +1864,25 @@ Vattrinfo2(int32 vgid, intn attrindex, char *name, int32 *datatype, int32 *count
 
     /* Getting attribute information */
 
+    /* New-style attribute in the compact store */
+    if (vg_alist == vg->alist && vg_alist[adjusted_index].atag == VG_ATTR_STORE_TAG) {
+        if (NULL == (a = VIattr_store_find(vg, adjusted_index)))
+            HGOTO_ERROR(DFE_BADATTR, FAIL);
+        if (name)
+            strcpy(name, a->name);
+        if (datatype)
+            *datatype = a->type;
+        if (count)
+            *count = a->count;
+        if (size)
+            *size = a->count * DFKNTsize(a->type | DFNT_NATIVE);
+        if (nfields)
+            *nfields = 1;
+        if (refnum)
+            *refnum = vg->astore->ref;
+        HGOTO_DONE(SUCCEED);
+    }
+
     /* Get access to the vdata storing the attr, and obtain requested info */
     if ((vsid = VSattach(vg->f, (int32)vg_alist[adjusted_index].aref, "r")) == FAIL)
         HGOTO_ERROR(DFE_CANTATTACH, FAIL);
@@ -1390,14 +1930,15 @@ DESCRIPTION
 intn
 Vgetattr(int32 vgid, intn attrindex, void *values)
 {
-    VGROUP       *vg;
-    VDATA        *vs;
-    char          fields[FIELDNAMELENMAX];
-    vginstance_t *v;
-    vsinstance_t *vs_inst;
-    int32         fid, vsid;
-    int32         n_recs, il;
-    int32         ret_value = SUCCEED;
+    VGROUP          *vg;
+    VDATA           *vs;
+    char             fields[FIELDNAMELENMAX];
+    vginstance_t    *v;
+    vsinstance_t    *vs_inst;
+    vattr_compact_t *a;
+    int32            fid, vsid;
+    int32            n_recs, il;
+    int32            ret_value = SUCCEED;
 
     HEclear();
     if (HAatom_group(vgid) != VGIDGROUP)
@@ -1415,6 +1956,15 @@ Vgetattr(int32 vgid, intn attrindex, void *values)
         /* not that many attrs or bad attr_Vg tag/ref */
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
+    if (vg->alist[attrindex].atag == VG_ATTR_STORE_TAG) {
+        /* in the compact store, no vdata to attach */
+        if (NULL == (a = VIattr_store_find(vg, attrindex)))
+            HGOTO_ERROR(DFE_BADATTR, FAIL);
+        if (FAIL == DFKconvert(a->values, values, a->type, a->count, DFACC_READ, 0, 0))
+            HGOTO_ERROR(DFE_BADCONV, FAIL);
+        HGOTO_DONE(SUCCEED);
+    }
+
     if ((vsid = VSattach(fid, (int32)vg->alist[attrindex].aref, "r")) == FAIL)
         HGOTO_ERROR(DFE_CANTATTACH, FAIL);
     if (HAatom_group(vsid) != VSIDGROUP)
@@ -1465,16 +2015,17 @@ DESCRIPTION
 intn
 Vgetattr2(int32 vgid, intn attrindex, void *values)
 {
-    VGROUP       *vg;
-    VDATA        *vs;
-    char          fields[FIELDNAMELENMAX];
-    vginstance_t *v;
-    vsinstance_t *vs_inst;
-    vg_attr_t    *vg_alist = NULL;
-    intn          adjusted_index;
-    int32         vsid = -1;
-    int32         n_recs, il;
-    int32         ret_value = SUCCEED;
+    VGROUP          *vg;
+    VDATA           *vs;
+    char             fields[FIELDNAMELENMAX];
+    vginstance_t    *v;
+    vsinstance_t    *vs_inst;
+    vg_attr_t       *vg_alist = NULL;
+    vattr_compact_t *a;
+    intn             adjusted_index;
+    int32            vsid = -1;
+    int32            n_recs, il;
+    int32            ret_value = SUCCEED;
 
     /* Clear error stack */
     HEclear();
@@ -1515,6 +2066,15 @@ Vgetattr2(int32 vgid, intn attrindex, void *values)
 
     /* Getting attribute information */
 
+    /* New-style attribute in the compact store */
+    if (vg_alist == vg->alist && vg_alist[adjusted_index].atag == VG_ATTR_STORE_TAG) {
+        if (NULL == (a = VIattr_store_find(vg, adjusted_index)))
+            HGOTO_ERROR(DFE_BADATTR, FAIL);
+        if (FAIL == DFKconvert(a->values, values, a->type, a->count, DFACC_READ, 0, 0))
+            HGOTO_ERROR(DFE_BADCONV, FAIL);
+        HGOTO_DONE(SUCCEED);
+    }
+
     /* Get access to the vdata storing the attr, and obtain requested info */
     if ((vsid = VSattach(vg->f, (int32)vg_alist[adjusted_index].aref, "r")) == FAIL)
         HGOTO_ERROR(DFE_CANTATTACH, FAIL);
@@ -35,12 +35,14 @@ nvsfcfdx(intf *vsid, _fcd fldnm, intf *findex, intf *fldnmlen)
 {
     intf  ret;
     char *fld;
+    char  namebuf[H4_MAX_NC_NAME];
 
-    fld = HDf2cstring(fldnm, (intn)*fldnmlen);
+    fld = HDf2cstring_buf(fldnm, (intn)*fldnmlen, namebuf, (intn)sizeof(namebuf));
     if (!fld)
         return FAIL;
     ret = (intf)VSfindex((int32)*vsid, fld, (int32 *)findex);
-    free(fld);
+    if (fld != namebuf)
+        free(fld);
     return ret;
 }
 
@@ -55,15 +57,17 @@ nvsfcsat(intf *vsid, intf *findex, _fcd attrnm, intf *dtype, intf *count, intf *
 {
     intf  ret;
     char *attrname;
+    char  namebuf[H4_MAX_NC_NAME];
     int32 cfindex;
 
-    attrname = HDf2cstring(attrnm, (intn)*attrnmlen);
+    attrname = HDf2cstring_buf(attrnm, (intn)*attrnmlen, namebuf, (intn)sizeof(namebuf));
     if (!attrname)
         return FAIL;
     cfindex = *findex;
     ret =
         (intf)VSsetattr((int32)*vsid, (int32)cfindex, attrname, (int32)*dtype, (int32)*count, (void *)values);
-    free(attrname);
+    if (attrname != namebuf)
+        free(attrname);
     return ret;
 }
 
@@ -78,15 +82,17 @@ nvsfcsca(intf *vsid, intf *findex, _fcd attrnm, intf *dtype, intf *count, _fcd v
 {
     intf  ret;
     char *attrname;
+    char  namebuf[H4_MAX_NC_NAME];
     int32 cfindex;
 
-    attrname = HDf2cstring(attrnm, (intn)*attrnmlen);
+    attrname = HDf2cstring_buf(attrnm, (intn)*attrnmlen, namebuf, (intn)sizeof(namebuf));
     if (!attrname)
         return FAIL;
     cfindex = *findex;
     ret     = (intf)VSsetattr((int32)*vsid, (int32)cfindex, attrname, (int32)*dtype, (int32)*count,
                               (void *)_fcdtocp(values));
-    free(attrname);
+    if (attrname != namebuf)
+        free(attrname);
     return ret;
 }
 
@@ -133,15 +139,17 @@ nvsfcfda(intf *vsid, intf *findex, _fcd attrnm, intf *attrnmlen)
 {
     intf  ret;
     char *attrname;
+    char  namebuf[H4_MAX_NC_NAME];
     int32 cfindex;
 
-    attrname = HDf2cstring(attrnm, (intn)*attrnmlen);
+    attrname = HDf2cstring_buf(attrnm, (intn)*attrnmlen, namebuf, (intn)sizeof(namebuf));
     if (!attrname)
         return FAIL;
     cfindex = *findex;
 
     ret = (intf)VSfindattr((int32)*vsid, (int32)cfindex, attrname);
-    free(attrname);
+    if (attrname != namebuf)
+        free(attrname);
     return ret;
 }
 
@@ -234,12 +242,14 @@ nvfcsatt(intf *vgid, _fcd attrnm, intf *dtype, intf *count, intf *values, intf *
 {
     intf  ret;
     char *attrname;
+    char  namebuf[H4_MAX_NC_NAME];
 
-    attrname = HDf2cstring(attrnm, (intn)*attrnmlen);
+    attrname = HDf2cstring_buf(attrnm, (intn)*attrnmlen, namebuf, (intn)sizeof(namebuf));
     if (!attrname)
         return FAIL;
     ret = (intf)Vsetattr((int32)*vgid, attrname, (int32)*dtype, (int32)*count, (void *)values);
-    free(attrname);
+    if (attrname != namebuf)
+        free(attrname);
     return ret;
 }
 
@@ -254,12 +264,14 @@ nvfcscat(intf *vgid, _fcd attrnm, intf *dtype, intf *count, _fcd values, intf *a
 {
     intf  ret;
     char *attrname;
+    char  namebuf[H4_MAX_NC_NAME];
 
-    attrname = HDf2cstring(attrnm, (intn)*attrnmlen);
+    attrname = HDf2cstring_buf(attrnm, (intn)*attrnmlen, namebuf, (intn)sizeof(namebuf));
     if (!attrname)
         return FAIL;
     ret = (intf)Vsetattr((int32)*vgid, attrname, (int32)*dtype, (int32)*count, (void *)_fcdtocp(values));
-    free(attrname);
+    if (attrname != namebuf)
+        free(attrname);
     return ret;
 }
 
@@ -287,12 +299,14 @@ nvfcfdat(intf *vgid, _fcd attrnm, intf *attrnmlen)
 {
     intf  ret;
     char *attrname;
+    char  namebuf[H4_MAX_NC_NAME];
 
-    attrname = HDf2cstring(attrnm, (intn)*attrnmlen);
+    attrname = HDf2cstring_buf(attrnm, (intn)*attrnmlen, namebuf, (intn)sizeof(namebuf));
     if (!attrname)
         return FAIL;
     ret = (intf)Vfindattr((int32)*vgid, attrname);
-    free(attrname);
+    if (attrname != namebuf)
+        free(attrname);
     return ret;
 }
 
@@ -53,6 +53,9 @@ EXPORTED ROUTINES
 PRIVATE FUNCTIONS
 =================
      matchnocase    -- compares to strings, ignoring case
+     VIfind_reset   -- forgets a name or class index of a file
+     VIfind_build   -- builds a name or class index of a file
+     VIfind_lookup  -- looks up a name or class in an index of a file
      vscheckclass   -- checks if a given vdata has the specified class or if
                        it is user-created, which means its class name is not
                        one of the predefined HDF classes.
@@ -66,15 +69,30 @@ PRIVATE data structures in here pertain to vdata in vsdir only.
 
 /* These are used to determine whether a vdata had been created by the
    library internally, that is, not created by user's application */
-#define HDF_NUM_INTERNAL_VDS 8
-const char *HDF_INTERNAL_VDS[] = {DIM_VALS,    DIM_VALS01,      _HDF_ATTRIBUTE, _HDF_SDSVAR,
-                                  _HDF_CRDVAR, "_HDF_CHK_TBL_", RIGATTRNAME,    RIGATTRCLASS};
+#define HDF_NUM_INTERNAL_VDS 12
+const char *HDF_INTERNAL_VDS[] = {DIM_VALS,        DIM_VALS01,           _HDF_ATTRIBUTE, _HDF_SDSVAR,
+                                  _HDF_CRDVAR,     "_HDF_CHK_TBL_",      RIGATTRNAME,    RIGATTRCLASS,
+                                  _HDF_ATTR_STORE, _HDF_CHK_STATS_CLASS, _HDF_CHK_SUMS_CLASS,
+                                  _HDF_VS_INDEX_CLASS};
+
+/* a name or class in the indexes used by Vfind() and co., the string
+   itself follows the node in the same allocation */
+typedef struct {
+    int32 ref;  /* lowest ref of the vgroups or vdatas with this name */
+    char *name; /* the name or class */
+} vfindnode_t;
 
 /* Private functions */
 #ifdef VDATA_FIELDS_ALL_UPPER
 static int32 matchnocase(char *strx, char *stry);
 #endif /* VDATA_FIELDS_ALL_UPPER */
 
+static intn VIfindcompare(void *k1, void *k2, intn cmparg);
+
+static intn VIfind_build(HFILEID f, vfile_t *vf, intn which);
+
+static int32 VIfind_lookup(HFILEID f, intn which, const char *name);
+
 #ifdef VDATA_FIELDS_ALL_UPPER
 /*-----------------------------------------------------------------
 NAME
@@ -483,6 +501,7 @@ VSsetname(int32       vkey, /* IN: Vdata key */
           const char *vsname /* IN: name to set for vdata*/)
 {
     vsinstance_t *w        = NULL;
+    vfile_t      *vf       = NULL;
     VDATA        *vs       = NULL;
     int32         curr_len = 0;
     int32         slen;
@@ -518,6 +537,10 @@ VSsetname(int32       vkey, /* IN: Vdata key */
 
     vs->marked = TRUE; /* mark vdata as being modified */
 
+    /* the searches have to look at the new name */
+    if ((vf = Get_vfile(vs->f)) != NULL)
+        VIfind_reset(vf, VFIND_VSNAME);
+
     if (curr_len < slen)
         vs->new_h_sz = TRUE; /* mark vdata header size being changed */
 
@@ -544,6 +567,7 @@ VSsetclass(int32       vkey, /* IN: vdata key */
 {
     vsinstance_t *w  = NULL;
     VDATA        *vs = NULL;
+    vfile_t      *vf = NULL;
     int32         curr_len;
     int32         slen;
     int32         ret_value = SUCCEED;
@@ -578,6 +602,10 @@ VSsetclass(int32       vkey, /* IN: vdata key */
 
     vs->marked = TRUE; /* mark vdata as being modified */
 
+    /* the searches have to look at the new class */
+    if ((vf = Get_vfile(vs->f)) != NULL)
+        VIfind_reset(vf, VFIND_VSCLASS);
+
     if (curr_len < slen)
         vs->new_h_sz = TRUE; /* mark vdata header size being changed */
 
@@ -861,6 +889,158 @@ done:
     return ret_value;
 } /* Vlone */
 
+/* -----------------------------------------------------------------
+NAME
+   VIfindcompare -- compares two keys of a name or class index
+
+RETURNS
+   Same as strcmp
+-----------------------------------------------------------------------*/
+static intn
+VIfindcompare(void *k1,   /* IN: first name */
+              void *k2,   /* IN: second name */
+              intn cmparg /* IN: not used */)
+{
+    (void)cmparg;
+
+    return (intn)strcmp((const char *)k1, (const char *)k2);
+} /* VIfindcompare */
+
+/* -----------------------------------------------------------------
+NAME
+   VIfind_reset -- forgets a name or class index of a file
+
+DESCRIPTION
+   Frees the index 'which' of the file, or all of them if 'which'
+   is -1, so that it is built again by the next search.  Called
+   whenever a name or class changes or a vgroup or vdata is created
+   or deleted.
+
+RETURNS
+   Nothing
+-----------------------------------------------------------------------*/
+void
+VIfind_reset(vfile_t *vf, /* IN: vgroup file record */
+             intn     which /* IN: index to forget, -1 for all */)
+{
+    intn i;
+
+    for (i = 0; i < VFIND_NINDEX; i++)
+        if ((which == -1 || which == i) && vf->findtree[i] != NULL)
+            vf->findtree[i] = tbbtdfree(vf->findtree[i], free, NULL);
+} /* VIfind_reset */
+
+/* -----------------------------------------------------------------
+NAME
+   VIfind_build -- builds a name or class index of a file
+
+DESCRIPTION
+   Reads the names or classes of the vgroups or vdatas of the file
+   in ref order and keeps the lowest ref of each, which is the one a
+   linear search finds first.  Like that search, it stops at the
+   first vgroup or vdata whose header cannot be read.
+
+RETURNS
+   SUCCEED/FAIL
+-----------------------------------------------------------------------*/
+static intn
+VIfind_build(HFILEID  f,  /* IN: file id */
+             vfile_t *vf, /* IN: vgroup file record */
+             intn     which /* IN: index to build */)
+{
+    TBBT_TREE    *tree = NULL;
+    TBBT_NODE    *t    = NULL;
+    vginstance_t *v    = NULL;
+    vsinstance_t *w    = NULL;
+    vfindnode_t  *node = NULL;
+    char         *name;
+    uint16        ref;
+    size_t        len;
+    intn          ret_value = SUCCEED;
+
+    if ((tree = tbbtdmake(VIfindcompare, 0, 0)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    if (which == VFIND_VGNAME || which == VFIND_VGCLASS)
+        t = (vf->vgtree != NULL) ? tbbtfirst((TBBT_NODE *)*(vf->vgtree)) : NULL;
+    else
+        t = (vf->vstree != NULL) ? tbbtfirst((TBBT_NODE *)*(vf->vstree)) : NULL;
+
+    for (; t != NULL; t = tbbtnext(t)) {
+        if (which == VFIND_VGNAME || which == VFIND_VGCLASS) {
+            ref = (uint16)((vginstance_t *)t->data)->ref;
+            if ((v = vginst(f, ref)) == NULL)
+                break;
+            name = (which == VFIND_VGNAME) ? v->vg->vgname : v->vg->vgclass;
+            if (name == NULL) /* never set */
+                continue;
+        }
+        else {
+            ref = (uint16)((vsinstance_t *)t->data)->ref;
+            if ((w = vsinst(f, ref)) == NULL)
+                break;
+            name = (which == VFIND_VSNAME) ? w->vs->vsname : w->vs->vsclass;
+        }
+
+        /* a lower ref already has this name */
+        if (tbbtdfind(tree, (void *)name, NULL) != NULL)
+            continue;
+
+        len = strlen(name);
+        if ((node = (vfindnode_t *)malloc(sizeof(vfindnode_t) + len + 1)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        node->ref  = (int32)ref;
+        node->name = (char *)(node + 1);
+        memcpy(node->name, name, len + 1);
+        if (tbbtdins(tree, (void *)node, (void *)node->name) == NULL) {
+            free(node);
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        }
+    }
+
+    vf->findtree[which] = tree;
+
+done:
+    if (ret_value == FAIL && tree != NULL)
+        tbbtdfree(tree, free, NULL);
+
+    return ret_value;
+} /* VIfind_build */
+
+/* -----------------------------------------------------------------
+NAME
+   VIfind_lookup -- looks up a name or class in an index of a file
+
+DESCRIPTION
+   Builds the index 'which' of the file if it is not there yet and
+   looks up 'name' in it.
+
+RETURNS
+   Returns 0 if not found or on error, otherwise the lowest ref of
+   the vgroups or vdatas with that name or class.
+-----------------------------------------------------------------------*/
+static int32
+VIfind_lookup(HFILEID     f,     /* IN: file id */
+              intn        which, /* IN: index to look in */
+              const char *name /* IN: name or class to find */)
+{
+    vfile_t *vf        = NULL;
+    void   **t         = NULL;
+    int32    ret_value = 0;
+
+    if (NULL == (vf = Get_vfile(f)))
+        HGOTO_ERROR(DFE_FNF, 0);
+
+    if (vf->findtree[which] == NULL && VIfind_build(f, vf, which) == FAIL)
+        HGOTO_DONE(0);
+
+    if ((t = (void **)tbbtdfind(vf->findtree[which], (void *)name, NULL)) != NULL)
+        ret_value = ((vfindnode_t *)*t)->ref;
+
+done:
+    return ret_value;
+} /* VIfind_lookup */
+
 /* -----------------------------------------------------------------
 NAME
    Vfind -- looks in the file and returns the ref of
@@ -878,30 +1058,14 @@ int32
 Vfind(HFILEID     f, /* IN: file id */
       const char *vgname /* IN: name of vgroup to find */)
 {
-    int32         vgid      = -1;
-    vginstance_t *v         = NULL;
-    VGROUP       *vg        = NULL;
-    int32         ret_value = 0;
+    int32 ret_value = 0;
 
     /* check for null vgroup name */
     if (vgname == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* process through Vgroups in file */
-    while (FAIL != (vgid = Vgetid(f, vgid))) { /* get instance of vgroup */
-        if ((v = vginst(f, (uint16)vgid)) == NULL)
-            HGOTO_DONE(0);
-
-        /* get vgroup itself and check it */
-        vg = v->vg;
-        if (vg == NULL)
-            HGOTO_DONE(0);
-
-        /* compare vgroup name to 'vgname' if it had been set */
-        if (vg->vgname != NULL)
-            if (!strcmp(vgname, vg->vgname))
-                HGOTO_DONE((int32)(vg->oref)); /* found the vgroup */
-    }
+    /* look it up in the index of the file */
+    ret_value = VIfind_lookup(f, VFIND_VGNAME, vgname);
 
 done:
     return ret_value;
@@ -924,29 +1088,14 @@ int32
 VSfind(HFILEID     f, /* IN: file id */
        const char *vsname /* IN: name of vdata to find */)
 {
-    int32         vsid      = -1;
-    vsinstance_t *v         = NULL;
-    VDATA        *vs        = NULL;
-    int32         ret_value = 0;
+    int32 ret_value = 0;
 
     /* check for null vdata name */
     if (vsname == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* process through Vdatas in file */
-    while (FAIL != (vsid = VSgetid(f, vsid))) { /* get instance of vdata */
-        if ((v = vsinst(f, (uint16)vsid)) == NULL)
-            HGOTO_DONE(0);
-
-        /* get vdata itself and check it */
-        vs = v->vs;
-        if (vs == NULL)
-            HGOTO_DONE(0);
-
-        /* compare vdata name to 'vsname' if it had been set */
-        if (!strcmp(vsname, vs->vsname))
-            HGOTO_DONE((int32)(vs->oref)); /* found the vdata */
-    }
+    /* look it up in the index of the file */
+    ret_value = VIfind_lookup(f, VFIND_VSNAME, vsname);
 
 done:
     return ret_value;
@@ -969,32 +1118,14 @@ int32
 Vfindclass(HFILEID     f, /* IN: file id */
            const char *vgclass /* IN: class of vgroup to find */)
 {
-    int32         vgid      = -1;
-    vginstance_t *v         = NULL;
-    VGROUP       *vg        = NULL;
-    int32         ret_value = 0;
+    int32 ret_value = 0;
 
     /* check for null vgroup class */
     if (vgclass == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* process through Vgroups in file */
-    while (FAIL != (vgid = Vgetid(f, vgid))) { /* get instance of vgroup */
-        if ((v = vginst(f, (uint16)vgid)) == NULL)
-            HGOTO_DONE(0);
-
-        /* get vgroup itself and check it */
-        vg = v->vg;
-        if (vg == NULL)
-            HGOTO_DONE(0);
-        /* Shouldn't we move on to the next vgroup instead of getting out?
-           Same question for the above HGOTO_DONE. -BMR 9/12/2011 */
-
-        /* compare vgroup class to 'vgclass' if it had been set */
-        if (vg->vgclass != NULL)
-            if (!strcmp(vgclass, vg->vgclass))
-                HGOTO_DONE((int32)(vg->oref)); /* found the vgroup */
-    }
+    /* look it up in the index of the file */
+    ret_value = VIfind_lookup(f, VFIND_VGCLASS, vgclass);
 
 done:
     return ret_value;
@@ -1017,29 +1148,14 @@ int32
 VSfindclass(HFILEID     f, /* IN: file id */
             const char *vsclass /* IN: class of vdata to find */)
 {
-    int32         vsid      = -1;
-    vsinstance_t *v         = NULL;
-    VDATA        *vs        = NULL;
-    int32         ret_value = 0;
+    int32 ret_value = 0;
 
     /* check for null vdata class */
     if (vsclass == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* process through Vdatas in file */
-    while (FAIL != (vsid = VSgetid(f, vsid))) { /* get instance of vdata */
-        if ((v = vsinst(f, (uint16)vsid)) == NULL)
-            HGOTO_DONE(0); /* error */
-
-        /* get vdata itself and check it */
-        vs = v->vs;
-        if (vs == NULL)
-            HGOTO_DONE(0);
-
-        /* compare vdata class to 'vsclass' if it had been set */
-        if (!strcmp(vsclass, vs->vsclass))
-            HGOTO_DONE((int32)(vs->oref)); /* found the vdata */
-    }
+    /* look it up in the index of the file */
+    ret_value = VIfind_lookup(f, VFIND_VSCLASS, vsclass);
 
 done:
     return ret_value;
@@ -94,6 +94,29 @@ typedef struct dyn_vgattr_struct {
     uint16 atag, aref; /* tag/ref pair of the attr     */
 } vg_attr_t;
 
+/* A vgroup attribute kept in the vgroup's compact attribute store.  Small
+   attributes set with Vsetcompactattr() on are packed into one vdata of
+   class _HDF_ATTR_STORE per vgroup instead of one vdata each; their
+   entries in the vgroup's attribute list have VG_ATTR_STORE_TAG as atag
+   and the ref of that vdata as aref, in the order they are in the store. */
+#define VG_ATTR_STORE_TAG DFTAG_VS
+#define VATTR_COMPACT_MAX 256 /* largest attribute kept in the store, in bytes */
+
+typedef struct vattr_compact_struct {
+    char  *name;   /* name of the attribute */
+    int32  type;   /* number type of the values */
+    int32  count;  /* # of values */
+    uint8 *values; /* values, in file format */
+} vattr_compact_t;
+
+typedef struct vattr_store_struct {
+    intn             n;     /* # of attributes in the store */
+    intn             max;   /* # of entries allocated in attrs */
+    vattr_compact_t *attrs; /* the attributes, in attribute list order */
+    uint16           ref;   /* ref of the store vdata, 0 if none yet */
+    intn             dirty; /* =1 if the store must be written out */
+} vattr_store_t;
+
 typedef struct dyn_read_struct {
     intn  n;    /* # fields to read */
     intn *item; /* index into vftable_struct */
@@ -105,6 +128,10 @@ typedef struct dyn_read_struct {
  *  -----------------------------------------------
  */
 
+/* Fewest entries of a vgroup for which its tag/ref pairs are looked up
+   through a hash table, see VIvg_find() */
+#define VG_TAGREF_HASH_MIN 64
+
 struct vgroup_desc {
     uint16  otag, oref;                /* tag-ref of this vgroup */
     HFILEID f;                         /* HDF file id  */
@@ -129,7 +156,11 @@ struct vgroup_desc {
     vg_attr_t *all_alist;              /* combined list; previous approach, only keep
                        just in case we come back to that approach; will
                        remove it once we decide not to go back 2/16/11 */
+    vattr_store_t      *astore;        /* compact attribute store, NULL until used */
+    intn               *thash;         /* entry of each tag/ref pair by hash, NULL until used */
+    intn                thash_size;    /* # of slots of thash, a power of 2 */
     int16               version, more; /* version and "more" field */
+    intn                in_arena;      /* TRUE if allocated from the arena of the file */
     struct vgroup_desc *next;          /* pointer to next node (for free list only) */
 };
 /* VGROUP */
@@ -140,6 +171,28 @@ struct vgroup_desc {
  *  -----------------------------------------------
  */
 
+/* Most field lists a vdata keeps resolved, see VSIfield_list() */
+#define VS_FLIST_MAX 16
+
+/* A list of field names resolved to indices in the write list of a vdata */
+typedef struct vs_flist_struct {
+    char                   *fields; /* the list as it was given */
+    intn                    n;      /* # of fields in the list */
+    intn                   *idx;    /* index of each field in the write list */
+    struct vs_flist_struct *next;   /* list used less recently */
+} vs_flist_t;
+
+/* Where VSfpack() copies each field from or to in a record of the buffer,
+   kept for the next call with the same field lists */
+typedef struct vs_fpack_struct {
+    char  *fields_in_buf; /* fields in the buffer as given, NULL for all */
+    char  *fields;        /* fields packed as given, NULL for all in the buffer */
+    intn   n;             /* # of fields packed */
+    int32  rec_size;      /* size of a record of the buffer */
+    int32 *offs;          /* offset of each field packed in a record */
+    int32 *sizes;         /* size of each field packed */
+} vs_fpack_t;
+
 struct vdata_desc {
     uint16         otag, oref;                /* tag,ref of this vdata */
     HFILEID        f;                         /* HDF file id */
@@ -165,6 +218,14 @@ struct vdata_desc {
     vs_attr_t                 *alist;         /* attribute list */
     int16                      version, more; /* version and "more" field */
     int32                      aid;           /* access id - for LINKED blocks */
+    struct vs_iter_struct     *iter;          /* batch scan set up by VSiter_begin, or NULL */
+    vs_flist_t                *flists;        /* field lists resolved, most recently used first */
+    intn                       nflists;       /* # of lists in flists */
+    intn                      *fhash;         /* write list index by hash of field name, or NULL */
+    intn                       fhash_size;    /* # of slots in fhash, a power of 2 */
+    vs_fpack_t                *fpack;         /* layout of the last VSfpack() call, or NULL */
+    intn                       in_arena;      /* TRUE if allocated from the arena of the file */
+    intn                       idx_stale;     /* TRUE if written to since its field indexes were built */
     struct vs_instance_struct *instance;      /* ptr to the instance struct for this VData */
     struct vdata_desc         *next;          /* pointer to next node (for free list only) */
 };                                            /* VDATA */
@@ -190,6 +251,7 @@ typedef struct vg_instance_struct {
     intn                       nattach;  /* # of current attaches to this vgroup */
     int32                      nentries; /* # of entries in that vgroup initially */
     VGROUP                    *vg;       /* points to the vg when it is attached */
+    intn                       in_arena; /* TRUE if allocated from the arena of the file */
     struct vg_instance_struct *next;     /* pointer to next node (for free list only) */
 } vginstance_t;
 
@@ -202,9 +264,18 @@ typedef struct vs_instance_struct {
     intn                       nattach;   /* # of current attaches to this vdata */
     int32                      nvertices; /* # of elements in that vdata initially */
     VDATA                     *vs;        /* points to the vdata when it is attached */
+    intn                       in_arena;  /* TRUE if allocated from the arena of the file */
     struct vs_instance_struct *next;      /* pointer to next node (for free list only) */
 } vsinstance_t;
 
+/* the name and class indexes kept for Vfind(), VSfind(), Vfindclass() and
+ * VSfindclass() */
+#define VFIND_VGNAME  0 /* vgroup names */
+#define VFIND_VGCLASS 1 /* vgroup classes */
+#define VFIND_VSNAME  2 /* vdata names */
+#define VFIND_VSCLASS 3 /* vdata classes */
+#define VFIND_NINDEX  4
+
 /* each vfile_t maintains 2 linked lists: one of vgs and one of vdatas
  * that already exist or are just created for a given file.  */
 typedef struct vfiledir_struct {
@@ -216,6 +287,14 @@ typedef struct vfiledir_struct {
     int32      vstabn; /* # of vs entries in vstab so far */
     TBBT_TREE *vstree; /* Root of VSet B-Tree */
     intn       access; /* the number of active pointers to this file's Vstuff */
+
+    TBBT_TREE *findtree[VFIND_NINDEX]; /* names and classes to the lowest ref */
+                                       /* using them, NULL until needed */
+    intn       compact_attrs;          /* TRUE to keep small vgroup attributes */
+                                       /* in compact attribute stores */
+    void      *arena;                  /* the vgroup and vdata instances and */
+                                       /* headers read from the file, see */
+                                       /* HDmarena_alloc() */
 } vfile_t;
 
 /* .................................................................. */
@@ -233,6 +312,16 @@ void VSIrelease_vdata_node(VDATA *v);
 
 intn VSIgetvdatas(int32 id, const char *vsclass, const uintn start_vd, const uintn n_vds, uint16 *refarray);
 
+void VSIiter_free(VDATA *vs);
+
+intn VSIindex_update(int32 vkey);
+
+intn VSIfield_index(VDATA *vs, const char *name);
+
+intn VSIfield_list(VDATA *vs, const char *fields, intn *nfields, const intn **idx);
+
+void VSIfields_free(VDATA *vs);
+
 HDFLIBAPI vsinstance_t *VSIget_vsinstance_node(void);
 
 HDFLIBAPI void VSIrelease_vsinstance_node(vsinstance_t *vs);
@@ -249,6 +338,18 @@ HDFLIBAPI intn VPparse_shutdown(void);
 
 HDFLIBAPI vfile_t *Get_vfile(HFILEID f);
 
+HDFLIBAPI void VIfind_reset(vfile_t *vf, intn which);
+
+HDFLIBAPI intn VIattr_store_flush(VGROUP *vg);
+
+HDFLIBAPI intn VIattr_store_datainfo(VGROUP *vg, intn attrindex, int32 *offset, int32 *length);
+
+HDFLIBAPI void VIattr_store_free(VGROUP *vg);
+
+intn VIvg_find(VGROUP *vg, uint16 tag, uint16 ref);
+
+void VIvg_hash_free(VGROUP *vg);
+
 HDFLIBAPI vsinstance_t *vsinst(HFILEID f, uint16 vsid);
 
 HDFLIBAPI vginstance_t *vginst(HFILEID f, uint16 vgid);
@@ -33,6 +33,10 @@ LOCAL ROUTINES
  VPgetinfo  --  Read in the "header" information about the Vgroup.
  VIstart    --  V-level initialization routine
  VPshutdown  --  Terminate various static buffers.
+ VPtrim      --  Free the free-lists and the buffer of the V routines.
+ VIvg_find   --  Finds a tag/ref pair in a vgroup, through a hash table
+                 for large vgroups.
+ VIvg_hash_free -- Frees the tag/ref hash table of a vgroup.
 
 EXPORTED ROUTINES
 =================
@@ -85,6 +89,8 @@ EXPORTED ROUTINES
  Vgetname     -- Returns the vgroup's name.
  Vgetclass    -- Returns the vgroup's class name .
  Vgetvgroups  -- Gets user-created vgroups in a file or in a vgroup
+ Vgettree     -- Gets the whole vgroup hierarchy of a file at once
+ Vfreetree    -- Frees a vgroup hierarchy returned by Vgettree
  Vinquire     -- General inquiry routine for VGROUP.
  Vopen        -- This routine opens the HDF file and initializes it for
                   Vset operations.(i.e." Hopen(); Vinitialize(f)").
@@ -169,6 +175,7 @@ VIget_vgroup_node(void)
     if (vgroup_free_list != NULL) {
         ret_value        = vgroup_free_list;
         vgroup_free_list = vgroup_free_list->next;
+        HDmem_release(HDF_MEM_FREE_LISTS, sizeof(VGROUP));
     } /* end if */
     else {
         if ((ret_value = (VGROUP *)malloc(sizeof(VGROUP))) == NULL)
@@ -199,6 +206,7 @@ VIrelease_vgroup_node(VGROUP *vg)
     /* Insert the atom at the beginning of the free list */
     vg->next         = vgroup_free_list;
     vgroup_free_list = vg;
+    HDmem_acquire(HDF_MEM_FREE_LISTS, sizeof(VGROUP));
 
 } /* end VIrelease_vgroup_node() */
 
@@ -224,6 +232,7 @@ VIget_vginstance_node(void)
     if (vginstance_free_list != NULL) {
         ret_value            = vginstance_free_list;
         vginstance_free_list = vginstance_free_list->next;
+        HDmem_release(HDF_MEM_FREE_LISTS, sizeof(vginstance_t));
     } /* end if */
     else {
         if ((ret_value = (vginstance_t *)malloc(sizeof(vginstance_t))) == NULL)
@@ -254,6 +263,7 @@ VIrelease_vginstance_node(vginstance_t *vg /* IN: vgroup instance to release */)
     /* Insert the vsinstance at the beginning of the free list */
     vg->next             = vginstance_free_list;
     vginstance_free_list = vg;
+    HDmem_acquire(HDF_MEM_FREE_LISTS, sizeof(vginstance_t));
 
 } /* end VIrelease_vginstance_node() */
 
@@ -319,6 +329,8 @@ DESCRIPTION
 
    loads vgtab table with info of all vgroups in file f.
    Will allocate a new vfile_t, then proceed to load vg instances.
+   Only the refs of the vgroups and vdatas are loaded, their headers
+   are read by vginst() and vsinst() the first time they are needed.
 
 RETURNS
    RETURNS FAIL if error or no more file slots available.
@@ -375,21 +387,19 @@ Load_vfile(HFILEID f /* IN: file handle */)
         /* get tag/ref for this vgroup */
         HQuerytagref(aid, &tag, &ref);
 
-        /* get a vgroup struct to fill */
-        if (NULL == (v = VIget_vginstance_node())) {
+        /* get a vgroup struct to fill, from the arena of the file */
+        if (NULL == (v = (vginstance_t *)HDmarena_alloc(&vf->arena, sizeof(vginstance_t)))) {
             tbbtdfree(vf->vgtree, vdestroynode, NULL);
             HGOTO_ERROR(DFE_NOSPACE, FAIL);
         }
 
         vf->vgtabn++; /* increment number of vgroups found in file */
 
-        v->key = (int32)ref; /* set the key for the node */
-        v->ref = (uintn)ref;
+        v->key      = (int32)ref; /* set the key for the node */
+        v->ref      = (uintn)ref;
+        v->in_arena = TRUE;
 
-        /* get the header information */
-        v->vg = VPgetinfo(f, ref);
-        if (v->vg == NULL)
-            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        /* the header information is read by vginst() when first needed */
 
         /* insert the vg instance in B-tree */
         tbbtdins(vf->vgtree, (void *)v, NULL);
@@ -418,8 +428,8 @@ Load_vfile(HFILEID f /* IN: file handle */)
         /* get tag/ref for this vdata */
         HQuerytagref(aid, &tag, &ref);
 
-        /* attach new vs to file's vstab */
-        if (NULL == (w = VSIget_vsinstance_node())) {
+        /* attach new vs to file's vstab, from the arena of the file */
+        if (NULL == (w = (vsinstance_t *)HDmarena_alloc(&vf->arena, sizeof(vsinstance_t)))) {
             tbbtdfree(vf->vgtree, vdestroynode, NULL);
             tbbtdfree(vf->vstree, vsdestroynode, NULL);
             HGOTO_ERROR(DFE_NOSPACE, FAIL);
@@ -427,13 +437,11 @@ Load_vfile(HFILEID f /* IN: file handle */)
 
         vf->vstabn++; /* increment number of vdatas found in file */
 
-        w->key = (int32)ref; /* set the key for the node */
-        w->ref = (uintn)ref;
+        w->key      = (int32)ref; /* set the key for the node */
+        w->ref      = (uintn)ref;
+        w->in_arena = TRUE;
 
-        /* get the header information */
-        w->vs = VSPgetinfo(f, ref);
-        if (w->vs == NULL)
-            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        /* the header information is read by vsinst() when first needed */
 
         w->nattach   = 0;
         w->nvertices = 0;
@@ -461,6 +469,14 @@ Load_vfile(HFILEID f /* IN: file handle */)
         }
     }
 
+    /* the trees are mostly searched from now on, until Vgroups or Vdatas
+       are created or deleted */
+    if (tbbtdindex(vf->vgtree) == FAIL || tbbtdindex(vf->vstree) == FAIL) {
+        tbbtdfree(vf->vgtree, vdestroynode, NULL);
+        tbbtdfree(vf->vstree, vsdestroynode, NULL);
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    }
+
 done:
     return ret_value;
 } /* Load_vfile */
@@ -502,6 +518,10 @@ Remove_vfile(HFILEID f /* IN: file handle */)
     /* clear out the tbbt's */
     tbbtdfree(vf->vgtree, vdestroynode, NULL);
     tbbtdfree(vf->vstree, vsdestroynode, NULL);
+    VIfind_reset(vf, -1);
+
+    /* the instances and headers from the file go all at once */
+    HDmarena_free(&vf->arena);
 
     /* Find the node in the tree */
     if ((t = (void **)tbbtdfind(vtree, (void *)&f, NULL)) == NULL)
@@ -582,6 +602,8 @@ vdestroynode(void *n /* IN: node to free */)
             free(vg->vgname);
             free(vg->vgclass);
             free(vg->alist);
+            VIattr_store_free(vg);
+            VIvg_hash_free(vg);
 
             /* Free the old-style attr list and reset associated fields */
             if (vg->old_alist != NULL) {
@@ -590,10 +612,12 @@ vdestroynode(void *n /* IN: node to free */)
                 vg->noldattrs = 0;
             }
 
-            VIrelease_vgroup_node(vg);
+            if (!vg->in_arena)
+                VIrelease_vgroup_node(vg);
         }
 
-        VIrelease_vginstance_node((vginstance_t *)n);
+        if (!((vginstance_t *)n)->in_arena)
+            VIrelease_vginstance_node((vginstance_t *)n);
     } /* end if n */
 } /* vdestroynode */
 
@@ -621,6 +645,7 @@ vfdestroynode(void *n /* IN: vfile_t record to free */)
         /* clear out the tbbt's */
         tbbtdfree(vf->vgtree, vdestroynode, NULL);
         tbbtdfree(vf->vstree, vsdestroynode, NULL);
+        VIfind_reset(vf, -1);
 
         free(vf);
     }
@@ -692,7 +717,8 @@ NAME
 
 DESCRIPTION
    Looks thru vgtab for vgid and return the addr of the vg instance
-   where vgid is found.
+   where vgid is found.  The header of the vgroup is read from the file
+   the first time it is looked up.
 
 RETURNS
    RETURNS NULL if error or not found.
@@ -720,6 +746,10 @@ vginst(HFILEID f, /* IN: file handle */
     t   = (void **)tbbtdfind(vf->vgtree, (void *)&key, NULL);
     if (t != NULL) {
         ret_value = ((vginstance_t *)*t); /* return the actual vginstance_t ptr */
+
+        /* read the header of a vgroup not looked at since the file was opened */
+        if (ret_value->vg == NULL && (ret_value->vg = VPgetinfo(f, vgid)) == NULL)
+            HGOTO_ERROR(DFE_INTERNAL, NULL);
         goto done;
     }
 
@@ -992,10 +1022,11 @@ VGROUP *
 VPgetinfo(HFILEID f, /* IN: file handle */
           uint16  ref /* IN: ref of vgroup */)
 {
-    VGROUP *vg = NULL;
+    VGROUP  *vg = NULL;
+    vfile_t *vf = NULL;
     /*  intn          len;    intn mismatches Vgbufsize type -- uint32 */
-    size_t  len;
-    VGROUP *ret_value = NULL; /* FAIL */
+    size_t   len;
+    VGROUP  *ret_value = NULL; /* FAIL */
 
     /* clear error stack */
     HEclear();
@@ -1005,11 +1036,7 @@ VPgetinfo(HFILEID f, /* IN: file handle */
         HGOTO_ERROR(DFE_INTERNAL, NULL);
 
     if (len > Vgbufsize) {
-        Vgbufsize = len;
-
-        free(Vgbuf);
-
-        if ((Vgbuf = (uint8 *)malloc(Vgbufsize)) == NULL)
+        if (HDscratch_resize(&Vgbuf, &Vgbufsize, len) == FAIL)
             HGOTO_ERROR(DFE_NOSPACE, NULL);
     }
 
@@ -1017,9 +1044,12 @@ VPgetinfo(HFILEID f, /* IN: file handle */
     if (Hgetelement(f, DFTAG_VG, (uint16)ref, Vgbuf) == (int32)FAIL)
         HGOTO_ERROR(DFE_NOMATCH, NULL);
 
-    /* allocate space for vg */
-    if (NULL == (vg = VIget_vgroup_node()))
+    /* allocate space for vg, from the arena of the file */
+    if (NULL == (vf = Get_vfile(f)))
+        HGOTO_ERROR(DFE_FNF, NULL);
+    if (NULL == (vg = (VGROUP *)HDmarena_alloc(&vf->arena, sizeof(VGROUP))))
         HGOTO_ERROR(DFE_NOSPACE, NULL);
+    vg->in_arena = TRUE;
 
     /* unpack vgpack into structure vg, and init  */
     vg->f    = f;
@@ -1233,6 +1263,11 @@ Vdetach(int32 vkey /* IN: vgroup key */)
     /* no reason to check for access... (I hope) -QAK */
     if (vg->marked == 1) {
         size_t need, vgnamelen = 0, vgclasslen = 0;
+
+        /* the compact attribute store goes first, the vgroup points to it */
+        if (FAIL == VIattr_store_flush(vg))
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
         if (vg->vgname != NULL)
             vgnamelen = strlen(vg->vgname);
 
@@ -1243,11 +1278,7 @@ Vdetach(int32 vkey /* IN: vgroup key */)
                + vgclasslen               /* vgclass dynamic, vpackvg omits null */
                + (size_t)vg->nvelt * 4 + (size_t)vg->nattrs * sizeof(vg_attr_t) + 1;
         if (need > Vgbufsize) {
-            Vgbufsize = need;
-
-            free(Vgbuf);
-
-            if ((Vgbuf = (uint8 *)malloc(Vgbufsize)) == NULL)
+            if (HDscratch_resize(&Vgbuf, &Vgbufsize, need) == FAIL)
                 HGOTO_ERROR(DFE_NOSPACE, FAIL);
         } /* end if */
 
@@ -1321,7 +1352,6 @@ Vinsert(int32 vkey, /* IN: vgroup key */
     uint16        newtag = 0;
     uint16        newref = 0;
     int32         newfid;
-    uintn         u;
     int32         ret_value = SUCCEED;
 
     /* clear error stack */
@@ -1382,10 +1412,8 @@ Vinsert(int32 vkey, /* IN: vgroup key */
         HGOTO_ERROR(DFE_DIFFFILES, FAIL);
 
     /* check and prevent duplicate links */
-    for (u = 0; u < (uintn)vg->nvelt; u++) {
-        if ((vg->ref[u] == newref) && (vg->tag[u] == newtag))
-            HGOTO_ERROR(DFE_DUPDD, FAIL);
-    }
+    if (VIvg_find(vg, newtag, newref) != FAIL)
+        HGOTO_ERROR(DFE_DUPDD, FAIL);
 
     /* Finally, ok to insert */
     if (vinsertpair(vg, newtag, newref) == FAIL)
@@ -1477,9 +1505,6 @@ Vinqtagref(int32 vkey, /* IN: vgroup key */
            int32 tag,  /* IN: tag to check in vgroup */
            int32 ref /* IN: ref to check in vgroup */)
 {
-    uintn         u;
-    uint16        ttag;
-    uint16        rref;
     vginstance_t *v         = NULL;
     VGROUP       *vg        = NULL;
     intn          ret_value = FALSE;
@@ -1500,13 +1525,8 @@ Vinqtagref(int32 vkey, /* IN: vgroup key */
     if (vg == NULL)
         HGOTO_ERROR(DFE_BADPTR, FALSE);
 
-    ttag = (uint16)tag;
-    rref = (uint16)ref;
-
-    for (u = 0; u < (uintn)vg->nvelt; u++) {
-        if ((ttag == vg->tag[u]) && (rref == vg->ref[u]))
-            HGOTO_DONE(TRUE);
-    }
+    if (VIvg_find(vg, (uint16)tag, (uint16)ref) != FAIL)
+        HGOTO_DONE(TRUE);
 
 done:
     return ret_value;
@@ -1532,9 +1552,8 @@ Vdeletetagref(int32 vkey, /* IN: vgroup key */
               int32 tag,  /* IN: tag to delete in vgroup */
               int32 ref /* IN: ref to delete in vgroup */)
 {
-    uintn         i, j;             /* loop indices */
-    uint16        ttag;             /* tag for comparison */
-    uint16        rref;             /* ref for comparison */
+    intn          i;                /* index of the entry to delete */
+    intn          n;                /* index of the last entry */
     vginstance_t *v         = NULL; /* vgroup instance struct */
     VGROUP       *vg        = NULL; /* in-memory vgroup struct */
     intn          ret_value = SUCCEED;
@@ -1562,48 +1581,31 @@ Vdeletetagref(int32 vkey, /* IN: vgroup key */
     if (vg == NULL)
         HGOTO_ERROR(DFE_BADPTR, FAIL);
 
-    /* set comparison tag/ref pair */
-    ttag = (uint16)tag;
-    rref = (uint16)ref;
-
-    /* look through elements in vgroup */
-    for (i = 0; i < (uintn)vg->nvelt; i++) { /* see if element tag/ref matches search tag/ref */
-        if ((ttag == vg->tag[i]) &&
-            (rref == vg->ref[i])) { /* found tag/ref pair to delete.
-                                       If duplicate tag/ref pairs exist, then it deletes
-                                       the first occurrence. If the case of duplicate tag/ref
-                                       pairs the user can call Vinqtagref() to see if there
-                                       are more occurrences and then delete them.*/
-
-            /* check if element found is last one in vgroup */
-            if (i != ((uintn)vg->nvelt - 1)) { /* Basically shifts the contents of the array down by one.
-                                                  This method will preserve the order without using
-                                                  extra memory for storage etc. If speed/performance
-                                                  is an issue you can use memmove()/memcpy(). */
-                for (j = i; j < (uintn)vg->nvelt - 1; j++) {
-                    vg->tag[j] = vg->tag[j + 1];
-                    vg->ref[j] = vg->ref[j + 1];
-                }
-            }
-            /* else if last one , do nothing and allow the
-               number of elements to be decrementd. */
-
-            /* reset last ones, just to be sure  */
-            vg->tag[(uintn)vg->nvelt - 1] = DFTAG_NULL;
-            vg->ref[(uintn)vg->nvelt - 1] = 0; /* invalid ref */
-
-            vg->nvelt--;       /* decrement number of elements in vgroup */
-            vg->marked = TRUE; /* mark vgroup as changed.
-                                  forces re-writing of new vgroup. */
-            ret_value = SUCCEED;
-            goto done; /* we are done */
-        }              /* if found */
-    }                  /* for all items in vgroup */
-
-    /* reaching here means tag/ref pair not found. The user
-       should have used Vinqtagref() before calling this fcn.
-       Oh well...*/
-    ret_value = FAIL;
+    /* find the first occurrence of the tag/ref pair */
+    if ((i = VIvg_find(vg, (uint16)tag, (uint16)ref)) == FAIL) {
+        /* reaching here means tag/ref pair not found. The user
+           should have used Vinqtagref() before calling this fcn.
+           Oh well...*/
+        HGOTO_DONE(FAIL);
+    }
+
+    /* shift the entries after it down by one, preserving the order */
+    n = (intn)vg->nvelt - 1;
+    if (i != n) {
+        memmove(&vg->tag[i], &vg->tag[i + 1], (size_t)(n - i) * sizeof(uint16));
+        memmove(&vg->ref[i], &vg->ref[i + 1], (size_t)(n - i) * sizeof(uint16));
+    }
+
+    /* reset last ones, just to be sure  */
+    vg->tag[n] = DFTAG_NULL;
+    vg->ref[n] = 0; /* invalid ref */
+
+    vg->nvelt--;       /* decrement number of elements in vgroup */
+    vg->marked = TRUE; /* mark vgroup as changed.
+                          forces re-writing of new vgroup. */
+
+    /* the entries after it have moved */
+    VIvg_hash_free(vg);
 
 done:
     return ret_value;
@@ -1906,10 +1908,7 @@ Vaddtagref(int32 vkey, /* IN: vgroup key */
 {
     vginstance_t *v  = NULL;
     VGROUP       *vg = NULL;
-#ifdef NO_DUPLICATES
-    uintn i;
-#endif /* NO_DUPLICATES */
-    int32 ret_value = SUCCEED;
+    int32         ret_value = SUCCEED;
 
     /* clear error stack */
     HEclear();
@@ -1931,9 +1930,8 @@ Vaddtagref(int32 vkey, /* IN: vgroup key */
     /* SD interface needs duplication if two dims have the same name.
        So, don't remove the ifdef/endif pair.   */
     /* make sure doesn't already exist in the Vgroup */
-    for (i = 0; i < vg->nvelt; i++)
-        if ((tag == vg->tag[i]) && (ref == vg->ref[i]))
-            HGOTO_DONE(FAIL);
+    if (VIvg_find(vg, (uint16)tag, (uint16)ref) != FAIL)
+        HGOTO_DONE(FAIL);
 #endif /* NO_DUPLICATES  */
 
     ret_value = vinsertpair(vg, (uint16)tag, (uint16)ref);
@@ -1942,6 +1940,96 @@ done:
     return ret_value;
 } /* Vaddtagref */
 
+/* Hash of a tag/ref pair for VIvg_find() */
+static uint32
+VIvg_hash(uint16 tag, uint16 ref)
+{
+    uint32 h = (((uint32)tag << 16) | (uint32)ref) * 2654435761U;
+
+    return h ^ (h >> 16);
+}
+
+/* Puts entry 'idx' of a vgroup in its hash table, unless an earlier entry
+   has the same tag/ref */
+static void
+VIvg_hash_add(VGROUP *vg, intn idx)
+{
+    uint32 mask = (uint32)vg->thash_size - 1;
+    uint32 h;
+
+    for (h = VIvg_hash(vg->tag[idx], vg->ref[idx]) & mask; vg->thash[h] != FAIL; h = (h + 1) & mask)
+        if (vg->tag[vg->thash[h]] == vg->tag[idx] && vg->ref[vg->thash[h]] == vg->ref[idx])
+            return;
+    vg->thash[h] = idx;
+} /* VIvg_hash_add */
+
+/*******************************************************************************
+NAME
+   VIvg_find -- Finds a tag/ref pair in a vgroup
+
+DESCRIPTION
+   Vgroups of VG_TAGREF_HASH_MIN entries or more are looked up through a
+   hash table of their tag/ref pairs, built the first time it is needed and
+   kept up to date by vinsertpair; smaller ones are searched.
+
+RETURNS
+   The index of the first entry with tag/ref, FAIL if there is none.
+
+*******************************************************************************/
+intn
+VIvg_find(VGROUP *vg,  /* IN: vgroup struct */
+          uint16  tag, /* IN: tag to find */
+          uint16  ref /* IN: ref to find */)
+{
+    uint32 mask, h;
+    intn   i, size;
+
+    if ((intn)vg->nvelt >= VG_TAGREF_HASH_MIN && vg->thash == NULL) {
+        for (size = 2 * VG_TAGREF_HASH_MIN; size < 2 * (intn)vg->nvelt; size *= 2)
+            ;
+        /* without the memory for it, the entries are searched */
+        if ((vg->thash = (intn *)malloc((size_t)size * sizeof(intn))) != NULL) {
+            vg->thash_size = size;
+            for (i = 0; i < size; i++)
+                vg->thash[i] = FAIL;
+            for (i = 0; i < (intn)vg->nvelt; i++)
+                VIvg_hash_add(vg, i);
+        }
+    }
+
+    if (vg->thash == NULL) {
+        for (i = 0; i < (intn)vg->nvelt; i++)
+            if (vg->tag[i] == tag && vg->ref[i] == ref)
+                return i;
+        return FAIL;
+    }
+
+    mask = (uint32)vg->thash_size - 1;
+    for (h = VIvg_hash(tag, ref) & mask; vg->thash[h] != FAIL; h = (h + 1) & mask)
+        if (vg->tag[vg->thash[h]] == tag && vg->ref[vg->thash[h]] == ref)
+            return vg->thash[h];
+    return FAIL;
+} /* VIvg_find */
+
+/*******************************************************************************
+NAME
+   VIvg_hash_free -- Frees the tag/ref hash table of a vgroup
+
+DESCRIPTION
+   Frees the hash table of VIvg_find, which builds it again when needed.
+
+RETURNS
+   Nothing
+
+*******************************************************************************/
+void
+VIvg_hash_free(VGROUP *vg /* IN: vgroup struct */)
+{
+    free(vg->thash);
+    vg->thash      = NULL;
+    vg->thash_size = 0;
+} /* VIvg_hash_free */
+
 /*******************************************************************************
 NAME
   vinsertpair
@@ -1978,6 +2066,14 @@ vinsertpair(VGROUP *vg,  /* IN: vgroup struct */
     vg->ref[(uintn)vg->nvelt] = ref;
     vg->nvelt++;
 
+    /* a full hash table is built again, larger, by the next VIvg_find() */
+    if (vg->thash != NULL) {
+        if (2 * (intn)vg->nvelt > vg->thash_size)
+            VIvg_hash_free(vg);
+        else
+            VIvg_hash_add(vg, (intn)vg->nvelt - 1);
+    }
+
     vg->marked = TRUE;
     ret_value  = ((int32)vg->nvelt);
 
@@ -2042,6 +2138,7 @@ Vsetname(int32       vkey, /* IN: vgroup key */
 {
     vginstance_t *v  = NULL;
     VGROUP       *vg = NULL;
+    vfile_t      *vf = NULL;
     size_t        name_len;
     int32         ret_value = SUCCEED;
 
@@ -2080,6 +2177,10 @@ Vsetname(int32       vkey, /* IN: vgroup key */
 
     vg->marked = TRUE;
 
+    /* the searches have to look at the new name */
+    if ((vf = Get_vfile(vg->f)) != NULL)
+        VIfind_reset(vf, VFIND_VGNAME);
+
 done:
     return ret_value;
 } /* Vsetname */
@@ -2104,6 +2205,7 @@ Vsetclass(int32       vkey, /* IN: vgroup key */
 {
     vginstance_t *v  = NULL;
     VGROUP       *vg = NULL;
+    vfile_t      *vf = NULL;
     size_t        classname_len;
     int32         ret_value = SUCCEED;
 
@@ -2148,6 +2250,10 @@ Vsetclass(int32       vkey, /* IN: vgroup key */
 
     vg->marked = TRUE;
 
+    /* the searches have to look at the new class */
+    if ((vf = Get_vfile(vg->f)) != NULL)
+        VIfind_reset(vf, VFIND_VGCLASS);
+
 done:
     return ret_value;
 } /* Vsetclass */
@@ -2168,8 +2274,6 @@ intn
 Visvg(int32 vkey, /* IN: vgroup key */
       int32 id /* IN: id of entry in vgroup */)
 {
-    uintn         u;
-    uint16        ID;
     vginstance_t *v         = NULL;
     VGROUP       *vg        = NULL;
     intn          ret_value = FALSE; /* initialize to FALSE */
@@ -2190,15 +2294,8 @@ Visvg(int32 vkey, /* IN: vgroup key */
     if (vg == NULL)
         HGOTO_ERROR(DFE_BADPTR, FALSE);
 
-    ID = (uint16)id; /* cast 32bit ID to 16bit id */
-
-    for (u = 0; u < (uintn)vg->nvelt; u++) {
-        if (vg->ref[u] == ID &&     /* if the ids match, */
-            vg->tag[u] == DFTAG_VG) /* and it is a vgroup */
-        {
-            HGOTO_DONE(TRUE);
-        }
-    }
+    if (VIvg_find(vg, DFTAG_VG, (uint16)id) != FAIL)
+        HGOTO_DONE(TRUE);
 
 done:
     return ret_value;
@@ -2220,7 +2317,6 @@ intn
 Visvs(int32 vkey, /* IN: vgroup key */
       int32 id /* IN: id of entry in vgroup */)
 {
-    intn          i;
     vginstance_t *v         = NULL;
     VGROUP       *vg        = NULL;
     intn          ret_value = FALSE; /* initialize to false */
@@ -2241,11 +2337,8 @@ Visvs(int32 vkey, /* IN: vgroup key */
     if (vg == NULL)
         HGOTO_ERROR(DFE_BADPTR, FALSE);
 
-    i = (intn)vg->nvelt;
-    while (i) {
-        if (vg->ref[--i] == (uint16)id && vg->tag[i] == VSDESCTAG)
-            HGOTO_DONE(TRUE);
-    }
+    if (VIvg_find(vg, VSDESCTAG, (uint16)id) != FAIL)
+        HGOTO_DONE(TRUE);
 
 done:
     return ret_value;
@@ -2790,6 +2883,8 @@ Vdelete(int32 f, /* IN: file handle */
     /* remove vgroup node from TBBT */
     if ((v = tbbtrem((TBBT_NODE **)vf->vgtree, (TBBT_NODE *)t, NULL)) != NULL)
         vdestroynode((void *)v);
+    VIfind_reset(vf, VFIND_VGNAME);
+    VIfind_reset(vf, VFIND_VGCLASS);
 
     /* Delete vgroup from file */
     if (Hdeldd(f, DFTAG_VG, (uint16)vgid) == FAIL)
@@ -2844,29 +2939,7 @@ done:
 intn
 VPshutdown(void)
 {
-    VGROUP       *v         = NULL;
-    vginstance_t *vg        = NULL;
-    intn          ret_value = SUCCEED;
-
-    /* Release the vdata free-list if it exists */
-    if (vgroup_free_list != NULL) {
-        while (vgroup_free_list != NULL) {
-            v                = vgroup_free_list;
-            vgroup_free_list = vgroup_free_list->next;
-            v->next          = NULL;
-            free(v);
-        }
-    }
-
-    /* Release the vginstance free-list if it exists */
-    if (vginstance_free_list != NULL) {
-        while (vginstance_free_list != NULL) {
-            vg                   = vginstance_free_list;
-            vginstance_free_list = vginstance_free_list->next;
-            vg->next             = NULL;
-            free(vg);
-        }
-    }
+    intn ret_value = SUCCEED;
 
     if (vtree != NULL) {
         /* Free the vfile tree */
@@ -2882,16 +2955,51 @@ VPshutdown(void)
         vtree = NULL;
     }
 
-    if (Vgbuf != NULL) {
-        free(Vgbuf);
-        Vgbuf     = NULL;
-        Vgbufsize = 0;
-    }
+    /* Release the nodes freed with the tree too */
+    ret_value = VPtrim();
 
 done:
     return ret_value;
 } /* end VPshutdown() */
 
+/*******************************************************************************
+ NAME
+    VPtrim  --  Free the free-lists and the buffer of the V routines.
+
+ DESCRIPTION
+    Frees the vgroup and vginstance nodes kept for reuse and the buffer of
+    the vgroup headers, which are allocated again when needed, see
+    Htrim_memory().
+
+ RETURNS
+    Returns SUCCEED/FAIL
+
+*******************************************************************************/
+intn
+VPtrim(void)
+{
+    VGROUP       *v  = NULL;
+    vginstance_t *vg = NULL;
+
+    /* Release the vgroup free-list if it exists */
+    while (vgroup_free_list != NULL) {
+        v                = vgroup_free_list;
+        vgroup_free_list = vgroup_free_list->next;
+        free(v);
+        HDmem_release(HDF_MEM_FREE_LISTS, sizeof(VGROUP));
+    }
+
+    /* Release the vginstance free-list if it exists */
+    while (vginstance_free_list != NULL) {
+        vg                   = vginstance_free_list;
+        vginstance_free_list = vginstance_free_list->next;
+        free(vg);
+        HDmem_release(HDF_MEM_FREE_LISTS, sizeof(vginstance_t));
+    }
+
+    return HDscratch_resize(&Vgbuf, &Vgbufsize, 0);
+} /* end VPtrim() */
+
 /*******************************************************************************
  NAME
     Vgisinternal  --  Determine if a vgroup is internally created by the lib
@@ -3179,3 +3287,242 @@ Vgetvgroups(int32   id,       /* IN: file id or vgroup id */
 done:
     return ret_value;
 } /* Vgetvgroups */
+
+/* A vgroup of the file while Vgettree sorts them by offset */
+typedef struct vgtree_ent_t {
+    vginstance_t *inst;   /* instance of the vgroup */
+    int32         offset; /* offset of its element, INT32_MAX if not written */
+    int32         rank;   /* position of the vgroup in ref order */
+} vgtree_ent_t;
+
+/* qsort() comparison of vgroups by the offset of their elements */
+static int
+VIvgtree_compare(const void *p1, const void *p2)
+{
+    const vgtree_ent_t *e1 = (const vgtree_ent_t *)p1;
+    const vgtree_ent_t *e2 = (const vgtree_ent_t *)p2;
+
+    if (e1->offset != e2->offset)
+        return (e1->offset > e2->offset) ? 1 : -1;
+    return (e1->rank > e2->rank) - (e1->rank < e2->rank);
+} /* VIvgtree_compare */
+
+/* Node index of the vgroup with ref, -1 if the file has none */
+static int32
+VIvgtree_node(const uint16 refs[], const int32 node_of[], int32 n, uint16 ref)
+{
+    int32 lo = 0, hi = n - 1, mid;
+
+    while (lo <= hi) {
+        mid = lo + (hi - lo) / 2;
+        if (refs[mid] == ref)
+            return node_of[mid];
+        if (refs[mid] < ref)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+    return -1;
+} /* VIvgtree_node */
+
+/*******************************************************************************
+NAME
+    Vgettree -- Get the whole vgroup hierarchy of a file at once
+RETURNS
+    SUCCEED/FAIL
+
+DESCRIPTION
+    Sets *tree to the vgroups of the file, in the order of their elements in
+    the file.  Each node has the name, class name and tag/ref entries of its
+    vgroup, as Vgetname, Vgetclass and Vgettagrefs get them, and the node
+    index of each entry that is a vgroup of the file.  The tree, its nodes
+    and all the arrays and strings they point to are a single allocation,
+    released with Vfreetree.
+
+    No vgroup is attached.  The headers that have not been read since the
+    file was opened are read in one Hreadv and kept, as vginst would keep
+    them; the others, including those of attached vgroups, are taken from
+    memory.
+*******************************************************************************/
+intn
+Vgettree(HFILEID        f,   /* IN: file handle */
+         hdf_vgtree_t **tree /* OUT: the vgroup hierarchy */)
+{
+    vfile_t      *vf;
+    vgtree_ent_t *ents    = NULL; /* the vgroups, sorted by offset */
+    uint16       *refs    = NULL; /* ref of each vgroup, in ref order */
+    int32        *node_of = NULL; /* node index of each vgroup, in ref order */
+    hdf_readv_t  *reqs    = NULL; /* reads of the headers not read yet */
+    uint8        *raw     = NULL; /* the headers read */
+    hdf_vgtree_t *out     = NULL;
+    hdf_vgnode_t *node;
+    VGROUP       *vg;
+    void        **t;
+    int32        *children;
+    uint16       *etags, *erefs;
+    char         *names;
+    size_t        size;
+    int32         n, nreqs = 0, raw_size = 0, nentries = 0, nchildren = 0, nchars = 0;
+    int32         i, k, len;
+    intn          ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    if (tree == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    *tree = NULL;
+
+    /* get Vxxx file record */
+    if (NULL == (vf = Get_vfile(f)))
+        HGOTO_ERROR(DFE_FNF, FAIL);
+
+    n = (vf->vgtree == NULL) ? 0 : (int32)tbbtcount(vf->vgtree);
+    if (n > 0) {
+        if ((ents = malloc((size_t)n * sizeof(vgtree_ent_t))) == NULL ||
+            (refs = malloc((size_t)n * sizeof(uint16))) == NULL ||
+            (node_of = malloc((size_t)n * sizeof(int32))) == NULL ||
+            (reqs = malloc((size_t)n * sizeof(hdf_readv_t))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+        /* collect the vgroups in ref order, with the lengths of the headers to read */
+        t = (void **)tbbtfirst((TBBT_NODE *)*(vf->vgtree));
+        for (i = 0; i < n && t != NULL; i++, t = (void **)tbbtnext((TBBT_NODE *)t)) {
+            ents[i].inst = (vginstance_t *)*t;
+            ents[i].rank = i;
+            refs[i]      = (uint16)ents[i].inst->ref;
+            if ((ents[i].offset = Hoffset(f, DFTAG_VG, refs[i])) == FAIL)
+                ents[i].offset = INT32_MAX; /* created but not written yet */
+            if (ents[i].inst->vg == NULL) {
+                if ((len = Hlength(f, DFTAG_VG, refs[i])) == FAIL)
+                    HGOTO_ERROR(DFE_INTERNAL, FAIL);
+                reqs[nreqs].tag    = DFTAG_VG;
+                reqs[nreqs].ref    = refs[i];
+                reqs[nreqs].offset = 0;
+                reqs[nreqs].length = len;
+                raw_size += len;
+                nreqs++;
+            }
+        }
+        n = i;
+        HEclear(); /* Hoffset() fails for the vgroups not written yet */
+    }
+
+    /* read the headers not read yet and keep them in their instances */
+    if (nreqs > 0) {
+        if ((raw = malloc((size_t)raw_size)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        for (k = 0, len = 0; k < nreqs; len += reqs[k].length, k++)
+            reqs[k].buf = raw + len;
+        if (Hreadv(f, nreqs, reqs) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+
+        for (i = 0, k = 0; i < n; i++) {
+            if (ents[i].inst->vg != NULL)
+                continue;
+            if (NULL == (vg = (VGROUP *)HDmarena_alloc(&vf->arena, sizeof(VGROUP))))
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+            vg->in_arena = TRUE;
+            vg->f        = f;
+            vg->oref = refs[i];
+            vg->otag = DFTAG_VG;
+            if (FAIL == vunpackvg(vg, (uint8 *)reqs[k].buf, (intn)reqs[k].nread)) {
+                free(vg->tag);
+                free(vg->ref);
+                free(vg->vgname);
+                free(vg->vgclass);
+                free(vg->alist);
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+            }
+            ents[i].inst->vg = vg;
+            k++;
+        }
+    }
+
+    /* put the vgroups in file order and size the tree */
+    if (n > 0)
+        qsort(ents, (size_t)n, sizeof(vgtree_ent_t), VIvgtree_compare);
+    for (i = 0; i < n; i++)
+        node_of[ents[i].rank] = i;
+    for (i = 0; i < n; i++) {
+        vg = ents[i].inst->vg;
+        nentries += (int32)vg->nvelt;
+        for (k = 0; k < (int32)vg->nvelt; k++)
+            if (vg->tag[k] == DFTAG_VG && VIvgtree_node(refs, node_of, n, vg->ref[k]) >= 0)
+                nchildren++;
+        nchars += (vg->vgname != NULL ? (int32)strlen(vg->vgname) : 0) + 1;
+        nchars += (vg->vgclass != NULL ? (int32)strlen(vg->vgclass) : 0) + 1;
+    }
+    size = sizeof(hdf_vgtree_t) + (size_t)n * sizeof(hdf_vgnode_t) + (size_t)nchildren * sizeof(int32) +
+           (size_t)nentries * 2 * sizeof(uint16) + (size_t)nchars;
+    if ((out = malloc(size)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    /* lay out the nodes, then the children, the entries and the strings */
+    out->nnodes = n;
+    out->nodes  = (hdf_vgnode_t *)(out + 1);
+    children    = (int32 *)(out->nodes + n);
+    etags       = (uint16 *)(children + nchildren);
+    erefs       = etags + nentries;
+    names       = (char *)(erefs + nentries);
+    for (i = 0; i < n; i++)
+        out->nodes[i].nparents = 0;
+    for (i = 0; i < n; i++) {
+        vg   = ents[i].inst->vg;
+        node = &out->nodes[i];
+
+        node->ref      = (uint16)ents[i].inst->ref;
+        node->nentries = (int32)vg->nvelt;
+        node->tags     = etags;
+        node->refs     = erefs;
+        if (vg->nvelt > 0) {
+            memcpy(etags, vg->tag, (size_t)vg->nvelt * sizeof(uint16));
+            memcpy(erefs, vg->ref, (size_t)vg->nvelt * sizeof(uint16));
+        }
+        etags += vg->nvelt;
+        erefs += vg->nvelt;
+
+        node->nchildren = 0;
+        node->children  = children;
+        for (k = 0; k < (int32)vg->nvelt; k++) {
+            int32 child;
+
+            if (vg->tag[k] == DFTAG_VG && (child = VIvgtree_node(refs, node_of, n, vg->ref[k])) >= 0) {
+                node->children[node->nchildren++] = child;
+                out->nodes[child].nparents++;
+            }
+        }
+        children += node->nchildren;
+
+        node->name = names;
+        strcpy(names, vg->vgname != NULL ? vg->vgname : "");
+        names += strlen(names) + 1;
+        node->vclass = names;
+        strcpy(names, vg->vgclass != NULL ? vg->vgclass : "");
+        names += strlen(names) + 1;
+    }
+
+    *tree = out;
+
+done:
+    free(ents);
+    free(refs);
+    free(node_of);
+    free(reqs);
+    free(raw);
+
+    return ret_value;
+} /* Vgettree */
+
+/*******************************************************************************
+NAME
+    Vfreetree -- Free a vgroup hierarchy returned by Vgettree
+RETURNS
+    SUCCEED
+*******************************************************************************/
+intn
+Vfreetree(hdf_vgtree_t *tree /* IN: the vgroup hierarchy */)
+{
+    free(tree);
+    return SUCCEED;
+} /* Vfreetree */
@@ -97,6 +97,7 @@ VSIget_vdata_node(void)
     if (vdata_free_list != NULL) {
         ret_value       = vdata_free_list;
         vdata_free_list = vdata_free_list->next;
+        HDmem_release(HDF_MEM_FREE_LISTS, sizeof(VDATA));
     }
     else /* allocate a new node */
     {
@@ -128,6 +129,7 @@ VSIrelease_vdata_node(VDATA *vs /* IN: vdata to release */)
     /* Insert the atom at the beginning of the free list */
     vs->next        = vdata_free_list;
     vdata_free_list = vs;
+    HDmem_acquire(HDF_MEM_FREE_LISTS, sizeof(VDATA));
 
 } /* end VSIrelease_vdata_node() */
 
@@ -153,6 +155,7 @@ VSIget_vsinstance_node(void)
     if (vsinstance_free_list != NULL) {
         ret_value            = vsinstance_free_list;
         vsinstance_free_list = vsinstance_free_list->next;
+        HDmem_release(HDF_MEM_FREE_LISTS, sizeof(vsinstance_t));
     }
     else /* allocate a new vsinstance record */
     {
@@ -184,6 +187,7 @@ VSIrelease_vsinstance_node(vsinstance_t *vs /* IN: vinstance node to release */)
     /* Insert the atom at the beginning of the free list */
     vs->next             = vsinstance_free_list;
     vsinstance_free_list = vs;
+    HDmem_acquire(HDF_MEM_FREE_LISTS, sizeof(vsinstance_t));
 
 } /* end VSIrelease_vsinstance_node() */
 
@@ -214,6 +218,7 @@ VSPhshutdown(void)
             vdata_free_list = vdata_free_list->next;
             v->next         = NULL;
             free(v);
+            HDmem_release(HDF_MEM_FREE_LISTS, sizeof(VDATA));
         }
     }
 
@@ -224,15 +229,12 @@ VSPhshutdown(void)
             vsinstance_free_list = vsinstance_free_list->next;
             vs->next             = NULL;
             free(vs);
+            HDmem_release(HDF_MEM_FREE_LISTS, sizeof(vsinstance_t));
         }
     }
 
     /* free buffer */
-    if (Vhbuf != NULL) {
-        free(Vhbuf);
-        Vhbuf     = NULL;
-        Vhbufsize = 0;
-    }
+    HDscratch_resize(&Vhbuf, &Vhbufsize, 0);
 
     /* free the parsing buffer */
     ret_value = VPparse_shutdown();
@@ -246,7 +248,8 @@ NAME
 
 DESCRIPTION
   Looks thru vstab for vsid and return the addr of the vdata instance
-  where vsid is found.
+  where vsid is found.  The header of the vdata is read from the file
+  the first time it is looked up.
 
 RETURNS
   RETURNS NULL if error or not found.
@@ -277,6 +280,10 @@ vsinst(HFILEID f, /* IN: File handle */
     /* return the actual vsinstance_t ptr */
     ret_value = ((vsinstance_t *)*t);
 
+    /* read the header of a vdata not looked at since the file was opened */
+    if (ret_value->vs == NULL && (ret_value->vs = VSPgetinfo(f, vsid)) == NULL)
+        HGOTO_ERROR(DFE_INTERNAL, NULL);
+
 done:
     return ret_value;
 } /* vsinst */
@@ -665,11 +672,16 @@ vsdestroynode(void *n /* IN: Node in TBBT-tree */)
 
             free(vs->alist);
 
-            VSIrelease_vdata_node(vs);
+            VSIiter_free(vs);
+            VSIfields_free(vs);
+
+            if (!vs->in_arena)
+                VSIrelease_vdata_node(vs);
         }
 
         /* release this instance to the free list ? */
-        VSIrelease_vsinstance_node((vsinstance_t *)n);
+        if (!((vsinstance_t *)n)->in_arena)
+            VSIrelease_vsinstance_node((vsinstance_t *)n);
     }
 
 } /* vsdestroynode */
@@ -691,29 +703,28 @@ VDATA *
 VSPgetinfo(HFILEID f, /* IN: file handle */
            uint16  ref /* IN: ref of the Vdata */)
 {
-    VDATA *vs = NULL;        /* new vdata to be returned */
-                             /* int32       vh_length;   int32 is mismatches Vhbuf's type -- uint32 */
-    size_t vh_length;        /* length of the vdata header */
-    VDATA *ret_value = NULL; /* FAIL */
+    VDATA   *vs = NULL;        /* new vdata to be returned */
+    vfile_t *vf = NULL;        /* Vxxx file record */
+                               /* int32       vh_length;   int32 is mismatches Vhbuf's type -- uint32 */
+    size_t   vh_length;        /* length of the vdata header */
+    VDATA   *ret_value = NULL; /* FAIL */
 
     /* clear error stack */
     HEclear();
 
-    /* get a free Vdata node? */
-    if ((vs = VSIget_vdata_node()) == NULL)
+    /* get a Vdata node from the arena of the file */
+    if ((vf = Get_vfile(f)) == NULL)
+        HGOTO_ERROR(DFE_FNF, NULL);
+    if ((vs = (VDATA *)HDmarena_alloc(&vf->arena, sizeof(VDATA))) == NULL)
         HGOTO_ERROR(DFE_NOSPACE, NULL);
+    vs->in_arena = TRUE;
 
     /* need to fetch length of vdata from file */
     if ((vh_length = Hlength(f, DFTAG_VH, ref)) == FAIL)
         HGOTO_ERROR(DFE_BADLEN, NULL);
 
     if (vh_length > Vhbufsize) {
-        Vhbufsize = vh_length;
-
-        if (Vhbuf != NULL)
-            free(Vhbuf);
-
-        if ((Vhbuf = (uint8 *)malloc(Vhbufsize)) == NULL)
+        if (HDscratch_resize(&Vhbuf, &Vhbufsize, vh_length) == FAIL)
             HGOTO_ERROR(DFE_NOSPACE, NULL);
     }
 
@@ -864,6 +875,10 @@ VSattach(HFILEID     f,    /* IN: file handle */
         /* insert the vs instance in B-tree */
         tbbtdins(vf->vstree, w, NULL);
 
+        /* the new vdata has an empty name and class */
+        VIfind_reset(vf, VFIND_VSNAME);
+        VIfind_reset(vf, VFIND_VSCLASS);
+
         vs->instance = w;
     }      /* end of case where vsid is -1 */
     else { /*  --------  VSID IS NON_NEGATIVE -------------
@@ -1003,6 +1018,7 @@ VSdetach(int32 vkey /* IN: vdata key? */)
     /* --- case where access was 'r' --- */
     if (vs->access == 'r') {
         if (w->nattach == 0) { /* end access to vdata */
+            VSIiter_free(vs);
             if (Hendaccess(vs->aid) == FAIL)
                 HGOTO_ERROR(DFE_INTERNAL, FAIL);
             vs->aid = FAIL;
@@ -1021,16 +1037,17 @@ VSdetach(int32 vkey /* IN: vdata key? */)
         if (w->nattach != 0)
             HGOTO_ERROR(DFE_CANTDETACH, FAIL);
 
+        /* bring the indexes of its fields up to date with the records written */
+        if (vs->idx_stale && VSIindex_update(vkey) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
         if (vs->marked) { /* if marked , write out vdata's VSDESC to file */
             size_t need;
 
             need = sizeof(VWRITELIST) + (size_t)vs->nattrs * sizeof(vs_attr_t) + sizeof(VDATA) + 1;
 
             if (need > Vhbufsize) {
-                Vhbufsize = need;
-                free(Vhbuf);
-
-                if ((Vhbuf = malloc(Vhbufsize)) == NULL)
+                if (HDscratch_resize(&Vhbuf, &Vhbufsize, need) == FAIL)
                     HGOTO_ERROR(DFE_NOSPACE, FAIL);
             }
 
@@ -1076,6 +1093,7 @@ VSdetach(int32 vkey /* IN: vdata key? */)
         vs->usym  = NULL;
 
         /* end access to vdata */
+        VSIiter_free(vs);
         if (Hendaccess(vs->aid) == FAIL)
             HGOTO_ERROR(DFE_INTERNAL, FAIL);
         vs->aid = FAIL;
@@ -1414,6 +1432,8 @@ VSdelete(int32 f, /* IN: file handle */
     /* destroy vdata node itself*/
     if (v != NULL)
         vsdestroynode(v);
+    VIfind_reset(vf, VFIND_VSNAME);
+    VIfind_reset(vf, VFIND_VSCLASS);
 
     /* delete vdata header and data from file */
     if (Hdeldd(f, DFTAG_VS, (uint16)vsid) == FAIL)
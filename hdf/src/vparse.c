@@ -68,9 +68,7 @@ scanattrs(const char *attrs, int32 *attrc, char ***attrv)
     size_t slen = strlen(attrs) + 1;
 
     if (slen > Vpbufsize) {
-        Vpbufsize = slen;
-        free(Vpbuf);
-        if ((Vpbuf = (uint8 *)malloc(Vpbufsize)) == NULL)
+        if (HDscratch_resize(&Vpbuf, &Vpbufsize, slen) == FAIL)
             HRETURN_ERROR(DFE_NOSPACE, FAIL);
     } /* end if */
 
@@ -153,11 +151,7 @@ scanattrs(const char *attrs, int32 *attrc, char ***attrv)
 intn
 VPparse_shutdown(void)
 {
-    if (Vpbuf != NULL) {
-        free(Vpbuf);
-        Vpbuf     = NULL;
-        Vpbufsize = 0;
-    }
+    HDscratch_resize(&Vpbuf, &Vpbufsize, 0);
 
     return SUCCEED;
 } /* end VSPhshutdown() */
@@ -20,14 +20,35 @@
 
 LOCAL ROUTINES
  VSPshutdown  --  Free the Vtbuf buffer.
+ VSIreadcolumns -- Reads fields of a vdata into one array per field.
+ VSIiter_hint   -- Announces the data of the next batch of a scan.
+ VSIiter_free   -- Frees the batch scan state of a vdata.
+ VSIquery_values -- Converts the values of a field for VSquery.
+ VSIquery_bound  -- Finds where a value is in a sorted field.
+ VSIindex_compare -- Orders the keys of an index.
+ VSIindex_build   -- Writes the index of a field of a vdata.
+ VSIindex_find    -- Finds the records of a range of values with an index.
+
+LIBRARY PRIVATE ROUTINES
+ VSIindex_update  -- Builds again the indexes of a vdata written to.
 
 EXPORTED ROUTINES
  VSseek  -- Seeks to an element boundary within a vdata i.e. 2nd element.
  VSread  -- Reads a specified number of elements' worth of data from a vdata.
              Data will be returned to you interlaced in the way you specified.
+ VSreadcolumns -- Reads the fields set by VSsetfields into one array each.
+ VSreadfield   -- Reads one field of a vdata into an array.
+ VSiter_begin  -- Sets up a scan of a vdata in batches of records.
+ VSiter_next   -- Reads the next batch of records of a scan.
+ VSiter_end    -- Ends a scan of a vdata.
+ VSquery       -- Finds the records of a vdata that meet conditions on fields.
+ VScreateindex -- Builds an index of a field of a vdata.
+ VSlookup      -- Finds the records holding a value of an indexed field.
+ VSrange       -- Finds the records holding a range of values of an indexed field.
  VSwrite -- Writes a specified number of elements' worth of data to a vdata.
              You must specify how your data in your buffer is interlaced.
              Creates an aid, and writes it out if this is the first time.
+ VSwritecolumns -- Writes the fields set by VSsetfields from one array each.
 
  NOTE: Another pass needs to made through this file to update some of
        the comments about certain sections of the code. -GV 9/8/97
@@ -36,14 +57,51 @@ EXPORTED ROUTINES
 
 #define VSET_INTERFACE
 #include "hdf.h"
+#include "hfile.h"
+
+#include <math.h>
 
 #ifndef MIN
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #endif /* MIN */
 
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif /* MAX */
+
+/* number of records VSquery() reads and evaluates at a time */
+#define VS_QUERY_BATCH 4096
+
+/* name (partial), fields and record size of the index vdata of a field,
+   see VScreateindex() */
+#define VS_INDEX_NAME    "_HDF_VS_IDX_"
+#define VS_INDEX_KEY     "key"
+#define VS_INDEX_RECORD  "record"
+#define VS_INDEX_FIELDS  "key,record"
+#define VS_INDEX_RECSIZE (sizeof(float64) + sizeof(int32))
+
 static uint32 Vtbufsize = 0;
 static uint8 *Vtbuf     = NULL;
 
+/* State of a scan of a vdata in batches, see VSiter_begin() */
+typedef struct vs_iter_struct {
+    int32  batch;     /* # of records in a batch */
+    int32  interlace; /* interlace of the records in the user's buffer */
+    int32  nblocks;   /* # of data blocks in 'offsets', 0 if not known */
+    int32 *offsets;   /* file offsets of the data blocks of the vdata */
+    int32 *lengths;   /* lengths of the data blocks of the vdata */
+} vs_iter_t;
+
+/* A value of an indexed field and the record it is in, see VScreateindex() */
+typedef struct vs_idxkey_struct {
+    float64 key; /* the value */
+    int32   rec; /* index of the record */
+} vs_idxkey_t;
+
+static int32 VSIreadcolumns(int32 vkey, intn nfields, const int32 findex[], uint8 *bufs[], int32 nelt);
+
+static void VSIiter_hint(VDATA *vs, vs_iter_t *iter, int32 first);
+
 /*******************************************************************************
  NAME
     VSPshutdown  --  Free the Vtbuf buffer.
@@ -63,11 +121,7 @@ VSPshutdown(void)
     intn ret_value = SUCCEED;
 
     /* free global buffers */
-    if (Vtbuf != NULL) {
-        free(Vtbuf);
-        Vtbuf     = NULL;
-        Vtbufsize = 0;
-    }
+    HDscratch_resize(&Vtbuf, &Vtbufsize, 0);
 
     /* Clear the local buffers in vio.c */
     ret_value = VSPhshutdown();
@@ -262,9 +316,7 @@ VSread(int32 vkey,  /* IN: vdata key */
             chunk = buf_size / hsize + 1;
 
             /* get a buffer big enough to hold the values */
-            Vtbufsize = (size_t)chunk * (size_t)hsize;
-            free(Vtbuf);
-            if ((Vtbuf = (uint8 *)malloc(Vtbufsize)) == NULL)
+            if (HDscratch_resize(&Vtbuf, &Vtbufsize, (size_t)chunk * (size_t)hsize) == FAIL)
                 HGOTO_ERROR(DFE_NOSPACE, FAIL);
         }
 
@@ -333,9 +385,7 @@ VSread(int32 vkey,  /* IN: vdata key */
 
         /* alloc space (Vtbuf) for reading in the raw data from vdata */
         if (Vtbufsize < (size_t)nelt * (size_t)hsize) {
-            Vtbufsize = (size_t)nelt * (size_t)hsize;
-            free(Vtbuf);
-            if ((Vtbuf = (uint8 *)malloc(Vtbufsize)) == NULL)
+            if (HDscratch_resize(&Vtbuf, &Vtbufsize, (size_t)nelt * (size_t)hsize) == FAIL)
                 HGOTO_ERROR(DFE_NOSPACE, FAIL);
         }
 
@@ -426,53 +476,51 @@ done:
 
 /*******************************************************************************
 NAME
-   VSwrite
+   VSIreadcolumns
 
 DESCRIPTION
-   Writes a specified number of elements' worth of data to a vdata.
-   You must specify how your data in your buffer is interlaced.
+   Reads a specified number of elements' worth of data from a vdata, each
+   field into its own array of 'nelt' values.  The fields are the ones set
+   with VSsetfields, with bufs[j] receiving the j-th of them, or the
+   'nfields' fields findex[] if 'findex' is not NULL.
 
-   NEW
-   create an aid, and write out if this is the first time.
-   (otherwise) subsequent writes result in link-blocks.
+   Each field is converted with one strided call when its values are
+   evenly spaced in the vdata, copied a record at a time when its number
+   type needs no conversion, and converted a value of its order at a time
+   otherwise.
 
 RETURNS
    RETURNS FAIL if error
-   RETURNS the number of elements written (0 or a +ve integer).
+   RETURNS the number of elements read (0 or a +ve integer).
 
 *******************************************************************************/
-int32
-VSwrite(int32       vkey,  /* IN: vdata key */
-        const uint8 buf[], /* IN: elements to write to vdata */
-        int32       nelt,  /* IN: number of elements */
-        int32       interlace /* IN: interlace of elements 'buf' */)
+static int32
+VSIreadcolumns(int32       vkey,     /* IN: vdata key */
+               intn        nfields,  /* IN: number of fields in 'findex' */
+               const int32 findex[], /* IN: fields to read, NULL for the read list */
+               uint8      *bufs[],   /* IN/OUT: one array per field to put elements in */
+               int32       nelt /* IN: number of elements to read */)
 {
-    intn            isize = 0;
-    intn            order = 0;
-    intn            index = 0;
-    intn            esize = 0;
-    uint8          *dest  = NULL;
-    const uint8    *src, *Src;
-    int32           j;
+    intn            isize;
+    intn            esize;
+    intn            order;
+    intn            i, j, k;
+    uint8          *src;
+    uint8          *dst;
+    int32           hsize;
+    int32           stride;      /* bytes from one record of a field to the next in Vtbuf */
     int32           type;
-    int32           offset;
-    int32           position = 0;
-    int32           new_size;
-    int32           status;
-    int32           total_bytes; /* total number of bytes that need to be written out */
-    DYN_VWRITELIST *w = NULL;
-    int32           int_size;     /* size of "element" as needed by user in memory */
-    intn            hdf_size = 0; /* size of record in HDF file */
-    vsinstance_t   *wi       = NULL;
-    VDATA          *vs       = NULL;
-    int32           bytes; /* number of elements / bytes to write next time */
-    int32           chunk;
-    int32           done; /* number of records to do / done */
+    int32           total_bytes; /* total number of bytes that need to be read in */
+    int32           bytes;       /* number of bytes to read next time */
+    int32           chunk;       /* number of records in a buffer */
+    int32           done;        /* number of records done */
+    int32           nv;
+    DYN_VWRITELIST *w         = NULL;
+    DYN_VREADLIST  *r         = NULL;
+    vsinstance_t   *wi        = NULL;
+    VDATA          *vs        = NULL;
     int32           ret_value = SUCCEED;
 
-    /* clear error stack */
-    HEclear();
-
     /* check if vdata is part of vdata group */
     if (HAatom_group(vkey) != VSIDGROUP)
         HGOTO_ERROR(DFE_ARGS, FAIL);
@@ -481,190 +529,1388 @@ VSwrite(int32       vkey,  /* IN: vdata key */
     if (NULL == (wi = (vsinstance_t *)HAatom_object(vkey)))
         HGOTO_ERROR(DFE_NOVS, FAIL);
 
-    /* get vdata itself and check it. Also check number of elements */
+    /* get vdata itself and check it */
     vs = wi->vs;
-    if ((nelt <= 0) || (vs == NULL))
+    if (vs == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* check if write access to vdata */
-    if (vs->access != 'w')
-        HGOTO_ERROR(DFE_BADACC, FAIL);
+    /* check access id and number of vertices in vdata */
+    if ((vs->aid == 0) || (vs->nvertices == 0))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* check if vdata exists in the file */
-    if (FAIL == vexistvs(vs->f, vs->oref))
-        HGOTO_ERROR(DFE_NOVS, FAIL);
+    /* Don't allow reads in 0-field vdatas */
+    if (vs->wlist.n <= 0)
+        HGOTO_ERROR(DFE_BADFIELDS, FAIL);
 
-    /* get write list */
-    w = &vs->wlist;
-    if (w->n == 0) {
-        HERROR(DFE_NOVS);
-        HEreport("No fields set for writing");
-        HGOTO_DONE(FAIL);
-    }
+    /* check if vdata exists in file */
+    if (vexistvs(vs->f, vs->oref) == FAIL)
+        HGOTO_ERROR(DFE_NOVS, FAIL);
 
-    /* check interlace of input buffer */
-    if (interlace != NO_INTERLACE && interlace != FULL_INTERLACE)
+    if (bufs == NULL || nelt < 0)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    hdf_size    = (intn)w->ivsize; /* as stored in HDF file */
-    total_bytes = hdf_size * nelt;
+    /* read/write lists */
+    w           = &(vs->wlist);
+    r           = &(vs->rlist);
+    nfields     = (findex == NULL) ? r->n : nfields;
+    hsize       = (int32)w->ivsize; /* size as stored in HDF */
+    total_bytes = hsize * nelt;
 
-    /* make sure we have a valid AID */
-    if (vs->aid == 0) {
-        HGOTO_ERROR(DFE_BADAID, FAIL);
-    }
+    for (j = 0; j < nfields; j++)
+        if (bufs[j] == NULL)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
 
     /*
-     * promote to link-block if vdata exists and is not already one
-     *  AND we are increasing its size
+     * A full interlaced vdata is read through a buffer of at most
+     * VDATA_BUFFER_MAX bytes, the fields of a no interlaced one are
+     * stored one after the other so all elements are read at once.
      */
-    HQueryposition(vs->aid, &position);
-    new_size = (position / (intn)vs->wlist.ivsize) + nelt;
+    if (vs->interlace == FULL_INTERLACE && (uint32)total_bytes >= Vtbufsize) {
+        /* make sure there is at least room for one record in our buffer */
+        chunk = MIN(total_bytes, VDATA_BUFFER_MAX) / hsize + 1;
 
-    /* this should really be cached in the Vdata structure */
-    for (int_size = 0, j = 0; j < w->n; j++)
-        int_size += w->esize[j];
+        if (HDscratch_resize(&Vtbuf, &Vtbufsize, (size_t)chunk * (size_t)hsize) == FAIL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    }
+    else {
+        chunk = nelt;
+        if (Vtbufsize < (size_t)nelt * (size_t)hsize) {
+            if (HDscratch_resize(&Vtbuf, &Vtbufsize, (size_t)nelt * (size_t)hsize) == FAIL)
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        }
+    }
 
-    /*
-       First, convert and repack field(s) from Vtbuf into buf.
+    for (done = 0; done < nelt; done += chunk) {
+        if (nelt - done < chunk)
+            chunk = nelt - done;
+        bytes = hsize * chunk;
 
-       This section of the code deals with interlacing. In all cases
-       the items for each of the fields are converted and shuffled
-       around from the user's buffer "buf" to the internal's buffer
-       "Vtbuf".  The data in "Vtbuf" is then written out to the vdata.
+        if ((nv = Hread(vs->aid, bytes, (uint8 *)Vtbuf)) != bytes) {
+            HERROR(DFE_READERROR);
+            HEreport("Tried to read %d, only read %d", bytes, nv);
+            HGOTO_DONE(FAIL);
+        }
 
-       There are 5 cases :
-       (A) user=NO_INTERLACE   & vdata=FULL_INTERLACE)
-       (B) user=NO_INTERLACE   & vdata=NO_INTERLACE)
-       (C) user=FULL_INTERLACE & vdata=FULL_INTERLACE)
-       (D) user=FULL_INTERLACE & vadat=NO_INTERLACE)
-       (E) SPECIAL CASE when only one field.
+        for (j = 0; j < nfields; j++) {
+            i     = (findex == NULL) ? r->item[j] : (intn)findex[j];
+            type  = (int32)w->type[i];
+            isize = (intn)w->isize[i];
+            esize = (intn)w->esize[i];
+            order = (intn)w->order[i];
+            dst   = bufs[j] + (size_t)done * (size_t)esize;
+            if (vs->interlace == FULL_INTERLACE) {
+                src    = Vtbuf + (size_t)w->off[i];
+                stride = hsize;
+            }
+            else {
+                src    = Vtbuf + (size_t)w->off[i] * (size_t)nelt;
+                stride = isize;
+            }
 
-       Cases (A)-(D) handles multiple fields
-       Case (E) handles single field Vdatas
+            if (stride == isize) /* the field is contiguous */
+                DFKconvert(src, dst, type, order * chunk, DFACC_READ, 0, 0);
+            else if (order == 1)
+                DFKconvert(src, dst, type, chunk, DFACC_READ, stride, esize);
+            else if (isize == esize && DFKiscopyNT(type))
+                for (k = 0; k < chunk; k++)
+                    memcpy(dst + (size_t)k * (size_t)esize, src + (size_t)k * (size_t)stride, (size_t)isize);
+            else
+                for (k = 0; k < order; k++)
+                    DFKconvert(src + k * (isize / order), dst + k * (esize / order), type, chunk, DFACC_READ,
+                               stride, esize);
+        }
+    }
 
-       Cases (E) and (C) are the most frequently used.  Limit buffer
-       allocations to VDATA_BUFFER_MAX size so that we conserve
-       memory.  Doing this involves a certain degree of added code
-       complexity so don't bother doing it for the less frequent
-       cases.  Cases E and C have been rolled together since they are
-       very similar and both need the incremental writing.
+    ret_value = nelt;
 
-       --------------------------------------------------------------------- */
-    /* CASE  (E + C): Easy to unroll case */
-    if ((w->n == 1) || (interlace == FULL_INTERLACE && vs->interlace == FULL_INTERLACE)) {
+done:
+    return ret_value;
+} /* VSIreadcolumns */
 
-        /*
-         * figure out how many elements we can move at a time and
-         * make sure our buffer is big enough
-         */
+/*******************************************************************************
+NAME
+   VSreadcolumns
 
-        if ((uint32)total_bytes < Vtbufsize) {
-            chunk = nelt;
-        }
-        else {
-            int32 buf_size;
+DESCRIPTION
+   Reads a specified number of elements' worth of data from a vdata into
+   one array per field: bufs[j] receives 'nelt' contiguous values of the
+   j-th field set with VSsetfields, converted to the native format.  This
+   is the same as reading with VSread in NO_INTERLACE mode, but does not
+   need the fields to be laid out in one buffer and reads a full interlaced
+   vdata a buffer at a time.
 
-            /* we are bounded above by VDATA_BUFFER_MAX */
-            buf_size = MIN(total_bytes, VDATA_BUFFER_MAX);
+RETURNS
+   RETURNS FAIL if error
+   RETURNS the number of elements read (0 or a +ve integer).
 
-            /* make sure there is at least room for one record in our buffer */
-            chunk = buf_size / hdf_size + 1;
+*******************************************************************************/
+int32
+VSreadcolumns(int32  vkey,   /* IN: vdata key */
+              uint8 *bufs[], /* IN/OUT: one array per field to put elements in */
+              int32  nelt /* IN: number of elements to read */)
+{
+    int32 ret_value;
 
-            /* get a buffer big enough to hold the values */
-            Vtbufsize = (size_t)chunk * (size_t)hdf_size;
-            free(Vtbuf);
-            if ((Vtbuf = (uint8 *)malloc(Vtbufsize)) == NULL)
-                HGOTO_ERROR(DFE_NOSPACE, FAIL);
-        }
+    /* clear error stack */
+    HEclear();
 
-        done = 0;
+    ret_value = VSIreadcolumns(vkey, 0, NULL, bufs, nelt);
 
-        /* set loop invariant parameters */
-        Src   = buf;
-        dest  = Vtbuf;
-        bytes = hdf_size * chunk;
+    return ret_value;
+} /* VSreadcolumns */
 
-        while (done < nelt) {
+/*******************************************************************************
+NAME
+   VSreadfield
 
-            /* chunk has changed so update the byte counts */
-            if (nelt - done < chunk) {
-                chunk = nelt - done;
-                bytes = hdf_size * chunk;
-            }
-            /*
-               printf("Case E/C: [%d,%d] writing %d (elems) %d bytes\n", done, nelt, chunk, bytes);
-             */
+DESCRIPTION
+   Reads a specified number of elements' worth of one field of a vdata
+   into 'buf' as 'nelt' contiguous values converted to the native format,
+   whatever fields were set with VSsetfields.
 
-            offset = 0;
-            for (j = 0; j < w->n; j++) {
-                src   = Src + offset;
-                dest  = Vtbuf + (size_t)w->off[j];
-                type  = (int32)w->type[j];
-                esize = (intn)w->esize[j];
-                isize = (intn)w->isize[j];
-                order = (intn)w->order[j];
+RETURNS
+   RETURNS FAIL if error
+   RETURNS the number of elements read (0 or a +ve integer).
 
-                for (index = 0; index < order; index++) {
-                    DFKconvert((void *)src, dest, type, (uint32)chunk, DFACC_WRITE, (uint32)int_size,
-                               (uint32)hdf_size);
-                    dest += isize / order;
-                    src += esize / order;
-                }
-                offset += esize;
-            }
+*******************************************************************************/
+int32
+VSreadfield(int32       vkey,      /* IN: vdata key */
+            const char *fieldname, /* IN: name of the field to read */
+            uint8       buf[],     /* IN/OUT: space to put elements in */
+            int32       nelt /* IN: number of elements to read */)
+{
+    int32 findex;
+    int32 ret_value = SUCCEED;
 
-            /* write the converted data to the file */
-            status = Hwrite(vs->aid, bytes, (uint8 *)Vtbuf);
-            if (status != bytes)
-                HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    /* clear error stack */
+    HEclear();
 
-            /* record what we've done and move to next group */
-            done += chunk;
-            Src += chunk * int_size;
-        }
+    if (fieldname == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    } /* case (C + E) */
+    /* find the field, this also checks the vdata key */
+    if (VSfindex(vkey, fieldname, &findex) == FAIL)
+        HGOTO_ERROR(DFE_BADFIELDS, FAIL);
 
-    else {
+    ret_value = VSIreadcolumns(vkey, 1, &findex, &buf, nelt);
 
-        /*
-         * Handle the other cases now.
-         * These cases are less frequent so don't bother unrolling
-         *   the loops for now.  As a result, we may get into memory
-         *   problems since we may end up allocating a huge buffer
-         */
+done:
+    return ret_value;
+} /* VSreadfield */
 
-        /* alloc space (Vtbuf) for writing out the data */
-        if (Vtbufsize < (uint32)total_bytes) {
-            Vtbufsize = (uint32)total_bytes;
-            free(Vtbuf);
-            if ((Vtbuf = (uint8 *)malloc(Vtbufsize)) == NULL)
-                HGOTO_ERROR(DFE_NOSPACE, FAIL);
-        }
+/*******************************************************************************
+NAME
+   VSIiter_hint
 
-        /* ----------------------------------------------------------------- */
-        /* CASE  (A):  user=none, vdata=full */
-        if (interlace == NO_INTERLACE && vs->interlace == FULL_INTERLACE) {
+DESCRIPTION
+   Tells the system that the data blocks of the batch of records starting
+   at record 'first' will be read soon, so that they are read from disk
+   while the application works on the current batch.
 
-            src = buf;
-            for (j = 0; j < w->n; j++) {
-                dest  = Vtbuf + (size_t)w->off[j];
-                type  = (int32)w->type[j];
-                esize = (intn)w->esize[j];
-                isize = (intn)w->isize[j];
-                order = (intn)w->order[j];
+RETURNS
+   Nothing
 
-                for (index = 0; index < order; index++) {
-                    DFKconvert((void *)src, dest, type, (uint32)nelt, DFACC_WRITE, (uint32)esize,
-                               (uint32)hdf_size);
-                    src += esize / order;
-                    dest += isize / order;
-                }
-                src += ((nelt - 1) * esize);
-            }
+*******************************************************************************/
+static void
+VSIiter_hint(VDATA     *vs,   /* IN: vdata being scanned */
+             vs_iter_t *iter, /* IN: its scan state */
+             int32      first /* IN: first record of the next batch */)
+{
+    filerec_t *file_rec;
+    int32      hsize;
+    int32      start, end;  /* element bytes of the batch */
+    int32      blk_start;   /* element offset of the current block */
+    int32      lo, hi;      /* part of the batch in the current block */
+    int32      i;
+
+    if (iter->nblocks == 0 || first >= vs->nvertices)
+        return;
+    if ((file_rec = HAatom_object(vs->f)) == NULL)
+        return;
+
+    hsize = (int32)vs->wlist.ivsize;
+    start = first * hsize;
+    end   = MIN(first + iter->batch, vs->nvertices) * hsize;
+
+    for (i = 0, blk_start = 0; i < iter->nblocks && blk_start < end; blk_start += iter->lengths[i++]) {
+        lo = MAX(start, blk_start);
+        hi = MIN(end, blk_start + iter->lengths[i]);
+        if (lo < hi)
+            HPwillneed(file_rec, iter->offsets[i] + (lo - blk_start), hi - lo);
+    }
+} /* VSIiter_hint */
 
-        } /* case (a) */
+/*******************************************************************************
+NAME
+   VSIiter_free
+
+DESCRIPTION
+   Frees the batch scan state of a vdata, if it has one.  Called by
+   VSiter_end() and when the vdata is detached.
+
+RETURNS
+   Nothing
+
+*******************************************************************************/
+void
+VSIiter_free(VDATA *vs /* IN: vdata */)
+{
+    if (vs->iter != NULL) {
+        free(vs->iter->offsets);
+        free(vs->iter->lengths);
+        free(vs->iter);
+        vs->iter = NULL;
+    }
+} /* VSIiter_free */
+
+/*******************************************************************************
+NAME
+   VSiter_begin
+
+DESCRIPTION
+   Sets up a scan of a vdata in batches of 'batch' records, from the
+   current position to the end.  Each VSiter_next() call then reads the
+   next batch of the fields set with VSsetfields into the user's buffer
+   with the given interlace, as VSread() would.
+
+   The scan knows where the data blocks of the vdata are in the file.
+   After reading a batch it asks the system to start reading the blocks of
+   the next one, so that the disk works while the application processes
+   the current batch.  Compressed and external vdatas are read the same
+   way but without the hints.
+
+   A vdata has a single scan; calling VSiter_begin() again restarts it
+   with the new parameters.  The scan ends with VSiter_end() or when the
+   vdata is detached.
+
+RETURNS
+   RETURNS SUCCEED/FAIL
+
+*******************************************************************************/
+intn
+VSiter_begin(int32 vkey,  /* IN: vdata key */
+             int32 batch, /* IN: number of records in a batch */
+             int32 interlace /* IN: interlace to return records in */)
+{
+    vsinstance_t *wi         = NULL;
+    VDATA        *vs         = NULL;
+    accrec_t     *access_rec = NULL;
+    vs_iter_t    *iter       = NULL;
+    int32         pos;
+    intn          n;
+    intn          ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* check if vdata is part of vdata group */
+    if (HAatom_group(vkey) != VSIDGROUP)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get vdata instance */
+    if (NULL == (wi = (vsinstance_t *)HAatom_object(vkey)))
+        HGOTO_ERROR(DFE_NOVS, FAIL);
+
+    /* get vdata itself and check it */
+    vs = wi->vs;
+    if (vs == NULL || vs->aid == 0 || vs->aid == FAIL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (batch <= 0 || (interlace != FULL_INTERLACE && interlace != NO_INTERLACE))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (NULL == (iter = (vs_iter_t *)calloc(1, sizeof(vs_iter_t))))
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    iter->batch     = batch;
+    iter->interlace = interlace;
+
+    /* Find the data blocks of vdatas stored as is, the hints are only
+       an optimization so failing to get them is not an error */
+    if (vs->nvertices > 0 && (access_rec = HAatom_object(vs->aid)) != NULL &&
+        (access_rec->special == 0 || access_rec->special == SPECIAL_LINKED) &&
+        (n = VSgetdatainfo(vkey, 0, 0, NULL, NULL)) > 0) {
+        iter->offsets = (int32 *)malloc((size_t)n * sizeof(int32));
+        iter->lengths = (int32 *)malloc((size_t)n * sizeof(int32));
+        if (iter->offsets != NULL && iter->lengths != NULL &&
+            VSgetdatainfo(vkey, 0, (uintn)n, iter->offsets, iter->lengths) == n)
+            iter->nblocks = n;
+        HEclear();
+    }
+
+    VSIiter_free(vs);
+    vs->iter = iter;
+
+    /* start reading the first batch */
+    if ((pos = Htell(vs->aid)) != FAIL)
+        VSIiter_hint(vs, iter, pos / (int32)vs->wlist.ivsize);
+
+done:
+    if (ret_value == FAIL && iter != NULL) {
+        free(iter->offsets);
+        free(iter->lengths);
+        free(iter);
+    }
+
+    return ret_value;
+} /* VSiter_begin */
+
+/*******************************************************************************
+NAME
+   VSiter_next
+
+DESCRIPTION
+   Reads the next batch of records of the scan set up with VSiter_begin()
+   into 'buf', which must have room for a whole batch.  The last batch may
+   be short.
+
+RETURNS
+   RETURNS FAIL if error
+   RETURNS the number of records read, 0 at the end of the vdata.
+
+*******************************************************************************/
+int32
+VSiter_next(int32 vkey, /* IN: vdata key */
+            uint8 buf[] /* OUT: space for a batch of records */)
+{
+    vsinstance_t *wi = NULL;
+    VDATA        *vs = NULL;
+    vs_iter_t    *iter;
+    int32         pos;
+    int32         nrecs;
+    int32         ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* check if vdata is part of vdata group */
+    if (HAatom_group(vkey) != VSIDGROUP)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get vdata instance */
+    if (NULL == (wi = (vsinstance_t *)HAatom_object(vkey)))
+        HGOTO_ERROR(DFE_NOVS, FAIL);
+
+    /* get vdata itself and its scan */
+    vs = wi->vs;
+    if (vs == NULL || (iter = vs->iter) == NULL || buf == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* records left from the current position */
+    if ((pos = Htell(vs->aid)) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    pos /= (int32)vs->wlist.ivsize;
+    nrecs = MIN(iter->batch, vs->nvertices - pos);
+    if (nrecs <= 0)
+        HGOTO_DONE(0);
+
+    if (VSread(vkey, buf, nrecs, iter->interlace) == FAIL)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
+
+    /* have the next batch read while this one is worked on */
+    VSIiter_hint(vs, iter, pos + nrecs);
+
+    ret_value = nrecs;
+
+done:
+    return ret_value;
+} /* VSiter_next */
+
+/*******************************************************************************
+NAME
+   VSiter_end
+
+DESCRIPTION
+   Ends the scan of a vdata set up with VSiter_begin().  The position in
+   the vdata stays where the scan left it.
+
+RETURNS
+   RETURNS SUCCEED/FAIL
+
+*******************************************************************************/
+intn
+VSiter_end(int32 vkey /* IN: vdata key */)
+{
+    vsinstance_t *wi        = NULL;
+    VDATA        *vs        = NULL;
+    intn          ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* check if vdata is part of vdata group */
+    if (HAatom_group(vkey) != VSIDGROUP)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get vdata instance */
+    if (NULL == (wi = (vsinstance_t *)HAatom_object(vkey)))
+        HGOTO_ERROR(DFE_NOVS, FAIL);
+
+    /* get vdata itself and check it has a scan */
+    vs = wi->vs;
+    if (vs == NULL || vs->iter == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    VSIiter_free(vs);
+
+done:
+    return ret_value;
+} /* VSiter_end */
+
+/*******************************************************************************
+NAME
+   VSIquery_values
+
+DESCRIPTION
+   Converts 'n' native values of number type 'type' into float64 values
+   that the conditions of VSquery() are evaluated on.
+
+RETURNS
+   RETURNS SUCCEED/FAIL
+
+*******************************************************************************/
+static intn
+VSIquery_values(int32        type, /* IN: number type of the values */
+                const uint8 *src,  /* IN: native values */
+                int32        n,    /* IN: number of values */
+                float64     *dst /* OUT: values as float64 */)
+{
+    int32 k;
+    intn  ret_value = SUCCEED;
+
+    switch (type & ~(DFNT_NATIVE | DFNT_LITEND)) {
+        case DFNT_CHAR8:
+        case DFNT_INT8:
+            for (k = 0; k < n; k++)
+                dst[k] = (float64)((const int8 *)src)[k];
+            break;
+        case DFNT_UCHAR8:
+        case DFNT_UINT8:
+            for (k = 0; k < n; k++)
+                dst[k] = (float64)((const uint8 *)src)[k];
+            break;
+        case DFNT_INT16:
+            for (k = 0; k < n; k++)
+                dst[k] = (float64)((const int16 *)src)[k];
+            break;
+        case DFNT_UINT16:
+            for (k = 0; k < n; k++)
+                dst[k] = (float64)((const uint16 *)src)[k];
+            break;
+        case DFNT_INT32:
+            for (k = 0; k < n; k++)
+                dst[k] = (float64)((const int32 *)src)[k];
+            break;
+        case DFNT_UINT32:
+            for (k = 0; k < n; k++)
+                dst[k] = (float64)((const uint32 *)src)[k];
+            break;
+        case DFNT_FLOAT32:
+            for (k = 0; k < n; k++)
+                dst[k] = (float64)((const float32 *)src)[k];
+            break;
+        case DFNT_FLOAT64:
+            for (k = 0; k < n; k++)
+                dst[k] = ((const float64 *)src)[k];
+            break;
+        default:
+            HGOTO_ERROR(DFE_BADNUMTYPE, FAIL);
+    }
+
+done:
+    return ret_value;
+} /* VSIquery_values */
+
+/*******************************************************************************
+NAME
+   VSIquery_bound
+
+DESCRIPTION
+   Looks for the first record in [lo, hi) of a non-decreasing field whose
+   value is above 'value', or not below it if 'strict' is FALSE, reading
+   one record at each step of a binary search.  The position in the vdata
+   is left anywhere.
+
+RETURNS
+   RETURNS FAIL if error
+   RETURNS the index of the record, 'hi' if there is none.
+
+*******************************************************************************/
+static int32
+VSIquery_bound(int32   vkey,   /* IN: vdata key */
+               int32   findex, /* IN: index of the field */
+               int32   type,   /* IN: number type of the field */
+               float64 value,  /* IN: value to look for */
+               intn    strict, /* IN: TRUE to skip the records equal to 'value' */
+               int32   lo,     /* IN: first record to look at */
+               int32   hi /* IN: one past the last record to look at */)
+{
+    float64 elem[1];   /* room for one native value, aligned for any type */
+    float64 v;
+    uint8  *buf = (uint8 *)elem;
+    int32   mid;
+    int32   ret_value = SUCCEED;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (VSseek(vkey, mid) == FAIL || VSIreadcolumns(vkey, 1, &findex, &buf, 1) != 1)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        if (VSIquery_values(type, buf, 1, &v) == FAIL)
+            HGOTO_ERROR(DFE_BADNUMTYPE, FAIL);
+        if (strict ? v <= value : v < value)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    ret_value = lo;
+
+done:
+    return ret_value;
+} /* VSIquery_bound */
+
+/*******************************************************************************
+NAME
+   VSquery
+
+DESCRIPTION
+   Finds the records of a vdata that meet all of 'nconds' conditions, each
+   comparing a field of order 1 and numeric type to a value.  The indices
+   of the first 'maxrecs' matching records are stored in 'indices' in
+   increasing order; the records can then be read with VSseek/VSread.
+
+   Only the fields of the conditions are read, a batch of records at a
+   time, and each condition is evaluated over a whole batch at once.  A
+   condition whose op has VS_QUERY_SORTED set tells that its field never
+   decreases from one record to the next: the range of records that can
+   match is then found with a binary search, and the data blocks outside
+   of it are not read at all.  This is only done for full interlaced
+   vdatas, the fields of a no interlaced one being read in one go.
+
+   The position in the vdata is the same after the call as before.
+
+RETURNS
+   RETURNS FAIL if error
+   RETURNS the number of matching records, which may be more than 'maxrecs'.
+
+*******************************************************************************/
+int32
+VSquery(int32              vkey,    /* IN: vdata key */
+        intn               nconds,  /* IN: number of conditions */
+        const hdf_vscond_t conds[], /* IN: conditions the records must all meet */
+        int32              maxrecs, /* IN: room in 'indices' */
+        int32              indices[] /* OUT: indices of the matching records */)
+{
+    vsinstance_t *wi      = NULL;
+    VDATA        *vs      = NULL;
+    int32        *findex  = NULL; /* field of each condition */
+    uint8       **bufs    = NULL; /* native values of each field for a batch */
+    float64      *vals    = NULL; /* values of one field for a batch */
+    uint8        *mask    = NULL; /* whether each record of a batch matches so far */
+    int32         pos     = FAIL; /* offset to go back to */
+    int32         first   = 0;    /* first record that can match */
+    int32         last;           /* one past the last record that can match */
+    int32         batch;
+    int32         nrecs;
+    int32         rec, k;
+    int32         type;
+    int32         count   = 0;
+    float64       x;
+    intn          i;
+    int32         ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* check if vdata is part of vdata group */
+    if (HAatom_group(vkey) != VSIDGROUP)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get vdata instance */
+    if (NULL == (wi = (vsinstance_t *)HAatom_object(vkey)))
+        HGOTO_ERROR(DFE_NOVS, FAIL);
+
+    /* get vdata itself and check it */
+    vs = wi->vs;
+    if (vs == NULL || vs->aid == 0 || vs->aid == FAIL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (nconds <= 0 || conds == NULL || maxrecs < 0 || (maxrecs > 0 && indices == NULL))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (vs->nvertices == 0)
+        HGOTO_DONE(0);
+
+    /* find the fields and check they can be compared */
+    if (NULL == (findex = (int32 *)malloc((size_t)nconds * sizeof(int32))))
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    for (i = 0; i < nconds; i++) {
+        if (conds[i].field == NULL || (conds[i].op & ~VS_QUERY_SORTED) < VS_QUERY_LT ||
+            (conds[i].op & ~VS_QUERY_SORTED) > VS_QUERY_GT)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+        if (VSfindex(vkey, conds[i].field, &findex[i]) == FAIL)
+            HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+        if (vs->wlist.order[findex[i]] != 1)
+            HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+        if (VSIquery_values((int32)vs->wlist.type[findex[i]], NULL, 0, NULL) == FAIL)
+            HGOTO_ERROR(DFE_BADNUMTYPE, FAIL);
+    }
+
+    if ((pos = Htell(vs->aid)) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* narrow the records down with the conditions on sorted fields */
+    last = vs->nvertices;
+    if (vs->interlace == FULL_INTERLACE)
+        for (i = 0; i < nconds && first < last; i++) {
+            if (!(conds[i].op & VS_QUERY_SORTED))
+                continue;
+            type = (int32)vs->wlist.type[findex[i]];
+            x    = conds[i].value;
+            switch (conds[i].op & ~VS_QUERY_SORTED) {
+                case VS_QUERY_LT:
+                    last = VSIquery_bound(vkey, findex[i], type, x, FALSE, first, last);
+                    break;
+                case VS_QUERY_LE:
+                    last = VSIquery_bound(vkey, findex[i], type, x, TRUE, first, last);
+                    break;
+                case VS_QUERY_GE:
+                    first = VSIquery_bound(vkey, findex[i], type, x, FALSE, first, last);
+                    break;
+                case VS_QUERY_GT:
+                    first = VSIquery_bound(vkey, findex[i], type, x, TRUE, first, last);
+                    break;
+                case VS_QUERY_EQ:
+                    if ((first = VSIquery_bound(vkey, findex[i], type, x, FALSE, first, last)) != FAIL)
+                        last = VSIquery_bound(vkey, findex[i], type, x, TRUE, first, last);
+                    break;
+                default: /* VS_QUERY_NE leaves both ends */
+                    break;
+            }
+            if (first == FAIL || last == FAIL)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+        }
+    if (first >= last)
+        HGOTO_DONE(0);
+
+    /* the fields of a no interlaced vdata are read all at once */
+    if (vs->interlace == FULL_INTERLACE)
+        batch = MIN(last - first, VS_QUERY_BATCH);
+    else {
+        first = 0;
+        last  = vs->nvertices;
+        batch = last;
+    }
+
+    if (NULL == (bufs = (uint8 **)calloc((size_t)nconds, sizeof(uint8 *))) ||
+        NULL == (vals = (float64 *)malloc((size_t)batch * sizeof(float64))) ||
+        NULL == (mask = (uint8 *)malloc((size_t)batch)))
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    for (i = 0; i < nconds; i++)
+        if (NULL == (bufs[i] = (uint8 *)malloc((size_t)batch * (size_t)vs->wlist.esize[findex[i]])))
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    if (VSseek(vkey, first) == FAIL)
+        HGOTO_ERROR(DFE_BADSEEK, FAIL);
+
+    for (rec = first; rec < last; rec += nrecs) {
+        nrecs = MIN(batch, last - rec);
+        if (VSIreadcolumns(vkey, nconds, findex, bufs, nrecs) != nrecs)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+
+        memset(mask, 1, (size_t)nrecs);
+        for (i = 0; i < nconds; i++) {
+            VSIquery_values((int32)vs->wlist.type[findex[i]], bufs[i], nrecs, vals);
+            x = conds[i].value;
+            switch (conds[i].op & ~VS_QUERY_SORTED) {
+                case VS_QUERY_LT:
+                    for (k = 0; k < nrecs; k++)
+                        mask[k] &= (uint8)(vals[k] < x);
+                    break;
+                case VS_QUERY_LE:
+                    for (k = 0; k < nrecs; k++)
+                        mask[k] &= (uint8)(vals[k] <= x);
+                    break;
+                case VS_QUERY_EQ:
+                    for (k = 0; k < nrecs; k++)
+                        mask[k] &= (uint8)(vals[k] == x);
+                    break;
+                case VS_QUERY_NE:
+                    for (k = 0; k < nrecs; k++)
+                        mask[k] &= (uint8)(vals[k] != x);
+                    break;
+                case VS_QUERY_GE:
+                    for (k = 0; k < nrecs; k++)
+                        mask[k] &= (uint8)(vals[k] >= x);
+                    break;
+                default: /* VS_QUERY_GT */
+                    for (k = 0; k < nrecs; k++)
+                        mask[k] &= (uint8)(vals[k] > x);
+                    break;
+            }
+        }
+
+        for (k = 0; k < nrecs; k++)
+            if (mask[k]) {
+                if (count < maxrecs)
+                    indices[count] = rec + k;
+                count++;
+            }
+    }
+
+    ret_value = count;
+
+done:
+    /* go back to where the caller was */
+    if (pos != FAIL)
+        Hseek(vs->aid, pos, DF_START);
+    if (bufs != NULL)
+        for (i = 0; i < nconds; i++)
+            free(bufs[i]);
+    free(bufs);
+    free(vals);
+    free(mask);
+    free(findex);
+
+    return ret_value;
+} /* VSquery */
+
+/*******************************************************************************
+NAME
+   VSIindex_compare
+
+DESCRIPTION
+   Orders the keys of an index by value, NaNs last, and the records of the
+   same value by index, for qsort().
+
+*******************************************************************************/
+static int
+VSIindex_compare(const void *p1, const void *p2)
+{
+    const vs_idxkey_t *k1   = (const vs_idxkey_t *)p1;
+    const vs_idxkey_t *k2   = (const vs_idxkey_t *)p2;
+    int                nan1 = isnan(k1->key);
+    int                nan2 = isnan(k2->key);
+
+    if (nan1 || nan2) {
+        if (!nan1 != !nan2)
+            return nan1 ? 1 : -1;
+    }
+    else if (k1->key < k2->key)
+        return -1;
+    else if (k1->key > k2->key)
+        return 1;
+    return (k1->rec > k2->rec) - (k1->rec < k2->rec);
+} /* VSIindex_compare */
+
+/*******************************************************************************
+NAME
+   VSIindex_build
+
+DESCRIPTION
+   Reads a field of order 1 and numeric type of all the records of a vdata
+   and writes its values, sorted, with the index of the record of each one
+   into the index vdata of the field, see VScreateindex().  The index vdata
+   is created when 'idx_ref' is 0 and written over otherwise.  The position
+   in the vdata is left anywhere.
+
+RETURNS
+   RETURNS SUCCEED/FAIL
+
+*******************************************************************************/
+static intn
+VSIindex_build(int32  vkey,   /* IN: vdata key */
+               VDATA *vs,     /* IN: the vdata */
+               int32  findex, /* IN: index of the field */
+               int32  idx_ref /* IN: ref of the index vdata, 0 if there is none */)
+{
+    vs_idxkey_t *keys = NULL; /* the values of the field and their records */
+    float64     *vals = NULL; /* values of a batch of records */
+    uint8       *buf  = NULL; /* native values of a batch, then index records */
+    uint8       *p;
+    int32        nrecs = vs->nvertices;
+    int32        batch = MIN(MAX(nrecs, 1), VS_QUERY_BATCH);
+    int32        type  = (int32)vs->wlist.type[findex];
+    int32        idx   = FAIL; /* index vdata */
+    int32        rec, n, k;
+    char         name[VSNAMELENMAX + 1];
+    intn         ret_value = SUCCEED;
+
+    if (NULL == (keys = (vs_idxkey_t *)malloc((size_t)MAX(nrecs, 1) * sizeof(vs_idxkey_t))) ||
+        NULL == (vals = (float64 *)malloc((size_t)batch * sizeof(float64))) ||
+        NULL == (buf = (uint8 *)malloc((size_t)batch * MAX(vs->wlist.esize[findex], VS_INDEX_RECSIZE))))
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    /* the values of the field, a batch at a time */
+    if (nrecs > 0 && VSseek(vkey, 0) == FAIL)
+        HGOTO_ERROR(DFE_BADSEEK, FAIL);
+    for (rec = 0; rec < nrecs; rec += n) {
+        n = MIN(batch, nrecs - rec);
+        if (VSIreadcolumns(vkey, 1, &findex, &buf, n) != n)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        if (VSIquery_values(type, buf, n, vals) == FAIL)
+            HGOTO_ERROR(DFE_BADNUMTYPE, FAIL);
+        for (k = 0; k < n; k++) {
+            keys[rec + k].key = vals[k];
+            keys[rec + k].rec = rec + k;
+        }
+    }
+    qsort(keys, (size_t)nrecs, sizeof(vs_idxkey_t), VSIindex_compare);
+
+    /* and out to the index vdata */
+    if (idx_ref == 0) {
+        if ((idx = VSattach(vs->f, -1, "w")) == FAIL)
+            HGOTO_ERROR(DFE_CANTATTACH, FAIL);
+        if (VSfdefine(idx, VS_INDEX_KEY, DFNT_FLOAT64, 1) == FAIL ||
+            VSfdefine(idx, VS_INDEX_RECORD, DFNT_INT32, 1) == FAIL)
+            HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+        sprintf(name, "%s%d_%d", VS_INDEX_NAME, (int)vs->oref, (int)findex);
+        if (VSsetname(idx, name) == FAIL || VSsetclass(idx, _HDF_VS_INDEX_CLASS) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    }
+    else {
+        if ((idx = VSattach(vs->f, idx_ref, "w")) == FAIL)
+            HGOTO_ERROR(DFE_CANTATTACH, FAIL);
+        if (VSelts(idx) > 0 && VSseek(idx, 0) == FAIL)
+            HGOTO_ERROR(DFE_BADSEEK, FAIL);
+    }
+    if (VSsetfields(idx, VS_INDEX_FIELDS) == FAIL)
+        HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+
+    for (rec = 0; rec < nrecs; rec += n) {
+        n = MIN(batch, nrecs - rec);
+        for (k = 0, p = buf; k < n; k++) {
+            memcpy(p, &keys[rec + k].key, sizeof(float64));
+            p += sizeof(float64);
+            memcpy(p, &keys[rec + k].rec, sizeof(int32));
+            p += sizeof(int32);
+        }
+        if (VSwrite(idx, buf, n, FULL_INTERLACE) != n)
+            HGOTO_ERROR(DFE_VSWRITE, FAIL);
+    }
+
+done:
+    if (idx != FAIL && VSdetach(idx) == FAIL)
+        ret_value = FAIL;
+    free(keys);
+    free(vals);
+    free(buf);
+
+    return ret_value;
+} /* VSIindex_build */
+
+/*******************************************************************************
+NAME
+   VSIindex_update
+
+DESCRIPTION
+   Builds again the indexes of the fields of a vdata that records were
+   written to, see VScreateindex().  Called when the vdata is detached and
+   before an index of it is looked up.
+
+RETURNS
+   RETURNS SUCCEED/FAIL
+
+*******************************************************************************/
+intn
+VSIindex_update(int32 vkey /* IN: vdata key */)
+{
+    vsinstance_t *wi = NULL;
+    VDATA        *vs = NULL;
+    int32         findex;
+    int32         ref;
+    char          name[VSNAMELENMAX + 1];
+    intn          ret_value = SUCCEED;
+
+    if (NULL == (wi = (vsinstance_t *)HAatom_object(vkey)) || NULL == (vs = wi->vs))
+        HGOTO_ERROR(DFE_NOVS, FAIL);
+    if (!vs->idx_stale)
+        HGOTO_DONE(SUCCEED);
+    vs->idx_stale = FALSE;
+
+    /* most files have no index at all */
+    if (VSfindclass(vs->f, _HDF_VS_INDEX_CLASS) == 0)
+        HGOTO_DONE(SUCCEED);
+
+    for (findex = 0; findex < vs->wlist.n; findex++) {
+        if (vs->wlist.order[findex] != 1)
+            continue;
+        sprintf(name, "%s%d_%d", VS_INDEX_NAME, (int)vs->oref, (int)findex);
+        if ((ref = VSfind(vs->f, name)) == 0)
+            continue;
+        if (VSIindex_build(vkey, vs, findex, ref) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    }
+
+done:
+    return ret_value;
+} /* VSIindex_update */
+
+/*******************************************************************************
+NAME
+   VScreateindex
+
+DESCRIPTION
+   Builds an index of a field of order 1 and numeric type of a vdata, so
+   that VSlookup() and VSrange() find the records holding given values of
+   the field with a binary search instead of reading the whole field.
+
+   The index is a vdata of class _HDF_VS_INDEX, named after the ref of the
+   vdata and the index of the field, holding a record per record of the
+   vdata: a value of the field, as a float64, and the index of the record
+   it is in, sorted by value.  Once built it is kept up to date: when
+   records were written to the vdata, the indexes of its fields are built
+   again when it is detached.  Calling it again builds the index again.
+
+   The position in the vdata is the same after the call as before.
+
+RETURNS
+   RETURNS SUCCEED/FAIL
+
+*******************************************************************************/
+intn
+VScreateindex(int32       vkey, /* IN: vdata key */
+              const char *field /* IN: name of the field to index */)
+{
+    vsinstance_t *wi     = NULL;
+    VDATA        *vs     = NULL;
+    int32         findex = 0;
+    int32         pos    = FAIL; /* offset to go back to */
+    char          name[VSNAMELENMAX + 1];
+    intn          ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* check if vdata is part of vdata group */
+    if (HAatom_group(vkey) != VSIDGROUP)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get vdata instance */
+    if (NULL == (wi = (vsinstance_t *)HAatom_object(vkey)))
+        HGOTO_ERROR(DFE_NOVS, FAIL);
+    vs = wi->vs;
+    if (vs == NULL || field == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* the field must be one VSquery() could compare */
+    if (VSfindex(vkey, field, &findex) == FAIL)
+        HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+    if (vs->wlist.order[findex] != 1)
+        HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+    if (VSIquery_values((int32)vs->wlist.type[findex], NULL, 0, NULL) == FAIL)
+        HGOTO_ERROR(DFE_BADNUMTYPE, FAIL);
+
+    /* records written since the other indexes were built? */
+    if (VSIindex_update(vkey) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    if (vs->nvertices > 0 && (pos = Htell(vs->aid)) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    sprintf(name, "%s%d_%d", VS_INDEX_NAME, (int)vs->oref, (int)findex);
+    if (VSIindex_build(vkey, vs, findex, VSfind(vs->f, name)) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+done:
+    /* go back to where the caller was */
+    if (pos != FAIL)
+        Hseek(vs->aid, pos, DF_START);
+
+    return ret_value;
+} /* VScreateindex */
+
+/*******************************************************************************
+NAME
+   VSIindex_find
+
+DESCRIPTION
+   Finds the records of a vdata whose value of an indexed field is between
+   'lo' and 'hi' included, with two binary searches of the index of the
+   field, see VScreateindex(), and reads the indices of the first
+   'maxrecs' of them from the index.
+
+RETURNS
+   RETURNS FAIL if error
+   RETURNS the number of matching records, which may be more than 'maxrecs'.
+
+*******************************************************************************/
+static int32
+VSIindex_find(int32       vkey,    /* IN: vdata key */
+              const char *field,   /* IN: name of the indexed field */
+              float64     lo,      /* IN: least value looked for */
+              float64     hi,      /* IN: greatest value looked for */
+              int32       maxrecs, /* IN: room in 'indices' */
+              int32       indices[] /* OUT: indices of the matching records */)
+{
+    vsinstance_t *wi     = NULL;
+    VDATA        *vs     = NULL;
+    int32         findex = 0;
+    int32         idx    = FAIL; /* index vdata */
+    int32         ref;
+    int32         first, last;
+    char          name[VSNAMELENMAX + 1];
+    int32         ret_value = SUCCEED;
+
+    /* check if vdata is part of vdata group */
+    if (HAatom_group(vkey) != VSIDGROUP)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get vdata instance */
+    if (NULL == (wi = (vsinstance_t *)HAatom_object(vkey)))
+        HGOTO_ERROR(DFE_NOVS, FAIL);
+    vs = wi->vs;
+    if (vs == NULL || field == NULL || maxrecs < 0 || (maxrecs > 0 && indices == NULL))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (VSfindex(vkey, field, &findex) == FAIL)
+        HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+
+    /* records written since the index was built? */
+    if (VSIindex_update(vkey) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    sprintf(name, "%s%d_%d", VS_INDEX_NAME, (int)vs->oref, (int)findex);
+    if ((ref = VSfind(vs->f, name)) == 0)
+        HGOTO_ERROR(DFE_NOMATCH, FAIL);
+    if ((idx = VSattach(vs->f, ref, "r")) == FAIL)
+        HGOTO_ERROR(DFE_CANTATTACH, FAIL);
+
+    /* an index the vdata outgrew was not kept up to date */
+    if (VSelts(idx) != vs->nvertices)
+        HGOTO_ERROR(DFE_NOMATCH, FAIL);
+    if (vs->nvertices == 0 || !(lo <= hi))
+        HGOTO_DONE(0);
+
+    /* the keys are the first field of the index */
+    if ((first = VSIquery_bound(idx, 0, DFNT_FLOAT64, lo, FALSE, 0, vs->nvertices)) == FAIL ||
+        (last = VSIquery_bound(idx, 0, DFNT_FLOAT64, hi, TRUE, first, vs->nvertices)) == FAIL)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
+
+    if (maxrecs > 0 && first < last) {
+        if (VSseek(idx, first) == FAIL)
+            HGOTO_ERROR(DFE_BADSEEK, FAIL);
+        if (VSreadfield(idx, VS_INDEX_RECORD, (uint8 *)indices, MIN(maxrecs, last - first)) !=
+            MIN(maxrecs, last - first))
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+    }
+
+    ret_value = last - first;
+
+done:
+    if (idx != FAIL)
+        VSdetach(idx);
+
+    return ret_value;
+} /* VSIindex_find */
+
+/*******************************************************************************
+NAME
+   VSlookup
+
+DESCRIPTION
+   Finds the records of a vdata whose value of a field indexed with
+   VScreateindex() is 'value', without reading the vdata.  The indices of
+   the first 'maxrecs' of them are stored in 'indices' in increasing
+   order; the records can then be read with VSseek/VSread.  The position in
+   the vdata is not changed.
+
+RETURNS
+   RETURNS FAIL if error, also when the field has no index
+   RETURNS the number of matching records, which may be more than 'maxrecs'.
+
+*******************************************************************************/
+int32
+VSlookup(int32       vkey,    /* IN: vdata key */
+         const char *field,   /* IN: name of the indexed field */
+         float64     value,   /* IN: value looked for */
+         int32       maxrecs, /* IN: room in 'indices' */
+         int32       indices[] /* OUT: indices of the matching records */)
+{
+    int32 ret_value;
+
+    /* clear error stack */
+    HEclear();
+
+    ret_value = VSIindex_find(vkey, field, value, value, maxrecs, indices);
+
+    return ret_value;
+} /* VSlookup */
+
+/*******************************************************************************
+NAME
+   VSrange
+
+DESCRIPTION
+   Finds the records of a vdata whose value of a field indexed with
+   VScreateindex() is between 'lo' and 'hi' included, without reading the
+   vdata.  The indices of the first 'maxrecs' of them are stored in
+   'indices' in increasing order of the value of the field, and of the
+   record for the same value; the records can then be read with
+   VSseek/VSread.  The position in the vdata is not changed.
+
+RETURNS
+   RETURNS FAIL if error, also when the field has no index
+   RETURNS the number of matching records, which may be more than 'maxrecs'.
+
+*******************************************************************************/
+int32
+VSrange(int32       vkey,    /* IN: vdata key */
+        const char *field,   /* IN: name of the indexed field */
+        float64     lo,      /* IN: least value looked for */
+        float64     hi,      /* IN: greatest value looked for */
+        int32       maxrecs, /* IN: room in 'indices' */
+        int32       indices[] /* OUT: indices of the matching records */)
+{
+    int32 ret_value;
+
+    /* clear error stack */
+    HEclear();
+
+    ret_value = VSIindex_find(vkey, field, lo, hi, maxrecs, indices);
+
+    return ret_value;
+} /* VSrange */
+
+/*******************************************************************************
+NAME
+   VSwrite
+
+DESCRIPTION
+   Writes a specified number of elements' worth of data to a vdata.
+   You must specify how your data in your buffer is interlaced.
+
+   NEW
+   create an aid, and write out if this is the first time.
+   (otherwise) subsequent writes result in link-blocks.
+
+RETURNS
+   RETURNS FAIL if error
+   RETURNS the number of elements written (0 or a +ve integer).
+
+*******************************************************************************/
+int32
+VSwrite(int32       vkey,  /* IN: vdata key */
+        const uint8 buf[], /* IN: elements to write to vdata */
+        int32       nelt,  /* IN: number of elements */
+        int32       interlace /* IN: interlace of elements 'buf' */)
+{
+    intn            isize = 0;
+    intn            order = 0;
+    intn            index = 0;
+    intn            esize = 0;
+    uint8          *dest  = NULL;
+    const uint8    *src, *Src;
+    int32           j;
+    int32           type;
+    int32           offset;
+    int32           position = 0;
+    int32           new_size;
+    int32           status;
+    int32           total_bytes; /* total number of bytes that need to be written out */
+    DYN_VWRITELIST *w = NULL;
+    int32           int_size;     /* size of "element" as needed by user in memory */
+    intn            hdf_size = 0; /* size of record in HDF file */
+    vsinstance_t   *wi       = NULL;
+    VDATA          *vs       = NULL;
+    int32           bytes; /* number of elements / bytes to write next time */
+    int32           chunk;
+    int32           done; /* number of records to do / done */
+    int32           ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* check if vdata is part of vdata group */
+    if (HAatom_group(vkey) != VSIDGROUP)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get vdata instance */
+    if (NULL == (wi = (vsinstance_t *)HAatom_object(vkey)))
+        HGOTO_ERROR(DFE_NOVS, FAIL);
+
+    /* get vdata itself and check it. Also check number of elements */
+    vs = wi->vs;
+    if ((nelt <= 0) || (vs == NULL))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* check if write access to vdata */
+    if (vs->access != 'w')
+        HGOTO_ERROR(DFE_BADACC, FAIL);
+
+    /* the indexes of its fields, if any, are built again at detach */
+    vs->idx_stale = TRUE;
+
+    /* check if vdata exists in the file */
+    if (FAIL == vexistvs(vs->f, vs->oref))
+        HGOTO_ERROR(DFE_NOVS, FAIL);
+
+    /* get write list */
+    w = &vs->wlist;
+    if (w->n == 0) {
+        HERROR(DFE_NOVS);
+        HEreport("No fields set for writing");
+        HGOTO_DONE(FAIL);
+    }
+
+    /* check interlace of input buffer */
+    if (interlace != NO_INTERLACE && interlace != FULL_INTERLACE)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    hdf_size    = (intn)w->ivsize; /* as stored in HDF file */
+    total_bytes = hdf_size * nelt;
+
+    /* make sure we have a valid AID */
+    if (vs->aid == 0) {
+        HGOTO_ERROR(DFE_BADAID, FAIL);
+    }
+
+    /*
+     * promote to link-block if vdata exists and is not already one
+     *  AND we are increasing its size
+     */
+    HQueryposition(vs->aid, &position);
+    new_size = (position / (intn)vs->wlist.ivsize) + nelt;
+
+    /* this should really be cached in the Vdata structure */
+    for (int_size = 0, j = 0; j < w->n; j++)
+        int_size += w->esize[j];
+
+    /*
+       First, convert and repack field(s) from Vtbuf into buf.
+
+       This section of the code deals with interlacing. In all cases
+       the items for each of the fields are converted and shuffled
+       around from the user's buffer "buf" to the internal's buffer
+       "Vtbuf".  The data in "Vtbuf" is then written out to the vdata.
+
+       There are 5 cases :
+       (A) user=NO_INTERLACE   & vdata=FULL_INTERLACE)
+       (B) user=NO_INTERLACE   & vdata=NO_INTERLACE)
+       (C) user=FULL_INTERLACE & vdata=FULL_INTERLACE)
+       (D) user=FULL_INTERLACE & vadat=NO_INTERLACE)
+       (E) SPECIAL CASE when only one field.
+
+       Cases (A)-(D) handles multiple fields
+       Case (E) handles single field Vdatas
+
+       Cases (E) and (C) are the most frequently used.  Limit buffer
+       allocations to VDATA_BUFFER_MAX size so that we conserve
+       memory.  Doing this involves a certain degree of added code
+       complexity so don't bother doing it for the less frequent
+       cases.  Cases E and C have been rolled together since they are
+       very similar and both need the incremental writing.
+
+       --------------------------------------------------------------------- */
+    /* CASE  (E + C): Easy to unroll case */
+    if ((w->n == 1) || (interlace == FULL_INTERLACE && vs->interlace == FULL_INTERLACE)) {
+
+        /*
+         * figure out how many elements we can move at a time and
+         * make sure our buffer is big enough
+         */
+
+        if ((uint32)total_bytes < Vtbufsize) {
+            chunk = nelt;
+        }
+        else {
+            int32 buf_size;
+
+            /* we are bounded above by VDATA_BUFFER_MAX */
+            buf_size = MIN(total_bytes, VDATA_BUFFER_MAX);
+
+            /* make sure there is at least room for one record in our buffer */
+            chunk = buf_size / hdf_size + 1;
+
+            /* get a buffer big enough to hold the values */
+            if (HDscratch_resize(&Vtbuf, &Vtbufsize, (size_t)chunk * (size_t)hdf_size) == FAIL)
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        }
+
+        done = 0;
+
+        /* set loop invariant parameters */
+        Src   = buf;
+        dest  = Vtbuf;
+        bytes = hdf_size * chunk;
+
+        while (done < nelt) {
+
+            /* chunk has changed so update the byte counts */
+            if (nelt - done < chunk) {
+                chunk = nelt - done;
+                bytes = hdf_size * chunk;
+            }
+            /*
+               printf("Case E/C: [%d,%d] writing %d (elems) %d bytes\n", done, nelt, chunk, bytes);
+             */
+
+            offset = 0;
+            for (j = 0; j < w->n; j++) {
+                src   = Src + offset;
+                dest  = Vtbuf + (size_t)w->off[j];
+                type  = (int32)w->type[j];
+                esize = (intn)w->esize[j];
+                isize = (intn)w->isize[j];
+                order = (intn)w->order[j];
+
+                for (index = 0; index < order; index++) {
+                    DFKconvert((void *)src, dest, type, (uint32)chunk, DFACC_WRITE, (uint32)int_size,
+                               (uint32)hdf_size);
+                    dest += isize / order;
+                    src += esize / order;
+                }
+                offset += esize;
+            }
+
+            /* write the converted data to the file */
+            status = Hwrite(vs->aid, bytes, (uint8 *)Vtbuf);
+            if (status != bytes)
+                HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+            /* record what we've done and move to next group */
+            done += chunk;
+            Src += chunk * int_size;
+        }
+
+    } /* case (C + E) */
+
+    else {
+
+        /*
+         * Handle the other cases now.
+         * These cases are less frequent so don't bother unrolling
+         *   the loops for now.  As a result, we may get into memory
+         *   problems since we may end up allocating a huge buffer
+         */
+
+        /* alloc space (Vtbuf) for writing out the data */
+        if (Vtbufsize < (uint32)total_bytes) {
+            if (HDscratch_resize(&Vtbuf, &Vtbufsize, (uint32)total_bytes) == FAIL)
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        }
+
+        /* ----------------------------------------------------------------- */
+        /* CASE  (A):  user=none, vdata=full */
+        if (interlace == NO_INTERLACE && vs->interlace == FULL_INTERLACE) {
+
+            src = buf;
+            for (j = 0; j < w->n; j++) {
+                dest  = Vtbuf + (size_t)w->off[j];
+                type  = (int32)w->type[j];
+                esize = (intn)w->esize[j];
+                isize = (intn)w->isize[j];
+                order = (intn)w->order[j];
+
+                for (index = 0; index < order; index++) {
+                    DFKconvert((void *)src, dest, type, (uint32)nelt, DFACC_WRITE, (uint32)esize,
+                               (uint32)hdf_size);
+                    src += esize / order;
+                    dest += isize / order;
+                }
+                src += ((nelt - 1) * esize);
+            }
+
+        } /* case (a) */
 
         /* --------------------------------------------------------------------- */
         /* CASE  (B):  user=none, vdata=none */
@@ -727,3 +1973,169 @@ VSwrite(int32       vkey,  /* IN: vdata key */
 done:
     return ret_value;
 } /* VSwrite */
+
+/*******************************************************************************
+NAME
+   VSwritecolumns
+
+DESCRIPTION
+   Writes a specified number of elements' worth of data to a vdata from
+   one array per field: bufs[j] holds 'nelt' contiguous values of the j-th
+   field set with VSsetfields, in the native format.  This is the same as
+   writing with VSwrite in NO_INTERLACE mode, but does not need the fields
+   to be laid out in one buffer.
+
+   Each field is converted with one strided call when it has order 1,
+   copied a record at a time when its number type needs no conversion,
+   and converted a value of its order at a time otherwise.  A full
+   interlaced vdata is written a buffer of at most VDATA_BUFFER_MAX bytes
+   at a time, the records of the buffer going out in a single write.
+
+RETURNS
+   RETURNS FAIL if error
+   RETURNS the number of elements written (0 or a +ve integer).
+
+*******************************************************************************/
+int32
+VSwritecolumns(int32        vkey,   /* IN: vdata key */
+               const uint8 *bufs[], /* IN: one array per field of elements to write */
+               int32        nelt /* IN: number of elements */)
+{
+    intn            isize;
+    intn            esize;
+    intn            order;
+    intn            j, k;
+    const uint8    *src;
+    uint8          *dst;
+    int32           hsize;
+    int32           stride;      /* bytes from one record of a field to the next in Vtbuf */
+    int32           type;
+    int32           position = 0;
+    int32           new_size;
+    int32           total_bytes; /* total number of bytes that need to be written out */
+    int32           bytes;       /* number of bytes to write next time */
+    int32           chunk;       /* number of records in a buffer */
+    int32           done;        /* number of records done */
+    DYN_VWRITELIST *w         = NULL;
+    vsinstance_t   *wi        = NULL;
+    VDATA          *vs        = NULL;
+    int32           ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* check if vdata is part of vdata group */
+    if (HAatom_group(vkey) != VSIDGROUP)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get vdata instance */
+    if (NULL == (wi = (vsinstance_t *)HAatom_object(vkey)))
+        HGOTO_ERROR(DFE_NOVS, FAIL);
+
+    /* get vdata itself and check it. Also check number of elements */
+    vs = wi->vs;
+    if ((nelt <= 0) || (vs == NULL) || (bufs == NULL))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* check if write access to vdata */
+    if (vs->access != 'w')
+        HGOTO_ERROR(DFE_BADACC, FAIL);
+
+    /* the indexes of its fields, if any, are built again at detach */
+    vs->idx_stale = TRUE;
+
+    /* check if vdata exists in the file */
+    if (FAIL == vexistvs(vs->f, vs->oref))
+        HGOTO_ERROR(DFE_NOVS, FAIL);
+
+    /* get write list */
+    w = &vs->wlist;
+    if (w->n == 0) {
+        HERROR(DFE_NOVS);
+        HEreport("No fields set for writing");
+        HGOTO_DONE(FAIL);
+    }
+
+    for (j = 0; j < w->n; j++)
+        if (bufs[j] == NULL)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* make sure we have a valid AID */
+    if (vs->aid == 0)
+        HGOTO_ERROR(DFE_BADAID, FAIL);
+
+    hsize       = (int32)w->ivsize; /* as stored in HDF file */
+    total_bytes = hsize * nelt;
+
+    HQueryposition(vs->aid, &position);
+    new_size = (position / hsize) + nelt;
+
+    /*
+     * A full interlaced vdata is written through a buffer of at most
+     * VDATA_BUFFER_MAX bytes, the fields of a no interlaced one are
+     * stored one after the other so all elements are written at once.
+     */
+    if (vs->interlace == FULL_INTERLACE && (uint32)total_bytes >= Vtbufsize) {
+        /* make sure there is at least room for one record in our buffer */
+        chunk = MIN(total_bytes, VDATA_BUFFER_MAX) / hsize + 1;
+
+        if (HDscratch_resize(&Vtbuf, &Vtbufsize, (size_t)chunk * (size_t)hsize) == FAIL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    }
+    else {
+        chunk = nelt;
+        if (Vtbufsize < (size_t)total_bytes) {
+            if (HDscratch_resize(&Vtbuf, &Vtbufsize, (size_t)total_bytes) == FAIL)
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        }
+    }
+
+    for (done = 0; done < nelt; done += chunk) {
+        if (nelt - done < chunk)
+            chunk = nelt - done;
+        bytes = hsize * chunk;
+
+        for (j = 0; j < w->n; j++) {
+            type  = (int32)w->type[j];
+            isize = (intn)w->isize[j];
+            esize = (intn)w->esize[j];
+            order = (intn)w->order[j];
+            src   = bufs[j] + (size_t)done * (size_t)esize;
+            if (vs->interlace == FULL_INTERLACE) {
+                dst    = Vtbuf + (size_t)w->off[j];
+                stride = hsize;
+            }
+            else {
+                dst    = Vtbuf + (size_t)w->off[j] * (size_t)nelt;
+                stride = isize;
+            }
+
+            if (stride == isize) /* the field is contiguous */
+                DFKconvert((void *)src, dst, type, (uint32)(order * chunk), DFACC_WRITE, 0, 0);
+            else if (order == 1)
+                DFKconvert((void *)src, dst, type, (uint32)chunk, DFACC_WRITE, (uint32)esize,
+                           (uint32)stride);
+            else if (isize == esize && DFKiscopyNT(type))
+                for (k = 0; k < chunk; k++)
+                    memcpy(dst + (size_t)k * (size_t)stride, src + (size_t)k * (size_t)esize, (size_t)isize);
+            else
+                for (k = 0; k < order; k++)
+                    DFKconvert((void *)(src + k * (esize / order)), dst + k * (isize / order), type,
+                               (uint32)chunk, DFACC_WRITE, (uint32)esize, (uint32)stride);
+        }
+
+        /* write the converted data to the file */
+        if (Hwrite(vs->aid, bytes, (uint8 *)Vtbuf) != bytes)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    }
+
+    /* update the internal structure to reflect write */
+    if (new_size > vs->nvertices)
+        vs->nvertices = new_size;
+    vs->marked = 1;
+
+    ret_value = nelt;
+
+done:
+    return ret_value;
+} /* VSwritecolumns */
@@ -17,6 +17,9 @@
 *
 
 LOCAL ROUTINES
+ VSIfield_index -- Finds a field of a vdata by name through a hash table.
+ VSIfield_list  -- Resolves a list of field names, keeping the last ones.
+ VSIfields_free -- Frees the field lookup state kept with a vdata.
 
 EXPORTED ROUTINES
  VSIZEOF      -- returns the machine size of a field type.
@@ -60,6 +63,166 @@ static const SYMDEF rstab[] = {
 
 #define NRESERVED (sizeof(rstab) / sizeof(SYMDEF))
 
+/* TRUE if two field lists given to VSfpack() are the same, NULL standing for all */
+#define VS_FIELDS_EQ(a, b) ((a) == NULL ? (b) == NULL : (b) != NULL && strcmp((a), (b)) == 0)
+
+/* Hash of a field name for VSIfield_index() */
+static uint32
+VSIfield_hash(const char *name)
+{
+    uint32 h = 2166136261U;
+
+    while (*name)
+        h = (h ^ (uint32)(uint8)*name++) * 16777619U;
+    return h;
+}
+
+/* ------------------------------------------------------------------ */
+/*
+ ** Index of the field 'name' in the write list of a vdata, the first one if
+ ** there are several, found through a hash table built the first time
+ ** RETURNS the index, or FAIL if the vdata has no such field
+ */
+intn
+VSIfield_index(VDATA *vs, const char *name)
+{
+    DYN_VWRITELIST *w = &vs->wlist;
+    uint32          mask;
+    uint32          h;
+    intn            i, size;
+
+    if (w->n <= 0)
+        return FAIL;
+
+    if (vs->fhash == NULL) {
+        for (size = 8; size < 2 * w->n; size *= 2)
+            ;
+        if ((vs->fhash = (intn *)malloc((size_t)size * sizeof(intn))) == NULL)
+            return FAIL;
+        vs->fhash_size = size;
+        for (h = 0; h < (uint32)size; h++)
+            vs->fhash[h] = FAIL;
+
+        mask = (uint32)size - 1;
+        for (i = 0; i < w->n; i++) {
+            for (h = VSIfield_hash(w->name[i]) & mask; vs->fhash[h] != FAIL; h = (h + 1) & mask)
+                if (strcmp(w->name[vs->fhash[h]], w->name[i]) == 0)
+                    break;
+            if (vs->fhash[h] == FAIL)
+                vs->fhash[h] = i;
+        }
+    }
+
+    mask = (uint32)vs->fhash_size - 1;
+    for (h = VSIfield_hash(name) & mask; vs->fhash[h] != FAIL; h = (h + 1) & mask)
+        if (strcmp(w->name[vs->fhash[h]], name) == 0)
+            return vs->fhash[h];
+
+    return FAIL;
+} /* VSIfield_index */
+
+/* ------------------------------------------------------------------ */
+/*
+ ** Resolves a comma-separated list of field names to indices in the write
+ ** list of a vdata.  The last VS_FLIST_MAX lists resolved are kept with the
+ ** vdata, so a list used again is neither parsed nor looked up; the indices
+ ** returned stay valid until the next call.
+ ** RETURNS FAIL if error, and SUCCEED if ok.
+ */
+intn
+VSIfield_list(VDATA *vs, const char *fields, intn *nfields, const intn **idx)
+{
+    vs_flist_t *fl, *prev = NULL;
+    char      **av;
+    int32       ac;
+    intn        i;
+    intn        ret_value = SUCCEED;
+
+    for (fl = vs->flists; fl != NULL; prev = fl, fl = fl->next)
+        if (strcmp(fl->fields, fields) == 0)
+            break;
+
+    if (fl == NULL) {
+        if ((scanattrs(fields, &ac, &av) == FAIL) || (ac == 0))
+            HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+
+        if ((fl = (vs_flist_t *)calloc(1, sizeof(vs_flist_t))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if ((fl->fields = strdup(fields)) == NULL ||
+            (fl->idx = (intn *)malloc((size_t)ac * sizeof(intn))) == NULL) {
+            free(fl->fields);
+            free(fl);
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        }
+        for (fl->n = 0; fl->n < ac; fl->n++)
+            if ((fl->idx[fl->n] = VSIfield_index(vs, av[fl->n])) == FAIL) {
+                free(fl->idx);
+                free(fl->fields);
+                free(fl);
+                HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+            }
+
+        /* drop the list used least recently */
+        if (vs->nflists >= VS_FLIST_MAX) {
+            vs_flist_t **last = &vs->flists;
+
+            for (i = 1; i < vs->nflists; i++)
+                last = &(*last)->next;
+            free((*last)->idx);
+            free((*last)->fields);
+            free(*last);
+            *last = NULL;
+            vs->nflists--;
+        }
+        fl->next   = vs->flists;
+        vs->flists = fl;
+        vs->nflists++;
+    }
+    else if (prev != NULL) { /* move it to the front */
+        prev->next = fl->next;
+        fl->next   = vs->flists;
+        vs->flists = fl;
+    }
+
+    *nfields = fl->n;
+    *idx     = fl->idx;
+
+done:
+    return ret_value;
+} /* VSIfield_list */
+
+/* ------------------------------------------------------------------ */
+/*
+ ** Frees the field lists, the field name hash and the VSfpack() layout
+ ** kept with a vdata; must be called when its write list changes
+ */
+void
+VSIfields_free(VDATA *vs)
+{
+    vs_flist_t *fl;
+
+    while ((fl = vs->flists) != NULL) {
+        vs->flists = fl->next;
+        free(fl->idx);
+        free(fl->fields);
+        free(fl);
+    }
+    vs->nflists = 0;
+
+    free(vs->fhash);
+    vs->fhash      = NULL;
+    vs->fhash_size = 0;
+
+    if (vs->fpack != NULL) {
+        free(vs->fpack->fields_in_buf);
+        free(vs->fpack->fields);
+        free(vs->fpack->offs);
+        free(vs->fpack->sizes);
+        free(vs->fpack);
+        vs->fpack = NULL;
+    }
+} /* VSIfields_free */
+
 /* ------------------------------------------------------------------ */
 /*
  ** sets the fields in a vdata for reading or writing
@@ -72,6 +235,8 @@ VSsetfields(int32 vkey, const char *fields)
     char          **av;
     int32           ac, found;
     intn            j, i;
+    intn            nidx;
+    const intn     *idx;
     uint16          uj;
     uint16          order;
     int32           value;
@@ -97,13 +262,6 @@ VSsetfields(int32 vkey, const char *fields)
     if (vs == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    if ((scanattrs(fields, &ac, &av) == FAIL) || (ac == 0))
-        HGOTO_ERROR(DFE_BADFIELDS, FAIL);
-
-    /* check number of fields limit  */
-    if (ac > VSFIELDMAX)
-        HGOTO_ERROR(DFE_SYMSIZE, FAIL);
-
     /*
      * write to an empty vdata : set the write list but do not set the
      *   read list cuz there is nothing there to read yet...
@@ -114,6 +272,16 @@ VSsetfields(int32 vkey, const char *fields)
             if (wlist->n == 0) /* fields not set yet, Sept. 96. */
                                /* do not re-set fields if they were already set. */
             {
+                if ((scanattrs(fields, &ac, &av) == FAIL) || (ac == 0))
+                    HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+
+                /* check number of fields limit  */
+                if (ac > VSFIELDMAX)
+                    HGOTO_ERROR(DFE_SYMSIZE, FAIL);
+
+                /* the lists resolved against no field are stale */
+                VSIfields_free(vs);
+
                 wlist->ivsize = 0;
                 wlist->n      = 0;
 
@@ -221,22 +389,20 @@ VSsetfields(int32 vkey, const char *fields)
         free(rlist->item);
         rlist->item = NULL;
 
+        /* the fields, as indices into wlist->name, parsed and looked up
+           only the first times this list is used */
+        if (VSIfield_list(vs, fields, &nidx, &idx) == FAIL)
+            HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+
+        /* check number of fields limit  */
+        if (nidx > VSFIELDMAX)
+            HGOTO_ERROR(DFE_SYMSIZE, FAIL);
+
         /* Allocate enough space for the read list */
-        if ((rlist->item = (intn *)malloc(sizeof(intn) * (size_t)(ac))) == NULL)
+        if ((rlist->item = (intn *)malloc(sizeof(intn) * (size_t)nidx)) == NULL)
             HGOTO_ERROR(DFE_NOSPACE, FAIL);
-        for (i = 0; i < ac; i++) {
-            found = FALSE;
-            for (j = 0; j < vs->wlist.n; j++)
-                if (!strcmp(av[i], vs->wlist.name[j])) { /*  see if field exist */
-                    found = TRUE;
-
-                    rlist->item[rlist->n] = j; /* save as index into wlist->name */
-                    rlist->n++;
-                    break;
-                }
-            if (!found) /* field does not exist - error */
-                HGOTO_ERROR(DFE_BADFIELDS, FAIL);
-        }
+        memcpy(rlist->item, idx, sizeof(intn) * (size_t)nidx);
+        rlist->n  = nidx;
         ret_value = SUCCEED;
     } /* setting read list */
 
@@ -852,24 +1018,18 @@ intn
 VSfpack(int32 vsid, intn packtype, const char *fields_in_buf, void *buf, intn bufsz, intn n_records,
         const char *fields, void *fldbufpt[])
 {
-    int32           ac;
-    char          **av, *s;
-    uint8          *bufp   = (uint8 *)buf;
-    uint8         **fbufps = NULL;
-    int32           b_rec_size, *fmsizes = NULL, *foffs = NULL;
-    intn            i, j, found, ret_value = SUCCEED;
+    const intn     *idx;
+    intn            bn, fn;
+    intn           *bfld  = NULL; /* index of each field in buf in the vdata */
+    int32          *boffs = NULL; /* offset of each field in buf in a record */
+    uint8          *bufp, *fbufp;
+    size_t          size;
+    intn            i, j, ret_value = SUCCEED;
     vsinstance_t   *wi;
-    VDATA          *vs;
+    VDATA          *vs = NULL;
     DYN_VWRITELIST *w;
-    struct blist_t { /* contains info about fields in buf */
-        intn   n;    /* number of fields in buf     */
-        int32 *idx;  /* index of buf fields in vdata */
-        int32 *offs; /* offset of buf fields in buf */
-    } blist;
-
-    /* initialize tobe-allocated vars in case of error before allocation */
-    blist.idx  = NULL;
-    blist.offs = NULL;
+    vs_fpack_t     *plan  = NULL;
+    intn            ready = FALSE; /* TRUE once plan is complete */
 
     if (HAatom_group(vsid) != VSIDGROUP)
         HGOTO_ERROR(DFE_ARGS, FAIL);
@@ -880,136 +1040,105 @@ VSfpack(int32 vsid, intn packtype, const char *fields_in_buf, void *buf, intn bu
     if (vs == NULL)
         HGOTO_ERROR(DFE_NOVS, FAIL);
     w = &vs->wlist;
-    /* build blist based on info in w */
-    if (fields_in_buf == NULL)
-        ac = w->n;
-    else { /* build our own blist */
-        if (scanattrs(fields_in_buf, &ac, &av) == FAIL)
+
+    /* the layout of the last call is used again if the field lists match */
+    plan = vs->fpack;
+    if (plan != NULL && VS_FIELDS_EQ(plan->fields_in_buf, fields_in_buf) && VS_FIELDS_EQ(plan->fields, fields)) {
+        vs->fpack = NULL; /* taken over, put back when done */
+        ready     = TRUE;
+    }
+    else {
+        if ((plan = (vs_fpack_t *)calloc(1, sizeof(vs_fpack_t))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if ((fields_in_buf != NULL && (plan->fields_in_buf = strdup(fields_in_buf)) == NULL) ||
+            (fields != NULL && (plan->fields = strdup(fields)) == NULL))
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+        /* fields in buf, NULL standing for all the fields of the vdata */
+        if (fields_in_buf == NULL) {
+            bn  = w->n;
+            idx = NULL;
+        }
+        else if (VSIfield_list(vs, fields_in_buf, &bn, &idx) == FAIL)
             HGOTO_ERROR(DFE_BADFIELDS, FAIL);
-        if ((av == NULL) || (ac < 1))
+        if (bn < 1)
             HGOTO_ERROR(DFE_ARGS, FAIL);
-    }
-    blist.n    = ac;
-    blist.idx  = (int32 *)malloc((size_t)ac * sizeof(int32));
-    blist.offs = (int32 *)malloc((size_t)ac * sizeof(int32));
-    if ((blist.idx == NULL) || (blist.offs == NULL))
-        HGOTO_ERROR(DFE_NOSPACE, FAIL);
-    /* fill arrays blist.msizes and blist.offs; calculate
-         buf record size */
-    b_rec_size = 0;
-    if (fields_in_buf != NULL)
-        /* a subset of vdata fields are contained in buf */
-        for (i = 0; i < ac; i++) {
-            /* look for the field in vdata fields */
-            found = 0;
-            s     = av[i];
-            for (j = 0; j < w->n; j++) {
-#ifdef VDATA_FIELDS_ALL_UPPER
-                if (matchnocase(s, w->name[j])) {
-                    found = 1;
-                    break;
-                }
-#else
-                if (strcmp(s, w->name[j]) == 0) {
-                    found = 1;
-                    break;
-                }
-#endif        /* VDATA_FIELDS_ALL_UPPER */
-            } /* for j */
-            if (!found)
-                HGOTO_ERROR(DFE_BADFIELDS, FAIL);
-            /* get field info */
-            blist.idx[i]  = j;
-            blist.offs[i] = (i == 0 ? 0 : blist.offs[i - 1] + w->esize[blist.idx[i - 1]]);
-            b_rec_size += w->esize[j];
-        } /* for i */
-    else  /* buf contains all vdata fields  */
-        for (i = 0; i < ac; i++) {
-            blist.idx[i]  = i;
-            blist.offs[i] = (i == 0 ? 0 : blist.offs[i - 1] + w->esize[i - 1]);
-            b_rec_size += w->esize[i];
+        bfld  = (intn *)malloc((size_t)bn * sizeof(intn));
+        boffs = (int32 *)malloc((size_t)bn * sizeof(int32));
+        if (bfld == NULL || boffs == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+        /* offsets of the fields in a record of buf, and its size */
+        for (i = 0; i < bn; i++) {
+            bfld[i]  = (idx == NULL) ? i : idx[i];
+            boffs[i] = plan->rec_size;
+            plan->rec_size += w->esize[bfld[i]];
         }
 
-    /* check bufsz */
-    if (bufsz < b_rec_size * n_records)
-        HGOTO_ERROR(DFE_NOTENOUGH, FAIL);
-    if (fields != NULL) { /* convert field names into tokens. */
-        if (scanattrs(fields, &ac, &av) == FAIL)
+        /* fields to pack or unpack, a subset of the fields in buf */
+        if (fields == NULL) {
+            fn  = bn;
+            idx = bfld;
+        }
+        else if (VSIfield_list(vs, fields, &fn, &idx) == FAIL)
             HGOTO_ERROR(DFE_BADFIELDS, FAIL);
-        if ((av == NULL) || (ac < 1))
+        if (fn < 1)
             HGOTO_ERROR(DFE_ARGS, FAIL);
-    }
-    else
-        ac = blist.n;
-    /* fill array of fmsizes, foffs, fbufps */
-    if ((fmsizes = (int32 *)malloc((size_t)ac * sizeof(int32))) == NULL)
-        HGOTO_ERROR(DFE_NOSPACE, FAIL);
-    if ((foffs = (int32 *)malloc((size_t)ac * sizeof(int32))) == NULL)
-        HGOTO_ERROR(DFE_NOSPACE, FAIL);
-    if ((fbufps = (uint8 **)malloc((size_t)ac * sizeof(uint8 *))) == NULL)
-        HGOTO_ERROR(DFE_NOSPACE, FAIL);
-    if (fields != NULL) { /* a subset of buf fields */
-        for (i = 0; i < ac; i++) {
-            /* find field info */
-            found = 0;
-            s     = av[i];
-            for (j = 0; j < blist.n; j++) {
-#ifdef VDATA_FIELDS_ALL_UPPER
-                if (matchnocase(s, w->name[blist.idx[j]])) {
-                    found = 1;
-                    break;
-                }
-#else
-                if (strcmp(s, w->name[blist.idx[j]]) == 0) {
-                    found = 1;
+
+        plan->n     = fn;
+        plan->offs  = (int32 *)malloc((size_t)fn * sizeof(int32));
+        plan->sizes = (int32 *)malloc((size_t)fn * sizeof(int32));
+        if (plan->offs == NULL || plan->sizes == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        for (i = 0; i < fn; i++) {
+            /* look for the field in buf */
+            for (j = 0; j < bn; j++)
+                if (bfld[j] == idx[i])
                     break;
-                }
-#endif        /* VDATA_FIELDS_ALL_UPPER */
-            } /* for */
-            if (!found)
+            if (j == bn)
                 HGOTO_ERROR(DFE_BADFIELDS, FAIL);
-            fmsizes[i] = (int32)w->esize[blist.idx[j]];
-            foffs[i]   = blist.offs[j];
-            fbufps[i]  = fldbufpt[i];
-            if (fbufps[i] == NULL)
-                HGOTO_ERROR(DFE_BADPTR, FAIL);
-        }
-    }
-    else { /* all buf fields */
-        for (i = 0; i < ac; i++) {
-            fmsizes[i] = (int32)w->esize[blist.idx[i]];
-            foffs[i]   = blist.offs[i];
-            fbufps[i]  = fldbufpt[i];
-            if (fbufps[i] == NULL)
-                HGOTO_ERROR(DFE_BADPTR, FAIL);
+            plan->offs[i]  = boffs[j];
+            plan->sizes[i] = (int32)w->esize[bfld[j]];
         }
+        ready = TRUE;
     }
-    if (packtype == _HDF_VSPACK) {
-        /* memory copy fields data to vdata buf */
-        for (i = 0; i < n_records; i++) {
-            for (j = 0; j < ac; j++) {
-                memcpy(bufp + foffs[j], fbufps[j], fmsizes[j]);
-                fbufps[j] += fmsizes[j];
-            }
-            bufp += b_rec_size;
-        }
-    }
-    else { /* unpack from buf to fields */
-        for (i = 0; i < n_records; i++) {
-            for (j = 0; j < ac; j++) {
-                memcpy(fbufps[j], bufp + foffs[j], fmsizes[j]);
-                fbufps[j] += fmsizes[j];
-            }
-            bufp += b_rec_size;
-        }
+
+    /* check bufsz */
+    if (bufsz < plan->rec_size * n_records)
+        HGOTO_ERROR(DFE_NOTENOUGH, FAIL);
+    for (i = 0; i < plan->n; i++)
+        if (fldbufpt[i] == NULL)
+            HGOTO_ERROR(DFE_BADPTR, FAIL);
+
+    /* copy a field of all the records at a time */
+    for (i = 0; i < plan->n; i++) {
+        size  = (size_t)plan->sizes[i];
+        bufp  = (uint8 *)buf + plan->offs[i];
+        fbufp = (uint8 *)fldbufpt[i];
+        if (packtype == _HDF_VSPACK) /* memory copy fields data to vdata buf */
+            for (j = 0; j < n_records; j++, bufp += plan->rec_size, fbufp += size)
+                memcpy(bufp, fbufp, size);
+        else /* unpack from buf to fields */
+            for (j = 0; j < n_records; j++, bufp += plan->rec_size, fbufp += size)
+                memcpy(fbufp, bufp, size);
     }
 
 done:
-    free(blist.idx);
-    free(blist.offs);
-    free(fmsizes);
-    free(foffs);
-    free(fbufps);
+    free(bfld);
+    free(boffs);
+
+    /* keep the layout for the next call */
+    if (plan != NULL) {
+        if (ready && vs->fpack == NULL)
+            vs->fpack = plan;
+        else {
+            free(plan->fields_in_buf);
+            free(plan->fields);
+            free(plan->offs);
+            free(plan->sizes);
+            free(plan);
+        }
+    }
 
     return ret_value;
 } /* VSfpack */
@@ -43,10 +43,13 @@ set (HDF4_TESTHDF_FILES
     datainfo_simple.hdf
     gr2.hdf
     gr_chunkcomp.hdf
+    gr_chunkjpeg.hdf
+    gr_chunkraw.hdf
     gr_comp.hdf
     gr_double_test.hdf
     gr_gzip.hdf
     gr_jpeg.hdf
+    gr_many_test.hdf
     gr_r8.hdf
     nntcheck.hdf
     ntcheck.hdf
@@ -75,30 +78,70 @@ set (HDF4_TESTHDF_FILES
     t2.hdf
     t3.hdf
     t4.hdf
+    t6.hdf
+    talign.hdf
+    tpattern.hdf
     tbitio.hdf
     tblocks.hdf
     tchunks.hdf
     tcomp.hdf
+    tddblock.hdf
+    tdirect.hdf
     tdf24.hdf
     tdfan.hdf
+    tdriver.hdf
     temp.hdf
+    tfd0.hdf
+    tfd1.hdf
+    tfd2.hdf
+    tfd3.hdf
+    tfd4.hdf
+    tfd5.hdf
+    tfree.hdf
     thf.hdf
+    timcomp.hdf
+    tindex.hdf
+    tindex.hdf.h4idx
     tjpeg.hdf
+    tkeep.hdf
     tlongnames.hdf
     tman.hdf
     tmgr.hdf
     tmgratt.hdf
     tmgrchk.hdf
+    tmgrovr.hdf
     tnbit.hdf
+    toffset.hdf
+    tposn.hdf
+    tprobe.hdf
     tref.hdf
+    trestart.hdf
+    tsearch.hdf
+    tstats.hdf
+    tstream.hdf
+    tthread0.hdf
+    tthread1.hdf
+    tthread2.hdf
+    tthread3.hdf
     tuservds.hdf
     tuservgs.hdf
+    tvalloc.hdf
     tvattr.hdf
+    tvcompat.hdf
+    tvghash.hdf
+    tvhuge.hdf
+    tvgtree.hdf
     tvpack.hdf
+    tvscols.hdf
     tvsempty.hdf
     tvset.hdf
     tvsetext.hdf
+    tvsindex.hdf
+    tvsquery.hdf
+    twbuf.hdf
+    thbuf.hdf
     tx.hdf
+    txcache.hdf
     Tables_External_File
 )
 add_test (
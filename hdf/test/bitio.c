@@ -63,6 +63,8 @@
 #define BITIO_REF_2 2500
 #define BITIO_TAG_3 3500
 #define BITIO_REF_3 3500
+#define BITIO_TAG_4 4500
+#define BITIO_REF_4 4500
 
 static uint8 outbuf[BUFSIZE], inbuf[DATASIZE];
 
@@ -78,6 +80,7 @@ static uint32 maskbuf[] = {0x00000000,   0x00000001,   0x00000003,  0x00000007,
 static void test_bitio_write(void);
 static void test_bitio_read(void);
 static void test_bitio_seek(void);
+static void test_bitio_vector(void);
 
 static void
 test_bitio_write(void)
@@ -399,10 +402,71 @@ test_bitio_seek(void)
     RESULT("Hclose");
 } /* test_bitio_seek() */
 
+static void
+test_bitio_vector(void)
+{
+    static const intn widths[] = {1, 7, 13, 32}; /* number of bits in each value of a pass */
+    int32             fid;
+    int32             bitid1;
+    int32             ret;
+    uint32            tempbuf;
+    intn              i, w;
+
+    MESSAGE(6, printf("Testing bitio vector routines\n"););
+    for (i = 0; i < BUFSIZE; i++)
+        outbuf2[i] = (uint32)RAND();
+
+    fid = Hopen(TESTFILE_NAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    for (w = 0; w < (intn)(sizeof(widths) / sizeof(widths[0])); w++) {
+        MESSAGE(8, printf("Writing and reading %d-bit values\n", widths[w]););
+
+        /* write half the values one at a time and half as an array */
+        bitid1 = Hstartbitwrite(fid, BITIO_TAG_4, (uint16)(BITIO_REF_4 + w), 0);
+        CHECK_VOID(bitid1, FAIL, "Hstartbitwrite");
+        ret = Hbitappendable(bitid1);
+        RESULT("Hbitappendable");
+        for (i = 0; i < BUFSIZE / 2; i++) {
+            ret = Hbitwrite(bitid1, widths[w], outbuf2[i]);
+            VERIFY_VOID(ret, widths[w], "Hbitwrite");
+        } /* end for */
+        ret = Hbitwritev(bitid1, widths[w], BUFSIZE / 2, &outbuf2[BUFSIZE / 2]);
+        VERIFY_VOID(ret, BUFSIZE / 2, "Hbitwritev");
+        ret = Hendbitaccess(bitid1, 0);
+        RESULT("Hbitendaccess");
+
+        /* read them all back as arrays, then try to read past the end */
+        memset(inbuf2, 0, sizeof(inbuf2));
+        bitid1 = Hstartbitread(fid, BITIO_TAG_4, (uint16)(BITIO_REF_4 + w));
+        CHECK_VOID(bitid1, FAIL, "Hstartbitread");
+        ret = Hbitreadv(bitid1, widths[w], 1, &inbuf2[0]);
+        VERIFY_VOID(ret, 1, "Hbitreadv");
+        ret = Hbitreadv(bitid1, widths[w], BUFSIZE - 1, &inbuf2[1]);
+        VERIFY_VOID(ret, BUFSIZE - 1, "Hbitreadv");
+        ret = Hbitreadv(bitid1, widths[w], 1, &tempbuf);
+        VERIFY_VOID(ret, 0, "Hbitreadv");
+        ret = Hendbitaccess(bitid1, 0);
+        RESULT("Hbitendaccess");
+
+        for (i = 0; i < BUFSIZE; i++)
+            if (inbuf2[i] != (outbuf2[i] & maskbuf[widths[w]])) {
+                printf("Error in vector bit I/O: value %d of %d bits is %lu, should be %lu\n", i, widths[w],
+                       (unsigned long)inbuf2[i], (unsigned long)(outbuf2[i] & maskbuf[widths[w]]));
+                num_errs++;
+                break;
+            } /* end if */
+    }         /* end for */
+
+    ret = Hclose(fid);
+    RESULT("Hclose");
+} /* test_bitio_vector() */
+
 void
 test_bitio(void)
 {
     test_bitio_read();
     test_bitio_write();
     test_bitio_seek();
+    test_bitio_vector();
 }
@@ -26,7 +26,7 @@ test_hblocks(void)
     int32  fid, fid1;
     int32  aid, aid1, aid2;
     int32  fileid, length, offset, posn;
-    uint16 tag, ref;
+    uint16 tag, ref, conv_ref;
     int16  acc_mode, special;
     int    i;
     int32  ret;
@@ -117,6 +117,22 @@ test_hblocks(void)
     ret = Hendaccess(aid1);
     CHECK_VOID(ret, FAIL, "Hendaccess");
 
+    MESSAGE(5, printf("Create a Linked Block element with missing blocks\n"););
+    aid1 = HLcreate(fid, 1020, 3, 128, 4);
+    CHECK_VOID(aid1, FAIL, "HLcreate");
+
+    ret = Hseek(aid1, 2000, DF_START);
+    CHECK_VOID(ret, FAIL, "Hseek");
+
+    ret = Hwrite(aid1, 100, outbuf);
+    if (ret != 100) {
+        fprintf(stderr, "ERROR: Hwrite returned the wrong length: %d\n", (int)ret);
+        errors++;
+    }
+
+    ret = Hendaccess(aid1);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
     MESSAGE(5, printf("Closing and re-opening file %s\n", TESTFILE_NAME););
     ret = Hclose(fid);
     CHECK_VOID(ret, FAIL, "Hclose");
@@ -191,6 +207,70 @@ test_hblocks(void)
         errors++;
     }
 
+    MESSAGE(5, printf("Reading Linked Block elements from late offsets\n"););
+    aid = Hstartread(fid, 1020, 2);
+    CHECK_VOID(aid, FAIL, "Hstartread");
+
+    /* across the blocks of several block tables */
+    ret = Hseek(aid, 3000, DF_START);
+    CHECK_VOID(ret, FAIL, "Hseek");
+
+    ret = Hread(aid, 700, inbuf);
+    if (ret != 700) {
+        fprintf(stderr, "ERROR: Hread returned the wrong length: %d\n", (int)ret);
+        errors++;
+    }
+    if (memcmp(inbuf, &outbuf[3000], 700)) {
+        fprintf(stderr, "ERROR: Hread returned the wrong data at offset 3000\n");
+        errors++;
+    }
+
+    /* back to an earlier block table, reading up to the end */
+    ret = Hseek(aid, 130, DF_START);
+    CHECK_VOID(ret, FAIL, "Hseek");
+
+    ret = Hread(aid, BUFSIZE, inbuf);
+    if (ret != BUFSIZE - 130) {
+        fprintf(stderr, "ERROR: Hread returned the wrong length: %d\n", (int)ret);
+        errors++;
+    }
+    if (memcmp(inbuf, &outbuf[130], BUFSIZE - 130)) {
+        fprintf(stderr, "ERROR: Hread returned the wrong data at offset 130\n");
+        errors++;
+    }
+
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    /* the missing blocks read as zeros */
+    aid = Hstartread(fid, 1020, 3);
+    CHECK_VOID(aid, FAIL, "Hstartread");
+
+    ret = Hread(aid, 0, inbuf);
+    if (ret != 2100) {
+        fprintf(stderr, "ERROR: Hread returned the wrong length: %d\n", (int)ret);
+        errors++;
+    }
+    for (i = 0; i < 2000; i++)
+        if (inbuf[i] != 0) {
+            fprintf(stderr, "ERROR: Hread returned %d in a missing block at %d\n", inbuf[i], i);
+            errors++;
+            break;
+        }
+    if (memcmp(&inbuf[2000], outbuf, 100)) {
+        fprintf(stderr, "ERROR: Hread returned the wrong data after the missing blocks\n");
+        errors++;
+    }
+
+    ret = Htell(aid);
+    if (ret != 2100) {
+        fprintf(stderr, "ERROR: Htell returned the wrong position: %d\n", (int)ret);
+        errors++;
+    }
+
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
     MESSAGE(5, printf("Writing to existing element\n"););
     aid2 = Hstartwrite(fid, 1000, 1, 4);
     CHECK_VOID(aid2, FAIL, "Hstartwrite");
@@ -234,6 +314,7 @@ test_hblocks(void)
 
     ref = Hnewref(fid);
     CHECK_VOID(ret, FAIL, "Hnewref");
+    conv_ref = ref;
 
     aid = Hstartwrite(fid, HLCONVERT_TAG, ref, 5);
     CHECK_VOID(aid, FAIL, "Hstartwrite");
@@ -267,5 +348,82 @@ test_hblocks(void)
         errors++;
     }
 
+    MESSAGE(5, printf("Testing HLcompact function\n"););
+    fid = Hopen(TESTFILE_NAME, DFACC_WRITE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    ret = HLcompact(fid, 1020, 2);
+    CHECK_VOID(ret, FAIL, "HLcompact");
+
+    /* a plain element now, with the same data */
+    aid = Hstartread(fid, 1020, 2);
+    CHECK_VOID(aid, FAIL, "Hstartread");
+
+    ret = Hinquire(aid, &fileid, &tag, &ref, &length, &offset, &posn, &acc_mode, &special);
+    CHECK_VOID(ret, FAIL, "Hinquire");
+    if (special || length != BUFSIZE) {
+        fprintf(stderr, "ERROR: HLcompact left special %d, length %d\n", (int)special, (int)length);
+        errors++;
+    }
+
+    ret = Hread(aid, BUFSIZE, inbuf);
+    if (ret != BUFSIZE || memcmp(inbuf, outbuf, BUFSIZE)) {
+        fprintf(stderr, "ERROR: Hread returned the wrong data after HLcompact\n");
+        errors++;
+    }
+
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    /* the other linked block elements get compacted on close */
+    ret = Hsetcompact(fid, TRUE);
+    CHECK_VOID(ret, FAIL, "Hsetcompact");
+
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    fid = Hopen(TESTFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    if (Hnumber(fid, DFTAG_LINKED) != 0) {
+        fprintf(stderr, "ERROR: linked blocks left after compacting on close\n");
+        errors++;
+    }
+
+    aid = Hstartread(fid, 1020, 3);
+    CHECK_VOID(aid, FAIL, "Hstartread");
+
+    ret = Hinquire(aid, &fileid, &tag, &ref, &length, &offset, &posn, &acc_mode, &special);
+    CHECK_VOID(ret, FAIL, "Hinquire");
+    if (special || length != 2100) {
+        fprintf(stderr, "ERROR: compacting on close left special %d, length %d\n", (int)special,
+                (int)length);
+        errors++;
+    }
+
+    ret = Hread(aid, 2100, inbuf);
+    if (ret != 2100 || memcmp(&inbuf[2000], outbuf, 100)) {
+        fprintf(stderr, "ERROR: Hread returned the wrong data after compacting on close\n");
+        errors++;
+    }
+    for (i = 0; i < 2000; i++)
+        if (inbuf[i] != 0) {
+            fprintf(stderr, "ERROR: Hread returned %d in a compacted missing block at %d\n", inbuf[i], i);
+            errors++;
+            break;
+        }
+
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    ret = Hgetelement(fid, HLCONVERT_TAG, conv_ref, inbuf);
+    if (ret != 512 || memcmp(inbuf, outbuf, 512)) {
+        fprintf(stderr, "ERROR: HLconvert element wrong after compacting on close\n");
+        errors++;
+    }
+
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
     num_errs += errors; /* increment global error count */
 }
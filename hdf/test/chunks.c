@@ -90,6 +90,13 @@
  *       where each chunk is 1x1x4= 4 bytes , total data size 24 bytes
  *       The element is compressed using RLE scheme.
  *
+ *    13. Create a 2-D element with many small chunks and grow the chunk
+ *       cache while chunks are cached, so that its page hash table is
+ *       resized.
+ *       Set dimension to 96x96 array with 2,304 chunks of 2x2 = 4 bytes.
+ *       Half the data is written with 48 chunks cached, the rest after
+ *       raising the cache to all 2,304 chunks.
+ *
  *  For all the tests the data is read back in and verified.
  *
  *  Routines tested using User level H-level calls:
@@ -2193,6 +2200,194 @@ test_chunks(void)
     ret = Hclose(fid);
     CHECK_VOID(ret, FAIL, "Hclose");
 
+    /*
+      13. Create a 2-D element with many small chunks and grow the
+      chunk cache while chunks are cached.
+      Set dimension to 96x96 array with 2304 chunks where each chunk is 2x2.
+      */
+    chunk[0].num_dims   = 2;                /* 2-D */
+    chunk[0].chunk_size = 4;                /* 2x2 = 4 bytes */
+    chunk[0].nt_size    = 1;                /* number type size */
+    chunk[0].chunk_flag = 0;                /* nothing set */
+    chunk[0].comp_type  = COMP_CODE_NONE;   /* nothing set */
+    chunk[0].model_type = COMP_MODEL_STDIO; /* nothing set */
+    chunk[0].cinfo      = NULL;             /* nothing set */
+    chunk[0].minfo      = NULL;             /* nothing set */
+
+    chunk[0].pdims[0].dim_length   = 96;
+    chunk[0].pdims[0].chunk_length = 2;
+    chunk[0].pdims[0].distrib_type = 1;
+
+    chunk[0].pdims[1].dim_length   = 96;
+    chunk[0].pdims[1].chunk_length = 2;
+    chunk[0].pdims[1].distrib_type = 1;
+
+    fill_val_u8  = 0;
+    fill_val_len = 1;
+
+    fid = Hopen(TESTFILE_NAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    MESSAGE(5, printf("Test 13. Create a 2-D, uint8 chunked element with 2304 chunks\n"););
+
+    /* Create element     tag, ref,  nlevels, fill_len, fill, chunk array */
+    aid1 = HMCcreate(fid, 1020, 23, 1, fill_val_len, &fill_val_u8, (HCHUNK_DEF *)chunk);
+    CHECK_VOID(aid1, FAIL, "HMCcreate");
+
+    /* cache one row of chunks while writing the first half */
+    ret = HMCsetMaxcache(aid1, 48, 0);
+    VERIFY_VOID(ret, 48, "HMCsetMaxcache");
+
+    ret = Hwrite(aid1, 4608, outbuf);
+    VERIFY_VOID(ret, 4608, "Hwrite");
+
+    /* then cache all the chunks, with a row of them cached */
+    MESSAGE(5, printf("Set max # of chunks to cache for chunked element to 2304 \n"););
+    ret = HMCsetMaxcache(aid1, 2304, 0);
+    VERIFY_VOID(ret, 2304, "HMCsetMaxcache");
+
+    ret = Hwrite(aid1, 4608, outbuf + 4608);
+    VERIFY_VOID(ret, 4608, "Hwrite");
+
+    /* read everything back through the cache before it is flushed */
+    ret = Hseek(aid1, 0, DF_START);
+    CHECK_VOID(ret, FAIL, "Hseek");
+
+    memset(inbuf, 0, 9216);
+    ret = Hread(aid1, 9216, inbuf);
+    VERIFY_VOID(ret, 9216, "Hread");
+
+    ret = Hendaccess(aid1);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    MESSAGE(5, printf("Verifying 9216 bytes of data\n"););
+    for (i = 0; i < 9216; i++) {
+        if (inbuf[i] != outbuf[i]) {
+            printf("Wrong data at %d, out %d in %d\n", i, outbuf[i], inbuf[i]);
+            errors++;
+            break;
+        }
+    }
+
+    /* and once more from the file */
+    aid1 = Hstartread(fid, 1020, 23);
+    CHECK_VOID(aid1, FAIL, "Hstartread");
+
+    memset(inbuf, 0, 9216);
+    ret = Hread(aid1, 9216, inbuf);
+    VERIFY_VOID(ret, 9216, "Hread");
+
+    ret = Hendaccess(aid1);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    for (i = 0; i < 9216; i++) {
+        if (inbuf[i] != outbuf[i]) {
+            printf("Wrong data at %d, out %d in %d\n", i, outbuf[i], inbuf[i]);
+            errors++;
+            break;
+        }
+    }
+
+    MESSAGE(5, printf("Closing the file\n"););
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /*
+      14. Create a 1-D element with more chunks than are added to the
+      chunk table at once, 6144 chunks where each chunk is 2 bytes.
+      */
+    chunk[0].num_dims              = 1;
+    chunk[0].chunk_size            = 2;
+    chunk[0].pdims[0].dim_length   = BUFSIZE;
+    chunk[0].pdims[0].chunk_length = 2;
+    chunk[0].pdims[0].distrib_type = 1;
+
+    fid = Hopen(TESTFILE_NAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    MESSAGE(5, printf("Test 14. Create a 1-D, uint8 chunked element with 6144 chunks\n"););
+
+    aid1 = HMCcreate(fid, 1020, 24, 1, fill_val_len, &fill_val_u8, (HCHUNK_DEF *)chunk);
+    CHECK_VOID(aid1, FAIL, "HMCcreate");
+
+    ret = Hwrite(aid1, BUFSIZE, outbuf);
+    VERIFY_VOID(ret, BUFSIZE, "Hwrite");
+
+    ret = Hendaccess(aid1);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    aid1 = Hstartread(fid, 1020, 24);
+    CHECK_VOID(aid1, FAIL, "Hstartread");
+
+    /* part of a chunk first, through the chunk cache */
+    memset(inbuf, 0, BUFSIZE);
+    ret = Hseek(aid1, 3, DF_START);
+    CHECK_VOID(ret, FAIL, "Hseek");
+    ret = Hread(aid1, 6, inbuf + 3);
+    VERIFY_VOID(ret, 6, "Hread");
+
+    /* then the whole chunks, read straight into the buffer but the
+       cached ones */
+    ret = Hseek(aid1, 0, DF_START);
+    CHECK_VOID(ret, FAIL, "Hseek");
+    ret = Hread(aid1, BUFSIZE, inbuf);
+    VERIFY_VOID(ret, BUFSIZE, "Hread");
+
+    ret = Hendaccess(aid1);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    MESSAGE(5, printf("Verifying %d bytes of data\n", BUFSIZE););
+    for (i = 0; i < BUFSIZE; i++) {
+        if (inbuf[i] != outbuf[i]) {
+            printf("Wrong data at %d, out %d in %d\n", i, outbuf[i], inbuf[i]);
+            errors++;
+            break;
+        }
+    }
+
+    /* overwrite the whole chunks with other data, which does not read
+       them in, then part of a chunk, which does */
+    for (i = 0; i < BUFSIZE; i++)
+        inbuf[i] = (uint8)(255 - outbuf[i]);
+
+    aid1 = Hstartwrite(fid, 1020, 24, BUFSIZE);
+    CHECK_VOID(aid1, FAIL, "Hstartwrite");
+
+    ret = Hwrite(aid1, BUFSIZE, inbuf);
+    VERIFY_VOID(ret, BUFSIZE, "Hwrite");
+
+    ret = Hseek(aid1, 1, DF_START);
+    CHECK_VOID(ret, FAIL, "Hseek");
+    ret = Hwrite(aid1, 2, outbuf + 1);
+    VERIFY_VOID(ret, 2, "Hwrite");
+
+    ret = Hendaccess(aid1);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    aid1 = Hstartread(fid, 1020, 24);
+    CHECK_VOID(aid1, FAIL, "Hstartread");
+
+    memset(inbuf, 0, BUFSIZE);
+    ret = Hread(aid1, BUFSIZE, inbuf);
+    VERIFY_VOID(ret, BUFSIZE, "Hread");
+
+    ret = Hendaccess(aid1);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    for (i = 0; i < BUFSIZE; i++) {
+        uint8 expected = (uint8)((i == 1 || i == 2) ? outbuf[i] : 255 - outbuf[i]);
+
+        if (inbuf[i] != expected) {
+            printf("Wrong data at %d, out %d in %d\n", i, expected, inbuf[i]);
+            errors++;
+            break;
+        }
+    }
+
+    MESSAGE(5, printf("Closing the file\n"););
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
 done:
     /* Don't forget to free dimensions allocate for chunk definition */
     free(chunk[0].pdims);
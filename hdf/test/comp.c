@@ -95,6 +95,11 @@ static void   free_buffers(void);
 static uint16 write_data(int32 fid, comp_model_t m_type, model_info *m_info, comp_coder_t c_type,
                          comp_info *c_info, intn test_num, int32 ntype);
 static void   read_data(int32 fid, uint16 ref_num, intn test_num, int32 ntype);
+static void   test_deflate_seek(void);
+static void   test_deflate_threads(void);
+static void   test_task_executor(void);
+static void   test_config_bufsize(void);
+static void   test_rle_pieces(void);
 
 static void
 init_model_info(comp_model_t m_type, model_info *m_info, int32 test_ntype)
@@ -377,10 +382,447 @@ read_data(int32 fid, uint16 ref_num, intn test_num, int32 ntype)
         num_errs++;
     } /* end if */
 
+    /* seek back and read the rest again in small pieces, which leaves */
+    /* some coders between pieces in the middle of a number or a code */
+    err_ret = Hseek(aid, read_size / 3, DF_START);
+    CHECK_VOID(err_ret, FAIL, "Hseek");
+    for (i = read_size / 3; i < read_size; i += err_ret) {
+        err_ret = Hread(aid, MIN(37, read_size - i), (char *)in_ptr + i);
+        if (err_ret != MIN(37, read_size - i)) {
+            fprintf(stderr, "ERROR(%d): Hread returned the wrong length: %d\n", __LINE__, (int)err_ret);
+            HEprint(stdout, 0);
+            num_errs++;
+            break;
+        } /* end if */
+    }     /* end for */
+    if (memcmp(in_ptr, out_ptr, read_size) != 0) {
+        fprintf(stderr, "ERROR: Data from test: %d read in pieces differs\n", test_num);
+        num_errs++;
+    } /* end if */
+
     err_ret = Hendaccess(aid);
     CHECK_VOID(err_ret, FAIL, "Hendaccess");
 } /* end read_data() */
 
+/* Test seeking in a deflate element written with seek points */
+#define SEEK_DATA_SIZE (1024 * 1024)
+#define SEEK_INTERVAL  (64 * 1024)
+#define SEEK_READ_SIZE 1000
+
+static void
+test_deflate_seek(void)
+{
+    comp_info   c_info;
+    model_info  m_info;
+    hdf_stats_t before, after;
+    uint8      *data, *buf;
+    int32       fid, aid, comp_size, orig_size;
+    uint16      ref;
+    int32       offsets[3] = {SEEK_DATA_SIZE - SEEK_READ_SIZE - 7, SEEK_DATA_SIZE / 2 + 11, 3};
+    intn        i;
+    int32       ret;
+
+    data = (uint8 *)malloc(SEEK_DATA_SIZE);
+    buf  = (uint8 *)malloc(SEEK_READ_SIZE);
+    CHECK_ALLOC(data, "data", "test_deflate_seek");
+    CHECK_ALLOC(buf, "buf", "test_deflate_seek");
+    for (i = 0; i < SEEK_DATA_SIZE; i++)
+        data[i] = (uint8)((i / 3) ^ (RAND() & 0x0f));
+
+    ret = HCset_deflate_seek_interval(-1);
+    VERIFY_VOID(ret, FAIL, "HCset_deflate_seek_interval");
+    ret = HCset_deflate_seek_interval(SEEK_INTERVAL);
+    CHECK_VOID(ret, FAIL, "HCset_deflate_seek_interval");
+
+    fid = Hopen(TESTFILE_NAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    ref                  = Hnewref(fid);
+    c_info.deflate.level = 6;
+    aid = HCcreate(fid, COMP_TAG, ref, COMP_MODEL_STDIO, &m_info, COMP_CODE_DEFLATE, &c_info);
+    CHECK_VOID(aid, FAIL, "HCcreate");
+    ret = Hwrite(aid, SEEK_DATA_SIZE / 2 + 5, data);
+    VERIFY_VOID(ret, SEEK_DATA_SIZE / 2 + 5, "Hwrite");
+    ret = Hwrite(aid, SEEK_DATA_SIZE - (SEEK_DATA_SIZE / 2 + 5), data + SEEK_DATA_SIZE / 2 + 5);
+    VERIFY_VOID(ret, SEEK_DATA_SIZE - (SEEK_DATA_SIZE / 2 + 5), "Hwrite");
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    VERIFY_VOID(Hnumber(fid, DFTAG_CMPSEEK), 1, "Hnumber");
+
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* Each seek only inflates from the seek point before it */
+    fid = Hopen(TESTFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = HCPgetdatasize(fid, COMP_TAG, ref, &comp_size, &orig_size);
+    CHECK_VOID(ret, FAIL, "HCPgetdatasize");
+
+    aid = Hstartread(fid, COMP_TAG, ref);
+    CHECK_VOID(aid, FAIL, "Hstartread");
+    for (i = 0; i < 3; i++) {
+        ret = Hgetstats(fid, &before);
+        CHECK_VOID(ret, FAIL, "Hgetstats");
+        ret = Hseek(aid, offsets[i], DF_START);
+        CHECK_VOID(ret, FAIL, "Hseek");
+        ret = Hread(aid, SEEK_READ_SIZE, buf);
+        VERIFY_VOID(ret, SEEK_READ_SIZE, "Hread");
+        ret = Hgetstats(fid, &after);
+        CHECK_VOID(ret, FAIL, "Hgetstats");
+        if (memcmp(buf, data + offsets[i], SEEK_READ_SIZE) != 0) {
+            printf("Error! data read at offset %ld is wrong\n", (long)offsets[i]);
+            num_errs++;
+        } /* end if */
+        if (after.bytes_read - before.bytes_read > (uint32)comp_size / 4) {
+            printf("Error! %lu bytes read to seek to offset %ld of a %ld byte stream\n",
+                   (unsigned long)(after.bytes_read - before.bytes_read), (long)offsets[i], (long)comp_size);
+            num_errs++;
+        } /* end if */
+    } /* end for */
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* Rewriting the element without seek points removes the old ones */
+    ret = HCset_deflate_seek_interval(0);
+    CHECK_VOID(ret, FAIL, "HCset_deflate_seek_interval");
+
+    fid = Hopen(TESTFILE_NAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    aid = Hstartwrite(fid, COMP_TAG, ref, SEEK_DATA_SIZE);
+    CHECK_VOID(aid, FAIL, "Hstartwrite");
+    ret = Hwrite(aid, SEEK_DATA_SIZE, data);
+    VERIFY_VOID(ret, SEEK_DATA_SIZE, "Hwrite");
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    VERIFY_VOID(Hnumber(fid, DFTAG_CMPSEEK), 0, "Hnumber");
+
+    aid = Hstartread(fid, COMP_TAG, ref);
+    CHECK_VOID(aid, FAIL, "Hstartread");
+    ret = Hseek(aid, offsets[0], DF_START);
+    CHECK_VOID(ret, FAIL, "Hseek");
+    ret = Hread(aid, SEEK_READ_SIZE, buf);
+    VERIFY_VOID(ret, SEEK_READ_SIZE, "Hread");
+    if (memcmp(buf, data + offsets[0], SEEK_READ_SIZE) != 0) {
+        printf("Error! data read without seek points is wrong\n");
+        num_errs++;
+    } /* end if */
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    free(buf);
+    free(data);
+} /* end test_deflate_seek() */
+
+/* Test a deflate element whose first write is deflated on worker threads */
+#define THREADS_DATA_SIZE (1024 * 1024)
+#define THREADS_APPEND    5000
+#define THREADS_NTHREADS  4
+
+static void
+test_deflate_threads(void)
+{
+    comp_info  c_info;
+    model_info m_info;
+    uint8     *data, *buf;
+    int32      fid, aid;
+    uint16     ref;
+    intn       i;
+    int32      ret;
+
+    data = (uint8 *)malloc(THREADS_DATA_SIZE + THREADS_APPEND);
+    buf  = (uint8 *)malloc(THREADS_DATA_SIZE + THREADS_APPEND);
+    CHECK_ALLOC(data, "data", "test_deflate_threads");
+    CHECK_ALLOC(buf, "buf", "test_deflate_threads");
+    for (i = 0; i < THREADS_DATA_SIZE + THREADS_APPEND; i++)
+        data[i] = (uint8)((i / 5) ^ (RAND() & 0x03));
+
+    ret = HCset_deflate_threads(0);
+    VERIFY_VOID(ret, FAIL, "HCset_deflate_threads");
+    ret = HCset_deflate_threads(THREADS_NTHREADS);
+    VERIFY_VOID(ret, 1, "HCset_deflate_threads");
+
+    /* the write that starts the stream is deflated in blocks, the one
+       appended after it serially */
+    fid = Hopen(TESTFILE_NAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ref                  = Hnewref(fid);
+    c_info.deflate.level = 6;
+    aid = HCcreate(fid, COMP_TAG, ref, COMP_MODEL_STDIO, &m_info, COMP_CODE_DEFLATE, &c_info);
+    CHECK_VOID(aid, FAIL, "HCcreate");
+    ret = Hwrite(aid, THREADS_DATA_SIZE, data);
+    VERIFY_VOID(ret, THREADS_DATA_SIZE, "Hwrite");
+    ret = Hwrite(aid, THREADS_APPEND, data + THREADS_DATA_SIZE);
+    VERIFY_VOID(ret, THREADS_APPEND, "Hwrite");
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    ret = HCset_deflate_threads(1);
+    VERIFY_VOID(ret, THREADS_NTHREADS, "HCset_deflate_threads");
+
+    /* read back whole, and from the middle of a block */
+    fid = Hopen(TESTFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    aid = Hstartread(fid, COMP_TAG, ref);
+    CHECK_VOID(aid, FAIL, "Hstartread");
+    ret = Hread(aid, THREADS_DATA_SIZE + THREADS_APPEND, buf);
+    VERIFY_VOID(ret, THREADS_DATA_SIZE + THREADS_APPEND, "Hread");
+    if (memcmp(buf, data, THREADS_DATA_SIZE + THREADS_APPEND) != 0) {
+        printf("Error! data deflated on threads is wrong\n");
+        num_errs++;
+    } /* end if */
+    ret = Hseek(aid, THREADS_DATA_SIZE / 2 + 3, DF_START);
+    CHECK_VOID(ret, FAIL, "Hseek");
+    ret = Hread(aid, 1000, buf);
+    VERIFY_VOID(ret, 1000, "Hread");
+    if (memcmp(buf, data + THREADS_DATA_SIZE / 2 + 3, 1000) != 0) {
+        printf("Error! data deflated on threads read after a seek is wrong\n");
+        num_errs++;
+    } /* end if */
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    free(buf);
+    free(data);
+} /* end test_deflate_threads() */
+
+/* Test the parallel work of the library handed to an executor of the
+   application, here one running the tasks in turn */
+static intn executor_calls;
+
+static intn
+test_executor(void *user_data, int32 ntasks, intn nthreads, void (*task)(void *arg, int32 i), void *arg)
+{
+    int32 i;
+
+    if (user_data != &executor_calls || nthreads < 2 || nthreads > THREADS_NTHREADS - 1)
+        return FAIL;
+    executor_calls++;
+    for (i = ntasks - 1; i >= 0; i--)
+        (*task)(arg, i);
+    return SUCCEED;
+} /* end test_executor() */
+
+static void
+test_task_executor(void)
+{
+    comp_info  c_info;
+    model_info m_info;
+    uint8     *data, *buf;
+    intn       cpu = 0;
+    int32      fid, aid;
+    uint16     ref;
+    intn       i;
+    int32      ret, prev;
+
+    data = (uint8 *)malloc(THREADS_DATA_SIZE);
+    buf  = (uint8 *)malloc(THREADS_DATA_SIZE);
+    CHECK_ALLOC(data, "data", "test_task_executor");
+    CHECK_ALLOC(buf, "buf", "test_task_executor");
+    for (i = 0; i < THREADS_DATA_SIZE; i++)
+        data[i] = (uint8)((i / 7) ^ (RAND() & 0x03));
+
+    ret = Hsettaskthreads(-1);
+    VERIFY_VOID(ret, FAIL, "Hsettaskthreads");
+    prev = Hsettaskthreads(THREADS_NTHREADS - 1);
+    CHECK_VOID(prev, FAIL, "Hsettaskthreads");
+    ret = Hsettaskaffinity(NULL, 1);
+    VERIFY_VOID(ret, FAIL, "Hsettaskaffinity");
+    ret = Hsettaskaffinity(&cpu, -1);
+    VERIFY_VOID(ret, FAIL, "Hsettaskaffinity");
+    ret = Hsettaskaffinity(NULL, 0);
+    CHECK_VOID(ret, FAIL, "Hsettaskaffinity");
+    ret = Hsettaskexecutor(test_executor, &executor_calls);
+    CHECK_VOID(ret, FAIL, "Hsettaskexecutor");
+    ret = HCset_deflate_threads(THREADS_NTHREADS);
+    CHECK_VOID(ret, FAIL, "HCset_deflate_threads");
+
+    /* the threads asked for are capped, and the blocks deflated on the
+       executor in reverse order */
+    executor_calls = 0;
+    fid            = Hopen(TESTFILE_NAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ref                  = Hnewref(fid);
+    c_info.deflate.level = 6;
+    aid = HCcreate(fid, COMP_TAG, ref, COMP_MODEL_STDIO, &m_info, COMP_CODE_DEFLATE, &c_info);
+    CHECK_VOID(aid, FAIL, "HCcreate");
+    ret = Hwrite(aid, THREADS_DATA_SIZE, data);
+    VERIFY_VOID(ret, THREADS_DATA_SIZE, "Hwrite");
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+    if (executor_calls == 0) {
+        printf("Error! the executor was not called\n");
+        num_errs++;
+    } /* end if */
+
+    ret = HCset_deflate_threads(1);
+    CHECK_VOID(ret, FAIL, "HCset_deflate_threads");
+    ret = Hsettaskexecutor(NULL, NULL);
+    CHECK_VOID(ret, FAIL, "Hsettaskexecutor");
+    ret = Hsettaskthreads((intn)prev);
+    VERIFY_VOID(ret, THREADS_NTHREADS - 1, "Hsettaskthreads");
+
+    fid = Hopen(TESTFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    aid = Hstartread(fid, COMP_TAG, ref);
+    CHECK_VOID(aid, FAIL, "Hstartread");
+    ret = Hread(aid, THREADS_DATA_SIZE, buf);
+    VERIFY_VOID(ret, THREADS_DATA_SIZE, "Hread");
+    if (memcmp(buf, data, THREADS_DATA_SIZE) != 0) {
+        printf("Error! data deflated on the executor is wrong\n");
+        num_errs++;
+    } /* end if */
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    free(buf);
+    free(data);
+} /* end test_task_executor() */
+
+/* Test a deflate element written and read through the I/O buffer size
+   given by Hsetconfig() */
+#define CONFIG_DATA_SIZE 20000
+#define CONFIG_BUFSIZE   100
+
+static void
+test_config_bufsize(void)
+{
+    comp_info  c_info;
+    model_info m_info;
+    uint8     *data, *buf;
+    int32      fid, aid;
+    uint16     ref;
+    intn       i;
+    int32      ret;
+
+    data = (uint8 *)malloc(CONFIG_DATA_SIZE);
+    buf  = (uint8 *)malloc(CONFIG_DATA_SIZE);
+    CHECK_ALLOC(data, "data", "test_config_bufsize");
+    CHECK_ALLOC(buf, "buf", "test_config_bufsize");
+    for (i = 0; i < CONFIG_DATA_SIZE; i++)
+        data[i] = (uint8)(RAND() & 0xff);
+
+    ret = Hsetconfig(HDF_CONFIG_NSETTINGS, 1);
+    VERIFY_VOID(ret, FAIL, "Hsetconfig");
+    ret = Hsetconfig(HDF_CONFIG_DEFLATE_BUFSIZE, -1);
+    VERIFY_VOID(ret, FAIL, "Hsetconfig");
+    ret = Hgetconfig(HDF_CONFIG_NSETTINGS);
+    VERIFY_VOID(ret, FAIL, "Hgetconfig");
+    ret = Hsetconfig(HDF_CONFIG_DEFLATE_BUFSIZE, CONFIG_BUFSIZE);
+    CHECK_VOID(ret, FAIL, "Hsetconfig");
+    ret = Hgetconfig(HDF_CONFIG_DEFLATE_BUFSIZE);
+    VERIFY_VOID(ret, CONFIG_BUFSIZE, "Hgetconfig");
+
+    /* random data deflates to more than many small buffers */
+    fid = Hopen(TESTFILE_NAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ref                  = Hnewref(fid);
+    c_info.deflate.level = 6;
+    aid = HCcreate(fid, COMP_TAG, ref, COMP_MODEL_STDIO, &m_info, COMP_CODE_DEFLATE, &c_info);
+    CHECK_VOID(aid, FAIL, "HCcreate");
+    ret = Hwrite(aid, CONFIG_DATA_SIZE, data);
+    VERIFY_VOID(ret, CONFIG_DATA_SIZE, "Hwrite");
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    aid = Hstartread(fid, COMP_TAG, ref);
+    CHECK_VOID(aid, FAIL, "Hstartread");
+    ret = Hread(aid, CONFIG_DATA_SIZE, buf);
+    VERIFY_VOID(ret, CONFIG_DATA_SIZE, "Hread");
+    if (memcmp(buf, data, CONFIG_DATA_SIZE) != 0) {
+        printf("Error! data deflated through a small buffer is wrong\n");
+        num_errs++;
+    } /* end if */
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    ret = Hsetconfig(HDF_CONFIG_DEFLATE_BUFSIZE, 0);
+    VERIFY_VOID(ret, CONFIG_BUFSIZE, "Hsetconfig");
+
+    free(buf);
+    free(data);
+} /* end test_config_bufsize() */
+
+/* Test RLE elements written whole and in pieces of all sizes: runs and
+   mixes of every length up to past their limits, starting anywhere in the
+   pieces and in the blocks the encoder searches at once, are encoded the
+   same */
+#define RLE_DATA_SIZE 60000
+
+static void
+test_rle_pieces(void)
+{
+    comp_info  c_info;
+    model_info m_info;
+    uint8     *data, *buf;
+    int32      fid, aid, comp_size[2], orig_size;
+    uint16     ref[2];
+    int32      pos, piece, len;
+    intn       i, w;
+    int32      ret;
+
+    data = (uint8 *)malloc(RLE_DATA_SIZE);
+    buf  = (uint8 *)malloc(RLE_DATA_SIZE);
+    CHECK_ALLOC(data, "data", "test_rle_pieces");
+    CHECK_ALLOC(buf, "buf", "test_rle_pieces");
+
+    /* runs of 1 to 200 bytes between mixes of 0 to 150 bytes, the mixes
+       sometimes ending in a pair of the byte of the run */
+    for (pos = 0, len = 1; pos < RLE_DATA_SIZE; len = len % 200 + 1) {
+        for (i = 0; i < len && pos < RLE_DATA_SIZE; i++)
+            data[pos++] = (uint8)len;
+        for (i = 0; i < (len * 7) % 151 && pos < RLE_DATA_SIZE; i++)
+            data[pos++] = (uint8)(i % 2 == 0 || len % 3 == 0 ? RAND() : len + 1);
+    } /* end for */
+
+    fid = Hopen(TESTFILE_NAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    for (w = 0; w < 2; w++) {
+        ref[w] = Hnewref(fid);
+        aid    = HCcreate(fid, COMP_TAG, ref[w], COMP_MODEL_STDIO, &m_info, COMP_CODE_RLE, &c_info);
+        CHECK_VOID(aid, FAIL, "HCcreate");
+        for (pos = 0, piece = 1; pos < RLE_DATA_SIZE; pos += len, piece = piece % 97 + 1) {
+            len = (w == 0) ? RLE_DATA_SIZE : MIN(piece, RLE_DATA_SIZE - pos);
+            ret = Hwrite(aid, len, data + pos);
+            VERIFY_VOID(ret, len, "Hwrite");
+        } /* end for */
+        ret = Hendaccess(aid);
+        CHECK_VOID(ret, FAIL, "Hendaccess");
+
+        aid = Hstartread(fid, COMP_TAG, ref[w]);
+        CHECK_VOID(aid, FAIL, "Hstartread");
+        ret = Hread(aid, RLE_DATA_SIZE, buf);
+        VERIFY_VOID(ret, RLE_DATA_SIZE, "Hread");
+        if (memcmp(buf, data, RLE_DATA_SIZE) != 0) {
+            printf("Error! RLE data written in %s is wrong\n", w == 0 ? "one piece" : "pieces");
+            num_errs++;
+        } /* end if */
+        ret = Hendaccess(aid);
+        CHECK_VOID(ret, FAIL, "Hendaccess");
+        ret = HCPgetdatasize(fid, COMP_TAG, ref[w], &comp_size[w], &orig_size);
+        CHECK_VOID(ret, FAIL, "HCPgetdatasize");
+    } /* end for */
+    VERIFY_VOID(comp_size[1], comp_size[0], "HCPgetdatasize");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    free(buf);
+    free(data);
+} /* end test_rle_pieces() */
+
 void
 test_comp(void)
 {
@@ -439,5 +881,11 @@ test_comp(void)
     /* free the input and output buffers */
     free_buffers();
 
+    test_deflate_seek();
+    test_deflate_threads();
+    test_task_executor();
+    test_config_bufsize();
+    test_rle_pieces();
+
     MESSAGE(6, printf("Finished compression test\n");)
 } /* end test_comp() */
@@ -70,6 +70,71 @@ static const char *test_name[] = {"Big-Endian", "Little-Endian", "Native"};
 /* close enough */
 #define EPS64 ((float64)1.0E-14)
 #define EPS32 ((float32)1.0E-7)
+
+/* Checks the byte order conversion of contiguous 2, 4 and 8 byte items,
+   which is done with vector instructions where they are available, for
+   counts leaving all possible remainders, unaligned and in place, and
+   of strided items */
+static void
+test_swap(void)
+{
+    static const int32 swap_type[] = {DFNT_INT16, DFNT_INT32, DFNT_FLOAT64};
+    uint8              src[8 * 70 + 1], dst[8 * 70 + 1], buf[8 * 70 + 1];
+    intn               size, nelm, off, i, j;
+    intn               t;
+    int32              type;
+    int32              ret;
+
+    for (t = 0; t < 3; t++) {
+        size = (intn)(2 << t);
+#ifdef H4_WORDS_BIGENDIAN
+        type = DFNT_LITEND | swap_type[t];
+#else
+        type = swap_type[t];
+#endif
+        MESSAGE(6, printf("swapping %d byte items\n", (int)size););
+        for (nelm = 1; nelm <= 70; nelm++)
+            for (off = 0; off < 2; off++) {
+                for (i = 0; i < nelm * size; i++)
+                    src[off + i] = (uint8)(i * 7 + nelm);
+                memcpy(buf + off, src + off, (size_t)(nelm * size));
+
+                ret = DFKconvert((void *)(src + off), (void *)(dst + off), type, nelm, DFACC_READ, 0, 0);
+                RESULT("DFKconvert");
+                ret = DFKconvert((void *)(buf + off), (void *)(buf + off), type, nelm, DFACC_READ, 0, 0);
+                RESULT("DFKconvert");
+
+                for (i = 0; i < nelm; i++)
+                    for (j = 0; j < size; j++)
+                        if (dst[off + i * size + j] != src[off + i * size + size - 1 - j] ||
+                            buf[off + i * size + j] != src[off + i * size + size - 1 - j]) {
+                            printf("Error swapping %d %d byte items at offset %d!\n", (int)nelm, (int)size,
+                                   (int)off);
+                            num_errs++;
+                            return;
+                        }
+            }
+
+        /* every other item into a packed array, and in place */
+        for (i = 0; i < 70 * size; i++)
+            src[i] = buf[i] = (uint8)(i * 5 + 3);
+        ret = DFKconvert((void *)src, (void *)dst, type, 35, DFACC_READ, (uint32)(2 * size), (uint32)size);
+        RESULT("DFKconvert");
+        ret = DFKconvert((void *)buf, (void *)buf, type, 35, DFACC_READ, (uint32)(2 * size),
+                         (uint32)(2 * size));
+        RESULT("DFKconvert");
+        for (i = 0; i < 35; i++)
+            for (j = 0; j < size; j++)
+                if (dst[i * size + j] != src[2 * i * size + size - 1 - j] ||
+                    buf[2 * i * size + j] != src[2 * i * size + size - 1 - j] ||
+                    buf[(2 * i + 1) * size + j] != src[(2 * i + 1) * size + j]) {
+                    printf("Error swapping strided %d byte items!\n", (int)size);
+                    num_errs++;
+                    return;
+                }
+    }
+} /* end test_swap() */
+
 void
 test_conv(void)
 {
@@ -763,4 +828,5 @@ test_conv(void)
         free(dst2_float64);
     } /* end for */
 
+    test_swap();
 } /* end test_conv() */
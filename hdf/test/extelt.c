@@ -17,7 +17,11 @@
  */
 #include "tproto.h"
 #define TESTFILE_NAME  "t.hdf"                  /* file for first 4 series of tests */
-#define TESTFILE_NAME1 "tx.hdf"                 /* file for last test */
+#define TESTFILE_NAME1 "tx.hdf"                 /* file for path tests */
+#define TESTFILE_NAME2 "txcache.hdf"            /* file for the external file cache tests */
+#define EXTFILE_NAME2  "t6.hdf"                 /* its external file */
+#define CACHE_NELEMS   8                        /* # of its elements */
+#define CACHE_ELEMLEN  256                      /* length of each */
 #define STRING         "element 1000 2"         /* 14 bytes */
 #define STRING2        "element 1000 1   wrong" /* 22 bytes */
 #define STRING3        "element 1000 1 correct" /* 22 bytes */
@@ -34,7 +38,7 @@ test_hextelt(void)
     int32  fileid, length, offset, posn;
     uint16 tag, ref;
     int16  acc_mode, special;
-    int    i;
+    int    i, j;
     int32  ret;
     intn   errflag = 0;
     intn   errors  = 0;
@@ -390,5 +394,73 @@ test_hextelt(void)
     ret = HXsetdir(NULL);
     CHECK_VOID(ret, FAIL, "HXsetdir");
 
+    /*==============================*/
+    MESSAGE(5, printf("testing the cache of external files\n"););
+
+    /* elements side by side in one external file, which stays open */
+    fid = Hopen(TESTFILE_NAME2, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    for (i = 0; i < CACHE_NELEMS; i++) {
+        aid1 = HXcreate(fid, 1000, (uint16)(i + 1), EXTFILE_NAME2, (int32)(i * CACHE_ELEMLEN), (int32)0);
+        CHECK_VOID(aid1, FAIL, "HXcreate");
+        ret = Hwrite(aid1, CACHE_ELEMLEN, outbuf + i * CACHE_ELEMLEN);
+        CHECK_VOID(ret, FAIL, "Hwrite");
+        ret = Hendaccess(aid1);
+        CHECK_VOID(ret, FAIL, "Hendaccess");
+    }
+
+    /* the data is flushed once the elements are no longer accessed */
+    {
+        FILE *f = fopen(EXTFILE_NAME2, "rb");
+
+        if (f == NULL || fread(inbuf, 1, CACHE_NELEMS * CACHE_ELEMLEN, f) != CACHE_NELEMS * CACHE_ELEMLEN ||
+            memcmp(inbuf, outbuf, CACHE_NELEMS * CACHE_ELEMLEN) != 0) {
+            fprintf(stderr, "Error: External file %s not flushed\n", EXTFILE_NAME2);
+            errors++;
+        }
+        if (f != NULL)
+            fclose(f);
+    }
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* the file opened read-only is reopened for writing when needed */
+    fid = Hopen(TESTFILE_NAME2, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hgetelement(fid, (uint16)1000, (uint16)1, inbuf);
+    VERIFY_VOID(ret, CACHE_ELEMLEN, "Hgetelement");
+    aid1 = Hstartwrite(fid, (uint16)1000, (uint16)2, CACHE_ELEMLEN);
+    CHECK_VOID(aid1, FAIL, "Hstartwrite");
+    ret = Hwrite(aid1, CACHE_ELEMLEN, outbuf + CACHE_NELEMS * CACHE_ELEMLEN);
+    CHECK_VOID(ret, FAIL, "Hwrite");
+    ret = Hendaccess(aid1);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+    memcpy(outbuf + CACHE_ELEMLEN, outbuf + CACHE_NELEMS * CACHE_ELEMLEN, CACHE_ELEMLEN);
+
+    /* the elements read back the same with and without the cache */
+    ret = HXsetfilecache(-1);
+    VERIFY_VOID(ret, FAIL, "HXsetfilecache");
+    for (j = 0; j < 2; j++) {
+        ret = HXsetfilecache(j == 0 ? 16 : 0);
+        CHECK_VOID(ret, FAIL, "HXsetfilecache");
+        fid = Hopen(TESTFILE_NAME2, DFACC_READ, 0);
+        CHECK_VOID(fid, FAIL, "Hopen");
+        for (i = CACHE_NELEMS - 1; i >= 0; i--) {
+            ret = Hgetelement(fid, (uint16)1000, (uint16)(i + 1), inbuf);
+            VERIFY_VOID(ret, CACHE_ELEMLEN, "Hgetelement");
+            if (memcmp(inbuf, outbuf + i * CACHE_ELEMLEN, CACHE_ELEMLEN) != 0) {
+                fprintf(stderr, "Error: Wrong data in element %d of external file %s\n", i + 1,
+                        EXTFILE_NAME2);
+                errors++;
+            }
+        }
+        ret = Hclose(fid);
+        CHECK_VOID(ret, FAIL, "Hclose");
+    }
+    ret = HXsetfilecache(16);
+    CHECK_VOID(ret, FAIL, "HXsetfilecache");
+
     num_errs += errors; /* increment global error count */
 }
@@ -38,22 +38,2064 @@
    ** Normal.
    ** With illegal file id.
    ** With illegal tag/ref.
+   ** Reusing the slot of an ended access id, which stays invalid.
+   ** Ending many accesses, after which no ended id nor id 0 is valid.
    ** With wildcard.
    ** Open more access elements than there is space.
 
+   * Hfind / Hnumber
+   ** By tag and by ref, forward and backward, over several DD blocks
+      with deleted and re-used DDs, before and after re-opening the file.
+
+   * Hmmap
+   ** Read a file opened read-only through its mapping, and after unmapping.
+   ** Map a file opened for writing.
+
+   * Hsetaccesspattern
+   ** A long element is read back in pieces, in order and out of order,
+      through the descriptor and the mapping, with each pattern, set for
+      all the files and for one.
+   ** Sequential and random together, unknown flags and bad ids are refused.
+
+   * Hreadv
+   ** Whole and partial plain elements, adjacent and apart in the file,
+      and a linked-block element.
+   ** A request for a missing element.
+
+   * Free space
+   ** The space of deleted elements is reused, best fit, and merged with
+      the space next to it.
+   ** Space still used by a duplicated DD is kept.
+
+   * Hsetalignment / Hreservespace
+   ** Long elements and elements that grow in place start at multiples of
+      the alignment, the others take the reserved space.
+   ** Neither can be set on a file opened read-only.
+
+   * Hwriteindex / Hreadindex
+   ** The DD list and the short elements of a file opened read-only are
+      read from its index, the long ones from the file.
+   ** An index written before the file changed is ignored.
+   ** Reading from an index is refused for a file opened for writing.
+
+   * Hsetdriver / Hregisterdriver
+   ** A file created and updated through the core driver is written back.
+   ** A file is read through a registered driver, which is refused
+      for writing when it has no write operation.
+   ** Unknown drivers and drivers replacing the built-in ones are refused.
+   ** Long elements written and read through the direct driver, at
+      unaligned offsets, and short ones, are read back through the
+      built-in file access.
+
+   * Hsetstreaming
+   ** A file created for streaming, with more DDs than its first DD block
+      holds, elements longer than the window and a compressed element,
+      is written in order, its head last, and read back.
+   ** Rewriting or reading the bytes written out fails, those still held
+      are read back.
+
+   * Hsetmaxdescriptors
+   ** More files than descriptors are written and read back, in turns,
+      while open, then after being closed.
+   ** A negative limit is refused.
+
+   * Positional reads
+   ** Access records reading the same element in turns, each from its own
+      position, get the right data, also while the file is written to,
+      without moving the file position.
+
+   * Hcache
+   ** Small elements written one after the other take few writes, and are
+      read back before and after being written out.
+   ** Elements rewritten while buffered, and writes larger than the
+      buffer, end up where they belong.
+   ** Writes go straight to the file without caching.
+
+   * HBsetpolicy
+   ** Small elements read often enough are read from the file once, the
+      others every time.
+   ** An element written is read again, while an access record opened
+      before keeps what it was reading.
+
+   * Hsetkeepopen / HPkeep_open
+   ** A file kept open is reopened without reading anything.
+   ** A file replaced on disk, or written, is read again.
+   ** Nothing is kept open with Hsetkeepopen(0).
+
+   * DD blocks
+   ** The many small DD blocks of a file are read at once when opened.
+   ** The DD blocks added to a file opened for writing take the size
+      passed to Hopen().
+   ** Hcompactdd and Hsetcompactdd leave out the DDs of deleted elements
+      and the blocks this empties, the others are still found.
+   ** Hcompactdd fails while an element is accessed.
+
+   * Hprobe
+   ** The version and first DD block of an HDF file are read.
+   ** The magic number of other files is returned.
+   ** A DD block larger than its file is found out.
+
+   * Hsetimage / Hgetimage / Hdeleteimage
+   ** A file created through the memory driver is retrieved as an image,
+      which is opened from a user buffer and updated without changing it.
+   ** Images of open files cannot be replaced or deleted.
+
+   * Thread-safe builds
+   ** Threads creating, writing and reading back files of their own.
+   ** Threads reading the elements of one file through the same file id.
+   ** Threads reading one element through access records of their own.
+
  */
 
-#include "tproto.h"
-#define TESTFILE_NAME "t.hdf"
-#define BUF_SIZE      4096
+#include "tproto.h"
+#include "hfile.h"
+#ifdef H4_HAVE_THREADSAFE
+#include <pthread.h>
+#endif
+#define TESTFILE_NAME   "t.hdf"
+#define SEARCHFILE_NAME "tsearch.hdf"
+#define FREEFILE_NAME   "tfree.hdf"
+#define FREE_TAG        1000 /* tag of the free space test elements */
+#define ALIGNFILE_NAME  "talign.hdf"
+#define PATTFILE_NAME   "tpattern.hdf"
+#define PATT_LEN        (3 * 1024 * 1024 + 100) /* element longer than a few HDROP_BEHIND_LEN */
+#define PATT_PIECE      (BUF_SIZE / 2)          /* bytes read at a time by the access pattern tests */
+#define ALIGN_SIZE      512 /* alignment of the alignment tests */
+#define IDXFILE_NAME    "tindex.hdf"
+#define IDX_MAX_LEN     1000 /* longest element indexed by the index tests */
+#define DRVFILE_NAME    "tdriver.hdf"
+#define DIRFILE_NAME    "tdirect.hdf"
+#define DIRECT_LEN      300001 /* long elements of the direct driver tests */
+#define STRFILE_NAME    "tstream.hdf"
+#define STREAM_WINDOW   1024 /* bytes kept by the streaming tests */
+#define STREAM_NELTS    30   /* short elements of the streaming tests */
+#define IMGFILE_NAME    "timage.hdf" /* never written to disk */
+#define FDFILE_NAME     "tfd%d.hdf"
+#define KEEPFILE_NAME   "tkeep.hdf"
+#define KEEPFILE2_NAME  "tkeep2.hdf" /* renamed to KEEPFILE_NAME */
+#define PROBEFILE_NAME  "tprobe.hdf"
+#define POSNFILE_NAME   "tposn.hdf"
+#define POSN_STEP       100 /* bytes read at a time by the positional read tests */
+#define WBUFFILE_NAME   "twbuf.hdf"
+#define WBUF_SIZE       1024 /* size of the write buffer of the write-combining tests */
+#define WBUF_NELEMS     100  /* small elements written by the write-combining tests */
+#define HBFILE_NAME     "thbuf.hdf"
+#define HB_MAX_LEN      1000 /* longest element buffered by the buffering policy tests */
+#define DDFILE_NAME     "tddblock.hdf"
+#define DD_NELTS        40 /* elements of the file, in blocks of MIN_NDDS DDs */
+#define FD_NFILES       6 /* files open at once in the descriptor tests */
+#define FD_MAX          2 /* descriptors they are given */
+#define BUF_SIZE        4096
+#define SEARCH_NELEMS   100 /* elements written for the search tests */
+#define SEARCH_NDDS     16  /* DDs per DD block for the search tests */
+#define THREAD_NTHREADS 4   /* threads of the thread-safety tests */
+#define THREAD_NELEMS   50  /* elements written by each thread */
+
+static uint8 outbuf[BUF_SIZE], inbuf[BUF_SIZE];
+
+/* Checks what Hfind() finds for search_tag/search_ref, in both directions,
+   against a walk of the whole DD list */
+static void
+check_search(int32 fid, uint16 search_tag, uint16 search_ref)
+{
+    uint16 tags[2 * SEARCH_NELEMS], refs[2 * SEARCH_NELEMS];
+    uint16 tag, ref;
+    int32  offset, length, count;
+    int    nfound = 0, i;
+
+    /* all the matching DDs, in DD list order */
+    tag = ref = 0;
+    while (Hfind(fid, DFTAG_WILDCARD, DFREF_WILDCARD, &tag, &ref, &offset, &length, DF_FORWARD) != FAIL)
+        if ((search_tag == DFTAG_WILDCARD || tag == search_tag) &&
+            (search_ref == DFREF_WILDCARD || ref == search_ref)) {
+            tags[nfound]   = tag;
+            refs[nfound++] = ref;
+        }
+
+    if (search_tag != DFTAG_WILDCARD && search_ref == DFREF_WILDCARD) {
+        count = Hnumber(fid, search_tag);
+        VERIFY_VOID(count, nfound, "Hnumber");
+    }
+
+    MESSAGE(7, printf("Searching tag %u ref %u forward and backward (%d matches)\n", (unsigned)search_tag,
+                      (unsigned)search_ref, nfound););
+    tag = ref = 0;
+    for (i = 0; Hfind(fid, search_tag, search_ref, &tag, &ref, &offset, &length, DF_FORWARD) != FAIL; i++)
+        if (i >= nfound || tag != tags[i] || ref != refs[i]) {
+            fprintf(stderr, "ERROR: Hfind forward found tag %u ref %u as match %d\n", (unsigned)tag,
+                    (unsigned)ref, i);
+            num_errs++;
+            return;
+        }
+    VERIFY_VOID(i, nfound, "Hfind");
+
+    tag = ref = 0;
+    for (i = nfound - 1; Hfind(fid, search_tag, search_ref, &tag, &ref, &offset, &length, DF_BACKWARD) != FAIL;
+         i--)
+        if (i < 0 || tag != tags[i] || ref != refs[i]) {
+            fprintf(stderr, "ERROR: Hfind backward found tag %u ref %u as match %d\n", (unsigned)tag,
+                    (unsigned)ref, i);
+            num_errs++;
+            return;
+        }
+    VERIFY_VOID(i, -1, "Hfind");
+}
+
+/* Searches a file with many DDs, some of them deleted and re-used */
+static void
+test_hfile_search(void)
+{
+    int32 fid;
+    int32 ret;
+    int   pass, i;
+
+    MESSAGE(5, printf("Creating a file %s with several DD blocks\n", SEARCHFILE_NAME););
+    fid = Hopen(SEARCHFILE_NAME, DFACC_CREATE, SEARCH_NDDS);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    for (i = 1; i <= SEARCH_NELEMS; i++) {
+        ret = Hputelement(fid, (uint16)(1000 + i % 3), (uint16)i, outbuf, i);
+        CHECK_VOID(ret, FAIL, "Hputelement");
+    }
+
+    /* free some DDs in the middle of the DD list, then re-use them */
+    for (i = 7; i <= SEARCH_NELEMS; i += 7) {
+        ret = Hdeldd(fid, (uint16)(1000 + i % 3), (uint16)i);
+        CHECK_VOID(ret, FAIL, "Hdeldd");
+    }
+    for (i = 0; i < 5; i++) {
+        ret = Hputelement(fid, (uint16)1001, (uint16)(SEARCH_NELEMS + 100 + i), outbuf, 10);
+        CHECK_VOID(ret, FAIL, "Hputelement");
+    }
+
+    for (pass = 0; pass < 2; pass++) {
+        check_search(fid, 1000, DFREF_WILDCARD);
+        check_search(fid, 1001, DFREF_WILDCARD);
+        check_search(fid, 1003, DFREF_WILDCARD);
+        check_search(fid, DFTAG_WILDCARD, 50);
+        check_search(fid, DFTAG_WILDCARD, 49);
+        check_search(fid, DFTAG_WILDCARD, SEARCH_NELEMS + 102);
+        check_search(fid, DFTAG_WILDCARD, 7);
+
+        ret = Hclose(fid);
+        CHECK_VOID(ret, FAIL, "Hclose");
+
+        if (pass == 0) {
+            MESSAGE(5, printf("Re-opening file %s\n", SEARCHFILE_NAME););
+            fid = Hopen(SEARCHFILE_NAME, DFACC_READ, 0);
+            CHECK_VOID(fid, FAIL, "Hopen");
+        }
+    }
+}
+
+/* Reads the search test file back through a memory-mapping */
+static void
+test_hfile_mmap(void)
+{
+    int32 fid, fid1;
+    int32 aid;
+    int32 ret;
+    int   pass, i;
+
+    ret = Hmmap(CACHE_ALL_FILES, TRUE);
+    CHECK_VOID(ret, FAIL, "Hmmap");
+
+    MESSAGE(5, printf("Opening file %s read-only and mapped\n", SEARCHFILE_NAME););
+    fid = Hopen(SEARCHFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    for (pass = 0; pass < 2; pass++) {
+        for (i = 1; i <= SEARCH_NELEMS; i++) {
+            if (i % 7 == 0)
+                continue; /* deleted by test_hfile_search() */
+            memset(inbuf, 0, (size_t)i);
+            ret = Hgetelement(fid, (uint16)(1000 + i % 3), (uint16)i, inbuf);
+            VERIFY_VOID(ret, i, "Hgetelement");
+            if (memcmp(inbuf, outbuf, (size_t)i) != 0) {
+                printf("Wrong data in element %d\n", i);
+                num_errs++;
+            }
+        }
+
+        /* read part of an element after a seek */
+        aid = Hstartread(fid, 1000 + SEARCH_NELEMS % 3, SEARCH_NELEMS);
+        CHECK_VOID(aid, FAIL, "Hstartread");
+        ret = Hseek(aid, 40, DF_START);
+        CHECK_VOID(ret, FAIL, "Hseek");
+        ret = Hread(aid, 20, inbuf);
+        VERIFY_VOID(ret, 20, "Hread");
+        if (memcmp(inbuf, outbuf + 40, 20) != 0) {
+            printf("Wrong data after Hseek\n");
+            num_errs++;
+        }
+        ret = Hendaccess(aid);
+        CHECK_VOID(ret, FAIL, "Hendaccess");
+
+        /* the second pass reads through the file handle again */
+        ret = Hmmap(fid, FALSE);
+        CHECK_VOID(ret, FAIL, "Hmmap");
+    }
+
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* files opened for writing cannot be mapped */
+    fid1 = Hopen(SEARCHFILE_NAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid1, FAIL, "Hopen");
+    ret = Hmmap(fid1, TRUE);
+    VERIFY_VOID(ret, FAIL, "Hmmap");
+    ret = Hclose(fid1);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    ret = Hmmap(CACHE_ALL_FILES, FALSE);
+    CHECK_VOID(ret, FAIL, "Hmmap");
+}
+
+/* Reads the long element of the access pattern test file in pieces of
+   PATT_PIECE, in order, or taking every other one first */
+static void
+pattern_reads(int32 fid, intn skip)
+{
+    int32 aid, ret;
+    int32 posn, len;
+    int32 step = skip ? 2 * PATT_PIECE : PATT_PIECE;
+    intn  pass, errors = 0;
+
+    aid = Hstartread(fid, 1000, 1);
+    CHECK_VOID(aid, FAIL, "Hstartread");
+    for (pass = skip ? 0 : 1; pass < 2; pass++)
+        for (posn = skip ? pass * PATT_PIECE : 0; posn < PATT_LEN; posn += step) {
+            len = MIN(PATT_PIECE, PATT_LEN - posn);
+            ret = Hseek(aid, posn, DF_START);
+            CHECK_VOID(ret, FAIL, "Hseek");
+            ret = Hread(aid, len, inbuf);
+            VERIFY_VOID(ret, len, "Hread");
+            if (ret == len && memcmp(inbuf, outbuf + (posn / PATT_PIECE) % 7, (size_t)len) != 0 &&
+                errors++ == 0) {
+                printf("Wrong data at %d of the access pattern test\n", (int)posn);
+                num_errs++;
+            }
+        }
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+}
+
+/* Reads a file with each access pattern */
+static void
+test_hfile_pattern(void)
+{
+    static const intn patterns[] = {HDF_ACCESS_SEQUENTIAL | HDF_ACCESS_DONTNEED, HDF_ACCESS_RANDOM,
+                                    HDF_ACCESS_WILLNEED | HDF_ACCESS_DONTNEED, HDF_ACCESS_NORMAL};
+    int32 fid, aid;
+    int32 ret;
+    int32 posn;
+    int   i;
+
+    MESSAGE(5, printf("Writing the long element of %s\n", PATTFILE_NAME););
+    fid = Hopen(PATTFILE_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    aid = Hstartwrite(fid, 1000, 1, PATT_LEN);
+    CHECK_VOID(aid, FAIL, "Hstartwrite");
+    for (posn = 0; posn < PATT_LEN; posn += PATT_PIECE) {
+        ret = Hwrite(aid, MIN(PATT_PIECE, PATT_LEN - posn), outbuf + (posn / PATT_PIECE) % 7);
+        VERIFY_VOID(ret, MIN(PATT_PIECE, PATT_LEN - posn), "Hwrite");
+    }
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    /* a file opened for writing takes one too */
+    ret = Hsetaccesspattern(fid, HDF_ACCESS_SEQUENTIAL | HDF_ACCESS_DONTNEED);
+    CHECK_VOID(ret, FAIL, "Hsetaccesspattern");
+    pattern_reads(fid, FALSE);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* set for all the files opened next, then for the open file */
+    for (i = 0; i < (int)(sizeof(patterns) / sizeof(patterns[0])); i++) {
+        MESSAGE(5, printf("Reading %s with access pattern %d\n", PATTFILE_NAME, (int)patterns[i]););
+        ret = Hsetaccesspattern(CACHE_ALL_FILES, patterns[i]);
+        CHECK_VOID(ret, FAIL, "Hsetaccesspattern");
+        fid = Hopen(PATTFILE_NAME, DFACC_READ, 0);
+        CHECK_VOID(fid, FAIL, "Hopen");
+        pattern_reads(fid, FALSE);
+        pattern_reads(fid, TRUE);
+
+        ret = Hmmap(fid, TRUE);
+        CHECK_VOID(ret, FAIL, "Hmmap");
+        ret = Hsetaccesspattern(fid, patterns[(i + 1) % 4]);
+        CHECK_VOID(ret, FAIL, "Hsetaccesspattern");
+        pattern_reads(fid, TRUE);
+        pattern_reads(fid, FALSE);
+
+        ret = Hclose(fid);
+        CHECK_VOID(ret, FAIL, "Hclose");
+    }
+
+    /* sequential and random at once, unknown flags, bad ids */
+    ret = Hsetaccesspattern(CACHE_ALL_FILES, HDF_ACCESS_SEQUENTIAL | HDF_ACCESS_RANDOM);
+    VERIFY_VOID(ret, FAIL, "Hsetaccesspattern");
+    ret = Hsetaccesspattern(CACHE_ALL_FILES, 0x100);
+    VERIFY_VOID(ret, FAIL, "Hsetaccesspattern");
+    ret = Hsetaccesspattern(fid, HDF_ACCESS_RANDOM);
+    VERIFY_VOID(ret, FAIL, "Hsetaccesspattern");
+}
+
+/* Reads several elements of the search test file with one Hreadv() call */
+static void
+test_hfile_readv(void)
+{
+    hdf_readv_t reqs[6];
+    uint8       bufs[6][BUF_SIZE];
+    int32       fid, aid;
+    int32       ret;
+    int         i;
+
+    fid = Hopen(SEARCHFILE_NAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    /* add a special element */
+    aid = HLcreate(fid, 1002, 1, 128, 4);
+    CHECK_VOID(aid, FAIL, "HLcreate");
+    ret = Hwrite(aid, 1000, outbuf);
+    VERIFY_VOID(ret, 1000, "Hwrite");
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    /* elements are written one after the other, so 50 and 51 are adjacent */
+    reqs[0].tag    = 1000 + 51 % 3;
+    reqs[0].ref    = 51;
+    reqs[0].offset = 0;
+    reqs[0].length = 0;
+    reqs[1].tag    = 1000 + 50 % 3;
+    reqs[1].ref    = 50;
+    reqs[1].offset = 10;
+    reqs[1].length = 20;
+    reqs[2].tag    = 1000 + 2 % 3;
+    reqs[2].ref    = 2;
+    reqs[2].offset = 0;
+    reqs[2].length = 100; /* past the end of the element */
+    reqs[3].tag    = 1002;
+    reqs[3].ref    = 1;
+    reqs[3].offset = 100;
+    reqs[3].length = 500;
+    reqs[4].tag    = 1000 + SEARCH_NELEMS % 3;
+    reqs[4].ref    = SEARCH_NELEMS;
+    reqs[4].offset = SEARCH_NELEMS;
+    reqs[4].length = 0; /* nothing left */
+    reqs[5].tag    = 1000 + 90 % 3;
+    reqs[5].ref    = 90;
+    reqs[5].offset = 89;
+    reqs[5].length = 1;
+    for (i = 0; i < 6; i++)
+        reqs[i].buf = bufs[i];
+
+    ret = Hreadv(fid, 6, reqs);
+    VERIFY_VOID(ret, 51 + 20 + 2 + 500 + 0 + 1, "Hreadv");
+    VERIFY_VOID(reqs[0].nread, 51, "Hreadv");
+    VERIFY_VOID(reqs[1].nread, 20, "Hreadv");
+    VERIFY_VOID(reqs[2].nread, 2, "Hreadv");
+    VERIFY_VOID(reqs[3].nread, 500, "Hreadv");
+    VERIFY_VOID(reqs[4].nread, 0, "Hreadv");
+    VERIFY_VOID(reqs[5].nread, 1, "Hreadv");
+    for (i = 0; i < 6; i++)
+        if (memcmp(bufs[i], outbuf + reqs[i].offset, (size_t)reqs[i].nread) != 0) {
+            printf("Wrong data for Hreadv request %d\n", i);
+            num_errs++;
+        }
+
+    /* an element still in the write buffer, and overlapping requests */
+    ret = Hputelement(fid, 1003, 1, outbuf + 3, 300);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+    reqs[0].tag    = 1003;
+    reqs[0].ref    = 1;
+    reqs[0].offset = 0;
+    reqs[0].length = 0;
+    reqs[1].tag    = 1003;
+    reqs[1].ref    = 1;
+    reqs[1].offset = 100;
+    reqs[1].length = 50;
+    reqs[2].tag    = 1000 + 51 % 3;
+    reqs[2].ref    = 51;
+    reqs[2].offset = 5;
+    reqs[2].length = 10;
+
+    ret = Hreadv(fid, 3, reqs);
+    VERIFY_VOID(ret, 300 + 50 + 10, "Hreadv");
+    if (memcmp(bufs[0], outbuf + 3, 300) != 0 || memcmp(bufs[1], outbuf + 103, 50) != 0 ||
+        memcmp(bufs[2], outbuf + 5, 10) != 0) {
+        printf("Wrong data for Hreadv after Hputelement\n");
+        num_errs++;
+    }
+
+    /* a missing element fails the whole call */
+    reqs[2].ref = 7; /* deleted by test_hfile_search() */
+    ret         = Hreadv(fid, 6, reqs);
+    VERIFY_VOID(ret, FAIL, "Hreadv");
+
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+}
+
+/* Writes element 'ref' of the free space test, 'length' bytes starting at
+   outbuf[ref], and returns its offset */
+static int32
+free_put(int32 fid, uint16 ref, int32 length)
+{
+    int32 ret;
+
+    ret = Hputelement(fid, FREE_TAG, ref, outbuf + ref, length);
+    CHECK(ret, FAIL, "Hputelement");
+    return Hoffset(fid, FREE_TAG, ref);
+}
+
+/* Checks the data of element 'ref' of the free space test, written from
+   outbuf[from] */
+static void
+free_check(int32 fid, uint16 ref, int from, int32 length)
+{
+    int32 ret;
+
+    memset(inbuf, 0, (size_t)length);
+    ret = Hgetelement(fid, FREE_TAG, ref, inbuf);
+    VERIFY_VOID(ret, length, "Hgetelement");
+    if (memcmp(inbuf, outbuf + from, (size_t)length) != 0) {
+        printf("Wrong data in element %u\n", (unsigned)ref);
+        num_errs++;
+    }
+}
+
+/* Deletes and writes elements and checks where the new ones go */
+static void
+test_hfile_freespace(void)
+{
+    int32 fid;
+    int32 off_a, off_e, off;
+    int32 ret;
+
+    MESSAGE(5, printf("Reusing the space of deleted elements in %s\n", FREEFILE_NAME););
+    fid = Hopen(FREEFILE_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    off_a = free_put(fid, 1, 1000);
+    free_put(fid, 2, 100);
+    off_e = free_put(fid, 3, 1000);
+    free_put(fid, 4, 100);
+
+    /* two elements fill the hole of element 1 */
+    ret = Hdeldd(fid, FREE_TAG, 1);
+    CHECK_VOID(ret, FAIL, "Hdeldd");
+    off = free_put(fid, 5, 500);
+    VERIFY_VOID(off, off_a, "Hoffset");
+    off = free_put(fid, 6, 500);
+    VERIFY_VOID(off, off_a + 500, "Hoffset");
+
+    /* element 3 is still used through its duplicate DD */
+    ret = Hdupdd(fid, FREE_TAG, 7, FREE_TAG, 3);
+    CHECK_VOID(ret, FAIL, "Hdupdd");
+    ret = Hdeldd(fid, FREE_TAG, 3);
+    CHECK_VOID(ret, FAIL, "Hdeldd");
+    off = free_put(fid, 8, 1000);
+    if (off < off_e + 1000 && off_e < off + 1000) {
+        printf("Element 8 was written over the data of element 7\n");
+        num_errs++;
+    }
+
+    /* the holes of elements 5 and 6 merge */
+    ret = Hdeldd(fid, FREE_TAG, 5);
+    CHECK_VOID(ret, FAIL, "Hdeldd");
+    ret = Hdeldd(fid, FREE_TAG, 6);
+    CHECK_VOID(ret, FAIL, "Hdeldd");
+    off = free_put(fid, 9, 1000);
+    VERIFY_VOID(off, off_a, "Hoffset");
+
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    fid = Hopen(FREEFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_check(fid, 2, 2, 100);
+    free_check(fid, 4, 4, 100);
+    free_check(fid, 7, 3, 1000);
+    free_check(fid, 8, 8, 1000);
+    free_check(fid, 9, 9, 1000);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+}
+
+/* Writes elements with alignment and reserved space and checks where they go */
+static void
+test_hfile_alignment(void)
+{
+    int32 fid, aid;
+    int32 off_a, off_b, off;
+    int16 special;
+    int32 ret;
+
+    MESSAGE(5, printf("Aligning elements in %s\n", ALIGNFILE_NAME););
+    fid = Hopen(ALIGNFILE_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hsetalignment(fid, 1000, ALIGN_SIZE);
+    CHECK_VOID(ret, FAIL, "Hsetalignment");
+    ret = Hreservespace(fid, 2000);
+    CHECK_VOID(ret, FAIL, "Hreservespace");
+
+    /* the short elements are packed into the reserved space, which ends
+       where the first long element starts */
+    off_a = free_put(fid, 1, 100);
+    off_b = free_put(fid, 2, 1000);
+    VERIFY_VOID(off_b, (off_a + 2000 + ALIGN_SIZE - 1) / ALIGN_SIZE * ALIGN_SIZE, "Hoffset");
+    off = free_put(fid, 3, 100);
+    VERIFY_VOID(off, off_a + 100, "Hoffset");
+    off = free_put(fid, 4, 1500);
+    VERIFY_VOID(off % ALIGN_SIZE, 0, "Hoffset");
+    if (off < off_b + 1000) {
+        printf("Element 4 was written over element 2\n");
+        num_errs++;
+    }
+
+    /* an element that grows is moved, to an aligned block once it is long */
+    aid = Hstartaccess(fid, FREE_TAG, 5, DFACC_WRITE);
+    CHECK_VOID(aid, FAIL, "Hstartaccess");
+    ret = Hwrite(aid, 10, outbuf + 5);
+    VERIFY_VOID(ret, 10, "Hwrite");
+    ret = Hwrite(aid, 990, outbuf + 15);
+    VERIFY_VOID(ret, 990, "Hwrite");
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    off_a = Hoffset(fid, FREE_TAG, 5);
+    VERIFY_VOID(off_a % ALIGN_SIZE, 0, "Hoffset");
+
+    /* a short one moves to the end of the file, not to linked blocks */
+    aid = Hstartaccess(fid, FREE_TAG, 6, DFACC_WRITE);
+    CHECK_VOID(aid, FAIL, "Hstartaccess");
+    ret = Hwrite(aid, 10, outbuf + 6);
+    VERIFY_VOID(ret, 10, "Hwrite");
+    ret = Hwrite(aid, 40, outbuf + 16);
+    VERIFY_VOID(ret, 40, "Hwrite");
+    ret = Hinquire(aid, NULL, NULL, NULL, NULL, &off, NULL, NULL, &special);
+    CHECK_VOID(ret, FAIL, "Hinquire");
+    VERIFY_VOID(special, 0, "Hinquire");
+    VERIFY_VOID(off, off_a + 1000, "Hinquire");
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    fid = Hopen(ALIGNFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_check(fid, 1, 1, 100);
+    free_check(fid, 2, 2, 1000);
+    free_check(fid, 3, 3, 100);
+    free_check(fid, 4, 4, 1500);
+    free_check(fid, 5, 5, 1000);
+    free_check(fid, 6, 6, 50);
+    ret = Hsetalignment(fid, 0, ALIGN_SIZE);
+    VERIFY_VOID(ret, FAIL, "Hsetalignment");
+    ret = Hreservespace(fid, 2000);
+    VERIFY_VOID(ret, FAIL, "Hreservespace");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+}
+
+/* Writes the index of a file and reads the file back through it */
+static void
+test_hfile_index(void)
+{
+    hdf_stats_t stats;
+    int32       fid;
+    int32       ret;
+
+    MESSAGE(5, printf("Reading %s through its index\n", IDXFILE_NAME););
+    fid = Hopen(IDXFILE_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_put(fid, 1, 100);
+    free_put(fid, 2, IDX_MAX_LEN);
+    free_put(fid, 3, 3000);
+    ret = Hwriteindex(fid, IDX_MAX_LEN);
+    CHECK_VOID(ret, FAIL, "Hwriteindex");
+    ret = Hreadindex(fid, TRUE);
+    VERIFY_VOID(ret, FAIL, "Hreadindex");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* the DD list and the short elements come out of the index, the
+       long element from the file */
+    ret = Hreadindex(CACHE_ALL_FILES, TRUE);
+    CHECK_VOID(ret, FAIL, "Hreadindex");
+    fid = Hopen(IDXFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_check(fid, 1, 1, 100);
+    free_check(fid, 2, 2, IDX_MAX_LEN);
+    ret = Hgetstats(fid, &stats);
+    CHECK_VOID(ret, FAIL, "Hgetstats");
+    VERIFY_VOID(stats.nreads, 0, "Hgetstats");
+    free_check(fid, 3, 3, 3000);
+    ret = Hgetstats(fid, &stats);
+    CHECK_VOID(ret, FAIL, "Hgetstats");
+    if (stats.nreads == 0) {
+        printf("Element 3 was not read from the file\n");
+        num_errs++;
+    }
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* once the file has changed, its index is not used */
+    fid = Hopen(IDXFILE_NAME, DFACC_WRITE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hreadindex(fid, TRUE);
+    VERIFY_VOID(ret, FAIL, "Hreadindex");
+    free_put(fid, 4, 200);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    fid = Hopen(IDXFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hgetstats(fid, &stats);
+    CHECK_VOID(ret, FAIL, "Hgetstats");
+    if (stats.nreads == 0) {
+        printf("The DD list was read from an outdated index\n");
+        num_errs++;
+    }
+    free_check(fid, 1, 1, 100);
+    free_check(fid, 4, 4, 200);
+    ret = Hreadindex(fid, TRUE);
+    VERIFY_VOID(ret, FAIL, "Hreadindex");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    ret = Hreadindex(CACHE_ALL_FILES, FALSE);
+    CHECK_VOID(ret, FAIL, "Hreadindex");
+}
+
+/* Has the index of a file written to a directory of indexes when it is first
+   opened, then reads the file through it */
+static void
+test_hfile_indexcache(void)
+{
+    hdf_stats_t stats;
+    char        idx_path[64];
+    int32       fid;
+    int32       ret;
+
+    MESSAGE(5, printf("Reading %s through an index written on open\n", IDXFILE_NAME););
+    ret = Hsetindexcache("", TRUE);
+    VERIFY_VOID(ret, FAIL, "Hsetindexcache");
+    ret = Hsetindexcache(".", TRUE);
+    CHECK_VOID(ret, FAIL, "Hsetindexcache");
+    ret = Hreadindex(CACHE_ALL_FILES, TRUE);
+    CHECK_VOID(ret, FAIL, "Hreadindex");
+
+    /* the index next to the file is outdated, one is written in "." */
+    fid = Hopen(IDXFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_check(fid, 1, 1, 100);
+    free_check(fid, 4, 4, 200);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+    snprintf(idx_path, sizeof(idx_path), "./%s.%08lx.h4idx", IDXFILE_NAME,
+             (unsigned long)HPfile_stamp(IDXFILE_NAME));
+
+    fid = Hopen(IDXFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_check(fid, 1, 1, 100);
+    free_check(fid, 4, 4, 200);
+    ret = Hgetstats(fid, &stats);
+    CHECK_VOID(ret, FAIL, "Hgetstats");
+    VERIFY_VOID(stats.nreads, 0, "Hgetstats");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    ret = Hsetindexcache(NULL, FALSE);
+    CHECK_VOID(ret, FAIL, "Hsetindexcache");
+    ret = Hreadindex(CACHE_ALL_FILES, FALSE);
+    CHECK_VOID(ret, FAIL, "Hreadindex");
+    if (remove(idx_path) != 0) {
+        printf("The index %s was not written\n", idx_path);
+        num_errs++;
+    }
+}
+
+/* A read-only driver reading through stdio and counting its reads */
+static int32 count_nreads = 0;
+
+static void *
+count_open(const char *path, intn acc_mode)
+{
+    return (acc_mode & (DFACC_WRITE | DFACC_CREATE)) ? NULL : (void *)fopen(path, "rb");
+}
+
+static intn
+count_read(void *handle, int32 offset, void *buf, int32 bytes)
+{
+    count_nreads++;
+    if (fseek((FILE *)handle, (long)offset, SEEK_SET) != 0 ||
+        fread(buf, 1, (size_t)bytes, (FILE *)handle) != (size_t)bytes)
+        return FAIL;
+    return SUCCEED;
+}
+
+static int32
+count_size(void *handle)
+{
+    if (fseek((FILE *)handle, 0L, SEEK_END) != 0)
+        return FAIL;
+    return (int32)ftell((FILE *)handle);
+}
+
+static intn
+count_close(void *handle)
+{
+    return fclose((FILE *)handle) == 0 ? SUCCEED : FAIL;
+}
+
+static const hdf_driver_t count_driver = {"count", count_open, count_read, NULL, count_size, NULL, count_close};
+
+/* Writes a file through the core driver and reads it back through the
+   built-in file access and through a driver of the test's own */
+static void
+test_hfile_driver(void)
+{
+    hdf_driver_t posix_driver = count_driver;
+    int32        fid;
+    int32        ret;
+
+    MESSAGE(5, printf("Writing and reading %s through file drivers\n", DRVFILE_NAME););
+    ret = Hsetdriver("core");
+    CHECK_VOID(ret, FAIL, "Hsetdriver");
+    fid = Hopen(DRVFILE_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_put(fid, 1, 100);
+    free_put(fid, 2, 3000);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* a file opened for writing is updated in memory, then written back */
+    fid = Hopen(DRVFILE_NAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_check(fid, 2, 2, 3000);
+    free_put(fid, 3, 200);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    ret = Hsetdriver("posix");
+    CHECK_VOID(ret, FAIL, "Hsetdriver");
+    fid = Hopen(DRVFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_check(fid, 1, 1, 100);
+    free_check(fid, 2, 2, 3000);
+    free_check(fid, 3, 3, 200);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* a registered driver does all the reads */
+    ret = Hregisterdriver(&count_driver);
+    CHECK_VOID(ret, FAIL, "Hregisterdriver");
+    ret = Hsetdriver("count");
+    CHECK_VOID(ret, FAIL, "Hsetdriver");
+    fid = Hopen(DRVFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_check(fid, 1, 1, 100);
+    free_check(fid, 3, 3, 200);
+    if (count_nreads == 0) {
+        printf("The registered driver was not used\n");
+        num_errs++;
+    }
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* it cannot write */
+    fid = Hopen(DRVFILE_NAME, DFACC_RDWR, 0);
+    VERIFY_VOID(fid, FAIL, "Hopen");
+
+    ret = Hsetdriver("nosuch");
+    VERIFY_VOID(ret, FAIL, "Hsetdriver");
+    posix_driver.name = "posix";
+    ret = Hregisterdriver(&posix_driver);
+    VERIFY_VOID(ret, FAIL, "Hregisterdriver");
+
+    ret = Hsetdriver(NULL);
+    CHECK_VOID(ret, FAIL, "Hsetdriver");
+}
+
+/* Checks a long element of the direct driver tests, whose bytes are
+   (i * seed) % 251 */
+static void
+direct_check(int32 fid, uint16 ref, int seed, uint8 *buf)
+{
+    int32 ret;
+    int32 i;
+
+    memset(buf, 0, DIRECT_LEN);
+    ret = Hgetelement(fid, FREE_TAG, ref, buf);
+    VERIFY_VOID(ret, DIRECT_LEN, "Hgetelement");
+    for (i = 0; i < DIRECT_LEN; i++)
+        if (buf[i] != (uint8)((i * seed) % 251)) {
+            printf("Wrong data at %d in element %u\n", (int)i, (unsigned)ref);
+            num_errs++;
+            return;
+        }
+}
+
+/* Writes long elements, at unaligned offsets, and short ones through the
+   direct driver and reads them back through it and the built-in access */
+static void
+test_hfile_direct(void)
+{
+    uint8 *buf;
+    int32  fid;
+    int32  ret;
+    int32  i;
+    int    pass;
+
+    /* only in libraries built where the system has direct I/O */
+    if (Hsetdriver("direct") == FAIL)
+        return;
+
+    MESSAGE(5, printf("Writing and reading %s through the direct driver\n", DIRFILE_NAME););
+    if ((buf = (uint8 *)malloc(DIRECT_LEN)) == NULL) {
+        num_errs++;
+        return;
+    }
+    fid = Hopen(DIRFILE_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_put(fid, 1, 100);
+    for (i = 0; i < DIRECT_LEN; i++)
+        buf[i] = (uint8)((i * 3) % 251);
+    ret = Hputelement(fid, FREE_TAG, 2, buf, DIRECT_LEN);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+    free_put(fid, 3, 200);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* a file opened for writing gets another long element */
+    fid = Hopen(DIRFILE_NAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    direct_check(fid, 2, 3, buf);
+    for (i = 0; i < DIRECT_LEN; i++)
+        buf[i] = (uint8)((i * 7) % 251);
+    ret = Hputelement(fid, FREE_TAG, 4, buf, DIRECT_LEN);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    for (pass = 0; pass < 2; pass++) {
+        ret = Hsetdriver(pass == 0 ? "direct" : "posix");
+        CHECK_VOID(ret, FAIL, "Hsetdriver");
+        fid = Hopen(DIRFILE_NAME, DFACC_READ, 0);
+        CHECK_VOID(fid, FAIL, "Hopen");
+        free_check(fid, 1, 1, 100);
+        direct_check(fid, 2, 3, buf);
+        free_check(fid, 3, 3, 200);
+        direct_check(fid, 4, 7, buf);
+        ret = Hclose(fid);
+        CHECK_VOID(ret, FAIL, "Hclose");
+    }
+
+    ret = Hsetdriver(NULL);
+    CHECK_VOID(ret, FAIL, "Hsetdriver");
+    free(buf);
+}
+
+/* A driver writing through stdio, counting the writes made after the head
+   of the file, at offset 0, or not right after the one before */
+static int32 seq_next    = -1;
+static int32 seq_nwrites = 0;
+static int32 seq_nbad    = 0;
+
+static void *
+seq_open(const char *path, intn acc_mode)
+{
+    return (void *)fopen(path, acc_mode == DFACC_CREATE ? "wb" : "rb");
+}
+
+static intn
+seq_write(void *handle, int32 offset, const void *buf, int32 bytes)
+{
+    if (seq_next == 0 || (offset != 0 && seq_next != -1 && offset != seq_next))
+        seq_nbad++;
+    seq_next = offset == 0 ? 0 : offset + bytes;
+    seq_nwrites++;
+    if (fseek((FILE *)handle, (long)offset, SEEK_SET) != 0 ||
+        fwrite(buf, 1, (size_t)bytes, (FILE *)handle) != (size_t)bytes)
+        return FAIL;
+    return SUCCEED;
+}
+
+static const hdf_driver_t seq_driver = {"seq", seq_open, count_read, seq_write, count_size, NULL, count_close};
+
+/* Creates a file for streaming through a driver checking the order of the
+   writes, and reads it back */
+static void
+test_hfile_stream(void)
+{
+    model_info m_info;
+    comp_info  c_info;
+    uint8     *buf;
+    int32      fid, aid;
+    int32      ret;
+    int32      i;
+
+    MESSAGE(5, printf("Creating %s for streaming\n", STRFILE_NAME););
+    if ((buf = (uint8 *)malloc(DIRECT_LEN)) == NULL) {
+        num_errs++;
+        return;
+    }
+    for (i = 0; i < DIRECT_LEN; i++)
+        buf[i] = (uint8)((i * 3) % 251);
+
+    ret = Hsetstreaming(-1);
+    VERIFY_VOID(ret, FAIL, "Hsetstreaming");
+    ret = Hregisterdriver(&seq_driver);
+    CHECK_VOID(ret, FAIL, "Hregisterdriver");
+    ret = Hsetdriver("seq");
+    CHECK_VOID(ret, FAIL, "Hsetdriver");
+    ret = Hsetstreaming(STREAM_WINDOW);
+    CHECK_VOID(ret, FAIL, "Hsetstreaming");
+
+    /* the DDs take several DD blocks, placed at the end */
+    fid = Hopen(STRFILE_NAME, DFACC_CREATE, MIN_NDDS);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    for (i = 1; i <= STREAM_NELTS; i++)
+        free_put(fid, (uint16)i, 10 * i);
+    ret = Hputelement(fid, FREE_TAG, STREAM_NELTS + 1, buf, DIRECT_LEN);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+
+    /* the header of a compressed element goes after its data */
+    memset(&c_info, 0, sizeof(c_info));
+    c_info.deflate.level = 6;
+    aid = HCcreate(fid, FREE_TAG, STREAM_NELTS + 2, COMP_MODEL_STDIO, &m_info, COMP_CODE_DEFLATE, &c_info);
+    CHECK_VOID(aid, FAIL, "HCcreate");
+    ret = Hwrite(aid, DIRECT_LEN, buf);
+    VERIFY_VOID(ret, DIRECT_LEN, "Hwrite");
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    free_put(fid, STREAM_NELTS + 3, 100);
+
+    /* what was written out cannot be written or read again */
+    ret = Hputelement(fid, FREE_TAG, 1, outbuf, 10);
+    VERIFY_VOID(ret, FAIL, "Hputelement");
+    ret = Hgetelement(fid, FREE_TAG, 2, inbuf);
+    VERIFY_VOID(ret, FAIL, "Hgetelement");
+    free_check(fid, STREAM_NELTS + 3, STREAM_NELTS + 3, 100);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+    if (seq_nbad != 0 || seq_next != 0) {
+        printf("%d of the %d writes of %s were out of order\n", (int)seq_nbad, (int)seq_nwrites,
+               STRFILE_NAME);
+        num_errs++;
+    }
+
+    ret = Hsetstreaming(0);
+    CHECK_VOID(ret, FAIL, "Hsetstreaming");
+    ret = Hsetdriver(NULL);
+    CHECK_VOID(ret, FAIL, "Hsetdriver");
+    fid = Hopen(STRFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hnumber(fid, FREE_TAG);
+    VERIFY_VOID(ret, STREAM_NELTS + 3, "Hnumber");
+    for (i = 1; i <= STREAM_NELTS; i++)
+        free_check(fid, (uint16)i, (int)i, 10 * i);
+    direct_check(fid, STREAM_NELTS + 1, 3, buf);
+    direct_check(fid, STREAM_NELTS + 2, 3, buf);
+    free_check(fid, STREAM_NELTS + 3, STREAM_NELTS + 3, 100);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+    free(buf);
+}
+
+/* Keeps more files open than they are given descriptors, which go to the
+   files used last */
+static void
+test_hfile_descriptors(void)
+{
+    char        name[FD_NFILES][16];
+    int32       fids[FD_NFILES];
+    hdf_stats_t stats;
+    int         i, pass;
+    int32       ret;
+
+    MESSAGE(5, printf("Using %d files with %d descriptors\n", FD_NFILES, FD_MAX););
+    ret = Hsetmaxdescriptors(-1);
+    VERIFY_VOID(ret, FAIL, "Hsetmaxdescriptors");
+    ret = Hsetmaxdescriptors(FD_MAX);
+    CHECK_VOID(ret, FAIL, "Hsetmaxdescriptors");
+
+    for (i = 0; i < FD_NFILES; i++) {
+        snprintf(name[i], sizeof(name[i]), FDFILE_NAME, i);
+        fids[i] = Hopen(name[i], DFACC_CREATE, 0);
+        CHECK_VOID(fids[i], FAIL, "Hopen");
+    }
+
+    /* each file is written to and read from in turn, losing its
+       descriptor to the others in between */
+    for (pass = 0; pass < 2; pass++)
+        for (i = 0; i < FD_NFILES; i++)
+            free_put(fids[i], (uint16)(10 * i + pass + 1), 100 + 10 * i);
+    for (i = 0; i < FD_NFILES; i++) {
+        free_check(fids[i], (uint16)(10 * i + 1), 10 * i + 1, 100 + 10 * i);
+        free_check(fids[i], (uint16)(10 * i + 2), 10 * i + 2, 100 + 10 * i);
+    }
+    ret = Hgetstats(fids[0], &stats);
+    CHECK_VOID(ret, FAIL, "Hgetstats");
+    if (stats.nopens == 0) {
+        printf("The descriptor of %s was never given back\n", name[0]);
+        num_errs++;
+    }
+    for (i = 0; i < FD_NFILES; i++) {
+        ret = Hclose(fids[i]);
+        CHECK_VOID(ret, FAIL, "Hclose");
+    }
+
+    /* all was written out */
+    for (i = 0; i < FD_NFILES; i++) {
+        fids[i] = Hopen(name[i], DFACC_READ, 0);
+        CHECK_VOID(fids[i], FAIL, "Hopen");
+    }
+    for (i = FD_NFILES - 1; i >= 0; i--) {
+        free_check(fids[i], (uint16)(10 * i + 2), 10 * i + 2, 100 + 10 * i);
+        free_check(fids[i], (uint16)(10 * i + 1), 10 * i + 1, 100 + 10 * i);
+        ret = Hclose(fids[i]);
+        CHECK_VOID(ret, FAIL, "Hclose");
+    }
+
+    ret = Hsetmaxdescriptors(MAX_OPEN_DESCRIPTORS);
+    CHECK_VOID(ret, FAIL, "Hsetmaxdescriptors");
+}
+
+/* Reads element 1 of the positional read test file through two access
+   records in turns, one from the start and one from the middle */
+static void
+posn_check(int32 fid)
+{
+    int32 aid1, aid2;
+    int32 ret;
+    int   i;
+
+    aid1 = Hstartread(fid, 1000, 1);
+    CHECK_VOID(aid1, FAIL, "Hstartread");
+    aid2 = Hstartread(fid, 1000, 1);
+    CHECK_VOID(aid2, FAIL, "Hstartread");
+    ret = Hseek(aid2, BUF_SIZE / 2, DF_START);
+    CHECK_VOID(ret, FAIL, "Hseek");
+
+    for (i = 0; i < BUF_SIZE / 2; i += POSN_STEP) {
+        ret = Hread(aid1, POSN_STEP, inbuf);
+        CHECK_VOID(ret, FAIL, "Hread");
+        if (ret > 0 && memcmp(inbuf, outbuf + i, (size_t)ret) != 0) {
+            printf("Wrong data read at %d by the first access record\n", i);
+            num_errs++;
+        }
+        ret = Hread(aid2, POSN_STEP, inbuf);
+        CHECK_VOID(ret, FAIL, "Hread");
+        if (ret > 0 && memcmp(inbuf, outbuf + BUF_SIZE / 2 + i, (size_t)ret) != 0) {
+            printf("Wrong data read at %d by the second access record\n", BUF_SIZE / 2 + i);
+            num_errs++;
+        }
+    }
+
+    ret = Hendaccess(aid1);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    ret = Hendaccess(aid2);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+}
+
+/* Reads one element through several access records at once */
+static void
+test_hfile_positional(void)
+{
+    hdf_stats_t before, after;
+    int32       fid;
+    int32       ret;
+
+    MESSAGE(5, printf("Testing reads through several access records\n"););
+    fid = Hopen(POSNFILE_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hputelement(fid, 1000, 1, outbuf, BUF_SIZE);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+
+    /* the element is still in the write buffer, then in the file */
+    posn_check(fid);
+    ret = Hsync(fid);
+    CHECK_VOID(ret, FAIL, "Hsync");
+    ret = Hgetstats(fid, &before);
+    CHECK_VOID(ret, FAIL, "Hgetstats");
+    posn_check(fid);
+    ret = Hgetstats(fid, &after);
+    CHECK_VOID(ret, FAIL, "Hgetstats");
+#ifdef HI_PREADV_SUPPORTED
+    if (after.nseeks != before.nseeks) {
+        printf("Reads through two access records took %u seeks\n", (unsigned)(after.nseeks - before.nseeks));
+        num_errs++;
+    }
+#endif
+
+    /* writes in between reads go where they belong */
+    ret = Hputelement(fid, 1000, 2, outbuf + 1, 500);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+    posn_check(fid);
+    ret = Hgetelement(fid, 1000, 2, inbuf);
+    VERIFY_VOID(ret, 500, "Hgetelement");
+    if (memcmp(inbuf, outbuf + 1, 500) != 0) {
+        printf("Wrong data read back after positional reads\n");
+        num_errs++;
+    }
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    fid = Hopen(POSNFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    posn_check(fid);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+}
+
+/* Checks the small elements of the write-combining test file, element
+   'ref' holding 10 bytes starting at outbuf[ref] */
+static void
+wbuf_check(int32 fid)
+{
+    uint16 ref;
+    int32  ret;
+
+    for (ref = 1; ref <= WBUF_NELEMS; ref++) {
+        ret = Hgetelement(fid, 1000, ref, inbuf);
+        VERIFY_VOID(ret, 10, "Hgetelement");
+        if (memcmp(inbuf, outbuf + ref, 10) != 0) {
+            printf("Wrong data for element %u of %s\n", (unsigned)ref, WBUFFILE_NAME);
+            num_errs++;
+            return;
+        }
+    }
+}
 
-static uint8 outbuf[BUF_SIZE], inbuf[BUF_SIZE];
+/* Combines small writes in a buffer of the file */
+static void
+test_hfile_writebuf(void)
+{
+    hdf_stats_t before, after;
+    int32       fid, aid;
+    uint16      ref;
+    int32       ret;
+
+    MESSAGE(5, printf("Combining small writes to %s\n", WBUFFILE_NAME););
+    fid = Hopen(WBUFFILE_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hcache(fid, WBUF_SIZE);
+    CHECK_VOID(ret, FAIL, "Hcache");
+
+    ret = Hgetstats(fid, &before);
+    CHECK_VOID(ret, FAIL, "Hgetstats");
+    for (ref = 1; ref <= WBUF_NELEMS; ref++) {
+        ret = Hputelement(fid, 1000, ref, outbuf + ref, 10);
+        CHECK_VOID(ret, FAIL, "Hputelement");
+    }
+    ret = Hgetstats(fid, &after);
+    CHECK_VOID(ret, FAIL, "Hgetstats");
+    if (after.nwrites - before.nwrites > WBUF_NELEMS / 10 ||
+        after.bytes_written - before.bytes_written < WBUF_NELEMS * 10) {
+        printf("%d small elements took %u writes of %u bytes\n", WBUF_NELEMS,
+               (unsigned)(after.nwrites - before.nwrites),
+               (unsigned)(after.bytes_written - before.bytes_written));
+        num_errs++;
+    }
+    wbuf_check(fid);
+
+    /* a buffered element rewritten, and an element larger than the buffer */
+    ret = Hputelement(fid, 1001, 1, outbuf, 100);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+    aid = Hstartwrite(fid, 1001, 1, 100);
+    CHECK_VOID(aid, FAIL, "Hstartwrite");
+    ret = Hseek(aid, 50, DF_START);
+    CHECK_VOID(ret, FAIL, "Hseek");
+    ret = Hwrite(aid, 10, outbuf + 500);
+    VERIFY_VOID(ret, 10, "Hwrite");
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    ret = Hputelement(fid, 1001, 2, outbuf, 2 * WBUF_SIZE);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+    ret = Hsync(fid);
+    CHECK_VOID(ret, FAIL, "Hsync");
+
+    /* without caching, each write goes to the file */
+    ret = Hcache(fid, FALSE);
+    CHECK_VOID(ret, FAIL, "Hcache");
+    ret = Hgetstats(fid, &before);
+    CHECK_VOID(ret, FAIL, "Hgetstats");
+    ret = Hputelement(fid, 1001, 3, outbuf + 1, 10);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+    ret = Hputelement(fid, 1001, 4, outbuf + 2, 10);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+    ret = Hgetstats(fid, &after);
+    CHECK_VOID(ret, FAIL, "Hgetstats");
+    if (after.nwrites - before.nwrites < 2) {
+        printf("Two uncached elements took %u writes\n", (unsigned)(after.nwrites - before.nwrites));
+        num_errs++;
+    }
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    fid = Hopen(WBUFFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    wbuf_check(fid);
+    ret = Hgetelement(fid, 1001, 1, inbuf);
+    VERIFY_VOID(ret, 100, "Hgetelement");
+    if (memcmp(inbuf, outbuf, 50) != 0 || memcmp(inbuf + 50, outbuf + 500, 10) != 0 ||
+        memcmp(inbuf + 60, outbuf + 60, 40) != 0) {
+        printf("Wrong data for the element rewritten while buffered\n");
+        num_errs++;
+    }
+    ret = Hgetelement(fid, 1001, 2, inbuf);
+    VERIFY_VOID(ret, 2 * WBUF_SIZE, "Hgetelement");
+    if (memcmp(inbuf, outbuf, 2 * WBUF_SIZE) != 0) {
+        printf("Wrong data for the element larger than the buffer\n");
+        num_errs++;
+    }
+    ret = Hgetelement(fid, 1001, 4, inbuf);
+    VERIFY_VOID(ret, 10, "Hgetelement");
+    if (memcmp(inbuf, outbuf + 2, 10) != 0) {
+        printf("Wrong data for an element written without caching\n");
+        num_errs++;
+    }
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+}
+
+/* Reads the small element of the buffering policy test file, which is to
+   hold 100 bytes starting at outbuf[start] */
+static void
+hbuf_check(int32 fid, int start)
+{
+    int32 ret;
+
+    ret = Hgetelement(fid, 1000, 1, inbuf);
+    VERIFY_VOID(ret, 100, "Hgetelement");
+    if (memcmp(inbuf, outbuf + start, 100) != 0) {
+        printf("Wrong data for the small element of %s\n", HBFILE_NAME);
+        num_errs++;
+    }
+}
+
+/* Buffers the small elements read repeatedly */
+static void
+test_hfile_bufpolicy(void)
+{
+    hdf_stats_t before, after;
+    int32       fid, aid;
+    int32       length;
+    int         i;
+    int32       ret;
+
+    MESSAGE(5, printf("Buffering the small elements of %s\n", HBFILE_NAME););
+    fid = Hopen(HBFILE_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hputelement(fid, 1000, 1, outbuf, 100);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+    ret = Hputelement(fid, 1000, 2, outbuf, BUF_SIZE);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* the small element is read from the file by its first two uses only */
+    fid = Hopen(HBFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = HBsetpolicy(fid, HB_MAX_LEN, 2);
+    CHECK_VOID(ret, FAIL, "HBsetpolicy");
+    hbuf_check(fid, 0);
+    hbuf_check(fid, 0);
+    ret = Hgetstats(fid, &before);
+    CHECK_VOID(ret, FAIL, "Hgetstats");
+    for (i = 0; i < 10; i++)
+        hbuf_check(fid, 0);
+    aid = Hstartread(fid, 1000, 1);
+    CHECK_VOID(aid, FAIL, "Hstartread");
+    ret = Hseek(aid, 50, DF_START);
+    CHECK_VOID(ret, FAIL, "Hseek");
+    ret = Hread(aid, 10, inbuf);
+    VERIFY_VOID(ret, 10, "Hread");
+    if (memcmp(inbuf, outbuf + 50, 10) != 0) {
+        printf("Wrong data read from the middle of a buffered element\n");
+        num_errs++;
+    }
+    ret = Hinquire(aid, NULL, NULL, NULL, &length, NULL, NULL, NULL, NULL);
+    CHECK_VOID(ret, FAIL, "Hinquire");
+    VERIFY_VOID(length, 100, "Hinquire");
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    ret = Hgetstats(fid, &after);
+    CHECK_VOID(ret, FAIL, "Hgetstats");
+    if (after.nreads != before.nreads) {
+        printf("A buffered element took %u reads\n", (unsigned)(after.nreads - before.nreads));
+        num_errs++;
+    }
+
+    /* the long one every time */
+    for (i = 0; i < 3; i++) {
+        ret = Hgetelement(fid, 1000, 2, inbuf);
+        VERIFY_VOID(ret, BUF_SIZE, "Hgetelement");
+    }
+    ret = Hgetstats(fid, &before);
+    CHECK_VOID(ret, FAIL, "Hgetstats");
+    if (before.nreads - after.nreads < 3) {
+        printf("A long element was read %u times from the file\n", (unsigned)(before.nreads - after.nreads));
+        num_errs++;
+    }
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* an element written is read again */
+    fid = Hopen(HBFILE_NAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = HBsetpolicy(fid, HB_MAX_LEN, 1);
+    CHECK_VOID(ret, FAIL, "HBsetpolicy");
+    aid = Hstartread(fid, 1000, 1);
+    CHECK_VOID(aid, FAIL, "Hstartread");
+    ret = Hputelement(fid, 1000, 1, outbuf + 7, 100);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+    hbuf_check(fid, 7);
+    ret = Hread(aid, 100, inbuf);
+    VERIFY_VOID(ret, 100, "Hread");
+    if (memcmp(inbuf, outbuf, 100) != 0) {
+        printf("An access record opened before an element was written lost its data\n");
+        num_errs++;
+    }
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    ret = HBsetpolicy(fid, 0, 0);
+    CHECK_VOID(ret, FAIL, "HBsetpolicy");
+    hbuf_check(fid, 7);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+}
+
+/* Opens a read-only file kept open after its last close, and returns the
+   # of reads made by the file since it was last opened from disk */
+static uint32
+keep_open_reads(void)
+{
+    hdf_stats_t stats;
+    int32       fid;
+    int32       ret;
+
+    fid = Hopen(KEEPFILE_NAME, DFACC_READ, 0);
+    CHECK(fid, FAIL, "Hopen");
+    ret = HPkeep_open(fid);
+    CHECK(ret, FAIL, "HPkeep_open");
+    free_check(fid, 1, 1, 100);
+    ret = Hgetstats(fid, &stats);
+    CHECK(ret, FAIL, "Hgetstats");
+    ret = Hclose(fid);
+    CHECK(ret, FAIL, "Hclose");
+    return stats.nreads;
+}
+
+/* Keeps a closed file open, as the single-file interfaces do, and checks
+   when it is read again */
+static void
+test_hfile_keepopen(void)
+{
+    uint32 nreads;
+    int32  fid;
+    int32  ret;
+
+    MESSAGE(5, printf("Keeping %s open once closed\n", KEEPFILE_NAME););
+    fid = Hopen(KEEPFILE_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_put(fid, 1, 100);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* reopened as it was kept, its element read once more; a file read
+       again from disk starts counting anew */
+    nreads = keep_open_reads();
+    if (keep_open_reads() <= nreads) {
+        printf("%s was read again when reopened\n", KEEPFILE_NAME);
+        num_errs++;
+    }
+
+    /* replaced on disk */
+    fid = Hopen(KEEPFILE2_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_put(fid, 1, 100);
+    free_put(fid, 2, 200);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+    ret = rename(KEEPFILE2_NAME, KEEPFILE_NAME);
+    CHECK_VOID(ret, -1, "rename");
+    keep_open_reads();
+    fid = Hopen(KEEPFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hexist(fid, FREE_TAG, 2);
+    CHECK_VOID(ret, FAIL, "Hexist");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* written */
+    fid = Hopen(KEEPFILE_NAME, DFACC_WRITE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_put(fid, 3, 300);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+    keep_open_reads();
+    fid = Hopen(KEEPFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_check(fid, 3, 3, 300);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* not kept */
+    ret = Hsetkeepopen(-1);
+    VERIFY_VOID(ret, FAIL, "Hsetkeepopen");
+    ret = Hsetkeepopen(0);
+    CHECK_VOID(ret, FAIL, "Hsetkeepopen");
+    nreads = keep_open_reads();
+    if (keep_open_reads() != nreads) {
+        printf("%s was kept open\n", KEEPFILE_NAME);
+        num_errs++;
+    }
+    ret = Hsetkeepopen(KEEP_OPEN_FILES);
+    CHECK_VOID(ret, FAIL, "Hsetkeepopen");
+}
+
+/* Opens a file with many DD blocks, reads its elements and returns the # of
+   reads made */
+static uint32
+ddblock_reads(int nelts)
+{
+    hdf_stats_t stats;
+    uint32      nreads;
+    int32       fid;
+    int32       ret;
+    int         i;
+
+    fid = Hopen(DDFILE_NAME, DFACC_READ, 0);
+    CHECK(fid, FAIL, "Hopen");
+    ret = Hgetstats(fid, &stats);
+    CHECK(ret, FAIL, "Hgetstats");
+    nreads = stats.nreads;
+    for (i = 1; i <= nelts; i++)
+        free_check(fid, (uint16)i, i, 10);
+    ret = Hclose(fid);
+    CHECK(ret, FAIL, "Hclose");
+    return nreads;
+}
+
+/* Reads and adds to the DD blocks of a file */
+static void
+test_hfile_ddblocks(void)
+{
+    uint32 nreads;
+    int32  fid;
+    int32  ret;
+    int    i;
+
+    MESSAGE(5, printf("Reading the DD blocks of %s\n", DDFILE_NAME););
+    fid = Hopen(DDFILE_NAME, DFACC_CREATE, MIN_NDDS);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    for (i = 1; i <= DD_NELTS; i++)
+        free_put(fid, (uint16)i, 10);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* the blocks follow the data they were added after, in a file shorter
+       than what is read at a time */
+    nreads = ddblock_reads(DD_NELTS);
+    if (nreads > 2) {
+        printf("%u reads to open %s\n", (unsigned)nreads, DDFILE_NAME);
+        num_errs++;
+    }
+
+    /* the blocks added take the size asked for */
+    fid = Hopen(DDFILE_NAME, DFACC_RDWR, 2 * DD_NELTS);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    for (i = DD_NELTS + 1; i <= 2 * DD_NELTS; i++)
+        free_put(fid, (uint16)i, 10);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+    ddblock_reads(2 * DD_NELTS);
+}
+
+/* Returns the # of DD blocks of the DD list of DDFILE_NAME, read from the file */
+static int
+ddblock_count(void)
+{
+    FILE  *f;
+    uint8  head[NDDS_SZ + OFFSET_SZ];
+    uint8 *p;
+    int32  next   = MAGICLEN;
+    int    nblock = 0;
+
+    if ((f = fopen(DDFILE_NAME, "rb")) == NULL)
+        return FAIL;
+    while (next != 0) {
+        if (fseek(f, (long)next, SEEK_SET) != 0 || fread(head, 1, sizeof(head), f) != sizeof(head)) {
+            nblock = FAIL;
+            break;
+        }
+        p = head + NDDS_SZ;
+        INT32DECODE(p, next);
+        nblock++;
+    }
+    fclose(f);
+    return nblock;
+}
+
+/* Drops the empty DDs of a file */
+static void
+test_hfile_compactdd(void)
+{
+    int32 fid, aid;
+    int32 ret;
+    int   nblock;
+    int   i;
+
+    MESSAGE(5, printf("Compacting the DD list of %s\n", DDFILE_NAME););
+    fid = Hopen(DDFILE_NAME, DFACC_CREATE, MIN_NDDS);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    for (i = 1; i <= DD_NELTS; i++)
+        free_put(fid, (uint16)i, 10);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+    nblock = ddblock_count();
+    if (nblock <= 2) {
+        printf("%d DD blocks in %s\n", nblock, DDFILE_NAME);
+        num_errs++;
+    }
+
+    /* keep one element out of four; nothing is compacted while one is read */
+    fid = Hopen(DDFILE_NAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    for (i = 1; i <= DD_NELTS; i++)
+        if (i % 4 != 0) {
+            ret = Hdeldd(fid, FREE_TAG, (uint16)i);
+            CHECK_VOID(ret, FAIL, "Hdeldd");
+        }
+    aid = Hstartread(fid, FREE_TAG, 4);
+    CHECK_VOID(aid, FAIL, "Hstartread");
+    ret = Hcompactdd(fid);
+    VERIFY_VOID(ret, FAIL, "Hcompactdd");
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    ret = Hcompactdd(fid);
+    CHECK_VOID(ret, FAIL, "Hcompactdd");
+
+    /* the DD list is still searched and added to */
+    for (i = 4; i <= DD_NELTS; i += 4)
+        free_check(fid, (uint16)i, i, 10);
+    ret = Hexist(fid, FREE_TAG, 1);
+    VERIFY_VOID(ret, FAIL, "Hexist");
+    free_put(fid, 1, 10);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* 12 DDs with the version, in the first block and one more */
+    nblock = ddblock_count();
+    VERIFY_VOID(nblock, 2, "ddblock_count");
+    fid = Hopen(DDFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_check(fid, 1, 1, 10);
+    for (i = 4; i <= DD_NELTS; i += 4)
+        free_check(fid, (uint16)i, i, 10);
+    ret = Hsetcompactdd(fid, TRUE);
+    VERIFY_VOID(ret, FAIL, "Hsetcompactdd");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* compacted on close, everything fits in the first block */
+    fid = Hopen(DDFILE_NAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hsetcompactdd(fid, TRUE);
+    CHECK_VOID(ret, FAIL, "Hsetcompactdd");
+    for (i = 1; i < DD_NELTS; i++)
+        if (Hexist(fid, FREE_TAG, (uint16)i) == SUCCEED) {
+            ret = Hdeldd(fid, FREE_TAG, (uint16)i);
+            CHECK_VOID(ret, FAIL, "Hdeldd");
+        }
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+    nblock = ddblock_count();
+    VERIFY_VOID(nblock, 1, "ddblock_count");
+    fid = Hopen(DDFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_check(fid, DD_NELTS, DD_NELTS, 10);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+}
+
+/* Writes the first bytes of a file */
+static void
+probe_write(const char *magic, int len)
+{
+    FILE *fp;
+
+    if ((fp = fopen(PROBEFILE_NAME, "wb")) == NULL || fwrite(magic, 1, (size_t)len, fp) != (size_t)len) {
+        printf("Cannot write %s\n", PROBEFILE_NAME);
+        num_errs++;
+    }
+    if (fp != NULL)
+        fclose(fp);
+}
+
+/* Finds out the format of files without opening them */
+static void
+test_hfile_probe(void)
+{
+    hdf_probe_t probe;
+    int32       fid;
+    intn        ret;
+
+    MESSAGE(5, printf("Probing %s\n", PROBEFILE_NAME););
+    fid = Hopen(PROBEFILE_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_put(fid, 1, 100);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    ret = Hprobe(PROBEFILE_NAME, TRUE, &probe);
+    CHECK_VOID(ret, FAIL, "Hprobe");
+    VERIFY_VOID(probe.magic, 0x0e031301, "Hprobe");
+    VERIFY_VOID(probe.hdf, TRUE, "Hprobe");
+    VERIFY_VOID(probe.dds_ok, TRUE, "Hprobe");
+    VERIFY_VOID(probe.ndds, DEF_NDDS, "Hprobe");
+    VERIFY_VOID(probe.majorv, LIBVER_MAJOR, "Hprobe");
+    VERIFY_VOID(probe.minorv, LIBVER_MINOR, "Hprobe");
+    VERIFY_VOID(probe.release, LIBVER_RELEASE, "Hprobe");
+
+    /* a netCDF file */
+    probe_write("CDF\001", 4);
+    ret = Hprobe(PROBEFILE_NAME, TRUE, &probe);
+    CHECK_VOID(ret, FAIL, "Hprobe");
+    VERIFY_VOID(probe.magic, 0x43444601, "Hprobe");
+    VERIFY_VOID(probe.hdf, FALSE, "Hprobe");
+    VERIFY_VOID(probe.dds_ok, FALSE, "Hprobe");
+
+    /* an HDF file cut short after 2 DDs out of 16 */
+    probe_write(HDFMAGIC "\000\020\000\000\000\000"
+                         "\000\036\000\001\000\000\000\000\000\000\000\000"
+                         "\000\001\000\000\000\000\000\000\000\000\000\000",
+                MAGICLEN + NDDS_SZ + OFFSET_SZ + 2 * DD_SZ);
+    ret = Hprobe(PROBEFILE_NAME, TRUE, &probe);
+    CHECK_VOID(ret, FAIL, "Hprobe");
+    VERIFY_VOID(probe.hdf, TRUE, "Hprobe");
+    VERIFY_VOID(probe.dds_ok, FALSE, "Hprobe");
+    ret = Hprobe(PROBEFILE_NAME, FALSE, &probe);
+    CHECK_VOID(ret, FAIL, "Hprobe");
+    VERIFY_VOID(probe.hdf, TRUE, "Hprobe");
+
+    ret = Hprobe("qqqqqqqq.qqq", FALSE, &probe);
+    VERIFY_VOID(ret, FAIL, "Hprobe");
+}
+
+/* Creates a file in memory, then opens a copy of it from a buffer of the
+   test's own */
+static void
+test_hfile_image(void)
+{
+    const void *image;
+    uint8      *copy;
+    int32       size, size2;
+    int32       fid;
+    int32       ret;
+
+    MESSAGE(5, printf("Creating and reading %s in memory\n", IMGFILE_NAME););
+    ret = Hsetdriver("memory");
+    CHECK_VOID(ret, FAIL, "Hsetdriver");
+    fid = Hopen(IMGFILE_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hsetdriver(NULL);
+    CHECK_VOID(ret, FAIL, "Hsetdriver");
+    free_put(fid, 1, 100);
+    free_put(fid, 2, 3000);
+
+    /* the image of an open file stays */
+    ret = Hsetimage(IMGFILE_NAME, NULL, 0);
+    VERIFY_VOID(ret, FAIL, "Hsetimage");
+    ret = Hdeleteimage(IMGFILE_NAME);
+    VERIFY_VOID(ret, FAIL, "Hdeleteimage");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    ret = Hgetimage(IMGFILE_NAME, &image, &size);
+    CHECK_VOID(ret, FAIL, "Hgetimage");
+    if (size < 3100) {
+        printf("Image of %d bytes is too short\n", (int)size);
+        num_errs++;
+        return;
+    }
+    copy = (uint8 *)malloc((size_t)size);
+    memcpy(copy, image, (size_t)size);
+    ret = Hdeleteimage(IMGFILE_NAME);
+    CHECK_VOID(ret, FAIL, "Hdeleteimage");
+    ret = Hgetimage(IMGFILE_NAME, &image, &size2);
+    VERIFY_VOID(ret, FAIL, "Hgetimage");
+
+    /* the file is opened from the buffer, by name alone */
+    ret = Hsetimage(IMGFILE_NAME, copy, size);
+    CHECK_VOID(ret, FAIL, "Hsetimage");
+    fid = Hopen(IMGFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_check(fid, 1, 1, 100);
+    free_check(fid, 2, 2, 3000);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* and updated in a buffer of the library, leaving the test's alone */
+    fid = Hopen(IMGFILE_NAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_put(fid, 3, 200);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+    ret = Hgetimage(IMGFILE_NAME, &image, &size2);
+    CHECK_VOID(ret, FAIL, "Hgetimage");
+    if (image == (const void *)copy || size2 <= size) {
+        printf("The image was not copied when written\n");
+        num_errs++;
+    }
+
+    fid = Hopen(IMGFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    free_check(fid, 2, 2, 3000);
+    free_check(fid, 3, 3, 200);
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    ret = Hdeleteimage(IMGFILE_NAME);
+    CHECK_VOID(ret, FAIL, "Hdeleteimage");
+    free(copy);
+}
+
+/* Fails to open a file with the full error stack, then with the last error
+   code alone */
+static void
+test_hfile_errmode(void)
+{
+    int16 full_code;
+    int32 fid;
+    intn  ret;
+
+    MESSAGE(5, printf("Testing the error modes\n"););
+    if (HEget_mode() != HE_MODE_FULL) {
+        printf("The error mode is %d, not HE_MODE_FULL\n", (int)HEget_mode());
+        num_errs++;
+    }
+    fid = Hopen("qqqqqqqq.qqq", DFACC_READ, 0);
+    VERIFY_VOID(fid, FAIL, "Hopen");
+    full_code = HEvalue(1);
+    CHECK_VOID(full_code, DFE_NONE, "HEvalue");
+
+    ret = HEset_mode(HE_MODE_CODE);
+    CHECK_VOID(ret, FAIL, "HEset_mode");
+    if (HEvalue(1) != DFE_NONE) {
+        printf("HEset_mode did not clear the errors\n");
+        num_errs++;
+    }
+    fid = Hopen("qqqqqqqq.qqq", DFACC_READ, 0);
+    VERIFY_VOID(fid, FAIL, "Hopen");
+    VERIFY_VOID(HEvalue(1), full_code, "HEvalue");
+    VERIFY_VOID(HEvalue(2), DFE_NONE, "HEvalue");
+    HEclear();
+    VERIFY_VOID(HEvalue(1), DFE_NONE, "HEvalue");
+
+    ret = HEset_mode(2);
+    VERIFY_VOID(ret, FAIL, "HEset_mode");
+    VERIFY_VOID(HEvalue(1), DFE_ARGS, "HEvalue");
+    ret = HEset_mode(HE_MODE_FULL);
+    CHECK_VOID(ret, FAIL, "HEset_mode");
+    VERIFY_VOID(HEget_mode(), HE_MODE_FULL, "HEget_mode");
+}
+
+#ifdef H4_HAVE_THREADSAFE
+/* What one thread of the thread-safety tests works on */
+typedef struct {
+    int   id;    /* thread number, also the seed of the data */
+    int32 fid;   /* shared file id, FAIL when the thread opens its own file */
+    int   nerrs; /* errors seen by the thread */
+} thread_arg_t;
+
+/* Data of element 'ref' written by thread 'id' */
+static void
+thread_fill(int id, uint16 ref, uint8 *buf)
+{
+    int i;
+
+    for (i = 0; i < BUF_SIZE / 4; i++)
+        buf[i] = (uint8)(id * 31 + ref + i);
+}
+
+/* Reads back and checks the elements of thread 'id' in an open file */
+static int
+thread_check(int32 fid, int id)
+{
+    uint8  in[BUF_SIZE / 4], expected[BUF_SIZE / 4];
+    uint16 ref;
+    int    nerrs = 0;
+
+    for (ref = 1; ref <= THREAD_NELEMS; ref++) {
+        thread_fill(id, ref, expected);
+        if (Hgetelement(fid, (uint16)1000, ref, in) != BUF_SIZE / 4 || memcmp(in, expected, sizeof(in)) != 0)
+            nerrs++;
+    }
+
+    return nerrs;
+}
+
+/* Creates, writes and reads back a file of the thread's own */
+static void *
+thread_own_file(void *varg)
+{
+    thread_arg_t *arg = (thread_arg_t *)varg;
+    char          name[32];
+    uint8         buf[BUF_SIZE / 4];
+    int32         fid;
+    uint16        ref;
+
+    snprintf(name, sizeof(name), "tthread%d.hdf", arg->id);
+    if ((fid = Hopen(name, DFACC_CREATE, 0)) == FAIL) {
+        arg->nerrs++;
+        return NULL;
+    }
+    for (ref = 1; ref <= THREAD_NELEMS; ref++) {
+        thread_fill(arg->id, ref, buf);
+        if (Hputelement(fid, (uint16)1000, ref, buf, (int32)sizeof(buf)) == FAIL)
+            arg->nerrs++;
+    }
+    if (Hclose(fid) == FAIL)
+        arg->nerrs++;
+
+    if ((fid = Hopen(name, DFACC_READ, 0)) == FAIL) {
+        arg->nerrs++;
+        return NULL;
+    }
+    arg->nerrs += thread_check(fid, arg->id);
+    if (Hclose(fid) == FAIL)
+        arg->nerrs++;
+
+    return NULL;
+}
+
+/* Reads the elements of thread 0 through a file id shared by all threads */
+static void *
+thread_shared_file(void *varg)
+{
+    thread_arg_t *arg = (thread_arg_t *)varg;
+    int           pass;
+
+    for (pass = 0; pass < 4; pass++)
+        arg->nerrs += thread_check(arg->fid, 0);
+
+    return NULL;
+}
+
+/* Reads element 1 of the positional read test file, through an access
+   record of the thread's own, a slice at a time from a slice of the thread's
+   own on */
+static void *
+thread_shared_element(void *varg)
+{
+    thread_arg_t *arg = (thread_arg_t *)varg;
+    uint8         in[POSN_STEP];
+    int32         aid, posn;
+    int           pass, i;
+
+    for (pass = 0; pass < 4; pass++) {
+        if ((aid = Hstartread(arg->fid, 1000, 1)) == FAIL) {
+            arg->nerrs++;
+            return NULL;
+        }
+        posn = (arg->id * BUF_SIZE / THREAD_NTHREADS) % BUF_SIZE;
+        for (i = 0; i < BUF_SIZE / POSN_STEP; i++) {
+            if (posn + POSN_STEP > BUF_SIZE)
+                posn = 0;
+            if (Hseek(aid, posn, DF_START) == FAIL || Hread(aid, POSN_STEP, in) != POSN_STEP ||
+                memcmp(in, outbuf + posn, POSN_STEP) != 0)
+                arg->nerrs++;
+            posn += POSN_STEP;
+        }
+        if (Hendaccess(aid) == FAIL)
+            arg->nerrs++;
+    }
+
+    return NULL;
+}
+
+/* Fails to open a file with the last error code alone, leaving the error
+   mode of the other threads */
+static void *
+thread_errmode(void *varg)
+{
+    thread_arg_t *arg = (thread_arg_t *)varg;
+
+    if (HEset_mode(HE_MODE_CODE) == FAIL)
+        arg->nerrs++;
+    if (Hopen("qqqqqqqq.qqq", DFACC_READ, 0) != FAIL || HEvalue(1) == DFE_NONE || HEvalue(2) != DFE_NONE)
+        arg->nerrs++;
+
+    return NULL;
+}
+
+/* Runs 'func' on THREAD_NTHREADS threads and counts their errors */
+static void
+thread_run(void *(*func)(void *), int32 fid, const char *what)
+{
+    pthread_t    threads[THREAD_NTHREADS];
+    thread_arg_t args[THREAD_NTHREADS];
+    int          i;
+
+    for (i = 0; i < THREAD_NTHREADS; i++) {
+        args[i].id    = i;
+        args[i].fid   = fid;
+        args[i].nerrs = 0;
+        if (pthread_create(&threads[i], NULL, func, &args[i]) != 0) {
+            fprintf(stderr, "ERROR: cannot start thread %d for %s\n", i, what);
+            num_errs++;
+            args[i].id = -1;
+        }
+    }
+    for (i = 0; i < THREAD_NTHREADS; i++) {
+        if (args[i].id >= 0)
+            pthread_join(threads[i], NULL);
+        if (args[i].nerrs > 0) {
+            fprintf(stderr, "ERROR: thread %d had %d errors %s\n", i, args[i].nerrs, what);
+            num_errs++;
+        }
+    }
+}
+
+/* Uses the H-level routines from several threads at once */
+static void
+test_hfile_threads(void)
+{
+    int32 fid;
+    int32 ret;
+
+    MESSAGE(5, printf("Testing threads working on files of their own\n"););
+    thread_run(thread_own_file, FAIL, "on their own files");
+
+    MESSAGE(5, printf("Testing threads reading one shared file\n"););
+    fid = Hopen("tthread0.hdf", DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    thread_run(thread_shared_file, fid, "on a shared file");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    MESSAGE(5, printf("Testing threads reading one shared element\n"););
+    fid = Hopen(POSNFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    thread_run(thread_shared_element, fid, "on a shared element");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    MESSAGE(5, printf("Testing the error modes of threads\n"););
+    thread_run(thread_errmode, FAIL, "in their error modes");
+    VERIFY_VOID(HEget_mode(), HE_MODE_FULL, "HEget_mode");
+}
+#endif /* H4_HAVE_THREADSAFE */
 
 void
 test_hfile(void)
 {
     int32  fid, fid1;
-    int32  aid1, aid2;
+    int32  aid1, aid2, aid3;
     int32  fileid, length, offset, posn;
     uint16 tag, ref;
     int16  acc_mode, special;
@@ -187,6 +2229,41 @@ test_hfile(void)
     ret = Hendaccess(aid2);
     CHECK_VOID(ret, FAIL, "Hendaccess");
 
+    MESSAGE(5, printf("Using an ended access id after its slot is reused\n"););
+    aid2 = Hstartread(fid, 100, 1);
+    CHECK_VOID(aid2, FAIL, "Hstartread");
+    if (aid2 == aid1) {
+        fprintf(stderr, "ERROR: got the id of an ended access again\n");
+        errors++;
+    }
+    ret = Hread(aid1, 4, inbuf);
+    VERIFY_VOID(ret, FAIL, "Hread");
+    ret = Hread(aid2, 4, inbuf);
+    VERIFY_VOID(ret, 4, "Hread");
+    ret = Hendaccess(aid2);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    MESSAGE(5, printf("Ending many accesses, ended ids and id 0 stay invalid\n"););
+    for (i = 0; i < 65536; i++) {
+        aid3 = Hstartread(fid, 100, 1);
+        CHECK_VOID(aid3, FAIL, "Hstartread");
+        if (aid3 == 0 || aid3 == aid1 || aid3 == aid2 || HAatom_object(0) != NULL) {
+            fprintf(stderr, "ERROR: got id %ld after %d accesses\n", (long)aid3, i);
+            errors++;
+            break;
+        }
+        ret = Hendaccess(aid3);
+        CHECK_VOID(ret, FAIL, "Hendaccess");
+    }
+    if (HAremove_atom(0) != NULL) {
+        fprintf(stderr, "ERROR: removed atom 0\n");
+        errors++;
+    }
+    ret = Hread(aid2, 4, inbuf);
+    VERIFY_VOID(ret, FAIL, "Hread");
+    ret = Hendaccess(aid2);
+    VERIFY_VOID(ret, FAIL, "Hendaccess");
+
     MESSAGE(5, printf("Attempting to gain multiple access to file (is allowed)\n"););
     fid1 = Hopen(TESTFILE_NAME, DFACC_READ, 0);
     if (fid1 == FAIL) {
@@ -211,4 +2288,29 @@ test_hfile(void)
 
     ret_bool = (intn)Hishdf("qqqqqqqq.qqq"); /* I sure hope it isn't there */
     CHECK_VOID(ret, TRUE, "Hishdf");
+
+    test_hfile_search();
+    test_hfile_mmap();
+    test_hfile_pattern();
+    test_hfile_readv();
+    test_hfile_freespace();
+    test_hfile_alignment();
+    test_hfile_index();
+    test_hfile_indexcache();
+    test_hfile_driver();
+    test_hfile_direct();
+    test_hfile_stream();
+    test_hfile_descriptors();
+    test_hfile_positional();
+    test_hfile_writebuf();
+    test_hfile_bufpolicy();
+    test_hfile_keepopen();
+    test_hfile_ddblocks();
+    test_hfile_compactdd();
+    test_hfile_probe();
+    test_hfile_image();
+    test_hfile_errmode();
+#ifdef H4_HAVE_THREADSAFE
+    test_hfile_threads();
+#endif
 }
@@ -20,12 +20,19 @@
 #define BIG            600
 #define TESTFILE_NAME  "thf"
 #define TESTREF_NAME   "tref.hdf"
+#define TESTOFF_NAME   "toffset.hdf"
+#define TESTRST_NAME   "trestart.hdf"
+#define TESTSTAT_NAME  "tstats.hdf"
 #define MAX_REF_TESTED MAX_REF
 static int32 files[BIG];
 static int32 accs[BIG];
 
 static void test_file_limits(void);
 static void test_ref_limits(void);
+static void test_offset_limits(void);
+static void test_restart_read(void);
+static void test_file_stats(void);
+static void test_trace(void);
 
 static void
 test_file_limits(void)
@@ -202,9 +209,313 @@ test_ref_limits(void)
     }     /* end if */
 } /* end test_ref_limits() */
 
+static void
+test_offset_limits(void)
+{
+    int32 fid, aid;
+    int32 data = 42, data_in = 0;
+    int32 ret;
+
+    MESSAGE(6, printf("Testing offset limits\n"););
+    fid = Hopen(TESTOFF_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    /* an element that would end past MAX_FILE_OFFSET is refused */
+    aid = Hstartwrite(fid, TAG1, 2, MAX_FILE_OFFSET - 10);
+    VERIFY_VOID(aid, FAIL, "Hstartwrite");
+
+    aid = Hstartaccess(fid, TAG1, 1, DFACC_WRITE);
+    CHECK_VOID(aid, FAIL, "Hstartaccess");
+    ret = Hwrite(aid, MAX_FILE_OFFSET - 10, &data);
+    VERIFY_VOID(ret, FAIL, "Hwrite");
+    ret = Hwrite(aid, sizeof(int32), &data);
+    VERIFY_VOID(ret, sizeof(int32), "Hwrite");
+    ret = Hwrite(aid, MAX_FILE_OFFSET - 2, &data);
+    VERIFY_VOID(ret, FAIL, "Hwrite");
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* the refused writes left the file alone */
+    fid = Hopen(TESTOFF_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hgetelement(fid, TAG1, 1, (uint8 *)&data_in);
+    VERIFY_VOID(ret, sizeof(int32), "Hgetelement");
+    VERIFY_VOID(data_in, data, "Hgetelement");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+} /* end test_offset_limits() */
+
+/* Reads plain elements and a linked-block one through one access id moved
+   with Hrestartread(), with a sieve buffer that must not outlive a move */
+static void
+test_restart_read(void)
+{
+    int32  fid, aid;
+    int32  data, data_in;
+    int32  ret;
+    uint16 ref, ref_in;
+
+    MESSAGE(6, printf("Testing Hrestartread\n"););
+    fid = Hopen(TESTRST_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    for (ref = 1; ref <= 8; ref++) {
+        data = (int32)ref * 7;
+        if (ref == 5)
+            aid = HLcreate(fid, TAG1, ref, 16, 4);
+        else
+            aid = Hstartwrite(fid, TAG1, ref, sizeof(int32));
+        CHECK_VOID(aid, FAIL, "Hstartwrite");
+        ret = Hwrite(aid, sizeof(int32), &data);
+        VERIFY_VOID(ret, sizeof(int32), "Hwrite");
+        ret = Hendaccess(aid);
+        CHECK_VOID(ret, FAIL, "Hendaccess");
+    }
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    fid = Hopen(TESTRST_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    aid = Hstartread(fid, TAG1, 8);
+    CHECK_VOID(aid, FAIL, "Hstartread");
+    ret = Hsetsievebuf(aid, 64);
+    CHECK_VOID(ret, FAIL, "Hsetsievebuf");
+
+    for (ref = 8; ref >= 1; ref--) {
+        if (ref != 8) {
+            ret = Hrestartread(aid, TAG1, ref);
+            CHECK_VOID(ret, FAIL, "Hrestartread");
+        }
+        data_in = 0;
+        ret     = Hread(aid, sizeof(int32), &data_in);
+        VERIFY_VOID(ret, sizeof(int32), "Hread");
+        VERIFY_VOID(data_in, (int32)ref * 7, "Hread");
+        ret = Hinquire(aid, NULL, NULL, &ref_in, NULL, NULL, NULL, NULL, NULL);
+        CHECK_VOID(ret, FAIL, "Hinquire");
+        VERIFY_VOID(ref_in, ref, "Hinquire");
+    }
+
+    /* a missing element leaves the access id where it was */
+    ret = Hrestartread(aid, TAG1, 9);
+    VERIFY_VOID(ret, FAIL, "Hrestartread");
+    ret = Hinquire(aid, NULL, NULL, &ref_in, NULL, NULL, NULL, NULL, NULL);
+    CHECK_VOID(ret, FAIL, "Hinquire");
+    VERIFY_VOID(ref_in, 1, "Hinquire");
+
+    /* back to the linked-block element, opened before */
+    ret = Hrestartread(aid, TAG1, 5);
+    CHECK_VOID(ret, FAIL, "Hrestartread");
+    data_in = 0;
+    ret     = Hread(aid, sizeof(int32), &data_in);
+    VERIFY_VOID(ret, sizeof(int32), "Hread");
+    VERIFY_VOID(data_in, 35, "Hread");
+
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+} /* end test_restart_read() */
+
+#define STAT_LEN 1000
+
+/* Checks the I/O statistics of a file kept by the library, for a plain
+   and an RLE compressed element read back */
+static void
+test_file_stats(void)
+{
+    int32       fid, fid2, aid;
+    uint8       data[STAT_LEN], data_in[STAT_LEN];
+    model_info  m_info;
+    comp_info   c_info;
+    hdf_stats_t before, after, other;
+    int32       ret;
+    intn        i;
+
+    MESSAGE(6, printf("Testing Hgetstats\n"););
+    for (i = 0; i < STAT_LEN; i++)
+        data[i] = (uint8)(i / 10);
+
+    fid = Hopen(TESTSTAT_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hputelement(fid, TAG1, 1, data, STAT_LEN);
+    VERIFY_VOID(ret, STAT_LEN, "Hputelement");
+    aid = HCcreate(fid, TAG1, 2, COMP_MODEL_STDIO, &m_info, COMP_CODE_RLE, &c_info);
+    CHECK_VOID(aid, FAIL, "HCcreate");
+    ret = Hwrite(aid, STAT_LEN, data);
+    VERIFY_VOID(ret, STAT_LEN, "Hwrite");
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    ret = Hgetstats(fid, NULL);
+    VERIFY_VOID(ret, FAIL, "Hgetstats");
+    ret = Hgetstats(fid, &after);
+    CHECK_VOID(ret, FAIL, "Hgetstats");
+    if (after.bytes_written < STAT_LEN || after.nwrites == 0) {
+        fprintf(stderr, "Hgetstats: %u bytes written in %u calls\n", (unsigned)after.bytes_written,
+                (unsigned)after.nwrites);
+        num_errs++;
+    }
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    fid = Hopen(TESTSTAT_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hgetstats(fid, &before);
+    CHECK_VOID(ret, FAIL, "Hgetstats");
+    VERIFY_VOID(before.bytes_written, 0, "Hgetstats");
+
+    ret = Hgetelement(fid, TAG1, 1, data_in);
+    VERIFY_VOID(ret, STAT_LEN, "Hgetelement");
+    ret = Hgetstats(fid, &after);
+    CHECK_VOID(ret, FAIL, "Hgetstats");
+    VERIFY_VOID(after.bytes_read - before.bytes_read, STAT_LEN, "Hgetstats");
+    if (after.nreads == before.nreads || after.nlookups == before.nlookups) {
+        fprintf(stderr, "Hgetstats: no read call or DD lookup counted\n");
+        num_errs++;
+    }
+
+    /* the decoded bytes are those read from the element, not from the file */
+    before = after;
+    aid    = Hstartread(fid, TAG1, 2);
+    CHECK_VOID(aid, FAIL, "Hstartread");
+    ret = Hread(aid, STAT_LEN, data_in);
+    VERIFY_VOID(ret, STAT_LEN, "Hread");
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    if (memcmp(data, data_in, STAT_LEN) != 0) {
+        fprintf(stderr, "Hread: wrong data in the compressed element\n");
+        num_errs++;
+    }
+    ret = Hgetstats(fid, &after);
+    CHECK_VOID(ret, FAIL, "Hgetstats");
+    VERIFY_VOID(after.bytes_decoded[COMP_CODE_RLE] - before.bytes_decoded[COMP_CODE_RLE], STAT_LEN,
+                "Hgetstats");
+    VERIFY_VOID(after.bytes_decoded[COMP_CODE_DEFLATE], 0, "Hgetstats");
+    if (after.bytes_read - before.bytes_read >= STAT_LEN) {
+        fprintf(stderr, "Hgetstats: %u bytes read for an RLE element\n",
+                (unsigned)(after.bytes_read - before.bytes_read));
+        num_errs++;
+    }
+
+    /* every ID of the file shares its counters */
+    fid2 = Hopen(TESTSTAT_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid2, FAIL, "Hopen");
+    ret = Hgetstats(fid, &after);
+    CHECK_VOID(ret, FAIL, "Hgetstats");
+    ret = Hgetstats(fid2, &other);
+    CHECK_VOID(ret, FAIL, "Hgetstats");
+    VERIFY_VOID(other.bytes_read, after.bytes_read, "Hgetstats");
+    VERIFY_VOID(other.nlookups, after.nlookups, "Hgetstats");
+    ret = Hclose(fid2);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+} /* end test_file_stats() */
+
+/* Begun and ended phases seen by trace_count(), and the trace nesting */
+static int32 trace_begun[HDF_TRACE_NOPS];
+static int32 trace_ended[HDF_TRACE_NOPS];
+static int32 trace_depth;
+static intn  trace_bad;
+
+static void
+trace_count(hdf_trace_op_t op, intn end, int32 count, void *user_data)
+{
+    if ((int)op < 0 || op >= HDF_TRACE_NOPS || count < 0 || user_data != (void *)trace_begun) {
+        trace_bad = TRUE;
+        return;
+    }
+    if (end) {
+        trace_ended[op]++;
+        if (--trace_depth < 0)
+            trace_bad = TRUE;
+    }
+    else {
+        trace_begun[op]++;
+        trace_depth++;
+    }
+}
+
+/* Checks that the phases of writing and reading back a file are reported to
+   the tracing callback, each end matching a beginning, and no longer once
+   the callback is removed */
+static void
+test_trace(void)
+{
+    int32      fid, aid;
+    uint8      data[STAT_LEN], data_in[STAT_LEN];
+    int32      nums[4] = {1, 2, 3, 4}, nums_out[4];
+    model_info m_info;
+    comp_info  c_info;
+    int32      ret;
+    intn       i, op;
+
+    MESSAGE(6, printf("Testing Hset_trace_callback\n"););
+    for (i = 0; i < STAT_LEN; i++)
+        data[i] = (uint8)(i / 10);
+
+    ret = Hset_trace_callback(trace_count, trace_begun);
+    CHECK_VOID(ret, FAIL, "Hset_trace_callback");
+
+    fid = Hopen(TESTSTAT_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    aid = HCcreate(fid, TAG1, 2, COMP_MODEL_STDIO, &m_info, COMP_CODE_RLE, &c_info);
+    CHECK_VOID(aid, FAIL, "HCcreate");
+    ret = Hwrite(aid, STAT_LEN, data);
+    VERIFY_VOID(ret, STAT_LEN, "Hwrite");
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    fid = Hopen(TESTSTAT_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hgetelement(fid, TAG1, 2, data_in);
+    VERIFY_VOID(ret, STAT_LEN, "Hgetelement");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    ret = DFKconvert(nums, nums_out, DFNT_INT32, 4, DFACC_WRITE, 0, 0);
+    CHECK_VOID(ret, FAIL, "DFKconvert");
+
+    ret = Hset_trace_callback(NULL, NULL);
+    CHECK_VOID(ret, FAIL, "Hset_trace_callback");
+
+    if (trace_bad || trace_depth != 0) {
+        fprintf(stderr, "Hset_trace_callback: bad trace calls, depth %d\n", (int)trace_depth);
+        num_errs++;
+    }
+    for (op = HDF_TRACE_OPEN; op < HDF_TRACE_NOPS; op++)
+        VERIFY_VOID(trace_ended[op], trace_begun[op], "Hset_trace_callback");
+    VERIFY_VOID(trace_begun[HDF_TRACE_OPEN], 2, "Hset_trace_callback");
+    VERIFY_VOID(trace_begun[HDF_TRACE_DD_LOAD], 1, "Hset_trace_callback");
+    VERIFY_VOID(trace_begun[HDF_TRACE_CONVERT], 1, "Hset_trace_callback");
+    if (trace_begun[HDF_TRACE_READ] == 0 || trace_begun[HDF_TRACE_WRITE] == 0 ||
+        trace_begun[HDF_TRACE_DD_FLUSH] == 0 || trace_begun[HDF_TRACE_DECODE] == 0) {
+        fprintf(stderr, "Hset_trace_callback: a phase was not traced\n");
+        num_errs++;
+    }
+    VERIFY_VOID(trace_begun[HDF_TRACE_CHUNK], 0, "Hset_trace_callback");
+
+    /* nothing is reported without a callback */
+    trace_begun[HDF_TRACE_OPEN] = 0;
+    fid                         = Hopen(TESTSTAT_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+    VERIFY_VOID(trace_begun[HDF_TRACE_OPEN], 0, "Hset_trace_callback");
+} /* end test_trace() */
+
 void
 test_hfile1(void)
 {
     test_file_limits();
     test_ref_limits();
+    test_offset_limits();
+    test_restart_read();
+    test_file_stats();
+    test_trace();
 }
@@ -0,0 +1,465 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*
+    FILE - hbench.c
+        Benchmarks for the low-level and Vdata/GR routines of the HDF library
+
+    DESIGN
+        - Time VSwrite and VSread of a multi-field vdata, which packs and
+            unpacks the fields of each record, and VSfpack on its own.
+        - Time GRreadimage of a pixel interlaced image into each interlace.
+        - Time the DFKconvert kernels of the common number types, both
+            contiguous and strided.
+        - Time Hfind over a file with a large DD table, as a forward scan
+            and as lookups of single tag/refs.
+        The data is the same on every run and each figure is the best of
+        BENCH_REPS timings, so that runs of different releases on the same
+        machine can be compared.  The results are written as JSON to the
+        file named on the command line (default: hbench.json).
+
+    BUGS/LIMITATIONS
+        The figures are wallclock times and depend on the machine and on
+        whatever else it is doing; only compare runs made on the same host.
+
+ */
+
+#define TESTMASTER
+
+#include "hdf.h"
+#ifdef H4_HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+#include "tutils.h"
+#include "hfile.h"
+
+#define BENCH_FILE "hbench.hdf"
+#define BENCH_JSON "hbench.json"
+
+/* Number of timings of each benchmark, the best one is reported */
+#define BENCH_REPS 5
+
+/* Vdata benchmarks */
+#define VS_NRECS   100000
+#define VS_FIELDS  "Ident,Temp,Speed,Height"
+#define VS_RECSIZE (4 + 4 + 2 + 8) /* packed size of a record */
+
+/* GR benchmarks */
+#define GR_DIM   1024
+#define GR_NCOMP 3
+
+/* DFKconvert benchmarks */
+#define CONV_NELM (1024 * 1024)
+
+/* Hfind benchmarks */
+#define FIND_TAG     1000
+#define FIND_NDDS    20000
+#define FIND_LOOKUPS 2000
+
+static FILE *json    = NULL; /* where the results go */
+static intn  nresult = 0;    /* number of results written so far */
+
+/* Return the wallclock time in seconds */
+static double
+bench_now(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1.0e6;
+} /* end bench_now() */
+
+/* Write one result, BYTES is the amount of data the benchmark moved */
+static void
+bench_report(const char *name, double seconds, double bytes)
+{
+    double mbps = (seconds > 0.0) ? bytes / seconds / (1024.0 * 1024.0) : 0.0;
+
+    printf("  %-32s %10.6f s %10.2f MB/s\n", name, seconds, mbps);
+    fprintf(json, "%s\n    {\"name\": \"%s\", \"seconds\": %.6f, \"bytes\": %.0f, \"mb_per_s\": %.2f}",
+            nresult ? "," : "", name, seconds, bytes, mbps);
+    nresult++;
+} /* end bench_report() */
+
+/* Keep the best of several timings */
+#define BENCH_BEST(best, t0)                                                                                 \
+    do {                                                                                                     \
+        double bench_t = bench_now() - (t0);                                                                 \
+        if ((best) < 0.0 || bench_t < (best))                                                                \
+            (best) = bench_t;                                                                                \
+    } while (0)
+
+/* VSwrite and VSread of four fields of different sizes, then VSfpack alone */
+static intn
+bench_vdata(void)
+{
+    int32    fid, vsid, vsref;
+    int32   *ident;
+    float32 *temp;
+    int16   *speed;
+    float64 *height;
+    uint8   *buf;
+    void    *fldbufs[4];
+    double   best, t0;
+    intn     rep, i;
+    int32    ret;
+
+    ident  = (int32 *)malloc(VS_NRECS * sizeof(int32));
+    temp   = (float32 *)malloc(VS_NRECS * sizeof(float32));
+    speed  = (int16 *)malloc(VS_NRECS * sizeof(int16));
+    height = (float64 *)malloc(VS_NRECS * sizeof(float64));
+    buf    = (uint8 *)malloc(VS_NRECS * VS_RECSIZE);
+    CHECK(buf, NULL, "malloc");
+    for (i = 0; i < VS_NRECS; i++) {
+        ident[i]  = i;
+        temp[i]   = (float32)(i % 100) / 4.0F;
+        speed[i]  = (int16)(i % 1000);
+        height[i] = (float64)i * 0.5;
+    }
+    fldbufs[0] = ident;
+    fldbufs[1] = temp;
+    fldbufs[2] = speed;
+    fldbufs[3] = height;
+
+    /* A new file each time, so every VSwrite appends the same records */
+    best = -1.0;
+    for (rep = 0; rep < BENCH_REPS; rep++) {
+        fid = Hopen(BENCH_FILE, DFACC_CREATE, 0);
+        CHECK(fid, FAIL, "Hopen");
+        ret = Vstart(fid);
+        CHECK(ret, FAIL, "Vstart");
+        vsid = VSattach(fid, -1, "w");
+        CHECK(vsid, FAIL, "VSattach");
+        ret = VSfdefine(vsid, "Ident", DFNT_INT32, 1);
+        CHECK(ret, FAIL, "VSfdefine");
+        ret = VSfdefine(vsid, "Temp", DFNT_FLOAT32, 1);
+        CHECK(ret, FAIL, "VSfdefine");
+        ret = VSfdefine(vsid, "Speed", DFNT_INT16, 1);
+        CHECK(ret, FAIL, "VSfdefine");
+        ret = VSfdefine(vsid, "Height", DFNT_FLOAT64, 1);
+        CHECK(ret, FAIL, "VSfdefine");
+        ret = VSsetfields(vsid, VS_FIELDS);
+        CHECK(ret, FAIL, "VSsetfields");
+        ret = VSsetname(vsid, "bench");
+        CHECK(ret, FAIL, "VSsetname");
+
+        /* VSfpack needs the fields of the vdata to lay out the records */
+        ret = VSfpack(vsid, _HDF_VSPACK, NULL, buf, VS_NRECS * VS_RECSIZE, VS_NRECS, NULL, fldbufs);
+        CHECK(ret, FAIL, "VSfpack");
+
+        t0  = bench_now();
+        ret = VSwrite(vsid, buf, VS_NRECS, FULL_INTERLACE);
+        BENCH_BEST(best, t0);
+        VERIFY(ret, VS_NRECS, "VSwrite");
+
+        ret = VSdetach(vsid);
+        CHECK(ret, FAIL, "VSdetach");
+        ret = Vend(fid);
+        CHECK(ret, FAIL, "Vend");
+        ret = Hclose(fid);
+        CHECK(ret, FAIL, "Hclose");
+    }
+    bench_report("vs_write_interlaced", best, (double)VS_NRECS * VS_RECSIZE);
+
+    fid = Hopen(BENCH_FILE, DFACC_READ, 0);
+    CHECK(fid, FAIL, "Hopen");
+    ret = Vstart(fid);
+    CHECK(ret, FAIL, "Vstart");
+    vsref = VSfind(fid, "bench");
+    CHECK(vsref, 0, "VSfind");
+    vsid = VSattach(fid, vsref, "r");
+    CHECK(vsid, FAIL, "VSattach");
+
+    /* All the fields, in the order they are stored */
+    ret = VSsetfields(vsid, VS_FIELDS);
+    CHECK(ret, FAIL, "VSsetfields");
+    best = -1.0;
+    for (rep = 0; rep < BENCH_REPS; rep++) {
+        ret = VSseek(vsid, 0);
+        CHECK(ret, FAIL, "VSseek");
+        t0  = bench_now();
+        ret = VSread(vsid, buf, VS_NRECS, FULL_INTERLACE);
+        BENCH_BEST(best, t0);
+        VERIFY(ret, VS_NRECS, "VSread");
+    }
+    bench_report("vs_read_interlaced", best, (double)VS_NRECS * VS_RECSIZE);
+
+    /* Two of the fields, reordered and not interlaced */
+    ret = VSsetfields(vsid, "Height,Ident");
+    CHECK(ret, FAIL, "VSsetfields");
+    best = -1.0;
+    for (rep = 0; rep < BENCH_REPS; rep++) {
+        ret = VSseek(vsid, 0);
+        CHECK(ret, FAIL, "VSseek");
+        t0  = bench_now();
+        ret = VSread(vsid, buf, VS_NRECS, NO_INTERLACE);
+        BENCH_BEST(best, t0);
+        VERIFY(ret, VS_NRECS, "VSread");
+    }
+    bench_report("vs_read_subset_nointerlace", best, (double)VS_NRECS * (8 + 4));
+
+    /* Packing and unpacking of the record buffer, without any I/O */
+    ret = VSsetfields(vsid, VS_FIELDS);
+    CHECK(ret, FAIL, "VSsetfields");
+    best = -1.0;
+    for (rep = 0; rep < BENCH_REPS; rep++) {
+        t0  = bench_now();
+        ret = VSfpack(vsid, _HDF_VSPACK, NULL, buf, VS_NRECS * VS_RECSIZE, VS_NRECS, NULL, fldbufs);
+        CHECK(ret, FAIL, "VSfpack");
+        ret = VSfpack(vsid, _HDF_VSUNPACK, NULL, buf, VS_NRECS * VS_RECSIZE, VS_NRECS, NULL, fldbufs);
+        BENCH_BEST(best, t0);
+        CHECK(ret, FAIL, "VSfpack");
+    }
+    bench_report("vs_fpack_unpack", best, 2.0 * VS_NRECS * VS_RECSIZE);
+
+    ret = VSdetach(vsid);
+    CHECK(ret, FAIL, "VSdetach");
+    ret = Vend(fid);
+    CHECK(ret, FAIL, "Vend");
+    ret = Hclose(fid);
+    CHECK(ret, FAIL, "Hclose");
+
+    free(ident);
+    free(temp);
+    free(speed);
+    free(height);
+    free(buf);
+    return num_errs;
+} /* end bench_vdata() */
+
+/* GRreadimage of a pixel interlaced image into each of the interlace modes */
+static intn
+bench_grimage(void)
+{
+    const char *names[] = {"gr_read_pixel_il", "gr_read_line_il", "gr_read_component_il"};
+    int32       fid, grid, riid;
+    int32       dims[2], start[2], edges[2];
+    uint8      *image, *readbuf;
+    double      best, t0;
+    intn        rep, il, i;
+    int32       ret;
+
+    image   = (uint8 *)malloc(GR_DIM * GR_DIM * GR_NCOMP);
+    readbuf = (uint8 *)malloc(GR_DIM * GR_DIM * GR_NCOMP);
+    CHECK(readbuf, NULL, "malloc");
+    for (i = 0; i < GR_DIM * GR_DIM * GR_NCOMP; i++)
+        image[i] = (uint8)((i * 7) % 251);
+
+    fid = Hopen(BENCH_FILE, DFACC_CREATE, 0);
+    CHECK(fid, FAIL, "Hopen");
+    grid = GRstart(fid);
+    CHECK(grid, FAIL, "GRstart");
+    dims[0] = dims[1] = GR_DIM;
+    riid              = GRcreate(grid, "bench", GR_NCOMP, DFNT_UINT8, MFGR_INTERLACE_PIXEL, dims);
+    CHECK(riid, FAIL, "GRcreate");
+    start[0] = start[1] = 0;
+    edges[0] = edges[1] = GR_DIM;
+    ret                 = GRwriteimage(riid, start, NULL, edges, image);
+    CHECK(ret, FAIL, "GRwriteimage");
+    ret = GRendaccess(riid);
+    CHECK(ret, FAIL, "GRendaccess");
+    ret = GRend(grid);
+    CHECK(ret, FAIL, "GRend");
+    ret = Hclose(fid);
+    CHECK(ret, FAIL, "Hclose");
+
+    fid = Hopen(BENCH_FILE, DFACC_READ, 0);
+    CHECK(fid, FAIL, "Hopen");
+    grid = GRstart(fid);
+    CHECK(grid, FAIL, "GRstart");
+    riid = GRselect(grid, 0);
+    CHECK(riid, FAIL, "GRselect");
+    for (il = MFGR_INTERLACE_PIXEL; il <= MFGR_INTERLACE_COMPONENT; il++) {
+        ret = GRreqimageil(riid, il);
+        CHECK(ret, FAIL, "GRreqimageil");
+        best = -1.0;
+        for (rep = 0; rep < BENCH_REPS; rep++) {
+            t0  = bench_now();
+            ret = GRreadimage(riid, start, NULL, edges, readbuf);
+            BENCH_BEST(best, t0);
+            CHECK(ret, FAIL, "GRreadimage");
+        }
+        bench_report(names[il], best, (double)GR_DIM * GR_DIM * GR_NCOMP);
+    }
+    ret = GRendaccess(riid);
+    CHECK(ret, FAIL, "GRendaccess");
+    ret = GRend(grid);
+    CHECK(ret, FAIL, "GRend");
+    ret = Hclose(fid);
+    CHECK(ret, FAIL, "Hclose");
+
+    free(image);
+    free(readbuf);
+    return num_errs;
+} /* end bench_grimage() */
+
+/* DFKconvert from the file form of each type to the native one */
+static intn
+bench_convert(void)
+{
+    struct {
+        const char *name;
+        int32       ntype;
+        int32       size;
+    } types[] = {{"conv_int16", DFNT_INT16, 2},
+                 {"conv_int32", DFNT_INT32, 4},
+                 {"conv_float32", DFNT_FLOAT32, 4},
+                 {"conv_float64", DFNT_FLOAT64, 8}};
+    char    name[64];
+    uint8  *src, *dst;
+    double  best, t0;
+    intn    t, rep, i;
+    int32   ret;
+
+    src = (uint8 *)malloc(CONV_NELM * 8);
+    dst = (uint8 *)malloc(CONV_NELM * 8);
+    CHECK(dst, NULL, "malloc");
+    for (i = 0; i < CONV_NELM * 8; i++)
+        src[i] = (uint8)(i % 61);
+
+    for (t = 0; t < (intn)(sizeof(types) / sizeof(types[0])); t++) {
+        best = -1.0;
+        for (rep = 0; rep < BENCH_REPS; rep++) {
+            t0  = bench_now();
+            ret = DFKconvert(src, dst, types[t].ntype, CONV_NELM, DFACC_READ, 0, 0);
+            BENCH_BEST(best, t0);
+            CHECK(ret, FAIL, "DFKconvert");
+        }
+        bench_report(types[t].name, best, (double)CONV_NELM * types[t].size);
+
+        /* Every other element of the source, as a strided read does */
+        best = -1.0;
+        for (rep = 0; rep < BENCH_REPS; rep++) {
+            t0  = bench_now();
+            ret = DFKconvert(src, dst, types[t].ntype, CONV_NELM / 2, DFACC_READ, 2 * types[t].size,
+                             types[t].size);
+            BENCH_BEST(best, t0);
+            CHECK(ret, FAIL, "DFKconvert");
+        }
+        snprintf(name, sizeof(name), "%s_strided", types[t].name);
+        bench_report(name, best, (double)CONV_NELM / 2 * types[t].size);
+    }
+
+    free(src);
+    free(dst);
+    return num_errs;
+} /* end bench_convert() */
+
+/* Hfind over FIND_NDDS elements of the same tag */
+static intn
+bench_hfind(void)
+{
+    int32  fid;
+    uint16 find_tag, find_ref;
+    int32  find_off, find_len;
+    uint8  data[4] = {1, 2, 3, 4};
+    double best, t0;
+    intn   rep, i, nfound;
+    int32  ret;
+
+    fid = Hopen(BENCH_FILE, DFACC_CREATE, 0);
+    CHECK(fid, FAIL, "Hopen");
+    for (i = 1; i <= FIND_NDDS; i++) {
+        ret = Hputelement(fid, FIND_TAG, (uint16)i, data, sizeof(data));
+        CHECK(ret, FAIL, "Hputelement");
+    }
+    ret = Hclose(fid);
+    CHECK(ret, FAIL, "Hclose");
+
+    /* The time to open includes reading in the DD table */
+    best = -1.0;
+    for (rep = 0; rep < BENCH_REPS; rep++) {
+        t0  = bench_now();
+        fid = Hopen(BENCH_FILE, DFACC_READ, 0);
+        BENCH_BEST(best, t0);
+        CHECK(fid, FAIL, "Hopen");
+        ret = Hclose(fid);
+        CHECK(ret, FAIL, "Hclose");
+    }
+    bench_report("hopen_large_dd_table", best, (double)FIND_NDDS * 12);
+
+    fid = Hopen(BENCH_FILE, DFACC_READ, 0);
+    CHECK(fid, FAIL, "Hopen");
+
+    /* Every DD in turn, the way the higher level interfaces walk a file */
+    best = -1.0;
+    for (rep = 0; rep < BENCH_REPS; rep++) {
+        nfound   = 0;
+        find_tag = find_ref = 0;
+        t0                  = bench_now();
+        while (Hfind(fid, FIND_TAG, DFREF_WILDCARD, &find_tag, &find_ref, &find_off, &find_len, DF_FORWARD) ==
+               SUCCEED)
+            nfound++;
+        BENCH_BEST(best, t0);
+        VERIFY(nfound, FIND_NDDS, "Hfind");
+    }
+    bench_report("hfind_scan", best, (double)FIND_NDDS * 12);
+
+    /* Single tag/refs spread over the table */
+    best = -1.0;
+    for (rep = 0; rep < BENCH_REPS; rep++) {
+        t0 = bench_now();
+        for (i = 0; i < FIND_LOOKUPS; i++) {
+            find_tag = find_ref = 0;
+            ret = Hfind(fid, FIND_TAG, (uint16)(1 + (i * 7919) % FIND_NDDS), &find_tag, &find_ref, &find_off,
+                        &find_len, DF_FORWARD);
+            CHECK(ret, FAIL, "Hfind");
+        }
+        BENCH_BEST(best, t0);
+    }
+    bench_report("hfind_lookup", best, (double)FIND_LOOKUPS * 12);
+
+    ret = Hclose(fid);
+    CHECK(ret, FAIL, "Hclose");
+    return num_errs;
+} /* end bench_hfind() */
+
+int
+main(int argc, char *argv[])
+{
+    const char *outname = (argc > 1) ? argv[1] : BENCH_JSON;
+    char        version[LIBVSTR_LEN + 1];
+    uint32      majorv, minorv, releasev;
+
+    if (argc > 2) {
+        printf("\nUsage: hbench [output.json]\n\n");
+        return 1;
+    }
+    if ((json = fopen(outname, "w")) == NULL) {
+        printf("*** Cannot create %s\n", outname);
+        return 1;
+    }
+    Hgetlibversion(&majorv, &minorv, &releasev, version);
+    fprintf(json, "{\n  \"suite\": \"hdf\",\n  \"library\": \"%u.%u.%u\",\n  \"results\": [",
+            (unsigned)majorv, (unsigned)minorv, (unsigned)releasev);
+
+    printf("HDF benchmarks, best of %d runs\n", BENCH_REPS);
+    if (num_errs == 0)
+        bench_vdata();
+    if (num_errs == 0)
+        bench_grimage();
+    if (num_errs == 0)
+        bench_convert();
+    if (num_errs == 0)
+        bench_hfind();
+
+    fprintf(json, "\n  ]\n}\n");
+    fclose(json);
+    remove(BENCH_FILE);
+
+    if (num_errs != 0)
+        printf("*** %d errors in the benchmarks\n", num_errs);
+    else
+        printf("Results written to %s\n", outname);
+    return num_errs;
+} /* end main() */
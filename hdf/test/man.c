@@ -34,6 +34,9 @@
  *    it should suffice to test the internals) while preserving
  *    original tag/ref of element.
  *
+ * 5. Looks up the labels of many objects, some added after the labels
+ *    of the file were first looked up.
+ *
  *************************************************************/
 
 /* includes */
@@ -43,6 +46,8 @@
 #define ROWS     10         /* row size of dataset/image */
 #define COLS     10         /* column size of dataset/image */
 #define REPS     3          /* number of images/data sets to write to file */
+#define NOBJS    60         /* number of objects labelled by check_obj_labels() */
+#define OBJ_TAG  1000       /* tag of those objects */
 
 /* File labels/descriptions to write */
 static const char *file_lab[3] = {"File label #1: aaa", "File label #2: bbbbbb", "File label #3: cccc"};
@@ -77,6 +82,8 @@ static int32 check_fann(const char *fname);
 static int32 check_lab_desc(const char *fname, uint16 tag, uint16 ref, const char *label[],
                             const char *desc[]);
 
+static int32 check_obj_labels(const char *fname);
+
 /****************************************************************
 **
 **  gen2Dfloat:  generate 2-D data array
@@ -612,6 +619,77 @@ check_lab_desc(const char *fname, uint16 tag, uint16 ref, const char *label[], c
     return SUCCEED;
 } /* check_lab_desc() */
 
+/****************************************************************
+**
+**  check_obj_labels:  Gives object 'ref' of OBJ_TAG (ref % 4) labels,
+**                     half of them while the labels of the file are
+**                     being looked up and half of them before, and
+**                     checks each object gets its own labels back.
+**
+****************************************************************/
+static int32
+check_obj_labels(const char *fname)
+{
+    int32 ret = SUCCEED; /* return value */
+    int32 file_handle;   /* file handle */
+    int32 an_handle;     /* annotation interface handle */
+    int32 ann_handle;    /* annotation handle */
+    int32 ann_list[4];   /* labels of an object */
+    char  lab[32];       /* label written */
+    char  rlab[32];      /* label read back */
+    int   pass, ref, i, n;
+
+    for (pass = 0; pass < 2; pass++) {
+        ret = file_handle = Hopen(fname, DFACC_RDWR, 0);
+        RESULT("Hopen");
+        ret = an_handle = ANstart(file_handle);
+        RESULT("ANstart");
+
+        /* the second half is added once the labels have been looked up */
+        if (pass == 1) {
+            ret = ANnumann(an_handle, AN_DATA_LABEL, OBJ_TAG, 1);
+            RESULT("ANnumann");
+        }
+        for (ref = 1 + pass; ref <= NOBJS; ref += 2)
+            for (i = 0; i < ref % 4; i++) {
+                snprintf(lab, sizeof(lab), "Object %d label %d", ref, i);
+                ret = ann_handle = ANcreate(an_handle, OBJ_TAG, (uint16)ref, AN_DATA_LABEL);
+                RESULT("ANcreate");
+                ret = ANwriteann(ann_handle, lab, (int32)strlen(lab));
+                RESULT("ANwriteann");
+                ret = ANendaccess(ann_handle);
+                RESULT("ANendaccess");
+            }
+
+        /* all the labels are found, in the file and not yet written out */
+        for (ref = 1; ref <= NOBJS; ref++) {
+            n = ANnumann(an_handle, AN_DATA_LABEL, OBJ_TAG, (uint16)ref);
+            VERIFY(n, (pass == 1 || ref % 2 == 1 ? ref % 4 : 0), "ANnumann");
+            ret = ANannlist(an_handle, AN_DATA_LABEL, OBJ_TAG, (uint16)ref, ann_list);
+            VERIFY(ret, n, "ANannlist");
+            for (i = 0; i < n; i++) {
+                memset(rlab, 0, sizeof(rlab));
+                ret = ANreadann(ann_list[i], rlab, (int32)sizeof(rlab));
+                RESULT("ANreadann");
+                snprintf(lab, sizeof(lab), "Object %d label ", ref);
+                if (strncmp(rlab, lab, strlen(lab)) != 0) {
+                    printf("Label \"%s\" found for object %d\n", rlab, ref);
+                    num_errs++;
+                }
+                ret = ANendaccess(ann_list[i]);
+                RESULT("ANendaccess");
+            }
+        }
+
+        ret = ANend(an_handle);
+        RESULT("ANend");
+        ret = Hclose(file_handle);
+        RESULT("Hclose");
+    }
+
+    return SUCCEED;
+} /* check_obj_labels() */
+
 /****************************************************************
 **
 **  test_man(): Main annotation test routine
@@ -638,7 +716,8 @@ check_lab_desc(const char *fname, uint16 tag, uint16 ref, const char *label[], c
 **     C. Get image ref and image
 **     D. Verify label and descriptions for Image->check_lab_desc()
 **  9. Check file labels and descriptions->check_fann()
-** 10. Clean up.
+** 10. Look up the labels of many objects->check_obj_labels()
+** 11. Clean up.
 ****************************************************************/
 void
 test_man(void)
@@ -819,6 +898,10 @@ test_man(void)
     if (check_fann_rewrite(TESTFILE) == FAIL)
         return; /* end of test */
 
+    /* check the labels of many objects are told apart */
+    if (check_obj_labels(TESTFILE) == FAIL)
+        return; /* end of test */
+
     /* free up space */
     free(data);
     free(image);
@@ -1050,6 +1050,8 @@ static void test_mgr_image_b2b1(int flag);
 static void test_mgr_image(int flag);
 static void test_mgr_index(int flag);
 static void test_mgr_interlace(int flag);
+static void test_mgr_interlace_convert(void);
+static void test_mgr_overviews(void);
 static void test_mgr_lut(int flag);
 static void test_mgr_special(int flag);
 extern void test_mgr_attr();
@@ -1892,6 +1894,19 @@ test_mgr_image_b2a1bb2(int flag)
             num_errs++;
         } /* end if */
 
+        /* Prefetch the same sub-set, then read it back again */
+        ret = GRprefetch(riid, start, count);
+        CHECK_VOID(ret, FAIL, "GRprefetch");
+        memset(image, 255, sizeof(image));
+        ret = GRreadimage(riid, start, stride, count, image);
+        CHECK_VOID(ret, FAIL, "GRreadimage");
+
+        if (0 != memcmp(image, sub_image, (size_t)(count[XDIM] * count[YDIM]) * sizeof(fill_pixel))) {
+            MESSAGE(3, printf("%d:Error reading prefetched sub-set of new image with default fill-value\n",
+                              __LINE__););
+            num_errs++;
+        } /* end if */
+
         /* check if we are doing chunked tests */
         if (flag) {
             /* Get chunk lengths */
@@ -3019,6 +3034,227 @@ test_mgr_index(int flag)
     /* I believe that these are adequately tested in the test_mgr_image routine -QAK */
 } /* end test_mgr_index() */
 
+/****************************************************************
+**
+**  test_mgr_interlace_convert(): Checks GRIil_convert() on small
+**      images against the layouts of the interlace schemes, for
+**      several numbers and sizes of components.
+**
+****************************************************************/
+#define ILC_XDIM 5
+#define ILC_YDIM 3
+static void
+test_mgr_interlace_convert(void)
+{
+    static const int32 nts[3] = {DFNT_UINT8, DFNT_UINT16, DFNT_INT32};
+    uint8              pixels[ILC_XDIM * ILC_YDIM * 5 * 4];
+    uint8              planes[ILC_XDIM * ILC_YDIM * 5 * 4];
+    uint8              back[ILC_XDIM * ILC_YDIM * 5 * 4];
+    int32              dims[2] = {ILC_XDIM, ILC_YDIM};
+    int32              ncomp;
+    intn               i, n, il, x, y, k, b, size;
+    size_t             in_off, out_off;
+    intn               ret;
+
+    MESSAGE(6, printf("Testing interlace conversions\n"););
+    for (i = 0; i < (intn)sizeof(pixels); i++)
+        pixels[i] = (uint8)(i * 7 + 1);
+
+    for (n = 0; n < 3; n++)
+        for (ncomp = 1; ncomp <= 5; ncomp++)
+            for (il = (intn)MFGR_INTERLACE_LINE; il <= (intn)MFGR_INTERLACE_COMPONENT; il++) {
+                size = DFKNTsize(nts[n] | DFNT_NATIVE);
+                memset(planes, 0, sizeof(planes));
+                ret = GRIil_convert(pixels, MFGR_INTERLACE_PIXEL, planes, (gr_interlace_t)il, dims, ncomp,
+                                    nts[n]);
+                CHECK_VOID(ret, FAIL, "GRIil_convert");
+
+                for (y = 0; y < ILC_YDIM; y++)
+                    for (x = 0; x < ILC_XDIM; x++)
+                        for (k = 0; k < ncomp; k++)
+                            for (b = 0; b < size; b++) {
+                                in_off = (size_t)(((y * ILC_XDIM + x) * ncomp + k) * size + b);
+                                if (il == (intn)MFGR_INTERLACE_LINE)
+                                    out_off = (size_t)(((y * ncomp + k) * ILC_XDIM + x) * size + b);
+                                else
+                                    out_off = (size_t)(((k * ILC_YDIM + y) * ILC_XDIM + x) * size + b);
+                                if (planes[out_off] != pixels[in_off]) {
+                                    MESSAGE(3, printf("Wrong interlace %d of nt %d, %d components at pixel "
+                                                      "(%d,%d)\n",
+                                                      il, (int)nts[n], (int)ncomp, x, y););
+                                    num_errs++;
+                                    return;
+                                }
+                            }
+
+                memset(back, 0, sizeof(back));
+                ret = GRIil_convert(planes, (gr_interlace_t)il, back, MFGR_INTERLACE_PIXEL, dims, ncomp,
+                                    nts[n]);
+                CHECK_VOID(ret, FAIL, "GRIil_convert");
+                if (memcmp(back, pixels, (size_t)(ILC_XDIM * ILC_YDIM * ncomp * size)) != 0) {
+                    MESSAGE(3, printf("Wrong pixel interlace from interlace %d of nt %d, %d components\n", il,
+                                      (int)nts[n], (int)ncomp););
+                    num_errs++;
+                }
+            }
+} /* end test_mgr_interlace_convert() */
+
+/****************************************************************
+**
+**  test_mgr_overviews(): Checks GRbuildoverviews() and
+**      GRreadimage_level() on a chunked, compressed image: the
+**      decimated values and the chunking of each level, reading a
+**      level in another interlace, and rebuilding the levels.
+**
+****************************************************************/
+#define OVR_FILE  "tmgrovr.hdf"
+#define OVR_XDIM  13
+#define OVR_YDIM  7
+#define OVR_NCOMP 2
+#define OVR_VAL(x, y, k) ((uint16)((x) * 100 + (y) * 10 + (k)))
+static void
+test_mgr_overviews(void)
+{
+    int32         fid, grid, riid, ovrid;
+    int32         dims[2]     = {OVR_XDIM, OVR_YDIM};
+    int32         start[2]    = {0, 0};
+    int32         count[2];
+    int32         n_datasets, n_attrs;
+    uint16        image[OVR_YDIM][OVR_XDIM][OVR_NCOMP];
+    uint16        level_data[OVR_YDIM * OVR_XDIM * OVR_NCOMP];
+    HDF_CHUNK_DEF chunk_def;
+    int32         chunk_flags;
+    intn          level, x, y, k;
+    intn          ret;
+
+    MESSAGE(6, printf("Testing GR overviews\n"););
+
+    for (y = 0; y < OVR_YDIM; y++)
+        for (x = 0; x < OVR_XDIM; x++)
+            for (k = 0; k < OVR_NCOMP; k++)
+                image[y][x][k] = OVR_VAL(x, y, k);
+
+    fid = Hopen(OVR_FILE, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    grid = GRstart(fid);
+    CHECK_VOID(grid, FAIL, "GRstart");
+    riid = GRcreate(grid, "ovr", OVR_NCOMP, DFNT_UINT16, MFGR_INTERLACE_PIXEL, dims);
+    CHECK_VOID(riid, FAIL, "GRcreate");
+
+    chunk_def.comp.chunk_lengths[0]    = 4;
+    chunk_def.comp.chunk_lengths[1]    = 3;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 6;
+    ret = GRsetchunk(riid, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK_VOID(ret, FAIL, "GRsetchunk");
+    ret = GRwriteimage(riid, start, NULL, dims, image);
+    CHECK_VOID(ret, FAIL, "GRwriteimage");
+
+    ret = GRbuildoverviews(riid, 3);
+    CHECK_VOID(ret, FAIL, "GRbuildoverviews");
+
+    /* each level keeps every other pixel of every other line of the one above */
+    count[0] = OVR_XDIM;
+    count[1] = OVR_YDIM;
+    for (level = 0; level <= 3; level++) {
+        memset(level_data, 0, sizeof(level_data));
+        ret = GRreadimage_level(riid, level, start, NULL, count, level_data);
+        CHECK_VOID(ret, FAIL, "GRreadimage_level");
+        for (y = 0; y < count[1]; y++)
+            for (x = 0; x < count[0]; x++)
+                for (k = 0; k < OVR_NCOMP; k++)
+                    if (level_data[(y * count[0] + x) * OVR_NCOMP + k] != OVR_VAL(x << level, y << level, k)) {
+                        MESSAGE(3, printf("Wrong value at (%d,%d) of overview level %d\n", x, y, level););
+                        num_errs++;
+                        break;
+                    }
+        count[0] = (count[0] + 1) / 2;
+        count[1] = (count[1] + 1) / 2;
+    }
+
+    /* there are only three levels */
+    ret = GRreadimage_level(riid, 4, start, NULL, count, level_data);
+    VERIFY_VOID(ret, FAIL, "GRreadimage_level");
+
+    /* a window of level 1, in component interlace */
+    ret = GRreqimageil(riid, MFGR_INTERLACE_COMPONENT);
+    CHECK_VOID(ret, FAIL, "GRreqimageil");
+    start[0] = 1;
+    start[1] = 2;
+    count[0] = 3;
+    count[1] = 2;
+    ret      = GRreadimage_level(riid, 1, start, NULL, count, level_data);
+    CHECK_VOID(ret, FAIL, "GRreadimage_level");
+    for (k = 0; k < OVR_NCOMP; k++)
+        for (y = 0; y < 2; y++)
+            for (x = 0; x < 3; x++)
+                if (level_data[(k * 2 + y) * 3 + x] != OVR_VAL((x + 1) * 2, (y + 2) * 2, k)) {
+                    MESSAGE(3, printf("Wrong value at (%d,%d) of the level 1 window\n", x, y););
+                    num_errs++;
+                }
+    start[0] = start[1] = 0;
+
+    /* the levels are chunked like the image, with the chunks clamped */
+    ovrid = GRselect(grid, GRnametoindex(grid, "ovr.overview3"));
+    CHECK_VOID(ovrid, FAIL, "GRselect");
+    ret = GRgetchunkinfo(ovrid, &chunk_def, &chunk_flags);
+    CHECK_VOID(ret, FAIL, "GRgetchunkinfo");
+    VERIFY_VOID(chunk_flags, (HDF_CHUNK | HDF_COMP), "GRgetchunkinfo");
+    VERIFY_VOID(chunk_def.chunk_lengths[0], 2, "GRgetchunkinfo");
+    VERIFY_VOID(chunk_def.chunk_lengths[1], 1, "GRgetchunkinfo");
+    ret = GRendaccess(ovrid);
+    CHECK_VOID(ret, FAIL, "GRendaccess");
+
+    ret = GRendaccess(riid);
+    CHECK_VOID(ret, FAIL, "GRendaccess");
+    ret = GRend(grid);
+    CHECK_VOID(ret, FAIL, "GRend");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* change the image, then rebuild two levels in place */
+    fid = Hopen(OVR_FILE, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    grid = GRstart(fid);
+    CHECK_VOID(grid, FAIL, "GRstart");
+    riid = GRselect(grid, GRnametoindex(grid, "ovr"));
+    CHECK_VOID(riid, FAIL, "GRselect");
+
+    for (y = 0; y < OVR_YDIM; y++)
+        for (x = 0; x < OVR_XDIM; x++)
+            for (k = 0; k < OVR_NCOMP; k++)
+                image[y][x][k] = (uint16)(OVR_VAL(x, y, k) + 1);
+    ret = GRwriteimage(riid, start, NULL, dims, image);
+    CHECK_VOID(ret, FAIL, "GRwriteimage");
+    ret = GRbuildoverviews(riid, 2);
+    CHECK_VOID(ret, FAIL, "GRbuildoverviews");
+
+    ret = (intn)GRfileinfo(grid, &n_datasets, &n_attrs);
+    CHECK_VOID(ret, FAIL, "GRfileinfo");
+    VERIFY_VOID(n_datasets, 4, "GRfileinfo");
+
+    count[0] = 4;
+    count[1] = 2;
+    ret      = GRreadimage_level(riid, 2, start, NULL, count, level_data);
+    CHECK_VOID(ret, FAIL, "GRreadimage_level");
+    for (y = 0; y < 2; y++)
+        for (x = 0; x < 4; x++)
+            for (k = 0; k < OVR_NCOMP; k++)
+                if (level_data[(y * 4 + x) * OVR_NCOMP + k] != (uint16)(OVR_VAL(x * 4, y * 4, k) + 1)) {
+                    MESSAGE(3, printf("Wrong value at (%d,%d) of rebuilt level 2\n", x, y););
+                    num_errs++;
+                }
+    ret = GRreadimage_level(riid, 3, start, NULL, count, level_data);
+    VERIFY_VOID(ret, FAIL, "GRreadimage_level");
+
+    ret = GRendaccess(riid);
+    CHECK_VOID(ret, FAIL, "GRendaccess");
+    ret = GRend(grid);
+    CHECK_VOID(ret, FAIL, "GRend");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+} /* end test_mgr_overviews() */
+
 /****************************************************************
 **
 **  test_mgr_interlace(): Multi-file Raster Interlace Test Routine
@@ -4339,6 +4575,15 @@ test_mgr_chunkwr_pixelone()
         status = GRsetchunk(ri_id[i], chunk_def, comp_flag);
         CHECK_VOID(status, FAIL, "GRsetchunk");
 
+        /*
+         * Deflate the GZIP chunks on several threads, they are then
+         * written when the image is closed.
+         */
+        if (comp_flag != HDF_CHUNK && chunk_def.comp.comp_type == COMP_CODE_DEFLATE) {
+            status = GRsetchunkthreads(ri_id[i], 4);
+            VERIFY_VOID(status, 1, "GRsetchunkthreads");
+        }
+
         /*
          * Write first data chunk ( 0, 0 ).
          */
@@ -4764,6 +5009,8 @@ test_mgr(void)
     test_mgr_index(0);
     test_mgr_interlace(0); /* read from normal GR */
     test_mgr_interlace(1); /* read from chunked GR */
+    test_mgr_interlace_convert();
+    test_mgr_overviews();
     test_mgr_lut(0);
     test_mgr_special(0);
     test_mgr_attr();
@@ -124,6 +124,14 @@
 #define NBIT_MASK12A 0x0000001f
 #define NBIT_MASK12B 0xffffffffUL
 
+#define NBIT_TAG13    1012
+#define NBIT_REF13    1012
+#define NBIT_SIZE13   4096
+#define NBIT_BITS13   11
+#define NBIT_OFF13    12
+#define NBIT_WPIECE13 7 /* bytes written at a time, not a whole number */
+#define NBIT_RPIECE13 5 /* bytes read at a time, not a whole number */
+
 static void test_nbit1(int32 fid);
 static void test_nbit2(int32 fid);
 static void test_nbit3(int32 fid);
@@ -136,6 +144,7 @@ static void test_nbit9(int32 fid);
 static void test_nbit10(int32 fid);
 static void test_nbit11(int32 fid);
 static void test_nbit12(int32 fid);
+static void test_nbit13(int32 fid);
 
 static void
 test_nbit1(int32 fid)
@@ -1023,6 +1032,90 @@ test_nbit12(int32 fid)
     num_errs += errors;
 }
 
+static void
+test_nbit13(int32 fid)
+{
+    int32      aid1;
+    uint16     ref1;
+    int        i;
+    int32      ret, len, total;
+    intn       errors = 0;
+    model_info m_info;
+    comp_info  c_info;
+    int16     *outbuf, *inbuf;
+    uint8     *convbuf;
+
+    outbuf  = (int16 *)malloc(NBIT_SIZE13 * sizeof(int16));
+    inbuf   = (int16 *)malloc(NBIT_SIZE13 * sizeof(int16));
+    convbuf = (uint8 *)malloc(NBIT_SIZE13 * (size_t)DFKNTsize(DFNT_INT16));
+
+    for (i = 0; i < NBIT_SIZE13; i++) /* fill with values that fit the bit-field */
+        outbuf[i] = (int16)((((i * 37) % 2048) - 1024) * (1 << ((NBIT_OFF13 - NBIT_BITS13) + 1)));
+
+    ref1 = Hnewref(fid);
+    CHECK_VOID(ref1, 0, "Hnewref");
+
+    MESSAGE(5, printf("Create a new element as a signed 16-bit n-bit element, written in pieces\n"););
+    c_info.nbit.nt        = DFNT_INT16;
+    c_info.nbit.sign_ext  = TRUE;
+    c_info.nbit.fill_one  = FALSE;
+    c_info.nbit.start_bit = NBIT_OFF13;
+    c_info.nbit.bit_len   = NBIT_BITS13;
+    aid1 = HCcreate(fid, NBIT_TAG13, ref1, COMP_MODEL_STDIO, &m_info, COMP_CODE_NBIT, &c_info);
+    CHECK_VOID(aid1, FAIL, "HCcreate");
+
+    ret = DFKconvert(outbuf, convbuf, DFNT_INT16, NBIT_SIZE13, DFACC_WRITE, 0, 0);
+    CHECK_VOID(ret, FAIL, "DFKconvert");
+
+    /* pieces which split the numbers mix whole numbers and single bytes */
+    total = NBIT_SIZE13 * DFKNTsize(DFNT_INT16);
+    for (i = 0; i < total; i += len) {
+        len = MIN(NBIT_WPIECE13, total - i);
+        ret = Hwrite(aid1, len, convbuf + i);
+        if (ret != len) {
+            fprintf(stderr, "ERROR(%d): Hwrite returned the wrong length: %d\n", __LINE__, (int)ret);
+            HEprint(stdout, 0);
+            errors++;
+            break;
+        }
+    }
+
+    ret = Hendaccess(aid1);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    MESSAGE(5, printf("Verifying data\n"););
+    memset(convbuf, 0, DFKNTsize(DFNT_INT16) * NBIT_SIZE13);
+
+    aid1 = Hstartread(fid, NBIT_TAG13, ref1);
+    CHECK_VOID(aid1, FAIL, "Hstartread");
+    for (i = 0; i < total; i += len) {
+        len = MIN(NBIT_RPIECE13, total - i);
+        ret = Hread(aid1, len, convbuf + i);
+        if (ret != len) {
+            HEprint(stderr, 0);
+            fprintf(stderr, "ERROR: (%d) Hread returned the wrong length: %d\n", __LINE__, (int)ret);
+            errors++;
+            break;
+        }
+    }
+    ret = Hendaccess(aid1);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    ret = DFKconvert(convbuf, inbuf, DFNT_INT16, NBIT_SIZE13, DFACC_READ, 0, 0);
+    CHECK_VOID(ret, FAIL, "DFKconvert");
+
+    for (i = 0; i < NBIT_SIZE13; i++) {
+        if (inbuf[i] != outbuf[i]) {
+            printf("test_nbit13: Wrong data at %d, out %d in %d\n", i, (int)outbuf[i], (int)inbuf[i]);
+            errors++;
+        }
+    }
+    free(outbuf);
+    free(inbuf);
+    free(convbuf);
+    num_errs += errors;
+}
+
 void
 test_nbit(void)
 {
@@ -1047,6 +1140,8 @@ test_nbit(void)
     test_nbit11(fid); /* advanced uint32 with fill-ones test */
     test_nbit12(fid); /* advanced int32 with fill-ones test */
 
+    test_nbit13(fid); /* int16 written and read in pieces of partial numbers */
+
     MESSAGE(5, printf("Closing the files\n"););
     ret = Hclose(fid);
     CHECK_VOID(ret, FAIL, "Hclose");
@@ -23,6 +23,10 @@
 #define JPEGFILE        "tjpeg.hdf"
 #define NONHDF_JPEGFILE "tnonhdf_jpeg.hdf"
 
+#define IMCOMPX    48
+#define IMCOMPY    48
+#define IMCOMPFILE "timcomp.hdf"
+
 static const uint8 jpeg_8bit_orig[JPEGY][JPEGX] = {
     {200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200,
      200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200,
@@ -455,6 +459,205 @@ const uint8 jpeg_24bit_orig[JPEGY * JPEGX * 3] = {
     255, 103, 0,   255, 103, 0,   255, 103, 0,   255, 103, 0,   255, 103, 0,   255, 103, 0,   255, 103, 0,
     255, 103, 0};
 
+/* The image and palette read back from the IMCOMP compressed image of
+   test_r8, as the median cut of the color boxes gave them before it counted
+   the points of a box instead of sorting them */
+static const uint8 imcomp_8bit_out[IMCOMPY][IMCOMPX] = {
+    {37, 115, 115, 115, 70, 70, 2, 2, 4, 4, 101, 101, 92, 92, 22, 22,
+     63, 63, 63, 127, 233, 233, 233, 233, 186, 186, 186, 186, 198, 247, 247, 247,
+     176, 176, 176, 176, 157, 157, 248, 248, 219, 219, 219, 86, 124, 124, 24, 24},
+    {37, 37, 115, 37, 2, 2, 2, 2, 4, 4, 4, 4, 22, 22, 22, 92,
+     63, 63, 127, 63, 168, 233, 168, 168, 211, 211, 186, 211, 198, 198, 247, 247,
+     246, 246, 246, 246, 248, 248, 248, 248, 219, 219, 86, 219, 124, 24, 24, 124},
+    {37, 37, 115, 115, 70, 70, 2, 2, 4, 101, 101, 101, 22, 92, 22, 92,
+     63, 127, 127, 127, 168, 168, 168, 233, 211, 211, 186, 186, 198, 198, 247, 247,
+     246, 176, 176, 176, 248, 157, 248, 157, 219, 86, 86, 86, 124, 124, 124, 24},
+    {115, 115, 37, 37, 70, 70, 2, 70, 101, 101, 4, 101, 92, 22, 22, 92,
+     127, 63, 63, 127, 233, 168, 168, 233, 186, 186, 211, 211, 198, 198, 247, 247,
+     176, 246, 246, 176, 157, 248, 248, 157, 86, 86, 219, 86, 24, 124, 24, 24},
+    {100, 100, 0, 100, 62, 62, 62, 62, 130, 166, 130, 130, 164, 239, 164, 239,
+     241, 154, 241, 154, 161, 161, 161, 224, 183, 220, 220, 220, 214, 50, 214, 214,
+     106, 106, 38, 38, 5, 5, 83, 5, 48, 107, 48, 107, 15, 110, 110, 15},
+    {100, 0, 100, 0, 128, 62, 128, 62, 130, 130, 130, 166, 164, 164, 164, 239,
+     154, 241, 154, 241, 161, 224, 161, 224, 220, 220, 183, 183, 50, 214, 214, 214,
+     106, 38, 38, 38, 83, 5, 83, 5, 107, 48, 107, 48, 110, 110, 110, 15},
+    {0, 100, 0, 100, 128, 62, 128, 128, 166, 130, 166, 166, 239, 164, 164, 239,
+     241, 154, 241, 241, 161, 224, 161, 161, 220, 183, 220, 220, 50, 214, 50, 50,
+     106, 106, 38, 106, 83, 5, 83, 5, 48, 107, 48, 48, 110, 15, 15, 110},
+    {0, 100, 100, 100, 62, 128, 128, 128, 166, 166, 130, 166, 164, 164, 239, 239,
+     241, 154, 154, 241, 224, 224, 161, 224, 220, 183, 183, 183, 214, 50, 50, 50,
+     106, 106, 38, 38, 5, 83, 83, 83, 48, 107, 107, 107, 15, 15, 110, 110},
+    {66, 129, 66, 66, 205, 205, 205, 138, 188, 188, 188, 188, 174, 249, 249, 249,
+     207, 207, 207, 207, 77, 77, 35, 35, 33, 98, 98, 98, 74, 74, 74, 74,
+     17, 17, 113, 113, 208, 197, 197, 208, 172, 172, 172, 172, 149, 149, 227, 227},
+    {66, 129, 129, 129, 205, 205, 205, 205, 255, 255, 255, 255, 249, 249, 249, 249,
+     145, 145, 145, 145, 35, 35, 35, 35, 33, 33, 33, 33, 74, 74, 74, 134,
+     17, 17, 113, 113, 208, 208, 208, 208, 254, 254, 254, 254, 227, 227, 227, 227},
+    {129, 129, 129, 66, 138, 138, 205, 205, 255, 188, 188, 188, 174, 174, 249, 174,
+     145, 145, 145, 145, 77, 77, 35, 35, 33, 33, 98, 98, 134, 134, 74, 74,
+     17, 113, 113, 113, 197, 197, 197, 208, 254, 254, 172, 172, 149, 227, 227, 227},
+    {129, 129, 66, 129, 205, 138, 205, 205, 255, 188, 188, 255, 174, 174, 249, 174,
+     145, 145, 207, 207, 77, 77, 77, 35, 98, 98, 33, 98, 134, 134, 74, 74,
+     113, 17, 17, 113, 197, 197, 208, 208, 254, 172, 254, 254, 149, 227, 149, 149},
+    {141, 141, 229, 141, 194, 194, 194, 245, 184, 181, 184, 181, 111, 111, 111, 42,
+     9, 99, 9, 99, 21, 89, 21, 21, 233, 135, 233, 135, 171, 234, 171, 234,
+     189, 242, 242, 189, 213, 144, 213, 144, 104, 104, 18, 104, 30, 30, 84, 30},
+    {141, 229, 141, 229, 194, 245, 194, 245, 184, 184, 181, 181, 111, 42, 42, 42,
+     99, 9, 99, 9, 89, 21, 89, 21, 135, 233, 233, 233, 171, 171, 171, 234,
+     189, 242, 189, 242, 213, 213, 144, 144, 18, 104, 104, 18, 84, 30, 84, 30},
+    {141, 229, 229, 229, 245, 245, 194, 245, 181, 184, 181, 184, 42, 111, 42, 42,
+     99, 9, 9, 99, 89, 21, 89, 89, 135, 233, 135, 135, 234, 234, 171, 234,
+     189, 189, 242, 189, 144, 213, 144, 144, 104, 18, 18, 104, 30, 30, 84, 84},
+    {229, 141, 141, 229, 245, 194, 194, 194, 181, 181, 184, 184, 111, 111, 42, 42,
+     9, 99, 99, 99, 21, 21, 89, 89, 135, 135, 135, 233, 234, 171, 171, 234,
+     242, 242, 189, 189, 213, 213, 144, 144, 18, 104, 104, 18, 30, 30, 84, 84},
+    {245, 245, 162, 162, 147, 147, 147, 217, 114, 114, 114, 114, 93, 11, 11, 11,
+     26, 210, 26, 210, 240, 240, 177, 177, 224, 224, 190, 190, 56, 218, 56, 218,
+     102, 102, 102, 39, 94, 13, 13, 13, 25, 237, 25, 237, 169, 251, 169, 169},
+    {245, 245, 245, 245, 217, 217, 147, 217, 27, 27, 27, 27, 11, 11, 11, 93,
+     26, 26, 210, 26, 177, 177, 177, 240, 224, 224, 224, 224, 218, 218, 56, 218,
+     39, 39, 39, 39, 13, 13, 13, 94, 25, 25, 237, 25, 169, 169, 169, 251},
+    {162, 162, 162, 245, 217, 217, 147, 147, 27, 114, 114, 114, 11, 11, 93, 93,
+     210, 210, 26, 26, 177, 177, 240, 240, 190, 190, 190, 224, 218, 218, 56, 56,
+     39, 102, 102, 102, 13, 13, 94, 94, 237, 237, 25, 25, 169, 251, 251, 251},
+    {162, 162, 245, 162, 147, 147, 217, 147, 27, 114, 27, 27, 93, 93, 11, 93,
+     210, 210, 26, 210, 240, 177, 177, 240, 190, 190, 224, 190, 56, 56, 56, 56,
+     39, 102, 39, 39, 94, 94, 13, 94, 237, 25, 237, 237, 251, 169, 251, 251},
+    {180, 180, 55, 180, 96, 8, 96, 8, 19, 19, 19, 126, 137, 235, 137, 235,
+     254, 193, 254, 193, 225, 64, 64, 225, 103, 103, 31, 103, 125, 75, 125, 75,
+     26, 26, 26, 237, 156, 247, 156, 247, 216, 216, 185, 185, 203, 203, 203, 34},
+    {180, 55, 180, 55, 96, 8, 96, 8, 126, 19, 126, 126, 137, 235, 137, 235,
+     193, 254, 193, 254, 225, 64, 225, 64, 103, 31, 103, 31, 125, 75, 125, 75,
+     26, 237, 26, 237, 156, 247, 156, 247, 185, 216, 216, 185, 203, 34, 203, 34},
+    {180, 55, 180, 180, 8, 96, 96, 8, 126, 126, 19, 126, 235, 137, 235, 235,
+     193, 254, 254, 193, 225, 225, 64, 225, 103, 31, 103, 103, 75, 125, 125, 75,
+     237, 237, 26, 26, 247, 247, 156, 247, 216, 185, 216, 185, 34, 203, 34, 34},
+    {180, 55, 55, 55, 96, 96, 96, 8, 19, 19, 126, 126, 137, 137, 235, 235,
+     193, 193, 193, 254, 225, 64, 64, 64, 31, 103, 31, 31, 125, 125, 125, 75,
+     26, 26, 237, 237, 247, 156, 156, 156, 216, 185, 185, 216, 203, 203, 34, 34},
+    {29, 97, 97, 97, 90, 90, 90, 90, 167, 167, 167, 167, 160, 160, 249, 249,
+     222, 222, 222, 222, 82, 82, 6, 6, 52, 52, 52, 52, 231, 231, 231, 231,
+     178, 250, 178, 178, 88, 88, 88, 28, 7, 120, 120, 120, 232, 73, 232, 232},
+    {29, 29, 29, 29, 23, 23, 90, 90, 167, 211, 211, 167, 249, 249, 249, 249,
+     222, 222, 43, 43, 82, 6, 6, 6, 52, 52, 52, 204, 175, 175, 231, 231,
+     250, 250, 250, 250, 28, 28, 88, 28, 7, 7, 7, 7, 73, 232, 73, 73},
+    {29, 29, 97, 97, 90, 23, 90, 23, 211, 211, 211, 167, 160, 160, 249, 160,
+     222, 43, 43, 43, 82, 6, 6, 82, 204, 204, 204, 52, 175, 175, 231, 231,
+     250, 178, 178, 178, 88, 88, 28, 28, 7, 7, 120, 120, 73, 73, 73, 232},
+    {97, 97, 29, 29, 90, 23, 23, 90, 211, 167, 211, 211, 160, 160, 249, 160,
+     43, 222, 43, 43, 82, 82, 6, 82, 204, 52, 204, 204, 175, 175, 231, 231,
+     178, 250, 250, 178, 88, 88, 28, 28, 120, 7, 7, 120, 232, 73, 232, 232},
+    {133, 14, 14, 133, 140, 206, 140, 206, 227, 227, 227, 195, 214, 68, 214, 68,
+     47, 105, 47, 105, 16, 228, 16, 16, 158, 158, 202, 158, 226, 226, 226, 226,
+     69, 119, 69, 69, 53, 53, 112, 112, 234, 142, 234, 142, 65, 65, 221, 221},
+    {133, 14, 133, 133, 206, 206, 140, 206, 195, 227, 195, 227, 214, 214, 68, 68,
+     47, 47, 105, 47, 228, 228, 228, 228, 158, 202, 158, 202, 79, 226, 226, 226,
+     69, 69, 69, 69, 112, 53, 112, 112, 234, 234, 142, 234, 65, 221, 65, 221},
+    {14, 133, 14, 14, 206, 140, 140, 206, 195, 195, 227, 227, 68, 214, 68, 68,
+     105, 105, 47, 47, 228, 16, 16, 228, 202, 158, 202, 202, 79, 226, 79, 79,
+     119, 69, 69, 119, 112, 53, 53, 112, 142, 142, 234, 234, 65, 221, 221, 65},
+    {14, 133, 133, 133, 140, 140, 140, 206, 195, 195, 195, 227, 214, 68, 68, 68,
+     47, 105, 105, 105, 16, 16, 228, 228, 202, 158, 158, 158, 79, 79, 79, 79,
+     119, 119, 119, 69, 53, 53, 112, 112, 234, 142, 142, 234, 221, 65, 65, 65},
+    {182, 182, 182, 182, 201, 253, 253, 201, 215, 215, 215, 49, 85, 10, 10, 10,
+     148, 148, 148, 204, 252, 152, 252, 252, 209, 209, 209, 209, 67, 67, 67, 67,
+     136, 136, 230, 136, 151, 249, 249, 249, 170, 170, 170, 44, 80, 80, 12, 12},
+    {182, 212, 212, 212, 253, 253, 253, 253, 49, 49, 49, 49, 10, 10, 10, 85,
+     204, 204, 204, 204, 252, 252, 252, 252, 51, 51, 51, 51, 67, 67, 67, 91,
+     230, 230, 230, 230, 249, 249, 249, 249, 44, 44, 44, 44, 12, 12, 12, 80},
+    {212, 212, 212, 182, 201, 201, 253, 253, 215, 49, 49, 49, 85, 10, 10, 85,
+     204, 204, 148, 148, 152, 252, 252, 252, 51, 51, 51, 209, 91, 91, 91, 91,
+     136, 230, 136, 136, 151, 249, 249, 151, 44, 44, 170, 170, 80, 12, 80, 80},
+    {212, 212, 182, 212, 253, 201, 253, 253, 49, 215, 215, 49, 85, 85, 10, 85,
+     204, 148, 204, 204, 152, 152, 152, 152, 51, 51, 209, 51, 67, 91, 67, 91,
+     230, 136, 230, 230, 151, 151, 249, 151, 44, 170, 44, 44, 80, 12, 12, 80},
+    {155, 155, 243, 155, 222, 78, 222, 78, 105, 1, 1, 105, 61, 235, 61, 235,
+     153, 244, 244, 244, 89, 89, 89, 36, 132, 20, 20, 132, 197, 236, 197, 236,
+     191, 221, 191, 221, 122, 32, 122, 32, 121, 57, 121, 57, 173, 250, 173, 250},
+    {155, 243, 155, 243, 78, 222, 222, 78, 1, 1, 105, 1, 61, 61, 235, 235,
+     153, 244, 244, 244, 89, 36, 89, 36, 132, 20, 132, 132, 236, 197, 197, 236,
+     191, 221, 191, 221, 122, 32, 32, 32, 121, 57, 57, 121, 250, 250, 173, 250},
+    {155, 243, 243, 243, 222, 222, 78, 222, 105, 105, 1, 105, 235, 61, 235, 235,
+     153, 153, 244, 153, 36, 89, 36, 36, 20, 132, 20, 20, 197, 197, 197, 236,
+     221, 191, 221, 191, 32, 122, 122, 32, 121, 121, 121, 121, 250, 250, 173, 250},
+    {243, 155, 155, 155, 222, 78, 78, 78, 1, 105, 105, 105, 61, 61, 61, 235,
+     244, 244, 153, 153, 89, 89, 89, 36, 20, 20, 132, 132, 197, 197, 197, 236,
+     221, 221, 191, 191, 32, 122, 122, 122, 57, 57, 57, 121, 250, 173, 173, 173},
+    {223, 223, 192, 223, 81, 3, 81, 3, 54, 54, 54, 95, 159, 216, 216, 216,
+     199, 199, 199, 199, 48, 87, 48, 48, 200, 139, 139, 139, 58, 218, 58, 218,
+     116, 116, 116, 116, 212, 212, 196, 212, 143, 143, 202, 143, 45, 108, 45, 108},
+    {223, 223, 223, 192, 81, 3, 3, 3, 54, 95, 54, 95, 216, 216, 216, 216,
+     199, 40, 40, 40, 48, 48, 48, 87, 200, 200, 200, 200, 218, 218, 58, 218,
+     46, 46, 46, 46, 196, 196, 196, 212, 202, 202, 202, 202, 108, 45, 108, 45},
+    {192, 192, 223, 192, 81, 3, 3, 81, 95, 95, 54, 54, 159, 216, 216, 159,
+     199, 40, 199, 199, 48, 48, 87, 87, 200, 139, 139, 200, 218, 218, 58, 58,
+     46, 116, 116, 46, 196, 196, 212, 212, 143, 143, 202, 202, 108, 45, 45, 45},
+    {192, 192, 223, 192, 81, 81, 3, 81, 95, 54, 54, 95, 159, 159, 216, 159,
+     40, 40, 40, 40, 87, 48, 48, 87, 139, 139, 200, 139, 58, 58, 218, 58,
+     46, 116, 46, 116, 212, 196, 196, 212, 143, 143, 202, 143, 45, 108, 45, 45},
+    {109, 109, 41, 109, 131, 72, 72, 72, 217, 187, 217, 187, 208, 60, 208, 60,
+     76, 123, 76, 123, 165, 219, 165, 219, 59, 179, 59, 179, 118, 68, 118, 68,
+     240, 150, 150, 150, 223, 223, 223, 146, 71, 117, 71, 71, 163, 238, 238, 163},
+    {109, 41, 109, 41, 131, 72, 72, 131, 187, 217, 187, 217, 208, 60, 208, 60,
+     123, 76, 123, 76, 165, 219, 165, 219, 179, 59, 179, 59, 118, 68, 118, 68,
+     150, 240, 150, 240, 223, 223, 223, 146, 117, 71, 117, 71, 238, 238, 163, 238},
+    {109, 41, 109, 109, 72, 131, 131, 72, 187, 187, 217, 187, 60, 208, 60, 60,
+     123, 76, 76, 123, 165, 165, 165, 219, 179, 59, 179, 179, 68, 118, 118, 68,
+     150, 240, 240, 150, 146, 223, 146, 146, 117, 71, 71, 117, 163, 163, 163, 238},
+    {109, 41, 41, 41, 131, 131, 131, 72, 187, 187, 217, 217, 208, 60, 60, 60,
+     123, 123, 123, 76, 165, 165, 219, 219, 179, 59, 59, 59, 118, 118, 118, 68,
+     150, 150, 240, 240, 223, 146, 146, 146, 117, 117, 117, 71, 163, 163, 238, 238}};
+
+static const uint8 imcomp_pal_out[768] = {
+    64, 48, 40, 56, 56, 80, 40, 48, 112, 48, 40, 96, 56, 48, 96, 48,
+    56, 96, 56, 56, 104, 64, 56, 104, 48, 64, 96, 48, 80, 96, 64, 64,
+    96, 72, 56, 56, 72, 56, 88, 72, 64, 80, 80, 40, 64, 112, 48, 88,
+    120, 48, 88, 112, 80, 88, 72, 72, 104, 80, 72, 104, 88, 48, 112, 88,
+    64, 104, 88, 72, 96, 96, 56, 112, 112, 40, 104, 120, 48, 104, 120, 64,
+    104, 40, 40, 120, 56, 40, 128, 40, 56, 120, 56, 56, 128, 40, 72, 120,
+    40, 80, 128, 48, 72, 128, 32, 48, 144, 16, 24, 176, 32, 48, 152, 24,
+    40, 176, 32, 64, 144, 40, 56, 136, 24, 56, 160, 24, 80, 160, 24, 80,
+    168, 16, 72, 184, 64, 40, 136, 64, 48, 128, 64, 56, 120, 64, 72, 120,
+    80, 64, 128, 64, 72, 152, 80, 80, 136, 88, 64, 120, 96, 56, 120, 104,
+    56, 120, 112, 48, 120, 112, 56, 120, 88, 48, 136, 112, 32, 128, 120, 40,
+    136, 120, 48, 136, 88, 56, 128, 120, 56, 128, 88, 64, 144, 104, 72, 136,
+    120, 64, 144, 112, 64, 152, 112, 56, 168, 56, 88, 96, 72, 88, 128, 72,
+    96, 112, 40, 160, 104, 80, 88, 88, 96, 88, 104, 120, 88, 104, 80, 96,
+    88, 80, 96, 104, 80, 112, 104, 96, 152, 104, 64, 88, 176, 72, 96, 160,
+    80, 120, 160, 40, 136, 152, 56, 168, 144, 64, 168, 136, 72, 160, 160, 80,
+    168, 152, 96, 96, 144, 104, 128, 136, 96, 144, 136, 96, 168, 136, 96, 152,
+    144, 96, 160, 144, 88, 168, 160, 88, 152, 192, 96, 160, 168, 120, 168, 160,
+    40, 192, 120, 40, 200, 112, 56, 176, 96, 56, 192, 120, 64, 192, 112, 72,
+    184, 88, 72, 192, 104, 80, 176, 112, 80, 176, 120, 72, 192, 112, 88, 176,
+    96, 88, 192, 104, 96, 208, 112, 120, 176, 104, 112, 184, 104, 112, 184, 112,
+    112, 184, 120, 120, 200, 120, 32, 184, 144, 24, 184, 176, 56, 184, 136, 56,
+    200, 136, 64, 216, 136, 56, 216, 144, 72, 208, 168, 112, 184, 136, 80, 192,
+    136, 80, 224, 136, 96, 176, 144, 80, 232, 144, 96, 192, 144, 120, 208, 144,
+    104, 184, 152, 112, 184, 152, 112, 192, 152, 96, 224, 152, 88, 184, 168, 88,
+    192, 168, 96, 200, 208, 136, 56, 88, 128, 48, 96, 128, 56, 104, 144, 56,
+    56, 168, 32, 80, 144, 56, 88, 152, 48, 104, 168, 48, 96, 176, 56, 104,
+    136, 56, 112, 144, 48, 112, 128, 48, 120, 136, 40, 120, 128, 32, 152, 136,
+    56, 136, 144, 48, 128, 168, 56, 112, 168, 56, 120, 168, 48, 136, 176, 40,
+    120, 176, 56, 112, 176, 48, 120, 176, 56, 128, 184, 48, 112, 200, 48, 112,
+    200, 56, 112, 200, 48, 128, 208, 56, 128, 128, 72, 72, 144, 64, 88, 152,
+    72, 104, 128, 80, 104, 144, 80, 104, 136, 88, 88, 152, 136, 72, 128, 160,
+    104, 160, 72, 96, 176, 64, 88, 192, 64, 104, 216, 72, 96, 160, 80, 104,
+    192, 80, 88, 160, 136, 96, 192, 96, 88, 176, 160, 104, 184, 160, 72, 232,
+    160, 48, 128, 64, 112, 128, 64, 144, 136, 64, 144, 136, 64, 160, 144, 64,
+    136, 168, 64, 128, 176, 64, 136, 184, 64, 128, 184, 64, 136, 136, 72, 160,
+    168, 72, 120, 192, 80, 128, 192, 80, 136, 208, 72, 136, 128, 88, 136, 152,
+    88, 112, 176, 88, 120, 128, 160, 112, 160, 144, 112, 184, 128, 136, 192, 160,
+    144, 128, 168, 96, 128, 168, 120, 144, 168, 104, 144, 168, 120, 152, 168, 120,
+    152, 176, 120, 128, 184, 112, 128, 208, 120, 152, 184, 88, 136, 192, 112, 160,
+    184, 120, 152, 200, 96, 168, 184, 80, 192, 184, 120, 176, 208, 88, 168, 216,
+    112, 184, 200, 104, 224, 168, 80, 224, 176, 80, 208, 200, 64, 208, 168, 104,
+    200, 176, 112, 200, 184, 88, 200, 200, 96, 208, 200, 104, 128, 176, 128, 168,
+    168, 128, 144, 176, 128, 160, 192, 128, 128, 168, 152, 128, 184, 152, 168, 176,
+    136, 144, 192, 136, 160, 208, 136, 136, 200, 160, 136, 192, 176, 152, 192, 144,
+    160, 192, 168, 176, 168, 136, 192, 176, 136, 184, 176, 168, 200, 168, 152, 200,
+    176, 152, 200, 184, 152, 176, 192, 136, 192, 208, 128, 200, 208, 136, 176, 192,
+    144, 184, 192, 160, 192, 208, 144, 200, 224, 144, 192, 208, 152, 176, 208, 176};
+
 void test_GRgetcomptype(void); /* in "tdfr8.c" */
 
 static void check_im_pal(int32 oldx, int32 oldy, int32 newx, int32 newy, uint8 *oldim, uint8 *newim,
@@ -1123,6 +1326,7 @@ test_r8(void)
     uint8    *im2, *ii2;
     uint8    *im1, *ii1;
     uint8    *pal1, *pal2, *ipal;
+    uint8    *imc, *iimc, *imcpal;
 
     int    x, y;
     int    ret, num_images = 0;
@@ -1166,6 +1370,14 @@ test_r8(void)
         exit(1);
     }
 
+    imc    = (uint8 *)malloc(IMCOMPX * IMCOMPY * sizeof(uint8));
+    iimc   = (uint8 *)malloc(IMCOMPX * IMCOMPY * sizeof(uint8));
+    imcpal = (uint8 *)malloc(768 * sizeof(char));
+    if (!imc || !iimc || !imcpal) {
+        fprintf(stderr, "Out of memory!\n");
+        exit(1);
+    }
+
     for (y = 0; y < YD1; y++)
         for (x = 0; x < XD1; x++)
             im1[y * XD1 + x] = (uint8)(x + y);
@@ -1326,6 +1538,43 @@ test_r8(void)
         num_errs++;
     }
 
+    MESSAGE(5, printf("\nStoring 8-bit image with IMCOMP compression\n"););
+
+    /* many colors, so that the palette is cut down from more than 256 */
+    for (x = 0; x < 256; x++) {
+        imcpal[3 * x]     = (uint8)x;
+        imcpal[3 * x + 1] = (uint8)(x * 97);
+        imcpal[3 * x + 2] = (uint8)(255 - 3 * x);
+    }
+    for (y = 0; y < IMCOMPY; y++)
+        for (x = 0; x < IMCOMPX; x++)
+            imc[y * IMCOMPX + x] = (uint8)(x * 5 + y * 11 + (x * y) / 3);
+
+    ret = DFR8setpalette(imcpal);
+    RESULT("DFR8setpalette");
+    ret = DFR8putimage(IMCOMPFILE, imc, IMCOMPX, IMCOMPY, COMP_IMCOMP);
+    RESULT("DFR8putimage");
+
+    ret = DFR8restart();
+    RESULT("DFR8restart");
+    ret = DFR8getdims(IMCOMPFILE, &xd, &yd, &ispal);
+    RESULT("DFR8getdims");
+    if (xd != IMCOMPX || yd != IMCOMPY || !ispal) {
+        fprintf(stderr, "Returned meta-data is wrong for IMCOMP image\n");
+        num_errs++;
+    }
+    ret = DFR8getimage(IMCOMPFILE, iimc, IMCOMPX, IMCOMPY, ipal);
+    RESULT("DFR8getimage");
+
+    if (memcmp(iimc, imcomp_8bit_out, sizeof(imcomp_8bit_out))) {
+        fprintf(stderr, "8-bit IMCOMP image was incorrect\n");
+        num_errs++;
+    }
+    if (memcmp(ipal, imcomp_pal_out, sizeof(imcomp_pal_out))) {
+        fprintf(stderr, "8-bit IMCOMP palette was incorrect\n");
+        num_errs++;
+    }
+
     free(im1);
     free(ii1);
     free(im2);
@@ -1336,6 +1585,9 @@ test_r8(void)
     free(pal2);
     free(ipal);
     free(jpeg_8bit_temp);
+    free(imc);
+    free(iimc);
+    free(imcpal);
 
     /* Temporarily call to test GRgetcomptype() for hmap project; these tests
        will need to be reformatted. Mar 13, 2011 -BMR */
@@ -24,6 +24,100 @@
 #define X_LENGTH      10
 #define Y_LENGTH      10
 
+#define MANY_FILE   "gr_many_test.hdf"
+#define MANY_IMAGES 300 /* images made with GR, each also in a RIG */
+#define MANY_R8     5   /* images made with DFR8 */
+#define MANY_ATTR   "index"
+
+/* Makes a file with many images, each with an attribute, and checks that
+   GRstart finds each of them once and the attributes are read back */
+static void
+test_mgr_many_images(void)
+{
+    int32 fid, grid, riid, il = MFGR_INTERLACE_PIXEL;
+    int32 start[2], edges[2], dims[2];
+    uint8 image_data[X_LENGTH][Y_LENGTH];
+    int32 n_datasets, n_attrs, ncomp, nt, attr_nt, count, value;
+    char  name[H4_MAX_GR_NAME], attr_name[H4_MAX_GR_NAME];
+    intn  i, j;
+    intn  status;
+
+    MESSAGE(8, printf("Try a file with many images\n"););
+
+    dims[0]  = X_LENGTH;
+    dims[1]  = Y_LENGTH;
+    start[0] = start[1] = 0;
+    edges[0]            = X_LENGTH;
+    edges[1]            = Y_LENGTH;
+    for (i = 0; i < X_LENGTH; i++)
+        for (j = 0; j < Y_LENGTH; j++)
+            image_data[i][j] = (uint8)(i * j);
+
+    /* the first one creates the file */
+    status = DFR8putimage(MANY_FILE, image_data, X_LENGTH, Y_LENGTH, 0);
+    CHECK_VOID(status, FAIL, "DFR8putimage");
+    for (i = 1; i < MANY_R8; i++) {
+        status = DFR8addimage(MANY_FILE, image_data, X_LENGTH, Y_LENGTH, 0);
+        CHECK_VOID(status, FAIL, "DFR8addimage");
+    }
+
+    fid = Hopen(MANY_FILE, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    grid = GRstart(fid);
+    CHECK_VOID(grid, FAIL, "GRstart");
+
+    for (i = 0; i < MANY_IMAGES; i++) {
+        sprintf(name, "Image %d", (int)i);
+        riid = GRcreate(grid, name, 1, DFNT_UINT8, il, dims);
+        CHECK_VOID(riid, FAIL, "GRcreate");
+        status = GRwriteimage(riid, start, NULL, edges, image_data);
+        CHECK_VOID(status, FAIL, "GRwriteimage");
+        value  = i;
+        status = GRsetattr(riid, MANY_ATTR, DFNT_INT32, 1, &value);
+        CHECK_VOID(status, FAIL, "GRsetattr");
+        status = GRendaccess(riid);
+        CHECK_VOID(status, FAIL, "GRendaccess");
+    }
+
+    status = GRend(grid);
+    CHECK_VOID(status, FAIL, "GRend");
+    status = Hclose(fid);
+    CHECK_VOID(status, FAIL, "Hclose");
+
+    /* Each image is found once, those made with GR not again through their RIGs */
+    fid = Hopen(MANY_FILE, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    grid = GRstart(fid);
+    CHECK_VOID(grid, FAIL, "GRstart");
+    status = GRfileinfo(grid, &n_datasets, &n_attrs);
+    CHECK_VOID(status, FAIL, "GRfileinfo");
+    VERIFY_VOID(n_datasets, MANY_IMAGES + MANY_R8, "GRfileinfo");
+
+    /* The attributes of an image are read when first asked for */
+    for (i = 0; i < MANY_IMAGES; i += 37) {
+        sprintf(name, "Image %d", (int)i);
+        riid = GRselect(grid, GRnametoindex(grid, name));
+        CHECK_VOID(riid, FAIL, "GRselect");
+        status = GRgetiminfo(riid, NULL, &ncomp, &nt, &il, dims, &n_attrs);
+        CHECK_VOID(status, FAIL, "GRgetiminfo");
+        VERIFY_VOID(n_attrs, 1, "GRgetiminfo");
+        status = GRattrinfo(riid, GRfindattr(riid, MANY_ATTR), attr_name, &attr_nt, &count);
+        CHECK_VOID(status, FAIL, "GRattrinfo");
+        VERIFY_VOID(attr_nt, DFNT_INT32, "GRattrinfo");
+        VERIFY_VOID(count, 1, "GRattrinfo");
+        status = GRgetattr(riid, 0, &value);
+        CHECK_VOID(status, FAIL, "GRgetattr");
+        VERIFY_VOID(value, i, "GRgetattr");
+        status = GRendaccess(riid);
+        CHECK_VOID(status, FAIL, "GRendaccess");
+    }
+
+    status = GRend(grid);
+    CHECK_VOID(status, FAIL, "GRend");
+    status = Hclose(fid);
+    CHECK_VOID(status, FAIL, "Hclose");
+} /* test_mgr_many_images */
+
 extern void
 test_mgr_dup_images()
 {
@@ -169,4 +263,7 @@ test_mgr_dup_images()
     CHECK_VOID(status, FAIL, "GRend");
     status = Hclose(fid);
     CHECK_VOID(status, FAIL, "Hclose");
+
+    /* Images of a file with many of them are not duplicated either */
+    test_mgr_many_images();
 }
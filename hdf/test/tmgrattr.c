@@ -16,6 +16,7 @@
  *    test_mgr_attr - test driver
  *        test_mgr_fillvalues - tests with fill value attributes
  *        test_mgr_userattr - tests with user-defined attributes
+ *        test_mgr_readallattrs - tests reading all the attributes at once
  *
  ****************************************************************************/
 
@@ -439,6 +440,93 @@ test_mgr_userattr()
     return num_errs;
 } /* test_mgr_userattr */
 
+/********************************************************************
+   Name: test_mgr_readallattrs()
+
+   Description:
+        This test routine reads all the attributes of the image and of
+        the file written by the previous tests with GRreadallattrs and
+        verifies them, then reads them into an arena that is too small
+        for the last image attribute.
+
+   Return value:
+        The number of errors occurred in this routine.
+
+*********************************************************************/
+static int
+test_mgr_readallattrs()
+{
+    int32      grid, riid, fid;
+    hdf_attr_t attrs[3];                         /* attributes read */
+    int32      nattrs;                           /* number of attributes read */
+    int32      size, full_size;                  /* size of the arena */
+    int16      ri_attr_2[RI_ATT2_N_VALUES] = {1, 2, 3, 4, 5, 6};
+    void      *arena;                            /* arena for the names and values */
+    intn       status;                           /* status for functions returning an intn */
+
+    MESSAGE(8, printf("Reading all the attributes at once\n"););
+
+    fid = Hopen(TESTFILE, DFACC_RDONLY, 0);
+    CHECK(fid, FAIL, "Hopen");
+    grid = GRstart(fid);
+    CHECK(grid, FAIL, "GRstart");
+    riid = GRselect(grid, GRnametoindex(grid, IMAGE1_NAME));
+    CHECK(riid, FAIL, "GRselect");
+
+    /* Get the number of attributes and the arena size needed */
+    full_size = 0;
+    nattrs    = GRreadallattrs(riid, NULL, 0, NULL, &full_size);
+    VERIFY(nattrs, 3, "GRreadallattrs");
+    arena = malloc(full_size);
+    CHECK_ALLOC(arena, "arena", "test_mgr_readallattrs");
+
+    /* Read the image's attributes */
+    size   = full_size;
+    nattrs = GRreadallattrs(riid, attrs, 3, arena, &size);
+    VERIFY(nattrs, 3, "GRreadallattrs");
+    VERIFY(size, full_size, "GRreadallattrs");
+    VERIFY_CHAR(attrs[0].name, FILL_ATTR, "GRreadallattrs");
+    VERIFY(attrs[0].ntype, DFNT_FLOAT32, "GRreadallattrs");
+    VERIFY(attrs[0].count, RI_ATT_N_VALUES, "GRreadallattrs");
+    VERIFY(memcmp(attrs[0].values, fill_pixel, sizeof(fill_pixel)), 0, "GRreadallattrs");
+    VERIFY_CHAR(attrs[1].name, RI_ATT1_NAME, "GRreadallattrs");
+    VERIFY(attrs[1].count, RI_ATT1_N_VALUES, "GRreadallattrs");
+    VERIFY(memcmp(attrs[1].values, RI_ATT1_VAL, RI_ATT1_N_VALUES), 0, "GRreadallattrs");
+    VERIFY_CHAR(attrs[2].name, RI_ATT2_NAME, "GRreadallattrs");
+    VERIFY(attrs[2].ntype, DFNT_INT16, "GRreadallattrs");
+    VERIFY(memcmp(attrs[2].values, ri_attr_2, sizeof(ri_attr_2)), 0, "GRreadallattrs");
+
+    /* The last one does not fit in a smaller arena */
+    size   = full_size - 1;
+    nattrs = GRreadallattrs(riid, attrs, 3, arena, &size);
+    VERIFY(nattrs, 3, "GRreadallattrs");
+    VERIFY(size, full_size, "GRreadallattrs");
+    VERIFY(memcmp(attrs[1].values, RI_ATT1_VAL, RI_ATT1_N_VALUES), 0, "GRreadallattrs");
+    VERIFY((attrs[2].values == NULL), TRUE, "GRreadallattrs");
+
+    /* Read the file attributes */
+    size   = full_size;
+    nattrs = GRreadallattrs(grid, attrs, 3, arena, &size);
+    VERIFY(nattrs, 2, "GRreadallattrs");
+    VERIFY_CHAR(attrs[0].name, F_ATT1_NAME, "GRreadallattrs");
+    VERIFY(memcmp(attrs[0].values, F_ATT1_VAL, F_ATT1_N_VALUES), 0, "GRreadallattrs");
+    VERIFY_CHAR(attrs[1].name, F_ATT2_NAME, "GRreadallattrs");
+    VERIFY(attrs[1].ntype, DFNT_UINT8, "GRreadallattrs");
+    VERIFY(memcmp(attrs[1].values, file_attr_2, F_ATT2_N_VALUES), 0, "GRreadallattrs");
+    free(arena);
+
+    /* Terminate accesses, and close the HDF file. */
+    status = GRendaccess(riid);
+    CHECK(status, FAIL, "GRendaccess");
+    status = GRend(grid);
+    CHECK(status, FAIL, "GRend");
+    status = Hclose(fid);
+    CHECK(status, FAIL, "Hclose");
+
+    /* Return the number of errors that's been kept track of so far */
+    return num_errs;
+} /* test_mgr_readallattrs */
+
 /****************************************************************
 **
 **  test_mgr_attr(): Main multi-file raster attribute test routine
@@ -449,6 +537,7 @@ test_mgr_userattr()
 **          1. GRsetattr
 **          2. GRgetattr
 **      C. GRfindattr
+**      D. GRreadallattrs
 **
 **  test_mgr_attr is invoked by test_mgr in mgr.c.
 **
@@ -466,6 +555,9 @@ test_mgr_attr()
     /* Test attribute functions with user-defined attributes */
     num_errs = num_errs + test_mgr_userattr();
 
+    /* Test reading all the attributes of an object at once */
+    num_errs = num_errs + test_mgr_readallattrs();
+
     if (num_errs != 0) {
         H4_FAILED();
     }
@@ -28,6 +28,8 @@
  *	  test_get_compress - tests getting comp info with compressed image
  *	  test_mgr_chunk_compress - tests getting comp info with chunked
  *				and compressed image
+ *	  test_mgr_chunk_jpeg - tests a chunked image with JPEG compressed
+ *				chunks
  * Modification:
  *	Nov 23, 2009: Moved out from mgr.c. - BMR
  *****************************************************************************/
@@ -909,6 +911,258 @@ test_mgr_chunk_compress()
     return num_errs;
 } /* end of test_mgr_chunk_compress */
 
+/* Create/Write/Read a 24-bit image with JPEG compressed chunks, reading a
+   region across several chunks back with the chunks decoded on threads */
+static int
+test_mgr_chunk_jpeg()
+{
+#define CHKJPEGFILE "gr_chunkjpeg.hdf"
+#define JPEG_XDIM   128 /* number of columns in the image */
+#define JPEG_YDIM   128 /* number of rows in the image */
+
+    intn          status;       /* status for functions returning an intn */
+    int32         file_id;      /* HDF file identifier */
+    int32         gr_id;        /* GR interface identifier */
+    int32         ri_id;        /* raster image identifier */
+    int32         start[2];     /* start position for each dimension */
+    int32         edges[2];     /* number of elements along each dimension */
+    int32         dim_sizes[2]; /* dimension sizes of the image array */
+    HDF_CHUNK_DEF chunk_def;    /* chunk definition */
+    comp_coder_t  comp_type;    /* compression type retrieved */
+    comp_info     cinfo;        /* compression information retrieved */
+    uint8         image_buf[JPEG_YDIM][JPEG_XDIM][3];
+    uint8         read_buf[50][70][3];
+    uint8         expected[50][70][3];
+    intn          i, j;
+
+    MESSAGE(8, printf("Operate on a chunked image with JPEG compressed chunks\n"););
+
+    /* Create and open the file and initialize GR interface */
+    file_id = Hopen(CHKJPEGFILE, DFACC_CREATE, 0);
+    CHECK(file_id, FAIL, "Hopen");
+
+    gr_id = GRstart(file_id);
+    CHECK(gr_id, FAIL, "GRstart");
+
+    dim_sizes[0] = JPEG_XDIM;
+    dim_sizes[1] = JPEG_YDIM;
+    ri_id        = GRcreate(gr_id, "JPEG chunks", 3, DFNT_UINT8, MFGR_INTERLACE_PIXEL, dim_sizes);
+    CHECK(ri_id, FAIL, "GRcreate");
+
+    /* Make the image chunked, with JPEG compressed chunks of 32 rows of 64 pixels */
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]          = 32;
+    chunk_def.comp.chunk_lengths[1]          = 64;
+    chunk_def.comp.comp_type                 = COMP_CODE_JPEG;
+    chunk_def.comp.cinfo.jpeg.quality        = 90;
+    chunk_def.comp.cinfo.jpeg.force_baseline = 1;
+    status                                   = GRsetchunk(ri_id, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "GRsetchunk");
+
+    /* Fill the image with smooth gradients, which JPEG keeps well */
+    for (i = 0; i < JPEG_YDIM; i++)
+        for (j = 0; j < JPEG_XDIM; j++) {
+            image_buf[i][j][0] = (uint8)(i + j);
+            image_buf[i][j][1] = (uint8)(2 * i);
+            image_buf[i][j][2] = (uint8)(255 - j);
+        }
+
+    start[0] = start[1] = 0;
+    edges[0]            = JPEG_XDIM;
+    edges[1]            = JPEG_YDIM;
+    status              = GRwriteimage(ri_id, start, NULL, edges, (void *)image_buf);
+    CHECK(status, FAIL, "GRwriteimage");
+
+    status = GRendaccess(ri_id);
+    CHECK(status, FAIL, "GRendaccess");
+    status = GRend(gr_id);
+    CHECK(status, FAIL, "GRend");
+    status = Hclose(file_id);
+    CHECK(status, FAIL, "Hclose");
+
+    /* Re-open the file and select the image */
+    file_id = Hopen(CHKJPEGFILE, DFACC_WRITE, 0);
+    CHECK(file_id, FAIL, "Hopen");
+
+    gr_id = GRstart(file_id);
+    CHECK(gr_id, FAIL, "GRstart");
+
+    ri_id = GRselect(gr_id, 0);
+    CHECK(ri_id, FAIL, "GRselect");
+
+    /* The chunks report JPEG compression with the quality they were given */
+    comp_type = COMP_CODE_INVALID;
+    memset(&cinfo, 0, sizeof(cinfo));
+    status = GRgetcompinfo(ri_id, &comp_type, &cinfo);
+    CHECK(status, FAIL, "GRgetcompinfo");
+    VERIFY(comp_type, COMP_CODE_JPEG, "GRgetcompinfo");
+    VERIFY(cinfo.jpeg.quality, 90, "GRgetcompinfo");
+
+    /* Decode the chunks on several threads */
+    status = GRsetchunkthreads(ri_id, 4);
+    CHECK(status, FAIL, "GRsetchunkthreads");
+
+    /* Read back a region that cuts across six chunks */
+    start[0] = 20;
+    start[1] = 30;
+    edges[0] = 70;
+    edges[1] = 50;
+    status   = GRreadimage(ri_id, start, NULL, edges, (void *)read_buf);
+    CHECK(status, FAIL, "GRreadimage");
+
+    for (i = 0; i < 50; i++)
+        for (j = 0; j < 70; j++)
+            memcpy(expected[i][j], image_buf[i + 30][j + 20], 3);
+
+    /* JPEG is lossy, allow for a small difference in each component */
+    if (fuzzy_memcmp(expected, read_buf, 50 * 70 * 3, 8 * JPEG_FUZZ) != 0) {
+        MESSAGE(3, printf("tmgrcomp: Error reading region of image with JPEG compressed chunks\n"););
+        num_errs++;
+    } /* end if */
+
+    status = GRendaccess(ri_id);
+    CHECK(status, FAIL, "GRendaccess");
+    status = GRend(gr_id);
+    CHECK(status, FAIL, "GRend");
+    status = Hclose(file_id);
+    CHECK(status, FAIL, "Hclose");
+
+    /* Return the number of errors that's been kept track of so far */
+    return num_errs;
+} /* end test_mgr_chunk_jpeg() */
+
+/* Copy the deflate compressed chunks of an image into a second image
+   with GRreadchunkraw/GRwritechunkraw, and read the copy back */
+static int
+test_mgr_chunk_raw()
+{
+#define CHKRAWFILE "gr_chunkraw.hdf"
+#define RAW_DIM    40 /* number of rows and columns in the images */
+#define RAW_CHUNK  10 /* number of rows and columns in the chunks */
+#define RAW_NCOMP  2  /* number of components in the images */
+
+    intn          status;       /* status for functions returning an intn */
+    int32         file_id;      /* HDF file identifier */
+    int32         gr_id;        /* GR interface identifier */
+    int32         src_id;       /* raster image the chunks are copied from */
+    int32         dst_id;       /* raster image the chunks are copied to */
+    int32         start[2];     /* start position for each dimension */
+    int32         edges[2];     /* number of elements along each dimension */
+    int32         dim_sizes[2]; /* dimension sizes of the image array */
+    int32         origin[2];    /* chunk to copy */
+    int32         raw_len;      /* length of a stored chunk */
+    HDF_CHUNK_DEF chunk_def;    /* chunk definition */
+    uint16        image_buf[RAW_DIM][RAW_DIM][RAW_NCOMP];
+    uint16        read_buf[RAW_DIM][RAW_DIM][RAW_NCOMP];
+    uint8        *raw_buf;
+    intn          i, j;
+
+    MESSAGE(8, printf("Copy the stored chunks of a chunked image\n"););
+
+    /* Create and open the file and initialize GR interface */
+    file_id = Hopen(CHKRAWFILE, DFACC_CREATE, 0);
+    CHECK(file_id, FAIL, "Hopen");
+
+    gr_id = GRstart(file_id);
+    CHECK(gr_id, FAIL, "GRstart");
+
+    /* Two images with the same deflate compressed chunks */
+    dim_sizes[0] = dim_sizes[1] = RAW_DIM;
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]    = RAW_CHUNK;
+    chunk_def.comp.chunk_lengths[1]    = RAW_CHUNK;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 6;
+
+    src_id = GRcreate(gr_id, "raw source", RAW_NCOMP, DFNT_UINT16, MFGR_INTERLACE_PIXEL, dim_sizes);
+    CHECK(src_id, FAIL, "GRcreate");
+    status = GRsetchunk(src_id, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "GRsetchunk");
+
+    dst_id = GRcreate(gr_id, "raw copy", RAW_NCOMP, DFNT_UINT16, MFGR_INTERLACE_PIXEL, dim_sizes);
+    CHECK(dst_id, FAIL, "GRcreate");
+    status = GRsetchunk(dst_id, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "GRsetchunk");
+
+    for (i = 0; i < RAW_DIM; i++)
+        for (j = 0; j < RAW_DIM; j++) {
+            image_buf[i][j][0] = (uint16)(i * 1000 + j);
+            image_buf[i][j][1] = (uint16)(j * 7);
+        }
+
+    start[0] = start[1] = 0;
+    edges[0] = edges[1] = RAW_DIM;
+    status              = GRwriteimage(src_id, start, NULL, edges, (void *)image_buf);
+    CHECK(status, FAIL, "GRwriteimage");
+
+    /* A chunk never written has no stored data */
+    origin[0] = origin[1] = 0;
+    raw_len               = GRreadchunkraw(dst_id, origin, NULL, 0);
+    VERIFY(raw_len, 0, "GRreadchunkraw");
+
+    raw_buf = (uint8 *)malloc(RAW_CHUNK * RAW_CHUNK * RAW_NCOMP * sizeof(uint16) * 2);
+    CHECK_ALLOC(raw_buf, "raw_buf", "test_mgr_chunk_raw");
+
+    for (origin[0] = 0; origin[0] < RAW_DIM / RAW_CHUNK; origin[0]++)
+        for (origin[1] = 0; origin[1] < RAW_DIM / RAW_CHUNK; origin[1]++) {
+            raw_len = GRreadchunkraw(src_id, origin, NULL, 0);
+            CHECK(raw_len, FAIL, "GRreadchunkraw");
+            if (raw_len <= 0 || raw_len > RAW_CHUNK * RAW_CHUNK * RAW_NCOMP * (int32)sizeof(uint16) * 2) {
+                MESSAGE(3, printf("tmgrcomp: Unexpected stored chunk length %d\n", (int)raw_len););
+                num_errs++;
+                continue;
+            }
+            status = (intn)GRreadchunkraw(src_id, origin, raw_buf, raw_len);
+            VERIFY(status, raw_len, "GRreadchunkraw");
+            status = GRwritechunkraw(dst_id, origin, raw_buf, raw_len);
+            CHECK(status, FAIL, "GRwritechunkraw");
+        }
+
+    /* A chunk can only be copied once */
+    origin[0] = origin[1] = 0;
+    raw_len               = GRreadchunkraw(src_id, origin, raw_buf, RAW_CHUNK * RAW_CHUNK * RAW_NCOMP * 4);
+    status                = GRwritechunkraw(dst_id, origin, raw_buf, raw_len);
+    VERIFY(status, FAIL, "GRwritechunkraw");
+    free(raw_buf);
+
+    status = GRendaccess(src_id);
+    CHECK(status, FAIL, "GRendaccess");
+    status = GRendaccess(dst_id);
+    CHECK(status, FAIL, "GRendaccess");
+    status = GRend(gr_id);
+    CHECK(status, FAIL, "GRend");
+    status = Hclose(file_id);
+    CHECK(status, FAIL, "Hclose");
+
+    /* Re-open the file and read the copy back */
+    file_id = Hopen(CHKRAWFILE, DFACC_READ, 0);
+    CHECK(file_id, FAIL, "Hopen");
+
+    gr_id = GRstart(file_id);
+    CHECK(gr_id, FAIL, "GRstart");
+
+    dst_id = GRselect(gr_id, 1);
+    CHECK(dst_id, FAIL, "GRselect");
+
+    memset(read_buf, 0, sizeof(read_buf));
+    status = GRreadimage(dst_id, start, NULL, edges, (void *)read_buf);
+    CHECK(status, FAIL, "GRreadimage");
+    if (memcmp(image_buf, read_buf, sizeof(image_buf)) != 0) {
+        MESSAGE(3, printf("tmgrcomp: Error reading image with copied chunks\n"););
+        num_errs++;
+    } /* end if */
+
+    status = GRendaccess(dst_id);
+    CHECK(status, FAIL, "GRendaccess");
+    status = GRend(gr_id);
+    CHECK(status, FAIL, "GRend");
+    status = Hclose(file_id);
+    CHECK(status, FAIL, "Hclose");
+
+    /* Return the number of errors that's been kept track of so far */
+    return num_errs;
+} /* end test_mgr_chunk_raw() */
+
 /****************************************************************
 **
 **  test_mgr_compress(): Multi-file Raster Compression tests
@@ -919,6 +1173,8 @@ test_mgr_chunk_compress()
 **      C. Create/Read/Write 24-bit JPEG compressed Image
 **      D. Retrieve various compression information of compressed Image
 **	E. Retrieve various compression info. of compressed, chunked images
+**	F. Create/Read/Write an image with JPEG compressed chunks
+**	G. Copy the stored chunks of an image to another image
 **
 ****************************************************************/
 extern void
@@ -943,6 +1199,12 @@ test_mgr_compress()
        compressed image */
     num_errs = num_errs + test_mgr_chunk_compress();
 
+    /* Test an image with JPEG compressed chunks */
+    num_errs = num_errs + test_mgr_chunk_jpeg();
+
+    /* Test copying the stored chunks of an image */
+    num_errs = num_errs + test_mgr_chunk_raw();
+
     if (num_errs != 0) {
         H4_FAILED();
     }
@@ -42,9 +42,14 @@
 #define RandInt(a, b) ((rand() % (((b) - (a)) + 1)) + (a))
 
 static void swap_arr(int32 *arr, intn a, intn b);
+static void count_item(void *item);
+static void test_tbbt_reuse(void);
+static void test_tbbt_index(void);
 
 intn tcompare(void *k1, void *k2, intn cmparg);
 
+static intn items_freed; /* number of items passed to count_item() */
+
 static void
 swap_arr(int32 *arr, intn a, intn b)
 {
@@ -57,6 +62,13 @@ swap_arr(int32 *arr, intn a, intn b)
     } /* end if */
 } /* end swap_arr() */
 
+static void
+count_item(void *item)
+{
+    (void)item;
+    items_freed++;
+} /* end count_item() */
+
 intn
 tcompare(void *k1, void *k2, intn cmparg)
 {
@@ -123,4 +135,94 @@ test_tbbt(void)
             tbbtdfree(tree, NULL, NULL);
         } /* end for */
     }     /* end for */
+
+    test_tbbt_reuse();
+    test_tbbt_index();
 } /* end test_tbbt() */
+
+/* Removes every other node of a tree and inserts the same keys again, so the
+   nodes are taken from the ones removed, then checks that the tree is still
+   in order and that tbbtdfree() visits each node left once */
+static void
+test_tbbt_reuse(void)
+{
+    int32      arr[MAX_TEST_SIZE * 8];
+    TBBT_TREE *tree;
+    TBBT_NODE *node;
+    intn       i, pass;
+
+    for (i = 0; i < MAX_TEST_SIZE * 8; i++)
+        arr[i] = i;
+
+    tree = tbbtdmake(tcompare, sizeof(int32), 0);
+    CHECK_VOID(tree, NULL, "tbbtdmake");
+    for (i = 0; i < MAX_TEST_SIZE * 8; i++) {
+        node = tbbtdins(tree, (void *)&arr[i], NULL);
+        CHECK_VOID(node, NULL, "tbbtdins");
+    }
+
+    for (pass = 0; pass < 2; pass++) {
+        for (i = pass; i < MAX_TEST_SIZE * 8; i += 2) {
+            node = tbbtdfind(tree, (void *)&arr[i], NULL);
+            CHECK_VOID(node, NULL, "tbbtdfind");
+            tbbtrem((TBBT_NODE **)tree, node, NULL);
+        }
+        for (i = pass; i < MAX_TEST_SIZE * 8; i += 2) {
+            node = tbbtdins(tree, (void *)&arr[i], NULL);
+            CHECK_VOID(node, NULL, "tbbtdins");
+        }
+    }
+
+    i = 0;
+    for (node = tbbtfirst(*(TBBT_NODE **)tree); node != NULL; node = tbbtnext(node)) {
+        VERIFY_VOID(*(int32 *)node->data, i, "tbbtnext");
+        i++;
+    }
+    VERIFY_VOID(i, MAX_TEST_SIZE * 8, "tbbtnext");
+
+    items_freed = 0;
+    tbbtdfree(tree, count_item, NULL);
+    VERIFY_VOID(items_freed, MAX_TEST_SIZE * 8, "tbbtdfree");
+} /* end test_tbbt_reuse() */
+
+/* Looks up every even key and the odd keys between them in trees of all sizes
+   up to MAX_TEST_SIZE, with and without a fast compare, through the search
+   index built by tbbtdindex() and after an insertion dropped it */
+static void
+test_tbbt_index(void)
+{
+    int32      arr[MAX_TEST_SIZE + 2];
+    int32      key;
+    TBBT_TREE *tree;
+    TBBT_NODE *node;
+    intn       test_size, size, fast, i;
+
+    for (i = 0; i < MAX_TEST_SIZE + 2; i++)
+        arr[i] = 2 * i;
+
+    for (fast = 0; fast < 2; fast++)
+        for (test_size = 0; test_size <= MAX_TEST_SIZE; test_size++) {
+            tree = tbbtdmake(tcompare, sizeof(int32), fast ? TBBT_FAST_INT32_COMPARE : 0);
+            CHECK_VOID(tree, NULL, "tbbtdmake");
+            for (i = test_size - 1; i >= 0; i--)
+                tbbtdins(tree, (void *)&arr[i], NULL);
+            VERIFY_VOID(tbbtdindex(tree), SUCCEED, "tbbtdindex");
+
+            for (size = test_size; size < test_size + 2; size++) {
+                for (key = -1; key <= 2 * size; key++) {
+                    node = tbbtdfind(tree, (void *)&key, NULL);
+                    if (key >= 0 && key < 2 * size && key % 2 == 0) {
+                        CHECK_VOID(node, NULL, "tbbtdfind");
+                        VERIFY_VOID(*(int32 *)node->data, key, "tbbtdfind");
+                    }
+                    else
+                        VERIFY_VOID(node, NULL, "tbbtdfind");
+                }
+
+                /* the index is dropped, the lookups go through the tree */
+                node = tbbtdins(tree, (void *)&arr[size], NULL);
+                CHECK_VOID(node, NULL, "tbbtdins");
+            }
+            tbbtdfree(tree, NULL, NULL);
+        }
+} /* end test_tbbt_index() */
@@ -28,6 +28,12 @@
  * test_readattrtwice: tests the fix of bugzilla #486, which a
  *	subsequent read of an attribute failed. - BMR - Dec, 2005.
  *
+ * test_readallattrs: checks that VSreadallattrs returns the same
+ *	names, types, counts and values as VSattrinfo and VSgetattr.
+ *
+ * test_compactattrs: sets many small vgroup attrs with the compact
+ *	attribute store on and checks they are all in one vdata.
+ *
  **************************************************************/
 #include "hdf.h"
 #include "tproto.h"
@@ -75,6 +81,8 @@ static intn create_vset_stuff(void);
 static intn write_vattrs(void);
 static intn read_vattrs(void);
 static void test_readattrtwice(void);
+static void test_readallattrs(void);
+static void test_compactattrs(void);
 
 /* create vdatas and vgroups */
 
@@ -814,6 +822,278 @@ test_readattrtwice(void)
     CHECK_VOID(ret, FAIL, "Hclose");
 } /* test_readattrtwice */
 
+/* compare the attrs of one field/vdata read at once with those read one by one */
+static void
+check_allattrs(int32 vsid, int32 findex)
+{
+    hdf_attr_t *attrs;
+    void       *arena;
+    int32       data_type, count, size, arena_size, full_size;
+    int32       nattrs, k;
+    char        name[MAX_HDF4_NAME_LENGTH + 1];
+    char       *buffer;
+    intn        ret;
+
+    full_size = 0;
+    nattrs    = VSreadallattrs(vsid, findex, NULL, 0, NULL, &full_size);
+    VERIFY_VOID(nattrs, VSfnattrs(vsid, findex), "VSreadallattrs");
+    if (nattrs <= 0)
+        return;
+
+    attrs = malloc(nattrs * sizeof(hdf_attr_t));
+    CHECK_VOID(attrs, NULL, "malloc");
+    arena = malloc(full_size);
+    CHECK_VOID(arena, NULL, "malloc");
+
+    arena_size = full_size;
+    ret        = VSreadallattrs(vsid, findex, attrs, nattrs, arena, &arena_size);
+    VERIFY_VOID(ret, nattrs, "VSreadallattrs");
+    VERIFY_VOID(arena_size, full_size, "VSreadallattrs");
+
+    for (k = 0; k < nattrs; k++) {
+        ret = VSattrinfo(vsid, findex, k, name, &data_type, &count, &size);
+        CHECK_VOID(ret, FAIL, "VSattrinfo");
+        VERIFY_CHAR_VOID(attrs[k].name, name, "VSreadallattrs");
+        VERIFY_VOID(attrs[k].ntype, data_type, "VSreadallattrs");
+        VERIFY_VOID(attrs[k].count, count, "VSreadallattrs");
+
+        buffer = malloc(size);
+        CHECK_VOID(buffer, NULL, "malloc");
+        ret = VSgetattr(vsid, findex, k, buffer);
+        CHECK_VOID(ret, FAIL, "VSgetattr");
+        if (memcmp(attrs[k].values, buffer, size) != 0) {
+            num_errs++;
+            printf(">>> VSreadallattrs read wrong values for attribute %s\n", name);
+        }
+        free(buffer);
+    }
+    free(arena);
+    free(attrs);
+} /* check_allattrs */
+
+static void
+test_readallattrs(void)
+{
+    int32 file_id, vsref, vsid;
+    int32 findex, nfields;
+    intn  ret;
+
+    file_id = Hopen(FILENAME, DFACC_READ, 0);
+    CHECK_VOID(file_id, FAIL, "Hopen:FILENAME");
+
+    ret = Vstart(file_id);
+    CHECK_VOID(ret, FAIL, "Vstart:file_id");
+
+    /* check the attributes of each vdata and of its fields */
+    vsref = VSgetid(file_id, -1);
+    while (vsref != -1) {
+        vsid = VSattach(file_id, vsref, "r");
+        CHECK_VOID(vsid, FAIL, "VSattach");
+
+        check_allattrs(vsid, _HDF_VDATA);
+        nfields = VFnfields(vsid);
+        CHECK_VOID(nfields, FAIL, "VFnfields");
+        for (findex = 0; findex < nfields; findex++)
+            check_allattrs(vsid, findex);
+
+        ret = VSdetach(vsid);
+        CHECK_VOID(ret, FAIL, "VSdetach");
+
+        vsref = VSgetid(file_id, vsref);
+    }
+    ret = Vend(file_id);
+    CHECK_VOID(ret, FAIL, "Vend");
+    ret = Hclose(file_id);
+    CHECK_VOID(ret, FAIL, "Hclose");
+} /* test_readallattrs */
+
+#define CFILENAME  "tvcompat.hdf"
+#define N_CATTRS   40
+#define BIG_CATTR  "big attr"
+#define N_BIG_VALS 100
+
+/* count the vdatas of a class in the file */
+static int32
+count_class(int32 fid, const char *vsclass)
+{
+    int32 vsref = -1, vsid, n = 0;
+    char  vclass[VSNAMELENMAX + 1];
+
+    while ((vsref = VSgetid(fid, vsref)) != FAIL) {
+        if ((vsid = VSattach(fid, vsref, "r")) == FAIL)
+            return FAIL;
+        if (VSgetclass(vsid, vclass) == FAIL)
+            return FAIL;
+        if (strcmp(vclass, vsclass) == 0)
+            n++;
+        VSdetach(vsid);
+    }
+    return n;
+}
+
+/* check the attrs set by test_compactattrs, nattrs of them */
+static void
+check_compactattrs(int32 fid, int32 nattrs)
+{
+    int32   vgid, idx, data_type, count, size, ival;
+    int32   big[N_BIG_VALS], ibig[N_BIG_VALS];
+    float64 dval;
+    char    name[MAX_HDF4_NAME_LENGTH + 1], aname[20];
+    intn    i, ret;
+
+    vgid = Vattach(fid, Vfind(fid, VGNAME0), "r");
+    CHECK_VOID(vgid, FAIL, "Vattach");
+    ret = Vnattrs(vgid);
+    VERIFY_VOID(ret, nattrs, "Vnattrs");
+
+    for (i = 0; i < nattrs - 1; i++) {
+        snprintf(aname, sizeof(aname), "cattr%d", i);
+        idx = Vfindattr(vgid, aname);
+        VERIFY_VOID(idx, (i == 0 ? 0 : i + 1), "Vfindattr");
+        ret = Vattrinfo(vgid, idx, name, &data_type, &count, &size);
+        CHECK_VOID(ret, FAIL, "Vattrinfo");
+        VERIFY_CHAR_VOID(name, aname, "Vattrinfo");
+        VERIFY_VOID(count, 1, "Vattrinfo");
+        if (i % 2 == 0) {
+            VERIFY_VOID(data_type, DFNT_INT32, "Vattrinfo");
+            ret = Vgetattr(vgid, idx, &ival);
+            CHECK_VOID(ret, FAIL, "Vgetattr");
+            VERIFY_VOID(ival, (i == 0 ? -1 : i * 100), "Vgetattr");
+        }
+        else {
+            VERIFY_VOID(data_type, DFNT_FLOAT64, "Vattrinfo");
+            VERIFY_VOID(size, 8, "Vattrinfo");
+            ret = Vgetattr2(vgid, idx, &dval);
+            CHECK_VOID(ret, FAIL, "Vgetattr2");
+            if (fabs(dval - i * 0.5) > EPS64) {
+                num_errs++;
+                printf(">>> Wrong value of compact attribute %s\n", aname);
+            }
+        }
+    }
+
+    /* the big one has a vdata of its own */
+    idx = Vfindattr(vgid, BIG_CATTR);
+    VERIFY_VOID(idx, 1, "Vfindattr");
+    ret = Vattrinfo(vgid, idx, name, &data_type, &count, &size);
+    CHECK_VOID(ret, FAIL, "Vattrinfo");
+    VERIFY_VOID(count, N_BIG_VALS, "Vattrinfo");
+    for (i = 0; i < N_BIG_VALS; i++)
+        big[i] = i;
+    ret = Vgetattr(vgid, idx, ibig);
+    CHECK_VOID(ret, FAIL, "Vgetattr");
+    if (memcmp(big, ibig, sizeof(big)) != 0) {
+        num_errs++;
+        printf(">>> Wrong values of attribute %s\n", BIG_CATTR);
+    }
+
+    ret = Vdetach(vgid);
+    CHECK_VOID(ret, FAIL, "Vdetach");
+
+    /* one store, one attribute vdata */
+    ret = count_class(fid, _HDF_ATTR_STORE);
+    VERIFY_VOID(ret, 1, "count_class");
+    ret = count_class(fid, _HDF_ATTRIBUTE);
+    VERIFY_VOID(ret, 1, "count_class");
+} /* check_compactattrs */
+
+static void
+test_compactattrs(void)
+{
+    int32   fid, vgid, ival;
+    int32   big[N_BIG_VALS];
+    float64 dval;
+    char    aname[20];
+    intn    i, ret;
+
+    fid = Hopen(CFILENAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Vstart(fid);
+    CHECK_VOID(ret, FAIL, "Vstart");
+    ret = Vsetcompactattr(fid, TRUE);
+    CHECK_VOID(ret, FAIL, "Vsetcompactattr");
+
+    vgid = Vattach(fid, -1, "w");
+    CHECK_VOID(vgid, FAIL, "Vattach");
+    ret = Vsetname(vgid, VGNAME0);
+    CHECK_VOID(ret, FAIL, "Vsetname");
+
+    /* small attrs, with a big one among them */
+    for (i = 0; i < N_BIG_VALS; i++)
+        big[i] = i;
+    for (i = 0; i < N_CATTRS / 2; i++) {
+        snprintf(aname, sizeof(aname), "cattr%d", i);
+        if (i % 2 == 0) {
+            ival = i * 100;
+            ret  = Vsetattr(vgid, aname, DFNT_INT32, 1, &ival);
+        }
+        else {
+            dval = i * 0.5;
+            ret  = Vsetattr(vgid, aname, DFNT_FLOAT64, 1, &dval);
+        }
+        CHECK_VOID(ret, FAIL, "Vsetattr");
+        if (i == 0) {
+            ret = Vsetattr(vgid, BIG_CATTR, DFNT_INT32, N_BIG_VALS, big);
+            CHECK_VOID(ret, FAIL, "Vsetattr");
+        }
+    }
+
+    /* replace the value of one of them */
+    ival = -1;
+    ret  = Vsetattr(vgid, "cattr0", DFNT_INT32, 1, &ival);
+    CHECK_VOID(ret, FAIL, "Vsetattr");
+    ret = Vsetattr(vgid, "cattr0", DFNT_INT16, 1, &ival);
+    VERIFY_VOID(ret, FAIL, "Vsetattr");
+
+    ret = Vdetach(vgid);
+    CHECK_VOID(ret, FAIL, "Vdetach");
+    ret = Vend(fid);
+    CHECK_VOID(ret, FAIL, "Vend");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* read them back */
+    fid = Hopen(CFILENAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Vstart(fid);
+    CHECK_VOID(ret, FAIL, "Vstart");
+    check_compactattrs(fid, N_CATTRS / 2 + 1);
+
+    /* add the others; the store is rewritten */
+    ret = Vsetcompactattr(fid, TRUE);
+    CHECK_VOID(ret, FAIL, "Vsetcompactattr");
+    vgid = Vattach(fid, Vfind(fid, VGNAME0), "w");
+    CHECK_VOID(vgid, FAIL, "Vattach");
+    for (i = N_CATTRS / 2; i < N_CATTRS; i++) {
+        snprintf(aname, sizeof(aname), "cattr%d", i);
+        if (i % 2 == 0) {
+            ival = i * 100;
+            ret  = Vsetattr(vgid, aname, DFNT_INT32, 1, &ival);
+        }
+        else {
+            dval = i * 0.5;
+            ret  = Vsetattr(vgid, aname, DFNT_FLOAT64, 1, &dval);
+        }
+        CHECK_VOID(ret, FAIL, "Vsetattr");
+    }
+    ret = Vdetach(vgid);
+    CHECK_VOID(ret, FAIL, "Vdetach");
+    ret = Vend(fid);
+    CHECK_VOID(ret, FAIL, "Vend");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    fid = Hopen(CFILENAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Vstart(fid);
+    CHECK_VOID(ret, FAIL, "Vstart");
+    check_compactattrs(fid, N_CATTRS + 1);
+    ret = Vend(fid);
+    CHECK_VOID(ret, FAIL, "Vend");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+} /* test_compactattrs */
+
 /* main test driver */
 void
 test_vset_attr(void)
@@ -822,4 +1102,6 @@ test_vset_attr(void)
     write_vattrs();
     read_vattrs();
     test_readattrtwice();
+    test_readallattrs();
+    test_compactattrs();
 } /* test_vset_attr */
@@ -66,6 +66,14 @@ static void  test_getvdatas(void);
 static void  test_blockinfo_oneLB(void);
 static void  test_blockinfo_multLBs(void);
 static void  test_VSofclass(void);
+static void  test_vsquery(void);
+static void  test_vswritecolumns(void);
+static void  test_vsindex(void);
+static void  test_vgettree(void);
+static void  test_vgtagref_hash(void);
+static void  test_allocator(void);
+static void  test_memory_usage(void);
+static void  test_hugepages(void);
 
 /* write some stuff to the file */
 static int32
@@ -1165,6 +1173,89 @@ read_vset_stuff(void)
         c_expected++;
     }
 
+    /*
+     * verify - read in all fields into one array each, then one field
+     */
+    {
+        char8   st_col[20];
+        int32   vl_col[30];
+        float32 fl_col[10];
+        uint8  *cols[3];
+
+        status = VSseek(vs1, 0);
+        CHECK(status, FAIL, "VSseek:vs1");
+
+        status = VSsetfields(vs1, MX);
+        CHECK(status, FAIL, "VSsetfields:vs1");
+
+        cols[0] = (uint8 *)st_col;
+        cols[1] = (uint8 *)vl_col;
+        cols[2] = (uint8 *)fl_col;
+        status  = VSreadcolumns(vs1, cols, count);
+        VERIFY(status, count, "VSreadcolumns:vs1");
+
+        for (i = 0; i < count; i++)
+            if (st_col[2 * i] != (char8)('a' + 2 * i) || st_col[2 * i + 1] != (char8)('a' + 2 * i + 1) ||
+                vl_col[3 * i] != 3 * i || vl_col[3 * i + 1] != 3 * i + 1 || vl_col[3 * i + 2] != 3 * i + 2 ||
+                fl_col[i] != (float32)15.5 + (float32)0.5 * (float32)i) {
+                num_errs++;
+                printf(">>> VSreadcolumns read bad values in element %d\n", (int)i);
+                break;
+            }
+
+        status = VSseek(vs1, 0);
+        CHECK(status, FAIL, "VSseek:vs1");
+
+        memset(vl_col, 0, sizeof(vl_col));
+        status = VSreadfield(vs1, VL, (uint8 *)vl_col, count);
+        VERIFY(status, count, "VSreadfield:vs1");
+
+        for (i = 0; i < 3 * count; i++)
+            if (vl_col[i] != i) {
+                num_errs++;
+                printf(">>> VSreadfield read %d for value %d\n", (int)vl_col[i], (int)i);
+                break;
+            }
+    }
+
+    /*
+     * verify - scan one field in batches of 3 records, the last one short
+     */
+    {
+        int32 vl_batch[9];
+        int32 nrecs, expected, total = 0;
+
+        status = VSseek(vs1, 0);
+        CHECK(status, FAIL, "VSseek:vs1");
+
+        status = VSsetfields(vs1, VL);
+        CHECK(status, FAIL, "VSsetfields:vs1");
+
+        status = VSiter_begin(vs1, 3, FULL_INTERLACE);
+        CHECK(status, FAIL, "VSiter_begin:vs1");
+
+        while ((nrecs = VSiter_next(vs1, (uint8 *)vl_batch)) > 0) {
+            expected = (total + 3 <= count) ? 3 : count - total;
+            VERIFY(nrecs, expected, "VSiter_next:vs1");
+            for (i = 0; i < 3 * nrecs; i++)
+                if (vl_batch[i] != 3 * total + i) {
+                    num_errs++;
+                    printf(">>> VSiter_next read %d for value %d\n", (int)vl_batch[i], (int)(3 * total + i));
+                    break;
+                }
+            total += nrecs;
+        }
+        VERIFY(nrecs, 0, "VSiter_next:vs1");
+        VERIFY(total, count, "VSiter_next:vs1");
+
+        status = VSiter_end(vs1);
+        CHECK(status, FAIL, "VSiter_end:vs1");
+
+        /* the scan is gone */
+        nrecs = VSiter_next(vs1, (uint8 *)vl_batch);
+        VERIFY(nrecs, FAIL, "VSiter_next:vs1");
+    }
+
     /* verify that VSfind does not mess up the AIDs of attached Vdatas */
     status = VSfind(fid, "foo");
     CHECK(status, FAIL, "VSfind:fid");
@@ -1236,6 +1327,10 @@ test_vsdelete(void)
     num_of_elements = VSwrite(vdata_id, (const uint8 *)vdata_buf, NUMBER_OF_ROWS, FULL_INTERLACE);
     CHECK_VOID(num_of_elements, FAIL, "VSwrite:");
 
+    /* The name is not there yet */
+    status = VSfind(fid, "Vdata should have been deleted");
+    VERIFY_VOID(status, 0, "VSfind:fid");
+
     /* Set the name and class. */
     status = VSsetname(vdata_id, "Vdata should have been deleted");
     CHECK_VOID(status, FAIL, "VSsetname:vdata_id");
@@ -1247,6 +1342,12 @@ test_vsdelete(void)
     v_ref = VSQueryref(vdata_id);
     CHECK_VOID(v_ref, FAIL, "VSQueryref:vdata_id");
 
+    /* The searches see the new name and class */
+    status = VSfind(fid, "Vdata should have been deleted");
+    VERIFY_VOID(status, v_ref, "VSfind:fid");
+    status = VSfindclass(fid, "Vdata should have been deleted");
+    VERIFY_VOID(status, v_ref, "VSfindclass:fid");
+
     /* Terminate access to the vdata. */
     status = VSdetach(vdata_id);
     CHECK_VOID(status, FAIL, "VSdetach:vdata_id");
@@ -1279,10 +1380,17 @@ test_vsdelete(void)
         VERIFY_VOID(name_len, 0, "VSgetexternalinfo:vdata_id");
     }
 
+    status = VSfind(fid, "Vdata should have been deleted");
+    VERIFY_VOID(status, v_ref, "VSfind:fid");
+
     /* Delete this Vdata */
     status = VSdelete(fid, v_ref);
     CHECK_VOID(status, FAIL, "VSdelete:vdata_id");
 
+    /* and it can no longer be found */
+    status = VSfind(fid, "Vdata should have been deleted");
+    VERIFY_VOID(status, 0, "VSfind:fid");
+
     /* Terminate access to the vdata. */
     status = VSdetach(vdata_id);
     CHECK_VOID(status, FAIL, "VSdetach:vdata_id");
@@ -3320,6 +3428,1007 @@ test_blockinfo(void)
 
 } /* test_blockinfo */
 
+/*
+   Testing VSquery: conditions on a sorted field and an unsorted one over
+   a linked-block vdata of more records than one batch of the scan.
+ */
+#define QUERY_FILE   "tvsquery.hdf"
+#define QUERY_VD     "Observations"
+#define QUERY_TIME   "Time"
+#define QUERY_VALUE  "Value"
+#define QUERY_VEC    "Vector"
+#define QUERY_FIELDS "Time,Value,Vector"
+#define QUERY_NRECS  10000
+
+static void
+test_vsquery(void)
+{
+    struct {
+        float64 time;
+        int16   value;
+        int32   vec[3];
+    } rec;
+    uint8        buf[sizeof(float64) + sizeof(int16) + 3 * sizeof(int32)];
+    void        *fldbufs[3] = {&rec.time, &rec.value, rec.vec};
+    hdf_vscond_t conds[2];
+    int32       *indices = NULL;
+    int32        fid, vdata_id;
+    int32        i, n, expected, pos;
+    int32        status;
+    intn         status_n;
+
+    indices = (int32 *)malloc(QUERY_NRECS * sizeof(int32));
+    CHECK_ALLOC(indices, "indices", "test_vsquery");
+
+    fid = Hopen(QUERY_FILE, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status_n = Vstart(fid);
+    CHECK_VOID(status_n, FAIL, "Vstart");
+
+    vdata_id = VSattach(fid, -1, "w");
+    CHECK_VOID(vdata_id, FAIL, "VSattach");
+    status = VSsetname(vdata_id, QUERY_VD);
+    CHECK_VOID(status, FAIL, "VSsetname");
+    status_n = VSfdefine(vdata_id, QUERY_TIME, DFNT_FLOAT64, 1);
+    CHECK_VOID(status_n, FAIL, "VSfdefine");
+    status_n = VSfdefine(vdata_id, QUERY_VALUE, DFNT_INT16, 1);
+    CHECK_VOID(status_n, FAIL, "VSfdefine");
+    status_n = VSfdefine(vdata_id, QUERY_VEC, DFNT_INT32, 3);
+    CHECK_VOID(status_n, FAIL, "VSfdefine");
+    status_n = VSsetfields(vdata_id, QUERY_FIELDS);
+    CHECK_VOID(status_n, FAIL, "VSsetfields");
+    status_n = VSsetblocksize(vdata_id, 1000);
+    CHECK_VOID(status_n, FAIL, "VSsetblocksize");
+
+    /* the time goes up by 0.5 every other record, the value goes round */
+    for (i = 0; i < QUERY_NRECS; i++) {
+        rec.time   = (float64)(i / 2) * 0.5;
+        rec.value  = (int16)((i * 7) % 100);
+        rec.vec[0] = rec.vec[1] = rec.vec[2] = i;
+        status     = VSfpack(vdata_id, _HDF_VSPACK, NULL, buf, sizeof(buf), 1, NULL, fldbufs);
+        CHECK_VOID(status, FAIL, "VSfpack");
+        status = VSwrite(vdata_id, buf, 1, FULL_INTERLACE);
+        VERIFY_VOID(status, 1, "VSwrite");
+    }
+
+    status = VSdetach(vdata_id);
+    CHECK_VOID(status, FAIL, "VSdetach");
+
+    vdata_id = VSattach(fid, VSfind(fid, QUERY_VD), "r");
+    CHECK_VOID(vdata_id, FAIL, "VSattach");
+    status_n = VSsetfields(vdata_id, QUERY_FIELDS);
+    CHECK_VOID(status_n, FAIL, "VSsetfields");
+
+    /* 1000 <= time < 2000 and value < 10, the time being sorted */
+    conds[0].field = QUERY_TIME;
+    conds[0].op    = VS_QUERY_GE | VS_QUERY_SORTED;
+    conds[0].value = 1000.0;
+    conds[1].field = QUERY_VALUE;
+    conds[1].op    = VS_QUERY_LT;
+    conds[1].value = 10.0;
+
+    status = VSseek(vdata_id, 123);
+    CHECK_VOID(status, FAIL, "VSseek");
+    n = VSquery(vdata_id, 2, conds, QUERY_NRECS, indices);
+    for (i = 0, expected = 0; i < QUERY_NRECS; i++)
+        if ((i / 2) * 0.5 >= 1000.0 && (i * 7) % 100 < 10) {
+            if (expected < n && indices[expected] != i) {
+                num_errs++;
+                printf(">>> VSquery found record %d instead of %d\n", (int)indices[expected], (int)i);
+            }
+            expected++;
+        }
+    VERIFY_VOID(n, expected, "VSquery");
+
+    /* the position is kept */
+    status = VSread(vdata_id, buf, 1, FULL_INTERLACE);
+    VERIFY_VOID(status, 1, "VSread");
+    status = VSfpack(vdata_id, _HDF_VSUNPACK, NULL, buf, sizeof(buf), 1, QUERY_VEC, &fldbufs[2]);
+    CHECK_VOID(status, FAIL, "VSfpack");
+    pos = rec.vec[0];
+    VERIFY_VOID(pos, 123, "VSquery");
+
+    /* an exact time on the sorted field, only the count being wanted */
+    conds[0].op    = VS_QUERY_EQ | VS_QUERY_SORTED;
+    conds[0].value = 10.5;
+    n              = VSquery(vdata_id, 1, conds, 0, NULL);
+    VERIFY_VOID(n, 2, "VSquery");
+
+    /* fewer indices than matches, the same with and without the sorting hint */
+    conds[0].op    = VS_QUERY_LE | VS_QUERY_SORTED;
+    conds[0].value = 100.0;
+    n              = VSquery(vdata_id, 1, conds, 5, indices);
+    VERIFY_VOID(n, 402, "VSquery");
+    VERIFY_VOID(indices[4], 4, "VSquery");
+    conds[0].op = VS_QUERY_LE;
+    n           = VSquery(vdata_id, 1, conds, 5, indices);
+    VERIFY_VOID(n, 402, "VSquery");
+
+    /* no record past the end of the time */
+    conds[0].op    = VS_QUERY_GT | VS_QUERY_SORTED;
+    conds[0].value = 5000.0;
+    n              = VSquery(vdata_id, 1, conds, QUERY_NRECS, indices);
+    VERIFY_VOID(n, 0, "VSquery");
+
+    /* fields of an order above 1 cannot be compared */
+    conds[0].field = QUERY_VEC;
+    n              = VSquery(vdata_id, 1, conds, QUERY_NRECS, indices);
+    VERIFY_VOID(n, FAIL, "VSquery");
+
+    status = VSdetach(vdata_id);
+    CHECK_VOID(status, FAIL, "VSdetach");
+    status_n = Vend(fid);
+    CHECK_VOID(status_n, FAIL, "Vend");
+    status_n = Hclose(fid);
+    CHECK_VOID(status_n, FAIL, "Hclose");
+
+    free(indices);
+} /* test_vsquery */
+
+/*
+   Testing VSwritecolumns: fields of several orders and number types
+   written from one array each, in two calls, to a full interlaced and a
+   no interlaced vdata, then read back by record and by field.
+ */
+#define COLS_FILE   "tvscols.hdf"
+#define COLS_FIELDS "Id,Pos,Tag"
+#define COLS_NRECS  300
+
+static void
+test_vswritecolumns(void)
+{
+    int32        ids[COLS_NRECS];
+    float32      pos[COLS_NRECS][2];
+    char8        tags[COLS_NRECS][3];
+    int32        ids_in[COLS_NRECS];
+    float32      pos_in[COLS_NRECS][2];
+    char8        tags_in[COLS_NRECS][3];
+    uint8        rec[sizeof(int32) + 2 * sizeof(float32) + 3 * sizeof(char8)];
+    const uint8 *cols[3];
+    uint8       *cols_in[3];
+    int32        fid, vdata_id, vdata_ref;
+    int32        i, il, half = COLS_NRECS / 3;
+    int32        status;
+    intn         status_n;
+
+    for (i = 0; i < COLS_NRECS; i++) {
+        ids[i]     = 1000 + i;
+        pos[i][0]  = (float32)i * 0.25f;
+        pos[i][1]  = -(float32)i;
+        tags[i][0] = (char8)('a' + i % 26);
+        tags[i][1] = (char8)('A' + i % 26);
+        tags[i][2] = (char8)('0' + i % 10);
+    }
+
+    fid = Hopen(COLS_FILE, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status_n = Vstart(fid);
+    CHECK_VOID(status_n, FAIL, "Vstart");
+
+    for (il = 0; il < 2; il++) {
+        vdata_id = VSattach(fid, -1, "w");
+        CHECK_VOID(vdata_id, FAIL, "VSattach");
+        status_n = VSfdefine(vdata_id, "Id", DFNT_INT32, 1);
+        CHECK_VOID(status_n, FAIL, "VSfdefine");
+        status_n = VSfdefine(vdata_id, "Pos", DFNT_FLOAT32, 2);
+        CHECK_VOID(status_n, FAIL, "VSfdefine");
+        status_n = VSfdefine(vdata_id, "Tag", DFNT_CHAR8, 3);
+        CHECK_VOID(status_n, FAIL, "VSfdefine");
+        status_n = VSsetinterlace(vdata_id, il == 0 ? FULL_INTERLACE : NO_INTERLACE);
+        CHECK_VOID(status_n, FAIL, "VSsetinterlace");
+        status_n = VSsetfields(vdata_id, COLS_FIELDS);
+        CHECK_VOID(status_n, FAIL, "VSsetfields");
+
+        /* a no interlaced vdata is written in one go */
+        cols[0] = (const uint8 *)ids;
+        cols[1] = (const uint8 *)pos;
+        cols[2] = (const uint8 *)tags;
+        if (il == 0) {
+            status = VSwritecolumns(vdata_id, cols, half);
+            VERIFY_VOID(status, half, "VSwritecolumns");
+            cols[0] = (const uint8 *)&ids[half];
+            cols[1] = (const uint8 *)pos[half];
+            cols[2] = (const uint8 *)tags[half];
+            status  = VSwritecolumns(vdata_id, cols, COLS_NRECS - half);
+            VERIFY_VOID(status, COLS_NRECS - half, "VSwritecolumns");
+        }
+        else {
+            status = VSwritecolumns(vdata_id, cols, COLS_NRECS);
+            VERIFY_VOID(status, COLS_NRECS, "VSwritecolumns");
+        }
+
+        status = VSdetach(vdata_id);
+        CHECK_VOID(status, FAIL, "VSdetach");
+    }
+
+    /* read back each vdata by field, and the full interlaced one by record */
+    vdata_ref = -1;
+    for (il = 0; il < 2; il++) {
+        vdata_ref = VSgetid(fid, vdata_ref);
+        CHECK_VOID(vdata_ref, FAIL, "VSgetid");
+        vdata_id = VSattach(fid, vdata_ref, "r");
+        CHECK_VOID(vdata_id, FAIL, "VSattach");
+        status_n = VSsetfields(vdata_id, COLS_FIELDS);
+        CHECK_VOID(status_n, FAIL, "VSsetfields");
+
+        cols_in[0] = (uint8 *)ids_in;
+        cols_in[1] = (uint8 *)pos_in;
+        cols_in[2] = (uint8 *)tags_in;
+        status     = VSreadcolumns(vdata_id, cols_in, COLS_NRECS);
+        VERIFY_VOID(status, COLS_NRECS, "VSreadcolumns");
+        if (memcmp(ids, ids_in, sizeof(ids)) != 0 || memcmp(pos, pos_in, sizeof(pos)) != 0 ||
+            memcmp(tags, tags_in, sizeof(tags)) != 0) {
+            num_errs++;
+            printf(">>> VSwritecolumns wrote bad values in vdata #%d\n", (int)il);
+        }
+
+        if (il == 0) {
+            status = VSseek(vdata_id, 123);
+            CHECK_VOID(status, FAIL, "VSseek");
+            status = VSread(vdata_id, rec, 1, FULL_INTERLACE);
+            VERIFY_VOID(status, 1, "VSread");
+            if (memcmp(rec, &ids[123], sizeof(int32)) != 0 ||
+                memcmp(rec + sizeof(int32), pos[123], 2 * sizeof(float32)) != 0 ||
+                memcmp(rec + sizeof(int32) + 2 * sizeof(float32), tags[123], 3) != 0) {
+                num_errs++;
+                printf(">>> VSwritecolumns wrote a bad record 123\n");
+            }
+        }
+
+        status = VSdetach(vdata_id);
+        CHECK_VOID(status, FAIL, "VSdetach");
+    }
+
+    status_n = Vend(fid);
+    CHECK_VOID(status_n, FAIL, "Vend");
+    status_n = Hclose(fid);
+    CHECK_VOID(status_n, FAIL, "Hclose");
+} /* test_vswritecolumns */
+
+/*
+   Testing VScreateindex, VSlookup and VSrange: an index of an unsorted
+   field kept up to date with records appended while the vdata is attached
+   and with records written over in a later attach, checked against a
+   scan of the values.
+ */
+#define INDEX_FILE    "tvsindex.hdf"
+#define INDEX_VD      "Readings"
+#define INDEX_STATION "Station"
+#define INDEX_LEVEL   "Level"
+#define INDEX_VEC     "Vector"
+#define INDEX_FIELDS  "Station,Level,Vector"
+#define INDEX_NRECS   3000
+#define INDEX_FIRST   2000
+
+/* the station of record 'i' before and after it is written over */
+#define INDEX_STATION_OF(i, over) ((int16)((over) ? ((i) * 11) % 40 : ((i) * 37) % 50))
+
+/* checks the indices found for the stations in [lo, hi] against a scan */
+static void
+check_vsindex(const int16 *stations, int32 nrecs, int16 lo, int16 hi, int32 n, const int32 *indices)
+{
+    int32 expected = 0;
+    int32 i;
+    int16 s;
+
+    /* by station, then by record */
+    for (s = lo; s <= hi; s++)
+        for (i = 0; i < nrecs; i++)
+            if (stations[i] == s) {
+                if (expected < n && indices[expected] != i) {
+                    num_errs++;
+                    printf(">>> VSrange found record %d instead of %d\n", (int)indices[expected], (int)i);
+                }
+                expected++;
+            }
+    VERIFY_VOID(n, expected, "VSrange");
+}
+
+static void
+test_vsindex(void)
+{
+    struct {
+        int16   station;
+        float32 level;
+        int32   vec[2];
+    } rec;
+    uint8  buf[sizeof(int16) + sizeof(float32) + 2 * sizeof(int32)];
+    void  *fldbufs[3] = {&rec.station, &rec.level, rec.vec};
+    int16 *stations   = NULL;
+    int32 *indices    = NULL;
+    int32  few[3];
+    int32  fid, vdata_id;
+    int32  i, n, pos;
+    int32  status;
+    intn   status_n;
+
+    stations = (int16 *)malloc(INDEX_NRECS * sizeof(int16));
+    CHECK_ALLOC(stations, "stations", "test_vsindex");
+    indices = (int32 *)malloc(INDEX_NRECS * sizeof(int32));
+    CHECK_ALLOC(indices, "indices", "test_vsindex");
+
+    fid = Hopen(INDEX_FILE, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status_n = Vstart(fid);
+    CHECK_VOID(status_n, FAIL, "Vstart");
+
+    vdata_id = VSattach(fid, -1, "w");
+    CHECK_VOID(vdata_id, FAIL, "VSattach");
+    status = VSsetname(vdata_id, INDEX_VD);
+    CHECK_VOID(status, FAIL, "VSsetname");
+    status_n = VSfdefine(vdata_id, INDEX_STATION, DFNT_INT16, 1);
+    CHECK_VOID(status_n, FAIL, "VSfdefine");
+    status_n = VSfdefine(vdata_id, INDEX_LEVEL, DFNT_FLOAT32, 1);
+    CHECK_VOID(status_n, FAIL, "VSfdefine");
+    status_n = VSfdefine(vdata_id, INDEX_VEC, DFNT_INT32, 2);
+    CHECK_VOID(status_n, FAIL, "VSfdefine");
+    status_n = VSsetfields(vdata_id, INDEX_FIELDS);
+    CHECK_VOID(status_n, FAIL, "VSsetfields");
+    status_n = VSsetblocksize(vdata_id, 1000);
+    CHECK_VOID(status_n, FAIL, "VSsetblocksize");
+
+    /* the first records, then the index, then the other records */
+    for (i = 0; i < INDEX_NRECS; i++) {
+        if (i == INDEX_FIRST) {
+            n = VSlookup(vdata_id, INDEX_STATION, 7.0, INDEX_NRECS, indices);
+            VERIFY_VOID(n, FAIL, "VSlookup");
+            status_n = VScreateindex(vdata_id, INDEX_STATION);
+            CHECK_VOID(status_n, FAIL, "VScreateindex");
+            n = VSlookup(vdata_id, INDEX_STATION, 7.0, INDEX_NRECS, indices);
+            check_vsindex(stations, INDEX_FIRST, 7, 7, n, indices);
+        }
+        rec.station = stations[i] = INDEX_STATION_OF(i, 0);
+        rec.level                 = (float32)i * 0.5f;
+        rec.vec[0] = rec.vec[1] = i;
+        status = VSfpack(vdata_id, _HDF_VSPACK, NULL, buf, sizeof(buf), 1, NULL, fldbufs);
+        CHECK_VOID(status, FAIL, "VSfpack");
+        status = VSwrite(vdata_id, buf, 1, FULL_INTERLACE);
+        VERIFY_VOID(status, 1, "VSwrite");
+    }
+    VERIFY_VOID(VSelts(vdata_id), INDEX_NRECS, "VSelts");
+
+    /* the records appended since the index was built are found */
+    n = VSrange(vdata_id, INDEX_STATION, 10.0, 12.0, INDEX_NRECS, indices);
+    check_vsindex(stations, INDEX_NRECS, 10, 12, n, indices);
+
+    /* fields of an order above 1 cannot be indexed */
+    status_n = VScreateindex(vdata_id, INDEX_VEC);
+    VERIFY_VOID(status_n, FAIL, "VScreateindex");
+
+    status = VSdetach(vdata_id);
+    CHECK_VOID(status, FAIL, "VSdetach");
+
+    /* write over the first records in another attach */
+    vdata_id = VSattach(fid, VSfind(fid, INDEX_VD), "w");
+    CHECK_VOID(vdata_id, FAIL, "VSattach");
+    status_n = VSsetfields(vdata_id, INDEX_FIELDS);
+    CHECK_VOID(status_n, FAIL, "VSsetfields");
+    status = VSseek(vdata_id, 0);
+    CHECK_VOID(status, FAIL, "VSseek");
+    for (i = 0; i < INDEX_FIRST / 2; i++) {
+        rec.station = stations[i] = INDEX_STATION_OF(i, 1);
+        rec.level                 = (float32)i * 0.5f;
+        rec.vec[0] = rec.vec[1] = i;
+        status = VSfpack(vdata_id, _HDF_VSPACK, NULL, buf, sizeof(buf), 1, NULL, fldbufs);
+        CHECK_VOID(status, FAIL, "VSfpack");
+        status = VSwrite(vdata_id, buf, 1, FULL_INTERLACE);
+        VERIFY_VOID(status, 1, "VSwrite");
+    }
+
+    /* an index of a second field, built again too at the detach */
+    status_n = VScreateindex(vdata_id, INDEX_LEVEL);
+    CHECK_VOID(status_n, FAIL, "VScreateindex");
+    status = VSdetach(vdata_id);
+    CHECK_VOID(status, FAIL, "VSdetach");
+    status_n = Vend(fid);
+    CHECK_VOID(status_n, FAIL, "Vend");
+    status_n = Hclose(fid);
+    CHECK_VOID(status_n, FAIL, "Hclose");
+
+    fid = Hopen(INDEX_FILE, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status_n = Vstart(fid);
+    CHECK_VOID(status_n, FAIL, "Vstart");
+    vdata_id = VSattach(fid, VSfind(fid, INDEX_VD), "r");
+    CHECK_VOID(vdata_id, FAIL, "VSattach");
+    status_n = VSsetfields(vdata_id, INDEX_FIELDS);
+    CHECK_VOID(status_n, FAIL, "VSsetfields");
+
+    /* the indexes are vdatas of the library */
+    n = VSgetvdatas(fid, 0, INDEX_NRECS, (uint16 *)indices);
+    VERIFY_VOID(n, 1, "VSgetvdatas");
+
+    /* the position is kept */
+    status = VSseek(vdata_id, 123);
+    CHECK_VOID(status, FAIL, "VSseek");
+    n = VSrange(vdata_id, INDEX_STATION, 0.0, 49.0, INDEX_NRECS, indices);
+    check_vsindex(stations, INDEX_NRECS, 0, 49, n, indices);
+    status = VSread(vdata_id, buf, 1, FULL_INTERLACE);
+    VERIFY_VOID(status, 1, "VSread");
+    status = VSfpack(vdata_id, _HDF_VSUNPACK, NULL, buf, sizeof(buf), 1, INDEX_VEC, &fldbufs[2]);
+    CHECK_VOID(status, FAIL, "VSfpack");
+    pos = rec.vec[0];
+    VERIFY_VOID(pos, 123, "VSrange");
+
+    /* fewer indices than matches, and only the count */
+    n = VSlookup(vdata_id, INDEX_STATION, 39.0, INDEX_NRECS, indices);
+    check_vsindex(stations, INDEX_NRECS, 39, 39, n, indices);
+    status = VSlookup(vdata_id, INDEX_STATION, 39.0, 3, few);
+    VERIFY_VOID(status, n, "VSlookup");
+    if (memcmp(few, indices, sizeof(few)) != 0) {
+        num_errs++;
+        printf(">>> VSlookup found other records with less room\n");
+    }
+    status = VSlookup(vdata_id, INDEX_STATION, 39.0, 0, NULL);
+    VERIFY_VOID(status, n, "VSlookup");
+    n = VSlookup(vdata_id, INDEX_STATION, 7.5, INDEX_NRECS, indices);
+    VERIFY_VOID(n, 0, "VSlookup");
+
+    /* the levels are unique, in the order of the records */
+    n = VSrange(vdata_id, INDEX_LEVEL, 100.0, 200.0, INDEX_NRECS, indices);
+    VERIFY_VOID(n, 201, "VSrange");
+    VERIFY_VOID(indices[0], 200, "VSrange");
+    VERIFY_VOID(indices[200], 400, "VSrange");
+
+    status = VSdetach(vdata_id);
+    CHECK_VOID(status, FAIL, "VSdetach");
+    status_n = Vend(fid);
+    CHECK_VOID(status_n, FAIL, "Vend");
+    status_n = Hclose(fid);
+    CHECK_VOID(status_n, FAIL, "Hclose");
+
+    free(stations);
+    free(indices);
+} /* test_vsindex */
+
+/*
+   Testing Vgettree: a small hierarchy with a vgroup in two parents and a
+   vdata entry, got while a new vgroup is still attached, then from the
+   reopened file.
+ */
+#define TREE_FILE "tvgtree.hdf"
+
+static void
+check_vgtree(const hdf_vgtree_t *tree, int32 fid, intn nnodes)
+{
+    const hdf_vgnode_t *node, *root = NULL, *a = NULL, *b = NULL;
+    int32               offset, prev = 0;
+    intn                i;
+
+    VERIFY_VOID(tree->nnodes, nnodes, "Vgettree");
+    for (i = 0; i < tree->nnodes; i++) {
+        node = &tree->nodes[i];
+        if (strcmp(node->name, "Root") == 0)
+            root = node;
+        else if (strcmp(node->name, "A") == 0)
+            a = node;
+        else if (strcmp(node->name, "B") == 0)
+            b = node;
+
+        /* the vgroups not written yet come last */
+        if ((offset = Hoffset(fid, DFTAG_VG, node->ref)) == FAIL)
+            offset = INT32_MAX;
+        if (offset < prev) {
+            num_errs++;
+            printf(">>> Vgettree: node %d is out of file order\n", (int)i);
+        }
+        prev = offset;
+    }
+    if (root == NULL || a == NULL || b == NULL) {
+        num_errs++;
+        printf(">>> Vgettree: missing vgroups\n");
+        return;
+    }
+
+    if (strcmp(root->vclass, "Top") != 0 || strcmp(a->vclass, "") != 0 || strcmp(b->vclass, "Leaf") != 0) {
+        num_errs++;
+        printf(">>> Vgettree: bad class names\n");
+    }
+    VERIFY_VOID(root->nentries, 3, "Vgettree");
+    VERIFY_VOID(root->nchildren, 2, "Vgettree");
+    VERIFY_VOID(root->nparents, 0, "Vgettree");
+    VERIFY_VOID(a->nchildren, 1, "Vgettree");
+    VERIFY_VOID(a->nparents, 1, "Vgettree");
+    VERIFY_VOID(b->nentries, 0, "Vgettree");
+    VERIFY_VOID(b->nparents, 2, "Vgettree");
+    if (root->nchildren == 2 && a->nchildren == 1 &&
+        (&tree->nodes[root->children[0]] != a || &tree->nodes[root->children[1]] != b ||
+         &tree->nodes[a->children[0]] != b)) {
+        num_errs++;
+        printf(">>> Vgettree: bad children\n");
+    }
+    if (root->nentries == 3 && (root->tags[0] != DFTAG_VG || root->tags[1] != DFTAG_VH ||
+                                root->tags[2] != DFTAG_VG || root->refs[0] != a->ref)) {
+        num_errs++;
+        printf(">>> Vgettree: bad entries\n");
+    }
+} /* check_vgtree */
+
+static void
+test_vgettree(void)
+{
+    hdf_vgtree_t *tree = NULL;
+    int32         fid, root_id, root_ref, a_id, b_id, c_id, vdata_id;
+    int32         status;
+    intn          status_n;
+
+    fid = Hopen(TREE_FILE, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status_n = Vstart(fid);
+    CHECK_VOID(status_n, FAIL, "Vstart");
+
+    root_id = Vattach(fid, -1, "w");
+    CHECK_VOID(root_id, FAIL, "Vattach");
+    status = Vsetname(root_id, "Root");
+    CHECK_VOID(status, FAIL, "Vsetname");
+    status = Vsetclass(root_id, "Top");
+    CHECK_VOID(status, FAIL, "Vsetclass");
+    root_ref = VQueryref(root_id);
+    CHECK_VOID(root_ref, FAIL, "VQueryref");
+    a_id = Vattach(fid, -1, "w");
+    CHECK_VOID(a_id, FAIL, "Vattach");
+    status = Vsetname(a_id, "A");
+    CHECK_VOID(status, FAIL, "Vsetname");
+    b_id = Vattach(fid, -1, "w");
+    CHECK_VOID(b_id, FAIL, "Vattach");
+    status = Vsetname(b_id, "B");
+    CHECK_VOID(status, FAIL, "Vsetname");
+    status = Vsetclass(b_id, "Leaf");
+    CHECK_VOID(status, FAIL, "Vsetclass");
+
+    vdata_id = VSattach(fid, -1, "w");
+    CHECK_VOID(vdata_id, FAIL, "VSattach");
+    status_n = VSfdefine(vdata_id, "X", DFNT_INT32, 1);
+    CHECK_VOID(status_n, FAIL, "VSfdefine");
+    status_n = VSsetfields(vdata_id, "X");
+    CHECK_VOID(status_n, FAIL, "VSsetfields");
+
+    status = Vinsert(root_id, a_id);
+    CHECK_VOID(status, FAIL, "Vinsert");
+    status = Vinsert(root_id, vdata_id);
+    CHECK_VOID(status, FAIL, "Vinsert");
+    status = Vinsert(root_id, b_id);
+    CHECK_VOID(status, FAIL, "Vinsert");
+    status = Vinsert(a_id, b_id);
+    CHECK_VOID(status, FAIL, "Vinsert");
+
+    status = VSdetach(vdata_id);
+    CHECK_VOID(status, FAIL, "VSdetach");
+    status = Vdetach(root_id);
+    CHECK_VOID(status, FAIL, "Vdetach");
+    status = Vdetach(a_id);
+    CHECK_VOID(status, FAIL, "Vdetach");
+    status = Vdetach(b_id);
+    CHECK_VOID(status, FAIL, "Vdetach");
+
+    /* a vgroup that is attached and not written yet is in the tree too */
+    c_id = Vattach(fid, -1, "w");
+    CHECK_VOID(c_id, FAIL, "Vattach");
+    status_n = Vgettree(fid, &tree);
+    CHECK_VOID(status_n, FAIL, "Vgettree");
+    check_vgtree(tree, fid, 4);
+    Vfreetree(tree);
+    status = Vdetach(c_id);
+    CHECK_VOID(status, FAIL, "Vdetach");
+
+    status_n = Vend(fid);
+    CHECK_VOID(status_n, FAIL, "Vend");
+    status_n = Hclose(fid);
+    CHECK_VOID(status_n, FAIL, "Hclose");
+
+    /* from the reopened file, whose vgroup headers are all read at once */
+    fid = Hopen(TREE_FILE, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status_n = Vstart(fid);
+    CHECK_VOID(status_n, FAIL, "Vstart");
+    status_n = Vgettree(fid, &tree);
+    CHECK_VOID(status_n, FAIL, "Vgettree");
+    check_vgtree(tree, fid, 4);
+    Vfreetree(tree);
+
+    /* the headers read are used by Vattach */
+    root_id = Vattach(fid, root_ref, "r");
+    CHECK_VOID(root_id, FAIL, "Vattach");
+    VERIFY_VOID(Vntagrefs(root_id), 3, "Vntagrefs");
+    status = Vdetach(root_id);
+    CHECK_VOID(status, FAIL, "Vdetach");
+
+    status_n = Vend(fid);
+    CHECK_VOID(status_n, FAIL, "Vend");
+    status_n = Hclose(fid);
+    CHECK_VOID(status_n, FAIL, "Hclose");
+} /* test_vgettree */
+
+/*
+   Testing the lookups of tag/ref pairs in a vgroup large enough to use a
+   hash table: Vinqtagref, Visvs, Vinsert's check of duplicates and
+   Vdeletetagref, as entries are added and deleted, then after reopening.
+ */
+#define TAGREF_FILE  "tvghash.hdf"
+#define TAGREF_NELTS 500
+
+static void
+test_vgtagref_hash(void)
+{
+    int32 fid, vgroup_id, vgroup_ref, vdata_id;
+    int32 tag, ref;
+    int32 i, n;
+    int32 status;
+    intn  status_n;
+
+    fid = Hopen(TAGREF_FILE, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status_n = Vstart(fid);
+    CHECK_VOID(status_n, FAIL, "Vstart");
+
+    vgroup_id = Vattach(fid, -1, "w");
+    CHECK_VOID(vgroup_id, FAIL, "Vattach");
+    vgroup_ref = VQueryref(vgroup_id);
+    CHECK_VOID(vgroup_ref, FAIL, "VQueryref");
+
+    /* entries 2*i and 2*i + 1 have ref i + 1, under two different tags */
+    for (i = 0; i < TAGREF_NELTS / 2; i++) {
+        status = Vaddtagref(vgroup_id, DFTAG_NDG, i + 1);
+        VERIFY_VOID(status, 2 * i + 1, "Vaddtagref");
+        status = Vaddtagref(vgroup_id, DFTAG_RIG, i + 1);
+        VERIFY_VOID(status, 2 * i + 2, "Vaddtagref");
+
+        /* look up while the table grows */
+        if (i % 37 == 0) {
+            VERIFY_VOID(Vinqtagref(vgroup_id, DFTAG_NDG, i / 2 + 1), TRUE, "Vinqtagref");
+            VERIFY_VOID(Vinqtagref(vgroup_id, DFTAG_RIG, i + 2), FALSE, "Vinqtagref");
+        }
+    }
+
+    /* a duplicate of entry 10, Vdeletetagref deletes the first one */
+    status = Vaddtagref(vgroup_id, DFTAG_NDG, 6);
+    VERIFY_VOID(status, TAGREF_NELTS + 1, "Vaddtagref");
+    status_n = Vdeletetagref(vgroup_id, DFTAG_NDG, 6);
+    CHECK_VOID(status_n, FAIL, "Vdeletetagref");
+    VERIFY_VOID(Vinqtagref(vgroup_id, DFTAG_NDG, 6), TRUE, "Vinqtagref");
+    status_n = Vgettagref(vgroup_id, 10, &tag, &ref);
+    CHECK_VOID(status_n, FAIL, "Vgettagref");
+    VERIFY_VOID(tag, DFTAG_RIG, "Vgettagref");
+    VERIFY_VOID(ref, 6, "Vgettagref");
+    status_n = Vdeletetagref(vgroup_id, DFTAG_NDG, 6);
+    CHECK_VOID(status_n, FAIL, "Vdeletetagref");
+    VERIFY_VOID(Vinqtagref(vgroup_id, DFTAG_NDG, 6), FALSE, "Vinqtagref");
+    status_n = Vdeletetagref(vgroup_id, DFTAG_NDG, 6);
+    VERIFY_VOID(status_n, FAIL, "Vdeletetagref");
+
+    /* a vdata is inserted once only */
+    vdata_id = VSattach(fid, -1, "w");
+    CHECK_VOID(vdata_id, FAIL, "VSattach");
+    status = Vinsert(vgroup_id, vdata_id);
+    VERIFY_VOID(status, TAGREF_NELTS - 1, "Vinsert");
+    status = Vinsert(vgroup_id, vdata_id);
+    VERIFY_VOID(status, FAIL, "Vinsert");
+    VERIFY_VOID(Visvs(vgroup_id, VSQueryref(vdata_id)), TRUE, "Visvs");
+    status = VSdetach(vdata_id);
+    CHECK_VOID(status, FAIL, "VSdetach");
+
+    status = Vdetach(vgroup_id);
+    CHECK_VOID(status, FAIL, "Vdetach");
+    status_n = Vend(fid);
+    CHECK_VOID(status_n, FAIL, "Vend");
+    status_n = Hclose(fid);
+    CHECK_VOID(status_n, FAIL, "Hclose");
+
+    /* every entry is found in the reopened file, in its place */
+    fid = Hopen(TAGREF_FILE, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status_n = Vstart(fid);
+    CHECK_VOID(status_n, FAIL, "Vstart");
+    vgroup_id = Vattach(fid, vgroup_ref, "r");
+    CHECK_VOID(vgroup_id, FAIL, "Vattach");
+
+    n = Vntagrefs(vgroup_id);
+    VERIFY_VOID(n, TAGREF_NELTS, "Vntagrefs");
+    for (i = 0; i < n; i++) {
+        status_n = Vgettagref(vgroup_id, i, &tag, &ref);
+        CHECK_VOID(status_n, FAIL, "Vgettagref");
+        if (Vinqtagref(vgroup_id, tag, ref) != TRUE) {
+            num_errs++;
+            printf(">>> Vinqtagref did not find entry #%d\n", (int)i);
+        }
+    }
+    VERIFY_VOID(Vinqtagref(vgroup_id, DFTAG_NDG, 6), FALSE, "Vinqtagref");
+    VERIFY_VOID(Vinqtagref(vgroup_id, DFTAG_RIG, TAGREF_NELTS), FALSE, "Vinqtagref");
+
+    status = Vdetach(vgroup_id);
+    CHECK_VOID(status, FAIL, "Vdetach");
+    status_n = Vend(fid);
+    CHECK_VOID(status_n, FAIL, "Vend");
+    status_n = Hclose(fid);
+    CHECK_VOID(status_n, FAIL, "Hclose");
+} /* test_vgtagref_hash */
+
+/*
+   Testing Hset_allocator: the metadata of a file with some vgroups and
+   vdatas is allocated and freed by counting routines, all of it by the
+   time the file is closed.
+ */
+#define ALLOC_FILE "tvalloc.hdf"
+
+/* Blocks allocated and not freed yet by the counting routines */
+static struct {
+    long nalloc;
+    long nlive;
+} alloc_count;
+
+static void *
+count_alloc(size_t size, void *ctx)
+{
+    ((long *)ctx)[0]++;
+    ((long *)ctx)[1]++;
+    return malloc(size);
+}
+
+static void
+count_free(void *ptr, void *ctx)
+{
+    ((long *)ctx)[1]--;
+    free(ptr);
+}
+
+static void
+test_allocator(void)
+{
+    hdf_allocator_t allocator;
+    int32           fid, vgroup_id, vdata_id, tag, ref;
+    int32           i;
+    int32           status;
+    intn            status_n;
+
+    allocator.alloc = count_alloc;
+    allocator.free  = NULL;
+    allocator.ctx   = &alloc_count;
+    status_n        = Hset_allocator(&allocator);
+    VERIFY_VOID(status_n, FAIL, "Hset_allocator");
+    allocator.free = count_free;
+    status_n       = Hset_allocator(&allocator);
+    CHECK_VOID(status_n, FAIL, "Hset_allocator");
+
+    fid = Hopen(ALLOC_FILE, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status_n = Vstart(fid);
+    CHECK_VOID(status_n, FAIL, "Vstart");
+    for (i = 0; i < 50; i++) {
+        vgroup_id = Vattach(fid, -1, "w");
+        CHECK_VOID(vgroup_id, FAIL, "Vattach");
+        vdata_id = VSattach(fid, -1, "w");
+        CHECK_VOID(vdata_id, FAIL, "VSattach");
+        status_n = VSfdefine(vdata_id, "X", DFNT_INT32, 1);
+        CHECK_VOID(status_n, FAIL, "VSfdefine");
+        status_n = VSsetfields(vdata_id, "X");
+        CHECK_VOID(status_n, FAIL, "VSsetfields");
+        status = VSwrite(vdata_id, (const uint8 *)&i, 1, FULL_INTERLACE);
+        VERIFY_VOID(status, 1, "VSwrite");
+        status = Vinsert(vgroup_id, vdata_id);
+        CHECK_VOID(status, FAIL, "Vinsert");
+        status = VSdetach(vdata_id);
+        CHECK_VOID(status, FAIL, "VSdetach");
+        status = Vdetach(vgroup_id);
+        CHECK_VOID(status, FAIL, "Vdetach");
+    }
+    status_n = Vend(fid);
+    CHECK_VOID(status_n, FAIL, "Vend");
+    status_n = Hclose(fid);
+    CHECK_VOID(status_n, FAIL, "Hclose");
+
+    /* the instances and headers read from the file come from its arena */
+    alloc_count.nalloc = 0;
+    fid                = Hopen(ALLOC_FILE, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status_n = Vstart(fid);
+    CHECK_VOID(status_n, FAIL, "Vstart");
+    ref = -1;
+    for (i = 0; i < 50; i++) {
+        ref = Vgetid(fid, ref);
+        CHECK_VOID(ref, FAIL, "Vgetid");
+        vgroup_id = Vattach(fid, ref, "r");
+        CHECK_VOID(vgroup_id, FAIL, "Vattach");
+        status = Vgettagref(vgroup_id, 0, &tag, &ref);
+        CHECK_VOID(status, FAIL, "Vgettagref");
+        vdata_id = VSattach(fid, ref, "r");
+        CHECK_VOID(vdata_id, FAIL, "VSattach");
+        status = VSdetach(vdata_id);
+        CHECK_VOID(status, FAIL, "VSdetach");
+        ref    = VQueryref(vgroup_id);
+        status = Vdetach(vgroup_id);
+        CHECK_VOID(status, FAIL, "Vdetach");
+    }
+    if (alloc_count.nalloc == 0 || alloc_count.nalloc > 20) {
+        num_errs++;
+        printf(">>> Hset_allocator: %ld blocks allocated for the metadata of a file\n", alloc_count.nalloc);
+    }
+    status_n = Vend(fid);
+    CHECK_VOID(status_n, FAIL, "Vend");
+    status_n = Hclose(fid);
+    CHECK_VOID(status_n, FAIL, "Hclose");
+    VERIFY_VOID(alloc_count.nlive, 0, "Hset_allocator");
+
+    status_n = Hset_allocator(NULL);
+    CHECK_VOID(status_n, FAIL, "Hset_allocator");
+} /* test_allocator */
+
+/*
+   Testing Hget_memory_usage and Htrim_memory: the headers and trees of a
+   file are counted while it is open and given back when it is closed,
+   and trimming empties the free lists and the scratch buffers.
+ */
+static void
+test_memory_usage(void)
+{
+    hdf_memory_report_t before, open, closed, trimmed;
+    int32               fid, vgroup_id, vdata_id, tag, ref, val;
+    int32               i;
+    int32               status;
+    intn                status_n;
+
+    status_n = Hget_memory_usage(NULL);
+    VERIFY_VOID(status_n, FAIL, "Hget_memory_usage");
+    status_n = Hget_memory_usage(&before);
+    CHECK_VOID(status_n, FAIL, "Hget_memory_usage");
+
+    fid = Hopen(ALLOC_FILE, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status_n = Vstart(fid);
+    CHECK_VOID(status_n, FAIL, "Vstart");
+    ref = -1;
+    for (i = 0; i < 50; i++) {
+        ref = Vgetid(fid, ref);
+        CHECK_VOID(ref, FAIL, "Vgetid");
+        vgroup_id = Vattach(fid, ref, "r");
+        CHECK_VOID(vgroup_id, FAIL, "Vattach");
+        status = Vgettagref(vgroup_id, 0, &tag, &ref);
+        CHECK_VOID(status, FAIL, "Vgettagref");
+        vdata_id = VSattach(fid, ref, "r");
+        CHECK_VOID(vdata_id, FAIL, "VSattach");
+        status_n = VSsetfields(vdata_id, "X");
+        CHECK_VOID(status_n, FAIL, "VSsetfields");
+        status = VSread(vdata_id, (uint8 *)&val, 1, FULL_INTERLACE);
+        VERIFY_VOID(status, 1, "VSread");
+        VERIFY_VOID(val, i, "VSread");
+        status = VSdetach(vdata_id);
+        CHECK_VOID(status, FAIL, "VSdetach");
+        ref    = VQueryref(vgroup_id);
+        status = Vdetach(vgroup_id);
+        CHECK_VOID(status, FAIL, "Vdetach");
+    }
+    status_n = Hget_memory_usage(&open);
+    CHECK_VOID(status_n, FAIL, "Hget_memory_usage");
+    status_n = Vend(fid);
+    CHECK_VOID(status_n, FAIL, "Vend");
+    status_n = Hclose(fid);
+    CHECK_VOID(status_n, FAIL, "Hclose");
+    status_n = Hget_memory_usage(&closed);
+    CHECK_VOID(status_n, FAIL, "Hget_memory_usage");
+
+    /* the headers of the open file are in its arena, its trees in slabs */
+    if (open.current[HDF_MEM_VHEADERS] <= before.current[HDF_MEM_VHEADERS] ||
+        open.current[HDF_MEM_TBBT] <= before.current[HDF_MEM_TBBT] || open.current[HDF_MEM_ATOMS] == 0 ||
+        open.current[HDF_MEM_SCRATCH] == 0) {
+        num_errs++;
+        printf(">>> Hget_memory_usage: memory of an open file not counted\n");
+    }
+    VERIFY_VOID(closed.current[HDF_MEM_VHEADERS], before.current[HDF_MEM_VHEADERS], "Hget_memory_usage");
+    for (i = 0; i < HDF_MEM_NCATEGORIES; i++)
+        if (closed.peak[i] < open.current[i] || closed.peak[i] < closed.current[i]) {
+            num_errs++;
+            printf(">>> Hget_memory_usage: peak of category %d below its current count\n", (int)i);
+        }
+
+    status_n = Htrim_memory();
+    CHECK_VOID(status_n, FAIL, "Htrim_memory");
+    status_n = Hget_memory_usage(&trimmed);
+    CHECK_VOID(status_n, FAIL, "Hget_memory_usage");
+    VERIFY_VOID(trimmed.current[HDF_MEM_FREE_LISTS], 0, "Htrim_memory");
+    VERIFY_VOID(trimmed.current[HDF_MEM_SCRATCH], 0, "Htrim_memory");
+    VERIFY_VOID(trimmed.peak[HDF_MEM_FREE_LISTS], closed.peak[HDF_MEM_FREE_LISTS], "Htrim_memory");
+} /* test_memory_usage */
+
+/*
+   Testing Hsethugepages: a vdata larger than a huge page is read through
+   scratch buffers made in each mode, every one freed in the next mode.
+ */
+#define HUGE_FILE  "tvhuge.hdf"
+#define HUGE_NRECS 300000 /* records of two int32: more than 2 MB */
+
+static void
+test_hugepages(void)
+{
+    static const intn modes[3] = {HDF_HUGEPAGES_NONE, HDF_HUGEPAGES_TRANSPARENT | HDF_HUGEPAGES_LOCAL,
+                                  HDF_HUGEPAGES_EXPLICIT};
+    int32            *buf = NULL;
+    int32             fid, vdata_id, ref, nrecs;
+    int32             i, m;
+    int32             status;
+    intn              status_n;
+
+    status_n = Hsethugepages(0x40);
+    VERIFY_VOID(status_n, FAIL, "Hsethugepages");
+    status_n = Hsethugepages(HDF_HUGEPAGES_TRANSPARENT | HDF_HUGEPAGES_EXPLICIT);
+    VERIFY_VOID(status_n, FAIL, "Hsethugepages");
+#if !defined(H4_HAVE_MMAP) || !defined(H4_HAVE_SYS_MMAN_H)
+    status_n = Hsethugepages(HDF_HUGEPAGES_TRANSPARENT);
+    VERIFY_VOID(status_n, FAIL, "Hsethugepages");
+    return; /* no mapped buffers here */
+#endif
+
+    if ((buf = (int32 *)malloc(2 * HUGE_NRECS * sizeof(int32))) == NULL) {
+        num_errs++;
+        printf(">>> Hsethugepages: out of memory\n");
+        return;
+    }
+    for (i = 0; i < 2 * HUGE_NRECS; i++)
+        buf[i] = i;
+
+    status_n = Hsethugepages(HDF_HUGEPAGES_TRANSPARENT);
+    CHECK_VOID(status_n, FAIL, "Hsethugepages");
+    fid = Hopen(HUGE_FILE, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status_n = Vstart(fid);
+    CHECK_VOID(status_n, FAIL, "Vstart");
+    vdata_id = VSattach(fid, -1, "w");
+    CHECK_VOID(vdata_id, FAIL, "VSattach");
+    status_n = VSfdefine(vdata_id, "A", DFNT_INT32, 1);
+    CHECK_VOID(status_n, FAIL, "VSfdefine");
+    status_n = VSfdefine(vdata_id, "B", DFNT_INT32, 1);
+    CHECK_VOID(status_n, FAIL, "VSfdefine");
+    status_n = VSsetfields(vdata_id, "A,B");
+    CHECK_VOID(status_n, FAIL, "VSsetfields");
+    status = VSwrite(vdata_id, (const uint8 *)buf, HUGE_NRECS, FULL_INTERLACE);
+    VERIFY_VOID(status, HUGE_NRECS, "VSwrite");
+    status = VSdetach(vdata_id);
+    CHECK_VOID(status, FAIL, "VSdetach");
+    status_n = Vend(fid);
+    CHECK_VOID(status_n, FAIL, "Vend");
+    status_n = Hclose(fid);
+    CHECK_VOID(status_n, FAIL, "Hclose");
+
+    /* more records at each read, so that the scratch buffer of the
+       previous mode is freed and another one made */
+    fid = Hopen(HUGE_FILE, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status_n = Vstart(fid);
+    CHECK_VOID(status_n, FAIL, "Vstart");
+    ref = VSgetid(fid, -1);
+    CHECK_VOID(ref, FAIL, "VSgetid");
+    for (m = 0; m < 3; m++) {
+        status_n = Hsethugepages(modes[m]);
+        CHECK_VOID(status_n, FAIL, "Hsethugepages");
+        nrecs    = HUGE_NRECS - (2 - m) * 10000;
+        vdata_id = VSattach(fid, ref, "r");
+        CHECK_VOID(vdata_id, FAIL, "VSattach");
+        status_n = VSsetfields(vdata_id, "A,B");
+        CHECK_VOID(status_n, FAIL, "VSsetfields");
+        memset(buf, 0, 2 * HUGE_NRECS * sizeof(int32));
+        status = VSread(vdata_id, (uint8 *)buf, nrecs, NO_INTERLACE);
+        VERIFY_VOID(status, nrecs, "VSread");
+        for (i = 0; i < nrecs; i++)
+            if (buf[i] != 2 * i || buf[nrecs + i] != 2 * i + 1) {
+                num_errs++;
+                printf(">>> Hsethugepages: record %d read in mode %d is wrong\n", (int)i, (int)modes[m]);
+                break;
+            }
+        status = VSdetach(vdata_id);
+        CHECK_VOID(status, FAIL, "VSdetach");
+    }
+    status_n = Vend(fid);
+    CHECK_VOID(status_n, FAIL, "Vend");
+    status_n = Hclose(fid);
+    CHECK_VOID(status_n, FAIL, "Hclose");
+
+    /* the last buffer is freed in another mode than it was made in */
+    status_n = Hsethugepages(HDF_HUGEPAGES_NONE);
+    CHECK_VOID(status_n, FAIL, "Hsethugepages");
+    status_n = Htrim_memory();
+    CHECK_VOID(status_n, FAIL, "Htrim_memory");
+
+    free(buf);
+} /* test_hugepages */
+
 /* main test driver */
 void
 test_vsets(void)
@@ -3360,6 +4469,30 @@ test_vsets(void)
 
     /* test_extfile - getting external file information */
     test_extfile();
+
+    /* test VSquery - finding the records that meet conditions on fields */
+    test_vsquery();
+
+    /* test VSwritecolumns - writing the fields from one array each */
+    test_vswritecolumns();
+
+    /* test VScreateindex, VSlookup and VSrange - looking up indexed fields */
+    test_vsindex();
+
+    /* test Vgettree - getting the whole vgroup hierarchy at once */
+    test_vgettree();
+
+    /* test the hash table of the tag/ref pairs of large vgroups */
+    test_vgtagref_hash();
+
+    /* test Hset_allocator - allocating the metadata of the files */
+    test_allocator();
+
+    /* test Hget_memory_usage and Htrim_memory - accounting for the memory */
+    test_memory_usage();
+
+    /* test Hsethugepages - making the large buffers of huge pages */
+    test_hugepages();
 } /* test_vsets */
 
 /* TODO:
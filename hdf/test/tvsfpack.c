@@ -306,6 +306,55 @@ funpack(void)
             printf(">>> Wrong subset data2 after VSfpack.\n");
         }
 
+    /* switch between more field lists than the vdata keeps resolved,
+       reading a record each time, and unpacking alternate subsets */
+    {
+        const char *names[4] = {FIELD_1, FIELD_2, FIELD_3, FIELD_4};
+        char        flist[64];
+        int32       findex;
+        int         pass, k;
+
+        for (pass = 0; pass < 3; pass++)
+            for (k = 0; k < 20; k++) {
+                if (k < 16)
+                    snprintf(flist, sizeof(flist), "%s,%s", names[k % 4], names[(k / 4 + k) % 4]);
+                else
+                    snprintf(flist, sizeof(flist), "%s", names[k % 4]);
+                istat = VSsetfields(vdata_id, flist);
+                if (istat == FAIL) {
+                    num_errs++;
+                    printf(">>> VSsetfields failed for %s.\n", flist);
+                }
+                istat = VSfindex(vdata_id, names[k % 4], &findex);
+                if (istat == FAIL || findex != k % 4) {
+                    num_errs++;
+                    printf(">>> VSfindex found %d for %s.\n", (int)findex, names[k % 4]);
+                }
+
+                VSseek(vdata_id, 0);
+                istat         = VSsetfields(vdata_id, FIELD_NAMES);
+                istat         = VSread(vdata_id, databuf, 1, FULL_INTERLACE);
+                databufptr[0] = (k % 2) ? (void *)ispeed : (void *)iident;
+                istat = VSfpack(vdata_id, _HDF_VSUNPACK, NULL, databuf, rec_size, 1, (k % 2) ? FIELD_3 : FIELD_1,
+                                databufptr);
+                if (istat == FAIL || ((k % 2) ? ispeed[0] != 0 : iident[0] != 'A')) {
+                    num_errs++;
+                    printf(">>> VSfpack unpacked a wrong value.\n");
+                }
+            }
+
+        istat = VSsetfields(vdata_id, "Ident,NoSuchField");
+        if (istat != FAIL) {
+            num_errs++;
+            printf(">>> VSsetfields accepted an unknown field.\n");
+        }
+        istat = VSfindex(vdata_id, "NoSuchField", &findex);
+        if (istat != FAIL) {
+            num_errs++;
+            printf(">>> VSfindex found an unknown field.\n");
+        }
+    }
+
     VSdetach(vdata_id);
     Vend(file_id);
     Hclose(file_id);
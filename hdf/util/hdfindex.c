@@ -0,0 +1,127 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*
+ ** FILE
+ **   hdfindex.c
+ ** USAGE
+ **   hdfindex [options] <hdffile> ...
+ ** DESCRIPTION
+ **   This program writes the sidecar index of each HDF file, under the
+ **   name of the file followed by ".h4idx".  The index holds the DD list
+ **   and the metadata of the file, so that a reader can load them with
+ **   one read, see Hreadindex(), and read only the data from the file.
+ **      Options are:
+ **           -m <bytes> Index the contents of the elements of at most
+ **              <bytes> bytes.  Default is 65536.
+ **           -v Print the length of each index written.
+ ** COMMENTS, BUGS, ASSUMPTIONS
+ **   The index must be written again whenever the file is modified.
+ */
+
+#include "hdf.h"
+#include "hfile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef H4_HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+
+#ifdef H4_HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+
+/* Prototypes declaration */
+int  main(int, char *a[]);
+void usage(void);
+
+/* variables */
+char *progname; /* the name this program is invoked, i.e. argv[0] */
+
+int
+main(int argc, char *argv[])
+{
+    int32 fid;
+    int32 max_len = 0;
+    intn  verbose = FALSE;
+    int   status  = 0;
+    char *end;
+
+    /* Get invocation name of program */
+    progname = *argv++;
+    argc--;
+
+    /* parse arguments */
+    while (argc > 0 && **argv == '-') {
+        switch ((*argv)[1]) {
+            case 'm':
+                argc--;
+                argv++;
+                if (argc == 0 || (max_len = (int32)strtol(*argv, &end, 10)) <= 0 || *end != '\0') {
+                    usage();
+                    exit(1);
+                }
+                argc--;
+                argv++;
+                break;
+            case 'v':
+                verbose = TRUE;
+                argc--;
+                argv++;
+                break;
+            default:
+                usage();
+                exit(1);
+        }
+    }
+
+    if (argc == 0) {
+        usage();
+        exit(1);
+    }
+
+    for (; argc > 0; argc--, argv++) {
+        if ((fid = Hopen(*argv, DFACC_READ, 0)) == FAIL) {
+            fprintf(stderr, "%s: cannot open %s\n", progname, *argv);
+            status = 1;
+            continue;
+        }
+        if (Hwriteindex(fid, max_len) == FAIL) {
+            fprintf(stderr, "%s: cannot write the index of %s\n", progname, *argv);
+            HEprint(stderr, 0);
+            status = 1;
+        }
+#ifdef H4_HAVE_SYS_STAT_H
+        else if (verbose) {
+            char        idxname[DF_MAXFNLEN];
+            struct stat sbuf;
+
+            snprintf(idxname, sizeof(idxname), "%s%s", *argv, HIDX_SUFFIX);
+            if (stat(idxname, &sbuf) == 0)
+                printf("%s: %ld bytes\n", idxname, (long)sbuf.st_size);
+        }
+#endif
+        if (Hclose(fid) == FAIL)
+            status = 1;
+    }
+
+    return status;
+}
+
+void
+usage(void)
+{
+    fprintf(stderr, "Usage: %s [-m <bytes>] [-v] <hdffile> ...\n", progname);
+}
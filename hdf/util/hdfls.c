@@ -14,9 +14,7 @@
 #include "hdf.h"
 #include "hfile.h"
 
-#define MAXBUFF 8192
-
-dd_t *desc_buf;
+dd_t *desc_buf = NULL;
 
 intn debug   = FALSE, /* Debugging is off by default */
     ddblocks = FALSE, /* DD block dumping is off by default */
@@ -422,8 +420,10 @@ dumpDD(void)
 int
 main(int argc, char *argv[])
 {
-    int32 fid, aid;
-    int   i = 1, j, n, status;
+    int32  fid, aid;
+    int32  off, len;
+    uint16 tag, ref;
+    int    i = 1, j, n, ndds;
 
     while ((i < argc) && (argv[i][0] == '-')) {
         switch (argv[i][1]) {
@@ -487,8 +487,6 @@ main(int argc, char *argv[])
         exit(1);
     }
 
-    desc_buf = (dd_t *)calloc(MAXBUFF, sizeof(dd_t));
-
     while (i < argc) {
         file_name = argv[i];
         printf("%s:\n", file_name);
@@ -515,18 +513,32 @@ main(int argc, char *argv[])
 
         printfilever(fid);
 
-        aid = Hstartread(fid, DFTAG_WILDCARD, DFREF_WILDCARD);
-        if (aid == FAIL) {
+        ndds = Hnumber(fid, DFTAG_WILDCARD);
+        if (ndds != FAIL)
+            desc_buf = (dd_t *)realloc(desc_buf, (size_t)(ndds + 1) * sizeof(dd_t));
+        if (ndds == FAIL || desc_buf == NULL) {
             HEprint(stderr, 0);
             i++;
             continue;
         }
 
-        status = SUCCEED;
-        for (n = 0; (n < MAXBUFF) && (status != FAIL); n++) {
-            Hinquire(aid, NULL, &desc_buf[n].tag, &desc_buf[n].ref, &desc_buf[n].length, &desc_buf[n].offset,
-                     NULL, NULL, NULL);
-            status = Hnextread(aid, DFTAG_WILDCARD, DFREF_WILDCARD, DF_CURRENT);
+        /* the DDs are taken from the DD list the library read in Hopen; no
+           element is opened but the special ones, and only to print their
+           lengths, which are those of their data rather than of their
+           special headers */
+        tag = ref = 0;
+        for (n = 0; n < ndds; n++) {
+            if (Hfind(fid, DFTAG_WILDCARD, DFREF_WILDCARD, &tag, &ref, &off, &len, DF_FORWARD) == FAIL)
+                break;
+            desc_buf[n].tag    = tag;
+            desc_buf[n].ref    = ref;
+            desc_buf[n].offset = off;
+            desc_buf[n].length = len;
+
+            if ((longout || debug) && SPECIALTAG(tag) && (aid = Hstartread(fid, tag, ref)) != FAIL) {
+                Hinquire(aid, NULL, NULL, NULL, &desc_buf[n].length, &desc_buf[n].offset, NULL, NULL, NULL);
+                Hendaccess(aid);
+            }
         }
 
         if (debug) {
@@ -547,17 +559,11 @@ main(int argc, char *argv[])
         if (v_init_done == TRUE)
             Vfinish(fid);
 
-        if (Hendaccess(aid) == FAIL)
-            HEprint(stderr, 0);
-
         if (Hclose(fid) == FAIL)
             HEprint(stderr, 0);
 
         i++;
         printf("\n");
-
-        if (n >= MAXBUFF)
-            fprintf(stderr, "Warning:  File may have more DD's than hdfls can display\n");
     }
 
     free(desc_buf);
@@ -27,6 +27,10 @@
  **          -x  Keep external objects external
  **          -r <from> <to> rename external objects
  **      Only one of options b and i can be specified.
+ **   The elements are copied in the order of their offsets in the input
+ **   file.  Runs of plain elements are read with one Hreadv() call per
+ **   buffer's worth, so the input is read mostly sequentially and in
+ **   large pieces; special elements are copied one at a time.
  ** COMMENTS, BUGS, ASSUMPTIONS
  **   Both arguments must be supplied to the program and they cannot be
  **   identical.
@@ -54,6 +58,8 @@ void copy_blocks(mydd_t *dd, int32 infile, int32 outfile);
 
 void merge_blocks(mydd_t *dd, int32 infile, int32 outfile);
 
+int pack_plain(mydd_t *dlist, int first, int num_desc, int32 infile, int32 outfile);
+
 int         main(int, char *a[]);
 static void usage(char *);
 static void hdferror(void);
@@ -63,6 +69,7 @@ int         desc_comp(const void *d1, const void *d2);
 unsigned char *data;
 char           invoke[81];
 int32          data_size;
+hdf_readv_t   *reqs;
 int32          nblk      = 0;
 char          *from_file = NULL;
 char          *to_file   = NULL;
@@ -72,6 +79,8 @@ main(int argc, char *argv[])
 {
     int     i, num_desc, fnum, merge;
     int32   infile, outfile, aid, ret;
+    int32   off, len;
+    uint16  tag, ref;
     mydd_t *dlist;
     int32   oldoff, oldlen;
     int     blocks   = 1;
@@ -191,53 +200,45 @@ main(int argc, char *argv[])
         hdferror();
 
     dlist = (mydd_t *)malloc(num_desc * sizeof(*dlist));
-    if (dlist == NULL)
+    reqs  = (hdf_readv_t *)malloc(num_desc * sizeof(*reqs));
+    if (dlist == NULL || reqs == NULL)
         error("\tWow!  That file must be HUGE!\n\tThere isn't enough memory to hold the DD's.\n");
 
     /*
-     **   Allocate data buffer - try 1 Meg first, work down
+     **   Allocate data buffer - try 16 Meg first, work down
      */
-    data_size = 1048576; /* 1 MB */
+    data_size = 16777216; /* 16 MB */
     data      = NULL;
     while ((data = (unsigned char *)malloc(data_size)) == NULL)
         data_size /= 2; /* okay then, cut request by half */
 
     /*
-     **   Get all DD's for data elements
+     **   Get all DD's for data elements from the DD list; only
+     **   special elements are opened, for their type and length
      */
-    aid = Hstartread(infile, DFTAG_WILDCARD, DFREF_WILDCARD);
-    if (aid == FAIL) {
-        printf("MAJOR PROBLEM: Hstartread for DD's; line %d\n", __LINE__);
-        hdferror();
-    }
+    tag = ref = 0;
     for (i = 0; i < num_desc; i++) {
-
-        /*
-         * Get data about the current one
-         */
-        Hinquire(aid, NULL, &dlist[i].tag, &dlist[i].ref, &dlist[i].length, &dlist[i].offset, NULL, NULL,
-                 &dlist[i].special);
-
-        /*
-         * Move to the next one
-         */
-        ret = Hnextread(aid, DFTAG_WILDCARD, DFREF_WILDCARD, DF_CURRENT);
-
-        /*
-         * Fail if there are none left and we expect more
-         */
-        if ((ret == FAIL) && (i + 1 < num_desc)) {
-            printf("MAJOR PROBLEM: DDs; only got %d of %d; line %d\n", i, num_desc, __LINE__);
-            hdferror();
+        if (Hfind(infile, DFTAG_WILDCARD, DFREF_WILDCARD, &tag, &ref, &off, &len, DF_FORWARD) == FAIL)
+            break;
+        dlist[i].tag     = tag;
+        dlist[i].ref     = ref;
+        dlist[i].offset  = off;
+        dlist[i].length  = len;
+        dlist[i].special = 0;
+
+        if (SPECIALTAG(tag)) {
+            aid = Hstartread(infile, tag, ref);
+            if (aid == FAIL) {
+                printf("MAJOR PROBLEM: Hstartread for DD %d; line %d\n", i, __LINE__);
+                hdferror();
+            }
+            Hinquire(aid, NULL, NULL, NULL, &dlist[i].length, NULL, NULL, NULL, &dlist[i].special);
+            ret = Hendaccess(aid);
+            if (ret == FAIL)
+                hdferror();
         }
     }
-
-    /*
-     * Close the access element
-     */
-    ret = Hendaccess(aid);
-    if (ret == FAIL)
-        hdferror();
+    num_desc = i;
 
     /*
      **   Sort DD's by offset to make it easy to
@@ -324,7 +325,11 @@ main(int argc, char *argv[])
                         free(buf);
                     } break;
                     default:
-                        merge_blocks(&dlist[i], infile, outfile);
+                        /* a run of plain elements that fit in the buffer is read at once */
+                        if (dlist[i].special == 0 && dlist[i].length > 0 && dlist[i].length <= data_size)
+                            i = pack_plain(dlist, i, num_desc, infile, outfile);
+                        else
+                            merge_blocks(&dlist[i], infile, outfile);
                         break;
                 } /* switch (special) */
             }
@@ -346,6 +351,7 @@ main(int argc, char *argv[])
     }
 
     free(data);
+    free(reqs);
     free(dlist);
 
     /*
@@ -494,6 +500,56 @@ merge_blocks(mydd_t *dd, int32 infile, int32 outfile)
     }
 }
 
+/*
+ ** NAME
+ **      pack_plain -- copy a run of plain elements
+ ** DESCRIPTION
+ **   Copies dlist[first] and the plain elements that follow it in the
+ **   list, as many as fit in the data buffer together.  Their data is
+ **   read with one Hreadv() call, which reads the extents in offset
+ **   order and merges neighbouring ones, then each element is written
+ **   to the output file with a single Hputelement().
+ ** RETURNS
+ **   The index in dlist of the last element copied.
+ */
+int
+pack_plain(mydd_t *dlist, int first, int num_desc, int32 infile, int32 outfile)
+{
+    int     n, last;
+    int32   ret, total = 0;
+    mydd_t *dd;
+
+    for (last = first; last < num_desc; last++) {
+        dd = &dlist[last];
+        if (dd->special != 0 || dd->tag == DFTAG_NULL || dd->tag == DFTAG_VERSION ||
+            dd->tag == DFTAG_LINKED || dd->length <= 0 || dd->length > data_size - total)
+            break;
+        n              = last - first;
+        reqs[n].tag    = dd->tag;
+        reqs[n].ref    = dd->ref;
+        reqs[n].offset = 0;
+        reqs[n].length = dd->length;
+        reqs[n].buf    = data + total;
+        reqs[n].nread  = 0;
+        total += dd->length;
+    }
+
+    if (Hreadv(infile, (int32)(last - first), reqs) == FAIL) {
+        HERROR(DFE_GENAPP);
+        hdferror();
+    }
+
+    for (n = 0; n < last - first; n++) {
+        ret = Hputelement(outfile, reqs[n].tag, reqs[n].ref, (const uint8 *)reqs[n].buf, reqs[n].nread);
+        if (ret == FAIL) {
+            HERROR(DFE_GENAPP);
+            hdferror();
+        }
+    }
+
+    return last - 1;
+}
+
 /*
  ** NAME
  **   usage -- print out usage template
@@ -584,5 +640,8 @@ error(const char *string)
 int
 desc_comp(const void *d1, const void *d2)
 {
-    return ((int)(((const mydd_t *)d1)->offset - ((const mydd_t *)d2)->offset));
+    int32 off1 = ((const mydd_t *)d1)->offset;
+    int32 off2 = ((const mydd_t *)d2)->offset;
+
+    return (off1 > off2) - (off1 < off2);
 }
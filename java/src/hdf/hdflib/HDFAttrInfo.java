@@ -0,0 +1,41 @@
+/****************************************************************************
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF Java Products. The full HDF Java copyright       *
+ * notice, including terms governing use, modification, and redistribution,  *
+ * is contained in the file, COPYING.  COPYING can be found at the root of   *
+ * the source code distribution tree. You can also access it online  at      *
+ * http://www.hdfgroup.org/products/licenses.html.  If you do not have       *
+ * access to the file, you may request a copy from help@hdfgroup.org.        *
+ ****************************************************************************/
+
+package hdf.hdflib;
+package hdf.hdflib;
+
+/**
+ * <p>
+ * This class holds the name, number type, count and values of one attribute;
+ * HDFLibrary.SDreadallattrs returns one for each attribute of an object in a single call.
+ */
+
+public class HDFAttrInfo {
+    /** the name of the attribute */
+    public String name;
+    /** the number type of the values */
+    public int nt;
+    /** the number of values */
+    public int count;
+    /** the values, in the machine's number format; convert them with HDFNativeData */
+    public byte[] values;
+
+    /** */
+    public HDFAttrInfo(String name, int nt, int count, byte[] values)
+    {
+        this.name   = name;
+        this.nt     = nt;
+        this.count  = count;
+        this.values = values;
+    }
+}
@@ -322,6 +322,8 @@ public class HDFConstants {
     public static final int COMP_CODE_INVALID = 6;
     /** */
     public static final int COMP_CODE_JPEG = 7;
+    /** */
+    public static final int COMP_CODE_LZ4 = 14;
 
     // Interlace schemes
     /** Pixel Interlacing */
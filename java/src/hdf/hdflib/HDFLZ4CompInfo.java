@@ -0,0 +1,37 @@
+/****************************************************************************
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF Java Products. The full HDF Java copyright       *
+ * notice, including terms governing use, modification, and redistribution,  *
+ * is contained in the file, COPYING.  COPYING can be found at the root of   *
+ * the source code distribution tree. You can also access it online  at      *
+ * http://www.hdfgroup.org/products/licenses.html.  If you do not have       *
+ * access to the file, you may request a copy from help@hdfgroup.org.        *
+ ****************************************************************************/
+
+package hdf.hdflib;
+
+/**
+ * <p>
+ * This class is a container for the parameters to the HDF LZ4 compression algorithm.
+ * <p>
+ * In this case, the only parameter is the ``acceleration'' of the encoder, 1 being the default speed of
+ * LZ4 and higher values trading compression for speed.
+ */
+
+public class HDFLZ4CompInfo extends HDFNewCompInfo {
+    /** */
+    public int acceleration;
+
+    /** */
+    public HDFLZ4CompInfo() { ctype = HDFConstants.COMP_CODE_LZ4; }
+
+    /** */
+    public HDFLZ4CompInfo(int a)
+    {
+        ctype        = HDFConstants.COMP_CODE_LZ4;
+        acceleration = a;
+    }
+}
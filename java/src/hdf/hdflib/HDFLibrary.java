@@ -14,6 +14,11 @@
 package hdf.hdflib;
 
 import java.io.File;
+import java.nio.ByteBuffer;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.Executor;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
 
 import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
@@ -162,6 +167,14 @@ public class HDFLibrary implements java.io.Serializable {
     private static String s_libraryName;
     private static boolean isLibraryLoaded = false;
 
+    // The SD and GR interfaces keep per-file state that is not locked, so the
+    // asynchronous reads run one after the other on a single daemon thread.
+    private final static ExecutorService asyncExecutor = Executors.newSingleThreadExecutor(r -> {
+        Thread thread = new Thread(r, "hdf-async-io");
+        thread.setDaemon(true);
+        return thread;
+    });
+
     static { loadH4Lib(); }
 
     public static void loadH4Lib()
@@ -565,6 +578,31 @@ public class HDFLibrary implements java.io.Serializable {
     public static native boolean GRreadimage(long grid, int[] start, int[] stride, int[] count, byte[] data)
         throws HDFException;
 
+    /**
+     * @param grid
+     *            <b>IN</b>: the GR interface id, returned by GRselect
+     * @param start
+     *            <b>IN</b>: int[], start
+     * @param stride
+     *            <b>IN</b>: int[], stride
+     * @param count
+     *            <b>IN</b>: int[], count
+     * @param data
+     *            <b>OUT</b>: ByteBuffer, a direct buffer to hold the data
+     *
+     * @exception hdf.hdflib.HDFException
+     *                should be thrown for errors.
+     *
+     *                <p>
+     *                <b>NOTE:</b> the data is read into the memory of the buffer itself, from its start,
+     *                without being copied, so it may be larger than a Java array; use slice() to
+     *                start at its position.
+     *
+     * @return true on success
+     */
+    public static native boolean GRreadimage_direct(long grid, int[] start, int[] stride, int[] count,
+                                                    ByteBuffer data) throws HDFException;
+
     /**
      * @param grid
      *            <b>IN</b>: the GR interface id, returned by GRstart
@@ -584,7 +622,8 @@ public class HDFLibrary implements java.io.Serializable {
      * @return the the data in the Java array.
      *
      *         <p>
-     *         <b>Note:</b> reads the data as bytes and converts to the Java array.
+     *         <b>Note:</b> reads 1-D short, int, float and double arrays directly; other arrays are
+     *         read as bytes and converted to the Java array.
      */
     public static boolean GRreadimage(long grid, int[] start, int[] stride, int[] count, Object theData)
         throws HDFException
@@ -592,13 +631,97 @@ public class HDFLibrary implements java.io.Serializable {
         byte[] data;
         boolean rval;
 
-        HDFArray theArray = new HDFArray(theData);
-        data              = theArray.emptyBytes();
-        rval              = GRreadimage(grid, start, stride, count, data);
-        theData           = theArray.arrayify(data);
+        Class dataClass = theData.getClass();
+        if (!dataClass.isArray()) {
+            throw(new HDFJavaException("GRreadimage: data is not an array"));
+        }
+
+        String cname = dataClass.getName();
+        boolean is1D = (cname.lastIndexOf('[') == cname.indexOf('['));
+        char dname   = cname.charAt(cname.lastIndexOf("[") + 1);
+
+        if (is1D && (dname == 'S')) {
+            rval = GRreadimage_short(grid, start, stride, count, (short[])theData);
+        }
+        else if (is1D && (dname == 'I')) {
+            rval = GRreadimage_int(grid, start, stride, count, (int[])theData);
+        }
+        else if (is1D && (dname == 'F')) {
+            rval = GRreadimage_float(grid, start, stride, count, (float[])theData);
+        }
+        else if (is1D && (dname == 'D')) {
+            rval = GRreadimage_double(grid, start, stride, count, (double[])theData);
+        }
+        else {
+            HDFArray theArray = new HDFArray(theData);
+            data              = theArray.emptyBytes();
+            rval              = GRreadimage(grid, start, stride, count, data);
+            theData           = theArray.arrayify(data);
+        }
         return rval;
     }
 
+    ////////////////////////////////////////////////////////////////////
+    // //
+    // Read the image straight into a Java array of the image's type, //
+    // without going through a byte[] and HDFNativeData. //
+    // //
+    ////////////////////////////////////////////////////////////////////
+
+    public static native boolean GRreadimage_short(long grid, int[] start, int[] stride, int[] count,
+                                                   short[] theData) throws HDFException;
+
+    public static native boolean GRreadimage_int(long grid, int[] start, int[] stride, int[] count,
+                                                 int[] theData) throws HDFException;
+
+    public static native boolean GRreadimage_float(long grid, int[] start, int[] stride, int[] count,
+                                                   float[] theData) throws HDFException;
+
+    public static native boolean GRreadimage_double(long grid, int[] start, int[] stride, int[] count,
+                                                    double[] theData) throws HDFException;
+
+    /**
+     * @param grid
+     *            <b>IN</b>: the GR interface id, returned by GRselect
+     * @param start
+     *            <b>IN</b>: int[2], start
+     * @param stride
+     *            <b>IN</b>: int[2], stride
+     * @param count
+     *            <b>IN</b>: int[2], count
+     * @param theData
+     *            <b>OUT</b>: Object, a Java array of appropriate type, dimensions, and size.
+     *
+     * @return a future completed with the result of GRreadimage once the data is in the Java array,
+     *         or completed exceptionally with the exception GRreadimage threw; the read runs on the
+     *         thread returned by getAsyncExecutor(), see SDreaddata_async.
+     */
+    public static CompletableFuture<Boolean> GRreadimage_async(long grid, int[] start, int[] stride,
+                                                               int[] count, Object theData)
+    {
+        return readAsync(() -> GRreadimage(grid, start, stride, count, theData));
+    }
+
+    /**
+     * @param grid
+     *            <b>IN</b>: the GR interface id, returned by GRselect
+     * @param start
+     *            <b>IN</b>: int[2], start
+     * @param stride
+     *            <b>IN</b>: int[2], stride
+     * @param count
+     *            <b>IN</b>: int[2], count
+     * @param data
+     *            <b>OUT</b>: ByteBuffer, a direct buffer to hold the data
+     *
+     * @return a future completed with the result of GRreadimage_direct, see SDreaddata_async.
+     */
+    public static CompletableFuture<Boolean> GRreadimage_direct_async(long grid, int[] start, int[] stride,
+                                                                      int[] count, ByteBuffer data)
+    {
+        return readAsync(() -> GRreadimage_direct(grid, start, stride, count, data));
+    }
+
     public static native boolean GRendaccess(long riid) throws HDFException;
 
     /*
@@ -906,6 +1029,31 @@ public class HDFLibrary implements java.io.Serializable {
     public static native boolean GRwriteimage(long grid, int[] start, int[] stride, int[] edge, byte[] data)
         throws HDFException;
 
+    /**
+     * @param grid
+     *            <b>IN</b>: the GR interface id, returned by GRselect
+     * @param start
+     *            <b>IN</b>: int[], start
+     * @param stride
+     *            <b>IN</b>: int[], stride
+     * @param edge
+     *            <b>IN</b>: int[], edge
+     * @param data
+     *            <b>IN</b>: ByteBuffer, a direct buffer holding the data
+     *
+     * @exception hdf.hdflib.HDFException
+     *                should be thrown for errors.
+     *
+     *                <p>
+     *                <b>NOTE:</b> the data is written from the memory of the buffer itself, from its start,
+     *                without being copied, so it may be larger than a Java array; use slice() to
+     *                start at its position.
+     *
+     * @return true on success
+     */
+    public static native boolean GRwriteimage_direct(long grid, int[] start, int[] stride, int[] edge,
+                                                     ByteBuffer data) throws HDFException;
+
     /**
      * @param grid
      *            <b>IN</b>: the GR interface id, returned by GRstart
@@ -1105,6 +1253,18 @@ public class HDFLibrary implements java.io.Serializable {
     public static native boolean SDgetinfo(long sdsid, String[] name, int[] dimsizes, int[] args)
         throws HDFException;
 
+    /**
+     * @param sdid
+     *            <b>IN</b>: the SD interface id, returned by SDstart
+     *
+     * @exception hdf.hdflib.HDFException
+     *                should be thrown for errors.
+     *
+     * @return the information of every dataset of the file, in index order, gathered in one call
+     *         instead of an SDselect, SDgetinfo and SDendaccess per dataset
+     */
+    public static native HDFSDSInfo[] SDgetinfoall(long sdid) throws HDFException;
+
     /**
      * @param sdsid
      *            <b>IN</b>: the SD interface id, returned by SDselect
@@ -1141,6 +1301,31 @@ public class HDFLibrary implements java.io.Serializable {
     public static native boolean SDreaddata(long sdsid, int[] start, int[] stride, int[] count, byte[] data)
         throws HDFException;
 
+    /**
+     * @param sdsid
+     *            <b>IN</b>: the SD interface id, returned by SDselect
+     * @param start
+     *            <b>IN</b>: int[], start
+     * @param stride
+     *            <b>IN</b>: int[], stride
+     * @param count
+     *            <b>IN</b>: int[], count
+     * @param data
+     *            <b>OUT</b>: ByteBuffer, a direct buffer to hold the data
+     *
+     * @exception hdf.hdflib.HDFException
+     *                should be thrown for errors.
+     *
+     *                <p>
+     *                <b>NOTE:</b> the data is read into the memory of the buffer itself, from its start,
+     *                without being copied, so it may be larger than a Java array; use slice() to
+     *                start at its position.
+     *
+     * @return true on success
+     */
+    public static native boolean SDreaddata_direct(long sdsid, int[] start, int[] stride, int[] count,
+                                                   ByteBuffer data) throws HDFException;
+
     /**
      * @param sdsid
      *            <b>IN</b>: the SD interface id, returned by SDselect
@@ -1230,6 +1415,85 @@ public class HDFLibrary implements java.io.Serializable {
     public static native boolean SDreaddata_double(long sdsid, int[] start, int[] stride, int[] count,
                                                    double[] theData) throws HDFException;
 
+    ////////////////////////////////////////////////////////////////////
+    // //
+    // Asynchronous reads: the read runs on the thread of the //
+    // library and the calling thread gets a CompletableFuture. //
+    // //
+    ////////////////////////////////////////////////////////////////////
+
+    /**
+     * Returns the executor the asynchronous reads run on. Other calls made while asynchronous reads
+     * are outstanding should be submitted to it too, for example with
+     * CompletableFuture.supplyAsync(), so that they do not run at the same time as the reads.
+     *
+     * @return the executor of the asynchronous reads
+     */
+    public static Executor getAsyncExecutor() { return asyncExecutor; }
+
+    private interface HDFRead {
+        boolean read() throws HDFException;
+    }
+
+    private static CompletableFuture<Boolean> readAsync(HDFRead request)
+    {
+        CompletableFuture<Boolean> future = new CompletableFuture<>();
+        asyncExecutor.execute(() -> {
+            try {
+                future.complete(request.read());
+            }
+            catch (Throwable err) {
+                future.completeExceptionally(err);
+            }
+        });
+        return future;
+    }
+
+    /**
+     * @param sdsid
+     *            <b>IN</b>: the SD interface id, returned by SDselect
+     * @param start
+     *            <b>IN</b>: int[], start
+     * @param stride
+     *            <b>IN</b>: int[], stride
+     * @param count
+     *            <b>IN</b>: int[], count
+     * @param theData
+     *            <b>OUT</b>: Object, a Java array of appropriate type, dimensions, and size.
+     *
+     * @return a future completed with the result of SDreaddata once the data is in the Java array,
+     *         or completed exceptionally with the exception SDreaddata threw.
+     *
+     *         <p>
+     *         <b>NOTE:</b> the arrays must not be touched until the future is complete. The read runs
+     *         on the thread returned by getAsyncExecutor(), so the calling thread does not block.
+     */
+    public static CompletableFuture<Boolean> SDreaddata_async(long sdsid, int[] start, int[] stride,
+                                                              int[] count, Object theData)
+    {
+        return readAsync(() -> SDreaddata(sdsid, start, stride, count, theData));
+    }
+
+    /**
+     * @param sdsid
+     *            <b>IN</b>: the SD interface id, returned by SDselect
+     * @param start
+     *            <b>IN</b>: int[], start
+     * @param stride
+     *            <b>IN</b>: int[], stride
+     * @param count
+     *            <b>IN</b>: int[], count
+     * @param data
+     *            <b>OUT</b>: ByteBuffer, a direct buffer to hold the data
+     *
+     * @return a future completed with the result of SDreaddata_direct, see SDreaddata_async.
+     */
+    public static CompletableFuture<Boolean> SDreaddata_direct_async(long sdsid, int[] start, int[] stride,
+                                                                     int[] count, ByteBuffer data)
+    {
+        return readAsync(() -> SDreaddata_direct(sdsid, start, stride, count, data));
+    }
+
     public static native boolean SDendaccess(long sdsid) throws HDFException;
 
     public static native long SDgetdimid(long sdsid, int index) throws HDFException;
@@ -1290,6 +1554,18 @@ public class HDFLibrary implements java.io.Serializable {
      */
     public static native boolean SDreadattr(long id, int index, byte[] data) throws HDFException;
 
+    /**
+     * @param id
+     *            <b>IN</b>: id of a file, SDS, or dimension
+     *
+     * @exception hdf.hdflib.HDFException
+     *                should be thrown for errors.
+     *
+     * @return the name, number type, count and values of every attribute of the object, in index
+     *         order, read in one call instead of an SDattrinfo and SDreadattr per attribute
+     */
+    public static native HDFAttrInfo[] SDreadallattrs(long id) throws HDFException;
+
     /**
      * @param id
      *            <b>IN</b>: id of a file, SDS, or dimension
@@ -1876,6 +2152,31 @@ public class HDFLibrary implements java.io.Serializable {
     public static native boolean SDwritedata(long sdsid, int[] start, int[] stride, int[] count, byte[] data)
         throws HDFException;
 
+    /**
+     * @param sdsid
+     *            <b>IN</b>: the SD interface id, returned by SDselect
+     * @param start
+     *            <b>IN</b>: int[], start
+     * @param stride
+     *            <b>IN</b>: int[], stride
+     * @param count
+     *            <b>IN</b>: int[], count
+     * @param data
+     *            <b>IN</b>: ByteBuffer, a direct buffer holding the data
+     *
+     * @exception hdf.hdflib.HDFException
+     *                should be thrown for errors.
+     *
+     *                <p>
+     *                <b>NOTE:</b> the data is written from the memory of the buffer itself, from its start,
+     *                without being copied, so it may be larger than a Java array; use slice() to
+     *                start at its position.
+     *
+     * @return true on success
+     */
+    public static native boolean SDwritedata_direct(long sdsid, int[] start, int[] stride, int[] count,
+                                                    ByteBuffer data) throws HDFException;
+
     /**
      * @param sdsid
      *            <b>IN</b>: the SD interface id, returned by SDselect
@@ -2039,6 +2340,26 @@ public class HDFLibrary implements java.io.Serializable {
      */
     public static native boolean SDreadchunk(long sdsid, int[] origin, byte[] theData) throws HDFException;
 
+    /**
+     * @param sdsid
+     *            <b>IN</b>: the SD interface id, returned by SDselect
+     * @param origin
+     *            <b>IN</b>: int[], origin
+     * @param data
+     *            <b>OUT</b>: ByteBuffer, a direct buffer to hold the chunk
+     *
+     * @exception hdf.hdflib.HDFException
+     *                should be thrown for errors.
+     *
+     *                <p>
+     *                <b>NOTE:</b> the chunk is read into the memory of the buffer itself, from its start,
+     *                without being copied; use slice() to start at its position.
+     *
+     * @return true on success
+     */
+    public static native boolean SDreadchunk_direct(long sdsid, int[] origin, ByteBuffer data)
+        throws HDFException;
+
     /**
      * @param sdsid
      *            <b>IN</b>: the SD interface id, returned by SDselect
@@ -2088,6 +2409,26 @@ public class HDFLibrary implements java.io.Serializable {
      */
     public static native boolean SDwritechunk(long sdsid, int[] origin, byte[] data) throws HDFException;
 
+    /**
+     * @param sdsid
+     *            <b>IN</b>: the SD interface id, returned by SDselect
+     * @param origin
+     *            <b>IN</b>: int[], origin
+     * @param data
+     *            <b>IN</b>: ByteBuffer, a direct buffer holding the chunk
+     *
+     * @exception hdf.hdflib.HDFException
+     *                should be thrown for errors.
+     *
+     *                <p>
+     *                <b>NOTE:</b> the chunk is written from the memory of the buffer itself, from its start,
+     *                without being copied; use slice() to start at its position.
+     *
+     * @return true on success
+     */
+    public static native boolean SDwritechunk_direct(long sdsid, int[] origin, ByteBuffer data)
+        throws HDFException;
+
     /**
      * @param sdsid
      *            <b>IN</b>: the SD interface id, returned by SDselect
@@ -2697,6 +3038,18 @@ public class HDFLibrary implements java.io.Serializable {
      */
     public static native boolean VSinquire(long vdata_id, int[] iargs) throws HDFException;
 
+    /**
+     * @param fid
+     *            <b>IN</b>: the file id, returned by Hopen
+     *
+     * @exception hdf.hdflib.HDFException
+     *                should be thrown for errors.
+     *
+     * @return the information of every vdata of the file, in the order VSgetid returns them,
+     *         gathered in one call instead of a VSattach, VSinquire and VSdetach per vdata
+     */
+    public static native HDFVdataInfo[] VSgetinfoall(long fid) throws HDFException;
+
     /**
      * @param fid
      *            <b>IN</b>, File identifier returned by Hopen
@@ -2736,6 +3089,28 @@ public class HDFLibrary implements java.io.Serializable {
     public static native int VSread(long vdata_id, byte[] databuf, int nrecord, int interlace)
         throws HDFException;
 
+    /**
+     * @param vdata_id
+     *            <b>IN</b>: the Vdata id
+     * @param databuf
+     *            <b>OUT</b>: ByteBuffer, a direct buffer to hold the records
+     * @param nrecord
+     *            <b>IN</b>: int, number of records
+     * @param interlace
+     *            <b>IN</b>: int, interlace
+     *
+     * @exception hdf.hdflib.HDFException
+     *                should be thrown for errors in the HDF library call.
+     *
+     *                <p>
+     *                <b>NOTE:</b> the records are read into the memory of the buffer itself, from its
+     *                start, without being copied; use slice() to start at its position.
+     *
+     * @return the number of elements read (0 or a +ve integer)
+     */
+    public static native int VSread_direct(long vdata_id, ByteBuffer databuf, int nrecord, int interlace)
+        throws HDFException;
+
     /**
      * @param vdata_id
      *            <b>IN</b>: the Vdata id
@@ -2768,6 +3143,60 @@ public class HDFLibrary implements java.io.Serializable {
         return rval;
     }
 
+    /**
+     * @param vdata_id
+     *            <b>IN</b>: the Vdata id
+     * @param fields
+     *            <b>IN</b>: String[], the names of the fields to read
+     * @param start
+     *            <b>IN</b>: int, the first record to read
+     * @param nrecord
+     *            <b>IN</b>: int, number of records
+     * @param columns
+     *            <b>OUT</b>: Object[], one Java array per field, of the type of the field: byte[],
+     *            short[], int[] or long[] for 8, 16, 32 or 64-bit integers and characters, float[] or
+     *            double[] for floating point numbers, with at least nrecord times the order of the
+     *            field elements.
+     *
+     * @exception hdf.hdflib.HDFException
+     *                should be thrown for errors in the HDF library call.
+     *
+     *                <p>
+     *                <b>NOTE:</b> sets the fields with VSsetfields, seeks to the start record and reads
+     *                each field into its array in one native call, with VSreadcolumns, without going
+     *                through a byte[] and HDFNativeData. Unsigned values keep their bits.
+     *
+     * @return the number of records read (0 or a +ve integer)
+     */
+    public static native int VSreadcolumns(long vdata_id, String[] fields, int start, int nrecord,
+                                           Object[] columns) throws HDFException;
+
+    /**
+     * @param vdata_id
+     *            <b>IN</b>: the Vdata id
+     * @param fields
+     *            <b>IN</b>: String[], the names of the fields to read
+     * @param start
+     *            <b>IN</b>: int, the first record to read
+     * @param nrecord
+     *            <b>IN</b>: int, number of records
+     * @param columns
+     *            <b>OUT</b>: ByteBuffer[], one direct buffer per field, large enough for nrecord
+     *            records of the field in the native format
+     *
+     * @exception hdf.hdflib.HDFException
+     *                should be thrown for errors in the HDF library call.
+     *
+     *                <p>
+     *                <b>NOTE:</b> the values are read into the memory of the buffers themselves, from
+     *                their start, see VSreadcolumns; set the native byte order on the buffers to read
+     *                them.
+     *
+     * @return the number of records read (0 or a +ve integer)
+     */
+    public static native int VSreadcolumns_direct(long vdata_id, String[] fields, int start, int nrecord,
+                                                  ByteBuffer[] columns) throws HDFException;
+
     public static native int VSseek(long vdata_id, int record) throws HDFException;
 
     public static native boolean VSsetfields(long vdata_id, String fields) throws HDFException;
@@ -2810,6 +3239,28 @@ public class HDFLibrary implements java.io.Serializable {
     public static native int VSwrite(long vdata_id, byte[] databuf, int n_records, int interlace)
         throws HDFException;
 
+    /**
+     * @param vdata_id
+     *            <b>IN</b>: the Vdata id
+     * @param databuf
+     *            <b>IN</b>: ByteBuffer, a direct buffer holding the records
+     * @param n_records
+     *            <b>IN</b>: int, number of records
+     * @param interlace
+     *            <b>IN</b>: int, interlace
+     *
+     * @exception hdf.hdflib.HDFException
+     *                should be thrown for errors in the HDF library call.
+     *
+     *                <p>
+     *                <b>NOTE:</b> the records are written from the memory of the buffer itself, from its
+     *                start, without being copied; use slice() to start at its position.
+     *
+     * @return the number of elements written (0 or a +ve integer)
+     */
+    public static native int VSwrite_direct(long vdata_id, ByteBuffer databuf, int n_records, int interlace)
+        throws HDFException;
+
     /**
      * @param vdata_id
      *            <b>IN</b>: the Vdata id
@@ -0,0 +1,50 @@
+/****************************************************************************
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF Java Products. The full HDF Java copyright       *
+ * notice, including terms governing use, modification, and redistribution,  *
+ * is contained in the file, COPYING.  COPYING can be found at the root of   *
+ * the source code distribution tree. You can also access it online  at      *
+ * http://www.hdfgroup.org/products/licenses.html.  If you do not have       *
+ * access to the file, you may request a copy from help@hdfgroup.org.        *
+ ****************************************************************************/
+
+package hdf.hdflib;
+package hdf.hdflib;
+
+/**
+ * <p>
+ * This class holds what SDgetinfo, SDidtoref and the dataset's index tell of one dataset of a file;
+ * HDFLibrary.SDgetinfoall returns one for each dataset of the file in a single call.
+ */
+
+public class HDFSDSInfo {
+    /** the index of the dataset, as passed to SDselect */
+    public int index;
+    /** the reference number of the dataset */
+    public int ref;
+    /** the name of the dataset */
+    public String name;
+    /** the rank of the dataset */
+    public int rank;
+    /** the dimension sizes, with the current size of an unlimited dimension */
+    public int[] dimsizes;
+    /** the number type of the data */
+    public int nt;
+    /** the number of attributes of the dataset */
+    public int nattrs;
+
+    /** */
+    public HDFSDSInfo(int index, int ref, String name, int rank, int[] dimsizes, int nt, int nattrs)
+    {
+        this.index    = index;
+        this.ref      = ref;
+        this.name     = name;
+        this.rank     = rank;
+        this.dimsizes = dimsizes;
+        this.nt       = nt;
+        this.nattrs   = nattrs;
+    }
+}
@@ -0,0 +1,54 @@
+/****************************************************************************
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF Java Products. The full HDF Java copyright       *
+ * notice, including terms governing use, modification, and redistribution,  *
+ * is contained in the file, COPYING.  COPYING can be found at the root of   *
+ * the source code distribution tree. You can also access it online  at      *
+ * http://www.hdfgroup.org/products/licenses.html.  If you do not have       *
+ * access to the file, you may request a copy from help@hdfgroup.org.        *
+ ****************************************************************************/
+
+package hdf.hdflib;
+package hdf.hdflib;
+
+/**
+ * <p>
+ * This class holds what VSinquire, VSgetclass and VSnattrs tell of one vdata of a file;
+ * HDFLibrary.VSgetinfoall returns one for each vdata of the file in a single call.
+ */
+
+public class HDFVdataInfo {
+    /** the reference number of the vdata */
+    public int ref;
+    /** the name of the vdata */
+    public String name;
+    /** the class of the vdata */
+    public String vclass;
+    /** the number of records */
+    public int nrecords;
+    /** the interlace mode */
+    public int interlace;
+    /** the names of the fields, separated by commas */
+    public String fields;
+    /** the size of a record, in bytes */
+    public int vsize;
+    /** the number of attributes of the vdata and its fields */
+    public int nattrs;
+
+    /** */
+    public HDFVdataInfo(int ref, String name, String vclass, int nrecords, int interlace, String fields,
+                        int vsize, int nattrs)
+    {
+        this.ref       = ref;
+        this.name      = name;
+        this.vclass    = vclass;
+        this.nrecords  = nrecords;
+        this.interlace = interlace;
+        this.fields    = fields;
+        this.vsize     = vsize;
+        this.nattrs    = nattrs;
+    }
+}
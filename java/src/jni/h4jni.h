@@ -235,6 +235,15 @@
         (*envptr)->ReleasePrimitiveArrayCritical(envptr, pinnedArray, bufToRelease, freeMode);               \
     } while (0)
 
+/* Macro for direct buffer access; the buffer is used in place, not pinned */
+#define GET_DIRECT_BUFFER(envptr, buffer, outBuf, failErrMsg)                                                \
+    do {                                                                                                     \
+        if (NULL == (outBuf = (jbyte *)(*envptr)->GetDirectBufferAddress(envptr, buffer))) {                 \
+            CHECK_JNI_EXCEPTION(envptr, JNI_TRUE);                                                           \
+            H4_BAD_ARGUMENT_ERROR(envptr, failErrMsg);                                                       \
+        }                                                                                                    \
+    } while (0)
+
 /* Macros for string access */
 #define PIN_JAVA_STRING(envptr, stringToPin, outString, isCopy, failErrMsg)                                  \
     do {                                                                                                     \
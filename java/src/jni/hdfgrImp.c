@@ -280,6 +280,257 @@ done:
     return JNI_TRUE;
 }
 
+JNIEXPORT jboolean JNICALL
+Java_hdf_hdflib_HDFLibrary_GRreadimage_1direct(JNIEnv *env, jclass clss, jlong ri_id, jintArray start,
+                                               jintArray stride, jintArray edge, jobject data)
+{
+    intn     rval = FAIL;
+    jbyte   *arr  = NULL;
+    jint    *strt = NULL;
+    jint    *strd = NULL;
+    jint    *edg  = NULL;
+    jboolean isCopy;
+
+    UNUSED(clss);
+
+    if (data == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "GRreadimage_direct:  data is NULL");
+    if (start == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "GRreadimage_direct:  start is NULL");
+    if (ENVPTR->GetArrayLength(ENVONLY, start) < 2)
+        H4_BAD_ARGUMENT_ERROR(ENVONLY, "GRreadimage_direct:  start input array < order 2");
+    if (edge == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "GRreadimage_direct:  edge is NULL");
+    if (ENVPTR->GetArrayLength(ENVONLY, edge) < 2)
+        H4_BAD_ARGUMENT_ERROR(ENVONLY, "GRreadimage_direct:  edge input array < order 2");
+
+    GET_DIRECT_BUFFER(ENVONLY, data, arr, "GRreadimage_direct:  data is not a direct buffer");
+    PIN_INT_ARRAY(ENVONLY, start, strt, &isCopy, "GRreadimage_direct:  start not pinned");
+    PIN_INT_ARRAY(ENVONLY, edge, edg, &isCopy, "GRreadimage_direct:  edge not pinned");
+
+    if (stride == NULL)
+        strd = NULL;
+    else
+        PIN_INT_ARRAY(ENVONLY, stride, strd, &isCopy, "GRreadimage_direct:  stride not pinned");
+
+    if ((rval = GRreadimage((int32)ri_id, (int32 *)strt, (int32 *)strd, (int32 *)edg, (void *)arr)) == FAIL)
+        H4_LIBRARY_ERROR(ENVONLY);
+
+done:
+    if (strd)
+        UNPIN_INT_ARRAY(ENVONLY, stride, strd, (rval == FAIL) ? JNI_ABORT : 0);
+    if (edg)
+        UNPIN_INT_ARRAY(ENVONLY, edge, edg, (rval == FAIL) ? JNI_ABORT : 0);
+    if (strt)
+        UNPIN_INT_ARRAY(ENVONLY, start, strt, (rval == FAIL) ? JNI_ABORT : 0);
+
+    return JNI_TRUE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_hdf_hdflib_HDFLibrary_GRreadimage_1short(JNIEnv *env, jclass clss, jlong ri_id, jintArray start,
+                                              jintArray stride, jintArray edge, jshortArray data)
+{
+    intn     rval = FAIL;
+    jshort  *arr  = NULL;
+    jint    *strt = NULL;
+    jint    *strd = NULL;
+    jint    *edg  = NULL;
+    jboolean isCopy;
+
+    UNUSED(clss);
+
+    if (data == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "GRreadimage:  data is NULL");
+    if (start == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "GRreadimage:  start is NULL");
+    if (ENVPTR->GetArrayLength(ENVONLY, start) < 2)
+        H4_BAD_ARGUMENT_ERROR(ENVONLY, "GRreadimage:  start input array < order 2");
+    if (edge == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "GRreadimage:  edge is NULL");
+    if (ENVPTR->GetArrayLength(ENVONLY, edge) < 2)
+        H4_BAD_ARGUMENT_ERROR(ENVONLY, "GRreadimage:  edge input array < order 2");
+
+    PIN_INT_ARRAY(ENVONLY, start, strt, &isCopy, "GRreadimage:  start not pinned");
+    PIN_INT_ARRAY(ENVONLY, edge, edg, &isCopy, "GRreadimage:  edge not pinned");
+
+    if (stride == NULL)
+        strd = NULL;
+    else
+        PIN_INT_ARRAY(ENVONLY, stride, strd, &isCopy, "GRreadimage:  stride not pinned");
+
+    /* Read straight into the array; no JNI call may be made while it is pinned */
+    PIN_SHORT_ARRAY_CRITICAL(ENVONLY, data, arr, &isCopy, "GRreadimage:  data not pinned");
+    rval = GRreadimage((int32)ri_id, (int32 *)strt, (int32 *)strd, (int32 *)edg, (void *)arr);
+    UNPIN_ARRAY_CRITICAL(ENVONLY, data, arr, (rval == FAIL) ? JNI_ABORT : 0);
+
+    if (rval == FAIL)
+        H4_LIBRARY_ERROR(ENVONLY);
+
+done:
+    if (strd)
+        UNPIN_INT_ARRAY(ENVONLY, stride, strd, (rval == FAIL) ? JNI_ABORT : 0);
+    if (edg)
+        UNPIN_INT_ARRAY(ENVONLY, edge, edg, (rval == FAIL) ? JNI_ABORT : 0);
+    if (strt)
+        UNPIN_INT_ARRAY(ENVONLY, start, strt, (rval == FAIL) ? JNI_ABORT : 0);
+
+    return JNI_TRUE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_hdf_hdflib_HDFLibrary_GRreadimage_1int(JNIEnv *env, jclass clss, jlong ri_id, jintArray start,
+                                            jintArray stride, jintArray edge, jintArray data)
+{
+    intn     rval = FAIL;
+    jint    *arr  = NULL;
+    jint    *strt = NULL;
+    jint    *strd = NULL;
+    jint    *edg  = NULL;
+    jboolean isCopy;
+
+    UNUSED(clss);
+
+    if (data == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "GRreadimage:  data is NULL");
+    if (start == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "GRreadimage:  start is NULL");
+    if (ENVPTR->GetArrayLength(ENVONLY, start) < 2)
+        H4_BAD_ARGUMENT_ERROR(ENVONLY, "GRreadimage:  start input array < order 2");
+    if (edge == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "GRreadimage:  edge is NULL");
+    if (ENVPTR->GetArrayLength(ENVONLY, edge) < 2)
+        H4_BAD_ARGUMENT_ERROR(ENVONLY, "GRreadimage:  edge input array < order 2");
+
+    PIN_INT_ARRAY(ENVONLY, start, strt, &isCopy, "GRreadimage:  start not pinned");
+    PIN_INT_ARRAY(ENVONLY, edge, edg, &isCopy, "GRreadimage:  edge not pinned");
+
+    if (stride == NULL)
+        strd = NULL;
+    else
+        PIN_INT_ARRAY(ENVONLY, stride, strd, &isCopy, "GRreadimage:  stride not pinned");
+
+    /* Read straight into the array; no JNI call may be made while it is pinned */
+    PIN_INT_ARRAY_CRITICAL(ENVONLY, data, arr, &isCopy, "GRreadimage:  data not pinned");
+    rval = GRreadimage((int32)ri_id, (int32 *)strt, (int32 *)strd, (int32 *)edg, (void *)arr);
+    UNPIN_ARRAY_CRITICAL(ENVONLY, data, arr, (rval == FAIL) ? JNI_ABORT : 0);
+
+    if (rval == FAIL)
+        H4_LIBRARY_ERROR(ENVONLY);
+
+done:
+    if (strd)
+        UNPIN_INT_ARRAY(ENVONLY, stride, strd, (rval == FAIL) ? JNI_ABORT : 0);
+    if (edg)
+        UNPIN_INT_ARRAY(ENVONLY, edge, edg, (rval == FAIL) ? JNI_ABORT : 0);
+    if (strt)
+        UNPIN_INT_ARRAY(ENVONLY, start, strt, (rval == FAIL) ? JNI_ABORT : 0);
+
+    return JNI_TRUE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_hdf_hdflib_HDFLibrary_GRreadimage_1float(JNIEnv *env, jclass clss, jlong ri_id, jintArray start,
+                                              jintArray stride, jintArray edge, jfloatArray data)
+{
+    intn     rval = FAIL;
+    jfloat  *arr  = NULL;
+    jint    *strt = NULL;
+    jint    *strd = NULL;
+    jint    *edg  = NULL;
+    jboolean isCopy;
+
+    UNUSED(clss);
+
+    if (data == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "GRreadimage:  data is NULL");
+    if (start == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "GRreadimage:  start is NULL");
+    if (ENVPTR->GetArrayLength(ENVONLY, start) < 2)
+        H4_BAD_ARGUMENT_ERROR(ENVONLY, "GRreadimage:  start input array < order 2");
+    if (edge == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "GRreadimage:  edge is NULL");
+    if (ENVPTR->GetArrayLength(ENVONLY, edge) < 2)
+        H4_BAD_ARGUMENT_ERROR(ENVONLY, "GRreadimage:  edge input array < order 2");
+
+    PIN_INT_ARRAY(ENVONLY, start, strt, &isCopy, "GRreadimage:  start not pinned");
+    PIN_INT_ARRAY(ENVONLY, edge, edg, &isCopy, "GRreadimage:  edge not pinned");
+
+    if (stride == NULL)
+        strd = NULL;
+    else
+        PIN_INT_ARRAY(ENVONLY, stride, strd, &isCopy, "GRreadimage:  stride not pinned");
+
+    /* Read straight into the array; no JNI call may be made while it is pinned */
+    PIN_FLOAT_ARRAY_CRITICAL(ENVONLY, data, arr, &isCopy, "GRreadimage:  data not pinned");
+    rval = GRreadimage((int32)ri_id, (int32 *)strt, (int32 *)strd, (int32 *)edg, (void *)arr);
+    UNPIN_ARRAY_CRITICAL(ENVONLY, data, arr, (rval == FAIL) ? JNI_ABORT : 0);
+
+    if (rval == FAIL)
+        H4_LIBRARY_ERROR(ENVONLY);
+
+done:
+    if (strd)
+        UNPIN_INT_ARRAY(ENVONLY, stride, strd, (rval == FAIL) ? JNI_ABORT : 0);
+    if (edg)
+        UNPIN_INT_ARRAY(ENVONLY, edge, edg, (rval == FAIL) ? JNI_ABORT : 0);
+    if (strt)
+        UNPIN_INT_ARRAY(ENVONLY, start, strt, (rval == FAIL) ? JNI_ABORT : 0);
+
+    return JNI_TRUE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_hdf_hdflib_HDFLibrary_GRreadimage_1double(JNIEnv *env, jclass clss, jlong ri_id, jintArray start,
+                                               jintArray stride, jintArray edge, jdoubleArray data)
+{
+    intn     rval = FAIL;
+    jdouble *arr  = NULL;
+    jint    *strt = NULL;
+    jint    *strd = NULL;
+    jint    *edg  = NULL;
+    jboolean isCopy;
+
+    UNUSED(clss);
+
+    if (data == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "GRreadimage:  data is NULL");
+    if (start == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "GRreadimage:  start is NULL");
+    if (ENVPTR->GetArrayLength(ENVONLY, start) < 2)
+        H4_BAD_ARGUMENT_ERROR(ENVONLY, "GRreadimage:  start input array < order 2");
+    if (edge == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "GRreadimage:  edge is NULL");
+    if (ENVPTR->GetArrayLength(ENVONLY, edge) < 2)
+        H4_BAD_ARGUMENT_ERROR(ENVONLY, "GRreadimage:  edge input array < order 2");
+
+    PIN_INT_ARRAY(ENVONLY, start, strt, &isCopy, "GRreadimage:  start not pinned");
+    PIN_INT_ARRAY(ENVONLY, edge, edg, &isCopy, "GRreadimage:  edge not pinned");
+
+    if (stride == NULL)
+        strd = NULL;
+    else
+        PIN_INT_ARRAY(ENVONLY, stride, strd, &isCopy, "GRreadimage:  stride not pinned");
+
+    /* Read straight into the array; no JNI call may be made while it is pinned */
+    PIN_DOUBLE_ARRAY_CRITICAL(ENVONLY, data, arr, &isCopy, "GRreadimage:  data not pinned");
+    rval = GRreadimage((int32)ri_id, (int32 *)strt, (int32 *)strd, (int32 *)edg, (void *)arr);
+    UNPIN_ARRAY_CRITICAL(ENVONLY, data, arr, (rval == FAIL) ? JNI_ABORT : 0);
+
+    if (rval == FAIL)
+        H4_LIBRARY_ERROR(ENVONLY);
+
+done:
+    if (strd)
+        UNPIN_INT_ARRAY(ENVONLY, stride, strd, (rval == FAIL) ? JNI_ABORT : 0);
+    if (edg)
+        UNPIN_INT_ARRAY(ENVONLY, edge, edg, (rval == FAIL) ? JNI_ABORT : 0);
+    if (strt)
+        UNPIN_INT_ARRAY(ENVONLY, start, strt, (rval == FAIL) ? JNI_ABORT : 0);
+
+    return JNI_TRUE;
+}
+
 JNIEXPORT jshort JNICALL
 Java_hdf_hdflib_HDFLibrary_GRidtoref(JNIEnv *env, jclass clss, jlong gr_id)
 {
@@ -799,6 +1050,53 @@ done:
     return JNI_TRUE;
 }
 
+JNIEXPORT jboolean JNICALL
+Java_hdf_hdflib_HDFLibrary_GRwriteimage_1direct(JNIEnv *env, jclass clss, jlong ri_id, jintArray start,
+                                                jintArray stride, jintArray edge, jobject data)
+{
+    intn     rval = FAIL;
+    jbyte   *arr  = NULL;
+    jint    *strt = NULL;
+    jint    *strd = NULL;
+    jint    *edg  = NULL;
+    jboolean isCopy;
+
+    UNUSED(clss);
+
+    if (data == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "GRwriteimage_direct:  data is NULL");
+    if (start == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "GRwriteimage_direct:  start is NULL");
+    if (ENVPTR->GetArrayLength(ENVONLY, start) < 2)
+        H4_BAD_ARGUMENT_ERROR(ENVONLY, "GRwriteimage_direct:  start input array < order 2");
+    if (edge == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "GRwriteimage_direct:  edge is NULL");
+    if (ENVPTR->GetArrayLength(ENVONLY, edge) < 2)
+        H4_BAD_ARGUMENT_ERROR(ENVONLY, "GRwriteimage_direct:  edge input array < order 2");
+
+    GET_DIRECT_BUFFER(ENVONLY, data, arr, "GRwriteimage_direct:  data is not a direct buffer");
+    PIN_INT_ARRAY(ENVONLY, start, strt, &isCopy, "GRwriteimage_direct:  start not pinned");
+    PIN_INT_ARRAY(ENVONLY, edge, edg, &isCopy, "GRwriteimage_direct:  edge not pinned");
+
+    if (stride == NULL)
+        strd = NULL;
+    else
+        PIN_INT_ARRAY(ENVONLY, stride, strd, &isCopy, "GRwriteimage_direct:  stride not pinned");
+
+    if ((rval = GRwriteimage((int32)ri_id, (int32 *)strt, (int32 *)strd, (int32 *)edg, (void *)arr)) == FAIL)
+        H4_LIBRARY_ERROR(ENVONLY);
+
+done:
+    if (strd)
+        UNPIN_INT_ARRAY(ENVONLY, stride, strd, (rval == FAIL) ? JNI_ABORT : 0);
+    if (edg)
+        UNPIN_INT_ARRAY(ENVONLY, edge, edg, (rval == FAIL) ? JNI_ABORT : 0);
+    if (strt)
+        UNPIN_INT_ARRAY(ENVONLY, start, strt, (rval == FAIL) ? JNI_ABORT : 0);
+
+    return JNI_TRUE;
+}
+
 JNIEXPORT jboolean JNICALL
 Java_hdf_hdflib_HDFLibrary_GRwritelut(JNIEnv *env, jclass clss, jlong pal_id, jint ncomp, jint data_type,
                                       jint interlace, jint num_entries, jbyteArray pal_data)
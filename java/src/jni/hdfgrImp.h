@@ -56,6 +56,30 @@ JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_GRreadimage(JNIEnv *env, j
                                                                   jintArray start, jintArray stride,
                                                                   jintArray edge, jbyteArray data);
 
+JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_GRreadimage_1direct(JNIEnv *env, jclass clss,
+                                                                          jlong ri_id, jintArray start,
+                                                                          jintArray stride, jintArray edge,
+                                                                          jobject data);
+
+JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_GRreadimage_1short(JNIEnv *env, jclass clss,
+                                                                         jlong ri_id, jintArray start,
+                                                                         jintArray stride, jintArray edge,
+                                                                         jshortArray data);
+
+JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_GRreadimage_1int(JNIEnv *env, jclass clss, jlong ri_id,
+                                                                       jintArray start, jintArray stride,
+                                                                       jintArray edge, jintArray data);
+
+JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_GRreadimage_1float(JNIEnv *env, jclass clss,
+                                                                         jlong ri_id, jintArray start,
+                                                                         jintArray stride, jintArray edge,
+                                                                         jfloatArray data);
+
+JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_GRreadimage_1double(JNIEnv *env, jclass clss,
+                                                                          jlong ri_id, jintArray start,
+                                                                          jintArray stride, jintArray edge,
+                                                                          jdoubleArray data);
+
 JNIEXPORT jshort JNICALL Java_hdf_hdflib_HDFLibrary_GRidtoref(JNIEnv *env, jclass clss, jlong gr_id);
 
 JNIEXPORT jint JNICALL Java_hdf_hdflib_HDFLibrary_GRreftoindex(JNIEnv *env, jclass clss, jlong gr_id,
@@ -122,6 +146,11 @@ JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_GRwriteimage(JNIEnv *env,
                                                                    jintArray start, jintArray stride,
                                                                    jintArray edge, jbyteArray data);
 
+JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_GRwriteimage_1direct(JNIEnv *env, jclass clss,
+                                                                           jlong ri_id, jintArray start,
+                                                                           jintArray stride, jintArray edge,
+                                                                           jobject data);
+
 JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_GRwritelut(JNIEnv *env, jclass clss, jlong pal_id,
                                                                  jint ncomp, jint data_type, jint interlace,
                                                                  jint num_entries, jbyteArray pal_data);
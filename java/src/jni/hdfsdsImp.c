@@ -193,6 +193,95 @@ done:
     return JNI_FALSE;
 }
 
+/*
+ * One call for the information of all the datasets of the file, instead of
+ * an SDselect(), SDgetinfo(), SDidtoref() and SDendaccess() call each.
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_hdf_hdflib_HDFLibrary_SDgetinfoall(JNIEnv *env, jclass clss, jlong sdid)
+{
+    int32        id     = (int32)sdid;
+    int32        sdsid  = FAIL;
+    int32        ndsets = 0;
+    int32        nattrs, rank, nt, ii;
+    int32        dims[H4_MAX_VAR_DIMS];
+    uint16       namelen;
+    char        *cname    = NULL;
+    size_t       cnamelen = 0;
+    jclass       cls;
+    jmethodID    constructor;
+    jobjectArray rarray = NULL;
+    jobject      info;
+    jstring      rstring;
+    jintArray    rdims;
+    jvalue       args[7];
+
+    UNUSED(clss);
+
+    if (SDfileinfo(id, &ndsets, &nattrs) == FAIL)
+        H4_LIBRARY_ERROR(ENVONLY);
+
+    if (NULL == (cls = ENVPTR->FindClass(ENVONLY, "hdf/hdflib/HDFSDSInfo"))) {
+        CHECK_JNI_EXCEPTION(ENVONLY, JNI_TRUE);
+        H4_JNI_FATAL_ERROR(ENVONLY, "SDgetinfoall: FindClass failed");
+    }
+    if (NULL == (constructor = ENVPTR->GetMethodID(ENVONLY, cls, "<init>", "(IILjava/lang/String;I[III)V"))) {
+        CHECK_JNI_EXCEPTION(ENVONLY, JNI_TRUE);
+        H4_JNI_FATAL_ERROR(ENVONLY, "SDgetinfoall: GetMethodID failed");
+    }
+    if (NULL == (rarray = ENVPTR->NewObjectArray(ENVONLY, (jsize)ndsets, cls, NULL)))
+        CHECK_JNI_EXCEPTION(ENVONLY, JNI_FALSE);
+
+    for (ii = 0; ii < ndsets; ii++) {
+        if ((sdsid = SDselect(id, ii)) == FAIL)
+            H4_LIBRARY_ERROR(ENVONLY);
+        if (SDgetnamelen(sdsid, &namelen) == FAIL)
+            H4_LIBRARY_ERROR(ENVONLY);
+        if ((size_t)namelen + 1 > cnamelen) {
+            free(cname);
+            cnamelen = (size_t)namelen + 1;
+            if ((cname = (char *)malloc(cnamelen)) == NULL)
+                H4_OUT_OF_MEMORY_ERROR(ENVONLY, "SDgetinfoall: failed to allocate data buffer");
+        }
+        if (SDgetinfo(sdsid, cname, &rank, dims, &nt, &nattrs) == FAIL)
+            H4_LIBRARY_ERROR(ENVONLY);
+        args[1].i = (jint)SDidtoref(sdsid);
+        SDendaccess(sdsid);
+        sdsid = FAIL;
+
+        if (NULL == (rstring = ENVPTR->NewStringUTF(ENVONLY, cname)))
+            CHECK_JNI_EXCEPTION(ENVONLY, JNI_FALSE);
+        if (NULL == (rdims = ENVPTR->NewIntArray(ENVONLY, (jsize)rank)))
+            CHECK_JNI_EXCEPTION(ENVONLY, JNI_FALSE);
+        ENVPTR->SetIntArrayRegion(ENVONLY, rdims, 0, (jsize)rank, (jint *)dims);
+        CHECK_JNI_EXCEPTION(ENVONLY, JNI_FALSE);
+
+        args[0].i = (jint)ii;
+        args[2].l = rstring;
+        args[3].i = (jint)rank;
+        args[4].l = rdims;
+        args[5].i = (jint)nt;
+        args[6].i = (jint)nattrs;
+        if (NULL == (info = ENVPTR->NewObjectA(ENVONLY, cls, constructor, args)))
+            CHECK_JNI_EXCEPTION(ENVONLY, JNI_FALSE);
+
+        ENVPTR->SetObjectArrayElement(ENVONLY, rarray, (jsize)ii, info);
+        CHECK_JNI_EXCEPTION(ENVONLY, JNI_FALSE);
+
+        /* A file can have thousands of datasets; keep the local references bounded */
+        ENVPTR->DeleteLocalRef(ENVONLY, info);
+        ENVPTR->DeleteLocalRef(ENVONLY, rdims);
+        ENVPTR->DeleteLocalRef(ENVONLY, rstring);
+    }
+
+done:
+    if (sdsid != FAIL)
+        SDendaccess(sdsid);
+    free(cname);
+
+    return rarray;
+}
+
 JNIEXPORT jboolean JNICALL
 Java_hdf_hdflib_HDFLibrary_SDreaddata(JNIEnv *env, jclass clss, jlong sdsid, jintArray start,
                                       jintArray stride, jintArray count, jbyteArray data)
@@ -242,6 +331,53 @@ done:
     return JNI_TRUE;
 }
 
+JNIEXPORT jboolean JNICALL
+Java_hdf_hdflib_HDFLibrary_SDreaddata_1direct(JNIEnv *env, jclass clss, jlong sdsid, jintArray start,
+                                              jintArray stride, jintArray count, jobject data)
+{
+    int32    rval = FAIL;
+    int32   *strt = NULL;
+    int32   *strd = NULL;
+    int32   *e    = NULL;
+    jbyte   *d    = NULL;
+    jboolean isCopy;
+    int32    id = (int32)sdsid;
+
+    UNUSED(clss);
+
+    if (id < 0)
+        H4_BAD_ARGUMENT_ERROR(ENVONLY, "SDreaddata_direct:  sdsid is invalid");
+
+    if (data == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "SDreaddata_direct:  data is NULL");
+
+    if (start == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "SDreaddata_direct:  start is NULL");
+
+    if (count == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "SDreaddata_direct:  count is NULL");
+
+    GET_DIRECT_BUFFER(ENVONLY, data, d, "SDreaddata_direct:  data is not a direct buffer");
+    PIN_INT_ARRAY(ENVONLY, start, strt, &isCopy, "SDreaddata_direct:  start not pinned");
+    PIN_INT_ARRAY(ENVONLY, count, e, &isCopy, "SDreaddata_direct:  count not pinned");
+
+    if (stride != NULL)
+        PIN_INT_ARRAY(ENVONLY, stride, strd, &isCopy, "SDreaddata_direct:  stride not pinned");
+
+    if ((rval = SDreaddata(id, strt, strd, e, (void *)d)) == FAIL)
+        H4_LIBRARY_ERROR(ENVONLY);
+
+done:
+    if (strd)
+        UNPIN_INT_ARRAY(ENVONLY, stride, strd, (rval == FAIL) ? JNI_ABORT : 0);
+    if (e)
+        UNPIN_INT_ARRAY(ENVONLY, count, e, (rval == FAIL) ? JNI_ABORT : 0);
+    if (strt)
+        UNPIN_INT_ARRAY(ENVONLY, start, strt, (rval == FAIL) ? JNI_ABORT : 0);
+
+    return JNI_TRUE;
+}
+
 /*
     ////////////////////////////////////////////////////////////////////
     //                                                                //
@@ -280,14 +416,18 @@ Java_hdf_hdflib_HDFLibrary_SDreaddata_1short(JNIEnv *env, jclass clss, jlong sds
     else if (count == NULL)
         H4_NULL_ARGUMENT_ERROR(ENVONLY, "SDreaddata:  count is NULL");
 
-    PIN_SHORT_ARRAY(ENVONLY, data, d, &isCopy, "SDreaddata:  data not pinned");
     PIN_INT_ARRAY(ENVONLY, start, strt, &isCopy, "SDreaddata:  start not pinned");
     PIN_INT_ARRAY(ENVONLY, count, cnt, &isCopy, "SDreaddata:  count not pinned");
 
     if (stride != NULL)
         PIN_INT_ARRAY(ENVONLY, stride, strd, &isCopy, "SDreaddata:  stride not pinned");
 
-    if ((rval = SDreaddata(id, strt, strd, cnt, d)) == FAIL)
+    /* Read straight into the array; no JNI call may be made while it is pinned */
+    PIN_SHORT_ARRAY_CRITICAL(ENVONLY, data, d, &isCopy, "SDreaddata:  data not pinned");
+    rval = SDreaddata(id, strt, strd, cnt, d);
+    UNPIN_ARRAY_CRITICAL(ENVONLY, data, d, (rval == FAIL) ? JNI_ABORT : 0);
+
+    if (rval == FAIL)
         H4_LIBRARY_ERROR(ENVONLY);
 
 done:
@@ -297,8 +437,6 @@ done:
         UNPIN_INT_ARRAY(ENVONLY, count, cnt, (rval == FAIL) ? JNI_ABORT : 0);
     if (strt)
         UNPIN_INT_ARRAY(ENVONLY, start, strt, (rval == FAIL) ? JNI_ABORT : 0);
-    if (d)
-        UNPIN_SHORT_ARRAY(ENVONLY, data, d, (rval == FAIL) ? JNI_ABORT : 0);
 
     return JNI_TRUE;
 }
@@ -329,14 +467,18 @@ Java_hdf_hdflib_HDFLibrary_SDreaddata_1int(JNIEnv *env, jclass clss, jlong sdsid
     if (count == NULL)
         H4_NULL_ARGUMENT_ERROR(ENVONLY, "SDreaddata:  count is NULL");
 
-    PIN_INT_ARRAY(ENVONLY, data, d, &isCopy, "SDreaddata:  data not pinned");
     PIN_INT_ARRAY(ENVONLY, start, strt, &isCopy, "SDreaddata:  start not pinned");
     PIN_INT_ARRAY(ENVONLY, count, cnt, &isCopy, "SDreaddata:  count not pinned");
 
     if (stride != NULL)
         PIN_INT_ARRAY(ENVONLY, stride, strd, &isCopy, "SDreaddata:  stride not pinned");
 
-    if ((rval = SDreaddata(id, strt, strd, cnt, d)) == FAIL)
+    /* Read straight into the array; no JNI call may be made while it is pinned */
+    PIN_INT_ARRAY_CRITICAL(ENVONLY, data, d, &isCopy, "SDreaddata:  data not pinned");
+    rval = SDreaddata(id, strt, strd, cnt, d);
+    UNPIN_ARRAY_CRITICAL(ENVONLY, data, d, (rval == FAIL) ? JNI_ABORT : 0);
+
+    if (rval == FAIL)
         H4_LIBRARY_ERROR(ENVONLY);
 
 done:
@@ -346,8 +488,6 @@ done:
         UNPIN_INT_ARRAY(ENVONLY, count, cnt, (rval == FAIL) ? JNI_ABORT : 0);
     if (strt)
         UNPIN_INT_ARRAY(ENVONLY, start, strt, (rval == FAIL) ? JNI_ABORT : 0);
-    if (d)
-        UNPIN_INT_ARRAY(ENVONLY, data, d, (rval == FAIL) ? JNI_ABORT : 0);
 
     return JNI_TRUE;
 }
@@ -378,14 +518,18 @@ Java_hdf_hdflib_HDFLibrary_SDreaddata_1long(JNIEnv *env, jclass clss, jlong sdsi
     if (count == NULL)
         H4_NULL_ARGUMENT_ERROR(ENVONLY, "SDreaddata:  count is NULL");
 
-    PIN_LONG_ARRAY(ENVONLY, data, d, &isCopy, "SDreaddata:  data not pinned");
     PIN_INT_ARRAY(ENVONLY, start, strt, &isCopy, "SDreaddata:  start not pinned");
     PIN_INT_ARRAY(ENVONLY, count, cnt, &isCopy, "SDreaddata:  count not pinned");
 
     if (stride != NULL)
         PIN_INT_ARRAY(ENVONLY, stride, strd, &isCopy, "SDreaddata:  stride not pinned");
 
-    if ((rval = SDreaddata(id, strt, strd, cnt, d)) == FAIL)
+    /* Read straight into the array; no JNI call may be made while it is pinned */
+    PIN_LONG_ARRAY_CRITICAL(ENVONLY, data, d, &isCopy, "SDreaddata:  data not pinned");
+    rval = SDreaddata(id, strt, strd, cnt, d);
+    UNPIN_ARRAY_CRITICAL(ENVONLY, data, d, (rval == FAIL) ? JNI_ABORT : 0);
+
+    if (rval == FAIL)
         H4_LIBRARY_ERROR(ENVONLY);
 
 done:
@@ -395,8 +539,6 @@ done:
         UNPIN_INT_ARRAY(ENVONLY, count, cnt, (rval == FAIL) ? JNI_ABORT : 0);
     if (strt)
         UNPIN_INT_ARRAY(ENVONLY, start, strt, (rval == FAIL) ? JNI_ABORT : 0);
-    if (d)
-        UNPIN_LONG_ARRAY(ENVONLY, data, d, (rval == FAIL) ? JNI_ABORT : 0);
 
     return JNI_TRUE;
 }
@@ -427,14 +569,18 @@ Java_hdf_hdflib_HDFLibrary_SDreaddata_1float(JNIEnv *env, jclass clss, jlong sds
     if (count == NULL)
         H4_NULL_ARGUMENT_ERROR(ENVONLY, "SDreaddata:  count is NULL");
 
-    PIN_FLOAT_ARRAY(ENVONLY, data, d, &isCopy, "SDreaddata:  data not pinned");
     PIN_INT_ARRAY(ENVONLY, start, strt, &isCopy, "SDreaddata:  start not pinned");
     PIN_INT_ARRAY(ENVONLY, count, cnt, &isCopy, "SDreaddata:  count not pinned");
 
     if (stride != NULL)
         PIN_INT_ARRAY(ENVONLY, stride, strd, &isCopy, "SDreaddata:  stride not pinned");
 
-    if ((rval = SDreaddata(id, strt, strd, cnt, d)) == FAIL)
+    /* Read straight into the array; no JNI call may be made while it is pinned */
+    PIN_FLOAT_ARRAY_CRITICAL(ENVONLY, data, d, &isCopy, "SDreaddata:  data not pinned");
+    rval = SDreaddata(id, strt, strd, cnt, d);
+    UNPIN_ARRAY_CRITICAL(ENVONLY, data, d, (rval == FAIL) ? JNI_ABORT : 0);
+
+    if (rval == FAIL)
         H4_LIBRARY_ERROR(ENVONLY);
 
 done:
@@ -444,8 +590,6 @@ done:
         UNPIN_INT_ARRAY(ENVONLY, count, cnt, (rval == FAIL) ? JNI_ABORT : 0);
     if (strt)
         UNPIN_INT_ARRAY(ENVONLY, start, strt, (rval == FAIL) ? JNI_ABORT : 0);
-    if (d)
-        UNPIN_FLOAT_ARRAY(ENVONLY, data, d, (rval == FAIL) ? JNI_ABORT : 0);
 
     return JNI_TRUE;
 }
@@ -476,14 +620,18 @@ Java_hdf_hdflib_HDFLibrary_SDreaddata_1double(JNIEnv *env, jclass clss, jlong sd
     if (count == NULL)
         H4_NULL_ARGUMENT_ERROR(ENVONLY, "SDreaddata:  count is NULL");
 
-    PIN_DOUBLE_ARRAY(ENVONLY, data, d, &isCopy, "SDreaddata:  data not pinned");
     PIN_INT_ARRAY(ENVONLY, start, strt, &isCopy, "SDreaddata:  start not pinned");
     PIN_INT_ARRAY(ENVONLY, count, cnt, &isCopy, "SDreaddata:  count not pinned");
 
     if (stride != NULL)
         PIN_INT_ARRAY(ENVONLY, stride, strd, &isCopy, "SDreaddata:  stride not pinned");
 
-    if ((rval = SDreaddata(id, strt, strd, cnt, d)) == FAIL)
+    /* Read straight into the array; no JNI call may be made while it is pinned */
+    PIN_DOUBLE_ARRAY_CRITICAL(ENVONLY, data, d, &isCopy, "SDreaddata:  data not pinned");
+    rval = SDreaddata(id, strt, strd, cnt, d);
+    UNPIN_ARRAY_CRITICAL(ENVONLY, data, d, (rval == FAIL) ? JNI_ABORT : 0);
+
+    if (rval == FAIL)
         H4_LIBRARY_ERROR(ENVONLY);
 
 done:
@@ -493,8 +641,6 @@ done:
         UNPIN_INT_ARRAY(ENVONLY, count, cnt, (rval == FAIL) ? JNI_ABORT : 0);
     if (strt)
         UNPIN_INT_ARRAY(ENVONLY, start, strt, (rval == FAIL) ? JNI_ABORT : 0);
-    if (d)
-        UNPIN_DOUBLE_ARRAY(ENVONLY, data, d, (rval == FAIL) ? JNI_ABORT : 0);
 
     return JNI_TRUE;
 }
@@ -681,6 +827,80 @@ done:
     return JNI_TRUE;
 }
 
+/*
+ * All the attributes of a file, dataset or dimension in one call, read with
+ * SDreadallattrs() instead of an SDattrinfo() and SDreadattr() call each.
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_hdf_hdflib_HDFLibrary_SDreadallattrs(JNIEnv *env, jclass clss, jlong id)
+{
+    hdf_attr_t  *attrs = NULL;
+    void        *arena = NULL;
+    int32        nattrs, size = 0, nbytes, ii;
+    jclass       cls;
+    jmethodID    constructor;
+    jobjectArray rarray = NULL;
+    jobject      info;
+    jstring      rstring;
+    jbyteArray   rvalues;
+    jvalue       args[4];
+
+    UNUSED(clss);
+
+    /* The number of attributes and the room their names and values need */
+    if ((nattrs = SDreadallattrs((int32)id, NULL, 0, NULL, &size)) == FAIL)
+        H4_LIBRARY_ERROR(ENVONLY);
+
+    if ((attrs = (hdf_attr_t *)malloc(sizeof(hdf_attr_t) * (size_t)(nattrs > 0 ? nattrs : 1))) == NULL)
+        H4_OUT_OF_MEMORY_ERROR(ENVONLY, "SDreadallattrs: failed to allocate data buffer");
+    if ((arena = malloc((size_t)(size > 0 ? size : 1))) == NULL)
+        H4_OUT_OF_MEMORY_ERROR(ENVONLY, "SDreadallattrs: failed to allocate data buffer");
+    if (SDreadallattrs((int32)id, attrs, nattrs, arena, &size) == FAIL)
+        H4_LIBRARY_ERROR(ENVONLY);
+
+    if (NULL == (cls = ENVPTR->FindClass(ENVONLY, "hdf/hdflib/HDFAttrInfo"))) {
+        CHECK_JNI_EXCEPTION(ENVONLY, JNI_TRUE);
+        H4_JNI_FATAL_ERROR(ENVONLY, "SDreadallattrs: FindClass failed");
+    }
+    if (NULL == (constructor = ENVPTR->GetMethodID(ENVONLY, cls, "<init>", "(Ljava/lang/String;II[B)V"))) {
+        CHECK_JNI_EXCEPTION(ENVONLY, JNI_TRUE);
+        H4_JNI_FATAL_ERROR(ENVONLY, "SDreadallattrs: GetMethodID failed");
+    }
+    if (NULL == (rarray = ENVPTR->NewObjectArray(ENVONLY, (jsize)nattrs, cls, NULL)))
+        CHECK_JNI_EXCEPTION(ENVONLY, JNI_FALSE);
+
+    for (ii = 0; ii < nattrs; ii++) {
+        nbytes = attrs[ii].count * DFKNTsize(attrs[ii].ntype | DFNT_NATIVE);
+
+        if (NULL == (rstring = ENVPTR->NewStringUTF(ENVONLY, attrs[ii].name)))
+            CHECK_JNI_EXCEPTION(ENVONLY, JNI_FALSE);
+        if (NULL == (rvalues = ENVPTR->NewByteArray(ENVONLY, (jsize)nbytes)))
+            CHECK_JNI_EXCEPTION(ENVONLY, JNI_FALSE);
+        ENVPTR->SetByteArrayRegion(ENVONLY, rvalues, 0, (jsize)nbytes, (jbyte *)attrs[ii].values);
+        CHECK_JNI_EXCEPTION(ENVONLY, JNI_FALSE);
+
+        args[0].l = rstring;
+        args[1].i = (jint)attrs[ii].ntype;
+        args[2].i = (jint)attrs[ii].count;
+        args[3].l = rvalues;
+        if (NULL == (info = ENVPTR->NewObjectA(ENVONLY, cls, constructor, args)))
+            CHECK_JNI_EXCEPTION(ENVONLY, JNI_FALSE);
+
+        ENVPTR->SetObjectArrayElement(ENVONLY, rarray, (jsize)ii, info);
+        CHECK_JNI_EXCEPTION(ENVONLY, JNI_FALSE);
+
+        ENVPTR->DeleteLocalRef(ENVONLY, info);
+        ENVPTR->DeleteLocalRef(ENVONLY, rvalues);
+        ENVPTR->DeleteLocalRef(ENVONLY, rstring);
+    }
+
+done:
+    free(arena);
+    free(attrs);
+
+    return rarray;
+}
+
 JNIEXPORT jint JNICALL
 Java_hdf_hdflib_HDFLibrary_SDfindattr(JNIEnv *env, jclass clss, jlong sdsid, jstring name)
 {
@@ -1353,6 +1573,53 @@ done:
     return JNI_TRUE;
 }
 
+JNIEXPORT jboolean JNICALL
+Java_hdf_hdflib_HDFLibrary_SDwritedata_1direct(JNIEnv *env, jclass clss, jlong sdsid, jintArray start,
+                                               jintArray stride, jintArray edge, jobject data)
+{
+    int32    rval = FAIL;
+    int32   *strt = NULL;
+    int32   *strd = NULL;
+    int32   *e    = NULL;
+    jbyte   *d    = NULL;
+    jboolean isCopy;
+    int32    id = (int32)sdsid;
+
+    UNUSED(clss);
+
+    if (id < 0)
+        H4_BAD_ARGUMENT_ERROR(ENVONLY, "SDwritedata_direct:  sdsid is invalid");
+
+    if (data == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "SDwritedata_direct:  data is NULL");
+
+    if (start == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "SDwritedata_direct:  start is NULL");
+
+    if (edge == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "SDwritedata_direct:  count is NULL");
+
+    GET_DIRECT_BUFFER(ENVONLY, data, d, "SDwritedata_direct:  data is not a direct buffer");
+    PIN_INT_ARRAY(ENVONLY, start, strt, &isCopy, "SDwritedata_direct:  start not pinned");
+    PIN_INT_ARRAY(ENVONLY, edge, e, &isCopy, "SDwritedata_direct:  edge not pinned");
+
+    if (stride != NULL)
+        PIN_INT_ARRAY(ENVONLY, stride, strd, &isCopy, "SDwritedata_direct:  stride not pinned");
+
+    if ((rval = SDwritedata(id, strt, strd, e, (void *)d)) == FAIL)
+        H4_LIBRARY_ERROR(ENVONLY);
+
+done:
+    if (strd)
+        UNPIN_INT_ARRAY(ENVONLY, stride, strd, (rval == FAIL) ? JNI_ABORT : 0);
+    if (e)
+        UNPIN_INT_ARRAY(ENVONLY, edge, e, (rval == FAIL) ? JNI_ABORT : 0);
+    if (strt)
+        UNPIN_INT_ARRAY(ENVONLY, start, strt, (rval == FAIL) ? JNI_ABORT : 0);
+
+    return JNI_TRUE;
+}
+
 /* new stuff for chunking */
 
 JNIEXPORT jboolean JNICALL
@@ -1606,6 +1873,37 @@ done:
     return JNI_TRUE;
 }
 
+JNIEXPORT jboolean JNICALL
+Java_hdf_hdflib_HDFLibrary_SDreadchunk_1direct(JNIEnv *env, jclass clss, jlong sdid, jintArray origin,
+                                               jobject dat)
+{
+    int32    rval = FAIL;
+    jbyte   *s    = NULL;
+    jint    *arr  = NULL;
+    jboolean isCopy;
+    int32    id = (int32)sdid;
+
+    UNUSED(clss);
+
+    if (dat == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "SDreadchunk_direct:  dat is NULL");
+
+    if (origin == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "SDreadchunk_direct:  origin is NULL");
+
+    GET_DIRECT_BUFFER(ENVONLY, dat, s, "SDreadchunk_direct:  dat is not a direct buffer");
+    PIN_INT_ARRAY(ENVONLY, origin, arr, &isCopy, "SDreadchunk_direct:  origin not pinned");
+
+    if ((rval = SDreadchunk(id, (int32 *)arr, s)) == FAIL)
+        H4_LIBRARY_ERROR(ENVONLY);
+
+done:
+    if (arr)
+        UNPIN_INT_ARRAY(ENVONLY, origin, arr, (rval == FAIL) ? JNI_ABORT : 0);
+
+    return JNI_TRUE;
+}
+
 JNIEXPORT jint JNICALL
 Java_hdf_hdflib_HDFLibrary_SDsetchunkcache(JNIEnv *env, jclass clss, jlong sdsid, jint maxcache, jint flags)
 {
@@ -1654,6 +1952,37 @@ done:
     return JNI_TRUE;
 }
 
+JNIEXPORT jboolean JNICALL
+Java_hdf_hdflib_HDFLibrary_SDwritechunk_1direct(JNIEnv *env, jclass clss, jlong sdid, jintArray origin,
+                                                jobject dat)
+{
+    int32    rval = FAIL;
+    jbyte   *s    = NULL;
+    jint    *arr  = NULL;
+    jboolean isCopy;
+    int32    id = (int32)sdid;
+
+    UNUSED(clss);
+
+    if (dat == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "SDwritechunk_direct:  dat is NULL");
+
+    if (origin == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "SDwritechunk_direct:  origin is NULL");
+
+    GET_DIRECT_BUFFER(ENVONLY, dat, s, "SDwritechunk_direct:  dat is not a direct buffer");
+    PIN_INT_ARRAY(ENVONLY, origin, arr, &isCopy, "SDwritechunk_direct:  origin not pinned");
+
+    if ((rval = SDwritechunk(id, (int32 *)arr, s)) == FAIL)
+        H4_LIBRARY_ERROR(ENVONLY);
+
+done:
+    if (arr)
+        UNPIN_INT_ARRAY(ENVONLY, origin, arr, (rval == FAIL) ? JNI_ABORT : 0);
+
+    return JNI_TRUE;
+}
+
 JNIEXPORT jboolean JNICALL
 Java_hdf_hdflib_HDFLibrary_SDcheckempty(JNIEnv *env, jclass clss, jlong sdsid, jintArray emptySDS)
 {
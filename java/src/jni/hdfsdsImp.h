@@ -47,10 +47,17 @@ JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_SDgetinfo(JNIEnv *env, jcl
                                                                 jobjectArray name, jintArray dimsizes,
                                                                 jintArray argv);
 
+JNIEXPORT jobjectArray JNICALL Java_hdf_hdflib_HDFLibrary_SDgetinfoall(JNIEnv *env, jclass clss, jlong sdid);
+
 JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_SDreaddata(JNIEnv *env, jclass clss, jlong sdsid,
                                                                  jintArray start, jintArray stride,
                                                                  jintArray count, jbyteArray data);
 
+JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_SDreaddata_1direct(JNIEnv *env, jclass clss,
+                                                                         jlong sdsid, jintArray start,
+                                                                         jintArray stride, jintArray count,
+                                                                         jobject data);
+
 /*
     ////////////////////////////////////////////////////////////////////
     //                                                                //
@@ -104,6 +111,8 @@ JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_SDattrinfo(JNIEnv *env, jc
 JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_SDreadattr(JNIEnv *env, jclass clss, jlong sdsid,
                                                                  jint index, jbyteArray dat);
 
+JNIEXPORT jobjectArray JNICALL Java_hdf_hdflib_HDFLibrary_SDreadallattrs(JNIEnv *env, jclass clss, jlong id);
+
 JNIEXPORT jint JNICALL Java_hdf_hdflib_HDFLibrary_SDfindattr(JNIEnv *env, jclass clss, jlong sdsid,
                                                              jstring name);
 
@@ -175,6 +184,11 @@ JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_SDwritedata(JNIEnv *env, j
                                                                   jintArray start, jintArray stride,
                                                                   jintArray edge, jbyteArray data);
 
+JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_SDwritedata_1direct(JNIEnv *env, jclass clss,
+                                                                          jlong sdsid, jintArray start,
+                                                                          jintArray stride, jintArray edge,
+                                                                          jobject data);
+
 /* new stuff for chunking */
 
 JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_SDsetnbitdataset(JNIEnv *env, jclass clss, jlong sdsid,
@@ -214,12 +228,20 @@ JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_SDgetchunkinfo(JNIEnv *env
 JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_SDreadchunk(JNIEnv *env, jclass clss, jlong sdid,
                                                                   jintArray origin, jbyteArray dat);
 
+JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_SDreadchunk_1direct(JNIEnv *env, jclass clss,
+                                                                          jlong sdid, jintArray origin,
+                                                                          jobject dat);
+
 JNIEXPORT jint JNICALL Java_hdf_hdflib_HDFLibrary_SDsetchunkcache(JNIEnv *env, jclass clss, jlong sdsid,
                                                                   jint maxcache, jint flags);
 
 JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_SDwritechunk(JNIEnv *env, jclass clss, jlong sdid,
                                                                    jintArray origin, jbyteArray dat);
 
+JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_SDwritechunk_1direct(JNIEnv *env, jclass clss,
+                                                                           jlong sdid, jintArray origin,
+                                                                           jobject dat);
+
 JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_SDcheckempty(JNIEnv *env, jclass clss, jlong sdsid,
                                                                    jintArray emptySDS);
 
@@ -81,6 +81,18 @@ getNewCompInfo(JNIEnv *env, jobject ciobj, comp_info *cinf)
             }
             cinf->deflate.level = ENVPTR->GetIntField(ENVONLY, ciobj, jf);
             break;
+
+        case COMP_CODE_LZ4:
+            jc = ENVPTR->FindClass(ENVONLY, "hdf/hdflib/HDFLZ4CompInfo");
+            if (jc == NULL) {
+                return JNI_FALSE;
+            }
+            jf = ENVPTR->GetFieldID(ENVONLY, jc, "acceleration", "I");
+            if (jf == NULL) {
+                return JNI_FALSE;
+            }
+            cinf->lz4.acceleration = ENVPTR->GetIntField(ENVONLY, ciobj, jf);
+            break;
         case COMP_CODE_SZIP:
             jc = ENVPTR->FindClass(ENVONLY, "hdf/hdflib/HDFSZIPCompInfo");
             if (jc == NULL) {
@@ -226,6 +238,23 @@ setNewCompInfo(JNIEnv *env, jobject ciobj, comp_coder_t coder, comp_info *cinf)
             }
             ENVPTR->SetIntField(ENVONLY, ciobj, jf, cinf->deflate.level);
             break;
+
+        case COMP_CODE_LZ4:
+            jc = ENVPTR->FindClass(ENVONLY, "hdf/hdflib/HDFLZ4CompInfo");
+            if (jc == NULL) {
+                return JNI_FALSE;
+            }
+            jf = ENVPTR->GetFieldID(ENVONLY, jc, "ctype", "I");
+            if (jf == NULL) {
+                return JNI_FALSE;
+            }
+            ENVPTR->SetIntField(ENVONLY, ciobj, jf, COMP_CODE_LZ4);
+            jf = ENVPTR->GetFieldID(ENVONLY, jc, "acceleration", "I");
+            if (jf == NULL) {
+                return JNI_FALSE;
+            }
+            ENVPTR->SetIntField(ENVONLY, ciobj, jf, cinf->lz4.acceleration);
+            break;
         case COMP_CODE_SZIP:
             jc = ENVPTR->FindClass(ENVONLY, "hdf/hdflib/HDFSZIPCompInfo");
             if (jc == NULL) {
@@ -549,6 +578,15 @@ makeChunkInfo(JNIEnv *env, jobject chunkobj, int32 flgs, HDF_CHUNK_DEF *cinf)
 
                     compinfo = ENVPTR->NewObject(ENVONLY, jc, jmi, cinf->comp.cinfo.deflate.level);
                     break;
+                case COMP_CODE_LZ4:
+                    if ((jc = ENVPTR->FindClass(ENVONLY, "hdf/hdflib/HDFLZ4CompInfo")) == NULL)
+                        return JNI_FALSE;
+
+                    if ((jmi = ENVPTR->GetMethodID(ENVONLY, jc, "<init>", "(I)V")) == NULL)
+                        return JNI_FALSE;
+
+                    compinfo = ENVPTR->NewObject(ENVONLY, jc, jmi, cinf->comp.cinfo.lz4.acceleration);
+                    break;
                 case COMP_CODE_SZIP:
                     if ((jc = ENVPTR->FindClass(ENVONLY, "hdf/hdflib/HDFSZIPCompInfo")) == NULL)
                         return JNI_FALSE;
@@ -385,6 +385,102 @@ done:
     return JNI_TRUE;
 }
 
+/*
+ * One call for the information of all the vdatas of the file, instead of
+ * a VSattach(), VSinquire(), VSgetclass(), VSnattrs() and VSdetach() call each.
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_hdf_hdflib_HDFLibrary_VSgetinfoall(JNIEnv *env, jclass clss, jlong fid)
+{
+    int32        id      = (int32)fid;
+    int32        vdata   = FAIL;
+    int32        nvdatas = 0;
+    int32        ref, nrecords, interlace, vsize, nattrs, ii;
+    char        *flds   = NULL;
+    char        *name   = NULL;
+    char        *vclass = NULL;
+    const char  *sig    = "(ILjava/lang/String;Ljava/lang/String;IILjava/lang/String;II)V";
+    jclass       cls;
+    jmethodID    constructor;
+    jobjectArray rarray = NULL;
+    jobject      info;
+    jstring      rname, rclass, rfields;
+    jvalue       args[8];
+
+    UNUSED(clss);
+
+    if (NULL == (flds = (char *)malloc(sizeof(char) * (size_t)MAX_FIELD_SIZE + 1)))
+        H4_OUT_OF_MEMORY_ERROR(ENVONLY, "VSgetinfoall: failed to allocate data buffer");
+    if (NULL == (name = (char *)malloc(sizeof(char) * (size_t)VSNAMELENMAX + 1)))
+        H4_OUT_OF_MEMORY_ERROR(ENVONLY, "VSgetinfoall: failed to allocate data buffer");
+    if (NULL == (vclass = (char *)malloc(sizeof(char) * (size_t)VSNAMELENMAX + 1)))
+        H4_OUT_OF_MEMORY_ERROR(ENVONLY, "VSgetinfoall: failed to allocate data buffer");
+
+    for (ref = VSgetid(id, -1); ref != FAIL; ref = VSgetid(id, ref))
+        nvdatas++;
+
+    if (NULL == (cls = ENVPTR->FindClass(ENVONLY, "hdf/hdflib/HDFVdataInfo"))) {
+        CHECK_JNI_EXCEPTION(ENVONLY, JNI_TRUE);
+        H4_JNI_FATAL_ERROR(ENVONLY, "VSgetinfoall: FindClass failed");
+    }
+    if (NULL == (constructor = ENVPTR->GetMethodID(ENVONLY, cls, "<init>", sig))) {
+        CHECK_JNI_EXCEPTION(ENVONLY, JNI_TRUE);
+        H4_JNI_FATAL_ERROR(ENVONLY, "VSgetinfoall: GetMethodID failed");
+    }
+    if (NULL == (rarray = ENVPTR->NewObjectArray(ENVONLY, (jsize)nvdatas, cls, NULL)))
+        CHECK_JNI_EXCEPTION(ENVONLY, JNI_FALSE);
+
+    for (ii = 0, ref = VSgetid(id, -1); ii < nvdatas && ref != FAIL; ii++, ref = VSgetid(id, ref)) {
+        if ((vdata = VSattach(id, ref, "r")) == FAIL)
+            H4_LIBRARY_ERROR(ENVONLY);
+        flds[0] = name[0] = vclass[0] = '\0';
+        if (VSinquire(vdata, &nrecords, &interlace, flds, &vsize, name) == FAIL)
+            H4_LIBRARY_ERROR(ENVONLY);
+        if (VSgetclass(vdata, vclass) == FAIL)
+            H4_LIBRARY_ERROR(ENVONLY);
+        if ((nattrs = VSnattrs(vdata)) == FAIL)
+            H4_LIBRARY_ERROR(ENVONLY);
+        VSdetach(vdata);
+        vdata = FAIL;
+
+        flds[MAX_FIELD_SIZE] = name[VSNAMELENMAX] = vclass[VSNAMELENMAX] = '\0';
+        if (NULL == (rname = ENVPTR->NewStringUTF(ENVONLY, name)))
+            CHECK_JNI_EXCEPTION(ENVONLY, JNI_FALSE);
+        if (NULL == (rclass = ENVPTR->NewStringUTF(ENVONLY, vclass)))
+            CHECK_JNI_EXCEPTION(ENVONLY, JNI_FALSE);
+        if (NULL == (rfields = ENVPTR->NewStringUTF(ENVONLY, flds)))
+            CHECK_JNI_EXCEPTION(ENVONLY, JNI_FALSE);
+
+        args[0].i = (jint)ref;
+        args[1].l = rname;
+        args[2].l = rclass;
+        args[3].i = (jint)nrecords;
+        args[4].i = (jint)interlace;
+        args[5].l = rfields;
+        args[6].i = (jint)vsize;
+        args[7].i = (jint)nattrs;
+        if (NULL == (info = ENVPTR->NewObjectA(ENVONLY, cls, constructor, args)))
+            CHECK_JNI_EXCEPTION(ENVONLY, JNI_FALSE);
+
+        ENVPTR->SetObjectArrayElement(ENVONLY, rarray, (jsize)ii, info);
+        CHECK_JNI_EXCEPTION(ENVONLY, JNI_FALSE);
+
+        ENVPTR->DeleteLocalRef(ENVONLY, info);
+        ENVPTR->DeleteLocalRef(ENVONLY, rfields);
+        ENVPTR->DeleteLocalRef(ENVONLY, rclass);
+        ENVPTR->DeleteLocalRef(ENVONLY, rname);
+    }
+
+done:
+    if (vdata != FAIL)
+        VSdetach(vdata);
+    free(vclass);
+    free(name);
+    free(flds);
+
+    return rarray;
+}
+
 JNIEXPORT jboolean JNICALL
 Java_hdf_hdflib_HDFLibrary_VSgetblockinfo(JNIEnv *env, jclass clss, jlong vdata_id, jintArray iargs)
 {
@@ -460,6 +556,217 @@ done:
     return rval;
 }
 
+JNIEXPORT jint JNICALL
+Java_hdf_hdflib_HDFLibrary_VSread_1direct(JNIEnv *env, jclass clss, jlong vdata_id, jobject databuf,
+                                          jint nrecords, jint interlace)
+{
+    int32  rval = FAIL;
+    jbyte *dat  = NULL;
+
+    UNUSED(clss);
+
+    if (databuf == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "VSread_direct: databuf is NULL");
+
+    GET_DIRECT_BUFFER(ENVONLY, databuf, dat, "VSread_direct:  databuf is not a direct buffer");
+
+    if ((rval = VSread((int32)vdata_id, (unsigned char *)dat, (int32)nrecords, (int32)interlace)) == FAIL)
+        H4_LIBRARY_ERROR(ENVONLY);
+
+done:
+    return rval;
+}
+
+/*
+ * The Java array class that holds the values of a field of type 'type', or
+ * NULL if there is none
+ */
+static const char *
+VScolumn_class(int32 type)
+{
+    switch (type & DFNT_MASK) {
+        case DFNT_FLOAT32:
+            return "[F";
+        case DFNT_FLOAT64:
+            return "[D";
+        default:
+            break;
+    }
+    switch (DFKNTsize((type & DFNT_MASK) | DFNT_NATIVE)) {
+        case 1:
+            return "[B";
+        case 2:
+            return "[S";
+        case 4:
+            return "[I";
+        case 8:
+            return "[J";
+        default:
+            return NULL;
+    }
+}
+
+/*
+ * Reads 'nrecords' records from record 'start' of the fields 'fields' of a
+ * vdata with VSreadcolumns(), each field into its own column: a Java array of
+ * the field's type or, if 'direct' is set, a direct buffer.  Each column is
+ * checked against its field before anything is read.
+ */
+static jint
+VSreadcolumns_columns(JNIEnv *env, jlong vdata_id, jobjectArray fields, jint start, jint nrecords,
+                      jobjectArray columns, jboolean direct)
+{
+    int32       rval    = FAIL;
+    int32       vid     = (int32)vdata_id;
+    jsize       nfields = 0;
+    jsize       npinned = 0;
+    jsize       ii;
+    jobject    *cols  = NULL;
+    uint8     **bufs  = NULL;
+    char       *names = NULL;
+    size_t      len   = 0;
+    jstring     jname = NULL;
+    const char *name  = NULL;
+    jclass      cls;
+    const char *clsname;
+    int32       idx;
+    int32       type;
+    int32       order;
+    jlong       need;
+    jboolean    isCopy;
+
+    if (fields == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "VSreadcolumns:  fields is NULL");
+    if (columns == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "VSreadcolumns:  columns is NULL");
+    if (start < 0 || nrecords < 0)
+        H4_BAD_ARGUMENT_ERROR(ENVONLY, "VSreadcolumns:  start or nrecords < 0");
+    if ((nfields = ENVPTR->GetArrayLength(ENVONLY, fields)) < 1)
+        H4_BAD_ARGUMENT_ERROR(ENVONLY, "VSreadcolumns:  no field");
+    if (ENVPTR->GetArrayLength(ENVONLY, columns) != nfields)
+        H4_BAD_ARGUMENT_ERROR(ENVONLY, "VSreadcolumns:  not one column per field");
+    if (ENVPTR->EnsureLocalCapacity(ENVONLY, nfields + 2) < 0)
+        H4_OUT_OF_MEMORY_ERROR(ENVONLY, "VSreadcolumns:  too many fields");
+
+    if ((cols = (jobject *)calloc((size_t)nfields, sizeof(jobject))) == NULL ||
+        (bufs = (uint8 **)calloc((size_t)nfields, sizeof(uint8 *))) == NULL)
+        H4_OUT_OF_MEMORY_ERROR(ENVONLY, "VSreadcolumns:  failed to allocate column table");
+
+    /* the field list for VSsetfields: the names joined with commas */
+    for (ii = 0; ii < nfields; ii++) {
+        char *more;
+
+        if ((jname = (jstring)ENVPTR->GetObjectArrayElement(ENVONLY, fields, ii)) == NULL)
+            H4_NULL_ARGUMENT_ERROR(ENVONLY, "VSreadcolumns:  field name is NULL");
+        PIN_JAVA_STRING(ENVONLY, jname, name, &isCopy, "VSreadcolumns:  field name not pinned");
+        if ((more = (char *)realloc(names, len + strlen(name) + 2)) == NULL)
+            H4_OUT_OF_MEMORY_ERROR(ENVONLY, "VSreadcolumns:  failed to allocate field list");
+        names = more;
+        if (ii > 0)
+            names[len++] = ',';
+        strcpy(names + len, name);
+        len += strlen(name);
+        UNPIN_JAVA_STRING(ENVONLY, jname, name);
+        name = NULL;
+        ENVPTR->DeleteLocalRef(ENVONLY, jname);
+        jname = NULL;
+    }
+
+    if (VSsetfields(vid, names) == FAIL)
+        H4_LIBRARY_ERROR(ENVONLY);
+
+    /* check each column against its field; nothing may be pinned yet */
+    for (ii = 0; ii < nfields; ii++) {
+        if ((jname = (jstring)ENVPTR->GetObjectArrayElement(ENVONLY, fields, ii)) == NULL)
+            H4_NULL_ARGUMENT_ERROR(ENVONLY, "VSreadcolumns:  field name is NULL");
+        PIN_JAVA_STRING(ENVONLY, jname, name, &isCopy, "VSreadcolumns:  field name not pinned");
+        if (VSfindex(vid, name, &idx) == FAIL)
+            H4_LIBRARY_ERROR(ENVONLY);
+        UNPIN_JAVA_STRING(ENVONLY, jname, name);
+        name = NULL;
+        ENVPTR->DeleteLocalRef(ENVONLY, jname);
+        jname = NULL;
+
+        if ((type = VFfieldtype(vid, idx)) == FAIL || (order = VFfieldorder(vid, idx)) == FAIL)
+            H4_LIBRARY_ERROR(ENVONLY);
+
+        if ((cols[ii] = ENVPTR->GetObjectArrayElement(ENVONLY, columns, ii)) == NULL)
+            H4_NULL_ARGUMENT_ERROR(ENVONLY, "VSreadcolumns:  column is NULL");
+
+        if (direct) {
+            need = (jlong)nrecords * order * DFKNTsize((type & DFNT_MASK) | DFNT_NATIVE);
+            GET_DIRECT_BUFFER(ENVONLY, cols[ii], bufs[ii], "VSreadcolumns:  column is not a direct buffer");
+            if (ENVPTR->GetDirectBufferCapacity(ENVONLY, cols[ii]) < need)
+                H4_BAD_ARGUMENT_ERROR(ENVONLY, "VSreadcolumns:  column buffer too small");
+        }
+        else {
+            need = (jlong)nrecords * order;
+            if ((clsname = VScolumn_class(type)) == NULL)
+                H4_BAD_ARGUMENT_ERROR(ENVONLY, "VSreadcolumns:  field type has no Java array");
+            if ((cls = ENVPTR->FindClass(ENVONLY, clsname)) == NULL) {
+                CHECK_JNI_EXCEPTION(ENVONLY, JNI_TRUE);
+                H4_JNI_FATAL_ERROR(ENVONLY, "VSreadcolumns:  array class not found");
+            }
+            if (!ENVPTR->IsInstanceOf(ENVONLY, cols[ii], cls))
+                H4_BAD_ARGUMENT_ERROR(ENVONLY, "VSreadcolumns:  column does not match the field type");
+            ENVPTR->DeleteLocalRef(ENVONLY, cls);
+            if (ENVPTR->GetArrayLength(ENVONLY, (jarray)cols[ii]) < need)
+                H4_BAD_ARGUMENT_ERROR(ENVONLY, "VSreadcolumns:  column array too small");
+        }
+    }
+
+    if (VSseek(vid, (int32)start) == FAIL)
+        H4_LIBRARY_ERROR(ENVONLY);
+
+    /* Read straight into the arrays; no other JNI call may be made while they are pinned */
+    if (direct)
+        rval = VSreadcolumns(vid, bufs, (int32)nrecords);
+    else {
+        for (npinned = 0; npinned < nfields; npinned++)
+            if ((bufs[npinned] = (uint8 *)ENVPTR->GetPrimitiveArrayCritical(ENVONLY, (jarray)cols[npinned],
+                                                                             &isCopy)) == NULL)
+                break;
+        if (npinned == nfields)
+            rval = VSreadcolumns(vid, bufs, (int32)nrecords);
+        for (ii = npinned; ii > 0; ii--)
+            UNPIN_ARRAY_CRITICAL(ENVONLY, (jarray)cols[ii - 1], bufs[ii - 1], (rval == FAIL) ? JNI_ABORT : 0);
+        if (npinned < nfields) {
+            CHECK_JNI_EXCEPTION(ENVONLY, JNI_TRUE);
+            H4_JNI_FATAL_ERROR(ENVONLY, "VSreadcolumns:  column not pinned");
+        }
+    }
+    if (rval == FAIL)
+        H4_LIBRARY_ERROR(ENVONLY);
+
+done:
+    if (name)
+        UNPIN_JAVA_STRING(ENVONLY, jname, name);
+    free(names);
+    free(bufs);
+    free(cols);
+
+    return (jint)rval;
+}
+
+JNIEXPORT jint JNICALL
+Java_hdf_hdflib_HDFLibrary_VSreadcolumns(JNIEnv *env, jclass clss, jlong vdata_id, jobjectArray fields,
+                                         jint start, jint nrecords, jobjectArray columns)
+{
+    UNUSED(clss);
+
+    return VSreadcolumns_columns(env, vdata_id, fields, start, nrecords, columns, JNI_FALSE);
+}
+
+JNIEXPORT jint JNICALL
+Java_hdf_hdflib_HDFLibrary_VSreadcolumns_1direct(JNIEnv *env, jclass clss, jlong vdata_id,
+                                                 jobjectArray fields, jint start, jint nrecords,
+                                                 jobjectArray columns)
+{
+    UNUSED(clss);
+
+    return VSreadcolumns_columns(env, vdata_id, fields, start, nrecords, columns, JNI_TRUE);
+}
+
 JNIEXPORT jint JNICALL
 Java_hdf_hdflib_HDFLibrary_VSseek(JNIEnv *env, jclass clss, jlong vdata_id, jint nrecord)
 {
@@ -720,6 +1027,27 @@ done:
     return rval;
 }
 
+JNIEXPORT jint JNICALL
+Java_hdf_hdflib_HDFLibrary_VSwrite_1direct(JNIEnv *env, jclass clss, jlong vdata_id, jobject databuf,
+                                           jint n_records, jint interlace)
+{
+    int32  rval = FAIL;
+    jbyte *dat  = NULL;
+
+    UNUSED(clss);
+
+    if (databuf == NULL)
+        H4_NULL_ARGUMENT_ERROR(ENVONLY, "VSwrite_direct: databuf is NULL");
+
+    GET_DIRECT_BUFFER(ENVONLY, databuf, dat, "VSwrite_direct:  databuf is not a direct buffer");
+
+    if ((rval = VSwrite((int32)vdata_id, (unsigned char *)dat, (int32)n_records, (int32)interlace)) == FAIL)
+        H4_LIBRARY_ERROR(ENVONLY);
+
+done:
+    return rval;
+}
+
 JNIEXPORT jboolean JNICALL
 Java_hdf_hdflib_HDFLibrary_VSattrinfo(JNIEnv *env, jclass clss, jlong id, jint index, jint attr_index,
                                       jobjectArray name, jintArray argv)
@@ -70,6 +70,8 @@ JNIEXPORT jint JNICALL Java_hdf_hdflib_HDFLibrary_VSgetinterlace(JNIEnv *env, jc
 JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_VSinquire(JNIEnv *env, jclass clss, jlong vdata_id,
                                                                 jintArray iargs, jobjectArray sargs);
 
+JNIEXPORT jobjectArray JNICALL Java_hdf_hdflib_HDFLibrary_VSgetinfoall(JNIEnv *env, jclass clss, jlong fid);
+
 JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_VSgetblockinfo(JNIEnv *env, jclass clss, jlong vdata_id,
                                                                      jintArray iargs);
 
@@ -79,6 +81,19 @@ JNIEXPORT jint JNICALL Java_hdf_hdflib_HDFLibrary_VSlone(JNIEnv *env, jclass cls
 JNIEXPORT jint JNICALL Java_hdf_hdflib_HDFLibrary_VSread(JNIEnv *env, jclass clss, jlong vdata_id,
                                                          jbyteArray databuf, jint nrecords, jint interlace);
 
+JNIEXPORT jint JNICALL Java_hdf_hdflib_HDFLibrary_VSread_1direct(JNIEnv *env, jclass clss, jlong vdata_id,
+                                                                 jobject databuf, jint nrecords,
+                                                                 jint interlace);
+
+JNIEXPORT jint JNICALL Java_hdf_hdflib_HDFLibrary_VSreadcolumns(JNIEnv *env, jclass clss, jlong vdata_id,
+                                                                jobjectArray fields, jint start,
+                                                                jint nrecords, jobjectArray columns);
+
+JNIEXPORT jint JNICALL Java_hdf_hdflib_HDFLibrary_VSreadcolumns_1direct(JNIEnv *env, jclass clss,
+                                                                        jlong vdata_id, jobjectArray fields,
+                                                                        jint start, jint nrecords,
+                                                                        jobjectArray columns);
+
 JNIEXPORT jint JNICALL Java_hdf_hdflib_HDFLibrary_VSseek(JNIEnv *env, jclass clss, jlong vdata_id,
                                                          jint nrecord);
 
@@ -118,6 +133,10 @@ JNIEXPORT void JNICALL Java_hdf_hdflib_HDFLibrary_VSsetname(JNIEnv *env, jclass
 JNIEXPORT jint JNICALL Java_hdf_hdflib_HDFLibrary_VSwrite(JNIEnv *env, jclass clss, jlong vdata_id,
                                                           jbyteArray databuf, jint n_records, jint interlace);
 
+JNIEXPORT jint JNICALL Java_hdf_hdflib_HDFLibrary_VSwrite_1direct(JNIEnv *env, jclass clss, jlong vdata_id,
+                                                                  jobject databuf, jint n_records,
+                                                                  jint interlace);
+
 JNIEXPORT jboolean JNICALL Java_hdf_hdflib_HDFLibrary_VSattrinfo(JNIEnv *env, jclass clss, jlong id,
                                                                  jint index, jint attr_index,
                                                                  jobjectArray name, jintArray argv);
@@ -18,6 +18,7 @@ import static org.junit.Assert.assertTrue;
 import static org.junit.Assert.fail;
 
 import java.io.File;
+import java.util.concurrent.ExecutionException;
 
 import hdf.hdflib.HDFChunkInfo;
 import hdf.hdflib.HDFCompInfo;
@@ -204,6 +205,40 @@ public class TestH4GRparams {
         HDFLibrary.GRreadimage(0, start, stride, null, data);
     }
 
+    @Test(expected = HDFException.class)
+    public void testGRreadimage_asyncIllegalId() throws Throwable
+    {
+        int[] start  = {0, 0};
+        int[] stride = {0, 0};
+        int[] count  = {0, 0};
+        byte[] data  = {0};
+        try {
+            HDFLibrary.GRreadimage_async(-1, start, stride, count, data).get();
+        }
+        catch (ExecutionException err) {
+            throw err.getCause();
+        }
+    }
+
+    @Test(expected = NullPointerException.class)
+    public void testGRreadimage_floatNullData() throws Throwable
+    {
+        int[] start  = {0, 0};
+        int[] stride = {0, 0};
+        int[] count  = {0, 0};
+        HDFLibrary.GRreadimage_float(0, start, stride, count, null);
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void testGRreadimage_intShortStart() throws Throwable
+    {
+        int[] start  = {0};
+        int[] stride = {0, 0};
+        int[] count  = {0, 0};
+        int[] data   = {0};
+        HDFLibrary.GRreadimage_int(0, start, stride, count, data);
+    }
+
     @Test(expected = HDFException.class)
     public void testGRendaccessIllegalId() throws Throwable
     {
@@ -18,6 +18,8 @@ import static org.junit.Assert.assertTrue;
 import static org.junit.Assert.fail;
 
 import java.io.File;
+import java.nio.ByteBuffer;
+import java.util.concurrent.ExecutionException;
 
 import hdf.hdflib.HDFChunkInfo;
 import hdf.hdflib.HDFCompInfo;
@@ -110,6 +112,12 @@ public class TestH4SDparams {
         HDFLibrary.SDgetinfo(-1, name, dim_sizes, args);
     }
 
+    @Test(expected = HDFException.class)
+    public void testSDgetinfoallIllegalId() throws Throwable
+    {
+        HDFLibrary.SDgetinfoall(-1);
+    }
+
     @Test(expected = NullPointerException.class)
     public void testSDgetinfoNullName() throws Throwable
     {
@@ -193,6 +201,64 @@ public class TestH4SDparams {
         HDFLibrary.SDreaddata(0, start, stride, null, data);
     }
 
+    @Test(expected = IllegalArgumentException.class)
+    public void testSDreaddata_asyncIllegalId() throws Throwable
+    {
+        int[] start  = {0, 0};
+        int[] stride = {0, 0};
+        int[] count  = {0, 0};
+        byte[] data  = {0};
+        try {
+            HDFLibrary.SDreaddata_async(-1, start, stride, count, data).get();
+        }
+        catch (ExecutionException err) {
+            throw err.getCause();
+        }
+    }
+
+    @Test(expected = NullPointerException.class)
+    public void testSDreaddata_asyncNullData() throws Throwable
+    {
+        int[] start  = {0, 0};
+        int[] stride = {0, 0};
+        int[] count  = {0, 0};
+        try {
+            HDFLibrary.SDreaddata_async(0, start, stride, count, null).get();
+        }
+        catch (ExecutionException err) {
+            throw err.getCause();
+        }
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void testSDreaddata_directIllegalId() throws Throwable
+    {
+        int[] start     = {0, 0};
+        int[] stride    = {0, 0};
+        int[] count     = {0, 0};
+        ByteBuffer data = ByteBuffer.allocateDirect(1);
+        HDFLibrary.SDreaddata_direct(-1, start, stride, count, data);
+    }
+
+    @Test(expected = NullPointerException.class)
+    public void testSDreaddata_directNullData() throws Throwable
+    {
+        int[] start  = {0, 0};
+        int[] stride = {0, 0};
+        int[] count  = {0, 0};
+        HDFLibrary.SDreaddata_direct(0, start, stride, count, null);
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void testSDreaddata_directNotDirect() throws Throwable
+    {
+        int[] start     = {0, 0};
+        int[] stride    = {0, 0};
+        int[] count     = {0, 0};
+        ByteBuffer data = ByteBuffer.allocate(1);
+        HDFLibrary.SDreaddata_direct(0, start, stride, count, data);
+    }
+
     @Test(expected = IllegalArgumentException.class)
     public void testSDreaddata_shortIllegalId() throws Throwable
     {
@@ -340,6 +406,12 @@ public class TestH4SDparams {
         HDFLibrary.SDreadattr(-1, index, data);
     }
 
+    @Test(expected = HDFException.class)
+    public void testSDreadallattrsIllegalId() throws Throwable
+    {
+        HDFLibrary.SDreadallattrs(-1);
+    }
+
     @Test(expected = NullPointerException.class)
     public void testSDreadattrNull() throws Throwable
     {
@@ -18,6 +18,7 @@ import static org.junit.Assert.assertTrue;
 import static org.junit.Assert.fail;
 
 import java.io.File;
+import java.nio.ByteBuffer;
 
 import hdf.hdflib.HDFChunkInfo;
 import hdf.hdflib.HDFConstants;
@@ -320,6 +321,42 @@ public class TestH4VSparams {
         HDFLibrary.VSread(0, null, 0, 0);
     }
 
+    @Test(expected = NullPointerException.class)
+    public void testVSread_directNullDataBuffer() throws Throwable
+    {
+        HDFLibrary.VSread_direct(0, null, 0, 0);
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void testVSread_directNotDirect() throws Throwable
+    {
+        HDFLibrary.VSread_direct(0, ByteBuffer.allocate(1), 0, 0);
+    }
+
+    @Test(expected = NullPointerException.class)
+    public void testVSreadcolumnsNullFields() throws Throwable
+    {
+        HDFLibrary.VSreadcolumns(0, null, 0, 0, new Object[] {new int[1]});
+    }
+
+    @Test(expected = NullPointerException.class)
+    public void testVSreadcolumnsNullColumns() throws Throwable
+    {
+        HDFLibrary.VSreadcolumns(0, new String[] {"a"}, 0, 0, null);
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void testVSreadcolumnsColumnCount() throws Throwable
+    {
+        HDFLibrary.VSreadcolumns(0, new String[] {"a", "b"}, 0, 0, new Object[] {new int[1]});
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void testVSreadcolumns_directNegativeStart() throws Throwable
+    {
+        HDFLibrary.VSreadcolumns_direct(0, new String[] {"a"}, -1, 0, new ByteBuffer[] {null});
+    }
+
     //    @Test(expected = HDFException.class)
     //    public void testVSreadIllegalId() throws Throwable {
     //        HDFLibrary.VSread(-1, new byte[] { }, 0, 0);
@@ -17,6 +17,8 @@ set (HDF4_REFERENCE_TEST_FILES
       Image_with_Palette.hdf
       IMCOMP.hdf
       LongDataset.hdf
+      cachesim.pat
+      sds_chunked.hdf
       sds_compressed.hdf
       sds_empty_many.hdf
       sds1_dim1_samename.hdf
@@ -41,6 +43,9 @@ set (HDF4_REFERENCE_TEST_FILES
 )
 
 set (HDF4_REFERENCE_FILES
+      cachesim-1.out
+      cachesim-2.out
+      cachesim-3.out
       dumpgr-1.out
       dumpgr-10.out
       dumpgr-11.out
@@ -117,8 +122,12 @@ set (HDF4_REFERENCE_FILES
       dumpvg-7.out
       dumpvg-8.out
       dumpvg-9.out
+      layout-1.out
+      layout-2.out
+      layout-3.out
       list-1.out
       list-10.out
+      list-11.out
       list-2.out
       list-3.out
       list-4.out
@@ -194,6 +203,7 @@ ADD_H4_TEST (list-7 0 list -g tdata.hdf)
 ADD_H4_TEST (list-8 0 list -a tdata.hdf)
 ADD_H4_TEST (list-9 0 list -a Example6.hdf)
 ADD_H4_TEST (list-10 0 list -n Example6.hdf)
+ADD_H4_TEST (list-11 0 list -q tdata.hdf)
 
 # Test 1 prints all datasets
 ADD_H4_TEST (dumpsds-1 0 dumpsds swf32.hdf)
@@ -384,3 +394,17 @@ ADD_H4_TEST (dumpgr-19 0 dumpgr -g -l grtdfi322.hdf)
 
 # Test 20: to test dumpgr successfully detect IMCOMP compression type
 ADD_H4_TEST (dumpgr-20 0 dumpgr IMCOMP.hdf)
+
+# Test 1 reports chunked, contiguous, and linked-block datasets and a vdata
+# appended in two sessions, test 2 adds every chunk, and test 3 reports
+# several files, one with a vdata in an external file
+ADD_H4_TEST (layout-1 0 layout sds_chunked.hdf)
+ADD_H4_TEST (layout-2 0 layout -l sds_chunked.hdf)
+ADD_H4_TEST (layout-3 0 layout tdata.hdf Tables.hdf)
+
+# Test 1 simulates the chunk cache of every chunked dataset read by rows,
+# test 2 reads by columns with given cache sizes and datasets, one of them
+# not chunked, and test 3 replays the slabs of a pattern file
+ADD_H4_TEST (cachesim-1 0 cachesim sds_chunked.hdf)
+ADD_H4_TEST (cachesim-2 0 cachesim -p columns -c 1,2,3 -i 2,0 sds_chunked.hdf)
+ADD_H4_TEST (cachesim-3 0 cachesim -i 0 -f cachesim.pat sds_chunked.hdf)
@@ -27,7 +27,18 @@ intn vinit_done = FALSE;
 /********************************/
 
 /* hdp commands (stored as (value, name) pairs to keep them in sync) */
-typedef enum { HELP, LIST, DUMPSDS, DUMPRIG, DUMPVG, DUMPVD, DUMPGR, BAD_COMMAND } command_value_t;
+typedef enum {
+    HELP,
+    LIST,
+    DUMPSDS,
+    DUMPRIG,
+    DUMPVG,
+    DUMPVD,
+    DUMPGR,
+    LAYOUT,
+    CACHESIM,
+    BAD_COMMAND
+} command_value_t;
 
 typedef struct command_t {
     const command_value_t value;
@@ -37,7 +48,9 @@ typedef struct command_t {
 static const command_t commands[] = {{HELP, "help"},       {LIST, "list"},
                                      {DUMPSDS, "dumpsds"}, {DUMPRIG, "dumprig"},
                                      {DUMPVG, "dumpvg"},   {DUMPVD, "dumpvd"},
-                                     {DUMPGR, "dumpgr"},   {BAD_COMMAND, "BADNESS - not a valid command"}};
+                                     {DUMPGR, "dumpgr"},   {LAYOUT, "layout"},
+                                     {CACHESIM, "cachesim"},
+                                     {BAD_COMMAND, "BADNESS - not a valid command"}};
 
 /* Print the usage message about this utility */
 static void
@@ -56,6 +69,8 @@ usage(intn argc, char *argv[])
     printf("\t     dumpvg\tdisplays data of vgroups in <filelist>. \n");
     printf("\t     dumprig\tdisplays data of RIs (DFR8 and DFR24) in <filelist>. \n");
     printf("\t     dumpgr\tdisplays data of RIs in <filelist>. \n");
+    printf("\t     layout\treports the storage layout of SDSs and vdatas in <filelist>. \n");
+    printf("\t     cachesim\tsimulates the chunk cache of chunked SDSs in <filelist>. \n");
     printf("\t <filelist>\tlist of hdf file names, separated by spaces.\n");
 }
 
@@ -187,6 +202,16 @@ main(int argc, char *argv[])
                 exit(EXIT_FAILURE);
             break;
 
+        case LAYOUT:
+            if (FAIL == do_layout(curr_arg, argc, argv, glob_opts.help))
+                exit(EXIT_FAILURE);
+            break;
+
+        case CACHESIM:
+            if (FAIL == do_cachesim(curr_arg, argc, argv, glob_opts.help))
+                exit(EXIT_FAILURE);
+            break;
+
         case HELP:
             usage(argc, argv);
             break;
@@ -426,6 +451,17 @@ Vattrhdfsize(int32 vgid, intn attrindex, int32 *size)
         /* Bad attr list */
         HGOTO_ERROR(DFE_BADATTR, FAIL);
 
+    /* An attribute in the compact store has no vdata of its own */
+    if (vg_alist == vg->alist && vg_alist[adjusted_index].atag == VG_ATTR_STORE_TAG) {
+        int32 nt, count;
+
+        if (Vattrinfo2(vgid, attrindex, NULL, &nt, &count, NULL, NULL, NULL) == FAIL)
+            HGOTO_ERROR(DFE_BADATTR, FAIL);
+        if (size)
+            *size = count * DFKNTsize(nt);
+        HGOTO_DONE(SUCCEED);
+    }
+
     /* Get access to the vdata storing the attr, and obtain requested info */
     if ((vsid = VSattach(fid, (int32)vg_alist[attrindex].aref, "r")) == FAIL)
         HGOTO_ERROR(DFE_CANTATTACH, FAIL);
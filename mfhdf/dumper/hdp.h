@@ -31,6 +31,7 @@ extern intn vinit_done;
 #define MAXPERLINE  65 /* max # of chars per line in the output */
 #define MAXRANK     100
 #define MAXFNLEN    256
+#define DUMP_READ_SIZE 1048576 /* bytes of SDS rows read at once when dumping */
 #define CONDENSE    1
 #define NO_SPECIFIC -1 /* no specific datasets are requested */
 #define ATTR_INDENT 0  /* # of spaces in front of attribute data */
@@ -288,7 +289,7 @@ typedef enum { OTAG, OFILE, OGROUP, ONAME } sort_t; /* The order tag/refs are so
 /* 'list' command option structure */
 typedef struct {
     sort_t order;                                    /* The sort order tag/refs are printed in */
-    enum { VSHORT, VLONG, VDEBUG } verbosity;        /* verbosity level of list */
+    enum { VSHORT, VLONG, VDEBUG, VTAGS } verbosity; /* verbosity level of list */
     enum { LNONE, LTAGNUM, LTAGNAME, LGROUP } limit; /* How to limit tag/refs */
     intn class;                                      /* Whether to dump class information */
     intn   name;                                     /* Whether to dump name information */
@@ -492,6 +493,12 @@ intn parse_dumpvd_opts(dump_info_t *dumpvd_opts, intn *curr_arg, intn argc, char
 intn do_dumpgr(intn curr_arg, intn argc, char *argv[], intn help);
 intn parse_dumpgr_opts(dump_info_t *dumpgr_opts, intn *curr_arg, intn argc, char *argv[]);
 
+/* hdp_layout.c */
+intn do_layout(intn curr_arg, intn argc, char *argv[], intn help);
+
+/* hdp_cachesim.c */
+intn do_cachesim(intn curr_arg, intn argc, char *argv[], intn help);
+
 /* hdp_dump.c */
 extern intn  fmtchar(void *x, file_format_t ft, FILE *ofp);
 extern intn  fmtuchar8(void *x, file_format_t ft, FILE *ofp);
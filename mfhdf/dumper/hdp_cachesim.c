@@ -0,0 +1,603 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* hdp cachesim: replays an access pattern against the chunk grid of the
+   chunked SDSs in a file, through the chunk cache of the library itself
+   (mcache) at several sizes and with each replacement policy, to help
+   choose the arguments of SDsetchunkcache().  A read of a slab looks up
+   the written chunks holding values of the slab once each, in the order
+   of their numbers, the way SDreaddata() does; chunks never written are
+   filled and never looked up.  No data is read from the file. */
+
+#include "mfhdf.h"
+#include "hdp.h"
+#include "mcache.h"
+
+#define CACHESIM_NPOLICIES 3 /* LRU, CLOCK and 2Q */
+
+static const intn  cachesim_policies[CACHESIM_NPOLICIES] = {MCACHE_LRU, MCACHE_CLOCK, MCACHE_2Q};
+static const char *cachesim_policy_names[CACHESIM_NPOLICIES] = {"LRU", "CLOCK", "2Q"};
+
+/* Built-in access patterns */
+typedef enum { PATTERN_ROWS, PATTERN_COLUMNS, PATTERN_WHOLE, PATTERN_FILE } cachesim_pattern_t;
+
+typedef struct {
+    cachesim_pattern_t pattern;  /* access pattern to replay */
+    char              *pat_file; /* file of slabs to read, for PATTERN_FILE */
+    number_filter_t    by_index; /* SDSs requested by index, all if empty */
+    number_filter_t    sizes;    /* cache sizes to simulate, in chunks */
+} cachesim_opts_t;
+
+/* The chunk grid of an SDS and the chunk lookups of the pattern */
+typedef struct {
+    int32  rank;
+    int32  dims[H4_MAX_VAR_DIMS];    /* dimension sizes */
+    int32  lengths[H4_MAX_VAR_DIMS]; /* chunk lengths */
+    int32  nchunks[H4_MAX_VAR_DIMS]; /* number of chunks along each dimension */
+    int32  total;                    /* number of chunks */
+    int32  raw_size;                 /* uncompressed size of a chunk */
+    uint8 *written;                  /* per chunk: 0 not written, 1 stored as is, 2 compressed */
+    int32 *lookups;                  /* chunk numbers looked up, in order */
+    int32  nlookups;                 /* number of entries in 'lookups' */
+    int32  maxlookups;               /* room in 'lookups' */
+    int32  nreads;                   /* number of slabs read */
+    int32  ndistinct;                /* number of different chunks looked up */
+    double bytes_decoded;            /* bytes decompressed by the current run */
+} cachesim_grid_t;
+
+static void
+cachesim_usage(intn argc, char *argv[])
+{
+    (void)argc;
+
+    printf("Usage:\n");
+    printf("%s cachesim [-i <indices>] [-p rows|columns|whole] [-f <pattern file>] [-c <sizes>] "
+           "<filelist>\n",
+           argv[0]);
+    printf("\t-i <indices>\tSimulate the chunked SDSs with these indices only\n");
+    printf("\t-p rows\t\tRead the SDS one index of its first dimension at a time (default)\n");
+    printf("\t-p columns\tRead the SDS one index of its last dimension at a time\n");
+    printf("\t-p whole\tRead the SDS at once\n");
+    printf("\t-f <file>\tRead the slabs listed in <file>, one per line: the start of the\n");
+    printf("\t\t\tslab along each dimension, then its edges, then optionally its strides\n");
+    printf("\t-c <sizes>\tSimulate caches of these numbers of chunks, e.g. 1,4,16\n");
+    printf("\t<filelist>\tList of hdf file names, separated by spaces\n");
+} /* end cachesim_usage() */
+
+/* Returns the number of options parsed or FAIL */
+static intn
+parse_cachesim_opts(cachesim_opts_t *opts, intn curr_arg, intn argc, char *argv[])
+{
+    intn start = curr_arg;
+
+    for (; curr_arg < argc; curr_arg++) {
+/* Allows '/' for options on Windows */
+#ifdef H4_HAVE_WIN32_API
+        if (argv[curr_arg][0] == '-' || argv[curr_arg][0] == '/')
+#else
+        if (argv[curr_arg][0] == '-')
+#endif
+        {
+            switch (argv[curr_arg][1]) {
+                case 'i': /* SDSs by index */
+                    curr_arg++;
+                    parse_number_opts(argv, &curr_arg, &opts->by_index);
+                    break;
+
+                case 'c': /* cache sizes */
+                    curr_arg++;
+                    parse_number_opts(argv, &curr_arg, &opts->sizes);
+                    break;
+
+                case 'p': /* built-in pattern */
+                    if (++curr_arg >= argc) {
+                        printf("Missing values for option\n");
+                        return FAIL;
+                    }
+                    if (strcmp(argv[curr_arg], "rows") == 0)
+                        opts->pattern = PATTERN_ROWS;
+                    else if (strcmp(argv[curr_arg], "columns") == 0)
+                        opts->pattern = PATTERN_COLUMNS;
+                    else if (strcmp(argv[curr_arg], "whole") == 0)
+                        opts->pattern = PATTERN_WHOLE;
+                    else {
+                        printf("ERROR: Unknown pattern: %s\n", argv[curr_arg]);
+                        return FAIL;
+                    }
+                    break;
+
+                case 'f': /* pattern file */
+                    if (++curr_arg >= argc) {
+                        printf("Missing values for option\n");
+                        return FAIL;
+                    }
+                    opts->pattern  = PATTERN_FILE;
+                    opts->pat_file = argv[curr_arg];
+                    break;
+
+                default: /* unknown option */
+                    printf("ERROR: Unknown option: %s\n", argv[curr_arg]);
+                    return FAIL;
+            } /* end switch */
+        }     /* end if */
+        else
+            break; /* the file names start here */
+    }          /* end for */
+
+    return curr_arg - start;
+} /* end parse_cachesim_opts() */
+
+/* Page-in routine of the simulated cache: counts the bytes that reading
+   the chunk in decompresses */
+static int32
+cachesim_pgin(void *cookie, int32 chunk_num, void *page)
+{
+    cachesim_grid_t *grid = (cachesim_grid_t *)cookie;
+
+    (void)page;
+    if (grid->written[chunk_num] == 2)
+        grid->bytes_decoded += (double)grid->raw_size;
+    return SUCCEED;
+} /* end cachesim_pgin() */
+
+/* Adds the lookups of the written chunks holding values of a slab, in the
+   order of their numbers */
+static intn
+cachesim_add_slab(cachesim_grid_t *grid, const int32 *start, const int32 *edges, const int32 *stride)
+{
+    int32 *clist[H4_MAX_VAR_DIMS];  /* chunks along each dimension holding values of the slab */
+    int32  ncs[H4_MAX_VAR_DIMS];    /* number of entries in clist[] */
+    int32  idx[H4_MAX_VAR_DIMS];    /* current entry of clist[] */
+    int32  c, last, chunk_num, *new_lookups;
+    int32  i, k;
+    intn   ret_value = SUCCEED;
+
+    memset(clist, 0, sizeof(clist));
+    for (k = 0; k < grid->rank; k++) {
+        if (start[k] < 0 || edges[k] < 1 || stride[k] < 1 ||
+            start[k] + (double)(edges[k] - 1) * stride[k] >= grid->dims[k])
+            ERROR_GOTO_1("in cachesim_add_slab: the slab does not fit dimension %d", (int)k);
+        if ((clist[k] = (int32 *)malloc((size_t)grid->nchunks[k] * sizeof(int32))) == NULL)
+            ERROR_GOTO_0("in cachesim_add_slab: not enough memory");
+        for (ncs[k] = 0, last = -1, i = 0; i < edges[k]; i++)
+            if ((c = (start[k] + i * stride[k]) / grid->lengths[k]) != last)
+                clist[k][ncs[k]++] = last = c;
+        idx[k] = 0;
+    }
+
+    do {
+        for (chunk_num = 0, k = 0; k < grid->rank; k++)
+            chunk_num = chunk_num * grid->nchunks[k] + clist[k][idx[k]];
+
+        if (grid->written[chunk_num]) {
+            if (grid->nlookups == grid->maxlookups) {
+                grid->maxlookups = MAX(2 * grid->maxlookups, 1024);
+                if ((new_lookups = (int32 *)realloc(grid->lookups,
+                                                    (size_t)grid->maxlookups * sizeof(int32))) == NULL)
+                    ERROR_GOTO_0("in cachesim_add_slab: not enough memory");
+                grid->lookups = new_lookups;
+            }
+            grid->lookups[grid->nlookups++] = chunk_num;
+        }
+
+        /* next chunk, the last dimension varying fastest */
+        for (k = grid->rank - 1; k >= 0; k--) {
+            if (++idx[k] < ncs[k])
+                break;
+            idx[k] = 0;
+        }
+    } while (k >= 0);
+    grid->nreads++;
+
+done:
+    for (k = 0; k < grid->rank; k++)
+        free(clist[k]);
+
+    return ret_value;
+} /* end cachesim_add_slab() */
+
+/* Adds the slabs of a built-in pattern */
+static intn
+cachesim_add_pattern(cachesim_grid_t *grid, cachesim_pattern_t pattern)
+{
+    int32 start[H4_MAX_VAR_DIMS], edges[H4_MAX_VAR_DIMS], stride[H4_MAX_VAR_DIMS];
+    int32 dim, i, k;
+    intn  ret_value = SUCCEED;
+
+    for (k = 0; k < grid->rank; k++) {
+        start[k]  = 0;
+        edges[k]  = grid->dims[k];
+        stride[k] = 1;
+    }
+    if (pattern == PATTERN_WHOLE)
+        return cachesim_add_slab(grid, start, edges, stride);
+
+    /* one index of the first or the last dimension at a time */
+    dim        = (pattern == PATTERN_ROWS) ? 0 : grid->rank - 1;
+    edges[dim] = 1;
+    for (i = 0; i < grid->dims[dim]; i++) {
+        start[dim] = i;
+        if (cachesim_add_slab(grid, start, edges, stride) == FAIL)
+            HGOTO_DONE(FAIL);
+    }
+
+done:
+    return ret_value;
+} /* end cachesim_add_pattern() */
+
+/* Adds the slabs listed in a pattern file; blank lines and lines starting
+   with '#' are skipped */
+static intn
+cachesim_add_file(cachesim_grid_t *grid, const char *pat_file)
+{
+    FILE *fp = NULL;
+    char  line[1024], *p, *end;
+    int32 values[3 * H4_MAX_VAR_DIMS];
+    int32 stride[H4_MAX_VAR_DIMS];
+    int32 nvalues, lineno = 0, k;
+    intn  ret_value = SUCCEED;
+
+    if ((fp = fopen(pat_file, "r")) == NULL)
+        ERROR_GOTO_1("in cachesim_add_file: cannot open pattern file %s", pat_file);
+
+    while (fgets(line, (int)sizeof(line), fp) != NULL) {
+        lineno++;
+        for (nvalues = 0, p = line;; p = end) {
+            while (*p == ' ' || *p == '\t' || *p == ',')
+                p++;
+            if (*p == '\0' || *p == '\n' || *p == '\r' || *p == '#')
+                break;
+            if (nvalues == 3 * grid->rank)
+                ERROR_GOTO_2("in cachesim_add_file: too many values on line %d of %s", (int)lineno, pat_file);
+            values[nvalues++] = (int32)strtol(p, &end, 10);
+            if (end == p)
+                ERROR_GOTO_2("in cachesim_add_file: bad value on line %d of %s", (int)lineno, pat_file);
+        }
+        if (nvalues == 0)
+            continue;
+        if (nvalues != 2 * grid->rank && nvalues != 3 * grid->rank)
+            ERROR_GOTO_2("in cachesim_add_file: wrong number of values on line %d of %s", (int)lineno,
+                         pat_file);
+
+        for (k = 0; k < grid->rank; k++)
+            stride[k] = (nvalues == 3 * grid->rank) ? values[2 * grid->rank + k] : 1;
+        if (cachesim_add_slab(grid, values, values + grid->rank, stride) == FAIL)
+            ERROR_GOTO_2("in cachesim_add_file: bad slab on line %d of %s", (int)lineno, pat_file);
+    }
+
+done:
+    if (fp != NULL)
+        fclose(fp);
+
+    return ret_value;
+} /* end cachesim_add_file() */
+
+/* Replays the lookups through a chunk cache of 'maxcache' chunks */
+static intn
+cachesim_run(cachesim_grid_t *grid, int32 maxcache, intn policy, hdf_cache_stats_t *stats)
+{
+    MCACHE *mp  = NULL;
+    int32   key = 0;
+    void   *page;
+    int32   i;
+    intn    ret_value = SUCCEED;
+
+    grid->bytes_decoded = 0.0;
+
+    /* the pages hold nothing, one byte each is enough */
+    if ((mp = mcache_open(&key, 0, 1, maxcache, grid->total, 0)) == NULL)
+        ERROR_GOTO_0("in cachesim_run: mcache_open failed");
+    mcache_filter(mp, cachesim_pgin, NULL, grid);
+    if (mcache_set_policy(mp, policy) == FAIL)
+        ERROR_GOTO_0("in cachesim_run: mcache_set_policy failed");
+
+    for (i = 0; i < grid->nlookups; i++) {
+        if ((page = mcache_get(mp, grid->lookups[i] + 1, 0)) == NULL)
+            ERROR_GOTO_0("in cachesim_run: mcache_get failed");
+        if (mcache_put(mp, page, 0) == FAIL)
+            ERROR_GOTO_0("in cachesim_run: mcache_put failed");
+    }
+    if (mcache_get_stats(mp, stats) == FAIL)
+        ERROR_GOTO_0("in cachesim_run: mcache_get_stats failed");
+
+done:
+    if (mp != NULL)
+        mcache_close(mp);
+
+    return ret_value;
+} /* end cachesim_run() */
+
+/* Finds the smallest cache with which no chunk is read in twice; a cache
+   holding every chunk looked up always is one.  LRU never misses more with
+   a larger cache, so its size is found by bisection, while CLOCK and 2Q
+   are tried with one chunk more at a time */
+static int32
+cachesim_smallest(cachesim_grid_t *grid, intn policy)
+{
+    hdf_cache_stats_t stats;
+    int32             lo = 1, hi = MAX(grid->ndistinct, 1), mid;
+
+    while (lo < hi) {
+        mid = (policy == MCACHE_LRU) ? lo + (hi - lo) / 2 : lo;
+        if (cachesim_run(grid, mid, policy, &stats) == FAIL)
+            return FAIL;
+        if (stats.misses == grid->ndistinct)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return hi;
+} /* end cachesim_smallest() */
+
+static int
+cachesim_compare(const void *a, const void *b)
+{
+    int32 x = *(const int32 *)a, y = *(const int32 *)b;
+
+    return (x > y) - (x < y);
+} /* end cachesim_compare() */
+
+/* Simulates the chunk cache of an SDS */
+static intn
+cachesim_sds(int32 sd_id, int32 sds_index, const cachesim_opts_t *opts, intn chosen)
+{
+    int32             sds_id = FAIL;
+    char              name[H4_MAX_NC_NAME];
+    int32             nt, nattrs, flags, coord[H4_MAX_VAR_DIMS];
+    int32             offset, length, chunk_num, deflt;
+    int32            *sizes = NULL, nsizes = 0, smallest;
+    uint8            *seen  = NULL;
+    HDF_CHUNK_DEF     cdef;
+    comp_coder_t      comp_type = COMP_CODE_NONE;
+    comp_info         c_info;
+    hdf_cache_stats_t stats;
+    cachesim_grid_t   grid;
+    intn              i, k, count;
+    intn              ret_value = SUCCEED;
+
+    memset(&grid, 0, sizeof(grid));
+
+    if ((sds_id = SDselect(sd_id, sds_index)) == FAIL)
+        ERROR_GOTO_2("in %s: SDselect failed for %d'th SDS", "cachesim_sds", (int)sds_index);
+
+    /* Dimension scales are not chunked */
+    if (SDiscoordvar(sds_id))
+        goto done;
+
+    if (SDgetinfo(sds_id, name, &grid.rank, grid.dims, &nt, &nattrs) == FAIL)
+        ERROR_GOTO_2("in %s: SDgetinfo failed for %d'th SDS", "cachesim_sds", (int)sds_index);
+    if (SDgetchunkinfo(sds_id, &cdef, &flags) == FAIL)
+        ERROR_GOTO_2("in %s: SDgetchunkinfo failed for %d'th SDS", "cachesim_sds", (int)sds_index);
+    if (!(flags & HDF_CHUNK)) {
+        if (chosen)
+            printf("\nSDS %d \"%s\": not chunked\n", (int)sds_index, name);
+        goto done;
+    }
+    memset(&c_info, 0, sizeof(c_info));
+    if (SDgetcompinfo(sds_id, &comp_type, &c_info) == FAIL)
+        comp_type = COMP_CODE_NONE;
+
+    printf("\nSDS %d \"%s\": ", (int)sds_index, name);
+    for (i = 0; i < grid.rank; i++)
+        printf("%s%d", i ? " x " : "", (int)grid.dims[i]);
+    printf("\n");
+
+    grid.total    = 1;
+    grid.raw_size = DFKNTsize(nt);
+    for (i = 0; i < grid.rank; i++) {
+        grid.lengths[i] = cdef.chunk_lengths[i];
+        grid.nchunks[i] = (grid.dims[i] + grid.lengths[i] - 1) / grid.lengths[i];
+        grid.total *= grid.nchunks[i];
+        grid.raw_size *= grid.lengths[i];
+        coord[i] = 0;
+    }
+    printf("    Chunk: ");
+    for (i = 0; i < grid.rank; i++)
+        printf("%s%d", i ? " x " : "", (int)grid.lengths[i]);
+    printf(", chunks: ");
+    for (i = 0; i < grid.rank; i++)
+        printf("%s%d", i ? " x " : "", (int)grid.nchunks[i]);
+    printf(", %d bytes each", (int)grid.raw_size);
+    if (comp_type != COMP_CODE_NONE)
+        printf(" (%s)", comp_method_txt(comp_type));
+    printf("\n");
+    if (grid.total == 0) {
+        printf("    No data written\n");
+        goto done;
+    }
+
+    /* Which chunks are written, and which are decompressed when read */
+    if ((grid.written = (uint8 *)calloc((size_t)grid.total, 1)) == NULL ||
+        (seen = (uint8 *)calloc((size_t)grid.total, 1)) == NULL)
+        ERROR_GOTO_0("in cachesim_sds: not enough memory");
+    for (chunk_num = 0; chunk_num < grid.total; chunk_num++) {
+        if ((count = SDgetdatainfo(sds_id, coord, 0, 1, &offset, &length)) == FAIL)
+            ERROR_GOTO_0("in cachesim_sds: SDgetdatainfo failed");
+        if (count > 0)
+            grid.written[chunk_num] = (comp_type != COMP_CODE_NONE && length != grid.raw_size) ? 2 : 1;
+
+        for (k = grid.rank - 1; k >= 0; k--) {
+            if (++coord[k] < grid.nchunks[k])
+                break;
+            coord[k] = 0;
+        }
+    }
+
+    if (opts->pattern == PATTERN_FILE) {
+        if (cachesim_add_file(&grid, opts->pat_file) == FAIL)
+            HGOTO_DONE(FAIL);
+    }
+    else if (cachesim_add_pattern(&grid, opts->pattern) == FAIL)
+        HGOTO_DONE(FAIL);
+    for (i = 0; i < grid.nlookups; i++)
+        if (!seen[grid.lookups[i]]) {
+            seen[grid.lookups[i]] = 1;
+            grid.ndistinct++;
+        }
+
+    printf("    Pattern: %s, %d reads, %d chunk lookups of %d chunks\n",
+           opts->pattern == PATTERN_ROWS      ? "rows"
+           : opts->pattern == PATTERN_COLUMNS ? "columns"
+           : opts->pattern == PATTERN_WHOLE   ? "whole"
+                                              : opts->pat_file,
+           (int)grid.nreads, (int)grid.nlookups, (int)grid.ndistinct);
+    if (grid.nlookups == 0)
+        goto done;
+
+    /* The default cache of the library holds a row of chunks, see
+       SDsetchunkcache(), or as many as HDF4_CHUNK_CACHE_BYTES holds */
+    if ((deflt = Hgetconfig(HDF_CONFIG_CHUNK_CACHE_BYTES)) > 0)
+        deflt = MAX(1, deflt / grid.raw_size);
+    else
+        for (deflt = 1, i = 1; i < grid.rank; i++)
+            deflt *= grid.nchunks[i];
+
+    /* The sizes asked for, or powers of two up to all the chunks looked
+       up and the default size */
+    if ((sizes = (int32 *)malloc((size_t)(opts->sizes.num_items + 34) * sizeof(int32))) == NULL)
+        ERROR_GOTO_0("in cachesim_sds: not enough memory");
+    if (opts->sizes.num_items > 0)
+        for (i = 0; i < opts->sizes.num_items; i++) {
+            if (opts->sizes.num_list[i] < 1)
+                ERROR_GOTO_1("in cachesim_sds: bad cache size %d", (int)opts->sizes.num_list[i]);
+            sizes[nsizes++] = opts->sizes.num_list[i];
+        }
+    else {
+        for (i = 1; i < grid.ndistinct; i *= 2)
+            sizes[nsizes++] = i;
+        sizes[nsizes++] = grid.ndistinct;
+        sizes[nsizes++] = deflt;
+    }
+    qsort(sizes, (size_t)nsizes, sizeof(int32), cachesim_compare);
+
+    printf("    %8s  %-6s %9s %9s %9s %9s %18s\n", "Cache", "Policy", "Hits", "Misses", "Hit ratio",
+           "Re-reads", "Bytes decompressed");
+    for (i = 0; i < nsizes; i++) {
+        if (i > 0 && sizes[i] == sizes[i - 1])
+            continue;
+        for (k = 0; k < CACHESIM_NPOLICIES; k++) {
+            if (cachesim_run(&grid, sizes[i], cachesim_policies[k], &stats) == FAIL)
+                HGOTO_DONE(FAIL);
+            printf("    %8d  %-6s %9d %9d %9.2f %9d %18.0f\n", (int)sizes[i], cachesim_policy_names[k],
+                   (int)stats.hits, (int)stats.misses, (double)stats.hits / (double)grid.nlookups,
+                   (int)(stats.misses - grid.ndistinct), grid.bytes_decoded);
+        }
+    }
+
+    printf("    Smallest cache with no chunk read twice:");
+    for (k = 0; k < CACHESIM_NPOLICIES; k++) {
+        if ((smallest = cachesim_smallest(&grid, cachesim_policies[k])) == FAIL)
+            HGOTO_DONE(FAIL);
+        printf("%s %s %d", k ? "," : "", cachesim_policy_names[k], (int)smallest);
+    }
+    printf(" chunks\n");
+    printf("    Library default: %d chunks\n", (int)deflt);
+
+done:
+    if (sds_id != FAIL)
+        SDendaccess(sds_id);
+    free(grid.written);
+    free(grid.lookups);
+    free(seen);
+    free(sizes);
+
+    return ret_value;
+} /* end cachesim_sds() */
+
+intn
+do_cachesim(intn curr_arg, intn argc, char *argv[], intn help)
+{
+    filelist_t     *f_list       = NULL; /* list of files to simulate */
+    char           *f_name       = NULL; /* current file name */
+    int32           sd_id        = FAIL; /* SD interface ID */
+    int32           n_datasets   = 0;    /* number of SDSs in the file */
+    int32           n_file_attrs = 0;    /* number of file attributes */
+    int32           sds_index;           /* index of the current SDS */
+    cachesim_opts_t opts;
+    intn            status, i;
+    intn            ret_value = SUCCEED;
+
+    memset(&opts, 0, sizeof(opts));
+    opts.pattern = PATTERN_ROWS;
+
+    if (help == TRUE) {
+        cachesim_usage(argc, argv);
+        goto done;
+    }
+
+    /* Incomplete command */
+    if (curr_arg >= argc) {
+        cachesim_usage(argc, argv);
+        ret_value = FAIL; /* So caller can be traced in debugging */
+        goto done;
+    }
+
+    if ((status = parse_cachesim_opts(&opts, curr_arg, argc, argv)) == FAIL) {
+        cachesim_usage(argc, argv);
+        ret_value = FAIL;
+        goto done;
+    }
+
+    curr_arg += status;
+    if (curr_arg >= argc || (f_list = make_file_list(curr_arg, argc, argv)) == NULL) {
+        fprintf(stderr, "ERROR: No files to dump!\n");
+        cachesim_usage(argc, argv);
+        ret_value = FAIL;
+        goto done;
+    }
+
+    /* Process each file */
+    f_name = get_next_file(f_list, 0);
+    while (f_name != NULL) {
+        if ((sd_id = SDstart(f_name, DFACC_READ)) == FAIL)
+            ERROR_GOTO_1("do_cachesim: SDstart failed for file %s", f_name);
+
+        printf("File: %s\n", f_name);
+
+        if (SDfileinfo(sd_id, &n_datasets, &n_file_attrs) == FAIL)
+            ERROR_GOTO_1("do_cachesim: SDfileinfo failed for file %s", f_name);
+        if (opts.by_index.num_items > 0)
+            for (i = 0; i < opts.by_index.num_items; i++) {
+                sds_index = opts.by_index.num_list[i];
+                if (sds_index < 0 || sds_index >= n_datasets)
+                    ERROR_GOTO_2("do_cachesim: no SDS with index %d in file %s", (int)sds_index, f_name);
+                if (FAIL == cachesim_sds(sd_id, sds_index, &opts, TRUE))
+                    ERROR_GOTO_0("in do_cachesim\n");
+            }
+        else
+            for (sds_index = 0; sds_index < n_datasets; sds_index++)
+                if (FAIL == cachesim_sds(sd_id, sds_index, &opts, FALSE))
+                    ERROR_GOTO_0("in do_cachesim\n");
+
+        if (SDend(sd_id) == FAIL)
+            ERROR_GOTO_1("do_cachesim: SDend failed for file %s", f_name);
+        sd_id = FAIL;
+
+        /* get next file to process */
+        f_name = get_next_file(f_list, 1);
+        if (f_name != NULL)
+            printf("\n");
+    } /* end while processing files */
+
+done:
+    if (ret_value == FAIL) { /* Failure cleanup */
+        if (sd_id != FAIL)
+            SDend(sd_id);
+    }
+    if (f_list != NULL)
+        free_file_list(f_list);
+    free(opts.by_index.num_list);
+    free(opts.sizes.num_list);
+
+    return ret_value;
+} /* end do_cachesim() */
@@ -263,6 +263,90 @@ select_func(int32 nt)
     } /* end switch */
 } /* select_func */
 
+/*
+ * ASCII formatting into a memory buffer, used by dumpfull() so that a row
+ * of numbers costs one fwrite() rather than a printf() per number.  The
+ * text is the same as the fmt* routines above print.
+ */
+
+#define DUMP_OBUF_SIZE 65536 /* bytes of text gathered before writing */
+#define DUMP_ITEM_MAX  400   /* longest item: "%f" of -DBL_MAX and a separator */
+
+/* decimal digits of V at OUT; returns the number of characters */
+static intn
+fmtdecimal(unsigned long v, intn negative, char *out)
+{
+    char digits[24];
+    intn n = 0, len = 0;
+
+    do {
+        digits[n++] = (char)('0' + (v % 10));
+        v /= 10;
+    } while (v != 0);
+
+    if (negative)
+        out[len++] = '-';
+    while (n > 0)
+        out[len++] = digits[--n];
+    return len;
+}
+
+static intn
+fmtsigned(long v, char *out)
+{
+    if (v < 0)
+        return fmtdecimal(0UL - (unsigned long)v, TRUE, out);
+    return fmtdecimal((unsigned long)v, FALSE, out);
+}
+
+/* formats the item of type NT at X into OUT; returns the number of characters */
+static intn
+fmtascii(int32 nt, const void *x, char *out)
+{
+    int16   i16;
+    uint16  u16;
+    int32   i32;
+    uint32  u32;
+    float32 f32;
+    float64 f64;
+
+    switch (nt & 0xff) {
+        case DFNT_UCHAR:
+        case DFNT_UINT8:
+            return fmtdecimal((unsigned long)*(const unsigned char *)x, FALSE, out);
+        case DFNT_INT8:
+            return fmtsigned((long)*(const signed char *)x, out);
+        case DFNT_UINT16:
+            memcpy(&u16, x, sizeof(uint16));
+            return fmtdecimal((unsigned long)u16, FALSE, out);
+        case DFNT_INT16:
+            memcpy(&i16, x, sizeof(int16));
+            return fmtsigned((long)i16, out);
+        case DFNT_UINT32:
+            memcpy(&u32, x, sizeof(uint32));
+            return fmtdecimal((unsigned long)u32, FALSE, out);
+        case DFNT_INT32:
+            memcpy(&i32, x, sizeof(int32));
+            return fmtsigned((long)i32, out);
+        case DFNT_FLOAT32:
+            memcpy(&f32, x, sizeof(float32));
+            if (fabsf(f32 - FILL_FLOAT) <= FLOAT32_EPSILON)
+                return snprintf(out, DUMP_ITEM_MAX, "FloatInf");
+            return snprintf(out, DUMP_ITEM_MAX, "%f", (double)f32);
+        case DFNT_FLOAT64:
+            memcpy(&f64, x, sizeof(float64));
+            if (fabs(f64 - FILL_DOUBLE) <= FLOAT64_EPSILON)
+                return snprintf(out, DUMP_ITEM_MAX, "DoubleInf");
+            return snprintf(out, DUMP_ITEM_MAX, "%f", f64);
+        default: /* as fmtchar() */
+            if (isprint(*(const unsigned char *)x)) {
+                out[0] = *(const char *)x;
+                return 1;
+            }
+            return snprintf(out, DUMP_ITEM_MAX, "\\%03o", *(const uchar8 *)x);
+    }
+}
+
 intn
 dumpfull(int32 nt, dump_info_t *dump_opts, int32 cnt, /* number of items in 'databuf' ? */
          void *databuf, FILE *ofp, intn indent,       /* indentation on the first line */
@@ -302,23 +386,36 @@ dumpfull(int32 nt, dump_info_t *dump_opts, int32 cnt, /* number of items in 'dat
             putc(' ', ofp);
 
         if (nt != DFNT_CHAR) {
+            char *obuf = (char *)malloc(DUMP_OBUF_SIZE);
+            intn  olen = 0, len;
+
+            CHECK_ALLOC(obuf, "obuf", "dumpfull");
             for (i = 0; i < cnt && bufptr != NULL; i++) {
-                cn += fmtfunct(bufptr, ff, ofp); /* dump item to file */
-                bufptr = (char *)bufptr + off;
-                putc(' ', ofp);
+                /* make room for the item and a continuation line */
+                if (olen > DUMP_OBUF_SIZE - DUMP_ITEM_MAX - cont_indent - 2) {
+                    fwrite(obuf, 1, (size_t)olen, ofp);
+                    olen = 0;
+                }
+                len = fmtascii(nt, bufptr, obuf + olen); /* dump item to buffer */
+                olen += len;
+                cn += len;
+                bufptr       = (char *)bufptr + off;
+                obuf[olen++] = ' ';
                 cn++;
 
                 /* temporary fix bad alignment algo in dumpfull by
                    adding i < cnt-1 to remove extra line - BMR 4/10/99 */
                 if (!dump_opts->as_stream) /* add \n after MAXPERLINE chars */
                     if (cn > MAXPERLINE && i < cnt - 1) {
-                        putc('\n', ofp);
+                        obuf[olen++] = '\n';
 
                         /* print spaces in front of data on the continuous line */
                         for (cn = 0; cn < cont_indent; cn++)
-                            putc(' ', ofp);
+                            obuf[olen++] = ' ';
                     } /* end if */
             }         /* end for every item in buffer */
+            fwrite(obuf, 1, (size_t)olen, ofp);
+            free(obuf);
         }
         else /* DFNT_CHAR */
         {
@@ -0,0 +1,470 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* hdp layout: reports how the data of the SDSs and vdatas in a file are laid
+   out on disk, so that the cost of reading them can be judged.  The seek
+   estimate counts the data blocks that do not start where the previous
+   block of the same object ended, reading the object front to back (chunks
+   in row-major order of their coordinates). */
+
+#include "mfhdf.h"
+#include "hdp.h"
+
+#define LAYOUT_NBUCKETS 32 /* power-of-two buckets of the chunk size histogram */
+
+/* Data blocks of one object, or of the whole file, in reading order */
+typedef struct {
+    int32 nblocks;  /* number of data blocks */
+    int32 nseeks;   /* blocks not starting where the previous block ended */
+    int32 nbytes;   /* bytes stored in the blocks */
+    int32 next_off; /* offset just past the previous block */
+} layout_run_t;
+
+static void
+layout_usage(intn argc, char *argv[])
+{
+    (void)argc;
+
+    printf("Usage:\n");
+    printf("%s layout [-l] <filelist>\n", argv[0]);
+    printf("\t-l\tAlso print the offset, length and compression ratio of each chunk\n");
+    printf("\t<filelist>\tList of hdf file names, separated by spaces\n");
+} /* end layout_usage() */
+
+/* Returns the number of options parsed or FAIL */
+static intn
+parse_layout_opts(intn *chunk_detail, intn curr_arg, intn argc, char *argv[])
+{
+    intn ret = 0;
+
+    for (; curr_arg < argc; curr_arg++) {
+/* Allows '/' for options on Windows */
+#ifdef H4_HAVE_WIN32_API
+        if (argv[curr_arg][0] == '-' || argv[curr_arg][0] == '/')
+#else
+        if (argv[curr_arg][0] == '-')
+#endif
+        {
+            ret++;
+            switch (argv[curr_arg][1]) {
+                case 'l': /* print every chunk */
+                    *chunk_detail = TRUE;
+                    break;
+
+                default: /* unknown option */
+                    printf("ERROR: Unknown option: %s\n", argv[curr_arg]);
+                    return FAIL;
+            } /* end switch */
+        }     /* end if */
+        else
+            break; /* the file names start here */
+    }          /* end for */
+    return ret;
+} /* end parse_layout_opts() */
+
+/* Adds a data block to a run, counting a seek when it is not adjacent to
+   the previous one */
+static void
+layout_add_block(layout_run_t *run, int32 offset, int32 length)
+{
+    if (run->nblocks == 0 || offset != run->next_off)
+        run->nseeks++;
+    run->nblocks++;
+    run->nbytes += length;
+    run->next_off = offset + length;
+} /* end layout_add_block() */
+
+/* Adds the blocks and seeks of an object to the file totals */
+static void
+layout_add_run(layout_run_t *total, const layout_run_t *run)
+{
+    total->nblocks += run->nblocks;
+    total->nseeks += run->nseeks;
+    total->nbytes += run->nbytes;
+} /* end layout_add_run() */
+
+static void
+print_layout_run(const layout_run_t *run)
+{
+    printf("    Data blocks: %d, estimated seeks for a full read: %d\n", (int)run->nblocks, (int)run->nseeks);
+} /* end print_layout_run() */
+
+/* Prints the number of DD blocks and how full they are; each DD block is a
+   separate read when the file is opened */
+static intn
+print_dd_blocks(int32 fid)
+{
+    filerec_t *file_rec;
+    ddblock_t *block;
+    int32      nblocks = 0, ndds = 0, nempty = 0;
+    intn       i;
+    intn       ret_value = SUCCEED;
+
+    if ((file_rec = HAatom_object(fid)) == NULL)
+        ERROR_GOTO_0("in print_dd_blocks: invalid file id");
+
+    for (block = file_rec->ddhead; block != NULL; block = block->next) {
+        nblocks++;
+        ndds += block->ndds;
+        for (i = 0; i < block->ndds; i++)
+            if (block->ddlist[i].tag == DFTAG_NULL)
+                nempty++;
+    }
+    printf("DD blocks: %d, DDs: %d, empty DDs: %d\n", (int)nblocks, (int)ndds, (int)nempty);
+
+done:
+    return ret_value;
+} /* end print_dd_blocks() */
+
+/* Prints the chunk statistics of a chunked SDS and adds its chunks to run */
+static intn
+print_chunk_layout(int32 sds_id, int32 rank, int32 *dimsizes, int32 nt, HDF_CHUNK_DEF *cdef,
+                   intn chunk_detail, layout_run_t *run)
+{
+    int32  nchunks[H4_MAX_VAR_DIMS]; /* number of chunks along each dimension */
+    int32  coord[H4_MAX_VAR_DIMS];   /* coordinates of the current chunk */
+    int32  buckets[LAYOUT_NBUCKETS]; /* histogram of the stored chunk sizes */
+    int32  raw_size;                 /* uncompressed size of a chunk */
+    int32  total = 1, nwritten = 0, nordered = 0;
+    int32  offset, length, min_len = 0, max_len = 0, prev_off = 0;
+    double ratio, min_ratio = 0.0, max_ratio = 0.0;
+    intn   i, k, count;
+    intn   ret_value = SUCCEED;
+
+    raw_size = DFKNTsize(nt);
+    for (i = 0; i < rank; i++) {
+        raw_size *= cdef->chunk_lengths[i];
+        nchunks[i] = (dimsizes[i] + cdef->chunk_lengths[i] - 1) / cdef->chunk_lengths[i];
+        total *= nchunks[i];
+        coord[i] = 0;
+    }
+    memset(buckets, 0, sizeof(buckets));
+
+    printf("    Chunk: ");
+    for (i = 0; i < rank; i++)
+        printf("%s%d", i ? " x " : "", (int)cdef->chunk_lengths[i]);
+    printf(", chunks: ");
+    for (i = 0; i < rank; i++)
+        printf("%s%d", i ? " x " : "", (int)nchunks[i]);
+    printf("\n");
+
+    /* Visit the chunks in row-major order, the order of a full read */
+    while (total > 0) {
+        if ((count = SDgetdatainfo(sds_id, coord, 0, 1, &offset, &length)) == FAIL)
+            ERROR_GOTO_0("in print_chunk_layout: SDgetdatainfo failed");
+
+        if (count > 0) {
+            ratio = (length > 0) ? (double)raw_size / (double)length : 0.0;
+            if (nwritten == 0) {
+                min_len = max_len = length;
+                min_ratio = max_ratio = ratio;
+            }
+            else {
+                if (offset > prev_off)
+                    nordered++;
+                if (length < min_len)
+                    min_len = length;
+                if (length > max_len)
+                    max_len = length;
+                if (ratio < min_ratio)
+                    min_ratio = ratio;
+                if (ratio > max_ratio)
+                    max_ratio = ratio;
+            }
+            for (k = 0; k < LAYOUT_NBUCKETS - 1 && ((int32)1 << k) < length; k++)
+                ;
+            buckets[k]++;
+            prev_off = offset;
+            nwritten++;
+            layout_add_block(run, offset, length);
+
+            if (chunk_detail) {
+                printf("        chunk (");
+                for (i = 0; i < rank; i++)
+                    printf("%s%d", i ? "," : "", (int)coord[i]);
+                printf("): offset %d, length %d, ratio %.2f\n", (int)offset, (int)length, ratio);
+            }
+        }
+
+        /* Advance to the next chunk, the last dimension varying fastest */
+        for (i = rank - 1; i >= 0; i--) {
+            if (++coord[i] < nchunks[i])
+                break;
+            coord[i] = 0;
+        }
+        if (i < 0)
+            break;
+    }
+
+    printf("    Chunks written: %d of %d\n", (int)nwritten, (int)total);
+    if (nwritten > 0) {
+        printf("    Chunk sizes: min %d, mean %.2f, max %d bytes\n", (int)min_len,
+               (double)run->nbytes / (double)nwritten, (int)max_len);
+        for (k = 0; k < LAYOUT_NBUCKETS; k++)
+            if (buckets[k] > 0)
+                printf("        <= %u bytes: %d\n", (unsigned)1 << k, (int)buckets[k]);
+        printf("    Chunk compression ratio: min %.2f, mean %.2f, max %.2f\n", min_ratio,
+               (double)raw_size * nwritten / (double)run->nbytes, max_ratio);
+        printf("    Physical order: %d of %d chunks stored after their logical predecessor\n", (int)nordered,
+               (int)(nwritten - 1));
+    }
+
+done:
+    return ret_value;
+} /* end print_chunk_layout() */
+
+/* Prints the storage layout of an SDS and adds its data blocks to total */
+static intn
+print_sds_layout(int32 sd_id, int32 sds_index, intn chunk_detail, layout_run_t *total)
+{
+    int32         sds_id = FAIL;
+    char          name[H4_MAX_NC_NAME];
+    int32         rank, nt, nattrs;
+    int32         dimsizes[H4_MAX_VAR_DIMS];
+    int32         flags, comp_size = 0, orig_size = 0;
+    int32        *offsets = NULL, *lengths = NULL;
+    HDF_CHUNK_DEF cdef;
+    comp_coder_t  comp_type = COMP_CODE_NONE;
+    comp_info     c_info;
+    layout_run_t  run;
+    intn          i, count;
+    intn          ret_value = SUCCEED;
+
+    memset(&run, 0, sizeof(run));
+
+    if ((sds_id = SDselect(sd_id, sds_index)) == FAIL)
+        ERROR_GOTO_2("in %s: SDselect failed for %d'th SDS", "print_sds_layout", (int)sds_index);
+
+    /* Dimension scales are listed with their dimensions, not here */
+    if (SDiscoordvar(sds_id))
+        goto done;
+
+    if (SDgetinfo(sds_id, name, &rank, dimsizes, &nt, &nattrs) == FAIL)
+        ERROR_GOTO_2("in %s: SDgetinfo failed for %d'th SDS", "print_sds_layout", (int)sds_index);
+    if (SDgetchunkinfo(sds_id, &cdef, &flags) == FAIL)
+        ERROR_GOTO_2("in %s: SDgetchunkinfo failed for %d'th SDS", "print_sds_layout", (int)sds_index);
+    memset(&c_info, 0, sizeof(c_info));
+    if (SDgetcompinfo(sds_id, &comp_type, &c_info) == FAIL)
+        comp_type = COMP_CODE_NONE;
+
+    printf("\nSDS %d \"%s\": ", (int)sds_index, name);
+    for (i = 0; i < rank; i++)
+        printf("%s%d", i ? " x " : "", (int)dimsizes[i]);
+    printf("\n");
+
+    if (flags & HDF_CHUNK) {
+        printf("    Storage: chunked");
+        if (comp_type != COMP_CODE_NONE)
+            printf(" (%s)", comp_method_txt(comp_type));
+        printf("\n");
+        if (FAIL == print_chunk_layout(sds_id, rank, dimsizes, nt, &cdef, chunk_detail, &run))
+            ERROR_GOTO_2("in %s: failed to get the chunks of %d'th SDS", "print_sds_layout", (int)sds_index);
+    }
+    else {
+        if ((count = SDgetdatainfo(sds_id, NULL, 0, 0, NULL, NULL)) == FAIL)
+            ERROR_GOTO_2("in %s: SDgetdatainfo failed for %d'th SDS", "print_sds_layout", (int)sds_index);
+        if (count > 0) {
+            if ((offsets = (int32 *)malloc(count * sizeof(int32))) == NULL ||
+                (lengths = (int32 *)malloc(count * sizeof(int32))) == NULL)
+                ERROR_GOTO_0("in print_sds_layout: not enough memory");
+            if (SDgetdatainfo(sds_id, NULL, 0, count, offsets, lengths) == FAIL)
+                ERROR_GOTO_2("in %s: SDgetdatainfo failed for %d'th SDS", "print_sds_layout",
+                             (int)sds_index);
+            for (i = 0; i < count; i++)
+                layout_add_block(&run, offsets[i], lengths[i]);
+        }
+
+        if (count == 0)
+            printf("    Storage: no data written\n");
+        else if (comp_type != COMP_CODE_NONE)
+            printf("    Storage: compressed (%s)\n", comp_method_txt(comp_type));
+        else if (count > 1)
+            printf("    Storage: linked blocks\n");
+        else
+            printf("    Storage: contiguous\n");
+    }
+
+    if (SDgetdatasize(sds_id, &comp_size, &orig_size) != FAIL && comp_size > 0)
+        printf("    Size: stored %d bytes, raw %d bytes, ratio %.2f\n", (int)comp_size, (int)orig_size,
+               (double)orig_size / (double)comp_size);
+    print_layout_run(&run);
+    layout_add_run(total, &run);
+
+done:
+    if (sds_id != FAIL)
+        SDendaccess(sds_id);
+    free(offsets);
+    free(lengths);
+
+    return ret_value;
+} /* end print_sds_layout() */
+
+/* Prints the storage layout of the vdatas created by the application
+   (attributes and other library-internal vdatas are skipped) and adds their
+   data blocks to total */
+static intn
+print_vd_layout(int32 fid, layout_run_t *total)
+{
+    int32        vd_ref = -1, vd_id = FAIL, nrecs;
+    int32       *offsets = NULL, *lengths = NULL;
+    char         name[VSNAMELENMAX + 1], vsclass[VSNAMELENMAX + 1];
+    layout_run_t run;
+    intn         i, count;
+    intn         ret_value = SUCCEED;
+
+    while ((vd_ref = VSgetid(fid, vd_ref)) != FAIL) {
+        if ((vd_id = VSattach(fid, vd_ref, "r")) == FAIL)
+            ERROR_GOTO_2("in %s: VSattach failed for vdata with ref#=%d", "print_vd_layout", (int)vd_ref);
+        if (VSgetclass(vd_id, vsclass) == FAIL || VSgetname(vd_id, name) == FAIL)
+            ERROR_GOTO_2("in %s: failed to get the name of vdata with ref#=%d", "print_vd_layout",
+                         (int)vd_ref);
+
+        if (!VSisinternal(vsclass)) {
+            memset(&run, 0, sizeof(run));
+            if ((nrecs = VSelts(vd_id)) == FAIL)
+                ERROR_GOTO_2("in %s: VSelts failed for vdata with ref#=%d", "print_vd_layout", (int)vd_ref);
+            if ((count = VSgetdatainfo(vd_id, 0, 0, NULL, NULL)) == FAIL)
+                ERROR_GOTO_2("in %s: VSgetdatainfo failed for vdata with ref#=%d", "print_vd_layout",
+                             (int)vd_ref);
+            if (count > 0) {
+                if ((offsets = (int32 *)malloc(count * sizeof(int32))) == NULL ||
+                    (lengths = (int32 *)malloc(count * sizeof(int32))) == NULL)
+                    ERROR_GOTO_0("in print_vd_layout: not enough memory");
+                if (VSgetdatainfo(vd_id, 0, count, offsets, lengths) == FAIL)
+                    ERROR_GOTO_2("in %s: VSgetdatainfo failed for vdata with ref#=%d", "print_vd_layout",
+                                 (int)vd_ref);
+                for (i = 0; i < count; i++)
+                    layout_add_block(&run, offsets[i], lengths[i]);
+                free(offsets);
+                free(lengths);
+                offsets = lengths = NULL;
+            }
+
+            printf("\nVdata ref %d \"%s\": %d records\n", (int)vd_ref, name, (int)nrecs);
+            printf("    Size: stored %d bytes\n", (int)run.nbytes);
+            print_layout_run(&run);
+            layout_add_run(total, &run);
+        }
+
+        if (VSdetach(vd_id) == FAIL)
+            ERROR_GOTO_2("in %s: VSdetach failed for vdata with ref#=%d", "print_vd_layout", (int)vd_ref);
+        vd_id = FAIL;
+    }
+
+done:
+    if (vd_id != FAIL)
+        VSdetach(vd_id);
+    free(offsets);
+    free(lengths);
+
+    return ret_value;
+} /* end print_vd_layout() */
+
+intn
+do_layout(intn curr_arg, intn argc, char *argv[], intn help)
+{
+    filelist_t  *f_list       = NULL;  /* list of files to report */
+    char        *f_name       = NULL;  /* current file name */
+    int32        fid          = FAIL;  /* HDF file ID */
+    int32        sd_id        = FAIL;  /* SD interface ID */
+    int32        n_datasets   = 0;     /* number of SDSs in the file */
+    int32        n_file_attrs = 0;     /* number of file attributes */
+    int32        sds_index;            /* index of the current SDS */
+    intn         chunk_detail = FALSE; /* print every chunk */
+    intn         status;
+    layout_run_t total;
+    intn         ret_value = SUCCEED;
+
+    if (help == TRUE) {
+        layout_usage(argc, argv);
+        goto done;
+    }
+
+    /* Incomplete command */
+    if (curr_arg >= argc) {
+        layout_usage(argc, argv);
+        ret_value = FAIL; /* So caller can be traced in debugging */
+        goto done;
+    }
+
+    if ((status = parse_layout_opts(&chunk_detail, curr_arg, argc, argv)) == FAIL) {
+        layout_usage(argc, argv);
+        ret_value = FAIL;
+        goto done;
+    }
+
+    curr_arg += status;
+    if (curr_arg >= argc || (f_list = make_file_list(curr_arg, argc, argv)) == NULL) {
+        fprintf(stderr, "ERROR: No files to dump!\n");
+        layout_usage(argc, argv);
+        ret_value = FAIL;
+        goto done;
+    }
+
+    /* Process each file */
+    f_name = get_next_file(f_list, 0);
+    while (f_name != NULL) {
+        memset(&total, 0, sizeof(total));
+
+        if ((fid = Hopen(f_name, DFACC_READ, 0)) == FAIL)
+            ERROR_GOTO_1("in do_layout: Hopen failed - possible invalid file name: %s", f_name);
+        if (Vstart(fid) == FAIL)
+            ERROR_GOTO_1("do_layout: Vstart failed for file %s", f_name);
+        if ((sd_id = SDstart(f_name, DFACC_READ)) == FAIL)
+            ERROR_GOTO_1("do_layout: SDstart failed for file %s", f_name);
+
+        printf("File: %s\n", f_name);
+        if (FAIL == print_dd_blocks(fid))
+            ERROR_GOTO_0("in do_layout\n");
+
+        if (SDfileinfo(sd_id, &n_datasets, &n_file_attrs) == FAIL)
+            ERROR_GOTO_1("do_layout: SDfileinfo failed for file %s", f_name);
+        for (sds_index = 0; sds_index < n_datasets; sds_index++)
+            if (FAIL == print_sds_layout(sd_id, sds_index, chunk_detail, &total))
+                ERROR_GOTO_0("in do_layout\n");
+
+        if (FAIL == print_vd_layout(fid, &total))
+            ERROR_GOTO_0("in do_layout\n");
+
+        printf("\nTotal: %d data blocks, %d bytes, estimated seeks for a full read: %d\n", (int)total.nblocks,
+               (int)total.nbytes, (int)total.nseeks);
+
+        if (SDend(sd_id) == FAIL)
+            ERROR_GOTO_1("do_layout: SDend failed for file %s", f_name);
+        sd_id = FAIL;
+        if (Vend(fid) == FAIL)
+            ERROR_GOTO_1("do_layout: Vend failed for file %s", f_name);
+        if (Hclose(fid) == FAIL)
+            ERROR_GOTO_1("do_layout: Hclose failed for file %s", f_name);
+        fid = FAIL;
+
+        /* get next file to process */
+        f_name = get_next_file(f_list, 1);
+        if (f_name != NULL)
+            printf("\n");
+    } /* end while processing files */
+
+done:
+    if (ret_value == FAIL) { /* Failure cleanup */
+        if (sd_id != FAIL)
+            SDend(sd_id);
+        if (fid != FAIL) {
+            Vend(fid);
+            Hclose(fid);
+        }
+    }
+    if (f_list != NULL)
+        free_file_list(f_list);
+
+    return ret_value;
+} /* end do_layout() */
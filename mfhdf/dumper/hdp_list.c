@@ -35,7 +35,7 @@ list_usage(intn argc, char *argv[])
     (void)argc;
 
     printf("Usage:\n");
-    printf("%s list [-acensldg] [-o<f|g|t|n>] [-t tag] <filelist>\n", argv[0]);
+    printf("%s list [-acensldgq] [-o<f|g|t|n>] [-t tag] <filelist>\n", argv[0]);
     printf("\t-a\tPrint annotations of items (sets long output)\n");
     printf("\t-c\tPrint classes of items (sets long output)\n");
     printf("\t-n\tPrint names or labels of items (sets long output)\n");
@@ -44,6 +44,7 @@ list_usage(intn argc, char *argv[])
     printf("\t-l\tLong output\n");
     printf("\t-d\tDebugging output\n");
     printf("\t-g\tPrint groups only\n");
+    printf("\t-q\tPrint the tag names and the number of items of each only\n");
     printf("\t-t <number>\tPrint items of with a given tag number\n");
     printf("\t-t <name>\tPrint items of with a given tag name\n");
     printf("\t-of\tPrint items in the order found in the file\n");
@@ -118,6 +119,10 @@ parse_list_opts(list_info_t *list_opts, intn curr_arg, intn argc, char *argv[])
                     list_opts->verbosity = VDEBUG; /* verbosity is debug */
                     break;
 
+                case 'q':                         /* tag names only */
+                    list_opts->verbosity = VTAGS; /* verbosity is tag names */
+                    break;
+
                 case 'g':                    /* print only groups */
                     list_opts->group = TRUE; /* dump group info */
                     if (list_opts->verbosity == VSHORT)
@@ -178,6 +183,7 @@ print_list_header(list_info_t *list_opts)
 {
     switch (list_opts->verbosity) {
         case VSHORT: /* short output */
+        case VTAGS:  /* tag names output */
             /* no header */
             break;
 
@@ -760,6 +766,7 @@ print_list_obj(const char *fname, list_info_t *l_opts, objinfo_t *o_info, intn o
 
     switch (l_opts->verbosity) {
         case VSHORT: /* short output */
+        case VTAGS:  /* tag names output */
             /* handled elsewhere */
             break;
 
@@ -924,7 +931,7 @@ do_list(intn curr_arg, intn argc, char *argv[], intn help)
     /* Process each file */
     f_name = get_next_file(f_list, 0);
     while (f_name != NULL) {
-        int label_flag, desc_flag;
+        int label_flag, desc_flag, group_flag, spec_flag;
         vinit_done = FALSE; /* Reset global Vset variable */
         obj_num    = 0;     /* Number of the object we are displaying */
         fid        = FAIL;
@@ -935,14 +942,19 @@ do_list(intn curr_arg, intn argc, char *argv[], intn help)
             if (FAIL == an_id)
                 ERROR_GOTO_1("do_list: ANstart failed for file %s \n", f_name);
 
-            label_flag = desc_flag = 0;
+            label_flag = desc_flag = group_flag = spec_flag = 0;
             if (list_opts.name == TRUE)
                 label_flag = CHECK_LABEL;
             if (list_opts.desc == TRUE)
                 desc_flag = CHECK_DESC;
+            if (list_opts.group == TRUE)
+                group_flag = CHECK_GROUP;
+            if (list_opts.spec == TRUE || list_opts.verbosity == VDEBUG)
+                spec_flag = CHECK_SPECIAL; /* also for the offsets and lengths of their data */
 
-            /* make list of all objects in file */
-            o_list = make_obj_list(fid, label_flag | desc_flag | CHECK_GROUP | CHECK_SPECIAL);
+            /* make list of all objects in file, reading the groups and
+               opening the special elements only if they are printed */
+            o_list = make_obj_list(fid, label_flag | desc_flag | group_flag | spec_flag);
 
             /* if there are any object in the file, print annotations if
                requested, then the object information as requested */
@@ -967,8 +979,36 @@ do_list(intn curr_arg, intn argc, char *argv[], intn help)
                 /* print out list header according to options */
                 print_list_header(&list_opts);
 
+                /* Special case for tag names output */
+                if (list_opts.verbosity == VTAGS) {
+                    o_info = get_next_obj(o_list, 0); /* get first DD object */
+                    while (o_info != NULL) {
+                        uint16 tag   = o_info->tag;
+                        intn   count = 0;
+
+                        /* count the objects of this tag */
+                        while (o_info != NULL && o_info->tag == tag) {
+                            if ((list_opts.limit == LGROUP || list_opts.limit == LNONE) ||
+                                list_opts.limit_tag == tag)
+                                count++;
+                            o_info = get_next_obj(o_list, 1); /* advance to next DD object */
+                        }
+
+                        if (count > 0) {
+                            s = HDgettagsname(tag);
+                            if (s == NULL)
+                                s = strdup("Unknown");
+
+                            printf("%-*s: (tag %d) %d item%s\n", TAGNAME_FIELD_WIDTH, s, tag, count,
+                                   count == 1 ? "" : "s");
+                            free(s);  /* free tagname string */
+                            s = NULL; /* reset */
+                        }
+                    } /* end while o_info */
+                }     /* end if verbosity */
+
                 /* Special case for short output */
-                if (list_opts.verbosity == VSHORT) {
+                else if (list_opts.verbosity == VSHORT) {
                     uint16 last_tag = 0;
 
                     o_info = get_next_obj(o_list, 0); /* get first DD object */
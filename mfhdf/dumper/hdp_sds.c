@@ -184,6 +184,8 @@ sdsdumpfull(int32 sds_id, dump_info_t *dumpsds_opts, int32 rank, int32 dimsizes[
     int32         numtype;
     int32         eltsz;
     int32         read_nelts; /* number of elements in one row */
+    int32         read_nrows; /* number of rows read at once */
+    int32         r;
     int32         done;       /* number of rows we have done */
     int32        *left     = NULL;
     int32        *start    = NULL;
@@ -208,7 +210,18 @@ sdsdumpfull(int32 sds_id, dump_info_t *dumpsds_opts, int32 rank, int32 dimsizes[
     CHECK_POS(eltsz, "eltsz", "sdsdumpfull");
     CHECK_POS(rank, "rank", "sdsdumpfull");
 
-    buf = (void *)malloc(read_nelts * eltsz);
+    /* read as many rows at once as fit in DUMP_READ_SIZE bytes; they are
+       still dumped a row at a time */
+    read_nrows = 1;
+    if (rank > 1) {
+        read_nrows = DUMP_READ_SIZE / (read_nelts * eltsz);
+        if (read_nrows > dimsizes[rank - 2])
+            read_nrows = dimsizes[rank - 2];
+        if (read_nrows < 1)
+            read_nrows = 1;
+    }
+
+    buf = (void *)malloc((size_t)read_nrows * read_nelts * eltsz);
     CHECK_ALLOC(buf, "buf", "sdsdumpfull");
 
     left = (int32 *)malloc(rank * sizeof(int32));
@@ -282,6 +295,7 @@ sdsdumpfull(int32 sds_id, dump_info_t *dumpsds_opts, int32 rank, int32 dimsizes[
         /* In each iteration, a row in dumped and "left[]" is modified
           accordingly(?) */
         while (!done) {
+            edge[rank - 2] = left[rank - 2] < read_nrows ? left[rank - 2] : read_nrows;
             if (FAIL == SDreaddata(sds_id, start, NULL, edge, buf)) {
                 /* If the data set has external element, get the external file
                    name to provide information */
@@ -302,14 +316,19 @@ sdsdumpfull(int32 sds_id, dump_info_t *dumpsds_opts, int32 rank, int32 dimsizes[
                     ERROR_GOTO_2("in %s: SDreaddata failed for sds_id(%d)", "sdsdumpfull", (int)sds_id);
             }
 
-            /* if printing data only, print with no indentation */
-            if (dumpsds_opts->contents == DDATA)
-                status = dumpfull(numtype, dumpsds_opts, read_nelts, buf, fp, 0, 0);
-            else
-                status = dumpfull(numtype, dumpsds_opts, read_nelts, buf, fp, DATA_INDENT, DATA_CONT_INDENT);
+            for (r = 0; r < edge[rank - 2]; r++) {
+                void *row = (char *)buf + (size_t)r * read_nelts * eltsz;
 
-            if (FAIL == status)
-                ERROR_GOTO_2("in %s: dumpfull failed for sds_id(%d)", "sdsdumpfull", (int)sds_id);
+                /* if printing data only, print with no indentation */
+                if (dumpsds_opts->contents == DDATA)
+                    status = dumpfull(numtype, dumpsds_opts, read_nelts, row, fp, 0, 0);
+                else
+                    status =
+                        dumpfull(numtype, dumpsds_opts, read_nelts, row, fp, DATA_INDENT, DATA_CONT_INDENT);
+
+                if (FAIL == status)
+                    ERROR_GOTO_2("in %s: dumpfull failed for sds_id(%d)", "sdsdumpfull", (int)sds_id);
+            }
 
             /* Modify the values for "start[]" and "left[]" that are to be used
                for dumping the next row. */
@@ -320,13 +339,17 @@ sdsdumpfull(int32 sds_id, dump_info_t *dumpsds_opts, int32 rank, int32 dimsizes[
                which is read in each time, and so we don't have to compute
                the "start" of it. */
 
+            /* The rows just dumped count as edge[rank-2] steps in dimension
+               rank-2; the other dimensions move one step at a time. */
+
             for (j = rank - 2; j >= 0; j--) { /* Examine each dimension. */
-                if (--left[j] > 0) {          /* Proceed in the same dimension; as long as there are
+                left[j] -= edge[j];
+                if (left[j] > 0) {            /* Proceed in the same dimension; as long as there are
                                               elements in this dimension, this loop breaks here after the
                                               last element in the current dimension has been subtracted,
                                               we subtract one for the next lower dimension and reset
                                               "left[j]" to be the size of dimension j. */
-                    start[j]++;
+                    start[j] += edge[j];
                     break;
                 }
                 else { /* Nothing left in the current dimension.  So, subtract one
@@ -738,6 +761,16 @@ print_comp_info(FILE *fp, int32 sds_id, comp_coder_t *comp_type)
             case COMP_CODE_DEFLATE:
                 fprintf(fp, "\t\t Deflate level = %d\n", c_info.deflate.level);
                 break;
+            case COMP_CODE_ZSTD:
+                fprintf(fp, "\t\t Zstd level = %d\n", c_info.zstd.level);
+                break;
+            case COMP_CODE_LZ4:
+                fprintf(fp, "\t\t LZ4 acceleration = %d\n", c_info.lz4.acceleration);
+                break;
+            case COMP_CODE_LOSSY:
+                fprintf(fp, "\t\t Error bound = %g (%s)\n", c_info.lossy.tolerance,
+                        c_info.lossy.mode == H4_LOSSY_REL ? "relative" : "absolute");
+                break;
             case COMP_CODE_SZIP: {
                 char mask_strg[160]; /* 160 is to cover all options and number val*/
                 if (option_mask_string(c_info.szip.options_mask, mask_strg) != FAIL)
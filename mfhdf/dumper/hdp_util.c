@@ -384,22 +384,37 @@ make_obj_list(int32 fid, uint32 options)
     memset(obj_ret->raw_obj_arr, 0, sizeof(objinfo_t) * nobj);
 
     /*
-     * Read all the tag/ref's in the file into an array
+     * Read all the tag/ref's in the file into an array; unless special
+     * elements are looked for, they are taken from the DD list the library
+     * read in Hopen and no element is opened, the offsets and lengths of
+     * the special elements being those of their special headers
      */
-    /* start the reading of an access element */
-    aid = Hstartread(fid, DFTAG_WILDCARD, DFREF_WILDCARD);
-    if (aid == FAIL) {
-        HEprint(stderr, 0);
-        free(obj_ret->raw_obj_arr);
-        free(obj_ret);
-        return (NULL);
-    } /* end if */
+    if (!(options & CHECK_SPECIAL)) {
+        uint16 tag = 0, ref = 0; /* last DD found, none to start the search */
+
+        for (n = 0; n < nobj; n++) {
+            if (Hfind(fid, DFTAG_WILDCARD, DFREF_WILDCARD, &tag, &ref, &(obj_ret->raw_obj_arr[n].offset),
+                      &(obj_ret->raw_obj_arr[n].length), DF_FORWARD) == FAIL)
+                break;
+            obj_ret->raw_obj_arr[n].tag = tag;
+            obj_ret->raw_obj_arr[n].ref = ref;
+        } /* end for */
+    }     /* end if */
+    else {
+        /* start the reading of an access element */
+        aid = Hstartread(fid, DFTAG_WILDCARD, DFREF_WILDCARD);
+        if (aid == FAIL) {
+            HEprint(stderr, 0);
+            free(obj_ret->raw_obj_arr);
+            free(obj_ret);
+            return (NULL);
+        } /* end if */
 
-    /* for each element */
-    for (n = 0, status = SUCCEED; (n < nobj) && (status != FAIL); n++) {
-        Hinquire(aid, NULL, &(obj_ret->raw_obj_arr[n].tag), &(obj_ret->raw_obj_arr[n].ref),
-                 &(obj_ret->raw_obj_arr[n].length), &(obj_ret->raw_obj_arr[n].offset), NULL, NULL, &tmp_spec);
-        if (options & CHECK_SPECIAL) { /* are we looking for spec. elem. ? */
+        /* for each element */
+        for (n = 0, status = SUCCEED; (n < nobj) && (status != FAIL); n++) {
+            Hinquire(aid, NULL, &(obj_ret->raw_obj_arr[n].tag), &(obj_ret->raw_obj_arr[n].ref),
+                     &(obj_ret->raw_obj_arr[n].length), &(obj_ret->raw_obj_arr[n].offset), NULL, NULL,
+                     &tmp_spec);
             obj_ret->raw_obj_arr[n].is_special = (tmp_spec != 0);
             if (obj_ret->raw_obj_arr[n].is_special) { /* get the special info. */
                 if ((status = HDget_special_info(aid, &info)) == FAIL) {
@@ -415,16 +430,16 @@ make_obj_list(int32 fid, uint32 options)
                         memcpy(obj_ret->raw_obj_arr[n].spec_info, &info, sizeof(sp_info_block_t));
                 } /* end else */
             }     /* end if */
-        }         /* end if */
-        status = Hnextread(aid, DFTAG_WILDCARD, DFREF_WILDCARD, DF_CURRENT);
-    } /* end for */
+            status = Hnextread(aid, DFTAG_WILDCARD, DFREF_WILDCARD, DF_CURRENT);
+        } /* end for */
 
-    if (Hendaccess(aid) == FAIL) {
-        HEprint(stderr, 0);
-        free(obj_ret->raw_obj_arr);
-        free(obj_ret);
-        return (NULL);
-    }
+        if (Hendaccess(aid) == FAIL) {
+            HEprint(stderr, 0);
+            free(obj_ret->raw_obj_arr);
+            free(obj_ret);
+            return (NULL);
+        }
+    } /* end else */
 
     /* Post-process the list of dd/objects, adding more information */
     /*  Also set up the pointers for the sorted list to be manipulated later */
@@ -876,6 +891,12 @@ comp_method_txt(comp_coder_t comp_type)
             return ("JPEG");
         case COMP_CODE_IMCOMP:
             return ("IMCOMP");
+        case COMP_CODE_ZSTD:
+            return ("ZSTD");
+        case COMP_CODE_LZ4:
+            return ("LZ4");
+        case COMP_CODE_LOSSY:
+            return ("LOSSY");
         default:
             return ("INVALID");
     }
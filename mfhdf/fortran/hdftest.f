@@ -223,6 +223,35 @@ C     create a new file
 
       if(err.ne.0) print *, 'After ReadVerify err = ', err
 
+C     Read the same data with sfrslab, which takes the slab in C order
+      start(1)  = 1
+      start(2)  = 0
+      stride(1) = 1
+      stride(2) = 1
+      end(1)    = 1
+      end(2)    = 3
+      stat = sfrslab(sds1, start, stride, end, ivals)
+      if(stat.ne.0) then
+         print *, 'sfrslab returned', stat
+         err = err + 1
+      endif
+      if (ivals(1).ne.4 .or. ivals(2).ne.5 .or. ivals(3).ne.6) then
+         err = err + 1
+         print *, 'sfrslab: was expecting 4 5 6 got', (ivals(i), i=1,3)
+      endif
+
+      stride(2) = 2
+      end(2)    = 2
+      stat = sfrslab(sds1, start, stride, end, ivals)
+      if(stat.ne.0) then
+         print *, 'sfrslab with stride returned', stat
+         err = err + 1
+      endif
+      if (ivals(1).ne.4 .or. ivals(2).ne.6) then
+         err = err + 1
+         print *, 'sfrslab: was expecting 4 6 got', (ivals(i), i=1,2)
+      endif
+
       nt = DFNT_INT32
       stat = sfsnatt(sds2, 'TestAttr', nt, 3, ivals)
       if(stat.ne.0) then
@@ -689,13 +689,14 @@ FRETVAL(intf)
 nscginfo(intf *id, _fcd name, intf *rank, intf *dimsizes, intf *nt, intf *nattr, intf *len)
 {
     char *iname;
+    char  namebuf[H4_MAX_NC_NAME];
     int32 status;
     int32 cdims[100], i;
     int32 rank32, nt32, nattr32;
 
     iname = NULL;
     if (*len)
-        iname = (char *)malloc((uint32)*len + 1);
+        iname = *len < (intf)sizeof(namebuf) ? namebuf : (char *)malloc((uint32)*len + 1);
 
     status = SDgetinfo((int32)*id, iname, &rank32, cdims, &nt32, &nattr32);
 
@@ -704,7 +705,8 @@ nscginfo(intf *id, _fcd name, intf *rank, intf *dimsizes, intf *nt, intf *nattr,
 
     HDpackFstring(iname, _fcdtocp(name), *len);
 
-    free(iname);
+    if (iname != namebuf)
+        free(iname);
 
     *rank  = (intf)rank32;
     *nt    = (intf)nt32;
@@ -877,11 +879,13 @@ FRETVAL(intf)
 nscn2index(intf *id, _fcd name, intf *namelen)
 {
     char *fn;
+    char  namebuf[H4_MAX_NC_NAME];
     intf  ret;
 
-    fn  = HDf2cstring(name, *namelen);
+    fn  = HDf2cstring_buf(name, *namelen, namebuf, (intn)sizeof(namebuf));
     ret = (intf)SDnametoindex(*id, fn);
-    free(fn);
+    if (fn != namebuf)
+        free(fn);
     return (ret);
 }
 
@@ -901,22 +905,22 @@ nscn2index(intf *id, _fcd name, intf *namelen)
 FRETVAL(intf)
 nsccreate(intf *id, _fcd name, intf *nt, intf *rank, intf *dims, intf *namelen)
 {
-    char  *fn;
-    intf   ret;
-    int32 *cdims, i;
+    char *fn;
+    char  namebuf[H4_MAX_NC_NAME];
+    intf  ret;
+    int32 cdims[H4_MAX_VAR_DIMS], i;
 
-    fn    = HDf2cstring(name, *namelen);
-    cdims = (int32 *)malloc(sizeof(int32) * (*rank));
-    if (!cdims)
+    if (*rank < 0 || *rank > H4_MAX_VAR_DIMS)
         return FAIL;
 
     for (i = 0; i < *rank; i++)
         cdims[i] = dims[*rank - i - 1];
 
+    fn  = HDf2cstring_buf(name, *namelen, namebuf, (intn)sizeof(namebuf));
     ret = (intf)SDcreate(*id, fn, *nt, *rank, cdims);
 
-    free(fn);
-    free(cdims);
+    if (fn != namebuf)
+        free(fn);
     return (ret);
 }
 
@@ -971,15 +975,16 @@ FRETVAL(intf)
 nscsdimname(intf *id, _fcd name, intf *len)
 {
     char *nstr;
+    char  namebuf[H4_MAX_NC_NAME];
     intf  ret;
 
     if (len)
-        nstr = HDf2cstring(name, *len);
+        nstr = HDf2cstring_buf(name, *len, namebuf, (intn)sizeof(namebuf));
     else
         nstr = NULL;
 
     ret = (intf)SDsetdimname(*id, nstr);
-    if (len)
+    if (nstr != namebuf)
         free(nstr);
     return (ret);
 }
@@ -1151,6 +1156,45 @@ nsfwdata(intf *id, intf *start, intf *stride, intf *end, void *values)
     return (ret);
 }
 
+/*-----------------------------------------------------------------------------
+ * Name:    sfrslab
+ * Purpose: read a section of data, with the section given in C order
+ * Inputs:  id: dataset id
+ *          start: start location
+ *          stride: stride along each dimension
+ *          end: number of values along each dim to read
+ *          values: data
+ * Remarks: start, stride and end list the slowest-varying dimension
+ *          first, as SDreaddata does, so nothing needs to be flipped and
+ *          they are handed to SDreaddata as they are.  A stride of all
+ *          ones is read as if no stride had been given.
+ * Returns: 0 on success, -1 on failure with error set
+ *---------------------------------------------------------------------------*/
+FRETVAL(intf)
+nsfrslab(intf *id, intf *start, intf *stride, intf *end, void *values)
+{
+    return ((intf)SDreaddata(*id, (int32 *)start, (int32 *)stride, (int32 *)end, values));
+}
+
+/*-----------------------------------------------------------------------------
+ * Name:    sfwslab
+ * Purpose: write a section of data, with the section given in C order
+ * Inputs:  id: dataset id
+ *          start: start location
+ *          stride: stride along each dimension
+ *          end: number of values along each dim to write
+ *          values: data
+ * Remarks: start, stride and end list the slowest-varying dimension
+ *          first, as SDwritedata does, so nothing needs to be flipped and
+ *          they are handed to SDwritedata as they are.
+ * Returns: 0 on success, -1 on failure with error set
+ *---------------------------------------------------------------------------*/
+FRETVAL(intf)
+nsfwslab(intf *id, intf *start, intf *stride, intf *end, void *values)
+{
+    return ((intf)SDwritedata(*id, (int32 *)start, (int32 *)stride, (int32 *)end, values));
+}
+
 /*-----------------------------------------------------------------------------
  * Name:    scgdmstrs
  * Purpose: Return the "dimension strings"
@@ -1276,19 +1320,21 @@ FRETVAL(intf)
 nscgainfo(intf *id, intf *number, _fcd name, intf *nt, intf *count, intf *len)
 {
     char *iname;
+    char  namebuf[H4_MAX_NC_NAME];
     intn  status;
     int32 nt32;
     int32 cnt32;
 
     iname = NULL;
     if (*len)
-        iname = (char *)malloc((uint32)*len + 1);
+        iname = *len < (intf)sizeof(namebuf) ? namebuf : (char *)malloc((uint32)*len + 1);
 
     status = SDattrinfo(*id, *number, iname, &nt32, &cnt32);
 
     HDpackFstring(iname, _fcdtocp(name), *len);
 
-    free(iname);
+    if (iname != namebuf)
+        free(iname);
 
     *nt    = (intf)nt32;
     *count = (intf)cnt32;
@@ -1310,18 +1356,20 @@ FRETVAL(intf)
 nscgdinfo(intf *id, _fcd name, intf *sz, intf *nt, intf *nattr, intf *len)
 {
     char *iname;
+    char  namebuf[H4_MAX_NC_NAME];
     int32 status;
     int32 sz32, nt32, nattr32;
 
     iname = NULL;
     if (*len)
-        iname = (char *)malloc((uint32)*len + 1);
+        iname = *len < (intf)sizeof(namebuf) ? namebuf : (char *)malloc((uint32)*len + 1);
 
     status = SDdiminfo(*id, iname, &sz32, &nt32, &nattr32);
 
     HDpackFstring(iname, _fcdtocp(name), *len);
 
-    free(iname);
+    if (iname != namebuf)
+        free(iname);
 
     *nt    = (intf)nt32;
     *sz    = (intf)sz32;
@@ -1364,13 +1412,15 @@ FRETVAL(intf)
 nscsnatt(intf *id, _fcd name, intf *nt, intf *count, void *data, intf *len)
 {
     char *an;
+    char  namebuf[H4_MAX_NC_NAME];
     intf  ret;
 
-    an = HDf2cstring(name, *len);
+    an = HDf2cstring_buf(name, *len, namebuf, (intn)sizeof(namebuf));
 
     ret = (intf)SDsetattr(*id, an, *nt, *count, data);
 
-    free(an);
+    if (an != namebuf)
+        free(an);
     return (ret);
 }
 
@@ -1393,11 +1443,13 @@ FRETVAL(intf)
 nscsattr(intf *id, _fcd name, intf *nt, intf *count, void *data, intf *len)
 {
     char *an;
+    char  namebuf[H4_MAX_NC_NAME];
     intf  ret;
 
-    an  = HDf2cstring(name, *len);
+    an  = HDf2cstring_buf(name, *len, namebuf, (intn)sizeof(namebuf));
     ret = (intf)SDsetattr(*id, an, *nt, *count, data);
-    free(an);
+    if (an != namebuf)
+        free(an);
     return (ret);
 }
 
@@ -1412,12 +1464,14 @@ FRETVAL(intf)
 nscfattr(intf *id, _fcd name, intf *namelen)
 {
     char *fn;
+    char  namebuf[H4_MAX_NC_NAME];
     intf  ret;
 
-    fn = HDf2cstring(name, *namelen);
+    fn = HDf2cstring_buf(name, *namelen, namebuf, (intn)sizeof(namebuf));
 
     ret = (intf)SDfindattr(*id, fn);
-    free(fn);
+    if (fn != namebuf)
+        free(fn);
 
     return (ret);
 }
@@ -1666,15 +1720,14 @@ nscgichnk(intf *id, intf *dim_length, intf *flags)
  * Calls:    SDreadchunk
  * Remarks:  need to flip the dimensions to account for array ordering
  *           differences (start --> cstart)
- *           If performance becomes an issue, use static cstart
  * Returns:  0 on success, -1 on failure with error set
  *----------------------------------------------------------------------------*/
 FRETVAL(intf)
 nscrchnk(intf *id, intf *start, void *num_data)
 {
-    intf   ret;
-    int32  rank, status, i;
-    int32 *cstart;
+    intf  ret;
+    int32 rank, status, i;
+    int32 cstart[H4_MAX_VAR_DIMS];
 
     int32 cdims[100], nt32, nattr32;
     /* Get rank of SDS */
@@ -1683,13 +1736,6 @@ nscrchnk(intf *id, intf *start, void *num_data)
     if (status == FAIL)
         return FAIL;
 
-    /* Allocate memory for cstart array; use static array, if performance
-           becomes an issue */
-
-    cstart = (int32 *)malloc(sizeof(int32) * rank);
-    if (!cstart)
-        return FAIL;
-
     /* Flip an array to account for array ordering in Fortran and C */
 
     for (i = 0; i < rank; i++)
@@ -1698,10 +1744,6 @@ nscrchnk(intf *id, intf *start, void *num_data)
     /* Call SDreadChunk function to read the data */
 
     ret = SDreadchunk(*id, cstart, num_data);
-
-    /* Free memory */
-
-    free(cstart);
     return (ret);
 }
 
@@ -1870,15 +1912,14 @@ nscschnk(intf *id, intf *dim_length, intf *comp_type, intf *comp_prm)
  * Calls:    SDwritechunk
  * Remarks:  need to flip the dimensions to account for array ordering
  *           differences (start --> cstart)
- *           If performance becomes an issue, use static cstart
  * Returns:  0 on success, -1 on failure with error set
  *----------------------------------------------------------------------------*/
 FRETVAL(intf)
 nscwchnk(intf *id, intf *start, void *num_data)
 {
-    intf   ret;
-    int32  rank, status, i;
-    int32 *cstart;
+    intf  ret;
+    int32 rank, status, i;
+    int32 cstart[H4_MAX_VAR_DIMS];
 
     int32 cdims[100], nt32, nattr32;
     /* Get rank of SDS */
@@ -1887,13 +1928,6 @@ nscwchnk(intf *id, intf *start, void *num_data)
     if (status == FAIL)
         return FAIL;
 
-    /* Allocate memory for cstart array; use static array, if performance
-           becomes an issue */
-
-    cstart = (int32 *)malloc(sizeof(int32) * rank);
-    if (!cstart)
-        return FAIL;
-
     /* Flip an array */
 
     for (i = 0; i < rank; i++)
@@ -1903,10 +1937,6 @@ nscwchnk(intf *id, intf *start, void *num_data)
 
     ret = SDwritechunk(*id, cstart, num_data);
 
-    /* Free memory */
-
-    free(cstart);
-
     return (ret);
 }
 
@@ -56,6 +56,8 @@ extern "C" {
 #define nsfrdata         H4_F77_FUNC(sfrdata, SFRDATA)
 #define nsfwcdata        H4_F77_FUNC(sfwcdata, SFWCDATA)
 #define nsfwdata         H4_F77_FUNC(sfwdata, SFWDATA)
+#define nsfrslab         H4_F77_FUNC(sfrslab, SFRSLAB)
+#define nsfwslab         H4_F77_FUNC(sfwslab, SFWSLAB)
 #define nscgdatstrs      H4_F77_FUNC(scgdatstrs, SCGDATSTRS)
 #define nscgdimstrs      H4_F77_FUNC(scgdimstrs, SCGDIMSTRS)
 #define nscscatt         H4_F77_FUNC(scscatt, SCSCATT)
@@ -154,6 +156,8 @@ HDFFCLIBAPI FRETVAL(intf) nsfrnatt(intf *id, intf *index, void *buf);
 HDFFCLIBAPI FRETVAL(intf) nsfrattr(intf *id, intf *index, void *buf);
 HDFFCLIBAPI FRETVAL(intf) nsfrdata(intf *id, intf *start, intf *stride, intf *end, void *values);
 HDFFCLIBAPI FRETVAL(intf) nsfwdata(intf *id, intf *start, intf *stride, intf *end, void *values);
+HDFFCLIBAPI FRETVAL(intf) nsfrslab(intf *id, intf *start, intf *stride, intf *end, void *values);
+HDFFCLIBAPI FRETVAL(intf) nsfwslab(intf *id, intf *start, intf *stride, intf *end, void *values);
 HDFFCLIBAPI FRETVAL(intf) nsfrcdata(intf *id, intf *start, intf *stride, intf *end, _fcd values);
 HDFFCLIBAPI FRETVAL(intf) nsfwcdata(intf *id, intf *start, intf *stride, intf *end, _fcd values);
 HDFFCLIBAPI FRETVAL(intf) nsfid2ref(intf *id);
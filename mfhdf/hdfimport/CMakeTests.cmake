@@ -30,6 +30,7 @@ set (HDF4_LS_TEST_FILES
     cb64r3-n.tst
     ctxtr2_ris.tst
     cb64r2_ris.tst
+    cb32r3-c.tst
     SDSfloat2.tst
     SDSfloat3.tst
 )
@@ -100,6 +101,9 @@ macro (ADD_H4_TEST resultfile resultcode testtfile testtype)
     if (${testtype} STREQUAL "R")
       add_test (NAME HIMPORT-${testtfile} COMMAND ${CMAKE_CROSSCOMPILING_EMULATOR} $<TARGET_FILE:hdfimport${tgt_ext}> ${resultfile} -o ${testtfile}.hdf -raster ${ARGN})
     endif ()
+    if (${testtype} STREQUAL "C")
+      add_test (NAME HIMPORT-${testtfile} COMMAND ${CMAKE_CROSSCOMPILING_EMULATOR} $<TARGET_FILE:hdfimport${tgt_ext}> ${resultfile} -o ${testtfile}.hdf -compress ${ARGN})
+    endif ()
   else ()
     add_test (NAME HIMPORT-${testtfile} COMMAND ${CMAKE_CROSSCOMPILING_EMULATOR} $<TARGET_FILE:hdfimport${tgt_ext}> ${resultfile} -o ${testtfile}.hdf)
   endif ()
@@ -209,6 +213,7 @@ add_test (
         cb64r3-n
         ctxtr2_ris
         cb64r2_ris
+        cb32r3-c
         ctxtr2.hdf
         ctxtr3.hdf
         cb32i2.hdf
@@ -223,6 +228,7 @@ add_test (
         cb64r3-n.hdf
         ctxtr2_ris.hdf
         cb64r2_ris.hdf
+        cb32r3-c.hdf
         ctxtr2.tmp
         ctxtr3.tmp
         cb32i2.tmp
@@ -237,6 +243,7 @@ add_test (
         cb64r3-n.tmp
         ctxtr2_ris.tmp
         cb64r2_ris.tmp
+        cb32r3-c.tmp
         SDSfloat2.tmp
         SDSfloat3.tmp
         ctxtr2.tmp.err
@@ -253,6 +260,7 @@ add_test (
         cb64r3-n.tmp.err
         ctxtr2_ris.tmp.err
         cb64r2_ris.tmp.err
+        cb32r3-c.tmp.err
         SDSfloat2.tmp.err
         SDSfloat3.tmp.err
 )
@@ -298,6 +306,8 @@ ADD_H4_TEST (cb64r3 0 cb64r3-n "N")
 # "Testing for raster options"
 ADD_H4_TEST (ctxtr2 0 ctxtr2_ris "R" -e 50 50)
 ADD_H4_TEST (cb64r2 0 cb64r2_ris "R" -i 50 50 -f)
+# "Testing for chunked, compressed output"
+ADD_H4_TEST (cb32r3 0 cb32r3-c "C" 0)
 #
 # test with hdf files
 # "Testing for reading from hdf files"
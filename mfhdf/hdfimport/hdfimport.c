@@ -34,7 +34,7 @@
  * Synopsis:
  *      hdfimport -h[elp], OR
  *      hdfimport <infile> [ [-t[ype] <output-type> | -n] [<infile> [-t[ype] <output-type> | -n ]]...]
- *                            -o[utfile] <outfile> [-r[aster] [ras_opts ...]] [-f[loat]]
+ *                            -o[utfile] <outfile> [-c[ompress] <level>] [-r[aster] [ras_opts ...]] [-f[loat]]
  *
  *      -h[elp]:
  *              Print this summary of usage, and exit.
@@ -70,6 +70,11 @@
  *              more data sets and/or images in one HDF output file,
  *              "outfile".
  *
+ *      -c[ompress] <level>:
+ *              Store each scientific data set chunked, one read slab per
+ *              chunk, and compress the chunks with deflate at "level"
+ *              (0-9).  The default is a contiguous, uncompressed data set.
+ *
  *      -r[aster]:
  *              Store output as a raster image set in the output file.
  *
@@ -168,6 +173,12 @@
  *      or native 16-bit integer values for IN16 input format or native 8-bit
  *      integer values for IN08 input format.
  *
+ *      Unless "-r" is given, the input data is never held in memory all at
+ *      once: it is read and written to the output data set a slab of whole
+ *      rows (or whole planes) at a time, so files larger than memory can be
+ *      imported.  The raster options need the complete array and read it
+ *      in one piece.
+ *
  */
 
 #include "hdf.h"
@@ -189,9 +200,10 @@
 /*
  * global macros
  */
-#define EXPAND   1 /* -e: expand image with pixel replication */
-#define INTERP   2 /* -i: expand image with interpolation */
-#define NAME_LEN 255
+#define EXPAND    1 /* -e: expand image with pixel replication */
+#define INTERP    2 /* -i: expand image with interpolation */
+#define NAME_LEN  255
+#define SLAB_SIZE (4 * 1024 * 1024) /* bytes of input data read and written at a time */
 
 /*
  * structure definition to associate input files with the output data types
@@ -212,16 +224,17 @@ struct Options {
     int                  to_float;    /* float output is desired */
     int                  to_image;    /* image output is desired */
     int                  to_int;
-    int                  pal;     /* output palette with image */
-    int                  ctm;     /* color transform method: EXPAND or INTERP */
-    int                  exh;     /* horizontal expansion factor */
-    int                  exv;     /* vertical expansion factor */
-    int                  exd;     /* depth expansion factor */
-    int                  hres;    /* horizontal resolution of output image */
-    int                  vres;    /* vertical resolution of output image */
-    int                  dres;    /* depth resolution of output image */
-    int                  mean;    /* scale image around a mean */
-    float32              meanval; /* mean value to scale the image around */
+    int                  pal;       /* output palette with image */
+    int                  ctm;       /* color transform method: EXPAND or INTERP */
+    int                  exh;       /* horizontal expansion factor */
+    int                  exv;       /* vertical expansion factor */
+    int                  exd;       /* depth expansion factor */
+    int                  hres;      /* horizontal resolution of output image */
+    int                  vres;      /* vertical resolution of output image */
+    int                  dres;      /* depth resolution of output image */
+    int                  mean;      /* scale image around a mean */
+    float32              meanval;   /* mean value to scale the image around */
+    int                  complevel; /* deflate level of chunked SDS output, -1 for contiguous */
 };
 
 /* Additional Structures to handle different data types */
@@ -327,73 +340,80 @@ struct Raster {
 #define OPT_n                                                                                                \
     11 /* for  a FLOAT 64 binary input file to be accepted as FLOAT 64 SDS (default behaviour is writing it  \
           as FLOAT 32 SDS */
-#define ERR 20 /* invalid token */
+#define OPT_c 12 /* chunk and compress the SDS */
+#define ERR   21 /* invalid token */
 
 /*
  * state table for parsing the command line.
  */
-static int state_table[19][12] = {
+static int state_table[21][13] = {
 
     /* token ordering:
        FILENAME     OPT_o   OPT_r   OPT_e   OPT_i   OPT_num   OPT_p   OPT_f
-       OPT_h        OPT_m   OPT_z */
+       OPT_h        OPT_m   OPT_t   OPT_n   OPT_c */
 
     /* state 0: start */
-    {1, ERR, ERR, ERR, ERR, ERR, ERR, ERR, 14, ERR, ERR, ERR},
+    {1, ERR, ERR, ERR, ERR, ERR, ERR, ERR, 14, ERR, ERR, ERR, ERR},
 
     /* state 1: input files */
-    {1, 2, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, 17, 18},
+    {1, 2, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, 17, 18, ERR},
 
     /* state 2: -o[utfile] */
-    {3, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR},
+    {3, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR},
 
     /* state 3: outfile */
-    {ERR, ERR, 4, ERR, ERR, ERR, ERR, 13, ERR, ERR, ERR, ERR},
+    {ERR, ERR, 4, ERR, ERR, ERR, ERR, 13, ERR, ERR, ERR, ERR, 19},
 
     /* state 4: -r[aster] */
-    {ERR, ERR, ERR, 5, 9, ERR, 10, 12, ERR, 15, ERR, ERR},
+    {ERR, ERR, ERR, 5, 9, ERR, 10, 12, ERR, 15, ERR, ERR, ERR},
 
     /* state 5: -e[xpand] */
-    {ERR, ERR, ERR, ERR, ERR, 6, ERR, ERR, ERR, ERR, ERR, ERR},
+    {ERR, ERR, ERR, ERR, ERR, 6, ERR, ERR, ERR, ERR, ERR, ERR, ERR},
 
     /* state 6: -e[xpand] or -i[nterp] option argument */
-    {ERR, ERR, ERR, ERR, ERR, 7, ERR, ERR, ERR, ERR, ERR, ERR},
+    {ERR, ERR, ERR, ERR, ERR, 7, ERR, ERR, ERR, ERR, ERR, ERR, ERR},
 
     /* state 7: -e[xpand] or -i[nterp] option argument */
-    {ERR, ERR, ERR, ERR, ERR, 8, 10, 12, ERR, 15, ERR, ERR},
+    {ERR, ERR, ERR, ERR, ERR, 8, 10, 12, ERR, 15, ERR, ERR, ERR},
 
     /* state 8: -e[xpand] or -i[nterp] option argument */
-    {ERR, ERR, ERR, ERR, ERR, ERR, 10, 12, ERR, 15, ERR, ERR},
+    {ERR, ERR, ERR, ERR, ERR, ERR, 10, 12, ERR, 15, ERR, ERR, ERR},
 
     /* state 9: -i[nterp] */
-    {ERR, ERR, ERR, ERR, ERR, 6, ERR, ERR, ERR, ERR, ERR, ERR},
+    {ERR, ERR, ERR, ERR, ERR, 6, ERR, ERR, ERR, ERR, ERR, ERR, ERR},
 
     /* state 10: -p[alfile] */
-    {11, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR},
+    {11, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR},
 
     /* state 11: palfile */
-    {ERR, ERR, ERR, 5, 9, ERR, ERR, 12, ERR, 15, ERR, ERR},
+    {ERR, ERR, ERR, 5, 9, ERR, ERR, 12, ERR, 15, ERR, ERR, ERR},
 
     /* state 12: -f[loat] (after -r[aster]) */
-    {ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR},
+    {ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR},
 
     /* state 13: -f[loat] */
-    {ERR, ERR, 4, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR},
+    {ERR, ERR, 4, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, 19},
 
     /* state 14: -h[elp] */
-    {ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR},
+    {ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR},
 
     /* state 15: -m[ean] */
-    {ERR, ERR, ERR, ERR, ERR, 16, ERR, ERR, ERR, ERR, ERR, ERR},
+    {ERR, ERR, ERR, ERR, ERR, 16, ERR, ERR, ERR, ERR, ERR, ERR, ERR},
 
     /* state 16: mean */
-    {ERR, ERR, ERR, 5, 9, ERR, 10, 12, ERR, ERR, ERR, ERR},
+    {ERR, ERR, ERR, 5, 9, ERR, 10, 12, ERR, ERR, ERR, ERR, ERR},
 
     /* state 17: output type for data set */
-    {1, 2, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR},
+    {1, 2, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR},
 
     /* state 18: override default behaviour for FP 64 */
-    {1, 2, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR}
+    {1, 2, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR, ERR},
+
+    /* state 19: -c[ompress] */
+    {ERR, ERR, ERR, ERR, ERR, 20, ERR, ERR, ERR, ERR, ERR, ERR, ERR},
+
+    /* state 20: compression level */
+    {ERR, ERR, 4, ERR, ERR, ERR, ERR, 13, ERR, ERR, ERR, ERR, ERR}
 
 };
 
@@ -403,7 +423,8 @@ static int process(struct Options *opt);
 static int gfloat(char *infile, FILE *strm, float32 *fp32, struct Input *in);
 static int gint(char *infile, FILE *strm, int32 *ival, struct Input *in);
 static int isnum(char *s);
-static int gdata(struct infilesformat infile_info, struct Input *in, FILE *strm, int *is_maxmin);
+static int gdata(struct infilesformat infile_info, struct Input *in, FILE *strm, int *is_maxmin, int32 row0,
+                 int32 nrows);
 static int gdimen(struct infilesformat infile_info, struct Input *in, FILE *strm);
 static int gmaxmin(struct infilesformat infile_info, struct Input *in, FILE *strm, int *is_maxmin);
 static int gscale(struct infilesformat infile_info, struct Input *in, FILE *strm, int *is_scale);
@@ -430,6 +451,12 @@ static int gint8(char *infile, FILE *strm, int8 *ival, struct Input *in);
 static int init_scales(struct Input *in);
 void       fpdeallocate(struct Input *in, struct Raster *im, struct Options *opt);
 
+/*
+ * Functions to move the data a slab of rows at a time
+ */
+static int32 slab_rows(struct Input *in);
+static void  slab_region(struct Input *in, int32 row0, int32 nrows, int32 *start, int32 *edges);
+
 /*
  * Name:
  *      main
@@ -484,6 +511,8 @@ main(int argc, char *argv[])
     opt.mean   = FALSE; /* default: no mean given */
     opt.fcount = 0;     /* to count number of input files */
 
+    opt.complevel = -1; /* default: contiguous, uncompressed SDS */
+
     /*
      * parse the command line
      */
@@ -565,6 +594,15 @@ main(int argc, char *argv[])
             case 18: /* -n found */
                 opt.infiles[opt.fcount - 1].outtype = FP_64;
                 break;
+            case 19: /* -c found */
+                break;
+            case 20: /* compression level */
+                opt.complevel = atoi(argv[i]);
+                if (opt.complevel < 0 || opt.complevel > 9) {
+                    usage(argv[0]);
+                    goto err;
+                }
+                break;
             case ERR: /* command syntax error */
             default:
                 (void)fprintf(stderr, "%s", err2);
@@ -611,11 +649,16 @@ err:
  * Revision: (bmribler - 2006/8/18)
  *    Replaced first parameter with 'struct infilesformat' to use both
  *    the file name and the SD identifier (handle.)
+ * Revision:
+ *    Reads only the 'nrows' rows starting at row 'row0' (rows counted
+ *    across all planes) into the start of in->data, so the data can be
+ *    imported a slab at a time.  The max/min, when not given by the
+ *    input, is accumulated over the slabs and is known after the last.
  */
 static int
-gdata(struct infilesformat infile_info, struct Input *in, FILE *strm, int *is_maxmin)
+gdata(struct infilesformat infile_info, struct Input *in, FILE *strm, int *is_maxmin, int32 row0, int32 nrows)
 {
-    int32       i, j, k;
+    int32       i;
     float32    *fp32;
     int32      *in32;
     int16      *in16;
@@ -623,7 +666,8 @@ gdata(struct infilesformat infile_info, struct Input *in, FILE *strm, int *is_ma
     int8       *in8;
     int32       hdfdims[3], start[3]; /* order: ZYX or YX */
     int32       sd_id, sds_id, sd_index;
-    int32       len = in->dims[0] * in->dims[1] * in->dims[2];
+    int32       len  = in->dims[0] * nrows;
+    int         last = (row0 + nrows == in->dims[1] * in->dims[2]);
     char        infile[NAME_LEN];
     intn        status;
     const char *err1 = "Unable to get input data from file: %s.\n";
@@ -637,22 +681,7 @@ gdata(struct infilesformat infile_info, struct Input *in, FILE *strm, int *is_ma
         sd_index = 0;
         sds_id   = SDselect(sd_id, sd_index);
 
-        /*
-         * hdfdims is ordered: ZYX or YX
-         * in->dims is ordered: XYZ
-         */
-        if (in->rank == 2) {
-            hdfdims[0] = in->dims[1];
-            hdfdims[1] = in->dims[0];
-            start[0] = start[1] = 0;
-        }
-        else {
-            hdfdims[0] = in->dims[2];
-            hdfdims[1] = in->dims[1];
-            hdfdims[2] = in->dims[0];
-            start[0] = start[1] = start[2] = 0;
-        }
-
+        slab_region(in, row0, nrows, start, hdfdims);
         status = SDreaddata(sds_id, start, NULL, hdfdims, in->data);
         if (status == FAIL) {
             (void)fprintf(stderr, err1, infile);
@@ -661,131 +690,111 @@ gdata(struct infilesformat infile_info, struct Input *in, FILE *strm, int *is_ma
     }
     else {
         if (in->outtype == FP_32) {
-            for (k = 0, fp32 = (float32 *)in->data; k < in->dims[2]; k++) {
-                for (j = 0; j < in->dims[1]; j++) {
-                    for (i = 0; i < in->dims[0]; i++, fp32++) {
-                        if (gfloat(infile, strm, fp32, in)) {
-                            (void)fprintf(stderr, err1, infile);
-                            goto err;
-                        }
-                    }
+            for (i = 0, fp32 = (float32 *)in->data; i < len; i++, fp32++) {
+                if (gfloat(infile, strm, fp32, in)) {
+                    (void)fprintf(stderr, err1, infile);
+                    goto err;
                 }
             }
             if (*is_maxmin == FALSE) {
-                in->min = in->max = *(float32 *)in->data;
-                for (i = 1; i < len; i++) {
+                if (row0 == 0)
+                    in->min = in->max = *(float32 *)in->data;
+                for (i = 0; i < len; i++) {
                     if (((float32 *)in->data)[i] > in->max)
                         in->max = ((float32 *)in->data)[i];
                     if (((float32 *)in->data)[i] < in->min)
                         in->min = ((float32 *)in->data)[i];
                 }
-                *is_maxmin = TRUE;
             }
         }
         if (in->outtype == INT_32) {
-            for (k = 0, in32 = (int32 *)in->data; k < in->dims[2]; k++) {
-                for (j = 0; j < in->dims[1]; j++) {
-                    for (i = 0; i < in->dims[0]; i++, in32++) {
-                        if (gint32(infile, strm, in32, in)) {
-                            (void)fprintf(stderr, err1, infile);
-                            goto err;
-                        }
-                    }
+            for (i = 0, in32 = (int32 *)in->data; i < len; i++, in32++) {
+                if (gint32(infile, strm, in32, in)) {
+                    (void)fprintf(stderr, err1, infile);
+                    goto err;
                 }
             }
             if (*is_maxmin == FALSE) {
-                in->in32s.min = in->in32s.max = *(int32 *)in->data;
-                for (i = 1; i < len; i++) {
+                if (row0 == 0)
+                    in->in32s.min = in->in32s.max = *(int32 *)in->data;
+                for (i = 0; i < len; i++) {
                     if (((int32 *)in->data)[i] > in->in32s.max)
                         in->in32s.max = ((int32 *)in->data)[i];
                     if (((int32 *)in->data)[i] < in->in32s.min)
                         in->in32s.min = ((int32 *)in->data)[i];
                 }
-                *is_maxmin = TRUE;
             }
         }
         if (in->outtype == INT_16) {
-            for (k = 0, in16 = (int16 *)in->data; k < in->dims[2]; k++) {
-                for (j = 0; j < in->dims[1]; j++) {
-                    for (i = 0; i < in->dims[0]; i++, in16++) {
-                        if (gint16(infile, strm, in16, in)) {
-                            (void)fprintf(stderr, err1, infile);
-                            goto err;
-                        }
-                    }
+            for (i = 0, in16 = (int16 *)in->data; i < len; i++, in16++) {
+                if (gint16(infile, strm, in16, in)) {
+                    (void)fprintf(stderr, err1, infile);
+                    goto err;
                 }
             }
             if (*is_maxmin == FALSE) {
-                in->in16s.min = in->in16s.max = *(int16 *)in->data;
-                for (i = 1; i < len; i++) {
+                if (row0 == 0)
+                    in->in16s.min = in->in16s.max = *(int16 *)in->data;
+                for (i = 0; i < len; i++) {
                     if (((int16 *)in->data)[i] > in->in16s.max)
                         in->in16s.max = ((int16 *)in->data)[i];
                     if (((int16 *)in->data)[i] < in->in16s.min)
                         in->in16s.min = ((int16 *)in->data)[i];
                 }
-                *is_maxmin = TRUE;
             }
         }
 
         if (in->outtype == INT_8) {
-            for (k = 0, in8 = (int8 *)in->data; k < in->dims[2]; k++) {
-                for (j = 0; j < in->dims[1]; j++) {
-                    for (i = 0; i < in->dims[0]; i++, in8++) {
-                        if (gint8(infile, strm, in8, in)) {
-                            (void)fprintf(stderr, err1, infile);
-                            goto err;
-                        }
-                    }
+            for (i = 0, in8 = (int8 *)in->data; i < len; i++, in8++) {
+                if (gint8(infile, strm, in8, in)) {
+                    (void)fprintf(stderr, err1, infile);
+                    goto err;
                 }
             }
             if (*is_maxmin == FALSE) {
-                in->in8s.min = in->in8s.max = *(int8 *)in->data;
-                for (i = 1; i < len; i++) {
+                if (row0 == 0)
+                    in->in8s.min = in->in8s.max = *(int8 *)in->data;
+                for (i = 0; i < len; i++) {
                     if (((int8 *)in->data)[i] > in->in8s.max)
                         in->in8s.max = ((int8 *)in->data)[i];
                     if (((int8 *)in->data)[i] < in->in8s.min)
                         in->in8s.min = ((int8 *)in->data)[i];
                 }
-                *is_maxmin = TRUE;
             }
         }
 
         if (in->outtype == FP_64) {
-            for (k = 0, fp64 = (float64 *)in->data; k < in->dims[2]; k++) {
-                for (j = 0; j < in->dims[1]; j++) {
-                    for (i = 0; i < in->dims[0]; i++, fp64++) {
-                        if (gfloat64(infile, strm, fp64, in)) {
-                            (void)fprintf(stderr, err1, infile);
-                            goto err;
-                        }
-                    }
+            for (i = 0, fp64 = (float64 *)in->data; i < len; i++, fp64++) {
+                if (gfloat64(infile, strm, fp64, in)) {
+                    (void)fprintf(stderr, err1, infile);
+                    goto err;
                 }
             }
             if (*is_maxmin == FALSE) {
-                in->fp64s.min = in->fp64s.max = *(float64 *)in->data;
-                for (i = 1; i < len; i++) {
+                if (row0 == 0)
+                    in->fp64s.min = in->fp64s.max = *(float64 *)in->data;
+                for (i = 0; i < len; i++) {
                     if (((float64 *)in->data)[i] > in->fp64s.max)
                         in->fp64s.max = ((float64 *)in->data)[i];
                     if (((float64 *)in->data)[i] < in->fp64s.min)
                         in->fp64s.min = ((float64 *)in->data)[i];
                 }
-                *is_maxmin = TRUE;
             }
         }
 
-        /* } */
-        (void)fclose(strm);
+        /* the max/min is complete once the last slab has been seen */
+        if (last) {
+            *is_maxmin = TRUE;
+            (void)fclose(strm);
+        }
     }
 
 #ifdef DEBUG
     (void)printf("\tdata:");
-    for (k = 0, fp32 = in->data; k < in->dims[2]; k++) {
-        (void)printf("\n");
-        for (j = 0; j < in->dims[1]; j++) {
+    for (i = 0, fp32 = in->data; i < len; i++, fp32++) {
+        if (i % in->dims[0] == 0)
             (void)printf("\n\t");
-            for (i = 0; i < in->dims[0]; i++, fp32++)
-                (void)printf("%E ", *fp32);
-        }
+        (void)printf("%E ", *fp32);
     }
     (void)printf("\n\n\n");
 #endif /* DEBUG */
@@ -1658,6 +1667,10 @@ gtoken(char *s)
                 if (!strncmp("mean", &s[1], len))
                     token = OPT_m;
                 break;
+            case 'c':
+                if (!strncmp("compress", &s[1], len))
+                    token = OPT_c;
+                break;
             case 'n':
                 token = OPT_n;
                 break;
@@ -1795,7 +1808,8 @@ help(char *name)
     (void)fprintf(
         stderr, "\n\t%s  <infile> [ [-t[ype] <output-type> | -n] [<infile> [-t[ype] <output-type> | -n]...]",
         name);
-    (void)fprintf(stderr, "\n\t\t\t\t\t-o[utfile] <outfile> [-r[aster] [ras_opts ...]] [-f[loat]]");
+    (void)fprintf(stderr, "\n\t\t\t\t\t-o[utfile] <outfile> [-c[ompress] <level>] [-r[aster] [ras_opts ...]] "
+                          "[-f[loat]]");
 
     (void)fprintf(stderr, "\n\n\t <infile(s)>:");
     (void)fprintf(stderr, "\n\t\t Name of the input file(s), containing a single ");
@@ -1828,6 +1842,12 @@ help(char *name)
     (void)fprintf(stderr, "\n\t\t more data sets and/or images in one HDF output file,");
     (void)fprintf(stderr, "\n\t\t \"outfile\".");
 
+    (void)fprintf(stderr, "\n\n\t -c[ompress] <level>:");
+    (void)fprintf(stderr, "\n\t\t Store each data set chunked and compressed with deflate");
+    (void)fprintf(stderr, "\n\t\t at \"level\" (0-9).  Without \"-r\" the data is read and");
+    (void)fprintf(stderr, "\n\t\t written a slab at a time, so inputs larger than memory");
+    (void)fprintf(stderr, "\n\t\t can be imported.");
+
     (void)fprintf(stderr, "\n\n\t -r[aster]:");
     (void)fprintf(stderr, "\n\t\t Store output as a raster image set in the output file.");
 
@@ -2499,9 +2519,12 @@ err:
  *    otherwise. (bmribler - 2006/8/18)
  */
 static int32
-create_SDS(int32 sd_id, int32 nt, struct Input *in)
+create_SDS(int32 sd_id, int32 nt, struct Input *in, int complevel, int32 slab)
 {
-    int32 sds_id = FAIL;
+    int32         sds_id = FAIL;
+    int32         start[3];
+    HDF_CHUNK_DEF chunk_def;
+    const char   *chunk_err = "Unable to make the SDS chunked\n";
 
     if (in->rank == 2) {
         int32 edges[2];
@@ -2516,6 +2539,21 @@ create_SDS(int32 sd_id, int32 nt, struct Input *in)
         edges[2] = in->dims[0];
         sds_id   = SDcreate(sd_id, NULL, nt, in->rank, edges);
     }
+
+    /*
+     * one chunk per slab, so that every chunk is written, and
+     * compressed, exactly once
+     */
+    if (sds_id != FAIL && complevel >= 0) {
+        slab_region(in, 0, slab, start, chunk_def.comp.chunk_lengths);
+        chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+        chunk_def.comp.cinfo.deflate.level = complevel;
+        if (SDsetchunk(sds_id, chunk_def, HDF_CHUNK | HDF_COMP) == FAIL) {
+            (void)fprintf(stderr, "%s", chunk_err);
+            (void)SDendaccess(sds_id);
+            sds_id = FAIL;
+        }
+    }
     return (sds_id);
 }
 
@@ -2570,6 +2608,83 @@ alloc_data(void **data, int32 len, int outtype)
     return SUCCEED;
 } /* alloc_data */
 
+/*
+ * Name:
+ *      slab_rows
+ *
+ * Purpose:
+ *      Return the number of rows read and written at a time: as many
+ *    whole planes as fit in SLAB_SIZE bytes, or, when a single plane
+ *    does not fit, as many rows of one plane as do.  At least one row.
+ */
+static int32
+slab_rows(struct Input *in)
+{
+    int32 size;
+    int32 rows;
+
+    switch (in->outtype) {
+        case 1: /* 64-bit float */
+            size = (int32)sizeof(float64);
+            break;
+        case 3: /* 16-bit integer */
+            size = (int32)sizeof(int16);
+            break;
+        case 4: /* 8-bit integer */
+            size = (int32)sizeof(int8);
+            break;
+        default: /* 32-bit float or integer */
+            size = (int32)sizeof(float32);
+            break;
+    }
+
+    rows = SLAB_SIZE / (size * in->dims[0]);
+    if (rows < 1)
+        rows = 1;
+    if (rows >= in->dims[1]) {
+        rows -= rows % in->dims[1];
+        if (rows > in->dims[1] * in->dims[2])
+            rows = in->dims[1] * in->dims[2];
+    }
+    return rows;
+} /* slab_rows */
+
+/*
+ * Name:
+ *      slab_region
+ *
+ * Purpose:
+ *      Compute the SDS start and edges (ordered ZYX or YX) covering the
+ *    'nrows' rows from row 'row0', counted across all planes.  The rows
+ *    are either part of one plane or a run of whole planes.
+ */
+static void
+slab_region(struct Input *in, int32 row0, int32 nrows, int32 *start, int32 *edges)
+{
+    if (in->rank == 2) {
+        start[0] = row0;
+        start[1] = 0;
+        edges[0] = nrows;
+        edges[1] = in->dims[0];
+    }
+    else if (row0 % in->dims[1] == 0 && nrows % in->dims[1] == 0) {
+        start[0] = row0 / in->dims[1];
+        start[1] = 0;
+        start[2] = 0;
+        edges[0] = nrows / in->dims[1];
+        edges[1] = in->dims[1];
+        edges[2] = in->dims[0];
+    }
+    else {
+        start[0] = row0 / in->dims[1];
+        start[1] = row0 % in->dims[1];
+        start[2] = 0;
+        edges[0] = 1;
+        edges[1] = nrows;
+        edges[2] = in->dims[0];
+    }
+} /* slab_region */
+
 /*
  * Name:
  *      write_SDS
@@ -2579,30 +2694,34 @@ alloc_data(void **data, int32 len, int outtype)
  *    three-dimensional dataset, used in function 'process.'  It
  *    was factored out to reduce the length of 'process.'
  *    Returns SUCCEED or FAIL. (bmribler - 2006/8/18)
+ * Revision:
+ *    When 'slab' is 0, in->data already holds the whole dataset and is
+ *    written at once.  Otherwise the input is read with 'gdata' and
+ *    written 'slab' rows at a time, never holding more than one slab.
  */
 static intn
-write_SDS(int32 sds_id, struct Input *in)
+write_SDS(struct infilesformat infile_info, int32 sds_id, struct Input *in, FILE *strm, int *is_maxmin,
+          int32 slab)
 {
+    int32       start[3], edges[3];
+    int32       row0, nrows;
+    int32       total     = in->dims[1] * in->dims[2];
     const char *write_err = "Unable to write an SDS to the HDF output file\n";
-    if (in->rank == 2) {
-        int32 edges[2], start[2];
-        edges[0] = in->dims[1];
-        edges[1] = in->dims[0];
-        start[0] = 0;
-        start[1] = 0;
-        if (SDwritedata(sds_id, start, NULL, edges, (void *)in->data) != 0) {
-            (void)fprintf(stderr, "%s", write_err);
-            return FAIL;
+
+    for (row0 = 0; row0 < total; row0 += nrows) {
+        nrows = total;
+        if (slab > 0) {
+            nrows = slab;
+            /* a slab shorter than a plane does not cross into the next */
+            if (slab < in->dims[1] && nrows > in->dims[1] - row0 % in->dims[1])
+                nrows = in->dims[1] - row0 % in->dims[1];
+            if (nrows > total - row0)
+                nrows = total - row0;
+            if (gdata(infile_info, in, strm, is_maxmin, row0, nrows))
+                return FAIL;
         }
-    }
-    else {
-        int32 edges[3], start[3];
-        edges[0] = in->dims[2];
-        edges[1] = in->dims[1];
-        edges[2] = in->dims[0];
-        start[0] = 0;
-        start[1] = 0;
-        start[2] = 0;
+
+        slab_region(in, row0, nrows, start, edges);
         if (SDwritedata(sds_id, start, NULL, edges, (void *)in->data) != 0) {
             (void)fprintf(stderr, "%s", write_err);
             return FAIL;
@@ -2710,6 +2829,7 @@ process(struct Options *opt)
     int            is_maxmin;
     int            is_scale;
     int32          len;
+    int32          slab;
     FILE          *strm = NULL;
     int32          hdf;
     int32          sd_id  = FAIL;
@@ -2804,15 +2924,17 @@ process(struct Options *opt)
             goto err;
 
         /*
-         * get the input data
+         * get the input data; unless an image is made from it, it is
+         * read a slab at a time while the data set is written
          */
-        len = in.dims[0] * in.dims[1] * in.dims[2];
+        slab = slab_rows(&in);
+        len  = in.dims[0] * (opt->to_image == TRUE ? in.dims[1] * in.dims[2] : slab);
 
         /* allocate memory for in.data depending on in.outtype value */
         if (alloc_data(&(in.data), len, in.outtype) == FAIL)
             goto err;
 
-        if (gdata(opt->infiles[i], &in, strm, &is_maxmin))
+        if (opt->to_image == TRUE && gdata(opt->infiles[i], &in, strm, &is_maxmin, 0, in.dims[1] * in.dims[2]))
             goto err;
 
         /*
@@ -2825,17 +2947,11 @@ process(struct Options *opt)
                 case 0: /* 32-bit float */
                 case 5: /* NO_NE */
                     /* create data-set */
-                    sds_id = create_SDS(sd_id, DFNT_FLOAT32, &in);
+                    sds_id = create_SDS(sd_id, DFNT_FLOAT32, &in, opt->complevel, slab);
                     if (sds_id == FAIL)
                         goto err;
 
                     if (is_scale == TRUE) {
-                        /* set range */
-                        if (SDsetrange(sds_id, &in.max, &in.min) != 0) {
-                            (void)fprintf(stderr, "%s", err5a);
-                            goto err;
-                        }
-
                         /* set dimension scale */
                         status = set_dimensions(sds_id, &in, DFNT_FLOAT32, (void *)in.dscale,
                                                 (void *)in.vscale, (void *)in.hscale);
@@ -2844,24 +2960,25 @@ process(struct Options *opt)
                     }
 
                     /* write data to the data set */
-                    if (write_SDS(sds_id, &in) == FAIL)
+                    if (write_SDS(opt->infiles[i], sds_id, &in, strm, &is_maxmin,
+                                  opt->to_image == TRUE ? 0 : slab) == FAIL)
                         goto err;
+
+                    /* set range, known once all the data has been read */
+                    if (is_scale == TRUE && SDsetrange(sds_id, &in.max, &in.min) != 0) {
+                        (void)fprintf(stderr, "%s", err5a);
+                        goto err;
+                    }
                     break;
 
                 case 1: /* 64-bit float */
 
                     /* create data-set */
-                    sds_id = create_SDS(sd_id, DFNT_FLOAT64, &in);
+                    sds_id = create_SDS(sd_id, DFNT_FLOAT64, &in, opt->complevel, slab);
                     if (sds_id == FAIL)
                         goto err;
 
                     if (is_scale == TRUE) {
-                        /* set range */
-                        if (SDsetrange(sds_id, &in.fp64s.max, &in.fp64s.min) != 0) {
-                            (void)fprintf(stderr, "%s", err5a);
-                            goto err;
-                        }
-
                         /* set dimension scale */
                         status = set_dimensions(sds_id, &in, DFNT_FLOAT64, (void *)in.fp64s.dscale,
                                                 (void *)in.fp64s.vscale, (void *)in.fp64s.hscale);
@@ -2870,24 +2987,25 @@ process(struct Options *opt)
                     }
 
                     /* write data to the data set */
-                    if (write_SDS(sds_id, &in) == FAIL)
+                    if (write_SDS(opt->infiles[i], sds_id, &in, strm, &is_maxmin,
+                                  opt->to_image == TRUE ? 0 : slab) == FAIL)
+                        goto err;
+
+                    /* set range, known once all the data has been read */
+                    if (is_scale == TRUE && SDsetrange(sds_id, &in.fp64s.max, &in.fp64s.min) != 0) {
+                        (void)fprintf(stderr, "%s", err5a);
                         goto err;
+                    }
                     break;
 
                 case 2: /* 32-bit integer */
 
                     /* create data-set */
-                    sds_id = create_SDS(sd_id, DFNT_INT32, &in);
+                    sds_id = create_SDS(sd_id, DFNT_INT32, &in, opt->complevel, slab);
                     if (sds_id == FAIL)
                         goto err;
 
                     if (is_scale == TRUE) {
-                        /* set range */
-                        if (SDsetrange(sds_id, &in.in32s.max, &in.in32s.min) != 0) {
-                            (void)fprintf(stderr, "%s", err5a);
-                            goto err;
-                        }
-
                         /* set dimension scale */
                         status = set_dimensions(sds_id, &in, DFNT_INT32, (void *)in.in32s.dscale,
                                                 (void *)in.in32s.vscale, (void *)in.in32s.hscale);
@@ -2896,23 +3014,24 @@ process(struct Options *opt)
                     }
 
                     /* write data to the data set */
-                    if (write_SDS(sds_id, &in) == FAIL)
+                    if (write_SDS(opt->infiles[i], sds_id, &in, strm, &is_maxmin,
+                                  opt->to_image == TRUE ? 0 : slab) == FAIL)
+                        goto err;
+
+                    /* set range, known once all the data has been read */
+                    if (is_scale == TRUE && SDsetrange(sds_id, &in.in32s.max, &in.in32s.min) != 0) {
+                        (void)fprintf(stderr, "%s", err5a);
                         goto err;
+                    }
                     break;
 
                 case 3: /* 16-bit integer */
                     /* create data-set */
-                    sds_id = create_SDS(sd_id, DFNT_INT16, &in);
+                    sds_id = create_SDS(sd_id, DFNT_INT16, &in, opt->complevel, slab);
                     if (sds_id == FAIL)
                         goto err;
 
                     if (is_scale == TRUE) {
-                        /* set range */
-                        if (SDsetrange(sds_id, &in.in16s.max, &in.in16s.min) != 0) {
-                            (void)fprintf(stderr, "%s", err5a);
-                            goto err;
-                        }
-
                         /* set dimension scale */
                         status = set_dimensions(sds_id, &in, DFNT_INT16, (void *)in.in16s.dscale,
                                                 (void *)in.in16s.vscale, (void *)in.in16s.hscale);
@@ -2921,23 +3040,24 @@ process(struct Options *opt)
                     }
 
                     /* write data to the data set */
-                    if (write_SDS(sds_id, &in) == FAIL)
+                    if (write_SDS(opt->infiles[i], sds_id, &in, strm, &is_maxmin,
+                                  opt->to_image == TRUE ? 0 : slab) == FAIL)
                         goto err;
+
+                    /* set range, known once all the data has been read */
+                    if (is_scale == TRUE && SDsetrange(sds_id, &in.in16s.max, &in.in16s.min) != 0) {
+                        (void)fprintf(stderr, "%s", err5a);
+                        goto err;
+                    }
                     break;
 
                 case 4: /* 8-bit integer */
                     /* create data-set */
-                    sds_id = create_SDS(sd_id, DFNT_INT8, &in);
+                    sds_id = create_SDS(sd_id, DFNT_INT8, &in, opt->complevel, slab);
                     if (sds_id == FAIL)
                         goto err;
 
                     if (is_scale == TRUE) {
-                        /* set range */
-                        if (SDsetrange(sds_id, &in.in8s.max, &in.in8s.min) != 0) {
-                            (void)fprintf(stderr, "%s", err5a);
-                            goto err;
-                        }
-
                         /* set dimension scale */
                         status = set_dimensions(sds_id, &in, DFNT_INT8, (void *)in.in8s.dscale,
                                                 (void *)in.in8s.vscale, (void *)in.in8s.hscale);
@@ -2946,8 +3066,15 @@ process(struct Options *opt)
                     }
 
                     /* write data to the data set */
-                    if (write_SDS(sds_id, &in) == FAIL)
+                    if (write_SDS(opt->infiles[i], sds_id, &in, strm, &is_maxmin,
+                                  opt->to_image == TRUE ? 0 : slab) == FAIL)
+                        goto err;
+
+                    /* set range, known once all the data has been read */
+                    if (is_scale == TRUE && SDsetrange(sds_id, &in.in8s.max, &in.in8s.min) != 0) {
+                        (void)fprintf(stderr, "%s", err5a);
                         goto err;
+                    }
                     break;
             }
             /* close data set */
@@ -3269,6 +3396,9 @@ usage(char *name)
     (void)fprintf(stderr, "\n\t\tfloating point data-set) should be overridden to write ");
     (void)fprintf(stderr, "\n\t\tit to a 64-bit floating point data-set.");
     (void)fprintf(stderr, "\n\n\toptions...\n");
+    (void)fprintf(stderr, "\n\t-c[ompress] <level>:\n");
+    (void)fprintf(stderr, "\t\tchunk the data set and compress it with deflate ");
+    (void)fprintf(stderr, "at level 0-9\n");
     (void)fprintf(stderr, "\n\t-r[aster]:\n");
     (void)fprintf(stderr, "\t\tproduce an image.  Could be ");
     (void)fprintf(stderr, "followed by:\n");
@@ -0,0 +1,69 @@
+cb32r3-c.hdf:
+
+Version Descriptor            : (tag 30)
+	Ref no      1	      92 bytes
+
+Compressed Data Indicator     : (tag 40)
+	Ref no      1	     251 bytes
+
+Number type                   : (tag 106)
+	Ref no     19	       4 bytes
+	Ref no     22	       4 bytes
+	Ref no     25	       4 bytes
+	Ref no     28	       4 bytes
+
+SciData dimension record      : (tag 701)
+	Ref no     19	      30 bytes
+	Ref no     22	      14 bytes
+	Ref no     25	      14 bytes
+	Ref no     28	      14 bytes
+
+Scientific Data               : (tag 702)
+	Ref no      6	      20 bytes
+	Ref no      8	      12 bytes
+	Ref no     10	      16 bytes
+
+Numeric Data Group            : (tag 720)
+	Ref no      2	      16 bytes
+	Ref no      5	      16 bytes
+	Ref no      7	      16 bytes
+	Ref no      9	      16 bytes
+
+Vdata                         : (tag 1962)
+	Ref no      4	     116 bytes
+	Ref no     11	      60 bytes
+	Ref no     13	      60 bytes
+	Ref no     15	      60 bytes
+	Ref no     17	      61 bytes
+	Ref no     18	      55 bytes
+	Ref no     21	      64 bytes
+	Ref no     24	      64 bytes
+	Ref no     27	      64 bytes
+
+Vdata Storage                 : (tag 1963)
+	Ref no      4	      16 bytes
+	Ref no     11	       4 bytes
+	Ref no     13	       4 bytes
+	Ref no     15	       4 bytes
+	Ref no     17	       8 bytes
+	Ref no     18	      -1 bytes
+	Ref no     21	      -1 bytes
+	Ref no     24	      -1 bytes
+	Ref no     27	      -1 bytes
+
+Vgroup                        : (tag 1965)
+	Ref no     12	      33 bytes
+	Ref no     14	      33 bytes
+	Ref no     16	      33 bytes
+	Ref no     20	      64 bytes
+	Ref no     23	      53 bytes
+	Ref no     26	      53 bytes
+	Ref no     29	      53 bytes
+	Ref no     30	      61 bytes
+
+Special Data Chunk            : (tag 16445)
+	Ref no      1	     240 bytes
+
+Special Scientific Data       : (tag 17086)
+	Ref no      3	     240 bytes
+
@@ -35,6 +35,8 @@ if (HDF4_BUILD_GENERATORS AND NOT ONLY_SHARED_LIBS)
           hdifftst5.hdf
           hdifftst6.hdf
           hdifftst7.hdf
+          hdifftst8.hdf
+          hdifftst9.hdf
   )
   set (last_test "HDIFF-GEN-clearall-objects")
 
@@ -88,6 +90,8 @@ set (HDF4_REFERENCE_TEST_FILES
     hdifftst5.hdf
     hdifftst6.hdf
     hdifftst7.hdf
+    hdifftst8.hdf
+    hdifftst9.hdf
 )
 set (HDF4_REFERENCE_FILES
     hdiff_01.txt
@@ -105,6 +109,9 @@ set (HDF4_REFERENCE_FILES
     hdiff_13.txt
     hdiff_14.txt
     hdiff_15.txt
+    hdiff_16.txt
+    hdiff_17.txt
+    hdiff_18.txt
 )
 
 foreach (h4_file ${HDF4_REFERENCE_TEST_FILES} ${HDF4_REFERENCE_FILES})
@@ -143,6 +150,9 @@ add_test (
         hdiff_13.out
         hdiff_14.out
         hdiff_15.out
+        hdiff_16.out
+        hdiff_17.out
+        hdiff_18.out
         hdiff_01.out.err
         hdiff_02.out.err
         hdiff_03.out.err
@@ -158,6 +168,9 @@ add_test (
         hdiff_13.out.err
         hdiff_14.out.err
         hdiff_15.out.err
+        hdiff_16.out.err
+        hdiff_17.out.err
+        hdiff_18.out.err
 )
 if (NOT "${last_test}" STREQUAL "")
   set_tests_properties (HDIFF-clearall-objects PROPERTIES DEPENDS ${last_test} LABELS ${PROJECT_NAME})
@@ -203,10 +216,19 @@ ADD_H4_TEST (hdiff_11 1 hdifftst1.hdf hdifftst2.hdf)
 ADD_H4_TEST (hdiff_12 1 -d -p 0.05 -v dset3 hdifftst1.hdf hdifftst2.hdf)
 
 # hyperslab reading
-ADD_H4_TEST (hdiff_13 0 hdifftst3.hdf hdifftst4.hdf)
+ADD_H4_TEST (hdiff_13 1 hdifftst3.hdf hdifftst4.hdf)
 
 # lone dim
 ADD_H4_TEST (hdiff_14 1 hdifftst5.hdf hdifftst6.hdf)
 
 # group loop
 ADD_H4_TEST (hdiff_15 0 -b hdifftst7.hdf hdifftst7.hdf)
+
+# compare objects in worker processes
+ADD_H4_TEST (hdiff_16 1 -j 3 hdifftst1.hdf hdifftst2.hdf)
+
+# chunked, compressed datasets
+ADD_H4_TEST (hdiff_17 1 hdifftst8.hdf hdifftst9.hdf)
+
+# chunked datasets compared by hyperslabs of whole chunks
+ADD_H4_TEST (hdiff_18 1 -M 64 hdifftst8.hdf hdifftst9.hdf)
@@ -15,6 +15,21 @@
 #include "hdiff_list.h"
 #include "hdiff_mattbl.h"
 
+#if defined(H4_HAVE_FORK) && defined(H4_HAVE_SYS_WAIT_H) && defined(H4_HAVE_UNISTD_H)
+#define HDIFF_WORKERS
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+static match_table_t *match_list(uint32 nobjects1, dtable_t *list1, uint32 nobjects2, dtable_t *list2,
+                                 diff_opt_t *opt);
+static uint32 match_diff(match_table_t *mattbl, uint32 first, uint32 last, int32 sd1_id, int32 gr1_id,
+                         int32 file1_id, int32 sd2_id, int32 gr2_id, int32 file2_id, diff_opt_t *opt);
+#ifdef HDIFF_WORKERS
+static uint32 match_workers(const char *fname1, const char *fname2, uint32 nobjects1, dtable_t *list1,
+                            uint32 nobjects2, dtable_t *list2, diff_opt_t *opt);
+#endif
+
 /*-------------------------------------------------------------------------
  * Function: hdiff
  *
@@ -35,7 +50,8 @@ hdiff(const char *fname1, const char *fname2, diff_opt_t *opt)
     int32     sd1_id = -1, sd2_id = -1, gr1_id = -1, gr2_id = -1, file1_id = -1, file2_id = -1;
     uint32    nobjects1;
     uint32    nobjects2;
-    uint32    nfound = 0;
+    uint32    nfound  = 0;
+    int       matched = 0;
     int       err;
     dtable_t *list1 = NULL;
     dtable_t *list2 = NULL;
@@ -74,6 +90,22 @@ hdiff(const char *fname1, const char *fname2, diff_opt_t *opt)
         dtable_print(list2, "file 2");
     }
 
+#ifdef HDIFF_WORKERS
+    /*-------------------------------------------------------------------------
+     * compare the common objects in worker processes (-j); this is done
+     * before this process opens the files so that no worker shares an open
+     * file, and its file offset, with another
+     *-------------------------------------------------------------------------
+     */
+
+    if (opt->nworkers > 1) {
+        nfound = match_workers(fname1, fname2, nobjects1, list1, nobjects2, list2, opt);
+        if (opt->err_stat)
+            goto out;
+        matched = 1;
+    }
+#endif
+
     /*-------------------------------------------------------------------------
      * open file IDs
      *-------------------------------------------------------------------------
@@ -124,8 +156,9 @@ hdiff(const char *fname1, const char *fname2, diff_opt_t *opt)
      *-------------------------------------------------------------------------
      */
 
-    nfound =
-        match(nobjects1, list1, nobjects2, list2, sd1_id, gr1_id, file1_id, sd2_id, gr2_id, file2_id, opt);
+    if (!matched)
+        nfound =
+            match(nobjects1, list1, nobjects2, list2, sd1_id, gr1_id, file1_id, sd2_id, gr2_id, file2_id, opt);
 
     nfound += diff_match_dim(sd1_id, sd2_id, td1_1, td1_2, td2_1, td2_2, opt);
 
@@ -222,12 +255,39 @@ out:
 uint32
 match(uint32 nobjects1, dtable_t *list1, uint32 nobjects2, dtable_t *list2, int32 sd1_id, int32 gr1_id,
       int32 file1_id, int32 sd2_id, int32 gr2_id, int32 file2_id, diff_opt_t *opt)
+{
+    uint32         nfound = 0;
+    match_table_t *mattbl = match_list(nobjects1, list1, nobjects2, list2, opt);
+
+    /*-------------------------------------------------------------------------
+     * do the diff for objects
+     *-------------------------------------------------------------------------
+     */
+
+    nfound = match_diff(mattbl, 0, mattbl->nobjs, sd1_id, gr1_id, file1_id, sd2_id, gr2_id, file2_id, opt);
+
+    /* free table */
+    match_table_free(mattbl);
+    return nfound;
+}
+
+/*-------------------------------------------------------------------------
+ * Function: match_list
+ *
+ * Purpose: Build the table of objects in either file, marking the ones
+ *  found in both, and print it in verbose mode
+ *
+ * Return: The table; the caller frees it with match_table_free
+ *
+ *-------------------------------------------------------------------------
+ */
+static match_table_t *
+match_list(uint32 nobjects1, dtable_t *list1, uint32 nobjects2, dtable_t *list2, diff_opt_t *opt)
 {
     int            cmp;
     int            more_names_exist = (nobjects1 > 0 && nobjects2 > 0) ? 1 : 0;
     uint32         curr1            = 0;
     uint32         curr2            = 0;
-    uint32         nfound           = 0;
     match_table_t *mattbl           = NULL;
     unsigned       infile[2];
     char           c1, c2;
@@ -308,12 +368,27 @@ match(uint32 nobjects1, dtable_t *list1, uint32 nobjects2, dtable_t *list2, int3
         printf("\n");
     }
 
-    /*-------------------------------------------------------------------------
-     * do the diff for objects
-     *-------------------------------------------------------------------------
-     */
+    return mattbl;
+}
 
-    for (i = 0; i < mattbl->nobjs; i++) {
+/*-------------------------------------------------------------------------
+ * Function: match_diff
+ *
+ * Purpose: Compare the objects found in both files among entries
+ *  [first, last) of the match table
+ *
+ * Return: Number of differences found
+ *
+ *-------------------------------------------------------------------------
+ */
+static uint32
+match_diff(match_table_t *mattbl, uint32 first, uint32 last, int32 sd1_id, int32 gr1_id, int32 file1_id,
+           int32 sd2_id, int32 gr2_id, int32 file2_id, diff_opt_t *opt)
+{
+    uint32 nfound = 0;
+    uint32 i;
+
+    for (i = first; i < last; i++) {
         if (mattbl->objs[i].flags[0] && mattbl->objs[i].flags[1]) {
             nfound += diff(file1_id, file2_id, sd1_id, sd2_id, gr1_id, gr2_id, mattbl->objs[i].obj_name,
                            mattbl->objs[i].obj_name, mattbl->objs[i].tag1, mattbl->objs[i].ref1,
@@ -321,10 +396,178 @@ match(uint32 nobjects1, dtable_t *list1, uint32 nobjects2, dtable_t *list2, int3
         }
     }
 
-    /* free table */
+    return nfound;
+}
+
+#ifdef HDIFF_WORKERS
+/*-------------------------------------------------------------------------
+ * Function: match_workers
+ *
+ * Purpose: Compare the common objects of the two files in opt->nworkers
+ *  processes.  The HDF library is not thread-safe, so each worker is a
+ *  separate process that opens both files itself; while one worker reads
+ *  an object another compares the one it has read.  The table is cut into
+ *  consecutive runs of about the same number of common objects and each
+ *  worker prints to a temporary file, which are copied to stdout in table
+ *  order once all workers are done, so the output is the same as without
+ *  -j.
+ *
+ * Return: Number of differences found; opt->err_stat is set if a worker
+ *  could not be run or failed
+ *
+ *-------------------------------------------------------------------------
+ */
+static uint32
+match_workers(const char *fname1, const char *fname2, uint32 nobjects1, dtable_t *list1, uint32 nobjects2,
+              dtable_t *list2, diff_opt_t *opt)
+{
+    typedef struct {
+        uint32 nfound;
+        int    err_stat;
+    } result_t;
+
+    match_table_t *mattbl = match_list(nobjects1, list1, nobjects2, list2, opt);
+    FILE         **out    = NULL;
+    int           *fds    = NULL;
+    pid_t         *pids   = NULL;
+    uint32         ncommon = 0, seen = 0, nfound = 0, first, i;
+    int            nworkers, k, started = 0;
+    char           buf[4096];
+    size_t         n;
+
+    for (i = 0; i < mattbl->nobjs; i++)
+        if (mattbl->objs[i].flags[0] && mattbl->objs[i].flags[1])
+            ncommon++;
+
+    nworkers = (uint32)opt->nworkers < ncommon ? opt->nworkers : (int)ncommon;
+    if (nworkers == 0)
+        goto done;
+
+    out  = (FILE **)calloc((size_t)nworkers, sizeof(FILE *));
+    fds  = (int *)malloc((size_t)nworkers * sizeof(int));
+    pids = (pid_t *)malloc((size_t)nworkers * sizeof(pid_t));
+    if (out == NULL || fds == NULL || pids == NULL) {
+        printf("Error: cannot allocate memory for %d workers\n", nworkers);
+        opt->err_stat = 1;
+        goto done;
+    }
+
+    /* anything already buffered must not be written again by every worker */
+    fflush(stdout);
+
+    first = 0;
+    for (k = 0; k < nworkers; k++) {
+        /* workers 0..k get the first 'target' common objects between them */
+        uint32 rem    = ncommon % (uint32)nworkers;
+        uint32 target = ncommon / (uint32)nworkers * (uint32)(k + 1) + ((uint32)k < rem ? (uint32)k + 1 : rem);
+        uint32 last   = first;
+        int    pfd[2];
+
+        while (last < mattbl->nobjs && seen < target) {
+            if (mattbl->objs[last].flags[0] && mattbl->objs[last].flags[1])
+                seen++;
+            last++;
+        }
+        if (k == nworkers - 1)
+            last = mattbl->nobjs;
+
+        if ((out[k] = tmpfile()) == NULL || pipe(pfd) < 0) {
+            printf("Error: cannot set up worker %d\n", k);
+            opt->err_stat = 1;
+            break;
+        }
+
+        if ((pids[k] = fork()) < 0) {
+            printf("Error: cannot start worker %d\n", k);
+            close(pfd[0]);
+            close(pfd[1]);
+            opt->err_stat = 1;
+            break;
+        }
+
+        if (pids[k] == 0) {
+            /* worker: open both files, compare its run, report back */
+            int32    file1_id = -1, file2_id = -1, sd1_id = -1, sd2_id = -1, gr1_id = -1, gr2_id = -1;
+            result_t res;
+
+            close(pfd[0]);
+            dup2(fileno(out[k]), STDOUT_FILENO);
+            opt->err_stat = 0;
+
+            if ((file1_id = Hopen(fname1, DFACC_READ, (int16)0)) == FAIL ||
+                (file2_id = Hopen(fname2, DFACC_READ, (int16)0)) == FAIL ||
+                (sd1_id = SDstart(fname1, DFACC_RDONLY)) == FAIL ||
+                (sd2_id = SDstart(fname2, DFACC_RDONLY)) == FAIL || (gr1_id = GRstart(file1_id)) == FAIL ||
+                (gr2_id = GRstart(file2_id)) == FAIL) {
+                printf("Error: worker %d could not open <%s> and <%s>\n", k, fname1, fname2);
+                opt->err_stat = 1;
+                res.nfound    = 0;
+            }
+            else
+                res.nfound = match_diff(mattbl, first, last, sd1_id, gr1_id, file1_id, sd2_id, gr2_id,
+                                        file2_id, opt);
+
+            if (sd1_id != -1 && sd1_id != FAIL)
+                SDend(sd1_id);
+            if (sd2_id != -1 && sd2_id != FAIL)
+                SDend(sd2_id);
+            if (gr1_id != -1 && gr1_id != FAIL)
+                GRend(gr1_id);
+            if (gr2_id != -1 && gr2_id != FAIL)
+                GRend(gr2_id);
+            if (file1_id != -1 && file1_id != FAIL)
+                Hclose(file1_id);
+            if (file2_id != -1 && file2_id != FAIL)
+                Hclose(file2_id);
+
+            fflush(stdout);
+            res.err_stat = opt->err_stat;
+            if (write(pfd[1], &res, sizeof(res)) != (ssize_t)sizeof(res))
+                _exit(EXIT_FAILURE);
+            _exit(EXIT_SUCCESS);
+        }
+
+        close(pfd[1]);
+        fds[k] = pfd[0];
+        started++;
+        first = last;
+    }
+
+    /* collect the workers in order and pass their output on */
+    for (k = 0; k < started; k++) {
+        result_t res;
+        int      status;
+
+        if (read(fds[k], &res, sizeof(res)) != (ssize_t)sizeof(res)) {
+            res.nfound   = 0;
+            res.err_stat = 1;
+        }
+        close(fds[k]);
+        if (waitpid(pids[k], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            res.err_stat = 1;
+
+        nfound += res.nfound;
+        if (res.err_stat)
+            opt->err_stat = 1;
+
+        rewind(out[k]);
+        while ((n = fread(buf, 1, sizeof(buf), out[k])) > 0)
+            fwrite(buf, 1, n, stdout);
+    }
+
+done:
+    if (out != NULL) {
+        for (k = 0; k < nworkers; k++)
+            if (out[k] != NULL)
+                fclose(out[k]);
+        free(out);
+    }
+    free(fds);
+    free(pids);
     match_table_free(mattbl);
     return nfound;
 }
+#endif /* HDIFF_WORKERS */
 
 /*-------------------------------------------------------------------------
  * Function: diff
@@ -16,6 +16,9 @@
 /* Maximum value for max_err_cnt */
 #define MAX_DIFF 0x7FFFFFFF
 
+/* Default size of the hyperslabs SDSs are compared by */
+#define SLAB_BYTES 1048576
+
 struct ncdim { /* dimension */
     char  name[H4_MAX_NC_NAME];
     int32 size;
@@ -88,6 +91,14 @@ typedef struct {        /* selection for comparison  */
     int err_stat;
     /* an error occurred (1, error, 0, no error) */
 
+    int nworkers; /*
+                   * number of worker processes comparing objects (-j)
+                   */
+
+    int32 slabsize; /*
+                     * size of the hyperslabs SDSs are compared by (-M)
+                     */
+
 } diff_opt_t;
 
 /*-------------------------------------------------------------------------
@@ -115,8 +126,8 @@ uint32 gattr_diff(int32 sdid1, int32 sdid2, diff_opt_t *opt);
 void   pr_att_vals(nc_type type, int len, void *vals);
 
 uint32 array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char *name2, int rank,
-                  int32 *dims, int32 type, float32 err_limit, float32 err_rel, uint32 max_err_cnt,
-                  int32 statistics, void *fill1, void *fill2);
+                  int32 *dims, int32 *offset, int32 type, float32 err_limit, float32 err_rel,
+                  uint32 max_err_cnt, int32 statistics, void *fill1, void *fill2);
 
 uint32 match(uint32 nobjects1, dtable_t *list1, uint32 nobjects2, dtable_t *list2, int32 sd1_id, int32 gr1_id,
              int32 file1_id, int32 sd2_id, int32 gr2_id, int32 file2_id, diff_opt_t *opt);
@@ -88,25 +88,44 @@
             not_comparable = 1;                                                                              \
     }
 
+/*-------------------------------------------------------------------------
+ * skip elements stored with the same bytes in both buffers: those never
+ * print a difference, so only statistics and debug output need them
+ *-------------------------------------------------------------------------
+ */
+
+#define SKIP_BLOCK 4096 /* elements compared at once while skipping */
+
+#define SKIP_SAME(T, P1, P2)                                                                                 \
+    if (skip) {                                                                                              \
+        i = next_mismatch(buf1, buf2, i, tot_cnt, sizeof(T));                                                \
+        if (i == tot_cnt)                                                                                    \
+            break;                                                                                           \
+        P1 = (T *)buf1 + i;                                                                                  \
+        P2 = (T *)buf2 + i;                                                                                  \
+    }
+
 /*-------------------------------------------------------------------------
  * local prototypes
  *-------------------------------------------------------------------------
  */
-static void print_pos(int *ph, uint32 curr_pos, int32 *acc, int32 *pos, int rank, const char *obj1,
-                      const char *obj2);
+static void   print_pos(int *ph, uint32 curr_pos, int32 *acc, int32 *pos, int32 *offset, int rank,
+                        const char *obj1, const char *obj2);
+static uint32 next_mismatch(const void *buf1, const void *buf2, uint32 i, uint32 tot_cnt, size_t size);
 
 /*-------------------------------------------------------------------------
  * Function: array_diff
  *
- * Purpose: compare the 2 buffers BUF1 and BUF2
+ * Purpose: compare the 2 buffers BUF1 and BUF2, of dimensions DIMS at
+ *  OFFSET in the arrays compared, NULL if they hold the whole arrays
  *
  *-------------------------------------------------------------------------
  */
 
 uint32
 array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char *name2, int rank,
-           int32 *dims, int32 type, float32 err_limit, float32 err_rel, uint32 max_err_cnt, int32 statistics,
-           void *fill1, void *fill2)
+           int32 *dims, int32 *offset, int32 type, float32 err_limit, float32 err_rel, uint32 max_err_cnt,
+           int32 statistics, void *fill1, void *fill2)
 
 {
     uint32   i;
@@ -137,6 +156,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
     int      both_zero;
     int      not_comparable;
     uint32   n_diff = 0;
+    int      skip;
 
     acc[rank - 1] = 1;
     for (j = (rank - 2); j >= 0; j--) {
@@ -149,6 +169,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
     if (debug) {
         fp = fopen("hdiff.debug", "w");
     }
+    skip = !statistics && !debug;
 
     switch (type) {
         case DFNT_INT8:
@@ -217,6 +238,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
             i1ptr1 = (int8 *)buf1;
             i1ptr2 = (int8 *)buf2;
             for (i = 0; i < tot_cnt; i++) {
+                SKIP_SAME(int8, i1ptr1, i1ptr2);
                 c_diff   = (int8)abs(*i1ptr1 - *i1ptr2);
                 is_fill1 = fill1 && (*i1ptr1 == *((int8 *)fill1));
                 is_fill2 = fill2 && (*i1ptr2 == *((int8 *)fill2));
@@ -252,7 +274,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
 
                     if (not_comparable && !both_zero) /* not comparable */
                     {
-                        print_pos(&ph, i, acc, pos, rank, name1, name2);
+                        print_pos(&ph, i, acc, pos, offset, rank, name1, name2);
                         printf(SPACES);
                         printf(I8FORMATP_NOTCOMP, *i1ptr1, *i1ptr2);
                         n_diff++;
@@ -263,7 +285,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
                         if ((float)per > err_rel) {
                         n_diff++;
                         if (n_diff <= max_err_cnt) {
-                            print_pos(&ph, i, acc, pos, rank, name1, name2);
+                            print_pos(&ph, i, acc, pos, offset, rank, name1, name2);
                             printf(SPACES);
                             printf(I8FORMATP, *i1ptr1, *i1ptr2, per * 100);
                         }
@@ -273,7 +295,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
                 else if (c_diff > (int32)err_limit) {
                     n_diff++;
                     if (n_diff <= max_err_cnt) {
-                        print_pos(&ph, i, acc, pos, rank, name1, name2);
+                        print_pos(&ph, i, acc, pos, offset, rank, name1, name2);
                         printf(SPACES);
                         printf(I8FORMAT, *i1ptr1, *i1ptr2, abs(*i1ptr1 - *i1ptr2));
                     }
@@ -297,6 +319,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
             i2ptr1 = (int16 *)buf1;
             i2ptr2 = (int16 *)buf2;
             for (i = 0; i < tot_cnt; i++) {
+                SKIP_SAME(int16, i2ptr1, i2ptr2);
                 i2_diff  = (int16)abs(*i2ptr1 - *i2ptr2);
                 is_fill1 = fill1 && (*i2ptr1 == *((int16 *)fill1));
                 is_fill2 = fill2 && (*i2ptr2 == *((int16 *)fill2));
@@ -335,7 +358,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
 
                     if (not_comparable && !both_zero) /* not comparable */
                     {
-                        print_pos(&ph, i, acc, pos, rank, name1, name2);
+                        print_pos(&ph, i, acc, pos, offset, rank, name1, name2);
                         printf(SPACES);
                         printf(I16FORMATP_NOTCOMP, *i2ptr1, *i2ptr2);
                         n_diff++;
@@ -346,7 +369,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
                         if ((float)per > err_rel) {
                         n_diff++;
                         if (n_diff <= max_err_cnt) {
-                            print_pos(&ph, i, acc, pos, rank, name1, name2);
+                            print_pos(&ph, i, acc, pos, offset, rank, name1, name2);
                             printf(SPACES);
                             printf(I16FORMATP, *i2ptr1, *i2ptr2, per * 100);
                         }
@@ -356,7 +379,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
                 else if (i2_diff > (int)err_limit) {
                     n_diff++;
                     if (n_diff <= max_err_cnt) {
-                        print_pos(&ph, i, acc, pos, rank, name1, name2);
+                        print_pos(&ph, i, acc, pos, offset, rank, name1, name2);
                         printf(SPACES);
                         printf(I16FORMAT, *i2ptr1, *i2ptr2, abs(*i2ptr1 - *i2ptr2));
                     }
@@ -379,6 +402,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
             i4ptr1 = (int32 *)buf1;
             i4ptr2 = (int32 *)buf2;
             for (i = 0; i < tot_cnt; i++) {
+                SKIP_SAME(int32, i4ptr1, i4ptr2);
                 i4_diff  = labs(*i4ptr1 - *i4ptr2);
                 is_fill1 = fill1 && (*i4ptr1 == *((int32 *)fill1));
                 is_fill2 = fill2 && (*i4ptr2 == *((int32 *)fill2));
@@ -414,7 +438,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
 
                     if (not_comparable && !both_zero) /* not comparable */
                     {
-                        print_pos(&ph, i, acc, pos, rank, name1, name2);
+                        print_pos(&ph, i, acc, pos, offset, rank, name1, name2);
                         printf(SPACES);
                         printf(IFORMATP_NOTCOMP, *i4ptr1, *i4ptr2);
                         n_diff++;
@@ -425,7 +449,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
                         if ((float)per > err_rel) {
                         n_diff++;
                         if (n_diff <= max_err_cnt) {
-                            print_pos(&ph, i, acc, pos, rank, name1, name2);
+                            print_pos(&ph, i, acc, pos, offset, rank, name1, name2);
                             printf(SPACES);
                             printf(IFORMATP, *i4ptr1, *i4ptr2, per * 100);
                         }
@@ -435,7 +459,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
                 else if (i4_diff > (int32)err_limit) {
                     n_diff++;
                     if (n_diff <= max_err_cnt) {
-                        print_pos(&ph, i, acc, pos, rank, name1, name2);
+                        print_pos(&ph, i, acc, pos, offset, rank, name1, name2);
                         printf(SPACES);
                         printf(IFORMAT, *i4ptr1, *i4ptr2, i4_diff);
                     }
@@ -458,6 +482,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
             fptr1 = (float32 *)buf1;
             fptr2 = (float32 *)buf2;
             for (i = 0; i < tot_cnt; i++) {
+                SKIP_SAME(float32, fptr1, fptr2);
                 f_diff   = (float32)fabs(*fptr1 - *fptr2);
                 is_fill1 = fill1 && (*fptr1 == *((float32 *)fill1));
                 is_fill2 = fill2 && (*fptr2 == *((float32 *)fill2));
@@ -496,7 +521,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
 
                     if (not_comparable && !both_zero) /* not comparable */
                     {
-                        print_pos(&ph, i, acc, pos, rank, name1, name2);
+                        print_pos(&ph, i, acc, pos, offset, rank, name1, name2);
                         printf(SPACES);
                         printf(FFORMATP_NOTCOMP, (double)*fptr1, (double)*fptr2);
                         n_diff++;
@@ -507,7 +532,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
                         if ((float)per > err_rel) {
                         n_diff++;
                         if (n_diff <= max_err_cnt) {
-                            print_pos(&ph, i, acc, pos, rank, name1, name2);
+                            print_pos(&ph, i, acc, pos, offset, rank, name1, name2);
                             printf(SPACES);
                             printf(FFORMATP, (double)*fptr1, (double)*fptr2, per * 100);
                         }
@@ -517,7 +542,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
                 else if (f_diff > err_limit) {
                     n_diff++;
                     if (n_diff <= max_err_cnt) {
-                        print_pos(&ph, i, acc, pos, rank, name1, name2);
+                        print_pos(&ph, i, acc, pos, offset, rank, name1, name2);
                         printf(SPACES);
                         printf(FFORMAT, (double)*fptr1, (double)*fptr2, fabs(*fptr1 - *fptr2));
                     }
@@ -539,6 +564,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
             dptr1 = (float64 *)buf1;
             dptr2 = (float64 *)buf2;
             for (i = 0; i < tot_cnt; i++) {
+                SKIP_SAME(float64, dptr1, dptr2);
                 d_diff   = fabs(*dptr1 - *dptr2);
                 is_fill1 = fill1 && (*dptr1 == *((float64 *)fill1));
                 is_fill2 = fill2 && (*dptr2 == *((float64 *)fill2));
@@ -574,7 +600,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
 
                     if (not_comparable && !both_zero) /* not comparable */
                     {
-                        print_pos(&ph, i, acc, pos, rank, name1, name2);
+                        print_pos(&ph, i, acc, pos, offset, rank, name1, name2);
                         printf(SPACES);
                         printf(FFORMATP_NOTCOMP, *dptr1, *dptr2);
                         n_diff++;
@@ -585,7 +611,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
                         if ((float)per > err_rel) {
                         n_diff++;
                         if (n_diff <= max_err_cnt) {
-                            print_pos(&ph, i, acc, pos, rank, name1, name2);
+                            print_pos(&ph, i, acc, pos, offset, rank, name1, name2);
                             printf(SPACES);
                             printf(FFORMATP, *dptr1, *dptr2, per * 100);
                         }
@@ -595,7 +621,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
                 else if (d_diff > (float64)err_limit) {
                     n_diff++;
                     if (n_diff <= max_err_cnt) {
-                        print_pos(&ph, i, acc, pos, rank, name1, name2);
+                        print_pos(&ph, i, acc, pos, offset, rank, name1, name2);
                         printf(SPACES);
                         printf(FFORMAT, *dptr1, *dptr2, fabs(*dptr1 - *dptr2));
                     }
@@ -634,10 +660,52 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
     return n_diff;
 }
 
+/*-------------------------------------------------------------------------
+ * Function: next_mismatch
+ *
+ * Purpose: find the first element at or after I whose bytes differ in
+ *  BUF1 and BUF2, comparing whole blocks with memcmp and halving the first
+ *  block that differs
+ *
+ * Return: its index, or TOT_CNT if there is none
+ *
+ *-------------------------------------------------------------------------
+ */
+static uint32
+next_mismatch(const void *buf1, const void *buf2, uint32 i, uint32 tot_cnt, size_t size)
+{
+    const uint8 *p1 = (const uint8 *)buf1;
+    const uint8 *p2 = (const uint8 *)buf2;
+    uint32       n  = 0;
+    uint32       half;
+
+    while (i < tot_cnt) {
+        n = MYMIN(tot_cnt - i, SKIP_BLOCK);
+        if (memcmp(p1 + (size_t)i * size, p2 + (size_t)i * size, (size_t)n * size) != 0)
+            break;
+        i += n;
+    }
+    if (i == tot_cnt)
+        return tot_cnt;
+
+    /* the block of N elements at I differs */
+    while (n > 1) {
+        half = n / 2;
+        if (memcmp(p1 + (size_t)i * size, p2 + (size_t)i * size, (size_t)half * size) == 0) {
+            i += half;
+            n -= half;
+        }
+        else
+            n = half;
+    }
+    return i;
+}
+
 /*-------------------------------------------------------------------------
  * Function: print_pos
  *
- * Purpose: convert an array index position to matrix notation
+ * Purpose: convert an array index position to matrix notation, in the
+ *  whole array if the buffer is at offset in it
  *
  * Return: pos matrix array
  *
@@ -648,7 +716,8 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
  *-------------------------------------------------------------------------
  */
 static void
-print_pos(int *ph, uint32 curr_pos, int32 *acc, int32 *pos, int rank, const char *obj1, const char *obj2)
+print_pos(int *ph, uint32 curr_pos, int32 *acc, int32 *pos, int32 *offset, int rank, const char *obj1,
+          const char *obj2)
 {
     int i;
 
@@ -668,7 +737,7 @@ print_pos(int *ph, uint32 curr_pos, int32 *acc, int32 *pos, int rank, const char
 
     printf("[ ");
     for (i = 0; i < rank; i++) {
-        fprintf(stdout, "%d ", pos[i]);
+        fprintf(stdout, "%d ", (int)(pos[i] + (offset != NULL ? offset[i] : 0)));
     }
     printf("]");
 }
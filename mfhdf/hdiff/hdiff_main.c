@@ -46,7 +46,7 @@ usage()
 {
 
     (void)fprintf(stdout, "hdiff [-V] [-b] [-g] [-s] [-d] [-D] [-S] [-v var1[,...]] [-u var1[,...]] [-e "
-                          "count] [-t limit] [-p relative] file1 file2\n");
+                          "count] [-t limit] [-p relative] [-j count] [-M size] file1 file2\n");
     fprintf(stdout, "  [-V]              Display version of the HDF4 library and exit\n");
     fprintf(stdout, "  [-b]              Verbose mode\n");
     fprintf(stdout, "  [-g]              Compare global attributes only\n");
@@ -59,10 +59,13 @@ usage()
     fprintf(stdout, "  [-e count]        Print difference up to count number for each variable\n");
     fprintf(stdout, "  [-t limit]        Print difference when it is greater than limit\n");
     fprintf(stdout, "  [-p relative]     Print difference when it is greater than a relative limit\n");
+    fprintf(stdout, "  [-j count]        Compare objects in count processes at once\n");
+    fprintf(stdout, "  [-M size]         Compare SD data by hyperslabs of whole chunks of at most\n");
+    fprintf(stdout, "                    size bytes (default %d), at least one chunk\n", SLAB_BYTES);
     fprintf(stdout, "  file1             File name of the first HDF file\n");
     fprintf(stdout, "  file2             File name of the second HDF file\n");
     fprintf(stdout, "\n");
-    fprintf(stdout, "The 'count' value must be a positive integer\n");
+    fprintf(stdout, "The 'count' values must be positive integers\n");
     fprintf(stdout, "The 'limit' and 'relative' values must be positive numbers\n");
     fprintf(stdout, "The -t compare criteria is |a - b| > limit\n");
     fprintf(stdout, "The -p compare criteria is |(b-a)/a| > relative\n");
@@ -75,21 +78,23 @@ main(int argc, char *argv[])
 {
     static diff_opt_t opt = /* defaults, overridden on command line */
         {
-            0,        /* verbose mode */
-            1,        /* compare global attributes */
-            1,        /* compare SD local attributes */
-            1,        /* compare SD data */
-            1,        /* compare GR data */
-            1,        /* compare Vdata */
-            MAX_DIFF, /* no limit on the difference to be printed */
-            0.0,      /* exact equal */
-            0,        /* if -v specified, number of variables */
-            0,        /* if -v specified, list of variable names */
-            0,        /* if -u specified, number of variables */
-            0,        /* if -u specified, list of variable names */
-            0,        /* if -S specified print statistics */
-            0,        /* -p err_rel */
-            0,        /* error status */
+            0,          /* verbose mode */
+            1,          /* compare global attributes */
+            1,          /* compare SD local attributes */
+            1,          /* compare SD data */
+            1,          /* compare GR data */
+            1,          /* compare Vdata */
+            MAX_DIFF,   /* no limit on the difference to be printed */
+            0.0,        /* exact equal */
+            0,          /* if -v specified, number of variables */
+            0,          /* if -v specified, list of variable names */
+            0,          /* if -u specified, number of variables */
+            0,          /* if -u specified, list of variable names */
+            0,          /* if -S specified print statistics */
+            0,          /* -p err_rel */
+            0,          /* error status */
+            1,          /* -j number of worker processes */
+            SLAB_BYTES, /* -M size of the hyperslabs */
         };
     int    c;
     uint32 nfound;
@@ -101,7 +106,7 @@ main(int argc, char *argv[])
     if (argc < 2)
         usage();
 
-    while ((c = h4getopt(argc, argv, "VbgsdSDe:t:v:u:p:")) != EOF) {
+    while ((c = h4getopt(argc, argv, "VbgsdSDe:t:v:u:p:j:M:")) != EOF) {
         switch (c) {
             case 'V': /* display version of the library */
                 printf("%s, %s\n\n", argv[0], LIBVER_STRING);
@@ -153,11 +158,25 @@ main(int argc, char *argv[])
             case 'p':
                 opt.err_rel = (float32)atof(h4optarg);
                 break;
+            case 'j': /* number of worker processes */
+                opt.nworkers = atoi(h4optarg);
+                if (opt.nworkers < 1)
+                    usage();
+                break;
+            case 'M': /* size of the hyperslabs */
+                opt.slabsize = atoi(h4optarg);
+                if (opt.slabsize < 1)
+                    usage();
+                break;
         }
     }
 
     argv = argv + h4optind;
 
+    /* the files are read through once: have the system read ahead, and
+       drop what was read so as not to flush the page cache */
+    Hsetaccesspattern(CACHE_ALL_FILES, HDF_ACCESS_SEQUENTIAL | HDF_ACCESS_DONTNEED);
+
     nfound = hdiff(argv[0], argv[1], &opt);
 
     /*-------------------------------------------------------------------------
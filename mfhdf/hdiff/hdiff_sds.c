@@ -16,11 +16,12 @@
 #include "hdiff_list.h"
 #include "hdiff_mattbl.h"
 
-#define H4TOOLS_BUFSIZE    (1024 * 1024)
-#define H4TOOLS_MALLOCSIZE (1024 * 1024)
-
 static uint32 diff_sds_attrs(int32 sds1_id, int32 nattrs1, int32 sds2_id, int32 nattrs2, char *sds1_name,
                              diff_opt_t *opt);
+static int    same_chunks(int32 sds1_id, int32 sds2_id, int rank, int32 *dimsizes);
+static void   plan_slab(int32 rank, int32 *dimsizes, int32 eltsz, int32 *chunk_lengths, int32 slab_bytes,
+                        int32 *sm_size);
+static int32  slab_chunks(int32 rank, int32 *dimsizes, int32 *chunk_lengths, int32 *sm_size);
 
 /*-------------------------------------------------------------------------
  * Function: diff_sds
@@ -54,7 +55,10 @@ diff_sds(int32 sd1_id, int32 sd2_id, int32 ref1, int32 ref2, diff_opt_t *opt)
         start[H4_MAX_VAR_DIMS],     /* read start */
         edges[H4_MAX_VAR_DIMS],     /* read edges */
         numtype,                    /* number type */
-        eltsz;                      /* element size */
+        eltsz,                      /* element size */
+        sm_size[H4_MAX_VAR_DIMS],   /* hyperslab of each pass */
+        chunk_flags1,               /* chunking of SDS 1 */
+        chunk_flags2;               /* chunking of SDS 2 */
     uint32 nelms;                   /* number of elements */
     size_t need;                    /* read size needed */
     char   sds1_name[H4_MAX_NC_NAME];
@@ -72,6 +76,9 @@ diff_sds(int32 sd1_id, int32 sd2_id, int32 ref1, int32 ref2, diff_opt_t *opt)
     void  *sm_buf1 = NULL;
     void  *sm_buf2 = NULL;
 
+    HDF_CHUNK_DEF chunk_def1; /* chunk lengths of SDS 1 */
+    HDF_CHUNK_DEF chunk_def2; /* chunk lengths of SDS 2 */
+
     /*-------------------------------------------------------------------------
      * object 1
      *-------------------------------------------------------------------------
@@ -222,6 +229,23 @@ diff_sds(int32 sd1_id, int32 sd2_id, int32 ref1, int32 ref2, diff_opt_t *opt)
             fill2 = NULL;
         }
 
+        /*-------------------------------------------------------------------------
+         * chunked SDSs with the same layout, coding and fill value whose
+         * stored chunks are all byte for byte the same hold the same data;
+         * for those compare the stored chunks and skip decoding them.
+         * -S needs the decoded values, so it always reads them
+         *-------------------------------------------------------------------------
+         */
+
+        if (!opt->statistics &&
+            ((fill1 == NULL && fill2 == NULL) ||
+             (fill1 != NULL && fill2 != NULL && memcmp(fill1, fill2, (size_t)eltsz) == 0)) &&
+            same_chunks(sds1_id, sds2_id, rank1, dimsizes1)) {
+            if (opt->verbose)
+                printf("Comparing <%s>\n", sds1_name);
+            goto sds_compared;
+        }
+
         /*-------------------------------------------------------------------------
          * read
          *-------------------------------------------------------------------------
@@ -234,11 +258,44 @@ diff_sds(int32 sd1_id, int32 sd2_id, int32 ref1, int32 ref2, diff_opt_t *opt)
 
         need = (size_t)(nelms * eltsz); /* bytes needed */
 
-        if (need < H4TOOLS_MALLOCSIZE) {
+        if (need < (size_t)opt->slabsize) {
             buf1 = (void *)malloc(need);
             buf2 = (void *)malloc(need);
         }
 
+        /*-------------------------------------------------------------------------
+         * unless read at once, the data is compared by hyperslabs of whole
+         * chunks of the first SDS, and the chunk cache of each SDS holds the
+         * chunks of one hyperslab, so that no chunk is decoded twice
+         *-------------------------------------------------------------------------
+         */
+
+        if (SDgetchunkinfo(sds1_id, &chunk_def1, &chunk_flags1) == FAIL ||
+            SDgetchunkinfo(sds2_id, &chunk_def2, &chunk_flags2) == FAIL) {
+            printf("Failed to get chunk info for SDS <%s>\n", sds1_name);
+            goto out;
+        }
+
+        if (buf1 != NULL && buf2 != NULL)
+            for (i = 0; i < rank1; i++)
+                sm_size[i] = dimsizes1[i];
+        else
+            plan_slab(rank1, dimsizes1, eltsz, chunk_flags1 != HDF_NONE ? chunk_def1.chunk_lengths : NULL,
+                      opt->slabsize, sm_size);
+
+        if (chunk_flags1 != HDF_NONE &&
+            SDsetchunkcache(sds1_id, slab_chunks(rank1, dimsizes1, chunk_def1.chunk_lengths, sm_size), 0) ==
+                FAIL) {
+            printf("Failed to set chunk cache for SDS <%s>\n", sds1_name);
+            goto out;
+        }
+        if (chunk_flags2 != HDF_NONE &&
+            SDsetchunkcache(sds2_id, slab_chunks(rank1, dimsizes1, chunk_def2.chunk_lengths, sm_size), 0) ==
+                FAIL) {
+            printf("Failed to set chunk cache for SDS <%s>\n", sds2_name);
+            goto out;
+        }
+
         /*-------------------------------------------------------------------------
          * read all
          *-------------------------------------------------------------------------
@@ -274,21 +331,19 @@ diff_sds(int32 sd1_id, int32 sd2_id, int32 ref1, int32 ref2, diff_opt_t *opt)
             /* if the given max_err_cnt is set (i.e. not its default MAX_DIFF),
                use it, otherwise, use the total number of elements in the dataset */
             max_err_cnt = (opt->max_err_cnt != MAX_DIFF) ? opt->max_err_cnt : nelms;
-            nfound      = array_diff(buf1, buf2, nelms, sds1_name, sds2_name, rank1, dimsizes1, dtype1,
+            nfound      = array_diff(buf1, buf2, nelms, sds1_name, sds2_name, rank1, dimsizes1, NULL, dtype1,
                                      opt->err_limit, opt->err_rel, max_err_cnt, opt->statistics, fill1, fill2);
         }
 
         else /* possibly not enough memory, read/compare by hyperslabs */
 
         {
-            size_t p_type_nbytes = eltsz; /*size of type */
-            uint32 p_nelmts      = nelms; /*total selected elmts */
-            uint32 elmtno;                /*counter  */
-            int    carry;                 /*counter carry value */
+            uint32 p_nelmts = nelms; /*total selected elmts */
+            uint32 elmtno;           /*counter  */
+            int    carry;            /*counter carry value */
 
             /* stripmine info */
-            int32 sm_size[H4_MAX_VAR_DIMS]; /*stripmine size */
-            int32 sm_nbytes;                /*bytes per stripmine */
+            int32 sm_nbytes; /*bytes per stripmine */
 
             /* hyperslab info */
             int32 hs_offset[H4_MAX_VAR_DIMS]; /*starting offset */
@@ -296,13 +351,11 @@ diff_sds(int32 sd1_id, int32 sd2_id, int32 ref1, int32 ref2, diff_opt_t *opt)
             int32 hs_nelmts;                  /*elements in request */
 
             /*
-             * determine the strip mine size and allocate a buffer. The strip mine is
-             * a hyperslab whose size is manageable.
+             * allocate buffers for the strip mine, the hyperslab planned above
              */
-            sm_nbytes = p_type_nbytes;
+            sm_nbytes = eltsz;
 
             for (i = rank1; i > 0; --i) {
-                sm_size[i - 1] = MIN(dimsizes1[i - 1], H4TOOLS_BUFSIZE / sm_nbytes);
                 sm_nbytes *= sm_size[i - 1];
                 assert(sm_nbytes > 0);
             }
@@ -351,9 +404,9 @@ diff_sds(int32 sd1_id, int32 sd2_id, int32 ref1, int32 ref2, diff_opt_t *opt)
                 /* get array differences. in the case of hyperslab read, increment the number of differences
                    found in each hyperslab and pass the position at the beginning for printing
                  */
-                nfound =
-                    array_diff(sm_buf1, sm_buf2, hs_nelmts, sds1_name, sds2_name, rank1, dimsizes1, dtype1,
-                               opt->err_limit, opt->err_rel, max_err_cnt, opt->statistics, fill1, fill2);
+                nfound += array_diff(sm_buf1, sm_buf2, hs_nelmts, sds1_name, sds2_name, rank1, hs_size,
+                                     hs_offset, dtype1, opt->err_limit, opt->err_rel, max_err_cnt,
+                                     opt->statistics, fill1, fill2);
 
                 /* calculate the next hyperslab offset */
                 for (i = rank1, carry = 1; i > 0 && carry; --i) {
@@ -373,6 +426,7 @@ diff_sds(int32 sd1_id, int32 sd2_id, int32 ref1, int32 ref2, diff_opt_t *opt)
 
         } /* hyperslab read */
 
+sds_compared:;
     } /* flag to compare SDSs */
 
     /* flag to compare SDSs local attributes */
@@ -413,6 +467,158 @@ out:
     return 0;
 }
 
+/*-------------------------------------------------------------------------
+ * Function: plan_slab
+ *
+ * Purpose: pick the size of the hyperslabs SDSs are compared by, of at most
+ *  slab_bytes bytes, grown from the fastest varying dimension.  For chunked
+ *  SDSs (chunk_lengths not NULL) they are made of whole chunks, at least
+ *  one, so that their offsets fall on chunk boundaries
+ *
+ * Return: void
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static void
+plan_slab(int32 rank, int32 *dimsizes, int32 eltsz, int32 *chunk_lengths, int32 slab_bytes, int32 *sm_size)
+{
+    int32 sm_nbytes = eltsz; /* bytes of the hyperslab so far */
+    int32 unit;              /* step of the size along a dimension */
+    int32 n;                 /* steps fitting in slab_bytes */
+    int   i;
+
+    for (i = rank; i > 0; --i) {
+        unit = (chunk_lengths != NULL) ? chunk_lengths[i - 1] : 1;
+        n    = slab_bytes / sm_nbytes / unit;
+        if (n < 1)
+            n = 1;
+        sm_size[i - 1] = MIN(dimsizes[i - 1], n * unit);
+        sm_nbytes *= sm_size[i - 1];
+    }
+}
+
+/*-------------------------------------------------------------------------
+ * Function: slab_chunks
+ *
+ * Purpose: count the chunks a hyperslab of size sm_size, at an offset that
+ *  is a multiple of it, can overlap
+ *
+ * Return: the number of chunks
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static int32
+slab_chunks(int32 rank, int32 *dimsizes, int32 *chunk_lengths, int32 *sm_size)
+{
+    int32 nchunks = 1;
+    int32 n;
+    int   i;
+
+    for (i = 0; i < rank; i++) {
+        n = sm_size[i] / chunk_lengths[i];
+        if (sm_size[i] % chunk_lengths[i] != 0)
+            n += 2;
+        nchunks *= MIN(n, (dimsizes[i] + chunk_lengths[i] - 1) / chunk_lengths[i]);
+    }
+
+    return nchunks;
+}
+
+/*-------------------------------------------------------------------------
+ * Function: same_chunks
+ *
+ * Purpose: check whether two SDSs are chunked the same way with the same
+ *  compression, and every chunk is stored with the same bytes in both,
+ *  reading the chunks with SDreadchunkraw without decoding them; stops at
+ *  the first chunk that differs
+ *
+ * Return: 1 if so, 0 if not or if this cannot be told
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static int
+same_chunks(int32 sds1_id, int32 sds2_id, int rank, int32 *dimsizes)
+{
+    HDF_CHUNK_DEF chunk_def1, chunk_def2;
+    int32         flags1, flags2;
+    comp_coder_t  comp_type1, comp_type2;
+    comp_info     c_info1, c_info2;
+    int32         nchunks[H4_MAX_VAR_DIMS]; /* number of chunks along each dimension */
+    int32         origin[H4_MAX_VAR_DIMS];  /* chunk being compared */
+    int32         len1, len2;
+    int32         buflen = 0;
+    uint8        *raw1   = NULL;
+    uint8        *raw2   = NULL;
+    int           same   = 0;
+    int           i;
+
+    memset(&chunk_def1, 0, sizeof(chunk_def1));
+    memset(&chunk_def2, 0, sizeof(chunk_def2));
+    if (SDgetchunkinfo(sds1_id, &chunk_def1, &flags1) == FAIL ||
+        SDgetchunkinfo(sds2_id, &chunk_def2, &flags2) == FAIL)
+        return 0;
+    if (flags1 == HDF_NONE || flags1 != flags2)
+        return 0;
+    for (i = 0; i < rank; i++)
+        if (chunk_def1.chunk_lengths[i] != chunk_def2.chunk_lengths[i] || chunk_def1.chunk_lengths[i] <= 0)
+            return 0;
+
+    /* the stored bytes mean the same only if they are decoded the same way */
+    memset(&c_info1, 0, sizeof(c_info1));
+    memset(&c_info2, 0, sizeof(c_info2));
+    if (SDgetcompinfo(sds1_id, &comp_type1, &c_info1) == FAIL ||
+        SDgetcompinfo(sds2_id, &comp_type2, &c_info2) == FAIL)
+        return 0;
+    if (comp_type1 != comp_type2 || memcmp(&c_info1, &c_info2, sizeof(comp_info)) != 0)
+        return 0;
+
+    for (i = 0; i < rank; i++) {
+        nchunks[i] = (dimsizes[i] + chunk_def1.chunk_lengths[i] - 1) / chunk_def1.chunk_lengths[i];
+        if (nchunks[i] == 0)
+            return 0;
+        origin[i] = 0;
+    }
+
+    for (;;) {
+        if ((len1 = SDreadchunkraw(sds1_id, origin, NULL, 0)) == FAIL ||
+            (len2 = SDreadchunkraw(sds2_id, origin, NULL, 0)) == FAIL || len1 != len2)
+            goto done;
+
+        if (len1 > 0) {
+            if (len1 > buflen) {
+                free(raw1);
+                free(raw2);
+                buflen = len1;
+                raw1   = (uint8 *)malloc((size_t)buflen);
+                raw2   = (uint8 *)malloc((size_t)buflen);
+                if (raw1 == NULL || raw2 == NULL)
+                    goto done;
+            }
+            if (SDreadchunkraw(sds1_id, origin, raw1, buflen) != len1 ||
+                SDreadchunkraw(sds2_id, origin, raw2, buflen) != len1 || memcmp(raw1, raw2, (size_t)len1) != 0)
+                goto done;
+        }
+
+        /* next chunk, last dimension fastest */
+        for (i = rank - 1; i >= 0; i--) {
+            if (++origin[i] < nchunks[i])
+                break;
+            origin[i] = 0;
+        }
+        if (i < 0)
+            break;
+    }
+    same = 1;
+
+done:
+    free(raw1);
+    free(raw2);
+    return same;
+}
+
 /*-------------------------------------------------------------------------
  * Function: diff_sds_attrs
  *
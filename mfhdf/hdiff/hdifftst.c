@@ -14,6 +14,10 @@
 /* groups */
 #define FILE7_NAME "hdifftst7.hdf"
 
+/* chunked, compressed datasets */
+#define FILE8_NAME "hdifftst8.hdf"
+#define FILE9_NAME "hdifftst9.hdf"
+
 #define X_LENGTH       2
 #define Y_LENGTH       3
 #define RANK           2
@@ -47,6 +51,7 @@
  */
 static int do_big_file(void);
 static int do_groups(void);
+static int do_chunks(void);
 
 /*-------------------------------------------------------------------------
  * main
@@ -303,6 +308,13 @@ main(void)
     if (do_groups() == FAIL)
         goto error;
 
+    /*-------------------------------------------------------------------------
+     * chunked, compressed datasets
+     *-------------------------------------------------------------------------
+     */
+    if (do_chunks() == FAIL)
+        goto error;
+
     return 0;
 
 error:
@@ -669,3 +681,69 @@ out:
     printf("Error...Exiting...\n");
     return FAIL;
 }
+
+/*-------------------------------------------------------------------------
+ * write 2 files with chunked, deflated datasets
+ * "same" is identical in both files, "changed" differs in one value
+ *-------------------------------------------------------------------------
+ */
+
+static int
+write_chunks(const char *fname, int32 delta)
+{
+    int32         sd_id, sds_id;
+    int32         dims[2]   = {8, 8};
+    int32         start[2]  = {0, 0};
+    int32         edges[2]  = {8, 8};
+    int32         buf[8][8];
+    HDF_CHUNK_DEF chunk_def;
+    const char   *names[2] = {"same", "changed"};
+    int           i, j, k;
+
+    for (i = 0; i < 8; i++)
+        for (j = 0; j < 8; j++)
+            buf[i][j] = i * 8 + j;
+
+    if ((sd_id = SDstart(fname, DFACC_CREATE)) == FAIL) {
+        printf("Error: Could not create file <%s>\n", fname);
+        return FAIL;
+    }
+
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]    = 4;
+    chunk_def.comp.chunk_lengths[1]    = 4;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 6;
+
+    for (k = 0; k < 2; k++) {
+        if ((sds_id = SDcreate(sd_id, names[k], DFNT_INT32, 2, dims)) == FAIL)
+            goto out;
+        if (SDsetchunk(sds_id, chunk_def, HDF_CHUNK | HDF_COMP) == FAIL)
+            goto out;
+        if (k == 1)
+            buf[5][6] += delta;
+        if (SDwritedata(sds_id, start, NULL, edges, buf) == FAIL)
+            goto out;
+        if (SDendaccess(sds_id) == FAIL)
+            goto out;
+    }
+
+    if (SDend(sd_id) == FAIL)
+        return FAIL;
+
+    return SUCCEED;
+
+out:
+    printf("Error...Exiting...\n");
+    return FAIL;
+}
+
+static int
+do_chunks(void)
+{
+    if (write_chunks(FILE8_NAME, 0) == FAIL)
+        return FAIL;
+    if (write_chunks(FILE9_NAME, 1) == FAIL)
+        return FAIL;
+    return SUCCEED;
+}
@@ -300,3 +300,61 @@ ADD_H4_TEST(VGROUP "TEST" ${HREPACK_FILE3})
 
 #    if (vg_verifygrpdep(HREPACK_FILE3,HREPACK_FILE3_OUT) != 0 )
 #        goto out;
+
+#-------------------------------------------------------------------------
+# test12:
+# repack without changing the compression, the chunks of the
+# chunked and compressed SDSs are copied without decoding them
+#-------------------------------------------------------------------------
+#
+ADD_H4_TEST(CHUNK_COPY "TEST" ${HREPACK_FILE1})
+
+#-------------------------------------------------------------------------
+# test13:
+# deflate the chunks of an SDS and an image on several threads
+#-------------------------------------------------------------------------
+#
+ADD_H4_TEST(THREADS "TEST" ${HREPACK_FILE1} -j 4 -t "dset4:GZIP 9" -c dset4:10x8 -t "gr_none:GZIP 9" -c gr_none:10x8)
+
+#-------------------------------------------------------------------------
+# test14:
+# chunk all objects with lengths picked for tile reads of 4 KB chunks,
+# and selected SDSs and images for row and column scans
+#-------------------------------------------------------------------------
+#
+ADD_H4_TEST(CHUNK_AUTO "TEST" ${HREPACK_FILE1} -t "*:GZIP 1" -c "auto:tile:4096")
+ADD_H4_TEST(CHUNK_AUTO_SEL "TEST" ${HREPACK_FILE1} -c "dset4,gr_none:auto:row:512" -c "dset5,gr_8bit:auto:col")
+
+#-------------------------------------------------------------------------
+# test15:
+# page-aligned layout, as is and with the storage changed
+#-------------------------------------------------------------------------
+#
+ADD_H4_TEST(ALIGN "TEST" ${HREPACK_FILE1} -a 4096)
+ADD_H4_TEST(ALIGN_CHUNK "TEST" ${HREPACK_FILE1} -t "*:GZIP 1" -c "auto:tile:4096" -a 4096:1024)
+
+#-------------------------------------------------------------------------
+# test16:
+# store identical chunks once, when chunking anew and when copying
+# the stored chunks
+#-------------------------------------------------------------------------
+#
+ADD_H4_TEST(DEDUP "TEST" ${HREPACK_FILE1} -d -t "dset4:GZIP 9" -c dset4:10x8)
+ADD_H4_TEST(DEDUP_COPY "TEST" ${HREPACK_FILE1} -d)
+
+#-------------------------------------------------------------------------
+# test17:
+# decode the chunked SDSs by hyperslabs of whole chunks, of at most
+# 256 bytes
+#-------------------------------------------------------------------------
+#
+ADD_H4_TEST(SLAB "TEST" ${HREPACK_FILE1} -M 256 -t "*:RLE")
+
+#-------------------------------------------------------------------------
+# test18:
+# check all the SDSs written on 3 processes, and half of the chunks
+# copied as stored
+#-------------------------------------------------------------------------
+#
+ADD_H4_TEST(VERIFY "TEST" ${HREPACK_FILE1} -k 100 -j 3 -t "dset4:GZIP 9" -c dset4:10x8)
+ADD_H4_TEST(VERIFY_COPY "TEST" ${HREPACK_FILE1} -k 50)
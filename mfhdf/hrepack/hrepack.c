@@ -28,7 +28,8 @@ int list_main(const char *infname, const char *outfname, options_t *options);
  *
  * Algorithm: 2 traversals are made to the file; the 1st builds a list of
  *  the high-level objects, the 2nd makes a copy of them, using the options;
- *  the reason for the 1st traversal is to check for invalid object name requests
+ *  the reason for the 1st traversal is to check for invalid object name requests;
+ *  with -k the SDSs written are then checked against checksums taken on the 2nd
  *
  * Return: FAIL, SUCCEED
  *
@@ -41,6 +42,8 @@ int list_main(const char *infname, const char *outfname, options_t *options);
 int
 hrepack_main(const char *infile, const char *outfile, options_t *options)
 {
+    int nfound;
+
     options->trip = 0;
 
     /* also checks input */
@@ -57,10 +60,26 @@ hrepack_main(const char *infile, const char *outfile, options_t *options)
     if (options->verbose)
         printf("Making new file %s...\n", outfile);
 
+    /* the checksums of the SDS data written */
+    if (options->verify)
+        verify_table_init(&(options->vf_tbl));
+
     /* this can fail for different reasons */
     if (list_main(infile, outfile, options) < 0)
         return FAIL;
 
+    /* read the new file back */
+    if (options->verify) {
+        if (options->verbose)
+            printf("Verifying new file %s...\n", outfile);
+
+        if ((nfound = hrepack_verify(outfile, options)) != 0) {
+            if (nfound > 0)
+                printf("Error: %d parts of the SDSs in <%s> differ from what was written\n", nfound, outfile);
+            return FAIL;
+        }
+    }
+
     return SUCCEED;
 }
 
@@ -147,11 +166,10 @@ int
 hrepack_addchunk(const char *str, options_t *options)
 {
 
-    obj_list_t *obj_list = NULL;                /*one object list for the -t and -c option entry */
-    int         n_objs;                         /*number of objects in the current -t or -c option entry */
-    int32       chunk_lengths[H4_MAX_VAR_DIMS]; /* chunk lengths along each dimension */
-    int         chunk_rank;                     /*global rank for chunks */
-    int         i, j;
+    obj_list_t  *obj_list = NULL; /*one object list for the -t and -c option entry */
+    int          n_objs;          /*number of objects in the current -t or -c option entry */
+    chunk_info_t chunk;           /* chunk lengths and rank, or an "auto:" pattern */
+    int          i;
 
     if (options->all_chunk == 1) {
         printf("Error: Invalid chunking input: '*' is present with other objects <%s>\n", str);
@@ -159,27 +177,26 @@ hrepack_addchunk(const char *str, options_t *options)
     }
 
     /* parse the -c option */
-    if ((obj_list = parse_chunk(str, &n_objs, chunk_lengths, &chunk_rank)) == NULL)
+    memset(&chunk, 0, sizeof(chunk));
+    if ((obj_list = parse_chunk(str, &n_objs, &chunk)) == NULL)
         return FAIL;
 
     /* searh for the "*" all objects character */
     for (i = 0; i < n_objs; i++) {
         if (strcmp("*", obj_list[i].obj) == 0) {
             /* if we are chunking all set the global chunking type */
-            options->all_chunk    = 1;
-            options->chunk_g.rank = chunk_rank;
-            for (j = 0; j < chunk_rank; j++)
-                options->chunk_g.chunk_lengths[j] = chunk_lengths[j];
+            options->all_chunk = 1;
+            options->chunk_g   = chunk;
         }
     }
 
-    if (i > 1) {
+    if (i > 1 && options->all_chunk == 1) {
         printf("\nError: '*' cannot be with other objects, <%s>. Exiting...\n", str);
         goto out;
     }
 
     if (options->all_chunk == 0) {
-        if (options_add_chunk(obj_list, n_objs, chunk_lengths, chunk_rank, options->op_tbl) < 0)
+        if (options_add_chunk(obj_list, n_objs, chunk, options->op_tbl) < 0)
             goto out;
     }
 
@@ -205,6 +222,8 @@ hrepack_init(options_t *options, int verbose)
 {
     memset(options, 0, sizeof(options_t));
     options->threshold = 1024;
+    options->nthreads  = 1;
+    options->slabsize  = SLAB_BYTES;
     options->verbose   = verbose;
     options_table_init(&(options->op_tbl));
 }
@@ -221,6 +240,7 @@ void
 hrepack_end(options_t *options)
 {
     options_table_free(options->op_tbl);
+    verify_table_free(options->vf_tbl);
 }
 
 /*-------------------------------------------------------------------------
@@ -247,7 +267,10 @@ print_options(options_t *options)
      */
     if (options->verbose) {
         printf("Objects to chunk are...\n");
-        if (options->all_chunk == 1) {
+        if (options->all_chunk == 1 && options->chunk_g.rank == CHUNK_AUTO)
+            printf("\tChunk all with auto:%s:%d\n", get_sauto(options->chunk_g.pattern),
+                   options->chunk_g.chunk_bytes);
+        else if (options->all_chunk == 1) {
             printf("\tChunk all with dimension [");
             for (j = 0; j < options->chunk_g.rank; j++)
                 printf("%d ", options->chunk_g.chunk_lengths[j]);
@@ -272,6 +295,12 @@ print_options(options_t *options)
                 printf("\t%s %s\n", obj_name, "NONE");
             has_ck = 1;
         }
+        else if (options->op_tbl->objs[i].chunk.rank == CHUNK_AUTO) {
+            if (options->verbose)
+                printf("\t%s auto:%s:%d\n", obj_name, get_sauto(options->op_tbl->objs[i].chunk.pattern),
+                       options->op_tbl->objs[i].chunk.chunk_bytes);
+            has_ck = 1;
+        }
     }
 
     if (options->all_chunk == 1 && has_ck) {
@@ -296,6 +325,8 @@ print_options(options_t *options)
                     break;
                 case COMP_CODE_SKPHUFF:
                 case COMP_CODE_DEFLATE:
+                case COMP_CODE_ZSTD:
+                case COMP_CODE_LZ4:
                 case COMP_CODE_JPEG:
                     printf("\tCompress all with %s compression, parameter %d\n",
                            get_scomp(options->comp_g.type), options->comp_g.info);
@@ -321,6 +352,10 @@ print_options(options_t *options)
         return FAIL;
     }
 
+    if (options->verbose && options->alignment > 0)
+        printf("Elements of %d bytes or more are aligned to %d bytes\n", (int)options->align_min,
+               (int)options->alignment);
+
     return SUCCEED;
 }
 
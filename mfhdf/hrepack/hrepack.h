@@ -15,6 +15,7 @@
 #define HREPACK_H
 
 #include "hrepack_lsttable.h"
+#include "hrepack_verify.h"
 
 #ifdef H4_HAVE_LIBSZ
 #include "szlib.h"
@@ -24,6 +25,16 @@
 #define TAG_GRP_IMAGE DFTAG_RIG
 #define TAG_GRP_DSET  DFTAG_NDG
 
+/* chunking picked per object from its shape by "-c auto:<pattern>" */
+#define CHUNK_AUTO       (-3)          /* chunk_info_t.rank of an "auto:" option */
+#define AUTO_ROW         0             /* reads along the fastest varying dimension */
+#define AUTO_COL         1             /* reads along the slowest varying dimension */
+#define AUTO_TILE        2             /* reads of rectangles of the two fastest dimensions */
+#define AUTO_CHUNK_BYTES 1048576       /* default target size of a chunk */
+#define AUTO_MAX_CHUNKS  (MAX_REF / 2) /* chunks take refs shared with all other elements */
+
+#define SLAB_BYTES 1048576 /* default size of the hyperslabs an SDS is copied by, "-M" */
+
 /* a list of names */
 typedef struct {
     char obj[H4_MAX_NC_NAME];
@@ -36,10 +47,13 @@ typedef struct {
     int          szip_mode; /* NN_MODE or EC_MODE */
 } comp_info_t;
 
-/* chunk lengths along each dimension and rank */
+/* chunk lengths along each dimension and rank; a rank of -2 unchunks and a
+   rank of CHUNK_AUTO picks the lengths of each object from its shape */
 typedef struct {
     int32 chunk_lengths[H4_MAX_VAR_DIMS];
     int   rank;
+    int   pattern;     /* CHUNK_AUTO: AUTO_ROW, AUTO_COL or AUTO_TILE */
+    int32 chunk_bytes; /* CHUNK_AUTO: target size of a chunk */
 } chunk_info_t;
 
 /* information for one object, contains PATH, CHUNK info and COMP info */
@@ -66,6 +80,13 @@ typedef struct {
     int              verbose;   /*verbose mode */
     int              trip;      /*which cycle are we in */
     int              threshold; /*minimum size to compress, in bytes */
+    int              nthreads;  /*threads coding compressed chunks */
+    int              dedup;     /*share the data of identical SDS chunks */
+    int32            slabsize;  /*size of the hyperslabs SDSs are copied by */
+    int32            alignment; /*alignment of the data elements, 0 for none */
+    int32            align_min; /*size from which elements are aligned */
+    int              verify;    /*percent of the SDS data verified, 0 for none */
+    verify_table_t  *vf_tbl;    /*checksums of the SDS data written */
 } options_t;
 
 #ifdef __cplusplus
@@ -78,6 +99,7 @@ int  hrepack_addchunk(const char *str, options_t *options);
 void hrepack_init(options_t *options, int verbose);
 void hrepack_end(options_t *options);
 int  hrepack_main(const char *infile, const char *outfile, options_t *options);
+int  hrepack_verify(const char *fname, options_t *options);
 
 int list(const char *infname, const char *outfname, options_t *options);
 int read_info(const char *filename, options_t *options);
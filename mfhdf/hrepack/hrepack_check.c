@@ -124,6 +124,12 @@ sds_get_compck(char *fname, char *sds_name)
             case COMP_CODE_DEFLATE:
                 printf("level:  %d \n", cinfo.deflate.level);
                 break;
+            case COMP_CODE_ZSTD:
+                printf("level:  %d \n", cinfo.zstd.level);
+                break;
+            case COMP_CODE_LZ4:
+                printf("acceleration:  %d \n", cinfo.lz4.acceleration);
+                break;
             case COMP_CODE_JPEG:
                 printf("quality factor:  %d \n", cinfo.jpeg.quality);
                 break;
@@ -221,6 +227,10 @@ get_scomp(comp_coder_t code)
         return "HUFF";
     else if (code == COMP_CODE_DEFLATE)
         return "GZIP";
+    else if (code == COMP_CODE_ZSTD)
+        return "ZSTD";
+    else if (code == COMP_CODE_LZ4)
+        return "LZ4";
     else if (code == COMP_CODE_JPEG)
         return "JPEG";
     if (code == COMP_CODE_SZIP)
@@ -291,6 +291,14 @@ gen_dim(char *name, /* name of SDS */
                     chunk_def_in.comp.comp_type     = COMP_CODE_DEFLATE;
                     chunk_def_in.comp.cinfo.deflate = c_info_in.deflate;
                     break;
+                case COMP_CODE_ZSTD:
+                    chunk_def_in.comp.comp_type  = COMP_CODE_ZSTD;
+                    chunk_def_in.comp.cinfo.zstd = c_info_in.zstd;
+                    break;
+                case COMP_CODE_LZ4:
+                    chunk_def_in.comp.comp_type = COMP_CODE_LZ4;
+                    chunk_def_in.comp.cinfo.lz4 = c_info_in.lz4;
+                    break;
                 case COMP_CODE_SZIP:
 #ifdef H4_HAVE_LIBSZ
                     chunk_def_in.comp.comp_type  = COMP_CODE_SZIP;
@@ -345,6 +353,12 @@ gen_dim(char *name, /* name of SDS */
             case COMP_CODE_DEFLATE:
                 info = c_info_in.deflate.level;
                 break;
+            case COMP_CODE_ZSTD:
+                info = c_info_in.zstd.level;
+                break;
+            case COMP_CODE_LZ4:
+                info = c_info_in.lz4.acceleration;
+                break;
             default:
                 printf("Error: Unrecognized compression code in %d <%s>\n", comp_type, sds_name);
                 break;
@@ -379,6 +393,14 @@ gen_dim(char *name, /* name of SDS */
                     chunk_def.comp.comp_type     = COMP_CODE_DEFLATE;
                     chunk_def.comp.cinfo.deflate = c_info_in.deflate;
                     break;
+                case COMP_CODE_ZSTD:
+                    chunk_def.comp.comp_type  = COMP_CODE_ZSTD;
+                    chunk_def.comp.cinfo.zstd = c_info_in.zstd;
+                    break;
+                case COMP_CODE_LZ4:
+                    chunk_def.comp.comp_type = COMP_CODE_LZ4;
+                    chunk_def.comp.cinfo.lz4 = c_info_in.lz4;
+                    break;
                 case COMP_CODE_SZIP:
 #ifdef H4_HAVE_LIBSZ
                     chunk_def.comp.comp_type  = COMP_CODE_SZIP;
@@ -411,7 +433,8 @@ gen_dim(char *name, /* name of SDS */
                                          sds_name,     /* path of object IN */
                                          1,            /* number of GR image planes (for SZIP), IN */
                                          dimsizes,     /* dimensions (for SZIP), IN */
-                                         dtype         /* numeric type ( for SZIP), IN */
+                                         dtype,        /* numeric type ( for SZIP), IN */
+                                         0             /* GR image, for auto chunking, IN */
             );
             if (have_info == FAIL)
                 goto out;
@@ -494,6 +517,8 @@ gen_dim(char *name, /* name of SDS */
             case COMP_CODE_RLE:
             case COMP_CODE_SKPHUFF:
             case COMP_CODE_DEFLATE:
+            case COMP_CODE_ZSTD:
+            case COMP_CODE_LZ4:
             case COMP_CODE_SZIP:
             case COMP_CODE_NBIT:
                 break;
@@ -563,6 +588,8 @@ gen_dim(char *name, /* name of SDS */
          * COMP_CODE_RLE       -> simple RLE encoding
          * COMP_CODE_SKPHUFF   -> Skipping huffman encoding
          * COMP_CODE_DEFLATE   -> gzip 'deflate' encoding
+         * COMP_CODE_ZSTD      -> zstd encoding
+         * COMP_CODE_LZ4       -> LZ4 encoding
          *-------------------------------------------------------------------------
          */
 
@@ -593,6 +620,12 @@ gen_dim(char *name, /* name of SDS */
                     case COMP_CODE_DEFLATE:
                         c_info.deflate.level = info;
                         break;
+                    case COMP_CODE_ZSTD:
+                        c_info.zstd.level = info;
+                        break;
+                    case COMP_CODE_LZ4:
+                        c_info.lz4.acceleration = info;
+                        break;
                     case COMP_CODE_NBIT:
                         comp_type = COMP_CODE_NONE; /* not supported in this version */
                         break;
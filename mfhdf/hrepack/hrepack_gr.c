@@ -145,6 +145,14 @@ copy_gr(int32 infile_id, int32 outfile_id, int32 gr_in, int32 gr_out, int32 tag,
                 chunk_def_in.comp.comp_type     = COMP_CODE_DEFLATE;
                 chunk_def_in.comp.cinfo.deflate = c_info_in.deflate;
                 break;
+            case COMP_CODE_ZSTD:
+                chunk_def_in.comp.comp_type  = COMP_CODE_ZSTD;
+                chunk_def_in.comp.cinfo.zstd = c_info_in.zstd;
+                break;
+            case COMP_CODE_LZ4:
+                chunk_def_in.comp.comp_type = COMP_CODE_LZ4;
+                chunk_def_in.comp.cinfo.lz4 = c_info_in.lz4;
+                break;
             case COMP_CODE_JPEG:
                 chunk_def_in.comp.comp_type  = COMP_CODE_JPEG;
                 chunk_def_in.comp.cinfo.jpeg = c_info_in.jpeg;
@@ -194,6 +202,12 @@ copy_gr(int32 infile_id, int32 outfile_id, int32 gr_in, int32 gr_out, int32 tag,
         case COMP_CODE_DEFLATE:
             info = c_info_in.deflate.level;
             break;
+        case COMP_CODE_ZSTD:
+            info = c_info_in.zstd.level;
+            break;
+        case COMP_CODE_LZ4:
+            info = c_info_in.lz4.acceleration;
+            break;
         case COMP_CODE_JPEG:
             /* JPEG's quality factor was not saved to the file and 75 is
                recommended by http://www.faqs.org/faqs/jpeg-faq/part1 - BMR 1/2009*/
@@ -241,6 +255,14 @@ copy_gr(int32 infile_id, int32 outfile_id, int32 gr_in, int32 gr_out, int32 tag,
                 chunk_def.comp.comp_type     = COMP_CODE_DEFLATE;
                 chunk_def.comp.cinfo.deflate = c_info_in.deflate;
                 break;
+            case COMP_CODE_ZSTD:
+                chunk_def.comp.comp_type  = COMP_CODE_ZSTD;
+                chunk_def.comp.cinfo.zstd = c_info_in.zstd;
+                break;
+            case COMP_CODE_LZ4:
+                chunk_def.comp.comp_type = COMP_CODE_LZ4;
+                chunk_def.comp.cinfo.lz4 = c_info_in.lz4;
+                break;
             case COMP_CODE_JPEG:
                 chunk_def.comp.comp_type  = COMP_CODE_JPEG;
                 chunk_def.comp.cinfo.jpeg = c_info_in.jpeg;
@@ -271,7 +293,8 @@ copy_gr(int32 infile_id, int32 outfile_id, int32 gr_in, int32 gr_out, int32 tag,
                                      path,         /* path of object IN */
                                      n_comps,      /* number of GR image planes (for SZIP), IN */
                                      dimsizes,     /* dimensions (for SZIP), IN */
-                                     dtype         /* numeric type ( for SZIP), IN */
+                                     dtype,        /* numeric type ( for SZIP), IN */
+                                     1             /* GR image, for auto chunking, IN */
         );
         if (have_info == FAIL)
             goto out;
@@ -404,6 +427,13 @@ copy_gr(int32 infile_id, int32 outfile_id, int32 gr_in, int32 gr_out, int32 tag,
             ret = -1;
             goto out;
         }
+
+        /* deflate new chunks in parallel */
+        if (options->nthreads > 1 && GRsetchunkthreads(ri_out, options->nthreads) == FAIL) {
+            printf("Error: Failed to set chunk threads for <%s>\n", path);
+            ret = -1;
+            goto out;
+        }
     }
 
     /*-------------------------------------------------------------------------
@@ -412,6 +442,8 @@ copy_gr(int32 infile_id, int32 outfile_id, int32 gr_in, int32 gr_out, int32 tag,
      * COMP_CODE_RLE       -> simple RLE encoding
      * COMP_CODE_SKPHUFF   -> Skipping huffman encoding
      * COMP_CODE_DEFLATE   -> gzip 'deflate' encoding
+     * COMP_CODE_ZSTD      -> zstd encoding
+     * COMP_CODE_LZ4       -> LZ4 encoding
      *-------------------------------------------------------------------------
      */
 
@@ -446,6 +478,12 @@ copy_gr(int32 infile_id, int32 outfile_id, int32 gr_in, int32 gr_out, int32 tag,
                 case COMP_CODE_DEFLATE:
                     c_info.deflate.level = info;
                     break;
+                case COMP_CODE_ZSTD:
+                    c_info.zstd.level = info;
+                    break;
+                case COMP_CODE_LZ4:
+                    c_info.lz4.acceleration = info;
+                    break;
                 case COMP_CODE_JPEG:
                     c_info.jpeg.quality        = info;
                     c_info.jpeg.force_baseline = 1;
@@ -101,6 +101,8 @@ list_main(const char *infname, const char *outfname, options_t *options)
         n_file_attrs;                                   /* number of file attributes */
     intn has_GRelems = 0;                               /* set to 1 when there are GR images or */
                                                         /* attributes in the file (HDFFR-1428) */
+    int16       ndds      = 0; /* DDs in the first DD block of the output */
+    int32       meta_size = 0; /* space reserved for the metadata of the output */
     int         i;
     const char *err;
 
@@ -148,10 +150,23 @@ list_main(const char *infname, const char *outfname, options_t *options)
      */
 
     if (options->trip == 1) {
-        if ((outfile_id = Hopen(outfname, DFACC_CREATE, (int16)0)) == FAIL) {
+        /* for the aligned layout, one DD block and the reserved space at
+           the front are to hold all the metadata */
+        if (options->alignment > 0)
+            meta_space(infile_id, options->align_min,
+                       options->op_tbl->nelems == 0 && !options->all_comp && !options->all_chunk, &ndds,
+                       &meta_size);
+
+        if ((outfile_id = Hopen(outfname, DFACC_CREATE, ndds)) == FAIL) {
             printf("Cannot create file <%s>\n", outfname);
             goto out;
         }
+        if (options->alignment > 0 &&
+            (Hsetalignment(outfile_id, options->align_min, options->alignment) == FAIL ||
+             (meta_size > 0 && Hreservespace(outfile_id, meta_size) == FAIL))) {
+            printf("Could not set the layout of <%s>\n", outfname);
+            goto out;
+        }
         if ((sd_out = SDstart(outfname, DFACC_WRITE)) == FAIL) {
             printf("Could not start GR for <%s>\n", outfname);
             goto out;
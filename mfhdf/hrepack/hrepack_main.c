@@ -90,6 +90,46 @@ main(int argc, char **argv)
             ++i;
         }
 
+        else if (strcmp(argv[i], "-j") == 0) {
+
+            options.nthreads = parse_number(argv[i + 1]);
+            if (options.nthreads < 1) {
+                printf("Error: Invalid number of threads <%s>\n", argv[i + 1]);
+                goto out;
+            }
+            ++i;
+        }
+
+        else if (strcmp(argv[i], "-M") == 0) {
+
+            options.slabsize = parse_number(argv[i + 1]);
+            if (options.slabsize < 1) {
+                printf("Error: Invalid hyperslab size <%s>\n", argv[i + 1]);
+                goto out;
+            }
+            ++i;
+        }
+
+        else if (strcmp(argv[i], "-d") == 0) {
+            options.dedup = 1;
+        }
+
+        else if (strcmp(argv[i], "-k") == 0) {
+
+            options.verify = parse_number(argv[i + 1]);
+            if (options.verify < 1 || options.verify > 100) {
+                printf("Error: Invalid percent to verify <%s>\n", argv[i + 1]);
+                goto out;
+            }
+            ++i;
+        }
+
+        else if (strcmp(argv[i], "-a") == 0) {
+            if (parse_align(argv[i + 1], &options) < 0)
+                goto out;
+            ++i;
+        }
+
         else if (strcmp(argv[i], "-f") == 0) {
             if (read_info(argv[++i], &options) < 0)
                 goto out;
@@ -103,6 +143,10 @@ main(int argc, char **argv)
     if (infile == NULL || outfile == NULL)
         goto out;
 
+    /* the files are read through once: have the system read ahead, and
+       drop what was read so as not to flush the page cache */
+    Hsetaccesspattern(CACHE_ALL_FILES, HDF_ACCESS_SEQUENTIAL | HDF_ACCESS_DONTNEED);
+
     /* zip it */
     ret = hrepack_main(infile, outfile, &options);
 
@@ -139,7 +183,7 @@ usage(void)
 {
 
     printf("usage: hrepack -i input -o output [-V] [-h] [-v] [-t 'comp_info'] [-c 'chunk_info'] [-f cfile] "
-           "[-m size]\n");
+           "[-m size] [-j nthreads] [-M size] [-d] [-a align] [-k percent]\n");
     printf("  -i input          input HDF File\n");
     printf("  -o output         output HDF File\n");
     printf("  [-V]              prints version of the HDF4 library and exits\n");
@@ -154,6 +198,8 @@ usage(void)
     printf("\t\t       RLE, for RLE compression\n");
     printf("\t\t       HUFF, for Huffman\n");
     printf("\t\t       GZIP, for gzip\n");
+    printf("\t\t       ZSTD, for zstd (when built with zstd)\n");
+    printf("\t\t       LZ4, for LZ4 (when built with LZ4)\n");
     printf("\t\t       JPEG, for JPEG (for images only)\n");
     printf("\t\t       SZIP, for szip\n");
     printf("\t\t       NONE, to uncompress\n");
@@ -161,6 +207,8 @@ usage(void)
     printf("\t\t       RLE, no parameter\n");
     printf("\t\t       HUFF, the skip-size\n");
     printf("\t\t       GZIP, the deflation level\n");
+    printf("\t\t       ZSTD, the compression level (1 to 22)\n");
+    printf("\t\t       LZ4, the acceleration (1 is the default speed)\n");
     printf("\t\t       JPEG, the quality factor\n");
     printf("\t\t       SZIP, pixels per block, compression mode (NN or EC)\n");
     printf("  [-c 'chunk_info'] apply chunking. 'chunk_info' is a string with the format\n");
@@ -170,9 +218,27 @@ usage(void)
     printf("\t\t         '*' means all objects\n");
     printf("\t\t       <chunk information> is the chunk size of each dimension:\n");
     printf("\t\t        <dim_1 x dim_2 x ... dim_n> or\n");
-    printf("\t\t        NONE, to unchunk a previous chunked object\n");
+    printf("\t\t        NONE, to unchunk a previous chunked object or\n");
+    printf("\t\t        auto:<pattern>[:<bytes>], to pick the chunk size of each object\n");
+    printf("\t\t         from its shape for an access pattern, row (row scans), col\n");
+    printf("\t\t         (column scans) or tile (tile reads), with chunks of about\n");
+    printf("\t\t         <bytes> (default %d)\n", AUTO_CHUNK_BYTES);
+    printf("\t\t       auto:<pattern>[:<bytes>] alone applies to all objects\n");
     printf("  [-f cfile]      file with compression information -t and -c\n");
     printf("  [-m size]       do not compress objects smaller than size (bytes)\n");
+    printf("  [-j nthreads]   code deflate and LZ4 chunks on nthreads threads\n");
+    printf("  [-M size]       copy SDSs by hyperslabs of whole input chunks of at most\n");
+    printf("\t\t     size bytes (default %d), at least one chunk\n", SLAB_BYTES);
+    printf("  [-d]            store identical chunks of chunked SDSs once\n");
+    printf("  [-a align]      page-aligned layout. 'align' is a string with the format\n");
+    printf("\t\t     <alignment>[:<size>]\n");
+    printf("\t\t     data elements of at least <size> bytes (default <alignment>) start\n");
+    printf("\t\t     at multiples of <alignment> bytes, and the metadata and smaller\n");
+    printf("\t\t     elements are kept together at the front of the file\n");
+    printf("  [-k percent]    read the SDSs written back and check percent of their\n");
+    printf("\t\t     chunks or hyperslabs against checksums taken while writing them;\n");
+    printf("\t\t     chunks copied as stored are not decoded, and the SDSs are split\n");
+    printf("\t\t     between nthreads (-j) processes\n");
     printf("\n");
     printf("Examples:\n");
     printf("\n");
@@ -193,5 +259,11 @@ usage(void)
     printf("4) hrepack -v -i file1.hdf -o file2.hdf -t 'A:SZIP 8,NN'\n");
     printf("   applies SZIP compression to object A, with parameters 8 and NN\n");
     printf("\n");
+    printf("5) hrepack -v -i file1.hdf -o file2.hdf -t '*:GZIP 6' -c 'auto:tile:65536'\n");
+    printf("   compresses all objects with gzip, in chunks of about 64 KB shaped for tile reads\n");
+    printf("\n");
+    printf("6) hrepack -v -i file1.hdf -o file2.hdf -c 'auto:tile' -a 4096\n");
+    printf("   chunks all objects and starts each chunk on a 4 KB boundary, after the metadata\n");
+    printf("\n");
     printf("Note: the use of the verbose option -v is recommended\n");
 }
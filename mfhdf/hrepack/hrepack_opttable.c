@@ -74,10 +74,9 @@ options_table_free(options_table_t *op_tbl)
  */
 
 int
-options_add_chunk(obj_list_t *obj_list, int n_objs, int32 *chunk_lengths, int chunk_rank,
-                  options_table_t *op_tbl)
+options_add_chunk(obj_list_t *obj_list, int n_objs, chunk_info_t chunk, options_table_t *op_tbl)
 {
-    int i, j, k, I, added = 0, found = 0;
+    int i, j, I, added = 0, found = 0;
 
     if (op_tbl->nelems + n_objs >= op_tbl->size) {
         op_tbl->size += n_objs;
@@ -99,16 +98,14 @@ options_add_chunk(obj_list_t *obj_list, int n_objs, int32 *chunk_lengths, int ch
                 /*already on the table */
                 if (strcmp(obj_list[j].obj, op_tbl->objs[i].objpath) == 0) {
                     /* already chunk info inserted for this one; exit */
-                    if (op_tbl->objs[i].chunk.rank > 0) {
+                    if (op_tbl->objs[i].chunk.rank > 0 || op_tbl->objs[i].chunk.rank == CHUNK_AUTO) {
                         printf("Input Error: chunk information already inserted for <%s>\n", obj_list[j].obj);
                         return FAIL;
                     }
                     /* insert the chunk info */
                     else {
-                        op_tbl->objs[i].chunk.rank = chunk_rank;
-                        for (k = 0; k < chunk_rank; k++)
-                            op_tbl->objs[i].chunk.chunk_lengths[k] = chunk_lengths[k];
-                        found = 1;
+                        op_tbl->objs[i].chunk = chunk;
+                        found                 = 1;
                         break;
                     }
                 } /* if */
@@ -119,9 +116,7 @@ options_add_chunk(obj_list_t *obj_list, int n_objs, int32 *chunk_lengths, int ch
                 I = op_tbl->nelems + added;
                 added++;
                 strcpy(op_tbl->objs[I].objpath, obj_list[j].obj);
-                op_tbl->objs[I].chunk.rank = chunk_rank;
-                for (k = 0; k < chunk_rank; k++)
-                    op_tbl->objs[I].chunk.chunk_lengths[k] = chunk_lengths[k];
+                op_tbl->objs[I].chunk = chunk;
             }
         } /* j */
     }
@@ -133,9 +128,7 @@ options_add_chunk(obj_list_t *obj_list, int n_objs, int32 *chunk_lengths, int ch
             I = op_tbl->nelems + added;
             added++;
             strcpy(op_tbl->objs[I].objpath, obj_list[j].obj);
-            op_tbl->objs[I].chunk.rank = chunk_rank;
-            for (k = 0; k < chunk_rank; k++)
-                op_tbl->objs[I].chunk.chunk_lengths[k] = chunk_lengths[k];
+            op_tbl->objs[I].chunk = chunk;
         }
     }
 
@@ -25,8 +25,7 @@ extern "C" {
 
 void         options_table_init(options_table_t **tbl);
 void         options_table_free(options_table_t *table);
-int          options_add_chunk(obj_list_t *obj_list, int n_objs, int32 *chunk_lengths, int chunk_rank,
-                               options_table_t *table);
+int          options_add_chunk(obj_list_t *obj_list, int n_objs, chunk_info_t chunk, options_table_t *table);
 int          options_add_comp(obj_list_t *obj_list, int n_objs, comp_info_t comp, options_table_t *table);
 pack_info_t *options_get_object(char *path, options_table_t *table);
 
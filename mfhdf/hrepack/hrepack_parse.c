@@ -200,6 +200,30 @@ parse_comp(const char *str, int *n_objs, comp_info_t *comp)
                     goto out;
                 }
             }
+            else if (strcmp(scomp, "ZSTD") == 0) {
+#ifdef H4_HAVE_LIBZSTD
+                comp->type = COMP_CODE_ZSTD;
+                if (no_param) { /*no more parameters, ZSTD must have parameter */
+                    printf("Input Error: Missing compression parameter in <%s>\n", str);
+                    goto out;
+                }
+#else
+                printf("Input Error: ZSTD compression is not available\n");
+                goto out;
+#endif
+            }
+            else if (strcmp(scomp, "LZ4") == 0) {
+#ifdef H4_HAVE_LIBLZ4
+                comp->type = COMP_CODE_LZ4;
+                if (no_param) { /*no more parameters, LZ4 must have parameter */
+                    printf("Input Error: Missing compression parameter in <%s>\n", str);
+                    goto out;
+                }
+#else
+                printf("Input Error: LZ4 compression is not available\n");
+                goto out;
+#endif
+            }
             else if (strcmp(scomp, "JPEG") == 0) {
                 comp->type = COMP_CODE_JPEG;
                 if (no_param) { /*no more parameters, JPEG must have parameter */
@@ -258,6 +282,18 @@ parse_comp(const char *str, int *n_objs, comp_info_t *comp)
                 goto out;
             }
             break;
+        case COMP_CODE_ZSTD:
+            if (comp->info < H4_ZSTD_MIN_LEVEL || comp->info > H4_ZSTD_MAX_LEVEL) {
+                printf("Input Error: Invalid compression parameter in <%s>\n", str);
+                goto out;
+            }
+            break;
+        case COMP_CODE_LZ4:
+            if (comp->info < H4_LZ4_MIN_ACCELERATION || comp->info > H4_LZ4_MAX_ACCELERATION) {
+                printf("Input Error: Invalid compression parameter in <%s>\n", str);
+                goto out;
+            }
+            break;
         case COMP_CODE_JPEG:
             if (comp->info < 0 || comp->info > 100) {
                 printf("Input Error: Invalid compression parameter in <%s>\n", str);
@@ -288,6 +324,52 @@ out:
     return NULL;
 }
 
+/*-------------------------------------------------------------------------
+ * Function: parse_chunk_auto
+ *
+ * Purpose: read the <pattern>[:<bytes>] of an "auto:" chunking option
+ *
+ * Return: SUCCEED, FAIL
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static int
+parse_chunk_auto(const char *str, chunk_info_t *chunk)
+{
+    const char *bytes = strchr(str, ':');
+    size_t      len   = (bytes != NULL) ? (size_t)(bytes - str) : strlen(str);
+    char        sbytes[12];
+
+    if (len == 3 && strncmp(str, "row", len) == 0)
+        chunk->pattern = AUTO_ROW;
+    else if (len == 3 && strncmp(str, "col", len) == 0)
+        chunk->pattern = AUTO_COL;
+    else if (len == 4 && strncmp(str, "tile", len) == 0)
+        chunk->pattern = AUTO_TILE;
+    else {
+        printf("Input Error: Invalid access pattern in <%s>, use row, col or tile\n", str);
+        return FAIL;
+    }
+
+    chunk->chunk_bytes = AUTO_CHUNK_BYTES;
+    if (bytes != NULL) {
+        bytes++;
+        if (*bytes == '\0' || strlen(bytes) >= sizeof(sbytes)) {
+            printf("Input Error: Invalid chunk size in <%s>\n", str);
+            return FAIL;
+        }
+        strcpy(sbytes, bytes);
+        if ((chunk->chunk_bytes = parse_number(sbytes)) <= 0) {
+            printf("Input Error: Invalid chunk size in <%s>\n", str);
+            return FAIL;
+        }
+    }
+    chunk->rank = CHUNK_AUTO;
+
+    return SUCCEED;
+}
+
 /*-------------------------------------------------------------------------
  * Function: parse_chunk
  *
@@ -303,7 +385,7 @@ out:
  */
 
 obj_list_t *
-parse_chunk(const char *str, int *n_objs, int32 *chunk_lengths, int *chunk_rank)
+parse_chunk(const char *str, int *n_objs, chunk_info_t *chunk)
 {
     obj_list_t *obj_list = NULL;
     unsigned    i;
@@ -312,6 +394,17 @@ parse_chunk(const char *str, int *n_objs, int32 *chunk_lengths, int *chunk_rank)
     int         j, n, k, end_obj = -1, c_index;
     char        obj[H4_MAX_NC_NAME];
     char        sdim[10];
+    const char *auto_spec = NULL; /* <pattern>[:<bytes>] of an "auto:" option */
+
+    /* "auto:<pattern>" alone applies to all objects */
+    if (strncmp(str, "auto:", 5) == 0) {
+        obj_list = malloc(sizeof(obj_list_t));
+        strcpy(obj_list[0].obj, "*");
+        *n_objs = 1;
+        if (parse_chunk_auto(str + 5, chunk) == FAIL)
+            goto out;
+        return obj_list;
+    }
 
     /* check for the end of object list and number of objects */
     for (i = 0, n = 0; i < len; i++) {
@@ -324,6 +417,10 @@ parse_chunk(const char *str, int *n_objs, int32 *chunk_lengths, int *chunk_rank)
         }
     }
 
+    /* the object list of "<object list>:auto:<pattern>" ends at its first ':' */
+    if ((auto_spec = strstr(str, ":auto:")) != NULL)
+        end_obj = (int)(auto_spec - str);
+
     if (end_obj == -1) { /* missing : */
         printf("Input Error: Invalid chunking input in <%s>\n", str);
         return NULL;
@@ -360,6 +457,12 @@ parse_chunk(const char *str, int *n_objs, int32 *chunk_lengths, int *chunk_rank)
         goto out;
     }
 
+    if (auto_spec != NULL) {
+        if (parse_chunk_auto(auto_spec + 6, chunk) == FAIL)
+            goto out;
+        return obj_list;
+    }
+
     /* get chunk info */
     k = 0;
     for (i = end_obj + 1, c_index = 0; i < len; i++) {
@@ -376,8 +479,8 @@ parse_chunk(const char *str, int *n_objs, int32 *chunk_lengths, int *chunk_rank)
             if (c == 'x') {
                 sdim[k - 1]            = '\0';
                 k                      = 0;
-                chunk_lengths[c_index] = atoi(sdim);
-                if (chunk_lengths[c_index] == 0) {
+                chunk->chunk_lengths[c_index] = atoi(sdim);
+                if (chunk->chunk_lengths[c_index] == 0) {
                     printf("Input Error: Invalid chunking in <%s>\n", str);
                     goto out;
                 }
@@ -387,15 +490,15 @@ parse_chunk(const char *str, int *n_objs, int32 *chunk_lengths, int *chunk_rank)
                 sdim[k] = '\0';
                 k       = 0;
                 if (strcmp(sdim, "NONE") == 0) {
-                    *chunk_rank = -2;
+                    chunk->rank = -2;
                 }
                 else {
-                    chunk_lengths[c_index] = atoi(sdim);
-                    if (chunk_lengths[c_index] == 0) {
+                    chunk->chunk_lengths[c_index] = atoi(sdim);
+                    if (chunk->chunk_lengths[c_index] == 0) {
                         printf("Input Error: Invalid chunking in <%s>\n", str);
                         goto out;
                     }
-                    *chunk_rank = c_index + 1;
+                    chunk->rank = c_index + 1;
                 }
             } /*if */
         }     /*if c=='x' || i==len-1 */
@@ -443,6 +546,52 @@ parse_number(char *str)
     return n;
 }
 
+/*-------------------------------------------------------------------------
+ * Function: parse_align
+ *
+ * Purpose: read the <alignment>[:<size>] of the -a option; elements of at
+ *  least size bytes, by default the alignment, are aligned
+ *
+ * Return: SUCCEED, FAIL
+ *
+ *-------------------------------------------------------------------------
+ */
+
+int
+parse_align(const char *str, options_t *options)
+{
+    const char *size = strchr(str, ':');
+    size_t      len  = (size != NULL) ? (size_t)(size - str) : strlen(str);
+    char        snum[12];
+
+    if (len == 0 || len >= sizeof(snum)) {
+        printf("Input Error: Invalid alignment in <%s>\n", str);
+        return FAIL;
+    }
+    strncpy(snum, str, len);
+    snum[len] = '\0';
+    if ((options->alignment = parse_number(snum)) < 2) {
+        printf("Input Error: Invalid alignment in <%s>\n", str);
+        return FAIL;
+    }
+
+    options->align_min = options->alignment;
+    if (size != NULL) {
+        size++;
+        if (*size == '\0' || strlen(size) >= sizeof(snum)) {
+            printf("Input Error: Invalid size in <%s>\n", str);
+            return FAIL;
+        }
+        strcpy(snum, size);
+        if ((options->align_min = parse_number(snum)) <= 0) {
+            printf("Input Error: Invalid size in <%s>\n", str);
+            return FAIL;
+        }
+    }
+
+    return SUCCEED;
+}
+
 /*-------------------------------------------------------------------------
  * Function: get_scomp
  *
@@ -462,6 +611,10 @@ get_scomp(comp_coder_t code)
         return "HUFF";
     else if (code == COMP_CODE_DEFLATE)
         return "GZIP";
+    else if (code == COMP_CODE_ZSTD)
+        return "ZSTD";
+    else if (code == COMP_CODE_LZ4)
+        return "LZ4";
     else if (code == COMP_CODE_JPEG)
         return "JPEG";
     else if (code == COMP_CODE_SZIP)
@@ -476,3 +629,23 @@ get_scomp(comp_coder_t code)
     }
     return NULL;
 }
+
+/*-------------------------------------------------------------------------
+ * Function: get_sauto
+ *
+ * Purpose: return the access pattern of an "auto:" chunking option as a string
+ *
+ *-------------------------------------------------------------------------
+ */
+
+const char *
+get_sauto(int pattern)
+{
+    if (pattern == AUTO_ROW)
+        return "row";
+    else if (pattern == AUTO_COL)
+        return "col";
+    else if (pattern == AUTO_TILE)
+        return "tile";
+    return NULL;
+}
@@ -31,7 +31,12 @@ const char *get_scomp(comp_coder_t code);
 
 /* chunking */
 
-obj_list_t *parse_chunk(const char *str, int *n_objs, int32 *chunk_lengths, int *chunk_rank);
+obj_list_t *parse_chunk(const char *str, int *n_objs, chunk_info_t *chunk);
+const char *get_sauto(int pattern);
+
+/* layout */
+
+int parse_align(const char *str, options_t *options);
 
 #ifdef __cplusplus
 }
@@ -22,14 +22,21 @@
 #include "hrepack_opttable.h"
 #include "hrepack_dim.h"
 
-#define H4TOOLS_BUFSIZE    (1024 * 1024)
-#define H4TOOLS_MALLOCSIZE (1024 * 1024)
-
 void print_info(int chunk_flags, HDF_CHUNK_DEF *chunk_def, int comp_type, char *path, char *ratio);
 
 int get_print_info(int chunk_flags, HDF_CHUNK_DEF *chunk_def, int comp_type, char *path, char *sds_name,
                    int32 sd_id);
 
+static int same_chunk_comp(int32 rank, HDF_CHUNK_DEF *chunk_def_in, HDF_CHUNK_DEF *chunk_def);
+
+static int copy_sds_chunks(int32 sds_id, int32 sds_out, int32 rank, int32 *dimsizes, HDF_CHUNK_DEF *chunk_def,
+                           int32 eltsz, char *path, verify_sds_t *vf);
+
+static void plan_slab(int32 rank, int32 *dimsizes, int32 eltsz, int32 *chunk_lengths, int32 slab_bytes,
+                      int32 *sm_size);
+
+static int32 slab_chunks(int32 rank, int32 *dimsizes, int32 *chunk_lengths, int32 *sm_size);
+
 /*-------------------------------------------------------------------------
  * Function: copy_sds
  *
@@ -67,7 +74,8 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
         eltsz,                     /* element size */
         nelms,                     /* number of elements */
         dim_id,                    /* dimension ID */
-        dim_out;                   /* dimension ID */
+        dim_out,                   /* dimension ID */
+        sm_size[H4_MAX_VAR_DIMS];  /* hyperslab of each pass */
     char          sds_name[H4_MAX_NC_NAME];
     char          dim_name[H4_MAX_NC_NAME];
     char         *path    = NULL;
@@ -87,8 +95,11 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
     intn          empty_sds;
     int           have_info = 0;
     size_t        need; /* read size needed */
-    void         *sm_buf    = NULL;
-    int           is_record = 0;
+    void         *sm_buf     = NULL;
+    int           is_record  = 0;
+    int           raw_copy   = 0;     /* copy the stored chunks as they are */
+    intn          shuffle_in = FALSE; /* bytes of the input shuffled */
+    verify_sds_t *vf         = NULL;  /* checksums of the data written, -k */
 
     sds_index = SDreftoindex(sd_in, ref);
     sds_id    = SDselect(sd_in, sds_index);
@@ -160,6 +171,11 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
             goto out;
         }
 
+        if (SDgetshuffle(sds_id, &shuffle_in) == FAIL) {
+            printf("Could not get shuffling information for SDS <%s>\n", path);
+            goto out;
+        }
+
         /* retrieve the compress information if so */
         if ((HDF_CHUNK | HDF_COMP) == chunk_flags_in) {
             chunk_def_in.comp.comp_type = comp_type_in;
@@ -175,6 +191,14 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
                     chunk_def_in.comp.comp_type     = COMP_CODE_DEFLATE;
                     chunk_def_in.comp.cinfo.deflate = c_info_in.deflate;
                     break;
+                case COMP_CODE_ZSTD:
+                    chunk_def_in.comp.comp_type  = COMP_CODE_ZSTD;
+                    chunk_def_in.comp.cinfo.zstd = c_info_in.zstd;
+                    break;
+                case COMP_CODE_LZ4:
+                    chunk_def_in.comp.comp_type = COMP_CODE_LZ4;
+                    chunk_def_in.comp.cinfo.lz4 = c_info_in.lz4;
+                    break;
                 case COMP_CODE_SZIP:
 #ifdef H4_HAVE_LIBSZ
                     chunk_def_in.comp.comp_type  = COMP_CODE_SZIP;
@@ -229,6 +253,12 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
             case COMP_CODE_DEFLATE:
                 info = c_info_in.deflate.level;
                 break;
+            case COMP_CODE_ZSTD:
+                info = c_info_in.zstd.level;
+                break;
+            case COMP_CODE_LZ4:
+                info = c_info_in.lz4.acceleration;
+                break;
             default:
                 printf("Error: Unrecognized compression code in %d <%s>\n", comp_type, path);
                 goto out;
@@ -264,6 +294,14 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
                     chunk_def.comp.comp_type     = COMP_CODE_DEFLATE;
                     chunk_def.comp.cinfo.deflate = c_info_in.deflate;
                     break;
+                case COMP_CODE_ZSTD:
+                    chunk_def.comp.comp_type  = COMP_CODE_ZSTD;
+                    chunk_def.comp.cinfo.zstd = c_info_in.zstd;
+                    break;
+                case COMP_CODE_LZ4:
+                    chunk_def.comp.comp_type = COMP_CODE_LZ4;
+                    chunk_def.comp.cinfo.lz4 = c_info_in.lz4;
+                    break;
                 case COMP_CODE_SZIP:
 #ifdef H4_HAVE_LIBSZ
                     chunk_def.comp.comp_type  = COMP_CODE_SZIP;
@@ -297,7 +335,8 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
                                          path,         /* path of object IN */
                                          1,            /* number of GR image planes (for SZIP), IN */
                                          dimsizes,     /* dimensions (for SZIP), IN */
-                                         dtype         /* numeric type ( for SZIP), IN */
+                                         dtype,        /* numeric type ( for SZIP), IN */
+                                         0             /* GR image, for auto chunking, IN */
             );
             if (have_info == FAIL)
                 goto out;
@@ -352,6 +391,8 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
             case COMP_CODE_RLE:
             case COMP_CODE_SKPHUFF:
             case COMP_CODE_DEFLATE:
+            case COMP_CODE_ZSTD:
+            case COMP_CODE_LZ4:
             case COMP_CODE_SZIP:
             case COMP_CODE_NBIT:
                 break;
@@ -439,6 +480,18 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
                     printf("Error: Failed to set chunk dimensions for <%s>\n", path);
                     goto out;
                 }
+
+                /* deflate new chunks in parallel */
+                if (options->nthreads > 1 && SDsetchunkthreads(sds_out, options->nthreads) == FAIL) {
+                    printf("Error: Failed to set chunk threads for <%s>\n", path);
+                    goto out;
+                }
+
+                /* point identical chunks at the same data */
+                if (options->dedup && SDsetchunkdedup(sds_out, TRUE) == FAIL) {
+                    printf("Error: Failed to set chunk deduplication for <%s>\n", path);
+                    goto out;
+                }
             }
         }
 
@@ -448,6 +501,8 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
          * COMP_CODE_RLE       -> simple RLE encoding
          * COMP_CODE_SKPHUFF   -> Skipping huffman encoding
          * COMP_CODE_DEFLATE   -> gzip 'deflate' encoding
+         * COMP_CODE_ZSTD      -> zstd encoding
+         * COMP_CODE_LZ4       -> LZ4 encoding
          *-------------------------------------------------------------------------
          */
 
@@ -477,6 +532,12 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
                     case COMP_CODE_DEFLATE:
                         c_info.deflate.level = info;
                         break;
+                    case COMP_CODE_ZSTD:
+                        c_info.zstd.level = info;
+                        break;
+                    case COMP_CODE_LZ4:
+                        c_info.lz4.acceleration = info;
+                        break;
                     case COMP_CODE_NBIT:
                         comp_type = COMP_CODE_NONE; /* not supported in this version */
                         break;
@@ -499,20 +560,71 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
             }
         }
 
+        /* chunks compressed the same way in both SDSs need not be decoded;
+           the output is written without shuffling, so shuffled ones are */
+        raw_copy = !is_record && !shuffle_in && chunk_flags_in == (HDF_CHUNK | HDF_COMP) &&
+                   chunk_flags == chunk_flags_in && same_chunk_comp(rank, &chunk_def_in, &chunk_def);
+
+        /* otherwise inflate the input chunks in parallel */
+        if (!raw_copy && chunk_flags_in != HDF_NONE && options->nthreads > 1 &&
+            SDsetchunkthreads(sds_id, options->nthreads) == FAIL) {
+            printf("Error: Failed to set chunk threads for <%s>\n", path);
+            goto out;
+        }
+
         need = (size_t)(nelms * eltsz); /* bytes needed */
 
-        if (need < H4TOOLS_MALLOCSIZE ||
-            /* for compressed datasets do one operation I/O, but allow hyperslab for chunked */
-            (chunk_flags == HDF_NONE && comp_type > COMP_CODE_NONE)) {
+        if (!raw_copy && (need < (size_t)options->slabsize ||
+                          /* for compressed datasets do one operation I/O, but allow hyperslab for chunked */
+                          (chunk_flags == HDF_NONE && comp_type > COMP_CODE_NONE))) {
             buf = (void *)malloc(need);
         }
 
+        /* unless read at once, the data is copied by hyperslabs of whole input
+           chunks, and the input chunk cache holds the chunks of one hyperslab,
+           so that no chunk is decoded twice */
+        if (!raw_copy) {
+            if (buf != NULL)
+                for (i = 0; i < rank; i++)
+                    sm_size[i] = dimsizes[i];
+            else
+                plan_slab(rank, dimsizes, eltsz,
+                          chunk_flags_in != HDF_NONE ? chunk_def_in.chunk_lengths : NULL, options->slabsize,
+                          sm_size);
+
+            if (chunk_flags_in != HDF_NONE &&
+                SDsetchunkcache(sds_id, slab_chunks(rank, dimsizes, chunk_def_in.chunk_lengths, sm_size),
+                                0) == FAIL) {
+                printf("Error: Failed to set chunk cache for <%s>\n", path);
+                goto out;
+            }
+        }
+
+        /* checksums of each stored chunk or each hyperslab written, checked
+           once the new file is done */
+        if (options->verify &&
+            (vf = verify_table_add(options->vf_tbl, path, rank, dimsizes, eltsz,
+                                   raw_copy ? chunk_def.comp.chunk_lengths : sm_size)) == NULL) {
+            printf("Error allocating checksums for SDS <%s>\n", path);
+            goto out;
+        }
+
+        /*-------------------------------------------------------------------------
+         * copy the stored chunks
+         *-------------------------------------------------------------------------
+         */
+
+        if (raw_copy) {
+            if (copy_sds_chunks(sds_id, sds_out, rank, dimsizes, &chunk_def, eltsz, path, vf) == FAIL)
+                goto out;
+        }
+
         /*-------------------------------------------------------------------------
          * read all
          *-------------------------------------------------------------------------
          */
 
-        if (buf != NULL) {
+        else if (buf != NULL) {
 
             /* set edges of SDS, select all */
             for (i = 0; i < rank; i++) {
@@ -531,19 +643,19 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
                 printf("Failed to write to new SDS <%s>\n", path);
                 goto out;
             }
+            if (vf != NULL)
+                verify_add_slab(vf, start, buf, (int32)need);
         }
 
         else /* possibly not enough memory, read/write by hyperslabs */
 
         {
-            size_t p_type_nbytes = eltsz; /*size of type */
-            uint32 p_nelmts      = nelms; /*total selected elmts */
-            uint32 elmtno;                /*counter  */
-            int    carry;                 /*counter carry value */
+            uint32 p_nelmts = nelms; /*total selected elmts */
+            uint32 elmtno;           /*counter  */
+            int    carry;            /*counter carry value */
 
             /* stripmine info */
-            int32 sm_size[H4_MAX_VAR_DIMS]; /*stripmine size */
-            int32 sm_nbytes;                /*bytes per stripmine */
+            int32 sm_nbytes; /*bytes per stripmine */
 
             /* hyperslab info */
             int32 hs_offset[H4_MAX_VAR_DIMS]; /*starting offset */
@@ -551,13 +663,11 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
             int32 hs_nelmts;                  /*elements in request */
 
             /*
-             * determine the strip mine size and allocate a buffer. The strip mine is
-             * a hyperslab whose size is manageable.
+             * allocate a buffer for the strip mine, the hyperslab planned above
              */
-            sm_nbytes = p_type_nbytes;
+            sm_nbytes = eltsz;
 
             for (i = rank; i > 0; --i) {
-                sm_size[i - 1] = MIN(dimsizes[i - 1], H4TOOLS_BUFSIZE / sm_nbytes);
                 sm_nbytes *= sm_size[i - 1];
                 assert(sm_nbytes > 0);
             }
@@ -590,6 +700,8 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
                     printf("Failed to write to new SDS <%s>\n", path);
                     goto out;
                 }
+                if (vf != NULL)
+                    verify_add_slab(vf, hs_offset, sm_buf, hs_nelmts * eltsz);
 
                 /* calculate the next hyperslab offset */
                 for (i = rank, carry = 1; i > 0 && carry; --i) {
@@ -687,6 +799,8 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
         printf("Failed to get new SDS reference in <%s>\n", path);
         goto out;
     }
+    if (vf != NULL)
+        vf->ref = sds_ref;
 
     /*-------------------------------------------------------------------------
      * add SDS to group
@@ -753,6 +867,213 @@ out:
     return FAIL;
 }
 
+/*-------------------------------------------------------------------------
+ * Function: same_chunk_comp
+ *
+ * Purpose: check if an output SDS is chunked and compressed with the
+ *  same chunk lengths, method and parameters as the input SDS, so that
+ *  its stored chunks can be copied as they are
+ *
+ * Return: 1 if they are the same, 0 otherwise
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static int
+same_chunk_comp(int32 rank, HDF_CHUNK_DEF *chunk_def_in, HDF_CHUNK_DEF *chunk_def)
+{
+    int i;
+
+    for (i = 0; i < rank; i++) {
+        if (chunk_def->comp.chunk_lengths[i] != chunk_def_in->comp.chunk_lengths[i])
+            return 0;
+    }
+
+    if (chunk_def->comp.comp_type != chunk_def_in->comp.comp_type)
+        return 0;
+
+    switch (chunk_def_in->comp.comp_type) {
+        case COMP_CODE_RLE:
+            return 1;
+        case COMP_CODE_SKPHUFF:
+            return chunk_def->comp.cinfo.skphuff.skp_size == chunk_def_in->comp.cinfo.skphuff.skp_size;
+        case COMP_CODE_DEFLATE:
+            return chunk_def->comp.cinfo.deflate.level == chunk_def_in->comp.cinfo.deflate.level;
+        case COMP_CODE_ZSTD:
+            return chunk_def->comp.cinfo.zstd.level == chunk_def_in->comp.cinfo.zstd.level;
+        case COMP_CODE_LZ4:
+            return chunk_def->comp.cinfo.lz4.acceleration == chunk_def_in->comp.cinfo.lz4.acceleration;
+        case COMP_CODE_SZIP:
+            return chunk_def->comp.cinfo.szip.options_mask == chunk_def_in->comp.cinfo.szip.options_mask &&
+                   chunk_def->comp.cinfo.szip.pixels_per_block ==
+                       chunk_def_in->comp.cinfo.szip.pixels_per_block;
+        default:
+            return 0;
+    }
+}
+
+/*-------------------------------------------------------------------------
+ * Function: plan_slab
+ *
+ * Purpose: pick the size of the hyperslabs an SDS is copied by, of at most
+ *  slab_bytes bytes, grown from the fastest varying dimension.  For chunked
+ *  SDSs (chunk_lengths not NULL) they are made of whole chunks, at least
+ *  one, so that their offsets fall on chunk boundaries
+ *
+ * Return: void
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static void
+plan_slab(int32 rank, int32 *dimsizes, int32 eltsz, int32 *chunk_lengths, int32 slab_bytes, int32 *sm_size)
+{
+    int32 sm_nbytes = eltsz; /* bytes of the hyperslab so far */
+    int32 unit;              /* step of the size along a dimension */
+    int32 n;                 /* steps fitting in slab_bytes */
+    int   i;
+
+    for (i = rank; i > 0; --i) {
+        unit = (chunk_lengths != NULL) ? chunk_lengths[i - 1] : 1;
+        n    = slab_bytes / sm_nbytes / unit;
+        if (n < 1)
+            n = 1;
+        sm_size[i - 1] = MIN(dimsizes[i - 1], n * unit);
+        sm_nbytes *= sm_size[i - 1];
+    }
+}
+
+/*-------------------------------------------------------------------------
+ * Function: slab_chunks
+ *
+ * Purpose: count the chunks a hyperslab of size sm_size, at an offset that
+ *  is a multiple of it, can overlap
+ *
+ * Return: the number of chunks
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static int32
+slab_chunks(int32 rank, int32 *dimsizes, int32 *chunk_lengths, int32 *sm_size)
+{
+    int32 nchunks = 1;
+    int32 n;
+    int   i;
+
+    for (i = 0; i < rank; i++) {
+        n = sm_size[i] / chunk_lengths[i];
+        if (sm_size[i] % chunk_lengths[i] != 0)
+            n += 2;
+        nchunks *= MIN(n, (dimsizes[i] + chunk_lengths[i] - 1) / chunk_lengths[i]);
+    }
+
+    return nchunks;
+}
+
+/*-------------------------------------------------------------------------
+ * Function: copy_sds_chunks
+ *
+ * Purpose: copy the chunks of an SDS to an SDS with the same chunking and
+ *  compression, as they are stored in the file, without decompressing
+ *  and compressing them again. Chunks that were never written are copied
+ *  with their fill values, like the hyperslab copy does, and chunks
+ *  stored otherwise than the SDS are copied decoded. The checksum of
+ *  each stored chunk copied is added to 'vf', if not NULL
+ *
+ * Return: SUCCEED, FAIL
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static int
+copy_sds_chunks(int32 sds_id, int32 sds_out, int32 rank, int32 *dimsizes, HDF_CHUNK_DEF *chunk_def,
+                int32 eltsz, char *path, verify_sds_t *vf)
+{
+    int32 nchunks[H4_MAX_VAR_DIMS]; /* number of chunks along each dimension */
+    int32 origin[H4_MAX_VAR_DIMS];  /* origin of the chunk to copy */
+    int32 chunk_nbytes = eltsz;     /* bytes in a chunk, once decoded */
+    int32 raw_len;                  /* bytes in a stored chunk */
+    int32 raw_size  = 0;            /* size of raw_buf */
+    void *raw_buf   = NULL;         /* stored chunk */
+    void *chunk_buf = NULL;         /* decoded chunk */
+    int   carry;                    /* counter carry value */
+    int   i;
+
+    for (i = 0; i < rank; i++) {
+        nchunks[i] = (dimsizes[i] + chunk_def->comp.chunk_lengths[i] - 1) / chunk_def->comp.chunk_lengths[i];
+        origin[i]  = 0;
+        chunk_nbytes *= chunk_def->comp.chunk_lengths[i];
+    }
+
+    do {
+        /* a chunk stored otherwise than the SDS, e.g. uncompressed, see
+           SDsetchunkrawlimit(), is copied decoded */
+        if ((raw_len = SDreadchunkraw(sds_id, origin, NULL, 0)) == FAIL) {
+            if (HEvalue(1) != DFE_BADCODER) {
+                printf("Could not read SDS <%s>\n", path);
+                goto out;
+            }
+            raw_len = 0;
+        }
+
+        if (raw_len > 0) {
+            if (raw_len > raw_size) {
+                free(raw_buf);
+                if ((raw_buf = malloc((size_t)raw_len)) == NULL) {
+                    printf("Error allocating %d bytes for SDS <%s>\n", raw_len, path);
+                    goto out;
+                }
+                raw_size = raw_len;
+            }
+            if (SDreadchunkraw(sds_id, origin, raw_buf, raw_size) != raw_len) {
+                printf("Could not read SDS <%s>\n", path);
+                goto out;
+            }
+            if (SDwritechunkraw(sds_out, origin, raw_buf, raw_len) == FAIL) {
+                printf("Failed to write to new SDS <%s>\n", path);
+                goto out;
+            }
+            if (vf != NULL)
+                verify_add_raw(vf, origin, raw_buf, raw_len);
+        }
+        else {
+            if (chunk_buf == NULL && (chunk_buf = malloc((size_t)chunk_nbytes)) == NULL) {
+                printf("Error allocating %d bytes for SDS <%s>\n", chunk_nbytes, path);
+                goto out;
+            }
+            if (SDreadchunk(sds_id, origin, chunk_buf) == FAIL) {
+                printf("Could not read SDS <%s>\n", path);
+                goto out;
+            }
+            if (SDwritechunk(sds_out, origin, chunk_buf) == FAIL) {
+                printf("Failed to write to new SDS <%s>\n", path);
+                goto out;
+            }
+        }
+
+        /* calculate the next chunk origin */
+        for (i = rank, carry = 1; i > 0 && carry; --i) {
+            if (++origin[i - 1] == nchunks[i - 1])
+                origin[i - 1] = 0;
+            else
+                carry = 0;
+        }
+    } while (!carry);
+
+    free(raw_buf);
+    free(chunk_buf);
+
+    return SUCCEED;
+
+out:
+
+    free(raw_buf);
+    free(chunk_buf);
+
+    return FAIL;
+}
+
 /*-------------------------------------------------------------------------
  * Function: copy_sds_attrs
  *
@@ -111,18 +111,23 @@ options_get_info(options_t     *options,     /* global options */
                  int            rank,        /* rank of object IN */
                  char          *path,        /* path of object IN */
                  int            ncomps,      /* number of GR image planes (for SZIP), IN */
-                 int32         *dimsizes,    /* dimensions (for SZIP), IN */
-                 int32          dtype        /* numeric type (for SZIP), IN */
+                 int32         *dimsizes,    /* dimensions (for SZIP and auto chunking), IN */
+                 int32          dtype,       /* numeric type (for SZIP and auto chunking), IN */
+                 int            is_image     /* GR image, for auto chunking, IN */
 )
 {
-    (void)dtype;
-    (void)dimsizes;
-    (void)ncomps;
-
     pack_info_t *obj = NULL; /* check if we have information for this object */
+    pack_info_t  obj_auto;   /* obj with its "auto:" chunking resolved */
+    chunk_info_t chunk_g;    /* global chunking, resolved for this object */
     int          i;
     comp_info    c_info; /* for SZIP default values */
 
+    /* "auto:" chunking picks the chunk lengths of each object; an object
+       that cannot be chunked keeps its layout */
+    chunk_g = options->chunk_g;
+    if (chunk_g.rank == CHUNK_AUTO && chunk_auto(&chunk_g, rank, dimsizes, dtype, ncomps, is_image) == FAIL)
+        chunk_g.rank = -1;
+
     /*-------------------------------------------------------------------------
      * CASE 1: chunk==ALL comp==SELECTED
      *-------------------------------------------------------------------------
@@ -130,19 +135,19 @@ options_get_info(options_t     *options,     /* global options */
 
     if (options->all_chunk == 1 && options->all_comp == 0) {
         /* NONE option */
-        if (options->chunk_g.rank == -2) {
+        if (chunk_g.rank == -2) {
             chunk_flags = HDF_NONE;
         }
 
         /*check if the input rank is correct (warn this one cannot be chunked) */
-        else if (options->chunk_g.rank != rank) {
+        else if (chunk_g.rank != rank) {
             if (options->verbose)
                 printf("Warning: chunk rank does not apply to <%s>\n", path);
         }
         else {
             *chunk_flags = HDF_CHUNK;
             for (i = 0; i < rank; i++)
-                chunk_def->chunk_lengths[i] = options->chunk_g.chunk_lengths[i];
+                chunk_def->chunk_lengths[i] = chunk_g.chunk_lengths[i];
         }
 
         obj = options_get_object(path, options->op_tbl);
@@ -178,6 +183,12 @@ options_get_info(options_t     *options,     /* global options */
                     case COMP_CODE_DEFLATE:
                         chunk_def->comp.cinfo.deflate.level = obj->comp.info;
                         break;
+                    case COMP_CODE_ZSTD:
+                        chunk_def->comp.cinfo.zstd.level = obj->comp.info;
+                        break;
+                    case COMP_CODE_LZ4:
+                        chunk_def->comp.cinfo.lz4.acceleration = obj->comp.info;
+                        break;
                     case COMP_CODE_JPEG:
                         chunk_def->comp.cinfo.jpeg.quality        = obj->comp.info;
                         chunk_def->comp.cinfo.jpeg.force_baseline = 1;
@@ -188,7 +199,7 @@ options_get_info(options_t     *options,     /* global options */
                 }; /*switch */
                 for (i = 0; i < rank; i++) {
                     /* To use chunking with RLE, Skipping Huffman, and GZIP compression */
-                    chunk_def->comp.chunk_lengths[i] = options->chunk_g.chunk_lengths[i];
+                    chunk_def->comp.chunk_lengths[i] = chunk_g.chunk_lengths[i];
                 }
             } /* chunk_flags */
         }     /* obj */
@@ -200,6 +211,12 @@ options_get_info(options_t     *options,     /* global options */
      */
     else if (options->all_chunk == 0 && options->all_comp == 0) {
         obj = options_get_object(path, options->op_tbl);
+        if (obj != NULL && obj->chunk.rank == CHUNK_AUTO) {
+            obj_auto = *obj;
+            if (chunk_auto(&obj_auto.chunk, rank, dimsizes, dtype, ncomps, is_image) == FAIL)
+                obj_auto.chunk.rank = -1;
+            obj = &obj_auto;
+        }
 
         if (obj != NULL) {
             /* NONE option */
@@ -245,6 +262,12 @@ options_get_info(options_t     *options,     /* global options */
                         case COMP_CODE_DEFLATE:
                             chunk_def->comp.cinfo.deflate.level = obj->comp.info;
                             break;
+                        case COMP_CODE_ZSTD:
+                            chunk_def->comp.cinfo.zstd.level = obj->comp.info;
+                            break;
+                        case COMP_CODE_LZ4:
+                            chunk_def->comp.cinfo.lz4.acceleration = obj->comp.info;
+                            break;
                         case COMP_CODE_JPEG:
                             chunk_def->comp.cinfo.jpeg.quality        = obj->comp.info;
                             chunk_def->comp.cinfo.jpeg.force_baseline = 1;
@@ -265,6 +288,12 @@ options_get_info(options_t     *options,     /* global options */
      */
     else if (options->all_chunk == 0 && options->all_comp == 1) {
         obj = options_get_object(path, options->op_tbl);
+        if (obj != NULL && obj->chunk.rank == CHUNK_AUTO) {
+            obj_auto = *obj;
+            if (chunk_auto(&obj_auto.chunk, rank, dimsizes, dtype, ncomps, is_image) == FAIL)
+                obj_auto.chunk.rank = -1;
+            obj = &obj_auto;
+        }
 
         if (obj != NULL) {
 
@@ -313,6 +342,12 @@ options_get_info(options_t     *options,     /* global options */
                 case COMP_CODE_DEFLATE:
                     chunk_def->comp.cinfo.deflate.level = *info;
                     break;
+                case COMP_CODE_ZSTD:
+                    chunk_def->comp.cinfo.zstd.level = *info;
+                    break;
+                case COMP_CODE_LZ4:
+                    chunk_def->comp.cinfo.lz4.acceleration = *info;
+                    break;
                 case COMP_CODE_JPEG:
                     chunk_def->comp.cinfo.jpeg.quality = *info;
                     ;
@@ -332,19 +367,19 @@ options_get_info(options_t     *options,     /* global options */
      */
     else if (options->all_chunk == 1 && options->all_comp == 1) {
         /* NONE option */
-        if (options->chunk_g.rank == -2) {
+        if (chunk_g.rank == -2) {
             *chunk_flags = HDF_NONE;
         }
 
         /*check if this object rank is the same as input (warn this one cannot be chunked) */
-        else if (options->chunk_g.rank != rank) {
+        else if (chunk_g.rank != rank) {
             if (options->verbose)
                 printf("Warning: chunk rank does not apply to <%s>\n", path);
         }
         else {
             *chunk_flags = HDF_CHUNK;
             for (i = 0; i < rank; i++)
-                chunk_def->chunk_lengths[i] = options->chunk_g.chunk_lengths[i];
+                chunk_def->chunk_lengths[i] = chunk_g.chunk_lengths[i];
         }
 
         /* we must have COMP information */
@@ -352,7 +387,7 @@ options_get_info(options_t     *options,     /* global options */
         *info      = options->comp_g.info;
         *szip_mode = options->comp_g.szip_mode;
         /* check if we can apply CHUNK */
-        if (options->chunk_g.rank == rank) {
+        if (chunk_g.rank == rank) {
             *chunk_flags              = HDF_CHUNK | HDF_COMP;
             chunk_def->comp.comp_type = *comp_type;
             switch (*comp_type) {
@@ -373,6 +408,12 @@ options_get_info(options_t     *options,     /* global options */
                 case COMP_CODE_DEFLATE:
                     chunk_def->comp.cinfo.deflate.level = *info;
                     break;
+                case COMP_CODE_ZSTD:
+                    chunk_def->comp.cinfo.zstd.level = *info;
+                    break;
+                case COMP_CODE_LZ4:
+                    chunk_def->comp.cinfo.lz4.acceleration = *info;
+                    break;
                 case COMP_CODE_JPEG:
                     chunk_def->comp.cinfo.jpeg.quality = *info;
                     ;
@@ -389,6 +430,125 @@ options_get_info(options_t     *options,     /* global options */
     return (obj == NULL) ? 0 : 1;
 }
 
+/*-------------------------------------------------------------------------
+ * Function: auto_fill
+ *
+ * Purpose: give the dimensions first..last (in that order, step +1 or -1)
+ *  as long a chunk length as fits in a budget of elements
+ *
+ * Return: the budget left
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static double
+auto_fill(int32 *dims, int32 *lengths, int first, int last, double budget)
+{
+    int step = (first <= last) ? 1 : -1;
+    int i;
+
+    for (i = first; i != last + step; i += step) {
+        lengths[i] = (int32)MIN((double)dims[i], MAX(1.0, budget));
+        budget /= lengths[i];
+    }
+    return budget;
+}
+
+/*-------------------------------------------------------------------------
+ * Function: chunk_auto
+ *
+ * Purpose: pick the chunk lengths of an object for a "-c auto:" option
+ *  from its shape and element size, the target chunk size, and the access
+ *  pattern:
+ *   row:  chunks span the fastest varying dimensions, as many as fit
+ *   col:  chunks span the slowest varying dimensions, as many as fit
+ *   tile: square chunks over the two fastest varying dimensions, grown
+ *         along the others once a chunk holds whole planes
+ *  The target grows while the object would need more than AUTO_MAX_CHUNKS
+ *  chunks.
+ *
+ * Return: SUCCEED, FAIL if the object cannot be chunked (an empty dimension)
+ *
+ *-------------------------------------------------------------------------
+ */
+
+int
+chunk_auto(chunk_info_t *chunk,    /* "auto:" option IN, chunk lengths OUT */
+           int           rank,     /* rank of object IN */
+           int32        *dimsizes, /* dimensions IN */
+           int32         dtype,    /* numeric type IN */
+           int           ncomps,   /* number of GR image planes, IN */
+           int           is_image  /* dimension 0 (X) of GR images varies fastest, IN */
+)
+{
+    int32  dims[H4_MAX_VAR_DIMS];    /* dimensions, slowest varying first */
+    int32  lengths[H4_MAX_VAR_DIMS]; /* chunk lengths, slowest varying first */
+    int32  eltsz;
+    double nelms = 1, nchunks, budget, left;
+    int32  side;
+    int    i, a, b;
+
+    eltsz = DFKNTsize(dtype) * MAX(ncomps, 1);
+    if (rank < 1 || rank > H4_MAX_VAR_DIMS || eltsz <= 0)
+        return FAIL;
+    for (i = 0; i < rank; i++) {
+        dims[i] = is_image ? dimsizes[rank - 1 - i] : dimsizes[i];
+        if (dims[i] < 1)
+            return FAIL;
+        nelms *= dims[i];
+    }
+
+    for (budget = MAX(1.0, (double)(chunk->chunk_bytes / eltsz));; budget *= 2) {
+        switch (chunk->pattern) {
+            case AUTO_ROW:
+                auto_fill(dims, lengths, rank - 1, 0, budget);
+                break;
+
+            case AUTO_COL:
+                auto_fill(dims, lengths, 0, rank - 1, budget);
+                break;
+
+            case AUTO_TILE:
+            default:
+                if (rank == 1) {
+                    auto_fill(dims, lengths, 0, 0, budget);
+                    break;
+                }
+                a = rank - 2;
+                b = rank - 1;
+                for (side = 1; (double)(side + 1) * (side + 1) <= budget; side++)
+                    ;
+                /* a dimension shorter than the side is spanned, and the
+                   other one gets the rest of the budget */
+                if (dims[a] <= side) {
+                    lengths[a] = dims[a];
+                    lengths[b] = (int32)MIN((double)dims[b], MAX(1.0, budget / dims[a]));
+                }
+                else if (dims[b] <= side) {
+                    lengths[b] = dims[b];
+                    lengths[a] = (int32)MIN((double)dims[a], MAX(1.0, budget / dims[b]));
+                }
+                else
+                    lengths[a] = lengths[b] = side;
+                left = budget / ((double)lengths[a] * lengths[b]);
+                if (rank > 2)
+                    auto_fill(dims, lengths, rank - 3, 0, left);
+                break;
+        }
+
+        for (i = 0, nchunks = 1; i < rank; i++)
+            nchunks *= (dims[i] + lengths[i] - 1) / lengths[i];
+        if (nchunks <= AUTO_MAX_CHUNKS || budget >= nelms)
+            break;
+    }
+
+    chunk->rank = rank;
+    for (i = 0; i < rank; i++)
+        chunk->chunk_lengths[i] = is_image ? lengths[rank - 1 - i] : lengths[i];
+
+    return SUCCEED;
+}
+
 /*-------------------------------------------------------------------------
  * Function: set_szip
  *
@@ -461,6 +621,49 @@ set_szip(int        pixels_per_block, /*in */
 #endif
 }
 
+/*-------------------------------------------------------------------------
+ * Function: meta_space
+ *
+ * Purpose: size the first DD block and the space reserved at the front of
+ *  an output file with the aligned layout, from the DDs of the input and
+ *  its elements shorter than min_size, which are not aligned, with room
+ *  for the chunks, chunk tables and special headers the new storage may
+ *  add; what overflows goes at the end of the file.  The data of datasets
+ *  and images is left out when their storage changes (keep_data 0), as
+ *  its new size is not known.
+ *
+ * Return: void
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+meta_space(int32 infile_id, int32 min_size, int keep_data, int16 *ndds, int32 *size)
+{
+    uint16 tag    = 0;
+    uint16 ref    = 0;
+    int32  offset = 0;
+    int32  length = 0;
+    int32  n      = 0;
+    double bytes  = 0.0;
+
+    while (Hfind(infile_id, DFTAG_WILDCARD, DFREF_WILDCARD, &tag, &ref, &offset, &length, DF_FORWARD) ==
+           SUCCEED) {
+        n++;
+        if (!keep_data && (tag == DFTAG_SD || tag == DFTAG_LINKED || tag == DFTAG_COMPRESSED ||
+                           tag == DFTAG_CMPSEEK || tag == DFTAG_CHUNK || tag == DFTAG_RI || tag == DFTAG_CI ||
+                           tag == DFTAG_RI8 || tag == DFTAG_CI8))
+            continue;
+        if (length < min_size)
+            bytes += length;
+    }
+
+    /* a quarter more, and a special header for each element */
+    bytes += bytes / 4 + 16.0 * n;
+    *ndds = (int16)((n < INT16_MAX / 2 - 16) ? 2 * n + 16 : INT16_MAX);
+    *size = (int32)((bytes < (double)(INT32_MAX / 2)) ? bytes : INT32_MAX / 2);
+}
+
 /*-------------------------------------------------------------------------
  * Function: cache
  *
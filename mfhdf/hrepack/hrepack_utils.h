@@ -33,10 +33,21 @@ int options_get_info(options_t     *options,     /* global options */
                      int            rank,        /* rank of object IN */
                      char          *path,        /* path of object IN */
                      int            ncomps,      /* number of GR image planes (for SZIP), IN */
-                     int32         *dimsizes,    /* dimensions (for SZIP), IN */
-                     int32          dtype        /* numeric type (for SZIP), IN */
+                     int32         *dimsizes,    /* dimensions (for SZIP and auto chunking), IN */
+                     int32          dtype,       /* numeric type (for SZIP and auto chunking), IN */
+                     int            is_image     /* GR image, for auto chunking, IN */
 );
 
+int chunk_auto(chunk_info_t *chunk,    /* "auto:" option IN, chunk lengths OUT */
+               int           rank,     /* rank of object IN */
+               int32        *dimsizes, /* dimensions IN */
+               int32         dtype,    /* numeric type IN */
+               int           ncomps,   /* number of GR image planes, IN */
+               int           is_image  /* dimension 0 (X) of GR images varies fastest, IN */
+);
+
+void meta_space(int32 infile_id, int32 min_size, int keep_data, int16 *ndds, int32 *size);
+
 int set_szip(int        pixels_per_block, /*in */
              int        compression_mode, /* in */
              comp_info *c_info /*out*/);
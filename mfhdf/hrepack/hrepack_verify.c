@@ -0,0 +1,469 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "zlib.h"
+
+#include "hrepack.h"
+#include "hrepack_verify.h"
+
+#if defined(H4_HAVE_FORK) && defined(H4_HAVE_SYS_WAIT_H) && defined(H4_HAVE_UNISTD_H)
+#define HREPACK_WORKERS
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+static int32 verify_index(verify_sds_t *vf, int32 *coord);
+static int   verify_sds(int32 sd_id, verify_sds_t *vf, int percent);
+static int   verify_run(const char *fname, verify_table_t *vf_tbl, int first, int last, int percent);
+#ifdef HREPACK_WORKERS
+static int verify_workers(const char *fname, verify_table_t *vf_tbl, int nworkers, int percent);
+#endif
+
+/*-------------------------------------------------------------------------
+ * Function: verify_table_init
+ *
+ * Purpose: init the table of checksums
+ *
+ * Return: void
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+verify_table_init(verify_table_t **vf_tbl)
+{
+    verify_table_t *table = (verify_table_t *)malloc(sizeof(verify_table_t));
+
+    table->size  = 20;
+    table->nobjs = 0;
+    table->objs  = (verify_sds_t **)malloc(table->size * sizeof(verify_sds_t *));
+
+    *vf_tbl = table;
+}
+
+/*-------------------------------------------------------------------------
+ * Function: verify_table_free
+ *
+ * Purpose: free the table of checksums
+ *
+ * Return: void
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+verify_table_free(verify_table_t *vf_tbl)
+{
+    int i;
+
+    if (vf_tbl == NULL)
+        return;
+
+    for (i = 0; i < vf_tbl->nobjs; i++) {
+        free(vf_tbl->objs[i]->path);
+        free(vf_tbl->objs[i]->crcs);
+        free(vf_tbl->objs[i]->kinds);
+        free(vf_tbl->objs[i]);
+    }
+    free(vf_tbl->objs);
+    free(vf_tbl);
+}
+
+/*-------------------------------------------------------------------------
+ * Function: verify_table_add
+ *
+ * Purpose: add an SDS that is about to be written, its data being cut
+ *  into units of 'unit' lengths; no unit is checked until its checksum
+ *  is added
+ *
+ * Return: the new entry, NULL if out of memory
+ *
+ *-------------------------------------------------------------------------
+ */
+
+verify_sds_t *
+verify_table_add(verify_table_t *vf_tbl, const char *path, int32 rank, int32 *dims, int32 eltsz, int32 *unit)
+{
+    verify_sds_t *vf;
+    int32         i;
+
+    if (vf_tbl->nobjs == vf_tbl->size) {
+        verify_sds_t **objs =
+            (verify_sds_t **)realloc(vf_tbl->objs, 2 * (size_t)vf_tbl->size * sizeof(verify_sds_t *));
+
+        if (objs == NULL)
+            return NULL;
+        vf_tbl->objs = objs;
+        vf_tbl->size *= 2;
+    }
+
+    if ((vf = (verify_sds_t *)calloc(1, sizeof(verify_sds_t))) == NULL)
+        return NULL;
+
+    vf->rank   = rank;
+    vf->eltsz  = eltsz;
+    vf->ntotal = 1;
+    for (i = 0; i < rank; i++) {
+        vf->dims[i]   = dims[i];
+        vf->unit[i]   = unit[i];
+        vf->nunits[i] = (dims[i] + unit[i] - 1) / unit[i];
+        vf->ntotal *= vf->nunits[i];
+    }
+
+    vf->path  = strdup(path);
+    vf->crcs  = (uint32 *)malloc((size_t)vf->ntotal * sizeof(uint32));
+    vf->kinds = (uint8 *)calloc((size_t)vf->ntotal, sizeof(uint8));
+    if (vf->path == NULL || vf->crcs == NULL || vf->kinds == NULL) {
+        free(vf->path);
+        free(vf->crcs);
+        free(vf->kinds);
+        free(vf);
+        return NULL;
+    }
+
+    vf_tbl->objs[vf_tbl->nobjs++] = vf;
+    return vf;
+}
+
+/*-------------------------------------------------------------------------
+ * Function: verify_add_slab
+ *
+ * Purpose: add the checksum of the values of the unit at 'offset', as
+ *  they were passed to SDwritedata
+ *
+ * Return: void
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+verify_add_slab(verify_sds_t *vf, int32 *offset, const void *buf, int32 nbytes)
+{
+    int32 coord[H4_MAX_VAR_DIMS];
+    int32 i, u;
+
+    for (i = 0; i < vf->rank; i++)
+        coord[i] = offset[i] / vf->unit[i];
+
+    u            = verify_index(vf, coord);
+    vf->crcs[u]  = (uint32)crc32(0L, (const Bytef *)buf, (uInt)nbytes);
+    vf->kinds[u] = VERIFY_DATA;
+}
+
+/*-------------------------------------------------------------------------
+ * Function: verify_add_raw
+ *
+ * Purpose: add the checksum of the stored chunk at 'origin', as it was
+ *  passed to SDwritechunkraw; it is checked without decoding it
+ *
+ * Return: void
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+verify_add_raw(verify_sds_t *vf, int32 *origin, const void *buf, int32 nbytes)
+{
+    int32 u = verify_index(vf, origin);
+
+    vf->crcs[u]  = (uint32)crc32(0L, (const Bytef *)buf, (uInt)nbytes);
+    vf->kinds[u] = VERIFY_RAW;
+}
+
+/*-------------------------------------------------------------------------
+ * Function: verify_index
+ *
+ * Purpose: number the unit at 'coord', in units, in row-major order
+ *
+ * Return: the unit number
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static int32
+verify_index(verify_sds_t *vf, int32 *coord)
+{
+    int32 i, u = 0;
+
+    for (i = 0; i < vf->rank; i++)
+        u = u * vf->nunits[i] + coord[i];
+    return u;
+}
+
+/*-------------------------------------------------------------------------
+ * Function: hrepack_verify
+ *
+ * Purpose: check the SDSs written to the new file against the checksums
+ *  taken while they were written (-k). Stored chunks copied as they are
+ *  are read back with SDreadchunkraw and are not decoded; the other data
+ *  is read back by the units it was written by. With 'percent' below 100
+ *  only that share of the units of each SDS, spread evenly, is checked.
+ *  The SDSs are split between options->nthreads worker processes, as the
+ *  HDF library is not thread-safe
+ *
+ * Return: the number of units that differ, -1 if the file could not be
+ *  checked
+ *
+ *-------------------------------------------------------------------------
+ */
+
+int
+hrepack_verify(const char *fname, options_t *options)
+{
+    verify_table_t *vf_tbl   = options->vf_tbl;
+    int             nworkers = options->nthreads < vf_tbl->nobjs ? options->nthreads : vf_tbl->nobjs;
+
+#ifdef HREPACK_WORKERS
+    if (nworkers > 1)
+        return verify_workers(fname, vf_tbl, nworkers, options->verify);
+#else
+    (void)nworkers;
+#endif
+
+    return verify_run(fname, vf_tbl, 0, vf_tbl->nobjs, options->verify);
+}
+
+/*-------------------------------------------------------------------------
+ * Function: verify_run
+ *
+ * Purpose: check the SDSs first to last - 1 of the table
+ *
+ * Return: the number of units that differ, -1 if the file could not be
+ *  checked
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static int
+verify_run(const char *fname, verify_table_t *vf_tbl, int first, int last, int percent)
+{
+    int32 sd_id;
+    int   nfound = 0, n, i;
+
+    if ((sd_id = SDstart(fname, DFACC_RDONLY)) == FAIL) {
+        printf("Could not open <%s> to verify it\n", fname);
+        return -1;
+    }
+
+    for (i = first; i < last; i++) {
+        if ((n = verify_sds(sd_id, vf_tbl->objs[i], percent)) < 0) {
+            nfound = -1;
+            break;
+        }
+        nfound += n;
+    }
+
+    SDend(sd_id);
+    return nfound;
+}
+
+/*-------------------------------------------------------------------------
+ * Function: verify_sds
+ *
+ * Purpose: check the sampled units of one SDS of the new file
+ *
+ * Return: the number of units that differ, -1 if the SDS could not be
+ *  read
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static int
+verify_sds(int32 sd_id, verify_sds_t *vf, int percent)
+{
+    int32  coord[H4_MAX_VAR_DIMS]; /* unit, in units */
+    int32  start[H4_MAX_VAR_DIMS]; /* unit, in elements */
+    int32  edges[H4_MAX_VAR_DIMS]; /* size of the unit, in elements */
+    int32  sds_id = FAIL;
+    int32  nbytes;   /* bytes in the unit */
+    int32  size = 0; /* size of buf */
+    int32  u, n, i;
+    void  *buf    = NULL;
+    int    nfound = 0;
+    uint32 crc;
+
+    if ((i = SDreftoindex(sd_id, vf->ref)) == FAIL || (sds_id = SDselect(sd_id, i)) == FAIL) {
+        printf("Could not select SDS <%s> to verify it\n", vf->path);
+        goto out;
+    }
+
+    for (u = 0; u < vf->ntotal; u++) {
+        /* the units checked are spread evenly, 'percent' in every 100 */
+        if (vf->kinds[u] == VERIFY_NONE || (u % 100) * percent % 100 >= percent)
+            continue;
+
+        for (i = vf->rank - 1, n = u; i >= 0; i--) {
+            coord[i] = n % vf->nunits[i];
+            n /= vf->nunits[i];
+        }
+
+        if (vf->kinds[u] == VERIFY_RAW) {
+            if ((nbytes = SDreadchunkraw(sds_id, coord, NULL, 0)) == FAIL) {
+                printf("Could not read SDS <%s> to verify it\n", vf->path);
+                goto out;
+            }
+        }
+        else {
+            for (i = 0, nbytes = vf->eltsz; i < vf->rank; i++) {
+                start[i] = coord[i] * vf->unit[i];
+                edges[i] = MIN(vf->dims[i] - start[i], vf->unit[i]);
+                nbytes *= edges[i];
+            }
+        }
+
+        if (nbytes > size) {
+            free(buf);
+            if ((buf = malloc((size_t)nbytes)) == NULL) {
+                printf("Error allocating %d bytes to verify SDS <%s>\n", nbytes, vf->path);
+                goto out;
+            }
+            size = nbytes;
+        }
+
+        if (vf->kinds[u] == VERIFY_RAW ? SDreadchunkraw(sds_id, coord, buf, size) != nbytes
+                                       : SDreaddata(sds_id, start, NULL, edges, buf) == FAIL) {
+            printf("Could not read SDS <%s> to verify it\n", vf->path);
+            goto out;
+        }
+
+        crc = (uint32)crc32(0L, (const Bytef *)buf, (uInt)nbytes);
+        if (crc != vf->crcs[u]) {
+            printf("Verification failed: %s %d of SDS <%s> differs\n",
+                   vf->kinds[u] == VERIFY_RAW ? "chunk" : "hyperslab", (int)u, vf->path);
+            nfound++;
+        }
+    }
+
+    free(buf);
+    SDendaccess(sds_id);
+    return nfound;
+
+out:
+
+    free(buf);
+    if (sds_id != FAIL)
+        SDendaccess(sds_id);
+    return -1;
+}
+
+#ifdef HREPACK_WORKERS
+/*-------------------------------------------------------------------------
+ * Function: verify_workers
+ *
+ * Purpose: check the SDSs in 'nworkers' processes, each opening the file
+ *  itself and checking a consecutive run of the table. Each worker prints
+ *  to a temporary file, which are copied to stdout in table order once all
+ *  workers are done
+ *
+ * Return: the number of units that differ, -1 if a worker could not be
+ *  run or failed
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static int
+verify_workers(const char *fname, verify_table_t *vf_tbl, int nworkers, int percent)
+{
+    FILE **out    = NULL;
+    int   *fds    = NULL;
+    pid_t *pids   = NULL;
+    int    nfound = 0, started = 0, err = 0, k;
+    char   buf[4096];
+    size_t n;
+
+    out  = (FILE **)calloc((size_t)nworkers, sizeof(FILE *));
+    fds  = (int *)malloc((size_t)nworkers * sizeof(int));
+    pids = (pid_t *)malloc((size_t)nworkers * sizeof(pid_t));
+    if (out == NULL || fds == NULL || pids == NULL) {
+        printf("Error: cannot allocate memory for %d workers\n", nworkers);
+        err = 1;
+        goto done;
+    }
+
+    /* anything already buffered must not be written again by every worker */
+    fflush(stdout);
+
+    for (k = 0; k < nworkers; k++) {
+        int first = vf_tbl->nobjs * k / nworkers;
+        int last  = vf_tbl->nobjs * (k + 1) / nworkers;
+        int pfd[2];
+
+        if ((out[k] = tmpfile()) == NULL || pipe(pfd) < 0) {
+            printf("Error: cannot set up worker %d\n", k);
+            err = 1;
+            break;
+        }
+
+        if ((pids[k] = fork()) < 0) {
+            printf("Error: cannot start worker %d\n", k);
+            close(pfd[0]);
+            close(pfd[1]);
+            err = 1;
+            break;
+        }
+
+        if (pids[k] == 0) {
+            /* worker: check its run, report back */
+            int res;
+
+            close(pfd[0]);
+            dup2(fileno(out[k]), STDOUT_FILENO);
+
+            res = verify_run(fname, vf_tbl, first, last, percent);
+
+            fflush(stdout);
+            if (write(pfd[1], &res, sizeof(res)) != (ssize_t)sizeof(res))
+                _exit(EXIT_FAILURE);
+            _exit(EXIT_SUCCESS);
+        }
+
+        close(pfd[1]);
+        fds[k] = pfd[0];
+        started++;
+    }
+
+    /* collect the workers in order and pass their output on */
+    for (k = 0; k < started; k++) {
+        int res;
+        int status;
+
+        if (read(fds[k], &res, sizeof(res)) != (ssize_t)sizeof(res))
+            res = -1;
+        close(fds[k]);
+        if (waitpid(pids[k], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            res = -1;
+
+        if (res < 0)
+            err = 1;
+        else
+            nfound += res;
+
+        rewind(out[k]);
+        while ((n = fread(buf, 1, sizeof(buf), out[k])) > 0)
+            fwrite(buf, 1, n, stdout);
+    }
+
+done:
+    if (out != NULL) {
+        for (k = 0; k < nworkers; k++)
+            if (out[k] != NULL)
+                fclose(out[k]);
+        free(out);
+    }
+    free(fds);
+    free(pids);
+    return err ? -1 : nfound;
+}
+#endif /* HREPACK_WORKERS */
@@ -0,0 +1,65 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef HREPACK_VERIFY_H
+#define HREPACK_VERIFY_H
+
+#include "hdf.h"
+#include "mfhdf.h"
+
+/* how the checksum of a unit was taken */
+#define VERIFY_NONE 0 /* not taken, the unit is not checked */
+#define VERIFY_DATA 1 /* on the values written by SDwritedata */
+#define VERIFY_RAW  2 /* on the stored chunk written by SDwritechunkraw */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ checksums of the data written to an output SDS, one for each unit: a
+ stored chunk when the chunks are copied as they are, otherwise one of
+ the hyperslabs the SDS is copied by
+*/
+typedef struct verify_sds_t {
+    char   *path;                    /* path of the SDS, for messages */
+    int32   ref;                     /* reference number of the output SDS */
+    int32   rank;                    /* rank of the SDS */
+    int32   eltsz;                   /* size of an element in memory */
+    int32   dims[H4_MAX_VAR_DIMS];   /* dimensions of the SDS */
+    int32   unit[H4_MAX_VAR_DIMS];   /* lengths of a unit */
+    int32   nunits[H4_MAX_VAR_DIMS]; /* number of units along each dimension */
+    int32   ntotal;                  /* number of units */
+    uint32 *crcs;                    /* checksum of each unit */
+    uint8  *kinds;                   /* VERIFY_NONE, VERIFY_DATA or VERIFY_RAW for each unit */
+} verify_sds_t;
+
+/*struct that stores the checksums of all SDSs written */
+typedef struct verify_table_t {
+    int            size;
+    int            nobjs;
+    verify_sds_t **objs;
+} verify_table_t;
+
+/* table methods */
+void          verify_table_init(verify_table_t **vf_tbl);
+void          verify_table_free(verify_table_t *vf_tbl);
+verify_sds_t *verify_table_add(verify_table_t *vf_tbl, const char *path, int32 rank, int32 *dims, int32 eltsz,
+                               int32 *unit);
+void          verify_add_slab(verify_sds_t *vf, int32 *offset, const void *buf, int32 nbytes);
+void          verify_add_raw(verify_sds_t *vf, int32 *origin, const void *buf, int32 nbytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HREPACK_VERIFY_H */
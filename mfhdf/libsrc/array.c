@@ -17,6 +17,20 @@
 #include <string.h>
 #include "local_nc.h"
 
+/* arrays of names shorter than this are searched linearly */
+#define NC_INDEX_MIN 16
+
+/* open addressing hash table, with linear probing, from the hash of the
+   elements' names to their indices in the array */
+struct NC_index {
+    unsigned mask;  /* number of slots - 1, the number of slots is a power of 2 */
+    unsigned used;  /* number of slots holding an index */
+    int     *slots; /* indices into the array, -1 for an empty slot */
+};
+
+static NC_string *NC_array_name(NC_array *array, unsigned ii);
+static void       NC_index_insert(NC_index *index, const NC_string *name, int ii);
+
 /*
  * for a netcdf type
  *  return the size of the on-disk representation
@@ -216,6 +230,8 @@ NC_new_array(nc_type type, unsigned count, const void *values)
     ret->type  = type;
     ret->szof  = NC_typelen(type);
     ret->count = count;
+    ret->index = NULL;
+    ret->dirty = TRUE;
     memlen     = count * ret->szof;
     ret->len   = count * NC_xtypelen(type);
     if (count != 0) {
@@ -255,6 +271,8 @@ NC_re_array(NC_array *old, nc_type type, unsigned count, const void *values)
     memlen = count * szof;
     if (memlen > old->count * old->szof)
         return (NULL); /* punt */
+    NC_unindex_array(old);
+    old->dirty = TRUE;
     old->count = count;
     old->type  = type;
     old->szof  = szof;
@@ -283,6 +301,7 @@ NC_free_array(NC_array *array)
     int ret_value = SUCCEED;
 
     if (array != NULL) {
+        NC_unindex_array(array);
         if (array->values != NULL) {
             switch (array->type) {
                 case NC_UNSPECIFIED:
@@ -410,24 +429,256 @@ NC_xlen_array(NC_array *array)
 Void *
 NC_incr_array(NC_array *array, Void *tail)
 {
-    char *ap;
+    return NC_append_array(array, 1, tail);
+}
+
+/*
+ * Add 'n' new handles on the end of an array of handles, growing it once
+ */
+Void *
+NC_append_array(NC_array *array, unsigned n, Void *tails)
+{
+    char    *ap;
+    unsigned ii;
 
     if (array == NULL) {
         NCadvise(NC_EINVAL, "increment: NULL array");
         return (NULL);
     }
 
-    array->values = realloc(array->values, (array->count + 1) * array->szof);
+    array->values = realloc(array->values, (array->count + n) * array->szof);
     if (array->values == NULL) {
         nc_serror("extend_array");
         return (NULL);
     }
     ap = array->values + array->szof * array->count;
-    (void)memcpy(ap, tail, array->szof);
-    array->count++;
+    (void)memcpy(ap, tails, array->szof * n);
+    array->count += n;
+    array->dirty = TRUE;
+
+    /* keep the name index current, or drop it to be rebuilt larger */
+    if (array->index != NULL) {
+        if (2 * (array->index->used + n) > array->index->mask + 1)
+            NC_unindex_array(array);
+        else
+            for (ii = array->count - n; ii < array->count; ii++)
+                NC_index_insert(array->index, NC_array_name(array, ii), (int)ii);
+    }
     return (array->values);
 }
 
+/*
+ * The name of element 'ii' of an array of dims, vars or attrs,
+ *  NULL for the other types of arrays
+ */
+static NC_string *
+NC_array_name(NC_array *array, unsigned ii)
+{
+    void *elem;
+
+    memcpy(&elem, array->values + array->szof * ii, sizeof(void *));
+    switch (array->type) {
+        case NC_DIMENSION:
+            return (((NC_dim *)elem)->name);
+        case NC_VARIABLE:
+            return (((NC_var *)elem)->name);
+        case NC_ATTRIBUTE:
+            return (((NC_attr *)elem)->name);
+        default:
+            return (NULL);
+    }
+}
+
+/*
+ * First slot to probe for a name of hash 'hash'
+ */
+static unsigned
+NC_index_slot(const NC_index *index, uint32 hash)
+{
+    /* NC_compute_hash() adds up the words of the name, so spread its bits */
+    hash *= 2654435761U;
+    return ((unsigned)(hash ^ (hash >> 15)) & index->mask);
+}
+
+/*
+ * Add element 'ii', named 'name', to an index
+ */
+static void
+NC_index_insert(NC_index *index, const NC_string *name, int ii)
+{
+    unsigned slot;
+
+    for (slot = NC_index_slot(index, name->hash); index->slots[slot] != -1; slot = (slot + 1) & index->mask)
+        ;
+    index->slots[slot] = ii;
+    index->used++;
+}
+
+/*
+ * Build the name index of an array of dims, vars or attrs,
+ *  returns NULL if the array can't be indexed
+ */
+static NC_index *
+NC_index_build(NC_array *array)
+{
+    NC_index *index;
+    unsigned  nslots;
+    unsigned  ii;
+
+    if (array->type != NC_DIMENSION && array->type != NC_VARIABLE && array->type != NC_ATTRIBUTE)
+        return (NULL);
+
+    /* keep the table at most half full */
+    for (nslots = 2 * NC_INDEX_MIN; nslots < 2 * array->count; nslots *= 2)
+        ;
+
+    index = malloc(sizeof(NC_index));
+    if (index == NULL)
+        return (NULL);
+    index->slots = malloc(sizeof(int) * nslots);
+    if (index->slots == NULL) {
+        free(index);
+        return (NULL);
+    }
+    index->mask = nslots - 1;
+    index->used = 0;
+    for (ii = 0; ii < nslots; ii++)
+        index->slots[ii] = -1;
+
+    /* elements go in by increasing index, so that along each probe sequence
+       the elements of the same name appear in the order of the array */
+    for (ii = 0; ii < array->count; ii++)
+        NC_index_insert(index, NC_array_name(array, ii), (int)ii);
+
+    return (index);
+}
+
+/*
+ * Drop the name index of an array, to be rebuilt by the next
+ *  NC_findname(); must be called when an element is renamed or removed
+ */
+void
+NC_unindex_array(NC_array *array)
+{
+    if (array != NULL && array->index != NULL) {
+        free(array->index->slots);
+        free(array->index);
+        array->index = NULL;
+    }
+}
+
+static size_t
+NC_string_memory(const NC_string *str)
+{
+    if (str == NULL)
+        return 0;
+    return sizeof(NC_string) + (str->values != NULL ? str->count + 1 : 0);
+}
+
+static size_t
+NC_var_memory(const NC_var *var)
+{
+    size_t   ret;
+    unsigned ndims = 0;
+
+    ret = sizeof(NC_var) + NC_string_memory(var->name) + NC_array_memory(var->attrs);
+    if (var->assoc != NULL) {
+        ndims = var->assoc->count;
+        ret += sizeof(NC_iarray) + ndims * sizeof(int);
+    }
+    if (var->shape != NULL)
+        ret += ndims * sizeof(unsigned long);
+    if (var->dsizes != NULL)
+        ret += ndims * sizeof(unsigned long);
+    return ret;
+}
+
+/*
+ * Bytes of memory held by an array, its name index and the elements
+ *  it points to, see NC_memory_usage()
+ */
+size_t
+NC_array_memory(const NC_array *array)
+{
+    const void *values;
+    size_t      ret;
+    unsigned    ii;
+
+    if (array == NULL)
+        return 0;
+    values = array->values;
+
+    ret = sizeof(NC_array) + array->count * array->szof;
+    if (array->index != NULL)
+        ret += sizeof(NC_index) + (array->index->mask + 1) * sizeof(int);
+
+    for (ii = 0; ii < array->count; ii++)
+        switch (array->type) {
+            case NC_STRING:
+                ret += NC_string_memory(((NC_string *const *)values)[ii]);
+                break;
+            case NC_DIMENSION:
+                ret += sizeof(NC_dim) + NC_string_memory(((NC_dim *const *)values)[ii]->name);
+                break;
+            case NC_VARIABLE:
+                ret += NC_var_memory(((NC_var *const *)values)[ii]);
+                break;
+            case NC_ATTRIBUTE:
+                ret += sizeof(NC_attr) + NC_string_memory(((NC_attr *const *)values)[ii]->name) +
+                       NC_array_memory(((NC_attr *const *)values)[ii]->data);
+                break;
+            default:
+                return ret;
+        }
+
+    return ret;
+}
+
+/*
+ * Look up an element of an array of dims, vars or attrs by name.
+ *  Returns the smallest index greater than 'after' of an element
+ *  named 'name', so -1 gives the first one, or -1 if there is none.
+ *  Arrays of NC_INDEX_MIN or more elements get a hash table on their
+ *  first lookup, which NC_incr_array() keeps up to date.
+ */
+int
+NC_findname(NC_array *array, const char *name, int after)
+{
+    NC_string *elem_name;
+    unsigned   len;
+    unsigned   slot;
+    uint32     hash;
+    int        ii;
+
+    if (array == NULL || array->count == 0)
+        return (-1);
+
+    len = (unsigned)strlen(name);
+    if (array->index == NULL && array->count >= NC_INDEX_MIN)
+        array->index = NC_index_build(array);
+
+    /* small array, or no memory for an index */
+    if (array->index == NULL) {
+        for (ii = after + 1; ii < (int)array->count; ii++) {
+            elem_name = NC_array_name(array, (unsigned)ii);
+            if (elem_name != NULL && len == elem_name->len && strncmp(name, elem_name->values, len) == 0)
+                return (ii);
+        }
+        return (-1);
+    }
+
+    hash = NC_compute_hash(len, name);
+    for (slot = NC_index_slot(array->index, hash); (ii = array->index->slots[slot]) != -1;
+         slot = (slot + 1) & array->index->mask) {
+        if (ii <= after)
+            continue;
+        elem_name = NC_array_name(array, (unsigned)ii);
+        if (elem_name->hash == hash && len == elem_name->len && strncmp(name, elem_name->values, len) == 0)
+            return (ii);
+    }
+    return (-1);
+}
+
 /*
  * Definitely NOT Bomb proof.
  */
@@ -463,9 +714,10 @@ xdr_NC_array(XDR *xdrs, NC_array **app)
                     return (FALSE);
                 }
             }
-            count  = (*app)->count;
-            type   = (*app)->type;
-            countp = &count;
+            count      = (*app)->count;
+            type       = (*app)->type;
+            countp     = &count;
+            temp_count = count;
             break;
         case XDR_DECODE:
             countp = &count;
@@ -111,6 +111,8 @@ NC_attrarray(int cdfid, int varid)
     else if (handle->vars != NULL && varid >= 0 && (unsigned)varid < handle->vars->count) {
         ap = (NC_array **)handle->vars->values;
         ap += varid;
+        if (hdf_read_var_attrs(handle, (NC_var *)(*ap)) == FAIL)
+            return (NULL);
         ap = &(((NC_var *)(*ap))->attrs); /* Whew! */
     }
     else {
@@ -127,23 +129,16 @@ NC_attrarray(int cdfid, int varid)
 NC_attr **
 NC_findattr(NC_array **ap, const char *name)
 {
-    NC_attr **attr;
-    unsigned  attrid;
-    size_t    len;
+    int attrid;
 
     if (*ap == NULL)
         return (NULL);
 
-    attr = (NC_attr **)(*ap)->values;
-
-    len = strlen(name);
+    attrid = NC_findname(*ap, name, -1);
+    if (attrid < 0)
+        return (NULL);
 
-    for (attrid = 0; attrid < (*ap)->count; attrid++, attr++) {
-        if (len == (*attr)->name->len && strncmp(name, (*attr)->name->values, len) == 0) {
-            return (attr); /* Normal return */
-        }
-    }
-    return (NULL);
+    return ((NC_attr **)(*ap)->values + attrid); /* Normal return */
 }
 
 /*
@@ -206,6 +201,7 @@ NC_aput(int cdfid, NC_array **ap, const char *name, nc_type datatype, unsigned c
                 return (-1);
             }
             NC_free_attr(old);
+            (*ap)->dirty = TRUE;
             return ((*ap)->count - 1);
         }
         /* else */
@@ -215,6 +211,7 @@ NC_aput(int cdfid, NC_array **ap, const char *name, nc_type datatype, unsigned c
         }
         /* else */
         (*atp)->HDFtype = hdf_map_type(datatype);
+        (*ap)->dirty    = TRUE;
         if (handle->flags & NC_HSYNC) {
             handle->xdrs->x_op = XDR_ENCODE;
             if (!xdr_cdf(handle->xdrs, &handle))
@@ -312,8 +309,9 @@ ncattinq(int cdfid, int varid, const char *name, nc_type *datatypep, int *countp
 int
 ncattrename(int cdfid, int varid, const char *name, const char *newname)
 {
-    NC       *handle;
-    NC_attr **attr;
+    NC        *handle;
+    NC_array **ap;
+    NC_attr  **attr;
     NC_string *new, *old;
 
     cdf_routine_name = "cdfattrrename";
@@ -331,6 +329,11 @@ ncattrename(int cdfid, int varid, const char *name, const char *newname)
     if (NC_lookupattr(cdfid, varid, newname, FALSE) != NULL) /* name in use */
         return (-1);
 
+    /* the name index goes stale */
+    ap = NC_attrarray(cdfid, varid);
+    NC_unindex_array(*ap);
+    (*ap)->dirty = TRUE;
+
     old = (*attr)->name;
     if (NC_indefine(cdfid, FALSE)) {
         new = NC_new_string((unsigned)strlen(newname), newname);
@@ -412,6 +415,8 @@ ncattdel(int cdfid, int varid, const char *name)
     }
     /* decrement count */
     (*ap)->count--;
+    NC_unindex_array(*ap);
+    (*ap)->dirty = TRUE;
 
     NC_free_attr(old);
 
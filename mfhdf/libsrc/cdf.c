@@ -28,6 +28,36 @@ static bool_t NC_xdr_cdf(XDR *xdrs, NC **handlep);
 
 static int NC_free_xcdf(NC *);
 
+/* The members of the top level Vgroup as the last header flush, or the
+   file's opening, left it; see hdf_write_xdr_cdf() */
+typedef struct {
+    int32 ref;   /* ref of a DFTAG_VG member */
+    int32 index; /* its index in the Vgroup */
+} hdf_vgref_t;
+
+typedef struct {
+    int32        count;  /* number of members */
+    int32       *tags;   /* their tags, in Vgroup order */
+    int32       *refs;   /* their refs, in Vgroup order */
+    intn        *done;   /* BOOLEAN == member kept or deleted already */
+    int32        nvgs;   /* number of DFTAG_VG members */
+    hdf_vgref_t *vgrefs; /* the DFTAG_VG members, by increasing ref */
+} hdf_oldcdf_t;
+
+static intn  hdf_get_oldcdf(NC *handle, hdf_oldcdf_t *old);
+static void  hdf_free_oldcdf(hdf_oldcdf_t *old);
+static int32 hdf_find_oldvg(hdf_oldcdf_t *old, int32 ref);
+static intn  hdf_keep_oldvg(hdf_oldcdf_t *old, int32 ref);
+static intn  hdf_delete_oldvg(NC *handle, hdf_oldcdf_t *old, int32 ref);
+static intn  hdf_delete_member(NC *handle, int32 tag, int32 ref);
+static intn  hdf_vg_clobber_members(NC *handle, int id, intn recurse);
+static intn  hdf_var_flushed(NC_var *vp, const intn *dim_written);
+static void  hdf_set_flushed(NC_var *vp);
+
+/* whether hdf_read_vars() leaves the attributes of the variables on disk
+   until they are needed, see SDsetlazyopen() */
+static intn lazy_open = FALSE;
+
 /* hmm we write the NDG out always for now */
 #define WRITE_NDG 1
 
@@ -66,7 +96,8 @@ NC_free_cdf(NC *handle)
         free(handle->xdrs);
         handle->xdrs = NULL;
 
-        if (handle->file_type == HDF_FILE) {
+        /* the HDF file of metadata kept by NC_set_metacache() is closed */
+        if (handle->file_type == HDF_FILE && handle->hdf_file != FAIL) {
             if (Vend(handle->hdf_file) == FAIL)
                 HGOTO_FAIL(FAIL);
 
@@ -91,33 +122,16 @@ done:
 int32
 hdf_get_magicnum(const char *filename)
 {
-    hdf_file_t fp;
-    uint8      buf[4];
-    uint8     *pbuf = NULL;
-    int32      magic_num;
-    int32      ret_value = 0;
-
-    fp = (hdf_file_t)HI_OPEN(filename, DFACC_READ);
-    if (OPENERR(fp)) {
-        HGOTO_ERROR(DFE_BADNAME, FAIL);
-    }
-
-    /* Make sure it is at the beginning of the file */
-    if (HI_SEEK(fp, MAGICOFFSET) == FAIL) {
-        HGOTO_ERROR(DFE_SEEKERROR, FAIL);
-    }
+    hdf_probe_t probe;
+    int32       magic_num;
+    int32       ret_value = 0;
 
     /* Read the first 4 bytes in the file, where the format version number
        is stored. */
-    if (HI_READ(fp, buf, MAGICLEN) == FAIL) {
-        HI_CLOSE(fp);
-        HGOTO_ERROR(DFE_READERROR, FAIL);
+    if (Hprobe(filename, FALSE, &probe) == FAIL) {
+        HGOTO_ERROR(DFE_BADNAME, FAIL);
     }
-
-    /* Obtain the file format version number then close the file*/
-    pbuf = &buf[0];
-    INT32DECODE(pbuf, magic_num);
-    HI_CLOSE(fp);
+    magic_num = probe.magic;
 
     /* If magic_num is a valid file format version number, then return it */
     if (magic_num == HDFXMAGIC || magic_num == CDFMAGIC || magic_num == NCMAGIC || magic_num == NCMAGIC64)
@@ -223,14 +237,20 @@ NC_new_cdf(const char *name, int mode)
         cdf->file_type = HDF_FILE;
     }
     else {
-        if (Hishdf(name))
-            cdf->file_type = HDF_FILE;
-        else if (HDiscdf(name))
-            cdf->file_type = CDF_FILE;
-        else if (HDisnetcdf(name))
-            cdf->file_type = netCDF_FILE;
-        else
-            HGOTO_FAIL(NULL);
+        /* the first 4 bytes of the file tell its type, read only once */
+        switch (hdf_get_magicnum(name)) {
+            case HDFXMAGIC:
+                cdf->file_type = HDF_FILE;
+                break;
+            case CDFMAGIC:
+                cdf->file_type = CDF_FILE;
+                break;
+            case NCMAGIC:
+                cdf->file_type = netCDF_FILE;
+                break;
+            default:
+                HGOTO_FAIL(NULL);
+        }
     }
 
     /* Delay allocating xdr struct until it is needed */
@@ -306,6 +326,10 @@ NC_new_cdf(const char *name, int mode)
             if (cdf->hdf_file == FAIL)
                 HGOTO_FAIL(NULL);
 
+            /* what the metadata are read from, see NC_set_metacache() */
+            if (hdf_mode == DFACC_RDONLY)
+                cdf->stamp = HPfile_stamp(name);
+
             /* start Vxx access */
             if (Vstart(cdf->hdf_file) == FAIL)
                 HGOTO_FAIL(NULL);
@@ -388,12 +412,14 @@ NC_dup_cdf(const char *name, int mode, NC *old)
         HGOTO_FAIL(NULL);
     }
 
-    cdf->dims      = NULL;
-    cdf->attrs     = NULL;
-    cdf->vars      = NULL;
-    cdf->begin_rec = 0;
-    cdf->recsize   = 0;
-    cdf->numrecs   = 0;
+    cdf->dims       = NULL;
+    cdf->attrs      = NULL;
+    cdf->vars       = NULL;
+    cdf->begin_rec  = 0;
+    cdf->recsize    = 0;
+    cdf->numrecs    = 0;
+    cdf->full_flush = FALSE;
+    cdf->stamp      = 0;
 
     cdf->file_type = old->file_type;
 
@@ -490,7 +516,7 @@ xdr_cdf(XDR *xdrs, NC **handlep)
 static bool_t
 NC_xdr_cdf(XDR *xdrs, NC **handlep)
 {
-    u_long magic;
+    u_long magic = NCMAGIC; /* written as is when encoding */
 
     if (xdrs->x_op == XDR_FREE) {
         NC_free_xcdf(*handlep);
@@ -1030,27 +1056,41 @@ done:
 
 /* ----------------------------------------------------------------
 ** Write out a cdf structure
+**
+** If the top level Vgroup of the structure as last read or written is
+**   still in the file, the Vgroups of the dimensions and variables that
+**   did not change since, and the global attributes if none of them
+**   did, go into the new top level Vgroup as they are; only the others
+**   are deleted and written again.
 */
 intn
 hdf_write_xdr_cdf(XDR *xdrs, NC **handlep)
 {
-    int32     count;
-    int       status, done;
-    unsigned  sz, i, j;
-    int32    *tags           = NULL;
-    int32    *refs           = NULL;
-    NC_dim  **dims           = NULL;
-    NC_dim  **dims1          = NULL;
-    NC_array *tmp            = NULL;
-    long     *dim_size_array = NULL;
-    long     *tsizeptr       = NULL;
-    long      tsize;
-    uint32   *dim_hash_array = NULL;
-    uint32   *thashptr       = NULL;
-    uint32    thash;
-    Void     *vars      = NULL;
-    Void     *attrs     = NULL;
-    intn      ret_value = SUCCEED;
+    int32        count;
+    int          status, done;
+    unsigned     sz, i, j;
+    int32        k, nattrs;
+    int32       *tags           = NULL;
+    int32       *refs           = NULL;
+    NC_dim     **dims           = NULL;
+    NC_dim     **dims1          = NULL;
+    NC_var      *vp             = NULL;
+    NC_array    *tmp            = NULL;
+    long        *dim_size_array = NULL;
+    long        *tsizeptr       = NULL;
+    long         tsize;
+    uint32      *dim_hash_array = NULL;
+    uint32      *thashptr       = NULL;
+    uint32       thash;
+    intn        *dim_written = NULL;  /* BOOLEAN == dimension got a new Vgroup */
+    intn         incremental = FALSE; /* BOOLEAN == the old structure is still there */
+    intn         keep_attrs  = FALSE; /* BOOLEAN == and so are all its global attributes */
+    hdf_oldcdf_t old;
+    Void        *vars      = NULL;
+    Void        *attrs     = NULL;
+    intn         ret_value = SUCCEED;
+
+    memset(&old, 0, sizeof(hdf_oldcdf_t));
 
     /* Convert old scales into coordinate var values before writing
        out any header info */
@@ -1058,6 +1098,16 @@ hdf_write_xdr_cdf(XDR *xdrs, NC **handlep)
     if (status == FAIL)
         HGOTO_FAIL(FAIL);
 
+    /* the structure is still in the file, see what of it can stay */
+    if ((*handlep)->vgid) {
+        /* Close open VData pointers */
+        if (FAIL == hdf_close((*handlep)))
+            HGOTO_FAIL(FAIL);
+        if (FAIL == hdf_get_oldcdf((*handlep), &old))
+            HGOTO_FAIL(FAIL);
+        incremental = TRUE;
+    }
+
     /* count size of tag / ref arrays */
     sz = 0;
     if ((*handlep)->dims)
@@ -1084,8 +1134,9 @@ hdf_write_xdr_cdf(XDR *xdrs, NC **handlep)
 
         tsizeptr = dim_size_array = malloc(sizeof(long) * (size_t)tmp->count);
         thashptr = dim_hash_array = malloc(sizeof(uint32) * (size_t)tmp->count);
+        dim_written               = calloc((size_t)tmp->count, sizeof(intn));
 
-        if (NULL == dim_size_array || NULL == dim_hash_array) {
+        if (NULL == dim_size_array || NULL == dim_hash_array || NULL == dim_written) {
             HGOTO_FAIL(FAIL);
         }
 
@@ -1120,9 +1171,14 @@ hdf_write_xdr_cdf(XDR *xdrs, NC **handlep)
 
             if (!done) {
                 tags[count] = (int32)DIM_TAG;
-                refs[count] = (int32)hdf_write_dim(xdrs, (*handlep), dims, count);
-                if (refs[count] == FAIL)
-                    HGOTO_FAIL(FAIL);
+                if (incremental && hdf_keep_oldvg(&old, (*dims)->vgid))
+                    refs[count] = (*dims)->vgid;
+                else {
+                    refs[count] = (int32)hdf_write_dim(xdrs, (*handlep), dims, count);
+                    if (refs[count] == FAIL)
+                        HGOTO_FAIL(FAIL);
+                    dim_written[i] = TRUE;
+                }
                 count++;
             }
             dims++;
@@ -1136,19 +1192,51 @@ hdf_write_xdr_cdf(XDR *xdrs, NC **handlep)
         tmp  = (*handlep)->vars;
         vars = (*handlep)->vars->values;
         for (i = 0; i < tmp->count; i++) {
+            memcpy(&vp, vars, sizeof(NC_var *));
             tags[count] = (int32)VAR_TAG;
-            refs[count] = (int32)hdf_write_var(xdrs, (*handlep), (NC_var **)vars);
-            if (refs[count] == FAIL)
-                HGOTO_FAIL(FAIL);
+            if (incremental && hdf_var_flushed(vp, dim_written) && hdf_keep_oldvg(&old, vp->vgid))
+                refs[count] = vp->vgid;
+            else {
+                if (incremental) {
+                    /* bring in the attributes still on disk, then delete
+                       the old Vgroup, whose NDG ref the new one reuses */
+                    if (FAIL == hdf_read_var_attrs((*handlep), vp))
+                        HGOTO_FAIL(FAIL);
+                    if (FAIL == hdf_delete_oldvg((*handlep), &old, vp->vgid))
+                        HGOTO_FAIL(FAIL);
+                }
+                refs[count] = (int32)hdf_write_var(xdrs, (*handlep), &vp);
+                if (refs[count] == FAIL)
+                    HGOTO_FAIL(FAIL);
+            }
+            hdf_set_flushed(vp);
             vars += tmp->szof;
             count++;
         }
     }
 
     /*
-     * write global attribute information
+     * write global attribute information, unless the old attribute
+     * Vdatas can stay: none changed and they are all there is
      */
-    if ((*handlep)->attrs) {
+    if (incremental && ((*handlep)->attrs == NULL || !(*handlep)->attrs->dirty)) {
+        nattrs = 0;
+        for (k = 0; k < old.count; k++)
+            if (old.tags[k] == (int32)ATTR_TAG)
+                nattrs++;
+        keep_attrs = (nattrs == (((*handlep)->attrs) ? (int32)(*handlep)->attrs->count : 0));
+    }
+    if (keep_attrs) {
+        for (k = 0; k < old.count; k++) {
+            if (old.tags[k] == (int32)ATTR_TAG) {
+                tags[count] = old.tags[k];
+                refs[count] = old.refs[k];
+                old.done[k] = TRUE;
+                count++;
+            }
+        }
+    }
+    else if ((*handlep)->attrs) {
         tmp   = (*handlep)->attrs;
         attrs = (*handlep)->attrs->values;
         for (i = 0; i < tmp->count; i++) {
@@ -1160,6 +1248,19 @@ hdf_write_xdr_cdf(XDR *xdrs, NC **handlep)
             count++;
         }
     }
+    if ((*handlep)->attrs)
+        (*handlep)->attrs->dirty = FALSE;
+
+    /* delete what is left of the old structure, then its Vgroup */
+    if (incremental) {
+        for (k = 0; k < old.count; k++) {
+            if (!old.done[k] && FAIL == hdf_delete_member((*handlep), old.tags[k], old.refs[k]))
+                HGOTO_FAIL(FAIL);
+            old.done[k] = TRUE;
+        }
+        if (FAIL == Vdelete((*handlep)->hdf_file, (*handlep)->vgid))
+            HGOTO_FAIL(FAIL);
+    }
 
     /* write out final VGroup thang */
     /* set the top level CDF VGroup pointer */
@@ -1168,8 +1269,10 @@ hdf_write_xdr_cdf(XDR *xdrs, NC **handlep)
     ret_value = (*handlep)->vgid; /* ref of final vgroup  */
 
 done:
+    hdf_free_oldcdf(&old);
     free(dim_size_array);
     free(dim_hash_array);
+    free(dim_written);
     free(tags);
     free(refs);
 
@@ -1571,9 +1674,12 @@ hdf_read_attrs(XDR *xdrs, NC *handle, int32 vg)
         } /* end if DFTAG_VH */
     }     /* end for */
 
-    /* create array of attributes */
-    if (count)
+    /* create array of attributes, as they are in the file */
+    if (count) {
         Array = NC_new_array(NC_ATTRIBUTE, count, (Void *)attributes);
+        if (Array != NULL)
+            Array->dirty = FALSE;
+    }
 
     ret_value = Array; /* return array of attributes */
 
@@ -1679,6 +1785,7 @@ hdf_read_vars(XDR *xdrs, NC *handle, int32 vg)
                 data_count = 0;
                 rag_ref    = 0;
                 is_rec_var = FALSE;
+                nattrs     = 0;
 
                 if (Vinquire(var, &n, vgname) == FAIL) {
                     HGOTO_FAIL(FAIL);
@@ -1735,6 +1842,9 @@ hdf_read_vars(XDR *xdrs, NC *handle, int32 vg)
                             if (FAIL == VSgetclass(sub, vsclass))
                                 HGOTO_FAIL(FAIL);
 
+                            if (!strcmp(vsclass, _HDF_ATTRIBUTE))
+                                nattrs++;
+
                             if (!strcmp(vsclass, _HDF_SDSVAR))
                                 var_type = IS_SDSVAR;
                             else if (!strcmp(vsclass, _HDF_CRDVAR))
@@ -1817,11 +1927,15 @@ hdf_read_vars(XDR *xdrs, NC *handle, int32 vg)
                     HGOTO_FAIL(FAIL);
                 }
 
-                /* Read in the attributes if any */
-                if ((nattrs = hdf_num_attrs(handle, var)) > 0)
-                    vp->attrs = hdf_read_attrs(xdrs, handle, var);
-                else
-                    vp->attrs = NULL;
+                /* Read in the attributes if any, or leave them for
+                   hdf_read_var_attrs() in lazy open mode */
+                vp->attrs = NULL;
+                if (nattrs > 0) {
+                    if (lazy_open)
+                        vp->lazy_attrs = TRUE;
+                    else
+                        vp->attrs = hdf_read_attrs(xdrs, handle, var);
+                }
 
                 /* set up for easy access later */
                 vp->vgid     = id;
@@ -1880,6 +1994,9 @@ hdf_read_vars(XDR *xdrs, NC *handle, int32 vg)
                         vp->numrecs = 1;
                     }
                 } /* end vp->data_ref */
+
+                /* the variable is as its Vgroup says */
+                hdf_set_flushed(vp);
                 count++;
             } /* end if vgroup class is variable */
 
@@ -1912,6 +2029,50 @@ done:
     return ret_value;
 } /* hdf_read_vars */
 
+/* ----------------------------------------------------------------
+** Read in the attributes of a variable that hdf_read_vars() left on
+** disk in lazy open mode
+** Return FAIL if something goes wrong
+*/
+intn
+hdf_read_var_attrs(NC *handle, NC_var *vp)
+{
+    int32 var       = FAIL;
+    intn  ret_value = SUCCEED;
+
+    if (!vp->lazy_attrs)
+        HGOTO_DONE(SUCCEED);
+
+    if ((var = Vattach(handle->hdf_file, vp->vgid, "r")) == FAIL)
+        HGOTO_ERROR(DFE_CANTATTACH, FAIL);
+
+    if ((vp->attrs = hdf_read_attrs(handle->xdrs, handle, var)) == NULL)
+        HGOTO_FAIL(FAIL);
+    vp->lazy_attrs = FALSE;
+
+done:
+    if (var != FAIL && FAIL == Vdetach(var))
+        ret_value = FAIL;
+
+    return ret_value;
+} /* hdf_read_var_attrs */
+
+/* ----------------------------------------------------------------
+** Set whether hdf_read_vars() reads the attributes of the variables
+** when a file is opened (FALSE) or when each variable is first used
+** (TRUE)
+** Return the previous setting
+*/
+intn
+hdf_set_lazy_open(intn lazy)
+{
+    intn ret_value = lazy_open;
+
+    lazy_open = (lazy ? TRUE : FALSE);
+
+    return ret_value;
+} /* hdf_set_lazy_open */
+
 /* ----------------------------------------------------------------
 ** Read in a cdf structure
 */
@@ -1973,12 +2134,29 @@ done:
 intn
 hdf_xdr_cdf(XDR *xdrs, NC **handlep)
 {
-    intn status;
-    intn ret_value = SUCCEED;
+    hdf_trace_op_t trace_op = (xdrs->x_op == XDR_ENCODE ? HDF_TRACE_META_FLUSH : HDF_TRACE_META_READ);
+    intn           status;
+    intn           ret_value = SUCCEED;
+
+    if (xdrs->x_op != XDR_FREE)
+        HP_TRACE(trace_op, FALSE, 0);
 
     switch (xdrs->x_op) {
         case XDR_ENCODE:
-            if ((*handlep)->vgid) {
+            /* hdf_write_xdr_cdf() only writes again what changed since the
+               structure was last read or written, unless the dimensions
+               changed in place and the old structure has to go first */
+            if ((*handlep)->vgid && (*handlep)->full_flush) {
+                /* the attributes left on disk are about to be deleted with
+                   the rest of the old structure, so bring them in first;
+                   looking up a variable reads them in */
+                if ((*handlep)->vars) {
+                    int ii;
+
+                    for (ii = 0; ii < (int)(*handlep)->vars->count; ii++)
+                        if (NULL == NC_hlookupvar((*handlep), ii))
+                            HGOTO_FAIL(FAIL);
+                }
                 if (FAIL == hdf_cdf_clobber((*handlep)))
                     HGOTO_FAIL(FAIL);
             }
@@ -1986,6 +2164,7 @@ hdf_xdr_cdf(XDR *xdrs, NC **handlep)
             if (FAIL == status) {
                 HGOTO_FAIL(FAIL);
             }
+            (*handlep)->full_flush = FALSE;
             break;
         case XDR_DECODE:
             if (FAIL == (status = hdf_read_xdr_cdf(xdrs, handlep))) {
@@ -2006,6 +2185,9 @@ hdf_xdr_cdf(XDR *xdrs, NC **handlep)
     }
 
 done:
+    if (xdrs->x_op != XDR_FREE)
+        HP_TRACE(trace_op, TRUE, 0);
+
     return ret_value;
 } /* hdf_xdr_cdf */
 
@@ -2017,6 +2199,16 @@ done:
 */
 intn
 hdf_vg_clobber(NC *handle, int id)
+{
+    return hdf_vg_clobber_members(handle, id, TRUE);
+} /* hdf_vg_clobber */
+
+/*
+  Delete the members of a VGroup, as hdf_vg_clobber() does, but going
+  into the member VGroups only if 'recurse' is set
+*/
+static intn
+hdf_vg_clobber_members(NC *handle, int id, intn recurse)
 {
     int   t, n;
     int32 vg, tag, ref;
@@ -2049,8 +2241,8 @@ hdf_vg_clobber(NC *handle, int id)
             case DFTAG_VG: /* recursive call */
                 /* check if vgroup exists in file before trying to delete
                    it's members */
-                if (vexistvg(handle->hdf_file, ref) != FAIL) {
-                    if (FAIL == hdf_vg_clobber(handle, ref)) {
+                if (recurse && vexistvg(handle->hdf_file, ref) != FAIL) {
+                    if (FAIL == hdf_vg_clobber_members(handle, ref, TRUE)) {
                         HGOTO_FAIL(FAIL);
                     }
                 }
@@ -2083,7 +2275,7 @@ hdf_vg_clobber(NC *handle, int id)
 
 done:
     return ret_value;
-} /* hdf_vg_clobber */
+} /* hdf_vg_clobber_members */
 
 /* --------------------------- hdf_cdf_clobber ---------------------------- */
 /*
@@ -2172,6 +2364,203 @@ done:
     return ret_value;
 } /* hdf_cdf_clobber */
 
+/* ----------------------------------------------------------------
+** Compare the refs of two Vgroup members, for qsort() and bsearch()
+*/
+static int
+hdf_vgref_cmp(const void *a, const void *b)
+{
+    int32 ref_a = ((const hdf_vgref_t *)a)->ref;
+    int32 ref_b = ((const hdf_vgref_t *)b)->ref;
+
+    return (ref_a < ref_b) ? -1 : (ref_a > ref_b);
+} /* hdf_vgref_cmp */
+
+/* ----------------------------------------------------------------
+** Read in the members of the top level Vgroup of a cdf structure
+** Return FAIL if something goes wrong
+*/
+static intn
+hdf_get_oldcdf(NC *handle, hdf_oldcdf_t *old)
+{
+    int32 vg = FAIL;
+    int32 ii;
+    intn  ret_value = SUCCEED;
+
+    memset(old, 0, sizeof(hdf_oldcdf_t));
+
+    vg = Vattach(handle->hdf_file, handle->vgid, "r");
+    if (vg == FAIL)
+        HGOTO_FAIL(FAIL);
+    old->count = Vntagrefs(vg);
+    if (old->count == FAIL)
+        HGOTO_FAIL(FAIL);
+
+    old->tags   = malloc(sizeof(int32) * (size_t)old->count + 1);
+    old->refs   = malloc(sizeof(int32) * (size_t)old->count + 1);
+    old->done   = calloc((size_t)old->count + 1, sizeof(intn));
+    old->vgrefs = malloc(sizeof(hdf_vgref_t) * (size_t)old->count + 1);
+    if (NULL == old->tags || NULL == old->refs || NULL == old->done || NULL == old->vgrefs)
+        HGOTO_FAIL(FAIL);
+
+    if (old->count > 0 && Vgettagrefs(vg, old->tags, old->refs, old->count) != old->count)
+        HGOTO_FAIL(FAIL);
+
+    for (ii = 0; ii < old->count; ii++) {
+        if (old->tags[ii] == DFTAG_VG) {
+            old->vgrefs[old->nvgs].ref   = old->refs[ii];
+            old->vgrefs[old->nvgs].index = ii;
+            old->nvgs++;
+        }
+    }
+    qsort(old->vgrefs, (size_t)old->nvgs, sizeof(hdf_vgref_t), hdf_vgref_cmp);
+
+done:
+    if (vg != FAIL && Vdetach(vg) == FAIL)
+        ret_value = FAIL;
+    if (ret_value == FAIL)
+        hdf_free_oldcdf(old);
+
+    return ret_value;
+} /* hdf_get_oldcdf */
+
+/* ----------------------------------------------------------------
+** Free what hdf_get_oldcdf() allocated
+*/
+static void
+hdf_free_oldcdf(hdf_oldcdf_t *old)
+{
+    free(old->tags);
+    free(old->refs);
+    free(old->done);
+    free(old->vgrefs);
+    memset(old, 0, sizeof(hdf_oldcdf_t));
+} /* hdf_free_oldcdf */
+
+/* ----------------------------------------------------------------
+** Look for the Vgroup 'ref' among the members of the old top level
+**   Vgroup that are neither kept nor deleted yet
+** Return the member's index or FAIL if there is none
+*/
+static int32
+hdf_find_oldvg(hdf_oldcdf_t *old, int32 ref)
+{
+    hdf_vgref_t  key;
+    hdf_vgref_t *found;
+
+    if (ref == 0 || old->nvgs == 0)
+        return FAIL;
+
+    key.ref = ref;
+    found   = bsearch(&key, old->vgrefs, (size_t)old->nvgs, sizeof(hdf_vgref_t), hdf_vgref_cmp);
+    if (found == NULL || old->done[found->index])
+        return FAIL;
+
+    return found->index;
+} /* hdf_find_oldvg */
+
+/* ----------------------------------------------------------------
+** Keep the Vgroup 'ref' of the old top level Vgroup in the new one
+** Return TRUE if it was there to be kept
+*/
+static intn
+hdf_keep_oldvg(hdf_oldcdf_t *old, int32 ref)
+{
+    int32 idx = hdf_find_oldvg(old, ref);
+
+    if (idx == FAIL)
+        return FALSE;
+
+    old->done[idx] = TRUE;
+    return TRUE;
+} /* hdf_keep_oldvg */
+
+/* ----------------------------------------------------------------
+** Delete the Vgroup 'ref' of the old top level Vgroup now, if it is
+**   there, rather than with the rest of the leftovers
+** Return FAIL if something goes wrong
+*/
+static intn
+hdf_delete_oldvg(NC *handle, hdf_oldcdf_t *old, int32 ref)
+{
+    int32 idx = hdf_find_oldvg(old, ref);
+
+    if (idx == FAIL)
+        return SUCCEED;
+
+    old->done[idx] = TRUE;
+    return hdf_delete_member(handle, DFTAG_VG, ref);
+} /* hdf_delete_oldvg */
+
+/* ----------------------------------------------------------------
+** Delete a member of the top level Vgroup of a cdf structure, leaving
+**   alone the Vgroups it holds, which are top level members too
+** Return FAIL if something goes wrong
+*/
+static intn
+hdf_delete_member(NC *handle, int32 tag, int32 ref)
+{
+    intn ret_value = SUCCEED;
+
+    switch (tag) {
+        case DFTAG_VG:
+            if (vexistvg(handle->hdf_file, (uint16)ref) != FAIL) {
+                if (FAIL == hdf_vg_clobber_members(handle, ref, FALSE))
+                    HGOTO_FAIL(FAIL);
+            }
+            if (FAIL == Vdelete(handle->hdf_file, ref))
+                HGOTO_FAIL(FAIL);
+            break;
+        case DFTAG_VH:
+            if (FAIL == VSdelete(handle->hdf_file, ref))
+                HGOTO_FAIL(FAIL);
+            break;
+        default:
+            if (FAIL == Hdeldd(handle->hdf_file, (uint16)tag, (uint16)ref))
+                HGOTO_FAIL(FAIL);
+            break;
+    }
+
+done:
+    return ret_value;
+} /* hdf_delete_member */
+
+/* ----------------------------------------------------------------
+** Whether the Vgroup of a variable still describes it, given which
+**   dimensions (by index) got a new Vgroup in this flush
+*/
+static intn
+hdf_var_flushed(NC_var *vp, const intn *dim_written)
+{
+    unsigned ii;
+
+    if (!vp->flushed || vp->vgid == 0)
+        return FALSE;
+    if (vp->data_ref != vp->flush_ref || vp->numrecs != vp->flush_recs)
+        return FALSE;
+    if (vp->attrs != NULL && vp->attrs->dirty)
+        return FALSE;
+    for (ii = 0; ii < vp->assoc->count; ii++)
+        if (dim_written[vp->assoc->values[ii]])
+            return FALSE; /* refers to the old Vgroup of the dimension */
+
+    return TRUE;
+} /* hdf_var_flushed */
+
+/* ----------------------------------------------------------------
+** Record that the Vgroup of a variable describes it, after it was
+**   read in or written out
+*/
+static void
+hdf_set_flushed(NC_var *vp)
+{
+    vp->flushed    = TRUE;
+    vp->flush_ref  = vp->data_ref;
+    vp->flush_recs = vp->numrecs;
+    if (vp->attrs != NULL)
+        vp->attrs->dirty = FALSE;
+} /* hdf_set_flushed */
+
 /* -------------------------- hdf_close --------------------- */
 /*
   We're about to close the file, do last minute HDF cleanup
@@ -2213,6 +2602,10 @@ hdf_close(NC *handle)
             }
 
             (*vp)->aid = FAIL; /* reset access id */
+
+            if (NC_end_views(*vp) == FAIL) {
+                HGOTO_FAIL(FAIL);
+            }
             vars += tmp->szof;
         } /* end for each variable */
     }
@@ -2349,21 +2742,20 @@ xdr_numrecs(XDR *xdrs, NC *handle)
     return (xdr_u_long(xdrs, &(handle->numrecs)));
 }
 
-static bool_t
-xdr_2shorts(XDR *xdrs, short *sp)
-/* sp - at least 2 valid shorts */
-{
-    return xdr_shorts(xdrs, sp, 2);
-}
+/* Bytes of fill values encoded at once by xdr_NC_fill() */
+#define NC_FILL_BLOCK 8192
 
 bool_t
 xdr_NC_fill(XDR *xdrs, NC_var *vp)
 {
-    char   fillp[2 * sizeof(double)];
-    bool_t stat;
-    bool_t (*xdr_NC_fnct)();
+    char      fillp[2 * sizeof(double)];
+    bool_t    stat;
     u_long    alen = vp->len;
-    NC_attr **attr = NULL;
+    u_long    blen;          /* bytes in the block of encoded fill values */
+    uint32    nfill;         /* fill values in the block */
+    char     *native = NULL; /* the fill values in memory */
+    char     *block  = NULL; /* the fill values as written */
+    NC_attr **attr   = NULL;
 
     /*
      * set up fill value
@@ -2388,38 +2780,47 @@ xdr_NC_fill(XDR *xdrs, NC_var *vp)
         }
     }
 
+    /* the values are written in whole XDR units, as many as fit in vp->len */
     switch (vp->type) {
         case NC_BYTE:
         case NC_CHAR:
-            alen /= 4;
-            xdr_NC_fnct = xdr_bytes;
-            break;
         case NC_SHORT:
-            alen /= 4;
-            xdr_NC_fnct = xdr_2shorts;
-            break;
         case NC_LONG:
-            alen /= 4;
-            xdr_NC_fnct = xdr_int;
-            break;
         case NC_FLOAT:
-            alen /= 4;
-            xdr_NC_fnct = xdr_float;
+            alen = alen / 4 * 4;
             break;
         case NC_DOUBLE:
-            alen /= 8;
-            xdr_NC_fnct = xdr_double;
+            alen = alen / 8 * 8;
             break;
         default:
             NCadvise(NC_EBADTYPE, "bad type %d", vp->type);
             return (FALSE);
     }
+    if (alen == 0)
+        return (TRUE);
+
+    /* encode a block of fill values once, the XDR encoding being the
+       same as that of the HDF number type, then write it out as often
+       as needed rather than one value at a time */
+    blen   = MIN(alen, NC_FILL_BLOCK);
+    nfill  = (uint32)(blen / vp->HDFsize);
+    native = malloc(nfill * vp->szof);
+    block  = malloc(blen);
+    stat   = (native != NULL && block != NULL);
+    if (stat) {
+        HDmemfill(native, fillp, (uint32)vp->szof, nfill);
+        stat = DFKconvert(native, block, vp->HDFtype, nfill, DFACC_WRITE, 0, 0) != FAIL;
+    }
 
     /* write out fill values */
-    for (stat = TRUE; stat && (alen > 0); alen--) {
-        stat = (*xdr_NC_fnct)(xdrs, fillp);
+    for (; stat && (alen > 0); alen -= blen) {
+        blen = MIN(alen, blen);
+        stat = xdr_opaque(xdrs, block, (u_int)blen);
     }
 
+    free(native);
+    free(block);
+
     if (!stat) {
         NCadvise(NC_EXDR, "xdr_NC_fill");
         return (FALSE);
@@ -239,6 +239,11 @@ ncdimrename(int cdfid, int dimid, const char *newname)
     dp = (NC_dim **)handle->dims->values;
     dp += dimid;
 
+    /* the name index goes stale, and the dimension's Vgroup with
+       those of its variables */
+    NC_unindex_array(handle->dims);
+    handle->full_flush = TRUE;
+
     old = (*dp)->name;
     if (NC_indefine(cdfid, FALSE)) {
         new = NC_new_string((unsigned)strlen(newname), newname);
@@ -28,26 +28,12 @@
 typedef int                               pid_t;
 #endif
 
-/* obtain the maximum number of open files allowed, at the same time,
-   on the current system */
-#if defined H4_HAVE_WIN32_API
-#define MAX_SYS_OPENFILES _getmaxstdio()
-#else
-#include <sys/resource.h>
-struct rlimit rlim;
-#define MAX_SYS_OPENFILES (getrlimit((RLIMIT_NOFILE), (&rlim)), rlim.rlim_cur)
-#endif
-
-/* Maximum number of files can be opened at one time; subtract 3 from
-   the system allowed to account for stdin, stdout, and stderr */
-/* On AIX 6.1 system the limit is 2GB-1; it caused our library to choke.
-   For now we will use a cap H4_MAX_AVAIL_OPENFILES on the maximum number
-   of files can be open at one time. This limit should probably
-   be in hlimits.h file in the future. EIP 2010-02-01*/
-
+/* Number of files the cdf list grows to once the current max is reached.
+   It no longer depends on the descriptors the system allows: HDF files
+   only hold a descriptor while recently used, see Hsetmaxdescriptors(),
+   so any number of them can be open.  Past this, the list keeps doubling. */
 #define H4_MAX_AVAIL_OPENFILES 20000
-#define MAX_AVAIL_OPENFILES                                                                                  \
-    (((MAX_SYS_OPENFILES - 3) > H4_MAX_AVAIL_OPENFILES) ? H4_MAX_AVAIL_OPENFILES : (MAX_SYS_OPENFILES - 3))
+#define MAX_AVAIL_OPENFILES    H4_MAX_AVAIL_OPENFILES
 
 static int _curr_opened = 0; /* the number of files currently opened */
 /* NOTE: _ncdf might have been the number of files currently opened, yet it
@@ -72,6 +58,13 @@ static NC **_cdfs;
 
 static intn max_NC_open = H4_MAX_NC_OPEN; /* current netCDF default */
 
+/* HDF files closed after being opened read-only, whose metadata are kept to
+   be reused when they are opened again, most recently closed first, see
+   NC_set_metacache() */
+static NC **nc_kept       = NULL;
+static intn nc_kept_count = 0;
+static intn nc_kept_max   = 0;
+
 /*
  * Resets _cdfs
  */
@@ -84,6 +77,41 @@ ncreset_cdflist(void)
     }
 }
 
+/*
+ *  Reallocates _cdfs to hold new_max files; returns SUCCEED or FAIL(-1).
+ */
+static intn
+ncgrow_cdflist(intn new_max)
+{
+    NC **newlist;
+    intn i;
+
+    newlist = malloc(sizeof(NC *) * new_max);
+
+    /* If allocation fails, return 0 for no allocation */
+    if (newlist == NULL) {
+        /* NC_EINVAL is Invalid Argument, but must decide if
+        we just want to return 0 without error or not */
+        NCadvise(NC_EINVAL, "Unable to allocate a cdf list of %d elements", new_max);
+        return FAIL;
+    }
+
+    /* If _cdfs is already allocated, transfer pointers over to the
+    new list and deallocate the old list of pointers */
+    if (_cdfs != NULL) {
+        for (i = 0; i < _ncdf; i++)
+            newlist[i] = _cdfs[i];
+        free(_cdfs);
+    }
+
+    /* Set _cdfs to the new list */
+    _cdfs = newlist;
+
+    /* Reset current max files opened allowed in HDF to the new max */
+    max_NC_open = new_max;
+    return SUCCEED;
+} /* ncgrow_cdflist */
+
 /*
  *  Allocates _cdfs and returns the allocated size if succeeds;
  *  otherwise return FAIL(-1).
@@ -94,8 +122,6 @@ NC_reset_maxopenfiles(intn req_max)
 {
     intn sys_limit = MAX_AVAIL_OPENFILES;
     intn alloc_size;
-    NC **newlist;
-    intn i;
     int  ret_value = SUCCEED;
 
     /* Verify arguments */
@@ -109,6 +135,9 @@ NC_reset_maxopenfiles(intn req_max)
     _cdfs as is and return the current max */
     if (req_max == 0) {
         if (!_cdfs) {
+            /* the first list may be sized by HDF_CONFIG_MAX_FILES */
+            if ((alloc_size = (intn)HPgetconfig(HDF_CONFIG_MAX_FILES)) > 0)
+                max_NC_open = MIN(alloc_size, sys_limit);
             _cdfs = malloc(sizeof(NC *) * (max_NC_open));
 
             /* If allocation fails, return 0 for no allocation */
@@ -134,35 +163,13 @@ NC_reset_maxopenfiles(intn req_max)
     /* If the requested max exceeds system limit, only allocate up
     to system limit */
     if (req_max > sys_limit)
-        alloc_size = sys_limit;
+        alloc_size = sys_limit > _ncdf ? sys_limit : max_NC_open;
     else
         alloc_size = req_max;
 
     /* Allocate a new list */
-    newlist = malloc(sizeof(NC *) * alloc_size);
-
-    /* If allocation fails, return 0 for no allocation */
-    if (newlist == NULL) {
-        /* NC_EINVAL is Invalid Argument, but must decide if
-        we just want to return 0 without error or not */
-        NCadvise(NC_EINVAL, "Unable to allocate a cdf list of %d elements", alloc_size);
+    if (ncgrow_cdflist(alloc_size) == FAIL)
         HGOTO_DONE(-1);
-    }
-
-    /* If _cdfs is already allocated, transfer pointers over to the
-    new list and deallocate the old list of pointers */
-    if (_cdfs != NULL) {
-        for (i = 0; i < _ncdf; i++)
-            newlist[i] = _cdfs[i];
-        free(_cdfs);
-    }
-
-    /* Set _cdfs to the new list */
-    _cdfs   = newlist;
-    newlist = NULL;
-
-    /* Reset current max files opened allowed in HDF to the new max */
-    max_NC_open = alloc_size;
 
     HGOTO_DONE(max_NC_open);
 
@@ -180,7 +187,7 @@ NC_get_maxopenfiles(void)
 } /* NC_get_maxopenfiles */
 
 /*
- *  Returns the maximum number of open files the system allows.
+ *  Returns the number of open files the cdf list grows to on demand.
  */
 intn
 NC_get_systemlimit(void)
@@ -197,6 +204,160 @@ NC_get_numopencdfs(void)
     return (_curr_opened);
 } /* NC_get_numopencdfs */
 
+/*
+ *  Returns the bytes of memory held by the metadata of the open files,
+ *  see Hget_memory_usage().
+ */
+size_t
+NC_memory_usage(void)
+{
+    size_t ret = 0;
+    int    ii;
+
+    for (ii = 0; ii < _ncdf; ii++)
+        if (_cdfs[ii] != NULL)
+            ret += sizeof(NC) + (_cdfs[ii]->xdrs != NULL ? sizeof(XDR) : 0) + NC_array_memory(_cdfs[ii]->dims) +
+                   NC_array_memory(_cdfs[ii]->attrs) + NC_array_memory(_cdfs[ii]->vars);
+    for (ii = 0; ii < nc_kept_count; ii++)
+        ret += sizeof(NC) + sizeof(XDR) + NC_array_memory(nc_kept[ii]->dims) +
+               NC_array_memory(nc_kept[ii]->attrs) + NC_array_memory(nc_kept[ii]->vars);
+
+    return ret;
+} /* NC_memory_usage */
+
+/*
+ *  Frees the metadata kept for the files closed last, from the last one
+ *  until no more than 'nfiles' are left.
+ */
+static void
+NC_kept_trim(intn nfiles)
+{
+    while (nc_kept_count > nfiles)
+        NC_free_cdf(nc_kept[--nc_kept_count]);
+}
+
+/*
+ *  Sets the number of HDF files opened read-only whose metadata are kept
+ *  after they are closed, see SDsetmetacache(); 0 frees them all.
+ *  Returns SUCCEED or FAIL.
+ */
+intn
+NC_set_metacache(intn nfiles)
+{
+    NC **newlist;
+
+    if (nfiles < 0) {
+        NCadvise(NC_EINVAL, "Invalid number of files %d", nfiles);
+        return FAIL;
+    }
+
+    NC_kept_trim(nfiles);
+    if (nfiles == 0) {
+        free(nc_kept);
+        nc_kept = NULL;
+    }
+    else if (nfiles != nc_kept_max) {
+        newlist = realloc(nc_kept, sizeof(NC *) * (size_t)nfiles);
+        if (newlist == NULL) {
+            NCadvise(NC_EINVAL, "Unable to allocate a list of %d kept files", nfiles);
+            return FAIL;
+        }
+        nc_kept = newlist;
+    }
+    nc_kept_max = nfiles;
+
+    return SUCCEED;
+} /* NC_set_metacache */
+
+/*
+ *  Frees the metadata kept for closed files, keeping the number of files
+ *  set by NC_set_metacache(); called by Htrim_memory() and at exit.
+ */
+intn
+NC_free_metacache(void)
+{
+    NC_kept_trim(0);
+    return SUCCEED;
+} /* NC_free_metacache */
+
+/*
+ *  Keeps the metadata of an HDF file being closed after being opened
+ *  read-only, provided the file has not changed on disk since it was read,
+ *  and closes its HDF file.  The HDF file is marked with HPkeep_open(), so
+ *  that its DD list is kept too, as long as Hsetkeepopen() allows.
+ *  Returns TRUE when it took the handle, FALSE when the caller frees it.
+ */
+static bool_t
+NC_kept_add(NC *handle)
+{
+    intn ii;
+
+    if (nc_kept_max == 0 || handle->file_type != HDF_FILE || (handle->flags & (NC_RDWR | NC_INDEF)) ||
+        handle->stamp == 0 || HPfile_stamp(handle->path) != handle->stamp)
+        return FALSE;
+
+    if (Vend(handle->hdf_file) == FAIL)
+        return FALSE;
+    HPkeep_open(handle->hdf_file);
+    if (Hclose(handle->hdf_file) == FAIL) {
+        handle->hdf_file = FAIL;
+        NC_free_cdf(handle);
+        return TRUE;
+    }
+    handle->hdf_file = FAIL;
+
+    /* the file may have been opened twice, keep the metadata closed last */
+    for (ii = 0; ii < nc_kept_count; ii++)
+        if (strcmp(nc_kept[ii]->path, handle->path) == 0) {
+            NC_free_cdf(nc_kept[ii]);
+            nc_kept[ii] = nc_kept[--nc_kept_count];
+            break;
+        }
+
+    NC_kept_trim(nc_kept_max - 1);
+    memmove(nc_kept + 1, nc_kept, sizeof(NC *) * (size_t)nc_kept_count);
+    nc_kept[0] = handle;
+    nc_kept_count++;
+
+    return TRUE;
+} /* NC_kept_add */
+
+/*
+ *  Takes the metadata kept for 'path' out of the kept files.  They are
+ *  returned, with the HDF file opened again, when the file is opened
+ *  read-only and has not changed on disk since it was read; they are freed
+ *  otherwise, and NULL is returned.
+ */
+static NC *
+NC_kept_take(const char *path, int mode)
+{
+    NC  *handle;
+    intn ii;
+
+    for (ii = 0; ii < nc_kept_count; ii++)
+        if (strcmp(nc_kept[ii]->path, path) == 0)
+            break;
+    if (ii == nc_kept_count)
+        return NULL;
+
+    handle = nc_kept[ii];
+    memmove(nc_kept + ii, nc_kept + ii + 1, sizeof(NC *) * (size_t)(nc_kept_count - ii - 1));
+    nc_kept_count--;
+
+    if (mode == NC_NOWRITE && HPfile_stamp(path) == handle->stamp) {
+        handle->hdf_file = Hopen(path, DFACC_RDONLY, 200);
+        if (handle->hdf_file != FAIL) {
+            if (Vstart(handle->hdf_file) != FAIL)
+                return handle;
+            Hclose(handle->hdf_file);
+            handle->hdf_file = FAIL;
+        }
+    }
+
+    NC_free_cdf(handle);
+    return NULL;
+} /* NC_kept_take */
+
 /*
  *  Check validity of cdf handle, return pointer to NC struct or
  * NULL on error.
@@ -258,22 +419,18 @@ NC_open(const char *path, int mode)
 
     /* if application attempts to open more files than the current max
     allows, increase the current max to the system limit, if it's
-    not at the system limit yet */
+    not at the system limit yet, else double it */
     if (cdfid == _ncdf && _ncdf >= max_NC_open) {
-        /* if the current max already reaches the system limit, fail */
-        if (max_NC_open == MAX_AVAIL_OPENFILES) {
-            NCadvise(NC_ENFILE, "maximum number of open cdfs allowed already reaches system limit %d",
-                     MAX_AVAIL_OPENFILES);
-            return (-1);
-        }
-        /* otherwise, increase the current max to the system limit */
-        if (FAIL == NC_reset_maxopenfiles(MAX_AVAIL_OPENFILES)) {
+        if (FAIL == ncgrow_cdflist(max_NC_open < MAX_AVAIL_OPENFILES ? MAX_AVAIL_OPENFILES : 2 * max_NC_open)) {
             NCadvise(NC_ENFILE, "Could not reset max open files limit");
             return (-1);
         }
     }
 
-    handle = NC_new_cdf(path, mode);
+    /* a file read before and unchanged since reuses its metadata */
+    handle = NC_kept_take(path, mode);
+    if (handle == NULL)
+        handle = NC_new_cdf(path, mode);
     if (handle == NULL) {
         /* if the failure was due to "too many open files," simply return */
         if (errno == EMFILE) {
@@ -622,10 +779,39 @@ ncredef(int cdfid)
 }
 
 /*
- * Compute offsets and put into the header
+ * Bytes left free after the header when the data has to be moved, so that
+ * the dimensions, attributes and variables added by a later ncredef() fit
+ * without moving it again
+ */
+#define NC_H_MINFREE 512
+
+/*
+ * Offset of the first data of a file, 0 when it has no variables
+ */
+static u_long
+NC_begin_data(NC *handle)
+{
+    unsigned ii;
+    u_long   begin = 0;
+    NC_var **vpp;
+
+    if (handle == NULL || handle->vars == NULL)
+        return (0);
+
+    vpp = (NC_var **)handle->vars->values;
+    for (ii = 0; ii < handle->vars->count; ii++, vpp++)
+        if (ii == 0 || (u_long)(*vpp)->begin < begin)
+            begin = (*vpp)->begin;
+    return (begin);
+}
+
+/*
+ * Compute offsets and put into the header.
+ * The data starts at begin_var, where that of the file being redefined
+ * starts, as long as the header still fits before it.
  */
 static void
-NC_begins(NC *handle)
+NC_begins(NC *handle, u_long begin_var)
 {
     unsigned ii;
     u_long   index = 0;
@@ -636,6 +822,10 @@ NC_begins(NC *handle)
         return;
 
     index = NC_xlen_cdf(handle);
+    if (index <= begin_var)
+        index = begin_var;
+    else
+        index += NC_H_MINFREE;
 
     /* loop thru vars, first pass is for the 'non-record' vars */
     vpp = (NC_var **)handle->vars->values;
@@ -683,23 +873,33 @@ bool_t
 NC_dcpy(XDR *target, XDR *source, long nbytes)
 {
 /* you may wish to tune this: big on a cray, small on a PC? */
-#define NC_DCP_BUFSIZE 8192
-    char buf[NC_DCP_BUFSIZE];
+#define NC_DCP_BUFSIZE 1048576
+    char *buf;
+    long  bufsize = nbytes < NC_DCP_BUFSIZE ? nbytes : NC_DCP_BUFSIZE;
+
+    if (nbytes <= 0)
+        return (TRUE);
+    if ((buf = malloc((size_t)bufsize)) == NULL) {
+        nc_serror("NC_dcpy");
+        return (FALSE);
+    }
 
-    while (nbytes > sizeof(buf)) {
-        if (!XDR_GETBYTES(source, buf, sizeof(buf)))
+    while (nbytes > bufsize) {
+        if (!XDR_GETBYTES(source, buf, bufsize))
             goto err;
-        if (!XDR_PUTBYTES(target, buf, sizeof(buf)))
+        if (!XDR_PUTBYTES(target, buf, bufsize))
             goto err;
-        nbytes -= sizeof(buf);
+        nbytes -= bufsize;
     }
-    /* we know nbytes <= sizeof(buf) at this point */
+    /* we know nbytes <= bufsize at this point */
     if (!XDR_GETBYTES(source, buf, nbytes))
         goto err;
     if (!XDR_PUTBYTES(target, buf, nbytes))
         goto err;
+    free(buf);
     return (TRUE);
 err:
+    free(buf);
     NCadvise(NC_EXDR, "NC_dcpy");
     return (FALSE);
 }
@@ -729,6 +929,7 @@ static bool_t
 NC_reccpy(XDR *target, NC *old, int varid, int recnum)
 {
     NC_var **vpp;
+    long     len;
     vpp = (NC_var **)old->vars->values;
     vpp += varid;
 
@@ -737,7 +938,47 @@ NC_reccpy(XDR *target, NC *old, int varid, int recnum)
         return (FALSE);
     }
 
-    return (NC_dcpy(target, old->xdrs, (*vpp)->len));
+    /* the records of a single record variable are packed */
+    len = (*vpp)->len;
+    if (old->recsize < (unsigned long)len)
+        len = (long)old->recsize;
+    return (NC_dcpy(target, old->xdrs, len));
+}
+
+/*
+ * Whether the data of old is still where NC_begins() put that of handle,
+ * in which case the new header can be written over the old one instead of
+ * copying the file: the variables of old begin at the same offsets and,
+ * once there are records, the record size is the same
+ */
+static bool_t
+NC_inplace(NC *handle, NC *old)
+{
+    unsigned ii;
+    NC_var **vpp;
+    NC_var **opp;
+
+    if (handle->vars == NULL)
+        return (FALSE);
+    if (old->vars == NULL)
+        return (TRUE);
+    if (old->numrecs > 0 && handle->recsize != old->recsize)
+        return (FALSE);
+
+    vpp = (NC_var **)handle->vars->values;
+    opp = (NC_var **)old->vars->values;
+    for (ii = 0; ii < handle->vars->count; ii++) {
+        if (IS_RECVAR(vpp[ii]) && old->numrecs == 0)
+            continue; /* no records to keep */
+        if (ii >= old->vars->count) {
+            if (IS_RECVAR(vpp[ii]))
+                return (FALSE); /* would need filling in every record */
+            continue;
+        }
+        if (vpp[ii]->begin != opp[ii]->begin)
+            return (FALSE);
+    }
+    return (TRUE);
 }
 
 /*
@@ -750,10 +991,19 @@ NC_endef(int cdfid, NC *handle)
     unsigned ii;
     unsigned jj = 0;
     NC_var **vpp;
-    NC      *stash = STASH(cdfid); /* faster rvalue */
+    NC      *stash   = STASH(cdfid); /* faster rvalue */
+    bool_t   inplace = FALSE;
 
     if (handle->file_type != HDF_FILE)
-        NC_begins(handle);
+        NC_begins(handle, NC_begin_data(stash));
+
+    if (handle->file_type == netCDF_FILE && !(handle->flags & NC_CREAT) && NC_inplace(handle, stash)) {
+        /* write to the file itself, the stash gets the scratch file */
+        xdrs         = handle->xdrs;
+        handle->xdrs = stash->xdrs;
+        stash->xdrs  = xdrs;
+        inplace      = TRUE;
+    }
 
     xdrs       = handle->xdrs;
     xdrs->x_op = XDR_ENCODE;
@@ -781,9 +1031,15 @@ NC_endef(int cdfid, NC *handle)
             continue; /* skip record variables on this pass */
         }
 
+        /* the header may be followed by free space, or is in place */
+        if (!xdr_setpos(xdrs, (*vpp)->begin)) {
+            nc_serror("Can't set position to %ld", (*vpp)->begin);
+            return (-1);
+        }
+
         if (!(handle->flags & NC_CREAT) && stash->vars != NULL && ii < stash->vars->count) {
             /* copy data */
-            if (!NC_vcpy(xdrs, stash, ii))
+            if (!inplace && !NC_vcpy(xdrs, stash, ii))
                 return (-1);
             continue;
         } /* else */
@@ -795,12 +1051,16 @@ NC_endef(int cdfid, NC *handle)
 
     if (!(handle->flags & NC_CREAT)) /* after redefinition */
     {
-        for (jj = 0; jj < stash->numrecs; jj++) {
+        for (jj = 0; !inplace && jj < stash->numrecs; jj++) {
             vpp = (NC_var **)handle->vars->values;
             for (ii = 0; ii < handle->vars->count; ii++, vpp++) {
                 if (!IS_RECVAR(*vpp)) {
                     continue; /* skip non-record variables on this pass */
                 }
+                if (!xdr_setpos(xdrs, (*vpp)->begin + handle->recsize * jj)) {
+                    nc_serror("Can't set position to record %u", jj);
+                    return (-1);
+                }
                 if (stash->vars != NULL && ii < stash->vars->count) {
                     /* copy data */
                     if (!NC_reccpy(xdrs, stash, ii, jj))
@@ -812,6 +1072,17 @@ NC_endef(int cdfid, NC *handle)
                         return (-1);
             }
         }
+        if (!inplace && stash->numrecs > 0) {
+            /* packed records of a single record variable may end off a 4-byte boundary */
+            static char zeros[4] = {0, 0, 0, 0};
+            u_long      end      = handle->begin_rec + handle->recsize * stash->numrecs;
+            u_int       pad      = (u_int)((4 - end % 4) % 4);
+
+            if (pad > 0 && (!xdr_setpos(xdrs, end) || !XDR_PUTBYTES(xdrs, zeros, pad))) {
+                nc_serror("Can't pad the last record");
+                return (-1);
+            }
+        }
         handle->numrecs = stash->numrecs;
         if (!xdr_numrecs(handle->xdrs, handle))
             return (-1);
@@ -822,34 +1093,43 @@ NC_endef(int cdfid, NC *handle)
         char realpath[FILENAME_MAX + 1];
         strcpy(realpath, stash->path);
 
-        /* close stash */
+        if (inplace) {
+            /* close the scratch file before removing it */
+            NC_free_cdf(stash);
+            stash = NULL;
+            if (remove(handle->path) != 0)
+                nc_serror("couldn't remove filename \"%s\"", handle->path);
+        }
+        else {
+            /* close stash */
 /*                NC_free_cdf(stash) ; */
 #ifdef H4_HAVE_WIN32_API
-        xdr_destroy(handle->xdrs); /* close handle */
-        if (remove(realpath) != 0)
-            nc_serror("couldn't remove filename \"%s\"", realpath);
+            xdr_destroy(handle->xdrs); /* close handle */
+            if (remove(realpath) != 0)
+                nc_serror("couldn't remove filename \"%s\"", realpath);
 #endif
-        if (rename(handle->path, realpath) != 0) {
-            nc_serror("rename %s -> %s failed", handle->path, realpath);
-            /* try to restore state prior to redef */
-            _cdfs[cdfid]           = stash;
-            _cdfs[handle->redefid] = NULL;
-            if (handle->redefid == _ncdf - 1)
-                _ncdf--;
-            _curr_opened--; /* one less file currently opened */
-            NC_free_cdf(handle);
-
-            /* if the _cdf list is empty, deallocate and reset it to NULL */
-            if (_ncdf == 0)
-                ncreset_cdflist();
+            if (rename(handle->path, realpath) != 0) {
+                nc_serror("rename %s -> %s failed", handle->path, realpath);
+                /* try to restore state prior to redef */
+                _cdfs[cdfid]           = stash;
+                _cdfs[handle->redefid] = NULL;
+                if (handle->redefid == _ncdf - 1)
+                    _ncdf--;
+                _curr_opened--; /* one less file currently opened */
+                NC_free_cdf(handle);
+
+                /* if the _cdf list is empty, deallocate and reset it to NULL */
+                if (_ncdf == 0)
+                    ncreset_cdflist();
 
-            return (-1);
-        }
-        (void)strncpy(handle->path, realpath, FILENAME_MAX);
+                return (-1);
+            }
 #ifdef H4_HAVE_WIN32_API
-        if (NCxdrfile_create(handle->xdrs, handle->path, NC_WRITE) < 0)
-            return -1;
+            if (NCxdrfile_create(handle->xdrs, realpath, NC_WRITE) < 0)
+                return -1;
 #endif
+        }
+        (void)strncpy(handle->path, realpath, FILENAME_MAX);
         NC_free_cdf(stash);
         _cdfs[handle->redefid] = NULL;
         if (handle->redefid == _ncdf - 1)
@@ -916,7 +1196,8 @@ ncclose(int cdfid)
     if (handle->file_type == HDF_FILE)
         hdf_close(handle);
 
-    NC_free_cdf(handle); /* calls fclose */
+    if (!NC_kept_add(handle))
+        NC_free_cdf(handle); /* calls fclose */
 
     _cdfs[cdfid] = NULL; /* reset pointer */
 
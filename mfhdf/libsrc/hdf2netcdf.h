@@ -69,6 +69,8 @@
 #define ncrecinq    HNAME(ncrecinq)
 #define ncrecget    HNAME(ncrecget)
 #define ncrecput    HNAME(ncrecput)
+#define ncrecgetn   HNAME(ncrecgetn)
+#define ncrecputn   HNAME(ncrecputn)
 #define ncnobuf     HNAME(ncnobuf) /* no prototype for this one */
 
 #endif /* !H4_HAVE_NETCDF i.e NOT USING HDF version of netCDF API */
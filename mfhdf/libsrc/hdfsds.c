@@ -73,14 +73,11 @@
  **************************************************************************/
 
 #include "local_nc.h"
-
-#define SDG_MAX_INITIAL 100
+#include "bitvect.h"
 
 /* local variables */
-static intn    sdgCurrent;
-static intn    sdgMax;
-static uint16 *sdgTable = NULL;
-static uint8  *ptbuf    = NULL;
+static bv_ptr sdgSeen = NULL; /* refs of the SDGs in SDG-NDG combos, one bit each */
+static uint8 *ptbuf   = NULL;
 
 /* Local routines */
 static intn hdf_query_seen_sdg(uint16 ndgRef);
@@ -99,8 +96,7 @@ uint8 *hdf_get_pred_str_attr(NC *handle, uint16 stratt_tag, uint16 satt_ref, int
    The SDG with the given ref number might be part of an SDG-NDG combo
    if so, we return TRUE else FALSE.
 
-   Attempt to discover if we've seen it in the most inefficient manner
-   possible
+   The refs seen are bits of a bit-vector, so this is a single lookup
 
  RETURNS
    TRUE / FALSE
@@ -109,17 +105,10 @@ uint8 *hdf_get_pred_str_attr(NC *handle, uint16 stratt_tag, uint16 satt_ref, int
 static intn
 hdf_query_seen_sdg(uint16 ndgRef)
 {
-    intn i;
-
-    if (!sdgTable)
+    if (sdgSeen == NULL)
         return FALSE;
 
-    for (i = 0; i < sdgCurrent; i++) {
-        if (sdgTable[i] == ndgRef)
-            return TRUE;
-    }
-
-    return FALSE;
+    return bv_get(sdgSeen, (int32)ndgRef) == BV_TRUE ? TRUE : FALSE;
 } /* hdf_query_seen_sdg */
 
 /******************************************************************************
@@ -139,26 +128,17 @@ hdf_register_seen_sdg(uint16 sdgRef)
 {
     intn ret_value = SUCCEED;
 
-    /* check if table is allocated */
-    if (!sdgTable) {
-        sdgMax   = SDG_MAX_INITIAL;
-        sdgTable = malloc(sdgMax * sizeof(uint16));
-        if (sdgTable == NULL) {
+    /* check if table is allocated, it grows with the largest ref */
+    if (sdgSeen == NULL) {
+        sdgSeen = bv_new(-1);
+        if (sdgSeen == NULL) {
             HGOTO_ERROR(DFE_NOSPACE, FAIL);
         }
-        sdgCurrent = 0;
     }
 
     /* add ref to table */
-    sdgTable[sdgCurrent++] = sdgRef;
-
-    /* check if we need to increase size of table */
-    if (sdgCurrent == sdgMax) {
-        sdgMax *= 2;
-        sdgTable = realloc(sdgTable, sdgMax * sizeof(uint16));
-        if (sdgTable == NULL) {
-            HGOTO_ERROR(DFE_NOSPACE, FAIL);
-        }
+    if (bv_set(sdgSeen, (int32)sdgRef, BV_TRUE) == FAIL) {
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
     }
 
 done:
@@ -1617,8 +1597,9 @@ hdf_read_sds_cdf(XDR *xdrs, NC **handlep)
      */
 
     /* we haven't seen any SDG-NDG combos yet */
-    free(sdgTable);
-    sdgTable = NULL;
+    if (sdgSeen != NULL)
+        bv_delete(sdgSeen);
+    sdgSeen = NULL;
 
     handle = (*handlep);
     if (NULL == handle) {
@@ -1631,8 +1612,9 @@ hdf_read_sds_cdf(XDR *xdrs, NC **handlep)
     }
 
     /* deallocate SDG-NDG space */
-    free(sdgTable);
-    sdgTable = NULL;
+    if (sdgSeen != NULL)
+        bv_delete(sdgSeen);
+    sdgSeen = NULL;
 
 done:
     return ret_value;
@@ -98,6 +98,9 @@ typedef unsigned long u_long;
 #define MAX_BLOCK_SIZE   65536 /* maximum size of block in linked blocks */
 #define BLOCK_COUNT      128   /* size of linked block pointer objects  */
 
+#define APPEND_BUF_SIZE 65536   /* starting size of the SDappend() buffer */
+#define MAX_APPEND_BUF  1048576 /* the SDappend() buffer grows up to this size */
+
 /* from cdflib.h CDF 2.3 */
 #ifndef MAX_VXR_ENTRIES
 #define MAX_VXR_ENTRIES 10
@@ -113,13 +116,18 @@ typedef struct vix_t_def {
     struct vix_t_def *next;                      /* next one in line */
 } vix_t;
 
+/* hash table from names to the indices of an array's elements, see NC_findname() */
+typedef struct NC_index NC_index;
+
 /* like, a discriminated union in the sense of xdr */
 typedef struct {
-    nc_type  type;   /* the discriminant */
-    size_t   len;    /* the total length originally allocated */
-    size_t   szof;   /* sizeof each value */
-    unsigned count;  /* length of the array */
-    Void    *values; /* the actual data */
+    nc_type   type;   /* the discriminant */
+    size_t    len;    /* the total length originally allocated */
+    size_t    szof;   /* sizeof each value */
+    unsigned  count;  /* length of the array */
+    Void     *values; /* the actual data */
+    NC_index *index;  /* name index of the dims, vars or attrs, NULL until needed */
+    intn      dirty;  /* BOOLEAN == changed since read from or written to the file */
 } NC_array;
 
 /* Counted string for names and such */
@@ -178,8 +186,10 @@ typedef struct {
     int32         hdf_file;
     int           file_type;
     int32         vgid;
-    int           hdf_mode; /* mode we are attached for */
-    hdf_file_t    cdf_fp;   /* file pointer used for CDF files */
+    int           hdf_mode;   /* mode we are attached for */
+    hdf_file_t    cdf_fp;     /* file pointer used for CDF files */
+    intn          full_flush; /* BOOLEAN == dims changed in place, rewrite all the metadata */
+    uint32        stamp;      /* HPfile_stamp() of an HDF file opened read-only, see NC_set_metacache() */
 } NC;
 
 /* NC variable: description and data */
@@ -224,6 +234,34 @@ typedef struct {
     int32 *rag_list;   /* size of ragged array lines */
     int32  rag_fill;   /* last line in rag_list to be set */
     vix_t *vixHead;    /* list of VXR records for CDF data storage */
+    intn   shuffle;    /* BOOLEAN == shuffle the bytes when compressing, see SDsetshuffle() */
+    intn   lazy_attrs; /* BOOLEAN == attributes not read in yet, see SDsetlazyopen() */
+    int32  sieve_size; /* size of the sieve buffer of 'aid', see SDsetsievebuf() */
+    intn   readahead;  /* BOOLEAN == readahead is on for 'aid', see SDsetchunkreadahead() */
+    /* The Vgroup 'vgid' is left as it is when the header is flushed if the
+       variable is 'flushed' and its data ref and number of records are the
+       ones it was read or written with, see hdf_write_xdr_cdf() */
+    intn   flushed;    /* BOOLEAN == name, type and attributes match the Vgroup */
+    uint16 flush_ref;  /* data_ref when read or written */
+    int    flush_recs; /* numrecs when read or written */
+    void  *app_buf;    /* records given to SDappend() and not written yet */
+    int32  app_nrecs;  /* number of records in app_buf */
+    int32  app_max;    /* number of records app_buf holds */
+    int32  app_id;     /* dataset ID the records were appended with */
+    /* The values of a coordinate variable as SDgetdimscale() returned them
+       last, dropped when the variable is written to, see NC_free_scale() */
+    void *scale_buf;   /* decoded scale values */
+    long  scale_count; /* number of values in scale_buf */
+    /* Chunks held by SDgetchunkptr() until SDreleasechunk(), see NC_end_views() */
+    int32  view_aid;   /* aid the chunks are pinned in the chunk cache with */
+    void **view_bufs;  /* chunks converted to the native number type */
+    intn   nview_bufs; /* number of entries in view_bufs */
+    /* Range of the values written since SDsetautorange(), see NC_range_update() */
+    intn    autorange;   /* BOOLEAN == keep the range and store it at SDendaccess() */
+    intn    range_set;   /* BOOLEAN == a value other than the fill value was written */
+    float64 range_min;   /* least value written */
+    float64 range_max;   /* greatest value written */
+    int32   range_nfill; /* number of fill values written */
 } NC_var;
 
 #define IS_RECVAR(vp) ((vp)->shape != NULL ? (*(vp)->shape == NC_UNLIMITED) : 0)
@@ -282,6 +320,11 @@ extern "C" {
 #define NC_free_string    HNAME(NC_free_string)
 #define NC_free_var       HNAME(NC_free_var)
 #define NC_incr_array     HNAME(NC_incr_array)
+#define NC_append_array   HNAME(NC_append_array)
+#define NC_findname       HNAME(NC_findname)
+#define NC_unindex_array  HNAME(NC_unindex_array)
+#define NC_array_memory   HNAME(NC_array_memory)
+#define NC_compute_hash   HNAME(NC_compute_hash)
 #define NC_dimid          HNAME(NC_dimid)
 #define NCcktype          HNAME(NCcktype)
 #define NC_indefine       HNAME(NC_indefine)
@@ -315,9 +358,14 @@ extern "C" {
 #define NC_dcpy           HNAME(NC_dcpy)
 #define NCxdrfile_sync    HNAME(NCxdrfile_sync)
 #define NCxdrfile_create  HNAME(NCxdrfile_create)
+#define NCxdrfile_bufsize HNAME(NCxdrfile_bufsize)
 #ifdef HDF
-#define NCgenio      HNAME(NCgenio)      /* from putgetg.c */
-#define NC_var_shape HNAME(NC_var_shape) /* from var.c */
+#define NCgenio         HNAME(NCgenio)         /* from putgetg.c */
+#define NC_var_shape    HNAME(NC_var_shape)    /* from var.c */
+#define NC_free_scale   HNAME(NC_free_scale)   /* from var.c */
+#define NC_end_views    HNAME(NC_end_views)    /* from var.c */
+#define NC_range_update HNAME(NC_range_update) /* from var.c */
+#define NC_range_get    HNAME(NC_range_get)    /* from var.c */
 #endif
 #endif /* !H4_HAVE_NETCDF ie. NOT USING HDF version of netCDF ncxxx API */
 
@@ -447,6 +495,13 @@ HDFLIBAPI int  NC_free_string(NC_string *cdfstr);
 HDFLIBAPI int  NC_free_var(NC_var *var);
 
 HDFLIBAPI Void *NC_incr_array(NC_array *array, Void *tail);
+HDFLIBAPI Void *NC_append_array(NC_array *array, unsigned n, Void *tails);
+HDFLIBAPI int   NC_findname(NC_array *array, const char *name, int after);
+HDFLIBAPI void  NC_unindex_array(NC_array *array);
+
+HDFLIBAPI size_t NC_array_memory(const NC_array *array);
+
+HDFLIBAPI uint32 NC_compute_hash(unsigned count, const char *str);
 
 HDFLIBAPI int    NC_dimid(NC *handle, char *name);
 HDFLIBAPI bool_t NCcktype(nc_type datatype);
@@ -484,6 +539,7 @@ HDFLIBAPI bool_t     NC_dcpy(XDR *target, XDR *source, long nbytes);
 HDFLIBAPI int        NCxdrfile_sync(XDR *xdrs);
 
 HDFLIBAPI int NCxdrfile_create(XDR *xdrs, const char *path, int ncmode);
+HDFLIBAPI int NCxdrfile_bufsize(XDR *xdrs, int nbytes);
 
 /* this routine is found in 'xdrposix.c' */
 HDFLIBAPI void hdf_xdrfile_create(XDR *xdrs, int ncop);
@@ -520,6 +576,10 @@ HDFLIBAPI NC_array *hdf_read_attrs(XDR *, NC *, int32);
 
 HDFLIBAPI intn hdf_read_vars(XDR *, NC *, int32);
 
+HDFLIBAPI intn hdf_read_var_attrs(NC *, NC_var *);
+
+HDFLIBAPI intn hdf_set_lazy_open(intn);
+
 HDFLIBAPI intn hdf_read_xdr_cdf(XDR *, NC **);
 
 HDFLIBAPI intn hdf_xdr_cdf(XDR *, NC **);
@@ -536,11 +596,21 @@ HDFLIBAPI intn hdf_read_sds_cdf(XDR *, NC **);
 
 HDFLIBAPI intn SDPfreebuf(void);
 
+HDFLIBAPI int32 SDPsetbuflimit(int32 nbytes);
+
 HDFLIBAPI intn NCgenio(NC *handle, int varid, const long *start, const long *count, const long *stride,
                        const long *imap, void *values);
 
 HDFLIBAPI intn NC_var_shape(NC_var *var, NC_array *dims);
 
+HDFLIBAPI void NC_free_scale(NC_var *var);
+
+HDFLIBAPI intn NC_end_views(NC_var *var);
+
+HDFLIBAPI void NC_range_update(NC_var *var, const void *values, long count);
+
+HDFLIBAPI intn NC_range_get(NC_var *var, void *pmax, void *pmin);
+
 HDFLIBAPI intn NC_reset_maxopenfiles(intn req_max);
 
 HDFLIBAPI intn NC_get_maxopenfiles(void);
@@ -549,6 +619,12 @@ HDFLIBAPI intn NC_get_systemlimit(void);
 
 HDFLIBAPI int NC_get_numopencdfs(void);
 
+HDFLIBAPI size_t NC_memory_usage(void);
+
+HDFLIBAPI intn NC_set_metacache(intn nfiles);
+
+HDFLIBAPI intn NC_free_metacache(void);
+
 /* CDF stuff. don't need anymore? -GV */
 HDFLIBAPI nc_type cdf_unmap_type(int type);
 
@@ -0,0 +1,496 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/******************************************************************************
+FILE
+  mfasync.c
+
+  This file contains the multi-file SD interface functions that read and
+  write data in the background, so that an application can compute while
+  the library does its I/O.
+
+  Requests are queued and run in order by a single I/O thread, started by
+  the first request.  The SD interface is not thread-safe, so while any
+  request is outstanding the application may only call SDreaddata_async(),
+  SDwritedata_async(), SDtest() and SDwait(); SDendaccess() and SDend()
+  wait for the outstanding requests first.  Without thread support the
+  requests are run right away by SDreaddata_async()/SDwritedata_async().
+
+  As with the rest of the SD API, these functions have names beginning with SD.
+
+EXPORTED ROUTINES
+-----------------
+
+  SDreaddata_async  -- start reading a slab of a dataset
+  SDwritedata_async -- start writing a slab of a dataset
+  SDtest            -- tell whether a request has completed
+  SDwait            -- wait for a request and get its result
+
+LOCAL ROUTINES
+--------------
+  SDIasync_find     -- look up a request by token
+  SDIasync_submit   -- queue a request
+  SDIasync_run      -- run a request
+  SDIasync_worker   -- body of the I/O thread
+  SDIasync_shutdown -- stop the I/O thread at library termination
+
+ ******************************************************************************/
+
+#include "local_nc.h"
+#include "mfhdf.h"
+#include "mfprivate.h"
+
+#ifdef H4_HAVE_THREADS
+#include <pthread.h>
+#endif
+
+/* State of a request */
+typedef enum { SDASYNC_PENDING = 0, SDASYNC_RUNNING, SDASYNC_DONE } sdasync_state_t;
+
+/* A read or write request */
+typedef struct sdasync_req_t {
+    int32                 token;                   /* token handed to the application */
+    sdasync_state_t       state;                   /* where the request is at */
+    intn                  is_write;                /* TRUE for a write, FALSE for a read */
+    int32                 sdsid;                   /* dataset to read or write */
+    int32                 start[H4_MAX_VAR_DIMS];  /* copy of the caller's start */
+    int32                 stride[H4_MAX_VAR_DIMS]; /* copy of the caller's stride */
+    int32                 edge[H4_MAX_VAR_DIMS];   /* copy of the caller's edge */
+    intn                  has_stride;              /* whether a stride was given */
+    void                 *data;                    /* the caller's buffer */
+    intn                  status;                  /* result of the read or write */
+    struct sdasync_req_t *next;                    /* next request, in submission order */
+} sdasync_req_t;
+
+/* Requests not waited for yet, oldest first */
+static sdasync_req_t *SDIasync_head = NULL;
+static sdasync_req_t *SDIasync_tail = NULL;
+
+/* Last token handed out */
+static int32 SDIasync_last_token = 0;
+
+#ifdef H4_HAVE_THREADS
+/* Protects the request list, the state of the requests and the thread state */
+static pthread_mutex_t SDIasync_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Signaled when a request is queued, when one completes and at shutdown */
+static pthread_cond_t SDIasync_cond = PTHREAD_COND_INITIALIZER;
+
+/* Held while the library is used on behalf of a request, or to submit one */
+static pthread_mutex_t SDIasync_run_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_t SDIasync_thread;
+static intn      SDIasync_started = FALSE; /* the I/O thread is running */
+static intn      SDIasync_stop    = FALSE; /* the I/O thread should exit */
+#endif /* H4_HAVE_THREADS */
+
+/* Private function prototypes */
+static sdasync_req_t *SDIasync_find(int32 token);
+static int32          SDIasync_submit(intn is_write, int32 sdsid, int32 *start, int32 *stride, int32 *edge,
+                                      void *data);
+static void           SDIasync_run(sdasync_req_t *req);
+#ifdef H4_HAVE_THREADS
+static void *SDIasync_worker(void *arg);
+static intn  SDIasync_shutdown(void);
+#endif
+
+/******************************************************************************
+ NAME
+    SDIasync_find -- look up a request by token
+
+ DESCRIPTION
+    Must be called with the request list locked.
+
+ RETURNS
+    The request, or NULL if there is no request with that token
+******************************************************************************/
+static sdasync_req_t *
+SDIasync_find(int32 token)
+{
+    sdasync_req_t *req;
+
+    for (req = SDIasync_head; req != NULL; req = req->next)
+        if (req->token == token)
+            break;
+
+    return req;
+} /* SDIasync_find */
+
+/******************************************************************************
+ NAME
+    SDIasync_run -- run a request
+
+ DESCRIPTION
+    Reads or writes the slab of the request through SDreaddata() or
+    SDwritedata() and keeps the result in the request.
+
+ RETURNS
+    None
+******************************************************************************/
+static void
+SDIasync_run(sdasync_req_t *req)
+{
+    int32 *stride = req->has_stride ? req->stride : NULL;
+
+    if (req->is_write)
+        req->status = SDwritedata(req->sdsid, req->start, stride, req->edge, req->data);
+    else
+        req->status = SDreaddata(req->sdsid, req->start, stride, req->edge, req->data);
+} /* SDIasync_run */
+
+#ifdef H4_HAVE_THREADS
+/******************************************************************************
+ NAME
+    SDIasync_worker -- body of the I/O thread
+
+ DESCRIPTION
+    Runs the pending requests in the order they were submitted, until
+    SDIasync_shutdown() asks it to stop and no request is left.
+
+ RETURNS
+    NULL
+******************************************************************************/
+static void *
+SDIasync_worker(void *arg)
+{
+    sdasync_req_t *req;
+
+    (void)arg;
+
+    pthread_mutex_lock(&SDIasync_lock);
+    for (;;) {
+        for (req = SDIasync_head; req != NULL; req = req->next)
+            if (req->state == SDASYNC_PENDING)
+                break;
+
+        if (req == NULL) {
+            if (SDIasync_stop)
+                break;
+            pthread_cond_wait(&SDIasync_cond, &SDIasync_lock);
+            continue;
+        }
+
+        /* Run the request without holding up SDtest() and SDwait() */
+        req->state = SDASYNC_RUNNING;
+        pthread_mutex_unlock(&SDIasync_lock);
+
+        pthread_mutex_lock(&SDIasync_run_lock);
+        SDIasync_run(req);
+        pthread_mutex_unlock(&SDIasync_run_lock);
+
+        pthread_mutex_lock(&SDIasync_lock);
+        req->state = SDASYNC_DONE;
+        pthread_cond_broadcast(&SDIasync_cond);
+    }
+    pthread_mutex_unlock(&SDIasync_lock);
+
+    return NULL;
+} /* SDIasync_worker */
+
+/******************************************************************************
+ NAME
+    SDIasync_shutdown -- stop the I/O thread at library termination
+
+ DESCRIPTION
+    Lets the I/O thread finish the pending requests, joins it and frees
+    the requests that were never waited for.
+
+ RETURNS
+    SUCCEED
+******************************************************************************/
+static intn
+SDIasync_shutdown(void)
+{
+    sdasync_req_t *req;
+
+    pthread_mutex_lock(&SDIasync_lock);
+    if (SDIasync_started) {
+        SDIasync_stop = TRUE;
+        pthread_cond_broadcast(&SDIasync_cond);
+        pthread_mutex_unlock(&SDIasync_lock);
+        pthread_join(SDIasync_thread, NULL);
+        pthread_mutex_lock(&SDIasync_lock);
+        SDIasync_started = FALSE;
+        SDIasync_stop    = FALSE;
+    }
+
+    while (SDIasync_head != NULL) {
+        req           = SDIasync_head;
+        SDIasync_head = req->next;
+        free(req);
+    }
+    SDIasync_tail = NULL;
+    pthread_mutex_unlock(&SDIasync_lock);
+
+    return SUCCEED;
+} /* SDIasync_shutdown */
+#endif /* H4_HAVE_THREADS */
+
+/******************************************************************************
+ NAME
+    SDIasync_submit -- queue a request
+
+ DESCRIPTION
+    Checks the dataset, copies the caller's start, stride and edge arrays
+    and queues the request for the I/O thread, starting the thread first
+    if needed.  Without thread support the request is run right away.
+
+ RETURNS
+    The token of the request, or FAIL
+******************************************************************************/
+static int32
+SDIasync_submit(intn is_write, int32 sdsid, int32 *start, int32 *stride, int32 *edge, void *data)
+{
+    sdasync_req_t *req = NULL;
+    int32          rank;
+    intn           i;
+    int32          ret_value = FAIL;
+
+#ifdef H4_HAVE_THREADS
+    /* Keep the I/O thread out of the library while the dataset is checked */
+    pthread_mutex_lock(&SDIasync_run_lock);
+#endif
+
+    /* clear error stack */
+    HEclear();
+
+    /* Check args */
+    if (start == NULL || edge == NULL || data == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (SDgetinfo(sdsid, NULL, &rank, NULL, NULL, NULL) == FAIL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (rank < 0 || rank > H4_MAX_VAR_DIMS)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if ((req = (sdasync_req_t *)calloc(1, sizeof(sdasync_req_t))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    req->state      = SDASYNC_PENDING;
+    req->is_write   = is_write;
+    req->sdsid      = sdsid;
+    req->has_stride = (stride != NULL);
+    req->data       = data;
+    for (i = 0; i < rank; i++) {
+        req->start[i]  = start[i];
+        req->edge[i]   = edge[i];
+        req->stride[i] = (stride != NULL) ? stride[i] : 1;
+    }
+
+#ifdef H4_HAVE_THREADS
+    pthread_mutex_lock(&SDIasync_lock);
+    if (!SDIasync_started) {
+        if (HPregister_term_func(&SDIasync_shutdown) != 0 ||
+            pthread_create(&SDIasync_thread, NULL, SDIasync_worker, NULL) != 0) {
+            pthread_mutex_unlock(&SDIasync_lock);
+            HGOTO_ERROR(DFE_CANTINIT, FAIL);
+        }
+        SDIasync_started = TRUE;
+    }
+#endif
+
+    /* Hand out the next token, never FAIL or 0 */
+    SDIasync_last_token = (SDIasync_last_token % 0x7ffffffe) + 1;
+    req->token          = SDIasync_last_token;
+
+    if (SDIasync_tail != NULL)
+        SDIasync_tail->next = req;
+    else
+        SDIasync_head = req;
+    SDIasync_tail = req;
+    ret_value     = req->token;
+
+#ifdef H4_HAVE_THREADS
+    pthread_cond_broadcast(&SDIasync_cond);
+    pthread_mutex_unlock(&SDIasync_lock);
+#else
+    SDIasync_run(req);
+    req->state = SDASYNC_DONE;
+#endif
+    req = NULL; /* queued */
+
+done:
+    free(req);
+#ifdef H4_HAVE_THREADS
+    pthread_mutex_unlock(&SDIasync_run_lock);
+#endif
+    return ret_value;
+} /* SDIasync_submit */
+
+/******************************************************************************
+ NAME
+    SDPasync_drain -- wait for all outstanding requests
+
+ DESCRIPTION
+    Called by SDendaccess() and SDend() before they touch the library, so
+    that no request is left running on a dataset or file going away.  The
+    requests stay around for SDwait().
+
+ RETURNS
+    None
+******************************************************************************/
+void
+SDPasync_drain(void)
+{
+#ifdef H4_HAVE_THREADS
+    sdasync_req_t *req;
+
+    pthread_mutex_lock(&SDIasync_lock);
+    for (;;) {
+        for (req = SDIasync_head; req != NULL; req = req->next)
+            if (req->state != SDASYNC_DONE)
+                break;
+        if (req == NULL)
+            break;
+        pthread_cond_wait(&SDIasync_cond, &SDIasync_lock);
+    }
+    pthread_mutex_unlock(&SDIasync_lock);
+#endif
+} /* SDPasync_drain */
+
+/******************************************************************************
+ NAME
+    SDreaddata_async -- start reading a slab of a dataset
+
+ DESCRIPTION
+    Queues a read of the slab described by 'start', 'stride' and 'edge',
+    as SDreaddata() would read it, into 'data'.  The start, stride and
+    edge arrays are copied; 'data' must be left alone until SDwait() has
+    been called for the request.  The dataset is checked right away, all
+    other errors are reported by SDwait().
+
+ RETURNS
+    The token of the request if successful and FAIL otherwise
+******************************************************************************/
+int32
+SDreaddata_async(int32  sdsid,  /* IN:  dataset ID */
+                 int32 *start,  /* IN:  coords of starting point */
+                 int32 *stride, /* IN:  stride along each dimension */
+                 int32 *edge,   /* IN:  number of values to read per dimension */
+                 void  *data /* OUT: data buffer */)
+{
+    return SDIasync_submit(FALSE, sdsid, start, stride, edge, data);
+} /* SDreaddata_async */
+
+/******************************************************************************
+ NAME
+    SDwritedata_async -- start writing a slab of a dataset
+
+ DESCRIPTION
+    Queues a write of 'data' to the slab described by 'start', 'stride'
+    and 'edge', as SDwritedata() would write it.  The start, stride and
+    edge arrays are copied; 'data' must be left alone until SDwait() has
+    been called for the request.  The dataset is checked right away, all
+    other errors are reported by SDwait().
+
+ RETURNS
+    The token of the request if successful and FAIL otherwise
+******************************************************************************/
+int32
+SDwritedata_async(int32  sdsid,  /* IN: dataset ID */
+                  int32 *start,  /* IN: coords of starting point */
+                  int32 *stride, /* IN: stride along each dimension */
+                  int32 *edge,   /* IN: number of values to write per dimension */
+                  void  *data /* IN: data buffer */)
+{
+    return SDIasync_submit(TRUE, sdsid, start, stride, edge, data);
+} /* SDwritedata_async */
+
+/******************************************************************************
+ NAME
+    SDtest -- tell whether a request has completed
+
+ DESCRIPTION
+    Sets 'done' to TRUE if the request has completed and to FALSE if it is
+    still queued or running.  Never waits for the I/O thread.  The request
+    remains until SDwait() is called for it.
+
+    This routine does not clear the error stack, which may be in use by
+    a running request.
+
+ RETURNS
+    SUCCEED, or FAIL if 'request' is not an outstanding request
+******************************************************************************/
+intn
+SDtest(int32 request, /* IN:  token of the request */
+       intn *done /* OUT: whether the request has completed */)
+{
+    sdasync_req_t *req;
+    intn           ret_value = SUCCEED;
+
+#ifdef H4_HAVE_THREADS
+    pthread_mutex_lock(&SDIasync_lock);
+#endif
+    if (done == NULL || (req = SDIasync_find(request)) == NULL)
+        ret_value = FAIL;
+    else
+        *done = (req->state == SDASYNC_DONE);
+#ifdef H4_HAVE_THREADS
+    pthread_mutex_unlock(&SDIasync_lock);
+#endif
+
+    return ret_value;
+} /* SDtest */
+
+/******************************************************************************
+ NAME
+    SDwait -- wait for a request and get its result
+
+ DESCRIPTION
+    Waits until the request has completed, releases its token and returns
+    what SDreaddata() or SDwritedata() returned for it.  When the request
+    failed, its errors are on the error stack in builds that share one
+    error stack between threads; thread-safe builds keep them on the stack
+    of the I/O thread.
+
+    This routine does not clear the error stack, which may be in use by
+    a running request.
+
+ RETURNS
+    The result of the request, or FAIL if 'request' is not an outstanding
+    request
+******************************************************************************/
+intn
+SDwait(int32 request /* IN: token of the request */)
+{
+    sdasync_req_t *req;
+    sdasync_req_t *prev      = NULL;
+    intn           ret_value = FAIL;
+
+#ifdef H4_HAVE_THREADS
+    pthread_mutex_lock(&SDIasync_lock);
+#endif
+    for (req = SDIasync_head; req != NULL; prev = req, req = req->next)
+        if (req->token == request)
+            break;
+
+    if (req != NULL) {
+#ifdef H4_HAVE_THREADS
+        while (req->state != SDASYNC_DONE)
+            pthread_cond_wait(&SDIasync_cond, &SDIasync_lock);
+#endif
+        ret_value = req->status;
+
+        /* Unlink the request */
+        if (prev != NULL)
+            prev->next = req->next;
+        else
+            SDIasync_head = req->next;
+        if (SDIasync_tail == req)
+            SDIasync_tail = prev;
+        free(req);
+    }
+#ifdef H4_HAVE_THREADS
+    pthread_mutex_unlock(&SDIasync_lock);
+#endif
+
+    return ret_value;
+} /* SDwait */
@@ -57,6 +57,8 @@ extern "C" {
 
 HDFLIBAPI int32 SDstart(const char *name, int32 accs);
 
+HDFLIBAPI intn SDstart_many(intn nfiles, const char *names[], int32 accs, int32 sd_ids[]);
+
 HDFLIBAPI intn SDend(int32 fid);
 
 HDFLIBAPI intn SDfileinfo(int32 fid, int32 *datasets, int32 *attrs);
@@ -79,6 +81,9 @@ HDFLIBAPI intn SDgetrange(int32 sdsid, void *pmax, void *pmin);
 
 HDFLIBAPI int32 SDcreate(int32 fid, const char *name, int32 nt, int32 rank, int32 *dimsizes);
 
+HDFLIBAPI intn SDcreate_many(int32 fid, intn n, const char *names[], int32 nt, int32 rank, int32 *dimsizes,
+                             int32 sds_ids[]);
+
 HDFLIBAPI int32 SDgetdimid(int32 sdsid, intn number);
 
 HDFLIBAPI intn SDsetdimname(int32 id, const char *name);
@@ -87,12 +92,18 @@ HDFLIBAPI intn SDendaccess(int32 id);
 
 HDFLIBAPI intn SDsetrange(int32 sdsid, void *pmax, void *pmin);
 
+HDFLIBAPI intn SDsetautorange(int32 sdsid, intn flag);
+
+HDFLIBAPI intn SDgetautorange(int32 sdsid, void *pmax, void *pmin, int32 *nfill);
+
 HDFLIBAPI intn SDsetattr(int32 id, const char *name, int32 nt, int32 count, const void *data);
 
 HDFLIBAPI intn SDattrinfo(int32 id, int32 idx, char *name, int32 *nt, int32 *count);
 
 HDFLIBAPI intn SDreadattr(int32 id, int32 idx, void *buf);
 
+HDFLIBAPI int32 SDreadallattrs(int32 id, hdf_attr_t *attrs, int32 max_attrs, void *arena, int32 *arena_size);
+
 HDFLIBAPI intn SDwritedata(int32 sdsid, int32 *start, int32 *stride, int32 *end, void *data);
 
 HDFLIBAPI intn SDsetdatastrs(int32 sdsid, const char *l, const char *u, const char *f, const char *c);
@@ -105,6 +116,8 @@ HDFLIBAPI intn SDgetfillvalue(int32 sdsid, void *val);
 
 HDFLIBAPI intn SDsetfillmode(int32 id, intn fillmode);
 
+HDFLIBAPI intn SDsetconvertinplace(int32 id, intn inplace);
+
 HDFLIBAPI intn SDgetdatastrs(int32 sdsid, char *l, char *u, char *f, char *c, intn len);
 
 HDFLIBAPI intn SDgetcal(int32 sdsid, float64 *cal, float64 *cale, float64 *ioff, float64 *ioffe, int32 *nt);
@@ -135,6 +148,10 @@ HDFLIBAPI intn SDgetcompinfo(int32 id, comp_coder_t *type, comp_info *c_info);
 
 HDFLIBAPI intn SDgetcomptype(int32 id, comp_coder_t *type);
 
+HDFLIBAPI intn SDsetshuffle(int32 id, intn shuffle);
+
+HDFLIBAPI intn SDgetshuffle(int32 id, intn *shuffle);
+
 HDFLIBAPI int32 SDfindattr(int32 id, const char *attrname);
 
 HDFLIBAPI int32 SDidtoref(int32 id);
@@ -151,6 +168,8 @@ HDFLIBAPI intn SDsetblocksize(int32 sdsid, int32 block_size);
 
 HDFLIBAPI intn SDgetblocksize(int32 sdsid, int32 *block_size);
 
+HDFLIBAPI intn SDcompact(int32 sdsid);
+
 HDFLIBAPI intn SDsetdimval_comp(int32 dimid, intn compt_mode);
 
 HDFLIBAPI intn SDisdimval_bwcomp(int32 dimid);
@@ -165,6 +184,10 @@ HDFLIBAPI intn SDget_maxopenfiles(intn *curr_max, intn *sys_limit);
 
 HDFLIBAPI intn SDget_numopenfiles(void);
 
+HDFLIBAPI intn SDsetlazyopen(intn lazy);
+
+HDFLIBAPI intn SDsetmetacache(intn nfiles);
+
 HDFLIBAPI intn SDgetdatasize(int32 sdsid, int32 *comp_size, int32 *uncomp_size);
 
 HDFLIBAPI intn SDgetfilename(int32 fid, char *filename);
@@ -317,6 +340,28 @@ HDFLIBAPI intn SDgetchunkinfo(int32          sdsid,     /* IN: sds access id */
                               HDF_CHUNK_DEF *chunk_def, /* IN/OUT: chunk definition */
                               int32         *flags /* IN/OUT: flags */);
 
+/******************************************************************************
+ NAME
+     SDgetchunkslab -- get the part of the SDS read by one of several readers
+
+ DESCRIPTION
+     Splits the SDS along its first dimension into 'nparts' slabs made of
+     whole chunks, or of whole rows if the SDS is not chunked, as evenly
+     as possible, and returns in 'start' and 'edges' the hyperslab of slab
+     'part', counting from 0.  Reading these hyperslabs, for instance by
+     the processes of an MPI job reading the file through Hsetmpio(),
+     reads each chunk by one reader only.  A slab may be empty, with
+     'edges[0]' 0, when there are fewer chunks than parts.
+
+ RETURNS
+        SUCCEED/FAIL
+******************************************************************************/
+HDFLIBAPI intn SDgetchunkslab(int32  sdsid,  /* IN: sds access id */
+                              int32  nparts, /* IN: number of parts */
+                              int32  part,   /* IN: part to get, 0 to nparts-1 */
+                              int32 *start,  /* OUT: start of the part */
+                              int32 *edges /* OUT: edges of the part */);
+
 /******************************************************************************
  NAME
      SDwritechunk  -- write the specified chunk to the SDS
@@ -365,6 +410,46 @@ HDFLIBAPI intn SDreadchunk(int32  sdsid,  /* IN: sds access id */
                            int32 *origin, /* IN: origin of chunk to read */
                            void  *datap /* IN/OUT: buffer for data */);
 
+/******************************************************************************
+ NAME
+     SDreadchunkraw -- read the stored data of a chunk of the SDS
+
+ DESCRIPTION
+     This routine copies the chunk of the chunked SDS specified by chunk
+     'origin' as it is stored in the file, i.e. still compressed if the
+     SDS is, into 'datap' without decoding or converting it.  With 'datap'
+     NULL only the size of the stored chunk is returned.
+
+     See SDwritechunkraw() to copy the chunk to another SDS.
+
+ RETURNS
+        The number of bytes of the stored chunk, 0 if the chunk was never
+        written and FAIL on error
+******************************************************************************/
+HDFLIBAPI int32 SDreadchunkraw(int32  sdsid,  /* IN: sds access id */
+                               int32 *origin, /* IN: origin of chunk to read */
+                               void  *datap,  /* OUT: buffer for the stored chunk */
+                               int32  buflen /* IN: size of 'datap' */);
+
+/******************************************************************************
+ NAME
+     SDwritechunkraw -- write the stored data of a chunk of the SDS
+
+ DESCRIPTION
+     This routine writes 'length' bytes read by SDreadchunkraw() as the
+     chunk of the chunked SDS specified by chunk 'origin', without
+     encoding or converting them.  The SDS must have the same number type,
+     chunk lengths and compression as the one the data was read from, and
+     the chunk must not have been written yet.
+
+ RETURNS
+        SUCCEED/FAIL
+******************************************************************************/
+HDFLIBAPI intn SDwritechunkraw(int32       sdsid,  /* IN: sds access id */
+                               int32      *origin, /* IN: origin of chunk to write */
+                               const void *datap,  /* IN: stored chunk */
+                               int32       length /* IN: number of bytes in 'datap' */);
+
 /******************************************************************************
 NAME
      SDsetchunkcache -- maximum number of chunks to cache
@@ -403,6 +488,21 @@ DESCRIPTION
      in memory, otherwise pass in zero(0). Currently you can only
      pass in zero.
 
+     The policy used to pick the chunk to evict from a full cache can be
+     or'ed into 'flags': HDF_CACHE_LRU (the default, least recently used),
+     HDF_CACHE_CLOCK or HDF_CACHE_2Q.  HDF_CACHE_2Q is scan resistant:
+     chunks that were only read once, as in a pass across the data, are
+     evicted before chunks that were read again.
+
+     With HDF_CACHE_SHARED also or'ed into 'flags', the cache joins the
+     cache pool shared by all the datasets of the process, whose byte
+     budget is set with SDsetchunkcachebudget().  'maxcache' still bounds
+     the number of chunks cached and is the dataset's weight in the pool:
+     when the pool is full, chunks are evicted from the dataset holding
+     the most bytes relative to its weight.  Calling again without
+     HDF_CACHE_SHARED takes the cache out of the pool.  Thread-safe
+     builds have no pool and refuse HDF_CACHE_SHARED.
+
     See SDsetchunk() for a description of the organization of chunks in an SDS.
 
 RETURNS
@@ -413,6 +513,598 @@ HDFLIBAPI intn SDsetchunkcache(int32 sdsid,    /* IN: sds access id */
                                int32 maxcache, /* IN: max number of chunks to cache */
                                int32 flags /* IN: flags = 0, HDF_CACHEALL */);
 
+/******************************************************************************
+NAME
+     SDsetchunkthreads -- number of threads used to code chunks
+
+DESCRIPTION
+     Set the number of threads used to decode and encode the compressed
+     chunks of a chunked SDS.
+
+     With 'nthreads' greater than 1, the deflate or LZ4 compressed chunks
+     that a read has to bring into the chunk cache are decoded in parallel on
+     up to 'nthreads' threads, and new ones are encoded in
+     parallel before they are written.  SZIP compressed chunks and those of
+     the coders registered with HCregister_coder() are decoded in parallel
+     as well, but encoded serially.  Written chunks may only reach the
+     file when the SDS is closed with SDendaccess().  Passing 1 restores the
+     default, serial coding.  Chunks using other compression methods or
+     shuffled bytes are always coded serially, as are all chunks when the
+     library was built without thread support.
+
+RETURNS
+     Returns the previous number of threads if successful and FAIL otherwise
+******************************************************************************/
+HDFLIBAPI intn SDsetchunkthreads(int32 sdsid, /* IN: sds access id */
+                                 intn  nthreads /* IN: number of decoding threads */);
+
+/******************************************************************************
+NAME
+     SDgetchunkcachestats -- hit, miss and eviction counts of the chunk cache
+
+DESCRIPTION
+     Returns the number of chunk lookups of a chunked SDS that were found
+     in its chunk cache, the number that had to read the chunk from the
+     file, and the number of chunks evicted to make room for others, since
+     the SDS was selected.  Useful to size the cache and pick its
+     replacement policy with SDsetchunkcache(); the I/O of the whole file
+     is counted by Hgetstats().
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+HDFLIBAPI intn SDgetchunkcachestats(int32              sdsid, /* IN: sds access id */
+                                    hdf_cache_stats_t *stats /* OUT: hit, miss and eviction counts */);
+
+/******************************************************************************
+NAME
+     SDsetchunkreadahead -- turn readahead of sequential reads on or off
+
+DESCRIPTION
+     With readahead on, a chunked SDS read slab by slab at a fixed step,
+     e.g. along its slowest dimension, brings the chunks the next slab
+     needs into the chunk cache at the end of each read, once three reads
+     in a row followed the pattern.  With SDsetchunkthreads() those chunks
+     are decoded on the coding threads together with the chunks of the
+     current read, and with SDreaddata_async() the whole read, readahead
+     included, runs in the background.  Nothing is read ahead when the
+     next slab needs more chunks than the chunk cache holds, see
+     SDsetchunkcache().  Readahead is off by default.
+
+RETURNS
+     Returns the previous setting (TRUE or FALSE) if successful and FAIL
+     otherwise
+******************************************************************************/
+HDFLIBAPI intn SDsetchunkreadahead(int32 sdsid, /* IN: sds access id */
+                                   intn  readahead /* IN: TRUE to turn readahead on */);
+
+/******************************************************************************
+NAME
+     SDsetchunksparse -- leave chunks of only fill values unwritten
+
+DESCRIPTION
+     With sparse writes on, a chunk of a chunked SDS that holds nothing
+     but the fill value when it is written out of the chunk cache is left
+     out of the file, unless it was written before.  Such chunks read
+     back as the fill value, so masked or mostly empty grids take only
+     the space of their other chunks.  Sparse writes are off by default.
+
+     Whether sparse writes are on or not, SDreaddata() puts the fill value
+     straight into the caller's buffer for the chunks that were never
+     written, without going through the chunk cache.
+
+RETURNS
+     Returns the previous setting (TRUE or FALSE) if successful and FAIL
+     otherwise
+******************************************************************************/
+HDFLIBAPI intn SDsetchunksparse(int32 sdsid, /* IN: sds access id */
+                                intn  sparse /* IN: TRUE to leave chunks of fill values unwritten */);
+
+/******************************************************************************
+NAME
+     SDsetchunkdedup -- share the data of identical chunks
+
+DESCRIPTION
+     With deduplication on, a new chunk of a chunked SDS that is the same,
+     byte for byte, as a chunk written since the SDS was selected is not
+     encoded and written again: it points at the data of that chunk.
+     Grids with many identical chunks, such as masks or repeated tiles,
+     then take the space and the writes of one of each.  Chunks written
+     with SDwritechunkraw() are compared as stored.  A chunk sharing its
+     data gets data of its own when it is written again.  Deduplication
+     is off by default.
+
+RETURNS
+     Returns the previous setting (TRUE or FALSE) if successful and FAIL
+     otherwise
+******************************************************************************/
+HDFLIBAPI intn SDsetchunkdedup(int32 sdsid, /* IN: sds access id */
+                               intn  dedup /* IN: TRUE to share the data of identical chunks */);
+
+/******************************************************************************
+NAME
+     SDsetchunkrawlimit -- store chunks that do not compress well as they are
+
+DESCRIPTION
+     With a limit set, a new chunk of a deflate or LZ4 compressed chunked
+     SDS that does not compress to at most 'percent' percent of its size
+     is stored uncompressed, and is read back without being decoded.  A
+     sample of a large chunk is compressed first, so that a chunk of
+     noise-like data costs little more to write than if it were not
+     compressed.  Such chunks read back with any version of the library.
+     SDreadchunkraw() fails on them with DFE_BADCODER, as it does on
+     chunks coded otherwise than the SDS.  A 'percent' of 0, the default,
+     turns the limit off.
+
+RETURNS
+     Returns the previous limit if successful and FAIL otherwise
+******************************************************************************/
+HDFLIBAPI intn SDsetchunkrawlimit(int32 sdsid, /* IN: sds access id */
+                                  intn  percent /* IN: limit of the compressed size, 0 for none */);
+
+/******************************************************************************
+NAME
+     SDsetchunkcoderpolicy -- choose the coder of each new chunk by a trial
+
+DESCRIPTION
+     With a policy set, a sample of each new chunk of a deflate or LZ4
+     compressed chunked SDS is compressed with LZ4 (when the library has
+     it), deflate at level 1 and deflate at the level of the SDS.  The
+     chunk is compressed with the fastest of these whose sample is at
+     most 'percent' percent larger than the smallest one, so that chunks
+     that compress about as well either way are written faster.  The
+     coder of each chunk is kept with it and the SDS reads back with any
+     version of the library that has that coder.  SDreadchunkraw() fails
+     with DFE_BADCODER on chunks coded otherwise than the SDS.  A negative
+     'percent', the default, turns the policy off.
+
+RETURNS
+     Returns SUCCEED if successful and FAIL otherwise
+******************************************************************************/
+HDFLIBAPI intn SDsetchunkcoderpolicy(int32 sdsid, /* IN: sds access id */
+                                     intn  percent /* IN: size a faster coder may trail by, <0 for none */);
+
+/******************************************************************************
+NAME
+     SDgetchunkmap -- get the map of the chunks written
+
+DESCRIPTION
+     Fills in 'map', if not NULL, with one bit per chunk of a chunked SDS,
+     set for each chunk that has been written.  Chunk number n, counting
+     the chunks with the last dimension changing fastest, is bit (n % 8)
+     of map[n / 8], so 'map' must have room for (nchunks + 7) / 8 bytes.
+     The number of chunks of the SDS is returned in 'nchunks' if it is not
+     NULL, so a first call with 'map' NULL gets the size of the map.
+
+     The map comes from the chunk table kept in memory while the SDS is
+     open and no chunk is read, so reads can be planned over only the
+     chunks that exist.  The chunks never written read as the fill value.
+
+RETURNS
+     Returns the number of chunks written if successful and FAIL otherwise
+******************************************************************************/
+HDFLIBAPI int32 SDgetchunkmap(int32  sdsid, /* IN: sds access id */
+                              uint8 *map,   /* OUT: one bit per chunk, set if written */
+                              int32 *nchunks /* OUT: number of chunks of the SDS */);
+
+/******************************************************************************
+NAME
+     SDsetchunkstats -- keep statistics of the chunks of an SDS
+
+DESCRIPTION
+     From now on, each chunk of a chunked SDS that is written gets its
+     statistics: the least and greatest of its values and their number,
+     the fill value and NaNs left out.  They are stored with the chunk
+     table and kept up to date whenever the SDS is written, also after
+     the file is closed and opened again.  SDquerychunks() then finds the
+     chunks that may hold values in a range, e.g. above a threshold,
+     without reading any, so that only those are read with SDreadchunk().
+
+     Chunks written before the statistics were turned on, and chunks
+     written with SDwritechunkraw(), have no statistics and are taken as
+     holding values of any range.  The statistics cannot be turned off.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+HDFLIBAPI intn SDsetchunkstats(int32 sdsid /* IN: sds access id */);
+
+/******************************************************************************
+NAME
+     SDgetchunkstats -- get the statistics of a chunk
+
+DESCRIPTION
+     Returns the least and greatest value of the chunk of a chunked SDS
+     at 'origin' in 'min' and 'max', as stored, i.e. not calibrated, and
+     their number in 'count'.  'count' is 0 for a chunk of only fill
+     values and -1 when the statistics of the chunk are not known, see
+     SDsetchunkstats(); 'min' and 'max' are not set then.
+
+RETURNS
+     SUCCEED/FAIL, also FAIL when the SDS keeps no statistics
+******************************************************************************/
+HDFLIBAPI intn SDgetchunkstats(int32    sdsid,  /* IN: sds access id */
+                               int32   *origin, /* IN: origin of the chunk */
+                               float64 *min,    /* OUT: least value */
+                               float64 *max,    /* OUT: greatest value */
+                               int32   *count /* OUT: number of values, -1 if not known */);
+
+/******************************************************************************
+NAME
+     SDquerychunks -- find the chunks that may hold values in a range
+
+DESCRIPTION
+     Finds the chunks of a chunked SDS that may hold values, other than
+     the fill value, between 'lo' and 'hi' included, from the statistics
+     kept with SDsetchunkstats().  The origins of the first 'maxchunks'
+     of them, with the last dimension changing fastest, are returned in
+     'origins', rank values each.  No chunk is read, and chunks that
+     were never written are not found.  A first call with 'maxchunks' 0
+     gets the number of chunks found.
+
+RETURNS
+     Returns the number of chunks found if successful and FAIL otherwise,
+     also when the SDS keeps no statistics
+******************************************************************************/
+HDFLIBAPI int32 SDquerychunks(int32   sdsid,     /* IN: sds access id */
+                              float64 lo,        /* IN: least value looked for */
+                              float64 hi,        /* IN: greatest value looked for */
+                              int32   maxchunks, /* IN: number of origins 'origins' has room for */
+                              int32  *origins /* OUT: origins of the chunks found */);
+
+/******************************************************************************
+NAME
+     SDsetchunkchecksums -- keep checksums of the chunks of an SDS
+
+DESCRIPTION
+     From now on, each chunk of a chunked SDS that is written gets two
+     CRC-32C checksums, of its data decoded, in the number type of the
+     file, and of its data as stored in the file, i.e. compressed if the
+     SDS is.  They are stored with the
+     chunk table and kept up to date whenever the SDS is written, also
+     after the file is closed and opened again.  With SDgetchunkchecksum()
+     chunks can then be verified, or compared between SDSs and files,
+     without being decoded.
+
+     The checksums are CRC-32C (Castagnoli), as iSCSI and ext4 use,
+     computed with the CRC instructions of the processor when it has
+     them.  Chunks written before the checksums were turned on have
+     none, and chunks written with SDwritechunkraw() to a compressed SDS
+     only the one of the stored data.  The checksums cannot be turned
+     off.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+HDFLIBAPI intn SDsetchunkchecksums(int32 sdsid /* IN: sds access id */);
+
+/******************************************************************************
+NAME
+     SDgetchunkchecksum -- get the checksums of a chunk
+
+DESCRIPTION
+     Returns the CRC-32C of the data of the chunk of a chunked SDS at
+     'origin' decoded in 'raw_crc' and as stored in the file, e.g. as
+     SDreadchunkraw() reads it, in 'stored_crc', see
+     SDsetchunkchecksums().  Only the checksums known are set.
+
+RETURNS
+     HDF_CHKSUM_RAW and HDF_CHKSUM_STORED or'ed for the checksums known,
+     0 for none, e.g. for a chunk never written, or FAIL, also when the
+     SDS keeps no checksums
+******************************************************************************/
+HDFLIBAPI intn SDgetchunkchecksum(int32   sdsid,   /* IN: sds access id */
+                                  int32  *origin,  /* IN: origin of the chunk */
+                                  uint32 *raw_crc, /* OUT: CRC-32C of the decoded data */
+                                  uint32 *stored_crc /* OUT: CRC-32C of the data as stored */);
+
+/******************************************************************************
+NAME
+     SDgetchunkptr -- get a pointer to a chunk held in the chunk cache
+
+DESCRIPTION
+     Reads the chunk of a chunked SDS specified by chunk 'origin', like
+     SDreadchunk() does, and returns a pointer to the whole decoded chunk
+     in '*datap' instead of copying it.  The chunk lengths are returned in
+     'chunk_lengths', if it is not NULL; chunks at the end of a dimension
+     are whole too, filled past the end of the data.
+
+     The chunk stays pinned in the chunk cache, and the pointer valid,
+     until it is given back with SDreleasechunk() or the SDS is closed
+     with SDendaccess(); the cache grows past its size while more chunks
+     are held than it has room for.  The data must not be written to.
+     When the number type of the SDS is not the native one of the
+     platform, the chunk is converted to a buffer of its own, which
+     SDreleasechunk() frees, and the copy is not saved.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+HDFLIBAPI intn SDgetchunkptr(int32        sdsid,  /* IN: sds access id */
+                             int32       *origin, /* IN: origin of chunk to get */
+                             const void **datap,  /* OUT: the chunk */
+                             int32       *chunk_lengths /* OUT: lengths of the chunk */);
+
+/******************************************************************************
+NAME
+     SDreleasechunk -- give back a chunk gotten with SDgetchunkptr()
+
+DESCRIPTION
+     Each chunk gotten with SDgetchunkptr() is given back once, after
+     which its pointer must not be used anymore.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+HDFLIBAPI intn SDreleasechunk(int32       sdsid, /* IN: sds access id */
+                              const void *datap /* IN: the chunk */);
+
+/******************************************************************************
+NAME
+     SDchunkiter -- visit the chunks written in storage order
+
+DESCRIPTION
+     Returns in 'origin' the origin of the next chunk of a chunked SDS
+     that was written, in the order the chunks are stored in the file, so
+     that getting them one after the other with SDgetchunkptr() or
+     SDreadchunk() reads the file forward.  '*cursor' is set to 0 to
+     start, which takes the chunks written until then, and each call
+     advances it.  Chunks never written are not visited.
+
+RETURNS
+     1 if a chunk was returned, 0 when all chunks were visited and FAIL
+     on error
+******************************************************************************/
+HDFLIBAPI intn SDchunkiter(int32  sdsid,  /* IN: sds access id */
+                           int32 *cursor, /* IN/OUT: position of the visit, 0 to start */
+                           int32 *origin /* OUT: origin of the next chunk */);
+
+/******************************************************************************
+NAME
+     SDsetchunkcachebudget -- byte budget of the shared chunk cache pool
+
+DESCRIPTION
+     Sets the number of bytes that the chunk caches of all datasets that
+     joined the shared pool, by passing HDF_CACHE_SHARED to
+     SDsetchunkcache() or GRsetchunkcache(), may hold together, across
+     all open files.  The default is 64 MB.
+
+RETURNS
+     Returns the previous budget if successful and FAIL otherwise
+******************************************************************************/
+HDFLIBAPI int32 SDsetchunkcachebudget(int32 nbytes /* IN: bytes shared by the pooled caches */);
+
+/******************************************************************************
+NAME
+     SDsetchunkdiskcache -- keep the compressed chunks of remote files on local disk
+
+DESCRIPTION
+     Sets the directory of the local chunk cache, which keeps the compressed
+     chunks read from files opened read-only through a remote driver, so
+     the next reads of these chunks come from local disk.  The cache holds
+     at most 'max_kbytes' KB, evicting the least recently used chunks past
+     that.  A NULL directory turns the cache off.
+
+RETURNS
+     SUCCEED if successful and FAIL otherwise
+******************************************************************************/
+HDFLIBAPI intn SDsetchunkdiskcache(const char *dir, /* IN: directory of the cache, NULL for none */
+                                   int32 max_kbytes /* IN: KB the cache may hold */);
+
+/******************************************************************************
+NAME
+     SDsetbufferlimit -- largest conversion buffer kept between calls
+
+DESCRIPTION
+     SDreaddata() and SDwritedata() convert data that is not in the
+     machine's number format through a buffer of the calling thread,
+     which is kept for the next call unless it is larger than 'nbytes'.
+     The default is 1 MB; 0 releases the buffers after every call.
+
+RETURNS
+     Returns the previous limit if successful and FAIL otherwise
+******************************************************************************/
+HDFLIBAPI int32 SDsetbufferlimit(int32 nbytes /* IN: largest buffer to keep, in bytes */);
+
+/******************************************************************************
+NAME
+     SDfreebuffers -- release the conversion buffers of the calling thread
+
+DESCRIPTION
+     Frees the buffers SDreaddata() and SDwritedata() keep for the calling
+     thread.  They are allocated again when needed.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+HDFLIBAPI intn SDfreebuffers(void);
+
+/******************************************************************************
+NAME
+     SDsetxdrbuffersize -- size of the I/O buffer of a netCDF file
+
+DESCRIPTION
+     Files in the netCDF classic format are read and written through a
+     buffer of 'nbytes' bytes, 1 MB by default.  With CACHE_ALL_FILES as
+     fid the size applies to the netCDF files opened from then on,
+     otherwise the buffer of the open file fid is resized.  netCDF files
+     opened read-only are memory-mapped where possible and have no buffer.
+
+RETURNS
+     Returns the previous size if successful and FAIL otherwise
+******************************************************************************/
+HDFLIBAPI int32 SDsetxdrbuffersize(int32 fid,   /* IN: file ID or CACHE_ALL_FILES */
+                                   int32 nbytes /* IN: buffer size, in bytes */);
+
+/******************************************************************************
+NAME
+     SDreaddata_async -- start reading a slab of a dataset
+     SDwritedata_async -- start writing a slab of a dataset
+
+DESCRIPTION
+     Queue a read or a write of a slab, as SDreaddata() and SDwritedata()
+     do it, for a background I/O thread and return a token for it right
+     away.  The buffer must be left alone until SDwait() has been called
+     for the token.  While requests are outstanding, only these routines,
+     SDtest() and SDwait() may be called; SDendaccess() and SDend() wait
+     for the requests first.
+
+RETURNS
+     The token of the request if successful and FAIL otherwise
+******************************************************************************/
+HDFLIBAPI int32 SDreaddata_async(int32 sdsid, int32 *start, int32 *stride, int32 *edge, void *data);
+
+HDFLIBAPI int32 SDwritedata_async(int32 sdsid, int32 *start, int32 *stride, int32 *edge, void *data);
+
+/******************************************************************************
+NAME
+     SDtest -- tell whether an asynchronous request has completed
+
+DESCRIPTION
+     Sets 'done' to TRUE once the request has completed, without waiting.
+
+RETURNS
+     SUCCEED, or FAIL if 'request' is not an outstanding request
+******************************************************************************/
+HDFLIBAPI intn SDtest(int32 request, /* IN: token of the request */
+                      intn *done /* OUT: whether the request has completed */);
+
+/******************************************************************************
+NAME
+     SDwait -- wait for an asynchronous request and get its result
+
+DESCRIPTION
+     Waits until the request has completed and releases its token.
+
+RETURNS
+     What SDreaddata() or SDwritedata() returned for the request, or FAIL
+     if 'request' is not an outstanding request
+******************************************************************************/
+HDFLIBAPI intn SDwait(int32 request /* IN: token of the request */);
+
+/******************************************************************************
+NAME
+     SDreaddata_multi -- read hyperslabs of several datasets
+
+DESCRIPTION
+     Reads the slab starts[i], strides[i], edges[i] of dataset sdsids[i]
+     into bufs[i] for each of the 'nsds' datasets, as SDreaddata() would.
+     'strides' or any of its entries may be NULL.  Everything is checked
+     before the first read, then the datasets are read file by file in
+     the order their data is stored, instead of the order given.  The
+     chunks of each dataset are decoded on the threads set with
+     SDsetchunkthreads().
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+HDFLIBAPI intn SDreaddata_multi(intn nsds, int32 sdsids[], int32 *starts[], int32 *strides[], int32 *edges[],
+                                void *bufs[]);
+
+/******************************************************************************
+NAME
+     SDreaddata_files -- read a slab of a dataset spanning several files
+
+DESCRIPTION
+     Reads a slab of the virtual dataset made of the dataset 'sdsname' of
+     each of the files 'paths', stacked along a new first dimension, the
+     index of the file.  'start', 'stride' and 'edge' have one entry more
+     than the rank of the datasets, for the files first; 'stride' may be
+     NULL.  Only the files and the parts of their datasets in the slab
+     are read, the chunks on up to 'nthreads' threads, see
+     SDsetchunkthreads().  The datasets must have the same rank and
+     number type.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+HDFLIBAPI intn SDreaddata_files(intn nfiles, const char *paths[], const char *sdsname, int32 *start,
+                                int32 *stride, int32 *edge, intn nthreads, void *data);
+
+/******************************************************************************
+NAME
+     SDreaddata_calibrated -- read a slab of a dataset as calibrated values
+
+DESCRIPTION
+     Reads a slab as SDreaddata() does and returns cal * (x - ioff), the
+     calibration set with SDsetcal(), as DFNT_FLOAT32 or DFNT_FLOAT64
+     values per 'out_nt'.  Fill values of the dataset are returned as
+     'fillout', e.g. NaN.  The calibration is applied in 'data' as the
+     values are converted, without another buffer; 'data' must hold the
+     values read in the number type 'out_nt'.  A dataset without
+     calibration is read with cal 1 and ioff 0.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+HDFLIBAPI intn SDreaddata_calibrated(int32 sdsid, int32 *start, int32 *stride, int32 *edge, int32 out_nt,
+                                     float64 fillout, void *data);
+
+/******************************************************************************
+NAME
+     SDsetsievebuf -- set the size of the sieve buffer of an SDS
+
+DESCRIPTION
+     A read of fewer than 'nbytes' bytes from a contiguous SDS brings
+     'nbytes' bytes of its data, from the first byte wanted on, into a
+     buffer kept with the dataset.  Later small reads within those bytes
+     are served from memory instead of the file.  Writes to the SDS empty
+     the buffer.  0 turns the buffer off, which is the default.  Chunked,
+     compressed and other special SDSs are not affected.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+HDFLIBAPI intn SDsetsievebuf(int32 sdsid, /* IN: sds access id */
+                             int32 nbytes /* IN: size of the buffer in bytes, 0 for none */);
+
+/******************************************************************************
+NAME
+     SDprefetch -- announce a read of a slab of an SDS
+
+DESCRIPTION
+     Tells the system that the data of the slab given by 'start' and
+     'edges' will be read soon.  The file blocks holding it, or the
+     chunks it touches for a chunked SDS, are read from disk in the
+     background, with posix_fadvise() where it is available, while the
+     application goes on.  The SDreaddata() of the slab later finds them
+     in memory.  Nothing is decoded ahead; SDreaddata_async() reads and
+     decodes a slab in the background.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+HDFLIBAPI intn SDprefetch(int32  sdsid, /* IN: sds access id */
+                          int32 *start, /* IN: coords of starting point */
+                          int32 *edges /* IN: number of values along each dimension */);
+
+/******************************************************************************
+NAME
+     SDappend -- append records to a dataset with an unlimited dimension
+
+DESCRIPTION
+     Adds 'nrecords' records after the last record of the dataset, as
+     SDwritedata() with start[0] at the number of records would.  The
+     records are copied into a buffer kept with the dataset and written
+     out together when the buffer is full, so that many small appends
+     cost one write and one update of the number of records.  The
+     buffer starts at the block size set with SDsetblocksize(), or at
+     64 KB, and grows to 1 MB while records keep coming.  A dataset
+     without data yet is stored in linked blocks the size of the buffer,
+     unless SDsetblocksize() was called.
+
+     The buffered records are written when the dataset is read or
+     written, by SDgetinfo() and SDgetdatasize(), and by SDendaccess()
+     and SDend().  Errors writing them are reported by these calls.  Only
+     HDF files opened for writing are supported.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+HDFLIBAPI intn SDappend(int32       sdsid,    /* IN: sds access id */
+                        int32       nrecords, /* IN: number of records to append */
+                        const void *data /* IN: the records */);
+
 #ifdef __cplusplus
 }
 #endif
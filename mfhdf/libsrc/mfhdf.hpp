@@ -0,0 +1,775 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*
+ * mfhdf.hpp -- a header-only C++17 layer over the SD, V and GR interfaces
+ *
+ * Every ID is held by a move-only handle that ends its access when it goes
+ * out of scope: hdf4::sd_file and hdf4::dataset for the SD interface,
+ * hdf4::hdf_file, hdf4::vdata, hdf4::gr_interface and hdf4::gr_image for
+ * the others.  A handle must not outlive the handle it was gotten from,
+ * as with the IDs of the C interfaces.  Failures throw hdf4::error.
+ *
+ * Reads and writes take any contiguous container of the element type
+ * (std::vector, std::array, std::span, ...) or a pointer and a count, and
+ * the element type must be the native type of the number type stored:
+ * the library converts from the file format only, never between number
+ * types, so a mismatch is refused instead of giving garbage.  Chunks are
+ * reached without a copy with dataset::chunk(), which pins a chunk in the
+ * chunk cache for as long as the view lives, and dataset::chunks(), which
+ * visits the written chunks in storage order.
+ *
+ * Nothing here is thread-safe beyond the library itself.
+ */
+
+#ifndef H4_MFHDF_HPP
+#define H4_MFHDF_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __cplusplus >= 202302L && __has_include(<mdspan>)
+#include <mdspan>
+#endif
+
+#include "mfhdf.h"
+
+namespace hdf4 {
+
+/* An error of the library, with the innermost error code of its stack */
+class error : public std::runtime_error {
+public:
+    error(const char *where, hdf_err_code_t code)
+        : std::runtime_error(std::string(where) + ": " + HEstring(code)), code_(code)
+    {
+    }
+
+    hdf_err_code_t code() const noexcept { return code_; }
+
+private:
+    hdf_err_code_t code_;
+};
+
+/* The HDF number type of the native values of type T, for the types that have one */
+template <typename T> struct number_type;
+template <> struct number_type<char> : std::integral_constant<int32, DFNT_CHAR8> {};
+template <> struct number_type<std::int8_t> : std::integral_constant<int32, DFNT_INT8> {};
+template <> struct number_type<std::uint8_t> : std::integral_constant<int32, DFNT_UINT8> {};
+template <> struct number_type<std::int16_t> : std::integral_constant<int32, DFNT_INT16> {};
+template <> struct number_type<std::uint16_t> : std::integral_constant<int32, DFNT_UINT16> {};
+template <> struct number_type<std::int32_t> : std::integral_constant<int32, DFNT_INT32> {};
+template <> struct number_type<std::uint32_t> : std::integral_constant<int32, DFNT_UINT32> {};
+template <> struct number_type<float> : std::integral_constant<int32, DFNT_FLOAT32> {};
+template <> struct number_type<double> : std::integral_constant<int32, DFNT_FLOAT64> {};
+
+template <typename T> inline constexpr int32 number_type_v = number_type<std::remove_cv_t<T>>::value;
+
+namespace detail {
+
+inline void
+check(bool ok, const char *where)
+{
+    if (!ok)
+        throw error(where, static_cast<hdf_err_code_t>(HEvalue(1)));
+}
+
+/* Whether values of number type 'nt', as read into memory, are of type T */
+template <typename T>
+inline bool
+holds(int32 nt) noexcept
+{
+    int32 base = nt & DFNT_MASK;
+
+    if (std::is_same_v<std::remove_cv_t<T>, std::uint8_t> && base == DFNT_UCHAR8)
+        return true;
+    return base == number_type_v<T>;
+}
+
+template <typename T>
+inline void
+check_type(int32 nt, const char *where)
+{
+    if (!holds<T>(nt))
+        throw std::invalid_argument(std::string(where) + ": element type does not match the number type");
+}
+
+inline std::size_t
+product(const int32 *lengths, std::size_t n)
+{
+    std::size_t size = 1;
+
+    for (std::size_t i = 0; i < n; i++)
+        size *= static_cast<std::size_t>(lengths[i]);
+    return size;
+}
+
+/* The access routines the handles end with, which may not be called more than once */
+inline intn
+end_hdf_file(int32 id)
+{
+    intn ret = Vend(id);
+
+    return (Hclose(id) == FAIL) ? FAIL : ret;
+}
+
+inline intn
+end_vdata(int32 id)
+{
+    return (VSdetach(id) == FAIL) ? FAIL : SUCCEED;
+}
+
+} /* namespace detail */
+
+/* A move-only ID, given back with End when the handle goes away */
+template <intn (*End)(int32)> class handle {
+public:
+    handle() noexcept = default;
+    explicit handle(int32 id) noexcept : id_(id) {}
+    handle(handle &&other) noexcept : id_(std::exchange(other.id_, FAIL)) {}
+    handle(const handle &)            = delete;
+    handle &operator=(const handle &) = delete;
+    ~handle() { reset(); }
+
+    handle &
+    operator=(handle &&other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            id_ = std::exchange(other.id_, FAIL);
+        }
+        return *this;
+    }
+
+    int32 id() const noexcept { return id_; }
+    explicit operator bool() const noexcept { return id_ != FAIL; }
+
+    /* End the access now, reporting a failure */
+    void
+    close()
+    {
+        if (id_ != FAIL)
+            detail::check(End(std::exchange(id_, FAIL)) != FAIL, "close");
+    }
+
+    /* End the access now, ignoring a failure, as the destructor does */
+    void
+    reset() noexcept
+    {
+        if (id_ != FAIL)
+            (void)End(std::exchange(id_, FAIL));
+    }
+
+private:
+    int32 id_ = FAIL;
+};
+
+/* A hyperslab: a start, a count and optionally a stride per dimension */
+struct slab {
+    std::vector<int32> start;
+    std::vector<int32> count;
+    std::vector<int32> stride; /* empty for contiguous */
+
+    std::size_t size() const noexcept { return detail::product(count.data(), count.size()); }
+};
+
+/*
+ * A chunk held in the chunk cache, read without a copy: the chunk stays
+ * pinned, and its values valid, until the view goes away.  The values
+ * are those of the whole chunk, its edges included, see SDgetchunkptr().
+ */
+template <typename T> class chunk_view {
+public:
+    chunk_view() noexcept = default;
+
+    chunk_view(int32 sdsid, std::vector<int32> origin, std::size_t rank)
+        : sdsid_(sdsid), origin_(std::move(origin)), lengths_(rank)
+    {
+        const void *datap = nullptr;
+
+        detail::check(SDgetchunkptr(sdsid_, origin_.data(), &datap, lengths_.data()) != FAIL,
+                      "SDgetchunkptr");
+        data_ = static_cast<const T *>(datap);
+    }
+
+    chunk_view(chunk_view &&other) noexcept { *this = std::move(other); }
+    chunk_view(const chunk_view &)            = delete;
+    chunk_view &operator=(const chunk_view &) = delete;
+    ~chunk_view() { release(); }
+
+    chunk_view &
+    operator=(chunk_view &&other) noexcept
+    {
+        if (this != &other) {
+            release();
+            sdsid_   = other.sdsid_;
+            origin_  = std::move(other.origin_);
+            lengths_ = std::move(other.lengths_);
+            data_    = std::exchange(other.data_, nullptr);
+        }
+        return *this;
+    }
+
+    const T *data() const noexcept { return data_; }
+    std::size_t
+    size() const noexcept
+    {
+        return data_ ? detail::product(lengths_.data(), lengths_.size()) : 0;
+    }
+    const T *begin() const noexcept { return data_; }
+    const T *end() const noexcept { return data_ + size(); }
+    const T &operator[](std::size_t i) const noexcept { return data_[i]; }
+
+    /* The origin of the chunk, in chunks, and its lengths, in values */
+    const std::vector<int32> &origin() const noexcept { return origin_; }
+    const std::vector<int32> &lengths() const noexcept { return lengths_; }
+
+    /* Give the chunk back now */
+    void
+    release() noexcept
+    {
+        if (data_ != nullptr)
+            (void)SDreleasechunk(sdsid_, std::exchange(data_, nullptr));
+    }
+
+private:
+    int32              sdsid_ = FAIL;
+    std::vector<int32> origin_;
+    std::vector<int32> lengths_;
+    const T           *data_ = nullptr;
+};
+
+/*
+ * The chunks written of a dataset, in the order they are stored, see
+ * SDchunkiter(); the chunk an iterator is on stays pinned until it moves.
+ * The iterators hold their chunk, so they can be moved but not copied.
+ */
+template <typename T> class chunk_range {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = chunk_view<T>;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const chunk_view<T> *;
+        using reference         = const chunk_view<T> &;
+
+        iterator() noexcept = default;
+        iterator(int32 sdsid, std::size_t rank) : sdsid_(sdsid), rank_(rank), done_(false) { advance(); }
+
+        reference operator*() const noexcept { return view_; }
+        pointer operator->() const noexcept { return &view_; }
+
+        iterator &
+        operator++()
+        {
+            advance();
+            return *this;
+        }
+
+        /* Iterators are equal when both are at the end */
+        bool operator==(const iterator &other) const noexcept { return done_ == other.done_; }
+        bool operator!=(const iterator &other) const noexcept { return !(*this == other); }
+
+    private:
+        void
+        advance()
+        {
+            std::vector<int32> origin(rank_);
+            intn               more;
+
+            view_.release();
+            more = SDchunkiter(sdsid_, &cursor_, origin.data());
+            detail::check(more != FAIL, "SDchunkiter");
+            if (more == 0)
+                done_ = true;
+            else
+                view_ = chunk_view<T>(sdsid_, std::move(origin), rank_);
+        }
+
+        int32         sdsid_  = FAIL;
+        std::size_t   rank_   = 0;
+        int32         cursor_ = 0;
+        bool          done_   = true;
+        chunk_view<T> view_;
+    };
+
+    chunk_range(int32 sdsid, std::size_t rank) noexcept : sdsid_(sdsid), rank_(rank) {}
+
+    iterator begin() const { return iterator(sdsid_, rank_); }
+    iterator end() const noexcept { return iterator(); }
+
+private:
+    int32       sdsid_;
+    std::size_t rank_;
+};
+
+/* A dataset of an SD file, from sd_file::select() or sd_file::create() */
+class dataset {
+public:
+    struct info_t {
+        std::string        name;
+        std::vector<int32> dims;
+        int32              nt;
+        int32              nattrs;
+    };
+
+    dataset() noexcept = default;
+    explicit dataset(int32 sdsid) noexcept : id_(sdsid) {}
+
+    int32 id() const noexcept { return id_.id(); }
+    void close() { id_.close(); }
+
+    info_t
+    info() const
+    {
+        char   name[H4_MAX_NC_NAME + 1] = "";
+        int32  dims[H4_MAX_VAR_DIMS];
+        int32  rank;
+        info_t info;
+
+        detail::check(SDgetinfo(id(), name, &rank, dims, &info.nt, &info.nattrs) != FAIL, "SDgetinfo");
+        info.name = name;
+        info.dims.assign(dims, dims + rank);
+        return info;
+    }
+
+    /* Read a hyperslab into 'n' values at 'data' */
+    template <typename T>
+    void
+    read(const slab &s, T *data, std::size_t n) const
+    {
+        static_assert(!std::is_const_v<T>, "cannot read into const values");
+        check_slab<T>(s, n, "SDreaddata");
+        detail::check(SDreaddata(id(), const_cast<int32 *>(s.start.data()), stride(s),
+                                 const_cast<int32 *>(s.count.data()), data) != FAIL,
+                      "SDreaddata");
+    }
+
+    /* Read a hyperslab into a contiguous container, e.g. a std::span */
+    template <typename C>
+    void
+    read(const slab &s, C &&values) const
+    {
+        read(s, std::data(values), std::size(values));
+    }
+
+    /* Read a hyperslab into a new vector */
+    template <typename T>
+    std::vector<T>
+    read(const slab &s) const
+    {
+        std::vector<T> values(s.size());
+
+        read(s, values.data(), values.size());
+        return values;
+    }
+
+    /* Read the whole dataset into a new vector */
+    template <typename T>
+    std::vector<T>
+    read() const
+    {
+        info_t info = this->info();
+
+        return read<T>(slab{std::vector<int32>(info.dims.size(), 0), info.dims, {}});
+    }
+
+#if defined(__cpp_lib_mdspan)
+    /* Read a hyperslab whose counts are the extents of a row-major mdspan */
+    template <typename T, typename Extents>
+    void
+    read(const std::vector<int32> &start, std::mdspan<T, Extents, std::layout_right> values) const
+    {
+        std::vector<int32> count(Extents::rank());
+
+        for (std::size_t i = 0; i < count.size(); i++)
+            count[i] = static_cast<int32>(values.extent(i));
+        read(slab{start, count, {}}, values.data_handle(), values.size());
+    }
+#endif
+
+    /* Write 'n' values at 'data' to a hyperslab */
+    template <typename T>
+    void
+    write(const slab &s, const T *data, std::size_t n)
+    {
+        check_slab<T>(s, n, "SDwritedata");
+        detail::check(SDwritedata(id(), const_cast<int32 *>(s.start.data()), stride(s),
+                                  const_cast<int32 *>(s.count.data()), const_cast<T *>(data)) != FAIL,
+                      "SDwritedata");
+    }
+
+    /* Write a contiguous container to a hyperslab */
+    template <typename C>
+    void
+    write(const slab &s, const C &values)
+    {
+        write(s, std::data(values), std::size(values));
+    }
+
+    /* The chunk at chunk 'origin', pinned in the chunk cache, see chunk_view */
+    template <typename T>
+    chunk_view<T>
+    chunk(std::vector<int32> origin) const
+    {
+        info_t info = this->info();
+
+        detail::check_type<T>(info.nt, "SDgetchunkptr");
+        if (origin.size() != info.dims.size())
+            throw std::invalid_argument("SDgetchunkptr: origin is not of the rank of the dataset");
+        return chunk_view<T>(id(), std::move(origin), info.dims.size());
+    }
+
+    /* The chunks written, in storage order, see chunk_range */
+    template <typename T>
+    chunk_range<T>
+    chunks() const
+    {
+        info_t info = this->info();
+
+        detail::check_type<T>(info.nt, "SDchunkiter");
+        return chunk_range<T>(id(), info.dims.size());
+    }
+
+private:
+    template <typename T>
+    void
+    check_slab(const slab &s, std::size_t n, const char *where) const
+    {
+        info_t info = this->info();
+
+        detail::check_type<T>(info.nt, where);
+        if (s.start.size() != info.dims.size() || s.count.size() != info.dims.size() ||
+            (!s.stride.empty() && s.stride.size() != info.dims.size()))
+            throw std::invalid_argument(std::string(where) + ": slab is not of the rank of the dataset");
+        if (n < s.size())
+            throw std::invalid_argument(std::string(where) + ": fewer values than the slab holds");
+    }
+
+    static int32 *
+    stride(const slab &s) noexcept
+    {
+        return s.stride.empty() ? nullptr : const_cast<int32 *>(s.stride.data());
+    }
+
+    handle<SDendaccess> id_;
+};
+
+/* A file opened with the SD interface */
+class sd_file {
+public:
+    sd_file() noexcept = default;
+
+    static sd_file
+    open(const std::string &path, int32 mode = DFACC_READ)
+    {
+        int32 fid = SDstart(path.c_str(), mode);
+
+        detail::check(fid != FAIL, "SDstart");
+        return sd_file(fid);
+    }
+
+    int32 id() const noexcept { return id_.id(); }
+    void close() { id_.close(); }
+
+    /* The number of datasets and of file attributes */
+    std::pair<int32, int32>
+    info() const
+    {
+        int32 ndatasets, nattrs;
+
+        detail::check(SDfileinfo(id(), &ndatasets, &nattrs) != FAIL, "SDfileinfo");
+        return {ndatasets, nattrs};
+    }
+
+    dataset
+    select(int32 index) const
+    {
+        int32 sdsid = SDselect(id(), index);
+
+        detail::check(sdsid != FAIL, "SDselect");
+        return dataset(sdsid);
+    }
+
+    dataset
+    select(const std::string &name) const
+    {
+        int32 index = SDnametoindex(id(), name.c_str());
+
+        detail::check(index != FAIL, "SDnametoindex");
+        return select(index);
+    }
+
+    dataset
+    create(const std::string &name, int32 nt, const std::vector<int32> &dims)
+    {
+        int32 rank  = static_cast<int32>(dims.size());
+        int32 sdsid = SDcreate(id(), name.c_str(), nt, rank, const_cast<int32 *>(dims.data()));
+
+        detail::check(sdsid != FAIL, "SDcreate");
+        return dataset(sdsid);
+    }
+
+    /* Create a dataset of the number type of T */
+    template <typename T>
+    dataset
+    create(const std::string &name, const std::vector<int32> &dims)
+    {
+        return create(name, number_type_v<T>, dims);
+    }
+
+private:
+    explicit sd_file(int32 fid) noexcept : id_(fid) {}
+
+    handle<SDend> id_;
+};
+
+/* A vdata, from hdf_file::attach_vdata() */
+class vdata {
+public:
+    vdata() noexcept = default;
+    explicit vdata(int32 vsid) noexcept : id_(vsid) {}
+
+    int32 id() const noexcept { return id_.id(); }
+    void close() { id_.close(); }
+
+    /* The number of records */
+    int32
+    size() const
+    {
+        int32 nrecs = VSelts(id());
+
+        detail::check(nrecs != FAIL, "VSelts");
+        return nrecs;
+    }
+
+    /*
+     * Read 'nrecs' records from record 'start' of field 'field' straight
+     * into 'n' values at 'data', see VSreadcolumns(); a field of order k
+     * takes k values per record.  Returns the number of records read.
+     */
+    template <typename T>
+    int32
+    read_field(const std::string &field, int32 start, int32 nrecs, T *data, std::size_t n)
+    {
+        int32  idx, order;
+        uint8 *bufs[1] = {reinterpret_cast<uint8 *>(data)};
+        int32  nread;
+
+        static_assert(!std::is_const_v<T>, "cannot read into const values");
+        detail::check(VSsetfields(id(), field.c_str()) != FAIL, "VSsetfields");
+        detail::check(VSfindex(id(), field.c_str(), &idx) != FAIL, "VSfindex");
+        detail::check_type<T>(VFfieldtype(id(), idx), "VSreadcolumns");
+        detail::check((order = VFfieldorder(id(), idx)) != FAIL, "VFfieldorder");
+        if (nrecs < 0 || n < static_cast<std::size_t>(nrecs) * static_cast<std::size_t>(order))
+            throw std::invalid_argument("VSreadcolumns: fewer values than the records hold");
+        detail::check(VSseek(id(), start) != FAIL, "VSseek");
+        detail::check((nread = VSreadcolumns(id(), bufs, nrecs)) != FAIL, "VSreadcolumns");
+        return nread;
+    }
+
+    /* Read a range of records of a field into a new vector */
+    template <typename T>
+    std::vector<T>
+    read_field(const std::string &field, int32 start, int32 nrecs)
+    {
+        int32          idx, order, nread;
+        std::vector<T> values;
+
+        detail::check(VSfindex(id(), field.c_str(), &idx) != FAIL, "VSfindex");
+        detail::check((order = VFfieldorder(id(), idx)) != FAIL, "VFfieldorder");
+        values.resize(static_cast<std::size_t>(nrecs > 0 ? nrecs : 0) * static_cast<std::size_t>(order));
+        nread = read_field(field, start, nrecs, values.data(), values.size());
+        values.resize(static_cast<std::size_t>(nread) * static_cast<std::size_t>(order));
+        return values;
+    }
+
+    /* Read all the records of a field into a new vector */
+    template <typename T>
+    std::vector<T>
+    read_field(const std::string &field)
+    {
+        return read_field<T>(field, 0, size());
+    }
+
+private:
+    handle<detail::end_vdata> id_;
+};
+
+/* A raster image of the GR interface, from gr_interface::select() */
+class gr_image {
+public:
+    struct info_t {
+        std::string name;
+        int32       ncomp;
+        int32       nt;
+        int32       interlace;
+        int32       dims[2];
+        int32       nattrs;
+    };
+
+    gr_image() noexcept = default;
+    explicit gr_image(int32 riid) noexcept : id_(riid) {}
+
+    int32 id() const noexcept { return id_.id(); }
+    void close() { id_.close(); }
+
+    info_t
+    info() const
+    {
+        char   name[H4_MAX_GR_NAME + 1] = "";
+        info_t info;
+        intn   status;
+
+        status = GRgetiminfo(id(), name, &info.ncomp, &info.nt, &info.interlace, info.dims, &info.nattrs);
+        detail::check(status != FAIL, "GRgetiminfo");
+        info.name = name;
+        return info;
+    }
+
+    /* Read 'count' pixels from 'start', all their components, into 'n' values at 'data' */
+    template <typename T>
+    void
+    read(const int32 (&start)[2], const int32 (&count)[2], T *data, std::size_t n) const
+    {
+        info_t info = this->info();
+        intn   status;
+
+        static_assert(!std::is_const_v<T>, "cannot read into const values");
+        detail::check_type<T>(info.nt, "GRreadimage");
+        if (n < detail::product(count, 2) * static_cast<std::size_t>(info.ncomp))
+            throw std::invalid_argument("GRreadimage: fewer values than the pixels hold");
+        status = GRreadimage(id(), const_cast<int32 *>(start), nullptr, const_cast<int32 *>(count), data);
+        detail::check(status != FAIL, "GRreadimage");
+    }
+
+    /* Read pixels into a contiguous container */
+    template <typename C>
+    void
+    read(const int32 (&start)[2], const int32 (&count)[2], C &&values) const
+    {
+        read(start, count, std::data(values), std::size(values));
+    }
+
+    /* Read the whole image into a new vector */
+    template <typename T>
+    std::vector<T>
+    read() const
+    {
+        info_t         info     = this->info();
+        int32          start[2] = {0, 0};
+        std::vector<T> values(detail::product(info.dims, 2) * static_cast<std::size_t>(info.ncomp));
+
+        read(start, info.dims, values.data(), values.size());
+        return values;
+    }
+
+private:
+    handle<GRendaccess> id_;
+};
+
+/* The GR interface of a file, from hdf_file::gr() */
+class gr_interface {
+public:
+    gr_interface() noexcept = default;
+    explicit gr_interface(int32 grid) noexcept : id_(grid) {}
+
+    int32 id() const noexcept { return id_.id(); }
+    void close() { id_.close(); }
+
+    gr_image
+    select(int32 index) const
+    {
+        int32 riid = GRselect(id(), index);
+
+        detail::check(riid != FAIL, "GRselect");
+        return gr_image(riid);
+    }
+
+    gr_image
+    select(const std::string &name) const
+    {
+        int32 index = GRnametoindex(id(), name.c_str());
+
+        detail::check(index != FAIL, "GRnametoindex");
+        return select(index);
+    }
+
+private:
+    handle<GRend> id_;
+};
+
+/* A file opened with Hopen(), with the V interface started, for vdatas and GR images */
+class hdf_file {
+public:
+    hdf_file() noexcept = default;
+
+    static hdf_file
+    open(const std::string &path, intn mode = DFACC_READ)
+    {
+        int32 fid = Hopen(path.c_str(), mode, 0);
+
+        detail::check(fid != FAIL, "Hopen");
+        if (Vstart(fid) == FAIL) {
+            (void)Hclose(fid);
+            detail::check(false, "Vstart");
+        }
+        return hdf_file(fid);
+    }
+
+    int32 id() const noexcept { return id_.id(); }
+    void close() { id_.close(); }
+
+    /* Attach to the vdata of reference number 'ref' with access "r" or "w" */
+    vdata
+    attach_vdata(int32 ref, const char *access = "r") const
+    {
+        int32 vsid = VSattach(id(), ref, access);
+
+        detail::check(vsid != FAIL, "VSattach");
+        return vdata(vsid);
+    }
+
+    /* Attach to the vdata named 'name' */
+    vdata
+    attach_vdata(const std::string &name, const char *access = "r") const
+    {
+        int32 ref = VSfind(id(), name.c_str());
+
+        detail::check(ref != 0, "VSfind");
+        return attach_vdata(ref, access);
+    }
+
+    gr_interface
+    gr() const
+    {
+        int32 grid = GRstart(id());
+
+        detail::check(grid != FAIL, "GRstart");
+        return gr_interface(grid);
+    }
+
+private:
+    explicit hdf_file(int32 fid) noexcept : id_(fid) {}
+
+    handle<detail::end_hdf_file> id_;
+};
+
+} /* namespace hdf4 */
+
+#endif /* H4_MFHDF_HPP */
@@ -49,4 +49,7 @@ intn SDIapfromid(int32 id, NC **handlep, NC_array ***app);
 /* Check permission on the file */
 int SDI_can_clobber(const char *name);
 
+/* Wait for the outstanding asynchronous reads and writes */
+void SDPasync_drain(void);
+
 #endif /* MFH4_MFPRIVATE_H */
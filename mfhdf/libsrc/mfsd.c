@@ -26,6 +26,9 @@ SD interface:
     --- open a file ---
 fid    = SDstart(file name, access);
 
+    --- open several files, their metadata read at once ---
+status = SDstart_many(nfiles, names, access, fids);
+
         --- get number of data sets and number of attributes in the file ---
 status = SDfileinfo(fid, *n_datasets, *n_attrs);
 
@@ -37,6 +40,10 @@ status = SDgetinfo(sdsid, ...);
 
 status = SDreaddata(sdsid, ...);
 
+status = SDreaddata_calibrated(sdsid, ...);
+
+status = SDreaddata_files(nfiles, paths, name, ...);
+
 status = SDgetrange(sdsid, ...);
 
 status = SDend(fid);
@@ -106,6 +113,9 @@ NOTE: This file needs to have the comments cleaned up for most of the
 
 intn SDsetup_szip_parms(int32 id, NC *handle, comp_info *c_info, int32 *cdims);
 
+/* Largest dimension scale, in bytes, that SDgetdimscale() keeps in memory */
+#define SD_SCALE_CACHE_MAX 65536
+
 /* Whether we've installed the library termination function yet for this interface */
 static intn library_terminate = FALSE;
 
@@ -174,6 +184,10 @@ SDIget_var(NC   *handle, /* IN: the handle for this file */
     else
         HGOTO_ERROR(DFE_ARGS, NULL);
 
+    /* bring in the attributes if the file was opened lazily */
+    if (hdf_read_var_attrs(handle, (NC_var *)*ap) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, NULL);
+
     ret_value = ((NC_var *)*ap);
 
 done:
@@ -216,6 +230,77 @@ done:
 } /* SDIget_dim */
 #endif /* MFSD_INTERNAL */
 
+/******************************************************************************
+ NAME
+    SDIopen_chunked -- tell whether a dataset is open as a chunked element
+
+ DESCRIPTION
+    Checks whether the dataset's data already has an access id, from an
+    earlier read or write, and whether it is chunked.  The chunk table of
+    such a dataset is kept in memory by the chunking layer.
+
+ RETURNS
+    TRUE or FALSE
+
+******************************************************************************/
+static intn
+SDIopen_chunked(NC_var *var /* IN: the variable record */)
+{
+    int16 special; /* Special code */
+
+    if (var->aid == 0 || var->aid == FAIL)
+        return FALSE;
+    if (Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special) == FAIL)
+        return FALSE;
+
+    return special == SPECIAL_CHUNKED ? TRUE : FALSE;
+} /* SDIopen_chunked */
+
+/******************************************************************************
+ NAME
+    SDIflush_append -- write out the records buffered by SDappend()
+
+ DESCRIPTION
+    Writes the records held in the append buffer of the dataset after
+    its last record, with a single SDwritedata(), which also brings the
+    number of records of the dataset up to date.  The buffer is emptied
+    first, so the flush done by SDwritedata() itself finds nothing to do.
+
+ RETURNS
+    SUCCEED/FAIL
+
+******************************************************************************/
+static intn
+SDIflush_append(NC_var *var /* IN: the variable record */)
+{
+    int32 start[H4_MAX_VAR_DIMS];
+    int32 edges[H4_MAX_VAR_DIMS];
+    int32       nrecs   = var->app_nrecs;
+    const char *routine = cdf_routine_name; /* SDwritedata() sets it */
+    intn        i;
+    intn        ret_value;
+
+    if (nrecs == 0)
+        return SUCCEED;
+    var->app_nrecs = 0;
+
+    /* data created by the flush is stored in blocks of a full buffer */
+    if (var->data_ref == 0 && var->block_size == -1)
+        var->block_size = (int32)((unsigned long)var->app_max * var->len);
+
+    start[0] = var->numrecs;
+    edges[0] = nrecs;
+    for (i = 1; i < var->assoc->count; i++) {
+        start[i] = 0;
+        edges[i] = (int32)var->shape[i];
+    }
+
+    ret_value        = SDwritedata(var->app_id, start, NULL, edges, var->app_buf);
+    cdf_routine_name = routine;
+
+    return ret_value;
+} /* SDIflush_append */
+
 /******************************************************************************
  NAME
     SDIstart -- initialize the SD interface
@@ -239,6 +324,17 @@ SDIstart(void)
     if (HPregister_term_func(&SDPfreebuf) != 0)
         HGOTO_ERROR(DFE_CANTINIT, FAIL);
 
+    /* Report the metadata of the open files and trim the conversion
+       buffers, see Hget_memory_usage() and Htrim_memory() */
+    if (HPregister_mem_funcs(HDF_MEM_NC, NC_memory_usage, SDPfreebuf) == FAIL)
+        HGOTO_ERROR(DFE_CANTINIT, FAIL);
+
+    /* Free the metadata kept for closed files, see SDsetmetacache() */
+    if (HPregister_term_func(&NC_free_metacache) != 0)
+        HGOTO_ERROR(DFE_CANTINIT, FAIL);
+    if (HPregister_mem_funcs(HDF_MEM_NC, NULL, NC_free_metacache) == FAIL)
+        HGOTO_ERROR(DFE_CANTINIT, FAIL);
+
 done:
     return (ret_value);
 } /* end SDIstart() */
@@ -359,6 +455,56 @@ done:
     return ret_value;
 } /* SDstart */
 
+/******************************************************************************
+ NAME
+    SDstart_many -- open several files
+
+ DESCRIPTION
+    Opens each of the 'nfiles' files 'names' with SDstart() and the access
+    mode 'HDFmode', storing its file ID, or FAIL, in 'sd_ids'.  Files
+    opened for reading or update first have their metadata read ahead
+    all at once, on the threads of the library, see HPprefetch_files():
+    the reads of the DD blocks, vgroups and attributes of the files then
+    overlap instead of adding up, which is what opening many files on
+    slow or remote storage waits for.  The files are then set up one
+    after the other from what was read.
+
+ RETURNS
+    SUCCEED if all the files were opened, FAIL otherwise; the IDs of the
+    files that were opened are still returned and must be closed
+******************************************************************************/
+intn
+SDstart_many(intn        nfiles,  /* IN:  number of files */
+             const char *names[], /* IN:  names of the files */
+             int32       HDFmode, /* IN:  access mode to open them with */
+             int32       sd_ids[] /* OUT: file IDs, FAIL for a file not opened */)
+{
+    intn i;
+    intn nfailed   = 0;
+    intn ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* Validate arguments */
+    if (nfiles < 0 || (nfiles > 0 && (names == NULL || sd_ids == NULL)))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* A failed read ahead only leaves the files to be read as usual */
+    if (!(HDFmode & DFACC_CREATE))
+        HPprefetch_files(nfiles, names);
+
+    for (i = 0; i < nfiles; i++)
+        if ((sd_ids[i] = (names[i] != NULL) ? SDstart(names[i], HDFmode) : FAIL) == FAIL)
+            nfailed++;
+
+    if (nfailed > 0)
+        HGOTO_ERROR(DFE_BADOPEN, FAIL);
+
+done:
+    return ret_value;
+} /* SDstart_many */
+
 /******************************************************************************
  NAME
     SDend -- close a file
@@ -373,9 +519,15 @@ done:
 intn
 SDend(int32 id /* IN: file ID of file to close */)
 {
-    intn cdfid;
-    NC  *handle    = NULL;
-    intn ret_value = SUCCEED;
+    intn     cdfid;
+    NC      *handle    = NULL;
+    NC_var **vp        = NULL;
+    unsigned ii;
+    intn     app_ret   = SUCCEED;
+    intn     ret_value = SUCCEED;
+
+    /* no asynchronous request may be left running on the file */
+    SDPasync_drain();
 
     /* clear error stack */
     HEclear();
@@ -388,6 +540,14 @@ SDend(int32 id /* IN: file ID of file to close */)
     if (handle == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
+    /* write out the records still buffered by SDappend() */
+    if (handle->vars != NULL) {
+        vp = (NC_var **)handle->vars->values;
+        for (ii = 0; ii < handle->vars->count; ii++)
+            if (vp[ii]->app_nrecs > 0 && SDIflush_append(vp[ii]) == FAIL)
+                app_ret = FAIL;
+    }
+
     /* make sure we can write to the file */
     if (handle->flags & NC_RDWR) {
 
@@ -416,6 +576,8 @@ SDend(int32 id /* IN: file ID of file to close */)
 
     /* call netCDF close */
     ret_value = ncclose(cdfid);
+    if (app_ret == FAIL)
+        ret_value = FAIL;
 
 done:
     return ret_value;
@@ -566,6 +728,10 @@ SDgetinfo(int32  sdsid,    /* IN:  dataset ID */
     if (var == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
+    /* the records appended count once they are written */
+    if (var->app_nrecs > 0 && SDIflush_append(var) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
     /* get sds name if it's requested */
     if (name != NULL) {
         memcpy(name, var->name->values, var->name->len);
@@ -605,6 +771,71 @@ done:
     return ret_value;
 } /* SDgetinfo */
 
+/******************************************************************************
+ NAME
+    SDIread_chunked -- read a hyperslab of a chunked dataset chunk by chunk
+
+ DESCRIPTION
+    Reads the hyperslab straight from the chunks that hold it with
+    HMCreadSlab(), then converts it in place, instead of going through
+    NCvario() or NCgenio(), which read it one contiguous run of values
+    at a time.  Only fixed-size chunked datasets whose values are as
+    large in the file as in memory are read this way, and not those with
+    readahead on, which watches the reads of contiguous runs; the stride
+    must have been checked against the dimensions of the dataset.
+
+ RETURNS
+    TRUE if the slab was read, FALSE if the dataset is not read this way,
+    FAIL on error
+
+******************************************************************************/
+static intn
+SDIread_chunked(NC     *handle, /* IN: the file record */
+                NC_var *var,    /* IN: the variable record */
+                int32  *start,  /* IN: coords of starting point */
+                int32  *stride, /* IN: stride along each dimension, may be NULL */
+                int32  *end,    /* IN: number of values to read per dimension */
+                void   *data /* OUT: data buffer */)
+{
+    int8     platntsubclass; /* the machine type of the current platform */
+    int8     outntsubclass;  /* the data's machine type */
+    int32    count = 1;      /* number of values of the slab */
+    unsigned i;
+    intn     ret_value = TRUE;
+
+    if (handle->file_type != HDF_FILE || (handle->flags & NC_INDEF) || var->assoc->count == 0 ||
+        IS_RECVAR(var) || var->HDFsize != (int32)var->szof || var->data_ref == 0 || var->readahead)
+        HGOTO_DONE(FALSE);
+    for (i = 0; i < var->assoc->count; i++) {
+        if (start[i] < 0 || end[i] < 1 || (unsigned long)(start[i] + end[i]) > var->shape[i])
+            HGOTO_DONE(FALSE);
+        count *= end[i];
+    }
+
+    /* the chunk table is kept in memory by the chunking layer */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL)
+        HGOTO_DONE(FALSE);
+    if (!SDIopen_chunked(var))
+        HGOTO_DONE(FALSE);
+
+    if (HMCreadSlab(var->aid, start, stride, end, data) == FAIL)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
+
+    /* convert the values where they are if only their byte order differs */
+    if (FAIL == (platntsubclass = DFKgetPNSC(var->HDFtype, DF_MT)))
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (DFKisnativeNT(var->HDFtype))
+        outntsubclass = platntsubclass;
+    else
+        outntsubclass = DFKislitendNT(var->HDFtype) ? DFNTF_PC : DFNTF_HDFDEFAULT;
+    if (platntsubclass != outntsubclass &&
+        DFKconvert(data, data, var->HDFtype, count, DFACC_READ, 0, 0) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+done:
+    return ret_value;
+} /* SDIread_chunked */
+
 /******************************************************************************
  NAME
     SDreaddata -- read a hyperslab of data
@@ -639,7 +870,8 @@ SDreaddata(int32  sdsid,  /* IN:  dataset ID */
     long *End    = NULL;
     long *Stride = NULL;
 #endif
-    intn ret_value = SUCCEED;
+    intn no_strides = 0;
+    intn ret_value  = SUCCEED;
 
     /* This decides how a dataset with unlimited dimension is read along the
        unlimited dimension; the behavior is different between SD and nc APIs */
@@ -669,6 +901,10 @@ SDreaddata(int32  sdsid,  /* IN:  dataset ID */
     if (var == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
+    /* records appended with SDappend() are read from the file */
+    if (var->app_nrecs > 0 && SDIflush_append(var) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
     /* Dev note: empty SDS should have been checked here and SDreaddata would
        have failed, but since it wasn't, for backward compatibility, we won't
        do it now either. -BMR 2011 */
@@ -750,10 +986,22 @@ SDreaddata(int32  sdsid,  /* IN:  dataset ID */
         for (i = 1; i < var->assoc->count; i++)
             if ((Stride[i] * (End[i] - 1)) >= ((int32)var->shape[i] - Start[i]))
                 HGOTO_ERROR(DFE_ARGS, FAIL);
+
+        /* Strides all set to '1' act like NULL was passed */
+        no_strides = 1;
+        for (i = 0; i < var->assoc->count; i++)
+            if (Stride[i] != 1)
+                no_strides = 0;
+    }
+
+    /* A chunked dataset is read chunk by chunk */
+    if (dim == NULL && (status = SDIread_chunked(handle, var, start, stride, end, data)) != FALSE) {
+        ret_value = (status == FAIL) ? FAIL : SUCCEED;
+        goto done;
     }
 
-    /* Call the readg routines if a stride is given */
-    if (stride == NULL)
+    /* Call the readg routines if a stride other than all '1' is given */
+    if (stride == NULL || no_strides == 1)
         status = NCvario(handle, varid, Start, End, (Void *)data);
     else
         status = NCgenio(handle, varid, Start, End, Stride, NULL, (Void *)data);
@@ -774,188 +1022,649 @@ done:
     return ret_value;
 } /* SDreaddata */
 
+/* One read of SDreaddata_multi(), with where its data starts in the file */
+typedef struct {
+    intn  file;   /* position of the first read from the same file */
+    int32 offset; /* offset of the data in the file, FAIL if unknown */
+    intn  index;  /* position of the read in the caller's arrays */
+} sdmulti_read_t;
+
 /******************************************************************************
  NAME
-    SDnametoindex -- map a dataset name to an index
+    SDImulti_cmp -- order two reads of SDreaddata_multi()
 
  DESCRIPTION
-    Given a data set name return the index (not ID) of the
-    first data set whose name matches.
-
-    There can be multiple data sets with the same name.  In
-    such a case, we only ever return the index of the first
-    such dataset.
-    Wildcards are not supported
+    Groups the reads by file, then orders them by data offset, with the
+    reads of unknown offset last, and keeps the caller's order on ties.
+    For qsort().
 
  RETURNS
-        Index of a dataset or FAIL
-
+    <0, 0 or >0
 ******************************************************************************/
-int32
-SDnametoindex(int32       fid, /* IN: file ID */
-              const char *name /* IN: name of dataset to search for */)
+static int
+SDImulti_cmp(const void *a, const void *b)
 {
-    unsigned ii;
-    intn     len;
-    NC      *handle    = NULL;
-    NC_var **dp        = NULL;
-    int32    ret_value = FAIL;
-
-    /* check that fid is valid */
-    handle = SDIhandle_from_id(fid, CDFTYPE);
-    if (handle == NULL) {
-        HGOTO_ERROR(DFE_ARGS, FAIL);
-    }
-
-    if (handle->vars == NULL) {
-        HGOTO_ERROR(DFE_ARGS, FAIL);
-    }
+    const sdmulti_read_t *ra = (const sdmulti_read_t *)a;
+    const sdmulti_read_t *rb = (const sdmulti_read_t *)b;
 
-    len = strlen(name);
-    dp  = (NC_var **)handle->vars->values;
-    for (ii = 0; ii < handle->vars->count; ii++, dp++) {
-        if (len == (*dp)->name->len && strncmp(name, (*dp)->name->values, strlen(name)) == 0) {
-            HGOTO_DONE((int32)ii);
-        }
+    if (ra->file != rb->file)
+        return (ra->file < rb->file) ? -1 : 1;
+    if (ra->offset != rb->offset) {
+        if (ra->offset == FAIL || rb->offset == FAIL)
+            return (ra->offset == FAIL) ? 1 : -1;
+        return (ra->offset < rb->offset) ? -1 : 1;
     }
-
-    ret_value = FAIL;
-
-done:
-    return ret_value;
-} /* SDnametoindex */
+    return (ra->index < rb->index) ? -1 : (ra->index > rb->index);
+} /* SDImulti_cmp */
 
 /******************************************************************************
  NAME
-    SDgetnumvars_byname -- get the number of variables in the file having
-            the given name.
+    SDreaddata_multi -- read hyperslabs of several datasets
 
  DESCRIPTION
-    Given a data set name, retrieve the number of variables in the file having
-    the same name.  Sometime, more than one SDS are named 'name' or a
-    dimension of the SDS 'name' is also named 'name.'  The user can use
-    this function to find out how many of those having the same name.
+    Reads the hyperslab given by starts[i], strides[i] and edges[i] of
+    the dataset sdsids[i] into bufs[i], for 0 <= i < nsds, as SDreaddata()
+    would.  'strides', or any of its entries, may be NULL.
 
- RETURNS
-        SUCCEED / FAIL
+    All the IDs and arrays are checked before anything is read.  The
+    reads are then done file by file, in the order their data is laid
+    out in the file, so that the file is gone through once instead of
+    being seeked back and forth.  The chunks of each dataset are decoded
+    on its coding threads, see SDsetchunkthreads().
 
+ RETURNS
+    SUCCEED / FAIL; on failure the buffers of the reads that came before
+    the failing one in file order were filled
 ******************************************************************************/
 intn
-SDgetnumvars_byname(int32       fid,  /* IN: file ID */
-                    const char *name, /* IN: name of dataset to search for */
-                    int32      *n_vars)
+SDreaddata_multi(intn   nsds,      /* IN:  number of reads */
+                 int32  sdsids[],  /* IN:  dataset IDs */
+                 int32 *starts[],  /* IN:  coords of starting point of each read */
+                 int32 *strides[], /* IN:  stride along each dimension of each read */
+                 int32 *edges[],   /* IN:  number of values to read per dimension */
+                 void  *bufs[] /* OUT: data buffers */)
 {
-    unsigned ii;
-    intn     len;
-    int32    count     = 0;
-    NC      *handle    = NULL;
-    NC_var **dp        = NULL;
-    intn     ret_value = SUCCEED;
+    sdmulti_read_t *reads = NULL;
+    NC             *handle;
+    NC             *other;
+    NC_var         *var;
+    int32          *stride;
+    uint16          find_tag, find_ref;
+    int32           offset, length;
+    intn            i, j;
+    intn            ret_value = SUCCEED;
 
-    /* clear error stack */
+    /* Clear error stack */
     HEclear();
 
-    /* check that fid is valid */
-    handle = SDIhandle_from_id(fid, CDFTYPE);
-    if (handle == NULL) {
+    /* Validate arguments */
+    if (nsds < 0 || (nsds > 0 && (sdsids == NULL || starts == NULL || edges == NULL || bufs == NULL)))
         HGOTO_ERROR(DFE_ARGS, FAIL);
-    }
+    if (nsds == 0)
+        HGOTO_DONE(SUCCEED);
 
-    if (handle->vars == NULL) {
-        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if ((reads = (sdmulti_read_t *)malloc((size_t)nsds * sizeof(sdmulti_read_t))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    /* Find where the data of each read starts */
+    for (i = 0; i < nsds; i++) {
+        if (starts[i] == NULL || edges[i] == NULL || bufs[i] == NULL)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+
+        reads[i].index  = i;
+        reads[i].offset = FAIL;
+
+        /* Coordinate variables of dimensions are read last */
+        handle = SDIhandle_from_id(sdsids[i], SDSTYPE);
+        if (handle == NULL) {
+            handle = SDIhandle_from_id(sdsids[i], DIMTYPE);
+            if (handle == NULL || SDIget_dim(handle, sdsids[i]) == NULL)
+                HGOTO_ERROR(DFE_ARGS, FAIL);
+        }
+        else {
+            if (handle->vars == NULL)
+                HGOTO_ERROR(DFE_ARGS, FAIL);
+            if ((var = SDIget_var(handle, sdsids[i])) == NULL)
+                HGOTO_ERROR(DFE_ARGS, FAIL);
+
+            if (handle->file_type != HDF_FILE)
+                reads[i].offset = (int32)var->begin;
+            else if (var->data_ref != 0) {
+                /* The offset of the DD, the header of a special element */
+                find_tag = find_ref = 0;
+                if (Hfind(handle->hdf_file, (uint16)var->data_tag, (uint16)var->data_ref, &find_tag, &find_ref,
+                          &offset, &length, DF_FORWARD) == SUCCEED)
+                    reads[i].offset = offset;
+            }
+        }
+
+        /* Group the reads from the same file */
+        reads[i].file = i;
+        for (j = 0; j < i; j++) {
+            other = SDIhandle_from_id(sdsids[j], SDSTYPE);
+            if (other == NULL)
+                other = SDIhandle_from_id(sdsids[j], DIMTYPE);
+            if (other == handle) {
+                reads[i].file = reads[j].file;
+                break;
+            }
+        }
     }
 
-    len = strlen(name);
-    dp  = (NC_var **)handle->vars->values;
-    for (ii = 0; ii < handle->vars->count; ii++, dp++) {
-        if (len == (*dp)->name->len && strncmp(name, (*dp)->name->values, strlen(name)) == 0)
-            count++;
+    qsort(reads, (size_t)nsds, sizeof(sdmulti_read_t), SDImulti_cmp);
+
+    for (i = 0; i < nsds; i++) {
+        j      = reads[i].index;
+        stride = (strides != NULL) ? strides[j] : NULL;
+        if (SDreaddata(sdsids[j], starts[j], stride, edges[j], bufs[j]) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
     }
-    *n_vars = count;
 
 done:
+    free(reads);
     return ret_value;
-} /* SDgetnumvars_byname */
+} /* SDreaddata_multi */
 
 /******************************************************************************
  NAME
-    SDnametoindices -- retrieves a list of variables having the given name.
+    SDreaddata_files -- read a slab of a dataset spanning several files
 
  DESCRIPTION
-    Given a data set name, retrieve a list of structures, each of which
-    contains the index of a variable whose name matches the given name, and
-    the type of the variable, which is either data set (IS_SDSVAR) or
-    coordinate variable (IS_CRDVAR,) or (UNKNOWN.)  UNKNOWN is for data
-    created before the fix of a data corruption bug due to the library's
-    inability to distinguish between those two types of variables.  The
-    fix was available starting in HDF4.2r2.
-
-    This API is added to allow the user to examine all the variables having
-    the given name and decide the correct one to gain access on.
+    Reads a slab of the virtual dataset made of the dataset named
+    'sdsname' in each of the 'nfiles' files 'paths', stacked along a new
+    first dimension whose index is that of the file in 'paths'.  The
+    virtual dataset has one more dimension than the datasets, and
+    'start', 'stride' and 'edge' one entry more, for the files first.
+    'stride' may be NULL.  The datasets must have the same rank and
+    number type; the slab must fit in each of them.
+
+    Only the files in the slab are opened, one at a time, read-only, and
+    only the slab of each is read, into the next part of 'data'.  With
+    'nthreads' greater than 1, the chunks of each dataset are decoded on
+    up to that many threads, see SDsetchunkthreads().  With the metadata
+    cache, see SDsetmetacache(), reading from the same files again does
+    not read their metadata again.
 
  RETURNS
-        SUCCEED / FAIL
-
+    SUCCEED / FAIL; on failure the slabs of the files before the failing
+    one were read
 ******************************************************************************/
 intn
-SDnametoindices(int32          fid,  /* IN: file ID */
-                const char    *name, /* IN: name of dataset to search for */
-                hdf_varlist_t *var_list)
+SDreaddata_files(intn        nfiles,   /* IN:  number of files */
+                 const char *paths[],  /* IN:  names of the files */
+                 const char *sdsname,  /* IN:  name of the dataset in each file */
+                 int32      *start,    /* IN:  coords of starting point, file first */
+                 int32      *stride,   /* IN:  stride along each dimension */
+                 int32      *edge,     /* IN:  number of values to read per dimension */
+                 intn        nthreads, /* IN:  number of threads decoding chunks */
+                 void       *data /* OUT: data buffer */)
 {
-    unsigned       ii;
-    intn           len;
-    NC            *handle = NULL;
-    NC_var       **dp     = NULL;
-    hdf_varlist_t *varlistp;
-    int32          ret_value = SUCCEED;
+    int32  fid   = FAIL;
+    int32  sdsid = FAIL;
+    int32  index, rank, nt, nattrs;
+    int32  dimsizes[H4_MAX_VAR_DIMS];
+    int32  rank0 = 0, nt0 = 0;
+    int32  step, n, i, j;
+    size_t slab      = 0;
+    uint8 *buf       = (uint8 *)data;
+    intn   ret_value = SUCCEED;
 
-    /* clear error stack */
+    /* Clear error stack */
     HEclear();
 
-    /* check that fid is valid */
-    handle = SDIhandle_from_id(fid, CDFTYPE);
-    if (handle == NULL) {
+    /* Validate arguments */
+    if (nfiles <= 0 || paths == NULL || sdsname == NULL || start == NULL || edge == NULL || data == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
-    }
-
-    if (handle->vars == NULL) {
+    step = (stride != NULL) ? stride[0] : 1;
+    if (start[0] < 0 || edge[0] < 0 || step <= 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (edge[0] > 0 && (edge[0] - 1) > (nfiles - 1 - start[0]) / step)
         HGOTO_ERROR(DFE_ARGS, FAIL);
-    }
 
-    len      = strlen(name);
-    dp       = (NC_var **)handle->vars->values;
-    varlistp = var_list;
-    for (ii = 0; ii < handle->vars->count; ii++, dp++) {
-        if (len == (*dp)->name->len && strncmp(name, (*dp)->name->values, strlen(name)) == 0) {
-            varlistp->var_index = (int32)ii;
-            varlistp->var_type  = (*dp)->var_type;
-            varlistp++;
+    for (i = 0; i < edge[0]; i++) {
+        if ((fid = SDstart(paths[start[0] + i * step], DFACC_READ)) == FAIL)
+            HGOTO_ERROR(DFE_BADOPEN, FAIL);
+        if ((index = SDnametoindex(fid, sdsname)) == FAIL)
+            HGOTO_ERROR(DFE_NOMATCH, FAIL);
+        if ((sdsid = SDselect(fid, index)) == FAIL)
+            HGOTO_ERROR(DFE_CANTACCESS, FAIL);
+        if (SDgetinfo(sdsid, NULL, &rank, dimsizes, &nt, &nattrs) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+        /* The first file sets the shape of the slab of each */
+        if (i == 0) {
+            rank0 = rank;
+            nt0   = nt;
+            for (n = 1, j = 1; j <= rank; j++) {
+                if (edge[j] < 0)
+                    HGOTO_ERROR(DFE_ARGS, FAIL);
+                n *= edge[j];
+            }
+            slab = (size_t)n * (size_t)DFKNTsize(nt | DFNT_NATIVE);
         }
+        else if (rank != rank0)
+            HGOTO_ERROR(DFE_BADDIM, FAIL);
+        else if (nt != nt0)
+            HGOTO_ERROR(DFE_BADNUMTYPE, FAIL);
+
+        /* Datasets that are not chunked simply keep reading serially */
+        if (nthreads > 1)
+            SDsetchunkthreads(sdsid, nthreads);
+
+        if (SDreaddata(sdsid, start + 1, (stride != NULL) ? stride + 1 : NULL, edge + 1, buf) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        buf += slab;
+
+        SDendaccess(sdsid);
+        sdsid = FAIL;
+        SDend(fid);
+        fid = FAIL;
     }
 
 done:
+    if (sdsid != FAIL)
+        SDendaccess(sdsid);
+    if (fid != FAIL)
+        SDend(fid);
     return ret_value;
-} /* SDnametoindices */
+} /* SDreaddata_files */
+
+/* Calibrate the n values of type 'stype' in 'sbuf' into values of type
+   'otype' in 'dbuf', masking the fill values when 'fill' is not NULL.  The
+   buffers may be the same: values that grow are done from the last one
+   down, values that shrink from the first one up, so that each value is
+   read before its bytes are written over. */
+#define SDI_CALIBRATE(stype, otype)                                                                          \
+    {                                                                                                        \
+        const stype *src = (const stype *)sbuf;                                                              \
+        otype       *dst = (otype *)dbuf;                                                                    \
+        stype        fv  = (fill != NULL) ? *(const stype *)fill : (stype)0;                                 \
+        intn         fnan = (fv != fv);                                                                      \
+        int32        ii;                                                                                     \
+                                                                                                             \
+        if (sizeof(otype) >= sizeof(stype)) {                                                                \
+            if (fill == NULL)                                                                                \
+                for (ii = n - 1; ii >= 0; ii--)                                                              \
+                    dst[ii] = (otype)(cal * ((float64)src[ii] - ioff));                                      \
+            else                                                                                             \
+                for (ii = n - 1; ii >= 0; ii--) {                                                            \
+                    stype x = src[ii];                                                                       \
+                    dst[ii] = (x == fv || (fnan && x != x)) ? (otype)fillout                                 \
+                                                            : (otype)(cal * ((float64)x - ioff));            \
+                }                                                                                            \
+        }                                                                                                    \
+        else {                                                                                               \
+            if (fill == NULL)                                                                                \
+                for (ii = 0; ii < n; ii++)                                                                   \
+                    dst[ii] = (otype)(cal * ((float64)src[ii] - ioff));                                      \
+            else                                                                                             \
+                for (ii = 0; ii < n; ii++) {                                                                 \
+                    stype x = src[ii];                                                                       \
+                    dst[ii] = (x == fv || (fnan && x != x)) ? (otype)fillout                                 \
+                                                            : (otype)(cal * ((float64)x - ioff));            \
+                }                                                                                            \
+        }                                                                                                    \
+    }
 
 /******************************************************************************
  NAME
-    SDgetrange -- simulate a call to DFSDgetrange
+    SDIcalibrate -- calibrate values read from a dataset
 
  DESCRIPTION
-    If a "valid_range" attribute is provided return its
-    values in pmax and pmin.  Else if both a "valid max"
-    AND a "valid min" exist return their values in pmax and pmin.
-
-    Arrgghh, in HDF it was assumed that the max and min values
-    were of the same data type as the rest of the data.  So
-    the user would know the amount of storage to send to get
-    back the max and min values.  This is not the case with
-    netCDF.  This routine will only work if they are already
-    the same number types.
+    Turns the n values of number type nt in sbuf into cal * (x - ioff)
+    as float32 or float64, per out_nt, in dbuf, and the values equal to
+    *fill, if fill is not NULL, into fillout.  sbuf and dbuf may be the
+    same buffer.
 
  RETURNS
-    On error or missing attributes return FAIL else SUCCEED.
-
+    SUCCEED / FAIL
+******************************************************************************/
+static intn
+SDIcalibrate(const void *sbuf, void *dbuf, int32 n, int32 nt, int32 out_nt, float64 cal, float64 ioff,
+             const void *fill, float64 fillout)
+{
+    intn ret_value = SUCCEED;
+
+    switch (nt & ~DFNT_NATIVE) {
+        case DFNT_CHAR8:
+        case DFNT_INT8:
+            if (out_nt == DFNT_FLOAT32)
+                SDI_CALIBRATE(int8, float32)
+            else
+                SDI_CALIBRATE(int8, float64)
+            break;
+        case DFNT_UCHAR8:
+        case DFNT_UINT8:
+            if (out_nt == DFNT_FLOAT32)
+                SDI_CALIBRATE(uint8, float32)
+            else
+                SDI_CALIBRATE(uint8, float64)
+            break;
+        case DFNT_INT16:
+            if (out_nt == DFNT_FLOAT32)
+                SDI_CALIBRATE(int16, float32)
+            else
+                SDI_CALIBRATE(int16, float64)
+            break;
+        case DFNT_UINT16:
+            if (out_nt == DFNT_FLOAT32)
+                SDI_CALIBRATE(uint16, float32)
+            else
+                SDI_CALIBRATE(uint16, float64)
+            break;
+        case DFNT_INT32:
+            if (out_nt == DFNT_FLOAT32)
+                SDI_CALIBRATE(int32, float32)
+            else
+                SDI_CALIBRATE(int32, float64)
+            break;
+        case DFNT_UINT32:
+            if (out_nt == DFNT_FLOAT32)
+                SDI_CALIBRATE(uint32, float32)
+            else
+                SDI_CALIBRATE(uint32, float64)
+            break;
+        case DFNT_FLOAT32:
+            if (out_nt == DFNT_FLOAT32)
+                SDI_CALIBRATE(float32, float32)
+            else
+                SDI_CALIBRATE(float32, float64)
+            break;
+        case DFNT_FLOAT64:
+            if (out_nt == DFNT_FLOAT32)
+                SDI_CALIBRATE(float64, float32)
+            else
+                SDI_CALIBRATE(float64, float64)
+            break;
+        default:
+            HGOTO_ERROR(DFE_BADNUMTYPE, FAIL);
+    }
+
+done:
+    return ret_value;
+} /* SDIcalibrate */
+
+/* Get the calibration attribute 'name' of var into *val, which is left
+   as it is if there is no such float64 or float32 attribute. */
+static void
+SDIcalvalue(NC_var *var, const char *name, float64 *val)
+{
+    NC_attr **attr;
+
+    attr = (NC_attr **)NC_findattr(&(var->attrs), name);
+    if (attr == NULL || (*attr)->data->count == 0)
+        return;
+    if ((*attr)->data->type == NC_DOUBLE)
+        *val = *(float64 *)(*attr)->data->values;
+    else if ((*attr)->data->type == NC_FLOAT)
+        *val = (float64)(*(float32 *)(*attr)->data->values);
+} /* SDIcalvalue */
+
+/******************************************************************************
+ NAME
+    SDreaddata_calibrated -- read a hyperslab of calibrated data
+
+ DESCRIPTION
+    Reads a hyperslab of the dataset as SDreaddata() does and returns
+    it calibrated, cal * (x - ioff) with the calibration set by
+    SDsetcal(), as float32 or float64 values, per out_nt.  The values
+    equal to the fill value of the dataset, if one was set, are returned
+    as fillout instead.  A dataset without calibration is returned with
+    cal 1 and ioff 0.
+
+    The data is read into 'data' itself and calibrated there in one
+    pass, so no buffer of the stored values is needed unless they are
+    larger than the values returned, i.e. float64 data read as float32.
+    'data' must hold the number of values read times the size of out_nt.
+
+ RETURNS
+    SUCCEED / FAIL
+
+******************************************************************************/
+intn
+SDreaddata_calibrated(int32   sdsid,   /* IN:  dataset ID */
+                      int32  *start,   /* IN:  coords of starting point */
+                      int32  *stride,  /* IN:  stride along each dimension */
+                      int32  *edge,    /* IN:  number of values to read per dimension */
+                      int32   out_nt,  /* IN:  DFNT_FLOAT32 or DFNT_FLOAT64 */
+                      float64 fillout, /* IN:  value returned for fill values */
+                      void   *data /* OUT: data buffer */)
+{
+    NC       *handle = NULL;
+    NC_var   *var    = NULL;
+    NC_attr **attr   = NULL;
+    float64   cal    = 1.0;
+    float64   ioff   = 0.0;
+    float64   fill[1]; /* room for a fill value of any type, aligned */
+    intn      has_fill = FALSE;
+    void     *buf      = NULL;
+    int32     nt, n;
+    intn      ssize, dsize;
+    intn      i;
+    intn      ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* Validate arguments */
+    if (start == NULL || edge == NULL || data == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (out_nt != DFNT_FLOAT32 && out_nt != DFNT_FLOAT64)
+        HGOTO_ERROR(DFE_BADNUMTYPE, FAIL);
+
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->vars == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    nt    = var->HDFtype ? var->HDFtype : hdf_map_type(var->type);
+    ssize = DFKNTsize(nt | DFNT_NATIVE);
+    dsize = DFKNTsize(out_nt);
+    if (ssize <= 0 || ssize > (intn)sizeof(fill))
+        HGOTO_ERROR(DFE_BADNUMTYPE, FAIL);
+
+    for (n = 1, i = 0; i < var->assoc->count; i++) {
+        if (edge[i] < 0)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+        n *= edge[i];
+    }
+
+    /* The calibration and fill value, as SDgetcal() and SDgetfillvalue() */
+    SDIcalvalue(var, _HDF_ScaleFactor, &cal);
+    SDIcalvalue(var, _HDF_AddOffset, &ioff);
+    attr = (NC_attr **)NC_findattr(&(var->attrs), _FillValue);
+    if (attr != NULL) {
+        NC_copy_arrayvals((char *)fill, (*attr)->data);
+        has_fill = TRUE;
+    }
+
+    /* Read the stored values into the output buffer, unless they do not fit */
+    if (ssize > dsize) {
+        if ((buf = malloc((size_t)n * (size_t)ssize)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    }
+    if (SDreaddata(sdsid, start, stride, edge, buf ? buf : data) == FAIL)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
+
+    if (SDIcalibrate(buf ? buf : data, data, n, nt, out_nt, cal, ioff, has_fill ? fill : NULL, fillout) ==
+        FAIL)
+        HGOTO_ERROR(DFE_BADNUMTYPE, FAIL);
+
+done:
+    free(buf);
+    return ret_value;
+} /* SDreaddata_calibrated */
+
+/******************************************************************************
+ NAME
+    SDnametoindex -- map a dataset name to an index
+
+ DESCRIPTION
+    Given a data set name return the index (not ID) of the
+    first data set whose name matches.
+
+    There can be multiple data sets with the same name.  In
+    such a case, we only ever return the index of the first
+    such dataset.
+    Wildcards are not supported
+
+ RETURNS
+        Index of a dataset or FAIL
+
+******************************************************************************/
+int32
+SDnametoindex(int32       fid, /* IN: file ID */
+              const char *name /* IN: name of dataset to search for */)
+{
+    int   ii;
+    NC   *handle    = NULL;
+    int32 ret_value = FAIL;
+
+    /* check that fid is valid */
+    handle = SDIhandle_from_id(fid, CDFTYPE);
+    if (handle == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    if (handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    ii = NC_findname(handle->vars, name, -1);
+    if (ii >= 0) {
+        HGOTO_DONE((int32)ii);
+    }
+
+    ret_value = FAIL;
+
+done:
+    return ret_value;
+} /* SDnametoindex */
+
+/******************************************************************************
+ NAME
+    SDgetnumvars_byname -- get the number of variables in the file having
+            the given name.
+
+ DESCRIPTION
+    Given a data set name, retrieve the number of variables in the file having
+    the same name.  Sometime, more than one SDS are named 'name' or a
+    dimension of the SDS 'name' is also named 'name.'  The user can use
+    this function to find out how many of those having the same name.
+
+ RETURNS
+        SUCCEED / FAIL
+
+******************************************************************************/
+intn
+SDgetnumvars_byname(int32       fid,  /* IN: file ID */
+                    const char *name, /* IN: name of dataset to search for */
+                    int32      *n_vars)
+{
+    int   ii;
+    int32 count     = 0;
+    NC   *handle    = NULL;
+    intn  ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* check that fid is valid */
+    handle = SDIhandle_from_id(fid, CDFTYPE);
+    if (handle == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    if (handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    for (ii = NC_findname(handle->vars, name, -1); ii >= 0; ii = NC_findname(handle->vars, name, ii))
+        count++;
+    *n_vars = count;
+
+done:
+    return ret_value;
+} /* SDgetnumvars_byname */
+
+/******************************************************************************
+ NAME
+    SDnametoindices -- retrieves a list of variables having the given name.
+
+ DESCRIPTION
+    Given a data set name, retrieve a list of structures, each of which
+    contains the index of a variable whose name matches the given name, and
+    the type of the variable, which is either data set (IS_SDSVAR) or
+    coordinate variable (IS_CRDVAR,) or (UNKNOWN.)  UNKNOWN is for data
+    created before the fix of a data corruption bug due to the library's
+    inability to distinguish between those two types of variables.  The
+    fix was available starting in HDF4.2r2.
+
+    This API is added to allow the user to examine all the variables having
+    the given name and decide the correct one to gain access on.
+
+ RETURNS
+        SUCCEED / FAIL
+
+******************************************************************************/
+intn
+SDnametoindices(int32          fid,  /* IN: file ID */
+                const char    *name, /* IN: name of dataset to search for */
+                hdf_varlist_t *var_list)
+{
+    int            ii;
+    NC            *handle = NULL;
+    NC_var       **dp     = NULL;
+    hdf_varlist_t *varlistp;
+    int32          ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* check that fid is valid */
+    handle = SDIhandle_from_id(fid, CDFTYPE);
+    if (handle == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    if (handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    varlistp = var_list;
+    for (ii = NC_findname(handle->vars, name, -1); ii >= 0; ii = NC_findname(handle->vars, name, ii)) {
+        dp                  = (NC_var **)handle->vars->values + ii;
+        varlistp->var_index = (int32)ii;
+        varlistp->var_type  = (*dp)->var_type;
+        varlistp++;
+    }
+
+done:
+    return ret_value;
+} /* SDnametoindices */
+
+/******************************************************************************
+ NAME
+    SDgetrange -- simulate a call to DFSDgetrange
+
+ DESCRIPTION
+    If a "valid_range" attribute is provided return its
+    values in pmax and pmin.  Else if both a "valid max"
+    AND a "valid min" exist return their values in pmax and pmin.
+
+    Arrgghh, in HDF it was assumed that the max and min values
+    were of the same data type as the rest of the data.  So
+    the user would know the amount of storage to send to get
+    back the max and min values.  This is not the case with
+    netCDF.  This routine will only work if they are already
+    the same number types.
+
+ RETURNS
+    On error or missing attributes return FAIL else SUCCEED.
+
 ******************************************************************************/
 intn
 SDgetrange(int32 sdsid, /* IN:  dataset ID */
@@ -1016,6 +1725,9 @@ done:
         --- create a new data set ---
 sdsid   = SDcreate(fid, name, numbertype, rank, dimsizes);
 
+        --- create many data sets of one shape, sharing their dimensions ---
+status  = SDcreate_many(fid, n, names, numbertype, rank, dimsizes, sdsids);
+
         --- associate a name with a dimension.  If a prev sdsid is ---
         --- provided then it is assumed that the current dimension is the ---
         --- same as the dimension with the same name of the previous sds ---
@@ -1040,78 +1752,18 @@ status  = SDsetdimval_comp(dimid, compt_mode);
 
 */
 
-/******************************************************************************
- NAME
-    SDcreate -- create a new dataset
-
- DESCRIPTION
-    Simulate a call to ncvardef without having to be in
-    define mode.  name can be at most H4_MAX_NC_NAME
-    characters.  Rank can be at most H4_MAX_VAR_DIMS
-
-    It looks like for the call to NC_new_var() we need to
-    have dimension IDs already.  So I guess we should just
-    create the fake dimensions now and when optional
-    information comes in (i.e.  name, tying to other
-    dimensions) we'll go in and modify the structure in place.
-    This is gonna be heinous.  Please do not attempt this at home
-    See SDselect() for a discussion on how SDS IDs are set up.
-
- RETURNS
-    An ID to the new dataset else FAIL
-
-******************************************************************************/
-int32
-SDcreate(int32       fid,  /* IN: file ID */
-         const char *name, /* IN: dataset name */
-         int32       nt,   /* IN: dataset number type */
-         int32       rank, /* IN: rank of dataset */
-         int32      *dimsizes /* IN: array of dimension sizes */)
+/*
+ * Add 'rank' fake dimensions of sizes 'dimsizes' to the file, which may or
+ * may not be over-ridden later, and store their indices in 'dims'
+ */
+static intn
+SDIcreate_fakedims(NC *handle, int32 rank, int32 *dimsizes, intn *dims)
 {
     intn    i;
-    NC     *handle = NULL;
-    NC_var *var    = NULL;
     NC_dim *newdim = NULL;
-    int32   sdsid;
-    nc_type nctype;
     char    dimname[H4_MAX_NC_NAME];
     intn    num;
-    intn   *dims = NULL;
-    intn    is_ragged;
-    int32   ret_value = FAIL;
-
-    /* clear error stack */
-    HEclear();
-
-    /* check that fid is valid */
-    handle = SDIhandle_from_id(fid, CDFTYPE);
-    if (handle == NULL) {
-        HGOTO_ERROR(DFE_ARGS, FAIL);
-    }
-
-    /* fudge the name since its optional */
-    if ((name == NULL) || (name[0] == ' ') || (name[0] == '\0'))
-        name = "DataSet";
-
-    /* check if its a ragged array.
-       Why is this code still here? -GV */
-    if ((rank > 1) && dimsizes[rank - 1] == SD_RAGGED) {
-        rank--;
-        is_ragged = TRUE;
-    }
-    else {
-        is_ragged = FALSE;
-    }
-
-    /* make fake dimensions which may or may not be over-ridden later */
-    dims = malloc(rank * sizeof(intn));
-    if (dims == NULL) {
-        HGOTO_ERROR(DFE_NOSPACE, FAIL);
-    }
-
-    if (rank > H4_MAX_VAR_DIMS) {
-        HGOTO_ERROR(DFE_ARGS, FAIL);
-    }
+    intn    ret_value = SUCCEED;
 
     for (i = 0; i < rank; i++) {
         num = (handle->dims ? handle->dims->count : 0);
@@ -1137,14 +1789,33 @@ SDcreate(int32       fid,  /* IN: file ID */
 
     } /* end for 'i < rank' */
 
+done:
+    return ret_value;
+} /* SDIcreate_fakedims */
+
+/*
+ * Make a new dataset on the dimensions 'dims' of the file, ready to be
+ * added to it, see SDcreate()
+ */
+static NC_var *
+SDIcreate_var(NC *handle, const char *name, int32 nt, int32 rank, intn *dims, intn is_ragged)
+{
+    NC_var *var = NULL;
+    nc_type nctype;
+    NC_var *ret_value = NULL;
+
+    /* fudge the name since its optional */
+    if ((name == NULL) || (name[0] == ' ') || (name[0] == '\0'))
+        name = "DataSet";
+
     /* create the actual variable */
     if ((nctype = hdf_unmap_type((int)nt)) == FAIL) {
-        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        HGOTO_ERROR(DFE_INTERNAL, NULL);
     }
 
     var = (NC_var *)NC_new_var(name, nctype, (int)rank, dims);
     if (var == NULL) {
-        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        HGOTO_ERROR(DFE_INTERNAL, NULL);
     }
 
     /* Set the "newly created" & "set length" flags for use in SDwritedata */
@@ -1158,7 +1829,7 @@ SDcreate(int32       fid,  /* IN: file ID */
     /* NC_new_var strips off "nativeness" add it back in if appropriate */
     var->HDFtype = nt;
     if (FAIL == (var->HDFsize = DFKNTsize(nt))) {
-        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        HGOTO_ERROR(DFE_INTERNAL, NULL);
     }
 
     var->cdf = handle; /* set cdf before calling NC_var_shape */
@@ -1174,6 +1845,93 @@ SDcreate(int32       fid,  /* IN: file ID */
         var->rag_fill = 0;
     }
 
+    /* compute all of the shape information */
+    if (NC_var_shape(var, handle->dims) == -1) {
+        HGOTO_ERROR(DFE_INTERNAL, NULL);
+    }
+
+    ret_value = var;
+
+done:
+    if (ret_value == NULL && var != NULL)
+        NC_free_var(var);
+
+    return ret_value;
+} /* SDIcreate_var */
+
+/******************************************************************************
+ NAME
+    SDcreate -- create a new dataset
+
+ DESCRIPTION
+    Simulate a call to ncvardef without having to be in
+    define mode.  name can be at most H4_MAX_NC_NAME
+    characters.  Rank can be at most H4_MAX_VAR_DIMS
+
+    It looks like for the call to NC_new_var() we need to
+    have dimension IDs already.  So I guess we should just
+    create the fake dimensions now and when optional
+    information comes in (i.e.  name, tying to other
+    dimensions) we'll go in and modify the structure in place.
+    This is gonna be heinous.  Please do not attempt this at home
+    See SDselect() for a discussion on how SDS IDs are set up.
+
+ RETURNS
+    An ID to the new dataset else FAIL
+
+******************************************************************************/
+int32
+SDcreate(int32       fid,  /* IN: file ID */
+         const char *name, /* IN: dataset name */
+         int32       nt,   /* IN: dataset number type */
+         int32       rank, /* IN: rank of dataset */
+         int32      *dimsizes /* IN: array of dimension sizes */)
+{
+    NC     *handle = NULL;
+    NC_var *var    = NULL;
+    int32   sdsid;
+    intn   *dims = NULL;
+    intn    is_ragged;
+    int32   ret_value = FAIL;
+
+    /* clear error stack */
+    HEclear();
+
+    /* check that fid is valid */
+    handle = SDIhandle_from_id(fid, CDFTYPE);
+    if (handle == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* check if its a ragged array.
+       Why is this code still here? -GV */
+    if ((rank > 1) && dimsizes[rank - 1] == SD_RAGGED) {
+        rank--;
+        is_ragged = TRUE;
+    }
+    else {
+        is_ragged = FALSE;
+    }
+
+    /* make fake dimensions which may or may not be over-ridden later */
+    dims = malloc(rank * sizeof(intn));
+    if (dims == NULL) {
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    }
+
+    if (rank > H4_MAX_VAR_DIMS) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    if (SDIcreate_fakedims(handle, rank, dimsizes, dims) == FAIL) {
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    }
+
+    /* create the actual variable */
+    if ((var = SDIcreate_var(handle, name, nt, rank, dims, is_ragged)) == NULL) {
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    }
+
     /* add it to the handle */
     if (handle->vars == NULL) { /* first time */
         handle->vars = NC_new_array(NC_VARIABLE, (unsigned)1, (Void *)&var);
@@ -1192,11 +1950,6 @@ SDcreate(int32       fid,  /* IN: file ID */
         }
     }
 
-    /* compute all of the shape information */
-    if (NC_var_shape(var, handle->dims) == -1) {
-        HGOTO_ERROR(DFE_INTERNAL, FAIL);
-    }
-
     /* create a handle we can give back to the user */
     sdsid = (((int32)fid) << 20) + (((int32)SDSTYPE) << 16);
     sdsid += handle->vars->count - 1;
@@ -1204,14 +1957,118 @@ SDcreate(int32       fid,  /* IN: file ID */
     /* make sure it gets reflected in the file */
     handle->flags |= NC_HDIRTY;
 
+    ret_value = sdsid;
+
+done:
     /* free dims */
     free(dims);
 
-    ret_value = sdsid;
+    return ret_value;
+} /* SDcreate */
+
+/******************************************************************************
+ NAME
+    SDcreate_many -- create many datasets of the same shape
+
+ DESCRIPTION
+    Creates 'n' datasets named 'names', all of number type 'nt', rank
+    'rank' and dimension sizes 'dimsizes', and stores their IDs in
+    'sds_ids'.  A NULL name gives the default name, as with SDcreate().
+
+    The datasets share one set of dimensions, as if they had been given
+    the same dimension names with SDsetdimname(): renaming a dimension of
+    one of them, or giving it a scale, does it for all of them.  Each
+    dimension is written to the file once instead of once per dataset, a
+    dimension Vgroup and its Vdata, which is most of the objects of a file
+    of many small datasets.  The datasets are added to the file in one go
+    and, like with SDcreate(), their metadata is written by SDend().
+
+ RETURNS
+    SUCCEED, or FAIL with no dataset created
+******************************************************************************/
+intn
+SDcreate_many(int32       fid,      /* IN:  file ID */
+              intn        n,        /* IN:  number of datasets */
+              const char *names[],  /* IN:  dataset names */
+              int32       nt,       /* IN:  number type of the datasets */
+              int32       rank,     /* IN:  rank of the datasets */
+              int32      *dimsizes, /* IN:  dimension sizes of the datasets */
+              int32       sds_ids[] /* OUT: dataset IDs */)
+{
+    NC      *handle = NULL;
+    NC_var **vars   = NULL;
+    intn    *dims   = NULL;
+    intn     nvars  = 0;
+    intn     first;
+    intn     i;
+    intn     ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* check that fid is valid */
+    handle = SDIhandle_from_id(fid, CDFTYPE);
+    if (handle == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    if (n < 0 || rank < 1 || rank > H4_MAX_VAR_DIMS || dimsizes == NULL || (n > 0 && sds_ids == NULL)) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+    if (dimsizes[rank - 1] == SD_RAGGED) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+    if (n == 0)
+        HGOTO_DONE(SUCCEED);
+
+    first = (handle->vars ? (intn)handle->vars->count : 0);
+    if (n > H4_MAX_NC_VARS - first) {
+        HGOTO_ERROR(DFE_EXCEEDMAX, FAIL);
+    }
+
+    dims = malloc((size_t)rank * sizeof(intn));
+    vars = malloc((size_t)n * sizeof(NC_var *));
+    if (dims == NULL || vars == NULL) {
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    }
+
+    /* one set of fake dimensions for all the datasets */
+    if (SDIcreate_fakedims(handle, rank, dimsizes, dims) == FAIL) {
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    }
+
+    for (nvars = 0; nvars < n; nvars++) {
+        vars[nvars] = SDIcreate_var(handle, (names != NULL) ? names[nvars] : NULL, nt, rank, dims, FALSE);
+        if (vars[nvars] == NULL) {
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        }
+    }
+
+    /* add them all to the handle */
+    if (handle->vars == NULL) /* first time */
+        handle->vars = NC_new_array(NC_VARIABLE, (unsigned)n, (Void *)vars);
+    else if (NC_append_array(handle->vars, (unsigned)n, (Void *)vars) == NULL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (handle->vars == NULL) {
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    }
+    nvars = 0; /* the handle has them now */
+
+    /* create the handles we can give back to the user */
+    for (i = 0; i < n; i++)
+        sds_ids[i] = (((int32)fid) << 20) + (((int32)SDSTYPE) << 16) + first + i;
+
+    /* make sure it gets reflected in the file */
+    handle->flags |= NC_HDIRTY;
 
 done:
+    for (i = 0; i < nvars; i++)
+        NC_free_var(vars[i]);
+    free(vars);
+    free(dims);
+
     return ret_value;
-} /* SDcreate */
+} /* SDcreate_many */
 
 /******************************************************************************
  NAME
@@ -1345,6 +2202,8 @@ SDsetdimname(int32       id, /* IN: dataset ID */
                 NC_free_dim(dim);
                 (*dp)->count += 1;
                 (*ap) = (NC_array *)(*dp);
+                NC_unindex_array(handle->dims);
+                handle->full_flush = TRUE;
                 HGOTO_DONE(SUCCEED);
             }
         }
@@ -1359,6 +2218,8 @@ SDsetdimname(int32       id, /* IN: dataset ID */
 
     dim->name = new;
     NC_free_string(old);
+    NC_unindex_array(handle->dims);
+    handle->full_flush = TRUE;
 
     /* make sure it gets reflected in the file */
     handle->flags |= NC_HDIRTY;
@@ -1381,8 +2242,14 @@ done:
 intn
 SDendaccess(int32 id /* IN: dataset ID */)
 {
-    NC   *handle;
-    int32 ret_value = SUCCEED;
+    NC     *handle;
+    NC_var *var;
+    uint8   range[2 * sizeof(float64)]; /* least and greatest value, see SDsetautorange() */
+    intn    app_ret   = SUCCEED;
+    int32   ret_value = SUCCEED;
+
+    /* no asynchronous request may be left running on the dataset */
+    SDPasync_drain();
 
     /* clear error stack */
     HEclear();
@@ -1393,8 +2260,28 @@ SDendaccess(int32 id /* IN: dataset ID */)
         HGOTO_ERROR(DFE_ARGS, FAIL);
     }
 
+    /* write out the records still buffered by SDappend() */
+    var = SDIget_var(handle, id);
+    if (var != NULL && var->app_nrecs > 0)
+        app_ret = SDIflush_append(var);
+
+    /* store the range kept since SDsetautorange() */
+    if (var != NULL && var->autorange && NC_range_get(var, range + var->szof, range) != FAIL) {
+        if (SDIputattr(&var->attrs, _HDF_ValidRange, var->HDFtype, (intn)2, range) == FAIL)
+            app_ret = FAIL;
+        handle->flags |= NC_HDIRTY;
+    }
+    if (var != NULL)
+        var->autorange = FALSE;
+
     /* free the AID */
     ret_value = SDIfreevarAID(handle, id & 0xffff);
+    if (app_ret == FAIL)
+        ret_value = FAIL;
+
+    /* give back the chunks still held by SDgetchunkptr() */
+    if (var != NULL && NC_end_views(var) == FAIL)
+        ret_value = FAIL;
 
 done:
     return ret_value;
@@ -1453,6 +2340,7 @@ SDIputattr(NC_array  **ap,    /* IN/OUT: attribute list */
             }
             (*atp)->HDFtype = nt; /* Add HDFtype  */
             NC_free_attr(old);
+            (*ap)->dirty = TRUE;
         }
         else {
             if ((*ap)->count >= H4_MAX_NC_ATTRS) { /* Too many */
@@ -1544,60 +2432,156 @@ done:
     return ret_value;
 } /* SDsetrange */
 
-#ifdef MFSD_INTERNAL
 /******************************************************************************
  NAME
-    SDIapfromid -- get the attribute list
+    SDsetautorange -- keep the range of the values written to an SDS
 
  DESCRIPTION
-    Given a ID figure out what the handle and attribute
-    list pointer are for that object.
+    With 'flag' TRUE, the least and greatest values written to the SDS
+    with SDwritedata() and SDwritechunk() from now on are kept, the fill
+    value and NaNs left out, along with the number of fill values
+    written.  They are computed on the user's buffer in the write path,
+    just before it is converted, so the data is not read again for them.
+    SDendaccess() stores them as the valid range, as SDsetrange() would,
+    if any value other than the fill value was written.
+
+    Calling it again with TRUE starts over; FALSE stops keeping the range
+    and nothing is stored.  Data written before is not looked at.
 
  RETURNS
-     On error FAIL else SUCCEED.
+    SUCCEED/FAIL
 
 ******************************************************************************/
 intn
-SDIapfromid(int32       id,      /* IN:  object ID */
-            NC        **handlep, /* IN:  handle for this file */
-            NC_array ***app /* OUT: attribute list */)
+SDsetautorange(int32 sdsid, /* IN: dataset ID */
+               intn  flag /* IN: TRUE to keep the range, FALSE to stop */)
 {
     NC     *handle    = NULL;
     NC_var *var       = NULL;
-    NC_dim *dim       = NULL;
-    int32   varid     = -1;
     intn    ret_value = SUCCEED;
 
-    /* see if its a variable ID */
-    handle = SDIhandle_from_id(id, SDSTYPE);
-    if (handle != NULL) {
-        /* find the variable */
-        var = SDIget_var(handle, id);
-        if (var == NULL) {
-            HGOTO_ERROR(DFE_ARGS, FAIL);
-        }
+    /* clear error stack */
+    HEclear();
 
-        (*app)     = &(var->attrs);
-        (*handlep) = handle;
-        HGOTO_DONE(SUCCEED);
-    }
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* see if its a file ID */
-    handle = SDIhandle_from_id(id, CDFTYPE);
-    if (handle != NULL) {
-        (*app)     = &(handle->attrs);
-        (*handlep) = handle;
-        HGOTO_DONE(SUCCEED);
-    }
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* see if its a dimension ID */
-    handle = SDIhandle_from_id(id, DIMTYPE);
-    if (handle != NULL) {
-        /* find the dimension */
-        dim = SDIget_dim(handle, id);
+    var->autorange   = (flag ? TRUE : FALSE);
+    var->range_set   = FALSE;
+    var->range_nfill = 0;
 
-        /* the ID is neither file, data set, nor dimension ID */
-        if (dim == NULL) {
+done:
+    return ret_value;
+} /* SDsetautorange */
+
+/******************************************************************************
+ NAME
+    SDgetautorange -- get the range kept since SDsetautorange()
+
+ DESCRIPTION
+    Returns in 'pmax' and 'pmin' the greatest and least values written to
+    the SDS since SDsetautorange(), in the number type of the SDS as with
+    SDgetrange(), and in 'nfill' the number of fill values written, if
+    not NULL.
+
+ RETURNS
+    SUCCEED, or FAIL if the range is not kept or only fill values were
+    written
+
+******************************************************************************/
+intn
+SDgetautorange(int32  sdsid, /* IN:  dataset ID */
+               void  *pmax,  /* OUT: greatest value written */
+               void  *pmin,  /* OUT: least value written */
+               int32 *nfill /* OUT: number of fill values written */)
+{
+    NC     *handle    = NULL;
+    NC_var *var       = NULL;
+    intn    ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    if (pmax == NULL || pmin == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL || !var->autorange)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (nfill != NULL)
+        *nfill = var->range_nfill;
+
+    if (NC_range_get(var, pmax, pmin) == FAIL)
+        HGOTO_ERROR(DFE_NOVALS, FAIL);
+
+done:
+    return ret_value;
+} /* SDgetautorange */
+
+#ifdef MFSD_INTERNAL
+/******************************************************************************
+ NAME
+    SDIapfromid -- get the attribute list
+
+ DESCRIPTION
+    Given a ID figure out what the handle and attribute
+    list pointer are for that object.
+
+ RETURNS
+     On error FAIL else SUCCEED.
+
+******************************************************************************/
+intn
+SDIapfromid(int32       id,      /* IN:  object ID */
+            NC        **handlep, /* IN:  handle for this file */
+            NC_array ***app /* OUT: attribute list */)
+{
+    NC     *handle    = NULL;
+    NC_var *var       = NULL;
+    NC_dim *dim       = NULL;
+    int32   varid     = -1;
+    intn    ret_value = SUCCEED;
+
+    /* see if its a variable ID */
+    handle = SDIhandle_from_id(id, SDSTYPE);
+    if (handle != NULL) {
+        /* find the variable */
+        var = SDIget_var(handle, id);
+        if (var == NULL) {
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+        }
+
+        (*app)     = &(var->attrs);
+        (*handlep) = handle;
+        HGOTO_DONE(SUCCEED);
+    }
+
+    /* see if its a file ID */
+    handle = SDIhandle_from_id(id, CDFTYPE);
+    if (handle != NULL) {
+        (*app)     = &(handle->attrs);
+        (*handlep) = handle;
+        HGOTO_DONE(SUCCEED);
+    }
+
+    /* see if its a dimension ID */
+    handle = SDIhandle_from_id(id, DIMTYPE);
+    if (handle != NULL) {
+        /* find the dimension */
+        dim = SDIget_dim(handle, id);
+
+        /* the ID is neither file, data set, nor dimension ID */
+        if (dim == NULL) {
             HGOTO_ERROR(DFE_ARGS, FAIL);
         }
 
@@ -1823,6 +2807,82 @@ done:
     return ret_value;
 } /* SDreadattr */
 
+/******************************************************************************
+ NAME
+    SDreadallattrs -- read all the attributes of an object at once
+
+ DESCRIPTION
+    Read the name, number type, count and values of every attribute of
+    the file, dataset or dimension given into attrs[0..max_attrs-1],
+    with the names and values packed into the caller's arena.  Each
+    attribute's values are 8-byte aligned and followed by its name.
+
+    On entry *arena_size is the size of the arena; on return it is the
+    size needed to hold all the attributes.  Attributes are placed in
+    index order until one does not fit; the name and values of the
+    entries that did not fit are set to NULL.  Calling with a NULL arena
+    (and attrs) returns the number of attributes and the arena size
+    needed, so the caller can size both in one call.
+
+ RETURNS
+    The number of attributes of the object, or FAIL.
+
+******************************************************************************/
+int32
+SDreadallattrs(int32       id,         /* IN:  object ID */
+               hdf_attr_t *attrs,      /* OUT: attribute entries */
+               int32       max_attrs,  /* IN:  # of entries of attrs */
+               void       *arena,      /* OUT: arena for the names and values */
+               int32      *arena_size /* IN/OUT: size of the arena */)
+{
+    NC_array   *ap     = NULL;
+    NC_array  **app    = NULL;
+    NC_attr   **atp    = NULL;
+    NC         *handle = NULL;
+    hdf_attr_t  extra; /* entry for the attributes past max_attrs */
+    hdf_attr_t *attr;
+    char        name[H4_MAX_NC_NAME + 1];
+    int32       used = 0;
+    int32       size;
+    unsigned    ii;
+    int32       ret_value = 0;
+
+    /* clear error stack */
+    HEclear();
+
+    /* sanity check args */
+    if (arena_size == NULL || max_attrs < 0 || (attrs == NULL && max_attrs > 0))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* determine what type of ID we've been given */
+    if (SDIapfromid(id, &handle, &app) == FAIL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* the attributes are all in memory already; just pack them */
+    ap = (*app);
+    if (ap != NULL) {
+        atp = (NC_attr **)ap->values;
+        for (ii = 0; ii < ap->count; ii++, atp++) {
+            if (*atp == NULL)
+                HGOTO_ERROR(DFE_ARGS, FAIL);
+
+            /* the ones past max_attrs are only counted in the arena size */
+            attr = ((int32)ii < max_attrs) ? &attrs[ii] : &extra;
+            memcpy(name, (*atp)->name->values, (*atp)->name->len);
+            name[(*atp)->name->len] = '\0';
+            size = (int32)((*atp)->data->count * (*atp)->data->szof);
+            if (HDarena_attr(attr, (attr == &extra) ? NULL : arena, *arena_size, &used, name,
+                             (*atp)->HDFtype, (int32)(*atp)->data->count, size))
+                memcpy(attr->values, (*atp)->data->values, (size_t)size);
+        }
+        ret_value = (int32)ap->count;
+    }
+    *arena_size = used;
+
+done:
+    return ret_value;
+} /* SDreadallattrs */
+
 /******************************************************************************
  NAME
     SDwritedata -- write a hyperslab of data
@@ -1890,6 +2950,10 @@ SDwritedata(int32  sdsid,  /* IN: dataset ID */
     if (var == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
+    /* records appended with SDappend() go first, they may be overwritten */
+    if (var->app_nrecs > 0 && SDIflush_append(var) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
     /* Check if compression method is enabled */
 
     /* Make sure that the file is an HDF file before checking about compression */
@@ -2418,6 +3482,41 @@ done:
 } /* SDgetcal */
 
 #ifdef MFSD_INTERNAL
+/******************************************************************************
+ NAME
+    SDIfindcoordvar -- find the coordinate variable of a dimension
+
+ DESCRIPTION
+    Looks up the rank 1 variable named after the dimension in the name
+    index of the variables, see NC_findname(), rather than comparing the
+    name of every variable of the file.  In HDF files, the variable must
+    also be a coordinate variable, or of unknown kind if it was created
+    prior to the fix of bugzilla 624; netCDF files make no such
+    distinction (bugz 1644).
+
+ RETURNS
+    The index of the variable, or FAIL if the dimension has none
+
+******************************************************************************/
+static int
+SDIfindcoordvar(NC     *handle, /* IN: file handle */
+                NC_dim *dim /* IN: dimension to find coord var of */)
+{
+    NC_var *var;
+    int     ii;
+
+    for (ii = NC_findname(handle->vars, dim->name->values, -1); ii != -1;
+         ii = NC_findname(handle->vars, dim->name->values, ii)) {
+        var = ((NC_var **)handle->vars->values)[ii];
+
+        /* eliminate vars with rank > 1, coord vars only have rank 1 */
+        if (var->assoc->count == 1 &&
+            (handle->file_type != HDF_FILE || var->var_type == IS_CRDVAR || var->var_type == UNKNOWN))
+            return ii;
+    }
+    return FAIL;
+} /* SDIfindcoordvar */
+
 /******************************************************************************
  NAME
     SDgetcoordvar -- get index of coordinate variable
@@ -2442,8 +3541,7 @@ SDIgetcoordvar(NC     *handle, /* IN: file handle */
                int32   id,     /* IN: dimension ID */
                int32   nt /* IN: number type to use if new variable*/)
 {
-    unsigned   ii;
-    unsigned   len;
+    int        ii;
     nc_type    nctype;
     intn       dimindex;
     NC_string *name      = NULL;
@@ -2453,42 +3551,35 @@ SDIgetcoordvar(NC     *handle, /* IN: file handle */
 
     /* look for a variable with the same name */
     name = dim->name;
-    len  = dim->name->len;
-    dp   = (NC_var **)handle->vars->values;
-    for (ii = 0; ii < handle->vars->count; ii++, dp++) {
-        /* eliminate vars with rank > 1, coord vars only have rank 1 */
-        if ((*dp)->assoc->count == 1)
-            if (len == (*dp)->name->len && strncmp(name->values, (*dp)->name->values, (size_t)len) == 0)
-                /* only proceed if the file is a netCDF file (bugz 1644)
-                or if this variable is a coordinate var or when
-                the status is unknown due to its being created prior to
-                the fix of bugzilla 624 - BMR 05/14/2007 */
-                if ((handle->file_type != HDF_FILE) || (*dp)->var_type == IS_CRDVAR ||
-                    (*dp)->var_type == UNKNOWN) {
-                    /* see if we need to change the number type */
-                    if ((nt != 0) && (nt != (*dp)->type)) {
-                        if (((*dp)->type = hdf_unmap_type((int)nt)) == FAIL) {
-                            HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                        }
+    ii   = SDIfindcoordvar(handle, dim);
+    if (ii != FAIL) {
+        dp = (NC_var **)handle->vars->values + ii;
 
-                        (*dp)->HDFtype = nt;
-                        (*dp)->cdf     = handle;
-                        /* don't forget to reset the sizes  */
-                        (*dp)->szof = NC_typelen((*dp)->type);
-                        if (FAIL == ((*dp)->HDFsize = DFKNTsize(nt))) {
-                            HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                        }
+        /* see if we need to change the number type */
+        if ((nt != 0) && (nt != (*dp)->type)) {
+            if (((*dp)->type = hdf_unmap_type((int)nt)) == FAIL) {
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+            }
 
-                        /* recompute all of the shape information */
-                        /* BUG: this may be a memory leak ??? */
-                        if (NC_var_shape((*dp), handle->dims) == -1) {
-                            HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                        }
-                    }
+            (*dp)->HDFtype = nt;
+            (*dp)->cdf     = handle;
+            (*dp)->flushed = FALSE;
+            NC_free_scale(*dp);
+            /* don't forget to reset the sizes  */
+            (*dp)->szof = NC_typelen((*dp)->type);
+            if (FAIL == ((*dp)->HDFsize = DFKNTsize(nt))) {
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+            }
 
-                    /* found it? */
-                    HGOTO_DONE((int32)ii);
-                }
+            /* recompute all of the shape information */
+            /* BUG: this may be a memory leak ??? */
+            if (NC_var_shape((*dp), handle->dims) == -1) {
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+            }
+        }
+
+        /* found it? */
+        HGOTO_DONE((int32)ii);
     }
 
     /* create a new var with this dim as only coord */
@@ -2763,6 +3854,7 @@ SDgetdimscale(int32 id, /* IN:  dimension ID */
     intn    varid = -1;
     long    start[1];
     long    end[1];
+    size_t  nbytes;
     intn    ret_value = SUCCEED;
 
     /* this decides how a dataset with unlimited dimension is read along the
@@ -2796,22 +3888,24 @@ SDgetdimscale(int32 id, /* IN:  dimension ID */
         HGOTO_ERROR(DFE_ARGS, FAIL);
     }
 
+    vp = ((NC_var **)handle->vars->values)[varid];
+
     /* store the data */
     handle->xdrs->x_op = XDR_DECODE;
     start[0]           = 0;
     if (dim->size != 0)
         end[0] = dim->size;
-    else {
-        if (handle->file_type != HDF_FILE)
-            end[0] = handle->numrecs;
-        else {
-            vp = SDIget_var(handle, varid);
-            if (vp == NULL) {
-                HGOTO_ERROR(DFE_ARGS, FAIL);
-            }
+    else if (handle->file_type != HDF_FILE)
+        end[0] = handle->numrecs;
+    else
+        end[0] = vp->numrecs;
 
-            end[0] = vp->numrecs;
-        }
+    /* the values read last time, unless the variable was written to since
+       or, for the unlimited dimension, records were added */
+    nbytes = (size_t)end[0] * vp->szof;
+    if (vp->scale_buf != NULL && vp->scale_count == end[0]) {
+        memcpy(data, vp->scale_buf, nbytes);
+        HGOTO_DONE(SUCCEED);
     }
 
     status = NCvario(handle, varid, start, end, (Void *)data);
@@ -2819,6 +3913,13 @@ SDgetdimscale(int32 id, /* IN:  dimension ID */
         HGOTO_ERROR(DFE_ARGS, FAIL);
     }
 
+    /* keep the values for the next call, small scales only */
+    NC_free_scale(vp);
+    if (nbytes > 0 && nbytes <= SD_SCALE_CACHE_MAX && (vp->scale_buf = malloc(nbytes)) != NULL) {
+        memcpy(vp->scale_buf, data, nbytes);
+        vp->scale_count = end[0];
+    }
+
 done:
     /* free the AID */
     status = SDIfreevarAID(handle, varid);
@@ -2851,12 +3952,11 @@ SDdiminfo(int32  id,   /* IN:  dimension ID */
           int32 *nt,   /* OUT: number type of scales */
           int32 *nattr /* OUT: the number of local attributes */)
 {
-    NC      *handle = NULL;
-    NC_dim  *dim    = NULL;
-    NC_var **dp     = NULL;
-    intn     ii;
-    intn     len;
-    int      ret_value = SUCCEED;
+    NC     *handle = NULL;
+    NC_dim *dim    = NULL;
+    NC_var *vp     = NULL;
+    int     ii;
+    int     ret_value = SUCCEED;
 
     /* clear error stack */
     HEclear();
@@ -2886,8 +3986,6 @@ SDdiminfo(int32  id,   /* IN:  dimension ID */
         memcpy(name, dim->name->values, dim->name->len);
         name[dim->name->len] = '\0';
     }
-    else
-        name = dim->name->values;
 
     /* Get dimension's size, which is the one application provided at SDcreate.
        Application must use SDgetinfo to get current size of unlimited dim */
@@ -2900,34 +3998,17 @@ SDdiminfo(int32  id,   /* IN:  dimension ID */
     /* In HDF files, number type and attribute info are only stored in the
        coordinate var of the dimension; so, if there is no coord var associated
        with the dimension being inquired, these info will not be available. */
-    if (handle->vars) {
-        len = dim->name->len;
-        dp  = (NC_var **)handle->vars->values;
-        for (ii = 0; ii < handle->vars->count; ii++, dp++) {
-            /* eliminate vars with rank > 1, coord vars only have rank 1 */
-            if ((*dp)->assoc->count == 1) {
-                /* check if this variable matches the searched name */
-                if (len == (*dp)->name->len && strncmp(name, (*dp)->name->values, (*dp)->name->len) == 0) {
-                    if (handle->file_type == HDF_FILE) /* HDF file */
-                    {
-                        /* only proceed if this variable is a coordinate var or
-                        when its status is unknown due to its being created
-                        prior to the fix of bugzilla 624 - BMR - 05/14/2007 */
-                        if ((*dp)->var_type == IS_CRDVAR || (*dp)->var_type == UNKNOWN) {
-                            *nt    = ((*dp)->numrecs ? (*dp)->HDFtype : 0);
-                            *nattr = ((*dp)->attrs ? (*dp)->attrs->count : 0);
-                            HGOTO_DONE(ret_value);
-                        }
-                    }
-                    else /* netCDF file */
-                    {
-                        *nt    = (*dp)->HDFtype;
-                        *nattr = ((*dp)->attrs ? (*dp)->attrs->count : 0);
-                        HGOTO_DONE(ret_value);
-                    }
-                } /* name matched */
-            }     /* rank = 1 */
+    if (handle->vars && (ii = SDIfindcoordvar(handle, dim)) != FAIL) {
+        vp = ((NC_var **)handle->vars->values)[ii];
+        if (handle->file_type == HDF_FILE) /* HDF file */
+        {
+            if (hdf_read_var_attrs(handle, vp) == FAIL)
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+            *nt = (vp->numrecs ? vp->HDFtype : 0);
         }
+        else /* netCDF file */
+            *nt = vp->HDFtype;
+        *nattr = (vp->attrs ? vp->attrs->count : 0);
     }
 done:
     return ret_value;
@@ -3012,6 +4093,8 @@ SDgetdimstrs(int32 id, /* IN:  dataset ID */
     }
 
     if (var != NULL) {
+        if (hdf_read_var_attrs(handle, var) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
         if (l) {
             attr = (NC_attr **)NC_findattr(&(var->attrs), _HDF_LongName);
             if (attr != NULL) {
@@ -3498,6 +4581,11 @@ SDsetnbitdataset(int32 id,        /* IN: dataset ID */
         HGOTO_ERROR(DFE_ARGS, FAIL);
     }
 
+    /* n-bit coding does not take shuffled bytes */
+    if (var->shuffle) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
     /* set up n-bit parameters */
     c_info.nbit.nt        = var->HDFtype;
     c_info.nbit.sign_ext  = sign_ext;
@@ -3590,6 +4678,32 @@ done:
     return (ret_value);
 }
 #endif
+/* Fill in the number type of the dataset for the lossy coder, which takes
+   32- and 64-bit floating-point data only */
+static intn
+SDIsetup_lossy(NC_var *var, comp_info *c_info)
+{
+    c_info->lossy.nt = var->HDFtype;
+    return HCPclossy_check_parms(c_info);
+} /* SDIsetup_lossy */
+
+/* Whether the bytes of the elements can be shuffled ahead of a coder,
+   which is the case for the coders that take the data as plain bytes */
+static intn
+SDIshuffle_coder(comp_coder_t comp_type)
+{
+    switch (comp_type) {
+        case COMP_CODE_RLE:
+        case COMP_CODE_SKPHUFF:
+        case COMP_CODE_DEFLATE:
+        case COMP_CODE_ZSTD:
+        case COMP_CODE_LZ4:
+            return TRUE;
+        default:
+            return FALSE;
+    }
+} /* SDIshuffle_coder */
+
 /******************************************************************************
  NAME
     SDsetcompress -- Create/convert a dataset to compressed representation
@@ -3598,7 +4712,8 @@ done:
     Specify a compression scheme for an SD dataset.
 
     Valid compression types available for this interface are listed in
-    hcomp.h as COMP_nnnn.
+    hcomp.h as COMP_nnnn.  The bytes of the elements are shuffled before
+    they are compressed if SDsetshuffle() was called first.
 
     IMPORTANT:  This will only work on datasets stored in HDF files.
 
@@ -3625,7 +4740,8 @@ SDsetcompress(int32        id,        /* IN: dataset ID */
     /* clear error stack */
     HEclear();
 
-    if (comp_type < COMP_CODE_NONE || comp_type >= COMP_CODE_INVALID) {
+    if ((comp_type < COMP_CODE_NONE || comp_type >= COMP_CODE_INVALID) && comp_type != COMP_CODE_ZSTD &&
+        comp_type != COMP_CODE_LZ4 && comp_type != COMP_CODE_LOSSY && comp_type < COMP_CODE_PLUGIN_MIN) {
         HGOTO_ERROR(DFE_ARGS, FAIL);
     }
 
@@ -3687,6 +4803,19 @@ SDsetcompress(int32        id,        /* IN: dataset ID */
     }
 #endif /* H4_HAVE_LIBSZ          */
 
+    /* the lossy coder needs the number type, and takes floats only */
+    if (comp_type == COMP_CODE_LOSSY && SDIsetup_lossy(var, &c_info_x) == FAIL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* shuffle the bytes of the elements if SDsetshuffle() asked for it */
+    if (var->shuffle) {
+        if (!SDIshuffle_coder(comp_type)) {
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+        }
+        m_info.shuffle.elem_size = var->HDFsize;
+    }
+
     if (!var->data_ref) { /* doesn't exist */
 
         /* element doesn't exist so we need a reference number */
@@ -3696,8 +4825,9 @@ SDsetcompress(int32        id,        /* IN: dataset ID */
         }
     } /* end if */
 
-    status = (intn)HCcreate(handle->hdf_file, (uint16)DATA_TAG, (uint16)var->data_ref, COMP_MODEL_STDIO,
-                            &m_info, comp_type, &c_info_x);
+    status = (intn)HCcreate(handle->hdf_file, (uint16)DATA_TAG, (uint16)var->data_ref,
+                            var->shuffle ? COMP_MODEL_SHUFFLE : COMP_MODEL_STDIO, &m_info, comp_type,
+                            &c_info_x);
 
     if (status != FAIL) {
         if (var && (var->aid != 0) && (var->aid != FAIL)) {
@@ -3739,98 +4869,204 @@ done:
     return ret_value;
 } /* SDsetcompress */
 
-#ifndef H4_NO_DEPRECATED_SYMBOLS
-
 /******************************************************************************
  NAME
-    SDgetcompress -- Retrieves compression information of a dataset
+    SDsetshuffle -- Shuffle the bytes of a dataset before compressing it
 
  DESCRIPTION
-    This routine uses HCPgetcompress to retrieve the compression type
-    and the compression information of the identified dataset.
+    With 'shuffle' TRUE, the compression later set up by SDsetcompress() or
+    SDsetchunk() stores the bytes of the elements regrouped by significance:
+    the first byte of every element, then the second byte, and so on.  The
+    high bytes of floating-point and wide integer data change slowly, so
+    the compressed data is usually much smaller.  The data reads back as
+    it was written, through the same calls as before.
+
+    Only the RLE, skipping Huffman, deflate, zstd and LZ4 coders take
+    shuffled data, SDsetcompress() and SDsetchunk() fail with the others.
+    A dataset that is not chunked has to be written in one pass from its
+    beginning once its bytes are shuffled.  Chunks with shuffled bytes
+    are coded serially, whatever SDsetchunkthreads() was given.
+
+    The files written cannot be read by HDF libraries without the shuffle
+    model.
 
  RETURNS
     SUCCEED/FAIL
 
- MODIFICATION
-    July 2001: Added to fix bug #307 - BMR
-    Apr 2005:  This function has incorrect behavior and is replaced by
-        SDgetcompinfo.  SDgetcompress will be removed in the future.
-
 ******************************************************************************/
 intn
-SDgetcompress(
-    int32         id,        /* IN: dataset ID */
-    comp_coder_t *comp_type, /* OUT: the type of compression */
-    comp_info    *c_info /* OUT: ptr to compression information structure for storing the retrieved info */
-)
+SDsetshuffle(int32 id,     /* IN: dataset ID */
+             intn  shuffle /* IN: whether to shuffle the bytes */)
 {
     NC     *handle;
     NC_var *var       = NULL;
-    intn    status    = FAIL;
     intn    ret_value = SUCCEED;
 
     /* clear error stack */
     HEclear();
 
-    if (comp_type == NULL || c_info == NULL)
-        HGOTO_ERROR(DFE_ARGS, FAIL);
-
     handle = SDIhandle_from_id(id, SDSTYPE);
-    if (handle == NULL || handle->file_type != HDF_FILE)
-        HGOTO_ERROR(DFE_ARGS, FAIL);
-    if (handle->vars == NULL)
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
         HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
 
     var = SDIget_var(handle, id);
-    if (var == NULL)
-        HGOTO_ERROR(DFE_ARGS, FAIL);
-
-    if (!var->data_ref)
+    if (var == NULL) {
         HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
 
-    /* use lower-level routine to get the compression information */
-    status = HCPgetcompress(handle->hdf_file, var->data_tag, var->data_ref, comp_type, c_info);
-    if (status == FAIL)
-        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    var->shuffle = shuffle ? TRUE : FALSE;
 
 done:
     return ret_value;
-} /* SDgetcompress */
-
-#endif /* H4_NO_DEPRECATED_SYMBOLS */
+} /* SDsetshuffle */
 
 /******************************************************************************
  NAME
-    SDgetcompinfo -- Retrieves compression information of a dataset
+    SDgetshuffle -- Whether the bytes of a dataset are shuffled
 
  DESCRIPTION
-    This routine uses HCPgetcompinfo to retrieve the compression type
-    and the compression information of the identified dataset.
+    Sets 'shuffle' to TRUE if the data of the dataset was compressed with
+    its bytes shuffled, see SDsetshuffle(), and to FALSE otherwise.  For
+    a dataset without data the setting of SDsetshuffle() is returned.
 
  RETURNS
     SUCCEED/FAIL
 
- MODIFICATION
-    July 2001: Added to fix bug #307 - BMR (from SDgetcompress)
-    Apr 2005:  This function was actually created at this time, but it is
-        almost a duplicate of SDgetcompress, which is intended to be
-        removed in the future, due to its incorrect behavior.  The
-        only difference is the call to the low-level routine,
-        HCPgetcompinfo, instead of HCPgetcompress.
-
 ******************************************************************************/
 intn
-SDgetcompinfo(int32         sdsid,     /* IN: dataset ID */
-              comp_coder_t *comp_type, /* OUT: the type of compression */
-              comp_info    *c_info     /* OUT: ptr to compression information
-         structure for storing the retrieved info */
-)
+SDgetshuffle(int32 id,      /* IN: dataset ID */
+             intn *shuffle /* OUT: whether the bytes are shuffled */)
 {
-    NC     *handle;
-    NC_var *var       = NULL;
-    intn    status    = FAIL;
-    intn    ret_value = SUCCEED;
+    NC          *handle;
+    NC_var      *var = NULL;
+    comp_model_t model_type;
+    intn         ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    if (shuffle == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    handle = SDIhandle_from_id(id, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    var = SDIget_var(handle, id);
+    if (var == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    if (!var->data_ref) {
+        *shuffle = var->shuffle;
+        HGOTO_DONE(SUCCEED);
+    }
+
+    /* use lower-level routine to get the modeling type */
+    if (HCPgetcompmodel(handle->hdf_file, var->data_tag, var->data_ref, &model_type) == FAIL) {
+        HGOTO_ERROR(DFE_COMPINFO, FAIL);
+    }
+    *shuffle = (model_type == COMP_MODEL_SHUFFLE) ? TRUE : FALSE;
+
+done:
+    return ret_value;
+} /* SDgetshuffle */
+
+#ifndef H4_NO_DEPRECATED_SYMBOLS
+
+/******************************************************************************
+ NAME
+    SDgetcompress -- Retrieves compression information of a dataset
+
+ DESCRIPTION
+    This routine uses HCPgetcompress to retrieve the compression type
+    and the compression information of the identified dataset.
+
+ RETURNS
+    SUCCEED/FAIL
+
+ MODIFICATION
+    July 2001: Added to fix bug #307 - BMR
+    Apr 2005:  This function has incorrect behavior and is replaced by
+        SDgetcompinfo.  SDgetcompress will be removed in the future.
+
+******************************************************************************/
+intn
+SDgetcompress(
+    int32         id,        /* IN: dataset ID */
+    comp_coder_t *comp_type, /* OUT: the type of compression */
+    comp_info    *c_info /* OUT: ptr to compression information structure for storing the retrieved info */
+)
+{
+    NC     *handle;
+    NC_var *var       = NULL;
+    intn    status    = FAIL;
+    intn    ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    if (comp_type == NULL || c_info == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    handle = SDIhandle_from_id(id, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (handle->vars == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    var = SDIget_var(handle, id);
+    if (var == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (!var->data_ref)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* use lower-level routine to get the compression information */
+    status = HCPgetcompress(handle->hdf_file, var->data_tag, var->data_ref, comp_type, c_info);
+    if (status == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+done:
+    return ret_value;
+} /* SDgetcompress */
+
+#endif /* H4_NO_DEPRECATED_SYMBOLS */
+
+/******************************************************************************
+ NAME
+    SDgetcompinfo -- Retrieves compression information of a dataset
+
+ DESCRIPTION
+    This routine uses HCPgetcompinfo to retrieve the compression type
+    and the compression information of the identified dataset.
+
+ RETURNS
+    SUCCEED/FAIL
+
+ MODIFICATION
+    July 2001: Added to fix bug #307 - BMR (from SDgetcompress)
+    Apr 2005:  This function was actually created at this time, but it is
+        almost a duplicate of SDgetcompress, which is intended to be
+        removed in the future, due to its incorrect behavior.  The
+        only difference is the call to the low-level routine,
+        HCPgetcompinfo, instead of HCPgetcompress.
+
+******************************************************************************/
+intn
+SDgetcompinfo(int32         sdsid,     /* IN: dataset ID */
+              comp_coder_t *comp_type, /* OUT: the type of compression */
+              comp_info    *c_info     /* OUT: ptr to compression information
+         structure for storing the retrieved info */
+)
+{
+    NC     *handle;
+    NC_var *var       = NULL;
+    intn    status    = FAIL;
+    intn    ret_value = SUCCEED;
 
     /* clear error stack */
     HEclear();
@@ -3977,12 +5213,23 @@ SDgetdatasize(int32  sdsid,     /* IN: dataset ID */
     if (var == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
+    /* records appended with SDappend() count once they are written */
+    if (var->app_nrecs > 0 && SDIflush_append(var) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
     /* if the data ref# of the SDS is 0, it indicates that the SDS has
     not been written with data because no storage is created
     for the SDS data */
     if (var->data_ref == 0) {
         *comp_size_tmp = *orig_size_tmp = 0;
     }
+    /* a chunked SDS that is open has its chunk table in memory, the
+       sizes are taken from there without reading the chunk headers again */
+    else if (SDIopen_chunked(var)) {
+        status = HMCgetChunkSizes(var->aid, comp_size_tmp, orig_size_tmp);
+        if (status == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    }
     else {
         /* use lower-level routine to get the data sizes */
         status = HCPgetdatasize(handle->hdf_file, var->data_tag, var->data_ref, comp_size_tmp, orig_size_tmp);
@@ -4338,6 +5585,155 @@ done:
     return ret_value;
 } /* SDsetaccesstype */
 
+/******************************************************************************
+ NAME
+    SDsetsievebuf -- set the size of the sieve buffer of an SDS
+
+ DESCRIPTION
+    Reads of fewer than 'nbytes' bytes of the data of a contiguous SDS
+    read 'nbytes' bytes into a buffer kept with the dataset, and the
+    following small reads that fall within these bytes are served from
+    it, see Hsetsievebuf().  0 turns the buffer off, which is the default.
+    Chunked, compressed and other special SDSs are not affected.
+
+ RETURNS
+    SUCCEED/FAIL
+
+******************************************************************************/
+intn
+SDsetsievebuf(int32 sdsid, /* IN: dataset ID */
+              int32 nbytes /* IN: size of the sieve buffer in bytes, 0 for none */)
+{
+    NC     *handle    = NULL;
+    NC_var *var       = NULL;
+    intn    ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    if (nbytes < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (handle->vars == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* Kept for when the data is attached to again */
+    var->sieve_size = nbytes;
+
+    if (var->aid != FAIL && Hsetsievebuf(var->aid, nbytes) == FAIL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+done:
+    return ret_value;
+} /* SDsetsievebuf */
+
+/******************************************************************************
+ NAME
+    SDprefetch -- announce a read of a slab of an SDS
+
+ DESCRIPTION
+    Tells the system that the file blocks holding the slab given by
+    'start' and 'edges' will be read soon, so that they are read from
+    disk in the background while the application goes on, and the
+    SDreaddata() of the slab later finds them in memory, see Hprefetch().
+    For a chunked SDS the blocks of the chunks the slab touches are
+    announced, unless they are in the chunk cache already.  Nothing is
+    read, decoded or converted here, and an SDS with no data written is
+    left alone.
+
+ RETURNS
+    SUCCEED/FAIL
+
+******************************************************************************/
+intn
+SDprefetch(int32  sdsid, /* IN: dataset ID */
+           int32 *start, /* IN: coords of starting point */
+           int32 *edges /* IN: number of values along each dimension */)
+{
+    NC     *handle  = NULL;
+    NC_var *var     = NULL;
+    int32  *offsets = NULL; /* element offset of each row of the slab */
+    int32  *lengths = NULL; /* bytes of each row of the slab */
+    int32   idx[H4_MAX_VAR_DIMS];
+    int32   nruns = 1;
+    int32   offset, r;
+    int     rank, i;
+    intn    ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    if (start == NULL || edges == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (handle->vars == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* the slab must be in the SDS, past its records along an unlimited
+       dimension it is fill values */
+    rank = (int)var->assoc->count;
+    for (i = 0; i < rank; i++) {
+        if (start[i] < 0 || edges[i] < 1)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+        if ((i > 0 || !IS_RECVAR(var)) && (unsigned long)(start[i] + edges[i]) > var->shape[i])
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+        if (i < rank - 1)
+            nruns *= edges[i];
+    }
+
+    /* nothing written yet */
+    if (var->data_ref == 0)
+        HGOTO_DONE(SUCCEED);
+
+    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* one run of bytes per row of the slab */
+    if ((offsets = (int32 *)malloc((size_t)nruns * sizeof(int32))) == NULL ||
+        (lengths = (int32 *)malloc((size_t)nruns * sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    for (i = 0; i < rank; i++)
+        idx[i] = start[i];
+    for (r = 0; r < nruns; r++) {
+        for (offset = 0, i = 0; i < rank; i++)
+            offset = offset * (i > 0 ? (int32)var->shape[i] : 1) + idx[i];
+        offsets[r] = offset * var->HDFsize + (var->data_offset > 0 ? var->data_offset : 0);
+        lengths[r] = edges[rank - 1] * var->HDFsize;
+
+        /* next row */
+        for (i = rank - 2; i >= 0; i--) {
+            if (++idx[i] < start[i] + edges[i])
+                break;
+            idx[i] = start[i];
+        }
+    }
+
+    if (Hprefetch(var->aid, nruns, offsets, lengths) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+done:
+    free(offsets);
+    free(lengths);
+    return ret_value;
+} /* SDprefetch */
+
 /******************************************************************************
  NAME
     SDsetblocksize -- set the size of the linked blocks created.
@@ -4382,6 +5778,100 @@ done:
     return ret_value;
 } /* SDsetblocksize */
 
+/******************************************************************************
+ NAME
+    SDappend -- append records to a dataset with an unlimited dimension
+
+ DESCRIPTION
+    Copies 'nrecords' records into a buffer kept with the dataset, which
+    is written after the last record of the dataset when it is full, see
+    SDIflush_append().  The buffer starts at the block size, or at
+    APPEND_BUF_SIZE bytes, and doubles with each flush up to MAX_APPEND_BUF
+    bytes.  A dataset that has no data yet gets linked blocks the size of
+    the buffer, unless SDsetblocksize() was called.
+
+ RETURNS
+    SUCCEED/FAIL
+
+******************************************************************************/
+intn
+SDappend(int32       sdsid,    /* IN: dataset ID */
+         int32       nrecords, /* IN: number of records to append */
+         const void *data /* IN: the records */)
+{
+    NC          *handle = NULL;
+    NC_var      *var    = NULL;
+    const uint8 *bufp   = (const uint8 *)data;
+    int32        rec_size;     /* bytes of one record in memory */
+    int32        nrecs;        /* records copied at a time */
+    int32        bytes;        /* size of the buffer in bytes */
+    void        *new_buf;
+    intn         i;
+    intn         ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    if (nrecords < 0 || (nrecords > 0 && data == NULL))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (!(handle->flags & NC_RDWR))
+        HGOTO_ERROR(DFE_BADACC, FAIL);
+    if (handle->vars == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL || !IS_RECVAR(var))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    rec_size = DFKNTsize(var->HDFtype | DFNT_NATIVE);
+    for (i = 1; i < var->assoc->count; i++)
+        rec_size *= (int32)var->shape[i];
+    if (rec_size <= 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* set up the buffer on the first call */
+    if (var->app_buf == NULL) {
+        bytes        = var->block_size > 0 ? var->block_size : APPEND_BUF_SIZE;
+        var->app_max = MAX(1, bytes / rec_size);
+        var->app_buf = malloc((size_t)var->app_max * (size_t)rec_size);
+        if (var->app_buf == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        var->app_nrecs = 0;
+    }
+    var->app_id = sdsid;
+
+    while (nrecords > 0) {
+        nrecs = MIN(nrecords, var->app_max - var->app_nrecs);
+        memcpy((uint8 *)var->app_buf + (size_t)var->app_nrecs * (size_t)rec_size, bufp,
+               (size_t)nrecs * (size_t)rec_size);
+        var->app_nrecs += nrecs;
+        bufp += (size_t)nrecs * (size_t)rec_size;
+        nrecords -= nrecs;
+
+        if (var->app_nrecs < var->app_max)
+            break;
+
+        if (SDIflush_append(var) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+        /* a steady stream of records is written in larger pieces */
+        if (var->app_max <= MAX_APPEND_BUF / 2 / rec_size) {
+            new_buf = realloc(var->app_buf, (size_t)var->app_max * 2 * (size_t)rec_size);
+            if (new_buf != NULL) {
+                var->app_buf = new_buf;
+                var->app_max *= 2;
+            }
+        }
+    }
+
+done:
+    return ret_value;
+} /* SDappend */
+
 /******************************************************************************
  NAME
     SDgetblocksize -- get the size of the linked blocks.
@@ -4452,10 +5942,64 @@ done:
 
 /******************************************************************************
  NAME
-   SDsetfillmode -- set fill mode as fill or nofill
+    SDcompact -- rewrite the linked blocks of a dataset as contiguous data
 
  DESCRIPTION
-   Calls ncsetfill().
+    Datasets with an unlimited dimension store their data in linked
+    blocks, which end up scattered across the file when the dataset is
+    extended many times.  SDcompact rewrites the data as one contiguous
+    element with HLcompact(), so that it reads back sequentially.
+    Writing past the end of the data later turns it back into linked
+    blocks.  Datasets stored any other way are left alone.
+
+ RETURNS
+    SUCCEED/FAIL
+
+******************************************************************************/
+intn
+SDcompact(int32 sdsid /* IN: dataset ID */)
+{
+    NC     *handle    = NULL;
+    NC_var *var       = NULL;
+    intn    ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* get the handle */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get the variable */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* nothing written yet */
+    if (var->data_ref == 0)
+        HGOTO_DONE(SUCCEED);
+
+    /* the data must not be open while it is rewritten */
+    if (var->aid != FAIL) {
+        if (Hendaccess(var->aid) == FAIL)
+            HGOTO_ERROR(DFE_CANTENDACCESS, FAIL);
+        var->aid = FAIL;
+    }
+
+    if (HLcompact(handle->hdf_file, var->data_tag, var->data_ref) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+done:
+    return ret_value;
+} /* SDcompact */
+
+/******************************************************************************
+ NAME
+   SDsetfillmode -- set fill mode as fill or nofill
+
+ DESCRIPTION
+   Calls ncsetfill().
 
  RETURNS
    The current fill mode of the file, or FAIL for error.
@@ -4487,6 +6031,53 @@ done:
     return ret_value;
 } /* SDsetfillmode() */
 
+/******************************************************************************
+ NAME
+   SDsetconvertinplace -- allow writes to convert the caller's buffer
+
+ DESCRIPTION
+   Data whose number type has a different byte order in the file than in
+   memory is converted into a temporary buffer before it is written.  With
+   'inplace' set to TRUE, SDwritedata() on the contiguous datasets of the
+   file converts the values in the caller's buffer instead and writes them
+   from there: the buffer then holds the data in file order when
+   SDwritedata() returns and must be converted back or refilled before it
+   is used again.
+
+   Reads always convert in the caller's buffer when the number type has
+   the same size in the file and in memory, so this setting only matters
+   for writes.
+
+ RETURNS
+   The previous setting, or FAIL for error.
+
+******************************************************************************/
+intn
+SDsetconvertinplace(int32 sd_id, /* IN: HDF file ID, returned from SDstart */
+                    intn  inplace /* IN: TRUE to let writes convert in place */)
+{
+    NC  *handle = NULL;
+    intn ret_value = FAIL;
+
+    /* clear error stack */
+    HEclear();
+
+    /* get the handle */
+    handle = SDIhandle_from_id(sd_id, CDFTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    ret_value = (handle->flags & NC_INPLACE) ? TRUE : FALSE;
+    if (inplace)
+        handle->flags |= NC_INPLACE;
+    else
+        handle->flags &= ~NC_INPLACE;
+
+done:
+    return ret_value;
+} /* SDsetconvertinplace() */
+
 /******************************************************************************
  NAME
     SDsetdimval_comp -- set dimval backward compatibility
@@ -4531,6 +6122,7 @@ SDsetdimval_comp(int32 dimid,    /* IN: dimension ID, returned from SDgetdimid *
 
         /* make sure it gets reflected in the file */
         handle->flags |= NC_HDIRTY;
+        handle->full_flush = TRUE;
     }
 
 done:
@@ -4770,6 +6362,10 @@ SDsetchunk(int32         sdsid,     /* IN: sds access id */
                 /* encoder not present?? */
                 HGOTO_ERROR(DFE_BADCODER, FAIL);
             }
+            /* bytes can only be shuffled ahead of some coders */
+            if (var->shuffle && !SDIshuffle_coder((comp_coder_t)cdef->comp.comp_type)) {
+                HGOTO_ERROR(DFE_ARGS, FAIL);
+            }
             if ((comp_coder_t)cdef->comp.comp_type != COMP_CODE_SZIP) {
                 cdims               = cdef->comp.chunk_lengths;
                 chunk[0].chunk_flag = SPECIAL_COMP; /* Compression */
@@ -4777,6 +6373,17 @@ SDsetchunk(int32         sdsid,     /* IN: sds access id */
                 chunk[0].model_type = COMP_MODEL_STDIO; /* Default */
                 chunk[0].cinfo      = &cdef->comp.cinfo;
                 chunk[0].minfo      = &minfo; /* dummy */
+                if (var->shuffle) {
+                    chunk[0].model_type     = COMP_MODEL_SHUFFLE;
+                    minfo.shuffle.elem_size = var->HDFsize;
+                }
+                if ((comp_coder_t)cdef->comp.comp_type == COMP_CODE_LOSSY) {
+                    memcpy(&cinfo, &(cdef->comp.cinfo), sizeof(comp_info));
+                    if (SDIsetup_lossy(var, &cinfo) == FAIL) {
+                        HGOTO_ERROR(DFE_ARGS, FAIL);
+                    }
+                    chunk[0].cinfo = &cinfo;
+                }
             }
             else /* requested compression is SZIP */
 
@@ -4801,6 +6408,9 @@ SDsetchunk(int32         sdsid,     /* IN: sds access id */
 
             break;
         case (HDF_CHUNK | HDF_NBIT):
+            if (var->shuffle) {
+                HGOTO_ERROR(DFE_ARGS, FAIL);
+            }
             cdef                = (HDF_CHUNK_DEF *)&chunk_def;
             cdims               = cdef->nbit.chunk_lengths;
             chunk[0].chunk_flag = SPECIAL_COMP;     /* NBIT is a type of compression */
@@ -5181,6 +6791,19 @@ SDgetchunkinfo(int32          sdsid,     /* IN: sds access id */
                                     chunk_def->comp.cinfo.deflate.level = -1;
                                     break;
 
+                                case COMP_CODE_ZSTD:
+                                    chunk_def->comp.cinfo.zstd.level = -1;
+                                    break;
+
+                                case COMP_CODE_LZ4:
+                                    chunk_def->comp.cinfo.lz4.acceleration = -1;
+                                    break;
+
+                                case COMP_CODE_LOSSY:
+                                    chunk_def->comp.cinfo.lossy.nt = chunk_def->comp.cinfo.lossy.mode = -1;
+                                    chunk_def->comp.cinfo.lossy.tolerance                             = -1.0;
+                                    break;
+
                                 case COMP_CODE_SZIP:
                                     chunk_def->comp.cinfo.szip.pixels =
                                         chunk_def->comp.cinfo.szip.pixels_per_scanline =
@@ -5225,6 +6848,71 @@ done:
     return ret_value;
 } /* SDgetchunkinfo() */
 
+/******************************************************************************
+ NAME
+     SDgetchunkslab -- get the part of the SDS read by one of several readers
+
+ DESCRIPTION
+     Splits the SDS along its first dimension into 'nparts' slabs made of
+     whole chunks, or of whole rows if the SDS is not chunked, as evenly
+     as possible, and returns in 'start' and 'edges' the hyperslab of slab
+     'part', counting from 0.  Reading these hyperslabs, for instance by
+     the processes of an MPI job reading the file through Hsetmpio(),
+     reads each chunk by one reader only.  A slab may be empty, with
+     'edges[0]' 0, when there are fewer chunks than parts.
+
+ RETURNS
+        SUCCEED/FAIL
+******************************************************************************/
+intn
+SDgetchunkslab(int32  sdsid,  /* IN: sds access id */
+               int32  nparts, /* IN: number of parts */
+               int32  part,   /* IN: part to get, 0 to nparts-1 */
+               int32 *start,  /* OUT: start of the part */
+               int32 *edges /* OUT: edges of the part */)
+{
+    HDF_CHUNK_DEF chunk_def; /* chunk lengths of the SDS */
+    int32         dimsizes[H4_MAX_VAR_DIMS];
+    int32         rank, nt, nattrs;
+    int32         flags;
+    int32         length; /* length of a slab unit, a chunk or a row */
+    int32         nunits; /* number of slab units along the first dimension */
+    int32         first, last;
+    intn          i;
+    intn          ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    if (nparts < 1 || part < 0 || part >= nparts || start == NULL || edges == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (SDgetinfo(sdsid, NULL, &rank, dimsizes, &nt, &nattrs) == FAIL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (SDgetchunkinfo(sdsid, &chunk_def, &flags) == FAIL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* the first member of every variant of the union is chunk_lengths */
+    length = (flags & HDF_CHUNK) ? chunk_def.chunk_lengths[0] : 1;
+    if (length < 1)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    nunits = (dimsizes[0] + length - 1) / length;
+
+    /* slab 'part' gets units [first, last) */
+    first = (int32)(((int64_t)nunits * part) / nparts);
+    last  = (int32)(((int64_t)nunits * (part + 1)) / nparts);
+
+    start[0] = MIN(first * length, dimsizes[0]);
+    edges[0] = MIN(last * length, dimsizes[0]) - start[0];
+    for (i = 1; i < rank; i++) {
+        start[i] = 0;
+        edges[i] = dimsizes[i];
+    }
+
+done:
+    return ret_value;
+} /* SDgetchunkslab() */
+
 /******************************************************************************
  NAME
      SDwritechunk   -- write the specified chunk to the SDS
@@ -5276,14 +6964,1360 @@ SDwritechunk(int32       sdsid,  /* IN: access aid to SDS */
     /* clear error stack */
     HEclear();
 
-    info_block.cdims = NULL;
-
-    /* Check args */
-    if (origin == NULL || datap == NULL)
-        HGOTO_ERROR(DFE_ARGS, FAIL);
-
+    info_block.cdims = NULL;
+
+    /* Check args */
+    if (origin == NULL || datap == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get file handle and verify it is an HDF file
+       we only handle writinng to SDS only not coordinate variables */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+    NC_free_scale(var);
+
+    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* Check compression method is enabled */
+    status = HCPgetcomptype(handle->hdf_file, var->data_tag, var->data_ref, &comp_type);
+
+    if (status != FAIL)
+        if (comp_type != COMP_CODE_NONE && comp_type != COMP_CODE_INVALID) {
+            /* Must have encoder to write */
+            HCget_config_info(comp_type, &comp_config);
+            if ((comp_config & COMP_ENCODER_ENABLED) == 0) {
+                /* encoder not present?? */
+                HGOTO_ERROR(DFE_BADCODER, FAIL);
+            }
+        }
+
+    /* inquire about element */
+    ret_value = Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
+    if (ret_value != FAIL) {
+        if (special == SPECIAL_CHUNKED) { /* yes */
+
+            /* get ready to write */
+            handle->xdrs->x_op = XDR_ENCODE;
+
+            /* get info about chunked element */
+            if ((ret_value = HDget_special_info(var->aid, &info_block)) != FAIL) {
+                /* calculate chunk size  */
+                csize = 1;
+                for (i = 0; i < info_block.ndims; i++)
+                    csize *= info_block.cdims[i];
+
+                /* adjust for number type size */
+                csize *= var->HDFsize;
+
+                /* figure out if data needs to be converted */
+                byte_count = csize;
+
+                if (var->autorange)
+                    NC_range_update(var, datap, (long)(byte_count / var->HDFsize));
+
+                if (FAIL == (platntsubclass = DFKgetPNSC(var->HDFtype, DF_MT))) {
+                    HGOTO_ERROR(DFE_INTERNAL, FAIL);
+                }
+
+                if (DFKisnativeNT(var->HDFtype)) {
+                    if (FAIL == (outntsubclass = DFKgetPNSC(var->HDFtype, DF_MT))) {
+                        ret_value = FAIL;
+                        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+                    }
+                }
+                else {
+                    outntsubclass = DFKislitendNT(var->HDFtype) ? DFNTF_PC : DFNTF_HDFDEFAULT;
+                }
+
+                convert = (uintn)(platntsubclass != outntsubclass);
+
+                /* make sure our tmp buffer is big enough to hold everything */
+                if (convert && tBuf_size < byte_count) {
+                    free(tBuf);
+                    tBuf_size = byte_count;
+                    tBuf      = malloc(tBuf_size);
+                    if (tBuf == NULL) {
+                        tBuf_size = 0;
+                        ret_value = FAIL;
+                        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+                    }
+                }
+
+                /* Write chunk out, */
+                if (convert) {
+                    /* convert it */
+                    if (FAIL == DFKconvert((void *)datap, tBuf, var->HDFtype, (byte_count / var->HDFsize),
+                                           DFACC_WRITE, 0, 0)) {
+                        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+                    }
+
+                    /* write it out now */
+                    if ((ret_value = HMCwriteChunk(var->aid, origin, tBuf)) != FAIL) {
+                        HGOTO_DONE(SUCCEED);
+                    }
+                    /* need to make sure correctness - remove when done */
+                    else
+                        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+                } /* end if */
+                else {
+                    if ((ret_value = HMCwriteChunk(var->aid, origin, datap)) != FAIL) {
+                        HGOTO_DONE(SUCCEED);
+                    }
+                    /* need to make sure correctness - remove when done */
+                    else
+                        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+                }
+            } /* end if get special info block */
+        }
+        else /* not special CHUNKED */
+            ret_value = FAIL;
+    } /* end if Hinquire */
+
+done:
+    /* Release resource */
+    free(info_block.cdims);
+    free(tBuf);
+
+    return ret_value;
+} /* SDwritechunk() */
+
+/******************************************************************************
+ NAME
+     SDreadchunk   -- read the specified chunk to the SDS
+
+ DESCRIPTION
+     This routine reads a whole chunk of data from the chunked SDS
+     specified by chunk 'origin' for the given SDS and can be used
+     instead of SDreaddata() when this information is known. This
+     routine has less overhead and is much faster than using SDreaddata().
+
+     Origin specifies the coordinates of the chunk according to the chunk
+     position in the overall chunk array.
+
+     'datap' must point to a whole chunk of data.
+
+     See SDsetchunk() for a description of the organization of chunks in an SDS.
+
+     NOTE:
+         This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+ RETURNS
+        SUCCEED/FAIL
+
+ AUTHOR
+       -GeorgeV
+******************************************************************************/
+intn
+SDreadchunk(int32  sdsid,  /* IN: access aid to SDS */
+            int32 *origin, /* IN: origin of chunk to write */
+            void  *datap /* IN/OUT: buffer for data */)
+{
+    NC             *handle = NULL;  /* file handle */
+    NC_var         *var    = NULL;  /* SDS variable */
+    int16           special;        /* Special code */
+    int32           csize;          /* physical chunk size */
+    uint32          byte_count;     /* bytes to read */
+    int8            platntsubclass; /* the machine type of the current platform */
+    int8            outntsubclass;  /* the data's machine type */
+    uintn           convert;        /* whether to convert or not */
+    comp_coder_t    comp_type;
+    uint32          comp_config;
+    int32           status;
+    intn            i;
+    sp_info_block_t info_block;       /* special info block */
+    uint32          tBuf_size = 0;    /* conversion buffer size */
+    void           *tBuf      = NULL; /* buffer used for conversion */
+    intn            ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    info_block.cdims = NULL;
+
+    /* Check args */
+    if (origin == NULL || datap == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get file handle and verify it is an HDF file
+       we only handle reading from SDS only not coordinate variables */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* Dev note: empty SDS should have been checked here and SDreadchunk would
+       have failed, but since it wasn't, for backward compatibility, we won't
+       do it now either. -BMR 2011 */
+
+#ifdef added_by_mistake
+    /* Replaced this if statement by if (var->aid == FAIL) because it seemed
+       that hdf_get_vp_aid was called here by mistake (perhaps, copy/paste.)
+       For more info, see SVN log messages and bug HDFFR-171. -BMR, 2011/10 */
+
+    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+#endif
+
+    /* Check compression method is enabled */
+    status = HCPgetcomptype(handle->hdf_file, var->data_tag, var->data_ref, &comp_type);
+
+    if (status != FAIL)
+        if (comp_type != COMP_CODE_NONE && comp_type != COMP_CODE_INVALID) {
+            /* Must have decoder to read data */
+            HCget_config_info(comp_type, &comp_config);
+            if ((comp_config & COMP_DECODER_ENABLED) == 0) {
+                /* decoder not present?? */
+                HGOTO_ERROR(DFE_BADCODER, FAIL);
+            }
+        }
+
+    /* Need to get access id for the following calls */
+    if (var->aid == FAIL) {
+        var->aid = Hstartread(handle->hdf_file, var->data_tag, var->data_ref);
+        if (var->aid == FAIL) /* catch FAIL from Hstartread */
+            HGOTO_ERROR(DFE_CANTACCESS, FAIL);
+    }
+
+    /* inquire about element */
+    ret_value = Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
+    if (ret_value != FAIL) {
+        if (special == SPECIAL_CHUNKED) { /* yes */
+            /* get ready to read */
+            handle->xdrs->x_op = XDR_DECODE;
+
+            /* get info about chunked element */
+            if ((ret_value = HDget_special_info(var->aid, &info_block)) != FAIL) {
+                /* calculate chunk size  */
+                csize = 1;
+                for (i = 0; i < info_block.ndims; i++)
+                    csize *= info_block.cdims[i];
+
+                /* adjust for number type size */
+                csize *= var->HDFsize;
+
+                /* figure out if data needs to be converted */
+                byte_count = csize;
+
+                if (FAIL == (platntsubclass = DFKgetPNSC(var->HDFtype, DF_MT))) {
+                    HGOTO_ERROR(DFE_INTERNAL, FAIL);
+                }
+
+                if (DFKisnativeNT(var->HDFtype)) {
+                    if (FAIL == (outntsubclass = DFKgetPNSC(var->HDFtype, DF_MT))) {
+                        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+                    }
+                }
+                else {
+                    outntsubclass = DFKislitendNT(var->HDFtype) ? DFNTF_PC : DFNTF_HDFDEFAULT;
+                }
+
+                convert = (uintn)(platntsubclass != outntsubclass);
+
+                /* make sure our tmp buffer is big enough to hold everything */
+                if (convert && tBuf_size < byte_count) {
+                    free(tBuf);
+                    tBuf_size = byte_count;
+                    tBuf      = malloc(tBuf_size);
+                    if (tBuf == NULL) {
+                        tBuf_size = 0;
+                        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+                    }
+                }
+
+                /* read chunk in */
+                if (convert) {
+                    /* read it in */
+                    if ((ret_value = HMCreadChunk(var->aid, origin, tBuf)) != FAIL) {
+                        /* convert chunk */
+                        if (FAIL == DFKconvert(tBuf, datap, var->HDFtype, (byte_count / var->HDFsize),
+                                               DFACC_READ, 0, 0)) {
+                            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+                        }
+
+                        ret_value = SUCCEED;
+                    }
+                    else
+                        HGOTO_ERROR(DFE_READERROR, FAIL);
+                } /* end if */
+                else {
+                    if ((ret_value = HMCreadChunk(var->aid, origin, datap)) != FAIL) {
+                        ret_value = SUCCEED;
+                    }
+                    else
+                        HGOTO_ERROR(DFE_READERROR, FAIL);
+                }
+            } /* end if get special info block */
+        }
+        else /* not special CHUNKED */
+            ret_value = FAIL;
+    } /* end if Hinquire */
+
+    /* End access to the access id */
+    if (Hendaccess(var->aid) == FAIL)
+        HGOTO_ERROR(DFE_CANTENDACCESS, FAIL);
+    var->aid = FAIL;
+
+done:
+    if (ret_value == FAIL) { /* Failure cleanup */
+        /* End access to the aid if necessary */
+        if (var && var->aid != FAIL) {
+            Hendaccess(var->aid);
+            var->aid = FAIL;
+        }
+    }
+
+    /* Release resource */
+    free(info_block.cdims);
+    free(tBuf);
+
+    return ret_value;
+} /* SDreadchunk() */
+
+/******************************************************************************
+ NAME
+     SDreadchunkraw -- read the stored data of a chunk of the SDS
+
+ DESCRIPTION
+     This routine copies the chunk of the chunked SDS specified by chunk
+     'origin' as it is stored in the file, i.e. still compressed if the
+     SDS is, into 'datap' without decoding or converting it.  With 'datap'
+     NULL only the size of the stored chunk is returned so that a buffer
+     can be allocated.  The coder and its parameters are returned by
+     SDgetcompinfo().
+
+     The data can be written with SDwritechunkraw() to a new chunked SDS
+     with the same number type, chunk lengths and compression, which
+     copies the chunk without decompressing and compressing it again.
+
+     See SDsetchunk() for a description of the organization of chunks in an SDS.
+
+     NOTE:
+         This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+ RETURNS
+        The number of bytes of the stored chunk, 0 if the chunk was never
+        written and FAIL on error
+******************************************************************************/
+int32
+SDreadchunkraw(int32  sdsid,  /* IN: access aid to SDS */
+               int32 *origin, /* IN: origin of chunk to read */
+               void  *datap,  /* OUT: buffer for the stored chunk */
+               int32  buflen /* IN: size of 'datap' */)
+{
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    int16   special;       /* Special code */
+    int32   ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* Check args */
+    if (origin == NULL || buflen < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get file handle and verify it is an HDF file
+       we only handle reading from SDS only not coordinate variables */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* Need to get access id for the following calls */
+    if (var->aid == FAIL) {
+        var->aid = Hstartread(handle->hdf_file, var->data_tag, var->data_ref);
+        if (var->aid == FAIL) /* catch FAIL from Hstartread */
+            HGOTO_ERROR(DFE_CANTACCESS, FAIL);
+    }
+
+    /* inquire about element */
+    ret_value = Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
+    if (ret_value != FAIL) {
+        if (special == SPECIAL_CHUNKED)
+            ret_value = HMCreadChunkRaw(var->aid, origin, datap, buflen);
+        else
+            ret_value = FAIL;
+    }
+
+done:
+    return ret_value;
+} /* SDreadchunkraw() */
+
+/******************************************************************************
+ NAME
+     SDwritechunkraw -- write the stored data of a chunk of the SDS
+
+ DESCRIPTION
+     This routine writes 'length' bytes read by SDreadchunkraw() as the
+     chunk of the chunked SDS specified by chunk 'origin', without
+     encoding or converting them.  The SDS must have the same number type,
+     chunk lengths and compression as the one the data was read from, and
+     the chunk must not have been written yet.
+
+     See SDsetchunk() for a description of the organization of chunks in an SDS.
+
+     NOTE:
+         This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+ RETURNS
+        SUCCEED/FAIL
+******************************************************************************/
+intn
+SDwritechunkraw(int32       sdsid,  /* IN: access aid to SDS */
+                int32      *origin, /* IN: origin of chunk to write */
+                const void *datap,  /* IN: stored chunk */
+                int32       length /* IN: number of bytes in 'datap' */)
+{
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    int16   special;       /* Special code */
+    intn    ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* Check args */
+    if (origin == NULL || datap == NULL || length <= 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get file handle and verify it is an HDF file
+       we only handle writinng to SDS only not coordinate variables */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+    NC_free_scale(var);
+
+    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* inquire about element */
+    ret_value = Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
+    if (ret_value != FAIL) {
+        if (special == SPECIAL_CHUNKED) {
+            if (HMCwriteChunkRaw(var->aid, origin, datap, length) == FAIL)
+                HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+            ret_value = SUCCEED;
+        }
+        else
+            ret_value = FAIL;
+    }
+
+done:
+    return ret_value;
+} /* SDwritechunkraw() */
+
+/******************************************************************************
+NAME
+     SDsetchunkcache - maximum number of chunks to cache
+
+DESCRIPTION
+     Set the maximum number of chunks to cache.
+
+     The cache contains the Least Recently Used(LRU cache replacement policy)
+     chunks. This routine allows the setting of maximum number of chunks that
+     can be cached, 'maxcache'.
+
+     The performance of the SDxxx interface with chunking is greatly
+     affected by the users access pattern over the dataset and by
+     the maximum number of chunks set in the chunk cache. The number chunks
+     that can be set in the cache is process memory limited. It is a good
+     idea to always set the maximum number of chunks in the cache as the
+     default heuristic does not take into account the memory available for
+     the application.
+
+     By default when the SDS is promoted to a chunked element the
+     maximum number of chunks in the cache 'maxcache' is set to the number of
+     chunks along the last dimension.
+
+     The values set here affects the current SDS object's caching behaviour.
+
+     If the chunk cache is full and 'maxcache' is greater then the
+     current 'maxcache' value, then the chunk cache is reset to the new
+     'maxcache' value, else the chunk cache remains at the current
+     'maxcache' value.
+
+     If the chunk cache is not full, then the chunk cache is set to the
+     new 'maxcache' value only if the new 'maxcache' value is greater than the
+     current number of chunks in the cache.
+
+     Use flags argument of 'HDF_CACHEALL' if the whole object is to be cached
+     in memory, otherwise pass in zero(0). Currently you can only
+     pass in zero.
+
+     The policy used to pick the chunk to evict from a full cache can be
+     or'ed into 'flags': HDF_CACHE_LRU (the default, least recently used),
+     HDF_CACHE_CLOCK or HDF_CACHE_2Q.  HDF_CACHE_2Q is scan resistant:
+     chunks that were only read once, as in a pass across the data, are
+     evicted before chunks that were read again.
+
+     With HDF_CACHE_SHARED also or'ed into 'flags', the cache joins the
+     cache pool shared by all the datasets of the process, whose byte
+     budget is set with SDsetchunkcachebudget().  'maxcache' still bounds
+     the number of chunks cached and is the dataset's weight in the pool:
+     when the pool is full, chunks are evicted from the dataset holding
+     the most bytes relative to its weight.  Calling again without
+     HDF_CACHE_SHARED takes the cache out of the pool.  Thread-safe
+     builds have no pool and refuse HDF_CACHE_SHARED.
+
+     See SDsetchunk() for a description of the organization of chunks in an SDS.
+
+     NOTE:
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+RETURNS
+     Returns the 'maxcache' value for the chunk cache if successful
+     and FAIL otherwise
+
+AUTHOR
+      -GeorgeV
+******************************************************************************/
+intn
+SDsetchunkcache(int32 sdsid,    /* IN: access aid to mess with */
+                int32 maxcache, /* IN: max number of chunks to cache */
+                int32 flags /* IN: flags = 0, HDF_CACHEALL */)
+{
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    int16   special;       /* Special code */
+    intn    ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* Check args */
+    if (maxcache < 1) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    if (!HDF_CACHE_FLAGS_OK(flags)) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* get file handle and verify it is an HDF file
+       we only handle dealing with SDS only not coordinate variables */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* inquire about element */
+    ret_value = Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
+    if (ret_value != FAIL) {
+        if (special == SPECIAL_CHUNKED)
+            ret_value = HMCsetMaxcache(var->aid, maxcache, flags); /* set cache*/
+        else
+            ret_value = FAIL;
+    }
+
+done:
+    return ret_value;
+} /* SDsetchunkcache() */
+
+/******************************************************************************
+NAME
+     SDsetchunkthreads - number of threads used to code chunks
+
+DESCRIPTION
+     Set the number of threads used to decode and encode the compressed
+     chunks of a chunked SDS.
+
+     By default the chunks needed by SDreaddata() are read and decoded one
+     at a time.  With 'nthreads' greater than 1, the deflate or LZ4 compressed
+     chunks that a read has to bring into the chunk cache are decoded in
+     parallel on up to 'nthreads' threads before the data is copied into
+     the user's buffer.  Passing 1 restores the serial behaviour.
+
+     Up to two decoded chunks per thread are held in memory during a read,
+     in addition to the chunk cache set with SDsetchunkcache().
+
+     New deflate or LZ4 compressed chunks written by SDwritedata() are
+     likewise held back, up to four per thread, and compressed in parallel
+     when enough of them have been collected.  The remaining ones are written
+     when the SDS is closed, so SDendaccess() reports any failure to write
+     them.  Chunks with bytes shuffled by SDsetshuffle() are always coded
+     serially.
+
+     NOTE:
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+RETURNS
+     Returns the previous number of threads if successful and FAIL otherwise
+
+******************************************************************************/
+intn
+SDsetchunkthreads(int32 sdsid, /* IN: access aid to mess with */
+                  intn  nthreads /* IN: number of coding threads */)
+{
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    int16   special;       /* Special code */
+    intn    ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* Check args */
+    if (nthreads < 1) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* get file handle and verify it is an HDF file
+       we only handle dealing with SDS only not coordinate variables */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* inquire about element */
+    ret_value = Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
+    if (ret_value != FAIL) {
+        if (special == SPECIAL_CHUNKED)
+            ret_value = HMCsetThreads(var->aid, nthreads); /* set threads */
+        else
+            ret_value = FAIL;
+    }
+
+done:
+    return ret_value;
+} /* SDsetchunkthreads() */
+
+/******************************************************************************
+NAME
+     SDgetchunkcachestats - hit, miss and eviction counts of the chunk cache
+
+DESCRIPTION
+     Returns the number of chunk lookups of a chunked SDS that were found
+     in its chunk cache, the number that had to read the chunk from the
+     file, and the number of chunks evicted to make room for others, since
+     the SDS was selected.
+
+     NOTE:
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+intn
+SDgetchunkcachestats(int32              sdsid, /* IN: access aid to mess with */
+                     hdf_cache_stats_t *stats /* OUT: hit, miss and eviction counts */)
+{
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    int16   special;       /* Special code */
+    intn    ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* get file handle and verify it is an HDF file
+       we only handle dealing with SDS only not coordinate variables */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* inquire about element */
+    ret_value = Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
+    if (ret_value != FAIL) {
+        if (special == SPECIAL_CHUNKED)
+            ret_value = HMCgetCacheStats(var->aid, stats);
+        else
+            ret_value = FAIL;
+    }
+
+done:
+    return ret_value;
+} /* SDgetchunkcachestats() */
+
+/******************************************************************************
+NAME
+     SDsetchunkreadahead - turn readahead of sequential reads on or off
+
+DESCRIPTION
+     Turns on or off the readahead of the chunks of a chunked SDS that is
+     read slab by slab at a fixed step.  See mfhdf.h for the details.
+
+     NOTE:
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+RETURNS
+     Returns the previous setting (TRUE or FALSE) if successful and FAIL
+     otherwise
+******************************************************************************/
+intn
+SDsetchunkreadahead(int32 sdsid, /* IN: access aid to mess with */
+                    intn  readahead /* IN: TRUE to turn readahead on */)
+{
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    int16   special;       /* Special code */
+    intn    ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* get file handle and verify it is an HDF file
+       we only handle dealing with SDS only not coordinate variables */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* inquire about element */
+    ret_value = Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
+    if (ret_value != FAIL) {
+        if (special == SPECIAL_CHUNKED) {
+            ret_value = HMCsetReadahead(var->aid, readahead);
+            if (ret_value != FAIL)
+                var->readahead = readahead;
+        }
+        else
+            ret_value = FAIL;
+    }
+
+done:
+    return ret_value;
+} /* SDsetchunkreadahead() */
+
+/******************************************************************************
+NAME
+     SDsetchunksparse - leave chunks of only fill values unwritten
+
+DESCRIPTION
+     Turns on or off the sparse writing of a chunked SDS, which leaves
+     new chunks that hold only the fill value out of the file.  See
+     mfhdf.h for the details.
+
+     NOTE:
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+RETURNS
+     Returns the previous setting (TRUE or FALSE) if successful and FAIL
+     otherwise
+******************************************************************************/
+intn
+SDsetchunksparse(int32 sdsid, /* IN: access aid to mess with */
+                 intn  sparse /* IN: TRUE to leave chunks of fill values unwritten */)
+{
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    int16   special;       /* Special code */
+    intn    ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* get file handle and verify it is an HDF file
+       we only handle dealing with SDS only not coordinate variables */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* inquire about element */
+    ret_value = Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
+    if (ret_value != FAIL) {
+        if (special == SPECIAL_CHUNKED)
+            ret_value = HMCsetSparse(var->aid, sparse);
+        else
+            ret_value = FAIL;
+    }
+
+done:
+    return ret_value;
+} /* SDsetchunksparse() */
+
+/******************************************************************************
+NAME
+     SDsetchunkdedup - share the data of identical chunks
+
+DESCRIPTION
+     Turns on or off the deduplication of the chunks of a chunked SDS,
+     which points new chunks that are the same as one written before at
+     its data instead of writing them.  See mfhdf.h for the details.
+
+     NOTE:
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+RETURNS
+     Returns the previous setting (TRUE or FALSE) if successful and FAIL
+     otherwise
+******************************************************************************/
+intn
+SDsetchunkdedup(int32 sdsid, /* IN: access aid to mess with */
+                intn  dedup /* IN: TRUE to share the data of identical chunks */)
+{
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    int16   special;       /* Special code */
+    intn    ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* get file handle and verify it is an HDF file
+       we only handle dealing with SDS only not coordinate variables */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* inquire about element */
+    ret_value = Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
+    if (ret_value != FAIL) {
+        if (special == SPECIAL_CHUNKED)
+            ret_value = HMCsetDedup(var->aid, dedup);
+        else
+            ret_value = FAIL;
+    }
+
+done:
+    return ret_value;
+} /* SDsetchunkdedup() */
+
+/******************************************************************************
+NAME
+     SDsetchunkrawlimit - store chunks that do not compress well as they are
+
+DESCRIPTION
+     Sets the percentage of its size the new chunks of a deflate or LZ4
+     compressed SDS must compress to, or they are stored uncompressed.
+     See mfhdf.h for the details.
+
+     NOTE:
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+RETURNS
+     Returns the previous limit if successful and FAIL otherwise
+******************************************************************************/
+intn
+SDsetchunkrawlimit(int32 sdsid, /* IN: access aid to mess with */
+                   intn  percent /* IN: limit of the compressed size, 0 for none */)
+{
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    int16   special;       /* Special code */
+    intn    ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* get file handle and verify it is an HDF file
+       we only handle dealing with SDS only not coordinate variables */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* inquire about element */
+    ret_value = Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
+    if (ret_value != FAIL) {
+        if (special == SPECIAL_CHUNKED)
+            ret_value = HMCsetRawLimit(var->aid, percent);
+        else
+            ret_value = FAIL;
+    }
+
+done:
+    return ret_value;
+} /* SDsetchunkrawlimit() */
+
+/******************************************************************************
+NAME
+     SDsetchunkcoderpolicy - choose the coder of each new chunk by a trial
+
+DESCRIPTION
+     Sets the percentage by which the sample of a faster coder may be
+     larger than the smallest one, for the new chunks of a deflate or LZ4
+     compressed SDS to be compressed with it.  See mfhdf.h for the details.
+
+     NOTE:
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+RETURNS
+     Returns SUCCEED if successful and FAIL otherwise
+******************************************************************************/
+intn
+SDsetchunkcoderpolicy(int32 sdsid, /* IN: access aid to mess with */
+                      intn  percent /* IN: size a faster coder may trail by, negative for none */)
+{
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    int16   special;       /* Special code */
+    intn    ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* get file handle and verify it is an HDF file
+       we only handle dealing with SDS only not coordinate variables */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* inquire about element */
+    ret_value = Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
+    if (ret_value != FAIL) {
+        if (special == SPECIAL_CHUNKED)
+            ret_value = HMCsetCoderPolicy(var->aid, percent);
+        else
+            ret_value = FAIL;
+    }
+
+done:
+    return ret_value;
+} /* SDsetchunkcoderpolicy() */
+
+/******************************************************************************
+NAME
+     SDgetchunkmap - get the map of the chunks written
+
+DESCRIPTION
+     Fills in one bit per chunk of a chunked SDS, set for each chunk that
+     has been written, from the chunk table kept in memory.  See mfhdf.h
+     for the details.
+
+     NOTE:
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+RETURNS
+     Returns the number of chunks written if successful and FAIL otherwise
+******************************************************************************/
+int32
+SDgetchunkmap(int32  sdsid, /* IN: access aid to mess with */
+              uint8 *map,   /* OUT: one bit per chunk, set if written */
+              int32 *nchunks /* OUT: number of chunks of the SDS */)
+{
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    int16   special;       /* Special code */
+    int32   ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* get file handle and verify it is an HDF file
+       we only handle dealing with SDS only not coordinate variables */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* inquire about element */
+    ret_value = Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
+    if (ret_value != FAIL) {
+        if (special == SPECIAL_CHUNKED)
+            ret_value = HMCgetChunkMap(var->aid, map, nchunks);
+        else
+            ret_value = FAIL;
+    }
+
+done:
+    return ret_value;
+} /* SDgetchunkmap() */
+
+/******************************************************************************
+NAME
+     SDsetchunkstats - keep statistics of the chunks of an SDS
+
+DESCRIPTION
+     Makes each chunk of a chunked SDS written from now on get the least
+     and greatest of its values and their number, stored with the chunk
+     table.  See mfhdf.h for the details.
+
+     NOTE:
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+intn
+SDsetchunkstats(int32 sdsid /* IN: access aid to mess with */)
+{
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    int16   special;       /* Special code */
+    intn    ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* get file handle and verify it is an HDF file
+       we only handle dealing with SDS only not coordinate variables */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* inquire about element */
+    ret_value = Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
+    if (ret_value != FAIL) {
+        if (special == SPECIAL_CHUNKED)
+            ret_value = HMCsetStats(var->aid, var->HDFtype);
+        else
+            ret_value = FAIL;
+    }
+
+done:
+    return ret_value;
+} /* SDsetchunkstats() */
+
+/******************************************************************************
+NAME
+     SDgetchunkstats - get the statistics of a chunk
+
+DESCRIPTION
+     Returns the least and greatest value of a chunk of a chunked SDS
+     and their number, from the statistics kept with SDsetchunkstats().
+     See mfhdf.h for the details.
+
+     NOTE:
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+intn
+SDgetchunkstats(int32    sdsid,  /* IN: access aid to mess with */
+                int32   *origin, /* IN: origin of the chunk */
+                float64 *min,    /* OUT: least value */
+                float64 *max,    /* OUT: greatest value */
+                int32   *count /* OUT: number of values, -1 if not known */)
+{
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    int16   special;       /* Special code */
+    intn    ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* get file handle and verify it is an HDF file
+       we only handle dealing with SDS only not coordinate variables */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* inquire about element */
+    ret_value = Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
+    if (ret_value != FAIL) {
+        if (special == SPECIAL_CHUNKED)
+            ret_value = HMCgetChunkStats(var->aid, origin, min, max, count);
+        else
+            ret_value = FAIL;
+    }
+
+done:
+    return ret_value;
+} /* SDgetchunkstats() */
+
+/******************************************************************************
+NAME
+     SDquerychunks - find the chunks that may hold values in a range
+
+DESCRIPTION
+     Returns the origins of the chunks of a chunked SDS whose statistics,
+     kept with SDsetchunkstats(), meet the range of values [lo, hi].  See
+     mfhdf.h for the details.
+
+     NOTE:
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+RETURNS
+     Returns the number of chunks found if successful and FAIL otherwise
+******************************************************************************/
+int32
+SDquerychunks(int32   sdsid,     /* IN: access aid to mess with */
+              float64 lo,        /* IN: least value looked for */
+              float64 hi,        /* IN: greatest value looked for */
+              int32   maxchunks, /* IN: number of origins 'origins' has room for */
+              int32  *origins /* OUT: origins of the chunks found */)
+{
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    int16   special;       /* Special code */
+    int32   ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* get file handle and verify it is an HDF file
+       we only handle dealing with SDS only not coordinate variables */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* inquire about element */
+    ret_value = Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
+    if (ret_value != FAIL) {
+        if (special == SPECIAL_CHUNKED)
+            ret_value = HMCqueryChunks(var->aid, lo, hi, maxchunks, origins);
+        else
+            ret_value = FAIL;
+    }
+
+done:
+    return ret_value;
+} /* SDquerychunks() */
+
+/******************************************************************************
+NAME
+     SDsetchunkchecksums - keep checksums of the chunks of an SDS
+
+DESCRIPTION
+     Makes each chunk of a chunked SDS written from now on get the
+     CRC-32C of its data decoded and as stored, kept with the chunk
+     table.  See mfhdf.h for the details.
+
+     NOTE:
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+intn
+SDsetchunkchecksums(int32 sdsid /* IN: access aid to mess with */)
+{
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    int16   special;       /* Special code */
+    intn    ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* get file handle and verify it is an HDF file
+       we only handle dealing with SDS only not coordinate variables */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* inquire about element */
+    ret_value = Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
+    if (ret_value != FAIL) {
+        if (special == SPECIAL_CHUNKED)
+            ret_value = HMCsetChecksums(var->aid);
+        else
+            ret_value = FAIL;
+    }
+
+done:
+    return ret_value;
+} /* SDsetchunkchecksums() */
+
+/******************************************************************************
+NAME
+     SDgetchunkchecksum - get the checksums of a chunk
+
+DESCRIPTION
+     Returns the CRC-32C of the data of a chunk of a chunked SDS decoded
+     and as stored, from the checksums kept with SDsetchunkchecksums().
+     See mfhdf.h for the details.
+
+     NOTE:
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+RETURNS
+     The checksums known, HDF_CHKSUM_RAW and HDF_CHKSUM_STORED or'ed, or
+     FAIL
+******************************************************************************/
+intn
+SDgetchunkchecksum(int32   sdsid,   /* IN: access aid to mess with */
+                   int32  *origin,  /* IN: origin of the chunk */
+                   uint32 *raw_crc, /* OUT: CRC-32C of the decoded data */
+                   uint32 *stored_crc /* OUT: CRC-32C of the data as stored */)
+{
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    int16   special;       /* Special code */
+    intn    ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
     /* get file handle and verify it is an HDF file
-       we only handle writinng to SDS only not coordinate variables */
+       we only handle dealing with SDS only not coordinate variables */
     handle = SDIhandle_from_id(sdsid, SDSTYPE);
     if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
         HGOTO_ERROR(DFE_ARGS, FAIL);
@@ -5300,152 +8334,55 @@ SDwritechunk(int32       sdsid,  /* IN: access aid to SDS */
         HGOTO_ERROR(DFE_ARGS, FAIL);
     }
 
-    /* Check compression method is enabled */
-    status = HCPgetcomptype(handle->hdf_file, var->data_tag, var->data_ref, &comp_type);
-
-    if (status != FAIL)
-        if (comp_type != COMP_CODE_NONE && comp_type != COMP_CODE_INVALID) {
-            /* Must have encoder to write */
-            HCget_config_info(comp_type, &comp_config);
-            if ((comp_config & COMP_ENCODER_ENABLED) == 0) {
-                /* encoder not present?? */
-                HGOTO_ERROR(DFE_BADCODER, FAIL);
-            }
-        }
-
     /* inquire about element */
     ret_value = Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
     if (ret_value != FAIL) {
-        if (special == SPECIAL_CHUNKED) { /* yes */
-
-            /* get ready to write */
-            handle->xdrs->x_op = XDR_ENCODE;
-
-            /* get info about chunked element */
-            if ((ret_value = HDget_special_info(var->aid, &info_block)) != FAIL) {
-                /* calculate chunk size  */
-                csize = 1;
-                for (i = 0; i < info_block.ndims; i++)
-                    csize *= info_block.cdims[i];
-
-                /* adjust for number type size */
-                csize *= var->HDFsize;
-
-                /* figure out if data needs to be converted */
-                byte_count = csize;
-
-                if (FAIL == (platntsubclass = DFKgetPNSC(var->HDFtype, DF_MT))) {
-                    HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                }
-
-                if (DFKisnativeNT(var->HDFtype)) {
-                    if (FAIL == (outntsubclass = DFKgetPNSC(var->HDFtype, DF_MT))) {
-                        ret_value = FAIL;
-                        HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                    }
-                }
-                else {
-                    outntsubclass = DFKislitendNT(var->HDFtype) ? DFNTF_PC : DFNTF_HDFDEFAULT;
-                }
-
-                convert = (uintn)(platntsubclass != outntsubclass);
-
-                /* make sure our tmp buffer is big enough to hold everything */
-                if (convert && tBuf_size < byte_count) {
-                    free(tBuf);
-                    tBuf_size = byte_count;
-                    tBuf      = malloc(tBuf_size);
-                    if (tBuf == NULL) {
-                        tBuf_size = 0;
-                        ret_value = FAIL;
-                        HGOTO_ERROR(DFE_NOSPACE, FAIL);
-                    }
-                }
-
-                /* Write chunk out, */
-                if (convert) {
-                    /* convert it */
-                    if (FAIL == DFKconvert((void *)datap, tBuf, var->HDFtype, (byte_count / var->HDFsize),
-                                           DFACC_WRITE, 0, 0)) {
-                        HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                    }
-
-                    /* write it out now */
-                    if ((ret_value = HMCwriteChunk(var->aid, origin, tBuf)) != FAIL) {
-                        HGOTO_DONE(SUCCEED);
-                    }
-                    /* need to make sure correctness - remove when done */
-                    else
-                        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
-                } /* end if */
-                else {
-                    if ((ret_value = HMCwriteChunk(var->aid, origin, datap)) != FAIL) {
-                        HGOTO_DONE(SUCCEED);
-                    }
-                    /* need to make sure correctness - remove when done */
-                    else
-                        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
-                }
-            } /* end if get special info block */
-        }
-        else /* not special CHUNKED */
+        if (special == SPECIAL_CHUNKED)
+            ret_value = HMCgetChunkChecksum(var->aid, origin, raw_crc, stored_crc);
+        else
             ret_value = FAIL;
-    } /* end if Hinquire */
+    }
 
 done:
-    /* Release resource */
-    free(info_block.cdims);
-    free(tBuf);
-
     return ret_value;
-} /* SDwritechunk() */
+} /* SDgetchunkchecksum() */
 
 /******************************************************************************
- NAME
-     SDreadchunk   -- read the specified chunk to the SDS
-
- DESCRIPTION
-     This routine reads a whole chunk of data from the chunked SDS
-     specified by chunk 'origin' for the given SDS and can be used
-     instead of SDreaddata() when this information is known. This
-     routine has less overhead and is much faster than using SDreaddata().
-
-     Origin specifies the coordinates of the chunk according to the chunk
-     position in the overall chunk array.
-
-     'datap' must point to a whole chunk of data.
+NAME
+     SDgetchunkptr - get a pointer to a chunk held in the chunk cache
 
-     See SDsetchunk() for a description of the organization of chunks in an SDS.
+DESCRIPTION
+     Reads the chunk of a chunked SDS specified by chunk 'origin' and
+     returns a pointer to it in '*datap' instead of copying it into a
+     buffer like SDreadchunk() does.  The chunk is kept pinned in the
+     chunk cache until it is given back with SDreleasechunk().  See
+     mfhdf.h for the details.
 
      NOTE:
-         This routine directly calls a Special Chunked Element fcn HMCxxx.
-
- RETURNS
-        SUCCEED/FAIL
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
 
- AUTHOR
-       -GeorgeV
+RETURNS
+     SUCCEED/FAIL
 ******************************************************************************/
 intn
-SDreadchunk(int32  sdsid,  /* IN: access aid to SDS */
-            int32 *origin, /* IN: origin of chunk to write */
-            void  *datap /* IN/OUT: buffer for data */)
+SDgetchunkptr(int32        sdsid,  /* IN: access aid to SDS */
+              int32       *origin, /* IN: origin of chunk to get */
+              const void **datap,  /* OUT: the chunk */
+              int32       *chunk_lengths /* OUT: lengths of the chunk */)
 {
     NC             *handle = NULL;  /* file handle */
     NC_var         *var    = NULL;  /* SDS variable */
     int16           special;        /* Special code */
-    int32           csize;          /* physical chunk size */
-    uint32          byte_count;     /* bytes to read */
+    int32           csize;          /* bytes of the chunk */
     int8            platntsubclass; /* the machine type of the current platform */
     int8            outntsubclass;  /* the data's machine type */
-    uintn           convert;        /* whether to convert or not */
     comp_coder_t    comp_type;
     uint32          comp_config;
-    int32           status;
+    const void     *chunk = NULL;  /* the chunk in the cache */
+    void           *tBuf  = NULL;  /* the chunk converted */
+    void          **bufs;          /* grown list of converted chunks */
+    sp_info_block_t info_block;    /* special info block */
     intn            i;
-    sp_info_block_t info_block;       /* special info block */
-    uint32          tBuf_size = 0;    /* conversion buffer size */
-    void           *tBuf      = NULL; /* buffer used for conversion */
     intn            ret_value = SUCCEED;
 
     /* clear error stack */
@@ -5470,25 +8407,8 @@ SDreadchunk(int32  sdsid,  /* IN: access aid to SDS */
         HGOTO_ERROR(DFE_ARGS, FAIL);
     }
 
-    /* Dev note: empty SDS should have been checked here and SDreadchunk would
-       have failed, but since it wasn't, for backward compatibility, we won't
-       do it now either. -BMR 2011 */
-
-#ifdef added_by_mistake
-    /* Replaced this if statement by if (var->aid == FAIL) because it seemed
-       that hdf_get_vp_aid was called here by mistake (perhaps, copy/paste.)
-       For more info, see SVN log messages and bug HDFFR-171. -BMR, 2011/10 */
-
-    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
-    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL) {
-        HGOTO_ERROR(DFE_ARGS, FAIL);
-    }
-#endif
-
     /* Check compression method is enabled */
-    status = HCPgetcomptype(handle->hdf_file, var->data_tag, var->data_ref, &comp_type);
-
-    if (status != FAIL)
+    if (HCPgetcomptype(handle->hdf_file, var->data_tag, var->data_ref, &comp_type) != FAIL)
         if (comp_type != COMP_CODE_NONE && comp_type != COMP_CODE_INVALID) {
             /* Must have decoder to read data */
             HCget_config_info(comp_type, &comp_config);
@@ -5498,162 +8418,154 @@ SDreadchunk(int32  sdsid,  /* IN: access aid to SDS */
             }
         }
 
-    /* Need to get access id for the following calls */
-    if (var->aid == FAIL) {
-        var->aid = Hstartread(handle->hdf_file, var->data_tag, var->data_ref);
-        if (var->aid == FAIL) /* catch FAIL from Hstartread */
+    /* The chunks are held with an access id of their own, which stays
+       open while other calls start and end 'var->aid' */
+    if (var->view_aid == FAIL) {
+        var->view_aid = Hstartread(handle->hdf_file, var->data_tag, var->data_ref);
+        if (var->view_aid == FAIL) /* catch FAIL from Hstartread */
             HGOTO_ERROR(DFE_CANTACCESS, FAIL);
     }
 
-    /* inquire about element */
-    ret_value = Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
-    if (ret_value != FAIL) {
-        if (special == SPECIAL_CHUNKED) { /* yes */
-            /* get ready to read */
-            handle->xdrs->x_op = XDR_DECODE;
-
-            /* get info about chunked element */
-            if ((ret_value = HDget_special_info(var->aid, &info_block)) != FAIL) {
-                /* calculate chunk size  */
-                csize = 1;
-                for (i = 0; i < info_block.ndims; i++)
-                    csize *= info_block.cdims[i];
-
-                /* adjust for number type size */
-                csize *= var->HDFsize;
-
-                /* figure out if data needs to be converted */
-                byte_count = csize;
-
-                if (FAIL == (platntsubclass = DFKgetPNSC(var->HDFtype, DF_MT))) {
-                    HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                }
-
-                if (DFKisnativeNT(var->HDFtype)) {
-                    if (FAIL == (outntsubclass = DFKgetPNSC(var->HDFtype, DF_MT))) {
-                        HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                    }
-                }
-                else {
-                    outntsubclass = DFKislitendNT(var->HDFtype) ? DFNTF_PC : DFNTF_HDFDEFAULT;
-                }
-
-                convert = (uintn)(platntsubclass != outntsubclass);
+    if (Hinquire(var->view_aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (special != SPECIAL_CHUNKED)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
 
-                /* make sure our tmp buffer is big enough to hold everything */
-                if (convert && tBuf_size < byte_count) {
-                    free(tBuf);
-                    tBuf_size = byte_count;
-                    tBuf      = malloc(tBuf_size);
-                    if (tBuf == NULL) {
-                        tBuf_size = 0;
-                        HGOTO_ERROR(DFE_NOSPACE, FAIL);
-                    }
-                }
+    /* get info about chunked element */
+    if (HDget_special_info(var->view_aid, &info_block) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
-                /* read chunk in */
-                if (convert) {
-                    /* read it in */
-                    if ((ret_value = HMCreadChunk(var->aid, origin, tBuf)) != FAIL) {
-                        /* convert chunk */
-                        if (FAIL == DFKconvert(tBuf, datap, var->HDFtype, (byte_count / var->HDFsize),
-                                               DFACC_READ, 0, 0)) {
-                            HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                        }
+    /* figure out if data needs to be converted */
+    if (FAIL == (platntsubclass = DFKgetPNSC(var->HDFtype, DF_MT))) {
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    }
 
-                        ret_value = SUCCEED;
-                    }
-                    else
-                        HGOTO_ERROR(DFE_READERROR, FAIL);
-                } /* end if */
-                else {
-                    if ((ret_value = HMCreadChunk(var->aid, origin, datap)) != FAIL) {
-                        ret_value = SUCCEED;
-                    }
-                    else
-                        HGOTO_ERROR(DFE_READERROR, FAIL);
-                }
-            } /* end if get special info block */
+    if (DFKisnativeNT(var->HDFtype)) {
+        if (FAIL == (outntsubclass = DFKgetPNSC(var->HDFtype, DF_MT))) {
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
         }
-        else /* not special CHUNKED */
-            ret_value = FAIL;
-    } /* end if Hinquire */
+    }
+    else {
+        outntsubclass = DFKislitendNT(var->HDFtype) ? DFNTF_PC : DFNTF_HDFDEFAULT;
+    }
 
-    /* End access to the access id */
-    if (Hendaccess(var->aid) == FAIL)
-        HGOTO_ERROR(DFE_CANTENDACCESS, FAIL);
-    var->aid = FAIL;
+    if ((csize = HMCgetChunkPtr(var->view_aid, origin, &chunk)) == FAIL)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
 
-done:
-    if (ret_value == FAIL) { /* Failure cleanup */
-        /* End access to the aid if necessary */
-        if (var && var->aid != FAIL) {
-            Hendaccess(var->aid);
-            var->aid = FAIL;
+    /* The chunk in the cache is as stored in the file; one that is not in
+       the native number type is converted to a buffer of its own, and
+       the cache is not held for it */
+    if (platntsubclass != outntsubclass) {
+        if ((tBuf = malloc((size_t)csize)) == NULL) {
+            HMCreleaseChunk(var->view_aid, chunk);
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        }
+        if (FAIL == DFKconvert((void *)chunk, tBuf, var->HDFtype, (csize / var->HDFsize), DFACC_READ, 0, 0)) {
+            HMCreleaseChunk(var->view_aid, chunk);
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
         }
+        if (HMCreleaseChunk(var->view_aid, chunk) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+        if ((bufs = realloc(var->view_bufs, (size_t)(var->nview_bufs + 1) * sizeof(void *))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        var->view_bufs                    = bufs;
+        var->view_bufs[var->nview_bufs++] = tBuf;
+
+        chunk = tBuf;
+        tBuf  = NULL;
     }
 
+    *datap = chunk;
+    if (chunk_lengths != NULL)
+        for (i = 0; i < info_block.ndims; i++)
+            chunk_lengths[i] = info_block.cdims[i];
+
+done:
     /* Release resource */
     free(info_block.cdims);
     free(tBuf);
 
     return ret_value;
-} /* SDreadchunk() */
+} /* SDgetchunkptr() */
 
 /******************************************************************************
 NAME
-     SDsetchunkcache - maximum number of chunks to cache
+     SDreleasechunk - give back a chunk gotten with SDgetchunkptr()
 
 DESCRIPTION
-     Set the maximum number of chunks to cache.
+     Unpins the chunk 'datap' returned by SDgetchunkptr() for the same
+     SDS, or frees it if it was converted to the native number type.
+     The pointer must not be used afterwards.
 
-     The cache contains the Least Recently Used(LRU cache replacement policy)
-     chunks. This routine allows the setting of maximum number of chunks that
-     can be cached, 'maxcache'.
+     NOTE:
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
 
-     The performance of the SDxxx interface with chunking is greatly
-     affected by the users access pattern over the dataset and by
-     the maximum number of chunks set in the chunk cache. The number chunks
-     that can be set in the cache is process memory limited. It is a good
-     idea to always set the maximum number of chunks in the cache as the
-     default heuristic does not take into account the memory available for
-     the application.
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+intn
+SDreleasechunk(int32       sdsid, /* IN: access aid to SDS */
+               const void *datap /* IN: the chunk */)
+{
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    intn    i;
+    intn    ret_value = SUCCEED;
 
-     By default when the SDS is promoted to a chunked element the
-     maximum number of chunks in the cache 'maxcache' is set to the number of
-     chunks along the last dimension.
+    /* clear error stack */
+    HEclear();
 
-     The values set here affects the current SDS object's caching behaviour.
+    if (datap == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
 
-     If the chunk cache is full and 'maxcache' is greater then the
-     current 'maxcache' value, then the chunk cache is reset to the new
-     'maxcache' value, else the chunk cache remains at the current
-     'maxcache' value.
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
 
-     If the chunk cache is not full, then the chunk cache is set to the
-     new 'maxcache' value only if the new 'maxcache' value is greater than the
-     current number of chunks in the cache.
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL || var->view_aid == FAIL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
 
-     Use flags argument of 'HDF_CACHEALL' if the whole object is to be cached
-     in memory, otherwise pass in zero(0). Currently you can only
-     pass in zero.
+    /* a converted chunk */
+    for (i = 0; i < var->nview_bufs; i++)
+        if (var->view_bufs[i] == datap) {
+            free(var->view_bufs[i]);
+            var->view_bufs[i] = var->view_bufs[--var->nview_bufs];
+            HGOTO_DONE(SUCCEED);
+        }
 
-     See SDsetchunk() for a description of the organization of chunks in an SDS.
+    /* a chunk in the cache */
+    if (HMCreleaseChunk(var->view_aid, datap) == FAIL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+done:
+    return ret_value;
+} /* SDreleasechunk() */
+
+/******************************************************************************
+NAME
+     SDchunkiter - visit the chunks written in storage order
+
+DESCRIPTION
+     Returns in 'origin' the origin of the next chunk of a chunked SDS
+     that was written, in the order the chunks are stored in the file.
+     '*cursor' is set to 0 to start and is advanced by each call.  See
+     mfhdf.h for the details.
 
      NOTE:
           This routine directly calls a Special Chunked Element fcn HMCxxx.
 
 RETURNS
-     Returns the 'maxcache' value for the chunk cache if successful
-     and FAIL otherwise
-
-AUTHOR
-      -GeorgeV
+     1 if a chunk was returned, 0 when all chunks were visited and FAIL
+     on error
 ******************************************************************************/
 intn
-SDsetchunkcache(int32 sdsid,    /* IN: access aid to mess with */
-                int32 maxcache, /* IN: max number of chunks to cache */
-                int32 flags /* IN: flags = 0, HDF_CACHEALL */)
+SDchunkiter(int32  sdsid,  /* IN: access aid to SDS */
+            int32 *cursor, /* IN/OUT: position of the visit, 0 to start */
+            int32 *origin /* OUT: origin of the next chunk */)
 {
     NC     *handle = NULL; /* file handle */
     NC_var *var    = NULL; /* SDS variable */
@@ -5663,15 +8575,6 @@ SDsetchunkcache(int32 sdsid,    /* IN: access aid to mess with */
     /* clear error stack */
     HEclear();
 
-    /* Check args */
-    if (maxcache < 1) {
-        HGOTO_ERROR(DFE_ARGS, FAIL);
-    }
-
-    if (flags != 0 && flags != HDF_CACHEALL) {
-        HGOTO_ERROR(DFE_ARGS, FAIL);
-    }
-
     /* get file handle and verify it is an HDF file
        we only handle dealing with SDS only not coordinate variables */
     handle = SDIhandle_from_id(sdsid, SDSTYPE);
@@ -5694,14 +8597,198 @@ SDsetchunkcache(int32 sdsid,    /* IN: access aid to mess with */
     ret_value = Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special);
     if (ret_value != FAIL) {
         if (special == SPECIAL_CHUNKED)
-            ret_value = HMCsetMaxcache(var->aid, maxcache, flags); /* set cache*/
+            ret_value = HMCnextChunk(var->aid, cursor, origin);
         else
             ret_value = FAIL;
     }
 
 done:
     return ret_value;
-} /* SDsetchunkcache() */
+} /* SDchunkiter() */
+
+/******************************************************************************
+NAME
+     SDsetchunkcachebudget - byte budget of the shared chunk cache pool
+
+DESCRIPTION
+     Sets the number of bytes that the chunk caches of all datasets that
+     joined the shared pool, by passing HDF_CACHE_SHARED to
+     SDsetchunkcache() or GRsetchunkcache(), may hold together, across
+     all open files.  The default is 64 MB.
+
+     Lowering the budget does not evict chunks right away, the pool
+     shrinks as the datasets in it read new chunks.
+
+     NOTE:
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+RETURNS
+     Returns the previous budget if successful and FAIL otherwise
+******************************************************************************/
+int32
+SDsetchunkcachebudget(int32 nbytes /* IN: bytes shared by the pooled caches */)
+{
+    int32 ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* Check args */
+    if (nbytes < 1) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    ret_value = HMCsetCacheBudget(nbytes);
+
+done:
+    return ret_value;
+} /* SDsetchunkcachebudget() */
+
+/******************************************************************************
+NAME
+     SDsetchunkdiskcache - keep the compressed chunks of remote files on local disk
+
+DESCRIPTION
+     Sets the directory of the local chunk cache, which keeps the compressed
+     chunks read from files opened read-only through a remote driver, such
+     as "http", see Hsetdriver(), so the next reads of these chunks, in this
+     or a later run, come from local disk instead of the network.  The
+     cache holds at most 'max_kbytes' KB, evicting the least recently used
+     chunks past that.  Setting the directory evicts at once down to the new
+     size, emptying the cache for a size of 0.  A NULL directory turns the
+     cache off.
+
+     NOTE:
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+RETURNS
+     SUCCEED if successful and FAIL otherwise
+******************************************************************************/
+intn
+SDsetchunkdiskcache(const char *dir, /* IN: directory of the cache, NULL for none */
+                    int32 max_kbytes /* IN: KB the cache may hold */)
+{
+    intn ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    ret_value = HMCsetDiskCache(dir, max_kbytes);
+
+    return ret_value;
+} /* SDsetchunkdiskcache() */
+
+/******************************************************************************
+NAME
+     SDsetbufferlimit - largest conversion buffer kept between calls
+
+DESCRIPTION
+     SDreaddata() and SDwritedata() convert data that is not in the
+     machine's number format through a buffer of the calling thread.  The
+     buffer is kept for the next call unless it is larger than 'nbytes', so
+     that one large request does not keep its buffer pinned.  The default
+     is 1 MB; 0 releases the buffers after every call.
+
+     The buffers of the calling thread are trimmed to the new limit right
+     away, those of other threads at their next call.
+
+RETURNS
+     Returns the previous limit if successful and FAIL otherwise
+******************************************************************************/
+int32
+SDsetbufferlimit(int32 nbytes /* IN: largest buffer to keep, in bytes */)
+{
+    int32 ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* Check args */
+    if (nbytes < 0) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    ret_value = SDPsetbuflimit(nbytes);
+
+done:
+    return ret_value;
+} /* SDsetbufferlimit() */
+
+/******************************************************************************
+NAME
+     SDfreebuffers - release the conversion buffers of the calling thread
+
+DESCRIPTION
+     Frees the buffers SDreaddata() and SDwritedata() keep for the calling
+     thread.  They are allocated again when needed.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+intn
+SDfreebuffers(void)
+{
+    /* clear error stack */
+    HEclear();
+
+    return SDPfreebuf();
+} /* SDfreebuffers() */
+
+/******************************************************************************
+NAME
+     SDsetxdrbuffersize - size of the I/O buffer of a netCDF file
+
+DESCRIPTION
+     Files in the netCDF classic format are read and written through a
+     buffer of 'nbytes' bytes, 1 MB by default or as given by
+     HDF4_IO_BUFSIZE, see Hsetconfig().  Reading past the end of
+     the buffer also asks the system to read the next bufferful ahead.
+
+     If fid is CACHE_ALL_FILES the size applies to the netCDF files opened
+     from then on, otherwise the buffer of the open file fid is flushed and
+     resized.  HDF files do their I/O through the H layer and do not use
+     this buffer, they fail here, as do netCDF files opened read-only that
+     are read from a memory mapping instead.
+
+RETURNS
+     Returns the previous size if successful and FAIL otherwise
+******************************************************************************/
+int32
+SDsetxdrbuffersize(int32 fid,   /* IN: file ID or CACHE_ALL_FILES */
+                   int32 nbytes /* IN: buffer size, in bytes */)
+{
+    NC   *handle    = NULL;
+    int32 ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* Check args */
+    if (nbytes <= 0) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    if (fid == CACHE_ALL_FILES) {
+        ret_value = (int32)NCxdrfile_bufsize(NULL, (int)nbytes);
+        goto done;
+    }
+
+    /* get the handle */
+    handle = SDIhandle_from_id(fid, CDFTYPE);
+    if (handle == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+    if (handle->file_type != netCDF_FILE) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    if ((ret_value = (int32)NCxdrfile_bufsize(handle->xdrs, (int)nbytes)) == FAIL) {
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    }
+
+done:
+    return ret_value;
+} /* SDsetxdrbuffersize() */
 
 /******************************************************************************
  NAME
@@ -5741,6 +8828,10 @@ SDcheckempty(int32 sdsid, /* IN: dataset ID */
     /* assume that the SDS is not empty until proving otherwise */
     *emptySDS = FALSE;
 
+    /* records given to SDappend() and not written yet make it non-empty */
+    if (var->app_nrecs > 0)
+        HGOTO_DONE(SUCCEED);
+
     /* if the data ref# of the SDS is 0, it indicates that the SDS has
     not been written with data because no storage is created
     for the SDS data */
@@ -5757,6 +8848,14 @@ SDcheckempty(int32 sdsid, /* IN: dataset ID */
             if (var->numrecs <= 0)
                 *emptySDS = TRUE;
         }
+        /* an open chunked SDS is empty if no chunk has been written */
+        else if (SDIopen_chunked(var)) {
+            int32 nwritten = HMCgetChunkMap(var->aid, NULL, NULL);
+
+            if (nwritten == FAIL)
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+            *emptySDS = nwritten == 0 ? TRUE : FALSE;
+        }
         /* handle other specialness via lower level functions */
         else {
             ret_value = HDcheck_empty(handle->hdf_file, var->data_tag, var->data_ref, emptySDS);
@@ -5827,7 +8926,8 @@ SDidtype(int32 an_id)
  DESCRIPTION
     Uses NC local function NC_reset_maxopenfiles to change the maximum
     number of opened files allowed.  This involves re-allocating of the
-    internal cdf list.
+    internal cdf list.  The list first made holds MAX_FILE files, or as
+    many as given by HDF4_MAX_FILES, see Hsetconfig().
 
  RETURNS
     The current maximum number of opened files allowed, or FAIL, if
@@ -5859,7 +8959,10 @@ done:
                 files allowed on a system.
 
  DESCRIPTION
-    Uses NC_get_maxopenfiles.
+    Uses NC_get_maxopenfiles.  HDF files only hold a file descriptor
+    while recently used, see Hsetmaxdescriptors(), so the "system limit"
+    is the number the list of open files first grows to; past it, it
+    keeps growing as more files are opened.
 
  RETURNS
     SUCCEED/FAIL
@@ -5915,6 +9018,82 @@ SDget_numopenfiles(void)
     return ret_value;
 } /* SDget_numopenfiles */
 
+/******************************************************************************
+ NAME
+    SDsetlazyopen -- sets whether SDstart reads the attributes of all
+                data sets when it opens a file.
+
+ DESCRIPTION
+    By default, SDstart reads the attributes of every data set and
+    coordinate variable in the file before returning.  With 'lazy' set to
+    TRUE, files opened afterwards only record the names, shapes and
+    references of their data sets, and the attributes of each one are read
+    the first time it is used through its SDS or dimension ID, e.g. by
+    SDgetinfo, SDfindattr or SDdiminfo.  This makes opening a file with
+    many data sets much faster when only a few of them are accessed.
+
+    The setting applies to all files opened by SDstart and ncopen after the
+    call; files that are already open are not affected.
+
+ RETURNS
+    The previous setting, TRUE or FALSE.
+
+******************************************************************************/
+intn
+SDsetlazyopen(intn lazy /* IN: TRUE to read attributes on first use */)
+{
+    intn ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    ret_value = hdf_set_lazy_open(lazy);
+    return ret_value;
+} /* SDsetlazyopen */
+
+/******************************************************************************
+ NAME
+    SDsetmetacache -- sets the number of files whose metadata are kept
+                after they are closed.
+
+ DESCRIPTION
+    SDstart reads the metadata of every data set, dimension and attribute
+    of a file when it opens it.  With 'nfiles' greater than 0, the
+    metadata of the last 'nfiles' HDF files opened read-only and closed by
+    SDend are kept, and opening one of them read-only again reuses them
+    instead of reading them, provided the file has not changed on disk
+    since, as told by its modification time, length, file serial number
+    and device.  A file modified twice in the same second without changing
+    length is not told apart; opening it for writing drops its metadata.
+
+    The files themselves are closed; their DD lists are kept too for as
+    many files as Hsetkeepopen() allows, so that opening them again reads
+    nothing at all.  By default no metadata are kept; SDsetmetacache(0)
+    frees those kept, and so does Htrim_memory().
+
+ RETURNS
+    SUCCEED / FAIL
+
+******************************************************************************/
+intn
+SDsetmetacache(intn nfiles /* IN: number of files, 0 to keep none */)
+{
+    intn ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    if (library_terminate == FALSE)
+        if (SDIstart() == FAIL)
+            HGOTO_ERROR(DFE_CANTINIT, FAIL);
+
+    if (NC_set_metacache(nfiles) == FAIL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+done:
+    return ret_value;
+} /* SDsetmetacache */
+
 /******************************************************************************
  NAME
     SDgetfilename -- retrieves the name of the file given its ID.
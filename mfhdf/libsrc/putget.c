@@ -18,6 +18,10 @@
 #include "local_nc.h"
 #include "hfile.h" /* Ugh!  We need the defs for HI_READ and HI_SEEK */
 
+#ifdef H4_HAVE_THREADSAFE
+#include <pthread.h>
+#endif
+
 /* Local function prototypes */
 static bool_t nssdc_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count,
                                 void *values);
@@ -34,6 +38,8 @@ int NC_fill_buffer(NC *handle, int varid, const long *edges, void *values);
 
 #define xdr_NCsetpos(xdrs, pos) xdr_setpos((xdrs), (pos))
 
+#define MAX_SIZE 1000000
+
 /*
  * Check if an ncxxx function has called the current function
  */
@@ -135,6 +141,7 @@ NCcoordck(NC *handle, NC_var *vp, const long *coords)
         NC_attr **attr  = NULL;
         int       count, byte_count;
         int       len;
+        long      blk_recs; /* records written by one Hwrite */
 
         /* Determine if fill values need to be written.  For example, if
            vp's numrecs is 5, and the accessed index is 8 (*ip), then recs
@@ -166,19 +173,25 @@ NCcoordck(NC *handle, NC_var *vp, const long *coords)
             if (vp->aid == FAIL && hdf_get_vp_aid(handle, vp) == FAIL)
                 return (FALSE);
 
-            /* strg and strg1 are to hold fill value and its conversion */
-            len   = (vp->len / vp->HDFsize) * vp->szof;
-            strg  = malloc(len);
-            strg1 = malloc(len);
+            byte_count = vp->len;
+            count      = byte_count / vp->HDFsize;
+
+            /* strg is to hold the fill values of a record, strg1 their
+               conversion repeated over as many records as fit in MAX_SIZE
+               bytes, so the records are filled with few large writes */
+            len      = count * vp->szof;
+            blk_recs = MAX(1, MIN(unfilled + 1, MAX_SIZE / MAX(byte_count, 1)));
+            strg     = malloc(len);
+            strg1    = malloc((size_t)blk_recs * byte_count);
             if (NULL == strg || NULL == strg1)
-                return FALSE;
+                goto fill_bad;
 
             /* Find the attribute _FillValue to get the user's fill value */
             attr = NC_findattr(&vp->attrs, _FillValue);
 
             /* If the attribute is found, fill strg with the fill value */
             if (attr != NULL)
-                HDmemfill(strg, (*attr)->data->values, vp->szof, (vp->len / vp->HDFsize));
+                HDmemfill(strg, (*attr)->data->values, vp->szof, count);
             /* otherwise, fill strg with predefined fill values such as
                     FILL_SHORT, FILL_BYTE,... */
             else
@@ -187,22 +200,21 @@ NCcoordck(NC *handle, NC_var *vp, const long *coords)
             /*
              * Seek to correct location
              */
-            byte_count = vp->len;
-            count      = byte_count / vp->HDFsize;
-
             if (FAIL == Hseek(vp->aid, (vp->numrecs) * byte_count, DF_START))
-                return FALSE;
+                goto fill_bad;
 
             /*
              * Write out the values
              */
             if (FAIL == DFKconvert(strg, strg1, vp->HDFtype, count, DFACC_WRITE, 0, 0))
-                return FALSE;
+                goto fill_bad;
+            HDmemfill(strg1, strg1, byte_count, blk_recs);
 
             /* Write fill value to each record for all "unfilled" records */
-            for (; unfilled >= 0; unfilled--, vp->numrecs++) {
-                if (FAIL == Hwrite(vp->aid, byte_count, (uint8 *)strg1))
-                    return FALSE;
+            for (unfilled++; unfilled > 0; unfilled -= blk_recs, vp->numrecs += blk_recs) {
+                blk_recs = MIN(blk_recs, unfilled);
+                if (FAIL == Hwrite(vp->aid, blk_recs * byte_count, (uint8 *)strg1))
+                    goto fill_bad;
             }
 
             free(strg);
@@ -217,6 +229,11 @@ NCcoordck(NC *handle, NC_var *vp, const long *coords)
         }
 
         return (TRUE);
+
+fill_bad:
+        free(strg);
+        free(strg1);
+        return (FALSE);
     }
 
     /**********************************************/
@@ -502,36 +519,149 @@ xdr_NCv1data(XDR *xdrs, u_long where, nc_type type, Void *values)
  *
  *****************************************************************************/
 
-static int32 tBuf_size    = 0;
-static int32 tValues_size = 0;
-static int8 *tBuf         = NULL;
-static int8 *tValues      = NULL;
+/* Default of the largest conversion buffer kept between calls */
+#define CONVBUF_LIMIT (1024 * 1024)
+
+/* Conversion buffers of a thread, kept between calls up to SDIbuf_limit bytes each */
+typedef struct {
+    int8 *tBuf;         /* data or fill values before or after conversion */
+    int32 tBuf_size;    /* size of tBuf in bytes */
+    int8 *tValues;      /* converted fill values */
+    int32 tValues_size; /* size of tValues in bytes */
+} SDIconvbuf_t;
+
+/* Largest buffer kept between calls, see SDsetbufferlimit() */
+static int32 SDIbuf_limit = CONVBUF_LIMIT;
+
+#ifdef H4_HAVE_THREADSAFE
+static pthread_once_t SDIbuf_once = PTHREAD_ONCE_INIT;
+static pthread_key_t  SDIbuf_key;
+
+/* Free the conversion buffers of a thread that exits */
+static void
+SDIfree_convbuf(void *arg)
+{
+    SDIconvbuf_t *bufs = (SDIconvbuf_t *)arg;
+
+    HDlarge_free(bufs->tBuf, (size_t)bufs->tBuf_size);
+    HDlarge_free(bufs->tValues, (size_t)bufs->tValues_size);
+    HDmem_release(HDF_MEM_SCRATCH, (size_t)bufs->tBuf_size + (size_t)bufs->tValues_size);
+    free(bufs);
+}
+
+static void
+SDIcreate_key(void)
+{
+    pthread_key_create(&SDIbuf_key, SDIfree_convbuf);
+}
+
+/* ------------------------------ SDIget_convbuf ------------------------------ */
+/*
+    Get the conversion buffers of the calling thread, NULL if out of memory
+*/
+static SDIconvbuf_t *
+SDIget_convbuf(void)
+{
+    SDIconvbuf_t *bufs;
+
+    pthread_once(&SDIbuf_once, SDIcreate_key);
+    if ((bufs = (SDIconvbuf_t *)pthread_getspecific(SDIbuf_key)) == NULL) {
+        if ((bufs = (SDIconvbuf_t *)calloc(1, sizeof(SDIconvbuf_t))) == NULL)
+            return NULL;
+        if (pthread_setspecific(SDIbuf_key, bufs) != 0) {
+            free(bufs);
+            return NULL;
+        }
+    }
+
+    return bufs;
+}
+#else
+static SDIconvbuf_t SDIconvbuf = {NULL, 0, NULL, 0};
+
+#define SDIget_convbuf() (&SDIconvbuf)
+#endif /* H4_HAVE_THREADSAFE */
+
+/* ------------------------------ SDItrimbuf ------------------------------ */
+/*
+    Throw away the buffers that grew past the limit for one large request;
+    smaller ones are kept for the next call
+*/
+static void
+SDItrimbuf(SDIconvbuf_t *bufs)
+{
+    if (bufs->tBuf_size > SDIbuf_limit) {
+        HDlarge_free(bufs->tBuf, (size_t)bufs->tBuf_size);
+        HDmem_release(HDF_MEM_SCRATCH, (size_t)bufs->tBuf_size);
+        bufs->tBuf      = NULL;
+        bufs->tBuf_size = 0;
+    }
+
+    if (bufs->tValues_size > SDIbuf_limit) {
+        HDlarge_free(bufs->tValues, (size_t)bufs->tValues_size);
+        HDmem_release(HDF_MEM_SCRATCH, (size_t)bufs->tValues_size);
+        bufs->tValues      = NULL;
+        bufs->tValues_size = 0;
+    }
+}
 
 /* ------------------------------ SDPfreebuf ------------------------------ */
 /*
-    Throw away the temporary buffer we've allocated
+    Throw away the temporary buffers the calling thread has allocated
 */
 intn
 SDPfreebuf(void)
 {
-    if (tBuf != NULL) {
-        free(tBuf);
-        tBuf      = NULL;
-        tBuf_size = 0;
+    SDIconvbuf_t *bufs;
+
+#ifdef H4_HAVE_THREADSAFE
+    pthread_once(&SDIbuf_once, SDIcreate_key);
+    if ((bufs = (SDIconvbuf_t *)pthread_getspecific(SDIbuf_key)) == NULL)
+        return SUCCEED;
+#else
+    bufs = SDIget_convbuf();
+#endif
+
+    if (bufs->tBuf != NULL) {
+        HDlarge_free(bufs->tBuf, (size_t)bufs->tBuf_size);
+        HDmem_release(HDF_MEM_SCRATCH, (size_t)bufs->tBuf_size);
+        bufs->tBuf      = NULL;
+        bufs->tBuf_size = 0;
     }
 
-    if (tValues != NULL) {
-        free(tValues);
-        tValues      = NULL;
-        tValues_size = 0;
+    if (bufs->tValues != NULL) {
+        HDlarge_free(bufs->tValues, (size_t)bufs->tValues_size);
+        HDmem_release(HDF_MEM_SCRATCH, (size_t)bufs->tValues_size);
+        bufs->tValues      = NULL;
+        bufs->tValues_size = 0;
     }
 
     return SUCCEED;
 }
 
+/* ------------------------------ SDPsetbuflimit ------------------------------ */
+/*
+    Set the largest conversion buffer kept between calls, returns the
+    previous limit.  The buffers of the calling thread are trimmed right away.
+*/
+int32
+SDPsetbuflimit(int32 nbytes)
+{
+    int32         ret_value = SDIbuf_limit;
+    SDIconvbuf_t *bufs;
+
+    SDIbuf_limit = nbytes;
+    if ((bufs = SDIget_convbuf()) != NULL)
+        SDItrimbuf(bufs);
+
+    return ret_value;
+}
+
 /* ------------------------------ SDIresizebuf ------------------------------ */
 /*
-    Resize a temporary buffer to the proper size
+    Resize a temporary buffer to the proper size.  Every caller fills the
+    buffer before using it, so it is not cleared.  A large one may be made
+    of huge pages, see Hsethugepages().
 */
 static intn
 SDIresizebuf(void **buf, int32 *buf_size, int32 size_wanted)
@@ -539,22 +669,22 @@ SDIresizebuf(void **buf, int32 *buf_size, int32 size_wanted)
     intn ret_value = SUCCEED;
 
     if (*buf_size < size_wanted) {
-        free(*buf);
+        HDlarge_free(*buf, (size_t)*buf_size);
+        HDmem_release(HDF_MEM_SCRATCH, (size_t)*buf_size);
         *buf_size = size_wanted;
-        *buf      = calloc(1, size_wanted);
+        *buf      = HDlarge_alloc((size_t)size_wanted);
         if (*buf == NULL) {
             *buf_size = 0;
             ret_value = FAIL;
             goto done;
         }
+        HDmem_acquire(HDF_MEM_SCRATCH, (size_t)size_wanted);
     }
 
 done:
     return ret_value;
 } /* end SDIresizebuf() */
 
-#define MAX_SIZE 1000000
-
 /* ------------------------- hdf_get_data ------------------- */
 /*
  * Given a variable vgid return the id of a valid data storage
@@ -764,6 +894,10 @@ hdf_get_vp_aid(NC *handle, NC_var *vp)
                 Hstartaccess(handle->hdf_file, vp->data_tag, vp->data_ref, DFACC_WRITE | DFACC_APPENDABLE);
     }
 
+    /* Reads of small pieces go through the sieve buffer, see SDsetsievebuf() */
+    if (vp->aid != FAIL && vp->sieve_size > 0)
+        Hsetsievebuf(vp->aid, vp->sieve_size);
+
     ret_value = vp->aid;
 
 done:
@@ -791,18 +925,24 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
     int32     data_size;         /* size of data block being processed in bytes */
     int32     new_count; /* computed by dividing number of elements 'count' by 2 since 'count' is too big to
                             allocate temporary buffer */
-    int32  bytes_left;
-    int32  elem_length;    /* length of the element pointed to */
-    int8   platntsubclass; /* the machine type of the current platform */
-    int8   outntsubclass;  /* the data's machine type */
-    uintn  convert;        /* whether to convert or not */
-    uint8 *pvalues;        /* pointer to traverse user's buffer "values" */
-    int16  isspecial;
-    intn   ret_value    = SUCCEED;
-    int32  alloc_status = FAIL; /* no successful allocation yet */
+    int32         bytes_left;
+    int32         elem_length;    /* length of the element pointed to */
+    int8          platntsubclass; /* the machine type of the current platform */
+    int8          outntsubclass;  /* the data's machine type */
+    uintn         convert;        /* whether to convert or not */
+    uint8        *pvalues;        /* pointer to traverse user's buffer "values" */
+    int16         isspecial;
+    SDIconvbuf_t *bufs         = NULL; /* the calling thread's conversion buffers */
+    intn          ret_value    = SUCCEED;
+    int32         alloc_status = FAIL; /* no successful allocation yet */
 
     (void)type;
 
+    if ((bufs = SDIget_convbuf()) == NULL) {
+        ret_value = FAIL;
+        goto done;
+    }
+
     if (vp->aid == FAIL && hdf_get_vp_aid(handle, vp) == FAIL) {
         /*
          * Fail if there is no data *AND* we were trying to read...
@@ -898,7 +1038,7 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
             new_count = vp->data_offset / vp->HDFsize;
 
             /* attempt to allocate the entire amount needed first, data_size bytes */
-            alloc_status = SDIresizebuf((void **)&tBuf, &tBuf_size, data_size);
+            alloc_status = SDIresizebuf((void **)&bufs->tBuf, &bufs->tBuf_size, data_size);
 
             /* if fail to allocate, repeatedly calculate a new amount
             and allocate until success or until no more memory available */
@@ -911,7 +1051,7 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
                 }
                 /* re-calculate the size of the data block using smaller # of elements */
                 data_size    = new_count * vp->szof;
-                alloc_status = SDIresizebuf((void **)&tBuf, &tBuf_size, data_size);
+                alloc_status = SDIresizebuf((void **)&bufs->tBuf, &bufs->tBuf_size, data_size);
             } /* while trying to allocate */
 
             /* assume that all elements are to be processed */
@@ -923,20 +1063,21 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
             while (elements_left > 0) {
                 /* Fill the temporary buffer with the fill-value */
                 if (attr != NULL)
-                    HDmemfill(tBuf, (*attr)->data->values, vp->szof, new_count);
+                    HDmemfill(bufs->tBuf, (*attr)->data->values, vp->szof, new_count);
                 else
-                    NC_arrayfill(tBuf, data_size, vp->type);
+                    NC_arrayfill(bufs->tBuf, data_size, vp->type);
 
                 /* convert the fill-values, if necessary */
                 if (convert) {
-                    if (FAIL == DFKconvert(tBuf, tBuf, vp->HDFtype, (uint32)new_count, DFACC_WRITE, 0, 0)) {
+                    if (FAIL ==
+                        DFKconvert(bufs->tBuf, bufs->tBuf, vp->HDFtype, (uint32)new_count, DFACC_WRITE, 0, 0)) {
                         ret_value = FAIL;
                         goto done;
                     }
                 } /* end if convert */
 
                 /* Write the fill-values out */
-                status = Hwrite(vp->aid, data_size, tBuf);
+                status = Hwrite(vp->aid, data_size, bufs->tBuf);
                 if (data_size == status) {
                     ret_value = FAIL;
                     goto done;
@@ -953,10 +1094,10 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
                 }
             } /* while more elements left to be processed */
 
-            SDPfreebuf(); /* free tBuf and tValues if any exists */
-                          /* end of BMR part */
-        }                 /* end if */
-    }                     /* end if */
+            SDItrimbuf(bufs); /* drop the buffers grown past the limit */
+                              /* end of BMR part */
+        }                     /* end if */
+    }                         /* end if */
 
     /* if we get here and the length is 0, we need to fill in the initial set of fill-values */
     if (elem_length <= 0 && where > 0) { /* fill in the lead sequence of bytes with the fill values */
@@ -980,7 +1121,7 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
             /* while any allocation fails */
             while (alloc_status == FAIL) {
                 /* try to allocate the buffer to hold the fill values after conversion */
-                alloc_status = SDIresizebuf((void **)&tValues, &tValues_size, chunk_size);
+                alloc_status = SDIresizebuf((void **)&bufs->tValues, &bufs->tValues_size, chunk_size);
                 /* then, if successful, try to allocate the temporary
                 buffer that holds the fill values before conversion */
                 if (alloc_status != FAIL) {
@@ -993,7 +1134,7 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
                         the buffer to hold fill_count fill values of type
                         vp->szof, i.e., before conversion */
                     tempbuf_size = fill_count * vp->szof;
-                    alloc_status = SDIresizebuf((void **)&tBuf, &tBuf_size, tempbuf_size);
+                    alloc_status = SDIresizebuf((void **)&bufs->tBuf, &bufs->tBuf_size, tempbuf_size);
                 } /* if first allocation successes */
 
                 if (alloc_status == FAIL)        /* if any allocations fail */
@@ -1010,21 +1151,21 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
             specified in the attribute if one exists, otherwise,
             with the default value */
             if (attr != NULL)
-                HDmemfill(tBuf, (*attr)->data->values, vp->szof, fill_count);
+                HDmemfill(bufs->tBuf, (*attr)->data->values, vp->szof, fill_count);
             else
-                NC_arrayfill(tBuf, tempbuf_size, vp->type);
+                NC_arrayfill(bufs->tBuf, tempbuf_size, vp->type);
 
             /* convert the fill-values, if necessary, and store
             them in the buffer tValues */
             if (convert) {
-                if (FAIL == DFKconvert(tBuf, tValues, vp->HDFtype, fill_count, DFACC_WRITE, 0, 0)) {
+                if (FAIL == DFKconvert(bufs->tBuf, bufs->tValues, vp->HDFtype, fill_count, DFACC_WRITE, 0, 0)) {
                     ret_value = FAIL;
                     goto done;
                 }
-                write_buf = (uint8 *)tValues;
+                write_buf = (uint8 *)bufs->tValues;
             } /* end if */
             else
-                write_buf = (uint8 *)tBuf;
+                write_buf = (uint8 *)bufs->tBuf;
 
             do {
                 /* Write the fill-values out */
@@ -1061,13 +1202,26 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
     /* Read or write the data into / from values */
     if (handle->xdrs->x_op == XDR_DECODE) /* the read case */
     {
-        if (convert) /* if data need to be converted for this platform */
+        if (convert && vp->HDFsize == vp->szof) /* only the byte order differs */
+        {
+            /* read directly into the user's buffer and convert it there */
+            status = Hread(vp->aid, byte_count, values);
+            if (status != byte_count) {
+                ret_value = FAIL;
+                goto done;
+            }
+            if (FAIL == DFKconvert(values, values, vp->HDFtype, count, DFACC_READ, 0, 0)) {
+                ret_value = FAIL;
+                goto done;
+            }
+        }
+        else if (convert) /* if data need to be converted for this platform */
         {
             data_size = byte_count; /* use data_size; preserve the byte count */
             new_count = count;      /* use new_count; preserve the # of elements */
 
             /* attempt to allocate the entire amount needed first */
-            alloc_status = SDIresizebuf((void **)&tBuf, &tBuf_size, data_size);
+            alloc_status = SDIresizebuf((void **)&bufs->tBuf, &bufs->tBuf_size, data_size);
 
             /* if fail to allocate, repeatedly calculate a new amount and
                 allocate until success or until no memory available */
@@ -1081,7 +1235,7 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
 
                 /* re-calculate the size of the data block */
                 data_size    = new_count * vp->szof;
-                alloc_status = SDIresizebuf((void **)&tBuf, &tBuf_size, data_size);
+                alloc_status = SDIresizebuf((void **)&bufs->tBuf, &bufs->tBuf_size, data_size);
             }
 
             /* repeatedly read, convert, and store blocks of data_size
@@ -1095,7 +1249,7 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
             pvalues = values;
 
             while (elements_left > 0) {
-                status = Hread(vp->aid, data_size, tBuf);
+                status = Hread(vp->aid, data_size, bufs->tBuf);
                 if (status != data_size) /* amount read != amount specified */
                 {
                     ret_value = FAIL;
@@ -1103,7 +1257,7 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
                 }
                 /* convert and store new_count elements in tBuf into
                    the buffer values, pointed to by pvalues */
-                if (FAIL == DFKconvert(tBuf, pvalues, vp->HDFtype, (uint32)new_count, DFACC_READ, 0, 0)) {
+                if (FAIL == DFKconvert(bufs->tBuf, pvalues, vp->HDFtype, (uint32)new_count, DFACC_READ, 0, 0)) {
                     ret_value = FAIL;
                     goto done;
                 }
@@ -1122,9 +1276,9 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
                 pvalues = pvalues + data_size;
             } /* while more elements left to be processed */
 
-            SDPfreebuf(); /* free tBuf and tValues if any exist */
-        }                 /* end if convert */
-        else              /* no convert, read directly into the user's buffer */
+            SDItrimbuf(bufs); /* drop the buffers grown past the limit */
+        }                     /* end if convert */
+        else                  /* no convert, read directly into the user's buffer */
         {
             status = Hread(vp->aid, byte_count, values);
             if (status != byte_count) {
@@ -1133,14 +1287,30 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
             }
         }            /* end else */
     }                /* end if XDR_DECODE */
-    else {           /* XDR_ENCODE */
-        if (convert) /* if data need to be converted for this platform */
+    else { /* XDR_ENCODE */
+        /* keep the range of the values while they are in cache, before any conversion */
+        if (vp->autorange)
+            NC_range_update(vp, values, (long)count);
+
+        if (convert && vp->HDFsize == vp->szof && (handle->flags & NC_INPLACE)) {
+            /* the user let us convert their buffer, write directly from it */
+            if (FAIL == DFKconvert(values, values, vp->HDFtype, count, DFACC_WRITE, 0, 0)) {
+                ret_value = FAIL;
+                goto done;
+            }
+            status = Hwrite(vp->aid, byte_count, values);
+            if (status != byte_count) {
+                ret_value = FAIL;
+                goto done;
+            }
+        }
+        else if (convert) /* if data need to be converted for this platform */
         {
             data_size = byte_count; /* use data_size; preserve the byte count*/
             new_count = count;      /* use new_count; preserve the # of elements */
 
             /* attempt to allocate the entire amount needed first */
-            alloc_status = SDIresizebuf((void **)&tBuf, &tBuf_size, data_size);
+            alloc_status = SDIresizebuf((void **)&bufs->tBuf, &bufs->tBuf_size, data_size);
 
             /* if fail to allocate, repeatedly calculate a new amount and
                allocate until success or no more memory left */
@@ -1154,7 +1324,7 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
 
                 /* re-calculate the size of the data block */
                 data_size    = new_count * vp->HDFsize;
-                alloc_status = SDIresizebuf((void **)&tBuf, &tBuf_size, data_size);
+                alloc_status = SDIresizebuf((void **)&bufs->tBuf, &bufs->tBuf_size, data_size);
             }
 
             /* repeatedly convert, store blocks of data_size bytes of data
@@ -1170,11 +1340,11 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
             while (elements_left > 0) {
                 /* convert new_count elements in the user's buffer values and
                    write them into the temporary buffer */
-                if (FAIL == DFKconvert(pvalues, tBuf, vp->HDFtype, (uint32)new_count, DFACC_WRITE, 0, 0)) {
+                if (FAIL == DFKconvert(pvalues, bufs->tBuf, vp->HDFtype, (uint32)new_count, DFACC_WRITE, 0, 0)) {
                     ret_value = FAIL;
                     goto done;
                 }
-                status = Hwrite(vp->aid, data_size, tBuf);
+                status = Hwrite(vp->aid, data_size, bufs->tBuf);
                 if (status != data_size) {
                     ret_value = FAIL;
                     goto done;
@@ -1193,9 +1363,9 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
                 pvalues = pvalues + data_size;
             } /* while more elements left to be processed */
 
-            SDPfreebuf(); /* free tBuf and tValues if any exist */
-        }                 /* end if convert */
-        else {            /* no convert, write directly from the user's buffer */
+            SDItrimbuf(bufs); /* drop the buffers grown past the limit */
+        }                     /* end if convert */
+        else {                /* no convert, write directly from the user's buffer */
             status = Hwrite(vp->aid, byte_count, values);
 
             if (status != byte_count) {
@@ -1228,7 +1398,7 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
             while (alloc_status == FAIL) {
                 /* first, try to allocate the buffer to hold the fill
                    values after conversion */
-                alloc_status = SDIresizebuf((void **)&tValues, &tValues_size, chunk_size);
+                alloc_status = SDIresizebuf((void **)&bufs->tValues, &bufs->tValues_size, chunk_size);
 
                 /* then, if successful, try to allocate the temporary
                     buffer that holds the fill values before conversion */
@@ -1242,7 +1412,7 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
                        buffer to hold fill_count fill values of type
           vp->szof, i.e., before conversion */
                     tempbuf_size = fill_count * vp->szof;
-                    alloc_status = SDIresizebuf((void **)&tBuf, &tBuf_size, tempbuf_size);
+                    alloc_status = SDIresizebuf((void **)&bufs->tBuf, &bufs->tBuf_size, tempbuf_size);
                 } /* if first allocation successes */
 
                 if (alloc_status == FAIL)        /* if any allocations fail */
@@ -1259,20 +1429,20 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
             /* Fill the temporary buffer tBuf with the fill-value specified                    in the
              * attribute if one exists, otherwise, with the default value */
             if (attr != NULL)
-                HDmemfill(tBuf, (*attr)->data->values, vp->szof, fill_count);
+                HDmemfill(bufs->tBuf, (*attr)->data->values, vp->szof, fill_count);
             else
-                NC_arrayfill(tBuf, tempbuf_size, vp->type);
+                NC_arrayfill(bufs->tBuf, tempbuf_size, vp->type);
 
             /* convert the fill-values, if necessary, and store them in the buffer tValues */
             if (convert) {
-                if (FAIL == DFKconvert(tBuf, tValues, vp->HDFtype, fill_count, DFACC_WRITE, 0, 0)) {
+                if (FAIL == DFKconvert(bufs->tBuf, bufs->tValues, vp->HDFtype, fill_count, DFACC_WRITE, 0, 0)) {
                     ret_value = FAIL;
                     goto done;
                 }
-                write_buf = (uint8 *)tValues;
+                write_buf = (uint8 *)bufs->tValues;
             } /* end if */
             else
-                write_buf = (uint8 *)tBuf;
+                write_buf = (uint8 *)bufs->tBuf;
 
             do {
                 /* Write the fill-values out */
@@ -1292,6 +1462,8 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
     }     /* end if */
 
 done:
+    if (bufs != NULL)
+        SDItrimbuf(bufs);
     return ret_value;
 } /* hdf_xdr_NCvdata */
 
@@ -1332,12 +1504,16 @@ done:
 static bool_t
 nssdc_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count, void *values)
 {
-    int32 status;
-    int32 byte_count;
+    SDIconvbuf_t *bufs;
+    int32         status;
+    int32         byte_count;
 
     (void)type;
     (void)values;
 
+    if ((bufs = SDIget_convbuf()) == NULL)
+        return (FALSE);
+
     /* position ourselves correctly */
     status = HI_SEEK((hdf_file_t)handle->cdf_fp, where);
     if (status == FAIL)
@@ -1345,8 +1521,9 @@ nssdc_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 cou
 
     /* make sure our tmp buffer is big enough to hold everything */
     byte_count = count * vp->HDFsize;
-    if (SDIresizebuf((void **)&tBuf, &tBuf_size, byte_count) == FAIL)
+    if (SDIresizebuf((void **)&bufs->tBuf, &bufs->tBuf_size, byte_count) == FAIL)
         return (FALSE);
+    SDItrimbuf(bufs);
 
     return (TRUE);
 
@@ -1366,6 +1543,8 @@ NCvar1io(NC *handle, int varid, const long *coords, Void *value)
     vp = NC_hlookupvar(handle, varid);
     if (vp == NULL)
         return (-1);
+    if (handle->xdrs->x_op == XDR_ENCODE)
+        NC_free_scale(vp);
 
     if (vp->assoc->count == 0) /* 'scaler' variable */
     {
@@ -1436,6 +1615,76 @@ ncvarget1(int cdfid, int varid, const long *coords, ncvoid *value)
     return (NCvar1io(handle, varid, coords, (Void *)value));
 }
 
+/*
+ * Decode 'count' items of 'xdr_size' bytes at the current position
+ * straight from the stream into 'values', when the stream can hand out a
+ * pointer to them (see xdrmmap_inline() in xdrposix.c).  Returns FALSE,
+ * with the position unchanged, when it cannot.
+ */
+static bool_t
+xdr_NCvinline(XDR *xdrs, int32 ntype, unsigned xdr_size, unsigned count, Void *values)
+{
+    u_int    pos;
+    int32_t *ip;
+
+    if (xdrs->x_op != XDR_DECODE || count == 0 || count > (unsigned)INT32_MAX / xdr_size)
+        return (FALSE);
+
+    pos = xdr_getpos(xdrs);
+    if ((ip = XDR_INLINE(xdrs, count * xdr_size)) == NULL)
+        return (FALSE);
+    if (DFKconvert(ip, values, ntype, (int32)count, DFACC_READ, 0, 0) == FAIL) {
+        (void)xdr_NCsetpos(xdrs, pos);
+        return (FALSE);
+    }
+    return (TRUE);
+}
+
+/*
+ * xdr 'count' items of 'xdr_size' bytes, the native size of type 'ntype',
+ * at the current position a block at a time rather than an item at a time:
+ * decoded values are read straight into 'values' and converted there,
+ * encoded ones are converted into the conversion buffer and written from
+ * it.  DFKconvert() swaps the bytes of a whole block at once.
+ */
+static bool_t
+xdr_NCvbulk(XDR *xdrs, int32 ntype, unsigned xdr_size, unsigned count, Void *values)
+{
+    SDIconvbuf_t *bufs;
+    unsigned      block;
+    bool_t        ret_value = TRUE;
+
+    if (count == 0)
+        return (TRUE);
+    if (count > (unsigned)INT32_MAX / xdr_size)
+        return (FALSE);
+
+    if (xdrs->x_op == XDR_DECODE) {
+        if (!XDR_GETBYTES(xdrs, (char *)values, count * xdr_size))
+            return (FALSE);
+        return (DFKconvert(values, values, ntype, (int32)count, DFACC_READ, 0, 0) != FAIL);
+    }
+
+    if ((bufs = SDIget_convbuf()) == NULL)
+        return (FALSE);
+    block = MIN(count, CONVBUF_LIMIT / xdr_size);
+    if (SDIresizebuf((void **)&bufs->tBuf, &bufs->tBuf_size, (int32)(block * xdr_size)) == FAIL)
+        return (FALSE);
+
+    for (; count > 0; count -= block) {
+        block = MIN(block, count);
+        if (DFKconvert(values, bufs->tBuf, ntype, (int32)block, DFACC_WRITE, 0, 0) == FAIL ||
+            !XDR_PUTBYTES(xdrs, (char *)bufs->tBuf, block * xdr_size)) {
+            ret_value = FALSE;
+            break;
+        }
+        values += block * xdr_size;
+    }
+
+    SDItrimbuf(bufs);
+    return (ret_value);
+}
+
 /*
  * xdr 'count' items of contiguous data of type 'type' at 'where'
  */
@@ -1446,6 +1695,7 @@ xdr_NCvdata(XDR *xdrs, u_long where, nc_type type, unsigned count, Void *values)
     bool_t (*xdr_NC_fnct)();
     bool_t stat;
     size_t szof;
+    int32  ntype;
 
     switch (type) {
         case NC_BYTE:
@@ -1492,7 +1742,8 @@ xdr_NCvdata(XDR *xdrs, u_long where, nc_type type, unsigned count, Void *values)
             }
             rem = count % 2; /* tail remainder */
             count -= rem;
-            if (!xdr_shorts(xdrs, (short *)values, count))
+            if (!xdr_NCvinline(xdrs, DFNT_INT16, 2, count, values) &&
+                !xdr_NCvbulk(xdrs, DFNT_INT16, 2, count, values))
                 return (FALSE);
             if (rem != 0) {
                 values += (count * sizeof(short));
@@ -1502,18 +1753,25 @@ xdr_NCvdata(XDR *xdrs, u_long where, nc_type type, unsigned count, Void *values)
         case NC_LONG:
             xdr_NC_fnct = xdr_int;
             szof        = sizeof(nclong);
+            ntype       = DFNT_INT32;
             break;
         case NC_FLOAT:
             xdr_NC_fnct = xdr_float;
             szof        = sizeof(float);
+            ntype       = DFNT_FLOAT32;
             break;
         case NC_DOUBLE:
             xdr_NC_fnct = xdr_double;
             szof        = sizeof(double);
+            ntype       = DFNT_FLOAT64;
             break;
         default:
             return (FALSE);
     }
+    if (xdr_NCvinline(xdrs, ntype, (unsigned)NC_xtypelen(type), count, values))
+        return (TRUE);
+    if (szof == (size_t)NC_xtypelen(type))
+        return (xdr_NCvbulk(xdrs, ntype, (unsigned)szof, count, values));
     for (stat = TRUE; stat && (count > 0); count--) {
         stat = (*xdr_NC_fnct)(xdrs, values);
         values += szof;
@@ -1652,6 +1910,8 @@ NCvario(NC *handle, int varid, const long *start, const long *edges, void *value
     vp = NC_hlookupvar(handle, varid);
     if (vp == NULL)
         return (-1);
+    if (handle->xdrs->x_op == XDR_ENCODE)
+        NC_free_scale(vp);
 
     if (handle->file_type != netCDF_FILE) {
         if (FAIL == DFKsetNT(vp->HDFtype))
@@ -1972,73 +2232,110 @@ ncrecinq(int cdfid, int *nrecvars, int *recvarids, long *recsizes)
     return nrvars;
 }
 
+/*
+ * xdr 'nrecs' records, from 'recnum' on, of the record variables whose
+ * address in 'datap' is not null, each address holding the records of its
+ * variable one after the other.  The records of a variable of an HDF file
+ * are contiguous in its element, and are moved in one go; those of a
+ * netCDF file are interleaved with the other variables, and are moved a
+ * record at a time, in the order of the file, through its buffer.
+ */
 static int
-NCrecio(NC *handle, long recnum, Void **datap)
+NCrecio(NC *handle, long recnum, long nrecs, Void **datap)
 {
     int      nrvars;
     NC_var  *rvp[H4_MAX_NC_VARS];
     int      ii;
+    long     rec;
     long     coords[H4_MAX_VAR_DIMS];
     u_long   offset;
     unsigned iocount;
+    size_t   szof;
 
     nrvars = NCnumrecvars(handle, rvp, (int *)NULL);
     if (nrvars == -1)
         return -1; /* TODO: what error message ?*/
 
     memset(coords, 0, sizeof(coords));
-    coords[0] = recnum;
     for (ii = 0; ii < nrvars; ii++) {
         if (datap[ii] == NULL)
             continue;
         /* else */
-        offset  = NC_varoffset(handle, rvp[ii], coords);
-        iocount = NCelemsPerRec(rvp[ii]);
+        if (handle->xdrs->x_op == XDR_ENCODE)
+            NC_free_scale(rvp[ii]);
+        iocount = (unsigned)NCelemsPerRec(rvp[ii]);
+        szof    = (size_t)nctypelen(rvp[ii]->type);
+        if (nrecs > 1 && iocount > 0 && (unsigned long)nrecs > (unsigned long)UINT32_MAX / iocount) {
+            NCadvise(NC_EINVAL, "Too many records %ld", nrecs);
+            return (-1);
+        }
 
         switch (handle->file_type) {
             case HDF_FILE:
+                coords[0] = recnum;
+                offset    = NC_varoffset(handle, rvp[ii], coords);
                 DFKsetNT(rvp[ii]->HDFtype);
-                if (FAIL ==
-                    hdf_xdr_NCvdata(handle, rvp[ii], offset, rvp[ii]->type, (uint32)iocount, datap[ii]))
+                if (FAIL == hdf_xdr_NCvdata(handle, rvp[ii], offset, rvp[ii]->type,
+                                            (uint32)iocount * (uint32)nrecs, datap[ii]))
                     return (-1);
                 break;
             case CDF_FILE:
                 DFKsetNT(rvp[ii]->HDFtype);
-                if (!nssdc_xdr_NCvdata(handle, rvp[ii], offset, rvp[ii]->type, (uint32)iocount, datap[ii]))
-                    return (-1);
+                for (rec = 0; rec < nrecs; rec++) {
+                    coords[0] = recnum + rec;
+                    offset    = NC_varoffset(handle, rvp[ii], coords);
+                    if (!nssdc_xdr_NCvdata(handle, rvp[ii], offset, rvp[ii]->type, (uint32)iocount,
+                                           datap[ii] + (size_t)rec * iocount * szof))
+                        return (-1);
+                }
                 break;
             case netCDF_FILE:
-                if (!xdr_NCvdata(handle->xdrs, offset, rvp[ii]->type, iocount, datap[ii]))
-                    return (-1);
                 break;
         }
     }
+
+    if (handle->file_type != netCDF_FILE)
+        return 0;
+
+    for (rec = 0; rec < nrecs; rec++) {
+        coords[0] = recnum + rec;
+        for (ii = 0; ii < nrvars; ii++) {
+            if (datap[ii] == NULL)
+                continue;
+            offset  = NC_varoffset(handle, rvp[ii], coords);
+            iocount = (unsigned)NCelemsPerRec(rvp[ii]);
+            szof    = (size_t)nctypelen(rvp[ii]->type);
+            if (!xdr_NCvdata(handle->xdrs, offset, rvp[ii]->type, iocount,
+                             datap[ii] + (size_t)rec * iocount * szof))
+                return (-1);
+        }
+    }
     return 0;
 }
 
 /*
- * Write one record's worth of data, except don't write to variables for which
- * the address of the data to be written is null.  Return -1 on error.
+ * Write 'nrecs' records from 'recnum' on, filling the new records before
+ * them as needed, see NCrecio().
  */
-int
-ncrecput(int cdfid, long recnum, ncvoid **datap)
+static int
+NCrecput(NC *handle, long recnum, long nrecs, Void **datap)
 {
-    NC  *handle;
     long unfilled;
 
-    cdf_routine_name = "ncrecput";
-
-    handle = NC_check_id(cdfid);
-    if (handle == NULL)
-        return (-1);
     if (handle->flags & NC_INDEF)
         return (-1);
+    if (recnum < 0 || nrecs < 0) {
+        NCadvise(NC_EINVAL, "Invalid records %ld to %ld", recnum, recnum + nrecs - 1);
+        return (-1);
+    }
+    if (nrecs == 0)
+        return (0);
 
-    if ((unfilled = recnum - handle->numrecs) >= 0) {
+    if ((unfilled = recnum + nrecs - 1 - handle->numrecs) >= 0) {
         handle->flags |= NC_NDIRTY;
         if (handle->flags & NC_NOFILL) {
             /* Go directly to jail, do not pass go */
-            handle->numrecs = recnum + 1;
+            handle->numrecs = recnum + nrecs;
         }
         else {
             /* fill out new records */
@@ -2063,7 +2360,66 @@ ncrecput(int cdfid, long recnum, ncvoid **datap)
 
     handle->xdrs->x_op = XDR_ENCODE;
 
-    return (NCrecio(handle, recnum, (Void **)datap));
+    return (NCrecio(handle, recnum, nrecs, datap));
+}
+
+/*
+ * Read 'nrecs' records from 'recnum' on, see NCrecio().
+ */
+static int
+NCrecget(NC *handle, long recnum, long nrecs, Void **datap)
+{
+    if (handle->flags & NC_INDEF)
+        return (-1);
+    if (recnum < 0 || nrecs < 0) {
+        NCadvise(NC_EINVAL, "Invalid records %ld to %ld", recnum, recnum + nrecs - 1);
+        return (-1);
+    }
+    if (nrecs == 0)
+        return (0);
+
+    handle->xdrs->x_op = XDR_DECODE;
+
+    return (NCrecio(handle, recnum, nrecs, datap));
+}
+
+/*
+ * Write one record's worth of data, except don't write to variables for which
+ * the address of the data to be written is null.  Return -1 on error.
+ */
+int
+ncrecput(int cdfid, long recnum, ncvoid **datap)
+{
+    NC *handle;
+
+    cdf_routine_name = "ncrecput";
+
+    handle = NC_check_id(cdfid);
+    if (handle == NULL)
+        return (-1);
+
+    return (NCrecput(handle, recnum, 1L, (Void **)datap));
+}
+
+/*
+ * Write 'nrecs' consecutive records, from 'recnum' on, except don't write
+ * to variables for which the address of the data to be written is null.
+ * The data of each variable hold its records one after the other.  The
+ * records of a variable are written in one go in HDF files.  Return -1 on
+ * error.
+ */
+int
+ncrecputn(int cdfid, long recnum, long nrecs, ncvoid **datap)
+{
+    NC *handle;
+
+    cdf_routine_name = "ncrecputn";
+
+    handle = NC_check_id(cdfid);
+    if (handle == NULL)
+        return (-1);
+
+    return (NCrecput(handle, recnum, nrecs, (Void **)datap));
 }
 
 /*
@@ -2080,10 +2436,27 @@ ncrecget(int cdfid, long recnum, ncvoid **datap)
     handle = NC_check_id(cdfid);
     if (handle == NULL)
         return (-1);
-    if (handle->flags & NC_INDEF)
-        return (-1);
 
-    handle->xdrs->x_op = XDR_DECODE;
+    return (NCrecget(handle, recnum, 1L, (Void **)datap));
+}
+
+/*
+ * Read 'nrecs' consecutive records, from 'recnum' on, except don't read
+ * from variables for which the address of the data to be read is null.
+ * The data of each variable get its records one after the other.  The
+ * records of a variable are read in one go in HDF files.  Return -1 on
+ * error.
+ */
+int
+ncrecgetn(int cdfid, long recnum, long nrecs, ncvoid **datap)
+{
+    NC *handle;
+
+    cdf_routine_name = "ncrecgetn";
+
+    handle = NC_check_id(cdfid);
+    if (handle == NULL)
+        return (-1);
 
-    return (NCrecio(handle, recnum, (Void **)datap));
+    return (NCrecget(handle, recnum, nrecs, (Void **)datap));
 }
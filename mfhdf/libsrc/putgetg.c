@@ -25,6 +25,121 @@
 
 #include "local_nc.h"
 
+/*
+ * Strided reads are done by reading a span that covers the values wanted
+ * in the fastest varying dimensions, as long as it fits in NC_SIEVE_MAX
+ * bytes and skips no more than NC_SIEVE_GAP bytes between two values, and
+ * gathering the values from it.
+ */
+#define NC_SIEVE_MAX (1024 * 1024)
+#define NC_SIEVE_GAP 4096
+
+/*
+ * Gather the values of a strided hyperslab from the span read by
+ * NCsieveget(), for dimensions idim to maxidim.
+ */
+/* sieve  - the span, laid out as the variable with the span's edges */
+/* sstep  - bytes between two values of the span along each dimension */
+/* dstep  - bytes between two values of the hyperslab in memory */
+static void
+NCsievegather(const char *sieve, char *values, int idim, int maxidim, size_t szof, const long *count,
+              const long *stride, const long *sstep, const long *dstep)
+{
+    long i;
+
+    if (idim < maxidim) {
+        for (i = 0; i < count[idim]; i++)
+            NCsievegather(sieve + i * stride[idim] * sstep[idim], values + i * dstep[idim], idim + 1, maxidim,
+                          szof, count, stride, sstep, dstep);
+        return;
+    }
+
+    if (stride[idim] == 1 && dstep[idim] == (long)szof) {
+        memcpy(values, sieve, (size_t)count[idim] * szof);
+        return;
+    }
+
+    switch (szof) {
+        case 1:
+            for (i = 0; i < count[idim]; i++)
+                values[i * dstep[idim]] = sieve[i * stride[idim]];
+            break;
+        case 2:
+            for (i = 0; i < count[idim]; i++)
+                memcpy(values + i * dstep[idim], sieve + i * stride[idim] * 2, 2);
+            break;
+        case 4:
+            for (i = 0; i < count[idim]; i++)
+                memcpy(values + i * dstep[idim], sieve + i * stride[idim] * 4, 4);
+            break;
+        case 8:
+            for (i = 0; i < count[idim]; i++)
+                memcpy(values + i * dstep[idim], sieve + i * stride[idim] * 8, 8);
+            break;
+        default:
+            for (i = 0; i < count[idim]; i++)
+                memcpy(values + i * dstep[idim], sieve + i * stride[idim] * (long)szof, szof);
+            break;
+    }
+}
+
+/*
+ * Read a strided hyperslab by spans covering dimensions sdim to maxidim,
+ * one NCvario() call per span, and gather the values into place.
+ */
+static int
+NCsieveget(NC *handle, int varid, NC_var *vp, int maxidim, int sdim, const long *start, const long *count,
+           const long *stride, const long *imap, char *values)
+{
+    long  mystart[H4_MAX_VAR_DIMS];
+    long  iocount[H4_MAX_VAR_DIMS]; /* edges of a span */
+    long  sstep[H4_MAX_VAR_DIMS];   /* bytes between two values of a span */
+    long  stop[H4_MAX_VAR_DIMS];
+    long  nbytes = (long)vp->szof;
+    char *sieve;
+    char *valp = values;
+    int   idim;
+    int   ret_value = 0;
+
+    for (idim = maxidim; idim >= 0; --idim) {
+        mystart[idim] = start[idim];
+        stop[idim]    = start[idim] + count[idim] * stride[idim];
+        if (idim >= sdim) {
+            iocount[idim] = (count[idim] - 1) * stride[idim] + 1;
+            sstep[idim]   = nbytes;
+            nbytes *= iocount[idim];
+        }
+        else
+            iocount[idim] = 1;
+    }
+
+    if ((sieve = malloc((size_t)nbytes)) == NULL) {
+        nc_serror("NCsieveget");
+        return (-1);
+    }
+
+    for (;;) {
+        if ((ret_value = NCvario(handle, varid, mystart, iocount, (Void *)sieve)) != 0)
+            break;
+        NCsievegather(sieve, valp, sdim, maxidim, vp->szof, count, stride, sstep, imap);
+
+        /* Move to the next span, along the dimensions before sdim */
+        for (idim = sdim - 1; idim >= 0; --idim) {
+            valp += imap[idim];
+            mystart[idim] += stride[idim];
+            if (mystart[idim] < stop[idim])
+                break;
+            mystart[idim] = start[idim];
+            valp -= imap[idim] * count[idim];
+        }
+        if (idim < 0)
+            break;
+    }
+
+    free(sieve);
+    return ret_value;
+}
+
 /*
  * Perform I/O on a generalized hyperslab.  The efficiency of this
  * implementation is dependent upon caching in the lower layers.
@@ -94,6 +209,39 @@ NCgenio(NC *handle, int varid, const long *start, const long *count, const long
             stop[idim]    = mystart[idim] + mycount[idim] * mystride[idim];
         }
 
+        /*
+         * When reading with non-unity strides, read the spans that cover
+         * the fastest dimensions, as far as they are cheap to cover, in one
+         * go each and gather the values from them.
+         */
+        if (handle->xdrs->x_op == XDR_DECODE) {
+            long span    = (long)vp->szof; /* bytes in a span over dimensions sdim and up */
+            long vslice  = (long)vp->szof; /* bytes of the variable per index of idim */
+            int  sdim    = maxidim + 1;
+            int  strided = FALSE;
+
+            for (idim = maxidim; idim >= 0; --idim) {
+                long edge = (mycount[idim] - 1) * mystride[idim] + 1;
+
+                if (mycount[idim] < 1) { /* nothing to read */
+                    strided = FALSE;
+                    break;
+                }
+                if (sdim != idim + 1 || (mystride[idim] - 1) * vslice > NC_SIEVE_GAP ||
+                    span * edge > NC_SIEVE_MAX)
+                    continue;
+                span *= edge;
+                sdim = idim;
+                if (mystride[idim] > 1 && mycount[idim] > 1)
+                    strided = TRUE;
+                if (idim > 0)
+                    vslice *= (long)vp->shape[idim];
+            }
+
+            if (strided)
+                return NCsieveget(handle, varid, vp, maxidim, sdim, mystart, mycount, mystride, myimap, valp);
+        }
+
         /*
          * As an optimization, adjust I/O parameters when the fastest
          * dimension has unity stride both externally and internally.
@@ -17,8 +17,11 @@
 #include <string.h>
 #include "local_nc.h"
 
-static uint32
-compute_hash(unsigned count, const char *str)
+/*
+ * The [non-perfect] hash value of a string, as kept in NC_string.hash
+ */
+uint32
+NC_compute_hash(unsigned count, const char *str)
 {
     uint32 ret = 0;
     uint32 temp;
@@ -40,7 +43,7 @@ compute_hash(unsigned count, const char *str)
         ret += temp;
     } /* end if */
     return (ret);
-} /* end compute_hash() */
+} /* end NC_compute_hash() */
 
 NC_string *
 NC_new_string(unsigned count, const char *str)
@@ -59,7 +62,7 @@ NC_new_string(unsigned count, const char *str)
         goto alloc_err;
     ret->count = count;
     ret->len   = count;
-    ret->hash  = compute_hash(count, str);
+    ret->hash  = NC_compute_hash(count, str);
     if (count != 0) /* allocate */
     {
         memlen      = count + 1;
@@ -113,7 +116,7 @@ NC_re_string(NC_string *old, unsigned count, const char *str)
 
     /* make sure len is always == to the string length */
     old->len  = count;
-    old->hash = compute_hash(count, str);
+    old->hash = NC_compute_hash(count, str);
 
     return (old);
 }
@@ -54,6 +54,25 @@ NC_new_var(const char *name, nc_type type, int ndims, const int *dims)
     ret->HDFtype     = hdf_map_type(type);
     ret->HDFsize     = DFKNTsize(ret->HDFtype);
     ret->is_ragged   = FALSE;
+    ret->shuffle     = FALSE;
+    ret->lazy_attrs  = FALSE;
+    ret->sieve_size  = 0;
+    ret->readahead   = FALSE;
+    ret->flushed     = FALSE; /* No Vgroup in the file describes it yet */
+    ret->flush_ref   = 0;
+    ret->flush_recs  = 0;
+    ret->app_buf     = NULL; /* Nothing appended with SDappend() yet */
+    ret->app_nrecs   = 0;
+    ret->app_max     = 0;
+    ret->app_id      = FAIL;
+    ret->scale_buf   = NULL; /* No scale read with SDgetdimscale() yet */
+    ret->scale_count = 0;
+    ret->view_aid    = FAIL; /* No chunk held with SDgetchunkptr() yet */
+    ret->view_bufs   = NULL;
+    ret->nview_bufs  = 0;
+    ret->autorange   = FALSE; /* No range kept, see SDsetautorange() */
+    ret->range_set   = FALSE;
+    ret->range_nfill = 0;
     ret->created     = FALSE; /* This is set in SDcreate() if it's a new SDS */
     ret->set_length  = FALSE; /* This is set in SDwritedata() if the data needs its length set */
 
@@ -85,6 +104,9 @@ NC_free_var(NC_var *var)
         }
         free(var->shape);
         free(var->dsizes);
+        free(var->app_buf);
+        free(var->scale_buf);
+        NC_end_views(var);
 
         if (NC_free_array(var->attrs) == FAIL) {
             ret_value = FAIL;
@@ -97,6 +119,187 @@ done:
     return ret_value;
 }
 
+/*
+ * Drop the scale values SDgetdimscale() kept for a variable;
+ *  must be called when the variable's data or number type changes
+ */
+void
+NC_free_scale(NC_var *var)
+{
+    free(var->scale_buf);
+    var->scale_buf   = NULL;
+    var->scale_count = 0;
+}
+
+/*
+ * Give back the chunks SDgetchunkptr() holds for a variable, the pointers
+ *  to them must not be used anymore
+ */
+intn
+NC_end_views(NC_var *var)
+{
+    intn ret_value = SUCCEED;
+    intn i;
+
+    for (i = 0; i < var->nview_bufs; i++)
+        free(var->view_bufs[i]);
+    free(var->view_bufs);
+    var->view_bufs  = NULL;
+    var->nview_bufs = 0;
+
+    /* the chunk cache goes with the last access id of the data */
+    if (var->view_aid != FAIL && Hendaccess(var->view_aid) == FAIL)
+        ret_value = FAIL;
+    var->view_aid = FAIL;
+
+    return ret_value;
+}
+
+/*
+ * Least and greatest of 'count' values of type T at 'values', leaving out
+ *  the fill value and NaNs, and the number of fill values; the loop has no
+ *  early exit so that the compiler can turn it into vector min/max
+ */
+#define NC_RANGE_REDUCE(T)                                                                                   \
+    {                                                                                                        \
+        const T *v    = (const T *)values;                                                                  \
+        T        fill = *(const T *)fillp;                                                                  \
+        T        lo, hi, x;                                                                                 \
+        for (k = 0; k < count && (v[k] == fill || v[k] != v[k]); k++)                                       \
+            nfill += (v[k] == fill);                                                                        \
+        if (k < count) {                                                                                    \
+            lo = hi = v[k];                                                                                 \
+            for (; k < count; k++) {                                                                        \
+                x = v[k];                                                                                   \
+                nfill += (x == fill);                                                                       \
+                lo = (x < lo && x != fill) ? x : lo;                                                        \
+                hi = (x > hi && x != fill) ? x : hi;                                                        \
+            }                                                                                               \
+            vmin = (float64)lo;                                                                             \
+            vmax = (float64)hi;                                                                             \
+            found = TRUE;                                                                                   \
+        }                                                                                                   \
+    }
+
+/*
+ * Fold 'count' values being written to a variable into the range
+ *  SDsetautorange() keeps for it
+ */
+void
+NC_range_update(NC_var *var, const void *values, long count)
+{
+    NC_attr **attr;
+    uint8     fillbuf[sizeof(float64)];
+    const void *fillp;
+    float64   vmin = 0.0, vmax = 0.0;
+    long      k;
+    int32     nfill = 0;
+    intn      found = FALSE;
+
+    if (!var->autorange || values == NULL || count <= 0 || var->szof > (int)sizeof(fillbuf))
+        return;
+
+    /* the fill value of the variable, or the default one of its type */
+    if ((attr = NC_findattr(&var->attrs, _FillValue)) != NULL && (*attr)->HDFtype == var->HDFtype)
+        fillp = (*attr)->data->values;
+    else {
+        NC_arrayfill(fillbuf, (size_t)var->szof, var->type);
+        fillp = fillbuf;
+    }
+
+    switch (var->HDFtype & ~(DFNT_NATIVE | DFNT_LITEND)) {
+        case DFNT_CHAR8:
+        case DFNT_INT8:
+            NC_RANGE_REDUCE(int8)
+            break;
+        case DFNT_UCHAR8:
+        case DFNT_UINT8:
+            NC_RANGE_REDUCE(uint8)
+            break;
+        case DFNT_INT16:
+            NC_RANGE_REDUCE(int16)
+            break;
+        case DFNT_UINT16:
+            NC_RANGE_REDUCE(uint16)
+            break;
+        case DFNT_INT32:
+            NC_RANGE_REDUCE(int32)
+            break;
+        case DFNT_UINT32:
+            NC_RANGE_REDUCE(uint32)
+            break;
+        case DFNT_FLOAT32:
+            NC_RANGE_REDUCE(float32)
+            break;
+        case DFNT_FLOAT64:
+            NC_RANGE_REDUCE(float64)
+            break;
+        default: /* no range for other types */
+            return;
+    }
+
+    var->range_nfill += nfill;
+    if (found) {
+        if (!var->range_set || vmin < var->range_min)
+            var->range_min = vmin;
+        if (!var->range_set || vmax > var->range_max)
+            var->range_max = vmax;
+        var->range_set = TRUE;
+    }
+}
+
+/*
+ * The range SDsetautorange() keeps for a variable, in its number type;
+ *  FAIL if no value other than the fill value was written
+ */
+intn
+NC_range_get(NC_var *var, void *pmax, void *pmin)
+{
+    if (!var->range_set)
+        return FAIL;
+
+    switch (var->HDFtype & ~(DFNT_NATIVE | DFNT_LITEND)) {
+        case DFNT_CHAR8:
+        case DFNT_INT8:
+            *(int8 *)pmin = (int8)var->range_min;
+            *(int8 *)pmax = (int8)var->range_max;
+            break;
+        case DFNT_UCHAR8:
+        case DFNT_UINT8:
+            *(uint8 *)pmin = (uint8)var->range_min;
+            *(uint8 *)pmax = (uint8)var->range_max;
+            break;
+        case DFNT_INT16:
+            *(int16 *)pmin = (int16)var->range_min;
+            *(int16 *)pmax = (int16)var->range_max;
+            break;
+        case DFNT_UINT16:
+            *(uint16 *)pmin = (uint16)var->range_min;
+            *(uint16 *)pmax = (uint16)var->range_max;
+            break;
+        case DFNT_INT32:
+            *(int32 *)pmin = (int32)var->range_min;
+            *(int32 *)pmax = (int32)var->range_max;
+            break;
+        case DFNT_UINT32:
+            *(uint32 *)pmin = (uint32)var->range_min;
+            *(uint32 *)pmax = (uint32)var->range_max;
+            break;
+        case DFNT_FLOAT32:
+            *(float32 *)pmin = (float32)var->range_min;
+            *(float32 *)pmax = (float32)var->range_max;
+            break;
+        case DFNT_FLOAT64:
+            *(float64 *)pmin = var->range_min;
+            *(float64 *)pmax = var->range_max;
+            break;
+        default:
+            return FAIL;
+    }
+
+    return SUCCEED;
+}
+
 /*
  * 'compile' the shape and len of a variable
  *  return -1 on error
@@ -210,11 +413,9 @@ out:
 int
 ncvardef(int cdfid, const char *name, nc_type type, int ndims, const int dims[])
 {
-    NC      *handle;
-    NC_var  *var[1];
-    NC_var **dp;
-    int      ii;
-    int      len;
+    NC     *handle;
+    NC_var *var[1];
+    int     ii;
 
     cdf_routine_name = "ncvardef";
 
@@ -257,13 +458,10 @@ ncvardef(int cdfid, const char *name, nc_type type, int ndims, const int dims[])
     }
     else {
         /* check for name in use */
-        len = strlen(name);
-        dp  = (NC_var **)handle->vars->values;
-        for (ii = 0; ii < handle->vars->count; ii++, dp++) {
-            if (len == (*dp)->name->len && strncmp(name, (*dp)->name->values, len) == 0) {
-                NCadvise(NC_ENAMEINUSE, "variable \"%s\" in use with index %d", (*dp)->name->values, ii);
-                return (-1);
-            }
+        ii = NC_findname(handle->vars, name, -1);
+        if (ii >= 0) {
+            NCadvise(NC_ENAMEINUSE, "variable \"%s\" in use with index %d", name, ii);
+            return (-1);
         }
         var[0] = NC_new_var(name, type, ndims, dims);
         if (var[0] == NULL)
@@ -278,6 +476,7 @@ ncvardef(int cdfid, const char *name, nc_type type, int ndims, const int dims[])
     }
     /* unwind */
     handle->vars->count--;
+    NC_unindex_array(handle->vars);
     NC_free_var(var[0]);
     return (-1);
 }
@@ -324,10 +523,8 @@ NC_computeshapes(NC *handle)
 int
 ncvarid(int cdfid, const char *name)
 {
-    NC      *handle;
-    NC_var **dp;
-    int      ii;
-    int      len;
+    NC *handle;
+    int ii;
 
     cdf_routine_name = "ncvarid";
 
@@ -336,13 +533,9 @@ ncvarid(int cdfid, const char *name)
         return (-1);
     if (handle->vars == NULL)
         return (-1);
-    len = strlen(name);
-    dp  = (NC_var **)handle->vars->values;
-    for (ii = 0; ii < handle->vars->count; ii++, dp++) {
-        if (len == (*dp)->name->len && strncmp(name, (*dp)->name->values, len) == 0) {
-            return (ii);
-        }
-    }
+    ii = NC_findname(handle->vars, name, -1);
+    if (ii >= 0)
+        return (ii);
     NCadvise(NC_ENOTVAR, "variable \"%s\" not found", name);
     return (-1);
 }
@@ -368,6 +561,11 @@ NC_hlookupvar(NC *handle, int varid)
         NCadvise(NC_ENOTVAR, "%d is not a valid variable id", varid);
         return (NULL);
     }
+
+    /* bring in the attributes if the file was opened lazily */
+    if (hdf_read_var_attrs(handle, (NC_var *)*ap) == FAIL)
+        return (NULL);
+
     return ((NC_var *)*ap);
 }
 
@@ -432,7 +630,6 @@ ncvarrename(int cdfid, int varid, const char *newname)
     NC        *handle;
     NC_var   **vpp;
     int        ii;
-    int        len;
     NC_string *old, *new;
 
     cdf_routine_name = "ncvarrename";
@@ -444,13 +641,10 @@ ncvarrename(int cdfid, int varid, const char *newname)
         return (-1);
 
     /* check for name in use */
-    len = strlen(newname);
-    vpp = (NC_var **)handle->vars->values;
-    for (ii = 0; ii < handle->vars->count; ii++, vpp++) {
-        if (len == (*vpp)->name->len && strncmp(newname, (*vpp)->name->values, len) == 0) {
-            NCadvise(NC_ENAMEINUSE, "variable name \"%s\" in use with index %d", (*vpp)->name->values, ii);
-            return (-1);
-        }
+    ii = NC_findname(handle->vars, newname, -1);
+    if (ii >= 0) {
+        NCadvise(NC_ENAMEINUSE, "variable name \"%s\" in use with index %d", newname, ii);
+        return (-1);
     }
 
     if (varid == NC_GLOBAL) /* Global is error in this context */
@@ -467,6 +661,10 @@ ncvarrename(int cdfid, int varid, const char *newname)
         return (-1);
     }
 
+    /* the name index goes stale, and the variable's Vgroup */
+    NC_unindex_array(handle->vars);
+    (*vpp)->flushed = FALSE;
+
     old = (*vpp)->name;
     if (NC_indefine(cdfid, TRUE)) {
         new = NC_new_string((unsigned)strlen(newname), newname);
@@ -517,6 +715,10 @@ xdr_NC_var(XDR *xdrs, NC_var **vpp)
     if (!xdr_NC_array(xdrs, &((*vpp)->attrs)))
         return (FALSE);
 
+    if (xdrs->x_op == XDR_ENCODE) {
+        temp_type = (int)(*vpp)->type;
+        temp_len  = (unsigned)(*vpp)->len;
+    }
     if (!xdr_int(xdrs, &temp_type)) {
         return (FALSE);
     }
@@ -542,6 +744,7 @@ xdr_NC_var(XDR *xdrs, NC_var **vpp)
         (*vpp)->HDFtype   = hdf_map_type((*vpp)->type);
         (*vpp)->HDFsize   = DFKNTsize((*vpp)->HDFtype);
         (*vpp)->aid       = FAIL;
+        (*vpp)->view_aid  = FAIL;
         (*vpp)->is_ragged = FALSE;
     }
 
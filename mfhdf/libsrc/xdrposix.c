@@ -31,6 +31,14 @@
 #include <sys/types.h>
 #endif
 
+/* Files opened read-only are memory-mapped where possible */
+#if defined(H4_HAVE_MMAP) && defined(H4_HAVE_SYS_MMAN_H)
+#define XDRMMAP_SUPPORTED
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 /* prototypes for NCadvis, nc_error also obtains <stdio.h>, <rpc/types.h>, &
  * <rpc/xdr.h>
  */
@@ -55,19 +63,31 @@ typedef struct {
     int            nwrote; /* number of bytes last write */
     int            cnt;    /* number of valid bytes in buffer */
     unsigned char *ptr;    /* next byte */
-#define BIOBUFSIZ 8192
-    unsigned char base[BIOBUFSIZ]; /* the data buffer */
+    int            bufsiz; /* size of the data buffer, a page of the file */
+    unsigned char *base;   /* the data buffer */
 } biobuf;
 
+/* buffer of the fake streams of HDF files, which do no I/O */
+#define BIOBUFSIZ 8192
+
+/* default buffer of netCDF files, see NCxdrfile_bufsize() */
+#define XDRPOSIX_BUFSIZ (1024 * 1024)
+
+
 static biobuf *
-new_biobuf(int fd, int fmode)
+new_biobuf(int fd, int fmode, int bufsiz)
 {
     biobuf *biop;
 
     biop = malloc(sizeof(biobuf));
     if (biop == NULL)
         return NULL;
-    biop->fd = fd;
+    if ((biop->base = malloc((size_t)bufsiz)) == NULL) {
+        free(biop);
+        return NULL;
+    }
+    biop->fd     = fd;
+    biop->bufsiz = bufsiz;
 
     biop->mode = fmode;
 
@@ -76,27 +96,39 @@ new_biobuf(int fd, int fmode)
     biop->nread   = 0;
     biop->nwrote  = 0;
     biop->cnt     = 0;
-    memset(biop->base, 0, ((size_t)(BIOBUFSIZ)));
+    memset(biop->base, 0, (size_t)bufsiz);
     biop->ptr = biop->base;
 
     return biop;
 }
 
+static void
+free_biobuf(biobuf *biop)
+{
+    free(biop->base);
+    free(biop);
+}
+
 static int
 rdbuf(biobuf *biop)
 {
-    memset(biop->base, 0, ((size_t)(BIOBUFSIZ)));
-
     if (biop->mode & O_WRONLY) {
         biop->cnt = 0;
     }
     else {
-        if (biop->nwrote != BIOBUFSIZ) {
+        if (biop->nwrote != biop->bufsiz) {
             /* last write wasn't a full block, adjust position ahead */
-            if (lseek(biop->fd, biop->page * BIOBUFSIZ, SEEK_SET) == ((off_t)-1))
+            if (lseek(biop->fd, biop->page * biop->bufsiz, SEEK_SET) == ((off_t)-1))
                 return -1;
         }
-        biop->nread = biop->cnt = read(biop->fd, (void *)biop->base, BIOBUFSIZ);
+        biop->nread = biop->cnt = read(biop->fd, (void *)biop->base, (size_t)biop->bufsiz);
+    }
+
+    /* clear only what the read left, a large buffer is mostly filled */
+    if (biop->cnt < biop->bufsiz) {
+        int valid = biop->cnt > 0 ? biop->cnt : 0;
+
+        memset(biop->base + valid, 0, (size_t)(biop->bufsiz - valid));
     }
     biop->ptr = biop->base;
     return biop->cnt;
@@ -112,7 +144,7 @@ wrbuf(biobuf *biop)
     else {
         if (biop->nread != 0) {
             /* if we read something, we have to adjust position back */
-            if (lseek(biop->fd, biop->page * BIOBUFSIZ, SEEK_SET) == ((off_t)-1))
+            if (lseek(biop->fd, biop->page * biop->bufsiz, SEEK_SET) == ((off_t)-1))
                 return -1;
         }
         biop->nwrote = write(biop->fd, (void *)biop->base, biop->cnt);
@@ -139,13 +171,30 @@ nextbuf(biobuf *biop)
     return biop->cnt;
 }
 
+/*
+ * Ask the system to start reading the page after the current one while
+ * the caller works through this one.  Only called when a read runs off
+ * the end of the buffer into the next page, i.e. on sequential access.
+ */
+static void
+bioreadahead(biobuf *biop)
+{
+#ifdef H4_HAVE_POSIX_FADVISE
+    if (biop->fd != -1 && !(biop->mode & O_WRONLY) && biop->cnt == biop->bufsiz)
+        (void)posix_fadvise(biop->fd, (biop->page + 1) * biop->bufsiz, (off_t)biop->bufsiz,
+                            POSIX_FADV_WILLNEED);
+#else
+    (void)biop;
+#endif
+}
+
 #define CNT(p) ((p)->ptr - (p)->base)
 
 /* # of unread bytes in buffer */
 #define REM(p) ((p)->cnt - CNT(p))
 
 /* available space for write in buffer */
-#define BREM(p) (BIOBUFSIZ - CNT(p))
+#define BREM(p) ((p)->bufsiz - CNT(p))
 
 static int
 bioread(biobuf *biop, unsigned char *ptr, int nbytes)
@@ -165,6 +214,7 @@ bioread(biobuf *biop, unsigned char *ptr, int nbytes)
         }
         if (nextbuf(biop) <= 0)
             return ngot;
+        bioreadahead(biop);
     }
     /* we know nbytes <= REM at this point */
     (void)memcpy(ptr, biop->ptr, (size_t)nbytes);
@@ -187,7 +237,7 @@ biowrite(biobuf *biop, unsigned char *ptr, int nbytes)
         if (rem > 0) {
             (void)memcpy(biop->ptr, ptr, rem);
             biop->isdirty = !0;
-            biop->cnt     = BIOBUFSIZ;
+            biop->cnt     = biop->bufsiz;
             ptr += rem;
             nbytes -= rem;
             nwrote += rem;
@@ -249,7 +299,7 @@ static struct xdr_ops xdrposix_ops = {
 void
 hdf_xdrfile_create(XDR *xdrs, int ncop)
 {
-    biobuf *biop = new_biobuf(-1, 0);
+    biobuf *biop = new_biobuf(-1, 0, BIOBUFSIZ);
 
     if (ncop & NC_CREAT)
         xdrs->x_op = XDR_ENCODE;
@@ -269,7 +319,8 @@ hdf_xdrfile_create(XDR *xdrs, int ncop)
 static int
 xdrposix_create(XDR *xdrs, int fd, int fmode, enum xdr_op op)
 {
-    biobuf *biop = new_biobuf(fd, fmode);
+    int     bufsiz = (int)HPgetconfig(HDF_CONFIG_IO_BUFSIZE);
+    biobuf *biop   = new_biobuf(fd, fmode, bufsiz > 0 ? bufsiz : XDRPOSIX_BUFSIZ);
 #ifdef XDRDEBUG
     fprintf(stderr, "xdrposix_create(): xdrs=%p, fd=%d, fmode=%d, op=%d\n", xdrs, fd, fmode, (int)op);
     fprintf(stderr, "xdrposix_create(): after new_biobuf(), biop=%p\n", biop);
@@ -331,7 +382,7 @@ xdrposix_destroy(XDR *xdrs)
         }
         if (biop->fd != -1)
             (void)close(biop->fd);
-        free(biop);
+        free_biobuf(biop);
     }
 }
 
@@ -389,7 +440,7 @@ static u_int
 xdrposix_getpos(XDR *xdrs)
 {
     biobuf *biop = (biobuf *)xdrs->x_private;
-    return BIOBUFSIZ * biop->page + CNT(biop);
+    return biop->bufsiz * biop->page + CNT(biop);
 }
 
 static bool_t
@@ -400,8 +451,8 @@ xdrposix_setpos(XDR *xdrs, u_int pos)
         off_t page;
         int   index;
         int   nread;
-        page  = pos / BIOBUFSIZ;
-        index = pos % BIOBUFSIZ;
+        page  = pos / biop->bufsiz;
+        index = pos % biop->bufsiz;
         if (page != biop->page) {
             if (biop->isdirty) {
                 if (wrbuf(biop) < 0)
@@ -465,12 +516,303 @@ xdrposix_putint(XDR *xdrs, const int *lp)
 }
 #endif /* end of xdrposix_put(get)int */
 
+#ifdef XDRMMAP_SUPPORTED
+/*
+ * XDR implementation on a read-only memory mapping of a file.  Reads are
+ * copied straight out of the mapping and xdrmmap_inline() hands out
+ * pointers into it, so that contiguous data can be decoded in place.
+ */
+typedef struct {
+    int            fd;   /* the file descriptor */
+    unsigned char *base; /* the mapping of the whole file */
+    size_t         len;  /* length of the mapping */
+    size_t         pos;  /* next byte */
+} xdrmap;
+
+static bool_t   xdrmmap_getlong(XDR *xdrs, long *lp);
+static bool_t   xdrmmap_putlong(XDR *xdrs, const long *lp);
+static bool_t   xdrmmap_getbytes(XDR *xdrs, char *addr, u_int len);
+static bool_t   xdrmmap_putbytes(XDR *xdrs, const char *addr, u_int len);
+static u_int    xdrmmap_getpos(XDR *xdrs);
+static bool_t   xdrmmap_setpos(XDR *xdrs, u_int pos);
+static int32_t *xdrmmap_inline(XDR *xdrs, u_int len);
+static void     xdrmmap_destroy(XDR *xdrs);
+#if (defined __sun && defined _LP64)
+static bool_t xdrmmap_getint(XDR *xdrs, int *lp);
+static bool_t xdrmmap_putint(XDR *xdrs, const int *lp);
+#endif
+
+/*
+ * Ops vector for mapped XDR
+ */
+static struct xdr_ops xdrmmap_ops = {
+    xdrmmap_getlong,  /* deserialize a 32-bit int */
+    xdrmmap_putlong,  /* serialize a 32-bit int */
+    xdrmmap_getbytes, /* deserialize counted bytes */
+    xdrmmap_putbytes, /* serialize counted bytes */
+    xdrmmap_getpos,   /* get offset in the stream */
+    xdrmmap_setpos,   /* set offset in the stream */
+    xdrmmap_inline,   /* prime stream for inline macros */
+    xdrmmap_destroy,  /* destroy stream */
+    NULL,             /* no xdr_control function defined */
+#if defined(__sun) && defined(_LP64)
+    xdrmmap_getint, /* deserialize a 32-bit int */
+    xdrmmap_putint  /* serialize a 32-bit int */
+#endif
+};
+
+/*
+ * Map the file open on fd, returns -1 if it cannot be mapped: empty,
+ * too large for the u_int positions of XDR, or mmap() failed.
+ */
+static int
+xdrmmap_map(xdrmap *map)
+{
+    struct stat st;
+    void       *base;
+
+    if (fstat(map->fd, &st) == -1 || st.st_size <= 0 || (uintmax_t)st.st_size > (uintmax_t)UINT_MAX)
+        return -1;
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, map->fd, 0);
+    if (base == MAP_FAILED)
+        return -1;
+    map->base = base;
+    map->len  = (size_t)st.st_size;
+    return 0;
+}
+
+/*
+ * Initialize a mapped xdr stream for decoding the file open on fd.
+ * Returns -1, leaving xdrs alone, if the file cannot be mapped.
+ */
+static int
+xdrmmap_create(XDR *xdrs, int fd)
+{
+    xdrmap *map;
+
+    if ((map = malloc(sizeof(xdrmap))) == NULL)
+        return -1;
+    map->fd  = fd;
+    map->pos = 0;
+    if (xdrmmap_map(map) < 0) {
+        free(map);
+        return -1;
+    }
+
+    xdrs->x_op      = XDR_DECODE;
+    xdrs->x_ops     = &xdrmmap_ops;
+    xdrs->x_private = (char *)map;
+    /* unused */
+    xdrs->x_handy = 0;
+    xdrs->x_base  = 0;
+    return 0;
+}
+
+/*
+ * "sync" a mapped xdr stream: map the file again if its size has
+ * changed, so that data appended by a writer becomes visible.
+ */
+static int
+xdrmmap_sync(XDR *xdrs)
+{
+    xdrmap        *map = (xdrmap *)xdrs->x_private;
+    struct stat    st;
+    unsigned char *base = map->base;
+    size_t         len  = map->len;
+
+    if (fstat(map->fd, &st) == -1)
+        return -1;
+    if ((uintmax_t)st.st_size == (uintmax_t)map->len)
+        return 0;
+
+    if (xdrmmap_map(map) < 0)
+        return -1; /* keep the old mapping */
+    (void)munmap(base, len);
+    return 0;
+}
+
+static void
+xdrmmap_destroy(XDR *xdrs)
+{
+    xdrmap *map = (xdrmap *)xdrs->x_private;
+
+    if (map != NULL) {
+        (void)munmap(map->base, map->len);
+        (void)close(map->fd);
+        free(map);
+    }
+}
+
+/* Copy nbytes at the current position out of the mapping */
+static bool_t
+mapread(xdrmap *map, void *ptr, size_t nbytes)
+{
+    if (nbytes > map->len - map->pos)
+        return FALSE;
+    (void)memcpy(ptr, map->base + map->pos, nbytes);
+    map->pos += nbytes;
+    return TRUE;
+}
+
+static bool_t
+xdrmmap_getlong(XDR *xdrs, long *lp)
+{
+    unsigned char *up = (unsigned char *)lp;
+#if (defined AIX5L64 || defined __powerpc64__)
+    *lp = 0;
+    up += (sizeof(long) - 4);
+#endif
+    if (!mapread((xdrmap *)xdrs->x_private, up, 4))
+        return FALSE;
+#ifndef H4_WORDS_BIGENDIAN
+    *lp = ntohl(*lp);
+#endif
+    return TRUE;
+}
+
+static bool_t
+xdrmmap_putlong(XDR *xdrs, const long *lp)
+{
+    (void)xdrs;
+    (void)lp;
+    return FALSE;
+}
+
+static bool_t
+xdrmmap_getbytes(XDR *xdrs, char *addr, u_int len)
+{
+    return mapread((xdrmap *)xdrs->x_private, addr, (size_t)len);
+}
+
+static bool_t
+xdrmmap_putbytes(XDR *xdrs, const char *addr, u_int len)
+{
+    (void)xdrs;
+    (void)addr;
+    (void)len;
+    return FALSE;
+}
+
+static u_int
+xdrmmap_getpos(XDR *xdrs)
+{
+    return (u_int)((xdrmap *)xdrs->x_private)->pos;
+}
+
+static bool_t
+xdrmmap_setpos(XDR *xdrs, u_int pos)
+{
+    xdrmap *map = (xdrmap *)xdrs->x_private;
+
+    if ((size_t)pos > map->len)
+        return FALSE;
+    map->pos = (size_t)pos;
+    return TRUE;
+}
+
+/*
+ * Return a pointer to the next len bytes of the mapping and move past
+ * them, or NULL if they run past the end of the file or are not aligned
+ * for int32_t access.
+ */
+static int32_t *
+xdrmmap_inline(XDR *xdrs, u_int len)
+{
+    xdrmap        *map = (xdrmap *)xdrs->x_private;
+    unsigned char *ptr = map->base + map->pos;
+
+    if (xdrs->x_op != XDR_DECODE || (size_t)len > map->len - map->pos ||
+        ((uintptr_t)ptr % sizeof(int32_t)) != 0)
+        return NULL;
+    map->pos += len;
+    return (int32_t *)(void *)ptr;
+}
+
+#if (defined __sun && defined _LP64)
+
+static bool_t
+xdrmmap_getint(XDR *xdrs, int *lp)
+{
+    if (!mapread((xdrmap *)xdrs->x_private, lp, 4))
+        return FALSE;
+#ifndef H4_WORDS_BIGENDIAN
+    *lp = ntohl(*lp);
+#endif
+    return TRUE;
+}
+
+static bool_t
+xdrmmap_putint(XDR *xdrs, const int *lp)
+{
+    (void)xdrs;
+    (void)lp;
+    return FALSE;
+}
+#endif /* end of xdrmmap_put(get)int */
+#endif /* XDRMMAP_SUPPORTED */
+
 int
 NCxdrfile_sync(XDR *xdrs)
 {
+#ifdef XDRMMAP_SUPPORTED
+    if (xdrs->x_ops == &xdrmmap_ops)
+        return xdrmmap_sync(xdrs);
+#endif
     return xdrposix_sync(xdrs);
 }
 
+/*
+ * Set the buffer of a posix xdr stream to nbytes, the stream is flushed
+ * and keeps its position.  With a NULL xdrs set the buffer of the streams
+ * created from now on instead.  Returns the previous size, -1 on error.
+ */
+int
+NCxdrfile_bufsize(XDR *xdrs, int nbytes)
+{
+    biobuf        *biop;
+    unsigned char *base;
+    u_int          pos;
+    int            old;
+
+    if (nbytes <= 0)
+        return -1;
+
+    if (xdrs == NULL) {
+        if ((old = (int)Hsetconfig(HDF_CONFIG_IO_BUFSIZE, (int32)nbytes)) == FAIL)
+            return -1;
+        return old > 0 ? old : XDRPOSIX_BUFSIZ;
+    }
+
+    /* a mapped stream has no buffer */
+    if (xdrs->x_ops != &xdrposix_ops)
+        return -1;
+    if ((biop = (biobuf *)xdrs->x_private) == NULL || biop->fd == -1)
+        return -1;
+    old = biop->bufsiz;
+    if (nbytes == old)
+        return old;
+
+    pos = xdrposix_getpos(xdrs);
+    if (biop->isdirty) {
+        if (wrbuf(biop) < 0)
+            return -1;
+    }
+    if ((base = malloc((size_t)nbytes)) == NULL)
+        return -1;
+    free(biop->base);
+    biop->base   = base;
+    biop->bufsiz = nbytes;
+
+    /* reread the page holding pos */
+    biop->page   = pos / nbytes;
+    biop->nwrote = 0; /* force seek in rdbuf */
+    if (rdbuf(biop) < 0)
+        return -1;
+    biop->ptr = biop->base + pos % nbytes;
+
+    return old;
+}
+
 int
 NCxdrfile_create(XDR *xdrs, const char *path, int ncmode)
 {
@@ -520,6 +862,12 @@ NCxdrfile_create(XDR *xdrs, const char *path, int ncmode)
         op = XDR_DECODE;
     }
 
+#ifdef XDRMMAP_SUPPORTED
+    /* read-only files are decoded straight from a mapping if possible */
+    if (fmode == O_RDONLY && xdrmmap_create(xdrs, fd) == 0)
+        return fd;
+#endif
+
 #ifdef XDRDEBUG
     fprintf(stderr, "NCxdrfile_create(): before xdrposix_create()\n");
 #endif
@@ -19,6 +19,8 @@ add_test (
         test1.nc
         test1.cdl
         test2.cdl
+        test0.csv.out
+        test0.csv.out.err
 )
 if (NOT "${last_test}" STREQUAL "")
   set_tests_properties (NCDUMP-clearall-objects PROPERTIES DEPENDS ${last_test} LABELS ${PROJECT_NAME})
@@ -28,6 +30,7 @@ endif ()
 set (last_test "NCDUMP-clearall-objects")
 
 HDFTEST_COPY_FILE("${HDF4_MFHDF_NCDUMP_SOURCE_DIR}/test0.cdl" "${PROJECT_BINARY_DIR}/test0.cdl" "ncdump_files")
+HDFTEST_COPY_FILE("${HDF4_MFHDF_NCDUMP_SOURCE_DIR}/test0.csv" "${PROJECT_BINARY_DIR}/test0.csv" "ncdump_files")
 add_custom_target(ncdump_files ALL COMMENT "Copying files needed by ncdump tests" DEPENDS ${ncdump_files_list})
 
 if (NCGEN_UTILITY)
@@ -74,4 +77,19 @@ if (NCGEN_UTILITY)
   )
   set_tests_properties (NCDUMP-test2.cdl PROPERTIES DEPENDS ${last_test} LABELS ${PROJECT_NAME})
   set (last_test "NCDUMP-test2.cdl")
+
+  add_test (
+      NAME NCDUMP-test0.csv
+      COMMAND "${CMAKE_COMMAND}"
+          -D "TEST_EMULATOR=${CMAKE_CROSSCOMPILING_EMULATOR}"
+          -D "TEST_PROGRAM=$<TARGET_FILE:ncdump${tgt_ext}>"
+          -D "TEST_ARGS:STRING=-o;csv;test0.nc"
+          -D "TEST_FOLDER=${PROJECT_BINARY_DIR}"
+          -D "TEST_OUTPUT=test0.csv.out"
+          -D "TEST_EXPECT=0"
+          -D "TEST_REFERENCE=test0.csv"
+          -P "${HDF_RESOURCES_DIR}/runTest.cmake"
+  )
+  set_tests_properties (NCDUMP-test0.csv PROPERTIES DEPENDS ${last_test} LABELS ${PROJECT_NAME})
+  set (last_test "NCDUMP-test0.csv")
 endif ()
@@ -24,7 +24,7 @@ long         vdims[H4_MAX_NC_DIMS]; /* dimension sizes for a single variable */
 static void
 usage()
 {
-    printf("ncdump [-V|-c|-h|-u] [-v ...] [[-b|-f] [c|f]] [-l len] [-n name] [-d n[,n]] file\n");
+    printf("ncdump [-V|-c|-h|-u] [-v ...] [[-b|-f] [c|f]] [-l len] [-n name] [-d n[,n]] [-o csv|bin] file\n");
     printf("\t [-V]             Display version of the HDF4 library and exit\n");
     printf("\t [-c]             Coordinate variable data and header information\n");
     printf("\t [-h]             Header information only, no data\n");
@@ -35,6 +35,7 @@ usage()
     printf("\t [-l len]         Line length maximum in data section (default 80)\n");
     printf("\t [-n name]        Name for netCDF (default derived from file name)\n");
     printf("\t [-d n[,n]]       Approximate floating-point values with less precision\n");
+    printf("\t [-o csv|bin]     Variable data only, as comma-separated rows or raw native values\n");
     printf("\t file             File name of input netCDF file\n");
 
     exit(EXIT_FAILURE);
@@ -281,6 +282,7 @@ do_ncdump(char *path, struct fspec *specp)
     int          iv;          /* variable number */
     int          is_coord;    /* true if variable is a coordinate variable */
     int          isempty = 0; /* true if an old hdf dim has no scale values */
+    int          cdl;         /* true unless -o asked for data only */
 
     int    ncid  = ncopen(path, NC_NOWRITE); /* netCDF id */
     vnode *vlist = newvlist();               /* list for vars specified with -v option */
@@ -306,7 +308,9 @@ do_ncdump(char *path, struct fspec *specp)
     if (specp->name == NULL)
         specp->name = name_path(path);
 
-    Printf("netcdf %s {\n", specp->name);
+    cdl = specp->data_form == FORM_CDL;
+    if (cdl)
+        Printf("netcdf %s {\n", specp->name);
 
     /*
      * get number of dimensions, number of variables, number of global
@@ -316,13 +320,16 @@ do_ncdump(char *path, struct fspec *specp)
 
     /* get dimension info */
     if (ndims > 0) {
-        Printf("dimensions:\n");
+        if (cdl)
+            Printf("dimensions:\n");
 
         for (dimid = 0; dimid < ndims; dimid++) {
             char *fixed_str = NULL;
 
             if (ncdiminq(ncid, dimid, dims[dimid].name, &dims[dimid].size) < 0)
                 fprintf(stderr, "Error calling ncdiminq on dimid = %d\n", dimid);
+            if (!cdl)
+                continue;
 
             fixed_str = sanitize_string(dims[dimid].name, specp->fix_str);
             if (fixed_str == NULL) {
@@ -339,10 +346,11 @@ do_ncdump(char *path, struct fspec *specp)
         }
     }
 
-    Printf("\nvariables:\n");
+    if (cdl)
+        Printf("\nvariables:\n");
 
     /* get variable info, with variable attributes */
-    for (varid = 0; varid < nvars; varid++) {
+    for (varid = 0; cdl && varid < nvars; varid++) {
         char *fixed_var;
 
         (void)ncvarinq(ncid, varid, var.name, &var.type, &var.ndims, var.dims, &var.natts);
@@ -409,10 +417,10 @@ do_ncdump(char *path, struct fspec *specp)
     }
 
     /* get global attributes */
-    if (ngatts > 0)
+    if (cdl && ngatts > 0)
         Printf("\n// global attributes:\n");
 
-    for (ia = 0; ia < ngatts; ia++) {
+    for (ia = 0; cdl && ia < ngatts; ia++) {
         char *fixed_att;
 
         (void)ncattname(ncid, NC_GLOBAL, ia, att.name);
@@ -443,7 +451,7 @@ do_ncdump(char *path, struct fspec *specp)
     }
 
     if (!specp->header_only) {
-        if (nvars > 0)
+        if (cdl && nvars > 0)
             Printf("\ndata:\n");
 
         /* output variable data */
@@ -525,7 +533,8 @@ do_ncdump(char *path, struct fspec *specp)
         }
     }
 
-    Printf("}\n");
+    if (cdl)
+        Printf("}\n");
     (void)ncclose(ncid);
 }
 
@@ -608,7 +617,8 @@ main(int argc, char *argv[])
             false,     /* replace nonalpha-numeric with underscore?  */
             LANG_NONE, /* language conventions for indices */
             0,         /* if -v specified, number of variables */
-            0          /* if -v specified, list of variable names */
+            0,         /* if -v specified, list of variable names */
+            FORM_CDL   /* data as CDL, csv or raw values? */
         };
     int c;
     int i;
@@ -620,7 +630,7 @@ main(int argc, char *argv[])
     if (1 == argc) /* if no arguments given, print help and exit */
         usage();
 
-    while ((c = h4getopt(argc, argv, "b:cf:hul:n:v:d:V")) != EOF)
+    while ((c = h4getopt(argc, argv, "b:cf:hul:n:v:d:o:V")) != EOF)
         switch (c) {
             case 'V': /* display version of the library */
                 printf("%s, %s\n\n", argv[0], LIBVER_STRING);
@@ -682,6 +692,16 @@ main(int argc, char *argv[])
             case 'd': /* specify precision for floats */
                 set_sigdigs(h4optarg);
                 break;
+            case 'o': /* variable data only, in another form */
+                if (strcmp(h4optarg, "csv") == 0)
+                    fspec.data_form = FORM_CSV;
+                else if (strcmp(h4optarg, "bin") == 0)
+                    fspec.data_form = FORM_BIN;
+                else {
+                    error("invalid value for -o option: %s", h4optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
             case '?':
                 usage();
                 break;
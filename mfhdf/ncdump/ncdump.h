@@ -36,6 +36,8 @@ struct ncatt { /* attribute */
 
 typedef enum { LANG_NONE, LANG_C, LANG_F } Nclang;
 
+typedef enum { FORM_CDL, FORM_CSV, FORM_BIN } Nform;
+
 struct fspec {             /* specification for how to format dump */
     char *name;            /*
                             * name specified with -n or derived from file
@@ -80,6 +82,11 @@ struct fspec {             /* specification for how to format dump */
                             * list of variable names specified with -v
                             * option on command line
                             */
+    Nform data_form;       /*
+                            * FORM_CDL for CDL, or FORM_CSV or FORM_BIN
+                            * (-o option) for variable data only, as
+                            * comma-separated rows or as raw native values
+                            */
 };
 
 #endif /* NCDUMP_H */
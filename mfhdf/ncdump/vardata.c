@@ -26,9 +26,47 @@
 extern char *sanitize_string(char *str, bool fix_str);
 
 static void annotate(struct ncvar *vp, struct fspec *fsp, long cor[], long iel);
+static int  vardata_raw(struct ncvar *vp, long vdims[], int ncid, int varid, struct fspec *fsp);
 
 #define STREQ(a, b) (*(a) == *(b) && strcmp((a), (b)) == 0)
 
+#define ROWBUFSIZ 1048576 /* bytes of whole rows read at once */
+#define OUTBUFSIZ 65536   /* bytes of -o csv text gathered before writing */
+
+/*
+ * Decimal text of v at out, the same as "%d" or "%ld" print it.  Returns
+ * the number of characters, without a terminating null.
+ */
+static int
+fmt_long(long v, char *out)
+{
+    char          digits[24];
+    unsigned long u   = v < 0 ? 0UL - (unsigned long)v : (unsigned long)v;
+    int           n   = 0;
+    int           len = 0;
+
+    do {
+        digits[n++] = (char)('0' + (u % 10));
+        u /= 10;
+    } while (u != 0);
+
+    if (v < 0)
+        out[len++] = '-';
+    while (n > 0)
+        out[len++] = digits[--n];
+    return len;
+}
+
+/*
+ * Integer values printed with the default "%d" or "%ld" format skip
+ * sprintf; a C_format attribute is still honored.
+ */
+#define PR_INT(v)                                                                                            \
+    if (fast)                                                                                                \
+        sout[fmt_long((long)(v), sout)] = '\0';                                                              \
+    else                                                                                                     \
+        (void)sprintf(sout, fmt, v)
+
 /*
  * Print a row of variable values.  Makes sure output lines aren't too long
  * by judiciously inserting newlines.
@@ -67,6 +105,7 @@ pr_vals(struct ncvar *vp, long len, char *fmt, bool more, bool lastrow, void *va
     float         fill_float;
     double        fill_double;
     char          sout[100]; /* temporary string for each encoded output */
+    bool          fast = (fmt != 0 && (STREQ(fmt, "%d") || STREQ(fmt, "%ld"))) ? true : false;
 
     fill_float  = FILL_FLOAT; /* static initialization hits ultrix cc bug */
     fill_double = FILL_DOUBLE;
@@ -74,11 +113,11 @@ pr_vals(struct ncvar *vp, long len, char *fmt, bool more, bool lastrow, void *va
         case NC_BYTE:
             gp.cp = (char *)vals;
             for (iel = 0; iel < len - 1; iel++) {
-                (void)sprintf(sout, fmt, *gp.cp++);
+                PR_INT(*gp.cp++);
                 (void)strcat(sout, ", ");
                 lput(sout);
             }
-            (void)sprintf(sout, fmt, *gp.cp++);
+            PR_INT(*gp.cp++);
             lput(sout);
             break;
         case NC_CHAR:
@@ -140,21 +179,21 @@ pr_vals(struct ncvar *vp, long len, char *fmt, bool more, bool lastrow, void *va
         case NC_SHORT:
             gp.sp = (short *)vals;
             for (iel = 0; iel < len - 1; iel++) {
-                (void)sprintf(sout, fmt, *gp.sp++);
+                PR_INT(*gp.sp++);
                 (void)strcat(sout, ", ");
                 lput(sout);
             }
-            (void)sprintf(sout, fmt, *gp.sp++);
+            PR_INT(*gp.sp++);
             lput(sout);
             break;
         case NC_LONG:
             gp.lp = (nclong *)vals;
             for (iel = 0; iel < len - 1; iel++) {
-                (void)sprintf(sout, fmt, *gp.lp++);
+                PR_INT(*gp.lp++);
                 (void)strcat(sout, ", ");
                 lput(sout);
             }
-            (void)sprintf(sout, fmt, *gp.lp++);
+            PR_INT(*gp.lp++);
             lput(sout);
             break;
         case NC_FLOAT:
@@ -494,9 +533,16 @@ vardata(struct ncvar *vp, long vdims[], int ncid, int varid, struct fspec *fsp)
     int   vrank = vp->ndims;
     char *fixed_var;
     int   ret = 0, err_code = 0;
+    long  batch = 0;     /* rows read at once, when more than one */
+    long  held  = 0;     /* rows read but not printed yet */
+    char *rows  = NULL;  /* buffer of "batch" rows */
+    char *rowp  = NULL;  /* next row in "rows" to print */
+    const char *fmt;     /* printf format used to print each value */
 
-    /* printf format used to print each value */
-    const char *fmt = get_fmt(ncid, varid, vp->type);
+    if (fsp->data_form != FORM_CDL)
+        return vardata_raw(vp, vdims, ncid, varid, fsp);
+
+    fmt = get_fmt(ncid, varid, vp->type);
 
     nels = 1;
     for (id = 0; id < vrank; id++) {
@@ -529,6 +575,17 @@ vardata(struct ncvar *vp, long vdims[], int ncid, int varid, struct fspec *fsp)
     }
     nrows = nels / ncols; /* number of "rows" */
 
+    /* rows short enough to print whole are read several at a time */
+    if (vrank > 1 && ncols <= gulp) {
+        batch = ROWBUFSIZ / (ncols * nctypelen(vp->type));
+        if (batch > vdims[vrank - 2])
+            batch = vdims[vrank - 2];
+        if (batch > 1)
+            rows = (char *)malloc((size_t)(batch * ncols * nctypelen(vp->type)));
+        if (rows == NULL)
+            batch = 0;
+    }
+
     for (ir = 0; ir < nrows; ir++) {
         /*
          * rather than just printing a whole row at once (which might exceed
@@ -571,26 +628,51 @@ vardata(struct ncvar *vp, long vdims[], int ncid, int varid, struct fspec *fsp)
         }
         lastrow = (ir == nrows - 1) ? true : false;
         while (left > 0) {
-            long toget = left < gulp ? left : gulp;
-            if (vrank > 0)
-                edg[vrank - 1] = toget;
+            long  toget   = left < gulp ? left : gulp;
+            void *rowvals = (void *)vals;
 
-            /* ncvarget was casted to (void), thus ncdump misinformed users
-               that the reading succeeded even though the data was corrupted and
-               reading in fact failed (HDFFR-1468.)  Now when ncvarget fails,
-               break out of the while loop and set error code to indicate this
-               failure. -BMR, 2015/01/19 */
-            ret = ncvarget(ncid, varid, cor, edg, (void *)vals);
-            if (ret == -1) {
-                err_code = ERR_READFAIL; /* to be returned to caller to
-                                            indicate that ncvarget fails */
-                break;
+            if (batch > 0) {
+                /* the whole row is printed at once; read the next rows
+                   along dimension vrank-2 with it */
+                if (held == 0) {
+                    held = vdims[vrank - 2] - cor[vrank - 2];
+                    if (held > batch)
+                        held = batch;
+                    edg[vrank - 2] = held;
+                    ret            = ncvarget(ncid, varid, cor, edg, (void *)rows);
+                    edg[vrank - 2] = 1;
+                    rowp           = rows;
+                    if (ret == -1) {
+                        held     = 0;
+                        err_code = ERR_READFAIL;
+                        break;
+                    }
+                }
+                rowvals = (void *)rowp;
+                rowp += ncols * nctypelen(vp->type);
+                held--;
+            }
+            else {
+                if (vrank > 0)
+                    edg[vrank - 1] = toget;
+
+                /* ncvarget was casted to (void), thus ncdump misinformed users
+                   that the reading succeeded even though the data was corrupted and
+                   reading in fact failed (HDFFR-1468.)  Now when ncvarget fails,
+                   break out of the while loop and set error code to indicate this
+                   failure. -BMR, 2015/01/19 */
+                ret = ncvarget(ncid, varid, cor, edg, (void *)vals);
+                if (ret == -1) {
+                    err_code = ERR_READFAIL; /* to be returned to caller to
+                                                indicate that ncvarget fails */
+                    break;
+                }
             }
 
             if (fsp->full_data_cmnts)
-                pr_cvals(vp, toget, fmt, left > toget, lastrow, (void *)vals, fsp, cor);
+                pr_cvals(vp, toget, fmt, left > toget, lastrow, rowvals, fsp, cor);
             else
-                pr_vals(vp, toget, fmt, left > toget, lastrow, (void *)vals);
+                pr_vals(vp, toget, fmt, left > toget, lastrow, rowvals);
             left -= toget;
             if (vrank > 0)
                 cor[vrank - 1] += toget;
@@ -606,8 +688,211 @@ vardata(struct ncvar *vp, long vdims[], int ncid, int varid, struct fspec *fsp)
         }
     }
 
+    free(rows);
     free(fixed_var);
     return (err_code);
     /* Previously, it was "return 0;"  If this function is revised, this
        return statement may be changed appropriately. (HDFFR-1468) */
 }
+
+/*
+ * Text for -o csv is gathered here and written a buffer at a time.
+ */
+static char   outbuf[OUTBUFSIZ];
+static size_t outlen = 0;
+
+static void
+out_flush(void)
+{
+    (void)fwrite(outbuf, 1, outlen, stdout);
+    outlen = 0;
+}
+
+static void
+out_put(const char *str, size_t len)
+{
+    if (outlen + len > OUTBUFSIZ)
+        out_flush();
+    if (len > OUTBUFSIZ)
+        (void)fwrite(str, 1, len, stdout);
+    else {
+        memcpy(outbuf + outlen, str, len);
+        outlen += len;
+    }
+}
+
+/*
+ * Appends len values of a variable to the -o csv text, separated by commas.
+ * Characters are quoted by the caller, so they are only escaped here.
+ */
+static void
+csv_vals(nc_type type, long len, const char *fmt, void *vals)
+{
+    long iel;
+    char sout[100];
+    int  n;
+
+    for (iel = 0; iel < len; iel++) {
+        n = 0;
+        switch (type) {
+            case NC_BYTE:
+                n = fmt_long((long)((char *)vals)[iel], sout);
+                break;
+            case NC_CHAR:
+                if (((char *)vals)[iel] == '"')
+                    sout[n++] = '"';
+                if (((char *)vals)[iel] != '\0')
+                    sout[n++] = ((char *)vals)[iel];
+                break;
+            case NC_SHORT:
+                n = fmt_long((long)((short *)vals)[iel], sout);
+                break;
+            case NC_LONG:
+                n = fmt_long((long)((nclong *)vals)[iel], sout);
+                break;
+            case NC_FLOAT:
+                n = sprintf(sout, fmt, (double)((float *)vals)[iel]);
+                break;
+            case NC_DOUBLE:
+                n = sprintf(sout, fmt, ((double *)vals)[iel]);
+                break;
+            default:
+                error("csv_vals: bad type");
+                return;
+        }
+        if (type != NC_CHAR && iel > 0)
+            out_put(",", 1);
+        out_put(sout, (size_t)n);
+    }
+}
+
+/*
+ * Writes the data of a variable for -o csv or -o bin, without the CDL
+ * layout.  Rows along the last dimension are read as many at a time as fit
+ * in ROWBUFSIZ bytes; a row that does not fit is read in pieces.
+ */
+/* vp    - variable */
+/* vdims - variable dimension sizes */
+/* ncid  - netcdf id */
+/* varid - variable id */
+/* fsp   - formatting specs */
+static int
+vardata_raw(struct ncvar *vp, long vdims[], int ncid, int varid, struct fspec *fsp)
+{
+    long  cor[H4_MAX_VAR_DIMS]; /* corner coordinates */
+    long  edg[H4_MAX_VAR_DIMS]; /* edges of hypercube */
+    long  add[H4_MAX_VAR_DIMS]; /* "odometer" increment to next rows */
+    int   vrank   = vp->ndims;
+    int   typelen = nctypelen(vp->type);
+    bool  csv     = fsp->data_form == FORM_CSV ? true : false;
+    long  ncols;   /* values in a row along the last dimension */
+    long  piece;   /* values of a row read at once */
+    long  batch;   /* rows read at once */
+    long  nrows;   /* rows in the buffer */
+    long  col, toget, ir;
+    long  nels = 1;
+    char *vals = NULL;
+    char *fixed_var;
+    char  fmt[100]; /* printf format for csv floating-point values */
+    int   id;
+    int   err_code = 0;
+
+    for (id = 0; id < vrank; id++) {
+        cor[id] = 0;
+        edg[id] = 1;
+        add[id] = 0;
+        nels *= vdims[id];
+    }
+    ncols = vrank > 0 ? vdims[vrank - 1] : 1;
+
+    if (csv) {
+        const char *cp = get_fmt(ncid, varid, vp->type);
+
+        /* the default float formats end in a blank, not wanted here */
+        fmt[0] = '\0';
+        if (cp != NULL && strlen(cp) < sizeof(fmt))
+            strcpy(fmt, cp);
+        for (id = (int)strlen(fmt); id > 0 && fmt[id - 1] == ' '; id--)
+            fmt[id - 1] = '\0';
+
+        if ((fixed_var = sanitize_string(vp->name, fsp->fix_str)) == NULL)
+            return -1;
+        out_put(fixed_var, strlen(fixed_var));
+        out_put("\n", 1);
+        free(fixed_var);
+    }
+    if (nels == 0)
+        goto done;
+
+    piece = ROWBUFSIZ / typelen;
+    batch = 1;
+    if (ncols <= piece) {
+        piece = ncols;
+        if (vrank > 1) {
+            batch = ROWBUFSIZ / (ncols * typelen);
+            if (batch > vdims[vrank - 2])
+                batch = vdims[vrank - 2];
+        }
+    }
+    if ((vals = (char *)malloc((size_t)(batch * piece * typelen))) == NULL) {
+        error("out of memory!");
+        err_code = -1;
+        goto done;
+    }
+
+    for (;;) {
+        nrows = 1;
+        if (vrank > 1) {
+            nrows = vdims[vrank - 2] - cor[vrank - 2];
+            if (nrows > batch)
+                nrows = batch;
+            edg[vrank - 2] = nrows;
+        }
+
+        for (col = 0; col < ncols; col += toget) {
+            toget = ncols - col < piece ? ncols - col : piece;
+            if (vrank > 0) {
+                cor[vrank - 1] = col;
+                edg[vrank - 1] = toget;
+            }
+            if (ncvarget(ncid, varid, cor, edg, (void *)vals) == -1) {
+                err_code = ERR_READFAIL;
+                goto done;
+            }
+
+            if (!csv) {
+                (void)fwrite(vals, (size_t)typelen, (size_t)(nrows * toget), stdout);
+                continue;
+            }
+
+            /* a buffer holds either whole rows or a piece of one row */
+            for (ir = 0; ir < nrows; ir++) {
+                if (vp->type == NC_CHAR && col == 0)
+                    out_put("\"", 1);
+                else if (col > 0)
+                    out_put(",", 1);
+                csv_vals(vp->type, toget, fmt, vals + ir * toget * typelen);
+                if (col + toget == ncols) {
+                    if (vp->type == NC_CHAR)
+                        out_put("\"", 1);
+                    out_put("\n", 1);
+                }
+            }
+        }
+
+        if (vrank < 2)
+            break;
+        cor[vrank - 1] = 0;
+        add[vrank - 2] = nrows;
+        if (!upcorner(vdims, vrank, cor, add))
+            break;
+    }
+
+done:
+    if (csv) {
+        out_put("\n", 1);
+        out_flush();
+    }
+    free(vals);
+    return err_code;
+}
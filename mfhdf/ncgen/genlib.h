@@ -35,6 +35,9 @@ void        define_netcdf(char *netcdfname);
 
 /* load.c */
 void load_netcdf(void *rec_start);
+long first_batch(void);
+int  next_batch(void);
+void fill_variable(void *rec_start, void *rec_cur);
 
 /* getfill.c */
 void nc_fill(nc_type, long, void *, union generic);
@@ -24,7 +24,8 @@ int  valnum;               /* value number index for attributes */
 int  rec_dim;              /* number of the unlimited dimension, if any */
 long var_len;              /* variable length (product of dimensions) */
 int  var_size;             /* size of each element of variable */
-long netcdf_record_number; /* current record number for variables */
+long netcdf_record_number; /* current record number, or first row held, for variables */
+long var_rows;             /* rows of the first dimension held for a put */
 
 struct vars vars[H4_MAX_NC_VARS]; /* should be a malloc'ed list, not an array */
 
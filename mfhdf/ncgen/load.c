@@ -13,6 +13,7 @@
 extern int netcdf_flag;
 extern int c_flag;
 extern int fortran_flag;
+extern int derror_count;
 
 void
 load_netcdf(void *rec_start) /* write out record from in-memory structure */
@@ -55,8 +56,8 @@ load_netcdf(void *rec_start) /* write out record from in-memory structure */
         edges[0]  = 1;
     }
     else {
-        coords[0] = 0;
-        edges[0]  = dims[vars[varnum].dims[0]].size;
+        coords[0] = netcdf_record_number;
+        edges[0]  = var_rows;
     }
 
     for (idim = 1; idim < vars[varnum].ndims; idim++) {
@@ -499,3 +500,87 @@ put_variable(void *rec_start)
     if (fortran_flag) /* create Fortran code to put values */
         gen_load_fortran(rec_start);
 }
+
+/* Returns the number of values of variable varnum held in memory for each
+ * put, given var_len, the number of its values (in one record for a record
+ * variable).  When only a netCDF file is written, a large fixed-size
+ * variable is put in batches of whole rows of its first dimension, of
+ * about NC_BATCH_SIZE bytes, so that its data is not all held at once.
+ * Character and byte variables are not split, as a string given for them
+ * may span rows.
+ */
+long
+first_batch(void)
+{
+    long row_len, rows;
+
+    netcdf_record_number = 0;
+    var_rows             = 1;
+    if (vars[varnum].ndims == 0 || vars[varnum].dims[0] == rec_dim)
+        return var_len;
+
+    var_rows = dims[vars[varnum].dims[0]].size;
+    if (c_flag || fortran_flag || vars[varnum].type == NC_CHAR || vars[varnum].type == NC_BYTE ||
+        var_len == 0 || var_len * var_size <= NC_BATCH_SIZE)
+        return var_len;
+
+    row_len = var_len / var_rows;
+    rows    = NC_BATCH_SIZE / (row_len * var_size);
+    if (rows < 1)
+        rows = 1;
+    var_rows = rows;
+    return row_len * rows;
+}
+
+/* Moves to the next record, or the next batch of rows, of variable varnum
+ * once the values held have been put.  Returns 0 when all the values of a
+ * fixed-size variable have been put, 1 otherwise.  The last batch may be
+ * shorter, and var_len is updated for it.
+ */
+int
+next_batch(void)
+{
+    long rows;
+
+    if (vars[varnum].ndims == 0)
+        return 0;
+    if (vars[varnum].dims[0] == rec_dim) {
+        netcdf_record_number++;
+        return 1;
+    }
+
+    netcdf_record_number += var_rows;
+    rows = dims[vars[varnum].dims[0]].size - netcdf_record_number;
+    if (rows <= 0)
+        return 0;
+    if (rows < var_rows) {
+        var_len  = var_len / var_rows * rows;
+        var_rows = rows;
+    }
+    return 1;
+}
+
+/* Puts fill values for the values of variable varnum missing at the end
+ * of its data list: the rest of the values held, then the rest of the
+ * rows of a fixed-size variable put in batches.
+ */
+/* rec_start - points to the values held */
+/* rec_cur   - points to where the next value would go */
+void
+fill_variable(void *rec_start, void *rec_cur)
+{
+    int fixed = vars[varnum].ndims > 0 && vars[varnum].dims[0] != rec_dim;
+
+    if (valnum >= var_len || (valnum == 0 && !(fixed && netcdf_record_number > 0)))
+        return;
+
+    nc_fill(vars[varnum].type, var_len - valnum, rec_cur, vars[varnum].fill_value);
+    if (derror_count == 0)
+        put_variable(rec_start);
+    if (fixed)
+        while (next_batch()) {
+            nc_fill(vars[varnum].type, var_len, rec_start, vars[varnum].fill_value);
+            if (derror_count == 0)
+                put_variable(rec_start);
+        }
+}
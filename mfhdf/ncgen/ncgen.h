@@ -14,6 +14,7 @@
 #define FORT_MAX_LINES    20                  /* max lines in FORTRAN statement */
 #define FORT_MAX_STMNT    66 * FORT_MAX_LINES /* max chars in FORTRAN statement */
 #define C_MAX_STMNT       FORT_MAX_STMNT      /* until we fix to break up C lines */
+#define NC_BATCH_SIZE     1048576             /* bytes of variable data held before a put */
 
 /* Decorated with NC_ to distinguish it from the library's STREQ, which
  * differs slightly.
@@ -36,7 +37,8 @@ extern int  valnum;               /* value number index for attributes */
 extern int  rec_dim;              /* number of the unlimited dimension, if any */
 extern long var_len;              /* variable length (product of dimensions) */
 extern int  var_size;             /* size of each element of variable */
-extern long netcdf_record_number; /* current record number for variables */
+extern long netcdf_record_number; /* current record number, or first row held, for variables */
+extern long var_rows;             /* rows of the first dimension held for a put */
 
 extern struct vars { /* variables */
     char         *name;
@@ -41,6 +41,9 @@ void nc_putfill(nc_type, void *, union generic *);		/* to get fill value for var
 void nc_fill(nc_type, long, void *, union generic);		/* fills a generic array with a value */
 int  put_variable(void *);            /* invoke nc calls or generate code to put */
                                 /* variable values            */
+long first_batch(void);		/* values of a variable held for a put */
+int  next_batch(void);		/* moves to the next values to hold */
+void fill_variable(void *rec_start, void *rec_cur);	/* puts fill values for missing values */
 extern int derror_count;	/* counts errors in netcdf definition */
 extern int lineno;		/* line number for error messages */
 
@@ -367,6 +370,8 @@ datadecl:       avar
 			 var_len = dims[vars[varnum].dims[0]].size;
 		       for(dimnum = 1; dimnum < vars[varnum].ndims; dimnum++)
 			 var_len = var_len*dims[vars[varnum].dims[dimnum]].size;
+		       /* a large variable is put a batch of rows at a time */
+		       var_len = first_batch();
 		       /* allocate memory for a record of variable data */
 		       if (var_len*var_size != (unsigned)(var_len*var_size)) {
 			   derror("too much data for this machine");
@@ -401,15 +406,8 @@ datadecl:       avar
 		 }
 		'=' constlist
                    {
-		       if (valnum > 0 && valnum < var_len) { /* leftovers */
-			   nc_fill(valtype,
-				    var_len - valnum,
-				    rec_cur,
-				    vars[varnum].fill_value);
-			   /* put out record of var_len values */
-			   if (derror_count == 0)
-			     put_variable(rec_start);
-		       }
+		       /* leftovers */
+		       fill_variable(rec_start, rec_cur);
 		       free ((char *) rec_start);
 		 }
                 ;
@@ -452,11 +450,10 @@ dconst:
 			   /* put out record of var_len elements */
 			   if (derror_count == 0)
 			     put_variable(rec_start);
-			   /* if this variable is unbounded, reset for */
-			   /* next record */
-			   if (vars[varnum].dims[0] == rec_dim) {
+			   /* if this variable is unbounded or put in */
+			   /* batches, reset for next record or batch */
+			   if (next_batch()) {
 			       valnum = 0;
-			       netcdf_record_number++;
 			       rec_cur = rec_start;
 			       switch (valtype) {
 				 case NC_CHAR:
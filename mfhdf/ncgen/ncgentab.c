@@ -101,6 +101,9 @@ void  nc_putfill(nc_type, void *, union generic *);      /* to get fill value fo
 void  nc_fill(nc_type, long, void *, union generic);     /* fills a generic array with a value */
 int   put_variable(void *);                              /* invoke nc calls or generate code to put */
                                                          /* variable values            */
+long  first_batch(void);                                 /* values of a variable held for a put */
+int   next_batch(void);                                  /* moves to the next values to hold */
+void  fill_variable(void *rec_start, void *rec_cur);     /* puts fill values for missing values */
 extern int derror_count;                                 /* counts errors in netcdf definition */
 extern int lineno;                                       /* line number for error messages */
 
@@ -564,10 +567,10 @@ static const yytype_int8 yytranslate[] = {
 #if YYDEBUG
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] = {
-    0,   103, 103, 105, 110, 101, 121, 122, 124, 125, 127, 128, 130, 136, 144, 155, 157, 158,
-    160, 161, 163, 163, 165, 167, 168, 169, 170, 171, 172, 174, 175, 178, 177, 203, 205, 206,
-    208, 209, 211, 231, 230, 262, 263, 269, 279, 285, 286, 288, 297, 303, 314, 320, 326, 332,
-    338, 346, 347, 350, 351, 354, 353, 416, 417, 420, 420, 486, 511, 544, 569, 594, 619, 644};
+    0,   106, 106, 108, 113, 104, 124, 125, 127, 128, 130, 131, 133, 139, 147, 158, 160, 161,
+    163, 164, 166, 166, 168, 170, 171, 172, 173, 174, 175, 177, 178, 181, 180, 206, 208, 209,
+    211, 212, 214, 234, 233, 265, 266, 272, 282, 288, 289, 291, 300, 306, 317, 323, 329, 335,
+    341, 349, 350, 353, 354, 357, 356, 414, 415, 418, 418, 483, 508, 541, 566, 591, 616, 641};
 #endif
 
 /** Accessing symbol of state STATE.  */
@@ -1135,7 +1138,7 @@ yyreduce:
     YY_REDUCE_PRINT(yyn);
     switch (yyn) {
         case 2: /* $@1: %empty  */
-#line 103 "mfhdf/ncgen/ncgen.y"
+#line 106 "mfhdf/ncgen/ncgen.y"
         {
             init_netcdf();
         }
@@ -1143,7 +1146,7 @@ yyreduce:
         break;
 
         case 3: /* $@2: %empty  */
-#line 105 "mfhdf/ncgen/ncgen.y"
+#line 108 "mfhdf/ncgen/ncgen.y"
         {
             if (ndims > H4_MAX_NC_DIMS)
                 derror("Too many dimensions");
@@ -1152,7 +1155,7 @@ yyreduce:
         break;
 
         case 4: /* $@3: %empty  */
-#line 110 "mfhdf/ncgen/ncgen.y"
+#line 113 "mfhdf/ncgen/ncgen.y"
         {
             if (derror_count == 0)
                 define_netcdf(netcdfname);
@@ -1161,7 +1164,7 @@ yyreduce:
         break;
 
         case 5: /* ncdesc: NETCDF '{' $@1 dimsection $@2 vasection $@3 datasection '}'  */
-#line 116 "mfhdf/ncgen/ncgen.y"
+#line 119 "mfhdf/ncgen/ncgen.y"
         {
             if (derror_count == 0)
                 close_netcdf();
@@ -1170,7 +1173,7 @@ yyreduce:
         break;
 
         case 12: /* dimdecl: dimd '=' LONG_CONST  */
-#line 131 "mfhdf/ncgen/ncgen.y"
+#line 134 "mfhdf/ncgen/ncgen.y"
         {
             if (long_val <= 0)
                 derror("negative dimension size");
@@ -1181,7 +1184,7 @@ yyreduce:
         break;
 
         case 13: /* dimdecl: dimd '=' NC_UNLIMITED_K  */
-#line 137 "mfhdf/ncgen/ncgen.y"
+#line 140 "mfhdf/ncgen/ncgen.y"
         {
             if (rec_dim != -1)
                 derror("only one NC_UNLIMITED dimension allowed");
@@ -1193,7 +1196,7 @@ yyreduce:
         break;
 
         case 14: /* dimd: dim  */
-#line 145 "mfhdf/ncgen/ncgen.y"
+#line 148 "mfhdf/ncgen/ncgen.y"
         {
             if (yyvsp[0]->is_dim == 1) {
                 derror("duplicate dimension declaration for %s", yyvsp[0]->name);
@@ -1207,7 +1210,7 @@ yyreduce:
         break;
 
         case 23: /* type: BYTE_K  */
-#line 167 "mfhdf/ncgen/ncgen.y"
+#line 170 "mfhdf/ncgen/ncgen.y"
         {
             type_code = NC_BYTE;
         }
@@ -1215,7 +1218,7 @@ yyreduce:
         break;
 
         case 24: /* type: CHAR_K  */
-#line 168 "mfhdf/ncgen/ncgen.y"
+#line 171 "mfhdf/ncgen/ncgen.y"
         {
             type_code = NC_CHAR;
         }
@@ -1223,7 +1226,7 @@ yyreduce:
         break;
 
         case 25: /* type: SHORT_K  */
-#line 169 "mfhdf/ncgen/ncgen.y"
+#line 172 "mfhdf/ncgen/ncgen.y"
         {
             type_code = NC_SHORT;
         }
@@ -1231,7 +1234,7 @@ yyreduce:
         break;
 
         case 26: /* type: LONG_K  */
-#line 170 "mfhdf/ncgen/ncgen.y"
+#line 173 "mfhdf/ncgen/ncgen.y"
         {
             type_code = NC_LONG;
         }
@@ -1239,7 +1242,7 @@ yyreduce:
         break;
 
         case 27: /* type: FLOAT_K  */
-#line 171 "mfhdf/ncgen/ncgen.y"
+#line 174 "mfhdf/ncgen/ncgen.y"
         {
             type_code = NC_FLOAT;
         }
@@ -1247,7 +1250,7 @@ yyreduce:
         break;
 
         case 28: /* type: DOUBLE_K  */
-#line 172 "mfhdf/ncgen/ncgen.y"
+#line 175 "mfhdf/ncgen/ncgen.y"
         {
             type_code = NC_DOUBLE;
         }
@@ -1255,7 +1258,7 @@ yyreduce:
         break;
 
         case 31: /* $@4: %empty  */
-#line 178 "mfhdf/ncgen/ncgen.y"
+#line 181 "mfhdf/ncgen/ncgen.y"
         {
             if (nvars >= H4_MAX_NC_VARS)
                 derror("too many variables");
@@ -1278,7 +1281,7 @@ yyreduce:
         break;
 
         case 32: /* varspec: var $@4 dimspec  */
-#line 198 "mfhdf/ncgen/ncgen.y"
+#line 201 "mfhdf/ncgen/ncgen.y"
         {
             vars[nvars].ndims = nvdims;
             nvars++;
@@ -1287,7 +1290,7 @@ yyreduce:
         break;
 
         case 38: /* vdim: dim  */
-#line 212 "mfhdf/ncgen/ncgen.y"
+#line 215 "mfhdf/ncgen/ncgen.y"
         {
             if (nvdims >= H4_MAX_VAR_DIMS) {
                 derror("%s has too many dimensions", vars[nvars].name);
@@ -1308,7 +1311,7 @@ yyreduce:
         break;
 
         case 39: /* $@5: %empty  */
-#line 231 "mfhdf/ncgen/ncgen.y"
+#line 234 "mfhdf/ncgen/ncgen.y"
         {
             valnum  = 0;
             valtype = NC_UNSPECIFIED;
@@ -1326,7 +1329,7 @@ yyreduce:
         break;
 
         case 40: /* attdecl: att $@5 '=' attvallist  */
-#line 245 "mfhdf/ncgen/ncgen.y"
+#line 248 "mfhdf/ncgen/ncgen.y"
         {
             if (natts >= H4_MAX_NC_ATTRS)
                 derror("too many attributes");
@@ -1345,7 +1348,7 @@ yyreduce:
         break;
 
         case 42: /* att: ':' attr  */
-#line 264 "mfhdf/ncgen/ncgen.y"
+#line 267 "mfhdf/ncgen/ncgen.y"
         {
             varnum = -1; /* handle of "global" attribute */
         }
@@ -1353,7 +1356,7 @@ yyreduce:
         break;
 
         case 43: /* avar: var  */
-#line 270 "mfhdf/ncgen/ncgen.y"
+#line 273 "mfhdf/ncgen/ncgen.y"
         {
             if (yyvsp[0]->is_var == 1)
                 varnum = yyvsp[0]->vnum;
@@ -1366,7 +1369,7 @@ yyreduce:
         break;
 
         case 44: /* attr: IDENT  */
-#line 280 "mfhdf/ncgen/ncgen.y"
+#line 283 "mfhdf/ncgen/ncgen.y"
         {
             atts[natts].name = (char *)emalloc(strlen(yyvsp[0]->name) + 1);
             (void)strcpy(atts[natts].name, yyvsp[0]->name);
@@ -1375,7 +1378,7 @@ yyreduce:
         break;
 
         case 47: /* aconst: attconst  */
-#line 289 "mfhdf/ncgen/ncgen.y"
+#line 292 "mfhdf/ncgen/ncgen.y"
         {
             if (valtype == NC_UNSPECIFIED)
                 valtype = atype_code;
@@ -1386,7 +1389,7 @@ yyreduce:
         break;
 
         case 48: /* attconst: CHAR_CONST  */
-#line 298 "mfhdf/ncgen/ncgen.y"
+#line 301 "mfhdf/ncgen/ncgen.y"
         {
             atype_code   = NC_CHAR;
             *char_valp++ = char_val;
@@ -1396,7 +1399,7 @@ yyreduce:
         break;
 
         case 49: /* attconst: TERMSTRING  */
-#line 304 "mfhdf/ncgen/ncgen.y"
+#line 307 "mfhdf/ncgen/ncgen.y"
         {
             atype_code = NC_CHAR;
             {
@@ -1411,7 +1414,7 @@ yyreduce:
         break;
 
         case 50: /* attconst: BYTE_CONST  */
-#line 315 "mfhdf/ncgen/ncgen.y"
+#line 318 "mfhdf/ncgen/ncgen.y"
         {
             atype_code   = NC_BYTE;
             *byte_valp++ = byte_val;
@@ -1421,7 +1424,7 @@ yyreduce:
         break;
 
         case 51: /* attconst: SHORT_CONST  */
-#line 321 "mfhdf/ncgen/ncgen.y"
+#line 324 "mfhdf/ncgen/ncgen.y"
         {
             atype_code    = NC_SHORT;
             *short_valp++ = short_val;
@@ -1431,7 +1434,7 @@ yyreduce:
         break;
 
         case 52: /* attconst: LONG_CONST  */
-#line 327 "mfhdf/ncgen/ncgen.y"
+#line 330 "mfhdf/ncgen/ncgen.y"
         {
             atype_code   = NC_LONG;
             *long_valp++ = long_val;
@@ -1441,7 +1444,7 @@ yyreduce:
         break;
 
         case 53: /* attconst: FLOAT_CONST  */
-#line 333 "mfhdf/ncgen/ncgen.y"
+#line 336 "mfhdf/ncgen/ncgen.y"
         {
             atype_code    = NC_FLOAT;
             *float_valp++ = float_val;
@@ -1451,7 +1454,7 @@ yyreduce:
         break;
 
         case 54: /* attconst: DOUBLE_CONST  */
-#line 339 "mfhdf/ncgen/ncgen.y"
+#line 342 "mfhdf/ncgen/ncgen.y"
         {
             atype_code     = NC_DOUBLE;
             *double_valp++ = double_val;
@@ -1461,7 +1464,7 @@ yyreduce:
         break;
 
         case 59: /* $@6: %empty  */
-#line 354 "mfhdf/ncgen/ncgen.y"
+#line 357 "mfhdf/ncgen/ncgen.y"
         {
             valtype               = vars[varnum].type; /* variable type */
             valnum                = 0;                 /* values accumulated for variable */
@@ -1478,6 +1481,8 @@ yyreduce:
                 var_len = dims[vars[varnum].dims[0]].size;
             for (dimnum = 1; dimnum < vars[varnum].ndims; dimnum++)
                 var_len = var_len * dims[vars[varnum].dims[dimnum]].size;
+            /* a large variable is put a batch of rows at a time */
+            var_len = first_batch();
             /* allocate memory for a record of variable data */
             if (var_len * var_size != (unsigned)(var_len * var_size)) {
                 derror("too much data for this machine");
@@ -1514,21 +1519,17 @@ yyreduce:
         break;
 
         case 60: /* datadecl: avar $@6 '=' constlist  */
-#line 403 "mfhdf/ncgen/ncgen.y"
+#line 408 "mfhdf/ncgen/ncgen.y"
         {
-            if (valnum > 0 && valnum < var_len) { /* leftovers */
-                nc_fill(valtype, var_len - valnum, rec_cur, vars[varnum].fill_value);
-                /* put out record of var_len values */
-                if (derror_count == 0)
-                    put_variable(rec_start);
-            }
+            /* leftovers */
+            fill_variable(rec_start, rec_cur);
             free((char *)rec_start);
         }
 #line 1636 "mfhdf/ncgen/ncgentab.c"
         break;
 
         case 63: /* $@7: %empty  */
-#line 420 "mfhdf/ncgen/ncgen.y"
+#line 418 "mfhdf/ncgen/ncgen.y"
         {
             if (valnum >= var_len) {
                 derror("too many values for this variable");
@@ -1540,7 +1541,7 @@ yyreduce:
         break;
 
         case 64: /* dconst: $@7 const  */
-#line 428 "mfhdf/ncgen/ncgen.y"
+#line 426 "mfhdf/ncgen/ncgen.y"
         {
             if (not_a_string) {
                 switch (valtype) {
@@ -1568,11 +1569,10 @@ yyreduce:
                 /* put out record of var_len elements */
                 if (derror_count == 0)
                     put_variable(rec_start);
-                /* if this variable is unbounded, reset for */
-                /* next record */
-                if (vars[varnum].dims[0] == rec_dim) {
-                    valnum = 0;
-                    netcdf_record_number++;
+                /* if this variable is unbounded or put in */
+                /* batches, reset for next record or batch */
+                if (next_batch()) {
+                    valnum  = 0;
                     rec_cur = rec_start;
                     switch (valtype) {
                         case NC_CHAR:
@@ -1601,7 +1601,7 @@ yyreduce:
         break;
 
         case 65: /* const: CHAR_CONST  */
-#line 487 "mfhdf/ncgen/ncgen.y"
+#line 484 "mfhdf/ncgen/ncgen.y"
         {
             atype_code = NC_CHAR;
             switch (valtype) {
@@ -1630,7 +1630,7 @@ yyreduce:
         break;
 
         case 66: /* const: TERMSTRING  */
-#line 512 "mfhdf/ncgen/ncgen.y"
+#line 509 "mfhdf/ncgen/ncgen.y"
         {
             not_a_string = 0;
             atype_code   = NC_CHAR;
@@ -1666,7 +1666,7 @@ yyreduce:
         break;
 
         case 67: /* const: BYTE_CONST  */
-#line 545 "mfhdf/ncgen/ncgen.y"
+#line 542 "mfhdf/ncgen/ncgen.y"
         {
             atype_code = NC_BYTE;
             switch (valtype) {
@@ -1695,7 +1695,7 @@ yyreduce:
         break;
 
         case 68: /* const: SHORT_CONST  */
-#line 570 "mfhdf/ncgen/ncgen.y"
+#line 567 "mfhdf/ncgen/ncgen.y"
         {
             atype_code = NC_SHORT;
             switch (valtype) {
@@ -1724,7 +1724,7 @@ yyreduce:
         break;
 
         case 69: /* const: LONG_CONST  */
-#line 595 "mfhdf/ncgen/ncgen.y"
+#line 592 "mfhdf/ncgen/ncgen.y"
         {
             atype_code = NC_LONG;
             switch (valtype) {
@@ -1753,7 +1753,7 @@ yyreduce:
         break;
 
         case 70: /* const: FLOAT_CONST  */
-#line 620 "mfhdf/ncgen/ncgen.y"
+#line 617 "mfhdf/ncgen/ncgen.y"
         {
             atype_code = NC_FLOAT;
             switch (valtype) {
@@ -1782,7 +1782,7 @@ yyreduce:
         break;
 
         case 71: /* const: DOUBLE_CONST  */
-#line 645 "mfhdf/ncgen/ncgen.y"
+#line 642 "mfhdf/ncgen/ncgen.y"
         {
             atype_code = NC_DOUBLE;
             switch (valtype) {
@@ -1983,7 +1983,7 @@ yyreturnlab:
     return yyresult;
 }
 
-#line 676 "mfhdf/ncgen/ncgen.y"
+#line 673 "mfhdf/ncgen/ncgen.y"
 
 /* PROGRAMS */
 
@@ -88,6 +88,8 @@ main(void)
 
     test_ncrecget(testfile);
 
+    test_ncrecrange(testfile);
+
     test_ncvarrename(testfile);
 
     test_ncattput(testfile);
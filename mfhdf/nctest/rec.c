@@ -581,3 +581,120 @@ test_ncrecget(char *path)
     else
         (void)fprintf(stderr, "ok ***\n");
 }
+
+/*
+ * Test ncrecputn and ncrecgetn
+ *    put the existing records at once, check them one record at a time
+ *    get them at once, check them against one record at a time
+ *    try an empty range, a negative one and a bad netCDF handle
+ */
+/* path - name of writable netcdf file to open */
+void
+test_ncrecrange(char *path)
+{
+    int         nerrs   = 0;
+    static char pname[] = "test_ncrecrange";
+    int         nrvars;          /* number of record variables */
+    int         rvarids[VARS];   /* id of each record variable */
+    long        rvarsizes[VARS]; /* record size of each record variable */
+    int         ncid;            /* netcdf id */
+    int         recdim;          /* id of the record dimension */
+    long        nrecs;           /* number of records in the file */
+    void       *datap[VARS];     /* the records of each record variable */
+    void       *datar[VARS];     /* pointers for comparison data */
+    void       *recp[VARS];      /* one record of each record variable */
+    long        rec;
+    int         iv;
+    long        recsize[VARS]; /* record size in data elements */
+    nc_type     vartype[VARS];
+
+    (void)fprintf(stderr, "*** Testing %s ...\t", &pname[5]);
+
+    if ((ncid = ncopen(path, NC_WRITE)) == -1) {
+        error("%s: ncopen failed", pname);
+        return;
+    }
+
+    if (ncrecinq(ncid, &nrvars, rvarids, rvarsizes) == -1 ||
+        ncinquire(ncid, NULL, NULL, NULL, &recdim) == -1 || ncdiminq(ncid, recdim, NULL, &nrecs) == -1) {
+        error("%s: ncrecinq failed", pname);
+        ncclose(ncid);
+        return;
+    }
+
+    /* the records of each record variable, one after the other */
+    for (iv = 0; iv < nrvars; iv++) {
+        datap[iv] = emalloc(nrecs * rvarsizes[iv] + 1);
+        datar[iv] = emalloc(nrecs * rvarsizes[iv] + 1);
+        if (ncvarinq(ncid, rvarids[iv], 0, &vartype[iv], NULL, NULL, NULL) == -1) {
+            error("%s: ncvarinq failed", pname);
+            ncclose(ncid);
+            return;
+        }
+        recsize[iv] = rvarsizes[iv] / nctypelen(vartype[iv]);
+        val_fill(vartype[iv], nrecs * recsize[iv], datap[iv]);
+        val_fill_zero(vartype[iv], nrecs * recsize[iv], datar[iv]);
+    }
+
+    /* put all the records, then check them one at a time */
+    if (ncrecputn(ncid, 0L, nrecs, datap) == -1) {
+        error("%s: ncrecputn failed", pname);
+        nerrs++;
+    }
+    for (rec = 0; rec < nrecs; rec++) {
+        for (iv = 0; iv < nrvars; iv++)
+            recp[iv] = (char *)datar[iv] + rec * rvarsizes[iv];
+        if (recget(ncid, (int)rec, recp) == -1) {
+            error("%s: recget failed", pname);
+            nerrs++;
+        }
+    }
+    for (iv = 0; iv < nrvars; iv++) {
+        if (val_cmp(vartype[iv], nrecs * recsize[iv], datap[iv], datar[iv]) != 0) {
+            error("%s: bad values written by ncrecputn", pname);
+            nerrs++;
+        }
+        val_fill_zero(vartype[iv], nrecs * recsize[iv], datar[iv]);
+    }
+
+    /* get all the records at once */
+    if (ncrecgetn(ncid, 0L, nrecs, datar) == -1) {
+        error("%s: ncrecgetn failed", pname);
+        nerrs++;
+    }
+    for (iv = 0; iv < nrvars; iv++) {
+        if (val_cmp(vartype[iv], nrecs * recsize[iv], datap[iv], datar[iv]) != 0) {
+            error("%s: bad values read by ncrecgetn", pname);
+            nerrs++;
+        }
+    }
+
+    /* nothing to move, or a bad range */
+    if (ncrecgetn(ncid, 0L, 0L, datar) == -1) {
+        error("%s: ncrecgetn failed on no record", pname);
+        nerrs++;
+    }
+    if (ncrecputn(ncid, 0L, -1L, datap) != -1) {
+        error("%s: ncrecputn should fail on a negative count", pname);
+        nerrs++;
+    }
+
+    /* try with bad netCDF handle, check error */
+    if (ncclose(ncid) == -1) {
+        error("%s: ncclose failed", pname);
+        return;
+    }
+    if (ncrecgetn(ncid, 0L, nrecs, datar) != -1) {
+        error("%s: ncrecgetn failed to report bad handle", pname);
+        nerrs++;
+    }
+    for (iv = 0; iv < nrvars; iv++) {
+        free(datap[iv]);
+        free(datar[iv]);
+    }
+
+    if (nerrs > 0)
+        (void)fprintf(stderr, "FAILED! ***\n");
+    else
+        (void)fprintf(stderr, "ok ***\n");
+}
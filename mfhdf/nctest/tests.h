@@ -35,6 +35,7 @@ extern void test_ncvarget_unlim(char *);
 extern void test_ncrecinq(char *);
 extern void test_ncrecput(char *);
 extern void test_ncrecget(char *);
+extern void test_ncrecrange(char *);
 extern void test_ncvarrename(char *);
 extern void test_ncattput(char *);
 extern void test_ncattinq(char *);
@@ -32,11 +32,26 @@ add_custom_target(mfhdf_test_files ALL COMMENT "Copying files needed by mfhdf te
 ##############################################################################
 # Remove any output file left over from previous test run
 set (HDF4_TESTMFHDF_FILES
+    appendvar.hdf
     b150.hdf
     bug376.hdf
     cdfout.new
     cdfout.new.err
     chkbit.hdf
+    chkdup.hdf
+    chkhsl.hdf
+    chkraw.hdf
+    chkcod.hdf
+    chksum.hdf
+    chkidx.hdf
+    chkpol.hdf
+    chkpro.hdf
+    chkslb.hdf
+    tmpio.hdf
+    chkspa.hdf
+    chkst.hdf
+    chkthr.hdf
+    chkvw.hdf
     chktst.hdf
     comptst1.hdf
     comptst2.hdf
@@ -45,6 +60,11 @@ set (HDF4_TESTMFHDF_FILES
     comptst5.hdf
     comptst6.hdf
     comptst7.hdf
+    comptstzstd.hdf
+    comptstlz4.hdf
+    comptstplug.hdf
+    comptstlossy.hdf
+    comptstshuf.hdf
     datainfo_chk.hdf
     datainfo_chkcmp.hdf
     datainfo_cmp.hdf
@@ -59,8 +79,10 @@ set (HDF4_TESTMFHDF_FILES
     idtypes.hdf
     multidimvar.nc
     nbit.hdf
+    ncfill.nc
     onedimmultivars.nc
     onedimonevar.nc
+    scalecache.hdf
     scaletst.hdf
     sds1_dim1_samename.hdf
     sds2_dim1_samename.hdf
@@ -76,14 +98,42 @@ set (HDF4_TESTMFHDF_FILES
     SDSchunkedsziped3d.hdf
     SDSlongname.hdf
     SDSunlimitedsziped.hdf
+    stress.hdf
     test.cdf
     test1.hdf
     test2.hdf
     test_arguments.hdf
+    test_async.hdf
+    test_buflimit.hdf
+    test_calibrated.hdf
+    test_files0.hdf
+    test_files1.hdf
+    test_files2.hdf
+    test_files3.hdf
+    test_files4.hdf
+    test_inplace.hdf
+    test_multi1.hdf
+    test_multi2.hdf
+    test_prefetch.hdf
+    test_autorange.hdf
+    test_sieve.hdf
+    test_strided.hdf
+    tlazyopen.hdf
+    tincrflush.hdf
+    treadall.hdf
+    tmetacache.hdf
+    tstartmany0.hdf
+    tstartmany1.hdf
+    tstartmany2.hdf
+    dimmany.hdf
+    tcxx.hdf
     'This file name has quite a few characters because it is used to test the fix of bugzilla 1331. It has to be at least this long to see.'
     Unlim_dim.hdf
     Unlim_inloop.hdf
     vars_samename.hdf
+    vars_manynames.hdf
+    xdrbuffer.nc
+    redefinplace.nc
     tdfanndg.hdf
     tdfansdg.hdf
 )
@@ -131,6 +181,42 @@ set_tests_properties (MFHDF_TEST-hdfnctest PROPERTIES
     LABELS ${PROJECT_NAME}
 )
 
+add_test (
+    NAME MFHDF_TEST-gen_stress
+    COMMAND ${CMAKE_CROSSCOMPILING_EMULATOR} $<TARGET_FILE:gen_stress>
+        -dds 500 -sds 50 -chunks 20,30 -chunkshape 4,5 -comp deflate -vgroups 100 -depth 7 stress.hdf
+)
+set_tests_properties (MFHDF_TEST-gen_stress PROPERTIES
+    FIXTURES_REQUIRED clear_MFHDF_TEST
+    DEPENDS MFHDF_TEST-hdfnctest
+    WORKING_DIRECTORY ${PROJECT_BINARY_DIR}/TEST
+    LABELS ${PROJECT_NAME}
+)
+
+if (TARGET tcxx)
+  add_test (NAME MFHDF_TEST-tcxx COMMAND ${CMAKE_CROSSCOMPILING_EMULATOR} $<TARGET_FILE:tcxx>)
+  set_tests_properties (MFHDF_TEST-tcxx PROPERTIES
+      PASS_REGULAR_EXPRESSION "C\\+\\+ API test passes"
+      FIXTURES_REQUIRED clear_MFHDF_TEST
+      WORKING_DIRECTORY ${PROJECT_BINARY_DIR}/TEST
+      LABELS ${PROJECT_NAME}
+  )
+endif ()
+
+if (H4_HAVE_PARALLEL)
+  add_test (
+      NAME MFHDF_TEST-tmpio
+      COMMAND ${MPIEXEC_EXECUTABLE} ${MPIEXEC_NUMPROC_FLAG} 3 ${MPIEXEC_PREFLAGS}
+          $<TARGET_FILE:tmpio> ${MPIEXEC_POSTFLAGS}
+  )
+  set_tests_properties (MFHDF_TEST-tmpio PROPERTIES
+      PASS_REGULAR_EXPRESSION "MPI-IO test passes"
+      FIXTURES_REQUIRED clear_MFHDF_TEST
+      WORKING_DIRECTORY ${PROJECT_BINARY_DIR}/TEST
+      LABELS ${PROJECT_NAME}
+  )
+endif ()
+
 #-- Adding test for xdrtest
 if (HDF4_BUILD_XDR_LIB)
   add_executable (xdrtest ${HDF4_MFHDF_XDR_DIR}/xdrtest.c)
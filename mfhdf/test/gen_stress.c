@@ -0,0 +1,413 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*
+ * Name:
+ *      gen_stress
+ *
+ * Purpose:
+ *      Generate large HDF files for scale testing: many data descriptors,
+ *      many datasets, datasets with many chunks and many nested vgroups.
+ *      The contents only depend on the options, so the same command always
+ *      gives the same file, and benchmarks and bug reports can share their
+ *      inputs by quoting the command line.
+ *
+ * Synopsis:
+ *      gen_stress [options] <outfile>
+ *
+ *      -dds <n>            write <n> small elements of a user tag
+ *      -sds <n>            create <n> small 1-D datasets
+ *      -chunks <r>,<c>     create a 2-D dataset of <r> x <c> chunks
+ *      -chunkshape <r>,<c> the shape of each chunk (default 16,16)
+ *      -comp <coder>       compress the chunks with none, rle, skphuff,
+ *                          deflate, szip, zstd or lz4 (default none)
+ *      -level <n>          the deflate or zstd level (default 6 and 3)
+ *      -vgroups <n>        create <n> vgroups
+ *      -depth <n>          nest the vgroups in chains of <n> (default 1)
+ *
+ *      Once the file is written it is opened again and the number of each
+ *      kind of object is checked; the exit status is 0 when all are there.
+ *
+ *      Refs are 16 bits, so the -dds elements use a new tag for each
+ *      MAX_REF of them and a file holds at most MAX_REF chunks; datasets
+ *      and vgroups share a single pool of MAX_REF refs.  A file also holds
+ *      at most H4_MAX_NC_VARS datasets; the -sds datasets all share one
+ *      dimension so that H4_MAX_NC_DIMS is not the limit.
+ *
+ * Example:
+ *      gen_stress -dds 100000 -vgroups 50000 -depth 8 many.hdf
+ *      gen_stress -sds 5000 sds.hdf
+ *      gen_stress -chunks 250,250 -chunkshape 64,64 -comp deflate chunks.hdf
+ */
+
+#include "mfhdf.h"
+#ifdef H4_HAVE_LIBSZ
+#include "szlib.h"
+#endif
+
+#define GEN_TAG       1000      /* first user tag of the -dds elements */
+#define GEN_CLASS     "Stress"  /* class of the -vgroups vgroups */
+#define GEN_DIM_NAME  "gen_dim" /* dimension shared by the -sds datasets */
+#define GEN_SDS_DIM   10        /* size of the -sds datasets */
+#define GEN_MAX_DEPTH 1024
+
+typedef struct {
+    int32        ndds;
+    int32        nsds;
+    int32        nchunks[2];
+    int32        chunkshape[2];
+    comp_coder_t coder;
+    intn         level;
+    int32        nvgroups;
+    int32        depth;
+    const char  *outfile;
+} gen_opt_t;
+
+static const struct {
+    const char  *name;
+    comp_coder_t coder;
+} coders[] = {{"none", COMP_CODE_NONE},       {"rle", COMP_CODE_RLE},   {"skphuff", COMP_CODE_SKPHUFF},
+              {"deflate", COMP_CODE_DEFLATE}, {"szip", COMP_CODE_SZIP}, {"zstd", COMP_CODE_ZSTD},
+              {"lz4", COMP_CODE_LZ4}};
+
+/* Print a message and make the caller fail when an HDF call does */
+#define GEN_CHECK(ret, where)                                                                                \
+    do {                                                                                                     \
+        if ((ret) == FAIL) {                                                                                 \
+            fprintf(stderr, "gen_stress: %s failed\n", where);                                               \
+            return FAIL;                                                                                     \
+        }                                                                                                    \
+    } while (0)
+
+static void
+usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [options] <outfile>\n", prog);
+    fprintf(stderr, "    -dds <n>            write <n> small elements of a user tag\n");
+    fprintf(stderr, "    -sds <n>            create <n> small 1-D datasets\n");
+    fprintf(stderr, "    -chunks <r>,<c>     create a 2-D dataset of <r> x <c> chunks\n");
+    fprintf(stderr, "    -chunkshape <r>,<c> the shape of each chunk (default 16,16)\n");
+    fprintf(stderr, "    -comp <coder>       none, rle, skphuff, deflate, szip, zstd or lz4\n");
+    fprintf(stderr, "    -level <n>          the deflate or zstd level\n");
+    fprintf(stderr, "    -vgroups <n>        create <n> vgroups\n");
+    fprintf(stderr, "    -depth <n>          nest the vgroups in chains of <n> (default 1)\n");
+}
+
+/* Parse "<r>,<c>" into two positive numbers */
+static intn
+parse_pair(const char *arg, int32 pair[2])
+{
+    long r, c;
+
+    if (sscanf(arg, "%ld,%ld", &r, &c) != 2 || r < 1 || c < 1)
+        return FAIL;
+    pair[0] = (int32)r;
+    pair[1] = (int32)c;
+    return SUCCEED;
+}
+
+/* The -sds datasets, and the chunked dataset written one chunk at a time */
+static intn
+gen_sds(const gen_opt_t *opt)
+{
+    int32         sd_id, sds_id;
+    int32         dims[2], start[2], origin[2];
+    int32         data[GEN_SDS_DIM];
+    int32        *chunk;
+    HDF_CHUNK_DEF chunk_def;
+    comp_info     cinfo;
+    uint32        comp_config;
+    char          name[32];
+    int32         i, j, k, chunk_size;
+    intn          status;
+
+    sd_id = SDstart(opt->outfile, DFACC_CREATE);
+    GEN_CHECK(sd_id, "SDstart");
+
+    start[0] = 0;
+    dims[0]  = GEN_SDS_DIM;
+    for (i = 0; i < opt->nsds; i++) {
+        for (k = 0; k < GEN_SDS_DIM; k++)
+            data[k] = i + k;
+        snprintf(name, sizeof(name), "sds%ld", (long)i);
+        sds_id = SDcreate(sd_id, name, DFNT_INT32, 1, dims);
+        GEN_CHECK(sds_id, "SDcreate");
+        status = SDsetdimname(SDgetdimid(sds_id, 0), GEN_DIM_NAME);
+        GEN_CHECK(status, "SDsetdimname");
+        status = SDwritedata(sds_id, start, NULL, dims, data);
+        GEN_CHECK(status, "SDwritedata");
+        status = SDendaccess(sds_id);
+        GEN_CHECK(status, "SDendaccess");
+    }
+
+    if (opt->nchunks[0] > 0) {
+        dims[0] = opt->nchunks[0] * opt->chunkshape[0];
+        dims[1] = opt->nchunks[1] * opt->chunkshape[1];
+        sds_id  = SDcreate(sd_id, "chunked", DFNT_INT32, 2, dims);
+        GEN_CHECK(sds_id, "SDcreate");
+
+        memset(&chunk_def, 0, sizeof(chunk_def));
+        chunk_def.chunk_lengths[0] = opt->chunkshape[0];
+        chunk_def.chunk_lengths[1] = opt->chunkshape[1];
+        if (opt->coder != COMP_CODE_NONE) {
+            status = HCget_config_info(opt->coder, &comp_config);
+            if (status == FAIL || !(comp_config & COMP_ENCODER_ENABLED)) {
+                fprintf(stderr, "gen_stress: this library cannot encode with the chosen coder\n");
+                return FAIL;
+            }
+            memset(&cinfo, 0, sizeof(cinfo));
+            switch (opt->coder) {
+                case COMP_CODE_SKPHUFF:
+                    cinfo.skphuff.skp_size = sizeof(int32);
+                    break;
+                case COMP_CODE_DEFLATE:
+                    cinfo.deflate.level = opt->level >= 0 ? opt->level : 6;
+                    break;
+#ifdef H4_HAVE_LIBSZ
+                case COMP_CODE_SZIP:
+                    cinfo.szip.pixels_per_block = 16;
+                    cinfo.szip.options_mask     = SZ_NN_OPTION_MASK;
+                    break;
+#endif
+                case COMP_CODE_ZSTD:
+                    cinfo.zstd.level = opt->level >= 0 ? opt->level : 3;
+                    break;
+                case COMP_CODE_LZ4:
+                    cinfo.lz4.acceleration = 1;
+                    break;
+                default:
+                    break;
+            }
+            chunk_def.comp.chunk_lengths[0] = opt->chunkshape[0];
+            chunk_def.comp.chunk_lengths[1] = opt->chunkshape[1];
+            chunk_def.comp.comp_type        = opt->coder;
+            chunk_def.comp.cinfo            = cinfo;
+        }
+        status = SDsetchunk(sds_id, chunk_def,
+                            opt->coder == COMP_CODE_NONE ? HDF_CHUNK : HDF_CHUNK | HDF_COMP);
+        GEN_CHECK(status, "SDsetchunk");
+
+        /* Each chunk holds a ramp that starts at its own number */
+        chunk_size = opt->chunkshape[0] * opt->chunkshape[1];
+        if ((chunk = (int32 *)malloc((size_t)chunk_size * sizeof(int32))) == NULL) {
+            fprintf(stderr, "gen_stress: cannot allocate a chunk\n");
+            return FAIL;
+        }
+        for (i = 0; i < opt->nchunks[0]; i++)
+            for (j = 0; j < opt->nchunks[1]; j++) {
+                for (k = 0; k < chunk_size; k++)
+                    chunk[k] = i * opt->nchunks[1] + j + k;
+                origin[0] = i;
+                origin[1] = j;
+                if (SDwritechunk(sds_id, origin, chunk) == FAIL) {
+                    fprintf(stderr, "gen_stress: SDwritechunk failed\n");
+                    free(chunk);
+                    return FAIL;
+                }
+            }
+        free(chunk);
+        status = SDendaccess(sds_id);
+        GEN_CHECK(status, "SDendaccess");
+    }
+
+    status = SDend(sd_id);
+    GEN_CHECK(status, "SDend");
+    return SUCCEED;
+}
+
+/* The -vgroups vgroups and the -dds elements, added to the file gen_sds made */
+static intn
+gen_hv(const gen_opt_t *opt)
+{
+    int32 fid;
+    int32 chain[GEN_MAX_DEPTH];
+    uint8 data[4];
+    char  name[32];
+    int32 i, d, ret;
+
+    fid = Hopen(opt->outfile, DFACC_RDWR, 0);
+    GEN_CHECK(fid, "Hopen");
+
+    ret = Vstart(fid);
+    GEN_CHECK(ret, "Vstart");
+
+    /* Each vgroup but the first of a chain is inserted into the one before */
+    for (i = 0; i < opt->nvgroups; i += opt->depth) {
+        for (d = 0; d < opt->depth && i + d < opt->nvgroups; d++) {
+            chain[d] = Vattach(fid, -1, "w");
+            GEN_CHECK(chain[d], "Vattach");
+            snprintf(name, sizeof(name), "vg%ld", (long)(i + d));
+            ret = Vsetname(chain[d], name);
+            GEN_CHECK(ret, "Vsetname");
+            ret = Vsetclass(chain[d], GEN_CLASS);
+            GEN_CHECK(ret, "Vsetclass");
+            if (d > 0) {
+                ret = Vinsert(chain[d - 1], chain[d]);
+                GEN_CHECK(ret, "Vinsert");
+            }
+        }
+        while (d-- > 0) {
+            ret = Vdetach(chain[d]);
+            GEN_CHECK(ret, "Vdetach");
+        }
+    }
+
+    ret = Vend(fid);
+    GEN_CHECK(ret, "Vend");
+
+    /* Last, as Hnewref() does not hand out a ref that any tag uses */
+    for (i = 0; i < opt->ndds; i++) {
+        data[0] = (uint8)i;
+        data[1] = (uint8)(i >> 8);
+        data[2] = (uint8)(i >> 16);
+        data[3] = (uint8)(i >> 24);
+        ret     = Hputelement(fid, (uint16)(GEN_TAG + i / MAX_REF), (uint16)(i % MAX_REF + 1), data,
+                              sizeof(data));
+        GEN_CHECK(ret, "Hputelement");
+    }
+    ret = Hclose(fid);
+    GEN_CHECK(ret, "Hclose");
+    return SUCCEED;
+}
+
+/* Open the file again and count what is in it */
+static intn
+gen_check(const gen_opt_t *opt)
+{
+    int32 sd_id, fid, vgid, ref;
+    int32 ndatasets, nattrs, nvgroups, ndds;
+    int32 i, ret;
+    char  vgclass[VGNAMELENMAX + 1];
+    intn  status;
+    intn  nerrs = 0;
+
+    sd_id = SDstart(opt->outfile, DFACC_READ);
+    GEN_CHECK(sd_id, "SDstart");
+    status = SDfileinfo(sd_id, &ndatasets, &nattrs);
+    GEN_CHECK(status, "SDfileinfo");
+    status = SDend(sd_id);
+    GEN_CHECK(status, "SDend");
+    if (ndatasets != opt->nsds + (opt->nchunks[0] > 0 ? 1 : 0)) {
+        fprintf(stderr, "gen_stress: found %ld datasets\n", (long)ndatasets);
+        nerrs++;
+    }
+
+    fid = Hopen(opt->outfile, DFACC_READ, 0);
+    GEN_CHECK(fid, "Hopen");
+    for (ndds = 0, i = 0; i <= (opt->ndds - 1) / MAX_REF; i++) {
+        ret = Hnumber(fid, (uint16)(GEN_TAG + i));
+        GEN_CHECK(ret, "Hnumber");
+        ndds += ret;
+    }
+    if (ndds != opt->ndds) {
+        fprintf(stderr, "gen_stress: found %ld elements of tags %d and up\n", (long)ndds, GEN_TAG);
+        nerrs++;
+    }
+
+    /* The SD interface makes vgroups of its own, only count ours */
+    status = Vstart(fid);
+    GEN_CHECK(status, "Vstart");
+    nvgroups = 0;
+    ref      = -1;
+    while ((ref = Vgetid(fid, ref)) != FAIL) {
+        vgid = Vattach(fid, ref, "r");
+        GEN_CHECK(vgid, "Vattach");
+        if (Vgetclass(vgid, vgclass) != FAIL && strcmp(vgclass, GEN_CLASS) == 0)
+            nvgroups++;
+        status = Vdetach(vgid);
+        GEN_CHECK(status, "Vdetach");
+    }
+    if (nvgroups != opt->nvgroups) {
+        fprintf(stderr, "gen_stress: found %ld vgroups of class %s\n", (long)nvgroups, GEN_CLASS);
+        nerrs++;
+    }
+    status = Vend(fid);
+    GEN_CHECK(status, "Vend");
+    status = Hclose(fid);
+    GEN_CHECK(status, "Hclose");
+
+    return nerrs == 0 ? SUCCEED : FAIL;
+}
+
+int
+main(int argc, char *argv[])
+{
+    gen_opt_t opt;
+    intn      i, c;
+
+    memset(&opt, 0, sizeof(opt));
+    opt.chunkshape[0] = opt.chunkshape[1] = 16;
+    opt.coder                             = COMP_CODE_NONE;
+    opt.level                             = -1;
+    opt.depth                             = 1;
+
+    for (i = 1; i < argc; i++) {
+        if (argv[i][0] != '-') {
+            if (opt.outfile != NULL)
+                break;
+            opt.outfile = argv[i];
+        }
+        else if (i + 1 >= argc)
+            break;
+        else if (strcmp(argv[i], "-dds") == 0)
+            opt.ndds = (int32)atol(argv[++i]);
+        else if (strcmp(argv[i], "-sds") == 0)
+            opt.nsds = (int32)atol(argv[++i]);
+        else if (strcmp(argv[i], "-chunks") == 0) {
+            if (parse_pair(argv[++i], opt.nchunks) == FAIL)
+                break;
+        }
+        else if (strcmp(argv[i], "-chunkshape") == 0) {
+            if (parse_pair(argv[++i], opt.chunkshape) == FAIL)
+                break;
+        }
+        else if (strcmp(argv[i], "-comp") == 0) {
+            i++;
+            for (c = 0; c < (intn)(sizeof(coders) / sizeof(coders[0])); c++)
+                if (strcmp(argv[i], coders[c].name) == 0)
+                    break;
+            if (c == (intn)(sizeof(coders) / sizeof(coders[0])))
+                break;
+            opt.coder = coders[c].coder;
+        }
+        else if (strcmp(argv[i], "-level") == 0)
+            opt.level = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-vgroups") == 0)
+            opt.nvgroups = (int32)atol(argv[++i]);
+        else if (strcmp(argv[i], "-depth") == 0)
+            opt.depth = (int32)atol(argv[++i]);
+        else
+            break;
+    }
+    if (i < argc || opt.outfile == NULL || opt.ndds < 0 || opt.nsds < 0 || opt.nvgroups < 0 ||
+        opt.depth < 1 || opt.depth > GEN_MAX_DEPTH) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (opt.nsds + (opt.nchunks[0] > 0 ? 1 : 0) > H4_MAX_NC_VARS) {
+        fprintf(stderr, "gen_stress: a file holds at most %d datasets\n", H4_MAX_NC_VARS);
+        return 1;
+    }
+    if ((double)opt.nchunks[0] * opt.nchunks[1] > MAX_REF) {
+        fprintf(stderr, "gen_stress: a file holds at most %d chunks\n", (int)MAX_REF);
+        return 1;
+    }
+
+    if (gen_sds(&opt) == FAIL || gen_hv(&opt) == FAIL || gen_check(&opt) == FAIL)
+        return 1;
+
+    printf("%s: %ld elements, %ld datasets, %ld x %ld chunks of %ld x %ld, %ld vgroups in chains of %ld\n",
+           opt.outfile, (long)opt.ndds, (long)opt.nsds, (long)opt.nchunks[0], (long)opt.nchunks[1],
+           (long)opt.chunkshape[0], (long)opt.chunkshape[1], (long)opt.nvgroups, (long)opt.depth);
+    return 0;
+}
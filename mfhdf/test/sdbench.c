@@ -0,0 +1,349 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*
+    FILE - sdbench.c
+        Benchmarks for the SD interface
+
+    DESIGN
+        - Time SDwritedata and SDreaddata of a whole 2-D dataset, and
+            SDreaddata of every other element in each dimension, for a
+            contiguous, a chunked, and a compressed dataset of each coder
+            the library can encode, both contiguous and chunked.
+        - Time SDstart of a file holding many datasets.
+        The data is the same on every run and each figure is the best of
+        BENCH_REPS timings, so that runs of different releases on the same
+        machine can be compared.  The results are written as JSON to the
+        file named on the command line (default: sdbench.json).
+
+    BUGS/LIMITATIONS
+        The figures are wallclock times and depend on the machine and on
+        whatever else it is doing; only compare runs made on the same host.
+
+ */
+
+#include "mfhdf.h"
+#ifdef H4_HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+#include "hdftest.h"
+#include "hfile.h"
+#ifdef H4_HAVE_LIBSZ
+#include "szlib.h"
+#endif
+
+#define BENCH_FILE "sdbench.hdf"
+#define BENCH_JSON "sdbench.json"
+
+/* Number of timings of each benchmark, the best one is reported */
+#define BENCH_REPS 5
+
+/* Dataset benchmarks */
+#define SD_DIM0   1024
+#define SD_DIM1   1024
+#define SD_CHUNK  128
+#define SD_NBYTES ((double)SD_DIM0 * SD_DIM1 * sizeof(int32))
+
+/* SDstart benchmark */
+#define OPEN_NSDS 2000
+#define OPEN_DIM  10
+
+static FILE *json    = NULL; /* where the results go */
+static intn  nresult = 0;    /* number of results written so far */
+
+/* Return the wallclock time in seconds */
+static double
+bench_now(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1.0e6;
+} /* end bench_now() */
+
+/* Write one result, BYTES is the amount of data the benchmark moved */
+static void
+bench_report(const char *name, double seconds, double bytes)
+{
+    double mbps = (seconds > 0.0) ? bytes / seconds / (1024.0 * 1024.0) : 0.0;
+
+    printf("  %-32s %10.6f s %10.2f MB/s\n", name, seconds, mbps);
+    fprintf(json, "%s\n    {\"name\": \"%s\", \"seconds\": %.6f, \"bytes\": %.0f, \"mb_per_s\": %.2f}",
+            nresult ? "," : "", name, seconds, bytes, mbps);
+    nresult++;
+} /* end bench_report() */
+
+/* Keep the best of several timings */
+#define BENCH_BEST(best, t0)                                                                                 \
+    do {                                                                                                     \
+        double bench_t = bench_now() - (t0);                                                                 \
+        if ((best) < 0.0 || bench_t < (best))                                                                \
+            (best) = bench_t;                                                                                \
+    } while (0)
+
+/* Write, read and strided read of one dataset; CODER is COMP_CODE_NONE for
+   plain data and COMP_CODE_NBIT for SDsetnbitdataset */
+static intn
+bench_sds(const char *name, intn chunked, comp_coder_t coder, comp_info *cinfo, int32 *data, int32 *readbuf)
+{
+    int32         sd_id, sds_id;
+    int32         dims[2], start[2], edges[2], stride[2];
+    HDF_CHUNK_DEF chunk_def;
+    char          label[64];
+    double        best, t0;
+    intn          rep;
+    intn          status;
+    intn          num_errs = 0;
+
+    dims[0]  = SD_DIM0;
+    dims[1]  = SD_DIM1;
+    start[0] = start[1] = 0;
+
+    /* A new file each time, so that every write allocates its space */
+    best = -1.0;
+    for (rep = 0; rep < BENCH_REPS; rep++) {
+        sd_id = SDstart(BENCH_FILE, DFACC_CREATE);
+        CHECK(sd_id, FAIL, "SDstart");
+        sds_id = SDcreate(sd_id, "bench", DFNT_INT32, 2, dims);
+        CHECK(sds_id, FAIL, "SDcreate");
+        if (chunked) {
+            memset(&chunk_def, 0, sizeof(chunk_def));
+            chunk_def.chunk_lengths[0] = SD_CHUNK;
+            chunk_def.chunk_lengths[1] = SD_CHUNK;
+            if (coder != COMP_CODE_NONE) {
+                chunk_def.comp.chunk_lengths[0] = SD_CHUNK;
+                chunk_def.comp.chunk_lengths[1] = SD_CHUNK;
+                chunk_def.comp.comp_type        = coder;
+                chunk_def.comp.cinfo            = *cinfo;
+            }
+            status = SDsetchunk(sds_id, chunk_def,
+                                coder == COMP_CODE_NONE ? HDF_CHUNK : HDF_CHUNK | HDF_COMP);
+            CHECK(status, FAIL, "SDsetchunk");
+        }
+        else if (coder == COMP_CODE_NBIT) {
+            status = SDsetnbitdataset(sds_id, 10, 11, FALSE, FALSE);
+            CHECK(status, FAIL, "SDsetnbitdataset");
+        }
+        else if (coder != COMP_CODE_NONE) {
+            status = SDsetcompress(sds_id, coder, cinfo);
+            CHECK(status, FAIL, "SDsetcompress");
+        }
+
+        /* The data only reaches the file when the dataset and file are closed */
+        edges[0] = SD_DIM0;
+        edges[1] = SD_DIM1;
+        t0       = bench_now();
+        status   = SDwritedata(sds_id, start, NULL, edges, data);
+        CHECK(status, FAIL, "SDwritedata");
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+        status = SDend(sd_id);
+        BENCH_BEST(best, t0);
+        CHECK(status, FAIL, "SDend");
+    }
+    snprintf(label, sizeof(label), "%s_write", name);
+    bench_report(label, best, SD_NBYTES);
+    if (num_errs != 0)
+        return num_errs;
+
+    sd_id = SDstart(BENCH_FILE, DFACC_READ);
+    CHECK(sd_id, FAIL, "SDstart");
+    sds_id = SDselect(sd_id, 0);
+    CHECK(sds_id, FAIL, "SDselect");
+
+    best = -1.0;
+    for (rep = 0; rep < BENCH_REPS; rep++) {
+        t0     = bench_now();
+        status = SDreaddata(sds_id, start, NULL, edges, readbuf);
+        BENCH_BEST(best, t0);
+        CHECK(status, FAIL, "SDreaddata");
+    }
+    VERIFY(memcmp(data, readbuf, SD_DIM0 * SD_DIM1 * sizeof(int32)), 0, "SDreaddata");
+    snprintf(label, sizeof(label), "%s_read", name);
+    bench_report(label, best, SD_NBYTES);
+
+    stride[0] = stride[1] = 2;
+    edges[0]              = SD_DIM0 / 2;
+    edges[1]              = SD_DIM1 / 2;
+    best                  = -1.0;
+    for (rep = 0; rep < BENCH_REPS; rep++) {
+        t0     = bench_now();
+        status = SDreaddata(sds_id, start, stride, edges, readbuf);
+        BENCH_BEST(best, t0);
+        CHECK(status, FAIL, "SDreaddata");
+    }
+    VERIFY(readbuf[1], data[2], "SDreaddata");
+    snprintf(label, sizeof(label), "%s_read_strided", name);
+    bench_report(label, best, SD_NBYTES / 4);
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDend(sd_id);
+    CHECK(status, FAIL, "SDend");
+    return num_errs;
+} /* end bench_sds() */
+
+/* Every coder the library can encode with, contiguous and chunked */
+static intn
+bench_coders(int32 *data, int32 *readbuf)
+{
+    struct {
+        const char  *name;
+        comp_coder_t coder;
+    } coders[] = {{"rle", COMP_CODE_RLE},   {"skphuff", COMP_CODE_SKPHUFF}, {"deflate", COMP_CODE_DEFLATE},
+                  {"szip", COMP_CODE_SZIP}, {"zstd", COMP_CODE_ZSTD},       {"lz4", COMP_CODE_LZ4}};
+    comp_info cinfo;
+    uint32    comp_config;
+    char      name[64];
+    intn      c;
+    intn      status;
+    intn      num_errs = 0;
+
+    num_errs += bench_sds("sd_nbit", FALSE, COMP_CODE_NBIT, NULL, data, readbuf);
+
+    for (c = 0; c < (intn)(sizeof(coders) / sizeof(coders[0])) && num_errs == 0; c++) {
+        status = HCget_config_info(coders[c].coder, &comp_config);
+        CHECK(status, FAIL, "HCget_config_info");
+        if (!(comp_config & COMP_ENCODER_ENABLED)) {
+            printf("  sd_%-29s skipped, no encoder\n", coders[c].name);
+            continue;
+        }
+
+        memset(&cinfo, 0, sizeof(cinfo));
+        switch (coders[c].coder) {
+            case COMP_CODE_SKPHUFF:
+                cinfo.skphuff.skp_size = sizeof(int32);
+                break;
+            case COMP_CODE_DEFLATE:
+                cinfo.deflate.level = 6;
+                break;
+#ifdef H4_HAVE_LIBSZ
+            case COMP_CODE_SZIP:
+                cinfo.szip.pixels_per_block = 16;
+                cinfo.szip.options_mask     = SZ_NN_OPTION_MASK;
+                break;
+#endif
+            case COMP_CODE_ZSTD:
+                cinfo.zstd.level = 3;
+                break;
+            case COMP_CODE_LZ4:
+                cinfo.lz4.acceleration = 1;
+                break;
+            default:
+                break;
+        }
+        snprintf(name, sizeof(name), "sd_%s", coders[c].name);
+        num_errs += bench_sds(name, FALSE, coders[c].coder, &cinfo, data, readbuf);
+        snprintf(name, sizeof(name), "sd_chunked_%s", coders[c].name);
+        num_errs += bench_sds(name, TRUE, coders[c].coder, &cinfo, data, readbuf);
+    }
+    return num_errs;
+} /* end bench_coders() */
+
+/* SDstart of a file with OPEN_NSDS small datasets */
+static intn
+bench_sdstart(void)
+{
+    int32  sd_id, sds_id;
+    int32  dims[1], start[1];
+    int32  data[OPEN_DIM];
+    char   name[32];
+    double best, t0;
+    intn   rep, i;
+    intn   status;
+    intn   num_errs = 0;
+
+    for (i = 0; i < OPEN_DIM; i++)
+        data[i] = i;
+    dims[0]  = OPEN_DIM;
+    start[0] = 0;
+
+    sd_id = SDstart(BENCH_FILE, DFACC_CREATE);
+    CHECK(sd_id, FAIL, "SDstart");
+    for (i = 0; i < OPEN_NSDS; i++) {
+        snprintf(name, sizeof(name), "sds%d", i);
+        sds_id = SDcreate(sd_id, name, DFNT_INT32, 1, dims);
+        CHECK(sds_id, FAIL, "SDcreate");
+        status = SDwritedata(sds_id, start, NULL, dims, data);
+        CHECK(status, FAIL, "SDwritedata");
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+    status = SDend(sd_id);
+    CHECK(status, FAIL, "SDend");
+
+    best = -1.0;
+    for (rep = 0; rep < BENCH_REPS && num_errs == 0; rep++) {
+        t0    = bench_now();
+        sd_id = SDstart(BENCH_FILE, DFACC_READ);
+        BENCH_BEST(best, t0);
+        CHECK(sd_id, FAIL, "SDstart");
+        status = SDend(sd_id);
+        CHECK(status, FAIL, "SDend");
+    }
+    bench_report("sdstart_many_sds", best, 0.0);
+    return num_errs;
+} /* end bench_sdstart() */
+
+int
+main(int argc, char *argv[])
+{
+    const char *outname = (argc > 1) ? argv[1] : BENCH_JSON;
+    int32      *data, *readbuf;
+    uint32      majorv, minorv, releasev;
+    char        version[LIBVSTR_LEN + 1];
+    intn        i, j;
+    intn        num_errs = 0;
+
+    if (argc > 2) {
+        printf("\nUsage: sdbench [output.json]\n\n");
+        return 1;
+    }
+    if ((json = fopen(outname, "w")) == NULL) {
+        printf("*** Cannot create %s\n", outname);
+        return 1;
+    }
+    Hgetlibversion(&majorv, &minorv, &releasev, version);
+    fprintf(json, "{\n  \"suite\": \"sd\",\n  \"library\": \"%u.%u.%u\",\n  \"results\": [",
+            (unsigned)majorv, (unsigned)minorv, (unsigned)releasev);
+
+    /* Smooth data with some noise, so that the coders have work to do */
+    data    = (int32 *)malloc(SD_DIM0 * SD_DIM1 * sizeof(int32));
+    readbuf = (int32 *)malloc(SD_DIM0 * SD_DIM1 * sizeof(int32));
+    CHECK_ALLOC(data, "data", "main");
+    CHECK_ALLOC(readbuf, "readbuf", "main");
+    for (i = 0; i < SD_DIM0; i++)
+        for (j = 0; j < SD_DIM1; j++)
+            data[i * SD_DIM1 + j] = (i + j) % 1024 + ((i * 31 + j * 17) % 7);
+
+    printf("SD benchmarks, best of %d runs\n", BENCH_REPS);
+    num_errs += bench_sds("sd_contiguous", FALSE, COMP_CODE_NONE, NULL, data, readbuf);
+    if (num_errs == 0)
+        num_errs += bench_sds("sd_chunked", TRUE, COMP_CODE_NONE, NULL, data, readbuf);
+    if (num_errs == 0)
+        num_errs += bench_coders(data, readbuf);
+    if (num_errs == 0)
+        num_errs += bench_sdstart();
+
+    fprintf(json, "\n  ]\n}\n");
+    fclose(json);
+    remove(BENCH_FILE);
+    free(data);
+    free(readbuf);
+
+    if (num_errs != 0)
+        printf("*** %d errors in the benchmarks\n", num_errs);
+    else
+        printf("Results written to %s\n", outname);
+    return num_errs;
+} /* end main() */
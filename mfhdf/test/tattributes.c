@@ -18,6 +18,12 @@
  *	  test_count - tests that SDsetattr fails when the parameter
  *		"count" is set to 0.  (HDFFD-989 and 227: SDsetattr didn't
  *		fail but, eventually, SDend did)
+ *	  test_lazy_open - tests attributes of files opened with
+ *		SDsetlazyopen(TRUE)
+ *	  test_incremental_flush - tests that closing a file after changing
+ *		some attributes keeps the metadata of everything else
+ *	  test_readallattrs - tests reading all the attributes of a data set
+ *		and of a file with SDreadallattrs
  *
  ****************************************************************************/
 
@@ -260,6 +266,512 @@ test_count(void)
     return num_errs;
 } /* test_count */
 
+/********************************************************************
+   Name: test_lazy_open() - tests that data sets' attributes are read
+                            correctly when the file is opened lazily.
+
+   Description:
+        With SDsetlazyopen(TRUE), SDstart leaves the attributes of the
+        data sets on disk until each data set is used.  The main contents
+        of the test are listed below.
+        - create LAZY_NSDS data sets, each with two attributes, and set
+          the label of the first one's dimension
+        - reopen the file lazily, read-only, and verify the attributes of
+          one data set and of its dimension
+        - reopen the file lazily, read/write, add an attribute to one data
+          set only and close the file
+        - reopen the file normally and verify that the attributes of the
+          data sets that were never touched are still there
+
+   Return value:
+        The number of errors occurred in this routine.
+
+*********************************************************************/
+#define FILE_LAZY  "tlazyopen.hdf"
+#define LAZY_NSDS  3
+#define LAZY_LABEL "lazy label"
+
+static intn
+test_lazy_open(void)
+{
+    char  sds_name[20], dim_name[20], label[20];
+    int32 dimsize[1], size;
+    int32 sds_id, file_id, dim_id;
+    int32 ntype, rank;
+    int32 nattrs = 0;
+    int32 ival;
+    intn  ii, status = 0;
+    intn  num_errs = 0; /* number of errors so far */
+
+    status = SDsetlazyopen(FALSE);
+    VERIFY(status, FALSE, "SDsetlazyopen");
+
+    file_id = SDstart(FILE_LAZY, DFACC_CREATE);
+    CHECK(file_id, FAIL, "SDstart");
+
+    dimsize[0] = 4;
+    for (ii = 0; ii < LAZY_NSDS; ii++) {
+        snprintf(sds_name, sizeof(sds_name), "lazy%d", ii);
+        sds_id = SDcreate(file_id, sds_name, DFNT_INT32, 1, dimsize);
+        CHECK(sds_id, FAIL, "SDcreate");
+
+        ival   = ii * 10;
+        status = SDsetattr(sds_id, "ival", DFNT_INT32, 1, &ival);
+        CHECK(status, FAIL, "SDsetattr");
+        status = SDsetattr(sds_id, ATTR1_NAME, DFNT_CHAR8, ATTR1_LEN, ATTR1_VAL);
+        CHECK(status, FAIL, "SDsetattr");
+
+        if (ii == 0) {
+            dim_id = SDgetdimid(sds_id, 0);
+            CHECK(dim_id, FAIL, "SDgetdimid");
+            status = SDsetdimname(dim_id, DIM1_NAME);
+            CHECK(status, FAIL, "SDsetdimname");
+            status = SDsetdimstrs(dim_id, LAZY_LABEL, NULL, NULL);
+            CHECK(status, FAIL, "SDsetdimstrs");
+        }
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+
+    /* Read one data set and its dimension from a lazily opened file */
+    status = SDsetlazyopen(TRUE);
+    VERIFY(status, FALSE, "SDsetlazyopen");
+
+    file_id = SDstart(FILE_LAZY, DFACC_RDONLY);
+    CHECK(file_id, FAIL, "SDstart");
+
+    sds_id = SDselect(file_id, SDnametoindex(file_id, "lazy0"));
+    CHECK(sds_id, FAIL, "SDselect");
+    status = SDgetinfo(sds_id, sds_name, &rank, dimsize, &ntype, &nattrs);
+    CHECK(status, FAIL, "SDgetinfo");
+    VERIFY(nattrs, 2, "SDgetinfo");
+    status = SDreadattr(sds_id, SDfindattr(sds_id, "ival"), &ival);
+    CHECK(status, FAIL, "SDreadattr");
+    VERIFY(ival, 0, "SDreadattr");
+
+    dim_id = SDgetdimid(sds_id, 0);
+    CHECK(dim_id, FAIL, "SDgetdimid");
+    status = SDdiminfo(dim_id, dim_name, &size, &ntype, &nattrs);
+    CHECK(status, FAIL, "SDdiminfo");
+    VERIFY(nattrs, 1, "SDdiminfo");
+    memset(label, 0, sizeof(label));
+    status = SDgetdimstrs(dim_id, label, NULL, NULL, (intn)sizeof(label));
+    CHECK(status, FAIL, "SDgetdimstrs");
+    VERIFY(strcmp(label, LAZY_LABEL), 0, "SDgetdimstrs");
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+
+    /* Change one data set only; the others' attributes must survive the
+       rewrite of the file's metadata */
+    file_id = SDstart(FILE_LAZY, DFACC_RDWR);
+    CHECK(file_id, FAIL, "SDstart");
+
+    sds_id = SDselect(file_id, SDnametoindex(file_id, "lazy1"));
+    CHECK(sds_id, FAIL, "SDselect");
+    status = SDsetattr(sds_id, ATTR2_NAME, DFNT_CHAR8, ATTR2_LEN, ATTR2_VAL);
+    CHECK(status, FAIL, "SDsetattr");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+
+    status = SDsetlazyopen(FALSE);
+    VERIFY(status, TRUE, "SDsetlazyopen");
+
+    file_id = SDstart(FILE_LAZY, DFACC_RDONLY);
+    CHECK(file_id, FAIL, "SDstart");
+
+    for (ii = 0; ii < LAZY_NSDS; ii++) {
+        snprintf(sds_name, sizeof(sds_name), "lazy%d", ii);
+        sds_id = SDselect(file_id, SDnametoindex(file_id, sds_name));
+        CHECK(sds_id, FAIL, "SDselect");
+        status = SDgetinfo(sds_id, sds_name, &rank, dimsize, &ntype, &nattrs);
+        CHECK(status, FAIL, "SDgetinfo");
+        VERIFY(nattrs, (ii == 1 ? 3 : 2), "SDgetinfo");
+        status = SDreadattr(sds_id, SDfindattr(sds_id, "ival"), &ival);
+        CHECK(status, FAIL, "SDreadattr");
+        VERIFY(ival, ii * 10, "SDreadattr");
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+
+    sds_id = SDselect(file_id, SDnametoindex(file_id, "lazy0"));
+    CHECK(sds_id, FAIL, "SDselect");
+    dim_id = SDgetdimid(sds_id, 0);
+    CHECK(dim_id, FAIL, "SDgetdimid");
+    memset(label, 0, sizeof(label));
+    status = SDgetdimstrs(dim_id, label, NULL, NULL, (intn)sizeof(label));
+    CHECK(status, FAIL, "SDgetdimstrs");
+    VERIFY(strcmp(label, LAZY_LABEL), 0, "SDgetdimstrs");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+
+    /* Return the number of errors that's been kept track of so far */
+    return num_errs;
+} /* test_lazy_open */
+
+/********************************************************************
+   Name: test_incremental_flush() - tests that only the changed metadata
+                                    is written when a file is closed.
+
+   Description:
+        When a file that was read in is closed after some changes, the
+        Vgroups of the data sets that did not change stay as they are.
+        The main contents of the test are listed below.
+        - create FLUSH_NSDS data sets with an attribute and some data,
+          the last one with an unlimited dimension, and a file attribute
+        - reopen the file, add an attribute to the first data set and
+          records to the last one, and verify, after closing it, that the
+          Vgroups of the others are the same ones
+        - reopen the file lazily and change the file attribute only
+        - rename a dimension, which rewrites all of the metadata
+        - each time, verify the names, attributes and data of all the
+          data sets, and the file attributes
+
+   Return value:
+        The number of errors occurred in this routine.
+
+*********************************************************************/
+#define FILE_FLUSH "tincrflush.hdf"
+#define FLUSH_NSDS 4
+#define FLUSH_LEN  5
+
+/* Look up the Vgroup of each data set by name */
+static intn
+get_flush_vgroups(int32 vgrefs[FLUSH_NSDS])
+{
+    char  sds_name[20];
+    int32 fid;
+    intn  ii, status;
+    intn  num_errs = 0; /* number of errors so far */
+
+    fid = Hopen(FILE_FLUSH, DFACC_READ, 0);
+    CHECK(fid, FAIL, "Hopen");
+    status = Vstart(fid);
+    CHECK(status, FAIL, "Vstart");
+    for (ii = 0; ii < FLUSH_NSDS; ii++) {
+        snprintf(sds_name, sizeof(sds_name), "flush%d", ii);
+        vgrefs[ii] = Vfind(fid, sds_name);
+        CHECK(vgrefs[ii], 0, "Vfind");
+    }
+    status = Vend(fid);
+    CHECK(status, FAIL, "Vend");
+    status = Hclose(fid);
+    CHECK(status, FAIL, "Hclose");
+
+    return num_errs;
+}
+
+/* Verify all the data sets and file attributes in the file */
+static intn
+check_flush_file(int32 nrecs, int32 file_ival, intn first_nattrs)
+{
+    char  sds_name[20], name[H4_MAX_NC_NAME];
+    int32 file_id, sds_id, attr_idx;
+    int32 dimsizes[H4_MAX_VAR_DIMS], rank, ntype, nattrs, n_datasets, n_file_attrs;
+    int32 start[1] = {0}, edges[1];
+    int32 data[2 * FLUSH_LEN], ival;
+    intn  ii, jj, status;
+    intn  num_errs = 0; /* number of errors so far */
+
+    file_id = SDstart(FILE_FLUSH, DFACC_READ);
+    CHECK(file_id, FAIL, "SDstart");
+
+    status = SDfileinfo(file_id, &n_datasets, &n_file_attrs);
+    CHECK(status, FAIL, "SDfileinfo");
+    VERIFY(n_datasets, FLUSH_NSDS, "SDfileinfo");
+    VERIFY(n_file_attrs, 1, "SDfileinfo");
+    status = SDreadattr(file_id, 0, &ival);
+    CHECK(status, FAIL, "SDreadattr");
+    VERIFY(ival, file_ival, "SDreadattr");
+
+    for (ii = 0; ii < FLUSH_NSDS; ii++) {
+        sds_id = SDselect(file_id, ii);
+        CHECK(sds_id, FAIL, "SDselect");
+        status = SDgetinfo(sds_id, name, &rank, dimsizes, &ntype, &nattrs);
+        CHECK(status, FAIL, "SDgetinfo");
+        snprintf(sds_name, sizeof(sds_name), "flush%d", ii);
+        VERIFY(strcmp(name, sds_name), 0, "SDgetinfo");
+        VERIFY(nattrs, ((ii == 0) ? first_nattrs : 1), "SDgetinfo");
+        VERIFY(dimsizes[0], ((ii == FLUSH_NSDS - 1) ? nrecs : FLUSH_LEN), "SDgetinfo");
+
+        attr_idx = SDfindattr(sds_id, "ival");
+        CHECK(attr_idx, FAIL, "SDfindattr");
+        status = SDreadattr(sds_id, attr_idx, &ival);
+        CHECK(status, FAIL, "SDreadattr");
+        VERIFY(ival, ii, "SDreadattr");
+
+        edges[0] = dimsizes[0];
+        status   = SDreaddata(sds_id, start, NULL, edges, data);
+        CHECK(status, FAIL, "SDreaddata");
+        for (jj = 0; jj < edges[0]; jj++)
+            VERIFY(data[jj], ii * 100 + jj, "SDreaddata");
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+
+    return num_errs;
+}
+
+static intn
+test_incremental_flush(void)
+{
+    char  sds_name[20], dim_name[H4_MAX_NC_NAME];
+    int32 dimsize[1], start[1] = {0}, edges[1];
+    int32 sds_id, file_id, dim_id;
+    int32 size, ntype, nattrs;
+    int32 data[2 * FLUSH_LEN], ival;
+    int32 vgrefs[FLUSH_NSDS], new_vgrefs[FLUSH_NSDS];
+    intn  ii, jj, status = 0;
+    intn  num_errs = 0; /* number of errors so far */
+
+    for (jj = 0; jj < 2 * FLUSH_LEN; jj++)
+        data[jj] = jj;
+
+    file_id = SDstart(FILE_FLUSH, DFACC_CREATE);
+    CHECK(file_id, FAIL, "SDstart");
+
+    for (ii = 0; ii < FLUSH_NSDS; ii++) {
+        snprintf(sds_name, sizeof(sds_name), "flush%d", ii);
+        dimsize[0] = (ii == FLUSH_NSDS - 1) ? SD_UNLIMITED : FLUSH_LEN;
+        sds_id     = SDcreate(file_id, sds_name, DFNT_INT32, 1, dimsize);
+        CHECK(sds_id, FAIL, "SDcreate");
+
+        ival   = ii;
+        status = SDsetattr(sds_id, "ival", DFNT_INT32, 1, &ival);
+        CHECK(status, FAIL, "SDsetattr");
+
+        for (jj = 0; jj < 2 * FLUSH_LEN; jj++)
+            data[jj] = ii * 100 + jj;
+        edges[0] = FLUSH_LEN;
+        status   = SDwritedata(sds_id, start, NULL, edges, data);
+        CHECK(status, FAIL, "SDwritedata");
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+    ival   = 1;
+    status = SDsetattr(file_id, "file ival", DFNT_INT32, 1, &ival);
+    CHECK(status, FAIL, "SDsetattr");
+
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+
+    num_errs += get_flush_vgroups(vgrefs);
+    num_errs += check_flush_file(FLUSH_LEN, 1, 1);
+
+    /* Change the first data set's attributes and the last one's records */
+    file_id = SDstart(FILE_FLUSH, DFACC_RDWR);
+    CHECK(file_id, FAIL, "SDstart");
+
+    sds_id = SDselect(file_id, 0);
+    CHECK(sds_id, FAIL, "SDselect");
+    status = SDsetattr(sds_id, ATTR1_NAME, DFNT_CHAR8, ATTR1_LEN, ATTR1_VAL);
+    CHECK(status, FAIL, "SDsetattr");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    sds_id = SDselect(file_id, FLUSH_NSDS - 1);
+    CHECK(sds_id, FAIL, "SDselect");
+    for (jj = 0; jj < 2 * FLUSH_LEN; jj++)
+        data[jj] = (FLUSH_NSDS - 1) * 100 + jj;
+    start[0] = FLUSH_LEN;
+    edges[0] = FLUSH_LEN;
+    status   = SDwritedata(sds_id, start, NULL, edges, data + FLUSH_LEN);
+    CHECK(status, FAIL, "SDwritedata");
+    start[0] = 0;
+    status   = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+
+    /* The data sets in between were left alone */
+    num_errs += get_flush_vgroups(new_vgrefs);
+    for (ii = 1; ii < FLUSH_NSDS - 1; ii++)
+        VERIFY(new_vgrefs[ii], vgrefs[ii], "Vfind");
+    num_errs += check_flush_file(2 * FLUSH_LEN, 1, 2);
+
+    /* Change only the file attribute, without the data sets' attributes
+       ever being read in */
+    status = SDsetlazyopen(TRUE);
+    CHECK(status, FAIL, "SDsetlazyopen");
+    file_id = SDstart(FILE_FLUSH, DFACC_RDWR);
+    CHECK(file_id, FAIL, "SDstart");
+    ival   = 2;
+    status = SDsetattr(file_id, "file ival", DFNT_INT32, 1, &ival);
+    CHECK(status, FAIL, "SDsetattr");
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+    status = SDsetlazyopen(FALSE);
+    CHECK(status, FAIL, "SDsetlazyopen");
+
+    memcpy(vgrefs, new_vgrefs, sizeof(vgrefs));
+    num_errs += get_flush_vgroups(new_vgrefs);
+    for (ii = 0; ii < FLUSH_NSDS; ii++)
+        VERIFY(new_vgrefs[ii], vgrefs[ii], "Vfind");
+    num_errs += check_flush_file(2 * FLUSH_LEN, 2, 2);
+
+    /* Renaming a dimension rewrites everything */
+    file_id = SDstart(FILE_FLUSH, DFACC_RDWR);
+    CHECK(file_id, FAIL, "SDstart");
+    sds_id = SDselect(file_id, 1);
+    CHECK(sds_id, FAIL, "SDselect");
+    dim_id = SDgetdimid(sds_id, 0);
+    CHECK(dim_id, FAIL, "SDgetdimid");
+    status = SDsetdimname(dim_id, DIM1_NAME);
+    CHECK(status, FAIL, "SDsetdimname");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+
+    num_errs += check_flush_file(2 * FLUSH_LEN, 2, 2);
+
+    file_id = SDstart(FILE_FLUSH, DFACC_READ);
+    CHECK(file_id, FAIL, "SDstart");
+    sds_id = SDselect(file_id, 1);
+    CHECK(sds_id, FAIL, "SDselect");
+    dim_id = SDgetdimid(sds_id, 0);
+    CHECK(dim_id, FAIL, "SDgetdimid");
+    status = SDdiminfo(dim_id, dim_name, &size, &ntype, &nattrs);
+    CHECK(status, FAIL, "SDdiminfo");
+    VERIFY(strcmp(dim_name, DIM1_NAME), 0, "SDdiminfo");
+    VERIFY(size, FLUSH_LEN, "SDdiminfo");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+
+    /* Return the number of errors that's been kept track of so far */
+    return num_errs;
+} /* test_incremental_flush */
+
+/********************************************************************
+   Name: test_readallattrs() - tests SDreadallattrs
+
+   Description:
+        The main contents of the test are listed below.
+        - create a data set with a character, an integer and a float64
+          attribute, and a file attribute
+        - reopen the file and get the arena size needed and the number
+          of attributes with a NULL arena
+        - read them all into an arena of that size and verify the names,
+          types, counts and values, and that the values are aligned
+        - read them into an arena too small for the last one and verify
+          that only the last one is missing
+        - read the file attribute the same way
+
+   Return value:
+        The number of errors occurred in this routine.
+
+*********************************************************************/
+#define FILE_READALL  "treadall.hdf"
+#define READALL_NATTR 3
+
+static intn
+test_readallattrs(void)
+{
+    hdf_attr_t attrs[READALL_NATTR];
+    float64    dvals[2] = {1.5, -2.25};
+    int32      ivals[3] = {7, 8, 9};
+    int32      dimsize[1], size, full_size, nattrs;
+    int32      sds_id, file_id;
+    void      *arena    = NULL;
+    intn       status   = 0;
+    intn       num_errs = 0; /* number of errors so far */
+
+    file_id = SDstart(FILE_READALL, DFACC_CREATE);
+    CHECK(file_id, FAIL, "SDstart");
+
+    dimsize[0] = 4;
+    sds_id     = SDcreate(file_id, "readall", DFNT_INT32, 1, dimsize);
+    CHECK(sds_id, FAIL, "SDcreate");
+    status = SDsetattr(sds_id, ATTR1_NAME, DFNT_CHAR8, ATTR1_LEN, ATTR1_VAL);
+    CHECK(status, FAIL, "SDsetattr");
+    status = SDsetattr(sds_id, "ivals", DFNT_INT32, 3, ivals);
+    CHECK(status, FAIL, "SDsetattr");
+    status = SDsetattr(sds_id, "dvals", DFNT_FLOAT64, 2, dvals);
+    CHECK(status, FAIL, "SDsetattr");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDsetattr(file_id, ATTR2_NAME, DFNT_CHAR8, ATTR2_LEN, ATTR2_VAL);
+    CHECK(status, FAIL, "SDsetattr");
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+
+    file_id = SDstart(FILE_READALL, DFACC_RDONLY);
+    CHECK(file_id, FAIL, "SDstart");
+    sds_id = SDselect(file_id, 0);
+    CHECK(sds_id, FAIL, "SDselect");
+
+    /* Size the arena */
+    full_size = 0;
+    nattrs    = SDreadallattrs(sds_id, NULL, 0, NULL, &full_size);
+    VERIFY(nattrs, READALL_NATTR, "SDreadallattrs");
+    VERIFY((full_size >= ATTR1_LEN + 3 * 4 + 2 * 8), TRUE, "SDreadallattrs");
+    arena = malloc((size_t)full_size);
+    CHECK_ALLOC(arena, "arena", "test_readallattrs");
+
+    /* Read them all */
+    size   = full_size;
+    nattrs = SDreadallattrs(sds_id, attrs, READALL_NATTR, arena, &size);
+    VERIFY(nattrs, READALL_NATTR, "SDreadallattrs");
+    VERIFY(size, full_size, "SDreadallattrs");
+    VERIFY(strcmp(attrs[0].name, ATTR1_NAME), 0, "SDreadallattrs");
+    VERIFY(attrs[0].ntype, DFNT_CHAR8, "SDreadallattrs");
+    VERIFY(attrs[0].count, ATTR1_LEN, "SDreadallattrs");
+    VERIFY(strncmp((char *)attrs[0].values, ATTR1_VAL, ATTR1_LEN), 0, "SDreadallattrs");
+    VERIFY(strcmp(attrs[1].name, "ivals"), 0, "SDreadallattrs");
+    VERIFY(attrs[1].ntype, DFNT_INT32, "SDreadallattrs");
+    VERIFY(attrs[1].count, 3, "SDreadallattrs");
+    VERIFY(memcmp(attrs[1].values, ivals, sizeof(ivals)), 0, "SDreadallattrs");
+    VERIFY(strcmp(attrs[2].name, "dvals"), 0, "SDreadallattrs");
+    VERIFY(attrs[2].ntype, DFNT_FLOAT64, "SDreadallattrs");
+    VERIFY(attrs[2].count, 2, "SDreadallattrs");
+    VERIFY((((char *)attrs[2].values - (char *)arena) % 8), 0, "SDreadallattrs");
+    VERIFY(memcmp(attrs[2].values, dvals, sizeof(dvals)), 0, "SDreadallattrs");
+
+    /* The last attribute does not fit */
+    size   = full_size - 1;
+    nattrs = SDreadallattrs(sds_id, attrs, READALL_NATTR, arena, &size);
+    VERIFY(nattrs, READALL_NATTR, "SDreadallattrs");
+    VERIFY(size, full_size, "SDreadallattrs");
+    VERIFY(memcmp(attrs[1].values, ivals, sizeof(ivals)), 0, "SDreadallattrs");
+    VERIFY((attrs[2].values == NULL && attrs[2].name == NULL), TRUE, "SDreadallattrs");
+    VERIFY(attrs[2].count, 2, "SDreadallattrs");
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    /* The file attribute */
+    size   = full_size;
+    nattrs = SDreadallattrs(file_id, attrs, READALL_NATTR, arena, &size);
+    VERIFY(nattrs, 1, "SDreadallattrs");
+    VERIFY(strcmp(attrs[0].name, ATTR2_NAME), 0, "SDreadallattrs");
+    VERIFY(strncmp((char *)attrs[0].values, ATTR2_VAL, ATTR2_LEN), 0, "SDreadallattrs");
+
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+    free(arena);
+
+    /* Return the number of errors that's been kept track of so far */
+    return num_errs;
+} /* test_readallattrs */
+
 /* Test driver for testing SD attributes. */
 extern int
 test_attributes()
@@ -272,6 +784,15 @@ test_attributes()
     /* test when count is passed into SDsetattr as 0 */
     num_errs = num_errs + test_count();
 
+    /* test reading attributes from a lazily opened file */
+    num_errs = num_errs + test_lazy_open();
+
+    /* test that closing a file writes only the metadata that changed */
+    num_errs = num_errs + test_incremental_flush();
+
+    /* test reading all the attributes of an object at once */
+    num_errs = num_errs + test_readallattrs();
+
     if (num_errs == 0)
         PASSED();
 
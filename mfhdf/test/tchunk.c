@@ -17,6 +17,89 @@
 
 #define CHKFILE   "chktst.hdf"  /* Chunking test file */
 #define CNBITFILE "chknbit.hdf" /* Chunking w/ NBIT compression */
+#define CTHRFILE  "chkthr.hdf"  /* Chunking w/ threaded decoding */
+#define CPOLFILE  "chkpol.hdf"  /* Chunk cache replacement policies */
+#define CIDXFILE  "chkidx.hdf"  /* Chunk index read on open */
+#define CSPAFILE  "chkspa.hdf"  /* Chunks of only fill values */
+#define CPROFILE  "chkpro.hdf"  /* Chunks decoded by a decode provider */
+#define CSLBFILE  "chkslb.hdf"  /* Data sets split into slabs of chunks */
+#define CVWFILE   "chkvw.hdf"   /* Chunks held in the chunk cache */
+#define CSTFILE   "chkst.hdf"   /* Statistics of the chunks */
+#define CDUPFILE  "chkdup.hdf"  /* Identical chunks sharing their data */
+#define CHSLFILE  "chkhsl.hdf"  /* Hyperslabs read chunk by chunk */
+#define CRAWFILE  "chkraw.hdf"  /* Chunks that do not compress stored as they are */
+#define CCODFILE  "chkcod.hdf"  /* Coder of each chunk picked by a trial */
+#define CSUMFILE  "chksum.hdf"  /* Checksums of the chunks */
+
+/* Dimensions of the dataset for the threaded decoding test */
+#define THR_DIM0   120
+#define THR_DIM1   150
+#define THR_CHUNK0 20
+#define THR_CHUNK1 25
+
+/* Number of rows of the slabs of the readahead test */
+#define RA_SLAB 5
+
+/* Dimensions of the dataset for the cache policy test, one chunk per row */
+#define POL_DIM0  16
+#define POL_DIM1  8
+#define POL_CACHE 4
+
+/* Dimensions of the dataset for the chunk index test, one chunk per element,
+   so that the chunk table is longer than one batch read of it */
+#define IDX_DIM0 80
+#define IDX_DIM1 64
+
+/* Dimensions of the dataset for the sparse chunk test, SPA_NCHUNK chunks
+   along each dimension of which only the diagonal ones hold data */
+#define SPA_DIM    64
+#define SPA_CHUNK  16
+#define SPA_NCHUNK (SPA_DIM / SPA_CHUNK)
+#define SPA_FILL   (-1)
+
+/* Dimensions of the dataset for the chunk view test, the last column of
+   chunks is partial */
+#define VW_DIM0   30
+#define VW_DIM1   20
+#define VW_CHUNK0 10
+#define VW_CHUNK1 8
+#define VW_NCHUNK 9
+
+/* Dimensions of the dataset for the chunk statistics test */
+#define ST_DIM    40
+#define ST_CHUNK  10
+#define ST_NCHUNK (ST_DIM / ST_CHUNK)
+#define ST_FILL   (-999.0)
+
+/* Dimensions of the dataset for the chunk deduplication test, DUP_NCHUNK
+   chunks along each dimension, each one of two kinds */
+#define DUP_DIM    64
+#define DUP_CHUNK  16
+#define DUP_NCHUNK (DUP_DIM / DUP_CHUNK)
+
+/* First dimension and fill value of the datasets for the hyperslab test,
+   only the first half along that dimension is written */
+#define HSL_DIM0 12
+#define HSL_FILL (-7)
+
+/* Dimensions of the datasets for the compression limit test, RAW_NCHUNK
+   chunks along each dimension, of noise on the diagonal */
+#define RAW_DIM    128
+#define RAW_CHUNK  64
+#define RAW_NCHUNK (RAW_DIM / RAW_CHUNK)
+#define RAW_LIMIT  95
+
+/* Dimensions of the datasets for the coder policy test, and the policies
+   that pick the fastest and the smallest coder */
+#define POL_DIM      128
+#define POL_CHUNK    64
+#define POL_FASTEST  1000
+#define POL_SMALLEST 0
+
+/* Dimensions of the datasets for the chunk checksums test */
+#define SUM_DIM    32
+#define SUM_CHUNK  8
+#define SUM_NCHUNK (SUM_DIM / SUM_CHUNK)
 
 /* Dimensions of slab */
 static int32 edge_dims[3]  = {2, 3, 4}; /* size of slab dims */
@@ -76,6 +159,2291 @@ static uint16 u16_data[2][3][4] = {{{0, 1, 2, 3}, {10, 11, 12, 13}, {20, 21, 22,
 static uint8 u8_data[2][3][4] = {{{0, 1, 2, 3}, {10, 11, 12, 13}, {20, 21, 22, 23}},
                                  {{100, 101, 102, 103}, {110, 111, 112, 113}, {120, 121, 122, 123}}};
 
+/********************************************************************
+   Name: test_chunk_threads() - tests reading and writing deflate
+                compressed chunked SDSs with their chunks coded on several
+                threads
+
+   Description:
+        Writes a deflate compressed chunked SDS, then reads it back,
+        whole and as a hyperslab spanning partial chunks, after
+        SDsetchunkthreads() was called.  The read is then repeated
+        with a chunk cache of a single chunk so that chunks have to be
+        decoded again.
+
+        A second SDS is written with SDsetchunkthreads() and a single
+        chunk cache in two hyperslabs that share a row of chunks, so
+        chunks waiting to be encoded are read back and modified, and
+        it is read back before and after it is closed.
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+static int
+test_chunk_threads(void)
+{
+    int32         fchk, sds_id;
+    int32         dims[2]  = {THR_DIM0, THR_DIM1};
+    int32         wstart[2], wedges[2];
+    int32         start[2] = {0, 0};
+    int32         edges[2] = {THR_DIM0, THR_DIM1};
+    HDF_CHUNK_DEF chunk_def;
+    static int32  data[THR_DIM0][THR_DIM1];
+    static int32  outdata[THR_DIM0][THR_DIM1];
+    intn          status;
+    intn          i, j;
+    int           num_errs = 0;
+
+    for (i = 0; i < THR_DIM0; i++)
+        for (j = 0; j < THR_DIM1; j++)
+            data[i][j] = i * 1000 + j;
+
+    /* Create the deflate compressed chunked SDS */
+    fchk = SDstart(CTHRFILE, DFACC_CREATE);
+    CHECK(fchk, FAIL, "test_chunk_threads: SDstart");
+
+    sds_id = SDcreate(fchk, "Threaded", DFNT_INT32, 2, dims);
+    CHECK(sds_id, FAIL, "test_chunk_threads: SDcreate");
+
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]    = THR_CHUNK0;
+    chunk_def.comp.chunk_lengths[1]    = THR_CHUNK1;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 6;
+
+    status = SDsetchunk(sds_id, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "test_chunk_threads: SDsetchunk");
+
+    status = SDwritedata(sds_id, start, NULL, edges, (void *)data);
+    CHECK(status, FAIL, "test_chunk_threads: SDwritedata");
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_chunk_threads: SDendaccess");
+
+    /* Create the second one, with its chunks encoded on 4 threads */
+    sds_id = SDcreate(fchk, "ThreadedWrite", DFNT_INT32, 2, dims);
+    CHECK(sds_id, FAIL, "test_chunk_threads: SDcreate");
+
+    status = SDsetchunk(sds_id, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "test_chunk_threads: SDsetchunk");
+    status = SDsetchunkthreads(sds_id, 4);
+    VERIFY(status, 1, "test_chunk_threads: SDsetchunkthreads");
+    status = SDsetchunkcache(sds_id, 1, 0);
+    CHECK(status, FAIL, "test_chunk_threads: SDsetchunkcache");
+
+    /* Rows 0-49 then 50-119: the chunks of rows 40-59 are written twice */
+    wstart[0] = 0;
+    wstart[1] = 0;
+    wedges[0] = 50;
+    wedges[1] = THR_DIM1;
+    status    = SDwritedata(sds_id, wstart, NULL, wedges, (void *)data);
+    CHECK(status, FAIL, "test_chunk_threads: SDwritedata");
+    wstart[0] = 50;
+    wedges[0] = THR_DIM0 - 50;
+    status    = SDwritedata(sds_id, wstart, NULL, wedges, (void *)data[50]);
+    CHECK(status, FAIL, "test_chunk_threads: SDwritedata");
+
+    /* Read back while some chunks have not reached the file yet */
+    memset(outdata, 0, sizeof(outdata));
+    status = SDreaddata(sds_id, start, NULL, edges, (void *)outdata);
+    CHECK(status, FAIL, "test_chunk_threads: SDreaddata");
+    if (memcmp(outdata, data, sizeof(data)) != 0) {
+        fprintf(stderr, "test_chunk_threads: wrong data read before SDendaccess\n");
+        num_errs++;
+    }
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_chunk_threads: SDendaccess");
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_threads: SDend");
+
+    /* Read the second one back serially */
+    fchk = SDstart(CTHRFILE, DFACC_READ);
+    CHECK(fchk, FAIL, "test_chunk_threads: SDstart");
+
+    sds_id = SDselect(fchk, 1);
+    CHECK(sds_id, FAIL, "test_chunk_threads: SDselect");
+
+    memset(outdata, 0, sizeof(outdata));
+    status = SDreaddata(sds_id, start, NULL, edges, (void *)outdata);
+    CHECK(status, FAIL, "test_chunk_threads: SDreaddata");
+    if (memcmp(outdata, data, sizeof(data)) != 0) {
+        fprintf(stderr, "test_chunk_threads: wrong data read after SDendaccess\n");
+        num_errs++;
+    }
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_chunk_threads: SDendaccess");
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_threads: SDend");
+
+    /* Read the first one back with the chunks decoded on 4 threads */
+    fchk = SDstart(CTHRFILE, DFACC_READ);
+    CHECK(fchk, FAIL, "test_chunk_threads: SDstart");
+
+    sds_id = SDselect(fchk, 0);
+    CHECK(sds_id, FAIL, "test_chunk_threads: SDselect");
+
+    status = SDsetchunkthreads(sds_id, 0);
+    VERIFY(status, FAIL, "test_chunk_threads: SDsetchunkthreads");
+    status = SDsetchunkthreads(sds_id, 4);
+    VERIFY(status, 1, "test_chunk_threads: SDsetchunkthreads");
+
+    /* Whole dataset */
+    memset(outdata, 0, sizeof(outdata));
+    status = SDreaddata(sds_id, start, NULL, edges, (void *)outdata);
+    CHECK(status, FAIL, "test_chunk_threads: SDreaddata");
+    for (i = 0; i < THR_DIM0; i++)
+        for (j = 0; j < THR_DIM1; j++)
+            if (outdata[i][j] != data[i][j]) {
+                fprintf(stderr, "test_chunk_threads: whole read, wrong value at [%d][%d]\n", i, j);
+                num_errs++;
+                goto done;
+            }
+
+    /* Hyperslab crossing partial chunks, with a single-chunk cache */
+    status = SDsetchunkcache(sds_id, 1, 0);
+    CHECK(status, FAIL, "test_chunk_threads: SDsetchunkcache");
+
+    start[0] = 7;
+    start[1] = 13;
+    edges[0] = 91;
+    edges[1] = 111;
+    memset(outdata, 0, sizeof(outdata));
+    status = SDreaddata(sds_id, start, NULL, edges, (void *)outdata);
+    CHECK(status, FAIL, "test_chunk_threads: SDreaddata");
+    for (i = 0; i < edges[0]; i++)
+        for (j = 0; j < edges[1]; j++)
+            if (((int32 *)outdata)[i * edges[1] + j] != data[start[0] + i][start[1] + j]) {
+                fprintf(stderr, "test_chunk_threads: slab read, wrong value at [%d][%d]\n", i, j);
+                num_errs++;
+                goto done;
+            }
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_chunk_threads: SDendaccess");
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_threads: SDend");
+
+done:
+    return num_errs;
+} /* test_chunk_threads() */
+
+/* Phases begun as seen by trace_count() */
+static int32 trace_begun[HDF_TRACE_NOPS];
+
+static void
+trace_count(hdf_trace_op_t op, intn end, int32 count, void *user_data)
+{
+    (void)count;
+    (void)user_data;
+    if (!end && op >= HDF_TRACE_OPEN && op < HDF_TRACE_NOPS)
+        trace_begun[op]++;
+}
+
+/********************************************************************
+   Name: test_chunk_readahead() - tests the readahead of the chunks of
+                a dataset read slab by slab
+
+   Description:
+        Reads the deflate compressed SDS written by test_chunk_threads()
+        in slabs of RA_SLAB rows, first serially and then with its chunks
+        decoded on 4 threads, with readahead on.  Once the pattern was
+        seen, each row of chunks is brought into the chunk cache by the
+        read before the first one using it, so only the very first read
+        misses the cache, which is checked with SDgetchunkcachestats().
+        The bytes decoded by the deflate coder are checked through
+        Hgetstats() on the file opened again at the H level, and the
+        phases of the serial pass through Hset_trace_callback().
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+static int
+test_chunk_readahead(void)
+{
+    int32             fchk, sds_id, fid;
+    int32             start[2] = {0, 0};
+    int32             edges[2] = {RA_SLAB, THR_DIM1};
+    hdf_cache_stats_t cstats;
+    hdf_stats_t       fstats;
+    static int32      outdata[RA_SLAB][THR_DIM1];
+    intn              status;
+    intn              pass, i, j;
+    int               num_errs = 0;
+
+    for (pass = 0; pass < 2; pass++) {
+        if (pass == 0) {
+            memset(trace_begun, 0, sizeof(trace_begun));
+            status = Hset_trace_callback(trace_count, NULL);
+            CHECK(status, FAIL, "test_chunk_readahead: Hset_trace_callback");
+        }
+
+        fchk = SDstart(CTHRFILE, DFACC_READ);
+        CHECK(fchk, FAIL, "test_chunk_readahead: SDstart");
+
+        sds_id = SDselect(fchk, 0);
+        CHECK(sds_id, FAIL, "test_chunk_readahead: SDselect");
+
+        if (pass == 1) {
+            status = SDsetchunkthreads(sds_id, 4);
+            VERIFY(status, 1, "test_chunk_readahead: SDsetchunkthreads");
+        }
+        status = SDsetchunkreadahead(sds_id, TRUE);
+        VERIFY(status, FALSE, "test_chunk_readahead: SDsetchunkreadahead");
+        status = SDsetchunkreadahead(sds_id, TRUE);
+        VERIFY(status, TRUE, "test_chunk_readahead: SDsetchunkreadahead");
+
+        for (start[0] = 0; start[0] < THR_DIM0; start[0] += RA_SLAB) {
+            memset(outdata, 0, sizeof(outdata));
+            status = SDreaddata(sds_id, start, NULL, edges, (void *)outdata);
+            CHECK(status, FAIL, "test_chunk_readahead: SDreaddata");
+            for (i = 0; i < RA_SLAB; i++)
+                for (j = 0; j < THR_DIM1; j++)
+                    if (outdata[i][j] != (start[0] + i) * 1000 + j) {
+                        fprintf(stderr, "test_chunk_readahead: pass %d, wrong value at [%d][%d]\n", pass,
+                                (int)start[0] + i, j);
+                        num_errs++;
+                        goto done;
+                    }
+        }
+
+        /* every row of a slab looks up the THR_DIM1 / THR_CHUNK1 chunks it
+           crosses; all chunks were missed once, by the first read or ahead */
+        status = SDgetchunkcachestats(sds_id, &cstats);
+        CHECK(status, FAIL, "test_chunk_readahead: SDgetchunkcachestats");
+        VERIFY(cstats.misses, (THR_DIM0 / THR_CHUNK0) * (THR_DIM1 / THR_CHUNK1),
+               "test_chunk_readahead: SDgetchunkcachestats");
+        VERIFY(cstats.hits, (THR_DIM0 - 1) * (THR_DIM1 / THR_CHUNK1),
+               "test_chunk_readahead: SDgetchunkcachestats");
+
+        if (pass == 0) {
+            /* every chunk was brought into the cache once, and decoded */
+            status = Hset_trace_callback(NULL, NULL);
+            CHECK(status, FAIL, "test_chunk_readahead: Hset_trace_callback");
+            VERIFY(trace_begun[HDF_TRACE_META_READ], 1, "test_chunk_readahead: Hset_trace_callback");
+            VERIFY(trace_begun[HDF_TRACE_CHUNK], cstats.misses, "test_chunk_readahead: Hset_trace_callback");
+            VERIFY(trace_begun[HDF_TRACE_DECODE], cstats.misses, "test_chunk_readahead: Hset_trace_callback");
+        }
+
+        /* every chunk was decoded once */
+        fid = Hopen(CTHRFILE, DFACC_READ, 0);
+        CHECK(fid, FAIL, "test_chunk_readahead: Hopen");
+        status = Hgetstats(fid, &fstats);
+        CHECK(status, FAIL, "test_chunk_readahead: Hgetstats");
+        VERIFY(fstats.bytes_decoded[COMP_CODE_DEFLATE], THR_DIM0 * THR_DIM1 * sizeof(int32),
+               "test_chunk_readahead: Hgetstats");
+        status = Hclose(fid);
+        CHECK(status, FAIL, "test_chunk_readahead: Hclose");
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "test_chunk_readahead: SDendaccess");
+        status = SDend(fchk);
+        CHECK(status, FAIL, "test_chunk_readahead: SDend");
+    }
+
+done:
+    Hset_trace_callback(NULL, NULL);
+    return num_errs;
+} /* test_chunk_readahead() */
+
+#ifndef H4_HAVE_WIN32_API
+/* A read-only "remote" driver reading through stdio and counting the bytes
+   it reads */
+static int32 remote_nbytes = 0;
+
+static void *
+remote_open(const char *path, intn acc_mode)
+{
+    return (acc_mode & (DFACC_WRITE | DFACC_CREATE)) ? NULL : (void *)fopen(path, "rb");
+}
+
+static intn
+remote_read(void *handle, int32 offset, void *buf, int32 bytes)
+{
+    remote_nbytes += bytes;
+    if (fseek((FILE *)handle, (long)offset, SEEK_SET) != 0 ||
+        fread(buf, 1, (size_t)bytes, (FILE *)handle) != (size_t)bytes)
+        return FAIL;
+    return SUCCEED;
+}
+
+static int32
+remote_size(void *handle)
+{
+    if (fseek((FILE *)handle, 0L, SEEK_END) != 0)
+        return FAIL;
+    return (int32)ftell((FILE *)handle);
+}
+
+static intn
+remote_close(void *handle)
+{
+    return fclose((FILE *)handle) == 0 ? SUCCEED : FAIL;
+}
+
+static const hdf_driver_t remote_driver = {"remote",    remote_open, remote_read, NULL,
+                                           remote_size, NULL,        remote_close};
+
+/********************************************************************
+   Name: test_chunk_diskcache() - tests the local chunk cache of the
+                files opened through a remote driver
+
+   Description:
+        Reads the SDS of the threaded decoding test file three times
+        through a driver of the test's own, with the local chunk cache
+        in the current directory, counting the bytes the driver reads.
+        The first, serial, read fills the cache; the second, on 4
+        threads, finds all the compressed chunks in it and reads that
+        many bytes less from the file.  Setting the size of the cache to
+        0 empties it, so the third read reads them all again.
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+static int
+test_chunk_diskcache(void)
+{
+    int32        fchk, sds_id;
+    int32        start[2] = {0, 0};
+    int32        edges[2] = {THR_DIM0, THR_DIM1};
+    static int32 outdata[THR_DIM0][THR_DIM1];
+    int32        comp_size, uncomp_size;
+    int32        nbytes[3];
+    intn         status;
+    intn         pass, i, j;
+    int          num_errs = 0;
+
+    status = SDsetchunkdiskcache("", 1024);
+    VERIFY(status, FAIL, "test_chunk_diskcache: SDsetchunkdiskcache");
+    status = SDsetchunkdiskcache(".", -1);
+    VERIFY(status, FAIL, "test_chunk_diskcache: SDsetchunkdiskcache");
+    status = SDsetchunkdiskcache(".", 1024);
+    CHECK(status, FAIL, "test_chunk_diskcache: SDsetchunkdiskcache");
+
+    status = Hregisterdriver(&remote_driver);
+    CHECK(status, FAIL, "test_chunk_diskcache: Hregisterdriver");
+    status = Hsetdriver("remote");
+    CHECK(status, FAIL, "test_chunk_diskcache: Hsetdriver");
+
+    for (pass = 0; pass < 3; pass++) {
+        if (pass == 2) {
+            status = SDsetchunkdiskcache(".", 0);
+            CHECK(status, FAIL, "test_chunk_diskcache: SDsetchunkdiskcache");
+        }
+        remote_nbytes = 0;
+
+        fchk = SDstart(CTHRFILE, DFACC_READ);
+        CHECK(fchk, FAIL, "test_chunk_diskcache: SDstart");
+        sds_id = SDselect(fchk, 0);
+        CHECK(sds_id, FAIL, "test_chunk_diskcache: SDselect");
+        if (pass == 1) {
+            status = SDsetchunkthreads(sds_id, 4);
+            VERIFY(status, 1, "test_chunk_diskcache: SDsetchunkthreads");
+        }
+
+        memset(outdata, 0, sizeof(outdata));
+        status = SDreaddata(sds_id, start, NULL, edges, (void *)outdata);
+        CHECK(status, FAIL, "test_chunk_diskcache: SDreaddata");
+        for (i = 0; i < THR_DIM0; i++)
+            for (j = 0; j < THR_DIM1; j++)
+                if (outdata[i][j] != i * 1000 + j) {
+                    fprintf(stderr, "test_chunk_diskcache: pass %d, wrong value at [%d][%d]\n", pass, i, j);
+                    num_errs++;
+                    i = THR_DIM0;
+                    break;
+                }
+
+        status = SDgetdatasize(sds_id, &comp_size, &uncomp_size);
+        CHECK(status, FAIL, "test_chunk_diskcache: SDgetdatasize");
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "test_chunk_diskcache: SDendaccess");
+        status = SDend(fchk);
+        CHECK(status, FAIL, "test_chunk_diskcache: SDend");
+        nbytes[pass] = remote_nbytes;
+    }
+
+    /* the second pass read no chunk from the file, the third all of them */
+    if (nbytes[1] + comp_size > nbytes[0] || nbytes[2] != nbytes[0]) {
+        fprintf(stderr, "test_chunk_diskcache: %d, %d and %d bytes read for %d bytes of chunks\n",
+                (int)nbytes[0], (int)nbytes[1], (int)nbytes[2], (int)comp_size);
+        num_errs++;
+    }
+
+    status = Hsetdriver(NULL);
+    CHECK(status, FAIL, "test_chunk_diskcache: Hsetdriver");
+    status = SDsetchunkdiskcache(NULL, 0);
+    CHECK(status, FAIL, "test_chunk_diskcache: SDsetchunkdiskcache");
+
+    return num_errs;
+} /* test_chunk_diskcache() */
+#endif /* H4_HAVE_WIN32_API */
+
+/********************************************************************
+   Name: test_chunk_cache_policy() - tests the replacement policies of
+                the chunk cache
+
+   Description:
+        Writes a chunked SDS with one chunk per row, then reads it back
+        with a cache much smaller than the SDS under each replacement
+        policy.  Each pass reads the two first rows, the hot set, and then
+        scans the rest of the SDS.  The scan evicts the hot set from an LRU
+        cache on every pass, but not from a 2Q cache, which is checked with
+        SDgetchunkcachestats().
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+static int
+test_chunk_cache_policy(void)
+{
+    int32             fchk, sds_id;
+    int32             dims[2] = {POL_DIM0, POL_DIM1};
+    int32             start[2], edges[2];
+    HDF_CHUNK_DEF     chunk_def;
+    int32             data[POL_DIM0][POL_DIM1];
+    int32             outrow[POL_DIM1];
+    int32             policies[3] = {HDF_CACHE_LRU, HDF_CACHE_CLOCK, HDF_CACHE_2Q};
+    int32             hits[3];
+    hdf_cache_stats_t cstats;
+    intn              status;
+    intn              i, j, pass, p;
+    int               num_errs = 0;
+
+    for (i = 0; i < POL_DIM0; i++)
+        for (j = 0; j < POL_DIM1; j++)
+            data[i][j] = i * 100 + j;
+
+    fchk = SDstart(CPOLFILE, DFACC_CREATE);
+    CHECK(fchk, FAIL, "test_chunk_cache_policy: SDstart");
+
+    sds_id = SDcreate(fchk, "Policy", DFNT_INT32, 2, dims);
+    CHECK(sds_id, FAIL, "test_chunk_cache_policy: SDcreate");
+
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.chunk_lengths[0] = 1;
+    chunk_def.chunk_lengths[1] = POL_DIM1;
+    status                     = SDsetchunk(sds_id, chunk_def, HDF_CHUNK);
+    CHECK(status, FAIL, "test_chunk_cache_policy: SDsetchunk");
+
+    start[0] = start[1] = 0;
+    status              = SDwritedata(sds_id, start, NULL, dims, (void *)data);
+    CHECK(status, FAIL, "test_chunk_cache_policy: SDwritedata");
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_chunk_cache_policy: SDendaccess");
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_cache_policy: SDend");
+
+    for (p = 0; p < 3; p++) {
+        fchk = SDstart(CPOLFILE, DFACC_READ);
+        CHECK(fchk, FAIL, "test_chunk_cache_policy: SDstart");
+
+        sds_id = SDselect(fchk, 0);
+        CHECK(sds_id, FAIL, "test_chunk_cache_policy: SDselect");
+
+        /* both policy bits at once is not a policy */
+        status = SDsetchunkcache(sds_id, POL_CACHE, HDF_CACHE_POLICY);
+        VERIFY(status, FAIL, "test_chunk_cache_policy: SDsetchunkcache");
+
+        status = SDsetchunkcache(sds_id, POL_CACHE, policies[p]);
+        VERIFY(status, POL_CACHE, "test_chunk_cache_policy: SDsetchunkcache");
+
+        edges[0] = 1;
+        edges[1] = POL_DIM1;
+        for (pass = 0; pass < 4; pass++)
+            for (i = 0; i < POL_DIM0 + 2; i++) {
+                /* rows 0, 1, 0, 1, then the scan of rows 2 and up */
+                start[0] = (i < 4) ? i % 2 : i - 2;
+                memset(outrow, 0, sizeof(outrow));
+                status = SDreaddata(sds_id, start, NULL, edges, (void *)outrow);
+                CHECK(status, FAIL, "test_chunk_cache_policy: SDreaddata");
+                if (memcmp(outrow, data[start[0]], sizeof(outrow)) != 0) {
+                    fprintf(stderr, "test_chunk_cache_policy: policy %d, wrong data in row %d\n",
+                            (int)policies[p], (int)start[0]);
+                    num_errs++;
+                }
+            }
+
+        status = SDgetchunkcachestats(sds_id, &cstats);
+        CHECK(status, FAIL, "test_chunk_cache_policy: SDgetchunkcachestats");
+        VERIFY(cstats.hits + cstats.misses, 4 * (POL_DIM0 + 2), "test_chunk_cache_policy: SDgetchunkcachestats");
+        /* a chunk only leaves the full cache when it is evicted */
+        VERIFY(cstats.evictions, cstats.misses - POL_CACHE, "test_chunk_cache_policy: SDgetchunkcachestats");
+        hits[p] = cstats.hits;
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "test_chunk_cache_policy: SDendaccess");
+        status = SDend(fchk);
+        CHECK(status, FAIL, "test_chunk_cache_policy: SDend");
+    }
+
+    /* the scan-resistant policy keeps the hot set across the scans */
+    if (hits[2] <= hits[0]) {
+        fprintf(stderr, "test_chunk_cache_policy: 2Q cache hits %d, LRU cache hits %d\n", (int)hits[2],
+                (int)hits[0]);
+        num_errs++;
+    }
+
+    return num_errs;
+} /* test_chunk_cache_policy() */
+
+/********************************************************************
+   Name: test_chunk_index() - tests the chunk index built when a chunked
+                SDS is opened
+
+   Description:
+        Writes a chunked SDS with one chunk per element in reverse order,
+        leaving out every fifth chunk, then reopens the file and checks
+        that the written chunks are found and the others read as the fill
+        value.  The missing chunks are then written and one chunk is
+        overwritten, and the whole SDS is checked once more after the
+        file is reopened a second time.
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+static int
+test_chunk_index(void)
+{
+    int32         fchk, sds_id;
+    int32         dims[2] = {IDX_DIM0, IDX_DIM1};
+    int32         start[2] = {0, 0};
+    int32         origin[2];
+    int32         fill_val = -1;
+    int32         value;
+    HDF_CHUNK_DEF chunk_def;
+    static int32  outdata[IDX_DIM0][IDX_DIM1];
+    intn          status;
+    intn          i, j, pass;
+    int           num_errs = 0;
+
+    fchk = SDstart(CIDXFILE, DFACC_CREATE);
+    CHECK(fchk, FAIL, "test_chunk_index: SDstart");
+
+    sds_id = SDcreate(fchk, "Indexed", DFNT_INT32, 2, dims);
+    CHECK(sds_id, FAIL, "test_chunk_index: SDcreate");
+
+    status = SDsetfillvalue(sds_id, (void *)&fill_val);
+    CHECK(status, FAIL, "test_chunk_index: SDsetfillvalue");
+
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.chunk_lengths[0] = 1;
+    chunk_def.chunk_lengths[1] = 1;
+    status                     = SDsetchunk(sds_id, chunk_def, HDF_CHUNK);
+    CHECK(status, FAIL, "test_chunk_index: SDsetchunk");
+
+    for (i = IDX_DIM0 - 1; i >= 0; i--)
+        for (j = IDX_DIM1 - 1; j >= 0; j--) {
+            if ((i * IDX_DIM1 + j) % 5 == 0)
+                continue;
+            origin[0] = i;
+            origin[1] = j;
+            value     = i * 1000 + j;
+            status    = SDwritechunk(sds_id, origin, (void *)&value);
+            CHECK(status, FAIL, "test_chunk_index: SDwritechunk");
+        }
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_chunk_index: SDendaccess");
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_index: SDend");
+
+    for (pass = 0; pass < 2; pass++) {
+        fchk = SDstart(CIDXFILE, DFACC_RDWR);
+        CHECK(fchk, FAIL, "test_chunk_index: SDstart");
+
+        sds_id = SDselect(fchk, 0);
+        CHECK(sds_id, FAIL, "test_chunk_index: SDselect");
+
+        memset(outdata, 0, sizeof(outdata));
+        status = SDreaddata(sds_id, start, NULL, dims, (void *)outdata);
+        CHECK(status, FAIL, "test_chunk_index: SDreaddata");
+        for (i = 0; i < IDX_DIM0; i++)
+            for (j = 0; j < IDX_DIM1; j++) {
+                if (pass == 1 && i == 3 && j == 7)
+                    value = 4242;
+                else if (pass == 0 && (i * IDX_DIM1 + j) % 5 == 0)
+                    value = fill_val;
+                else
+                    value = i * 1000 + j;
+                if (outdata[i][j] != value) {
+                    fprintf(stderr, "test_chunk_index: pass %d, wrong value at [%d][%d]\n", pass, i, j);
+                    num_errs++;
+                    goto done;
+                }
+            }
+
+        if (pass == 0) {
+            /* write the chunks left out, then overwrite one written before */
+            for (i = 0; i < IDX_DIM0; i++)
+                for (j = 0; j < IDX_DIM1; j++) {
+                    if ((i * IDX_DIM1 + j) % 5 != 0)
+                        continue;
+                    origin[0] = i;
+                    origin[1] = j;
+                    value     = i * 1000 + j;
+                    status    = SDwritechunk(sds_id, origin, (void *)&value);
+                    CHECK(status, FAIL, "test_chunk_index: SDwritechunk");
+                }
+            origin[0] = 3;
+            origin[1] = 7;
+            value     = 4242;
+            status    = SDwritechunk(sds_id, origin, (void *)&value);
+            CHECK(status, FAIL, "test_chunk_index: SDwritechunk");
+        }
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "test_chunk_index: SDendaccess");
+        status = SDend(fchk);
+        CHECK(status, FAIL, "test_chunk_index: SDend");
+    }
+
+done:
+    return num_errs;
+} /* test_chunk_index() */
+
+#ifndef H4_HAVE_THREADSAFE
+/********************************************************************
+   Name: test_chunk_cache_pool() - tests the chunk cache pool shared
+                by several datasets
+
+   Description:
+        Adds a second SDS to the cache policy test file, then reads three
+        chunks of each of the two SDSs in turn, first with caches of their
+        own that can hold all of them, then with the same caches in a
+        shared pool that only has room for four chunks, and checks the
+        data and the number of chunks that had to be read.
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+static int
+test_chunk_cache_pool(void)
+{
+    int32             fchk, sds_id[2];
+    int32             dims[2] = {POL_DIM0, POL_DIM1};
+    int32             start[2], edges[2];
+    HDF_CHUNK_DEF     chunk_def;
+    int32             data[POL_DIM0][POL_DIM1];
+    int32             outrow[POL_DIM1];
+    int32             nmisses;
+    hdf_cache_stats_t cstats;
+    int32             budget;
+    intn              status;
+    intn              i, j, k, pass, shared;
+    int               num_errs = 0;
+
+    for (i = 0; i < POL_DIM0; i++)
+        for (j = 0; j < POL_DIM1; j++)
+            data[i][j] = i * 100 + j + 1;
+
+    fchk = SDstart(CPOLFILE, DFACC_RDWR);
+    CHECK(fchk, FAIL, "test_chunk_cache_pool: SDstart");
+
+    sds_id[1] = SDcreate(fchk, "Pooled", DFNT_INT32, 2, dims);
+    CHECK(sds_id[1], FAIL, "test_chunk_cache_pool: SDcreate");
+
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.chunk_lengths[0] = 1;
+    chunk_def.chunk_lengths[1] = POL_DIM1;
+    status                     = SDsetchunk(sds_id[1], chunk_def, HDF_CHUNK);
+    CHECK(status, FAIL, "test_chunk_cache_pool: SDsetchunk");
+
+    start[0] = start[1] = 0;
+    status              = SDwritedata(sds_id[1], start, NULL, dims, (void *)data);
+    CHECK(status, FAIL, "test_chunk_cache_pool: SDwritedata");
+
+    status = SDendaccess(sds_id[1]);
+    CHECK(status, FAIL, "test_chunk_cache_pool: SDendaccess");
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_cache_pool: SDend");
+
+    status = SDsetchunkcachebudget(0);
+    VERIFY(status, FAIL, "test_chunk_cache_pool: SDsetchunkcachebudget");
+    budget = SDsetchunkcachebudget(4 * POL_DIM1 * (int32)sizeof(int32));
+    CHECK(budget, FAIL, "test_chunk_cache_pool: SDsetchunkcachebudget");
+
+    for (shared = 0; shared < 2; shared++) {
+        fchk = SDstart(CPOLFILE, DFACC_READ);
+        CHECK(fchk, FAIL, "test_chunk_cache_pool: SDstart");
+
+        for (k = 0; k < 2; k++) {
+            sds_id[k] = SDselect(fchk, k);
+            CHECK(sds_id[k], FAIL, "test_chunk_cache_pool: SDselect");
+            status = SDsetchunkcache(sds_id[k], 8, shared ? HDF_CACHE_SHARED : 0);
+            VERIFY(status, 8, "test_chunk_cache_pool: SDsetchunkcache");
+        }
+
+        edges[0] = 1;
+        edges[1] = POL_DIM1;
+        start[1] = 0;
+        for (pass = 0; pass < 3; pass++)
+            for (k = 0; k < 2; k++)
+                for (i = 0; i < 3; i++) {
+                    start[0] = i;
+                    memset(outrow, 0, sizeof(outrow));
+                    status = SDreaddata(sds_id[k], start, NULL, edges, (void *)outrow);
+                    CHECK(status, FAIL, "test_chunk_cache_pool: SDreaddata");
+                    if (outrow[1] != i * 100 + 1 + k) {
+                        fprintf(stderr, "test_chunk_cache_pool: SDS %d, wrong data in row %d\n", k, i);
+                        num_errs++;
+                    }
+                }
+
+        nmisses = 0;
+        for (k = 0; k < 2; k++) {
+            status = SDgetchunkcachestats(sds_id[k], &cstats);
+            CHECK(status, FAIL, "test_chunk_cache_pool: SDgetchunkcachestats");
+            nmisses += cstats.misses;
+
+            status = SDendaccess(sds_id[k]);
+            CHECK(status, FAIL, "test_chunk_cache_pool: SDendaccess");
+        }
+        status = SDend(fchk);
+        CHECK(status, FAIL, "test_chunk_cache_pool: SDend");
+
+        /* the six chunks fit in the caches of their own, but not in the pool */
+        if (shared ? nmisses <= 6 : nmisses != 6) {
+            fprintf(stderr, "test_chunk_cache_pool: %s caches, %d chunks read\n", shared ? "shared" : "private",
+                    (int)nmisses);
+            num_errs++;
+        }
+    }
+
+    status = SDsetchunkcachebudget(budget);
+    VERIFY(status, 4 * POL_DIM1 * (int32)sizeof(int32), "test_chunk_cache_pool: SDsetchunkcachebudget");
+
+    return num_errs;
+} /* test_chunk_cache_pool() */
+#endif /* H4_HAVE_THREADSAFE */
+
+/********************************************************************
+   Name: test_chunk_sparse() - tests that chunks of only fill values
+                are left unwritten
+
+   Description:
+        Writes the same data, fill values everywhere but in the chunks
+        on the diagonal, to two deflate compressed SDSs, the first one
+        with sparse writes on.  Only the diagonal chunks of the first SDS
+        end up in the file, which is checked by counting the chunks with
+        Hnumber().  Both SDSs read back the same, and reading the chunks
+        that were never written does not page them into the chunk cache,
+        which is checked with SDgetchunkcachestats().
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+static int
+test_chunk_sparse(void)
+{
+    int32             fchk, sds_id, fid;
+    int32             dims[2]  = {SPA_DIM, SPA_DIM};
+    int32             start[2] = {0, 0};
+    int32             fill     = SPA_FILL;
+    HDF_CHUNK_DEF     chunk_def;
+    hdf_cache_stats_t cstats;
+    static int32      data[SPA_DIM][SPA_DIM];
+    static int32      outdata[SPA_DIM][SPA_DIM];
+    int32             nchunks;
+    intn              status;
+    intn              i, j, k;
+    int               num_errs = 0;
+
+    for (i = 0; i < SPA_DIM; i++)
+        for (j = 0; j < SPA_DIM; j++)
+            data[i][j] = (i / SPA_CHUNK == j / SPA_CHUNK) ? i * 100 + j : SPA_FILL;
+
+    fchk = SDstart(CSPAFILE, DFACC_CREATE);
+    CHECK(fchk, FAIL, "test_chunk_sparse: SDstart");
+
+    for (k = 0; k < 2; k++) {
+        sds_id = SDcreate(fchk, k == 0 ? "Sparse" : "Dense", DFNT_INT32, 2, dims);
+        CHECK(sds_id, FAIL, "test_chunk_sparse: SDcreate");
+
+        status = SDsetfillvalue(sds_id, &fill);
+        CHECK(status, FAIL, "test_chunk_sparse: SDsetfillvalue");
+
+        memset(&chunk_def, 0, sizeof(chunk_def));
+        chunk_def.comp.chunk_lengths[0]    = SPA_CHUNK;
+        chunk_def.comp.chunk_lengths[1]    = SPA_CHUNK;
+        chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+        chunk_def.comp.cinfo.deflate.level = 6;
+        status                             = SDsetchunk(sds_id, chunk_def, HDF_CHUNK | HDF_COMP);
+        CHECK(status, FAIL, "test_chunk_sparse: SDsetchunk");
+
+        if (k == 0) {
+            status = SDsetchunksparse(sds_id, TRUE);
+            VERIFY(status, FALSE, "test_chunk_sparse: SDsetchunksparse");
+            status = SDsetchunksparse(sds_id, TRUE);
+            VERIFY(status, TRUE, "test_chunk_sparse: SDsetchunksparse");
+        }
+
+        status = SDwritedata(sds_id, start, NULL, dims, (void *)data);
+        CHECK(status, FAIL, "test_chunk_sparse: SDwritedata");
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "test_chunk_sparse: SDendaccess");
+    }
+
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_sparse: SDend");
+
+    /* the diagonal chunks of the first SDS and all chunks of the second */
+    fid = Hopen(CSPAFILE, DFACC_READ, 0);
+    CHECK(fid, FAIL, "test_chunk_sparse: Hopen");
+    nchunks = Hnumber(fid, DFTAG_CHUNK);
+    VERIFY(nchunks, SPA_NCHUNK + SPA_NCHUNK * SPA_NCHUNK, "test_chunk_sparse: Hnumber");
+    status = Hclose(fid);
+    CHECK(status, FAIL, "test_chunk_sparse: Hclose");
+
+    fchk = SDstart(CSPAFILE, DFACC_READ);
+    CHECK(fchk, FAIL, "test_chunk_sparse: SDstart");
+
+    for (k = 0; k < 2; k++) {
+        sds_id = SDselect(fchk, k);
+        CHECK(sds_id, FAIL, "test_chunk_sparse: SDselect");
+
+        memset(outdata, 0, sizeof(outdata));
+        status = SDreaddata(sds_id, start, NULL, dims, (void *)outdata);
+        CHECK(status, FAIL, "test_chunk_sparse: SDreaddata");
+        if (memcmp(outdata, data, sizeof(data)) != 0) {
+            fprintf(stderr, "test_chunk_sparse: wrong data read from SDS %d\n", k);
+            num_errs++;
+        }
+
+        /* only the chunks in the file went through the cache */
+        status = SDgetchunkcachestats(sds_id, &cstats);
+        CHECK(status, FAIL, "test_chunk_sparse: SDgetchunkcachestats");
+        nchunks = (k == 0) ? SPA_NCHUNK : SPA_NCHUNK * SPA_NCHUNK;
+        VERIFY(cstats.misses, nchunks, "test_chunk_sparse: SDgetchunkcachestats");
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "test_chunk_sparse: SDendaccess");
+    }
+
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_sparse: SDend");
+
+    return num_errs;
+} /* test_chunk_sparse() */
+
+/********************************************************************
+   Name: test_chunk_map() - tests SDgetchunkmap and the sizes of an
+                open chunked SDS
+
+   Description:
+        Uses the file made by test_chunk_sparse().  The map of the
+        sparse SDS has the bits of the diagonal chunks set only, and
+        SDgetdatasize returns the same sizes whether the chunk table
+        is read from the file or, once the SDS is open, from memory.
+        A new chunked SDS is empty until one chunk is written, and its
+        sizes follow the writes while it is open.
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+static int
+test_chunk_map(void)
+{
+    int32         fchk, sds_id;
+    int32         dims[2]   = {SPA_DIM, SPA_DIM};
+    int32         origin[2] = {1, 2};
+    int32         comp_size, orig_size, comp_size2, orig_size2;
+    int32         nchunks, nwritten;
+    int32         expected;
+    HDF_CHUNK_DEF chunk_def;
+    uint8         map[(SPA_NCHUNK * SPA_NCHUNK + 7) / 8];
+    static int32  chunk[SPA_CHUNK][SPA_CHUNK];
+    intn          empty;
+    intn          status;
+    intn          i, j;
+    int           num_errs = 0;
+
+    fchk = SDstart(CSPAFILE, DFACC_RDWR);
+    CHECK(fchk, FAIL, "test_chunk_map: SDstart");
+
+    sds_id = SDselect(fchk, 0);
+    CHECK(sds_id, FAIL, "test_chunk_map: SDselect");
+
+    /* sizes from the chunk table in the file */
+    status = SDgetdatasize(sds_id, &comp_size, &orig_size);
+    CHECK(status, FAIL, "test_chunk_map: SDgetdatasize");
+    VERIFY(orig_size, SPA_NCHUNK * SPA_CHUNK * SPA_CHUNK * (int32)sizeof(int32),
+           "test_chunk_map: SDgetdatasize");
+
+    nwritten = SDgetchunkmap(sds_id, NULL, &nchunks);
+    VERIFY(nwritten, SPA_NCHUNK, "test_chunk_map: SDgetchunkmap");
+    VERIFY(nchunks, SPA_NCHUNK * SPA_NCHUNK, "test_chunk_map: SDgetchunkmap");
+
+    memset(map, 0xff, sizeof(map));
+    nwritten = SDgetchunkmap(sds_id, map, NULL);
+    VERIFY(nwritten, SPA_NCHUNK, "test_chunk_map: SDgetchunkmap");
+    for (i = 0; i < SPA_NCHUNK * SPA_NCHUNK; i++) {
+        intn bit = (map[i / 8] >> (i % 8)) & 1;
+
+        expected = (i / SPA_NCHUNK == i % SPA_NCHUNK);
+        VERIFY(bit, expected, "test_chunk_map: SDgetchunkmap");
+    }
+
+    /* the same sizes from the chunk table in memory */
+    status = SDgetdatasize(sds_id, &comp_size2, &orig_size2);
+    CHECK(status, FAIL, "test_chunk_map: SDgetdatasize");
+    VERIFY(comp_size2, comp_size, "test_chunk_map: SDgetdatasize");
+    VERIFY(orig_size2, orig_size, "test_chunk_map: SDgetdatasize");
+
+    status = SDcheckempty(sds_id, &empty);
+    CHECK(status, FAIL, "test_chunk_map: SDcheckempty");
+    VERIFY(empty, FALSE, "test_chunk_map: SDcheckempty");
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_chunk_map: SDendaccess");
+
+    /* a new SDS, empty until a chunk is written */
+    sds_id = SDcreate(fchk, "Mapped", DFNT_INT32, 2, dims);
+    CHECK(sds_id, FAIL, "test_chunk_map: SDcreate");
+
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]    = SPA_CHUNK;
+    chunk_def.comp.chunk_lengths[1]    = SPA_CHUNK;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 6;
+    status                             = SDsetchunk(sds_id, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "test_chunk_map: SDsetchunk");
+
+    nwritten = SDgetchunkmap(sds_id, map, &nchunks);
+    VERIFY(nwritten, 0, "test_chunk_map: SDgetchunkmap");
+    VERIFY(nchunks, SPA_NCHUNK * SPA_NCHUNK, "test_chunk_map: SDgetchunkmap");
+
+    status = SDcheckempty(sds_id, &empty);
+    CHECK(status, FAIL, "test_chunk_map: SDcheckempty");
+    VERIFY(empty, TRUE, "test_chunk_map: SDcheckempty");
+
+    for (i = 0; i < SPA_CHUNK; i++)
+        for (j = 0; j < SPA_CHUNK; j++)
+            chunk[i][j] = i * j;
+    status = SDwritechunk(sds_id, origin, (void *)chunk);
+    CHECK(status, FAIL, "test_chunk_map: SDwritechunk");
+
+    /* chunk (1, 2) is chunk number 1 * SPA_NCHUNK + 2 */
+    nwritten = SDgetchunkmap(sds_id, map, NULL);
+    VERIFY(nwritten, 1, "test_chunk_map: SDgetchunkmap");
+    expected = 1 << ((SPA_NCHUNK + 2) % 8);
+    VERIFY(map[(SPA_NCHUNK + 2) / 8], expected, "test_chunk_map: SDgetchunkmap");
+
+    status = SDcheckempty(sds_id, &empty);
+    CHECK(status, FAIL, "test_chunk_map: SDcheckempty");
+    VERIFY(empty, FALSE, "test_chunk_map: SDcheckempty");
+
+    status = SDgetdatasize(sds_id, &comp_size, &orig_size);
+    CHECK(status, FAIL, "test_chunk_map: SDgetdatasize");
+    VERIFY(orig_size, SPA_CHUNK * SPA_CHUNK * (int32)sizeof(int32), "test_chunk_map: SDgetdatasize");
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_chunk_map: SDendaccess");
+
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_map: SDend");
+
+    /* and the same sizes once the file is closed */
+    fchk = SDstart(CSPAFILE, DFACC_READ);
+    CHECK(fchk, FAIL, "test_chunk_map: SDstart");
+
+    sds_id = SDselect(fchk, 2);
+    CHECK(sds_id, FAIL, "test_chunk_map: SDselect");
+
+    status = SDgetdatasize(sds_id, &comp_size2, &orig_size2);
+    CHECK(status, FAIL, "test_chunk_map: SDgetdatasize");
+    VERIFY(comp_size2, comp_size, "test_chunk_map: SDgetdatasize");
+    VERIFY(orig_size2, orig_size, "test_chunk_map: SDgetdatasize");
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_chunk_map: SDendaccess");
+
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_map: SDend");
+
+    return num_errs;
+} /* test_chunk_map() */
+
+/* Calls of rle_provider() and chunks it decoded */
+static int32 provider_calls;
+static int32 provider_decoded;
+
+/* Decode provider for RLE chunks that leaves every other chunk to the library */
+static intn
+rle_provider(comp_coder_t coder_type, const comp_info *c_info, int32 n, const uint8 *const *raw,
+             const int32 *raw_len, uint8 *const *data, int32 data_len, intn *status, void *user_data)
+{
+    int32 i, len;
+
+    (void)c_info;
+    if (coder_type != COMP_CODE_RLE || user_data != &provider_calls)
+        return FAIL;
+
+    provider_calls++;
+    for (i = 0; i < n; i += 2) {
+        const uint8 *src = raw[i], *src_end = raw[i] + raw_len[i];
+        uint8       *dst = data[i], *dst_end = data[i] + data_len;
+
+        while (src < src_end && dst < dst_end) {
+            if (*src & 0x80) { /* run of 3 or more */
+                len = (*src & 0x7f) + 3;
+                if (len > dst_end - dst || src + 1 >= src_end)
+                    break;
+                memset(dst, src[1], (size_t)len);
+                src += 2;
+            }
+            else { /* mix of 1 or more */
+                len = (*src & 0x7f) + 1;
+                if (len > dst_end - dst || len > src_end - (src + 1))
+                    break;
+                memcpy(dst, src + 1, (size_t)len);
+                src += len + 1;
+            }
+            dst += len;
+        }
+        if (dst == dst_end) {
+            status[i] = SUCCEED;
+            provider_decoded++;
+        }
+    }
+    return SUCCEED;
+} /* rle_provider() */
+
+/********************************************************************
+   Name: test_chunk_provider() - tests decoding chunks with a decode
+                provider
+
+   Description:
+        Registers a decode provider for RLE with HCset_decode_provider()
+        and reads back an RLE compressed chunked SDS, whole and as a
+        hyperslab.  The provider decodes half the chunks it is given;
+        the library decodes the others.
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+static int
+test_chunk_provider(void)
+{
+    int32         fchk, sds_id;
+    int32         dims[2]  = {THR_DIM0, THR_DIM1};
+    int32         start[2] = {0, 0};
+    int32         edges[2] = {THR_DIM0, THR_DIM1};
+    HDF_CHUNK_DEF chunk_def;
+    static int32  data[THR_DIM0][THR_DIM1];
+    static int32  outdata[THR_DIM0][THR_DIM1];
+    intn          status;
+    intn          i, j;
+    int           num_errs = 0;
+
+    for (i = 0; i < THR_DIM0; i++)
+        for (j = 0; j < THR_DIM1; j++)
+            data[i][j] = (i / 4) * 100 + j;
+
+    /* Create the RLE compressed chunked SDS */
+    fchk = SDstart(CPROFILE, DFACC_CREATE);
+    CHECK(fchk, FAIL, "test_chunk_provider: SDstart");
+
+    sds_id = SDcreate(fchk, "Provided", DFNT_INT32, 2, dims);
+    CHECK(sds_id, FAIL, "test_chunk_provider: SDcreate");
+
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0] = THR_CHUNK0;
+    chunk_def.comp.chunk_lengths[1] = THR_CHUNK1;
+    chunk_def.comp.comp_type        = COMP_CODE_RLE;
+
+    status = SDsetchunk(sds_id, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "test_chunk_provider: SDsetchunk");
+
+    status = SDwritedata(sds_id, start, NULL, edges, (void *)data);
+    CHECK(status, FAIL, "test_chunk_provider: SDwritedata");
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_chunk_provider: SDendaccess");
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_provider: SDend");
+
+    status = HCset_decode_provider(COMP_CODE_NONE, rle_provider, NULL);
+    VERIFY(status, FAIL, "test_chunk_provider: HCset_decode_provider");
+    status = HCset_decode_provider(COMP_CODE_RLE, rle_provider, &provider_calls);
+    CHECK(status, FAIL, "test_chunk_provider: HCset_decode_provider");
+    provider_calls = provider_decoded = 0;
+
+    /* Read it back with the provider */
+    fchk = SDstart(CPROFILE, DFACC_READ);
+    CHECK(fchk, FAIL, "test_chunk_provider: SDstart");
+
+    sds_id = SDselect(fchk, 0);
+    CHECK(sds_id, FAIL, "test_chunk_provider: SDselect");
+
+    memset(outdata, 0, sizeof(outdata));
+    status = SDreaddata(sds_id, start, NULL, edges, (void *)outdata);
+    CHECK(status, FAIL, "test_chunk_provider: SDreaddata");
+    if (memcmp(outdata, data, sizeof(data)) != 0) {
+        fprintf(stderr, "test_chunk_provider: wrong data in whole read\n");
+        num_errs++;
+    }
+    if (provider_calls == 0 || provider_decoded == 0) {
+        fprintf(stderr, "test_chunk_provider: the decode provider was not used\n");
+        num_errs++;
+    }
+
+    /* Hyperslab crossing partial chunks, with a single-chunk cache */
+    status = SDsetchunkcache(sds_id, 1, 0);
+    CHECK(status, FAIL, "test_chunk_provider: SDsetchunkcache");
+
+    start[0] = 7;
+    start[1] = 13;
+    edges[0] = 91;
+    edges[1] = 111;
+    memset(outdata, 0, sizeof(outdata));
+    status = SDreaddata(sds_id, start, NULL, edges, (void *)outdata);
+    CHECK(status, FAIL, "test_chunk_provider: SDreaddata");
+    for (i = 0; i < edges[0]; i++)
+        for (j = 0; j < edges[1]; j++)
+            if (((int32 *)outdata)[i * edges[1] + j] != data[start[0] + i][start[1] + j]) {
+                fprintf(stderr, "test_chunk_provider: slab read, wrong value at [%d][%d]\n", i, j);
+                num_errs++;
+                i = edges[0];
+                break;
+            }
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_chunk_provider: SDendaccess");
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_provider: SDend");
+
+    status = HCset_decode_provider(COMP_CODE_RLE, NULL, NULL);
+    CHECK(status, FAIL, "test_chunk_provider: HCset_decode_provider");
+
+    return num_errs;
+} /* test_chunk_provider() */
+
+/********************************************************************
+   Name: test_chunk_slab() - tests splitting data sets among readers
+
+   Description:
+        Checks the slabs SDgetchunkslab() returns for a chunked SDS whose
+        last row of chunks is partial, split into fewer and into more
+        parts than it has rows of chunks, and for a contiguous SDS, whose
+        slabs are made of rows.
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+static int
+test_chunk_slab(void)
+{
+    int32         fchk, sds_id, sds2_id;
+    int32         dims[2] = {110, 30};
+    int32         start[2], edges[2];
+    HDF_CHUNK_DEF chunk_def;
+    intn          status;
+    int32         k;
+    int           num_errs = 0;
+
+    /* slabs of 4 parts of 6 rows of chunks of 20, the last one of 10 */
+    static const int32 chk_start[4] = {0, 20, 60, 80};
+    static const int32 chk_edges[4] = {20, 40, 20, 30};
+
+    /* slabs of 3 parts of 110 rows */
+    static const int32 row_start[3] = {0, 36, 73};
+    static const int32 row_edges[3] = {36, 37, 37};
+
+    fchk = SDstart(CSLBFILE, DFACC_CREATE);
+    CHECK(fchk, FAIL, "test_chunk_slab: SDstart");
+
+    sds_id = SDcreate(fchk, "Chunked", DFNT_INT32, 2, dims);
+    CHECK(sds_id, FAIL, "test_chunk_slab: SDcreate");
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.chunk_lengths[0] = 20;
+    chunk_def.chunk_lengths[1] = 15;
+    status                     = SDsetchunk(sds_id, chunk_def, HDF_CHUNK);
+    CHECK(status, FAIL, "test_chunk_slab: SDsetchunk");
+
+    sds2_id = SDcreate(fchk, "Contiguous", DFNT_INT32, 2, dims);
+    CHECK(sds2_id, FAIL, "test_chunk_slab: SDcreate");
+
+    for (k = 0; k < 4; k++) {
+        status = SDgetchunkslab(sds_id, 4, k, start, edges);
+        CHECK(status, FAIL, "test_chunk_slab: SDgetchunkslab");
+        VERIFY(start[0], chk_start[k], "test_chunk_slab: SDgetchunkslab");
+        VERIFY(edges[0], chk_edges[k], "test_chunk_slab: SDgetchunkslab");
+        VERIFY(start[1], 0, "test_chunk_slab: SDgetchunkslab");
+        VERIFY(edges[1], dims[1], "test_chunk_slab: SDgetchunkslab");
+    }
+
+    /* More parts than rows of chunks: every chunk in one part, some empty */
+    for (k = 0, edges[1] = 0; k < 8; k++) {
+        int32 total = edges[1];
+
+        status = SDgetchunkslab(sds_id, 8, k, start, edges);
+        CHECK(status, FAIL, "test_chunk_slab: SDgetchunkslab");
+        if (start[0] % 20 != 0 || start[0] != MIN(total, dims[0])) {
+            fprintf(stderr, "test_chunk_slab: part %d of 8 starts at %d\n", (int)k, (int)start[0]);
+            num_errs++;
+        }
+        edges[1] = start[0] + edges[0];
+    }
+    VERIFY(edges[1], dims[0], "test_chunk_slab: SDgetchunkslab");
+
+    for (k = 0; k < 3; k++) {
+        status = SDgetchunkslab(sds2_id, 3, k, start, edges);
+        CHECK(status, FAIL, "test_chunk_slab: SDgetchunkslab");
+        VERIFY(start[0], row_start[k], "test_chunk_slab: SDgetchunkslab");
+        VERIFY(edges[0], row_edges[k], "test_chunk_slab: SDgetchunkslab");
+    }
+
+    status = SDgetchunkslab(sds_id, 4, 4, start, edges);
+    VERIFY(status, FAIL, "test_chunk_slab: SDgetchunkslab");
+    status = SDgetchunkslab(sds_id, 0, 0, start, edges);
+    VERIFY(status, FAIL, "test_chunk_slab: SDgetchunkslab");
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_chunk_slab: SDendaccess");
+    status = SDendaccess(sds2_id);
+    CHECK(status, FAIL, "test_chunk_slab: SDendaccess");
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_slab: SDend");
+
+    return num_errs;
+} /* test_chunk_slab() */
+
+/********************************************************************
+   Name: test_chunk_view() - tests chunks held in the chunk cache
+
+   Description:
+        Writes all chunks but one of a chunked SDS, last one first,
+        through a cache of one chunk, so that they are stored in that
+        order.  SDchunkiter() must visit them in the order written, and
+        the chunks SDgetchunkptr() returns must hold the data and stay
+        valid while more chunks are held than the cache has room for
+        and the SDS is read otherwise.  This is done for a number type
+        that is converted and one that is not on little-endian platforms.
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+static int
+test_chunk_view(void)
+{
+    int32         fchk, sds_id;
+    int32         dims[2]  = {VW_DIM0, VW_DIM1};
+    int32         start[2] = {0, 0};
+    int32         origin[2], lengths[2];
+    int32         cursor, nvisited;
+    int32         chunk[VW_CHUNK0 * VW_CHUNK1];
+    int32         data[VW_DIM0][VW_DIM1];
+    const int32  *views[VW_NCHUNK];
+    int32         view_chunk[VW_NCHUNK];
+    HDF_CHUNK_DEF chunk_def;
+    intn          status;
+    int32         i, j, k, n, t;
+    int           num_errs = 0;
+
+    static const int32 types[2] = {DFNT_INT32, DFNT_LINT32};
+
+    for (i = 0; i < VW_DIM0; i++)
+        for (j = 0; j < VW_DIM1; j++)
+            data[i][j] = i * 100 + j;
+
+    for (t = 0; t < 2; t++) {
+        fchk = SDstart(CVWFILE, DFACC_CREATE);
+        CHECK(fchk, FAIL, "test_chunk_view: SDstart");
+
+        sds_id = SDcreate(fchk, "View", types[t], 2, dims);
+        CHECK(sds_id, FAIL, "test_chunk_view: SDcreate");
+        memset(&chunk_def, 0, sizeof(chunk_def));
+        chunk_def.chunk_lengths[0] = VW_CHUNK0;
+        chunk_def.chunk_lengths[1] = VW_CHUNK1;
+        status                     = SDsetchunk(sds_id, chunk_def, HDF_CHUNK);
+        CHECK(status, FAIL, "test_chunk_view: SDsetchunk");
+        status = SDsetchunkcache(sds_id, 1, 0);
+        CHECK(status, FAIL, "test_chunk_view: SDsetchunkcache");
+
+        /* chunk 0 is left unwritten */
+        for (n = VW_NCHUNK - 1; n > 0; n--) {
+            origin[0] = n / 3;
+            origin[1] = n % 3;
+            for (i = 0; i < VW_CHUNK0; i++)
+                for (j = 0; j < VW_CHUNK1; j++)
+                    chunk[i * VW_CHUNK1 + j] = origin[1] * VW_CHUNK1 + j < VW_DIM1
+                                                   ? data[origin[0] * VW_CHUNK0 + i][origin[1] * VW_CHUNK1 + j]
+                                                   : 0;
+            status = SDwritechunk(sds_id, origin, (void *)chunk);
+            CHECK(status, FAIL, "test_chunk_view: SDwritechunk");
+        }
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "test_chunk_view: SDendaccess");
+        status = SDend(fchk);
+        CHECK(status, FAIL, "test_chunk_view: SDend");
+
+        fchk = SDstart(CVWFILE, DFACC_READ);
+        CHECK(fchk, FAIL, "test_chunk_view: SDstart");
+        sds_id = SDselect(fchk, 0);
+        CHECK(sds_id, FAIL, "test_chunk_view: SDselect");
+        status = SDsetchunkcache(sds_id, 2, 0);
+        CHECK(status, FAIL, "test_chunk_view: SDsetchunkcache");
+
+        /* visit the chunks in storage order and hold them all */
+        for (cursor = 0, nvisited = 0; (status = SDchunkiter(sds_id, &cursor, origin)) == 1; nvisited++) {
+            n = origin[0] * 3 + origin[1];
+            if (nvisited >= VW_NCHUNK - 1 || n != VW_NCHUNK - 1 - nvisited) {
+                fprintf(stderr, "test_chunk_view: chunk %d visited as #%d\n", (int)n, (int)nvisited);
+                num_errs++;
+                break;
+            }
+            status = SDgetchunkptr(sds_id, origin, (const void **)&views[nvisited], lengths);
+            CHECK(status, FAIL, "test_chunk_view: SDgetchunkptr");
+            VERIFY(lengths[0], VW_CHUNK0, "test_chunk_view: SDgetchunkptr");
+            VERIFY(lengths[1], VW_CHUNK1, "test_chunk_view: SDgetchunkptr");
+            view_chunk[nvisited] = n;
+        }
+        VERIFY(status, 0, "test_chunk_view: SDchunkiter");
+        VERIFY(nvisited, VW_NCHUNK - 1, "test_chunk_view: SDchunkiter");
+
+        /* read the SDS otherwise in between */
+        origin[0] = origin[1] = 0;
+        status                = SDreadchunk(sds_id, origin, (void *)chunk);
+        CHECK(status, FAIL, "test_chunk_view: SDreadchunk");
+        status = SDreaddata(sds_id, start, NULL, dims, (void *)data);
+        CHECK(status, FAIL, "test_chunk_view: SDreaddata");
+
+        for (k = 0; k < nvisited; k++) {
+            origin[0] = view_chunk[k] / 3;
+            origin[1] = view_chunk[k] % 3;
+            for (i = 0; i < VW_CHUNK0; i++)
+                for (j = 0; j < VW_CHUNK1 && origin[1] * VW_CHUNK1 + j < VW_DIM1; j++)
+                    if (views[k][i * VW_CHUNK1 + j] != data[origin[0] * VW_CHUNK0 + i][origin[1] * VW_CHUNK1 + j]) {
+                        fprintf(stderr, "test_chunk_view: wrong value in chunk %d\n", (int)view_chunk[k]);
+                        num_errs++;
+                        i = VW_CHUNK0;
+                        break;
+                    }
+        }
+
+        /* the last chunk is given back by SDendaccess() */
+        for (k = 0; k < nvisited - 1; k++) {
+            status = SDreleasechunk(sds_id, views[k]);
+            CHECK(status, FAIL, "test_chunk_view: SDreleasechunk");
+        }
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "test_chunk_view: SDendaccess");
+        status = SDend(fchk);
+        CHECK(status, FAIL, "test_chunk_view: SDend");
+    }
+
+    return num_errs;
+} /* test_chunk_view() */
+
+/********************************************************************
+   Name: test_chunk_stats() - tests the statistics of the chunks
+
+   Description:
+        Writes the first three rows of chunks of a compressed chunked
+        float32 SDS that keeps statistics of its chunks, one chunk
+        holding only fill values, and checks which chunks SDquerychunks()
+        finds for ranges of values and the statistics of some chunks,
+        before and after the file is opened again, and after a value is
+        changed.  An SDS without statistics cannot be queried.
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+static int
+test_chunk_stats(void)
+{
+    int32          fchk, sds_id, sds2_id;
+    int32          dims[2]  = {ST_DIM, ST_DIM};
+    int32          start[2] = {0, 0};
+    int32          edges[2] = {3 * ST_CHUNK, ST_DIM};
+    int32          origins[ST_NCHUNK * ST_NCHUNK][2];
+    int32          origin[2], count, nfound;
+    float64        min, max;
+    float32        fill = ST_FILL, value;
+    static float32 data[ST_DIM][ST_DIM];
+    HDF_CHUNK_DEF  chunk_def;
+    intn           status;
+    int32          i, j;
+    int            num_errs = 0;
+
+    for (i = 0; i < ST_DIM; i++)
+        for (j = 0; j < ST_DIM; j++)
+            data[i][j] = (i < ST_CHUNK && j >= ST_CHUNK && j < 2 * ST_CHUNK) ? ST_FILL : (float32)(i * ST_DIM + j);
+
+    fchk = SDstart(CSTFILE, DFACC_CREATE);
+    CHECK(fchk, FAIL, "test_chunk_stats: SDstart");
+
+    sds_id = SDcreate(fchk, "Stats", DFNT_FLOAT32, 2, dims);
+    CHECK(sds_id, FAIL, "test_chunk_stats: SDcreate");
+    status = SDsetfillvalue(sds_id, (void *)&fill);
+    CHECK(status, FAIL, "test_chunk_stats: SDsetfillvalue");
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]    = ST_CHUNK;
+    chunk_def.comp.chunk_lengths[1]    = ST_CHUNK;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 1;
+    status                             = SDsetchunk(sds_id, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "test_chunk_stats: SDsetchunk");
+    status = SDsetchunkstats(sds_id);
+    CHECK(status, FAIL, "test_chunk_stats: SDsetchunkstats");
+
+    sds2_id = SDcreate(fchk, "NoStats", DFNT_FLOAT32, 2, dims);
+    CHECK(sds2_id, FAIL, "test_chunk_stats: SDcreate");
+    status = SDsetchunk(sds2_id, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "test_chunk_stats: SDsetchunk");
+
+    status = SDwritedata(sds_id, start, NULL, edges, (void *)data);
+    CHECK(status, FAIL, "test_chunk_stats: SDwritedata");
+    status = SDwritedata(sds2_id, start, NULL, edges, (void *)data);
+    CHECK(status, FAIL, "test_chunk_stats: SDwritedata");
+
+    /* only the third row of chunks holds values of 1000 and more */
+    nfound = SDquerychunks(sds_id, 1000.0, 1.0e9, ST_NCHUNK * ST_NCHUNK, &origins[0][0]);
+    VERIFY(nfound, ST_NCHUNK, "test_chunk_stats: SDquerychunks");
+    for (i = 0; i < nfound && i < ST_NCHUNK; i++)
+        if (origins[i][0] != 2 || origins[i][1] != i) {
+            fprintf(stderr, "test_chunk_stats: chunk [%d,%d] found as #%d\n", (int)origins[i][0],
+                    (int)origins[i][1], (int)i);
+            num_errs++;
+        }
+    nfound = SDquerychunks(sds2_id, 1000.0, 1.0e9, 0, NULL);
+    VERIFY(nfound, FAIL, "test_chunk_stats: SDquerychunks");
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_chunk_stats: SDendaccess");
+    status = SDendaccess(sds2_id);
+    CHECK(status, FAIL, "test_chunk_stats: SDendaccess");
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_stats: SDend");
+
+    /* the statistics are kept in the file and updated on writes */
+    fchk = SDstart(CSTFILE, DFACC_WRITE);
+    CHECK(fchk, FAIL, "test_chunk_stats: SDstart");
+    sds_id = SDselect(fchk, 0);
+    CHECK(sds_id, FAIL, "test_chunk_stats: SDselect");
+
+    origin[0] = 1;
+    origin[1] = 2;
+    status    = SDgetchunkstats(sds_id, origin, &min, &max, &count);
+    CHECK(status, FAIL, "test_chunk_stats: SDgetchunkstats");
+    VERIFY(count, ST_CHUNK * ST_CHUNK, "test_chunk_stats: SDgetchunkstats");
+    VERIFY(min, (float64)(ST_CHUNK * ST_DIM + 2 * ST_CHUNK), "test_chunk_stats: SDgetchunkstats");
+    VERIFY(max, (float64)((2 * ST_CHUNK - 1) * ST_DIM + 3 * ST_CHUNK - 1), "test_chunk_stats: SDgetchunkstats");
+    origin[0] = 0;
+    origin[1] = 1;
+    status    = SDgetchunkstats(sds_id, origin, &min, &max, &count);
+    CHECK(status, FAIL, "test_chunk_stats: SDgetchunkstats");
+    VERIFY(count, 0, "test_chunk_stats: SDgetchunkstats");
+    origin[0] = 3;
+    status    = SDgetchunkstats(sds_id, origin, &min, &max, &count);
+    CHECK(status, FAIL, "test_chunk_stats: SDgetchunkstats");
+    VERIFY(count, 0, "test_chunk_stats: SDgetchunkstats");
+
+    start[0] = start[1] = 5;
+    edges[0] = edges[1] = 1;
+    value               = 5000.0;
+    status              = SDwritedata(sds_id, start, NULL, edges, (void *)&value);
+    CHECK(status, FAIL, "test_chunk_stats: SDwritedata");
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_chunk_stats: SDendaccess");
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_stats: SDend");
+
+    fchk = SDstart(CSTFILE, DFACC_READ);
+    CHECK(fchk, FAIL, "test_chunk_stats: SDstart");
+    sds_id = SDselect(fchk, 0);
+    CHECK(sds_id, FAIL, "test_chunk_stats: SDselect");
+
+    status = SDsetchunkstats(sds_id);
+    VERIFY(status, FAIL, "test_chunk_stats: SDsetchunkstats");
+    nfound = SDquerychunks(sds_id, 1000.0, 2000.0, 0, NULL);
+    VERIFY(nfound, ST_NCHUNK + 1, "test_chunk_stats: SDquerychunks");
+    nfound = SDquerychunks(sds_id, 4000.0, 6000.0, 1, &origins[0][0]);
+    VERIFY(nfound, 1, "test_chunk_stats: SDquerychunks");
+    VERIFY(origins[0][0], 0, "test_chunk_stats: SDquerychunks");
+    VERIFY(origins[0][1], 0, "test_chunk_stats: SDquerychunks");
+    nfound = SDquerychunks(sds_id, ST_FILL, ST_FILL, 0, NULL);
+    VERIFY(nfound, 0, "test_chunk_stats: SDquerychunks");
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_chunk_stats: SDendaccess");
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_stats: SDend");
+
+    return num_errs;
+} /* test_chunk_stats() */
+
+/* Counts the different offsets of the data of the chunks of an SDS */
+static int32
+count_chunk_offsets(int32 sds_id)
+{
+    int32 offsets[DUP_NCHUNK * DUP_NCHUNK];
+    int32 coord[2], offset, length;
+    int32 noffsets = 0;
+    intn  i, j, k;
+
+    for (i = 0; i < DUP_NCHUNK; i++)
+        for (j = 0; j < DUP_NCHUNK; j++) {
+            coord[0] = i;
+            coord[1] = j;
+            if (SDgetdatainfo(sds_id, coord, 0, 1, &offset, &length) != 1)
+                return FAIL;
+            k = 0;
+            while (k < noffsets && offsets[k] != offset)
+                k++;
+            if (k == noffsets)
+                offsets[noffsets++] = offset;
+        }
+
+    return noffsets;
+} /* count_chunk_offsets() */
+
+/********************************************************************
+   Name: test_chunk_dedup() - tests that identical chunks share their
+                data
+
+   Description:
+        Writes a deflate compressed SDS with deduplication on whose
+        chunks are of two kinds, and checks with SDgetdatainfo() that
+        the file holds the data of two chunks only.  The stored chunks
+        are then copied to a second SDS with SDreadchunkraw() and
+        SDwritechunkraw(), which shares them the same way, and a chunk
+        of the first SDS is written again, which leaves the chunks that
+        shared its data as they were.
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+static int
+test_chunk_dedup(void)
+{
+    int32         fchk, sds_id, sds2_id;
+    int32         dims[2]  = {DUP_DIM, DUP_DIM};
+    int32         start[2] = {0, 0};
+    int32         origin[2];
+    HDF_CHUNK_DEF chunk_def;
+    static int32  data[DUP_DIM][DUP_DIM];
+    static int32  outdata[DUP_DIM][DUP_DIM];
+    static int32  chunk[DUP_CHUNK][DUP_CHUNK];
+    static uint8  raw[DUP_CHUNK * DUP_CHUNK * sizeof(int32) * 2];
+    int32         raw_len, noffsets;
+    intn          status;
+    intn          i, j;
+    int           num_errs = 0;
+
+    /* the chunks on the even and on the odd diagonals are the same */
+    for (i = 0; i < DUP_DIM; i++)
+        for (j = 0; j < DUP_DIM; j++)
+            data[i][j] =
+                ((i / DUP_CHUNK + j / DUP_CHUNK) % 2) * 10000 + (i % DUP_CHUNK) * 100 + j % DUP_CHUNK;
+
+    fchk = SDstart(CDUPFILE, DFACC_CREATE);
+    CHECK(fchk, FAIL, "test_chunk_dedup: SDstart");
+
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]    = DUP_CHUNK;
+    chunk_def.comp.chunk_lengths[1]    = DUP_CHUNK;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 6;
+
+    for (i = 0; i < 2; i++) {
+        sds_id = SDcreate(fchk, i == 0 ? "Dedup" : "Copy", DFNT_INT32, 2, dims);
+        CHECK(sds_id, FAIL, "test_chunk_dedup: SDcreate");
+        status = SDsetchunk(sds_id, chunk_def, HDF_CHUNK | HDF_COMP);
+        CHECK(status, FAIL, "test_chunk_dedup: SDsetchunk");
+        status = SDsetchunkdedup(sds_id, TRUE);
+        VERIFY(status, FALSE, "test_chunk_dedup: SDsetchunkdedup");
+        status = SDsetchunkdedup(sds_id, TRUE);
+        VERIFY(status, TRUE, "test_chunk_dedup: SDsetchunkdedup");
+        if (i == 0) {
+            status = SDwritedata(sds_id, start, NULL, dims, (void *)data);
+            CHECK(status, FAIL, "test_chunk_dedup: SDwritedata");
+        }
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "test_chunk_dedup: SDendaccess");
+    }
+
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_dedup: SDend");
+
+    /* copy the stored chunks, then write a chunk of the first SDS again */
+    fchk = SDstart(CDUPFILE, DFACC_WRITE);
+    CHECK(fchk, FAIL, "test_chunk_dedup: SDstart");
+    sds_id = SDselect(fchk, 0);
+    CHECK(sds_id, FAIL, "test_chunk_dedup: SDselect");
+    sds2_id = SDselect(fchk, 1);
+    CHECK(sds2_id, FAIL, "test_chunk_dedup: SDselect");
+
+    noffsets = count_chunk_offsets(sds_id);
+    VERIFY(noffsets, 2, "test_chunk_dedup: SDgetdatainfo");
+
+    status = SDsetchunkdedup(sds2_id, TRUE);
+    VERIFY(status, FALSE, "test_chunk_dedup: SDsetchunkdedup");
+    for (i = 0; i < DUP_NCHUNK; i++)
+        for (j = 0; j < DUP_NCHUNK; j++) {
+            origin[0] = i;
+            origin[1] = j;
+            raw_len   = SDreadchunkraw(sds_id, origin, raw, (int32)sizeof(raw));
+            CHECK(raw_len, FAIL, "test_chunk_dedup: SDreadchunkraw");
+            status = SDwritechunkraw(sds2_id, origin, raw, raw_len);
+            CHECK(status, FAIL, "test_chunk_dedup: SDwritechunkraw");
+        }
+
+    for (i = 0; i < DUP_CHUNK; i++)
+        for (j = 0; j < DUP_CHUNK; j++)
+            chunk[i][j] = -1;
+    origin[0] = origin[1] = 0;
+    status                = SDwritechunk(sds_id, origin, (void *)chunk);
+    CHECK(status, FAIL, "test_chunk_dedup: SDwritechunk");
+    for (i = 0; i < DUP_CHUNK; i++)
+        for (j = 0; j < DUP_CHUNK; j++)
+            data[i][j] = -1;
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_chunk_dedup: SDendaccess");
+    status = SDendaccess(sds2_id);
+    CHECK(status, FAIL, "test_chunk_dedup: SDendaccess");
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_dedup: SDend");
+
+    fchk = SDstart(CDUPFILE, DFACC_READ);
+    CHECK(fchk, FAIL, "test_chunk_dedup: SDstart");
+
+    sds_id = SDselect(fchk, 0);
+    CHECK(sds_id, FAIL, "test_chunk_dedup: SDselect");
+    memset(outdata, 0, sizeof(outdata));
+    status = SDreaddata(sds_id, start, NULL, dims, (void *)outdata);
+    CHECK(status, FAIL, "test_chunk_dedup: SDreaddata");
+    if (memcmp(outdata, data, sizeof(data)) != 0) {
+        fprintf(stderr, "test_chunk_dedup: wrong data read from the first SDS\n");
+        num_errs++;
+    }
+    noffsets = count_chunk_offsets(sds_id);
+    VERIFY(noffsets, 3, "test_chunk_dedup: SDgetdatainfo");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_chunk_dedup: SDendaccess");
+
+    /* the copy was made before the chunk was written again */
+    for (i = 0; i < DUP_CHUNK; i++)
+        for (j = 0; j < DUP_CHUNK; j++)
+            data[i][j] = i * 100 + j;
+
+    sds2_id = SDselect(fchk, 1);
+    CHECK(sds2_id, FAIL, "test_chunk_dedup: SDselect");
+    memset(outdata, 0, sizeof(outdata));
+    status = SDreaddata(sds2_id, start, NULL, dims, (void *)outdata);
+    CHECK(status, FAIL, "test_chunk_dedup: SDreaddata");
+    if (memcmp(outdata, data, sizeof(data)) != 0) {
+        fprintf(stderr, "test_chunk_dedup: wrong data read from the copy\n");
+        num_errs++;
+    }
+    noffsets = count_chunk_offsets(sds2_id);
+    VERIFY(noffsets, 2, "test_chunk_dedup: SDgetdatainfo");
+    status = SDendaccess(sds2_id);
+    CHECK(status, FAIL, "test_chunk_dedup: SDendaccess");
+
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_dedup: SDend");
+
+    return num_errs;
+} /* test_chunk_dedup() */
+
+/********************************************************************
+   Name: test_chunk_hyperslab() - tests reading hyperslabs of chunked
+                data sets chunk by chunk
+
+   Description:
+        Writes the first half of a deflate compressed SDS of rank 3 and
+        of an uncompressed one of rank 4, whose last chunks are cut short
+        along every dimension, leaving the other chunks unwritten.  Their
+        hyperslabs are then read, with strides shorter and longer than
+        the chunks, and checked against the values written and the fill
+        value.
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+static int
+test_chunk_hyperslab(void)
+{
+    int32         fchk, sds_id;
+    int32         dims[4]  = {HSL_DIM0, 10, 9, 7};
+    int32         zero[4]  = {0, 0, 0, 0};
+    int32         edges[4] = {HSL_DIM0 / 2, 10, 9, 7};
+    int32         idx[4];
+    int32         fill = HSL_FILL;
+    int32         value, coord;
+    HDF_CHUNK_DEF chunk_def;
+    static int32  data[HSL_DIM0 * 10 * 9 * 7];
+    static int32  outdata[HSL_DIM0 * 10 * 9 * 7];
+    intn          status;
+    intn          rank, s, k;
+    int32         i, n;
+    int           num_errs = 0;
+
+    /* start, stride and edges of the slabs read, along the 4 dimensions */
+    static int32 slabs[4][3][4] = {
+        {{0, 0, 0, 0}, {1, 1, 1, 1}, {HSL_DIM0, 10, 9, 7}}, /* the whole SDS */
+        {{3, 2, 1, 2}, {1, 1, 1, 1}, {6, 5, 7, 4}},         /* across chunks */
+        {{1, 0, 2, 0}, {5, 6, 3, 4}, {3, 2, 3, 2}},         /* skipping chunks */
+        {{11, 9, 8, 6}, {1, 1, 1, 1}, {1, 1, 1, 1}},        /* the last value */
+    };
+
+    fchk = SDstart(CHSLFILE, DFACC_CREATE);
+    CHECK(fchk, FAIL, "test_chunk_hyperslab: SDstart");
+
+    for (rank = 3; rank <= 4; rank++) {
+        /* the value at (c0, c1, c2[, c3]) is c0c1c2[c3] in decimal */
+        for (n = 1, k = 0; k < rank; k++)
+            n *= dims[k];
+        for (i = 0; i < n; i++) {
+            for (value = 0, coord = i, k = rank - 1; k >= 0; k--) {
+                idx[k] = coord % dims[k];
+                coord /= dims[k];
+            }
+            for (k = 0; k < rank; k++)
+                value = value * 10 + idx[k];
+            data[i] = value;
+        }
+
+        sds_id = SDcreate(fchk, rank == 3 ? "Rank 3" : "Rank 4", DFNT_INT32, rank, dims);
+        CHECK(sds_id, FAIL, "test_chunk_hyperslab: SDcreate");
+        status = SDsetfillvalue(sds_id, (void *)&fill);
+        CHECK(status, FAIL, "test_chunk_hyperslab: SDsetfillvalue");
+        memset(&chunk_def, 0, sizeof(chunk_def));
+        chunk_def.comp.chunk_lengths[0] = 5;
+        chunk_def.comp.chunk_lengths[1] = 4;
+        chunk_def.comp.chunk_lengths[2] = 4;
+        chunk_def.comp.chunk_lengths[3] = 3;
+        if (rank == 3) {
+            chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+            chunk_def.comp.cinfo.deflate.level = 6;
+        }
+        status = SDsetchunk(sds_id, chunk_def, rank == 3 ? HDF_CHUNK | HDF_COMP : HDF_CHUNK);
+        CHECK(status, FAIL, "test_chunk_hyperslab: SDsetchunk");
+        status = SDwritedata(sds_id, zero, NULL, edges, (void *)data);
+        CHECK(status, FAIL, "test_chunk_hyperslab: SDwritedata");
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "test_chunk_hyperslab: SDendaccess");
+    }
+
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_hyperslab: SDend");
+
+    fchk = SDstart(CHSLFILE, DFACC_READ);
+    CHECK(fchk, FAIL, "test_chunk_hyperslab: SDstart");
+
+    for (rank = 3; rank <= 4; rank++) {
+        sds_id = SDselect(fchk, rank - 3);
+        CHECK(sds_id, FAIL, "test_chunk_hyperslab: SDselect");
+
+        for (s = 0; s < 4; s++) {
+            memset(outdata, 0, sizeof(outdata));
+            status = SDreaddata(sds_id, slabs[s][0], slabs[s][1], slabs[s][2], (void *)outdata);
+            CHECK(status, FAIL, "test_chunk_hyperslab: SDreaddata");
+
+            /* the values of the slab, the rows past the first half are fill */
+            for (k = 0; k < rank; k++)
+                idx[k] = 0;
+            n = 0;
+            do {
+                for (value = 0, k = 0; k < rank; k++)
+                    value = value * 10 + slabs[s][0][k] + idx[k] * slabs[s][1][k];
+                if (slabs[s][0][0] + idx[0] * slabs[s][1][0] >= HSL_DIM0 / 2)
+                    value = HSL_FILL;
+                if (outdata[n++] != value) {
+                    fprintf(stderr, "test_chunk_hyperslab: rank %d, slab %d, wrong value #%d\n", rank, s,
+                            (int)n - 1);
+                    num_errs++;
+                    break;
+                }
+                for (k = rank - 1; k >= 0; k--) {
+                    if (++idx[k] < slabs[s][2][k])
+                        break;
+                    idx[k] = 0;
+                }
+            } while (k >= 0);
+        }
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "test_chunk_hyperslab: SDendaccess");
+    }
+
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_hyperslab: SDend");
+
+    return num_errs;
+} /* test_chunk_hyperslab() */
+
+/********************************************************************
+   Name: test_chunk_rawlimit() - tests that chunks that do not compress
+                well are stored as they are
+
+   Description:
+        Writes two deflate compressed SDSs with a limit on the size of
+        the compressed chunks, the second one with two coding threads,
+        whose chunks on the diagonal are noise and the others compress
+        well.  The noise chunks must be stored uncompressed, at their
+        full size, and read back, while SDreadchunkraw() only reads the
+        others as stored.
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+static int
+test_chunk_rawlimit(void)
+{
+    int32         fchk, sds_id;
+    int32         dims[2]  = {RAW_DIM, RAW_DIM};
+    int32         start[2] = {0, 0};
+    int32         origin[2];
+    int32         offset, length, comp_size, uncomp_size;
+    int32         chunk_bytes = RAW_CHUNK * RAW_CHUNK * (int32)sizeof(int32);
+    HDF_CHUNK_DEF chunk_def;
+    static int32  data[RAW_DIM][RAW_DIM];
+    static int32  outdata[RAW_DIM][RAW_DIM];
+    uint32        seed = 12345;
+    intn          noise;
+    intn          status;
+    intn          i, j, k;
+    int           num_errs = 0;
+
+    for (i = 0; i < RAW_DIM; i++)
+        for (j = 0; j < RAW_DIM; j++) {
+            seed       = seed * 1103515245 + 12345;
+            data[i][j] = (i / RAW_CHUNK == j / RAW_CHUNK) ? (int32)seed : i;
+        }
+
+    fchk = SDstart(CRAWFILE, DFACC_CREATE);
+    CHECK(fchk, FAIL, "test_chunk_rawlimit: SDstart");
+
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]    = RAW_CHUNK;
+    chunk_def.comp.chunk_lengths[1]    = RAW_CHUNK;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 6;
+
+    for (k = 0; k < 2; k++) {
+        sds_id = SDcreate(fchk, k == 0 ? "Serial" : "Threaded", DFNT_INT32, 2, dims);
+        CHECK(sds_id, FAIL, "test_chunk_rawlimit: SDcreate");
+        status = SDsetchunk(sds_id, chunk_def, HDF_CHUNK | HDF_COMP);
+        CHECK(status, FAIL, "test_chunk_rawlimit: SDsetchunk");
+        status = SDsetchunkrawlimit(sds_id, RAW_LIMIT);
+        VERIFY(status, 0, "test_chunk_rawlimit: SDsetchunkrawlimit");
+        status = SDsetchunkrawlimit(sds_id, RAW_LIMIT);
+        VERIFY(status, RAW_LIMIT, "test_chunk_rawlimit: SDsetchunkrawlimit");
+        if (k == 1) {
+            status = SDsetchunkthreads(sds_id, 2);
+            CHECK(status, FAIL, "test_chunk_rawlimit: SDsetchunkthreads");
+        }
+        status = SDwritedata(sds_id, start, NULL, dims, (void *)data);
+        CHECK(status, FAIL, "test_chunk_rawlimit: SDwritedata");
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "test_chunk_rawlimit: SDendaccess");
+    }
+
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_rawlimit: SDend");
+
+    fchk = SDstart(CRAWFILE, DFACC_READ);
+    CHECK(fchk, FAIL, "test_chunk_rawlimit: SDstart");
+
+    for (k = 0; k < 2; k++) {
+        sds_id = SDselect(fchk, k);
+        CHECK(sds_id, FAIL, "test_chunk_rawlimit: SDselect");
+
+        memset(outdata, 0, sizeof(outdata));
+        status = SDreaddata(sds_id, start, NULL, dims, (void *)outdata);
+        CHECK(status, FAIL, "test_chunk_rawlimit: SDreaddata");
+        if (memcmp(outdata, data, sizeof(data)) != 0) {
+            fprintf(stderr, "test_chunk_rawlimit: wrong data read from SDS #%d\n", (int)k);
+            num_errs++;
+        }
+
+        for (i = 0; i < RAW_NCHUNK; i++)
+            for (j = 0; j < RAW_NCHUNK; j++) {
+                origin[0] = i;
+                origin[1] = j;
+                noise     = (i == j);
+                status    = SDgetdatainfo(sds_id, origin, 0, 1, &offset, &length);
+                VERIFY(status, 1, "test_chunk_rawlimit: SDgetdatainfo");
+                if (noise ? length != chunk_bytes : length >= chunk_bytes * RAW_LIMIT / 100) {
+                    fprintf(stderr, "test_chunk_rawlimit: chunk (%d,%d) of SDS #%d stored in %d bytes\n",
+                            (int)i, (int)j, (int)k, (int)length);
+                    num_errs++;
+                }
+                length = SDreadchunkraw(sds_id, origin, NULL, 0);
+                if (noise) {
+                    VERIFY(length, FAIL, "test_chunk_rawlimit: SDreadchunkraw");
+                }
+                else {
+                    CHECK(length, FAIL, "test_chunk_rawlimit: SDreadchunkraw");
+                }
+            }
+
+        status = SDgetdatasize(sds_id, &comp_size, &uncomp_size);
+        CHECK(status, FAIL, "test_chunk_rawlimit: SDgetdatasize");
+        if (comp_size <= RAW_NCHUNK * chunk_bytes || comp_size >= uncomp_size) {
+            fprintf(stderr, "test_chunk_rawlimit: SDS #%d takes %d bytes\n", (int)k, (int)comp_size);
+            num_errs++;
+        }
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "test_chunk_rawlimit: SDendaccess");
+    }
+
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_rawlimit: SDend");
+
+    return num_errs;
+} /* test_chunk_rawlimit() */
+
+/********************************************************************
+   Name: test_chunk_coderpolicy() - tests that the coder of each chunk
+                is picked by a trial
+
+   Description:
+        Writes a deflate compressed SDS at level 1 and three at level 9
+        with a coder policy set: two, the second one with two coding
+        threads, with a policy that picks the fastest coder, and one
+        with a policy that picks the smallest.  Without LZ4 in the
+        library the fastest coder is deflate at level 1, and the chunks
+        of the first two take the size of those of the level 1 SDS.
+        All of them read back.
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+static int
+test_chunk_coderpolicy(void)
+{
+    int32         fchk, sds_id;
+    int32         dims[2]  = {POL_DIM, POL_DIM};
+    int32         start[2] = {0, 0};
+    int32         comp_size[4], uncomp_size;
+    HDF_CHUNK_DEF chunk_def;
+    static int32  data[POL_DIM][POL_DIM];
+    static int32  outdata[POL_DIM][POL_DIM];
+    const char   *names[4]    = {"Level 1", "Fastest", "Threaded", "Smallest"};
+    intn          policies[4] = {-1, POL_FASTEST, POL_FASTEST, POL_SMALLEST};
+    uint32        seed        = 12345;
+    intn          status;
+    intn          i, j, k;
+    int           num_errs = 0;
+
+    /* values of a few bits of noise on a slope */
+    for (i = 0; i < POL_DIM; i++)
+        for (j = 0; j < POL_DIM; j++) {
+            seed       = seed * 1103515245 + 12345;
+            data[i][j] = i * j + (int32)(seed >> 28);
+        }
+
+    fchk = SDstart(CCODFILE, DFACC_CREATE);
+    CHECK(fchk, FAIL, "test_chunk_coderpolicy: SDstart");
+
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0] = POL_CHUNK;
+    chunk_def.comp.chunk_lengths[1] = POL_CHUNK;
+    chunk_def.comp.comp_type        = COMP_CODE_DEFLATE;
+
+    for (k = 0; k < 4; k++) {
+        sds_id = SDcreate(fchk, names[k], DFNT_INT32, 2, dims);
+        CHECK(sds_id, FAIL, "test_chunk_coderpolicy: SDcreate");
+        chunk_def.comp.cinfo.deflate.level = k == 0 ? 1 : 9;
+        status                             = SDsetchunk(sds_id, chunk_def, HDF_CHUNK | HDF_COMP);
+        CHECK(status, FAIL, "test_chunk_coderpolicy: SDsetchunk");
+        status = SDsetchunkcoderpolicy(sds_id, policies[k]);
+        VERIFY(status, SUCCEED, "test_chunk_coderpolicy: SDsetchunkcoderpolicy");
+        if (k == 2) {
+            status = SDsetchunkthreads(sds_id, 2);
+            CHECK(status, FAIL, "test_chunk_coderpolicy: SDsetchunkthreads");
+        }
+        status = SDwritedata(sds_id, start, NULL, dims, (void *)data);
+        CHECK(status, FAIL, "test_chunk_coderpolicy: SDwritedata");
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "test_chunk_coderpolicy: SDendaccess");
+    }
+
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_coderpolicy: SDend");
+
+    fchk = SDstart(CCODFILE, DFACC_READ);
+    CHECK(fchk, FAIL, "test_chunk_coderpolicy: SDstart");
+
+    for (k = 0; k < 4; k++) {
+        sds_id = SDselect(fchk, k);
+        CHECK(sds_id, FAIL, "test_chunk_coderpolicy: SDselect");
+
+        memset(outdata, 0, sizeof(outdata));
+        status = SDreaddata(sds_id, start, NULL, dims, (void *)outdata);
+        CHECK(status, FAIL, "test_chunk_coderpolicy: SDreaddata");
+        if (memcmp(outdata, data, sizeof(data)) != 0) {
+            fprintf(stderr, "test_chunk_coderpolicy: wrong data read from SDS %s\n", names[k]);
+            num_errs++;
+        }
+
+        status = SDgetdatasize(sds_id, &comp_size[k], &uncomp_size);
+        CHECK(status, FAIL, "test_chunk_coderpolicy: SDgetdatasize");
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "test_chunk_coderpolicy: SDendaccess");
+    }
+
+#ifndef H4_HAVE_LIBLZ4
+    if (comp_size[1] != comp_size[0] || comp_size[2] != comp_size[0]) {
+        fprintf(stderr, "test_chunk_coderpolicy: fastest coder takes %d and %d bytes, not %d\n",
+                (int)comp_size[1], (int)comp_size[2], (int)comp_size[0]);
+        num_errs++;
+    }
+#endif /* H4_HAVE_LIBLZ4 */
+
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_coderpolicy: SDend");
+
+    return num_errs;
+} /* test_chunk_coderpolicy() */
+
+/* CRC-32C of 'len' bytes, a bit at a time, to check the library's against */
+static uint32
+crc32c_bitwise(const uint8 *p, int32 len)
+{
+    uint32 crc = 0xffffffff;
+    int    b;
+
+    for (; len > 0; len--, p++) {
+        crc ^= *p;
+        for (b = 0; b < 8; b++)
+            crc = (crc & 1) ? (crc >> 1) ^ 0x82f63b78 : crc >> 1;
+    }
+    return ~crc;
+} /* crc32c_bitwise() */
+
+/* Checks the checksums of a chunk against those of its data read back, the
+   data of an uncompressed SDS 'plain_id' for the one of the decoded data;
+   returns the number of errors */
+static int
+check_chunk_sums(int32 sds_id, int32 plain_id, int32 *origin, intn known, const char *where)
+{
+    static uint8 buf[SUM_CHUNK * SUM_CHUNK * sizeof(int32) * 2];
+    uint32       raw_crc, stored_crc;
+    int32        len;
+    intn         ret;
+    int          num_errs = 0;
+
+    ret = SDgetchunkchecksum(sds_id, origin, &raw_crc, &stored_crc);
+    VERIFY(ret, known, where);
+    if (ret & HDF_CHKSUM_STORED) {
+        len = SDreadchunkraw(sds_id, origin, buf, (int32)sizeof(buf));
+        CHECK(len, FAIL, where);
+        if (stored_crc != crc32c_bitwise(buf, len)) {
+            fprintf(stderr, "%s: wrong checksum of stored chunk [%d,%d]\n", where, (int)origin[0],
+                    (int)origin[1]);
+            num_errs++;
+        }
+    }
+    if (ret & HDF_CHKSUM_RAW) {
+        len = SDreadchunkraw(plain_id, origin, buf, (int32)sizeof(buf));
+        VERIFY(len, SUM_CHUNK * SUM_CHUNK * (int32)sizeof(int32), where);
+        if (raw_crc != crc32c_bitwise(buf, len)) {
+            fprintf(stderr, "%s: wrong checksum of decoded chunk [%d,%d]\n", where, (int)origin[0],
+                    (int)origin[1]);
+            num_errs++;
+        }
+    }
+
+    return num_errs;
+} /* check_chunk_sums() */
+
+/********************************************************************
+   Name: test_chunk_checksums() - tests the checksums of the chunks
+
+   Description:
+        Writes the first two rows of chunks of two deflate compressed
+        SDSs, one with two coding threads, and an uncompressed one, all
+        keeping checksums of their chunks, and of an SDS without them.
+        The checksums are checked against the CRC-32C of the chunks
+        read back with SDreadchunkraw(), those of the decoded data
+        against the chunks of the uncompressed SDS, before and after the
+        file is opened again and a value is changed.  Identical chunks
+        have the same checksums, chunks never written none, and a chunk
+        copied with SDwritechunkraw() only the one of its stored data.
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+static int
+test_chunk_checksums(void)
+{
+    int32         fchk, sds_id[4], copy_id;
+    int32         dims[2]  = {SUM_DIM, SUM_DIM};
+    int32         start[2] = {0, 0};
+    int32         edges[2] = {2 * SUM_CHUNK, SUM_DIM};
+    int32         origin[2], origin2[2], len;
+    uint32        raw_crc, stored_crc, raw_crc2, stored_crc2, old_crc;
+    static int32  data[SUM_DIM][SUM_DIM];
+    static uint8  buf[SUM_CHUNK * SUM_CHUNK * sizeof(int32) * 2];
+    const char   *names[4] = {"Deflate", "Threaded", "Plain", "NoSums"};
+    HDF_CHUNK_DEF chunk_def;
+    int32         value;
+    intn          status;
+    int32         i, j, k;
+    int           num_errs = 0;
+
+    /* the reference the library's checksums are checked against */
+    VERIFY(crc32c_bitwise((const uint8 *)"123456789", 9), 0xe3069283, "test_chunk_checksums: CRC-32C");
+
+    /* the chunks of even columns the same */
+    for (i = 0; i < SUM_DIM; i++)
+        for (j = 0; j < SUM_DIM; j++)
+            data[i][j] = ((j / SUM_CHUNK) % 2 == 0) ? (i % SUM_CHUNK) * 100 + j % SUM_CHUNK : i * j;
+
+    fchk = SDstart(CSUMFILE, DFACC_CREATE);
+    CHECK(fchk, FAIL, "test_chunk_checksums: SDstart");
+
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]    = SUM_CHUNK;
+    chunk_def.comp.chunk_lengths[1]    = SUM_CHUNK;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 6;
+    for (k = 0; k < 4; k++) {
+        sds_id[k] = SDcreate(fchk, names[k], DFNT_INT32, 2, dims);
+        CHECK(sds_id[k], FAIL, "test_chunk_checksums: SDcreate");
+        status = SDsetchunk(sds_id[k], chunk_def, k == 2 ? HDF_CHUNK : HDF_CHUNK | HDF_COMP);
+        CHECK(status, FAIL, "test_chunk_checksums: SDsetchunk");
+        if (k == 1) {
+            status = SDsetchunkthreads(sds_id[k], 2);
+            CHECK(status, FAIL, "test_chunk_checksums: SDsetchunkthreads");
+        }
+        if (k < 3) {
+            status = SDsetchunkchecksums(sds_id[k]);
+            CHECK(status, FAIL, "test_chunk_checksums: SDsetchunkchecksums");
+        }
+        status = SDwritedata(sds_id[k], start, NULL, edges, (void *)data);
+        CHECK(status, FAIL, "test_chunk_checksums: SDwritedata");
+    }
+
+    for (origin[0] = 0; origin[0] < 2; origin[0]++)
+        for (origin[1] = 0; origin[1] < SUM_NCHUNK; origin[1]++)
+            for (k = 0; k < 3; k++)
+                num_errs += check_chunk_sums(sds_id[k], sds_id[2], origin, HDF_CHKSUM_RAW | HDF_CHKSUM_STORED,
+                                             "test_chunk_checksums: SDgetchunkchecksum");
+
+    /* identical chunks, compressed the same */
+    origin[0]  = 0;
+    origin[1]  = 0;
+    origin2[0] = 1;
+    origin2[1] = 2;
+    status     = SDgetchunkchecksum(sds_id[0], origin, &raw_crc, &stored_crc);
+    CHECK(status, FAIL, "test_chunk_checksums: SDgetchunkchecksum");
+    status = SDgetchunkchecksum(sds_id[0], origin2, &raw_crc2, &stored_crc2);
+    CHECK(status, FAIL, "test_chunk_checksums: SDgetchunkchecksum");
+    VERIFY(raw_crc2, raw_crc, "test_chunk_checksums: SDgetchunkchecksum");
+    VERIFY(stored_crc2, stored_crc, "test_chunk_checksums: SDgetchunkchecksum");
+
+    /* none for a chunk never written, nor for an SDS without them */
+    origin[0] = 3;
+    status    = SDgetchunkchecksum(sds_id[0], origin, &raw_crc, &stored_crc);
+    VERIFY(status, 0, "test_chunk_checksums: SDgetchunkchecksum");
+    origin[0] = 0;
+    status    = SDgetchunkchecksum(sds_id[3], origin, &raw_crc, &stored_crc);
+    VERIFY(status, FAIL, "test_chunk_checksums: SDgetchunkchecksum");
+
+    for (k = 0; k < 4; k++) {
+        status = SDendaccess(sds_id[k]);
+        CHECK(status, FAIL, "test_chunk_checksums: SDendaccess");
+    }
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_checksums: SDend");
+
+    /* the checksums are kept in the file and updated on writes */
+    fchk = SDstart(CSUMFILE, DFACC_WRITE);
+    CHECK(fchk, FAIL, "test_chunk_checksums: SDstart");
+    for (k = 0; k < 3; k++) {
+        sds_id[k] = SDselect(fchk, k);
+        CHECK(sds_id[k], FAIL, "test_chunk_checksums: SDselect");
+    }
+
+    origin[0] = 0;
+    origin[1] = 1;
+    status    = SDgetchunkchecksum(sds_id[0], origin, &old_crc, &stored_crc);
+    VERIFY(status, (HDF_CHKSUM_RAW | HDF_CHKSUM_STORED), "test_chunk_checksums: SDgetchunkchecksum");
+
+    start[0] = 2;
+    start[1] = SUM_CHUNK + 3;
+    edges[0] = edges[1] = 1;
+    value               = -1;
+    for (k = 0; k < 3; k++) {
+        status = SDwritedata(sds_id[k], start, NULL, edges, (void *)&value);
+        CHECK(status, FAIL, "test_chunk_checksums: SDwritedata");
+    }
+    for (k = 0; k < 3; k++)
+        num_errs += check_chunk_sums(sds_id[k], sds_id[2], origin, HDF_CHKSUM_RAW | HDF_CHKSUM_STORED,
+                                     "test_chunk_checksums: SDgetchunkchecksum");
+    status = SDgetchunkchecksum(sds_id[0], origin, &raw_crc, &stored_crc);
+    CHECK(status, FAIL, "test_chunk_checksums: SDgetchunkchecksum");
+    if (raw_crc == old_crc) {
+        fprintf(stderr, "test_chunk_checksums: checksum of chunk [0,1] not updated\n");
+        num_errs++;
+    }
+
+    /* a chunk copied as stored */
+    copy_id = SDcreate(fchk, "Copy", DFNT_INT32, 2, dims);
+    CHECK(copy_id, FAIL, "test_chunk_checksums: SDcreate");
+    status = SDsetchunk(copy_id, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "test_chunk_checksums: SDsetchunk");
+    status = SDsetchunkchecksums(copy_id);
+    CHECK(status, FAIL, "test_chunk_checksums: SDsetchunkchecksums");
+    len = SDreadchunkraw(sds_id[0], origin, buf, (int32)sizeof(buf));
+    CHECK(len, FAIL, "test_chunk_checksums: SDreadchunkraw");
+    status = SDwritechunkraw(copy_id, origin, buf, len);
+    CHECK(status, FAIL, "test_chunk_checksums: SDwritechunkraw");
+    status = SDgetchunkchecksum(copy_id, origin, &raw_crc2, &stored_crc2);
+    VERIFY(status, HDF_CHKSUM_STORED, "test_chunk_checksums: SDgetchunkchecksum");
+    VERIFY(stored_crc2, stored_crc, "test_chunk_checksums: SDgetchunkchecksum");
+
+    status = SDendaccess(copy_id);
+    CHECK(status, FAIL, "test_chunk_checksums: SDendaccess");
+    for (k = 0; k < 3; k++) {
+        status = SDendaccess(sds_id[k]);
+        CHECK(status, FAIL, "test_chunk_checksums: SDendaccess");
+    }
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_checksums: SDend");
+
+    fchk = SDstart(CSUMFILE, DFACC_READ);
+    CHECK(fchk, FAIL, "test_chunk_checksums: SDstart");
+    for (k = 0; k < 3; k++) {
+        sds_id[k] = SDselect(fchk, k);
+        CHECK(sds_id[k], FAIL, "test_chunk_checksums: SDselect");
+    }
+
+    for (origin[0] = 0; origin[0] < 2; origin[0]++)
+        for (origin[1] = 0; origin[1] < SUM_NCHUNK; origin[1]++)
+            for (k = 0; k < 3; k++)
+                num_errs += check_chunk_sums(sds_id[k], sds_id[2], origin, HDF_CHKSUM_RAW | HDF_CHKSUM_STORED,
+                                             "test_chunk_checksums: SDgetchunkchecksum");
+    origin[0] = 0;
+    origin[1] = 1;
+    status    = SDgetchunkchecksum(sds_id[1], origin, &raw_crc2, &stored_crc2);
+    CHECK(status, FAIL, "test_chunk_checksums: SDgetchunkchecksum");
+    VERIFY(raw_crc2, raw_crc, "test_chunk_checksums: SDgetchunkchecksum");
+
+    for (k = 0; k < 3; k++) {
+        status = SDendaccess(sds_id[k]);
+        CHECK(status, FAIL, "test_chunk_checksums: SDendaccess");
+    }
+    status = SDend(fchk);
+    CHECK(status, FAIL, "test_chunk_checksums: SDend");
+
+    return num_errs;
+} /* test_chunk_checksums() */
+
 extern int
 test_chunk()
 {
@@ -1375,6 +3743,53 @@ test8:
     status = SDend(fchk);
     CHECK(status, FAIL, "Chunk Test 8. SDend");
 
+    /* Chunks decoded on several threads */
+    num_errs += test_chunk_threads();
+    num_errs += test_chunk_readahead();
+#ifndef H4_HAVE_WIN32_API
+    num_errs += test_chunk_diskcache(); /* compressed chunks of remote files kept on local disk */
+#endif
+
+    /* Chunks decoded by a decode provider */
+    num_errs += test_chunk_provider();
+
+    /* Data sets split into slabs of chunks among readers */
+    num_errs += test_chunk_slab();
+
+    /* Chunk cache replacement policies */
+    num_errs += test_chunk_cache_policy();
+
+    /* Chunk index read on open */
+    num_errs += test_chunk_index();
+#ifndef H4_HAVE_THREADSAFE
+    num_errs += test_chunk_cache_pool(); /* thread-safe builds have no pool */
+#endif
+
+    /* Chunks of only fill values */
+    num_errs += test_chunk_sparse();
+    num_errs += test_chunk_map();
+
+    /* Chunks held in the chunk cache, visited in storage order */
+    num_errs += test_chunk_view();
+
+    /* Statistics of the chunks */
+    num_errs += test_chunk_stats();
+
+    /* Identical chunks sharing their data */
+    num_errs += test_chunk_dedup();
+
+    /* Hyperslabs read chunk by chunk */
+    num_errs += test_chunk_hyperslab();
+
+    /* Chunks that do not compress stored as they are */
+    num_errs += test_chunk_rawlimit();
+
+    /* Coder of each chunk picked by a trial */
+    num_errs += test_chunk_coderpolicy();
+
+    /* Checksums of the chunks */
+    num_errs += test_chunk_checksums();
+
     if (num_errs == 0)
         PASSED();
 
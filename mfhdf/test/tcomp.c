@@ -17,6 +17,11 @@
  *    test_compression - test driver
  *	  test_various_comps - creates several data sets with different
  *		compression methods.
+ *	  test_zstd_comp - writes and reads zstd compressed data sets.
+ *	  test_lz4_comp - writes and reads LZ4 compressed data sets.
+ *	  test_shuffle_comp - writes and reads data sets with shuffled bytes.
+ *	  test_plugin_comp - writes and reads data sets with a registered coder.
+ *	  test_lossy_comp - writes and reads data sets with the lossy coder.
  *
  ****************************************************************************/
 
@@ -826,6 +831,932 @@ test_compressed_data()
 
 } /* end test_compressed_data */
 
+/********************************************************************
+   Name: test_zstd_comp() - writes and reads zstd compressed data sets
+
+   Description:
+        Without the zstd library, this function only verifies that the
+        ZSTD coder is reported unavailable and is refused.  Otherwise, it
+        writes a contiguous and a chunked data set with zstd, large enough
+        for the compressed stream to span several zstd buffers, then reads
+        them back whole and from an offset, which seeks in the stream, and
+        verifies the data and the compression information.
+
+   Return value:
+        The number of errors occurred in this routine.
+
+*********************************************************************/
+
+#define ZSTD_FILE   "comptstzstd.hdf"
+#define ZSTD_DIM0   300
+#define ZSTD_DIM1   300
+#define ZSTD_LEVEL  3
+#define ZSTD_OFFSET 123
+
+static intn
+test_zstd_comp()
+{
+    int32     sd_id, sds_id;
+    int32     dimsize[2];
+    comp_info cinfo;
+    uint32    comp_config;
+    intn      status;
+    intn      num_errs = 0; /* number of errors in compression test so far */
+
+    status = HCget_config_info(COMP_CODE_ZSTD, &comp_config);
+    CHECK(status, FAIL, "HCget_config_info");
+
+#ifndef H4_HAVE_LIBZSTD
+    VERIFY(comp_config, 0, "HCget_config_info");
+
+    /* The coder must be refused when the library is not there */
+    sd_id = SDstart(ZSTD_FILE, DFACC_CREATE);
+    CHECK(sd_id, FAIL, "SDstart");
+    dimsize[0] = ZSTD_DIM0;
+    dimsize[1] = ZSTD_DIM1;
+    sds_id     = SDcreate(sd_id, "ZstdContiguous", DFNT_INT32, 2, dimsize);
+    CHECK(sds_id, FAIL, "SDcreate");
+    cinfo.zstd.level = ZSTD_LEVEL;
+    status           = SDsetcompress(sds_id, COMP_CODE_ZSTD, &cinfo);
+    VERIFY(status, FAIL, "SDsetcompress");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDend(sd_id);
+    CHECK(status, FAIL, "SDend");
+#else
+    {
+        HDF_CHUNK_DEF chunk_def;
+        int32         start[2], edges[2];
+        comp_coder_t  comp_type;
+        int32        *idata, *rdata;
+        uint32        seed = 1;
+        intn          i, k;
+
+        VERIFY(comp_config, (COMP_DECODER_ENABLED | COMP_ENCODER_ENABLED), "HCget_config_info");
+
+        idata = (int32 *)malloc(ZSTD_DIM0 * ZSTD_DIM1 * sizeof(int32));
+        rdata = (int32 *)malloc(ZSTD_DIM0 * ZSTD_DIM1 * sizeof(int32));
+        CHECK_ALLOC(idata, "idata", "test_zstd_comp");
+        CHECK_ALLOC(rdata, "rdata", "test_zstd_comp");
+
+        /* hardly compressible data, so that the stream is long */
+        for (i = 0; i < ZSTD_DIM0 * ZSTD_DIM1; i++) {
+            seed     = seed * 1103515245 + 12345;
+            idata[i] = (int32)(seed >> 8);
+        }
+
+        sd_id = SDstart(ZSTD_FILE, DFACC_CREATE);
+        CHECK(sd_id, FAIL, "SDstart");
+
+        dimsize[0] = ZSTD_DIM0;
+        dimsize[1] = ZSTD_DIM1;
+        start[0] = start[1] = 0;
+        edges[0]            = ZSTD_DIM0;
+        edges[1]            = ZSTD_DIM1;
+
+        /* Levels out of range are refused */
+        sds_id = SDcreate(sd_id, "ZstdContiguous", DFNT_INT32, 2, dimsize);
+        CHECK(sds_id, FAIL, "SDcreate");
+        cinfo.zstd.level = H4_ZSTD_MAX_LEVEL + 1;
+        status           = SDsetcompress(sds_id, COMP_CODE_ZSTD, &cinfo);
+        VERIFY(status, FAIL, "SDsetcompress");
+
+        cinfo.zstd.level = ZSTD_LEVEL;
+        status           = SDsetcompress(sds_id, COMP_CODE_ZSTD, &cinfo);
+        CHECK(status, FAIL, "SDsetcompress");
+        status = SDwritedata(sds_id, start, NULL, edges, (void *)idata);
+        CHECK(status, FAIL, "SDwritedata");
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+
+        /* Chunked, each chunk its own zstd stream */
+        sds_id = SDcreate(sd_id, "ZstdChunked", DFNT_INT32, 2, dimsize);
+        CHECK(sds_id, FAIL, "SDcreate");
+        memset(&chunk_def, 0, sizeof(chunk_def));
+        chunk_def.comp.chunk_lengths[0] = ZSTD_DIM0 / 2;
+        chunk_def.comp.chunk_lengths[1] = ZSTD_DIM1 / 2;
+        chunk_def.comp.comp_type        = COMP_CODE_ZSTD;
+        chunk_def.comp.cinfo.zstd.level = H4_ZSTD_MAX_LEVEL;
+        status                          = SDsetchunk(sds_id, chunk_def, HDF_CHUNK | HDF_COMP);
+        CHECK(status, FAIL, "SDsetchunk");
+        status = SDwritedata(sds_id, start, NULL, edges, (void *)idata);
+        CHECK(status, FAIL, "SDwritedata");
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+
+        status = SDend(sd_id);
+        CHECK(status, FAIL, "SDend");
+
+        sd_id = SDstart(ZSTD_FILE, DFACC_READ);
+        CHECK(sd_id, FAIL, "SDstart");
+
+        for (k = 0; k < 2; k++) {
+            sds_id = SDselect(sd_id, k);
+            CHECK(sds_id, FAIL, "SDselect");
+
+            comp_type = COMP_CODE_INVALID; /* reset variables before retrieving info */
+            memset(&cinfo, 0, sizeof(cinfo));
+            status = SDgetcompinfo(sds_id, &comp_type, &cinfo);
+            CHECK(status, FAIL, "SDgetcompinfo");
+            VERIFY(comp_type, COMP_CODE_ZSTD, "SDgetcompinfo");
+            VERIFY(cinfo.zstd.level, (k == 0 ? ZSTD_LEVEL : H4_ZSTD_MAX_LEVEL), "SDgetcompinfo");
+
+            /* Read the whole data set */
+            memset(rdata, 0, ZSTD_DIM0 * ZSTD_DIM1 * sizeof(int32));
+            start[0] = 0;
+            edges[0] = ZSTD_DIM0;
+            status   = SDreaddata(sds_id, start, NULL, edges, (void *)rdata);
+            CHECK(status, FAIL, "SDreaddata");
+            if (memcmp(idata, rdata, ZSTD_DIM0 * ZSTD_DIM1 * sizeof(int32)) != 0) {
+                fprintf(stderr, "test_zstd_comp: wrong data read from data set #%d\n", (int)k);
+                num_errs++;
+            }
+
+            /* Read the tail, backwards after the full read */
+            memset(rdata, 0, ZSTD_DIM0 * ZSTD_DIM1 * sizeof(int32));
+            start[0] = ZSTD_OFFSET;
+            edges[0] = ZSTD_DIM0 - ZSTD_OFFSET;
+            status   = SDreaddata(sds_id, start, NULL, edges, (void *)rdata);
+            CHECK(status, FAIL, "SDreaddata");
+            if (memcmp(idata + ZSTD_OFFSET * ZSTD_DIM1, rdata, (size_t)edges[0] * ZSTD_DIM1 * sizeof(int32)) !=
+                0) {
+                fprintf(stderr, "test_zstd_comp: wrong data read from an offset of data set #%d\n", (int)k);
+                num_errs++;
+            }
+
+            status = SDendaccess(sds_id);
+            CHECK(status, FAIL, "SDendaccess");
+        }
+
+        status = SDend(sd_id);
+        CHECK(status, FAIL, "SDend");
+
+        free(idata);
+        free(rdata);
+    }
+#endif /* H4_HAVE_LIBZSTD */
+
+    return num_errs;
+} /* end test_zstd_comp */
+
+/********************************************************************
+   Name: test_lz4_comp() - writes and reads LZ4 compressed data sets
+
+   Description:
+        Without the LZ4 library, this function only verifies that the
+        LZ4 coder is reported unavailable and is refused.  Otherwise, it
+        writes a contiguous data set and a chunked one, the latter with
+        its chunks encoded on worker threads, then reads them back whole
+        and from an offset, and the chunked one again with its chunks
+        decoded on worker threads, and verifies the data and the
+        compression information.
+
+   Return value:
+        The number of errors occurred in this routine.
+
+*********************************************************************/
+
+#define LZ4_FILE   "comptstlz4.hdf"
+#define LZ4_DIM0   300
+#define LZ4_DIM1   300
+#define LZ4_ACCEL  8
+#define LZ4_OFFSET 123
+
+static intn
+test_lz4_comp()
+{
+    int32     sd_id, sds_id;
+    int32     dimsize[2];
+    comp_info cinfo;
+    uint32    comp_config;
+    intn      status;
+    intn      num_errs = 0; /* number of errors in compression test so far */
+
+    status = HCget_config_info(COMP_CODE_LZ4, &comp_config);
+    CHECK(status, FAIL, "HCget_config_info");
+
+#ifndef H4_HAVE_LIBLZ4
+    VERIFY(comp_config, 0, "HCget_config_info");
+
+    /* The coder must be refused when the library is not there */
+    sd_id = SDstart(LZ4_FILE, DFACC_CREATE);
+    CHECK(sd_id, FAIL, "SDstart");
+    dimsize[0] = LZ4_DIM0;
+    dimsize[1] = LZ4_DIM1;
+    sds_id     = SDcreate(sd_id, "LZ4Contiguous", DFNT_INT32, 2, dimsize);
+    CHECK(sds_id, FAIL, "SDcreate");
+    cinfo.lz4.acceleration = 1;
+    status                 = SDsetcompress(sds_id, COMP_CODE_LZ4, &cinfo);
+    VERIFY(status, FAIL, "SDsetcompress");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDend(sd_id);
+    CHECK(status, FAIL, "SDend");
+#else
+    {
+        HDF_CHUNK_DEF chunk_def;
+        int32         start[2], edges[2];
+        comp_coder_t  comp_type;
+        int32        *idata, *rdata;
+        uint32        seed = 1;
+        intn          i, k;
+
+        VERIFY(comp_config, (COMP_DECODER_ENABLED | COMP_ENCODER_ENABLED), "HCget_config_info");
+
+        idata = (int32 *)malloc(LZ4_DIM0 * LZ4_DIM1 * sizeof(int32));
+        rdata = (int32 *)malloc(LZ4_DIM0 * LZ4_DIM1 * sizeof(int32));
+        CHECK_ALLOC(idata, "idata", "test_lz4_comp");
+        CHECK_ALLOC(rdata, "rdata", "test_lz4_comp");
+
+        /* partly compressible data, long enough for several LZ4 blocks */
+        for (i = 0; i < LZ4_DIM0 * LZ4_DIM1; i++) {
+            seed     = seed * 1103515245 + 12345;
+            idata[i] = (int32)(seed >> 24);
+        }
+
+        sd_id = SDstart(LZ4_FILE, DFACC_CREATE);
+        CHECK(sd_id, FAIL, "SDstart");
+
+        dimsize[0] = LZ4_DIM0;
+        dimsize[1] = LZ4_DIM1;
+        start[0] = start[1] = 0;
+        edges[0]            = LZ4_DIM0;
+        edges[1]            = LZ4_DIM1;
+
+        /* Accelerations out of range are refused */
+        sds_id = SDcreate(sd_id, "LZ4Contiguous", DFNT_INT32, 2, dimsize);
+        CHECK(sds_id, FAIL, "SDcreate");
+        cinfo.lz4.acceleration = H4_LZ4_MIN_ACCELERATION - 1;
+        status                 = SDsetcompress(sds_id, COMP_CODE_LZ4, &cinfo);
+        VERIFY(status, FAIL, "SDsetcompress");
+
+        cinfo.lz4.acceleration = H4_LZ4_MIN_ACCELERATION;
+        status                 = SDsetcompress(sds_id, COMP_CODE_LZ4, &cinfo);
+        CHECK(status, FAIL, "SDsetcompress");
+        status = SDwritedata(sds_id, start, NULL, edges, (void *)idata);
+        CHECK(status, FAIL, "SDwritedata");
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+
+        /* Chunked, each chunk its own LZ4 frame, encoded on 4 threads
+           when the library can use them */
+        sds_id = SDcreate(sd_id, "LZ4Chunked", DFNT_INT32, 2, dimsize);
+        CHECK(sds_id, FAIL, "SDcreate");
+        memset(&chunk_def, 0, sizeof(chunk_def));
+        chunk_def.comp.chunk_lengths[0]       = LZ4_DIM0 / 2;
+        chunk_def.comp.chunk_lengths[1]       = LZ4_DIM1 / 2;
+        chunk_def.comp.comp_type              = COMP_CODE_LZ4;
+        chunk_def.comp.cinfo.lz4.acceleration = LZ4_ACCEL;
+        status                                = SDsetchunk(sds_id, chunk_def, HDF_CHUNK | HDF_COMP);
+        CHECK(status, FAIL, "SDsetchunk");
+        status = SDsetchunkthreads(sds_id, 4);
+        CHECK(status, FAIL, "SDsetchunkthreads");
+        status = SDwritedata(sds_id, start, NULL, edges, (void *)idata);
+        CHECK(status, FAIL, "SDwritedata");
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+
+        status = SDend(sd_id);
+        CHECK(status, FAIL, "SDend");
+
+        sd_id = SDstart(LZ4_FILE, DFACC_READ);
+        CHECK(sd_id, FAIL, "SDstart");
+
+        /* the chunked data set is read serially, then with its chunks
+           decoded on 4 threads */
+        for (k = 0; k < 3; k++) {
+            sds_id = SDselect(sd_id, (k == 0 ? 0 : 1));
+            CHECK(sds_id, FAIL, "SDselect");
+            if (k == 2) {
+                status = SDsetchunkthreads(sds_id, 4);
+                CHECK(status, FAIL, "SDsetchunkthreads");
+            }
+
+            comp_type = COMP_CODE_INVALID; /* reset variables before retrieving info */
+            memset(&cinfo, 0, sizeof(cinfo));
+            status = SDgetcompinfo(sds_id, &comp_type, &cinfo);
+            CHECK(status, FAIL, "SDgetcompinfo");
+            VERIFY(comp_type, COMP_CODE_LZ4, "SDgetcompinfo");
+            VERIFY(cinfo.lz4.acceleration, (k == 0 ? H4_LZ4_MIN_ACCELERATION : LZ4_ACCEL), "SDgetcompinfo");
+
+            /* Read the whole data set */
+            memset(rdata, 0, LZ4_DIM0 * LZ4_DIM1 * sizeof(int32));
+            start[0] = 0;
+            edges[0] = LZ4_DIM0;
+            status   = SDreaddata(sds_id, start, NULL, edges, (void *)rdata);
+            CHECK(status, FAIL, "SDreaddata");
+            if (memcmp(idata, rdata, LZ4_DIM0 * LZ4_DIM1 * sizeof(int32)) != 0) {
+                fprintf(stderr, "test_lz4_comp: wrong data read in pass #%d\n", (int)k);
+                num_errs++;
+            }
+
+            /* Read the tail, backwards after the full read */
+            memset(rdata, 0, LZ4_DIM0 * LZ4_DIM1 * sizeof(int32));
+            start[0] = LZ4_OFFSET;
+            edges[0] = LZ4_DIM0 - LZ4_OFFSET;
+            status   = SDreaddata(sds_id, start, NULL, edges, (void *)rdata);
+            CHECK(status, FAIL, "SDreaddata");
+            if (memcmp(idata + LZ4_OFFSET * LZ4_DIM1, rdata, (size_t)edges[0] * LZ4_DIM1 * sizeof(int32)) != 0) {
+                fprintf(stderr, "test_lz4_comp: wrong data read from an offset in pass #%d\n", (int)k);
+                num_errs++;
+            }
+
+            status = SDendaccess(sds_id);
+            CHECK(status, FAIL, "SDendaccess");
+        }
+
+        status = SDend(sd_id);
+        CHECK(status, FAIL, "SDend");
+
+        free(idata);
+        free(rdata);
+    }
+#endif /* H4_HAVE_LIBLZ4 */
+
+    return num_errs;
+} /* end test_lz4_comp */
+
+/********************************************************************
+   Name: test_shuffle_comp() - writes and reads data sets with shuffled bytes
+
+   Description:
+        This function writes the same floating-point data compressed with
+        deflate, once as is and once with its bytes shuffled, the latter
+        in several writes, and a chunked data set of doubles with its
+        bytes shuffled.  It verifies that the data reads back whole and
+        from an offset, that the shuffled data set is smaller, and that
+        coders which do not take shuffled bytes are refused.
+
+   Return value:
+        The number of errors occurred in this routine.
+
+*********************************************************************/
+
+#define SHUF_FILE   "comptstshuf.hdf"
+#define SHUF_DIM0   300
+#define SHUF_DIM1   300
+#define SHUF_OFFSET 123
+
+static intn
+test_shuffle_comp()
+{
+    int32         sd_id, sds_id;
+    int32         dimsize[2], start[2], edges[2];
+    int32         comp_size[2], orig_size;
+    comp_coder_t  comp_type;
+    comp_info     cinfo;
+    HDF_CHUNK_DEF chunk_def;
+    float32      *fdata, *frdata;
+    float64      *ddata, *drdata;
+    uint32        seed = 1;
+    intn          shuffle;
+    intn          status;
+    intn          i, k;
+    intn          num_errs = 0; /* number of errors in compression test so far */
+
+    fdata  = (float32 *)malloc(SHUF_DIM0 * SHUF_DIM1 * sizeof(float32));
+    frdata = (float32 *)malloc(SHUF_DIM0 * SHUF_DIM1 * sizeof(float32));
+    ddata  = (float64 *)malloc(SHUF_DIM0 * SHUF_DIM1 * sizeof(float64));
+    drdata = (float64 *)malloc(SHUF_DIM0 * SHUF_DIM1 * sizeof(float64));
+    CHECK_ALLOC(fdata, "fdata", "test_shuffle_comp");
+    CHECK_ALLOC(frdata, "frdata", "test_shuffle_comp");
+    CHECK_ALLOC(ddata, "ddata", "test_shuffle_comp");
+    CHECK_ALLOC(drdata, "drdata", "test_shuffle_comp");
+
+    /* a smooth field with some noise, like a temperature grid */
+    for (i = 0; i < SHUF_DIM0 * SHUF_DIM1; i++) {
+        seed     = seed * 1103515245 + 12345;
+        ddata[i] = 280.0 + 0.01 * (i % SHUF_DIM1) + 0.02 * (i / SHUF_DIM1) + (double)(seed >> 24) / 4096.0;
+        fdata[i] = (float32)ddata[i];
+    }
+
+    sd_id = SDstart(SHUF_FILE, DFACC_CREATE);
+    CHECK(sd_id, FAIL, "SDstart");
+
+    dimsize[0] = SHUF_DIM0;
+    dimsize[1] = SHUF_DIM1;
+    start[0] = start[1] = 0;
+    edges[0]            = SHUF_DIM0;
+    edges[1]            = SHUF_DIM1;
+
+    /* The floats compressed as they are */
+    sds_id = SDcreate(sd_id, "Unshuffled", DFNT_FLOAT32, 2, dimsize);
+    CHECK(sds_id, FAIL, "SDcreate");
+    cinfo.deflate.level = 6;
+    status              = SDsetcompress(sds_id, COMP_CODE_DEFLATE, &cinfo);
+    CHECK(status, FAIL, "SDsetcompress");
+    status = SDwritedata(sds_id, start, NULL, edges, (void *)fdata);
+    CHECK(status, FAIL, "SDwritedata");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    /* The same floats with their bytes shuffled */
+    sds_id = SDcreate(sd_id, "Shuffled", DFNT_FLOAT32, 2, dimsize);
+    CHECK(sds_id, FAIL, "SDcreate");
+    status = SDsetshuffle(sds_id, TRUE);
+    CHECK(status, FAIL, "SDsetshuffle");
+    status = SDgetshuffle(sds_id, &shuffle);
+    CHECK(status, FAIL, "SDgetshuffle");
+    VERIFY(shuffle, TRUE, "SDgetshuffle");
+    status = SDsetcompress(sds_id, COMP_CODE_DEFLATE, &cinfo);
+    CHECK(status, FAIL, "SDsetcompress");
+    status = SDwritedata(sds_id, start, NULL, edges, (void *)fdata);
+    CHECK(status, FAIL, "SDwritedata");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    /* Doubles in chunks of a partial last block, the threads are not
+       used for shuffled chunks but must not get in the way */
+    sds_id = SDcreate(sd_id, "ShuffledChunked", DFNT_FLOAT64, 2, dimsize);
+    CHECK(sds_id, FAIL, "SDcreate");
+    status = SDsetshuffle(sds_id, TRUE);
+    CHECK(status, FAIL, "SDsetshuffle");
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]    = SHUF_DIM0 / 2;
+    chunk_def.comp.chunk_lengths[1]    = SHUF_DIM1 / 2;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 6;
+    status                             = SDsetchunk(sds_id, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "SDsetchunk");
+    status = SDsetchunkthreads(sds_id, 4);
+    CHECK(status, FAIL, "SDsetchunkthreads");
+    start[0] = 0;
+    edges[0] = SHUF_DIM0;
+    status   = SDwritedata(sds_id, start, NULL, edges, (void *)ddata);
+    CHECK(status, FAIL, "SDwritedata");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    /* N-bit coding does not take shuffled bytes */
+    sds_id = SDcreate(sd_id, "ShuffledNbit", DFNT_INT32, 2, dimsize);
+    CHECK(sds_id, FAIL, "SDcreate");
+    status = SDsetshuffle(sds_id, TRUE);
+    CHECK(status, FAIL, "SDsetshuffle");
+    status = SDsetnbitdataset(sds_id, 20, 21, FALSE, FALSE);
+    VERIFY(status, FAIL, "SDsetnbitdataset");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    status = SDend(sd_id);
+    CHECK(status, FAIL, "SDend");
+
+    sd_id = SDstart(SHUF_FILE, DFACC_READ);
+    CHECK(sd_id, FAIL, "SDstart");
+
+    for (k = 0; k < 3; k++) {
+        size_t esize = (k == 2) ? sizeof(float64) : sizeof(float32);
+        void  *data  = (k == 2) ? (void *)ddata : (void *)fdata;
+        void  *rdata = (k == 2) ? (void *)drdata : (void *)frdata;
+
+        sds_id = SDselect(sd_id, k);
+        CHECK(sds_id, FAIL, "SDselect");
+
+        status = SDgetshuffle(sds_id, &shuffle);
+        CHECK(status, FAIL, "SDgetshuffle");
+        VERIFY(shuffle, (k == 0 ? FALSE : TRUE), "SDgetshuffle");
+
+        comp_type = COMP_CODE_INVALID; /* reset variables before retrieving info */
+        memset(&cinfo, 0, sizeof(cinfo));
+        status = SDgetcompinfo(sds_id, &comp_type, &cinfo);
+        CHECK(status, FAIL, "SDgetcompinfo");
+        VERIFY(comp_type, COMP_CODE_DEFLATE, "SDgetcompinfo");
+        if (k < 2) {
+            status = SDgetdatasize(sds_id, &comp_size[k], &orig_size);
+            CHECK(status, FAIL, "SDgetdatasize");
+        }
+
+        /* Read the whole data set */
+        memset(rdata, 0, SHUF_DIM0 * SHUF_DIM1 * esize);
+        start[0] = 0;
+        edges[0] = SHUF_DIM0;
+        status   = SDreaddata(sds_id, start, NULL, edges, rdata);
+        CHECK(status, FAIL, "SDreaddata");
+        if (memcmp(data, rdata, SHUF_DIM0 * SHUF_DIM1 * esize) != 0) {
+            fprintf(stderr, "test_shuffle_comp: wrong data read from data set #%d\n", (int)k);
+            num_errs++;
+        }
+
+        /* Read the tail, backwards after the full read */
+        memset(rdata, 0, SHUF_DIM0 * SHUF_DIM1 * esize);
+        start[0] = SHUF_OFFSET;
+        edges[0] = SHUF_DIM0 - SHUF_OFFSET;
+        status   = SDreaddata(sds_id, start, NULL, edges, rdata);
+        CHECK(status, FAIL, "SDreaddata");
+        if (memcmp((uint8 *)data + SHUF_OFFSET * SHUF_DIM1 * esize, rdata,
+                   (size_t)edges[0] * SHUF_DIM1 * esize) != 0) {
+            fprintf(stderr, "test_shuffle_comp: wrong data read from an offset in data set #%d\n", (int)k);
+            num_errs++;
+        }
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+
+    /* the high bytes of the floats compress much better on their own */
+    if (comp_size[1] >= comp_size[0]) {
+        fprintf(stderr, "test_shuffle_comp: shuffled data takes %d bytes, %d bytes unshuffled\n",
+                (int)comp_size[1], (int)comp_size[0]);
+        num_errs++;
+    }
+
+    status = SDend(sd_id);
+    CHECK(status, FAIL, "SDend");
+
+    free(fdata);
+    free(frdata);
+    free(ddata);
+    free(drdata);
+
+    return num_errs;
+} /* end test_shuffle_comp */
+
+/********************************************************************
+   Name: test_plugin_comp() - writes and reads data sets with a coder
+                registered with HCregister_coder()
+
+   Description:
+        This function registers a coder that XORs the bytes with a key
+        kept in its parameters, and writes a contiguous data set, in two
+        writes, and a chunked one with it.  It verifies that the coder is
+        refused until it is registered, that the data and the parameters
+        read back, and that the data sets cannot be read once the coder
+        is unregistered.
+
+   Return value:
+        The number of errors occurred in this routine.
+
+*********************************************************************/
+
+#define PLUG_FILE "comptstplug.hdf"
+#define PLUG_CODE (COMP_CODE_PLUGIN_MIN + 44)
+#define PLUG_KEY  0x5a
+#define PLUG_DIM0 60
+#define PLUG_DIM1 40
+
+static int plug_inits, plug_encodes, plug_decodes;
+
+static intn
+plug_init(void)
+{
+    plug_inits++;
+    return SUCCEED;
+}
+
+static void
+plug_term(void)
+{
+    plug_inits--;
+}
+
+static int32
+plug_xor(const comp_info *c_info, const uint8 *src, int32 src_len, uint8 *dst, int32 dst_len)
+{
+    int32 i;
+
+    if (c_info->plugin.cd_nelmts != 1 || src_len > dst_len)
+        return FAIL;
+    for (i = 0; i < src_len; i++)
+        dst[i] = (uint8)(src[i] ^ c_info->plugin.cd_values[0]);
+    return src_len;
+}
+
+static int32
+plug_encode(const comp_info *c_info, const uint8 *src, int32 src_len, uint8 *dst, int32 dst_len)
+{
+    plug_encodes++;
+    return plug_xor(c_info, src, src_len, dst, dst_len);
+}
+
+static int32
+plug_decode(const comp_info *c_info, const uint8 *src, int32 src_len, uint8 *dst, int32 dst_len)
+{
+    plug_decodes++; /* not exact with worker threads, only tested for zero */
+    return plug_xor(c_info, src, src_len, dst, dst_len);
+}
+
+static intn
+test_plugin_comp()
+{
+    hdf_coder_plugin_t plugin;
+    HDF_CHUNK_DEF      chunk_def;
+    int32              sd_id, sds_id;
+    int32              dimsize[2], start[2], edges[2];
+    int32             *idata, *rdata;
+    comp_coder_t       comp_type;
+    comp_info          cinfo;
+    uint32             comp_config;
+    intn               status;
+    intn               i, k;
+    intn               num_errs = 0; /* number of errors in compression test so far */
+
+    idata = (int32 *)malloc(PLUG_DIM0 * PLUG_DIM1 * sizeof(int32));
+    rdata = (int32 *)malloc(PLUG_DIM0 * PLUG_DIM1 * sizeof(int32));
+    CHECK_ALLOC(idata, "idata", "test_plugin_comp");
+    CHECK_ALLOC(rdata, "rdata", "test_plugin_comp");
+    for (i = 0; i < PLUG_DIM0 * PLUG_DIM1; i++)
+        idata[i] = i * 7;
+
+    memset(&plugin, 0, sizeof(plugin));
+    plugin.id     = PLUG_CODE;
+    plugin.name   = "xor";
+    plugin.init   = plug_init;
+    plugin.term   = plug_term;
+    plugin.encode = plug_encode;
+    plugin.decode = plug_decode;
+
+    /* Unknown until registered */
+    status = HCget_config_info(PLUG_CODE, &comp_config);
+    VERIFY(status, FAIL, "HCget_config_info");
+    VERIFY(comp_config, 0, "HCget_config_info");
+
+    sd_id = SDstart(PLUG_FILE, DFACC_CREATE);
+    CHECK(sd_id, FAIL, "SDstart");
+    dimsize[0] = PLUG_DIM0;
+    dimsize[1] = PLUG_DIM1;
+    sds_id     = SDcreate(sd_id, "PluginContiguous", DFNT_INT32, 2, dimsize);
+    CHECK(sds_id, FAIL, "SDcreate");
+
+    memset(&cinfo, 0, sizeof(cinfo));
+    cinfo.plugin.cd_nelmts    = 1;
+    cinfo.plugin.cd_values[0] = PLUG_KEY;
+    status                    = SDsetcompress(sds_id, PLUG_CODE, &cinfo);
+    VERIFY(status, FAIL, "SDsetcompress");
+
+    /* Types below the plugin range are refused, as is a second coder with
+       the same type */
+    plugin.id = COMP_CODE_PLUGIN_MIN - 1;
+    status    = HCregister_coder(&plugin);
+    VERIFY(status, FAIL, "HCregister_coder");
+    plugin.id = PLUG_CODE;
+    status    = HCregister_coder(&plugin);
+    CHECK(status, FAIL, "HCregister_coder");
+    status = HCregister_coder(&plugin);
+    VERIFY(status, FAIL, "HCregister_coder");
+    VERIFY(plug_inits, 1, "HCregister_coder");
+
+    status = HCget_config_info(PLUG_CODE, &comp_config);
+    CHECK(status, FAIL, "HCget_config_info");
+    VERIFY(comp_config, (COMP_DECODER_ENABLED | COMP_ENCODER_ENABLED), "HCget_config_info");
+
+    /* Contiguous, written in two halves */
+    status = SDsetcompress(sds_id, PLUG_CODE, &cinfo);
+    CHECK(status, FAIL, "SDsetcompress");
+    start[0] = start[1] = 0;
+    edges[0]            = PLUG_DIM0 / 2;
+    edges[1]            = PLUG_DIM1;
+    status              = SDwritedata(sds_id, start, NULL, edges, (void *)idata);
+    CHECK(status, FAIL, "SDwritedata");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    sds_id = SDselect(sd_id, 0);
+    CHECK(sds_id, FAIL, "SDselect");
+    start[0] = PLUG_DIM0 / 2;
+    status   = SDwritedata(sds_id, start, NULL, edges, (void *)(idata + PLUG_DIM0 / 2 * PLUG_DIM1));
+    CHECK(status, FAIL, "SDwritedata");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    /* Chunked, the chunks decoded on 4 threads when the library can */
+    sds_id = SDcreate(sd_id, "PluginChunked", DFNT_INT32, 2, dimsize);
+    CHECK(sds_id, FAIL, "SDcreate");
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0] = PLUG_DIM0 / 3;
+    chunk_def.comp.chunk_lengths[1] = PLUG_DIM1 / 2;
+    chunk_def.comp.comp_type        = PLUG_CODE;
+    chunk_def.comp.cinfo            = cinfo;
+    status                          = SDsetchunk(sds_id, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "SDsetchunk");
+    start[0] = 0;
+    edges[0] = PLUG_DIM0;
+    status   = SDwritedata(sds_id, start, NULL, edges, (void *)idata);
+    CHECK(status, FAIL, "SDwritedata");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    status = SDend(sd_id);
+    CHECK(status, FAIL, "SDend");
+    if (plug_encodes == 0) {
+        fprintf(stderr, "test_plugin_comp: the coder did not encode\n");
+        num_errs++;
+    }
+
+    sd_id = SDstart(PLUG_FILE, DFACC_READ);
+    CHECK(sd_id, FAIL, "SDstart");
+    for (k = 0; k < 2; k++) {
+        sds_id = SDselect(sd_id, k);
+        CHECK(sds_id, FAIL, "SDselect");
+        if (k == 1) {
+            status = SDsetchunkthreads(sds_id, 4);
+            CHECK(status, FAIL, "SDsetchunkthreads");
+        }
+
+        comp_type = COMP_CODE_INVALID; /* reset variables before retrieving info */
+        memset(&cinfo, 0, sizeof(cinfo));
+        status = SDgetcompinfo(sds_id, &comp_type, &cinfo);
+        CHECK(status, FAIL, "SDgetcompinfo");
+        VERIFY(comp_type, PLUG_CODE, "SDgetcompinfo");
+        VERIFY(cinfo.plugin.cd_nelmts, 1, "SDgetcompinfo");
+        VERIFY(cinfo.plugin.cd_values[0], PLUG_KEY, "SDgetcompinfo");
+
+        plug_decodes = 0;
+        memset(rdata, 0, PLUG_DIM0 * PLUG_DIM1 * sizeof(int32));
+        status = SDreaddata(sds_id, start, NULL, edges, (void *)rdata);
+        CHECK(status, FAIL, "SDreaddata");
+        if (memcmp(idata, rdata, PLUG_DIM0 * PLUG_DIM1 * sizeof(int32)) != 0) {
+            fprintf(stderr, "test_plugin_comp: wrong data read from data set #%d\n", (int)k);
+            num_errs++;
+        }
+        if (plug_decodes == 0) {
+            fprintf(stderr, "test_plugin_comp: the coder did not decode data set #%d\n", (int)k);
+            num_errs++;
+        }
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+
+    /* Without the coder the data cannot be read */
+    status = HCunregister_coder(PLUG_CODE);
+    CHECK(status, FAIL, "HCunregister_coder");
+    VERIFY(plug_inits, 0, "HCunregister_coder");
+    status = HCunregister_coder(PLUG_CODE);
+    VERIFY(status, FAIL, "HCunregister_coder");
+
+    sds_id = SDselect(sd_id, 1);
+    CHECK(sds_id, FAIL, "SDselect");
+    status = SDreaddata(sds_id, start, NULL, edges, (void *)rdata);
+    VERIFY(status, FAIL, "SDreaddata");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    status = SDend(sd_id);
+    CHECK(status, FAIL, "SDend");
+
+    free(idata);
+    free(rdata);
+
+    return num_errs;
+} /* end test_plugin_comp */
+
+/********************************************************************
+   Name: test_lossy_comp() - writes and reads data sets with the lossy
+                coder
+
+   Description:
+        This function writes a smooth float32 field, contiguous with an
+        absolute error bound and chunked with a relative one, and checks
+        that every value read back is within the bound, that a NaN is kept
+        and that the data is smaller than the input.  It also checks that
+        the coder is refused for integer data sets.
+
+   Return value:
+        The number of errors occurred in this routine.
+
+*********************************************************************/
+
+#define LOSSY_FILE "comptstlossy.hdf"
+#define LOSSY_DIM0 80
+#define LOSSY_DIM1 50
+#define LOSSY_TOL  0.01
+
+static intn
+test_lossy_comp()
+{
+    HDF_CHUNK_DEF    chunk_def;
+    int32            sd_id, sds_id;
+    int32            dimsize[2], start[2], edges[2];
+    int32            comp_size, orig_size;
+    float32         *idata, *rdata;
+    float64          bound, err;
+    volatile float64 zero;
+    comp_coder_t     comp_type;
+    comp_info        cinfo;
+    uint32           comp_config;
+    intn             status;
+    intn             i, k;
+    intn             num_errs = 0; /* number of errors in compression test so far */
+
+    idata = (float32 *)malloc(LOSSY_DIM0 * LOSSY_DIM1 * sizeof(float32));
+    rdata = (float32 *)malloc(LOSSY_DIM0 * LOSSY_DIM1 * sizeof(float32));
+    CHECK_ALLOC(idata, "idata", "test_lossy_comp");
+    CHECK_ALLOC(rdata, "rdata", "test_lossy_comp");
+    for (i = 0; i < LOSSY_DIM0 * LOSSY_DIM1; i++)
+        idata[i] = (float32)((i / LOSSY_DIM1) * 1.5 + (i % LOSSY_DIM1) / 3.0 + ((i * 7) % 11) * 0.001);
+    zero      = 0.0;
+    idata[17] = (float32)(zero / zero);
+
+    status = HCget_config_info(COMP_CODE_LOSSY, &comp_config);
+    CHECK(status, FAIL, "HCget_config_info");
+    VERIFY(comp_config, (COMP_DECODER_ENABLED | COMP_ENCODER_ENABLED), "HCget_config_info");
+
+    sd_id = SDstart(LOSSY_FILE, DFACC_CREATE);
+    CHECK(sd_id, FAIL, "SDstart");
+    dimsize[0] = LOSSY_DIM0;
+    dimsize[1] = LOSSY_DIM1;
+    start[0] = start[1] = 0;
+    edges[0]            = LOSSY_DIM0;
+    edges[1]            = LOSSY_DIM1;
+
+    /* Integer data cannot be compressed lossily */
+    sds_id = SDcreate(sd_id, "LossyInt", DFNT_INT32, 2, dimsize);
+    CHECK(sds_id, FAIL, "SDcreate");
+    memset(&cinfo, 0, sizeof(cinfo));
+    cinfo.lossy.mode      = H4_LOSSY_ABS;
+    cinfo.lossy.tolerance = LOSSY_TOL;
+    status                = SDsetcompress(sds_id, COMP_CODE_LOSSY, &cinfo);
+    VERIFY(status, FAIL, "SDsetcompress");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    /* Contiguous, absolute bound */
+    sds_id = SDcreate(sd_id, "LossyContiguous", DFNT_FLOAT32, 2, dimsize);
+    CHECK(sds_id, FAIL, "SDcreate");
+    cinfo.lossy.tolerance = -1.0;
+    status                = SDsetcompress(sds_id, COMP_CODE_LOSSY, &cinfo);
+    VERIFY(status, FAIL, "SDsetcompress");
+    cinfo.lossy.tolerance = LOSSY_TOL;
+    status                = SDsetcompress(sds_id, COMP_CODE_LOSSY, &cinfo);
+    CHECK(status, FAIL, "SDsetcompress");
+    status = SDwritedata(sds_id, start, NULL, edges, (void *)idata);
+    CHECK(status, FAIL, "SDwritedata");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    /* Chunked, relative bound */
+    sds_id = SDcreate(sd_id, "LossyChunked", DFNT_FLOAT32, 2, dimsize);
+    CHECK(sds_id, FAIL, "SDcreate");
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]      = LOSSY_DIM0 / 4;
+    chunk_def.comp.chunk_lengths[1]      = LOSSY_DIM1;
+    chunk_def.comp.comp_type             = COMP_CODE_LOSSY;
+    chunk_def.comp.cinfo.lossy.mode      = H4_LOSSY_REL;
+    chunk_def.comp.cinfo.lossy.tolerance = LOSSY_TOL / 100.0;
+    status                               = SDsetchunk(sds_id, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "SDsetchunk");
+    status = SDwritedata(sds_id, start, NULL, edges, (void *)idata);
+    CHECK(status, FAIL, "SDwritedata");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    status = SDend(sd_id);
+    CHECK(status, FAIL, "SDend");
+
+    sd_id = SDstart(LOSSY_FILE, DFACC_READ);
+    CHECK(sd_id, FAIL, "SDstart");
+    for (k = 1; k < 3; k++) {
+        sds_id = SDselect(sd_id, k);
+        CHECK(sds_id, FAIL, "SDselect");
+
+        comp_type = COMP_CODE_INVALID; /* reset variables before retrieving info */
+        memset(&cinfo, 0, sizeof(cinfo));
+        status = SDgetcompinfo(sds_id, &comp_type, &cinfo);
+        CHECK(status, FAIL, "SDgetcompinfo");
+        VERIFY(comp_type, COMP_CODE_LOSSY, "SDgetcompinfo");
+        VERIFY(cinfo.lossy.mode, (k == 1 ? H4_LOSSY_ABS : H4_LOSSY_REL), "SDgetcompinfo");
+        VERIFY(cinfo.lossy.nt, DFNT_FLOAT32, "SDgetcompinfo");
+
+        /* The relative bound is a fraction of the range of the chunk, at
+           most the range of the whole data set */
+        bound = (k == 1) ? LOSSY_TOL : cinfo.lossy.tolerance * 140.0;
+
+        memset(rdata, 0, LOSSY_DIM0 * LOSSY_DIM1 * sizeof(float32));
+        status = SDreaddata(sds_id, start, NULL, edges, (void *)rdata);
+        CHECK(status, FAIL, "SDreaddata");
+        if (!(rdata[17] != rdata[17])) {
+            fprintf(stderr, "test_lossy_comp: NaN not kept in data set #%d\n", (int)k);
+            num_errs++;
+        }
+        for (i = 0; i < LOSSY_DIM0 * LOSSY_DIM1; i++) {
+            err = (float64)rdata[i] - (float64)idata[i];
+            if (i != 17 && !(err <= bound && -err <= bound)) {
+                fprintf(stderr, "test_lossy_comp: value %d of data set #%d off by %g\n", (int)i, (int)k, err);
+                num_errs++;
+                break;
+            }
+        }
+
+        status = SDgetdatasize(sds_id, &comp_size, &orig_size);
+        CHECK(status, FAIL, "SDgetdatasize");
+        if (comp_size >= orig_size / 2) {
+            fprintf(stderr, "test_lossy_comp: data set #%d only compressed to %d of %d bytes\n", (int)k,
+                    (int)comp_size, (int)orig_size);
+            num_errs++;
+        }
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+
+    status = SDend(sd_id);
+    CHECK(status, FAIL, "SDend");
+
+    free(idata);
+    free(rdata);
+
+    return num_errs;
+} /* end test_lossy_comp */
+
 extern int
 test_compression()
 {
@@ -840,6 +1771,21 @@ test_compression()
     /* test writing and reading data sets with compression */
     num_errs = num_errs + test_compressed_data();
 
+    /* test the zstd coder, or that it is refused without the library */
+    num_errs = num_errs + test_zstd_comp();
+
+    /* test the LZ4 coder, or that it is refused without the library */
+    num_errs = num_errs + test_lz4_comp();
+
+    /* test shuffling the bytes of the elements before compressing them */
+    num_errs = num_errs + test_shuffle_comp();
+
+    /* test a coder registered by the application */
+    num_errs = num_errs + test_plugin_comp();
+
+    /* test the error-bounded lossy coder */
+    num_errs = num_errs + test_lossy_comp();
+
     if (num_errs == 0)
         PASSED();
 
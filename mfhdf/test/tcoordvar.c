@@ -615,6 +615,160 @@ test_named_vars(void)
     return num_errs;
 } /* test_named_vars */
 
+/********************************************************************
+   Name: test_many_named_vars() - tests name lookups among many variables
+                                  and attributes
+
+   Description:
+        Name lookups in arrays of 16 or more elements go through a hash
+        table that is built on the first lookup and kept up to date as
+        elements are added.  This test creates enough data sets with
+        repeated names, before and after the first lookup, to go past
+        the table's load limit, then verifies SDnametoindex,
+        SDnametoindices, SDgetnumvars_byname and ncvarid after a rename
+        through the netCDF API, and SDfindattr on a data set with many
+        attributes.
+
+   Return value:
+        The number of errors occurred in this routine.
+
+*********************************************************************/
+
+#define N_NAMES      4
+#define N_FIRST_VARS 24 /* created before the first lookup */
+#define N_MORE_VARS  16 /* all named as the first one, after the first lookup */
+#define N_MANY_ATTRS 20
+#define FILE4        "vars_manynames.hdf"
+
+static intn
+test_many_named_vars(void)
+{
+    char           name[20];
+    int32          dimsize[1] = {3};
+    int32          file_id, sds_id;
+    int32          n_vars, attr_val, idx32;
+    int            cdfid, varid;
+    intn           status, ii;
+    hdf_varlist_t *allvars;
+    intn           num_errs = 0; /* number of errors so far */
+
+    file_id = SDstart(FILE4, DFACC_CREATE);
+    CHECK(file_id, FAIL, "SDstart");
+
+    /* Variable i is named "var <i % N_NAMES>" */
+    for (ii = 0; ii < N_FIRST_VARS; ii++) {
+        snprintf(name, sizeof(name), "var %d", ii % N_NAMES);
+        sds_id = SDcreate(file_id, name, DFNT_INT32, 1, dimsize);
+        CHECK(sds_id, FAIL, "SDcreate");
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+
+    idx32 = SDnametoindex(file_id, "var 2");
+    VERIFY(idx32, 2, "SDnametoindex");
+
+    /* These go into the index built by the lookup above, then past its limit */
+    for (ii = 0; ii < N_MORE_VARS; ii++) {
+        sds_id = SDcreate(file_id, "var 0", DFNT_INT32, 1, dimsize);
+        CHECK(sds_id, FAIL, "SDcreate");
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+
+        status = SDgetnumvars_byname(file_id, "var 0", &n_vars);
+        CHECK(status, FAIL, "SDgetnumvars_byname");
+        VERIFY(n_vars, N_FIRST_VARS / N_NAMES + ii + 1, "SDgetnumvars_byname");
+    }
+
+    idx32 = SDnametoindex(file_id, "var 3");
+    VERIFY(idx32, 3, "SDnametoindex");
+    idx32 = SDnametoindex(file_id, "var 4");
+    VERIFY(idx32, FAIL, "SDnametoindex");
+
+    /* The indices of all the "var 0" come in increasing order */
+    allvars = (hdf_varlist_t *)malloc((N_FIRST_VARS / N_NAMES + N_MORE_VARS) * sizeof(hdf_varlist_t));
+    status  = SDnametoindices(file_id, "var 0", allvars);
+    CHECK(status, FAIL, "SDnametoindices");
+    for (ii = 0; ii < N_FIRST_VARS / N_NAMES; ii++)
+        VERIFY(allvars[ii].var_index, ii * N_NAMES, "SDnametoindices");
+    for (ii = 0; ii < N_MORE_VARS; ii++)
+        VERIFY(allvars[N_FIRST_VARS / N_NAMES + ii].var_index, N_FIRST_VARS + ii, "SDnametoindices");
+    free(allvars);
+
+    /* Give the last data set many attributes */
+    sds_id = SDselect(file_id, N_FIRST_VARS + N_MORE_VARS - 1);
+    CHECK(sds_id, FAIL, "SDselect");
+    for (ii = 0; ii < N_MANY_ATTRS; ii++) {
+        snprintf(name, sizeof(name), "attr %d", ii);
+        attr_val = ii;
+        status   = SDsetattr(sds_id, name, DFNT_INT32, 1, &attr_val);
+        CHECK(status, FAIL, "SDsetattr");
+    }
+    for (ii = N_MANY_ATTRS - 1; ii >= 0; ii--) {
+        snprintf(name, sizeof(name), "attr %d", ii);
+        idx32 = SDfindattr(sds_id, name);
+        VERIFY(idx32, ii, "SDfindattr");
+    }
+    idx32 = SDfindattr(sds_id, "attr");
+    VERIFY(idx32, FAIL, "SDfindattr");
+
+    /* Resetting an attribute must not add a second one of the same name */
+    attr_val = -1;
+    status   = SDsetattr(sds_id, "attr 7", DFNT_INT32, 1, &attr_val);
+    CHECK(status, FAIL, "SDsetattr");
+    idx32 = SDfindattr(sds_id, "attr 7");
+    VERIFY(idx32, 7, "SDfindattr");
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+
+    /* Rename the first "var 1" through the netCDF API */
+    cdfid = ncopen(FILE4, NC_RDWR);
+    CHECK(cdfid, -1, "ncopen");
+    varid = ncvarid(cdfid, "var 1");
+    VERIFY(varid, 1, "ncvarid");
+    status = ncvarrename(cdfid, varid, "var 3");
+    VERIFY(status, -1, "ncvarrename"); /* name in use */
+    status = ncvarrename(cdfid, varid, "var 9");
+    VERIFY(status, varid, "ncvarrename");
+    varid = ncvarid(cdfid, "var 9");
+    VERIFY(varid, 1, "ncvarid");
+    varid = ncvarid(cdfid, "var 1");
+    VERIFY(varid, 1 + N_NAMES, "ncvarid");
+    status = ncclose(cdfid);
+    CHECK(status, -1, "ncclose");
+
+    /* Everything is found again in the file as written */
+    file_id = SDstart(FILE4, DFACC_READ);
+    CHECK(file_id, FAIL, "SDstart");
+
+    idx32 = SDnametoindex(file_id, "var 9");
+    VERIFY(idx32, 1, "SDnametoindex");
+    status = SDgetnumvars_byname(file_id, "var 1", &n_vars);
+    CHECK(status, FAIL, "SDgetnumvars_byname");
+    VERIFY(n_vars, N_FIRST_VARS / N_NAMES - 1, "SDgetnumvars_byname");
+    status = SDgetnumvars_byname(file_id, "var 0", &n_vars);
+    CHECK(status, FAIL, "SDgetnumvars_byname");
+    VERIFY(n_vars, N_FIRST_VARS / N_NAMES + N_MORE_VARS, "SDgetnumvars_byname");
+
+    sds_id = SDselect(file_id, N_FIRST_VARS + N_MORE_VARS - 1);
+    CHECK(sds_id, FAIL, "SDselect");
+    for (ii = 0; ii < N_MANY_ATTRS; ii++) {
+        snprintf(name, sizeof(name), "attr %d", ii);
+        idx32 = SDfindattr(sds_id, name);
+        VERIFY(idx32, ii, "SDfindattr");
+    }
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+
+    /* Return the number of errors that's been kept track of so far */
+    return num_errs;
+} /* test_many_named_vars */
+
 /* Test driver for testing various coordinate variable features. */
 extern int
 test_coordvar()
@@ -628,6 +782,7 @@ test_coordvar()
     num_errs = num_errs + test_dim1_SDS1();
     num_errs = num_errs + test_dim1_SDS2();
     num_errs = num_errs + test_named_vars();
+    num_errs = num_errs + test_many_named_vars();
 
     if (num_errs == 0)
         PASSED();
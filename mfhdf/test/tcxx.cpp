@@ -0,0 +1,207 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/********************************************************************
+ * tcxx.cpp - tests the C++ layer of mfhdf.hpp
+ *    test_sd    - datasets: typed reads and writes, slabs, type checks
+ *    test_chunk - pinned chunk views and the chunks in storage order
+ *    test_v_gr  - vdata fields and GR images through an hdf_file
+ *********************************************************************/
+
+#include <array>
+#include <cstdio>
+#include <numeric>
+#include <vector>
+
+#include "mfhdf.hpp"
+
+#define CXX_FILE "tcxx.hdf"
+#define NROWS    6
+#define NCOLS    4
+
+static int num_errs = 0;
+
+#define VERIFY(cond, what)                                                                                   \
+    do {                                                                                                     \
+        if (!(cond)) {                                                                                       \
+            std::fprintf(stderr, "*** %s failed at line %d: %s\n", what, __LINE__, #cond);                 \
+            num_errs++;                                                                                      \
+        }                                                                                                    \
+    } while (0)
+
+static void
+test_sd()
+{
+    std::vector<float> data(NROWS * NCOLS);
+
+    std::iota(data.begin(), data.end(), 0.0f);
+    {
+        hdf4::sd_file   file = hdf4::sd_file::open(CXX_FILE, DFACC_CREATE);
+        hdf4::dataset   sds  = file.create<float>("floats", {NROWS, NCOLS});
+        hdf4::slab      all{{0, 0}, {NROWS, NCOLS}, {}};
+        hdf4::dataset   moved;
+        bool            refused = false;
+
+        sds.write(all, data);
+
+        /* a handle moves, and the one moved from holds nothing */
+        moved = std::move(sds);
+        VERIFY(sds.id() == FAIL && moved.id() != FAIL, "move");
+
+        /* an int32 dataset cannot be written with floats */
+        hdf4::dataset ints = file.create<int32>("ints", {NROWS});
+        try {
+            ints.write(hdf4::slab{{0}, {NROWS}, {}}, data.data(), NROWS);
+        }
+        catch (const std::invalid_argument &) {
+            refused = true;
+        }
+        VERIFY(refused, "write of the wrong type");
+    } /* everything is ended here */
+
+    hdf4::sd_file file = hdf4::sd_file::open(CXX_FILE, DFACC_READ);
+    hdf4::dataset sds  = file.select("floats");
+
+    hdf4::dataset::info_t info = sds.info();
+    VERIFY(info.name == "floats" && info.dims.size() == 2 && info.nt == DFNT_FLOAT32, "info");
+    VERIFY(file.info().first == 2, "file info");
+
+    std::vector<float> whole = sds.read<float>();
+    VERIFY(whole == data, "read of the whole dataset");
+
+    /* a strided slab into a fixed-size array */
+    std::array<float, 3> column;
+    sds.read(hdf4::slab{{0, 1}, {3, 1}, {2, 1}}, column);
+    VERIFY(column[0] == 1 && column[1] == 9 && column[2] == 17, "strided read");
+
+    /* wrong type, short buffer and unknown name */
+    int caught = 0;
+    try {
+        (void)sds.read<double>();
+    }
+    catch (const std::invalid_argument &) {
+        caught++;
+    }
+    try {
+        std::array<float, 2> small;
+        sds.read(hdf4::slab{{0, 0}, {1, 3}, {}}, small);
+    }
+    catch (const std::invalid_argument &) {
+        caught++;
+    }
+    try {
+        (void)file.select("no such dataset");
+    }
+    catch (const hdf4::error &) {
+        caught++;
+    }
+    VERIFY(caught == 3, "errors");
+}
+
+static void
+test_chunk()
+{
+    std::vector<int32> data(NROWS * NCOLS);
+
+    std::iota(data.begin(), data.end(), 100);
+    {
+        hdf4::sd_file  file = hdf4::sd_file::open(CXX_FILE, DFACC_WRITE);
+        hdf4::dataset  sds  = file.create<int32>("chunked", {NROWS, NCOLS});
+        HDF_CHUNK_DEF  def;
+
+        def.chunk_lengths[0] = 2;
+        def.chunk_lengths[1] = NCOLS;
+        VERIFY(SDsetchunk(sds.id(), def, HDF_CHUNK) != FAIL, "SDsetchunk");
+        sds.write(hdf4::slab{{0, 0}, {NROWS, NCOLS}, {}}, data);
+    }
+
+    hdf4::sd_file file = hdf4::sd_file::open(CXX_FILE, DFACC_READ);
+    hdf4::dataset sds  = file.select("chunked");
+
+    /* one chunk, seen in place */
+    {
+        hdf4::chunk_view<int32> view = sds.chunk<int32>({1, 0});
+        VERIFY(view.size() == 2 * NCOLS, "chunk size");
+        VERIFY(view[0] == 100 + 2 * NCOLS, "chunk values");
+    }
+
+    /* all of them, in storage order */
+    long sum    = 0;
+    int  nchunk = 0;
+    for (const hdf4::chunk_view<int32> &view : sds.chunks<int32>()) {
+        for (int32 value : view)
+            sum += value;
+        nchunk++;
+    }
+    VERIFY(nchunk == NROWS / 2, "number of chunks");
+    VERIFY(sum == std::accumulate(data.begin(), data.end(), 0L), "sum of the chunks");
+}
+
+static void
+test_v_gr()
+{
+    const uint16 values[NROWS] = {3, 1, 4, 1, 5, 9};
+    uint8        image[NROWS][NCOLS];
+
+    for (int i = 0; i < NROWS; i++)
+        for (int j = 0; j < NCOLS; j++)
+            image[i][j] = (uint8)(10 * i + j);
+
+    /* written with the C interfaces */
+    {
+        hdf4::hdf_file file = hdf4::hdf_file::open(CXX_FILE, DFACC_WRITE);
+        int32          dims[2] = {NCOLS, NROWS}, start[2] = {0, 0};
+        int32          riid;
+
+        VERIFY(VHstoredata(file.id(), "Value", (const uint8 *)values, NROWS, DFNT_UINT16, "cxx vdata",
+                           "cxx class") != FAIL,
+               "VHstoredata");
+
+        hdf4::gr_interface gr = file.gr();
+        riid                  = GRcreate(gr.id(), "cxx image", 1, DFNT_UINT8, MFGR_INTERLACE_PIXEL, dims);
+        VERIFY(riid != FAIL, "GRcreate");
+        hdf4::gr_image ri(riid);
+        VERIFY(GRwriteimage(ri.id(), start, NULL, dims, image) != FAIL, "GRwriteimage");
+    }
+
+    hdf4::hdf_file file = hdf4::hdf_file::open(CXX_FILE, DFACC_READ);
+    hdf4::vdata    vd   = file.attach_vdata(std::string("cxx vdata"));
+
+    VERIFY(vd.size() == NROWS, "vdata size");
+    std::vector<uint16> all = vd.read_field<uint16>("Value");
+    VERIFY(all.size() == NROWS && all[5] == 9, "vdata field");
+    std::vector<uint16> some = vd.read_field<uint16>("Value", 2, 3);
+    VERIFY(some.size() == 3 && some[0] == 4 && some[2] == 5, "vdata records");
+
+    hdf4::gr_interface gr = file.gr();
+    hdf4::gr_image     ri = gr.select("cxx image");
+    std::vector<uint8> pixels = ri.read<uint8>();
+    VERIFY(pixels.size() == NROWS * NCOLS && pixels[NCOLS + 2] == 12, "image");
+}
+
+int
+main()
+{
+    try {
+        test_sd();
+        test_chunk();
+        test_v_gr();
+    }
+    catch (const std::exception &err) {
+        std::fprintf(stderr, "*** unexpected exception: %s\n", err.what());
+        num_errs++;
+    }
+
+    if (num_errs == 0)
+        std::printf("C++ API test passes\n");
+    return num_errs == 0 ? 0 : 1;
+}
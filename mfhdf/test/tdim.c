@@ -17,6 +17,10 @@
  *    test_dim_basics - tests basic dimension operations
  *    test_dim_scales - tests basic dimension scale operations
  *    test_dim_strs   - tests SDsetdimstrs and SDgetdimstrs
+ *    test_dim_scale_cache - tests that repeated SDgetdimscale calls see
+ *                      the scale values written in between
+ *    test_create_many - tests SDcreate_many and the dimensions shared by
+ *                      the datasets it creates
  *
  *********************************************************************/
 
@@ -751,6 +755,284 @@ test_dim_strs()
 
 } /* test_dim_strs */
 
+/********************************************************************
+   Name: test_dim_scale_cache()
+
+   Description:
+        SDgetdimscale keeps the values it read, this test routine checks
+        that they are not returned once the scale has changed.
+        The main contents include:
+        - creates a dataset with a fixed and an unlimited dimension
+        - reads the scale of each twice, then rewrites it with
+          SDsetdimscale, with another number type, and through the
+          coordinate variable itself, reading it back after each write
+        - renames a dimension, which then has no scale
+
+   Return value:
+        The number of errors occurred in this routine.
+
+*********************************************************************/
+#define CACHE_FILE "scalecache.hdf" /* file to test the scale cache */
+#define CACHE_DS   "Cached Data"
+#define CACHE_LEN  5 /* length of the fixed dimension */
+#define CACHE_RECS 3 /* initial length of the unlimited dimension */
+
+static intn
+test_dim_scale_cache()
+{
+    int32   fid, sds_id, crd_id, dim0_id, dim1_id, crd_idx, status;
+    int32   dims[2], start[2], edges[2];
+    int32   size, dim_data_type, dim_num_attrs;
+    int32   scale0[CACHE_LEN]  = {10, 20, 30, 40, 50};
+    int32   scale1[CACHE_RECS] = {1, 2, 3};
+    int32   more1[2]           = {4, 5};
+    int32   data[CACHE_RECS][CACHE_LEN];
+    int32   out[CACHE_LEN];
+    float32 scalef[CACHE_LEN] = {0.5, 1.5, 2.5, 3.5, 4.5}, outf[CACHE_LEN];
+    char    dim_name[H4_MAX_NC_NAME];
+    intn    i, j;
+    int     num_errs = 0; /* number of errors so far */
+
+    fid = SDstart(CACHE_FILE, DFACC_CREATE);
+    CHECK(fid, FAIL, "SDstart");
+
+    /* a dataset with an unlimited first dimension */
+    dims[0] = SD_UNLIMITED;
+    dims[1] = CACHE_LEN;
+    sds_id  = SDcreate(fid, CACHE_DS, DFNT_INT32, 2, dims);
+    CHECK(sds_id, FAIL, "SDcreate");
+
+    for (j = 0; j < CACHE_RECS; j++)
+        for (i = 0; i < CACHE_LEN; i++)
+            data[j][i] = j * CACHE_LEN + i;
+    start[0] = start[1] = 0;
+    edges[0]            = CACHE_RECS;
+    edges[1]            = CACHE_LEN;
+    status              = SDwritedata(sds_id, start, NULL, edges, (void *)data);
+    CHECK(status, FAIL, "SDwritedata");
+
+    dim0_id = SDgetdimid(sds_id, 0);
+    CHECK(dim0_id, FAIL, "SDgetdimid");
+    status = SDsetdimname(dim0_id, "time");
+    CHECK(status, FAIL, "SDsetdimname");
+    status = SDsetdimscale(dim0_id, CACHE_RECS, DFNT_INT32, scale1);
+    CHECK(status, FAIL, "SDsetdimscale");
+
+    dim1_id = SDgetdimid(sds_id, 1);
+    CHECK(dim1_id, FAIL, "SDgetdimid");
+    status = SDsetdimname(dim1_id, "lon");
+    CHECK(status, FAIL, "SDsetdimname");
+    status = SDsetdimscale(dim1_id, CACHE_LEN, DFNT_INT32, scale0);
+    CHECK(status, FAIL, "SDsetdimscale");
+
+    /* the second read is served from memory, and must be the same */
+    for (j = 0; j < 2; j++) {
+        memset(out, 0, sizeof(out));
+        status = SDgetdimscale(dim1_id, (void *)out);
+        CHECK(status, FAIL, "SDgetdimscale");
+        for (i = 0; i < CACHE_LEN; i++)
+            VERIFY(out[i], scale0[i], "SDgetdimscale");
+    }
+
+    /* rewrite the scale with other values */
+    for (i = 0; i < CACHE_LEN; i++)
+        scale0[i] = -scale0[i];
+    status = SDsetdimscale(dim1_id, CACHE_LEN, DFNT_INT32, scale0);
+    CHECK(status, FAIL, "SDsetdimscale");
+    status = SDgetdimscale(dim1_id, (void *)out);
+    CHECK(status, FAIL, "SDgetdimscale");
+    for (i = 0; i < CACHE_LEN; i++)
+        VERIFY(out[i], scale0[i], "SDgetdimscale");
+
+    /* and with another number type */
+    status = SDsetdimscale(dim1_id, CACHE_LEN, DFNT_FLOAT32, scalef);
+    CHECK(status, FAIL, "SDsetdimscale");
+    status = SDdiminfo(dim1_id, dim_name, &size, &dim_data_type, &dim_num_attrs);
+    CHECK(status, FAIL, "SDdiminfo");
+    VERIFY(dim_data_type, DFNT_FLOAT32, "SDdiminfo");
+    status = SDgetdimscale(dim1_id, (void *)outf);
+    CHECK(status, FAIL, "SDgetdimscale");
+    for (i = 0; i < CACHE_LEN; i++)
+        VERIFY(outf[i], scalef[i], "SDgetdimscale");
+
+    /* the scale of the unlimited dimension, then extended by writing
+       the coordinate variable itself */
+    status = SDgetdimscale(dim0_id, (void *)out);
+    CHECK(status, FAIL, "SDgetdimscale");
+    for (i = 0; i < CACHE_RECS; i++)
+        VERIFY(out[i], scale1[i], "SDgetdimscale");
+
+    crd_idx = SDnametoindex(fid, "time");
+    CHECK(crd_idx, FAIL, "SDnametoindex");
+    crd_id = SDselect(fid, crd_idx);
+    CHECK(crd_id, FAIL, "SDselect");
+    VERIFY(SDiscoordvar(crd_id), TRUE, "SDiscoordvar");
+    start[0] = CACHE_RECS;
+    edges[0] = 2;
+    status   = SDwritedata(crd_id, start, NULL, edges, (void *)more1);
+    CHECK(status, FAIL, "SDwritedata");
+    status = SDendaccess(crd_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    memset(out, 0, sizeof(out));
+    status = SDgetdimscale(dim0_id, (void *)out);
+    CHECK(status, FAIL, "SDgetdimscale");
+    for (i = 0; i < CACHE_RECS; i++)
+        VERIFY(out[i], scale1[i], "SDgetdimscale");
+    VERIFY(out[CACHE_RECS], more1[0], "SDgetdimscale");
+    VERIFY(out[CACHE_RECS + 1], more1[1], "SDgetdimscale");
+
+    /* a renamed dimension has no coordinate variable any more */
+    status = SDsetdimname(dim1_id, "lon2");
+    CHECK(status, FAIL, "SDsetdimname");
+    status = SDdiminfo(dim1_id, dim_name, &size, &dim_data_type, &dim_num_attrs);
+    CHECK(status, FAIL, "SDdiminfo");
+    VERIFY(dim_data_type, 0, "SDdiminfo");
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    return num_errs;
+
+} /* test_dim_scale_cache */
+
+/********************************************************************
+   Name: test_create_many()
+
+   Description:
+        SDcreate_many creates datasets of one shape that share their
+        dimensions.  The main contents include:
+        - creates MANY_NSDS datasets at once and writes each of them
+        - renames the first dimension through one dataset, which renames
+          it for all of them
+        - reopens the file and checks the datasets, their data and
+          dimensions, and that each dimension was written once
+
+   Return value:
+        The number of errors occurred in this routine.
+
+*********************************************************************/
+#define MANY_FILE "dimmany.hdf" /* file to test SDcreate_many */
+#define MANY_NSDS 20            /* number of datasets */
+#define MANY_LEN0 4             /* dimensions of the datasets */
+#define MANY_LEN1 3
+
+static intn
+test_create_many()
+{
+    int32       fid, file_id, dim_id, status;
+    int32       ids[MANY_NSDS];
+    int32       dims[2] = {MANY_LEN0, MANY_LEN1}, start[2] = {0, 0};
+    int32       rank, out_dims[H4_MAX_VAR_DIMS], nt, nattrs, nsds, size, dim_nt;
+    int32       data[MANY_LEN0][MANY_LEN1], out[MANY_LEN0][MANY_LEN1];
+    char        names[MANY_NSDS][16];
+    const char *name_ptrs[MANY_NSDS];
+    char        sds_name[H4_MAX_NC_NAME], dim_name[H4_MAX_NC_NAME], dim1_name[H4_MAX_NC_NAME];
+    intn        i, j, k;
+    int         num_errs = 0; /* number of errors so far */
+
+    for (k = 0; k < MANY_NSDS; k++) {
+        snprintf(names[k], sizeof(names[k]), "Many %d", (int)k);
+        name_ptrs[k] = names[k];
+    }
+
+    fid = SDstart(MANY_FILE, DFACC_CREATE);
+    CHECK(fid, FAIL, "SDstart");
+
+    /* a bad rank creates nothing */
+    status = SDcreate_many(fid, MANY_NSDS, name_ptrs, DFNT_INT32, 0, dims, ids);
+    VERIFY(status, FAIL, "SDcreate_many");
+
+    status = SDcreate_many(fid, MANY_NSDS, name_ptrs, DFNT_INT32, 2, dims, ids);
+    CHECK(status, FAIL, "SDcreate_many");
+
+    for (k = 0; k < MANY_NSDS; k++) {
+        for (i = 0; i < MANY_LEN0; i++)
+            for (j = 0; j < MANY_LEN1; j++)
+                data[i][j] = 100 * k + 10 * i + j;
+        status = SDwritedata(ids[k], start, NULL, dims, data);
+        CHECK(status, FAIL, "SDwritedata");
+    }
+
+    /* renaming the first dimension of one renames it for all */
+    dim_id = SDgetdimid(ids[0], 0);
+    CHECK(dim_id, FAIL, "SDgetdimid");
+    status = SDsetdimname(dim_id, "Rows");
+    CHECK(status, FAIL, "SDsetdimname");
+    dim_id = SDgetdimid(ids[MANY_NSDS - 1], 0);
+    CHECK(dim_id, FAIL, "SDgetdimid");
+    status = SDdiminfo(dim_id, dim_name, &size, &dim_nt, &nattrs);
+    CHECK(status, FAIL, "SDdiminfo");
+    VERIFY_CHAR(dim_name, "Rows", "SDdiminfo");
+
+    for (k = 0; k < MANY_NSDS; k++) {
+        status = SDendaccess(ids[k]);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    /* read it all back */
+    fid = SDstart(MANY_FILE, DFACC_READ);
+    CHECK(fid, FAIL, "SDstart");
+    status = SDfileinfo(fid, &nsds, &nattrs);
+    CHECK(status, FAIL, "SDfileinfo");
+    VERIFY(nsds, MANY_NSDS, "SDfileinfo");
+
+    for (k = 0; k < MANY_NSDS; k++) {
+        ids[k] = SDselect(fid, k);
+        CHECK(ids[k], FAIL, "SDselect");
+        status = SDgetinfo(ids[k], sds_name, &rank, out_dims, &nt, &nattrs);
+        CHECK(status, FAIL, "SDgetinfo");
+        VERIFY_CHAR(sds_name, names[k], "SDgetinfo");
+        VERIFY(rank, 2, "SDgetinfo");
+        VERIFY(out_dims[0], MANY_LEN0, "SDgetinfo");
+        VERIFY(out_dims[1], MANY_LEN1, "SDgetinfo");
+        VERIFY(nt, DFNT_INT32, "SDgetinfo");
+
+        status = SDreaddata(ids[k], start, NULL, dims, out);
+        CHECK(status, FAIL, "SDreaddata");
+        for (i = 0; i < MANY_LEN0; i++)
+            for (j = 0; j < MANY_LEN1; j++)
+                if (out[i][j] != 100 * k + 10 * i + j) {
+                    fprintf(stderr, "test_create_many: wrong value of dataset %d at %d,%d\n", (int)k, (int)i,
+                            (int)j);
+                    num_errs++;
+                }
+
+        /* the datasets still share their dimensions */
+        dim_id = SDgetdimid(ids[k], 0);
+        CHECK(dim_id, FAIL, "SDgetdimid");
+        status = SDdiminfo(dim_id, dim_name, &size, &dim_nt, &nattrs);
+        CHECK(status, FAIL, "SDdiminfo");
+        VERIFY_CHAR(dim_name, "Rows", "SDdiminfo");
+        dim_id = SDgetdimid(ids[k], 1);
+        CHECK(dim_id, FAIL, "SDgetdimid");
+        status = SDdiminfo(dim_id, dim_name, &size, &dim_nt, &nattrs);
+        CHECK(status, FAIL, "SDdiminfo");
+        VERIFY(size, MANY_LEN1, "SDdiminfo");
+        if (k == 0)
+            strcpy(dim1_name, dim_name);
+        VERIFY_CHAR(dim_name, dim1_name, "SDdiminfo");
+
+        status = SDendaccess(ids[k]);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    /* one Vgroup per dataset and dimension, and the file's own */
+    file_id = Hopen(MANY_FILE, DFACC_READ, 0);
+    CHECK(file_id, FAIL, "Hopen");
+    VERIFY(Hnumber(file_id, DFTAG_VG), MANY_NSDS + 2 + 1, "Hnumber");
+    status = Hclose(file_id);
+    CHECK(status, FAIL, "Hclose");
+
+    return num_errs;
+} /* test_create_many */
+
 /* Test driver for testing dimension functionality */
 extern int
 test_dimensions()
@@ -769,6 +1051,12 @@ test_dimensions()
     /* Test SD[set/get]dimstrs */
     num_errs = num_errs + test_dim_strs();
 
+    /* Test SDgetdimscale after the scale changes */
+    num_errs = num_errs + test_dim_scale_cache();
+
+    /* Test SDcreate_many and the dimensions its datasets share */
+    num_errs = num_errs + test_create_many();
+
     if (num_errs == 0)
         PASSED();
     return num_errs;
@@ -425,6 +425,226 @@ test_fileformat()
     return num_errs;
 }
 
+/********************************************************************
+   Name: test_metacache() - tests reopening files with the metadata
+                            kept by SDsetmetacache
+
+   Description:
+    The main contents include:
+    - create a file with two data sets, one with an attribute
+    - open it read-only and close it twice, checking that its metadata
+      stay counted by Hget_memory_usage() in between, and that the data
+      and attribute read the second time are right
+    - add a data set to the file and check that reopening it read-only
+      sees it
+    - check that SDsetmetacache(0) frees the metadata kept
+
+   Return value:
+    The number of errors occurred in this routine.
+
+*********************************************************************/
+
+#define FILE_META "tmetacache.hdf"
+#define META_DIM  8
+
+static intn
+meta_read(int32 nsds_expected, int32 *buf)
+{
+    int32 fid, sds_id;
+    int32 nsds, nattrs;
+    int32 start[1] = {0}, edges[1] = {META_DIM};
+    int32 attr;
+    intn  status;
+    intn  num_errs = 0;
+
+    fid = SDstart(FILE_META, DFACC_READ);
+    CHECK(fid, FAIL, "test_metacache: SDstart");
+    status = SDfileinfo(fid, &nsds, &nattrs);
+    CHECK(status, FAIL, "test_metacache: SDfileinfo");
+    VERIFY(nsds, nsds_expected, "test_metacache: SDfileinfo");
+
+    sds_id = SDselect(fid, 0);
+    CHECK(sds_id, FAIL, "test_metacache: SDselect");
+    status = SDreaddata(sds_id, start, NULL, edges, buf);
+    CHECK(status, FAIL, "test_metacache: SDreaddata");
+    status = SDreadattr(sds_id, SDfindattr(sds_id, "scale"), &attr);
+    CHECK(status, FAIL, "test_metacache: SDreadattr");
+    VERIFY(attr, 42, "test_metacache: SDreadattr");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_metacache: SDendaccess");
+
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_metacache: SDend");
+    return num_errs;
+}
+
+static int
+test_metacache()
+{
+    int32               fid, sds_id;
+    int32               dims[1] = {META_DIM}, start[1] = {0};
+    int32               data[META_DIM], buf[META_DIM];
+    int32               attr = 42;
+    hdf_memory_report_t report;
+    size_t              kept;
+    intn                status;
+    int                 i;
+    intn                num_errs = 0;
+
+    for (i = 0; i < META_DIM; i++)
+        data[i] = i * 3;
+
+    fid = SDstart(FILE_META, DFACC_CREATE);
+    CHECK(fid, FAIL, "test_metacache: SDstart");
+    sds_id = SDcreate(fid, "first", DFNT_INT32, 1, dims);
+    CHECK(sds_id, FAIL, "test_metacache: SDcreate");
+    status = SDwritedata(sds_id, start, NULL, dims, data);
+    CHECK(status, FAIL, "test_metacache: SDwritedata");
+    status = SDsetattr(sds_id, "scale", DFNT_INT32, 1, &attr);
+    CHECK(status, FAIL, "test_metacache: SDsetattr");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_metacache: SDendaccess");
+    sds_id = SDcreate(fid, "second", DFNT_INT32, 1, dims);
+    CHECK(sds_id, FAIL, "test_metacache: SDcreate");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_metacache: SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_metacache: SDend");
+
+    status = SDsetmetacache(-1);
+    VERIFY(status, FAIL, "test_metacache: SDsetmetacache");
+    status = SDsetmetacache(2);
+    CHECK(status, FAIL, "test_metacache: SDsetmetacache");
+
+    /* the metadata read are kept after SDend, and reused */
+    num_errs += meta_read(2, buf);
+    status = Hget_memory_usage(&report);
+    CHECK(status, FAIL, "test_metacache: Hget_memory_usage");
+    kept = report.current[HDF_MEM_NC];
+    if (kept == 0) {
+        fprintf(stderr, "test_metacache: the metadata were not kept\n");
+        num_errs++;
+    }
+    num_errs += meta_read(2, buf);
+    if (memcmp(buf, data, sizeof(data)) != 0) {
+        fprintf(stderr, "test_metacache: wrong data read with kept metadata\n");
+        num_errs++;
+    }
+
+    /* a file written to is read again */
+    fid = SDstart(FILE_META, DFACC_RDWR);
+    CHECK(fid, FAIL, "test_metacache: SDstart");
+    sds_id = SDcreate(fid, "third", DFNT_INT32, 1, dims);
+    CHECK(sds_id, FAIL, "test_metacache: SDcreate");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_metacache: SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_metacache: SDend");
+    num_errs += meta_read(3, buf);
+
+    status = SDsetmetacache(0);
+    CHECK(status, FAIL, "test_metacache: SDsetmetacache");
+    status = Hget_memory_usage(&report);
+    CHECK(status, FAIL, "test_metacache: Hget_memory_usage");
+    if (report.current[HDF_MEM_NC] >= kept) {
+        fprintf(stderr, "test_metacache: the metadata kept were not freed\n");
+        num_errs++;
+    }
+
+    return num_errs;
+}
+
+/********************************************************************
+   Name: test_start_many() - tests opening several files at once with
+                             SDstart_many
+
+   Description:
+    The main contents include:
+    - create a few files with a data set with an attribute each
+    - open them along with a missing file with SDstart_many, checking
+      that it fails for the missing file only, and that the data and
+      attribute of each of the others are right
+    - open the existing ones again, which succeeds
+
+   Return value:
+    The number of errors occurred in this routine.
+
+*********************************************************************/
+
+#define MANY_NFILES 3
+#define MANY_DIM    16
+
+static int
+test_start_many()
+{
+    const char *names[MANY_NFILES + 1] = {"tstartmany0.hdf", "tstartmany1.hdf", "tstartmany2.hdf",
+                                          "tstartmany_none.hdf"};
+    int32       fids[MANY_NFILES + 1];
+    int32       sds_id;
+    int32       dims[1] = {MANY_DIM}, start[1] = {0};
+    int32       data[MANY_DIM], buf[MANY_DIM];
+    int32       attr;
+    int32       nsds, nattrs;
+    intn        status;
+    int         i, j;
+    intn        num_errs = 0;
+
+    for (i = 0; i < MANY_NFILES; i++) {
+        for (j = 0; j < MANY_DIM; j++)
+            data[j] = i * 100 + j;
+        attr = i;
+        fids[i] = SDstart(names[i], DFACC_CREATE);
+        CHECK(fids[i], FAIL, "test_start_many: SDstart");
+        sds_id = SDcreate(fids[i], "values", DFNT_INT32, 1, dims);
+        CHECK(sds_id, FAIL, "test_start_many: SDcreate");
+        status = SDwritedata(sds_id, start, NULL, dims, data);
+        CHECK(status, FAIL, "test_start_many: SDwritedata");
+        status = SDsetattr(sds_id, "file", DFNT_INT32, 1, &attr);
+        CHECK(status, FAIL, "test_start_many: SDsetattr");
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "test_start_many: SDendaccess");
+        status = SDend(fids[i]);
+        CHECK(status, FAIL, "test_start_many: SDend");
+    }
+
+    /* the missing file fails, the others open */
+    status = SDstart_many(MANY_NFILES + 1, names, DFACC_READ, fids);
+    VERIFY(status, FAIL, "test_start_many: SDstart_many");
+    VERIFY(fids[MANY_NFILES], FAIL, "test_start_many: SDstart_many");
+    for (i = 0; i < MANY_NFILES; i++) {
+        CHECK(fids[i], FAIL, "test_start_many: SDstart_many");
+        status = SDfileinfo(fids[i], &nsds, &nattrs);
+        CHECK(status, FAIL, "test_start_many: SDfileinfo");
+        VERIFY(nsds, 1, "test_start_many: SDfileinfo");
+
+        sds_id = SDselect(fids[i], 0);
+        CHECK(sds_id, FAIL, "test_start_many: SDselect");
+        status = SDreaddata(sds_id, start, NULL, dims, buf);
+        CHECK(status, FAIL, "test_start_many: SDreaddata");
+        VERIFY(buf[MANY_DIM - 1], i * 100 + MANY_DIM - 1, "test_start_many: SDreaddata");
+        status = SDreadattr(sds_id, SDfindattr(sds_id, "file"), &attr);
+        CHECK(status, FAIL, "test_start_many: SDreadattr");
+        VERIFY(attr, i, "test_start_many: SDreadattr");
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "test_start_many: SDendaccess");
+        status = SDend(fids[i]);
+        CHECK(status, FAIL, "test_start_many: SDend");
+    }
+
+    /* all the files open */
+    status = SDstart_many(MANY_NFILES, names, DFACC_RDWR, fids);
+    CHECK(status, FAIL, "test_start_many: SDstart_many");
+    for (i = 0; i < MANY_NFILES; i++) {
+        status = SDend(fids[i]);
+        CHECK(status, FAIL, "test_start_many: SDend");
+    }
+
+    status = SDstart_many(-1, names, DFACC_READ, fids);
+    VERIFY(status, FAIL, "test_start_many: SDstart_many");
+
+    return num_errs;
+}
+
 /* Test driver for testing miscellaneous file related APIs. */
 extern int
 test_files()
@@ -446,6 +666,12 @@ test_files()
     /* Test determining of file format */
     num_errs = num_errs + test_fileformat();
 
+    /* Test reopening files with their metadata kept */
+    num_errs = num_errs + test_metacache();
+
+    /* Test opening several files at once */
+    num_errs = num_errs + test_start_many();
+
     if (num_errs == 0)
         PASSED();
     return num_errs;
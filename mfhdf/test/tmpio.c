@@ -0,0 +1,164 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/****************************************************************************
+ * tmpio.c - tests reading a file with the "mpio" driver, see Hsetmpio(),
+ *	     run on several MPI processes.  The first process writes a file
+ *	     with a compressed chunked data set and a contiguous one, then
+ *	     every process reads its own slab of each, see SDgetchunkslab(),
+ *	     the chunk table being read by the first process only.
+ ****************************************************************************/
+
+#include "mfhdf.h"
+
+#include "hdftest.h"
+
+#define MPIO_FILE   "tmpio.hdf"
+#define MPIO_DIM0   100
+#define MPIO_DIM1   40
+#define MPIO_CHUNK0 8
+#define MPIO_CHUNK1 20
+
+static int32 data[MPIO_DIM0][MPIO_DIM1];
+static int32 outdata[MPIO_DIM0][MPIO_DIM1];
+
+/* Writes the test file, from the first process only */
+static int
+write_file(void)
+{
+    int32         sd_id, sds_id;
+    int32         dims[2]  = {MPIO_DIM0, MPIO_DIM1};
+    int32         start[2] = {0, 0};
+    HDF_CHUNK_DEF chunk_def;
+    intn          status;
+    int           num_errs = 0;
+
+    sd_id = SDstart(MPIO_FILE, DFACC_CREATE);
+    CHECK(sd_id, FAIL, "SDstart");
+
+    sds_id = SDcreate(sd_id, "Chunked", DFNT_INT32, 2, dims);
+    CHECK(sds_id, FAIL, "SDcreate");
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]    = MPIO_CHUNK0;
+    chunk_def.comp.chunk_lengths[1]    = MPIO_CHUNK1;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 6;
+    status                             = SDsetchunk(sds_id, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "SDsetchunk");
+    status = SDwritedata(sds_id, start, NULL, dims, (void *)data);
+    CHECK(status, FAIL, "SDwritedata");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    sds_id = SDcreate(sd_id, "Contiguous", DFNT_INT32, 2, dims);
+    CHECK(sds_id, FAIL, "SDcreate");
+    status = SDwritedata(sds_id, start, NULL, dims, (void *)data);
+    CHECK(status, FAIL, "SDwritedata");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    status = SDend(sd_id);
+    CHECK(status, FAIL, "SDend");
+
+    return num_errs;
+} /* write_file */
+
+/* Reads the slab of each data set of this process */
+static int
+read_file(int rank, int nprocs)
+{
+    int32 sd_id, sds_id;
+    int32 start[2], edges[2];
+    intn  status;
+    int32 i, j, k;
+    int   num_errs = 0;
+
+    /* The driver is read-only */
+    sd_id = SDstart(MPIO_FILE, DFACC_WRITE);
+    VERIFY(sd_id, FAIL, "SDstart");
+
+    sd_id = SDstart(MPIO_FILE, DFACC_READ);
+    CHECK(sd_id, FAIL, "SDstart");
+
+    for (k = 0; k < 2; k++) {
+        sds_id = SDselect(sd_id, k);
+        CHECK(sds_id, FAIL, "SDselect");
+
+        status = SDgetchunkslab(sds_id, (int32)nprocs, (int32)rank, start, edges);
+        CHECK(status, FAIL, "SDgetchunkslab");
+        if (k == 0 && start[0] % MPIO_CHUNK0 != 0) {
+            fprintf(stderr, "rank %d: slab of data set #%d starts inside a chunk\n", rank, (int)k);
+            num_errs++;
+        }
+
+        memset(outdata, 0, sizeof(outdata));
+        if (edges[0] > 0) {
+            status = SDreaddata(sds_id, start, NULL, edges, (void *)outdata);
+            CHECK(status, FAIL, "SDreaddata");
+        }
+        for (i = 0; i < edges[0]; i++)
+            for (j = 0; j < edges[1]; j++)
+                if (outdata[i][j] != data[start[0] + i][j]) {
+                    fprintf(stderr, "rank %d: wrong value at [%d][%d] of data set #%d\n", rank,
+                            (int)(start[0] + i), (int)j, (int)k);
+                    num_errs++;
+                    i = edges[0];
+                    break;
+                }
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+
+    status = SDend(sd_id);
+    CHECK(status, FAIL, "SDend");
+
+    return num_errs;
+} /* read_file */
+
+int
+main(int argc, char *argv[])
+{
+    int  rank, nprocs;
+    int  errs, num_errs = 0;
+    intn status;
+    int  i, j;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+
+    for (i = 0; i < MPIO_DIM0; i++)
+        for (j = 0; j < MPIO_DIM1; j++)
+            data[i][j] = i * 1000 + j;
+
+    if (rank == 0)
+        num_errs += write_file();
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    status = Hsetmpio(MPI_COMM_WORLD, MPI_INFO_NULL);
+    CHECK(status, FAIL, "Hsetmpio");
+    num_errs += read_file(rank, nprocs);
+    status = Hsetmpio(MPI_COMM_NULL, MPI_INFO_NULL);
+    CHECK(status, FAIL, "Hsetmpio");
+
+    MPI_Allreduce(&num_errs, &errs, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (rank == 0) {
+        if (errs == 0)
+            printf("MPI-IO test passes on %d processes\n", nprocs);
+        else
+            printf("MPI-IO test fails: %d errors\n", errs);
+    }
+
+    MPI_Finalize();
+    return errs == 0 ? 0 : 1;
+}
@@ -27,6 +27,8 @@
  *        test_1dim_singlevar - tests on a single variable with only 1 dimension
  *        test_1dim_multivars - tests on multiple variables with only 1 dimension
  *        test_multidim_singlevar - tests on single variable with multiple dimensions
+ *        test_netcdf_fill - tests filling new records of byte/char variables in a
+ *                           netCDF file
  *
  ****************************************************************************/
 
@@ -895,6 +897,137 @@ test_multidim_singlevar()
     return 0;
 }
 
+/********************************************************************
+   Name: test_netcdf_fill() - tests filling new records of byte and char
+                              variables in a netCDF file
+
+   Description:
+        The library only creates HDF files, so the netCDF file is written
+        here from its raw header: an unlimited dimension "time", a
+        dimension "x" of 5 and two record variables b(time,x) of NC_BYTE
+        and c(time,x) of NC_CHAR, each with a _FillValue.  The main
+        contents include:
+        - repeat an item over a buffer in place with HDmemfill
+        - write record 3 of b, which fills records 0 to 2 of both
+          variables and record 3 of c
+        - read back both variables and check the filled values
+
+   Return value:
+        The number of errors occurred in this routine.
+
+*********************************************************************/
+
+#define FILENAME4 "ncfill.nc"
+#define NREC      4
+#define XLEN      5
+#define BFILL     7
+#define CFILL     'z'
+
+static int
+test_netcdf_fill()
+{
+    /* netCDF header; b and c each have one _FillValue attribute, a record
+       of each is 8 bytes and the records start right after the header */
+    static const uint8 header[] = {
+        /* magic, no records yet */
+        'C', 'D', 'F', 1, 0, 0, 0, 0,
+        /* two dimensions: time (unlimited) and x */
+        0, 0, 0, 10, 0, 0, 0, 2,
+        0, 0, 0, 4, 't', 'i', 'm', 'e', 0, 0, 0, 0,
+        0, 0, 0, 1, 'x', 0, 0, 0, 0, 0, 0, XLEN,
+        /* no global attributes */
+        0, 0, 0, 0, 0, 0, 0, 0,
+        /* two variables */
+        0, 0, 0, 11, 0, 0, 0, 2,
+        /* b(time, x): NC_BYTE, _FillValue BFILL, vsize 8, begin 192 */
+        0, 0, 0, 1, 'b', 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 1,
+        0, 0, 0, 12, 0, 0, 0, 1,
+        0, 0, 0, 10, '_', 'F', 'i', 'l', 'l', 'V', 'a', 'l', 'u', 'e', 0, 0,
+        0, 0, 0, 1, 0, 0, 0, 1, BFILL, 0, 0, 0,
+        0, 0, 0, 1, 0, 0, 0, 8, 0, 0, 0, 192,
+        /* c(time, x): NC_CHAR, _FillValue CFILL, vsize 8, begin 200 */
+        0, 0, 0, 1, 'c', 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 1,
+        0, 0, 0, 12, 0, 0, 0, 1,
+        0, 0, 0, 10, '_', 'F', 'i', 'l', 'l', 'V', 'a', 'l', 'u', 'e', 0, 0,
+        0, 0, 0, 2, 0, 0, 0, 1, CFILL, 0, 0, 0,
+        0, 0, 0, 2, 0, 0, 0, 8, 0, 0, 0, 200};
+    FILE *fp;
+    int   ncid;                            /* file id */
+    int   bid, cid;                        /* variable ids */
+    long  nrecs   = 0;                     /* number of records */
+    long  start[] = {NREC - 1, 0};         /* last record, written */
+    long  edges[] = {1, XLEN};             /* one record */
+    char  bdata[NREC][XLEN];               /* data read back */
+    char  cdata[NREC][XLEN];               /* data read back */
+    char  outdata[XLEN] = {1, 2, 3, 4, 5}; /* data written */
+    char  items[12]     = "abc";           /* buffer for HDmemfill */
+    int   ii, jj;
+    intn  status   = 0; /* returned by called functions */
+    intn  num_errs = 0; /* number of errors so far */
+
+    /* The first item of the buffer repeated over the rest of it */
+    HDmemfill(items, items, 3, 4);
+    if (memcmp(items, "abcabcabcabc", sizeof(items)) != 0) {
+        fprintf(stderr, "test_netcdf_fill: HDmemfill did not repeat the item in place\n");
+        num_errs++;
+    }
+
+    /* Write the header of the netCDF file */
+    fp = fopen(FILENAME4, "wb");
+    CHECK(fp, NULL, "fopen");
+    if (fp == NULL)
+        return num_errs;
+    if (fwrite(header, 1, sizeof(header), fp) != sizeof(header)) {
+        fprintf(stderr, "test_netcdf_fill: cannot write %s\n", FILENAME4);
+        num_errs++;
+    }
+    fclose(fp);
+
+    /* Write the last record of b, which fills all the records before it */
+    ncid = ncopen(FILENAME4, NC_RDWR);
+    CHECK(ncid, -1, "ncopen");
+    bid = ncvarid(ncid, "b");
+    CHECK(bid, -1, "ncvarid");
+    status = ncvarput(ncid, bid, start, edges, outdata);
+    CHECK(status, -1, "ncvarput");
+    status = ncclose(ncid);
+    CHECK(status, -1, "ncclose");
+
+    /* Read both variables back */
+    ncid = ncopen(FILENAME4, NC_NOWRITE);
+    CHECK(ncid, -1, "ncopen");
+    status = ncdiminq(ncid, 0, NULL, &nrecs);
+    CHECK(status, -1, "ncdiminq");
+    VERIFY(nrecs, NREC, "ncdiminq");
+
+    bid = ncvarid(ncid, "b");
+    CHECK(bid, -1, "ncvarid");
+    cid = ncvarid(ncid, "c");
+    CHECK(cid, -1, "ncvarid");
+    start[0] = 0;
+    edges[0] = NREC;
+    status   = ncvarget(ncid, bid, start, edges, bdata);
+    CHECK(status, -1, "ncvarget");
+    status = ncvarget(ncid, cid, start, edges, cdata);
+    CHECK(status, -1, "ncvarget");
+    status = ncclose(ncid);
+    CHECK(status, -1, "ncclose");
+
+    for (ii = 0; ii < NREC; ii++)
+        for (jj = 0; jj < XLEN; jj++) {
+            if (bdata[ii][jj] != (ii == NREC - 1 ? outdata[jj] : BFILL)) {
+                fprintf(stderr, "test_netcdf_fill: wrong value %d of b at %d,%d\n", bdata[ii][jj], ii, jj);
+                num_errs++;
+            }
+            if (cdata[ii][jj] != CFILL) {
+                fprintf(stderr, "test_netcdf_fill: wrong value %d of c at %d,%d\n", cdata[ii][jj], ii, jj);
+                num_errs++;
+            }
+        }
+
+    return num_errs;
+}
+
 /* Test driver for testing reading/writing variables with unlimited dimension
    using nc API. */
 extern int
@@ -914,6 +1047,9 @@ test_ncunlim()
     /* Test multiple variables with multiple dimensions */
     num_errs = num_errs + test_multidim_singlevar();
 
+    /* Test filling new records of byte and char variables in a netCDF file */
+    num_errs = num_errs + test_netcdf_fill();
+
     if (num_errs == 0)
         PASSED();
     return num_errs;
@@ -118,6 +118,366 @@ test_read_dim()
 
 static int16 netcdf_u16[2][3] = {{1, 2, 3}, {4, 5, 6}};
 
+/* Copies the file src to dst, the tests below working on copies of the
+   files read by the other tests */
+static intn
+copy_file(const char *src, const char *dst)
+{
+    FILE  *in, *out;
+    char   copybuf[1024];
+    size_t n;
+
+    if ((in = fopen(src, "rb")) == NULL)
+        return FAIL;
+    if ((out = fopen(dst, "wb")) == NULL) {
+        fclose(in);
+        return FAIL;
+    }
+    while ((n = fread(copybuf, 1, sizeof(copybuf), in)) > 0)
+        fwrite(copybuf, 1, n, out);
+    fclose(in);
+    fclose(out);
+    return SUCCEED;
+}
+
+/********************************************************************
+   Name: test_xdr_buffer() - tests the I/O buffer of netCDF files.
+
+   Description:
+        This routine updates a copy of 'test1.nc' through a buffer much
+    smaller than the file, so that the header and the data cross many
+    buffer pages, and reads the update back with the SD interface.  The
+    buffer of the open file is enlarged between two reads, which must
+    not move the stream.  The copy is then read read-only, which decodes
+    the data straight from a mapping of the file where mmap() exists.
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+#define XDR_FILE  "xdrbuffer.nc"
+#define XDR_SMALL 64
+
+static intn
+test_xdr_buffer(const char *testfile)
+{
+    int     ncid, varid;
+    long    nc_start[2], nc_edges[2];
+    int16   data[2][3] = {{10, 20, 30}, {40, 50, 60}};
+    int16   outdata[2][3];
+    float32 aloan[2][3] = {{-1.5f, 0.0f, 2.25f}, {1.0e-20f, 3.0e20f, -7.0f}};
+    float32 outaloan[2][3];
+    int32   shot[2][3];
+    float64 cross[3];
+    int32   sd_id, sds_id;
+    int32   start[2], edges[2];
+    int32   status;
+    intn    i, j;
+    intn    num_errs = 0; /* number of errors so far */
+
+    /* work on a copy, the original is read by the other tests */
+    if (copy_file(testfile, XDR_FILE) == FAIL) {
+        fprintf(stderr, "test_xdr_buffer: cannot copy %s\n", testfile);
+        return 1;
+    }
+
+    /* A size of 0 is refused, a small size applies to the files opened next */
+    status = SDsetxdrbuffersize(CACHE_ALL_FILES, 0);
+    VERIFY(status, FAIL, "SDsetxdrbuffersize");
+    status = SDsetxdrbuffersize(CACHE_ALL_FILES, XDR_SMALL);
+    VERIFY(status, 1024 * 1024, "SDsetxdrbuffersize");
+
+    /* rewrite the variable 'order' through the small buffer */
+    ncid = ncopen(XDR_FILE, NC_WRITE);
+    CHECK(ncid, -1, "ncopen");
+    varid = ncvarid(ncid, "order");
+    CHECK(varid, -1, "ncvarid");
+    nc_start[0] = nc_start[1] = 0;
+    nc_edges[0]               = 2;
+    nc_edges[1]               = 3;
+    status                    = ncvarput(ncid, varid, nc_start, nc_edges, (void *)data);
+    CHECK(status, -1, "ncvarput");
+
+    /* floating-point values are converted a block at a time both ways */
+    varid = ncvarid(ncid, "aloan");
+    CHECK(varid, -1, "ncvarid");
+    status = ncvarput(ncid, varid, nc_start, nc_edges, (void *)aloan);
+    CHECK(status, -1, "ncvarput");
+    memset(outaloan, 0, sizeof(outaloan));
+    status = ncvarget(ncid, varid, nc_start, nc_edges, (void *)outaloan);
+    CHECK(status, -1, "ncvarget");
+    for (j = 0; j < 2; j++)
+        for (i = 0; i < 3; i++)
+            if (outaloan[j][i] != aloan[j][i]) {
+                fprintf(stderr, "test_xdr_buffer: wanted aloan[%d][%d]=%g, read %g\n", j, i,
+                        (double)aloan[j][i], (double)outaloan[j][i]);
+                num_errs++;
+            }
+    status = ncclose(ncid);
+    CHECK(status, -1, "ncclose");
+
+    /* read it back a row at a time, enlarging the buffer in between; the
+       file is opened for writing since read-only files may be mapped */
+    memset(outdata, 0, sizeof(outdata));
+    sd_id = SDstart(XDR_FILE, DFACC_WRITE);
+    CHECK(sd_id, FAIL, "SDstart");
+    sds_id = SDselect(sd_id, SDnametoindex(sd_id, "order"));
+    CHECK(sds_id, FAIL, "SDselect");
+    start[0] = start[1] = 0;
+    edges[0]            = 1;
+    edges[1]            = 3;
+    status              = SDreaddata(sds_id, start, NULL, edges, (void *)outdata[0]);
+    CHECK(status, FAIL, "SDreaddata");
+    status = SDsetxdrbuffersize(sd_id, 4096);
+    VERIFY(status, XDR_SMALL, "SDsetxdrbuffersize");
+    start[0] = 1;
+    status   = SDreaddata(sds_id, start, NULL, edges, (void *)outdata[1]);
+    CHECK(status, FAIL, "SDreaddata");
+    for (j = 0; j < 2; j++)
+        for (i = 0; i < 3; i++)
+            if (outdata[j][i] != data[j][i]) {
+                fprintf(stderr, "test_xdr_buffer: wanted order[%d][%d]=%d, read %d\n", j, i, data[j][i],
+                        outdata[j][i]);
+                num_errs++;
+            }
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDend(sd_id);
+    CHECK(status, FAIL, "SDend");
+
+    /* read the integer and floating-point variables read-only */
+    sd_id = SDstart(XDR_FILE, DFACC_RDONLY);
+    CHECK(sd_id, FAIL, "SDstart");
+    sds_id = SDselect(sd_id, SDnametoindex(sd_id, "shot"));
+    CHECK(sds_id, FAIL, "SDselect");
+    start[0] = start[1] = 0;
+    edges[0]            = 2;
+    edges[1]            = 3;
+    status              = SDreaddata(sds_id, start, NULL, edges, (void *)shot);
+    CHECK(status, FAIL, "SDreaddata");
+    for (j = 0; j < 2; j++)
+        for (i = 0; i < 3; i++)
+            if (shot[j][i] != 3 * j + i + 2) {
+                fprintf(stderr, "test_xdr_buffer: wanted shot[%d][%d]=%d, read %d\n", j, i, 3 * j + i + 2,
+                        (int)shot[j][i]);
+                num_errs++;
+            }
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    /* the second row only, from the middle of the variable */
+    sds_id = SDselect(sd_id, SDnametoindex(sd_id, "cross"));
+    CHECK(sds_id, FAIL, "SDselect");
+    start[0] = 1;
+    edges[0] = 1;
+    status   = SDreaddata(sds_id, start, NULL, edges, (void *)cross);
+    CHECK(status, FAIL, "SDreaddata");
+    if (cross[0] != 7.0 || cross[1] != 8.0 || cross[2] != 1.0e10) {
+        fprintf(stderr, "test_xdr_buffer: wanted cross[1]={7, 8, 1e10}, read {%g, %g, %g}\n", cross[0],
+                cross[1], cross[2]);
+        num_errs++;
+    }
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDend(sd_id);
+    CHECK(status, FAIL, "SDend");
+
+    /* put the default back for the other tests */
+    status = SDsetxdrbuffersize(CACHE_ALL_FILES, 1024 * 1024);
+    VERIFY(status, XDR_SMALL, "SDsetxdrbuffersize");
+
+    return num_errs;
+} /* test_xdr_buffer */
+
+/********************************************************************
+   Name: test_redef_inplace() - tests leaving define mode in place.
+
+   Description:
+        This routine adds attributes and variables to a copy of 'test1.nc'
+    through ncredef().  The first attribute does not fit before the data,
+    which is moved and leaves room after the header; the next attribute
+    and variables fit in that room, so that the data stays where it is.
+    An attribute too large for the room left moves the data again.  The
+    data is read back after each change.
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+#define REDEF_FILE "redefinplace.nc"
+#define REDEF_RECS 3
+
+static long
+file_size(const char *name)
+{
+    FILE *fp;
+    long  size;
+
+    if ((fp = fopen(name, "rb")) == NULL)
+        return -1;
+    fseek(fp, 0L, SEEK_END);
+    size = ftell(fp);
+    fclose(fp);
+    return size;
+}
+
+/* Checks 'order', then the variable 'w' and the numrecs records of 'r'
+   when they have been added */
+static intn
+check_redef_data(int ncid, int numrecs)
+{
+    short order[2][3], w[2][3];
+    short r[REDEF_RECS][3];
+    long  nc_start[2] = {0, 0}, nc_edges[2] = {2, 3};
+    int   varid, status;
+    intn  i, j;
+    intn  num_errs = 0;
+
+    varid = ncvarid(ncid, "order");
+    CHECK(varid, -1, "ncvarid");
+    status = ncvarget(ncid, varid, nc_start, nc_edges, (void *)order);
+    CHECK(status, -1, "ncvarget");
+    for (j = 0; j < 2; j++)
+        for (i = 0; i < 3; i++)
+            if (order[j][i] != netcdf_u16[j][i]) {
+                fprintf(stderr, "test_redef_inplace: wanted order[%d][%d]=%d, read %d\n", j, i,
+                        netcdf_u16[j][i], order[j][i]);
+                num_errs++;
+            }
+
+    if (numrecs < 0)
+        return num_errs;
+
+    /* the variable added has its fill value */
+    varid = ncvarid(ncid, "w");
+    CHECK(varid, -1, "ncvarid");
+    status = ncvarget(ncid, varid, nc_start, nc_edges, (void *)w);
+    CHECK(status, -1, "ncvarget");
+    for (j = 0; j < 2; j++)
+        for (i = 0; i < 3; i++)
+            if (w[j][i] != FILL_SHORT) {
+                fprintf(stderr, "test_redef_inplace: wanted w[%d][%d]=%d, read %d\n", j, i, FILL_SHORT,
+                        w[j][i]);
+                num_errs++;
+            }
+
+    if (numrecs == 0)
+        return num_errs;
+
+    varid = ncvarid(ncid, "r");
+    CHECK(varid, -1, "ncvarid");
+    nc_edges[0] = numrecs;
+    status      = ncvarget(ncid, varid, nc_start, nc_edges, (void *)r);
+    CHECK(status, -1, "ncvarget");
+    for (j = 0; j < numrecs; j++)
+        for (i = 0; i < 3; i++)
+            if (r[j][i] != 3 * j + i) {
+                fprintf(stderr, "test_redef_inplace: wanted r[%d][%d]=%d, read %d\n", j, i, 3 * j + i,
+                        r[j][i]);
+                num_errs++;
+            }
+
+    return num_errs;
+}
+
+static intn
+test_redef_inplace(const char *testfile)
+{
+    short r[REDEF_RECS][3] = {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}};
+    char  big[1000];
+    long  nc_start[2] = {0, 0}, nc_edges[2] = {REDEF_RECS, 3};
+    long  size, new_size;
+    int   ncid, dims[2], varid, status;
+    intn  num_errs = 0; /* number of errors so far */
+
+    if (copy_file(testfile, REDEF_FILE) == FAIL) {
+        fprintf(stderr, "test_redef_inplace: cannot copy %s\n", testfile);
+        return 1;
+    }
+
+    /* the header of the copy is followed by the data, which moves */
+    size = file_size(REDEF_FILE);
+    ncid = ncopen(REDEF_FILE, NC_WRITE);
+    CHECK(ncid, -1, "ncopen");
+    status = ncredef(ncid);
+    CHECK(status, -1, "ncredef");
+    status = ncattput(ncid, NC_GLOBAL, "title", NC_CHAR, 5, "moved");
+    CHECK(status, -1, "ncattput");
+    status = ncendef(ncid);
+    CHECK(status, -1, "ncendef");
+    num_errs += check_redef_data(ncid, -1);
+    status = ncclose(ncid);
+    CHECK(status, -1, "ncclose");
+    new_size = file_size(REDEF_FILE);
+    if (new_size <= size) {
+        fprintf(stderr, "test_redef_inplace: file of %ld bytes did not grow, now %ld\n", size, new_size);
+        num_errs++;
+    }
+
+    /* another attribute fits before the data, nothing moves */
+    size = new_size;
+    ncid = ncopen(REDEF_FILE, NC_WRITE);
+    CHECK(ncid, -1, "ncopen");
+    status = ncredef(ncid);
+    CHECK(status, -1, "ncredef");
+    status = ncattput(ncid, NC_GLOBAL, "comment", NC_CHAR, 8, "in place");
+    CHECK(status, -1, "ncattput");
+    status = ncendef(ncid);
+    CHECK(status, -1, "ncendef");
+    num_errs += check_redef_data(ncid, -1);
+    status = ncclose(ncid);
+    CHECK(status, -1, "ncclose");
+    VERIFY(file_size(REDEF_FILE), size, "file_size");
+
+    /* so do a variable, which is filled, and a record variable */
+    ncid = ncopen(REDEF_FILE, NC_WRITE);
+    CHECK(ncid, -1, "ncopen");
+    status = ncredef(ncid);
+    CHECK(status, -1, "ncredef");
+    dims[0] = ncdimid(ncid, "i");
+    dims[1] = ncdimid(ncid, "j");
+    varid   = ncvardef(ncid, "w", NC_SHORT, 2, dims);
+    CHECK(varid, -1, "ncvardef");
+    dims[0] = ncdimid(ncid, "k");
+    varid   = ncvardef(ncid, "r", NC_SHORT, 2, dims);
+    CHECK(varid, -1, "ncvardef");
+    status = ncendef(ncid);
+    CHECK(status, -1, "ncendef");
+    num_errs += check_redef_data(ncid, 0);
+    status = ncvarput(ncid, varid, nc_start, nc_edges, (void *)r);
+    CHECK(status, -1, "ncvarput");
+    status = ncclose(ncid);
+    CHECK(status, -1, "ncclose");
+
+    /* a large attribute does not fit, the data moves again */
+    size = file_size(REDEF_FILE);
+    ncid = ncopen(REDEF_FILE, NC_WRITE);
+    CHECK(ncid, -1, "ncopen");
+    status = ncredef(ncid);
+    CHECK(status, -1, "ncredef");
+    memset(big, 'x', sizeof(big));
+    status = ncattput(ncid, NC_GLOBAL, "large", NC_CHAR, (int)sizeof(big), big);
+    CHECK(status, -1, "ncattput");
+    status = ncendef(ncid);
+    CHECK(status, -1, "ncendef");
+    num_errs += check_redef_data(ncid, REDEF_RECS);
+    status = ncclose(ncid);
+    CHECK(status, -1, "ncclose");
+    new_size = file_size(REDEF_FILE);
+    if (new_size <= size) {
+        fprintf(stderr, "test_redef_inplace: file of %ld bytes did not grow, now %ld\n", size, new_size);
+        num_errs++;
+    }
+
+    /* and everything is found again once the file is reopened */
+    ncid = ncopen(REDEF_FILE, NC_NOWRITE);
+    CHECK(ncid, -1, "ncopen");
+    num_errs += check_redef_data(ncid, REDEF_RECS);
+    status = ncclose(ncid);
+    CHECK(status, -1, "ncclose");
+
+    return num_errs;
+} /* test_redef_inplace */
+
 /* Tests reading of netCDF file 'test1.nc' using the SDxxx interface.
    Note not all features of reading SDS from netCDF files are tested here.
    Hopefully more tests will be added over time as needed/required. */
@@ -235,6 +595,12 @@ test_netcdf_reading()
     /* Test reading dimension scale - bugzilla 1644 */
     num_errs = num_errs + test_read_dim();
 
+    /* Test the I/O buffer of netCDF files */
+    num_errs = num_errs + test_xdr_buffer(testfile);
+
+    /* Test adding to a netCDF file without moving its data */
+    num_errs = num_errs + test_redef_inplace(testfile);
+
     if (num_errs == 0)
         PASSED();
     return num_errs;
@@ -742,6 +742,1246 @@ test_valid_args2()
     return num_errs;
 } /* test_valid_args2 */
 
+/****************************************************************************
+   Name: test_convert_inplace() - tests converting the user's buffer in place
+
+   Description:
+        This routine writes the same int32 data to two big-endian
+        datasets, once with SDsetconvertinplace() off and once with it on,
+        then checks that the buffer was only modified the second time,
+        that it holds the data in file order, and that both datasets read
+        back correctly.
+
+   Return value:
+        The number of errors occurred in this routine.
+
+****************************************************************************/
+
+#define INPLACE_FILE_NAME "test_inplace.hdf" /* file to test in place conversion */
+
+static intn
+test_convert_inplace()
+{
+    int32 fid, dset;
+    int32 start[2], edges[2], dimsizes[2];
+    int32 data[X_LENGTH][Y_LENGTH], /* data to be written to datasets */
+        buf[X_LENGTH][Y_LENGTH];    /* buffer handed to SDwritedata */
+    intn idxx, idxy, status;
+    intn inplace;
+    intn num_errs = 0; /* number of errors so far */
+
+    for (idxx = 0; idxx < X_LENGTH; idxx++)
+        for (idxy = 0; idxy < Y_LENGTH; idxy++)
+            data[idxx][idxy] = idxx * 0x01020304 + idxy;
+
+    fid = SDstart(INPLACE_FILE_NAME, DFACC_CREATE);
+    CHECK(fid, FAIL, "SDstart");
+
+    dimsizes[0] = X_LENGTH;
+    dimsizes[1] = Y_LENGTH;
+    start[0] = start[1] = 0;
+    edges[0]            = X_LENGTH;
+    edges[1]            = Y_LENGTH;
+
+    for (inplace = FALSE; inplace <= TRUE; inplace++) {
+        status = SDsetconvertinplace(fid, inplace);
+        VERIFY(status, FALSE, "SDsetconvertinplace");
+
+        dset = SDcreate(fid, inplace ? DS2_NAME : DS1_NAME, DFNT_INT32, RANK, dimsizes);
+        CHECK(dset, FAIL, "SDcreate");
+
+        memcpy(buf, data, sizeof(data));
+        status = SDwritedata(dset, start, NULL, edges, (void *)buf);
+        CHECK(status, FAIL, "SDwritedata");
+
+        /* Only the second write may leave the data in file order */
+        if (inplace) {
+            status = DFKconvert(buf, buf, DFNT_INT32, X_LENGTH * Y_LENGTH, DFACC_READ, 0, 0);
+            CHECK(status, FAIL, "DFKconvert");
+        }
+        if (memcmp(buf, data, sizeof(data)) != 0) {
+            fprintf(stderr, "test_convert_inplace: wrong buffer contents after SDwritedata\n");
+            num_errs++;
+        }
+
+        status = SDendaccess(dset);
+        CHECK(status, FAIL, "SDendaccess");
+
+        status = SDsetconvertinplace(fid, FALSE);
+        VERIFY(status, inplace, "SDsetconvertinplace");
+    }
+
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    /* Read both datasets back, the reads convert in place */
+    fid = SDstart(INPLACE_FILE_NAME, DFACC_READ);
+    CHECK(fid, FAIL, "SDstart");
+
+    for (inplace = FALSE; inplace <= TRUE; inplace++) {
+        dset = SDselect(fid, inplace);
+        CHECK(dset, FAIL, "SDselect");
+
+        memset(buf, 0, sizeof(buf));
+        status = SDreaddata(dset, start, NULL, edges, (void *)buf);
+        CHECK(status, FAIL, "SDreaddata");
+        if (memcmp(buf, data, sizeof(data)) != 0) {
+            fprintf(stderr, "test_convert_inplace: wrong data read from dataset %d\n", inplace);
+            num_errs++;
+        }
+
+        status = SDendaccess(dset);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    /* Return the number of errors that's been kept track of, so far */
+    return num_errs;
+} /* test_convert_inplace */
+
+/****************************************************************************
+   Name: test_buffer_limit() - tests the limit on kept conversion buffers
+
+   Description:
+        This routine checks the arguments and previous values of
+        SDsetbufferlimit(), then writes and reads back big-endian int32
+        data, which goes through the conversion buffer, with buffers
+        released after every call and with buffers kept.  The kept buffer
+        and the metadata of the open file are reported by
+        Hget_memory_usage(), and the buffer is freed by Htrim_memory().
+
+   Return value:
+        The number of errors occurred in this routine.
+
+****************************************************************************/
+
+#define BUFLIMIT_FILE_NAME "test_buflimit.hdf" /* file to test the buffer limit */
+
+static intn
+test_buffer_limit()
+{
+    int32 fid, dset;
+    int32 start[2], edges[2], dimsizes[2];
+    int32 data[X_LENGTH][Y_LENGTH], /* data to be written to datasets */
+        buf[X_LENGTH][Y_LENGTH];    /* buffer to read the data back */
+    int32               limit, expect;
+    intn                idxx, idxy, status;
+    intn                keep;
+    hdf_memory_report_t report;
+    intn                num_errs = 0; /* number of errors so far */
+
+    for (idxx = 0; idxx < X_LENGTH; idxx++)
+        for (idxy = 0; idxy < Y_LENGTH; idxy++)
+            data[idxx][idxy] = idxx * 0x01020304 + idxy;
+
+    limit = SDsetbufferlimit(-1);
+    VERIFY(limit, FAIL, "SDsetbufferlimit");
+
+    dimsizes[0] = X_LENGTH;
+    dimsizes[1] = Y_LENGTH;
+    start[0] = start[1] = 0;
+    edges[0]            = X_LENGTH;
+    edges[1]            = Y_LENGTH;
+
+    for (keep = FALSE; keep <= TRUE; keep++) {
+        /* keep nothing, then go back to the default */
+        limit  = SDsetbufferlimit(keep ? 1024 * 1024 : 0);
+        expect = keep ? 0 : 1024 * 1024;
+        VERIFY(limit, expect, "SDsetbufferlimit");
+
+        fid = SDstart(BUFLIMIT_FILE_NAME, keep ? DFACC_RDWR : DFACC_CREATE);
+        CHECK(fid, FAIL, "SDstart");
+
+        dset = SDcreate(fid, keep ? DS2_NAME : DS1_NAME, DFNT_INT32, RANK, dimsizes);
+        CHECK(dset, FAIL, "SDcreate");
+        status = SDwritedata(dset, start, NULL, edges, (void *)data);
+        CHECK(status, FAIL, "SDwritedata");
+        status = SDendaccess(dset);
+        CHECK(status, FAIL, "SDendaccess");
+
+        status = SDend(fid);
+        CHECK(status, FAIL, "SDend");
+
+        fid = SDstart(BUFLIMIT_FILE_NAME, DFACC_READ);
+        CHECK(fid, FAIL, "SDstart");
+
+        dset = SDselect(fid, keep);
+        CHECK(dset, FAIL, "SDselect");
+        memset(buf, 0, sizeof(buf));
+        status = SDreaddata(dset, start, NULL, edges, (void *)buf);
+        CHECK(status, FAIL, "SDreaddata");
+        if (memcmp(buf, data, sizeof(data)) != 0) {
+            fprintf(stderr, "test_buffer_limit: wrong data read from dataset %d\n", keep);
+            num_errs++;
+        }
+        status = SDendaccess(dset);
+        CHECK(status, FAIL, "SDendaccess");
+
+        status = Hget_memory_usage(&report);
+        CHECK(status, FAIL, "Hget_memory_usage");
+        if (report.current[HDF_MEM_NC] == 0 || (keep && report.current[HDF_MEM_SCRATCH] < sizeof(data))) {
+            fprintf(stderr, "test_buffer_limit: memory of the open file not reported\n");
+            num_errs++;
+        }
+
+        status = SDend(fid);
+        CHECK(status, FAIL, "SDend");
+    }
+
+    status = Htrim_memory();
+    CHECK(status, FAIL, "Htrim_memory");
+    status = Hget_memory_usage(&report);
+    CHECK(status, FAIL, "Hget_memory_usage");
+    VERIFY(report.current[HDF_MEM_SCRATCH], 0, "Htrim_memory");
+
+    status = SDfreebuffers();
+    CHECK(status, FAIL, "SDfreebuffers");
+
+    /* Return the number of errors that's been kept track of, so far */
+    return num_errs;
+} /* test_buffer_limit */
+
+/****************************************************************************
+   Name: test_async_io() - tests the asynchronous reads and writes
+
+   Description:
+        This routine writes two datasets with SDwritedata_async(), reads
+        them back with SDreaddata_async() while polling with SDtest(),
+        and checks the results of SDwait().  It also checks that a bad
+        dataset is refused right away, that a bad slab is reported by
+        SDwait(), that unknown tokens are refused, and that SDendaccess()
+        lets a request complete before it closes the dataset.
+
+   Return value:
+        The number of errors occurred in this routine.
+
+****************************************************************************/
+
+#define ASYNC_FILE_NAME "test_async.hdf" /* file to test asynchronous I/O */
+
+static intn
+test_async_io()
+{
+    int32 fid, dsets[2];
+    int32 start[2], edges[2], dimsizes[2];
+    int32 data[2][X_LENGTH][Y_LENGTH], /* data to be written to datasets */
+        buf[2][X_LENGTH][Y_LENGTH];    /* buffers to read the data back */
+    int32 reqs[2];
+    intn  idxx, idxy, idx, status, done;
+    intn  num_errs = 0; /* number of errors so far */
+
+    for (idx = 0; idx < 2; idx++)
+        for (idxx = 0; idxx < X_LENGTH; idxx++)
+            for (idxy = 0; idxy < Y_LENGTH; idxy++)
+                data[idx][idxx][idxy] = idx * 1000 + idxx * 10 + idxy;
+
+    fid = SDstart(ASYNC_FILE_NAME, DFACC_CREATE);
+    CHECK(fid, FAIL, "SDstart");
+
+    dimsizes[0] = X_LENGTH;
+    dimsizes[1] = Y_LENGTH;
+    start[0] = start[1] = 0;
+    edges[0]            = X_LENGTH;
+    edges[1]            = Y_LENGTH;
+
+    /* Queue both writes, then wait for them */
+    for (idx = 0; idx < 2; idx++) {
+        dsets[idx] = SDcreate(fid, idx ? DS2_NAME : DS1_NAME, DFNT_INT32, RANK, dimsizes);
+        CHECK(dsets[idx], FAIL, "SDcreate");
+        reqs[idx] = SDwritedata_async(dsets[idx], start, NULL, edges, (void *)data[idx]);
+        CHECK(reqs[idx], FAIL, "SDwritedata_async");
+    }
+    for (idx = 0; idx < 2; idx++) {
+        status = SDwait(reqs[idx]);
+        VERIFY(status, SUCCEED, "SDwait");
+    }
+
+    /* A token is gone once waited for */
+    status = SDwait(reqs[0]);
+    VERIFY(status, FAIL, "SDwait");
+    status = SDtest(reqs[0], &done);
+    VERIFY(status, FAIL, "SDtest");
+
+    /* Queue both reads and poll until they are done */
+    memset(buf, 0, sizeof(buf));
+    for (idx = 0; idx < 2; idx++) {
+        reqs[idx] = SDreaddata_async(dsets[idx], start, NULL, edges, (void *)buf[idx]);
+        CHECK(reqs[idx], FAIL, "SDreaddata_async");
+    }
+    do {
+        status = SDtest(reqs[1], &done);
+        CHECK(status, FAIL, "SDtest");
+    } while (status != FAIL && !done);
+    for (idx = 0; idx < 2; idx++) {
+        status = SDwait(reqs[idx]);
+        VERIFY(status, SUCCEED, "SDwait");
+    }
+    if (memcmp(buf, data, sizeof(data)) != 0) {
+        fprintf(stderr, "test_async_io: wrong data read back\n");
+        num_errs++;
+    }
+
+    /* A bad dataset is refused right away, a bad slab when waited for */
+    reqs[0] = SDreaddata_async(fid, start, NULL, edges, (void *)buf[0]);
+    VERIFY(reqs[0], FAIL, "SDreaddata_async");
+    edges[0] = X_LENGTH + 1;
+    reqs[0]  = SDreaddata_async(dsets[0], start, NULL, edges, (void *)buf[0]);
+    CHECK(reqs[0], FAIL, "SDreaddata_async");
+    status = SDwait(reqs[0]);
+    VERIFY(status, FAIL, "SDwait");
+    edges[0] = X_LENGTH;
+
+    /* SDendaccess() lets the outstanding request complete first */
+    memset(buf, 0, sizeof(buf));
+    reqs[1] = SDreaddata_async(dsets[1], start, NULL, edges, (void *)buf[1]);
+    CHECK(reqs[1], FAIL, "SDreaddata_async");
+    for (idx = 0; idx < 2; idx++) {
+        status = SDendaccess(dsets[idx]);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+    status = SDtest(reqs[1], &done);
+    VERIFY(done, TRUE, "SDtest");
+    status = SDwait(reqs[1]);
+    VERIFY(status, SUCCEED, "SDwait");
+    if (memcmp(buf[1], data[1], sizeof(data[1])) != 0) {
+        fprintf(stderr, "test_async_io: wrong data read back before SDendaccess\n");
+        num_errs++;
+    }
+
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    /* Return the number of errors that's been kept track of, so far */
+    return num_errs;
+} /* test_async_io */
+
+/****************************************************************************
+   Name: test_multi_read() - tests reading several datasets in one call
+
+   Description:
+        This routine writes three datasets in one file, the last one
+        chunked and compressed, in the reverse order of their creation,
+        and a fourth one in another file.  It then reads them all back
+        with one SDreaddata_multi(), one of them with a stride, and checks
+        that a bad dataset fails the call before anything is read.
+
+   Return value:
+        The number of errors occurred in this routine.
+
+****************************************************************************/
+
+#define MULTI_FILE_NAME1 "test_multi1.hdf" /* files to test reading several datasets */
+#define MULTI_FILE_NAME2 "test_multi2.hdf"
+#define MULTI_NSDS       4
+
+static intn
+test_multi_read()
+{
+    int32         fids[2], dsets[MULTI_NSDS];
+    int32         start[2], edges[2], stride[2], sedges[2], dimsizes[2];
+    int32         data[MULTI_NSDS][X_LENGTH][Y_LENGTH], /* data to be written to datasets */
+        buf[MULTI_NSDS][X_LENGTH][Y_LENGTH];            /* buffers to read the data back */
+    int32        *starts[MULTI_NSDS], *strides[MULTI_NSDS], *alledges[MULTI_NSDS];
+    void         *bufs[MULTI_NSDS];
+    static int32  zeros[MULTI_NSDS][X_LENGTH][Y_LENGTH];
+    const char   *names[MULTI_NSDS] = {DS1_NAME, DS2_NAME, "chunked", DS1_NAME};
+    HDF_CHUNK_DEF chunk_def;
+    intn          idxx, idxy, idx, status;
+    intn          num_errs = 0; /* number of errors so far */
+
+    for (idx = 0; idx < MULTI_NSDS; idx++)
+        for (idxx = 0; idxx < X_LENGTH; idxx++)
+            for (idxy = 0; idxy < Y_LENGTH; idxy++)
+                data[idx][idxx][idxy] = idx * 1000 + idxx * 10 + idxy;
+
+    fids[0] = SDstart(MULTI_FILE_NAME1, DFACC_CREATE);
+    CHECK(fids[0], FAIL, "SDstart");
+    fids[1] = SDstart(MULTI_FILE_NAME2, DFACC_CREATE);
+    CHECK(fids[1], FAIL, "SDstart");
+
+    dimsizes[0] = X_LENGTH;
+    dimsizes[1] = Y_LENGTH;
+    start[0] = start[1] = 0;
+    edges[0]            = X_LENGTH;
+    edges[1]            = Y_LENGTH;
+
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]    = 3;
+    chunk_def.comp.chunk_lengths[1]    = 4;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 6;
+
+    for (idx = 0; idx < MULTI_NSDS; idx++) {
+        dsets[idx] = SDcreate(fids[idx == MULTI_NSDS - 1], names[idx], DFNT_INT32, RANK, dimsizes);
+        CHECK(dsets[idx], FAIL, "SDcreate");
+    }
+    status = SDsetchunk(dsets[2], chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "SDsetchunk");
+
+    /* Write the data in the reverse order of the datasets */
+    for (idx = MULTI_NSDS - 1; idx >= 0; idx--) {
+        status = SDwritedata(dsets[idx], start, NULL, edges, (void *)data[idx]);
+        CHECK(status, FAIL, "SDwritedata");
+    }
+
+    /* Read every other row and column of the second dataset */
+    stride[0] = stride[1] = 2;
+    sedges[0]             = X_LENGTH / 2;
+    sedges[1]             = Y_LENGTH / 2;
+    for (idx = 0; idx < MULTI_NSDS; idx++) {
+        starts[idx]   = start;
+        strides[idx]  = (idx == 1) ? stride : NULL;
+        alledges[idx] = (idx == 1) ? sedges : edges;
+        bufs[idx]     = (void *)buf[idx];
+    }
+
+    memset(buf, 0, sizeof(buf));
+    status = SDreaddata_multi(MULTI_NSDS, dsets, starts, strides, alledges, bufs);
+    VERIFY(status, SUCCEED, "SDreaddata_multi");
+    for (idx = 0; idx < MULTI_NSDS; idx++) {
+        if (idx == 1) {
+            for (idxx = 0; idxx < sedges[0]; idxx++)
+                for (idxy = 0; idxy < sedges[1]; idxy++)
+                    if (((int32 *)buf[idx])[idxx * sedges[1] + idxy] != data[idx][2 * idxx][2 * idxy]) {
+                        fprintf(stderr, "test_multi_read: wrong value at [%d][%d] of dataset %d\n", idxx,
+                                idxy, idx);
+                        num_errs++;
+                    }
+        }
+        else if (memcmp(buf[idx], data[idx], sizeof(data[idx])) != 0) {
+            fprintf(stderr, "test_multi_read: wrong data read back for dataset %d\n", idx);
+            num_errs++;
+        }
+    }
+
+    /* Without strides at all, and with nothing to read */
+    memset(buf, 0, sizeof(buf));
+    status = SDreaddata_multi(1, &dsets[2], starts, NULL, alledges, bufs);
+    VERIFY(status, SUCCEED, "SDreaddata_multi");
+    if (memcmp(buf[0], data[2], sizeof(data[2])) != 0) {
+        fprintf(stderr, "test_multi_read: wrong data read back without strides\n");
+        num_errs++;
+    }
+    status = SDreaddata_multi(0, NULL, NULL, NULL, NULL, NULL);
+    VERIFY(status, SUCCEED, "SDreaddata_multi");
+
+    /* A bad dataset or slab is refused before anything is read */
+    memset(buf, 0, sizeof(buf));
+    dsets[MULTI_NSDS - 1] = fids[0];
+    status                = SDreaddata_multi(MULTI_NSDS, dsets, starts, strides, alledges, bufs);
+    VERIFY(status, FAIL, "SDreaddata_multi");
+    if (memcmp(buf, zeros, sizeof(buf)) != 0) {
+        fprintf(stderr, "test_multi_read: data read for a refused call\n");
+        num_errs++;
+    }
+    status = SDreaddata_multi(MULTI_NSDS, dsets, starts, NULL, NULL, bufs);
+    VERIFY(status, FAIL, "SDreaddata_multi");
+
+    for (idx = 0; idx < MULTI_NSDS - 1; idx++) {
+        status = SDendaccess(dsets[idx]);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+    for (idx = 0; idx < 2; idx++) {
+        status = SDend(fids[idx]);
+        CHECK(status, FAIL, "SDend");
+    }
+
+    /* Return the number of errors that's been kept track of, so far */
+    return num_errs;
+} /* test_multi_read */
+
+/****************************************************************************
+   Name: test_files_read() - tests reading a dataset spanning several files
+
+   Description:
+        This routine writes a dataset of the same name in several files,
+        chunked and compressed in one of them, and one of another number
+        type in a last file.  It then reads slabs of the virtual dataset
+        they make with SDreaddata_files(), among which a time series of
+        one value and every other file, and checks that slabs outside of
+        the files, a missing dataset and mixed number types are refused.
+
+   Return value:
+        The number of errors occurred in this routine.
+
+****************************************************************************/
+
+#define FILES_NFILES 5 /* files of the virtual dataset, the last one float32 */
+#define FILES_DSNAME "series"
+
+static intn
+test_files_read()
+{
+    int32         fid, dset;
+    int32         start[RANK + 1], stride[RANK + 1], edges[RANK + 1], dimsizes[RANK];
+    int32         data[FILES_NFILES - 1][X_LENGTH][Y_LENGTH];
+    int32         buf[FILES_NFILES - 1][X_LENGTH][Y_LENGTH];
+    float32       fdata[X_LENGTH][Y_LENGTH];
+    char          names[FILES_NFILES][20];
+    const char   *paths[FILES_NFILES];
+    HDF_CHUNK_DEF chunk_def;
+    intn          idxx, idxy, idx, status;
+    intn          num_errs = 0; /* number of errors so far */
+
+    dimsizes[0] = X_LENGTH;
+    dimsizes[1] = Y_LENGTH;
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]    = 3;
+    chunk_def.comp.chunk_lengths[1]    = 4;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 6;
+    memset(fdata, 0, sizeof(fdata));
+
+    for (idx = 0; idx < FILES_NFILES; idx++) {
+        snprintf(names[idx], sizeof(names[idx]), "test_files%d.hdf", idx);
+        paths[idx] = names[idx];
+
+        fid = SDstart(paths[idx], DFACC_CREATE);
+        CHECK(fid, FAIL, "SDstart");
+        dset =
+            SDcreate(fid, FILES_DSNAME, idx < FILES_NFILES - 1 ? DFNT_INT32 : DFNT_FLOAT32, RANK, dimsizes);
+        CHECK(dset, FAIL, "SDcreate");
+        if (idx == 2) {
+            status = SDsetchunk(dset, chunk_def, HDF_CHUNK | HDF_COMP);
+            CHECK(status, FAIL, "SDsetchunk");
+        }
+
+        start[0] = start[1] = 0;
+        if (idx < FILES_NFILES - 1) {
+            for (idxx = 0; idxx < X_LENGTH; idxx++)
+                for (idxy = 0; idxy < Y_LENGTH; idxy++)
+                    data[idx][idxx][idxy] = idx * 1000 + idxx * 10 + idxy;
+            status = SDwritedata(dset, start, NULL, dimsizes, (void *)data[idx]);
+        }
+        else
+            status = SDwritedata(dset, start, NULL, dimsizes, (void *)fdata);
+        CHECK(status, FAIL, "SDwritedata");
+
+        status = SDendaccess(dset);
+        CHECK(status, FAIL, "SDendaccess");
+        status = SDend(fid);
+        CHECK(status, FAIL, "SDend");
+    }
+
+    /* The whole of the int32 files, the chunks decoded on threads */
+    start[0] = start[1] = start[2] = 0;
+    edges[0]                       = FILES_NFILES - 1;
+    edges[1]                       = X_LENGTH;
+    edges[2]                       = Y_LENGTH;
+    memset(buf, 0, sizeof(buf));
+    status = SDreaddata_files(FILES_NFILES, paths, FILES_DSNAME, start, NULL, edges, 4, (void *)buf);
+    VERIFY(status, SUCCEED, "SDreaddata_files");
+    if (memcmp(buf, data, sizeof(data)) != 0) {
+        fprintf(stderr, "test_files_read: wrong data read back from all files\n");
+        num_errs++;
+    }
+
+    /* The time series of one value */
+    start[1] = 3;
+    start[2] = 7;
+    edges[1] = edges[2] = 1;
+    memset(buf, 0, sizeof(buf));
+    status = SDreaddata_files(FILES_NFILES, paths, FILES_DSNAME, start, NULL, edges, 1, (void *)buf);
+    VERIFY(status, SUCCEED, "SDreaddata_files");
+    for (idx = 0; idx < FILES_NFILES - 1; idx++)
+        if (((int32 *)buf)[idx] != data[idx][3][7]) {
+            fprintf(stderr, "test_files_read: wrong value of the time series in file %d\n", idx);
+            num_errs++;
+        }
+
+    /* Every other file, and every other value of some rows */
+    start[0]  = 1;
+    start[1]  = 2;
+    start[2]  = 1;
+    stride[0] = 2;
+    stride[1] = 1;
+    stride[2] = 2;
+    edges[0]  = 2;
+    edges[1]  = 3;
+    edges[2]  = Y_LENGTH / 2;
+    memset(buf, 0, sizeof(buf));
+    status = SDreaddata_files(FILES_NFILES, paths, FILES_DSNAME, start, stride, edges, 2, (void *)buf);
+    VERIFY(status, SUCCEED, "SDreaddata_files");
+    for (idx = 0; idx < edges[0]; idx++)
+        for (idxx = 0; idxx < edges[1]; idxx++)
+            for (idxy = 0; idxy < edges[2]; idxy++)
+                if (((int32 *)buf)[(idx * edges[1] + idxx) * edges[2] + idxy] !=
+                    data[1 + 2 * idx][2 + idxx][1 + 2 * idxy]) {
+                    fprintf(stderr, "test_files_read: wrong strided value at [%d][%d][%d]\n", idx, idxx,
+                            idxy);
+                    num_errs++;
+                }
+
+    /* Slabs past the last file, a missing dataset, mixed number types */
+    stride[0] = 3;
+    status    = SDreaddata_files(FILES_NFILES - 1, paths, FILES_DSNAME, start, stride, edges, 1, (void *)buf);
+    VERIFY(status, FAIL, "SDreaddata_files");
+    status = SDreaddata_files(FILES_NFILES, paths, "no such dataset", start, NULL, edges, 1, (void *)buf);
+    VERIFY(status, FAIL, "SDreaddata_files");
+    start[0] = FILES_NFILES - 2;
+    status   = SDreaddata_files(FILES_NFILES, paths, FILES_DSNAME, start, NULL, edges, 1, (void *)buf);
+    VERIFY(status, FAIL, "SDreaddata_files");
+
+    /* Return the number of errors that's been kept track of, so far */
+    return num_errs;
+} /* test_files_read */
+
+/****************************************************************************
+   Name: test_strided_read() - tests reading with non-unity strides
+
+   Description:
+        This routine writes a 3-D int16 dataset, contiguous and chunked
+        and compressed, and a long 1-D float64 dataset, then reads them
+        back with several strides, some along the fastest dimension only,
+        some along all dimensions, and one too large to be read in spans,
+        and checks every value against the data written.
+
+   Return value:
+        The number of errors occurred in this routine.
+
+****************************************************************************/
+
+#define STRIDE_FILE_NAME "test_strided.hdf" /* file to test strided reads */
+#define STR_DIM0         12
+#define STR_DIM1         20
+#define STR_DIM2         30
+#define STR_LEN          5000
+#define STR_NSTRIDES     5
+
+static intn
+test_strided_read()
+{
+    int32           fid, dsets[3];
+    int32           dimsizes[3] = {STR_DIM0, STR_DIM1, STR_DIM2};
+    int32           start[3]    = {0, 0, 0};
+    int32           rstart[3], stride[3], edges[3];
+    int32           strides[STR_NSTRIDES][3] = {{1, 1, 4}, {1, 3, 1}, {2, 3, 5}, {5, 1, 2}, {1, 7, 29}};
+    static int16    sdata[STR_DIM0][STR_DIM1][STR_DIM2];
+    static int16    sbuf[STR_DIM0 * STR_DIM1 * STR_DIM2];
+    static float64  fdata[STR_LEN];
+    static float64  fbuf[STR_LEN];
+    int32           fstride[2] = {4, 700}; /* the second skips too much to read spans */
+    HDF_CHUNK_DEF   chunk_def;
+    intn            ii, jj, kk, idx, ids, pos, status;
+    intn            num_errs = 0; /* number of errors so far */
+
+    for (ii = 0; ii < STR_DIM0; ii++)
+        for (jj = 0; jj < STR_DIM1; jj++)
+            for (kk = 0; kk < STR_DIM2; kk++)
+                sdata[ii][jj][kk] = (int16)(ii * 1000 + jj * 31 + kk);
+    for (ii = 0; ii < STR_LEN; ii++)
+        fdata[ii] = ii * 0.5;
+
+    fid = SDstart(STRIDE_FILE_NAME, DFACC_CREATE);
+    CHECK(fid, FAIL, "SDstart");
+
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]    = 5;
+    chunk_def.comp.chunk_lengths[1]    = 6;
+    chunk_def.comp.chunk_lengths[2]    = 7;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 6;
+
+    for (ids = 0; ids < 2; ids++) {
+        dsets[ids] = SDcreate(fid, ids ? DS2_NAME : DS1_NAME, DFNT_INT16, 3, dimsizes);
+        CHECK(dsets[ids], FAIL, "SDcreate");
+        if (ids == 1) {
+            status = SDsetchunk(dsets[ids], chunk_def, HDF_CHUNK | HDF_COMP);
+            CHECK(status, FAIL, "SDsetchunk");
+        }
+        status = SDwritedata(dsets[ids], start, NULL, dimsizes, (void *)sdata);
+        CHECK(status, FAIL, "SDwritedata");
+    }
+
+    dimsizes[0] = STR_LEN;
+    dsets[2]    = SDcreate(fid, "float64", DFNT_FLOAT64, 1, dimsizes);
+    CHECK(dsets[2], FAIL, "SDcreate");
+    status = SDwritedata(dsets[2], start, NULL, dimsizes, (void *)fdata);
+    CHECK(status, FAIL, "SDwritedata");
+
+    /* Read the 3-D datasets with each stride, from an offset start */
+    for (ids = 0; ids < 2; ids++)
+        for (idx = 0; idx < STR_NSTRIDES; idx++) {
+            rstart[0] = 1;
+            rstart[1] = 0;
+            rstart[2] = 1;
+            stride[0] = strides[idx][0];
+            stride[1] = strides[idx][1];
+            stride[2] = strides[idx][2];
+            edges[0]  = (STR_DIM0 - 1 - rstart[0]) / stride[0] + 1;
+            edges[1]  = (STR_DIM1 - 1 - rstart[1]) / stride[1] + 1;
+            edges[2]  = (STR_DIM2 - 1 - rstart[2]) / stride[2] + 1;
+
+            memset(sbuf, 0, sizeof(sbuf));
+            status = SDreaddata(dsets[ids], rstart, stride, edges, (void *)sbuf);
+            CHECK(status, FAIL, "SDreaddata");
+
+            pos = 0;
+            for (ii = 0; ii < edges[0]; ii++)
+                for (jj = 0; jj < edges[1]; jj++)
+                    for (kk = 0; kk < edges[2]; kk++, pos++)
+                        if (sbuf[pos] != sdata[rstart[0] + ii * stride[0]][rstart[1] + jj * stride[1]]
+                                              [rstart[2] + kk * stride[2]]) {
+                            fprintf(stderr, "test_strided_read: dataset %d, stride %d, wrong value at %d\n",
+                                    ids, idx, pos);
+                            num_errs++;
+                            ii = edges[0];
+                            jj = edges[1];
+                            break;
+                        }
+        }
+
+    /* Read the 1-D dataset with a small and a large stride */
+    for (idx = 0; idx < 2; idx++) {
+        rstart[0] = 3;
+        edges[0]  = (STR_LEN - 1 - rstart[0]) / fstride[idx] + 1;
+        memset(fbuf, 0, sizeof(fbuf));
+        status = SDreaddata(dsets[2], rstart, &fstride[idx], edges, (void *)fbuf);
+        CHECK(status, FAIL, "SDreaddata");
+        for (ii = 0; ii < edges[0]; ii++)
+            if (fbuf[ii] != fdata[rstart[0] + ii * fstride[idx]]) {
+                fprintf(stderr, "test_strided_read: float64 stride %d, wrong value at %d\n", (int)fstride[idx],
+                        ii);
+                num_errs++;
+                break;
+            }
+    }
+
+    for (ids = 0; ids < 3; ids++) {
+        status = SDendaccess(dsets[ids]);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    /* Return the number of errors that's been kept track of, so far */
+    return num_errs;
+} /* test_strided_read */
+
+/****************************************************************************
+   Name: test_sieve_buf() - tests the sieve buffer of a contiguous dataset
+
+   Description:
+        This routine writes a contiguous int32 dataset, sets a sieve
+        buffer on it and reads single values here and there, then
+        overwrites some of them and checks that the new values are read
+        back, not the ones left in the buffer.  It also checks that a
+        negative size is refused and that a chunked dataset accepts a
+        sieve buffer.
+
+   Return value:
+        The number of errors occurred in this routine.
+
+****************************************************************************/
+
+#define SIEVE_FILE_NAME "test_sieve.hdf" /* file to test the sieve buffer */
+#define SIEVE_LEN       20000
+
+static intn
+test_sieve_buf()
+{
+    int32         fid, dset, cdset;
+    int32         dimsize = SIEVE_LEN;
+    int32         start, edge, value, newval;
+    static int32  data[SIEVE_LEN];
+    int32         positions[8] = {5, 6, 1000, 7, 19999, 1001, 0, 12345};
+    HDF_CHUNK_DEF chunk_def;
+    intn          ii, status;
+    intn          num_errs = 0; /* number of errors so far */
+
+    for (ii = 0; ii < SIEVE_LEN; ii++)
+        data[ii] = ii * 3;
+
+    fid = SDstart(SIEVE_FILE_NAME, DFACC_CREATE);
+    CHECK(fid, FAIL, "SDstart");
+
+    dset = SDcreate(fid, DS1_NAME, DFNT_INT32, 1, &dimsize);
+    CHECK(dset, FAIL, "SDcreate");
+    start  = 0;
+    status = SDwritedata(dset, &start, NULL, &dimsize, (void *)data);
+    CHECK(status, FAIL, "SDwritedata");
+
+    status = SDsetsievebuf(dset, -1);
+    VERIFY(status, FAIL, "SDsetsievebuf");
+    status = SDsetsievebuf(dset, 4096);
+    VERIFY(status, SUCCEED, "SDsetsievebuf");
+
+    /* Values within and outside of the bytes in the buffer */
+    edge = 1;
+    for (ii = 0; ii < 8; ii++) {
+        start  = positions[ii];
+        status = SDreaddata(dset, &start, NULL, &edge, (void *)&value);
+        CHECK(status, FAIL, "SDreaddata");
+        VERIFY(value, data[positions[ii]], "SDreaddata");
+    }
+
+    /* A write empties the buffer */
+    start  = 1000;
+    newval = -1;
+    status = SDwritedata(dset, &start, NULL, &edge, (void *)&newval);
+    CHECK(status, FAIL, "SDwritedata");
+    status = SDreaddata(dset, &start, NULL, &edge, (void *)&value);
+    CHECK(status, FAIL, "SDreaddata");
+    VERIFY(value, -1, "SDreaddata");
+    start  = 1001;
+    status = SDreaddata(dset, &start, NULL, &edge, (void *)&value);
+    CHECK(status, FAIL, "SDreaddata");
+    VERIFY(value, data[1001], "SDreaddata");
+
+    status = SDendaccess(dset);
+    CHECK(status, FAIL, "SDendaccess");
+
+    /* A chunked dataset takes a sieve buffer but does not use it */
+    cdset = SDcreate(fid, DS2_NAME, DFNT_INT32, 1, &dimsize);
+    CHECK(cdset, FAIL, "SDcreate");
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.chunk_lengths[0] = 1000;
+    status                     = SDsetchunk(cdset, chunk_def, HDF_CHUNK);
+    CHECK(status, FAIL, "SDsetchunk");
+    status = SDsetsievebuf(cdset, 4096);
+    VERIFY(status, SUCCEED, "SDsetsievebuf");
+    start  = 0;
+    status = SDwritedata(cdset, &start, NULL, &dimsize, (void *)data);
+    CHECK(status, FAIL, "SDwritedata");
+    start  = 12345;
+    status = SDreaddata(cdset, &start, NULL, &edge, (void *)&value);
+    CHECK(status, FAIL, "SDreaddata");
+    VERIFY(value, data[12345], "SDreaddata");
+    status = SDendaccess(cdset);
+    CHECK(status, FAIL, "SDendaccess");
+
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    /* Read back from a read-only file, the buffer set before the data is attached to */
+    fid = SDstart(SIEVE_FILE_NAME, DFACC_READ);
+    CHECK(fid, FAIL, "SDstart");
+    dset = SDselect(fid, 0);
+    CHECK(dset, FAIL, "SDselect");
+    status = SDsetsievebuf(dset, 64);
+    VERIFY(status, SUCCEED, "SDsetsievebuf");
+    data[1000] = -1;
+    for (ii = 0; ii < SIEVE_LEN; ii += 7) {
+        start  = ii;
+        status = SDreaddata(dset, &start, NULL, &edge, (void *)&value);
+        CHECK(status, FAIL, "SDreaddata");
+        if (value != data[ii]) {
+            fprintf(stderr, "test_sieve_buf: wrong value at %d\n", ii);
+            num_errs++;
+            break;
+        }
+    }
+    status = SDendaccess(dset);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    /* Return the number of errors that's been kept track of, so far */
+    return num_errs;
+} /* test_sieve_buf */
+
+/****************************************************************************
+   Name: test_calibrated_read() - tests reading calibrated values
+
+   Description:
+        This routine writes an int16 dataset with a calibration and a fill
+        value, some of its values being the fill value, a float64 dataset
+        with a calibration and a uint8 dataset without one.  It then reads
+        them back with SDreaddata_calibrated() as float32 and float64
+        values, with and without a stride, and checks each value against
+        cal * (x - ioff) or the value given for the fill values.
+
+   Return value:
+        The number of errors occurred in this routine.
+
+****************************************************************************/
+
+#define CAL_FILE_NAME "test_calibrated.hdf" /* file to test calibrated reads */
+#define CAL_LEN       1000
+#define CAL_FILL      (-999)
+
+static intn
+test_calibrated_read()
+{
+    int32          fid, dsets[3];
+    int32          dimsize = CAL_LEN;
+    int32          start = 0, stride = 3, edge;
+    static int16   sdata[CAL_LEN];
+    static float64 ddata[CAL_LEN];
+    static uint8   udata[CAL_LEN];
+    static float32 fbuf[CAL_LEN];
+    static float64 dbuf[CAL_LEN];
+    int16          fill = CAL_FILL;
+    float64        expect, nan;
+    intn           ii, ids, status;
+    intn           num_errs = 0; /* number of errors so far */
+
+    for (ii = 0; ii < CAL_LEN; ii++) {
+        sdata[ii] = (int16)((ii % 10 == 0) ? CAL_FILL : ii - 500);
+        ddata[ii] = ii * 0.25;
+        udata[ii] = (uint8)ii;
+    }
+
+    fid = SDstart(CAL_FILE_NAME, DFACC_CREATE);
+    CHECK(fid, FAIL, "SDstart");
+
+    dsets[0] = SDcreate(fid, "int16", DFNT_INT16, 1, &dimsize);
+    CHECK(dsets[0], FAIL, "SDcreate");
+    status = SDsetcal(dsets[0], 0.5, 0.0, 10.0, 0.0, DFNT_INT16);
+    CHECK(status, FAIL, "SDsetcal");
+    status = SDsetfillvalue(dsets[0], (void *)&fill);
+    CHECK(status, FAIL, "SDsetfillvalue");
+    status = SDwritedata(dsets[0], &start, NULL, &dimsize, (void *)sdata);
+    CHECK(status, FAIL, "SDwritedata");
+
+    dsets[1] = SDcreate(fid, "float64", DFNT_FLOAT64, 1, &dimsize);
+    CHECK(dsets[1], FAIL, "SDcreate");
+    status = SDsetcal(dsets[1], 4.0, 0.0, -1.0, 0.0, DFNT_FLOAT64);
+    CHECK(status, FAIL, "SDsetcal");
+    status = SDwritedata(dsets[1], &start, NULL, &dimsize, (void *)ddata);
+    CHECK(status, FAIL, "SDwritedata");
+
+    dsets[2] = SDcreate(fid, "uint8", DFNT_UINT8, 1, &dimsize);
+    CHECK(dsets[2], FAIL, "SDcreate");
+    status = SDwritedata(dsets[2], &start, NULL, &dimsize, (void *)udata);
+    CHECK(status, FAIL, "SDwritedata");
+
+    /* Each dataset as float64, then as float32 */
+    for (ids = 0; ids < 3; ids++) {
+        status = SDreaddata_calibrated(dsets[ids], &start, NULL, &dimsize, DFNT_FLOAT64, -1.0e30, (void *)dbuf);
+        CHECK(status, FAIL, "SDreaddata_calibrated");
+        status = SDreaddata_calibrated(dsets[ids], &start, NULL, &dimsize, DFNT_FLOAT32, -1.0e30, (void *)fbuf);
+        CHECK(status, FAIL, "SDreaddata_calibrated");
+        for (ii = 0; ii < CAL_LEN; ii++) {
+            if (ids == 0)
+                expect = (sdata[ii] == CAL_FILL) ? -1.0e30 : 0.5 * (sdata[ii] - 10.0);
+            else if (ids == 1)
+                expect = 4.0 * (ddata[ii] + 1.0);
+            else
+                expect = udata[ii];
+            if (dbuf[ii] != expect || fbuf[ii] != (float32)expect) {
+                fprintf(stderr, "test_calibrated_read: dataset %d, wrong value at %d\n", ids, ii);
+                num_errs++;
+                break;
+            }
+        }
+    }
+
+    /* Every third value from the second one, with NaN for the fill values */
+    start  = 1;
+    edge   = (CAL_LEN - 1 - start) / stride + 1;
+    nan    = 0.0;
+    nan    = nan / nan;
+    status = SDreaddata_calibrated(dsets[0], &start, &stride, &edge, DFNT_FLOAT32, nan, (void *)fbuf);
+    CHECK(status, FAIL, "SDreaddata_calibrated");
+    for (ii = 0; ii < edge; ii++) {
+        int16 x = sdata[start + ii * stride];
+
+        if ((x == CAL_FILL) ? (fbuf[ii] == fbuf[ii]) : (fbuf[ii] != (float32)(0.5 * (x - 10.0)))) {
+            fprintf(stderr, "test_calibrated_read: wrong strided value at %d\n", ii);
+            num_errs++;
+            break;
+        }
+    }
+
+    /* Only float32 and float64 can be returned */
+    status = SDreaddata_calibrated(dsets[0], &start, NULL, &edge, DFNT_INT32, 0.0, (void *)fbuf);
+    VERIFY(status, FAIL, "SDreaddata_calibrated");
+
+    for (ids = 0; ids < 3; ids++) {
+        status = SDendaccess(dsets[ids]);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    /* Return the number of errors that's been kept track of, so far */
+    return num_errs;
+} /* test_calibrated_read */
+
+/****************************************************************************
+   Name: test_prefetch() - tests announcing the read of a slab
+
+   Description:
+        This routine writes a contiguous, a compressed chunked and an
+        unlimited int32 dataset, and leaves a fourth one without data.
+        It then announces slabs of each with SDprefetch(), some chunks
+        of the chunked one being read in the cache already, reads the
+        slabs back and checks them.  It also checks that a slab outside
+        of a dataset is refused.
+
+   Return value:
+        The number of errors occurred in this routine.
+
+****************************************************************************/
+
+#define PREFETCH_FILE_NAME "test_prefetch.hdf" /* file to test prefetching */
+#define PF_DIM0            60
+#define PF_DIM1            50
+#define PF_FILL            (-5)
+
+static intn
+test_prefetch()
+{
+    int32         fid, dsets[4];
+    int32         dims[2] = {PF_DIM0, PF_DIM1};
+    int32         start[2], edges[2], fill;
+    static int32  data[PF_DIM0][PF_DIM1];
+    static int32  outbuf[PF_DIM0][PF_DIM1];
+    HDF_CHUNK_DEF chunk_def;
+    intn          ids, ii, jj, status;
+    intn          num_errs = 0; /* number of errors so far */
+
+    for (ii = 0; ii < PF_DIM0; ii++)
+        for (jj = 0; jj < PF_DIM1; jj++)
+            data[ii][jj] = ii * 100 + jj;
+
+    fid = SDstart(PREFETCH_FILE_NAME, DFACC_CREATE);
+    CHECK(fid, FAIL, "SDstart");
+
+    dsets[0] = SDcreate(fid, "contiguous", DFNT_INT32, 2, dims);
+    CHECK(dsets[0], FAIL, "SDcreate");
+    dsets[1] = SDcreate(fid, "chunked", DFNT_INT32, 2, dims);
+    CHECK(dsets[1], FAIL, "SDcreate");
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]    = 16;
+    chunk_def.comp.chunk_lengths[1]    = 10;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 6;
+    status                             = SDsetchunk(dsets[1], chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "SDsetchunk");
+    dims[0]  = SD_UNLIMITED;
+    dsets[2] = SDcreate(fid, "unlimited", DFNT_INT32, 2, dims);
+    CHECK(dsets[2], FAIL, "SDcreate");
+    dims[0]  = PF_DIM0;
+    dsets[3] = SDcreate(fid, "empty", DFNT_INT32, 2, dims);
+    CHECK(dsets[3], FAIL, "SDcreate");
+    fill   = PF_FILL;
+    status = SDsetfillvalue(dsets[3], (void *)&fill);
+    CHECK(status, FAIL, "SDsetfillvalue");
+
+    start[0] = start[1] = 0;
+    for (ids = 0; ids < 3; ids++) {
+        status = SDwritedata(dsets[ids], start, NULL, dims, (void *)data);
+        CHECK(status, FAIL, "SDwritedata");
+    }
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    fid = SDstart(PREFETCH_FILE_NAME, DFACC_READ);
+    CHECK(fid, FAIL, "SDstart");
+    for (ids = 0; ids < 4; ids++) {
+        dsets[ids] = SDselect(fid, ids);
+        CHECK(dsets[ids], FAIL, "SDselect");
+    }
+
+    /* Bring some chunks in the cache first */
+    start[0] = 0;
+    start[1] = 0;
+    edges[0] = 20;
+    edges[1] = 12;
+    status   = SDreaddata(dsets[1], start, NULL, edges, (void *)outbuf);
+    CHECK(status, FAIL, "SDreaddata");
+
+    start[0] = 5;
+    start[1] = 7;
+    edges[0] = 40;
+    edges[1] = 30;
+    for (ids = 0; ids < 4; ids++) {
+        status = SDprefetch(dsets[ids], start, edges);
+        CHECK(status, FAIL, "SDprefetch");
+
+        memset(outbuf, 0, sizeof(outbuf));
+        status = SDreaddata(dsets[ids], start, NULL, edges, (void *)outbuf);
+        CHECK(status, FAIL, "SDreaddata");
+        for (ii = 0; ii < edges[0] * edges[1]; ii++)
+            if (((int32 *)outbuf)[ii] !=
+                (ids == 3 ? PF_FILL : data[start[0] + ii / edges[1]][start[1] + ii % edges[1]])) {
+                fprintf(stderr, "test_prefetch: dataset #%d, wrong value at %d\n", ids, ii);
+                num_errs++;
+                break;
+            }
+    }
+
+    /* The slab must be in the dataset */
+    edges[1] = PF_DIM1;
+    status   = SDprefetch(dsets[0], start, edges);
+    VERIFY(status, FAIL, "SDprefetch");
+    edges[1] = 0;
+    status   = SDprefetch(dsets[0], start, edges);
+    VERIFY(status, FAIL, "SDprefetch");
+    status = SDprefetch(fid, start, edges);
+    VERIFY(status, FAIL, "SDprefetch");
+
+    for (ids = 0; ids < 4; ids++) {
+        status = SDendaccess(dsets[ids]);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    /* Return the number of errors that's been kept track of, so far */
+    return num_errs;
+} /* test_prefetch */
+
+/****************************************************************************
+   Name: test_autorange() - tests keeping the range of written values
+
+   Description:
+        This routine writes a float32 dataset with a fill value, and a
+        NaN, in two hyperslabs after SDsetautorange(), and an int16
+        chunked dataset with SDwritechunk().  It checks the range and
+        number of fill values SDgetautorange() returns, then that
+        SDendaccess() stored the range as the valid range.  A dataset
+        with only fill values written gets no valid range.
+
+   Return value:
+        The number of errors occurred in this routine.
+
+****************************************************************************/
+
+#define AUTORANGE_FILE_NAME "test_autorange.hdf" /* file to test SDsetautorange */
+#define AR_DIM0             20
+#define AR_DIM1             30
+#define AR_FILL             (-1.0f)
+
+static intn
+test_autorange()
+{
+    int32         fid, sds_id, sds2_id, sds3_id;
+    int32         dims[2] = {AR_DIM0, AR_DIM1};
+    int32         start[2], edges[2], origin[2] = {1, 0};
+    int32         nfill;
+    static float  data[AR_DIM0][AR_DIM1];
+    int16         chunk[10][AR_DIM1], smin, smax;
+    float         fill = AR_FILL, fmin, fmax, zero = 0.0f;
+    HDF_CHUNK_DEF chunk_def;
+    intn          ii, jj, status;
+    intn          num_errs = 0; /* number of errors so far */
+
+    for (ii = 0; ii < AR_DIM0; ii++)
+        for (jj = 0; jj < AR_DIM1; jj++)
+            data[ii][jj] = (float)(ii * 10 + jj) - 50.0f;
+    data[0][0] = AR_FILL;
+    data[0][1] = AR_FILL;
+    data[3][4] = zero / zero; /* NaN, never the least nor the greatest */
+    data[AR_DIM0 - 1][AR_DIM1 - 1] = AR_FILL;
+
+    fid = SDstart(AUTORANGE_FILE_NAME, DFACC_CREATE);
+    CHECK(fid, FAIL, "SDstart");
+
+    sds_id = SDcreate(fid, "float", DFNT_FLOAT32, 2, dims);
+    CHECK(sds_id, FAIL, "SDcreate");
+    status = SDsetfillvalue(sds_id, (void *)&fill);
+    CHECK(status, FAIL, "SDsetfillvalue");
+
+    /* Nothing written yet */
+    status = SDgetautorange(sds_id, (void *)&fmax, (void *)&fmin, &nfill);
+    VERIFY(status, FAIL, "SDgetautorange");
+    status = SDsetautorange(sds_id, TRUE);
+    CHECK(status, FAIL, "SDsetautorange");
+    status = SDgetautorange(sds_id, (void *)&fmax, (void *)&fmin, &nfill);
+    VERIFY(status, FAIL, "SDgetautorange");
+
+    /* Two halves, the greatest value in the second */
+    start[0] = start[1] = 0;
+    edges[0]            = AR_DIM0 / 2;
+    edges[1]            = AR_DIM1;
+    status              = SDwritedata(sds_id, start, NULL, edges, (void *)data);
+    CHECK(status, FAIL, "SDwritedata");
+    start[0] = AR_DIM0 / 2;
+    status   = SDwritedata(sds_id, start, NULL, edges, (void *)data[AR_DIM0 / 2]);
+    CHECK(status, FAIL, "SDwritedata");
+
+    status = SDgetautorange(sds_id, (void *)&fmax, (void *)&fmin, &nfill);
+    CHECK(status, FAIL, "SDgetautorange");
+    VERIFY(fmin, -48.0f, "SDgetautorange");
+    VERIFY(fmax, (float)((AR_DIM0 - 1) * 10 + AR_DIM1 - 2) - 50.0f, "SDgetautorange");
+    VERIFY(nfill, 6, "SDgetautorange"); /* 3 set, and 3 computed as -1 */
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    /* A chunked int16 dataset written a chunk at a time */
+    sds2_id = SDcreate(fid, "chunked", DFNT_INT16, 2, dims);
+    CHECK(sds2_id, FAIL, "SDcreate");
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.chunk_lengths[0] = 10;
+    chunk_def.chunk_lengths[1] = AR_DIM1;
+    status                     = SDsetchunk(sds2_id, chunk_def, HDF_CHUNK);
+    CHECK(status, FAIL, "SDsetchunk");
+    status = SDsetautorange(sds2_id, TRUE);
+    CHECK(status, FAIL, "SDsetautorange");
+    for (ii = 0; ii < 10; ii++)
+        for (jj = 0; jj < AR_DIM1; jj++)
+            chunk[ii][jj] = (int16)(ii - jj);
+    status = SDwritechunk(sds2_id, origin, (void *)chunk);
+    CHECK(status, FAIL, "SDwritechunk");
+    status = SDgetautorange(sds2_id, (void *)&smax, (void *)&smin, NULL);
+    CHECK(status, FAIL, "SDgetautorange");
+    VERIFY(smin, 1 - AR_DIM1, "SDgetautorange");
+    VERIFY(smax, 9, "SDgetautorange");
+    status = SDendaccess(sds2_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    /* Only the fill value written, no range */
+    sds3_id = SDcreate(fid, "fill only", DFNT_FLOAT32, 2, dims);
+    CHECK(sds3_id, FAIL, "SDcreate");
+    status = SDsetfillvalue(sds3_id, (void *)&fill);
+    CHECK(status, FAIL, "SDsetfillvalue");
+    status = SDsetautorange(sds3_id, TRUE);
+    CHECK(status, FAIL, "SDsetautorange");
+    start[0] = start[1] = 0;
+    edges[0] = edges[1] = 1;
+    status              = SDwritedata(sds3_id, start, NULL, edges, (void *)&fill);
+    CHECK(status, FAIL, "SDwritedata");
+    status = SDgetautorange(sds3_id, (void *)&fmax, (void *)&fmin, &nfill);
+    VERIFY(status, FAIL, "SDgetautorange");
+    VERIFY(nfill, 1, "SDgetautorange");
+    status = SDendaccess(sds3_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    /* The ranges were stored as the valid ranges */
+    fid = SDstart(AUTORANGE_FILE_NAME, DFACC_READ);
+    CHECK(fid, FAIL, "SDstart");
+
+    sds_id = SDselect(fid, 0);
+    CHECK(sds_id, FAIL, "SDselect");
+    status = SDgetrange(sds_id, (void *)&fmax, (void *)&fmin);
+    CHECK(status, FAIL, "SDgetrange");
+    VERIFY(fmin, -48.0f, "SDgetrange");
+    VERIFY(fmax, (float)((AR_DIM0 - 1) * 10 + AR_DIM1 - 2) - 50.0f, "SDgetrange");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    sds2_id = SDselect(fid, 1);
+    CHECK(sds2_id, FAIL, "SDselect");
+    status = SDgetrange(sds2_id, (void *)&smax, (void *)&smin);
+    CHECK(status, FAIL, "SDgetrange");
+    VERIFY(smin, 1 - AR_DIM1, "SDgetrange");
+    VERIFY(smax, 9, "SDgetrange");
+    status = SDendaccess(sds2_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    sds3_id = SDselect(fid, 2);
+    CHECK(sds3_id, FAIL, "SDselect");
+    status = SDgetrange(sds3_id, (void *)&fmax, (void *)&fmin);
+    VERIFY(status, FAIL, "SDgetrange");
+    status = SDendaccess(sds3_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    /* Return the number of errors that's been kept track of, so far */
+    return num_errs;
+} /* test_autorange */
+
 /* Test driver for testing various SDS' properties. */
 extern int
 test_SDSprops()
@@ -756,6 +1996,16 @@ test_SDSprops()
     num_errs = num_errs + test_unlim_inloop();
     num_errs = num_errs + test_valid_args();
     num_errs = num_errs + test_valid_args2();
+    num_errs = num_errs + test_convert_inplace();
+    num_errs = num_errs + test_buffer_limit();
+    num_errs = num_errs + test_async_io();
+    num_errs = num_errs + test_multi_read();
+    num_errs = num_errs + test_files_read();
+    num_errs = num_errs + test_strided_read();
+    num_errs = num_errs + test_sieve_buf();
+    num_errs = num_errs + test_calibrated_read();
+    num_errs = num_errs + test_prefetch();
+    num_errs = num_errs + test_autorange();
 
     if (num_errs == 0)
         PASSED();
@@ -19,6 +19,7 @@
  *		+ data added immediately after last record
  *		+ data added skipping one or more records
  *		+ data overridden existing data
+ *		+ data compacted with SDcompact and appended to again
  *		+ data read pass the end of that variable but not the max in
  *		  all the variables in the file
  *
@@ -30,6 +31,7 @@
  *		dimensions
  *	  test_1dim_multivars_addon - tests multiple 1-dim variables that were
  *		added on to existing file
+ *	  test_append_records - tests appending records with SDappend
  *
  ****************************************************************************/
 
@@ -198,6 +200,24 @@ test_1dim_singlevar()
     /* Get information of the dataset, and verify its dimension */
     num_errs = num_errs + verify_info_data(dset1, 11, result);
 
+    /* Rewrite the linked blocks of the data as contiguous data */
+    status = SDcompact(dset1);
+    CHECK(status, FAIL, "SDcompact");
+
+    num_errs = num_errs + verify_info_data(dset1, 11, result);
+
+    { /* Append data to the compacted dataset */
+        int16 data[]     = {900, 901};
+        int16 appended[]  = {1, 2, 302, 303, 99, 99, 30, 31, 801, 802, 803, 900, 901};
+
+        start[0] = 11;
+        edges[0] = 2;
+        status   = SDwritedata(dset1, start, NULL, edges, (void *)data);
+        CHECK(status, FAIL, "SDwritedata");
+
+        num_errs = num_errs + verify_info_data(dset1, 13, appended);
+    }
+
     /* Close the dataset */
     status = SDendaccess(dset1);
     CHECK(status, FAIL, "SDendaccess");
@@ -716,6 +736,151 @@ test_1dim_multivars_addon()
     return 0;
 } /* test_1dim_multivars_addon */
 
+/********************************************************************
+   Name: test_append_records() - tests appending records with SDappend
+
+   Description:
+        The main contents include:
+        - append a few records and check that the SDS is not empty
+        - get the number of records, which writes the records out
+        - append many records in small pieces, so that the buffer is
+          written out several times
+        - read the data back, close and reopen the file, and verify the
+          number of records, the data and the size of the linked blocks
+        - SDappend on a dataset without unlimited dimension should fail
+
+   Return value:
+        The number of errors occurred in this routine.
+
+*********************************************************************/
+
+#define FILENAME4 "appendvar.hdf"
+#define APP_DIM1  3
+#define APP_NRECS 20000
+#define APP_STEP  7
+static int
+test_append_records()
+{
+    int32  fid;                        /* file id */
+    int32  dset1, dset2;               /* dataset ids */
+    int32  dset_index;                 /* dataset index */
+    int32  dimsizes[2];                /* dimension size buffer */
+    int32  start[2], edges[2];         /* where and how much to read */
+    int32  recs[APP_STEP][APP_DIM1];   /* records to append */
+    int32 *outdata = NULL;             /* data read back */
+    int32  block_size;                 /* size of the linked blocks */
+    int32  nrecs, i, j;                /* records appended, indices */
+    intn   emptySDS;                   /* TRUE if the SDS is empty */
+    intn   status   = 0;               /* returned by called functions */
+    intn   num_errs = 0;               /* number of errors so far */
+
+    fid = SDstart(FILENAME4, DFACC_CREATE);
+    CHECK(fid, FAIL, "SDstart");
+
+    dimsizes[0] = SD_UNLIMITED;
+    dimsizes[1] = APP_DIM1;
+    dset1       = SDcreate(fid, "Appended", DFNT_INT32, 2, dimsizes);
+    CHECK(dset1, FAIL, "SDcreate");
+
+    /* Records that are only buffered already make the SDS non-empty */
+    for (i = 0; i < APP_STEP; i++)
+        for (j = 0; j < APP_DIM1; j++)
+            recs[i][j] = i * APP_DIM1 + j;
+    status = SDappend(dset1, 3, recs);
+    CHECK(status, FAIL, "SDappend");
+    status = SDcheckempty(dset1, &emptySDS);
+    CHECK(status, FAIL, "SDcheckempty");
+    VERIFY(emptySDS, FALSE, "SDcheckempty");
+
+    /* SDgetinfo writes them out and counts them */
+    status = SDgetinfo(dset1, NULL, NULL, dimsizes, NULL, NULL);
+    CHECK(status, FAIL, "SDgetinfo");
+    VERIFY(dimsizes[0], 3, "SDgetinfo");
+
+    /* Append the rest a few records at a time */
+    for (nrecs = 3; nrecs < APP_NRECS; nrecs += APP_STEP) {
+        int32 n = MIN(APP_STEP, APP_NRECS - nrecs);
+
+        for (i = 0; i < n; i++)
+            for (j = 0; j < APP_DIM1; j++)
+                recs[i][j] = (nrecs + i) * APP_DIM1 + j;
+        status = SDappend(dset1, n, recs);
+        CHECK(status, FAIL, "SDappend");
+    }
+
+    /* Read all the records back */
+    outdata = (int32 *)malloc(APP_NRECS * APP_DIM1 * sizeof(int32));
+    CHECK_ALLOC(outdata, "outdata", "test_append_records");
+    start[0] = start[1] = 0;
+    edges[0]            = APP_NRECS;
+    edges[1]            = APP_DIM1;
+    status              = SDreaddata(dset1, start, NULL, edges, outdata);
+    CHECK(status, FAIL, "SDreaddata");
+    for (i = 0; i < APP_NRECS * APP_DIM1; i++)
+        if (outdata[i] != i) {
+            fprintf(stderr, "test_append_records: value %d is %d after SDreaddata\n", (int)i,
+                    (int)outdata[i]);
+            num_errs++;
+            break;
+        }
+
+    /* A dataset without unlimited dimension cannot be appended to */
+    dimsizes[0] = 10;
+    dset2       = SDcreate(fid, "Fixed", DFNT_INT32, 2, dimsizes);
+    CHECK(dset2, FAIL, "SDcreate");
+    status = SDappend(dset2, 1, recs);
+    VERIFY(status, FAIL, "SDappend");
+    status = SDendaccess(dset2);
+    CHECK(status, FAIL, "SDendaccess");
+
+    /* Leave a few records in the buffer for SDend to write */
+    status = SDappend(dset1, 2, recs);
+    CHECK(status, FAIL, "SDappend");
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    /* Reopen the file and verify the records */
+    fid = SDstart(FILENAME4, DFACC_READ);
+    CHECK(fid, FAIL, "SDstart");
+    dset_index = SDnametoindex(fid, "Appended");
+    CHECK(dset_index, FAIL, "SDnametoindex");
+    dset1 = SDselect(fid, dset_index);
+    CHECK(dset1, FAIL, "SDselect");
+
+    status = SDgetinfo(dset1, NULL, NULL, dimsizes, NULL, NULL);
+    CHECK(status, FAIL, "SDgetinfo");
+    VERIFY(dimsizes[0], APP_NRECS + 2, "SDgetinfo");
+
+    edges[0] = APP_NRECS + 2;
+    free(outdata);
+    outdata = (int32 *)malloc((APP_NRECS + 2) * APP_DIM1 * sizeof(int32));
+    CHECK_ALLOC(outdata, "outdata", "test_append_records");
+    status = SDreaddata(dset1, start, NULL, edges, outdata);
+    CHECK(status, FAIL, "SDreaddata");
+    for (i = 0; i < APP_NRECS * APP_DIM1; i++)
+        if (outdata[i] != i) {
+            fprintf(stderr, "test_append_records: value %d is %d after reopening\n", (int)i,
+                    (int)outdata[i]);
+            num_errs++;
+            break;
+        }
+    status = memcmp(outdata + APP_NRECS * APP_DIM1, recs, 2 * APP_DIM1 * sizeof(int32));
+    VERIFY(status, 0, "SDend with appended records");
+
+    /* The linked blocks hold the records of a full 64 KB buffer */
+    status = SDgetblocksize(dset1, &block_size);
+    CHECK(status, FAIL, "SDgetblocksize");
+    VERIFY(block_size, (65536 / (APP_DIM1 * 4)) * APP_DIM1 * 4, "SDgetblocksize");
+
+    free(outdata);
+    status = SDendaccess(dset1);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    return num_errs;
+} /* test_append_records */
+
 /* Test driver for testing reading/writing variables with unlimited dimension
    using SD API. */
 extern int
@@ -738,6 +903,9 @@ test_unlim()
     /* Test multiple variables created at different time */
     num_errs = num_errs + test_1dim_multivars_addon();
 
+    /* Test appending records with SDappend */
+    num_errs = num_errs + test_append_records();
+
     if (num_errs == 0)
         PASSED();
     return num_errs;